@@ -62,6 +62,11 @@ static lv_color_t *disp_draw_buf2;
 static lv_disp_drv_t disp_drv;
 
 /* Display flushing */
+void my_disp_flush_done(void *arg)
+{
+  lv_disp_flush_ready((lv_disp_drv_t *)arg);
+}
+
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
   uint32_t w = (area->x2 - area->x1 + 1);
@@ -69,11 +74,18 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
 
 #if (LV_COLOR_16_SWAP != 0)
   gfx->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t *)&color_p->full, w, h);
+  lv_disp_flush_ready(disp);
 #else
-  gfx->draw16bitRGBBitmap(area->x1, area->y1, (uint16_t *)&color_p->full, w, h);
+  // The DMA copies while LVGL renders into the other buffer
+  gfx->draw16bitRGBBitmapAsync(area->x1, area->y1, (uint16_t *)&color_p->full, w, h, my_disp_flush_done, disp);
 #endif
+}
 
-  lv_disp_flush_ready(disp);
+/* Areas on 16 pixel columns, the frame buffer DMA moves 32 byte blocks */
+void my_disp_rounder(lv_disp_drv_t *disp, lv_area_t *area)
+{
+  area->x1 &= ~15;
+  area->x2 |= 15;
 }
 
 void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
@@ -273,6 +285,9 @@ void setup()
   audioInit();
 
   audio.setPinout(I2S_BCLK, I2S_LRC, I2S_DOUT);
+  // I2S is fed from a ring by a task of its own, on core 0 with the decoder
+  // and away from LVGL, so heavy redraws do not reach the sound
+  audio.startOutputTask(0, 3);
   audio.setVolume(20); // 0...21
 
   log_i("current volume is: %d", audioGetVolume());
@@ -309,8 +324,8 @@ void setup()
   screenHeight = gfx->height();
 #ifdef ESP32
   //disp_draw_buf = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 4, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-  disp_draw_buf1 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-  disp_draw_buf2 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  disp_draw_buf1 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  disp_draw_buf2 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
 #else
   disp_draw_buf = (lv_color_t *)malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 4);
 #endif
@@ -328,6 +343,7 @@ void setup()
     disp_drv.hor_res = screenWidth;
     disp_drv.ver_res = screenHeight;
     disp_drv.flush_cb = my_disp_flush;
+    disp_drv.rounder_cb = my_disp_rounder;
     disp_drv.draw_buf = &draw_buf;
     lv_disp_drv_register(&disp_drv);
 
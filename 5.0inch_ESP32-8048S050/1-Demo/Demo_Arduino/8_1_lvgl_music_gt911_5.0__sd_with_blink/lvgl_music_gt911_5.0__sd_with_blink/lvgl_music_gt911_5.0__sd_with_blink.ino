@@ -48,6 +48,11 @@ void my_print(const char *buf)
 #endif
 
 /* Display flushing */
+void my_disp_flush_done(void *arg)
+{
+  lv_disp_flush_ready((lv_disp_drv_t *)arg);
+}
+
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
   uint32_t w = (area->x2 - area->x1 + 1);
@@ -55,11 +60,18 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
 
 #if (LV_COLOR_16_SWAP != 0)
   gfx->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t *)&color_p->full, w, h);
+  lv_disp_flush_ready(disp);
 #else
-  gfx->draw16bitRGBBitmap(area->x1, area->y1, (uint16_t *)&color_p->full, w, h);
+  // The DMA copies while LVGL renders into the other buffer
+  gfx->draw16bitRGBBitmapAsync(area->x1, area->y1, (uint16_t *)&color_p->full, w, h, my_disp_flush_done, disp);
 #endif
+}
 
-  lv_disp_flush_ready(disp);
+/* Areas on 16 pixel columns, the frame buffer DMA moves 32 byte blocks */
+void my_disp_rounder(lv_disp_drv_t *disp, lv_area_t *area)
+{
+  area->x1 &= ~15;
+  area->x2 |= 15;
 }
 
 /*Read the touchpad*/
@@ -148,8 +160,16 @@ void setup()
   gfx->begin();
   gfx->fillScreen(BLACK);
 
-  disp_draw_buf1 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-  disp_draw_buf2 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight /8, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  // Internal RAM lets the DMA flush run behind rendering, PSRAM buffers are copied by the CPU
+  disp_draw_buf1 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  disp_draw_buf2 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  if (!disp_draw_buf1 || !disp_draw_buf2)
+  {
+    free(disp_draw_buf1);
+    free(disp_draw_buf2);
+    disp_draw_buf1 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    disp_draw_buf2 = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * screenWidth * screenHeight / 8, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
 
   lv_disp_draw_buf_init(&draw_buf, disp_draw_buf1, disp_draw_buf2, screenWidth * screenHeight / 8);
 
@@ -160,6 +180,7 @@ void setup()
   disp_drv.hor_res = screenWidth;
   disp_drv.ver_res = screenHeight;
   disp_drv.flush_cb = my_disp_flush;
+  disp_drv.rounder_cb = my_disp_rounder;
   disp_drv.draw_buf = &draw_buf;
   lv_disp_drv_register(&disp_drv);
 
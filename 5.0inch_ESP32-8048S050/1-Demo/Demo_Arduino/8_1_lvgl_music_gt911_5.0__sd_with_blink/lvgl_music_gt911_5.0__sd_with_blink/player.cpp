@@ -86,6 +86,9 @@ void audioInit() {
   );
   
   audio.setPinout(I2S_BCLK, I2S_LRC, I2S_DOUT);
+  // I2S is fed from a ring by a task of its own, on core 0 with the decoder
+  // and away from LVGL, so heavy redraws do not reach the sound
+  audio.startOutputTask(0, 3);
   audio.setVolume(20); // 0...21
 }
 
@@ -113,6 +113,10 @@ void touch_init()
   Wire.begin(TOUCH_GT911_SDA, TOUCH_GT911_SCL);
   ts.begin();
   ts.setRotation(TOUCH_GT911_ROTATION);
+#if (TOUCH_GT911_INT >= 0)
+  // ts.read() then only goes to I2C after INT reported new points
+  ts.setOnRead(NULL);
+#endif
 
 #elif defined(TOUCH_XPT2046)
   SPI.begin(TOUCH_XPT2046_SCK, TOUCH_XPT2046_MISO, TOUCH_XPT2046_MOSI, TOUCH_XPT2046_CS);
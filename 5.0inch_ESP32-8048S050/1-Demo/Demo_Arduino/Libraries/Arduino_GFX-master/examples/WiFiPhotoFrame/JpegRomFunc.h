@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * ESP32-S3 ROM TJpgDec related function
+ *
+ * Decodes straight into the frame buffer of an RGB panel: the ROM decoder
+ * hands out each MCU block as RGB888 and it is packed to RGB565 at its final
+ * place on screen in the same pass, without a draw call or an intermediate
+ * bitmap. A reader task on the other core fills a stream buffer from the
+ * HTTP stream meanwhile, so network reads overlap the decode.
+ *
+ * No dependent libraries, the decoder is in the ESP32-S3 ROM.
+ ******************************************************************************/
+#ifndef _JPEGROMFUNC_H_
+#define _JPEGROMFUNC_H_
+
+#include <esp32s3/rom/tjpgd.h>
+#include <freertos/stream_buffer.h>
+
+#define JPEG_ROM_WORK_SIZE 3100      // work area the ROM decoder needs
+#define JPEG_ROM_STREAM_SIZE 8192    // bytes read ahead of the decoder
+#define JPEG_ROM_READ_CHUNK 1024
+#define JPEG_ROM_READ_TIMEOUT 10000  // in ms, without a byte from the server
+#define JPEG_ROM_READER_CORE 0       // with the WiFi stack, away from loop()
+
+typedef struct
+{
+  WiFiClient *stream;
+  int32_t remain; // bytes the reader has still to pass on
+  StreamBufferHandle_t sbuf;
+  volatile bool reader_done;
+  volatile bool abort;
+  uint16_t *fb;
+  int16_t fb_w, fb_h;
+  int x, y;       // top left corner of the image on the panel
+  uint16_t out_w; // image width after scaling
+} JpegRomCtx;
+
+static void jpegRomReader(void *arg)
+{
+  JpegRomCtx *ctx = (JpegRomCtx *)arg;
+  uint8_t chunk[JPEG_ROM_READ_CHUNK];
+  unsigned long last_ms = millis();
+  while ((ctx->remain > 0) && (!ctx->abort))
+  {
+    size_t a = ctx->stream->available();
+    if (!a)
+    {
+      if ((!ctx->stream->connected()) || (millis() - last_ms > JPEG_ROM_READ_TIMEOUT))
+      {
+        break;
+      }
+      delay(1);
+      continue;
+    }
+    size_t n = min(a, min(sizeof(chunk), (size_t)ctx->remain));
+    n = ctx->stream->read(chunk, n);
+    last_ms = millis();
+    ctx->remain -= n;
+    size_t sent = 0;
+    while ((sent < n) && (!ctx->abort))
+    {
+      sent += xStreamBufferSend(ctx->sbuf, chunk + sent, n - sent, pdMS_TO_TICKS(100));
+    }
+  }
+  ctx->reader_done = true;
+  vTaskDelete(NULL);
+}
+
+// buf NULL means skip len bytes
+static uint32_t jpegRomInput(JDEC *jd, uint8_t *buf, uint32_t len)
+{
+  JpegRomCtx *ctx = (JpegRomCtx *)jd->device;
+  uint8_t skip[64];
+  uint32_t got = 0;
+  while (got < len)
+  {
+    uint32_t want = len - got;
+    if ((!buf) && (want > sizeof(skip)))
+    {
+      want = sizeof(skip);
+    }
+    size_t n = xStreamBufferReceive(ctx->sbuf, buf ? buf + got : skip, want, pdMS_TO_TICKS(100));
+    if ((n == 0) && ctx->reader_done && xStreamBufferIsEmpty(ctx->sbuf))
+    {
+      break; // short read, the decoder gives up with JDR_INP
+    }
+    got += n;
+  }
+  return got;
+}
+
+static uint32_t jpegRomOutput(JDEC *jd, void *bitmap, JRECT *rect)
+{
+  JpegRomCtx *ctx = (JpegRomCtx *)jd->device;
+  const uint8_t *src = (const uint8_t *)bitmap;
+  int w = rect->right - rect->left + 1;
+  int h = rect->bottom - rect->top + 1;
+  int x = ctx->x + rect->left;
+  int y = ctx->y + rect->top;
+  int cw = min(w, ctx->fb_w - x);
+  int ch = min(h, ctx->fb_h - y);
+
+  if ((cw > 0) && (ch > 0))
+  {
+    uint16_t *row = ctx->fb + (int32_t)y * ctx->fb_w + x;
+    for (int j = 0; j < ch; j++)
+    {
+      const uint8_t *s = src + j * w * 3;
+      uint16_t *d = row;
+      for (int i = 0; i < cw; i++)
+      {
+        *d++ = ((s[0] & 0xF8) << 8) | ((s[1] & 0xFC) << 3) | (s[2] >> 3);
+        s += 3;
+      }
+      row += ctx->fb_w;
+    }
+  }
+
+  // One write back per band of MCUs, its full-width rows are contiguous
+  if ((rect->right + 1 >= ctx->out_w) && (ch > 0))
+  {
+    Cache_WriteBack_Addr((uint32_t)(ctx->fb + (int32_t)y * ctx->fb_w), (uint32_t)ch * ctx->fb_w * 2);
+  }
+  return 1;
+}
+
+static int jpegRomDrawHttpStream(WiFiClient *http_stream, int32_t dataSize, Arduino_RPi_DPI_RGBPanel *panel,
+                                 int x, int y, int widthLimit, int heightLimit)
+{
+  static uint32_t work[JPEG_ROM_WORK_SIZE / 4];
+  JpegRomCtx ctx = {};
+  ctx.stream = http_stream;
+  ctx.remain = dataSize;
+  ctx.fb = panel->getFramebuffer();
+  ctx.fb_w = panel->width();
+  ctx.fb_h = panel->height();
+  ctx.x = x;
+  ctx.y = y;
+
+  ctx.sbuf = xStreamBufferCreate(JPEG_ROM_STREAM_SIZE, 1);
+  if (!ctx.sbuf)
+  {
+    return 0;
+  }
+  if (xTaskCreatePinnedToCore(jpegRomReader, "jpegReader", 4096, &ctx, 1, NULL, JPEG_ROM_READER_CORE) != pdPASS)
+  {
+    vStreamBufferDelete(ctx.sbuf);
+    return 0;
+  }
+
+  int decode_result = 0;
+  JDEC jd;
+  if (jd_prepare(&jd, jpegRomInput, work, sizeof(work), &ctx) == JDR_OK)
+  {
+    // scale to fit, 1/1 to 1/8
+    uint8_t scale = 0;
+    while ((scale < 3) && (((jd.width >> scale) > widthLimit) || ((jd.height >> scale) > heightLimit)))
+    {
+      scale++;
+    }
+    ctx.out_w = jd.width >> scale;
+    decode_result = (jd_decomp(&jd, jpegRomOutput, scale) == JDR_OK);
+  }
+
+  // the reader may still be blocked on a full buffer after a failed decode
+  ctx.abort = true;
+  while (!ctx.reader_done)
+  {
+    delay(1);
+  }
+  vStreamBufferDelete(ctx.sbuf);
+
+  return decode_result;
+}
+
+#endif // _JPEGROMFUNC_H_
@@ -13,6 +13,10 @@
  * Setup steps:
  * 1. Fill your own SSID_NAME, SSID_PASSWORD, HTTP_HOST, HTTP_PORT and HTTP_PATH_TEMPLATE
  * 2. Change your LCD parameters in Arduino_GFX setting
+ *
+ * With RGB_PANEL_800X480 defined the photo is decoded by the ESP32-S3 ROM
+ * TJpgDec straight into the panel frame buffer while the next bytes are
+ * still being received, see JpegRomFunc.h; JPEGDEC is not needed then.
  ******************************************************************************/
 
 /* WiFi settings */
@@ -49,9 +53,25 @@ const uint16_t HTTP_TIMEOUT = 30000; // in ms, wait a while for server processin
 
 #define GFX_BL DF_GFX_BL // default backlight pin, you may replace DF_GFX_BL to actual backlight pin
 
+/* uncomment for the ESP32-8048S050 800x480 RGB panel */
+// #define RGB_PANEL_800X480
+
 /* More dev device declaration: https://github.com/moononournation/Arduino_GFX/wiki/Dev-Device-Declaration */
 #if defined(DISPLAY_DEV_KIT)
 Arduino_GFX *gfx = create_default_Arduino_GFX();
+#elif defined(RGB_PANEL_800X480)
+Arduino_ESP32RGBPanel *bus = new Arduino_ESP32RGBPanel(
+    GFX_NOT_DEFINED /* CS */, GFX_NOT_DEFINED /* SCK */, GFX_NOT_DEFINED /* SDA */,
+    40 /* DE */, 41 /* VSYNC */, 39 /* HSYNC */, 42 /* PCLK */,
+    45 /* R0 */, 48 /* R1 */, 47 /* R2 */, 21 /* R3 */, 14 /* R4 */,
+    5 /* G0 */, 6 /* G1 */, 7 /* G2 */, 15 /* G3 */, 16 /* G4 */, 4 /* G5 */,
+    8 /* B0 */, 3 /* B1 */, 46 /* B2 */, 9 /* B3 */, 1 /* B4 */
+);
+Arduino_RPi_DPI_RGBPanel *gfx = new Arduino_RPi_DPI_RGBPanel(
+    bus,
+    800 /* width */, 0 /* hsync_polarity */, 8 /* hsync_front_porch */, 4 /* hsync_pulse_width */, 8 /* hsync_back_porch */,
+    480 /* height */, 0 /* vsync_polarity */, 8 /* vsync_front_porch */, 4 /* vsync_pulse_width */, 8 /* vsync_back_porch */,
+    1 /* pclk_active_neg */, 12000000 /* prefer_speed */, true /* auto_flush */);
 #else /* !defined(DISPLAY_DEV_KIT) */
 
 /* More data bus class: https://github.com/moononournation/Arduino_GFX/wiki/Data-Bus-Class */
@@ -90,8 +110,13 @@ WiFiClient client;
 HttpClient http(client);
 #endif
 
+#if defined(RGB_PANEL_800X480)
+#include "JpegRomFunc.h"
+#else
 #include "JpegFunc.h"
+#endif
 
+#if !defined(RGB_PANEL_800X480)
 // pixel drawing callback
 static int jpegDrawCallback(JPEGDRAW *pDraw)
 {
@@ -99,6 +124,7 @@ static int jpegDrawCallback(JPEGDRAW *pDraw)
   gfx->draw16bitRGBBitmap(pDraw->x, pDraw->y, pDraw->pPixels, pDraw->iWidth, pDraw->iHeight);
   return 1;
 }
+#endif
 
 static unsigned long next_show_millis = 0;
 
@@ -217,6 +243,11 @@ void loop()
           {
             unsigned long start = millis();
 
+#if defined(RGB_PANEL_800X480)
+            static WiFiClient *http_stream = http.getStreamPtr();
+            jpeg_result = jpegRomDrawHttpStream(http_stream, len, gfx,
+                                                0 /* x */, 0 /* y */, gfx->width() /* widthLimit */, gfx->height() /* heightLimit */);
+#else
             uint8_t *buf = (uint8_t *)malloc(len);
             if (buf)
             {
@@ -248,6 +279,7 @@ void loop()
                                        0 /* x */, 0 /* y */, gfx->width() /* widthLimit */, gfx->height() /* heightLimit */);
               }
             }
+#endif
             Serial.printf("Time used: %lu\n", millis() - start);
           }
         }
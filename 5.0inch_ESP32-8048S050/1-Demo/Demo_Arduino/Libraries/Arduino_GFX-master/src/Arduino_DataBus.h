@@ -71,6 +71,9 @@ typedef uint8_t ARDUINOGFX_PORT_t;
 typedef volatile ARDUINOGFX_PORT_t *PORTreg_t;
 #endif
 
+// Completion of an asynchronous write, may be called from an interrupt
+typedef void (*gfx_done_cb_t)(void *arg);
+
 #if defined(ARDUINO_ARCH_ARC32) || defined(ARDUINO_MAXIM)
 #define SPI_DEFAULT_FREQ 16000000
 // Teensy 3.0, 3.1/3.2, 3.5, 3.6
@@ -1521,6 +1521,30 @@ void Arduino_GFX::draw16bitBeRGBBitmap(int16_t x, int16_t y,
   endWrite();
 }
 
+/**************************************************************************/
+/*!
+  @brief  Draw a RAM-resident 16-bit image (RGB 5/6/5) at the specified (x,y)
+    position and call done(arg) once it is on the display. Displays that can
+    copy in the background return before that and call done from an
+    interrupt; the bitmap must stay untouched until then. This one draws
+    synchronously.
+  @param  x       Top left corner x coordinate
+  @param  y       Top left corner y coordinate
+  @param  bitmap  byte array with 16-bit color bitmap
+  @param  w       Width of bitmap in pixels
+  @param  h       Height of bitmap in pixels
+  @param  done    Called once the bitmap is drawn
+  @param  arg     Passed to done
+*/
+/**************************************************************************/
+void Arduino_GFX::draw16bitRGBBitmapAsync(int16_t x, int16_t y,
+                                          uint16_t *bitmap, int16_t w, int16_t h,
+                                          gfx_done_cb_t done, void *arg)
+{
+  draw16bitRGBBitmap(x, y, bitmap, w, h);
+  done(arg);
+}
+
 /**************************************************************************/
 /*!
   @brief  Draw a PROGMEM-resident 16-bit image (RGB 5/6/5) with a 1-bit mask
@@ -1755,6 +1779,70 @@ uint16_t Arduino_GFX::u8g2_font_get_word(const uint8_t *font, uint8_t offset)
   return pos;
 }
 
+const uint8_t *Arduino_GFX::u8g2_font_get_glyph_data(uint16_t encoding)
+{
+  const uint8_t *font = u8g2Font;
+  const uint8_t *glyph_data = 0;
+
+  // extract from u8g2_font_get_glyph_data()
+  font += 23; // U8G2_FONT_DATA_STRUCT_SIZE
+  if (encoding <= 255)
+  {
+    if (encoding >= 'a')
+    {
+      font += _u8g2_start_pos_lower_a;
+    }
+    else if (encoding >= 'A')
+    {
+      font += _u8g2_start_pos_upper_A;
+    }
+
+    for (;;)
+    {
+      if (pgm_read_byte(font + 1) == 0)
+        break;
+      if (pgm_read_byte(font) == encoding)
+      {
+        glyph_data = font + 2; /* skip encoding and glyph size */
+      }
+      font += pgm_read_byte(font + 1);
+    }
+  }
+#ifdef U8G2_WITH_UNICODE
+  else
+  {
+    uint16_t e;
+    font += _u8g2_start_pos_unicode;
+    const uint8_t *unicode_lookup_table = font;
+
+    /* issue 596: search for the glyph start in the unicode lookup table */
+    do
+    {
+      font += u8g2_font_get_word(unicode_lookup_table, 0);
+      e = u8g2_font_get_word(unicode_lookup_table, 2);
+      unicode_lookup_table += 4;
+    } while (e < encoding);
+
+    for (;;)
+    {
+      e = u8g2_font_get_word(font, 0);
+
+      if (e == 0)
+        break;
+
+      if (e == encoding)
+      {
+        glyph_data = font + 3; /* skip encoding and glyph size */
+        break;
+      }
+      font += pgm_read_byte(font + 2);
+    }
+  }
+#endif
+
+  return glyph_data;
+}
+
 uint8_t Arduino_GFX::u8g2_font_decode_get_unsigned_bits(uint8_t cnt)
 {
   uint8_t val;
@@ -1871,6 +1959,92 @@ void Arduino_GFX::u8g2_font_decode_len(uint8_t len, uint8_t is_foreground, uint1
   _u8g2_dx = lx;
   _u8g2_dy = ly;
 }
+
+// Same run length decode as drawChar(), into a 1 bit per pixel bitmap
+void Arduino_GFX::u8g2_font_decode_bitmap(uint8_t *bitmap)
+{
+  uint8_t stride = (_u8g2_char_width + 7) >> 3;
+  uint8_t lx = 0;
+  uint8_t ly = 0;
+  for (;;)
+  {
+    uint8_t a = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_0);
+    uint8_t b = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_1);
+    do
+    {
+      for (uint16_t i = a + b; i > 0; i--)
+      {
+        if ((i <= b) && (ly < _u8g2_char_height))
+        {
+          bitmap[ly * stride + (lx >> 3)] |= 0x80 >> (lx & 7);
+        }
+        if (++lx == _u8g2_char_width)
+        {
+          lx = 0;
+          ly++;
+        }
+      }
+    } while (u8g2_font_decode_get_unsigned_bits(1) != 0);
+
+    if (ly >= _u8g2_char_height)
+      break;
+  }
+}
+
+void Arduino_GFX::u8g2_draw_cached_glyph(uint16_t color, uint16_t bg)
+{
+  const uint8_t *bitmap = _u8g2_glyph_cache->bitmap(_u8g2_glyph);
+  uint8_t w = _u8g2_char_width;
+  uint8_t h = _u8g2_char_height;
+  uint8_t stride = (w + 7) >> 3;
+
+  if ((textsize_x == 1) && (textsize_y == 1) && (bg != color) && ((w * h) <= (16 * 16)))
+  {
+    // opaque text is a solid block, one bitmap draw instead of a line per run
+    uint16_t buf[16 * 16];
+    uint16_t *p = buf;
+    for (uint8_t ly = 0; ly < h; ly++)
+    {
+      const uint8_t *row = bitmap + ly * stride;
+      for (uint8_t lx = 0; lx < w; lx++)
+      {
+        *p++ = (row[lx >> 3] & (0x80 >> (lx & 7))) ? color : bg;
+      }
+    }
+    draw16bitRGBBitmap(_u8g2_target_x, _u8g2_target_y, buf, w, h);
+    return;
+  }
+
+  startWrite();
+  for (uint8_t ly = 0; ly < h; ly++)
+  {
+    const uint8_t *row = bitmap + ly * stride;
+    uint8_t lx = 0;
+    while (lx < w)
+    {
+      bool fg = row[lx >> 3] & (0x80 >> (lx & 7));
+      uint8_t run = 1;
+      while (((lx + run) < w) && ((bool)(row[(lx + run) >> 3] & (0x80 >> ((lx + run) & 7))) == fg))
+      {
+        run++;
+      }
+      if (fg || (bg != color))
+      {
+        if (textsize_x == 1 && textsize_y == 1)
+        {
+          writeFastHLine(_u8g2_target_x + lx, _u8g2_target_y + ly, run, fg ? color : bg);
+        }
+        else
+        {
+          writeFillRect(_u8g2_target_x + (lx * textsize_x), _u8g2_target_y + (ly * textsize_y),
+                        (run * textsize_x) - text_pixel_margin, textsize_y - text_pixel_margin, fg ? color : bg);
+        }
+      }
+      lx += run;
+    }
+  }
+  endWrite();
+}
 #endif // defined(U8G2_FONT_SUPPORT)
 
 // TEXT- AND CHARACTER-HANDLING FUNCTIONS ----------------------------------
@@ -1968,7 +2142,13 @@ void Arduino_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
 #if defined(U8G2_FONT_SUPPORT)
       if (u8g2Font)
   {
-    if ((_u8g2_decode_ptr) && (_u8g2_char_width > 0))
+    if ((_u8g2_glyph) && (_u8g2_char_width > 0))
+    {
+      _u8g2_target_x = x + (_u8g2_char_x * textsize_x);
+      _u8g2_target_y = y - ((_u8g2_char_height + _u8g2_char_y) * textsize_y);
+      u8g2_draw_cached_glyph(color, bg);
+    }
+    else if ((_u8g2_decode_ptr) && (_u8g2_char_width > 0))
     {
       uint8_t a, b;
 
@@ -2109,6 +2289,7 @@ size_t Arduino_GFX::write(uint8_t c)
       if (u8g2Font)
   {
     _u8g2_decode_ptr = 0;
+    _u8g2_glyph = NULL;
 
     if (_enableUTF8Print)
     {
@@ -2164,64 +2345,25 @@ size_t Arduino_GFX::write(uint8_t c)
       }
       else if (_encoding != '\r')
       { // Ignore carriage returns
-        uint8_t *font = u8g2Font;
         const uint8_t *glyph_data = 0;
 
-        // extract from u8g2_font_get_glyph_data()
-        font += 23; // U8G2_FONT_DATA_STRUCT_SIZE
-        if (_encoding <= 255)
+        if (_u8g2_glyph_cache)
         {
-          if (_encoding >= 'a')
-          {
-            font += _u8g2_start_pos_lower_a;
-          }
-          else if (_encoding >= 'A')
-          {
-            font += _u8g2_start_pos_upper_A;
-          }
-
-          for (;;)
-          {
-            if (pgm_read_byte(font + 1) == 0)
-              break;
-            if (pgm_read_byte(font) == _encoding)
-            {
-              glyph_data = font + 2; /* skip encoding and glyph size */
-            }
-            font += pgm_read_byte(font + 1);
-          }
+          _u8g2_glyph = _u8g2_glyph_cache->get(u8g2Font, _encoding);
+        }
+        if (_u8g2_glyph)
+        {
+          // neither the glyph search nor the decode
+          _u8g2_char_width = _u8g2_glyph->width;
+          _u8g2_char_height = _u8g2_glyph->height;
+          _u8g2_char_x = _u8g2_glyph->x;
+          _u8g2_char_y = _u8g2_glyph->y;
+          _u8g2_delta_x = _u8g2_glyph->delta_x;
         }
-#ifdef U8G2_WITH_UNICODE
         else
         {
-          uint16_t e;
-          font += _u8g2_start_pos_unicode;
-          const uint8_t *unicode_lookup_table = font;
-
-          /* issue 596: search for the glyph start in the unicode lookup table */
-          do
-          {
-            font += u8g2_font_get_word(unicode_lookup_table, 0);
-            e = u8g2_font_get_word(unicode_lookup_table, 2);
-            unicode_lookup_table += 4;
-          } while (e < _encoding);
-
-          for (;;)
-          {
-            e = u8g2_font_get_word(font, 0);
-
-            if (e == 0)
-              break;
-
-            if (e == _encoding)
-            {
-              glyph_data = font + 3; /* skip encoding and glyph size */
-              break;
-            }
-            font += pgm_read_byte(font + 2);
-          }
+          glyph_data = u8g2_font_get_glyph_data(_encoding);
         }
-#endif
 
         if (glyph_data)
         {
@@ -2237,6 +2379,24 @@ size_t Arduino_GFX::write(uint8_t c)
           // log_d("c: %c, _encoding: %d, _u8g2_char_width: %d, _u8g2_char_height: %d, _u8g2_char_x: %d, _u8g2_char_y: %d, _u8g2_delta_x: %d",
           //       c, _encoding, _u8g2_char_width, _u8g2_char_height, _u8g2_char_x, _u8g2_char_y, _u8g2_delta_x);
 
+          if (_u8g2_glyph_cache)
+          {
+            _u8g2_glyph = _u8g2_glyph_cache->add(u8g2Font, _encoding, _u8g2_char_width, _u8g2_char_height);
+            if (_u8g2_glyph)
+            {
+              _u8g2_glyph->x = _u8g2_char_x;
+              _u8g2_glyph->y = _u8g2_char_y;
+              _u8g2_glyph->delta_x = _u8g2_delta_x;
+              if (_u8g2_char_width > 0)
+              {
+                u8g2_font_decode_bitmap(_u8g2_glyph_cache->bitmap(_u8g2_glyph));
+              }
+            }
+          }
+        }
+
+        if ((glyph_data) || (_u8g2_glyph))
+        {
           if (_u8g2_char_width > 0)
           {
             if (wrap && ((cursor_x + (textsize_x * _u8g2_char_width) - 1) > _max_x))
@@ -2370,6 +2530,7 @@ void Arduino_GFX::setFont(const uint8_t *font)
 {
   gfxFont = NULL;
   u8g2Font = (uint8_t *)font;
+  _u8g2_glyph = NULL;
 
   // extract from u8g2_read_font_info()
   /* offset 0 */
@@ -2420,6 +2581,33 @@ void Arduino_GFX::setUTF8Print(bool isEnable)
 {
   _enableUTF8Print = isEnable;
 }
+
+/**************************************************************************/
+/*!
+  @brief  Keep decoded u8g2 glyphs in a least recently used cache, so
+          repeated text skips the glyph search and the bit stream decode
+  @param  budget           Bytes for the cache, in PSRAM when there is some;
+                           0 frees it
+  @param  max_char_width   Widest glyph to cache, 16 for the unifont fonts
+  @param  max_char_height  Tallest glyph to cache
+  @return true if the cache is ready, or freed for a budget of 0
+*/
+/**************************************************************************/
+bool Arduino_GFX::setU8g2GlyphCache(size_t budget, uint8_t max_char_width, uint8_t max_char_height)
+{
+  _u8g2_glyph = NULL;
+  if (!budget)
+  {
+    delete _u8g2_glyph_cache;
+    _u8g2_glyph_cache = NULL;
+    return true;
+  }
+  if (!_u8g2_glyph_cache)
+  {
+    _u8g2_glyph_cache = new Arduino_U8g2GlyphCache();
+  }
+  return _u8g2_glyph_cache->begin(budget, max_char_width, max_char_height);
+}
 #endif // defined(U8G2_FONT_SUPPORT)
 
 /**************************************************************************/
@@ -0,0 +1,183 @@
+#include "Arduino_RGB565.h"
+
+#if defined(ESP32) && (CONFIG_IDF_TARGET_ESP32S3)
+#define RGB565_PIE
+#endif
+
+// Red and blue in the low half, green in the high half, with room above
+// each channel for the multiply in rgb565_blend()
+#define RGB565_SPREAD_MASK 0x07E0F81F
+
+// Clears the low bit of each channel so a shift does not cross into the next
+#define RGB565_HALF_MASK 0xF7DEF7DE
+
+void rgb565_fill(uint16_t *dst, uint16_t color, uint32_t len)
+{
+#if defined(RGB565_PIE)
+  while (len && ((uintptr_t)dst & 15))
+  {
+    *dst++ = color;
+    len--;
+  }
+  uint32_t blocks = len >> 3;
+  if (blocks)
+  {
+    // q0 = color in all 8 lanes, then one 128-bit store per 8 pixels
+    asm volatile(
+        "ee.vldbc.16 q0, %[c]\n"
+        "1:\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        : [d] "+r"(dst), [n] "+r"(blocks)
+        : [c] "r"(&color)
+        : "memory");
+    len &= 7;
+  }
+#endif
+  if (len && ((uintptr_t)dst & 2))
+  {
+    *dst++ = color;
+    len--;
+  }
+  uint32_t c2 = ((uint32_t)color << 16) | color;
+  uint32_t *dst2 = (uint32_t *)dst;
+  uint32_t words = len >> 1;
+  while (words >= 4)
+  {
+    dst2[0] = c2;
+    dst2[1] = c2;
+    dst2[2] = c2;
+    dst2[3] = c2;
+    dst2 += 4;
+    words -= 4;
+  }
+  while (words--)
+  {
+    *dst2++ = c2;
+  }
+  if (len & 1)
+  {
+    *(uint16_t *)dst2 = color;
+  }
+}
+
+void rgb565_copy(uint16_t *dst, const uint16_t *src, uint32_t len)
+{
+#if defined(RGB565_PIE)
+  // Vector loads and stores both need 16 byte alignment, which only helps
+  // when source and destination share it; canvas rows usually do
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 15) == 0)
+  {
+    while (len && ((uintptr_t)dst & 15))
+    {
+      *dst++ = *src++;
+      len--;
+    }
+    uint32_t blocks = len >> 3;
+    if (blocks)
+    {
+      asm volatile(
+          "1:\n"
+          "ee.vld.128.ip q0, %[s], 16\n"
+          "ee.vst.128.ip q0, %[d], 16\n"
+          "addi %[n], %[n], -1\n"
+          "bnez %[n], 1b\n"
+          : [d] "+r"(dst), [s] "+r"(src), [n] "+r"(blocks)
+          :
+          : "memory");
+      len &= 7;
+    }
+  }
+#endif
+  memcpy(dst, src, len * 2);
+}
+
+void rgb565_copy_swap(uint16_t *dst, const uint16_t *src, uint32_t len)
+{
+  // Two pixels per word when both sides can be word aligned together
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0)
+  {
+    if (len && ((uintptr_t)dst & 2))
+    {
+      uint16_t p = *src++;
+      *dst++ = (p << 8) | (p >> 8);
+      len--;
+    }
+    uint32_t *dst2 = (uint32_t *)dst;
+    const uint32_t *src2 = (const uint32_t *)src;
+    uint32_t words = len >> 1;
+    while (words--)
+    {
+      uint32_t v = *src2++;
+      *dst2++ = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+    }
+    dst = (uint16_t *)dst2;
+    src = (const uint16_t *)src2;
+    len &= 1;
+  }
+  while (len--)
+  {
+    uint16_t p = *src++;
+    *dst++ = (p << 8) | (p >> 8);
+  }
+}
+
+void rgb565_blend50(uint16_t *dst, const uint16_t *src, uint32_t len)
+{
+  // (a & b) + ((a ^ b) >> 1) per channel, the masked shift keeps channels apart
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0)
+  {
+    if (len && ((uintptr_t)dst & 2))
+    {
+      uint16_t a = *dst, b = *src++;
+      *dst++ = (a & b) + (((a ^ b) & (uint16_t)RGB565_HALF_MASK) >> 1);
+      len--;
+    }
+    uint32_t *dst2 = (uint32_t *)dst;
+    const uint32_t *src2 = (const uint32_t *)src;
+    uint32_t words = len >> 1;
+    while (words--)
+    {
+      uint32_t a = *dst2, b = *src2++;
+      *dst2++ = (a & b) + (((a ^ b) & RGB565_HALF_MASK) >> 1);
+    }
+    dst = (uint16_t *)dst2;
+    src = (const uint16_t *)src2;
+    len &= 1;
+  }
+  while (len--)
+  {
+    uint16_t a = *dst, b = *src++;
+    *dst++ = (a & b) + (((a ^ b) & (uint16_t)RGB565_HALF_MASK) >> 1);
+  }
+}
+
+void rgb565_blend(uint16_t *dst, const uint16_t *src, uint32_t len, uint8_t alpha)
+{
+  uint32_t a = ((uint32_t)alpha + 4) >> 3;
+  if (a == 0)
+  {
+    return;
+  }
+  if (a == 32)
+  {
+    rgb565_copy(dst, src, len);
+    return;
+  }
+  if (a == 16)
+  {
+    rgb565_blend50(dst, src, len);
+    return;
+  }
+  // All three channels in one multiply
+  while (len--)
+  {
+    uint32_t fg = *src++;
+    uint32_t bg = *dst;
+    fg = (fg | (fg << 16)) & RGB565_SPREAD_MASK;
+    bg = (bg | (bg << 16)) & RGB565_SPREAD_MASK;
+    uint32_t r = ((((fg - bg) * a) >> 5) + bg) & RGB565_SPREAD_MASK;
+    *dst++ = (uint16_t)((r >> 16) | r);
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef _ARDUINO_RGB565_H_
+#define _ARDUINO_RGB565_H_
+
+#include <Arduino.h>
+
+// Row kernels for RGB565 pixel runs, shared by the canvas and the RGB panel
+// bus. On the ESP32-S3 fill and copy move 16 bytes per store through the PIE
+// vector unit once the destination is 16 byte aligned; elsewhere, and for the
+// unaligned head and tail, they fall back to word stores.
+
+// dst[0..len) = color
+void rgb565_fill(uint16_t *dst, uint16_t color, uint32_t len);
+
+// dst[0..len) = src[0..len)
+void rgb565_copy(uint16_t *dst, const uint16_t *src, uint32_t len);
+
+// dst[0..len) = src[0..len) with the bytes of each pixel swapped
+void rgb565_copy_swap(uint16_t *dst, const uint16_t *src, uint32_t len);
+
+// dst[i] = average of dst[i] and src[i], per channel
+void rgb565_blend50(uint16_t *dst, const uint16_t *src, uint32_t len);
+
+// dst[i] = src[i] * alpha + dst[i] * (255 - alpha), alpha in 1/32 steps
+void rgb565_blend(uint16_t *dst, const uint16_t *src, uint32_t len, uint8_t alpha);
+
+#endif // _ARDUINO_RGB565_H_
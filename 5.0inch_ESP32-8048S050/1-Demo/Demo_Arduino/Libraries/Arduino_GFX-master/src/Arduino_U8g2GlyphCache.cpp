@@ -0,0 +1,209 @@
+#include "Arduino_U8g2GlyphCache.h"
+
+Arduino_U8g2GlyphCache::Arduino_U8g2GlyphCache()
+{
+}
+
+Arduino_U8g2GlyphCache::~Arduino_U8g2GlyphCache()
+{
+  end();
+}
+
+bool Arduino_U8g2GlyphCache::begin(size_t budget, uint8_t max_width, uint8_t max_height)
+{
+  end();
+
+  _header_size = (sizeof(Glyph) + 3) & ~3;
+  _slot_size = (_header_size + ((max_width + 7) >> 3) * max_height + 3) & ~3;
+  size_t slots = budget / _slot_size;
+  if (slots > U8G2_GLYPH_CACHE_NONE - 1)
+  {
+    slots = U8G2_GLYPH_CACHE_NONE - 1;
+  }
+  if (slots == 0)
+  {
+    return false;
+  }
+
+  // about 2 slots per bucket, the chains stay short
+  uint16_t buckets = 1;
+  while ((size_t)(buckets << 1) <= (slots >> 1))
+  {
+    buckets <<= 1;
+  }
+
+#if defined(ESP32)
+  if (psramFound())
+  {
+    _pool = (uint8_t *)ps_malloc(slots * _slot_size);
+  }
+  else
+  {
+    _pool = (uint8_t *)malloc(slots * _slot_size);
+  }
+#else
+  _pool = (uint8_t *)malloc(slots * _slot_size);
+#endif
+  _buckets = (uint16_t *)malloc(buckets * sizeof(uint16_t));
+  if ((!_pool) || (!_buckets))
+  {
+    end();
+    return false;
+  }
+
+  _slots = slots;
+  _bucket_mask = buckets - 1;
+  _max_width = max_width;
+  _max_height = max_height;
+  clear();
+  return true;
+}
+
+void Arduino_U8g2GlyphCache::end()
+{
+  if (_pool)
+  {
+    free(_pool);
+    _pool = NULL;
+  }
+  if (_buckets)
+  {
+    free(_buckets);
+    _buckets = NULL;
+  }
+  _slots = 0;
+  _used = 0;
+  _lru_head = _lru_tail = U8G2_GLYPH_CACHE_NONE;
+}
+
+void Arduino_U8g2GlyphCache::clear()
+{
+  if (!_buckets)
+  {
+    return;
+  }
+  for (uint32_t i = 0; i <= _bucket_mask; i++)
+  {
+    _buckets[i] = U8G2_GLYPH_CACHE_NONE;
+  }
+  _used = 0;
+  _lru_head = _lru_tail = U8G2_GLYPH_CACHE_NONE;
+  _hits = _misses = 0;
+}
+
+Arduino_U8g2GlyphCache::Glyph *Arduino_U8g2GlyphCache::get(const uint8_t *font, uint16_t encoding)
+{
+  if (!_pool)
+  {
+    return NULL;
+  }
+  uint16_t i = _buckets[hash(font, encoding)];
+  while (i != U8G2_GLYPH_CACHE_NONE)
+  {
+    Glyph *g = slot(i);
+    if ((g->encoding == encoding) && (g->font == font))
+    {
+      if (i != _lru_head)
+      {
+        unlinkLru(i);
+        pushFront(i);
+      }
+      _hits++;
+      return g;
+    }
+    i = g->hash_next;
+  }
+  _misses++;
+  return NULL;
+}
+
+Arduino_U8g2GlyphCache::Glyph *Arduino_U8g2GlyphCache::add(const uint8_t *font, uint16_t encoding, uint8_t width, uint8_t height)
+{
+  if ((!_pool) || (width > _max_width) || (height > _max_height))
+  {
+    return NULL;
+  }
+
+  uint16_t i;
+  if (_used < _slots)
+  {
+    i = _used++;
+  }
+  else
+  {
+    i = _lru_tail;
+    unlinkLru(i);
+    unlinkHash(i);
+  }
+
+  Glyph *g = slot(i);
+  g->font = font;
+  g->encoding = encoding;
+  g->width = width;
+  g->height = height;
+  uint16_t h = hash(font, encoding);
+  g->hash_next = _buckets[h];
+  _buckets[h] = i;
+  pushFront(i);
+  memset(bitmap(g), 0, ((width + 7) >> 3) * height);
+  return g;
+}
+
+uint16_t Arduino_U8g2GlyphCache::hash(const uint8_t *font, uint16_t encoding)
+{
+  uint32_t v = encoding ^ ((uint32_t)(uintptr_t)font >> 4);
+  v *= 0x9E3779B1; // Fibonacci hashing, the high bits are the well mixed ones
+  return (v >> 16) & _bucket_mask;
+}
+
+void Arduino_U8g2GlyphCache::unlinkLru(uint16_t i)
+{
+  Glyph *g = slot(i);
+  if (g->lru_prev != U8G2_GLYPH_CACHE_NONE)
+  {
+    slot(g->lru_prev)->lru_next = g->lru_next;
+  }
+  else
+  {
+    _lru_head = g->lru_next;
+  }
+  if (g->lru_next != U8G2_GLYPH_CACHE_NONE)
+  {
+    slot(g->lru_next)->lru_prev = g->lru_prev;
+  }
+  else
+  {
+    _lru_tail = g->lru_prev;
+  }
+}
+
+void Arduino_U8g2GlyphCache::pushFront(uint16_t i)
+{
+  Glyph *g = slot(i);
+  g->lru_prev = U8G2_GLYPH_CACHE_NONE;
+  g->lru_next = _lru_head;
+  if (_lru_head != U8G2_GLYPH_CACHE_NONE)
+  {
+    slot(_lru_head)->lru_prev = i;
+  }
+  _lru_head = i;
+  if (_lru_tail == U8G2_GLYPH_CACHE_NONE)
+  {
+    _lru_tail = i;
+  }
+}
+
+void Arduino_U8g2GlyphCache::unlinkHash(uint16_t i)
+{
+  Glyph *g = slot(i);
+  uint16_t *link = &_buckets[hash(g->font, g->encoding)];
+  while (*link != U8G2_GLYPH_CACHE_NONE)
+  {
+    if (*link == i)
+    {
+      *link = g->hash_next;
+      return;
+    }
+    link = &slot(*link)->hash_next;
+  }
+}
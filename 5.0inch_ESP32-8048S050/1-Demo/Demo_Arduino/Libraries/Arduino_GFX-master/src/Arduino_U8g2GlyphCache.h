@@ -0,0 +1,72 @@
+#ifndef _ARDUINO_U8G2GLYPHCACHE_H_
+#define _ARDUINO_U8G2GLYPHCACHE_H_
+
+#include <Arduino.h>
+
+// Least recently used cache of decoded u8g2 glyphs, 1 bit per pixel, rows
+// padded to whole bytes. Slots are all the size of the largest glyph given
+// to begin() and come out of one allocation, in PSRAM when there is some;
+// a glyph larger than that is simply not cached. Keyed by font and
+// encoding, so several fonts can share one cache.
+
+#define U8G2_GLYPH_CACHE_NONE 0xFFFF
+
+class Arduino_U8g2GlyphCache
+{
+public:
+  typedef struct
+  {
+    const uint8_t *font;
+    uint16_t encoding;
+    uint16_t hash_next; // chain of the same hash bucket
+    uint16_t lru_prev;  // towards the most recently used
+    uint16_t lru_next;  // towards the least recently used
+    uint8_t width;
+    uint8_t height;
+    int8_t x;
+    int8_t y;
+    int8_t delta_x;
+  } Glyph; // followed by the bitmap in its slot
+
+  Arduino_U8g2GlyphCache();
+  ~Arduino_U8g2GlyphCache();
+
+  bool begin(size_t budget, uint8_t max_width, uint8_t max_height);
+  void end();
+  void clear();
+
+  // NULL on a miss, a hit becomes the most recently used
+  Glyph *get(const uint8_t *font, uint16_t encoding);
+  // takes the least recently used slot, NULL if the glyph does not fit one
+  Glyph *add(const uint8_t *font, uint16_t encoding, uint8_t width, uint8_t height);
+
+  uint8_t *bitmap(Glyph *g) { return ((uint8_t *)g) + _header_size; }
+  uint8_t maxWidth() { return _max_width; }
+  uint8_t maxHeight() { return _max_height; }
+  uint16_t capacity() { return _slots; }
+  uint32_t hits() { return _hits; }
+  uint32_t misses() { return _misses; }
+
+private:
+  Glyph *slot(uint16_t i) { return (Glyph *)(_pool + (size_t)i * _slot_size); }
+  uint16_t hash(const uint8_t *font, uint16_t encoding);
+  void unlinkLru(uint16_t i);
+  void pushFront(uint16_t i);
+  void unlinkHash(uint16_t i);
+
+  uint8_t *_pool = NULL;
+  uint16_t *_buckets = NULL;
+  size_t _header_size = 0;
+  size_t _slot_size = 0;
+  uint16_t _slots = 0;
+  uint16_t _bucket_mask = 0;
+  uint16_t _used = 0;
+  uint16_t _lru_head = U8G2_GLYPH_CACHE_NONE; // most recently used
+  uint16_t _lru_tail = U8G2_GLYPH_CACHE_NONE; // least recently used, evicted first
+  uint8_t _max_width = 0;
+  uint8_t _max_height = 0;
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+};
+
+#endif // _ARDUINO_U8G2GLYPHCACHE_H_
@@ -2,8 +2,14 @@
 #if !defined(LITTLE_FOOT_PRINT)
 
 #include "../Arduino_GFX.h"
+#include "../Arduino_RGB565.h"
 #include "Arduino_Canvas.h"
 
+static inline int32_t rect_area(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    return (int32_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+}
+
 Arduino_Canvas::Arduino_Canvas(
     int16_t w, int16_t h, Arduino_G *output, int16_t output_x, int16_t output_y)
     : Arduino_GFX(w, h), _output(output), _output_x(output_x), _output_y(output_y)
@@ -40,11 +46,13 @@ void Arduino_Canvas::begin(int32_t speed)
     {
         Serial.println(F("_framebuffer allocation failed."));
     }
+    markDirty(0, 0, _width, _height);
 }
 
 void Arduino_Canvas::writePixelPreclipped(int16_t x, int16_t y, uint16_t color)
 {
     _framebuffer[((int32_t)y * _width) + x] = color;
+    markDirty(x, y, 1, 1);
 }
 
 void Arduino_Canvas::writeFastVLine(int16_t x, int16_t y,
@@ -73,6 +81,7 @@ void Arduino_Canvas::writeFastVLine(int16_t x, int16_t y,
                     h = _max_y - y + 1;
                 } // Clip bottom
 
+                markDirty(x, y, 1, h);
                 uint16_t *fb = _framebuffer + ((int32_t)y * _width) + x;
                 while (h--)
                 {
@@ -110,11 +119,8 @@ void Arduino_Canvas::writeFastHLine(int16_t x, int16_t y,
                     w = _max_x - x + 1;
                 } // Clip right
 
-                uint16_t *fb = _framebuffer + ((int32_t)y * _width) + x;
-                while (w--)
-                {
-                    *(fb++) = color;
-                }
+                markDirty(x, y, w, 1);
+                rgb565_fill(_framebuffer + ((int32_t)y * _width) + x, color, w);
             }
         }
     }
@@ -123,15 +129,13 @@ void Arduino_Canvas::writeFastHLine(int16_t x, int16_t y,
 void Arduino_Canvas::writeFillRectPreclipped(int16_t x, int16_t y,
                                              int16_t w, int16_t h, uint16_t color)
 {
+    markDirty(x, y, w, h);
     uint16_t *row = _framebuffer;
     row += y * _width;
     row += x;
     for (int j = 0; j < h; j++)
     {
-        for (int i = 0; i < w; i++)
-        {
-            row[i] = color;
-        }
+        rgb565_fill(row, color, w);
         row += _width;
     }
 }
@@ -139,57 +143,66 @@ void Arduino_Canvas::writeFillRectPreclipped(int16_t x, int16_t y,
 void Arduino_Canvas::draw16bitRGBBitmap(int16_t x, int16_t y,
                                         uint16_t *bitmap, int16_t w, int16_t h)
 {
-    if (
-        ((x + w - 1) < 0) || // Outside left
-        ((y + h - 1) < 0) || // Outside top
-        (x > _max_x) ||      // Outside right
-        (y > _max_y)         // Outside bottom
-    )
+    int16_t xskip;
+    if (!clipBitmap(x, y, bitmap, w, h, xskip))
     {
         return;
     }
-    else
+    markDirty(x, y, w, h);
+    uint16_t *row = _framebuffer;
+    row += y * _width;
+    row += x;
+    for (int j = 0; j < h; j++)
     {
-        int16_t xskip = 0;
-        if ((y + h - 1) > _max_y)
-        {
-            h -= (y + h - 1) - _max_y;
-        }
-        if (y < 0)
-        {
-            bitmap -= y * w;
-            h += y;
-            y = 0;
-        }
-        if ((x + w - 1) > _max_x)
-        {
-            xskip = (x + w - 1) - _max_x;
-            w -= xskip;
-        }
-        if (x < 0)
-        {
-            bitmap -= x;
-            xskip -= x;
-            w += x;
-            x = 0;
-        }
-        uint16_t *row = _framebuffer;
-        row += y * _width;
-        row += x;
-        for (int j = 0; j < h; j++)
-        {
-            for (int i = 0; i < w; i++)
-            {
-                row[i] = *bitmap++;
-            }
-            bitmap += xskip;
-            row += _width;
-        }
+        rgb565_copy(row, bitmap, w);
+        bitmap += w + xskip;
+        row += _width;
     }
 }
 
 void Arduino_Canvas::draw16bitBeRGBBitmap(int16_t x, int16_t y,
                                           uint16_t *bitmap, int16_t w, int16_t h)
+{
+    int16_t xskip;
+    if (!clipBitmap(x, y, bitmap, w, h, xskip))
+    {
+        return;
+    }
+    markDirty(x, y, w, h);
+    uint16_t *row = _framebuffer;
+    row += y * _width;
+    row += x;
+    for (int j = 0; j < h; j++)
+    {
+        rgb565_copy_swap(row, bitmap, w);
+        bitmap += w + xskip;
+        row += _width;
+    }
+}
+
+void Arduino_Canvas::blend16bitRGBBitmap(int16_t x, int16_t y,
+                                         uint16_t *bitmap, int16_t w, int16_t h, uint8_t alpha)
+{
+    int16_t xskip;
+    if (!clipBitmap(x, y, bitmap, w, h, xskip))
+    {
+        return;
+    }
+    markDirty(x, y, w, h);
+    uint16_t *row = _framebuffer;
+    row += y * _width;
+    row += x;
+    for (int j = 0; j < h; j++)
+    {
+        rgb565_blend(row, bitmap, w, alpha);
+        bitmap += w + xskip;
+        row += _width;
+    }
+}
+
+// Clips a bitmap to the canvas, xskip is what is cut off each row
+bool Arduino_Canvas::clipBitmap(int16_t &x, int16_t &y, uint16_t *&bitmap,
+                                int16_t &w, int16_t &h, int16_t &xskip)
 {
     if (
         ((x + w - 1) < 0) || // Outside left
@@ -198,53 +211,113 @@ void Arduino_Canvas::draw16bitBeRGBBitmap(int16_t x, int16_t y,
         (y > _max_y)         // Outside bottom
     )
     {
-        return;
+        return false;
     }
-    else
+    xskip = 0;
+    if ((y + h - 1) > _max_y)
     {
-        int16_t xskip = 0;
-        if ((y + h - 1) > _max_y)
-        {
-            h -= (y + h - 1) - _max_y;
-        }
-        if (y < 0)
-        {
-            bitmap -= y * w;
-            h += y;
-            y = 0;
-        }
-        if ((x + w - 1) > _max_x)
+        h -= (y + h - 1) - _max_y;
+    }
+    if (y < 0)
+    {
+        bitmap -= y * w;
+        h += y;
+        y = 0;
+    }
+    if ((x + w - 1) > _max_x)
+    {
+        xskip = (x + w - 1) - _max_x;
+        w -= xskip;
+    }
+    if (x < 0)
+    {
+        bitmap -= x;
+        xskip -= x;
+        w += x;
+        x = 0;
+    }
+    return true;
+}
+
+void Arduino_Canvas::markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    DirtyRect r = {x, y, (int16_t)(x + w - 1), (int16_t)(y + h - 1)};
+    for (uint8_t i = 0; i < _dirty_count; i++)
+    {
+        const DirtyRect &d = _dirty[i];
+        if (r.x1 >= d.x1 && r.y1 >= d.y1 && r.x2 <= d.x2 && r.y2 <= d.y2)
         {
-            xskip = (x + w - 1) - _max_x;
-            w -= xskip;
+            return;
         }
-        if (x < 0)
+    }
+
+    // Absorb rects close enough that pushing their union costs about the same
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (uint8_t i = 0; i < _dirty_count; i++)
         {
-            bitmap -= x;
-            xskip -= x;
-            w += x;
-            x = 0;
+            const DirtyRect &d = _dirty[i];
+            DirtyRect u = {min(r.x1, d.x1), min(r.y1, d.y1), max(r.x2, d.x2), max(r.y2, d.y2)};
+            if (rect_area(u.x1, u.y1, u.x2, u.y2) <=
+                rect_area(r.x1, r.y1, r.x2, r.y2) + rect_area(d.x1, d.y1, d.x2, d.y2) + CANVAS_DIRTY_MERGE_SLACK)
+            {
+                r = u;
+                _dirty[i] = _dirty[--_dirty_count];
+                merged = true;
+                break;
+            }
         }
-        uint16_t *row = _framebuffer;
-        row += y * _width;
-        row += x;
-        uint16_t color;
-        for (int j = 0; j < h; j++)
+    }
+
+    if (_dirty_count == CANVAS_DIRTY_RECTS)
+    {
+        // List full: grow the rect that grows least
+        uint8_t best = 0;
+        int32_t best_growth = INT32_MAX;
+        for (uint8_t i = 0; i < _dirty_count; i++)
         {
-            for (int i = 0; i < w; i++)
+            const DirtyRect &d = _dirty[i];
+            int32_t growth = rect_area(min(r.x1, d.x1), min(r.y1, d.y1), max(r.x2, d.x2), max(r.y2, d.y2)) -
+                             rect_area(d.x1, d.y1, d.x2, d.y2);
+            if (growth < best_growth)
             {
-                color = *bitmap++;
-                MSB_16_SET(row[i], color);
+                best = i;
+                best_growth = growth;
             }
-            bitmap += xskip;
-            row += _width;
         }
+        const DirtyRect &d = _dirty[best];
+        r = {min(r.x1, d.x1), min(r.y1, d.y1), max(r.x2, d.x2), max(r.y2, d.y2)};
+        _dirty[best] = _dirty[--_dirty_count];
     }
+    _dirty[_dirty_count++] = r;
 }
 
 void Arduino_Canvas::flush()
 {
-    _output->draw16bitRGBBitmap(_output_x, _output_y, _framebuffer, _width, _height);
+    for (uint8_t i = 0; i < _dirty_count; i++)
+    {
+        const DirtyRect &d = _dirty[i];
+        int16_t w = d.x2 - d.x1 + 1;
+        int16_t h = d.y2 - d.y1 + 1;
+        uint16_t *row = _framebuffer + ((int32_t)d.y1 * _width);
+        if ((int32_t)w * 4 >= (int32_t)_width * 3)
+        {
+            // Nearly full width: the whole band is contiguous, one push
+            _output->draw16bitRGBBitmap(_output_x, _output_y + d.y1, row, _width, h);
+        }
+        else
+        {
+            row += d.x1;
+            for (int16_t j = 0; j < h; j++)
+            {
+                _output->draw16bitRGBBitmap(_output_x + d.x1, _output_y + d.y1 + j, row, w, 1);
+                row += _width;
+            }
+        }
+    }
+    _dirty_count = 0;
 }
 
 #endif // !defined(LITTLE_FOOT_PRINT)
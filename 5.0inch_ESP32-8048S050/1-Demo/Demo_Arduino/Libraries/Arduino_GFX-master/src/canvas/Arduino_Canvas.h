@@ -6,6 +6,11 @@
 
 #include "../Arduino_GFX.h"
 
+// Areas drawn since the last flush; more are merged into the closest one
+#define CANVAS_DIRTY_RECTS 8
+// Rects are merged when the union is at most this many pixels larger than both
+#define CANVAS_DIRTY_MERGE_SLACK 512
+
 class Arduino_Canvas : public Arduino_GFX
 {
 public:
@@ -18,13 +23,25 @@ public:
   void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
   void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
   void draw16bitBeRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
+  // Mixes the bitmap over what is on the canvas, alpha 255 is opaque
+  void blend16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h, uint8_t alpha);
   void flush(void) override;
 
 protected:
+  void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+  bool clipBitmap(int16_t &x, int16_t &y, uint16_t *&bitmap, int16_t &w, int16_t &h, int16_t &xskip);
+
   uint16_t *_framebuffer;
   Arduino_G *_output;
   int16_t _output_x, _output_y;
 
+  struct DirtyRect
+  {
+    int16_t x1, y1, x2, y2;
+  };
+  DirtyRect _dirty[CANVAS_DIRTY_RECTS];
+  uint8_t _dirty_count = 0;
+
 private:
 };
 
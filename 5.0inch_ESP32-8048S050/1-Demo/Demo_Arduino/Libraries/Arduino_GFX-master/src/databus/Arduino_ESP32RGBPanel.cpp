@@ -1,7 +1,13 @@
 #include "Arduino_ESP32RGBPanel.h"
+#include "../Arduino_RGB565.h"
 
 #if defined(ESP32) && (CONFIG_IDF_TARGET_ESP32S3)
 
+#include "soc/soc_memory_layout.h"
+
+#define RGBPANEL_ASYNC_BACKLOG 64 // DMA descriptors, an eighth of 800x480 goes in one copy
+#define RGBPANEL_ASYNC_ALIGN 32   // PSRAM block size of the copy DMA, bytes
+
 Arduino_ESP32RGBPanel::Arduino_ESP32RGBPanel(
     int8_t cs, int8_t sck, int8_t sda,
     int8_t de, int8_t vsync, int8_t hsync, int8_t pclk,
@@ -16,6 +22,7 @@ Arduino_ESP32RGBPanel::Arduino_ESP32RGBPanel(
       _b0(b0), _b1(b1), _b2(b2), _b3(b3), _b4(b4),
       _useBigEndian(useBigEndian)
 {
+  portMUX_INITIALIZE(&_async_lock);
 }
 
 void Arduino_ESP32RGBPanel::begin(int32_t speed, int8_t dataMode)
@@ -156,18 +163,294 @@ void Arduino_ESP32RGBPanel::write16(uint16_t)
 
 void Arduino_ESP32RGBPanel::writeRepeat(uint16_t p, uint32_t len)
 {
+  if (!_fb)
+  {
+    return;
+  }
+  fillWindow(p, len);
+  flushSpans();
 }
 
 void Arduino_ESP32RGBPanel::writePixels(uint16_t *data, uint32_t len)
 {
+  if (!_fb)
+  {
+    return;
+  }
+  while (len)
+  {
+    uint32_t n = len;
+    uint16_t *dst = nextSpan(&n);
+    rgb565_copy(dst, data, n);
+    data += n;
+    len -= n;
+  }
+  flushSpans();
 }
 
+// Bytes are big-endian pixels, as for the SPI and parallel buses
 void Arduino_ESP32RGBPanel::writeBytes(uint8_t *data, uint32_t len)
 {
+  if (!_fb)
+  {
+    return;
+  }
+  copyBeWindow(data, len >> 1);
+  flushSpans();
 }
 
 void Arduino_ESP32RGBPanel::writePattern(uint8_t *data, uint8_t len, uint32_t repeat)
 {
+  if (!_fb)
+  {
+    return;
+  }
+  if (len == 2)
+  {
+    fillWindow(((uint16_t)data[0] << 8) | data[1], repeat);
+  }
+  else
+  {
+    while (repeat--)
+    {
+      copyBeWindow(data, len >> 1);
+    }
+  }
+  flushSpans();
+}
+
+void Arduino_ESP32RGBPanel::setWindow(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+  if (x < 0)
+  {
+    w = (w > -x) ? w + x : 0;
+    x = 0;
+  }
+  if (y < 0)
+  {
+    h = (h > -y) ? h + y : 0;
+    y = 0;
+  }
+  if (x + w > _fb_w)
+  {
+    w = (x < _fb_w) ? _fb_w - x : 0;
+  }
+  if (y + h > _fb_h)
+  {
+    h = (y < _fb_h) ? _fb_h - y : 0;
+  }
+  if (!w || !h)
+  {
+    // Nothing of it on screen, keep writes inside the frame buffer
+    x = y = 0;
+    w = h = 1;
+  }
+  _win_x = x;
+  _win_y = y;
+  _win_w = w;
+  _win_h = h;
+  _cur_x = 0;
+  _cur_y = 0;
+}
+
+void Arduino_ESP32RGBPanel::setAutoFlush(bool auto_flush)
+{
+  _auto_flush = auto_flush;
+}
+
+// Returns where the cursor is and advances it by up to *len pixels that are
+// contiguous in the frame buffer: the rest of the row, or with a full-width
+// window the rest of the window. Wraps to the top like a controller's GRAM.
+uint16_t *Arduino_ESP32RGBPanel::nextSpan(uint32_t *len)
+{
+  uint32_t avail = _win_w - _cur_x;
+  if (_win_w == _fb_w)
+  {
+    avail += (uint32_t)(_win_h - _cur_y - 1) * _win_w;
+  }
+  if (*len > avail)
+  {
+    *len = avail;
+  }
+
+  uint16_t *dst = _fb + (uint32_t)(_win_y + _cur_y) * _fb_w + _win_x + _cur_x;
+  if (!_dirty_start || dst < _dirty_start)
+  {
+    _dirty_start = dst;
+  }
+  if (dst + *len > _dirty_end)
+  {
+    _dirty_end = dst + *len;
+  }
+
+  uint32_t pos = _cur_x + *len;
+  _cur_y += pos / _win_w;
+  _cur_x = pos % _win_w;
+  if (_cur_y >= _win_h)
+  {
+    _cur_y = 0;
+  }
+  return dst;
+}
+
+void Arduino_ESP32RGBPanel::fillWindow(uint16_t p, uint32_t len)
+{
+  while (len)
+  {
+    uint32_t n = len;
+    uint16_t *dst = nextSpan(&n);
+    len -= n;
+    rgb565_fill(dst, p, n);
+  }
+}
+
+void Arduino_ESP32RGBPanel::copyBeWindow(const uint8_t *data, uint32_t len)
+{
+  while (len)
+  {
+    uint32_t n = len;
+    uint16_t *dst = nextSpan(&n);
+    len -= n;
+    while (n--)
+    {
+      *dst++ = ((uint16_t)data[0] << 8) | data[1];
+      data += 2;
+    }
+  }
+}
+
+// One write back for everything touched since the last one
+void Arduino_ESP32RGBPanel::flushSpans(void)
+{
+  if (_auto_flush && _dirty_start)
+  {
+    Cache_WriteBack_Addr((uint32_t)_dirty_start, (_dirty_end - _dirty_start) * 2);
+  }
+  _dirty_start = NULL;
+  _dirty_end = NULL;
+}
+
+void Arduino_ESP32RGBPanel::writePixelsAsync(int16_t x, int16_t y, uint16_t w, uint16_t h,
+                                             const uint16_t *data, uint16_t stride, gfx_done_cb_t done, void *arg)
+{
+  // One copy in flight at a time, LVGL waits for the previous one anyway
+  while (_async_pending)
+  {
+  }
+
+  if (!_fb || !w || !h)
+  {
+    done(arg);
+    return;
+  }
+
+  uint16_t *dst = _fb + (uint32_t)y * _fb_w + x;
+  uint32_t row_bytes = (uint32_t)w * 2;
+  if (!beginAsync() || !esp_ptr_dma_capable(data) ||
+      (((uintptr_t)dst | row_bytes | ((uint32_t)_fb_w * 2)) & (RGBPANEL_ASYNC_ALIGN - 1)))
+  {
+    copyRows(dst, data, w, h, stride);
+    done(arg);
+    return;
+  }
+
+  // The DMA writes PSRAM behind the cache: nothing of the window may stay
+  // dirty there to be written back over the copy, nor clean to be read
+  uint32_t span = ((uint32_t)(h - 1) * _fb_w + w) * 2;
+  Cache_WriteBack_Addr((uint32_t)dst, span);
+  Cache_Invalidate_Addr((uint32_t)dst, span);
+
+  _async_done = done;
+  _async_arg = arg;
+  _async_pending = 1;
+
+  uint16_t rows = 0;
+  if ((w == _fb_w) && (stride == w) && queueCopy(dst, data, span))
+  {
+    rows = h;
+  }
+  while ((rows < h) && queueCopy(dst + (uint32_t)rows * _fb_w, data + (uint32_t)rows * stride, row_bytes))
+  {
+    rows++;
+  }
+  if (rows < h)
+  {
+    // Out of descriptors: let the queued rows land, the CPU does the rest
+    while (_async_pending > 1)
+    {
+    }
+    copyRows(dst + (uint32_t)rows * _fb_w, data + (uint32_t)rows * stride, w, h - rows, stride);
+  }
+  releaseAsync();
+}
+
+void Arduino_ESP32RGBPanel::copyRows(uint16_t *dst, const uint16_t *src, uint16_t w, uint16_t h, uint16_t stride)
+{
+  uint16_t *start = dst;
+  for (uint16_t j = 0; j < h; j++)
+  {
+    rgb565_copy(dst, src, w);
+    dst += _fb_w;
+    src += stride;
+  }
+  if (_auto_flush)
+  {
+    Cache_WriteBack_Addr((uint32_t)start, ((uint32_t)(h - 1) * _fb_w + w) * 2);
+  }
+}
+
+// Installs the async memcpy driver on first use, it takes a GDMA channel pair
+bool Arduino_ESP32RGBPanel::beginAsync(void)
+{
+  if (!_async_mcp && !_async_unavailable)
+  {
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = RGBPANEL_ASYNC_BACKLOG;
+    config.psram_trans_align = RGBPANEL_ASYNC_ALIGN;
+    if (esp_async_memcpy_install(&config, &_async_mcp) != ESP_OK)
+    {
+      _async_mcp = NULL;
+      _async_unavailable = true;
+    }
+  }
+  return _async_mcp != NULL;
+}
+
+bool Arduino_ESP32RGBPanel::queueCopy(uint16_t *dst, const uint16_t *src, uint32_t bytes)
+{
+  portENTER_CRITICAL(&_async_lock);
+  _async_pending++;
+  portEXIT_CRITICAL(&_async_lock);
+  if (esp_async_memcpy(_async_mcp, dst, (void *)src, bytes, asyncCopyDone, this) == ESP_OK)
+  {
+    return true;
+  }
+  portENTER_CRITICAL(&_async_lock);
+  _async_pending--;
+  portEXIT_CRITICAL(&_async_lock);
+  return false;
+}
+
+// Drops one reference to the copy in flight, the last one reports it done
+void Arduino_ESP32RGBPanel::releaseAsync(void)
+{
+  portENTER_CRITICAL_SAFE(&_async_lock);
+  gfx_done_cb_t done = _async_done;
+  void *arg = _async_arg;
+  bool last = (--_async_pending == 0);
+  portEXIT_CRITICAL_SAFE(&_async_lock);
+  if (last)
+  {
+    done(arg);
+  }
+}
+
+bool Arduino_ESP32RGBPanel::asyncCopyDone(async_memcpy_t mcp, async_memcpy_event_t *event, void *arg)
+{
+  UNUSED(mcp);
+  UNUSED(event);
+  ((Arduino_ESP32RGBPanel *)arg)->releaseAsync();
+  return false;
 }
 
 uint16_t *Arduino_ESP32RGBPanel::getFrameBuffer(
@@ -258,7 +541,12 @@ uint16_t *Arduino_ESP32RGBPanel::getFrameBuffer(
 
   _rgb_panel = __containerof(_panel_handle, esp_rgb_panel_t, base);
 
-  return (uint16_t *)_rgb_panel->fb;
+  _fb = (uint16_t *)_rgb_panel->fb;
+  _fb_w = w;
+  _fb_h = h;
+  setWindow(0, 0, w, h);
+
+  return _fb;
 }
 
 INLINE void Arduino_ESP32RGBPanel::CS_HIGH(void)
@@ -10,6 +10,7 @@
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_interface.h"
+#include "esp_async_memcpy.h"
 #include "esp_private/gdma.h"
 #include "esp_pm.h"
 #include "hal/dma_types.h"
@@ -83,8 +84,30 @@ public:
       uint16_t vsync_pulse_width = 10, uint16_t vsync_back_porch = 16, uint16_t vsync_front_porch = 4, uint16_t vsync_polarity = 1,
       uint16_t pclk_active_neg = 0, int32_t prefer_speed = GFX_NOT_DEFINED);
 
+  // Bulk writes go to this window of the frame buffer, left to right and top to bottom
+  void setWindow(int16_t x, int16_t y, uint16_t w, uint16_t h);
+  void setAutoFlush(bool auto_flush);
+
+  // Copies w x h pixels, rows stride pixels apart, to (x, y) of the frame
+  // buffer with the async memcpy DMA and returns; done(arg) runs from its
+  // interrupt once every row has landed, and data must stay untouched until
+  // then. The window must be on screen. The DMA moves 32 byte blocks, so x
+  // and w need to be multiples of 16 and data in DMA capable internal RAM;
+  // otherwise the CPU copies it and done runs before this returns.
+  void writePixelsAsync(int16_t x, int16_t y, uint16_t w, uint16_t h,
+                        const uint16_t *data, uint16_t stride, gfx_done_cb_t done, void *arg);
+
 protected:
 private:
+  uint16_t *nextSpan(uint32_t *len);
+  void fillWindow(uint16_t p, uint32_t len);
+  void copyBeWindow(const uint8_t *data, uint32_t len);
+  void flushSpans(void);
+  void copyRows(uint16_t *dst, const uint16_t *src, uint16_t w, uint16_t h, uint16_t stride);
+  bool beginAsync(void);
+  bool queueCopy(uint16_t *dst, const uint16_t *src, uint32_t bytes);
+  void releaseAsync(void);
+  static bool asyncCopyDone(async_memcpy_t mcp, async_memcpy_event_t *event, void *arg);
   INLINE void CS_HIGH(void);
   INLINE void CS_LOW(void);
   INLINE void SCK_HIGH(void);
@@ -104,6 +127,21 @@ private:
   esp_lcd_panel_handle_t _panel_handle = NULL;
   esp_rgb_panel_t *_rgb_panel;
 
+  uint16_t *_fb = NULL;
+  uint16_t _fb_w = 0, _fb_h = 0;
+  uint16_t _win_x = 0, _win_y = 0, _win_w = 0, _win_h = 0;
+  uint16_t _cur_x = 0, _cur_y = 0;
+  bool _auto_flush = true;
+  uint16_t *_dirty_start = NULL; // Span touched since the last write back
+  uint16_t *_dirty_end = NULL;
+
+  async_memcpy_t _async_mcp = NULL;
+  bool _async_unavailable = false;
+  portMUX_TYPE _async_lock;
+  volatile uint32_t _async_pending = 0; // Queued copies, plus one while queueing
+  gfx_done_cb_t _async_done = NULL;
+  void *_async_arg = NULL;
+
   PORTreg_t _csPortSet;  ///< PORT register for chip select SET
   PORTreg_t _csPortClr;  ///< PORT register for chip select CLEAR
   PORTreg_t _sckPortSet; ///< PORT register for SCK SET
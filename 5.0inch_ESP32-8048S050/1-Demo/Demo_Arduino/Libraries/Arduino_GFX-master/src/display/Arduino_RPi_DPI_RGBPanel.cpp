@@ -27,6 +27,7 @@ void Arduino_RPi_DPI_RGBPanel::begin(int32_t speed)
       _hsync_pulse_width, _hsync_back_porch, _hsync_front_porch, _hsync_polarity,
       _vsync_pulse_width, _vsync_back_porch, _vsync_front_porch, _vsync_polarity,
       _pclk_active_neg, _prefer_speed);
+  _bus->setAutoFlush(_auto_flush);
 }
 
 void Arduino_RPi_DPI_RGBPanel::writePixelPreclipped(int16_t x, int16_t y, uint16_t color)
@@ -116,17 +117,8 @@ void Arduino_RPi_DPI_RGBPanel::writeFastHLine(int16_t x, int16_t y,
           w = _max_x - x + 1;
         } // Clip right
 
-        uint16_t *fb = _framebuffer + ((int32_t)y * _width) + x;
-        uint32_t cachePos = (uint32_t)fb;
-        int16_t writeSize = w * 2;
-        while (w--)
-        {
-          *(fb++) = color;
-        }
-        if (_auto_flush)
-        {
-          Cache_WriteBack_Addr(cachePos, writeSize);
-        }
+        _bus->setWindow(x, y, w, 1);
+        _bus->writeRepeat(color, w);
       }
     }
   }
@@ -135,22 +127,8 @@ void Arduino_RPi_DPI_RGBPanel::writeFastHLine(int16_t x, int16_t y,
 void Arduino_RPi_DPI_RGBPanel::writeFillRectPreclipped(int16_t x, int16_t y,
                                                        int16_t w, int16_t h, uint16_t color)
 {
-  uint16_t *row = _framebuffer;
-  row += y * _width;
-  uint32_t cachePos = (uint32_t)row;
-  row += x;
-  for (int j = 0; j < h; j++)
-  {
-    for (int i = 0; i < w; i++)
-    {
-      row[i] = color;
-    }
-    row += _width;
-  }
-  if (_auto_flush)
-  {
-    Cache_WriteBack_Addr(cachePos, _width * h * 2);
-  }
+  _bus->setWindow(x, y, w, h);
+  _bus->writeRepeat(color, (uint32_t)w * h);
 }
 
 void Arduino_RPi_DPI_RGBPanel::draw16bitRGBBitmap(int16_t x, int16_t y,
@@ -190,44 +168,19 @@ void Arduino_RPi_DPI_RGBPanel::draw16bitRGBBitmap(int16_t x, int16_t y,
       w += x;
       x = 0;
     }
-    uint16_t *row = _framebuffer;
-    row += y * _width;
-    uint32_t cachePos = (uint32_t)row;
-    row += x;
-    if (((_width & 1) == 0) && ((xskip & 1) == 0) && ((w & 1) == 0))
+    _bus->setWindow(x, y, w, h);
+    if (xskip == 0)
     {
-      uint32_t *row2 = (uint32_t *)row;
-      uint32_t *bitmap2 = (uint32_t *)bitmap;
-      int16_t _width2 = _width >> 1;
-      int16_t xskip2 = xskip >> 1;
-      int16_t w2 = w >> 1;
-
-      for (int16_t j = 0; j < h; j++)
-      {
-        for (int16_t i = 0; i < w2; i++)
-        {
-          row2[i] = *bitmap2++;
-        }
-        bitmap2 += xskip2;
-        row2 += _width2;
-      }
+      _bus->writePixels(bitmap, (uint32_t)w * h);
     }
     else
     {
       for (int j = 0; j < h; j++)
       {
-        for (int i = 0; i < w; i++)
-        {
-          row[i] = *bitmap++;
-        }
-        bitmap += xskip;
-        row += _width;
+        _bus->writePixels(bitmap, w);
+        bitmap += w + xskip;
       }
     }
-    if (_auto_flush)
-    {
-      Cache_WriteBack_Addr(cachePos, _width * h * 2);
-    }
   }
 }
 
@@ -268,28 +221,63 @@ void Arduino_RPi_DPI_RGBPanel::draw16bitBeRGBBitmap(int16_t x, int16_t y,
       w += x;
       x = 0;
     }
-    uint16_t *row = _framebuffer;
-    row += y * _width;
-    uint32_t cachePos = (uint32_t)row;
-    row += x;
-    uint16_t color;
-    for (int j = 0; j < h; j++)
+    _bus->setWindow(x, y, w, h);
+    if (xskip == 0)
     {
-      for (int i = 0; i < w; i++)
-      {
-        color = *bitmap++;
-        MSB_16_SET(row[i], color);
-      }
-      bitmap += xskip;
-      row += _width;
+      _bus->writeBytes((uint8_t *)bitmap, (uint32_t)w * h * 2);
     }
-    if (_auto_flush)
+    else
     {
-      Cache_WriteBack_Addr(cachePos, _width * h * 2);
+      for (int j = 0; j < h; j++)
+      {
+        _bus->writeBytes((uint8_t *)bitmap, w * 2);
+        bitmap += w + xskip;
+      }
     }
   }
 }
 
+void Arduino_RPi_DPI_RGBPanel::draw16bitRGBBitmapAsync(int16_t x, int16_t y,
+                                                       uint16_t *bitmap, int16_t w, int16_t h,
+                                                       gfx_done_cb_t done, void *arg)
+{
+  if (
+      ((x + w - 1) < 0) || // Outside left
+      ((y + h - 1) < 0) || // Outside top
+      (x > _max_x) ||      // Outside right
+      (y > _max_y)         // Outside bottom
+  )
+  {
+    done(arg);
+    return;
+  }
+
+  int16_t xskip = 0;
+  if ((y + h - 1) > _max_y)
+  {
+    h -= (y + h - 1) - _max_y;
+  }
+  if (y < 0)
+  {
+    bitmap -= y * w;
+    h += y;
+    y = 0;
+  }
+  if ((x + w - 1) > _max_x)
+  {
+    xskip = (x + w - 1) - _max_x;
+    w -= xskip;
+  }
+  if (x < 0)
+  {
+    bitmap -= x;
+    xskip -= x;
+    w += x;
+    x = 0;
+  }
+  _bus->writePixelsAsync(x, y, w, h, bitmap, w + xskip, done, arg);
+}
+
 void Arduino_RPi_DPI_RGBPanel::flush(void)
 {
   if (!_auto_flush)
@@ -12,11 +12,16 @@
 #include "mp3_decoder/mp3_decoder.h"
 #include "aac_decoder/aac_decoder.h"
 #include "flac_decoder/flac_decoder.h"
+#include <esp_heap_caps.h>
 
 #ifdef SDFATFS_USED
 fs::SDFATFS SD_SDFAT;
 #endif
 
+#define AUDIO_PREFETCH_BURST  32768  // bytes per file read while a PSRAM input buffer is refilled
+#define AUDIO_OUT_CHUNK       256    // frames per i2s_write() in the output task
+#define AUDIO_OUT_MAX_FRAMES  16384  // largest output ring
+
 //---------------------------------------------------------------------------------------------------------------------
 AudioBuffer::AudioBuffer(size_t maxBlockSize) {
     // if maxBlockSize isn't set use defaultspace (1600 bytes) is enough for aac and mp3 player
@@ -294,6 +299,8 @@ Audio::~Audio() {
     //InBuff.~AudioBuffer(); #215 the AudioBuffer is automatically destroyed by the destructor
     setDefaults();
     if(m_playlistBuff) {free(m_playlistBuff); m_playlistBuff = NULL;}
+    if(m_outTask) {vTaskDelete(m_outTask); m_outTask = NULL;}
+    if(m_outRing) {free(m_outRing); m_outRing = NULL;}
     i2s_driver_uninstall((i2s_port_t)m_i2s_num); // #215 free I2S buffer
 }
 //---------------------------------------------------------------------------------------------------------------------
@@ -2262,7 +2269,7 @@ uint32_t Audio::stopSong() {
         log_w("Closing audio file");  // for debug
     }
     memset(m_outBuff, 0, sizeof(m_outBuff));     //Clear OutputBuffer
-    i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+    zeroOutput();
     return pos;
 }
 //---------------------------------------------------------------------------------------------------------------------
@@ -2276,6 +2283,8 @@ void Audio::playI2Sremains() { // returns true if all dma_buffs flushed
     while(m_validSamples) {
         playChunk();
     }
+    uint32_t t = millis();
+    while(m_outTask && m_outRingHead != m_outRingTail && millis() - t < 500) vTaskDelay(1); // the zeros are in the DMA
     i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
     return;
 }
@@ -2287,7 +2296,7 @@ bool Audio::pauseResume() {
         retVal = true;
         if(!m_f_running) {
             memset(m_outBuff, 0, sizeof(m_outBuff));               //Clear OutputBuffer
-            i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+            zeroOutput();
         }
     }
     return retVal;
@@ -2378,6 +2387,91 @@ bool Audio::playChunk() {
     return false;
 }
 //---------------------------------------------------------------------------------------------------------------------
+bool Audio::startOutputTask(uint8_t core, UBaseType_t prio, uint16_t ringFrames) {
+    // Call once after setPinout() and before the first connectto...(). playSample() then hands the frames to a ring
+    // instead of calling i2s_write() for each of them; a task that does nothing else keeps the I2S DMA fed from it,
+    // so a decoder that stalls on the SD card or on a busy core eats into the ring and not into the sound.
+    if(m_outTask) return true;
+    uint32_t frames = AUDIO_OUT_CHUNK;
+    while(frames < ringFrames && frames < AUDIO_OUT_MAX_FRAMES) frames <<= 1;
+    m_outRing = (uint32_t*)heap_caps_malloc(frames * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(!m_outRing && psramFound()) m_outRing = (uint32_t*)ps_malloc(frames * sizeof(uint32_t)); // 176KB/s is nothing for PSRAM
+    if(!m_outRing) {log_e("no memory for the output ring"); return false;}
+    m_outRingMask = frames - 1;
+    m_outRingHead = 0;
+    m_outRingTail = 0;
+    if(xTaskCreatePinnedToCore(outputTask, "audioout", 3072, this, prio, &m_outTask, core) != pdPASS) {
+        m_outTask = NULL;
+        free(m_outRing); m_outRing = NULL;
+        log_e("output task not started");
+        return false;
+    }
+    AUDIO_INFO("output task on core %u, ring of %u frames", core, frames);
+    return true;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::outputTask(void* arg) {
+    ((Audio*)arg)->outputLoop();
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::outputLoop() { // the consumer, only this task moves m_outRingTail
+    while(true) {
+        if(m_f_outFlush) {
+            __atomic_store_n(&m_outRingTail, __atomic_load_n(&m_outRingHead, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            m_f_outFlush = false;
+        }
+        uint32_t tail = m_outRingTail;
+        uint32_t filled = __atomic_load_n(&m_outRingHead, __ATOMIC_ACQUIRE) - tail;
+        if(!filled) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(5)); // outputPush() wakes us, the timeout is only a fuse
+            continue;
+        }
+        uint32_t pos = tail & m_outRingMask;
+        uint32_t n = min(filled, m_outRingMask + 1 - pos); // not across the end of the ring
+        n = min(n, (uint32_t)AUDIO_OUT_CHUNK);
+        size_t bw = 0;
+        i2s_write((i2s_port_t)m_i2s_num, (const char*)&m_outRing[pos], n * sizeof(uint32_t), &bw, pdMS_TO_TICKS(100));
+        __atomic_store_n(&m_outRingTail, tail + bw / sizeof(uint32_t), __ATOMIC_RELEASE);
+        TaskHandle_t waiter = m_outWaiter;
+        if(waiter) xTaskNotifyGive(waiter);
+    }
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool Audio::outputPush(uint32_t s32) { // the producer, only the task in loop() moves m_outRingHead
+    uint32_t head = m_outRingHead;
+    if(head - __atomic_load_n(&m_outRingTail, __ATOMIC_ACQUIRE) > m_outRingMask) { // full, wait for the consumer
+        m_outWaiter = xTaskGetCurrentTaskHandle();
+        uint32_t t = millis();
+        while(head - __atomic_load_n(&m_outRingTail, __ATOMIC_ACQUIRE) > m_outRingMask) {
+            if(millis() - t > 100) {
+                m_outWaiter = NULL;
+                log_e("Can't stuff any more in I2S...");
+                return false;
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+        }
+        m_outWaiter = NULL;
+    }
+    m_outRing[head & m_outRingMask] = s32;
+    __atomic_store_n(&m_outRingHead, head + 1, __ATOMIC_RELEASE);
+    if(__atomic_load_n(&m_outRingTail, __ATOMIC_ACQUIRE) == head) xTaskNotifyGive(m_outTask); // the ring was empty
+    return true;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::outputFlush() {
+    // the consumer owns the tail, so it drops what is queued itself
+    if(!m_outTask) return;
+    m_f_outFlush = true;
+    xTaskNotifyGive(m_outTask);
+    uint32_t t = millis();
+    while(m_f_outFlush && millis() - t < 200) vTaskDelay(1);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::zeroOutput() {
+    outputFlush();
+    i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
+}
+//---------------------------------------------------------------------------------------------------------------------
 void Audio::loop() {
 
     if(!m_f_running) return;
@@ -2848,17 +2942,26 @@ void Audio::processLocalFile() {
     const uint32_t  maxFrameSize = InBuff.getMaxBlockSize();    // every mp3/aac frame is not bigger
     static bool f_stream;
     static bool f_fileDataComplete;
+    static bool f_refill;                                       // between the low and the high watermark
     static uint32_t byteCounter;                                // count received data
 
     if(m_f_firstCall) {  // runs only one time per connection, prepare for start
         m_f_firstCall = false;
         f_stream = false;
         f_fileDataComplete = false;
+        f_refill = true;
         byteCounter = 0;
         return;
     }
 
     uint32_t availableBytes = maxFrameSize * 4;
+    if(InBuff.havePSRAM()) {
+        // A large buffer is refilled in bursts once it has drained to a quarter, and left alone above three quarters;
+        // the card sees few long reads instead of a short one per frame, and most calls only decode.
+        if(InBuff.bufferFilled() < InBuff.getBufsize() / 4)     f_refill = true;
+        if(InBuff.bufferFilled() > InBuff.getBufsize() * 3 / 4) f_refill = false;
+        availableBytes = f_refill ? max(availableBytes, (uint32_t)AUDIO_PREFETCH_BURST) : 0;
+    }
     availableBytes = min(availableBytes, InBuff.writeSpace());
     availableBytes = min(availableBytes, audiofile.size() - byteCounter);
     if(m_contentlength){
@@ -2868,7 +2971,7 @@ void Audio::processLocalFile() {
         availableBytes = min(availableBytes, m_audioDataSize + m_audioDataStart - byteCounter);
     }
 
-    int32_t bytesAddedToBuffer = audiofile.read(InBuff.getWritePtr(), availableBytes);
+    int32_t bytesAddedToBuffer = availableBytes ? audiofile.read(InBuff.getWritePtr(), availableBytes) : 0;
 
     if(bytesAddedToBuffer > 0) {
         byteCounter += bytesAddedToBuffer;  // Pull request #42
@@ -3989,7 +4092,7 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     }
     if(ret < 0) { // Error, skip the frame...
         if(m_f_Log) if(m_codec == CODEC_M4A){log_i("begin not found"); return 1;}
-        i2s_zero_dma_buffer((i2s_port_t)m_i2s_num);
+        zeroOutput();
         if(!getChannels() && (ret == -2)) {
              ; // suppress errorcode MAINDATA_UNDERFLOW
         }
@@ -4387,6 +4490,7 @@ bool Audio::playSample(int16_t sample[2]) {
     if(m_f_internalDAC) {
         s32 += 0x80008000;
     }
+    if(m_outTask) return outputPush(s32);
     m_i2s_bytesWritten = 0;
     esp_err_t err = i2s_write((i2s_port_t) m_i2s_num, (const char*) &s32, sizeof(uint32_t), &m_i2s_bytesWritten, 100);
     if(err != ESP_OK) {
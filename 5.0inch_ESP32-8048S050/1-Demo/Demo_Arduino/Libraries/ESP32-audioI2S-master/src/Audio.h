@@ -134,6 +134,7 @@ public:
     uint32_t getReadPos();                      // read position relative to the beginning
     void     resetBuffer();                     // restore defaults
     bool     havePSRAM() { return m_f_psram; };
+    size_t   getBufsize() { return m_buffSize; };  // usable size, without the reserve
 
 protected:
     size_t   m_buffSizePSRAM    = 300000;   // most webstreams limit the advance to 100...300Kbytes
@@ -179,6 +180,7 @@ public:
     bool pauseResume();
     bool isRunning() {return m_f_running;}
     void loop();
+    bool startOutputTask(uint8_t core, UBaseType_t prio = 3, uint16_t ringFrames = 4096); // decoded samples go to I2S from a task of their own
     uint32_t stopSong();
     void forceMono(bool m);
     void setBalance(int8_t bal = 0);
@@ -224,6 +226,11 @@ private:
     void processWebStreamTS();
     void processWebStreamHLS();
     void playAudioData();
+    static void outputTask(void* arg);
+    void outputLoop();
+    bool outputPush(uint32_t s32);
+    void outputFlush();
+    void zeroOutput();
     bool readPlayListData();
     const char* parsePlaylist_M3U();
     const char* parsePlaylist_PLS();
@@ -553,6 +560,15 @@ private:
     int16_t         m_pidOfAAC;
     uint8_t         m_packetBuff[m_tsPacketSize];
     int16_t         m_pesDataLength = 0;
+
+    // decoder -> I2S ring, one producer (the task in loop()) and one consumer (outputTask)
+    uint32_t*       m_outRing = NULL;               // stereo frames as written to I2S
+    uint32_t        m_outRingMask = 0;              // frames - 1, frames is a power of 2
+    volatile uint32_t m_outRingHead = 0;            // free running, written by the producer only
+    volatile uint32_t m_outRingTail = 0;            // free running, written by the consumer only
+    volatile bool   m_f_outFlush = false;           // producer asks the consumer to drop the ring
+    volatile TaskHandle_t m_outWaiter = NULL;       // producer blocked on a full ring
+    TaskHandle_t    m_outTask = NULL;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
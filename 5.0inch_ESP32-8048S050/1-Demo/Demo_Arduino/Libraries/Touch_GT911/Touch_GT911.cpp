@@ -2,8 +2,14 @@
 #include <Touch_GT911.h>
 #include <Wire.h>
 
+#ifndef ARDUINO_ISR_ATTR
+#define ARDUINO_ISR_ATTR
+#endif
+
+Touch_GT911 *Touch_GT911::irqOwner = NULL;
+
 Touch_GT911::Touch_GT911(uint8_t _sda, uint8_t _scl, uint8_t _int, uint8_t _rst, uint16_t _width, uint16_t _height) :
-  pinSda(_sda), pinScl(_scl), pinRst(_rst), width(_width), height(_height) {
+  pinSda(_sda), pinScl(_scl), pinInt(_int), pinRst(_rst), width(_width), height(_height) {
 
 }
 
@@ -42,6 +48,30 @@ void Touch_GT911::reConfig() {
   writeByteData(GT911_CONFIG_CHKSUM, configBuf[GT911_CONFIG_CHKSUM-GT911_CONFIG_START]);
   writeByteData(GT911_CONFIG_FRESH, 1);
 }
+bool Touch_GT911::setOnRead(void (*isr)()) {
+  if (pinInt == GT911_PIN_NONE) {
+    return false;
+  }
+  onRead = isr;
+  irqOwner = this;
+  // Whatever is in the buffer now was reported before the edge we wait for
+  dataReady = true;
+  useInterrupt = true;
+  pinMode(pinInt, INPUT);
+  // The GT911 pulls INT low for every new report (default config: falling edge)
+  attachInterrupt(digitalPinToInterrupt(pinInt), handleInterrupt, FALLING);
+  return true;
+}
+bool Touch_GT911::available(void) {
+  return !useInterrupt || dataReady;
+}
+void ARDUINO_ISR_ATTR Touch_GT911::handleInterrupt(void) {
+  Touch_GT911 *ts = irqOwner;
+  ts->dataReady = true;
+  if (ts->onRead) {
+    ts->onRead();
+  }
+}
 void Touch_GT911::setRotation(uint8_t rot) {
   rotation = rot;
 }
@@ -54,22 +84,35 @@ void Touch_GT911::setResolution(uint16_t _width, uint16_t _height) {
 }
 
 void Touch_GT911::read(void) {
-  uint8_t data[7];
-  uint8_t id;
-  uint16_t x, y, size;
+  // Status and the first point in one burst, further points in a second
+  uint8_t data[1 + GT911_MAX_POINTS * GT911_POINT_SIZE];
+
+  if (useInterrupt) {
+    if (!dataReady) {
+      return;
+    }
+    // Cleared before the bus read, so an edge during it is not lost
+    dataReady = false;
+  }
 
-  uint8_t pointInfo = readByteData(GT911_POINT_INFO);
+  readBlockData(data, GT911_POINT_INFO, 1 + GT911_POINT_SIZE);
+  uint8_t pointInfo = data[0];
   uint8_t bufferStatus = pointInfo >> 7 & 1;
-  uint8_t proximityValid = pointInfo >> 5 & 1;
-  uint8_t haveKey = pointInfo >> 4 & 1;
+  if (bufferStatus == 0) {
+    // Nothing new since the last report, the last points stand
+    return;
+  }
   isLargeDetect = pointInfo >> 6 & 1;
   touches = pointInfo & 0xF;
+  if (touches > GT911_MAX_POINTS) {
+    touches = GT911_MAX_POINTS;
+  }
   isTouched = touches > 0;
-  if (bufferStatus == 1 && isTouched) {
-    for (uint8_t i=0; i<touches; i++) {
-      readBlockData(data, GT911_POINT_1 + i * 8, 7);
-      points[i] = readPoint(data);
-    }
+  if (touches > 1) {
+    readBlockData(data + 1 + GT911_POINT_SIZE, GT911_POINT_2, (touches - 1) * GT911_POINT_SIZE);
+  }
+  for (uint8_t i=0; i<touches; i++) {
+    points[i] = readPoint(data + 1 + i * GT911_POINT_SIZE);
   }
   writeByteData(GT911_POINT_INFO, 0);
 }
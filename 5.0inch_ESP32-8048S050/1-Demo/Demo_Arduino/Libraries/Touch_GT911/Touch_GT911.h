@@ -13,6 +13,8 @@
 #define ROTATION_RIGHT     (uint8_t)2
 #define ROTATION_NORMAL    (uint8_t)3
 
+#define GT911_PIN_NONE     (uint8_t)0xFF
+
 
 // Real-time command (Write only)
 #define GT911_COMMAND       (uint16_t)0x8040
@@ -77,6 +79,8 @@
 #define GT911_POINT_4           (uint16_t)0X8167
 #define GT911_POINT_5           (uint16_t)0X816F
 #define GT911_POINTS_REG        {GT911_POINT_1, GT911_POINT_2, GT911_POINT_3, GT911_POINT_4, GT911_POINT_5}
+#define GT911_POINT_SIZE        8
+#define GT911_MAX_POINTS        5
 
 class TPoint {
   public:
@@ -98,7 +102,11 @@ class Touch_GT911 {
     void begin(uint8_t _addr=GT911_ADDR1);
     void setRotation(uint8_t rot);
     void setResolution(uint16_t _width, uint16_t _height);
-    // void setOnRead(void (*isr)());
+    // Interrupt mode: read() only goes to the bus after the INT pin reported
+    // new data, and isr (may be NULL) runs from that interrupt. False when
+    // the board has no INT pin, polling mode then stays.
+    bool setOnRead(void (*isr)());
+    bool available(void);
     uint8_t getGesture(void);
     void read(void);
     uint8_t isLargeDetect;
@@ -108,6 +116,8 @@ class Touch_GT911 {
     TPoint points[5];
 
   private:
+    static void handleInterrupt(void);
+    static Touch_GT911 *irqOwner;
     void calculateChecksum();
     void reConfig();
     TPoint readPoint(uint8_t *data);
@@ -119,7 +129,11 @@ class Touch_GT911 {
     uint8_t addr;
     uint8_t pinSda;
     uint8_t pinScl;
+    uint8_t pinInt;
     uint8_t pinRst;
+    bool useInterrupt = false;
+    volatile bool dataReady = false;
+    void (*onRead)() = NULL;
     uint16_t width;
     uint16_t height;
     uint8_t configBuf[GT911_CONFIG_SIZE];
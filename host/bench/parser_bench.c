@@ -0,0 +1,688 @@
+/**
+ * @file parser_bench.c
+ * @brief Host micro-benchmarks for the telemetry and Home Assistant parsers
+ *
+ * Runs each parser of main/ over the same input until a time budget is
+ * spent and reports, per parsed line, frame or document:
+ *
+ *   ns/op      mean wall time
+ *   MB/s       input bytes over wall time
+ *   allocs/op  malloc/calloc/realloc calls
+ *   peak B     most heap bytes live above the starting level
+ *
+ * Workloads:
+ *   - telemetry JSON lines: streaming parser and the cJSON path, with the
+ *     tree on the heap and in a JSON arena
+ *   - telemetry binary frames: keyframe and delta decode
+ *   - /api/states documents of about 5 KB, 50 KB and 500 KB: the
+ *     streaming states parser fed in HTTP-sized chunks and the cJSON
+ *     parse, again on the heap and in an arena
+ *
+ * The states documents are generated with the shape and value mix of a
+ * real /api/states response. Recorded responses can be passed as extra
+ * arguments and are benchmarked the same way, looking up eight entity
+ * IDs spread through each file.
+ *
+ * Host timings do not transfer to the ESP32-S3 directly; they are meant
+ * for comparing parsers and catching regressions, the allocation counts
+ * transfer as they are.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "entity_states_parser.h"
+#include "esp_timer.h"
+#include "json_arena.h"
+#include "telemetry_frame.h"
+#include "telemetry_json.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define BENCH_BUDGET_US 300000   ///< Time spent per case after warm-up
+#define BENCH_MIN_ITERATIONS 20  ///< Even when a single run blows the budget
+#define BENCH_WARMUP_ITERATIONS 3
+
+#define TELEMETRY_LINE_COUNT 64   ///< Distinct lines cycled through
+#define STATES_LOOKUP_COUNT 8     ///< Entities looked up per document
+#define STATES_CHUNK_BYTES ENTITY_PARSER_CHUNK_BYTES
+
+// =======================================================================
+// ALLOCATION COUNTING
+// =======================================================================
+
+static bool counting = false;
+static uint64_t alloc_calls = 0;
+static int64_t live_bytes = 0;
+static int64_t peak_bytes = 0;
+
+#ifdef __GLIBC__
+#define BENCH_COUNTS_ALLOCATIONS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static void count_alloc(void *ptr, int64_t released)
+{
+  if (!counting)
+    return;
+  alloc_calls++;
+  live_bytes += (ptr ? (int64_t)malloc_usable_size(ptr) : 0) - released;
+  if (live_bytes > peak_bytes)
+    peak_bytes = live_bytes;
+}
+
+// Interposed for the whole process, so cJSON, the shims and libc itself are seen
+void *malloc(size_t size)
+{
+  void *ptr = __libc_malloc(size);
+  count_alloc(ptr, 0);
+  return ptr;
+}
+
+void *calloc(size_t n, size_t size)
+{
+  void *ptr = __libc_calloc(n, size);
+  count_alloc(ptr, 0);
+  return ptr;
+}
+
+void *realloc(void *old, size_t size)
+{
+  int64_t released = (counting && old) ? (int64_t)malloc_usable_size(old) : 0;
+  void *ptr = __libc_realloc(old, size);
+  count_alloc(ptr, ptr ? released : 0);
+  return ptr;
+}
+
+void free(void *ptr)
+{
+  if (counting && ptr)
+    live_bytes -= (int64_t)malloc_usable_size(ptr);
+  __libc_free(ptr);
+}
+#else
+#define BENCH_COUNTS_ALLOCATIONS 0
+#endif
+
+// =======================================================================
+// BENCHMARK RUNNER
+// =======================================================================
+
+typedef struct
+{
+  const char *name;
+  size_t bytes;          ///< Input bytes per operation
+  void (*run)(void *ctx); ///< One operation
+  void *ctx;
+} bench_case_t;
+
+static void run_case(const bench_case_t *bc)
+{
+  for (int i = 0; i < BENCH_WARMUP_ITERATIONS; i++)
+    bc->run(bc->ctx);
+
+  uint64_t iterations = 0;
+  int64_t op_peak = 0;
+  alloc_calls = 0;
+  live_bytes = 0;
+
+  int64_t start = esp_timer_get_time();
+  int64_t elapsed = 0;
+  while (elapsed < BENCH_BUDGET_US || iterations < BENCH_MIN_ITERATIONS)
+  {
+    int64_t base = live_bytes;
+    peak_bytes = base;
+    counting = true;
+    bc->run(bc->ctx);
+    counting = false;
+    if (peak_bytes - base > op_peak)
+      op_peak = peak_bytes - base;
+
+    iterations++;
+    elapsed = esp_timer_get_time() - start;
+  }
+
+  double ns_per_op = (double)elapsed * 1000.0 / (double)iterations;
+  double mb_per_s = (double)bc->bytes * (double)iterations / (double)elapsed;
+  if (BENCH_COUNTS_ALLOCATIONS)
+  {
+    printf("%-34s %9zu %9llu %12.0f %9.1f %10.1f %10lld\n", bc->name, bc->bytes, (unsigned long long)iterations,
+           ns_per_op, mb_per_s, (double)alloc_calls / (double)iterations, (long long)op_peak);
+  }
+  else
+  {
+    printf("%-34s %9zu %9llu %12.0f %9.1f %10s %10s\n", bc->name, bc->bytes, (unsigned long long)iterations,
+           ns_per_op, mb_per_s, "n/a", "n/a");
+  }
+}
+
+static void print_header(const char *title)
+{
+  printf("\n%s\n", title);
+  printf("%-34s %9s %9s %12s %9s %10s %10s\n", "case", "bytes", "iters", "ns/op", "MB/s", "allocs/op", "peak B");
+}
+
+// =======================================================================
+// TELEMETRY WORKLOADS
+// =======================================================================
+
+typedef struct
+{
+  char *lines[TELEMETRY_LINE_COUNT];
+  size_t lens[TELEMETRY_LINE_COUNT];
+  uint8_t *frames[TELEMETRY_LINE_COUNT];
+  size_t frame_lens[TELEMETRY_LINE_COUNT];
+  unsigned next;
+  system_data_t data;
+} telemetry_ctx_t;
+
+static const char *const cpu_names[] = {"Intel Core i9-13900K", "AMD Ryzen 9 7950X3D", "Intel Core i5-12400F"};
+static const char *const gpu_names[] = {"NVIDIA GeForce RTX 4080", "AMD Radeon RX 7900 XTX", "Intel Arc A770"};
+
+static void make_sample(unsigned i, system_data_t *s)
+{
+  memset(s, 0, sizeof(*s));
+  s->timestamp = 1760515200000ULL + (uint64_t)i * 1000;
+  s->cpu.usage = (uint8_t)(10 + (i * 37) % 85);
+  s->cpu.temp = (uint8_t)(40 + (i * 13) % 45);
+  s->cpu.fan = (uint16_t)(800 + (i * 97) % 1400);
+  snprintf(s->cpu.name, sizeof(s->cpu.name), "%s", cpu_names[i % 3]);
+  s->gpu.usage = (uint8_t)((i * 53) % 100);
+  s->gpu.temp = (uint8_t)(35 + (i * 7) % 50);
+  snprintf(s->gpu.name, sizeof(s->gpu.name), "%s", gpu_names[i % 3]);
+  s->gpu.mem_used = 1024 + (i * 331) % 14000;
+  s->gpu.mem_total = 16384;
+  s->mem.usage = (uint8_t)(30 + (i * 11) % 60);
+  s->mem.total = 31.9f;
+  s->mem.used = s->mem.total * s->mem.usage / 100.0f;
+  s->mem.avail = s->mem.total - s->mem.used;
+}
+
+static char *make_line(const system_data_t *s, size_t *len)
+{
+  char buf[512];
+  int n = snprintf(buf, sizeof(buf),
+                   "{\"ts\":%llu,"
+                   "\"cpu\":{\"usage\":%u,\"temp\":%u,\"fan\":%u,\"name\":\"%s\"},"
+                   "\"gpu\":{\"usage\":%u,\"temp\":%u,\"name\":\"%s\",\"mem_used\":%u,\"mem_total\":%u},"
+                   "\"mem\":{\"usage\":%u,\"used\":%.1f,\"total\":%.1f,\"avail\":%.1f}}",
+                   (unsigned long long)s->timestamp, s->cpu.usage, s->cpu.temp, s->cpu.fan, s->cpu.name,
+                   s->gpu.usage, s->gpu.temp, s->gpu.name, (unsigned)s->gpu.mem_used, (unsigned)s->gpu.mem_total,
+                   s->mem.usage, s->mem.used, s->mem.total, s->mem.avail);
+  *len = (size_t)n;
+  return strdup(buf);
+}
+
+// Payload writer, the same layout utils/telemetry_load_test.py sends
+typedef struct
+{
+  uint8_t buf[TELEMETRY_FRAME_MAX_PAYLOAD];
+  size_t len;
+} payload_t;
+
+static void put(payload_t *p, const void *bytes, size_t n)
+{
+  memcpy(p->buf + p->len, bytes, n);
+  p->len += n;
+}
+
+static void put_le(payload_t *p, uint64_t value, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    p->buf[p->len++] = (uint8_t)(value >> (8 * i));
+}
+
+static void put_f32(payload_t *p, float value)
+{
+  uint32_t raw;
+  memcpy(&raw, &value, sizeof(raw));
+  put_le(p, raw, 4);
+}
+
+static void put_string(payload_t *p, const char *s)
+{
+  size_t n = strlen(s);
+  put_le(p, n, 1);
+  put(p, s, n);
+}
+
+/**
+ * @brief Integer field, raw or as a zigzag varint difference to previous in a packed delta
+ */
+static void put_int(payload_t *p, bool packed, uint64_t value, uint64_t previous, size_t n)
+{
+  if (!packed)
+  {
+    put_le(p, value, n);
+    return;
+  }
+
+  // Wrap the difference to the field width, then sign extend it
+  unsigned shift = 64 - 8 * (unsigned)n;
+  int64_t diff = (int64_t)((value - previous) << shift) >> shift;
+  uint64_t zigzag = ((uint64_t)diff << 1) ^ (uint64_t)(diff >> 63);
+  do
+  {
+    p->buf[p->len++] = (uint8_t)((zigzag & 0x7F) | (zigzag > 0x7F ? 0x80 : 0));
+    zigzag >>= 7;
+  } while (zigzag);
+}
+
+static uint8_t *make_frame(const system_data_t *s, const system_data_t *prev, uint32_t fields, uint8_t msg_type,
+                           size_t *len)
+{
+  bool packed = msg_type == TELEMETRY_MSG_DELTA_PACKED;
+  payload_t p = {.len = 0};
+  put_le(&p, TELEMETRY_FRAME_VERSION, 1);
+  put_le(&p, msg_type, 1);
+  put_le(&p, fields, 2);
+  if (fields & TELEMETRY_FIELD_TIMESTAMP)
+    put_int(&p, packed, s->timestamp, prev->timestamp, 8);
+  if (fields & TELEMETRY_FIELD_CPU_USAGE)
+    put_int(&p, packed, s->cpu.usage, prev->cpu.usage, 1);
+  if (fields & TELEMETRY_FIELD_CPU_TEMP)
+    put_int(&p, packed, s->cpu.temp, prev->cpu.temp, 1);
+  if (fields & TELEMETRY_FIELD_CPU_FAN)
+    put_int(&p, packed, s->cpu.fan, prev->cpu.fan, 2);
+  if (fields & TELEMETRY_FIELD_CPU_NAME)
+    put_string(&p, s->cpu.name);
+  if (fields & TELEMETRY_FIELD_GPU_USAGE)
+    put_int(&p, packed, s->gpu.usage, prev->gpu.usage, 1);
+  if (fields & TELEMETRY_FIELD_GPU_TEMP)
+    put_int(&p, packed, s->gpu.temp, prev->gpu.temp, 1);
+  if (fields & TELEMETRY_FIELD_GPU_NAME)
+    put_string(&p, s->gpu.name);
+  if (fields & TELEMETRY_FIELD_GPU_MEM_USED)
+    put_int(&p, packed, s->gpu.mem_used, prev->gpu.mem_used, 4);
+  if (fields & TELEMETRY_FIELD_GPU_MEM_TOTAL)
+    put_int(&p, packed, s->gpu.mem_total, prev->gpu.mem_total, 4);
+  if (fields & TELEMETRY_FIELD_MEM_USAGE)
+    put_int(&p, packed, s->mem.usage, prev->mem.usage, 1);
+  if (fields & TELEMETRY_FIELD_MEM_USED)
+    put_f32(&p, s->mem.used);
+  if (fields & TELEMETRY_FIELD_MEM_TOTAL)
+    put_f32(&p, s->mem.total);
+  if (fields & TELEMETRY_FIELD_MEM_AVAIL)
+    put_f32(&p, s->mem.avail);
+  if (fields & TELEMETRY_FIELD_CPU_CORES)
+  {
+    put_le(&p, s->cpu.cores.count, 1);
+    put(&p, s->cpu.cores.value, s->cpu.cores.count);
+  }
+  put_le(&p, telemetry_frame_crc16(p.buf, p.len), 2);
+
+  // COBS, without the 0x00 delimiters the receiver strips
+  uint8_t *out = malloc(TELEMETRY_FRAME_MAX_ENCODED);
+  size_t code_pos = 0;
+  size_t out_len = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < p.len; i++)
+  {
+    if (p.buf[i] == 0)
+    {
+      out[code_pos] = code;
+      code_pos = out_len++;
+      code = 1;
+      continue;
+    }
+    out[out_len++] = p.buf[i];
+    if (++code == 0xFF)
+    {
+      out[code_pos] = code;
+      code_pos = out_len++;
+      code = 1;
+    }
+  }
+  out[code_pos] = code;
+  *len = out_len;
+  return out;
+}
+
+static void telemetry_ctx_init(telemetry_ctx_t *ctx, uint8_t msg_type)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  system_data_t prev;
+  make_sample(TELEMETRY_LINE_COUNT - 1, &prev);
+  // Packed deltas apply to the state the previous frame left, the last sample when the frames wrap around
+  ctx->data = prev;
+  for (unsigned i = 0; i < TELEMETRY_LINE_COUNT; i++)
+  {
+    system_data_t s;
+    make_sample(i, &s);
+    ctx->lines[i] = make_line(&s, &ctx->lens[i]);
+    uint32_t fields = msg_type == TELEMETRY_MSG_KEYFRAME ? SYSTEM_DATA_FIELD_ALL
+                                                         : telemetry_frame_diff(&prev, &s) | TELEMETRY_FIELD_TIMESTAMP;
+    ctx->frames[i] = make_frame(&s, &prev, fields, msg_type, &ctx->frame_lens[i]);
+    prev = s;
+  }
+}
+
+static size_t telemetry_mean(const size_t *lens)
+{
+  size_t total = 0;
+  for (unsigned i = 0; i < TELEMETRY_LINE_COUNT; i++)
+    total += lens[i];
+  return total / TELEMETRY_LINE_COUNT;
+}
+
+static void run_line_streaming(void *arg)
+{
+  telemetry_ctx_t *ctx = arg;
+  unsigned i = ctx->next++ % TELEMETRY_LINE_COUNT;
+  telemetry_json_parse(ctx->lines[i], ctx->lens[i], &ctx->data);
+}
+
+static void run_line_cjson(void *arg)
+{
+  telemetry_ctx_t *ctx = arg;
+  unsigned i = ctx->next++ % TELEMETRY_LINE_COUNT;
+  telemetry_json_parse_cjson(ctx->lines[i], ctx->lens[i], &ctx->data);
+}
+
+static void run_frame_decode(void *arg)
+{
+  telemetry_ctx_t *ctx = arg;
+  unsigned i = ctx->next++ % TELEMETRY_LINE_COUNT;
+  uint8_t msg_type;
+  telemetry_frame_decode(ctx->frames[i], ctx->frame_lens[i], &ctx->data, &msg_type);
+}
+
+// =======================================================================
+// HOME ASSISTANT STATES WORKLOADS
+// =======================================================================
+
+typedef struct
+{
+  char name[64];
+  char *json;
+  size_t len;
+  const char *ids[STATES_LOOKUP_COUNT];
+  int id_count;
+  ha_entity_state_t states[STATES_LOOKUP_COUNT];
+  entity_stream_parser_t parser;
+  int found;
+} states_ctx_t;
+
+typedef struct
+{
+  char *buf;
+  size_t len;
+  size_t size;
+} text_t;
+
+static void text_append(text_t *t, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void text_append(text_t *t, const char *format, ...)
+{
+  for (;;)
+  {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(t->buf + t->len, t->size - t->len, format, args);
+    va_end(args);
+    if ((size_t)n < t->size - t->len)
+    {
+      t->len += (size_t)n;
+      return;
+    }
+    t->size = t->size * 2 + (size_t)n;
+    t->buf = realloc(t->buf, t->size);
+  }
+}
+
+static const char *const rooms[] = {"living_room", "kitchen", "bedroom", "office", "hallway", "garage", "bathroom"};
+
+// One entity in the shape and size HA 2024+ returns it, picked by index
+static void append_entity(text_t *t, unsigned i)
+{
+  const char *room = rooms[i % 7];
+  unsigned sec = (i * 7919) % 86400;
+  char stamp[40];
+  snprintf(stamp, sizeof(stamp), "2026-10-15T%02u:%02u:%02u.%06u+00:00", sec / 3600, sec / 60 % 60, sec % 60,
+           (i * 104729) % 1000000);
+  char context[160];
+  snprintf(context, sizeof(context), "\"context\":{\"id\":\"01JA%08X%014u\",\"parent_id\":null,\"user_id\":null}",
+           i * 2654435761u, i);
+
+  if (i > 0)
+    text_append(t, ",");
+
+  switch (i % 5)
+  {
+  case 0:
+    text_append(t,
+                "{\"entity_id\":\"switch.%s_%u\",\"state\":\"%s\",\"attributes\":{\"friendly_name\":"
+                "\"%s Switch %u\"},\"last_changed\":\"%s\",\"last_reported\":\"%s\",\"last_updated\":\"%s\",%s}",
+                room, i, (i & 8) ? "on" : "off", room, i, stamp, stamp, stamp, context);
+    break;
+  case 1:
+    text_append(t,
+                "{\"entity_id\":\"sensor.%s_temperature_%u\",\"state\":\"%u.%u\",\"attributes\":{\"state_class\":"
+                "\"measurement\",\"unit_of_measurement\":\"\\u00b0C\",\"device_class\":\"temperature\","
+                "\"friendly_name\":\"%s Temperature %u\"},\"last_changed\":\"%s\",\"last_reported\":\"%s\","
+                "\"last_updated\":\"%s\",%s}",
+                room, i, 18 + i % 7, i % 10, room, i, stamp, stamp, stamp, context);
+    break;
+  case 2:
+    text_append(t,
+                "{\"entity_id\":\"light.%s_%u\",\"state\":\"%s\",\"attributes\":{\"min_color_temp_kelvin\":2202,"
+                "\"max_color_temp_kelvin\":6535,\"min_mireds\":153,\"max_mireds\":454,\"effect_list\":[\"None\","
+                "\"candle\",\"fireplace\",\"colorloop\"],\"supported_color_modes\":[\"color_temp\",\"xy\"],"
+                "\"color_mode\":\"xy\",\"brightness\":%u,\"hs_color\":[%u.0,%u.5],\"rgb_color\":[255,%u,%u],"
+                "\"xy_color\":[0.%04u,0.%04u],\"effect\":\"None\",\"friendly_name\":\"%s Light %u\","
+                "\"supported_features\":44},\"last_changed\":\"%s\",\"last_reported\":\"%s\","
+                "\"last_updated\":\"%s\",%s}",
+                room, i, (i & 4) ? "on" : "off", i % 255, i % 360, i % 100, i % 256, (i * 3) % 256,
+                (i * 37) % 10000, (i * 91) % 10000, room, i, stamp, stamp, stamp, context);
+    break;
+  case 3:
+    text_append(t,
+                "{\"entity_id\":\"binary_sensor.%s_motion_%u\",\"state\":\"%s\",\"attributes\":{\"device_class\":"
+                "\"motion\",\"friendly_name\":\"%s Motion %u\"},\"last_changed\":\"%s\",\"last_reported\":\"%s\","
+                "\"last_updated\":\"%s\",%s}",
+                room, i, (i & 2) ? "on" : "off", room, i, stamp, stamp, stamp, context);
+    break;
+  default:
+    text_append(t,
+                "{\"entity_id\":\"sensor.%s_power_%u\",\"state\":\"%s\",\"attributes\":{\"state_class\":"
+                "\"measurement\",\"unit_of_measurement\":\"W\",\"device_class\":\"power\",\"friendly_name\":"
+                "\"%s Power \\\"%u\\\"\"},\"last_changed\":\"%s\",\"last_reported\":\"%s\",\"last_updated\":\"%s\",%s}",
+                room, i, (i % 11) ? "42.7" : "unavailable", room, i, stamp, stamp, stamp, context);
+    break;
+  }
+}
+
+static char *make_states(size_t target, size_t *len)
+{
+  text_t t = {.buf = malloc(target + 1024), .len = 0, .size = target + 1024};
+  text_append(&t, "[");
+  for (unsigned i = 0; t.len < target; i++)
+    append_entity(&t, i);
+  text_append(&t, "]");
+  *len = t.len;
+  return t.buf;
+}
+
+// Looks up IDs spread evenly through the document, the last entity included
+static void pick_entity_ids(states_ctx_t *ctx)
+{
+  static const char marker[] = "\"entity_id\":\"";
+  size_t total = 0;
+  for (const char *p = ctx->json; (p = strstr(p, marker)) != NULL; p += sizeof(marker) - 1)
+    total++;
+
+  ctx->id_count = 0;
+  if (total == 0)
+    return;
+
+  size_t want = total < STATES_LOOKUP_COUNT ? total : STATES_LOOKUP_COUNT;
+  size_t index = 0;
+  for (const char *p = ctx->json; (p = strstr(p, marker)) != NULL && ctx->id_count < (int)want; index++)
+  {
+    p += sizeof(marker) - 1;
+    size_t pick = want > 1 ? (total - 1) * (size_t)ctx->id_count / (want - 1) : 0;
+    if (index != pick)
+      continue;
+    const char *end = strchr(p, '"');
+    ctx->ids[ctx->id_count++] = strndup(p, end ? (size_t)(end - p) : 0);
+  }
+}
+
+static void run_states_streaming(void *arg)
+{
+  states_ctx_t *ctx = arg;
+  entity_states_stream_begin(&ctx->parser, ctx->ids, ctx->id_count, ctx->states);
+  for (size_t pos = 0; pos < ctx->len; pos += STATES_CHUNK_BYTES)
+  {
+    size_t n = ctx->len - pos < STATES_CHUNK_BYTES ? ctx->len - pos : STATES_CHUNK_BYTES;
+    entity_states_stream_feed(&ctx->parser, ctx->json + pos, n);
+  }
+  entity_states_stream_finish(&ctx->parser);
+  ctx->found = ctx->parser.found_count;
+}
+
+static void run_states_cjson(void *arg)
+{
+  states_ctx_t *ctx = arg;
+  entity_states_parser_parse_sync(ctx->json, ctx->ids, ctx->id_count, ctx->states);
+  ctx->found = 0;
+  for (int i = 0; i < ctx->id_count; i++)
+    ctx->found += ctx->states[i].found ? 1 : 0;
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *buf = malloc((size_t)size + 1);
+  if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size)
+  {
+    free(buf);
+    buf = NULL;
+  }
+  fclose(f);
+  if (buf)
+  {
+    buf[size] = '\0';
+    *len = (size_t)size;
+  }
+  return buf;
+}
+
+// =======================================================================
+// MAIN
+// =======================================================================
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))
+  {
+    printf("usage: %s [recorded-states.json ...]\n", argv[0]);
+    return 0;
+  }
+
+  // Telemetry
+  static telemetry_ctx_t keyframes;
+  static telemetry_ctx_t deltas;
+  static telemetry_ctx_t packed;
+  telemetry_ctx_init(&keyframes, TELEMETRY_MSG_KEYFRAME);
+  telemetry_ctx_init(&deltas, TELEMETRY_MSG_DELTA);
+  telemetry_ctx_init(&packed, TELEMETRY_MSG_DELTA_PACKED);
+
+  // States documents, generated and recorded
+  int doc_count = 3 + (argc - 1);
+  states_ctx_t *docs = calloc((size_t)doc_count, sizeof(states_ctx_t));
+  static const size_t sizes[] = {5 * 1024, 50 * 1024, 500 * 1024};
+  int loaded = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    docs[loaded].json = make_states(sizes[i], &docs[loaded].len);
+    snprintf(docs[loaded].name, sizeof(docs[loaded].name), "states %zu KB", sizes[i] / 1024);
+    loaded++;
+  }
+  for (int i = 1; i < argc; i++)
+  {
+    docs[loaded].json = read_file(argv[i], &docs[loaded].len);
+    if (!docs[loaded].json)
+    {
+      fprintf(stderr, "cannot read %s\n", argv[i]);
+      continue;
+    }
+    const char *base = strrchr(argv[i], '/');
+    snprintf(docs[loaded].name, sizeof(docs[loaded].name), "%.40s", base ? base + 1 : argv[i]);
+    loaded++;
+  }
+  for (int i = 0; i < loaded; i++)
+    pick_entity_ids(&docs[i]);
+
+  if (!BENCH_COUNTS_ALLOCATIONS)
+    printf("Allocation counting needs glibc, allocs/op and peak B are not reported\n");
+
+  // Heap-backed cJSON first, json_arena_init() installs the arena hooks for good
+  print_header("Telemetry (per line or frame)");
+  bench_case_t line_cases[] = {
+      {"json line, streaming", telemetry_mean(keyframes.lens), run_line_streaming, &keyframes},
+      {"json line, cJSON heap", telemetry_mean(keyframes.lens), run_line_cjson, &keyframes},
+      {"binary keyframe, decode", telemetry_mean(keyframes.frame_lens), run_frame_decode, &keyframes},
+      {"binary delta, decode", telemetry_mean(deltas.frame_lens), run_frame_decode, &deltas},
+      {"binary packed delta, decode", telemetry_mean(packed.frame_lens), run_frame_decode, &packed},
+  };
+  for (size_t i = 0; i < sizeof(line_cases) / sizeof(line_cases[0]); i++)
+    run_case(&line_cases[i]);
+
+  print_header("Home Assistant /api/states (per document)");
+  for (int i = 0; i < loaded; i++)
+  {
+    char name[96];
+    snprintf(name, sizeof(name), "%s, streaming", docs[i].name);
+    run_case(&(bench_case_t){name, docs[i].len, run_states_streaming, &docs[i]});
+    int streaming_found = docs[i].found;
+
+    snprintf(name, sizeof(name), "%s, cJSON heap", docs[i].name);
+    run_case(&(bench_case_t){name, docs[i].len, run_states_cjson, &docs[i]});
+    if (docs[i].found != streaming_found)
+    {
+      printf("  ! %s: streaming found %d of %d entities, cJSON %d\n", docs[i].name, streaming_found,
+             docs[i].id_count, docs[i].found);
+    }
+  }
+
+  if (json_arena_init() != ESP_OK)
+  {
+    fprintf(stderr, "json_arena_init failed\n");
+    return 1;
+  }
+
+  // Documents larger than JSON_ARENA_LARGE_SIZE / JSON_ARENA_TREE_FACTOR get no arena and show heap numbers
+  print_header("cJSON with JSON arenas");
+  run_case(&(bench_case_t){"json line, cJSON arena", telemetry_mean(keyframes.lens), run_line_cjson, &keyframes});
+  for (int i = 0; i < loaded; i++)
+  {
+    char name[96];
+    snprintf(name, sizeof(name), "%s, cJSON arena", docs[i].name);
+    run_case(&(bench_case_t){name, docs[i].len, run_states_cjson, &docs[i]});
+  }
+
+  return 0;
+}
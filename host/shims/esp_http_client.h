@@ -0,0 +1,9 @@
+/**
+ * @file esp_http_client.h
+ * @brief Host build stand-in, ha_api.h includes it but the parsers use no HTTP types
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
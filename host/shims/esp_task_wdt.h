@@ -0,0 +1,16 @@
+/**
+ * @file esp_task_wdt.h
+ * @brief Host build stand-in for the task watchdog, there is nothing to feed
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+static inline esp_err_t esp_task_wdt_reset(void)
+{
+  return ESP_OK;
+}
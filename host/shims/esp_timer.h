@@ -0,0 +1,16 @@
+/**
+ * @file esp_timer.h
+ * @brief Host build stand-in for esp_timer, backed by CLOCK_MONOTONIC
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Microseconds since an arbitrary fixed point
+ */
+int64_t esp_timer_get_time(void);
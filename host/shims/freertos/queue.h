@@ -0,0 +1,41 @@
+/**
+ * @file queue.h
+ * @brief Host build stand-in for FreeRTOS queues, creation always fails
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  (void)length;
+  (void)item_size;
+  return NULL;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+  (void)queue;
+  (void)item;
+  (void)wait;
+  return pdFAIL;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+  (void)queue;
+  (void)item;
+  (void)wait;
+  return pdFAIL;
+}
+
+static inline void vQueueDelete(QueueHandle_t queue)
+{
+  (void)queue;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file semphr.h
+ * @brief Host build stand-in for FreeRTOS semaphores, creation always fails
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return NULL;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+  return NULL;
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+  (void)sem;
+  (void)wait;
+  return pdFAIL;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+  (void)sem;
+  return pdFAIL;
+}
+
+static inline void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+  (void)sem;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file task.h
+ * @brief Host build stand-in for FreeRTOS tasks, creation always fails
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+/**
+ * @brief Handle of the only task there is, never NULL
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+  (void)ticks;
+}
+
+static inline void vTaskDelete(TaskHandle_t task)
+{
+  (void)task;
+}
+
+static inline TickType_t xTaskGetTickCount(void)
+{
+  return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file host_shims.c
+ * @brief Host build implementations of the ESP-IDF and firmware services
+ *        the shared parsing modules call
+ *
+ * Logging, metrics and task creation are no-ops so that a benchmark run
+ * measures parsing only. Set HOST_SHIMS_LOG=1 in the environment to see
+ * the firmware's log lines on stderr.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "system_debug_utils.h"
+#include "task_stack.h"
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void host_log(debug_tag_t tag, const char *level, const char *format, va_list args)
+{
+  static int enabled = -1;
+  if (enabled < 0)
+  {
+    const char *env = getenv("HOST_SHIMS_LOG");
+    enabled = env && env[0] == '1';
+  }
+  if (!enabled)
+    return;
+
+  fprintf(stderr, "%s (%d) ", level, (int)tag);
+  vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+}
+
+#define HOST_LOG_FORMAT(tag, level, format)                                         \
+  do                                                                                \
+  {                                                                                 \
+    va_list args;                                                                   \
+    va_start(args, format);                                                         \
+    host_log((tag), (level), (format), args);                                       \
+    va_end(args);                                                                   \
+  } while (0)
+
+static void host_log_text(debug_tag_t tag, const char *level, const char *format, ...)
+{
+  HOST_LOG_FORMAT(tag, level, format);
+}
+
+// =======================================================================
+// ESP-IDF
+// =======================================================================
+
+int64_t esp_timer_get_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+  switch (code)
+  {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_INVALID_SIZE:
+    return "ESP_ERR_INVALID_SIZE";
+  case ESP_ERR_NOT_FOUND:
+    return "ESP_ERR_NOT_FOUND";
+  case ESP_ERR_NOT_SUPPORTED:
+    return "ESP_ERR_NOT_SUPPORTED";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  case ESP_ERR_INVALID_RESPONSE:
+    return "ESP_ERR_INVALID_RESPONSE";
+  case ESP_ERR_INVALID_CRC:
+    return "ESP_ERR_INVALID_CRC";
+  default:
+    return "UNKNOWN ERROR";
+  }
+}
+
+// =======================================================================
+// FREERTOS
+// =======================================================================
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  static int main_task;
+  return &main_task;
+}
+
+BaseType_t task_stack_create(TaskFunction_t task, const char *name, uint32_t stack_size, void *arg,
+                             UBaseType_t priority, TaskHandle_t *handle, BaseType_t core_id)
+{
+  (void)task;
+  (void)name;
+  (void)stack_size;
+  (void)arg;
+  (void)priority;
+  (void)core_id;
+  if (handle)
+    *handle = NULL;
+  return pdFAIL;
+}
+
+void task_stack_delete(TaskHandle_t handle)
+{
+  (void)handle;
+}
+
+// =======================================================================
+// METRICS
+// =======================================================================
+
+void metrics_register(metric_t *metric)
+{
+  (void)metric;
+}
+
+void metrics_histogram_observe(metric_histogram_t *histogram, uint32_t value)
+{
+  (void)histogram;
+  (void)value;
+}
+
+// =======================================================================
+// DEBUG LOGGING
+// =======================================================================
+
+void debug_log_startup(debug_tag_t tag, const char *component_name)
+{
+  host_log_text(tag, "I", "%s started", component_name);
+}
+
+void debug_log_error(debug_tag_t tag, const char *error_msg)
+{
+  host_log_text(tag, "E", "%s", error_msg);
+}
+
+void debug_log_event(debug_tag_t tag, const char *event_msg)
+{
+  host_log_text(tag, "I", "%s", event_msg);
+}
+
+void debug_log_info(debug_tag_t tag, const char *info_msg)
+{
+  host_log_text(tag, "I", "%s", info_msg);
+}
+
+void debug_log_warning(debug_tag_t tag, const char *warning_msg)
+{
+  host_log_text(tag, "W", "%s", warning_msg);
+}
+
+void debug_log_debug(debug_tag_t tag, const char *debug_msg)
+{
+  host_log_text(tag, "D", "%s", debug_msg);
+}
+
+void debug_log_info_f(debug_tag_t tag, const char *format, ...)
+{
+  HOST_LOG_FORMAT(tag, "I", format);
+}
+
+void debug_log_error_f(debug_tag_t tag, const char *format, ...)
+{
+  HOST_LOG_FORMAT(tag, "E", format);
+}
+
+void debug_log_warning_f(debug_tag_t tag, const char *format, ...)
+{
+  HOST_LOG_FORMAT(tag, "W", format);
+}
+
+void debug_log_debug_f(debug_tag_t tag, const char *format, ...)
+{
+  HOST_LOG_FORMAT(tag, "D", format);
+}
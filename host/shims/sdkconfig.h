@@ -0,0 +1,13 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host build stand-in for the generated ESP-IDF configuration
+ *
+ * Every option is left undefined, which compiles the optional paths
+ * (split parse worker, trace spans, debug log ring) out, the same as a
+ * default firmware build with those features off.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
@@ -4,12 +4,14 @@
  *
  * This header contains data structures that are shared between modules
  * but doesn't include any module-specific headers to maintain decoupling.
+ * The structs and field bits are expanded from telemetry_schema.h.
  */
 
 #ifndef DASHBOARD_DATA_H
 #define DASHBOARD_DATA_H
 
 #include <stdint.h>
+#include "telemetry_schema.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -20,16 +22,20 @@ extern "C"
   // DATA STRUCTURES
   // =======================================================================
 
+  // Members of the section structs, generated from telemetry_schema.h in schema order
+#define DASHBOARD_DATA_MEMBER(WANT, ID, SECTION, field, key, TYPE, unit, history, ui) \
+  TELEMETRY_IF_SECTION(SECTION, WANT, TELEMETRY_CTYPE_##TYPE field TELEMETRY_EXTENT_##TYPE;)
+#define DASHBOARD_DATA_ROOT_MEMBER(...) DASHBOARD_DATA_MEMBER(ROOT, __VA_ARGS__)
+#define DASHBOARD_DATA_CPU_MEMBER(...) DASHBOARD_DATA_MEMBER(CPU, __VA_ARGS__)
+#define DASHBOARD_DATA_GPU_MEMBER(...) DASHBOARD_DATA_MEMBER(GPU, __VA_ARGS__)
+#define DASHBOARD_DATA_MEM_MEMBER(...) DASHBOARD_DATA_MEMBER(MEM, __VA_ARGS__)
+
   /**
    * @brief CPU monitoring data structure
    */
   struct cpu_info
   {
-    uint8_t usage; ///< CPU usage percentage (0-100)
-    uint8_t temp;  ///< CPU temperature in Celsius
-    uint32_t freq; ///< CPU frequency in MHz
-    uint16_t fan;  ///< CPU fan speed in RPM
-    char name[32]; ///< CPU name/model string
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_CPU_MEMBER)
   };
 
   /**
@@ -37,11 +43,7 @@ extern "C"
    */
   struct gpu_info
   {
-    uint8_t usage;      ///< GPU usage percentage (0-100)
-    uint8_t temp;       ///< GPU temperature in Celsius
-    char name[32];      ///< GPU name/model string
-    uint32_t mem_used;  ///< GPU memory used (MB)
-    uint32_t mem_total; ///< GPU memory total (MB)
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_GPU_MEMBER)
   };
 
   /**
@@ -49,25 +51,22 @@ extern "C"
    */
   struct memory_info
   {
-    uint8_t usage; ///< Memory usage percentage (0-100)
-    float used;    ///< Memory used (GB)
-    float total;   ///< Memory total (GB)
-    float avail;   ///< Memory available (GB)
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_MEM_MEMBER)
   };
 
   /**
    * @brief System monitoring data structure
    *
-   * Contains all system metrics received via JSON from serial port:
-   * - Timestamp for data freshness tracking
-   * - CPU usage, temperature, and identification
+   * Contains all system metrics received from the host, one member per
+   * telemetry_schema.h entry:
+   * - Timestamp for data freshness tracking (milliseconds since epoch)
+   * - CPU usage, temperature, identification and per-core usage
    * - GPU usage, temperature, memory, and identification
    * - System memory usage and availability
    */
   typedef struct system_data
   {
-    // Timestamp (milliseconds since epoch)
-    uint64_t timestamp;
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_ROOT_MEMBER)
 
     // CPU Information Section
     struct cpu_info cpu;
@@ -79,6 +78,34 @@ extern "C"
     struct memory_info mem;
   } system_data_t;
 
+#undef DASHBOARD_DATA_MEMBER
+#undef DASHBOARD_DATA_ROOT_MEMBER
+#undef DASHBOARD_DATA_CPU_MEMBER
+#undef DASHBOARD_DATA_GPU_MEMBER
+#undef DASHBOARD_DATA_MEM_MEMBER
+
+  // =======================================================================
+  // FIELD MASK
+  // =======================================================================
+
+  // One bit per schema entry in schema order, used for change masks and frame bitmaps
+  enum
+  {
+#define DASHBOARD_DATA_FIELD_INDEX(ID, ...) SYSTEM_DATA_FIELD_INDEX_##ID,
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_FIELD_INDEX)
+#undef DASHBOARD_DATA_FIELD_INDEX
+    SYSTEM_DATA_FIELD_COUNT
+  };
+
+  enum
+  {
+#define DASHBOARD_DATA_FIELD_BIT(ID, ...) SYSTEM_DATA_FIELD_##ID = 1u << SYSTEM_DATA_FIELD_INDEX_##ID,
+    TELEMETRY_SCHEMA(DASHBOARD_DATA_FIELD_BIT)
+#undef DASHBOARD_DATA_FIELD_BIT
+  };
+
+#define SYSTEM_DATA_FIELD_ALL ((1u << SYSTEM_DATA_FIELD_COUNT) - 1)
+
 #ifdef __cplusplus
 }
 #endif
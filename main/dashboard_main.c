@@ -1,158 +1,828 @@
-#include <stdio.h>
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/timers.h"
-#include "lvgl.h"
-#include "lvgl/lvgl_setup.h"
-#include "serial/serial_data_handler.h"
-#include "smart/ha_status.h"
-#include "smart/smart_home.h"
-#include "ui/ui_controls_panel.h"
-#include "ui/ui_dashboard.h"
-#include "ui/ui_status_info.h"
-#include "utils/system_debug_utils.h"
-#include "utils/crash_handler.h"
-#include "wifi/wifi_manager.h"
-#include "nvs_flash.h"
-
-// LVGL task handles all timer processing automatically
-static esp_lcd_panel_handle_t global_panel_handle = NULL;
-static TimerHandle_t runtime_timer = NULL;
-static uint32_t runtime_seconds = 0;
-
-// No additional display monitoring needed
-
-static void runtime_timer_callback(TimerHandle_t xTimer)
-{
-  runtime_seconds++;
-  status_info_update_runtime(runtime_seconds);
-}
-
-static void init_runtime_timer(void)
-{
-  // Create and start runtime timer (1 second interval)
-  runtime_timer = xTimerCreate(
-      "RuntimeTimer",
-      pdMS_TO_TICKS(1000), // 1 second interval
-      pdTRUE,              // Auto-reload
-      NULL,                // Timer ID (not used)
-      runtime_timer_callback);
-
-  if (runtime_timer != NULL)
-  {
-    xTimerStart(runtime_timer, 0);
-    debug_log_info(DEBUG_TAG_SYSTEM, "Runtime timer started");
-  }
-  else
-  {
-    debug_log_error(DEBUG_TAG_SYSTEM, "Failed to create runtime timer");
-  }
-}
-
-static void wifi_status_callback(bool is_connected, const char *status_text, wifi_status_t status, const wifi_info_t *info)
-{
-  status_info_update_wifi_status(status_text, is_connected);
-}
-
-static void wifi_connected_callback(void)
-{
-  smart_home_init();
-}
-
-static void serial_connection_status_callback(bool connected)
-{
-  status_info_update_serial_status(connected);
-
-  // Reset dashboard to default values when serial connection is lost
-  if (!connected)
-  {
-    ui_dashboard_reset_to_defaults();
-  }
-}
-
-static void serial_data_update_callback(const system_data_t *data)
-{
-  ui_dashboard_update(data);
-}
-
-void ha_status_change_callback(bool is_ready, bool is_syncing, const char *status_text)
-{
-  controls_panel_update_ha_status(is_ready, is_syncing, status_text);
-}
-
-static void smart_home_states_sync_callback(bool switch_states[3], int state_count)
-{
-  // Update UI controls based on sync states
-  if (state_count >= 3)
-  {
-    controls_panel_set_switch(0, switch_states[0]); // SWITCH_A = 0
-    controls_panel_set_switch(1, switch_states[1]); // SWITCH_B = 1
-    controls_panel_set_switch(2, switch_states[2]); // SWITCH_C = 2
-  }
-}
-
-void app_main(void)
-{
-  debug_log_startup(DEBUG_TAG_SYSTEM, "Dashboard");
-
-  // Initialize NVS first for crash log storage
-  esp_err_t ret = nvs_flash_init();
-  if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
-  {
-    ESP_ERROR_CHECK(nvs_flash_erase());
-    ret = nvs_flash_init();
-  }
-  ESP_ERROR_CHECK(ret);
-
-  // Initialize crash handler early to capture any startup crashes
-  ESP_ERROR_CHECK(crash_handler_init());
-
-  // Register smart home callbacks BEFORE creating UI
-  // This ensures callbacks are available when controls are created
-  smart_home_callbacks_t callbacks = {
-      .switch_callback = smart_home_control_switch,
-      .scene_callback = smart_home_trigger_scene};
-  ui_dashboard_register_smart_home_callbacks(&callbacks);
-
-  // Initialize LVGL
-  lvgl_setup_init_backlight();
-  lvgl_setup_set_backlight(LCD_BK_LIGHT_OFF_LEVEL);
-
-  esp_lcd_panel_handle_t panel_handle = lvgl_setup_create_lcd_panel();
-  global_panel_handle = panel_handle;
-
-  lvgl_setup_set_backlight(LCD_BK_LIGHT_ON_LEVEL);
-  lv_display_t *display = lvgl_setup_init(panel_handle);
-  lvgl_setup_init_touch();
-  lvgl_setup_create_ui_safe(display, ui_dashboard_create);
-  lvgl_setup_start_task();
-
-  // Initialize Wi-Fi manager
-  ESP_ERROR_CHECK(wifi_manager_init());
-  wifi_manager_register_status_callback(wifi_status_callback);
-  wifi_manager_register_connected_callback(wifi_connected_callback);
-
-  // Initialize Serial Data
-  ESP_ERROR_CHECK(serial_data_init());
-  serial_data_register_connection_callback(serial_connection_status_callback);
-  serial_data_register_data_callback(serial_data_update_callback);
-  serial_data_start_task();
-
-  // Register Smart Home callbacks
-  smart_home_register_states_sync_callback(smart_home_states_sync_callback);
-
-  // Initialize runtime timer
-  init_runtime_timer();
-
-  // Note: smart_home_init() will be called from wifi_connected_callback()
-  // and will initialize ha_status_init(). We'll register the callback
-  // from within the smart home module to ensure proper timing.
-
-  debug_log_startup(DEBUG_TAG_SYSTEM, "System Monitor - Fully Initialized");
-
-  while (1)
-  {
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-  }
-}
+#include <stdio.h>
+#include <string.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "lvgl.h"
+#include "lvgl/boot_splash.h"
+#include "lvgl/display_activity.h"
+#include "lvgl/lvgl_lock_prof.h"
+#include "lvgl/lvgl_setup.h"
+#include "lvgl/lvgl_stall.h"
+#include "lvgl/screen_capture.h"
+#include "serial/serial_baud.h"
+#include "serial/serial_data_handler.h"
+#include "serial/telemetry_alerts.h"
+#include "serial/telemetry_clock.h"
+#include "serial/telemetry_rate.h"
+#include "serial/telemetry_export.h"
+#include "serial/telemetry_history.h"
+#include "serial/telemetry_net.h"
+#include "serial/telemetry_relay.h"
+#include "serial/telemetry_sd_log.h"
+#include "smart/ha_camera.h"
+#include "smart/ha_entity_icons.h"
+#include "smart/ha_entity_registry.h"
+#include "smart/ha_http_cache.h"
+#include "smart/ha_outbox.h"
+#include "smart/ha_shortcuts.h"
+#include "smart/ha_latency_test.h"
+#include "smart/ha_metrics.h"
+#include "smart/ha_mqtt.h"
+#include "smart/ha_servers.h"
+#include "smart/ha_share.h"
+#include "smart/ha_status.h"
+#include "smart/ha_websocket.h"
+#include "smart/smart_home.h"
+#include "touch/gt911_config.h"
+#include "touch/gt911_filter.h"
+#include "touch/gt911_gesture.h"
+#include "touch/gt911_touch.h"
+#include "touch/touch_feedback.h"
+#include "touch/touch_inject.h"
+#include "ui/ui_alerts.h"
+#include "ui/ui_benchmark.h"
+#include "ui/ui_controls_panel.h"
+#include "ui/ui_dashboard.h"
+#include "ui/ui_layout.h"
+#include "ui/ui_lvgl_benchmark.h"
+#include "ui/ui_night_page.h"
+#include "ui/ui_pages.h"
+#include "ui/ui_safe_mode.h"
+#include "ui/ui_sensor_page.h"
+#include "ui/ui_state_cache.h"
+#include "ui/ui_status_info.h"
+#include "utils/alert_audio.h"
+#include "utils/asset_pack.h"
+#include "utils/boot_graph.h"
+#include "utils/cpu_power.h"
+#include "utils/cycle_prof.h"
+#include "utils/deferred_init.h"
+#include "utils/diag_http.h"
+#include "utils/event_bus.h"
+#include "utils/heap_monitor.h"
+#include "utils/mem_governor.h"
+#include "utils/metrics.h"
+#include "utils/nvs_store.h"
+#include "utils/safe_mode.h"
+#include "utils/task_plan.h"
+#include "utils/task_profiler.h"
+#include "utils/trace_spans.h"
+#include "utils/system_debug_utils.h"
+#include "utils/crash_handler.h"
+#include "utils/crash_log_manager.h"
+#include "utils/json_arena.h"
+#include "utils/touch_latency.h"
+#include "wifi/ota_update.h"
+#include "wifi/wifi_link_monitor.h"
+#include "wifi/wifi_manager.h"
+#include "wifi/wifi_power_policy.h"
+#include "wifi/wifi_time_sync.h"
+#include "nvs_flash.h"
+
+// LVGL task handles all timer processing automatically
+static esp_lcd_panel_handle_t global_panel_handle = NULL;
+static lv_display_t *global_display = NULL;
+static lv_indev_t *global_touch_indev = NULL;
+static bool wifi_power_policy_started = false;
+static TimerHandle_t runtime_timer = NULL;
+static uint32_t runtime_seconds = 0;
+static volatile uint8_t displayed_source = SERIAL_SOURCE_LOCAL; // Telemetry source shown on the dashboard
+
+// No additional display monitoring needed
+
+static bool show_source(uint8_t source_id)
+{
+  system_data_t data;
+  if (serial_data_get_source_data(source_id, &data) != ESP_OK)
+    return false;
+
+  displayed_source = source_id;
+  if (!ui_benchmark_is_running())
+  {
+    ui_dashboard_update(&data, SYSTEM_DATA_FIELD_ALL);
+    ui_alerts_set_active(telemetry_alerts_get_active(source_id));
+  }
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Showing telemetry source %s", serial_data_get_source_name(source_id));
+  return true;
+}
+
+static bool show_next_connected_source(void)
+{
+  // Other sources only, the current one is already on screen
+  for (int step = 1; step < CONFIG_SERIAL_MAX_SOURCES; step++)
+  {
+    uint8_t id = (displayed_source + step) % CONFIG_SERIAL_MAX_SOURCES;
+    if (serial_data_is_source_connected(id) && show_source(id))
+      return true;
+  }
+  return false;
+}
+
+static void ui_benchmark_done_callback(void)
+{
+  // Paint the real telemetry back over the synthetic samples
+  if (!serial_data_is_source_connected(displayed_source) || !show_source(displayed_source))
+  {
+    ui_dashboard_reset_to_defaults();
+  }
+}
+
+static bool any_source_connected(void)
+{
+  for (uint8_t id = 0; id < CONFIG_SERIAL_MAX_SOURCES; id++)
+  {
+    if (serial_data_is_source_connected(id))
+      return true;
+  }
+  return false;
+}
+
+static void runtime_timer_callback(TimerHandle_t xTimer)
+{
+  // The status panel keeps its own runtime and clock, this only paces source rotation
+  runtime_seconds++;
+
+#if CONFIG_SERIAL_MAX_SOURCES > 1 && CONFIG_DASHBOARD_SOURCE_ROTATE_SECONDS > 0
+  if (runtime_seconds % CONFIG_DASHBOARD_SOURCE_ROTATE_SECONDS == 0)
+  {
+    show_next_connected_source();
+  }
+#endif
+
+#if CONFIG_TELEMETRY_CLOCK_SYNC && CONFIG_TELEMETRY_STALE_AFTER_MS > 0
+  // Values age by the host's clock, a link that delivers old samples is stale too
+  uint32_t age_ms;
+  ui_dashboard_set_data_stale(serial_data_get_sample_age_ms(displayed_source, &age_ms) == ESP_OK &&
+                              age_ms > CONFIG_TELEMETRY_STALE_AFTER_MS);
+#endif
+}
+
+static void init_runtime_timer(void)
+{
+  // Create and start runtime timer (1 second interval)
+  runtime_timer = xTimerCreate(
+      "RuntimeTimer",
+      pdMS_TO_TICKS(1000), // 1 second interval
+      pdTRUE,              // Auto-reload
+      NULL,                // Timer ID (not used)
+      runtime_timer_callback);
+
+  if (runtime_timer != NULL)
+  {
+    xTimerStart(runtime_timer, 0);
+    debug_log_info(DEBUG_TAG_SYSTEM, "Runtime timer started");
+  }
+  else
+  {
+    debug_log_error(DEBUG_TAG_SYSTEM, "Failed to create runtime timer");
+  }
+}
+
+static void wifi_status_callback(const event_t *event, void *ctx)
+{
+  status_info_update_wifi_status(event->wifi_status.text, event->wifi_status.is_connected);
+}
+
+static void display_activity_callback(display_activity_state_t state)
+{
+  static const wifi_power_ui_t ui_levels[] = {
+      [DISPLAY_ACTIVITY_ACTIVE] = WIFI_POWER_UI_ACTIVE,
+      [DISPLAY_ACTIVITY_IDLE] = WIFI_POWER_UI_IDLE,
+      [DISPLAY_ACTIVITY_STANDBY] = WIFI_POWER_UI_STANDBY,
+      [DISPLAY_ACTIVITY_NIGHT] = WIFI_POWER_UI_IDLE,
+  };
+  if (wifi_power_policy_started)
+  {
+    wifi_power_policy_set_ui(ui_levels[state]);
+  }
+  telemetry_rate_set_viewing(state == DISPLAY_ACTIVITY_ACTIVE);
+  cpu_power_hold(CPU_POWER_TOUCH, state == DISPLAY_ACTIVITY_ACTIVE);
+  // A touch that wakes the panel from standby or night never reaches a control
+  touch_feedback_set_enabled(state == DISPLAY_ACTIVITY_ACTIVE || state == DISPLAY_ACTIVITY_IDLE);
+  // Standby keeps whatever page it dimmed, night and waking up switch
+  if (state != DISPLAY_ACTIVITY_STANDBY)
+  {
+    ui_night_page_show(state == DISPLAY_ACTIVITY_NIGHT);
+  }
+}
+
+static void wifi_link_callback(const wifi_link_metrics_t *metrics)
+{
+  status_info_update_wifi_link(metrics->connected, metrics->rssi_avg, metrics->degraded);
+}
+
+static void touch_gesture_callback(const gt911_gesture_event_t *event, void *user_ctx)
+{
+  // Two-finger swipes page through the screens, the content follows the fingers
+  if (event->type == GT911_GESTURE_SWIPE_LEFT)
+    ui_pages_show_relative(1);
+  else if (event->type == GT911_GESTURE_SWIPE_RIGHT)
+    ui_pages_show_relative(-1);
+}
+
+static void wifi_connected_callback(void)
+{
+  // Runs on the WiFi event task, the HTTP clients and workers start on the background init task
+  if (deferred_init_submit("smart_home", smart_home_init) != ESP_OK ||
+      deferred_init_submit("telemetry_net", telemetry_net_start) != ESP_OK)
+  {
+    debug_log_error(DEBUG_TAG_SYSTEM, "Could not queue network subsystem init");
+  }
+#if CONFIG_TELEMETRY_RELAY
+  deferred_init_submit("telemetry_relay", telemetry_relay_start);
+#endif
+#if CONFIG_DIAG_HTTP
+  deferred_init_submit("diag_http", diag_http_start);
+#endif
+}
+
+static void serial_connection_status_callback(const event_t *event, void *ctx)
+{
+  uint8_t source_id = event->serial_connection.source_id;
+  bool connected = event->serial_connection.connected;
+
+  status_info_update_serial_status(any_source_connected());
+  if (!connected)
+  {
+    telemetry_alerts_clear(source_id);
+  }
+
+  if (connected)
+  {
+    // Take over the screen if the displayed source went quiet earlier
+    if (source_id != displayed_source && !serial_data_is_source_connected(displayed_source))
+    {
+      show_source(source_id);
+    }
+    return;
+  }
+
+  // Reset dashboard to default values when the last source is lost
+  if (source_id == displayed_source && !show_next_connected_source())
+  {
+    ui_dashboard_reset_to_defaults();
+    ui_alerts_set_active(0);
+  }
+}
+
+static void serial_data_update_callback(const event_t *event, void *ctx)
+{
+  uint8_t source_id = event->telemetry.source_id;
+  const system_data_t *data = event->telemetry.data;
+  uint32_t changed_fields = event->telemetry.changed_fields;
+
+  static bool first_frame_traced = false;
+  if (!first_frame_traced)
+  {
+    first_frame_traced = true;
+    boot_graph_mark_milestone("first_telemetry");
+  }
+
+  display_activity_notify_telemetry();
+  uint32_t raised = ~telemetry_alerts_get_active(source_id);
+  uint32_t alerts = telemetry_alerts_evaluate(source_id, data, changed_fields);
+  alert_audio_play_alerts(alerts & raised);
+  if (source_id == displayed_source && !ui_benchmark_is_running())
+  {
+    ui_dashboard_update(data, changed_fields);
+    ui_alerts_set_active(alerts);
+    ui_state_cache_store_telemetry(data);
+  }
+}
+
+#if CONFIG_TELEMETRY_ALERT_HA_EVENTS
+static void telemetry_alert_sink(const char *event_json)
+{
+  esp_err_t ret = smart_home_fire_event("system_monitor_alert", event_json);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Alert event not sent: %s", esp_err_to_name(ret));
+  }
+}
+#endif
+
+#if CONFIG_ALERT_AUDIO_HA_EVENTS
+static void ha_sound_event(const cJSON *data)
+{
+  const char *clip = cJSON_GetStringValue(cJSON_GetObjectItem(data, "clip"));
+  esp_err_t ret = alert_audio_play(clip ? clip : "notify");
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "HA sound %s not played: %s", clip ? clip : "notify", esp_err_to_name(ret));
+  }
+}
+#endif
+
+static bool serial_command_callback(const char *line)
+{
+  if (strcmp(line, "GET_DISPLAY_METRICS") == 0)
+  {
+    static const char prefix[] = "DISPLAY_METRICS ";
+    static char reply[1024];
+    lvgl_metrics_t metrics;
+    size_t len = sizeof(prefix) - 1;
+    memcpy(reply, prefix, len);
+
+    size_t json_len = 0;
+    if (lvgl_setup_get_metrics(&metrics) == ESP_OK)
+    {
+      json_len = lvgl_setup_format_metrics_json(&metrics, reply + len, sizeof(reply) - len - 1);
+    }
+    if (json_len == 0)
+    {
+      json_len = 2;
+      memcpy(reply + len, "{}", json_len);
+    }
+    len += json_len;
+
+    // Single prefixed line so host tools can pick it out of the log stream
+    reply[len++] = '\n';
+    serial_data_write(reply, len);
+    return true;
+  }
+  if (ha_registry_handle_command(line))
+    return true;
+  if (ha_outbox_handle_command(line))
+    return true;
+  if (ha_http_cache_handle_command(line))
+    return true;
+  if (ha_camera_handle_command(line))
+    return true;
+  if (ha_metrics_handle_command(line))
+    return true;
+  if (ha_mqtt_handle_command(line))
+    return true;
+  if (ha_share_handle_command(line))
+    return true;
+  if (ha_servers_handle_command(line))
+    return true;
+  if (ha_latency_test_handle_command(line))
+    return true;
+  if (gt911_filter_handle_command(line))
+    return true;
+  if (gt911_config_handle_command(line))
+    return true;
+  if (touch_inject_handle_command(line))
+    return true;
+  if (touch_latency_handle_command(line))
+    return true;
+  if (touch_feedback_handle_command(line))
+    return true;
+  if (alert_audio_handle_command(line))
+    return true;
+  if (wifi_link_monitor_handle_command(line))
+    return true;
+  if (boot_graph_handle_command(line))
+    return true;
+  if (deferred_init_handle_command(line))
+    return true;
+  if (debug_log_ring_handle_command(line))
+    return true;
+  if (task_profiler_handle_command(line))
+    return true;
+  if (task_plan_handle_command(line))
+    return true;
+  if (heap_monitor_handle_command(line))
+    return true;
+  if (mem_governor_handle_command(line))
+    return true;
+  if (trace_spans_handle_command(line))
+    return true;
+  if (cycle_prof_handle_command(line))
+    return true;
+  if (cpu_power_handle_command(line))
+    return true;
+  if (crash_log_handle_command(line))
+    return true;
+  if (safe_mode_handle_command(line))
+    return true;
+  if (metrics_handle_command(line))
+    return true;
+  if (ui_pages_handle_command(line))
+    return true;
+  if (ui_layout_handle_command(line))
+    return true;
+  if (display_activity_handle_command(line))
+    return true;
+  if (telemetry_alerts_handle_command(line))
+    return true;
+  if (telemetry_clock_handle_command(line))
+    return true;
+  if (telemetry_rate_handle_command(line))
+    return true;
+  if (telemetry_relay_handle_command(line))
+    return true;
+  if (serial_baud_handle_command(line))
+    return true;
+  if (ui_benchmark_handle_command(line))
+    return true;
+  if (ui_lvgl_benchmark_handle_command(line))
+    return true;
+  if (lvgl_lock_prof_handle_command(line))
+    return true;
+  if (lvgl_stall_handle_command(line))
+    return true;
+  if (screen_capture_handle_command(line))
+    return true;
+  if (debug_trace_handle_command(line))
+    return true;
+  if (telemetry_history_handle_command(line))
+    return true;
+  if (telemetry_sd_log_handle_command(line))
+    return true;
+  if (telemetry_export_handle_command(line))
+    return true;
+  if (asset_pack_handle_command(line))
+    return true;
+  if (ota_update_handle_command(line))
+    return true;
+  return nvs_store_handle_command(line);
+}
+
+static void ha_status_change_callback(const event_t *event, void *ctx)
+{
+  telemetry_rate_set_busy(TELEMETRY_RATE_BUSY_HA_SYNC, event->ha_status.is_syncing);
+  cpu_power_hold(CPU_POWER_HA_SYNC, event->ha_status.is_syncing);
+  controls_panel_update_ha_status(event->ha_status.is_ready, event->ha_status.is_syncing, event->ha_status.text);
+}
+
+static void smart_home_states_sync_callback(const event_t *event, void *ctx)
+{
+  const ha_entity_state_t *states = event->ha_states.states;
+  int state_count = event->ha_states.count;
+
+  // Update UI controls based on sync states, indexed like the entity registry
+  controls_panel_set_entity_states(states, state_count);
+  ui_sensor_page_set_entity_states(states, state_count);
+  ui_state_cache_store_entity_states(states, state_count);
+}
+
+// =======================================================================
+// BOOT STEPS
+// =======================================================================
+
+static esp_err_t boot_panel(void)
+{
+  lvgl_setup_init_backlight();
+  lvgl_setup_set_backlight(LCD_BK_LIGHT_OFF_LEVEL);
+
+  esp_lcd_panel_handle_t panel_handle = lvgl_setup_create_lcd_panel();
+  global_panel_handle = panel_handle;
+
+  // Light up over the splash instead of leftover PSRAM
+  esp_err_t splash_ret = boot_splash_draw(panel_handle);
+  if (splash_ret != ESP_OK && splash_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Boot splash not drawn: %s", esp_err_to_name(splash_ret));
+  }
+
+  lvgl_setup_set_backlight(LCD_BK_LIGHT_ON_LEVEL);
+  return panel_handle ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t boot_touch_hw(void)
+{
+  // A missing buzzer only costs the pulses, it does not fail the touch step
+  touch_feedback_init();
+  // Reset and address detection take a few hundred ms of delays, overlap them with the panel
+  return gt911_init();
+}
+
+static esp_err_t boot_lvgl(void)
+{
+  global_display = lvgl_setup_init(global_panel_handle);
+  if (global_display)
+  {
+    screen_capture_init(global_display);
+  }
+  return global_display ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t boot_ui(void)
+{
+  lvgl_setup_create_ui_safe(global_display, ui_dashboard_create);
+
+  // Queued before the LVGL task starts, so the first frame already shows them
+  system_data_t cached_data;
+  if (ui_state_cache_get_telemetry(&cached_data))
+  {
+    ui_dashboard_show_cached(&cached_data);
+  }
+  static ha_entity_state_t cached_states[HA_REGISTRY_MAX_ENTITIES];
+  int cached_count = ui_state_cache_get_entity_states(cached_states);
+  if (cached_count > 0)
+  {
+    controls_panel_show_cached_states(cached_states, cached_count);
+  }
+  ui_benchmark_register_done_callback(ui_benchmark_done_callback);
+  return ESP_OK;
+}
+
+static esp_err_t boot_touch(void)
+{
+  // Creates an LVGL input device, so it runs after the UI rather than beside it
+  global_touch_indev = lvgl_setup_init_touch();
+  gt911_gesture_set_callback(touch_gesture_callback, NULL);
+  return ESP_OK;
+}
+
+static esp_err_t boot_display(void)
+{
+  display_activity_init(global_display, global_touch_indev);
+  lvgl_setup_start_task();
+  return ESP_OK;
+}
+
+static esp_err_t boot_wifi(void)
+{
+  ESP_ERROR_CHECK(wifi_manager_init());
+  esp_err_t link_ret = wifi_link_monitor_start();
+  if (link_ret != ESP_OK && link_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "WiFi link monitor not started");
+  }
+  esp_err_t ps_ret = wifi_power_policy_init();
+  wifi_power_policy_started = ps_ret == ESP_OK;
+  if (ps_ret != ESP_OK && ps_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "WiFi power-save policy not started");
+  }
+  esp_err_t sntp_ret = wifi_time_sync_start();
+  if (sntp_ret != ESP_OK && sntp_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "SNTP time sync not started");
+  }
+  return ESP_OK;
+}
+
+static esp_err_t boot_wifi_ui(void)
+{
+  // WiFi may already be connected by now, the bus replays the retained status
+  event_bus_subscribe(EVENT_TOPIC_WIFI_STATUS, wifi_status_callback, NULL, NULL);
+  wifi_manager_register_connected_callback(wifi_connected_callback);
+  wifi_link_monitor_register_callback(wifi_link_callback);
+  wifi_time_sync_register_callback(status_info_clock_changed);
+  display_activity_register_callback(display_activity_callback);
+  // The display starts out active, the callback only reports changes
+  cpu_power_hold(CPU_POWER_TOUCH, display_activity_get_state() == DISPLAY_ACTIVITY_ACTIVE);
+  return ESP_OK;
+}
+
+static esp_err_t boot_serial(void)
+{
+  ESP_ERROR_CHECK(serial_data_init());
+  esp_err_t baud_ret = serial_baud_init();
+  if (baud_ret != ESP_OK && baud_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Baud negotiation unavailable: %s", esp_err_to_name(baud_ret));
+  }
+  if (telemetry_history_init() != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Telemetry history unavailable");
+  }
+#if CONFIG_TELEMETRY_SD_LOG
+  if (telemetry_sd_log_start() != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Telemetry SD log unavailable");
+  }
+#endif
+  if (telemetry_alerts_init() == ESP_OK)
+  {
+#if CONFIG_TELEMETRY_ALERT_HA_EVENTS
+    telemetry_alerts_register_sink(telemetry_alert_sink);
+#endif
+  }
+  event_bus_subscribe(EVENT_TOPIC_SERIAL_CONNECTION, serial_connection_status_callback, NULL, NULL);
+  event_bus_subscribe(EVENT_TOPIC_TELEMETRY, serial_data_update_callback, NULL, NULL);
+  serial_data_register_command_callback(serial_command_callback);
+  serial_data_start_task();
+  return ESP_OK;
+}
+
+static esp_err_t boot_smart_home_callbacks(void)
+{
+#if CONFIG_ALERT_AUDIO_HA_EVENTS
+  ha_websocket_register_event_callback(ALERT_AUDIO_HA_EVENT, ha_sound_event);
+#endif
+  event_bus_subscribe(EVENT_TOPIC_HA_STATUS, ha_status_change_callback, NULL, NULL);
+  event_bus_subscribe(EVENT_TOPIC_HA_STATES, smart_home_states_sync_callback, NULL, NULL);
+  return ESP_OK;
+}
+
+/**
+ * @brief Commands left in safe mode: diagnosis and the way out
+ */
+static bool safe_mode_command_callback(const char *line)
+{
+  if (safe_mode_handle_command(line))
+    return true;
+  if (crash_log_handle_command(line))
+    return true;
+  if (debug_log_ring_handle_command(line))
+    return true;
+  if (boot_graph_handle_command(line))
+    return true;
+  return nvs_store_handle_command(line);
+}
+
+/**
+ * @brief Panel, one status screen and serial, in series and nothing else
+ */
+static void boot_safe_mode(void)
+{
+  if (boot_panel() != ESP_OK || boot_lvgl() != ESP_OK)
+  {
+    debug_log_error(DEBUG_TAG_SYSTEM, "Safe mode: display unavailable, serial only");
+  }
+  else
+  {
+    lvgl_setup_create_ui_safe(global_display, ui_safe_mode_create);
+    lvgl_setup_start_task();
+  }
+
+  if (serial_data_init() == ESP_OK)
+  {
+    serial_data_register_command_callback(safe_mode_command_callback);
+    serial_data_start_task();
+  }
+  boot_graph_mark_milestone("safe_mode");
+}
+
+enum
+{
+  BOOT_STEP_PANEL,
+  BOOT_STEP_TOUCH_HW,
+  BOOT_STEP_LVGL,
+  BOOT_STEP_UI,
+  BOOT_STEP_TOUCH,
+  BOOT_STEP_DISPLAY,
+  BOOT_STEP_WIFI,
+  BOOT_STEP_WIFI_UI,
+  BOOT_STEP_SERIAL,
+  BOOT_STEP_SMART_CB,
+  BOOT_STEP_COUNT
+};
+
+static const boot_step_t boot_steps[BOOT_STEP_COUNT] = {
+    [BOOT_STEP_PANEL] = {.name = "panel", .run = boot_panel},
+    [BOOT_STEP_TOUCH_HW] = {.name = "touch_hw", .run = boot_touch_hw},
+    [BOOT_STEP_LVGL] = {.name = "lvgl", .run = boot_lvgl, .deps = BOOT_DEP(BOOT_STEP_PANEL)},
+    [BOOT_STEP_UI] = {.name = "ui", .run = boot_ui, .deps = BOOT_DEP(BOOT_STEP_LVGL), .stack_size = 8192},
+    [BOOT_STEP_TOUCH] = {.name = "touch",
+                         .run = boot_touch,
+                         .deps = BOOT_DEP(BOOT_STEP_UI) | BOOT_DEP(BOOT_STEP_TOUCH_HW)},
+    [BOOT_STEP_DISPLAY] = {.name = "display",
+                           .run = boot_display,
+                           .deps = BOOT_DEP(BOOT_STEP_UI) | BOOT_DEP(BOOT_STEP_TOUCH)},
+    [BOOT_STEP_WIFI] = {.name = "wifi", .run = boot_wifi, .core = BOOT_CORE_ANY},
+    [BOOT_STEP_WIFI_UI] = {.name = "wifi_ui",
+                           .run = boot_wifi_ui,
+                           .deps = BOOT_DEP(BOOT_STEP_WIFI) | BOOT_DEP(BOOT_STEP_DISPLAY)},
+    [BOOT_STEP_SERIAL] = {.name = "serial", .run = boot_serial, .deps = BOOT_DEP(BOOT_STEP_DISPLAY)},
+    [BOOT_STEP_SMART_CB] = {.name = "smart_cb", .run = boot_smart_home_callbacks},
+};
+
+void app_main(void)
+{
+  debug_log_ring_init();
+  debug_log_startup(DEBUG_TAG_SYSTEM, "Dashboard");
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Performance profile %s", CONFIG_DASHBOARD_PROFILE_NAME);
+  boot_graph_trace_begin();
+  metrics_init();
+  event_bus_init();
+
+  // Initialize NVS first for crash log storage
+  esp_err_t ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+  {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    ret = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(ret);
+  boot_graph_mark_milestone("nvs");
+
+  // Settings, caches and calibration go through the write-coalescing store
+  ESP_ERROR_CHECK(nvs_store_init());
+  boot_graph_mark_milestone("nvs_store");
+
+  // Initialize crash handler early to capture any startup crashes
+  ESP_ERROR_CHECK(crash_handler_init());
+  boot_graph_mark_milestone("crash_handler");
+
+  // After a run of early crashes skip everything that could be causing them
+  if (safe_mode_init())
+  {
+    boot_safe_mode();
+    debug_log_startup(DEBUG_TAG_SYSTEM, "System Monitor - Safe Mode");
+    while (1)
+    {
+      vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+  }
+
+  // cJSON trees go to PSRAM arenas from here on, before any task parses
+  if (json_arena_init() != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "JSON arenas unavailable, cJSON uses the heap");
+  }
+  boot_graph_mark_milestone("json_arena");
+
+  // Fonts, images and config defaults, mapped before anything looks one up
+  asset_pack_init();
+  boot_graph_mark_milestone("asset_pack");
+  // Clips come from the pack; a missing amplifier only costs the sounds
+  alert_audio_init();
+
+  // Load the HA entity list before the controls panel builds its widgets
+  ha_registry_init();
+  ha_shortcuts_init();
+  ha_entity_icons_init();
+  ha_outbox_init();
+  ha_http_cache_init();
+  boot_graph_mark_milestone("ha_registry");
+
+  // Heavy subsystems are started here once their trigger fires, off the event loop
+  ESP_ERROR_CHECK(deferred_init_start());
+
+  // Last-known telemetry and entity states, shown until live data arrives
+  esp_err_t cache_ret = ui_state_cache_init();
+  if (cache_ret != ESP_OK && cache_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Last-known UI state unavailable");
+  }
+
+  // Register smart home callbacks BEFORE creating UI
+  // This ensures callbacks are available when controls are created
+  smart_home_callbacks_t callbacks = {
+      .switch_callback = smart_home_control_switch,
+      .scene_callback = smart_home_trigger_scene,
+      .level_callback = smart_home_set_level};
+  ui_dashboard_register_smart_home_callbacks(&callbacks);
+
+  // Display, touch, WiFi and serial come up in parallel where they can
+  ret = boot_graph_run(boot_steps, BOOT_STEP_COUNT);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Boot finished with errors: %s", esp_err_to_name(ret));
+  }
+
+  // Boot ran at the fixed maximum, from here the CPU slows down between bursts
+  esp_err_t pm_ret = cpu_power_init();
+  if (pm_ret != ESP_OK && pm_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "CPU frequency scaling not started");
+  }
+
+#if CONFIG_UI_LVGL_BENCHMARK_AT_BOOT
+  // Benchmark builds take their numbers right away, the LVGL task is running by now
+  if (ui_lvgl_benchmark_start() != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "LVGL benchmark not started");
+  }
+#endif
+
+  // Initialize runtime timer
+  init_runtime_timer();
+
+  // Boot completed, so a freshly installed image is kept
+  esp_err_t ota_ret = ota_update_init();
+  if (ota_ret != ESP_OK && ota_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "OTA update check not started");
+  }
+
+  esp_err_t profiler_ret = task_profiler_start();
+  if (profiler_ret != ESP_OK && profiler_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Task profiler not started");
+  }
+  esp_err_t plan_ret = task_plan_start_monitor();
+  if (plan_ret != ESP_OK && plan_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Task plan monitor not started");
+  }
+  esp_err_t heap_ret = heap_monitor_start();
+  if (heap_ret != ESP_OK && heap_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Heap monitor not started");
+  }
+  esp_err_t governor_ret = mem_governor_start();
+  if (governor_ret != ESP_OK && governor_ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Memory governor not started");
+  }
+
+  // Note: wifi_connected_callback() queues smart_home_init() on the deferred
+  // init task, which also initializes ha_status_init(). GET_INIT_STATE shows
+  // how far it got.
+
+  debug_log_startup(DEBUG_TAG_SYSTEM, "System Monitor - Fully Initialized");
+
+  while (1)
+  {
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+  }
+}
@@ -0,0 +1,228 @@
+/**
+ * @file boot_splash.c
+ * @brief Splash screen drawn straight into the panel frame buffers
+ *
+ * The logo is stored at a third of its on-screen size as runs of palette
+ * colours. Each byte is one run within a row: the top two bits pick the
+ * palette entry, the low six bits hold the run length minus one. A row is
+ * decoded once into a DRAM line, scaled up, and copied SPLASH_SCALE times.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "boot_splash.h"
+
+#include <string.h>
+#include "esp_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_rgb.h"
+#include "lvgl_setup.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// SPLASH IMAGE
+// =======================================================================
+
+#define SPLASH_WIDTH 122
+#define SPLASH_HEIGHT 32
+#define SPLASH_SCALE 3
+
+#define SPLASH_RUN_COLOR(byte) ((byte) >> 6)
+#define SPLASH_RUN_LENGTH(byte) (((byte) & 0x3f) + 1)
+
+// Screen background of the dark theme, accent bars, title text, bar baseline
+static const uint32_t splash_palette[4] = {0x15171a, 0x4fc3f7, 0xe0e0e0, 0x2e2e4a};
+
+// Bar chart icon beside "SYSTEM" over "MONITOR"
+static const uint8_t splash_runs[] = {
+    0x27, 0x87, 0x01, 0x81, 0x05, 0x81, 0x03, 0x87, 0x01, 0x89, 0x01, 0x89, 0x01, 0x81, 0x05, 0x81,
+    0x0d, 0x14, 0x46, 0x0b, 0x87, 0x01, 0x81, 0x05, 0x81, 0x03, 0x87, 0x01, 0x89, 0x01, 0x89, 0x01,
+    0x81, 0x05, 0x81, 0x0d, 0x14, 0x46, 0x09, 0x81, 0x09, 0x81, 0x05, 0x81, 0x01, 0x81, 0x0d, 0x81,
+    0x05, 0x81, 0x09, 0x83, 0x01, 0x83, 0x0d, 0x14, 0x46, 0x09, 0x81, 0x09, 0x81, 0x05, 0x81, 0x01,
+    0x81, 0x0d, 0x81, 0x05, 0x81, 0x09, 0x83, 0x01, 0x83, 0x0d, 0x14, 0x46, 0x09, 0x81, 0x0b, 0x81,
+    0x01, 0x81, 0x03, 0x81, 0x0d, 0x81, 0x05, 0x81, 0x09, 0x81, 0x01, 0x81, 0x01, 0x81, 0x0d, 0x14,
+    0x46, 0x09, 0x81, 0x0b, 0x81, 0x01, 0x81, 0x03, 0x81, 0x0d, 0x81, 0x05, 0x81, 0x09, 0x81, 0x01,
+    0x81, 0x01, 0x81, 0x0d, 0x14, 0x46, 0x0b, 0x85, 0x07, 0x81, 0x07, 0x85, 0x07, 0x81, 0x05, 0x87,
+    0x03, 0x81, 0x01, 0x81, 0x01, 0x81, 0x0d, 0x14, 0x46, 0x0b, 0x85, 0x07, 0x81, 0x07, 0x85, 0x07,
+    0x81, 0x05, 0x87, 0x03, 0x81, 0x01, 0x81, 0x01, 0x81, 0x0d, 0x14, 0x46, 0x11, 0x81, 0x05, 0x81,
+    0x0d, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x0d, 0x0a, 0x46, 0x02, 0x46, 0x11,
+    0x81, 0x05, 0x81, 0x0d, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x0d, 0x0a, 0x46,
+    0x02, 0x46, 0x11, 0x81, 0x05, 0x81, 0x0d, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81,
+    0x0d, 0x0a, 0x46, 0x02, 0x46, 0x11, 0x81, 0x05, 0x81, 0x0d, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09,
+    0x81, 0x05, 0x81, 0x0d, 0x0a, 0x46, 0x02, 0x46, 0x09, 0x87, 0x07, 0x81, 0x05, 0x87, 0x07, 0x81,
+    0x05, 0x89, 0x01, 0x81, 0x05, 0x81, 0x0d, 0x0a, 0x46, 0x02, 0x46, 0x09, 0x87, 0x07, 0x81, 0x05,
+    0x87, 0x07, 0x81, 0x05, 0x89, 0x01, 0x81, 0x05, 0x81, 0x0d, 0x0a, 0x46, 0x02, 0x46, 0x3f, 0x1d,
+    0x0a, 0x46, 0x02, 0x46, 0x3f, 0x1d, 0x0a, 0x46, 0x02, 0x46, 0x3f, 0x1d, 0x00, 0x46, 0x02, 0x46,
+    0x02, 0x46, 0x3f, 0x1d, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x05, 0x81, 0x03, 0x85,
+    0x03, 0x81, 0x05, 0x81, 0x03, 0x85, 0x03, 0x89, 0x03, 0x85, 0x03, 0x87, 0x03, 0x00, 0x46, 0x02,
+    0x46, 0x02, 0x46, 0x09, 0x81, 0x05, 0x81, 0x03, 0x85, 0x03, 0x81, 0x05, 0x81, 0x03, 0x85, 0x03,
+    0x89, 0x03, 0x85, 0x03, 0x87, 0x03, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x83, 0x01, 0x83,
+    0x01, 0x81, 0x05, 0x81, 0x01, 0x83, 0x03, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x05, 0x81,
+    0x01, 0x81, 0x05, 0x81, 0x01, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x83, 0x01, 0x83, 0x01,
+    0x81, 0x05, 0x81, 0x01, 0x83, 0x03, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x05, 0x81, 0x01,
+    0x81, 0x05, 0x81, 0x01, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x01, 0x81, 0x01, 0x81,
+    0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81,
+    0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x01,
+    0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x81, 0x09,
+    0x81, 0x05, 0x81, 0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46,
+    0x09, 0x81, 0x01, 0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x03, 0x83, 0x05, 0x81,
+    0x09, 0x81, 0x05, 0x81, 0x05, 0x81, 0x01, 0x87, 0x03, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09,
+    0x81, 0x01, 0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x03, 0x83, 0x05, 0x81, 0x09,
+    0x81, 0x05, 0x81, 0x05, 0x81, 0x01, 0x87, 0x03, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81,
+    0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81,
+    0x05, 0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x05,
+    0x81, 0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x05,
+    0x81, 0x01, 0x81, 0x01, 0x81, 0x05, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x05, 0x81,
+    0x01, 0x81, 0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x05, 0x81,
+    0x01, 0x81, 0x03, 0x81, 0x03, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x05, 0x81, 0x01,
+    0x81, 0x05, 0x81, 0x01, 0x81, 0x05, 0x81, 0x05, 0x81, 0x09, 0x81, 0x05, 0x81, 0x05, 0x81, 0x01,
+    0x81, 0x03, 0x81, 0x03, 0x00, 0x46, 0x02, 0x46, 0x02, 0x46, 0x09, 0x81, 0x05, 0x81, 0x03, 0x85,
+    0x03, 0x81, 0x05, 0x81, 0x03, 0x85, 0x07, 0x81, 0x07, 0x85, 0x03, 0x81, 0x05, 0x81, 0x01, 0xdd,
+    0x07, 0x81, 0x05, 0x81, 0x03, 0x85, 0x03, 0x81, 0x05, 0x81, 0x03, 0x85, 0x07, 0x81, 0x07, 0x85,
+    0x03, 0x81, 0x05, 0x81, 0x01,
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void put_pixel(uint8_t *dst, uint32_t rgb)
+{
+#if LCD_PIXEL_SIZE == 2
+  uint16_t rgb565 = (uint16_t)(((rgb >> 8) & 0xf800) | ((rgb >> 5) & 0x07e0) | ((rgb >> 3) & 0x001f));
+  memcpy(dst, &rgb565, sizeof(rgb565));
+#else
+  // LVGL's RGB888 is stored blue first
+  dst[0] = (uint8_t)rgb;
+  dst[1] = (uint8_t)(rgb >> 8);
+  dst[2] = (uint8_t)(rgb >> 16);
+#endif
+}
+
+static void fill_line(uint8_t *line, int pixels, uint32_t rgb)
+{
+  for (int x = 0; x < pixels; x++)
+  {
+    put_pixel(line + x * LCD_PIXEL_SIZE, rgb);
+  }
+}
+
+#if LCD_ROTATION != LV_DISPLAY_ROTATION_0
+// Frame buffer offset of a pixel in LVGL's rotated coordinates
+static size_t rotated_offset(int x, int y)
+{
+#if LCD_ROTATION == LV_DISPLAY_ROTATION_90
+  int fb_x = y, fb_y = LCD_V_RES - 1 - x;
+#elif LCD_ROTATION == LV_DISPLAY_ROTATION_180
+  int fb_x = LCD_H_RES - 1 - x, fb_y = LCD_V_RES - 1 - y;
+#else
+  int fb_x = LCD_H_RES - 1 - y, fb_y = x;
+#endif
+  return ((size_t)fb_y * LCD_H_RES + fb_x) * LCD_PIXEL_SIZE;
+}
+#endif
+
+static void draw_splash(uint8_t *fb, uint8_t *line)
+{
+  const size_t stride = LCD_H_RES * LCD_PIXEL_SIZE;
+  const int logo_w = SPLASH_WIDTH * SPLASH_SCALE;
+  const int logo_h = SPLASH_HEIGHT * SPLASH_SCALE;
+#if LCD_ROTATION == LV_DISPLAY_ROTATION_90 || LCD_ROTATION == LV_DISPLAY_ROTATION_270
+  const int x0 = (LCD_V_RES - logo_w) / 2;
+  const int y0 = (LCD_H_RES - logo_h) / 2;
+#else
+  const int x0 = (LCD_H_RES - logo_w) / 2;
+  const int y0 = (LCD_V_RES - logo_h) / 2;
+#endif
+
+  fill_line(line, LCD_H_RES, splash_palette[0]);
+  for (int y = 0; y < LCD_V_RES; y++)
+  {
+    memcpy(fb + y * stride, line, stride);
+  }
+
+  size_t run = 0;
+  for (int row = 0; row < SPLASH_HEIGHT; row++)
+  {
+    // Runs never cross a row, so each row ends exactly at SPLASH_WIDTH
+    int x = 0;
+    while (x < SPLASH_WIDTH && run < sizeof(splash_runs))
+    {
+      uint8_t byte = splash_runs[run++];
+      int length = SPLASH_RUN_LENGTH(byte);
+      fill_line(line + (size_t)x * SPLASH_SCALE * LCD_PIXEL_SIZE, length * SPLASH_SCALE,
+                splash_palette[SPLASH_RUN_COLOR(byte)]);
+      x += length;
+    }
+
+    for (int s = 0; s < SPLASH_SCALE; s++)
+    {
+#if LCD_ROTATION != LV_DISPLAY_ROTATION_0
+      // Placed pixel by pixel, once at boot, the way the driver places LVGL's areas
+      for (int x = 0; x < logo_w; x++)
+      {
+        memcpy(fb + rotated_offset(x0 + x, y0 + row * SPLASH_SCALE + s), line + (size_t)x * LCD_PIXEL_SIZE,
+               LCD_PIXEL_SIZE);
+      }
+#else
+      memcpy(fb + (size_t)(y0 + row * SPLASH_SCALE + s) * stride + (size_t)x0 * LCD_PIXEL_SIZE, line,
+             (size_t)logo_w * LCD_PIXEL_SIZE);
+#endif
+    }
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t boot_splash_draw(esp_lcd_panel_handle_t panel_handle)
+{
+#if CONFIG_BOOT_SPLASH
+  if (!panel_handle)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  void *fbs[LCD_NUM_FB] = {NULL};
+#if LCD_NUM_FB == 2
+  esp_err_t ret = esp_lcd_rgb_panel_get_frame_buffer(panel_handle, 2, &fbs[0], &fbs[1]);
+#else
+  esp_err_t ret = esp_lcd_rgb_panel_get_frame_buffer(panel_handle, 1, &fbs[0]);
+#endif
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  // Rows are composed in DRAM, PSRAM is only ever written in whole lines
+  uint8_t *line = heap_caps_malloc(LCD_H_RES * LCD_PIXEL_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!line)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  const size_t fb_size = LCD_H_RES * LCD_V_RES * LCD_PIXEL_SIZE;
+  for (int i = 0; i < LCD_NUM_FB; i++)
+  {
+    draw_splash(fbs[i], line);
+
+    // The panel DMA reads PSRAM directly, push the pixels out of the cache
+    ret = esp_cache_msync(fbs[i], fb_size, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+    if (ret != ESP_OK)
+    {
+      break;
+    }
+  }
+  heap_caps_free(line);
+
+  if (ret == ESP_OK)
+  {
+    debug_log_info(DEBUG_TAG_LVGL_SETUP, "Boot splash drawn");
+  }
+  return ret;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
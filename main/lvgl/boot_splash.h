@@ -0,0 +1,25 @@
+/**
+ * @file boot_splash.h
+ * @brief Splash screen drawn straight into the panel frame buffers
+ *
+ * Between panel creation and the first LVGL frame the frame buffers hold
+ * whatever was left in PSRAM. The splash decodes a small run-length encoded
+ * logo into them before lv_init(), so the backlight can come on over a
+ * clean screen. LVGL's first full-screen render replaces it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+/**
+ * @brief Draw the splash into every frame buffer of the panel
+ * @param panel_handle Panel from lvgl_setup_create_lcd_panel()
+ * @return ESP_OK once the frame buffers hold the splash, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+ * @note Call before lvgl_setup_init() and before the backlight comes on
+ */
+esp_err_t boot_splash_draw(esp_lcd_panel_handle_t panel_handle);
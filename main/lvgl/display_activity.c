@@ -0,0 +1,340 @@
+/**
+ * @file display_activity.c
+ * @brief Idle/active policy for the display pipeline
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "display_activity.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "gt911_touch.h"
+#include "lvgl_setup.h"
+#include "serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "wifi/wifi_time_sync.h"
+
+#define NIGHT_SCHEDULE_CHECK_US (10 * 1000000LL) // The hour is looked up at most this often
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static lv_display_t *activity_display = NULL;
+static lv_indev_t *activity_indev = NULL;
+static display_activity_state_t activity_state = DISPLAY_ACTIVITY_ACTIVE;
+static display_activity_cb_t activity_cb = NULL;
+static int64_t standby_since_us = 0;
+static bool display_asleep = false; ///< Scan-out and rendering stopped, only in standby
+
+// Written by the serial task, read by the LVGL task
+static portMUX_TYPE telemetry_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t last_telemetry_us = 0;
+
+// Mode written by the serial task; the LVGL task consumes the request to enter night now
+static portMUX_TYPE night_lock = portMUX_INITIALIZER_UNLOCKED;
+static display_night_mode_t night_mode = DISPLAY_NIGHT_AUTO;
+static bool night_enter_requested = false;
+
+// LVGL task only
+static bool night_forced = false;           ///< Entered by NIGHT_MODE ON before the idle timeout
+static uint32_t night_forced_inactive_ms = 0; ///< Inactive time then, a touch makes it smaller
+
+static const char *const state_names[] = {"active", "idle", "standby", "night"};
+
+#if CONFIG_DISPLAY_NIGHT_MODE
+static bool night_scheduled = false;
+static int64_t night_checked_us = 0;
+
+static const char *const night_mode_names[] = {"auto", "on", "off"};
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_DISPLAY_NIGHT_MODE
+/**
+ * @brief Whether the local time falls into the configured night hours
+ */
+static bool night_hours_now(void)
+{
+  if (DISPLAY_NIGHT_START_HOUR == DISPLAY_NIGHT_END_HOUR || !wifi_time_sync_is_valid())
+  {
+    return false;
+  }
+  time_t now = time(NULL);
+  struct tm local;
+  localtime_r(&now, &local);
+  if (DISPLAY_NIGHT_START_HOUR < DISPLAY_NIGHT_END_HOUR)
+  {
+    return local.tm_hour >= DISPLAY_NIGHT_START_HOUR && local.tm_hour < DISPLAY_NIGHT_END_HOUR;
+  }
+  return local.tm_hour >= DISPLAY_NIGHT_START_HOUR || local.tm_hour < DISPLAY_NIGHT_END_HOUR;
+}
+#endif
+
+/**
+ * @brief Whether an idle display should be in night instead
+ */
+static bool night_applies(display_night_mode_t mode)
+{
+#if CONFIG_DISPLAY_NIGHT_MODE
+  if (mode != DISPLAY_NIGHT_AUTO)
+  {
+    return mode == DISPLAY_NIGHT_ON;
+  }
+  int64_t now_us = esp_timer_get_time();
+  if (night_checked_us == 0 || now_us - night_checked_us >= NIGHT_SCHEDULE_CHECK_US)
+  {
+    night_scheduled = night_hours_now();
+    night_checked_us = now_us;
+  }
+  return night_scheduled;
+#else
+  (void)mode;
+  return false;
+#endif
+}
+
+static void apply_state(display_activity_state_t state)
+{
+  display_activity_state_t previous = activity_state;
+  activity_state = state;
+  lv_timer_t *refr_timer = lv_display_get_refr_timer(activity_display);
+
+  // Scan-out first, so the backlight never lights a stopped panel
+  if (display_asleep)
+  {
+    lvgl_setup_set_display_sleep(activity_display, false);
+    display_asleep = false;
+  }
+
+  if (state == DISPLAY_ACTIVITY_ACTIVE)
+  {
+    lv_timer_set_period(refr_timer, lvgl_setup_get_refr_period_ms());
+    lv_timer_resume(lv_anim_get_timer());
+    gt911_set_poll_period(GT911_POLL_PERIOD_MS);
+  }
+  else
+  {
+    lv_timer_set_period(refr_timer,
+                        state == DISPLAY_ACTIVITY_NIGHT ? DISPLAY_NIGHT_REFR_PERIOD_MS : DISPLAY_IDLE_REFR_PERIOD_MS);
+    lv_timer_pause(lv_anim_get_timer());
+    gt911_set_poll_period(DISPLAY_IDLE_TOUCH_POLL_MS);
+  }
+
+#if CONFIG_DISPLAY_NIGHT_MODE
+  // Standby keeps the night clock, scan-out stops there anyway
+  if (state == DISPLAY_ACTIVITY_NIGHT)
+  {
+    lvgl_setup_set_pixel_clock(activity_display, DISPLAY_NIGHT_PCLK_HZ);
+  }
+  else if (state != DISPLAY_ACTIVITY_STANDBY)
+  {
+    lvgl_setup_set_pixel_clock(activity_display, LCD_PIXEL_CLOCK_HZ);
+  }
+#endif
+
+  // Hardware fades, nothing here waits for them
+  switch (state)
+  {
+  case DISPLAY_ACTIVITY_ACTIVE:
+    lvgl_setup_fade_backlight(LCD_BK_LIGHT_ON_LEVEL, DISPLAY_WAKE_FADE_MS);
+    break;
+  case DISPLAY_ACTIVITY_IDLE:
+    lvgl_setup_fade_backlight(DISPLAY_IDLE_BACKLIGHT_LEVEL,
+                              previous == DISPLAY_ACTIVITY_STANDBY ? DISPLAY_WAKE_FADE_MS : DISPLAY_DIM_FADE_MS);
+    break;
+  case DISPLAY_ACTIVITY_STANDBY:
+    lvgl_setup_fade_backlight(LCD_BK_LIGHT_OFF_LEVEL, DISPLAY_DIM_FADE_MS);
+    standby_since_us = esp_timer_get_time();
+    break;
+  case DISPLAY_ACTIVITY_NIGHT:
+    lvgl_setup_fade_backlight(DISPLAY_NIGHT_BACKLIGHT_LEVEL,
+                              previous == DISPLAY_ACTIVITY_STANDBY ? DISPLAY_WAKE_FADE_MS : DISPLAY_DIM_FADE_MS);
+    break;
+  }
+
+  // The touch that lit the panel was made blind, or lands on the page that replaces the night page;
+  // it must not operate a control
+  if ((previous == DISPLAY_ACTIVITY_STANDBY || previous == DISPLAY_ACTIVITY_NIGHT) &&
+      state == DISPLAY_ACTIVITY_ACTIVE && activity_indev)
+  {
+    lv_indev_wait_release(activity_indev);
+  }
+
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Display %s", state_names[state]);
+  if (activity_cb)
+  {
+    activity_cb(state);
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void display_activity_init(lv_display_t *display, lv_indev_t *indev)
+{
+#if CONFIG_DISPLAY_ACTIVITY_MANAGER
+  if (!display)
+  {
+    return;
+  }
+  activity_display = display;
+  activity_indev = indev;
+  activity_state = DISPLAY_ACTIVITY_ACTIVE;
+
+  portENTER_CRITICAL(&telemetry_lock);
+  last_telemetry_us = esp_timer_get_time();
+  portEXIT_CRITICAL(&telemetry_lock);
+
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Display idle after %d s, standby after %d s", DISPLAY_IDLE_TIMEOUT_S,
+                   DISPLAY_STANDBY_TIMEOUT_S);
+#else
+  (void)display;
+  (void)indev;
+#endif
+}
+
+void display_activity_process(void)
+{
+  if (!activity_display)
+  {
+    return;
+  }
+
+  // LVGL updates the inactivity time whenever an input device reads a press
+  uint32_t inactive_ms = lv_display_get_inactive_time(activity_display);
+
+  portENTER_CRITICAL(&night_lock);
+  display_night_mode_t mode = night_mode;
+  bool enter_now = night_enter_requested;
+  night_enter_requested = false;
+  portEXIT_CRITICAL(&night_lock);
+
+  if (enter_now)
+  {
+    night_forced = true;
+    night_forced_inactive_ms = inactive_ms;
+  }
+  else if (night_forced && (mode != DISPLAY_NIGHT_ON || inactive_ms < night_forced_inactive_ms))
+  {
+    night_forced = false;
+  }
+
+  display_activity_state_t state = DISPLAY_ACTIVITY_ACTIVE;
+  if (night_forced)
+  {
+    state = DISPLAY_ACTIVITY_NIGHT;
+  }
+  else if (inactive_ms >= (uint32_t)DISPLAY_IDLE_TIMEOUT_S * 1000)
+  {
+    state = night_applies(mode) ? DISPLAY_ACTIVITY_NIGHT : DISPLAY_ACTIVITY_IDLE;
+  }
+
+  if (state != DISPLAY_ACTIVITY_ACTIVE && DISPLAY_STANDBY_TIMEOUT_S > 0 &&
+      inactive_ms >= (uint32_t)DISPLAY_STANDBY_TIMEOUT_S * 1000)
+  {
+    portENTER_CRITICAL(&telemetry_lock);
+    int64_t telemetry_us = last_telemetry_us;
+    portEXIT_CRITICAL(&telemetry_lock);
+    if (esp_timer_get_time() - telemetry_us >= (int64_t)DISPLAY_STANDBY_TIMEOUT_S * 1000000)
+    {
+      state = DISPLAY_ACTIVITY_STANDBY;
+    }
+  }
+
+  if (state != activity_state)
+  {
+    apply_state(state);
+  }
+
+#if CONFIG_DISPLAY_SLEEP_IN_STANDBY
+  // Stop scan-out once the fade to black has finished
+  if (activity_state == DISPLAY_ACTIVITY_STANDBY && !display_asleep &&
+      esp_timer_get_time() - standby_since_us >= (int64_t)DISPLAY_DIM_FADE_MS * 1000)
+  {
+    lvgl_setup_set_display_sleep(activity_display, true);
+    display_asleep = true;
+  }
+#endif
+}
+
+void display_activity_notify_telemetry(void)
+{
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&telemetry_lock);
+  last_telemetry_us = now_us;
+  portEXIT_CRITICAL(&telemetry_lock);
+}
+
+display_activity_state_t display_activity_get_state(void)
+{
+  return activity_state;
+}
+
+void display_activity_register_callback(display_activity_cb_t callback)
+{
+  activity_cb = callback;
+}
+
+void display_activity_set_night_mode(display_night_mode_t mode)
+{
+  portENTER_CRITICAL(&night_lock);
+  night_mode = mode;
+  night_enter_requested = (mode == DISPLAY_NIGHT_ON);
+  portEXIT_CRITICAL(&night_lock);
+  lvgl_setup_wake_task();
+}
+
+bool display_activity_handle_command(const char *line)
+{
+  if (strncmp(line, "NIGHT_MODE", 10) != 0 || (line[10] != '\0' && line[10] != ' '))
+  {
+    return false;
+  }
+
+  char reply[160];
+  int len;
+#if CONFIG_DISPLAY_NIGHT_MODE
+  const char *arg = line[10] ? line + 11 : "";
+  if (*arg)
+  {
+    int mode = -1;
+    for (int i = 0; i < (int)(sizeof(night_mode_names) / sizeof(night_mode_names[0])); i++)
+    {
+      if (strcasecmp(arg, night_mode_names[i]) == 0)
+      {
+        mode = i;
+      }
+    }
+    if (mode < 0)
+    {
+      static const char usage[] = "NIGHT_MODE {\"error\":\"usage: NIGHT_MODE [ON|OFF|AUTO]\"}\n";
+      serial_data_write(usage, sizeof(usage) - 1);
+      return true;
+    }
+    display_activity_set_night_mode((display_night_mode_t)mode);
+  }
+
+  portENTER_CRITICAL(&night_lock);
+  display_night_mode_t mode = night_mode;
+  portEXIT_CRITICAL(&night_lock);
+  len = snprintf(reply, sizeof(reply),
+                 "NIGHT_MODE {\"mode\":\"%s\",\"state\":\"%s\",\"hours\":[%d,%d],\"pclk_hz\":%lu}\n",
+                 night_mode_names[mode], state_names[activity_state], DISPLAY_NIGHT_START_HOUR,
+                 DISPLAY_NIGHT_END_HOUR, (unsigned long)DISPLAY_NIGHT_PCLK_HZ);
+#else
+  len = snprintf(reply, sizeof(reply), "NIGHT_MODE {\"error\":\"disabled\"}\n");
+#endif
+  serial_data_write(reply, len);
+  return true;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file display_activity.h
+ * @brief Idle/active policy for the display pipeline
+ *
+ * Touches keep the display active. After CONFIG_DISPLAY_IDLE_TIMEOUT_S
+ * without one, LVGL refreshes less often, the touch controller is polled
+ * more slowly, animations stop and the backlight dims. Once neither a touch
+ * nor telemetry has arrived for CONFIG_DISPLAY_STANDBY_TIMEOUT_S, the
+ * backlight fades out, after which RGB scan-out and rendering stop too. The
+ * first touch restores everything on the LVGL pass that reads it.
+ *
+ * Between CONFIG_DISPLAY_NIGHT_START_HOUR and CONFIG_DISPLAY_NIGHT_END_HOUR
+ * local time the display goes to night instead of idle: the night page
+ * (clock and active alerts only) is shown, refreshes come once a second,
+ * the backlight is barely on and the pixel clock drops so the frame buffer
+ * is scanned out of PSRAM less often. NIGHT_MODE ON|OFF|AUTO over the serial
+ * port forces it on or off at runtime; ON enters night at once.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#ifdef CONFIG_DISPLAY_IDLE_TIMEOUT_S
+#define DISPLAY_IDLE_TIMEOUT_S CONFIG_DISPLAY_IDLE_TIMEOUT_S
+#else
+#define DISPLAY_IDLE_TIMEOUT_S 30
+#endif
+
+// 0 keeps the backlight on while idle
+#ifdef CONFIG_DISPLAY_STANDBY_TIMEOUT_S
+#define DISPLAY_STANDBY_TIMEOUT_S CONFIG_DISPLAY_STANDBY_TIMEOUT_S
+#else
+#define DISPLAY_STANDBY_TIMEOUT_S 600
+#endif
+
+#ifdef CONFIG_DISPLAY_IDLE_REFR_PERIOD_MS
+#define DISPLAY_IDLE_REFR_PERIOD_MS CONFIG_DISPLAY_IDLE_REFR_PERIOD_MS
+#else
+#define DISPLAY_IDLE_REFR_PERIOD_MS 250
+#endif
+
+// Backlight while idle, percent
+#ifdef CONFIG_DISPLAY_IDLE_BACKLIGHT_LEVEL
+#define DISPLAY_IDLE_BACKLIGHT_LEVEL CONFIG_DISPLAY_IDLE_BACKLIGHT_LEVEL
+#else
+#define DISPLAY_IDLE_BACKLIGHT_LEVEL 30
+#endif
+
+#ifdef CONFIG_DISPLAY_DIM_FADE_MS
+#define DISPLAY_DIM_FADE_MS CONFIG_DISPLAY_DIM_FADE_MS
+#else
+#define DISPLAY_DIM_FADE_MS 1500
+#endif
+
+#define DISPLAY_WAKE_FADE_MS 120 // Short enough to feel instant, long enough not to flash
+
+#ifdef CONFIG_DISPLAY_IDLE_TOUCH_POLL_MS
+#define DISPLAY_IDLE_TOUCH_POLL_MS CONFIG_DISPLAY_IDLE_TOUCH_POLL_MS
+#else
+#define DISPLAY_IDLE_TOUCH_POLL_MS 100
+#endif
+
+// Local hours, night runs from start up to end and may wrap midnight
+#ifdef CONFIG_DISPLAY_NIGHT_START_HOUR
+#define DISPLAY_NIGHT_START_HOUR CONFIG_DISPLAY_NIGHT_START_HOUR
+#define DISPLAY_NIGHT_END_HOUR CONFIG_DISPLAY_NIGHT_END_HOUR
+#else
+#define DISPLAY_NIGHT_START_HOUR 22
+#define DISPLAY_NIGHT_END_HOUR 7
+#endif
+
+#ifdef CONFIG_DISPLAY_NIGHT_REFR_PERIOD_MS
+#define DISPLAY_NIGHT_REFR_PERIOD_MS CONFIG_DISPLAY_NIGHT_REFR_PERIOD_MS
+#else
+#define DISPLAY_NIGHT_REFR_PERIOD_MS 1000
+#endif
+
+// Backlight at night, percent
+#ifdef CONFIG_DISPLAY_NIGHT_BACKLIGHT_LEVEL
+#define DISPLAY_NIGHT_BACKLIGHT_LEVEL CONFIG_DISPLAY_NIGHT_BACKLIGHT_LEVEL
+#else
+#define DISPLAY_NIGHT_BACKLIGHT_LEVEL 5
+#endif
+
+#ifdef CONFIG_DISPLAY_NIGHT_PCLK_MHZ
+#define DISPLAY_NIGHT_PCLK_HZ (CONFIG_DISPLAY_NIGHT_PCLK_MHZ * 1000 * 1000)
+#else
+#define DISPLAY_NIGHT_PCLK_HZ (10 * 1000 * 1000)
+#endif
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef enum
+{
+  DISPLAY_ACTIVITY_ACTIVE = 0, // Touched recently, full rates
+  DISPLAY_ACTIVITY_IDLE,       // Reduced rates, animations paused, backlight dimmed
+  DISPLAY_ACTIVITY_STANDBY,    // Backlight off, then display asleep
+  DISPLAY_ACTIVITY_NIGHT,      // Idle at night: night page, slow refresh and pixel clock, backlight low
+} display_activity_state_t;
+
+typedef enum
+{
+  DISPLAY_NIGHT_AUTO = 0, // Night by the configured hours, once the clock is synced
+  DISPLAY_NIGHT_ON,       // Always night instead of idle
+  DISPLAY_NIGHT_OFF,      // Never night
+} display_night_mode_t;
+
+/**
+ * @brief State change callback, runs in the LVGL task with the LVGL lock held
+ * @param state State just entered
+ */
+typedef void (*display_activity_cb_t)(display_activity_state_t state);
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Start tracking activity
+ * @param display Display whose refresh timer and inactivity time are used
+ * @param indev Touch input device, NULL if touch is unavailable
+ * @note Call with the LVGL lock held or before the LVGL task starts, after
+ *       the refresh period and touch reads are set up
+ */
+void display_activity_init(lv_display_t *display, lv_indev_t *indev);
+
+/**
+ * @brief Apply the state for the current inactivity time
+ * @note Called by the LVGL task with the LVGL lock held, after input is read
+ */
+void display_activity_process(void);
+
+/**
+ * @brief Telemetry arrived, keeps the panel out of standby
+ * @note Callable from any task
+ */
+void display_activity_notify_telemetry(void);
+
+/**
+ * @brief Current state
+ */
+display_activity_state_t display_activity_get_state(void);
+
+/**
+ * @brief Register the state change callback
+ * @param callback Called on every transition, NULL to remove
+ */
+void display_activity_register_callback(display_activity_cb_t callback);
+
+/**
+ * @brief Force night mode on or off, or go back to the schedule
+ * @param mode DISPLAY_NIGHT_ON also enters night without waiting for the idle timeout
+ * @note Callable from any task, applied on the next LVGL pass
+ */
+void display_activity_set_night_mode(display_night_mode_t mode);
+
+/**
+ * @brief Handle NIGHT_MODE [ON|OFF|AUTO]
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a night mode command
+ */
+bool display_activity_handle_command(const char *line);
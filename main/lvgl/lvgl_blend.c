@@ -0,0 +1,199 @@
+/**
+ * @file lvgl_blend.c
+ * @brief RGB565 row kernels behind LVGL's software blender
+ *
+ * The vector loops keep q0 to one asm statement each, nothing is assumed
+ * about vector registers between statements. FreeRTOS saves the PIE state
+ * of a task that used it when another task wants the unit.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "lvgl_blend.h"
+
+#include <stdint.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define LVGL_BLEND_PIE 1
+#endif
+
+// Green in the high half, red and blue in the low half, with room above
+// each channel for the multiply
+#define RGB565_SPREAD_MASK 0x07E0F81FU
+
+// Clears the low bit of each channel so the shift stays inside it
+#define RGB565_HALF_MASK 0xF7DEF7DEU
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static inline uint32_t spread(uint16_t c)
+{
+  return ((uint32_t)c | ((uint32_t)c << 16)) & RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t mix_spread(uint32_t fg, uint32_t bg, uint32_t a32)
+{
+  uint32_t r = ((((fg - bg) * a32) >> 5) + bg) & RGB565_SPREAD_MASK;
+  return (uint16_t)((r >> 16) | r);
+}
+
+static inline uint16_t half_mix(uint16_t a, uint16_t b)
+{
+  return (a & b) + (((a ^ b) & (uint16_t)RGB565_HALF_MASK) >> 1);
+}
+
+/**
+ * @brief 50 % mix, two pixels per word where dst and src allow it
+ */
+static void half_mix_rgb565(uint16_t *dst, const uint16_t *src, uint32_t len)
+{
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0)
+  {
+    if (len && ((uintptr_t)dst & 2))
+    {
+      *dst = half_mix(*dst, *src++);
+      dst++;
+      len--;
+    }
+    uint32_t *dst2 = (uint32_t *)dst;
+    const uint32_t *src2 = (const uint32_t *)src;
+    for (uint32_t words = len >> 1; words; words--)
+    {
+      uint32_t a = *dst2, b = *src2++;
+      *dst2++ = (a & b) + (((a ^ b) & RGB565_HALF_MASK) >> 1);
+    }
+    dst = (uint16_t *)dst2;
+    src = (const uint16_t *)src2;
+    len &= 1;
+  }
+  while (len--)
+  {
+    *dst = half_mix(*dst, *src++);
+    dst++;
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void lvgl_blend_fill_rgb565(uint16_t *dst, uint16_t color, uint32_t len)
+{
+#if LVGL_BLEND_PIE
+  while (len && ((uintptr_t)dst & 15))
+  {
+    *dst++ = color;
+    len--;
+  }
+  uint32_t blocks = len >> 3;
+  if (blocks)
+  {
+    // color in all eight lanes of q0, then one 128-bit store per 8 pixels
+    __asm__ volatile("ee.vldbc.16 q0, %[c]\n"
+                     "1:\n"
+                     "ee.vst.128.ip q0, %[d], 16\n"
+                     "addi %[n], %[n], -1\n"
+                     "bnez %[n], 1b\n"
+                     : [d] "+r"(dst), [n] "+r"(blocks)
+                     : [c] "r"(&color)
+                     : "memory");
+    len &= 7;
+  }
+#endif
+  if (len && ((uintptr_t)dst & 2))
+  {
+    *dst++ = color;
+    len--;
+  }
+  uint32_t c2 = ((uint32_t)color << 16) | color;
+  uint32_t *dst2 = (uint32_t *)dst;
+  for (uint32_t words = len >> 1; words; words--)
+  {
+    *dst2++ = c2;
+  }
+  if (len & 1)
+    *(uint16_t *)dst2 = color;
+}
+
+void lvgl_blend_copy_rgb565(uint16_t *dst, const uint16_t *src, uint32_t len)
+{
+#if LVGL_BLEND_PIE
+  if ((((uintptr_t)dst ^ (uintptr_t)src) & 15) == 0)
+  {
+    while (len && ((uintptr_t)dst & 15))
+    {
+      *dst++ = *src++;
+      len--;
+    }
+    uint32_t blocks = len >> 3;
+    if (blocks)
+    {
+      __asm__ volatile("1:\n"
+                       "ee.vld.128.ip q0, %[s], 16\n"
+                       "ee.vst.128.ip q0, %[d], 16\n"
+                       "addi %[n], %[n], -1\n"
+                       "bnez %[n], 1b\n"
+                       : [d] "+r"(dst), [s] "+r"(src), [n] "+r"(blocks)
+                       :
+                       : "memory");
+      len &= 7;
+    }
+  }
+#endif
+  memcpy(dst, src, len * sizeof(uint16_t));
+}
+
+void lvgl_blend_mix_color_rgb565(uint16_t *dst, uint16_t color, uint32_t len, uint8_t opa)
+{
+  uint32_t a32 = ((uint32_t)opa + 4) >> 3;
+  if (a32 == 0 || len == 0)
+    return;
+  if (a32 == 32)
+  {
+    lvgl_blend_fill_rgb565(dst, color, len);
+    return;
+  }
+
+  // The color side of the multiply is the same for every pixel
+  uint32_t fg = spread(color);
+  uint16_t last_bg = ~*dst;
+  uint16_t last_out = 0;
+  while (len--)
+  {
+    // Runs of one background color are the common case, mix each once
+    if (*dst != last_bg)
+    {
+      last_bg = *dst;
+      last_out = mix_spread(fg, spread(last_bg), a32);
+    }
+    *dst++ = last_out;
+  }
+}
+
+void lvgl_blend_mix_rgb565(uint16_t *dst, const uint16_t *src, uint32_t len, uint8_t opa)
+{
+  uint32_t a32 = ((uint32_t)opa + 4) >> 3;
+  if (a32 == 0)
+    return;
+  if (a32 == 32)
+  {
+    lvgl_blend_copy_rgb565(dst, src, len);
+    return;
+  }
+  if (a32 == 16)
+  {
+    half_mix_rgb565(dst, src, len);
+    return;
+  }
+
+  while (len--)
+  {
+    *dst = mix_spread(spread(*src++), spread(*dst), a32);
+    dst++;
+  }
+}
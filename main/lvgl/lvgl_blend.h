@@ -0,0 +1,46 @@
+/**
+ * @file lvgl_blend.h
+ * @brief RGB565 row kernels behind LVGL's software blender
+ *
+ * Fill and copy store 16 bytes at a time through the ESP32-S3 PIE vector
+ * unit once the destination is 16 byte aligned, with a scalar head and tail.
+ * The opacity mixes work two pixels per word for 50 % and mix all three
+ * channels with one multiply otherwise. On other targets every kernel is
+ * plain C.
+ *
+ * LVGL reaches them through lvgl_blend_hooks.h, which the lvgl component
+ * includes when CONFIG_LV_DRAW_SW_ASM_CUSTOM is set.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// =======================================================================
+// PUBLIC FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief dst[0..len) = color
+ */
+void lvgl_blend_fill_rgb565(uint16_t *dst, uint16_t color, uint32_t len);
+
+/**
+ * @brief dst[0..len) = src[0..len)
+ * @note The vector path needs dst and src to share their 16 byte alignment,
+ *       as rows of two full-width buffers do
+ */
+void lvgl_blend_copy_rgb565(uint16_t *dst, const uint16_t *src, uint32_t len);
+
+/**
+ * @brief dst[i] = color * opa + dst[i] * (255 - opa), opa in 1/32 steps
+ */
+void lvgl_blend_mix_color_rgb565(uint16_t *dst, uint16_t color, uint32_t len, uint8_t opa);
+
+/**
+ * @brief dst[i] = src[i] * opa + dst[i] * (255 - opa), opa in 1/32 steps
+ */
+void lvgl_blend_mix_rgb565(uint16_t *dst, const uint16_t *src, uint32_t len, uint8_t opa);
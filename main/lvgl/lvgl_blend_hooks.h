@@ -0,0 +1,57 @@
+/**
+ * @file lvgl_blend_hooks.h
+ * @brief LV_DRAW_SW_ASM_CUSTOM hooks for RGB565 destinations
+ *
+ * Included by LVGL's own blend sources, not by the application: set
+ * CONFIG_LV_DRAW_SW_ASM_CUSTOM and CONFIG_LV_DRAW_SW_ASM_CUSTOM_INCLUDE to
+ * "lvgl_blend_hooks.h". Each hook returns LV_RESULT_INVALID for a case it
+ * does not take, LVGL then runs its generic loop. Masked fills and images
+ * (anti-aliased edges, rounded corners) stay with LVGL.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "lvgl_blend.h"
+
+// =======================================================================
+// HOOKS
+// =======================================================================
+
+static inline lv_result_t lvgl_blend_hook_fill(lv_draw_sw_blend_fill_dsc_t *dsc)
+{
+  uint16_t color = lv_color_to_u16(dsc->color);
+  uint8_t *row = dsc->dest_buf;
+  for (int32_t y = 0; y < dsc->dest_h; y++)
+  {
+    if (dsc->opa >= LV_OPA_MAX)
+      lvgl_blend_fill_rgb565((uint16_t *)row, color, dsc->dest_w);
+    else
+      lvgl_blend_mix_color_rgb565((uint16_t *)row, color, dsc->dest_w, dsc->opa);
+    row += dsc->dest_stride;
+  }
+  return LV_RESULT_OK;
+}
+
+static inline lv_result_t lvgl_blend_hook_image(lv_draw_sw_blend_image_dsc_t *dsc)
+{
+  uint8_t *row = dsc->dest_buf;
+  const uint8_t *src = dsc->src_buf;
+  for (int32_t y = 0; y < dsc->dest_h; y++)
+  {
+    if (dsc->opa >= LV_OPA_MAX)
+      lvgl_blend_copy_rgb565((uint16_t *)row, (const uint16_t *)src, dsc->dest_w);
+    else
+      lvgl_blend_mix_rgb565((uint16_t *)row, (const uint16_t *)src, dsc->dest_w, dsc->opa);
+    row += dsc->dest_stride;
+    src += dsc->src_stride;
+  }
+  return LV_RESULT_OK;
+}
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) lvgl_blend_hook_fill(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc) lvgl_blend_hook_fill(dsc)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) lvgl_blend_hook_image(dsc)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc) lvgl_blend_hook_image(dsc)
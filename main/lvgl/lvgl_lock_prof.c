@@ -0,0 +1,304 @@
+/**
+ * @file lvgl_lock_prof.c
+ * @brief Contention profile of the LVGL lock per call site
+ *
+ * The holder fields are only written by the task that holds the LVGL lock,
+ * but are read by waiters and the serial task, so they share a spinlock
+ * with the site table. Sites are keyed by the __func__ pointer, which is
+ * one string per function.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "lvgl_lock_prof.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl_setup.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+#if CONFIG_LVGL_LOCK_PROFILER
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  const char *site;
+  char task[configMAX_TASK_NAME_LEN]; ///< Last task that took the lock here
+  uint32_t timeouts;
+  const char *blocked_by; ///< Holder when the longest wait began
+  lvgl_metrics_hist_t wait_us;
+  lvgl_metrics_hist_t hold_us;
+} lock_site_t;
+
+static portMUX_TYPE prof_lock = portMUX_INITIALIZER_UNLOCKED;
+static lock_site_t sites[LVGL_LOCK_PROF_SITES];
+static uint32_t site_count = 0;
+static uint32_t dropped = 0;
+
+// Outermost hold, written by the holding task
+static lock_site_t *holder = NULL;
+static uint32_t holder_depth = 0;
+static int64_t holder_since_us = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void hist_add(lvgl_metrics_hist_t *hist, uint32_t value)
+{
+  uint32_t scaled = value >> LVGL_METRICS_TIME_SHIFT;
+  uint32_t bucket = scaled ? (32 - __builtin_clz(scaled)) : 0;
+  if (bucket >= LVGL_METRICS_HIST_BUCKETS)
+    bucket = LVGL_METRICS_HIST_BUCKETS - 1;
+  hist->buckets[bucket]++;
+  hist->count++;
+  hist->sum += value;
+  if (value > hist->max)
+    hist->max = value;
+}
+
+/**
+ * @brief Entry of a site, created on first use, prof_lock held
+ * @return NULL when the table is full
+ */
+static lock_site_t *find_site(const char *site)
+{
+  for (uint32_t i = 0; i < site_count; i++)
+  {
+    if (sites[i].site == site)
+      return &sites[i];
+  }
+  if (site_count == LVGL_LOCK_PROF_SITES)
+  {
+    dropped++;
+    return NULL;
+  }
+  lock_site_t *entry = &sites[site_count++];
+  memset(entry, 0, sizeof(*entry));
+  entry->site = site;
+  return entry;
+}
+
+static int format_hist(char *buf, size_t size, const char *name, const lvgl_metrics_hist_t *hist)
+{
+  int len = snprintf(buf, size, "\"%s\":{\"n\":%lu,\"avg\":%lu,\"max\":%lu,\"h\":[", name,
+                     (unsigned long)hist->count, (unsigned long)(hist->count ? hist->sum / hist->count : 0),
+                     (unsigned long)hist->max);
+  for (int i = 0; i < LVGL_METRICS_HIST_BUCKETS && len > 0 && (size_t)len < size; i++)
+    len += snprintf(buf + len, size - len, "%s%lu", i ? "," : "", (unsigned long)hist->buckets[i]);
+  if (len > 0 && (size_t)len < size)
+    len += snprintf(buf + len, size - len, "]}");
+  return len;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+const char *lvgl_lock_prof_begin_wait(void)
+{
+  portENTER_CRITICAL(&prof_lock);
+  const char *site = holder ? holder->site : NULL;
+  portEXIT_CRITICAL(&prof_lock);
+  return site;
+}
+
+void lvgl_lock_prof_end_wait(const char *site, const char *blocker, int64_t wait_us, bool acquired)
+{
+  const char *task = pcTaskGetName(NULL);
+  int64_t now_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&prof_lock);
+  lock_site_t *entry = find_site(site);
+  if (acquired && holder_depth++ > 0)
+  {
+    // Recursive take, the outer hold goes on
+    portEXIT_CRITICAL(&prof_lock);
+    return;
+  }
+  if (entry)
+  {
+    strlcpy(entry->task, task, sizeof(entry->task));
+    if (blocker && (uint32_t)wait_us >= entry->wait_us.max)
+      entry->blocked_by = blocker;
+    hist_add(&entry->wait_us, (uint32_t)wait_us);
+    if (!acquired)
+      entry->timeouts++;
+  }
+  if (acquired)
+  {
+    holder = entry;
+    holder_since_us = now_us;
+  }
+  portEXIT_CRITICAL(&prof_lock);
+}
+
+void lvgl_lock_prof_release(void)
+{
+  int64_t now_us = esp_timer_get_time();
+  const char *site = NULL;
+  uint32_t held_us = 0;
+
+  portENTER_CRITICAL(&prof_lock);
+  if (holder_depth > 0 && --holder_depth == 0)
+  {
+    held_us = (uint32_t)(now_us - holder_since_us);
+    if (holder)
+    {
+      hist_add(&holder->hold_us, held_us);
+      site = holder->site;
+    }
+    holder = NULL;
+  }
+  portEXIT_CRITICAL(&prof_lock);
+
+  if (site && held_us >= CONFIG_LVGL_LOCK_PROF_WARN_MS * 1000u)
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "LVGL lock held %lu ms by %s (%s)", (unsigned long)(held_us / 1000),
+                        site, pcTaskGetName(NULL));
+}
+
+void lvgl_lock_prof_format_holder(char *buf, size_t size)
+{
+  int64_t now_us = esp_timer_get_time();
+  char task[configMAX_TASK_NAME_LEN] = "";
+  const char *site = NULL;
+  int64_t since_us = 0;
+
+  portENTER_CRITICAL(&prof_lock);
+  if (holder)
+  {
+    site = holder->site;
+    strlcpy(task, holder->task, sizeof(task));
+    since_us = holder_since_us;
+  }
+  portEXIT_CRITICAL(&prof_lock);
+
+  if (site)
+    snprintf(buf, size, ", held by %s (%s) for %lld ms", site, task, (long long)((now_us - since_us) / 1000));
+  else if (size)
+    buf[0] = '\0';
+}
+
+bool lvgl_lock_prof_handle_command(const char *line)
+{
+  if (strcmp(line, "LVGL_LOCKS RESET") == 0)
+  {
+    portENTER_CRITICAL(&prof_lock);
+    for (uint32_t i = 0; i < site_count; i++)
+    {
+      sites[i].timeouts = 0;
+      sites[i].blocked_by = NULL;
+      memset(&sites[i].wait_us, 0, sizeof(sites[i].wait_us));
+      memset(&sites[i].hold_us, 0, sizeof(sites[i].hold_us));
+    }
+    dropped = 0;
+    portEXIT_CRITICAL(&prof_lock);
+    static const char ok[] = "LVGL_LOCKS {\"reset\":true}\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+    return true;
+  }
+  if (strcmp(line, "GET_LVGL_LOCKS") != 0)
+    return false;
+
+  // Snapshot first, formatting under a spinlock would stall both lock paths
+  static lock_site_t snapshot[LVGL_LOCK_PROF_SITES];
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&prof_lock);
+  uint32_t count = site_count;
+  uint32_t dropped_count = dropped;
+  memcpy(snapshot, sites, count * sizeof(snapshot[0]));
+  const char *holder_site = holder ? holder->site : NULL;
+  char holder_task[configMAX_TASK_NAME_LEN] = "";
+  if (holder)
+    strlcpy(holder_task, holder->task, sizeof(holder_task));
+  int64_t held_ms = holder ? (now_us - holder_since_us) / 1000 : 0;
+  portEXIT_CRITICAL(&prof_lock);
+
+  // Worst hold first, a handful of sites so insertion sort does
+  for (uint32_t i = 1; i < count; i++)
+  {
+    lock_site_t entry = snapshot[i];
+    uint32_t j = i;
+    for (; j > 0 && snapshot[j - 1].hold_us.max < entry.hold_us.max; j--)
+      snapshot[j] = snapshot[j - 1];
+    snapshot[j] = entry;
+  }
+
+  char reply[512];
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const lock_site_t *entry = &snapshot[i];
+    int len = snprintf(reply, sizeof(reply),
+                       "LVGL_LOCK {\"site\":\"%s\",\"task\":\"%s\",\"n\":%lu,\"timeouts\":%lu,\"blocked_by\":",
+                       entry->site, entry->task, (unsigned long)entry->hold_us.count,
+                       (unsigned long)entry->timeouts);
+    if (len > 0 && (size_t)len < sizeof(reply))
+      len += snprintf(reply + len, sizeof(reply) - len, entry->blocked_by ? "\"%s\"," : "null,",
+                      entry->blocked_by);
+    if (len > 0 && (size_t)len < sizeof(reply))
+      len += format_hist(reply + len, sizeof(reply) - len, "wait_us", &entry->wait_us);
+    if (len > 0 && (size_t)len < sizeof(reply))
+      len += snprintf(reply + len, sizeof(reply) - len, ",");
+    if (len > 0 && (size_t)len < sizeof(reply))
+      len += format_hist(reply + len, sizeof(reply) - len, "hold_us", &entry->hold_us);
+    if (len > 0 && (size_t)len < sizeof(reply) - 2)
+    {
+      len += snprintf(reply + len, sizeof(reply) - len, "}\n");
+      serial_data_write(reply, len);
+    }
+  }
+
+  int len = snprintf(reply, sizeof(reply), "LVGL_LOCKS {\"sites\":%lu,\"dropped\":%lu,\"holder\":",
+                     (unsigned long)count, (unsigned long)dropped_count);
+  if (holder_site)
+    len += snprintf(reply + len, sizeof(reply) - len, "{\"site\":\"%s\",\"task\":\"%s\",\"ms\":%lld}}\n",
+                    holder_site, holder_task, (long long)held_ms);
+  else
+    len += snprintf(reply + len, sizeof(reply) - len, "null}\n");
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+const char *lvgl_lock_prof_begin_wait(void)
+{
+  return NULL;
+}
+
+void lvgl_lock_prof_end_wait(const char *site, const char *blocker, int64_t wait_us, bool acquired)
+{
+  (void)site;
+  (void)blocker;
+  (void)wait_us;
+  (void)acquired;
+}
+
+void lvgl_lock_prof_release(void)
+{
+}
+
+void lvgl_lock_prof_format_holder(char *buf, size_t size)
+{
+  if (size)
+    buf[0] = '\0';
+}
+
+bool lvgl_lock_prof_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_LVGL_LOCKS") != 0 && strcmp(line, "LVGL_LOCKS RESET") != 0)
+    return false;
+  static const char disabled[] = "LVGL_LOCKS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_LVGL_LOCK_PROFILER
@@ -0,0 +1,79 @@
+/**
+ * @file lvgl_lock_prof.h
+ * @brief Contention profile of the LVGL lock per call site
+ *
+ * lvgl_port_lock() records, for the function it was called from, how long
+ * the caller waited, how long it then held the lock, how often it timed out
+ * and which site held the lock when its longest wait began. The site is the
+ * caller's __func__, passed in by the lvgl_port_lock() macro, so several
+ * calls in one function share an entry. Only the outermost of recursive
+ * takes counts as a hold.
+ *
+ * Holds longer than CONFIG_LVGL_LOCK_PROF_WARN_MS are logged as they end,
+ * and a timed-out lvgl_port_lock() names the holder. lvgl_port_task holds
+ * the lock for whole LVGL passes, so long holds there come from an update
+ * handler or an event handler that blocks, e.g. on HTTP; the trace spans
+ * (trace_spans.h) tell which.
+ *
+ * GET_LVGL_LOCKS replies with one line per site, worst hold first, then a
+ * summary with the current holder:
+ *   LVGL_LOCK {"site":"controls_panel_get_switch","task":"ha_worker","n":12,"timeouts":1,
+ *              "blocked_by":"lvgl_port_task","wait_us":{...},"hold_us":{...}}
+ *   LVGL_LOCKS {"sites":5,"dropped":0,"holder":{"site":"lvgl_port_task","task":"LVGL","ms":3}}
+ * The histograms are those of GET_DISPLAY_METRICS (LVGL_METRICS_TIME_SHIFT
+ * buckets) and cover everything since boot or LVGL_LOCKS RESET.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define LVGL_LOCK_PROF_SITES 16 ///< Call sites tracked, later ones only count as dropped
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Site holding the lock right now, before a caller starts to wait
+ * @return Site name, NULL when free or the profiler is disabled
+ */
+const char *lvgl_lock_prof_begin_wait(void);
+
+/**
+ * @brief Record the end of a wait in lvgl_port_lock()
+ * @param site Caller's __func__
+ * @param blocker What lvgl_lock_prof_begin_wait() returned
+ * @param wait_us Time spent waiting
+ * @param acquired true if the caller now holds the lock
+ */
+void lvgl_lock_prof_end_wait(const char *site, const char *blocker, int64_t wait_us, bool acquired);
+
+/**
+ * @brief Record a release in lvgl_port_unlock(), before the lock is given back
+ */
+void lvgl_lock_prof_release(void);
+
+/**
+ * @brief Describe the current holder for a timeout message
+ * @param buf Output, ", held by <site> (<task>) for <n> ms" or empty
+ * @param size Size of buf
+ */
+void lvgl_lock_prof_format_holder(char *buf, size_t size);
+
+/**
+ * @brief Handle GET_LVGL_LOCKS and LVGL_LOCKS RESET
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a lock profiler command
+ */
+bool lvgl_lock_prof_handle_command(const char *line);
@@ -0,0 +1,339 @@
+/**
+ * @file lvgl_mem.c
+ * @brief LVGL heap split into an internal and a PSRAM pool
+ *
+ * Both pools are ESP-IDF multi_heap instances, the same TLSF allocator
+ * behind heap_caps_malloc(), registered on memory that belongs to LVGL
+ * alone: a static array in internal RAM and one PSRAM block taken at
+ * lv_init(). A pointer's pool follows from its address. Each pool has its
+ * own spinlock, so lv_malloc() stays safe outside the LVGL lock as it was
+ * with the builtin heap.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "lvgl_mem.h"
+
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "lvgl.h"
+#include "multi_heap.h"
+#include "utils/metrics.h"
+#include "utils/system_debug_utils.h"
+
+#ifndef CONFIG_LVGL_MEM_PSRAM_POOL_KB
+#define CONFIG_LVGL_MEM_PSRAM_POOL_KB 0
+#endif
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  multi_heap_handle_t heap;
+  uint8_t *start;
+  size_t size;
+  portMUX_TYPE lock;
+  uint32_t fallbacks;
+} mem_pool_t;
+
+typedef enum
+{
+  POOL_STAT_FREE = 0,
+  POOL_STAT_MIN_FREE,
+  POOL_STAT_LARGEST_FREE,
+  POOL_STAT_FRAG_PCT,
+  POOL_STAT_FALLBACKS,
+} pool_stat_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Internal RAM, like the builtin heap's work_mem_int it replaces
+static WORD_ALIGNED_ATTR uint8_t internal_pool_mem[CONFIG_LVGL_MEM_INTERNAL_POOL_KB * 1024];
+
+static mem_pool_t pools[LVGL_MEM_POOL_COUNT] = {
+    [LVGL_MEM_POOL_INTERNAL] = {.lock = portMUX_INITIALIZER_UNLOCKED},
+    [LVGL_MEM_POOL_PSRAM] = {.lock = portMUX_INITIALIZER_UNLOCKED},
+};
+
+static int64_t read_pool_metric(const metric_t *metric);
+
+#define POOL_METRIC_ARG(pool_, stat_) (((pool_) << 8) | (stat_))
+#define POOL_METRIC(type_, name_, help_, stat_)                                                      \
+  METRIC_READ_INIT(type_, name_, help_, "pool=\"internal\"", read_pool_metric,                      \
+                   POOL_METRIC_ARG(LVGL_MEM_POOL_INTERNAL, stat_)),                                  \
+      METRIC_READ_INIT(type_, name_, help_, "pool=\"psram\"", read_pool_metric,                     \
+                       POOL_METRIC_ARG(LVGL_MEM_POOL_PSRAM, stat_))
+
+static metric_t pool_metrics[] = {
+    POOL_METRIC(METRIC_TYPE_GAUGE, "lvgl_mem_free_bytes", "Free bytes in an LVGL pool", POOL_STAT_FREE),
+    POOL_METRIC(METRIC_TYPE_GAUGE, "lvgl_mem_min_free_bytes", "Lowest free bytes in an LVGL pool since boot",
+                POOL_STAT_MIN_FREE),
+    POOL_METRIC(METRIC_TYPE_GAUGE, "lvgl_mem_largest_free_block_bytes", "Largest allocatable block in an LVGL pool",
+                POOL_STAT_LARGEST_FREE),
+    POOL_METRIC(METRIC_TYPE_GAUGE, "lvgl_mem_frag_percent", "Free bytes of an LVGL pool outside its largest block",
+                POOL_STAT_FRAG_PCT),
+    POOL_METRIC(METRIC_TYPE_COUNTER, "lvgl_mem_fallback_total", "LVGL allocations served by the other pool",
+                POOL_STAT_FALLBACKS),
+};
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static bool pool_register(mem_pool_t *pool, uint8_t *start, size_t size)
+{
+  pool->heap = multi_heap_register(start, size);
+  if (!pool->heap)
+    return false;
+  multi_heap_set_lock(pool->heap, &pool->lock);
+  pool->start = start;
+  pool->size = size;
+  return true;
+}
+
+static mem_pool_t *pool_of(const void *p)
+{
+  const uint8_t *addr = p;
+  for (int i = 0; i < LVGL_MEM_POOL_COUNT; i++)
+  {
+    if (pools[i].heap && addr >= pools[i].start && addr < pools[i].start + pools[i].size)
+      return &pools[i];
+  }
+  return NULL;
+}
+
+static lvgl_mem_pool_id_t preferred_pool(size_t size)
+{
+  if (size > CONFIG_LVGL_MEM_SMALL_MAX && pools[LVGL_MEM_POOL_PSRAM].heap)
+    return LVGL_MEM_POOL_PSRAM;
+  return LVGL_MEM_POOL_INTERNAL;
+}
+
+static void *pool_malloc(size_t size)
+{
+  lvgl_mem_pool_id_t id = preferred_pool(size);
+  if (!pools[id].heap)
+    return NULL;
+  void *p = multi_heap_malloc(pools[id].heap, size);
+  if (p)
+    return p;
+
+  mem_pool_t *other = &pools[id == LVGL_MEM_POOL_INTERNAL ? LVGL_MEM_POOL_PSRAM : LVGL_MEM_POOL_INTERNAL];
+  if (!other->heap)
+    return NULL;
+  p = multi_heap_malloc(other->heap, size);
+  if (p)
+    other->fallbacks++;
+  return p;
+}
+
+static int64_t read_pool_metric(const metric_t *metric)
+{
+  lvgl_mem_pool_stats_t stats;
+  lvgl_mem_get_stats((lvgl_mem_pool_id_t)(metric->arg >> 8), &stats);
+
+  switch ((pool_stat_t)(metric->arg & 0xFF))
+  {
+  case POOL_STAT_FREE:
+    return stats.free;
+  case POOL_STAT_MIN_FREE:
+    return stats.min_free;
+  case POOL_STAT_LARGEST_FREE:
+    return stats.largest_free;
+  case POOL_STAT_FRAG_PCT:
+    return stats.frag_pct;
+  default:
+    return stats.fallbacks;
+  }
+}
+
+// =======================================================================
+// LVGL MEMORY CORE (LV_STDLIB_CUSTOM)
+// =======================================================================
+
+void lv_mem_init(void)
+{
+  if (pools[LVGL_MEM_POOL_INTERNAL].heap)
+    return;
+
+  if (!pool_register(&pools[LVGL_MEM_POOL_INTERNAL], internal_pool_mem, sizeof(internal_pool_mem)))
+  {
+    debug_log_error(DEBUG_TAG_LVGL_SETUP, "LVGL internal pool could not be created");
+    return;
+  }
+
+#if CONFIG_LVGL_MEM_PSRAM_POOL_KB > 0
+  size_t psram_size = CONFIG_LVGL_MEM_PSRAM_POOL_KB * 1024;
+  uint8_t *psram = heap_caps_malloc(psram_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!psram || !pool_register(&pools[LVGL_MEM_POOL_PSRAM], psram, psram_size))
+  {
+    // Everything lands in the internal pool, as with the builtin heap
+    heap_caps_free(psram);
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "LVGL PSRAM pool (%u KB) unavailable, internal pool only",
+                        (unsigned)CONFIG_LVGL_MEM_PSRAM_POOL_KB);
+    return;
+  }
+#endif
+
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL heap: %u KB internal, %u KB PSRAM, > %u bytes to PSRAM",
+                   (unsigned)CONFIG_LVGL_MEM_INTERNAL_POOL_KB, (unsigned)CONFIG_LVGL_MEM_PSRAM_POOL_KB,
+                   (unsigned)CONFIG_LVGL_MEM_SMALL_MAX);
+}
+
+void lv_mem_deinit(void)
+{
+  // LVGL has freed what it allocated; the static array needs no release
+  if (pools[LVGL_MEM_POOL_PSRAM].heap)
+    heap_caps_free(pools[LVGL_MEM_POOL_PSRAM].start);
+  for (int i = 0; i < LVGL_MEM_POOL_COUNT; i++)
+  {
+    pools[i].heap = NULL;
+    pools[i].start = NULL;
+    pools[i].size = 0;
+    pools[i].fallbacks = 0;
+  }
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+  // Both pools are fixed, see CONFIG_LVGL_MEM_*_POOL_KB
+  LV_UNUSED(mem);
+  LV_UNUSED(bytes);
+  return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+  LV_UNUSED(pool);
+}
+
+void *lv_malloc_core(size_t size)
+{
+  return pool_malloc(size);
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+  if (!p)
+    return lv_malloc_core(new_size);
+
+  mem_pool_t *owner = pool_of(p);
+  if (!owner)
+    return NULL;
+
+  // Grow or shrink in place while the block still belongs where it is
+  if (owner == &pools[preferred_pool(new_size)])
+  {
+    void *resized = multi_heap_realloc(owner->heap, p, new_size);
+    if (resized)
+      return resized;
+  }
+
+  // Move across pools, e.g. an array that outgrew CONFIG_LVGL_MEM_SMALL_MAX
+  void *moved = pool_malloc(new_size);
+  if (!moved)
+    return NULL;
+  size_t old_size = multi_heap_get_allocated_size(owner->heap, p);
+  memcpy(moved, p, LV_MIN(old_size, new_size));
+  multi_heap_free(owner->heap, p);
+  return moved;
+}
+
+void lv_free_core(void *p)
+{
+  mem_pool_t *owner = pool_of(p);
+  if (owner)
+    multi_heap_free(owner->heap, p);
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+  memset(mon_p, 0, sizeof(*mon_p));
+  size_t used = 0;
+  size_t max_used = 0;
+  for (int i = 0; i < LVGL_MEM_POOL_COUNT; i++)
+  {
+    if (!pools[i].heap)
+      continue;
+    multi_heap_info_t info;
+    multi_heap_get_info(pools[i].heap, &info);
+    mon_p->total_size += pools[i].size;
+    mon_p->free_size += info.total_free_bytes;
+    mon_p->free_cnt += info.free_blocks;
+    mon_p->used_cnt += info.allocated_blocks;
+    mon_p->free_biggest_size = LV_MAX(mon_p->free_biggest_size, info.largest_free_block);
+    used += info.total_allocated_bytes;
+    max_used += pools[i].size - info.minimum_free_bytes;
+  }
+
+  mon_p->max_used = max_used;
+  mon_p->used_pct = mon_p->total_size ? (uint8_t)(used * 100 / mon_p->total_size) : 0;
+  mon_p->frag_pct = mon_p->free_size
+                        ? (uint8_t)(100 - (uint64_t)mon_p->free_biggest_size * 100 / mon_p->free_size)
+                        : 0;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+  for (int i = 0; i < LVGL_MEM_POOL_COUNT; i++)
+  {
+    if (pools[i].heap && !multi_heap_check(pools[i].heap, true))
+      return LV_RESULT_INVALID;
+  }
+  return LV_RESULT_OK;
+}
+
+#endif // CONFIG_LV_USE_CUSTOM_MALLOC
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+void lvgl_mem_get_stats(lvgl_mem_pool_id_t pool, lvgl_mem_pool_stats_t *stats)
+{
+  if (!stats)
+    return;
+  memset(stats, 0, sizeof(*stats));
+
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+  if (pool >= LVGL_MEM_POOL_COUNT || !pools[pool].heap)
+    return;
+
+  multi_heap_info_t info;
+  multi_heap_get_info(pools[pool].heap, &info);
+  stats->total = pools[pool].size;
+  stats->free = info.total_free_bytes;
+  stats->min_free = info.minimum_free_bytes;
+  stats->largest_free = info.largest_free_block;
+  stats->used_blocks = (uint32_t)info.allocated_blocks;
+  stats->fallbacks = pools[pool].fallbacks;
+  stats->frag_pct = info.total_free_bytes
+                        ? (uint8_t)(100 - (uint64_t)info.largest_free_block * 100 / info.total_free_bytes)
+                        : 0;
+#else
+  (void)pool;
+#endif
+}
+
+void lvgl_mem_register_metrics(void)
+{
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+  // Internal and PSRAM series of a name alternate, so skipping a missing PSRAM pool keeps them adjacent
+  for (size_t i = 0; i < sizeof(pool_metrics) / sizeof(pool_metrics[0]); i++)
+  {
+    if (pools[pool_metrics[i].arg >> 8].heap)
+      metrics_register(&pool_metrics[i]);
+  }
+#endif
+}
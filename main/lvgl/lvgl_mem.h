@@ -0,0 +1,61 @@
+/**
+ * @file lvgl_mem.h
+ * @brief LVGL heap split into an internal and a PSRAM pool
+ *
+ * With CONFIG_LV_USE_CUSTOM_MALLOC, LVGL's lv_malloc_core() and friends
+ * live here instead of in LVGL's builtin TLSF heap. Allocations up to
+ * CONFIG_LVGL_MEM_SMALL_MAX bytes (objects, styles, draw tasks, event
+ * lists) come from a TLSF pool in internal RAM; larger ones (layer and
+ * image buffers, decoded fonts) come from a second TLSF pool in PSRAM, so
+ * they neither crowd the hot small blocks out of DRAM nor fragment it.
+ * Either pool serves the other's requests when it runs dry.
+ *
+ * lv_mem_monitor() reports both pools together; the metrics registry has
+ * each one separately.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =======================================================================
+// PUBLIC TYPES
+// =======================================================================
+
+typedef enum
+{
+  LVGL_MEM_POOL_INTERNAL = 0,
+  LVGL_MEM_POOL_PSRAM,
+  LVGL_MEM_POOL_COUNT,
+} lvgl_mem_pool_id_t;
+
+typedef struct
+{
+  size_t total;         ///< Pool size, 0 if the pool does not exist
+  size_t free;          ///< Free bytes
+  size_t min_free;      ///< Lowest free bytes since boot
+  size_t largest_free;  ///< Largest allocatable block
+  uint32_t used_blocks; ///< Live allocations
+  uint32_t fallbacks;   ///< Allocations meant for the other pool served here
+  uint8_t frag_pct;     ///< 100 - largest_free * 100 / free
+} lvgl_mem_pool_stats_t;
+
+// =======================================================================
+// PUBLIC FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Snapshot of one pool
+ * @note Any task; all zero without CONFIG_LV_USE_CUSTOM_MALLOC or before lv_init()
+ */
+void lvgl_mem_get_stats(lvgl_mem_pool_id_t pool, lvgl_mem_pool_stats_t *stats);
+
+/**
+ * @brief Register the per-pool lvgl_mem_* series with the metrics registry
+ * @note Call once after lv_init(); does nothing without CONFIG_LV_USE_CUSTOM_MALLOC
+ */
+void lvgl_mem_register_metrics(void);
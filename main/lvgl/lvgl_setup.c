@@ -8,20 +8,137 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/lock.h>
-#include <unistd.h>
-#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_async_memcpy.h"
+#include "esp_attr.h"
 #include "esp_err.h"
 #include "esp_heap_caps.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_rgb.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "soc/soc_caps.h"
+#include "src/core/lv_global.h"
+#include "display_activity.h"
 #include "gt911_touch.h"
+#include "lvgl_lock_prof.h"
+#include "lvgl_stall.h"
+#include "lvgl_mem.h"
+#include "utils/boot_graph.h"
+#include "utils/cpu_power.h"
+#include "utils/cycle_prof.h"
+#include "utils/metrics.h"
 #include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+#include "utils/touch_latency.h"
+#include "utils/trace_spans.h"
 
-static SemaphoreHandle_t lvgl_timeout_mutex = NULL;
+#if LV_USE_OS != LV_OS_FREERTOS
+#error "lvgl_port_lock() is LVGL's own lock and the draw threads need an OS, set CONFIG_LV_OS_FREERTOS"
+#endif
+
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+// Set by the flush callback, cleared by the vsync ISR once the swap took effect
+static volatile bool swap_pending = false;
+#endif
+
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+_Static_assert((LCD_V_RES % (2 * LCD_BOUNCE_BUFFER_LINES)) == 0,
+               "Frame buffer must be an even multiple of the bounce buffer size");
+
+// Updated from the panel ISR only, read with a plain copy
+static lvgl_bounce_stats_t bounce_stats = {0};
+static volatile bool bounce_frame_done = true;
+static int64_t bounce_last_frame_us = 0;
+#endif
+
+// The LVGL task blocks on its task notification; vsync, touch and UI updates wake it
+static TaskHandle_t lvgl_task_handle = NULL;
+
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+// One finished area on its way to the frame buffer
+typedef struct
+{
+  lv_display_t *disp;
+  esp_lcd_panel_handle_t panel;
+  lv_area_t area;
+  uint8_t *px_map;
+} flush_job_t;
+
+// Created only when both draw buffers were allocated; flush_idle is given while no copy is in flight
+static QueueHandle_t flush_queue = NULL;
+static SemaphoreHandle_t flush_idle = NULL;
+#endif
+
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+_Static_assert((LCD_H_RES % LVGL_GDMA_ALIGN_PX) == 0, "Rounded areas must stay on screen");
+
+// Set once the copier is installed, the flush task falls back to the RGB driver copy without it
+static async_memcpy_handle_t gdma_copier = NULL;
+static uint8_t *gdma_fb = NULL;
+static TaskHandle_t flush_task_handle = NULL;
+#endif
+
+// Drains queued widget updates inside the LVGL task before timers run
+static lvgl_update_handler_t update_handler = NULL;
+
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+// Armed by the LVGL task when work is due within a frame, consumed by the vsync ISR
+static volatile bool vsync_wakeup_armed = false;
+static uint32_t frame_period_ms = 0;
+#endif
+
+#if CONFIG_EXAMPLE_LCD_METRICS
+// Current and last complete metrics window, updated from the LVGL task and lock callers
+static portMUX_TYPE metrics_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static lvgl_metrics_t metrics_current = {0};
+static lvgl_metrics_t metrics_last = {0};
+static int64_t metrics_window_start_us = 0;
+
+// Capture over a caller-chosen span (benchmarks), fed alongside the window while active
+static lvgl_metrics_t metrics_capture = {0};
+static int64_t metrics_capture_start_us = 0;
+static bool metrics_capture_active = false;
+
+// Per-frame accumulators, only touched from the LVGL task
+static int64_t frame_start_us = 0;
+static int64_t flush_start_us = 0;
+static uint32_t frame_flush_us = 0;
+static uint32_t frame_inv_area_px = 0;
+static bool frame_flushed = false;
+#endif
+
+#if PIN_NUM_BK_LIGHT >= 0
+#define BK_LEDC_MODE LEDC_LOW_SPEED_MODE
+#define BK_LEDC_TIMER LEDC_TIMER_0
+#define BK_LEDC_CHANNEL LEDC_CHANNEL_0
+#define BK_LEDC_RESOLUTION LEDC_TIMER_10_BIT
+#define BK_LEDC_MAX_DUTY ((1U << BK_LEDC_RESOLUTION) - 1)
+
+// Serializes backlight changes, a new fade must stop the running one first
+static SemaphoreHandle_t backlight_mutex = NULL;
+static esp_timer_handle_t backlight_timer = NULL;
+static uint32_t backlight_level = LCD_BK_LIGHT_OFF_LEVEL;
+static uint32_t scheduled_level = LCD_BK_LIGHT_OFF_LEVEL;
+static uint32_t scheduled_fade_ms = 0;
+static bool scheduled_pending = false; ///< Cleared by any newer change, the timer may already have fired
+#endif
+
+// Display refresh period chosen by lvgl_setup_init()
+static uint32_t refr_period_ms = LV_DEF_REFR_PERIOD;
+
+// Display sleep, only changed with the LVGL lock held
+static bool display_asleep = false;
+static bool scanout_stopped = false;
+
+// Set by the GT911 touch task when the event-mode input device has a new report
+static lv_indev_t *touch_indev = NULL;
+static volatile bool touch_pending = false;
+
+CYCLE_PROF_SITE(lvgl_flush_cb);
 
 // Memory debugging helper function
 static void log_memory_status(const char *context)
@@ -34,26 +151,148 @@ static void log_memory_status(const char *context)
 
 // Static function prototypes (ordered by call sequence)
 static esp_err_t init_panel_config(esp_lcd_rgb_panel_config_t *panel_config);
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB || CONFIG_EXAMPLE_LCD_VSYNC_PACING
+static bool lvgl_notify_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx);
+#endif
+#if !CONFIG_EXAMPLE_USE_DOUBLE_FB
 static bool lvgl_notify_flush_ready(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx);
+#endif
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+static bool lvgl_bounce_on_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx);
+static bool lvgl_bounce_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx);
+#endif
+#if CONFIG_EXAMPLE_LCD_ISR_AWAY_FROM_WIFI
+static esp_err_t create_rgb_panel_on_core(const esp_lcd_rgb_panel_config_t *panel_config, esp_lcd_panel_handle_t *panel_handle, BaseType_t core_id);
+#endif
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+static size_t alloc_pingpong_buffers(void **buf1, void **buf2);
+static esp_err_t start_flush_task(lv_display_t *display);
+#endif
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+static void start_gdma_flush(lv_display_t *display);
+static bool gdma_flush(const flush_job_t *job);
+#endif
 static void lvgl_increase_tick(void *arg);
 static void lvgl_port_task(void *arg);
+static void lvgl_touch_ready(void);
+#if CONFIG_EXAMPLE_LCD_METRICS
+static void lvgl_metrics_event_cb(lv_event_t *e);
+static void lvgl_metrics_record_lock_wait(int64_t wait_us);
+static int64_t read_display_metric(const metric_t *metric);
+
+// Registry view of the last complete window, arg selects the figure
+enum
+{
+  DISPLAY_METRIC_FPS_X10,
+  DISPLAY_METRIC_RENDER_US,
+  DISPLAY_METRIC_FLUSH_US,
+  DISPLAY_METRIC_LOCK_WAIT_US,
+};
+
+static metric_t display_metrics[] = {
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "display_fps_x10", "Frames per second times 10, last window", NULL,
+                     read_display_metric, DISPLAY_METRIC_FPS_X10),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "display_render_us", "Mean render time per frame, last window", NULL,
+                     read_display_metric, DISPLAY_METRIC_RENDER_US),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "display_flush_us", "Mean flush time per frame, last window", NULL,
+                     read_display_metric, DISPLAY_METRIC_FLUSH_US),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "display_lock_wait_us", "Mean LVGL lock wait, last window", NULL,
+                     read_display_metric, DISPLAY_METRIC_LOCK_WAIT_US),
+};
+#endif
 
 // 1. Backlight functions (called first)
+#if PIN_NUM_BK_LIGHT >= 0
+// Square law, so equal percent steps look like equal brightness steps
+static uint32_t backlight_duty(uint32_t level)
+{
+  if (level > LCD_BK_LIGHT_ON_LEVEL)
+  {
+    level = LCD_BK_LIGHT_ON_LEVEL;
+  }
+  return (BK_LEDC_MAX_DUTY * level * level) / (LCD_BK_LIGHT_ON_LEVEL * LCD_BK_LIGHT_ON_LEVEL);
+}
+
+// Caller holds backlight_mutex
+static void backlight_apply(uint32_t level, uint32_t fade_ms)
+{
+#if SOC_LEDC_SUPPORT_FADE_STOP
+  // Otherwise the next fade setup blocks until the running one has finished
+  ledc_fade_stop(BK_LEDC_MODE, BK_LEDC_CHANNEL);
+#endif
+  uint32_t duty = backlight_duty(level);
+  if (fade_ms == 0)
+  {
+    ledc_set_duty(BK_LEDC_MODE, BK_LEDC_CHANNEL, duty);
+    ledc_update_duty(BK_LEDC_MODE, BK_LEDC_CHANNEL);
+  }
+  else
+  {
+    ledc_set_fade_with_time(BK_LEDC_MODE, BK_LEDC_CHANNEL, duty, fade_ms);
+    ledc_fade_start(BK_LEDC_MODE, BK_LEDC_CHANNEL, LEDC_FADE_NO_WAIT);
+  }
+  backlight_level = level;
+}
+
+static void backlight_timer_cb(void *arg)
+{
+  xSemaphoreTake(backlight_mutex, portMAX_DELAY);
+  if (scheduled_pending)
+  {
+    scheduled_pending = false;
+    backlight_apply(scheduled_level, scheduled_fade_ms);
+  }
+  xSemaphoreGive(backlight_mutex);
+}
+#endif
+
 void lvgl_setup_init_backlight(void)
 {
 #if PIN_NUM_BK_LIGHT >= 0
-  gpio_config_t bk_gpio_config = {
-      .mode = GPIO_MODE_OUTPUT,
-      .pin_bit_mask = 1ULL << PIN_NUM_BK_LIGHT};
-  ESP_ERROR_CHECK(gpio_config(&bk_gpio_config));
+  ledc_timer_config_t timer_config = {
+      .speed_mode = BK_LEDC_MODE,
+      .duty_resolution = BK_LEDC_RESOLUTION,
+      .timer_num = BK_LEDC_TIMER,
+      .freq_hz = LCD_BK_LIGHT_PWM_FREQ_HZ,
+      .clk_cfg = LEDC_AUTO_CLK,
+  };
+  ESP_ERROR_CHECK(ledc_timer_config(&timer_config));
+
+  ledc_channel_config_t channel_config = {
+      .gpio_num = PIN_NUM_BK_LIGHT,
+      .speed_mode = BK_LEDC_MODE,
+      .channel = BK_LEDC_CHANNEL,
+      .timer_sel = BK_LEDC_TIMER,
+      .duty = 0,
+      .hpoint = 0,
+  };
+  ESP_ERROR_CHECK(ledc_channel_config(&channel_config));
+
+  // Fades run in hardware, the driver only takes an interrupt when one ends
+  ESP_ERROR_CHECK(ledc_fade_func_install(0));
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = backlight_timer_cb,
+      .name = "backlight"};
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &backlight_timer));
+
+  backlight_mutex = xSemaphoreCreateMutex();
+  if (!backlight_mutex)
+  {
+    debug_log_error(DEBUG_TAG_LVGL_SETUP, "Failed to create backlight mutex");
+    return;
+  }
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Backlight PWM at %d Hz", LCD_BK_LIGHT_PWM_FREQ_HZ);
 #endif
 }
 
 void lvgl_setup_set_backlight(uint32_t level)
 {
-#if PIN_NUM_BK_LIGHT >= 0
-  gpio_set_level(PIN_NUM_BK_LIGHT, level);
+  if (lvgl_setup_fade_backlight(level, 0) != ESP_OK)
+  {
+    return;
+  }
   if (level == LCD_BK_LIGHT_ON_LEVEL)
   {
     debug_log_info(DEBUG_TAG_LVGL_SETUP, "LCD backlight turned ON");
@@ -62,6 +301,52 @@ void lvgl_setup_set_backlight(uint32_t level)
   {
     debug_log_info(DEBUG_TAG_LVGL_SETUP, "LCD backlight turned OFF");
   }
+}
+
+esp_err_t lvgl_setup_fade_backlight(uint32_t level, uint32_t fade_ms)
+{
+#if PIN_NUM_BK_LIGHT >= 0
+  if (!backlight_mutex)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  xSemaphoreTake(backlight_mutex, portMAX_DELAY);
+  esp_timer_stop(backlight_timer);
+  scheduled_pending = false;
+  backlight_apply(level, fade_ms);
+  xSemaphoreGive(backlight_mutex);
+  return ESP_OK;
+#else
+  return ESP_ERR_INVALID_STATE;
+#endif
+}
+
+esp_err_t lvgl_setup_schedule_backlight(uint32_t level, uint32_t delay_ms, uint32_t fade_ms)
+{
+#if PIN_NUM_BK_LIGHT >= 0
+  if (!backlight_mutex)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  xSemaphoreTake(backlight_mutex, portMAX_DELAY);
+  esp_timer_stop(backlight_timer);
+  scheduled_level = level;
+  scheduled_fade_ms = fade_ms;
+  scheduled_pending = true;
+  esp_err_t ret = esp_timer_start_once(backlight_timer, (uint64_t)delay_ms * 1000);
+  xSemaphoreGive(backlight_mutex);
+  return ret;
+#else
+  return ESP_ERR_INVALID_STATE;
+#endif
+}
+
+uint32_t lvgl_setup_get_backlight(void)
+{
+#if PIN_NUM_BK_LIGHT >= 0
+  return backlight_level;
+#else
+  return LCD_BK_LIGHT_ON_LEVEL;
 #endif
 }
 
@@ -72,17 +357,41 @@ esp_lcd_panel_handle_t lvgl_setup_create_lcd_panel(void)
   esp_lcd_rgb_panel_config_t panel_config;
 
   ESP_ERROR_CHECK(init_panel_config(&panel_config));
+#if CONFIG_EXAMPLE_LCD_ISR_AWAY_FROM_WIFI
+  // The panel ISR (and with it the bounce buffer refill) lands on the creating core
+#if CONFIG_ESP_WIFI_TASK_PINNED_TO_CORE_1
+  const BaseType_t isr_core = 0;
+#else
+  const BaseType_t isr_core = 1;
+#endif
+  ESP_ERROR_CHECK(create_rgb_panel_on_core(&panel_config, &panel_handle, isr_core));
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "RGB panel ISR installed on core %d", (int)isr_core);
+#else
   ESP_ERROR_CHECK(esp_lcd_new_rgb_panel(&panel_config, &panel_handle));
+#endif
   ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
   ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
+#if LCD_ROTATION != LV_DISPLAY_ROTATION_0
+  // Applied by the driver in its draw_bitmap copy, so rotation adds no pass over the pixels
+  ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle, LCD_ROTATION_SWAP_XY));
+  ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, LCD_ROTATION_MIRROR_X, LCD_ROTATION_MIRROR_Y));
+#endif
 
   log_memory_status("After LCD panel creation");
 
   // Calculate and log memory usage
   size_t frame_buffer_size = LCD_H_RES * LCD_V_RES * LCD_PIXEL_SIZE * LCD_NUM_FB;
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+  size_t draw_buffer_size = 0; // Direct mode renders into the frame buffers
+#else
   size_t draw_buffer_size = LCD_H_RES * LVGL_DRAW_BUF_LINES * LCD_PIXEL_SIZE;
+#endif
   debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Memory allocation - Frame buffer: %zu KB (%d buffers), Draw buffer: %zu KB",
                    frame_buffer_size / 1024, LCD_NUM_FB, draw_buffer_size / 1024);
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Bounce buffers: 2 x %d lines (%zu KB internal DMA)",
+                   LCD_BOUNCE_BUFFER_LINES, (size_t)(2 * LCD_BOUNCE_BUFFER_LINES * LCD_H_RES * LCD_PIXEL_SIZE) / 1024);
+#endif
   debug_log_info(DEBUG_TAG_LVGL_SETUP, "LCD RGB panel created with frame buffer in SPIRAM");
 
   return panel_handle;
@@ -102,18 +411,15 @@ lv_display_t *lvgl_setup_init(esp_lcd_panel_handle_t panel_handle)
    */
 
   lv_init();
+  lvgl_mem_register_metrics();
 
-  // Initialize timeout-capable mutex for LVGL locking
-  if (lvgl_timeout_mutex == NULL)
-  {
-    lvgl_timeout_mutex = xSemaphoreCreateMutex();
-    if (lvgl_timeout_mutex == NULL)
-    {
-      debug_log_error(DEBUG_TAG_LVGL_SETUP, "Failed to create LVGL timeout mutex");
-      return NULL;
-    }
-    debug_log_info(DEBUG_TAG_LVGL_SETUP, "LVGL timeout mutex created successfully");
-  }
+#if CONFIG_LV_DRAW_SW_ASM_CUSTOM
+  // Nothing to register, LVGL's blend sources call lvgl_blend_hooks.h directly
+  debug_log_info(DEBUG_TAG_LVGL_SETUP, "RGB565 fills and copies use the PIE blend kernels");
+#endif
+
+  // lv_init() created LVGL's global lock and started the SW draw threads
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL renders with %d SW draw unit(s)", LV_DRAW_SW_DRAW_UNIT_CNT);
 
   lv_display_t *display = lv_display_create(LCD_H_RES, LCD_V_RES);
   if (!display)
@@ -131,45 +437,112 @@ lv_display_t *lvgl_setup_init(esp_lcd_panel_handle_t panel_handle)
   void *buf2 = NULL;
 
 #if CONFIG_EXAMPLE_USE_DOUBLE_FB
+  // Direct mode: LVGL renders straight into the panel's back frame buffer.
+  // LVGL keeps the two buffers in sync by copying the previous frame's dirty
+  // areas forward, so no DRAM draw buffer and no per-flush memcpy are needed.
   ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(panel_handle, 2, &buf1, &buf2));
-  lv_display_set_buffers(display, buf1, buf2, LCD_H_RES * LCD_V_RES * LVGL_DRAW_BUF_LINES, LV_DISPLAY_RENDER_MODE_PARTIAL);
-  debug_log_info(DEBUG_TAG_LVGL_SETUP, "Using double framebuffer mode");
+  size_t frame_buffer_sz = LCD_H_RES * LCD_V_RES * LCD_PIXEL_SIZE;
+  lv_display_set_buffers(display, buf1, buf2, frame_buffer_sz, LV_DISPLAY_RENDER_MODE_DIRECT);
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Using double framebuffer direct mode: 2 x %zu KB in SPIRAM",
+                   frame_buffer_sz / 1024);
 #else
-  size_t draw_buffer_sz = LCD_H_RES * LVGL_DRAW_BUF_LINES * LCD_PIXEL_SIZE;
-  // CRITICAL FIX: Use internal DRAM for draw buffer to avoid rendering issues
-  buf1 = heap_caps_malloc(draw_buffer_sz, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  size_t draw_buffer_sz = 0;
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+  draw_buffer_sz = alloc_pingpong_buffers(&buf1, &buf2);
+#endif
   if (!buf1)
   {
-    debug_log_warning(DEBUG_TAG_LVGL_SETUP, "Failed to allocate LVGL draw buffer in DRAM, trying SPIRAM fallback");
-    // Fallback to SPIRAM with smaller buffer to reduce memory pressure
-    size_t fallback_buffer_sz = LCD_H_RES * (LVGL_DRAW_BUF_LINES / 2) * LCD_PIXEL_SIZE; // Half the lines for fallback
-    buf1 = heap_caps_malloc(fallback_buffer_sz, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    draw_buffer_sz = LCD_H_RES * LVGL_DRAW_BUF_LINES * LCD_PIXEL_SIZE;
+    // CRITICAL FIX: Use internal DRAM for draw buffer to avoid rendering issues
+    buf1 = heap_caps_malloc(draw_buffer_sz, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
     if (!buf1)
     {
-      debug_log_error(DEBUG_TAG_LVGL_SETUP, "Failed to allocate LVGL draw buffer in both DRAM and SPIRAM");
-      return NULL;
+      debug_log_warning(DEBUG_TAG_LVGL_SETUP, "Failed to allocate LVGL draw buffer in DRAM, trying SPIRAM fallback");
+      // Fallback to SPIRAM with smaller buffer to reduce memory pressure
+      size_t fallback_buffer_sz = LCD_H_RES * (LVGL_DRAW_BUF_LINES / 2) * LCD_PIXEL_SIZE; // Half the lines for fallback
+      buf1 = heap_caps_malloc(fallback_buffer_sz, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+      if (!buf1)
+      {
+        debug_log_error(DEBUG_TAG_LVGL_SETUP, "Failed to allocate LVGL draw buffer in both DRAM and SPIRAM");
+        return NULL;
+      }
+      draw_buffer_sz = fallback_buffer_sz;
+      debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Using fallback SPIRAM buffer: %zu bytes", draw_buffer_sz);
+    }
+    else
+    {
+      debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL draw buffer allocated in DRAM: %zu bytes", draw_buffer_sz);
     }
-    draw_buffer_sz = fallback_buffer_sz;
-    debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Using fallback SPIRAM buffer: %zu bytes", draw_buffer_sz);
-  }
-  else
-  {
-    debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL draw buffer allocated in DRAM: %zu bytes", draw_buffer_sz);
   }
 
   log_memory_status("After draw buffer allocation");
 
-  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL draw buffer allocated: %zu bytes", draw_buffer_sz);
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "LVGL draw buffer allocated: %s%zu bytes", buf2 ? "2 x " : "", draw_buffer_sz);
   lv_display_set_buffers(display, buf1, buf2, draw_buffer_sz, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+  if (buf2 && start_flush_task(display) != ESP_OK)
+  {
+    // LVGL still alternates the buffers, flushes just stay synchronous
+    debug_log_warning(DEBUG_TAG_LVGL_SETUP, "Flush task unavailable, render and flush will not overlap");
+  }
+#endif
 #endif
 
   lv_display_set_flush_cb(display, lvgl_flush_cb);
+#if LCD_ROTATION != LV_DISPLAY_ROTATION_0
+  // Flushed areas arrive in rotated coordinates, which the panel's mirror/swap settings expect
+  lv_display_set_rotation(display, LCD_ROTATION);
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Display rotated, %ldx%ld logical", (long)lv_display_get_horizontal_resolution(display),
+                   (long)lv_display_get_vertical_resolution(display));
+#endif
+
+#if CONFIG_EXAMPLE_LCD_METRICS
+  metrics_window_start_us = esp_timer_get_time();
+  lv_display_add_event_cb(display, lvgl_metrics_event_cb, LV_EVENT_ALL, NULL);
+  for (size_t i = 0; i < sizeof(display_metrics) / sizeof(display_metrics[0]); i++)
+  {
+    metrics_register(&display_metrics[i]);
+  }
+#endif
+
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+  // Round the refresh period to whole panel frames so every refresh starts on a vsync wakeup.
+  // Half a frame of slack keeps the timer due by the time the Nth vsync arrives.
+  frame_period_ms = (LCD_FRAME_PERIOD_US + 999) / 1000;
+  uint32_t frames_per_refresh = LV_DEF_REFR_PERIOD / frame_period_ms;
+  if (frames_per_refresh == 0)
+  {
+    frames_per_refresh = 1;
+  }
+  refr_period_ms = frames_per_refresh * frame_period_ms - frame_period_ms / 2;
+  lv_timer_set_period(lv_display_get_refr_timer(display), refr_period_ms);
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Vsync pacing: frame %lu us, refresh every %lu frame(s)",
+                   (unsigned long)LCD_FRAME_PERIOD_US, (unsigned long)frames_per_refresh);
+#endif
 
   // Register callbacks
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+  // Buffer swaps only take effect at the next vsync, release LVGL from there
+  esp_lcd_rgb_panel_event_callbacks_t cbs = {
+      .on_vsync = lvgl_notify_vsync,
+  };
+#else
   esp_lcd_rgb_panel_event_callbacks_t cbs = {
       .on_color_trans_done = lvgl_notify_flush_ready,
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+      // Both edges are needed to spot vsyncs that overtook the bounce buffer refill
+      .on_vsync = lvgl_bounce_on_vsync,
+      .on_bounce_frame_finish = lvgl_bounce_frame_finish,
+#elif CONFIG_EXAMPLE_LCD_VSYNC_PACING
+      .on_vsync = lvgl_notify_vsync,
+#endif
   };
+#endif
   ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(panel_handle, &cbs, display));
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+  // The refill ISR copies every line out of PSRAM and underruns at a low CPU clock
+  cpu_power_hold(CPU_POWER_SCANOUT, true);
+#endif
 
   // Setup tick timer
   const esp_timer_create_args_t lvgl_tick_timer_args = {
@@ -185,9 +558,11 @@ lv_display_t *lvgl_setup_init(esp_lcd_panel_handle_t panel_handle)
 // 4. Task management (called fourth)
 void lvgl_setup_start_task(void)
 {
-  debug_log_event(DEBUG_TAG_LVGL_SETUP, "Starting LVGL task on core 1");
-  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Creating LVGL task with priority %d, stack size %d", LVGL_TASK_PRIORITY, LVGL_TASK_STACK_SIZE);
-  BaseType_t result = xTaskCreatePinnedToCore(lvgl_port_task, "LVGL", LVGL_TASK_STACK_SIZE, NULL, LVGL_TASK_PRIORITY, NULL, 1);
+  const task_plan_entry_t *plan = task_plan_get(TASK_PLAN_LVGL);
+  debug_log_event(DEBUG_TAG_LVGL_SETUP, "Starting LVGL task on the render core");
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Creating LVGL task on core %d with priority %d, stack size %lu",
+                   (int)plan->core, (int)plan->priority, (unsigned long)plan->stack_size);
+  BaseType_t result = task_plan_create(TASK_PLAN_LVGL, lvgl_port_task, NULL, &lvgl_task_handle);
   if (result == pdPASS)
   {
     debug_log_event(DEBUG_TAG_LVGL_SETUP, "LVGL task created successfully");
@@ -218,46 +593,168 @@ void lvgl_setup_create_ui_safe(lv_display_t *display, void (*ui_create_func)(lv_
   }
 }
 
-// LVGL port locking with timeout
-bool lvgl_port_lock(int timeout_ms)
+// LVGL port locking with timeout, on LVGL's own recursive lock so lv_timer_handler()
+// and the draw threads' dispatch take the same one
+bool lvgl_port_lock_at(int timeout_ms, const char *site)
 {
-  if (lvgl_timeout_mutex == NULL)
-  {
-    debug_log_error(DEBUG_TAG_LVGL_SETUP, "LVGL timeout mutex not initialized!");
-    return false;
-  }
+  const char *blocker = lvgl_lock_prof_begin_wait();
+  int64_t wait_start_us = esp_timer_get_time();
 
+  bool acquired;
   if (timeout_ms <= 0)
   {
-    // Use blocking semaphore for timeout <= 0
-    if (xSemaphoreTake(lvgl_timeout_mutex, portMAX_DELAY) == pdTRUE)
-    {
-      return true;
-    }
-    return false;
+    acquired = lv_lock() == LV_RESULT_OK;
+  }
+  else
+  {
+    // lv_lock() cannot time out, take the mutex behind it directly
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    acquired = xSemaphoreTakeRecursive(LV_GLOBAL_DEFAULT()->lv_general_mutex.xMutex, timeout_ticks) == pdTRUE;
   }
 
-  // Use timeout-capable semaphore
-  TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-  if (xSemaphoreTake(lvgl_timeout_mutex, timeout_ticks) == pdTRUE)
+  int64_t wait_us = esp_timer_get_time() - wait_start_us;
+  lvgl_lock_prof_end_wait(site, blocker, wait_us, acquired);
+  if (acquired)
   {
+#if CONFIG_EXAMPLE_LCD_METRICS
+    lvgl_metrics_record_lock_wait(wait_us);
+#endif
     return true;
   }
 
-  debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "LVGL lock timeout after %d ms", timeout_ms);
+  if (timeout_ms > 0)
+  {
+    char holder[96];
+    lvgl_lock_prof_format_holder(holder, sizeof(holder));
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "LVGL lock timeout after %d ms in %s%s", timeout_ms, site, holder);
+  }
   return false; // Timeout reached
 }
 
 void lvgl_port_unlock(void)
 {
-  if (lvgl_timeout_mutex != NULL)
+  lvgl_lock_prof_release();
+  lv_unlock();
+
+  // Another task changed widgets under the lock, let LVGL pick the invalidation up now
+  if (lvgl_task_handle != NULL && xTaskGetCurrentTaskHandle() != lvgl_task_handle)
+  {
+    xTaskNotifyGive(lvgl_task_handle);
+  }
+}
+
+void lvgl_setup_register_update_handler(lvgl_update_handler_t handler)
+{
+  update_handler = handler;
+}
+
+void lvgl_setup_wake_task(void)
+{
+  if (lvgl_task_handle != NULL)
   {
-    xSemaphoreGive(lvgl_timeout_mutex);
+    xTaskNotifyGive(lvgl_task_handle);
   }
-  else
+}
+
+uint32_t lvgl_setup_get_refr_period_ms(void)
+{
+  return refr_period_ms;
+}
+
+esp_err_t lvgl_setup_set_display_sleep(lv_display_t *display, bool sleep)
+{
+  if (!display)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (sleep == display_asleep)
+  {
+    return ESP_OK;
+  }
+
+  esp_lcd_panel_handle_t panel_handle = lv_display_get_user_data(display);
+  lv_timer_t *refr_timer = lv_display_get_refr_timer(display);
+  esp_err_t ret = ESP_OK;
+
+  if (sleep)
+  {
+    // A double-FB swap still waiting for its vsync completes once scan-out runs again
+    lv_timer_pause(refr_timer);
+    ret = esp_lcd_panel_disp_on_off(panel_handle, false);
+    scanout_stopped = (ret == ESP_OK);
+    display_asleep = true;
+    if (scanout_stopped)
+    {
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+      cpu_power_hold(CPU_POWER_SCANOUT, false);
+#endif
+      debug_log_info(DEBUG_TAG_LVGL_SETUP, "Display asleep, RGB scan-out stopped");
+    }
+    else
+    {
+      debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "Display asleep, scan-out still running: %s", esp_err_to_name(ret));
+    }
+    return ret;
+  }
+
+  if (scanout_stopped)
   {
-    debug_log_error(DEBUG_TAG_LVGL_SETUP, "LVGL timeout mutex not initialized for unlock!");
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+    // The gap is not an underrun
+    bounce_last_frame_us = 0;
+    cpu_power_hold(CPU_POWER_SCANOUT, true);
+#endif
+    ret = esp_lcd_panel_disp_on_off(panel_handle, true);
+    scanout_stopped = false;
   }
+  display_asleep = false;
+
+  // Redraw everything, the frame buffer may not match what LVGL holds any more
+  lv_obj_invalidate(lv_display_get_screen_active(display));
+  lv_timer_resume(refr_timer);
+  lv_timer_ready(refr_timer);
+  debug_log_info(DEBUG_TAG_LVGL_SETUP, "Display awake");
+  return ret;
+}
+
+esp_err_t lvgl_setup_set_pixel_clock(lv_display_t *display, uint32_t pclk_hz)
+{
+  static uint32_t current_pclk_hz = LCD_PIXEL_CLOCK_HZ;
+
+  if (!display || pclk_hz == 0 || pclk_hz > LCD_PIXEL_CLOCK_HZ)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (pclk_hz == current_pclk_hz)
+  {
+    return ESP_OK;
+  }
+
+  // Takes effect at the next vsync, the frame in flight finishes at the old rate
+  esp_err_t ret = esp_lcd_rgb_panel_set_pclk(lv_display_get_user_data(display), pclk_hz);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "Pixel clock %lu Hz: %s", (unsigned long)pclk_hz, esp_err_to_name(ret));
+    return ret;
+  }
+  current_pclk_hz = pclk_hz;
+
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+  // Vsync wakeups come further apart, keep the stall fallback beyond one frame
+  frame_period_ms = (uint32_t)(((uint64_t)LCD_H_TOTAL * LCD_V_TOTAL * 1000ULL + pclk_hz - 1) / pclk_hz);
+#endif
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Pixel clock %lu kHz", (unsigned long)(pclk_hz / 1000));
+  return ESP_OK;
+}
+
+bool lvgl_setup_wake_task_from_isr(void)
+{
+  BaseType_t high_task_awoken = pdFALSE;
+  if (lvgl_task_handle != NULL)
+  {
+    vTaskNotifyGiveFromISR(lvgl_task_handle, &high_task_awoken);
+  }
+  return high_task_awoken == pdTRUE;
 }
 
 // Static functions (implementation details)
@@ -275,7 +772,8 @@ static esp_err_t init_panel_config(esp_lcd_rgb_panel_config_t *panel_config)
   panel_config->flags.fb_in_psram = true; // Frame buffer in SPIRAM for stability
 
 #if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
-  panel_config->bounce_buffer_size_px = 10 * LCD_H_RES; // Reduced from 20 to 10 lines for DRAM conservation
+  // The driver allocates both bounce buffers from internal DMA-capable memory
+  panel_config->bounce_buffer_size_px = LCD_BOUNCE_BUFFER_LINES * LCD_H_RES;
 #endif
 
   // GPIO pins
@@ -329,17 +827,650 @@ static esp_err_t init_panel_config(esp_lcd_rgb_panel_config_t *panel_config)
   return ESP_OK;
 }
 
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB || CONFIG_EXAMPLE_LCD_VSYNC_PACING
+static bool lvgl_notify_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx)
+{
+  BaseType_t high_task_awoken = pdFALSE;
+
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+  lv_display_t *disp = (lv_display_t *)user_ctx;
+
+  // The panel switched to the buffer we handed over, the old front buffer is free now
+  if (swap_pending)
+  {
+    swap_pending = false;
+    touch_latency_mark_flush_done();
+    lv_display_flush_ready(disp);
+  }
+#endif
+
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+  // Start of a new frame: wake the LVGL task so the next refresh begins in blanking.
+  // Only while it has work due, otherwise an idle UI would wake on every frame.
+  if (vsync_wakeup_armed && lvgl_task_handle != NULL)
+  {
+    vsync_wakeup_armed = false;
+    vTaskNotifyGiveFromISR(lvgl_task_handle, &high_task_awoken);
+  }
+#endif
+
+  return high_task_awoken == pdTRUE;
+}
+#endif
+
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+static bool IRAM_ATTR lvgl_bounce_on_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx)
+{
+  // The previous frame never finished streaming: the refill fell behind the scanout
+  if (!bounce_frame_done)
+  {
+    bounce_stats.underruns++;
+  }
+  bounce_frame_done = false;
+  return false;
+}
+
+static bool IRAM_ATTR lvgl_bounce_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx)
+{
+  int64_t now_us = esp_timer_get_time();
+  if (bounce_last_frame_us != 0)
+  {
+    uint32_t interval_us = (uint32_t)(now_us - bounce_last_frame_us);
+    if (interval_us > bounce_stats.max_frame_interval_us)
+    {
+      bounce_stats.max_frame_interval_us = interval_us;
+    }
+  }
+  bounce_last_frame_us = now_us;
+  bounce_stats.frames++;
+  bounce_frame_done = true;
+
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+  // In bounce buffer mode the frame boundary is when the last line left the frame buffer
+  return lvgl_notify_vsync(panel, event_data, user_ctx);
+#else
+  return false;
+#endif
+}
+#endif
+
+#if CONFIG_EXAMPLE_LCD_ISR_AWAY_FROM_WIFI
+typedef struct
+{
+  const esp_lcd_rgb_panel_config_t *config;
+  esp_lcd_panel_handle_t handle;
+  esp_err_t result;
+  TaskHandle_t caller;
+} panel_create_ctx_t;
+
+static void panel_create_task(void *arg)
+{
+  panel_create_ctx_t *ctx = (panel_create_ctx_t *)arg;
+  ctx->result = esp_lcd_new_rgb_panel(ctx->config, &ctx->handle);
+  xTaskNotifyGive(ctx->caller);
+  vTaskDelete(NULL);
+}
+
+static esp_err_t create_rgb_panel_on_core(const esp_lcd_rgb_panel_config_t *panel_config, esp_lcd_panel_handle_t *panel_handle, BaseType_t core_id)
+{
+  panel_create_ctx_t ctx = {
+      .config = panel_config,
+      .handle = NULL,
+      .result = ESP_FAIL,
+      .caller = xTaskGetCurrentTaskHandle(),
+  };
+
+  if (xTaskCreatePinnedToCore(panel_create_task, "lcd_init", 4096, &ctx, uxTaskPriorityGet(NULL), NULL, core_id) != pdPASS)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  *panel_handle = ctx.handle;
+  return ctx.result;
+}
+#endif
+
+esp_err_t lvgl_setup_get_bounce_stats(lvgl_bounce_stats_t *stats)
+{
+  if (!stats)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+  *stats = bounce_stats;
+  return ESP_OK;
+#else
+  memset(stats, 0, sizeof(*stats));
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+// Runs in the LVGL task on the last area of a frame
+static void trace_first_frame(void)
+{
+  static bool traced = false;
+  if (!traced)
+  {
+    traced = true;
+    boot_graph_mark_milestone("first_frame");
+  }
+}
+
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+  CYCLE_PROF_BEGIN(lvgl_flush_cb);
+  // In direct mode every area is already in place inside the back buffer,
+  // only the last area of a frame triggers the swap
+  if (!lv_display_flush_is_last(disp))
+  {
+    lv_display_flush_ready(disp);
+    CYCLE_PROF_END(lvgl_flush_cb);
+    return;
+  }
+
+  trace_first_frame();
+
+  // Passing a frame buffer pointer makes the RGB driver switch buffers without copying
+  esp_lcd_panel_handle_t panel_handle = lv_display_get_user_data(disp);
+  swap_pending = true;
+  esp_lcd_panel_draw_bitmap(panel_handle, 0, 0, LCD_H_RES, LCD_V_RES, px_map);
+  CYCLE_PROF_END(lvgl_flush_cb);
+}
+#else
 static bool lvgl_notify_flush_ready(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *event_data, void *user_ctx)
 {
   lv_display_t *disp = (lv_display_t *)user_ctx;
+  if (lv_display_flush_is_last(disp))
+  {
+    touch_latency_mark_flush_done();
+  }
   lv_display_flush_ready(disp);
   return false;
 }
 
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
+  CYCLE_PROF_BEGIN(lvgl_flush_cb);
+  if (lv_display_flush_is_last(disp))
+  {
+    trace_first_frame();
+  }
   esp_lcd_panel_handle_t panel_handle = lv_display_get_user_data(disp);
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+  if (flush_queue)
+  {
+    // LVGL waits in lvgl_flush_wait_cb() before reusing this buffer
+    flush_job_t job = {.disp = disp, .panel = panel_handle, .area = *area, .px_map = px_map};
+    xSemaphoreTake(flush_idle, portMAX_DELAY);
+    xQueueSend(flush_queue, &job, portMAX_DELAY);
+    CYCLE_PROF_END(lvgl_flush_cb);
+    return;
+  }
+#endif
   esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
+  CYCLE_PROF_END(lvgl_flush_cb);
+}
+
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+/**
+ * @brief Size two draw buffers from the internal DMA-capable heap left after init
+ * @return Size of each buffer, 0 and no allocation if two of LVGL_DRAW_BUF_MIN_LINES do not fit
+ */
+static size_t alloc_pingpong_buffers(void **buf1, void **buf2)
+{
+  const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
+  const size_t line_sz = LCD_H_RES * LCD_PIXEL_SIZE;
+
+  size_t free_sz = heap_caps_get_free_size(caps);
+  size_t per_buffer = free_sz > LVGL_DRAW_BUF_DRAM_RESERVE ? (free_sz - LVGL_DRAW_BUF_DRAM_RESERVE) / 2 : 0;
+  size_t largest = heap_caps_get_largest_free_block(caps);
+  if (per_buffer > largest)
+  {
+    per_buffer = largest;
+  }
+
+  size_t lines = per_buffer / line_sz;
+  if (lines > LVGL_DRAW_BUF_LINES)
+  {
+    lines = LVGL_DRAW_BUF_LINES;
+  }
+  if (lines < LVGL_DRAW_BUF_MIN_LINES)
+  {
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "Only %zu KB internal heap free, using a single draw buffer", free_sz / 1024);
+    return 0;
+  }
+
+  size_t size = lines * line_sz;
+  *buf1 = heap_caps_aligned_alloc(LVGL_DRAW_BUF_ALIGN, size, caps);
+  *buf2 = *buf1 ? heap_caps_aligned_alloc(LVGL_DRAW_BUF_ALIGN, size, caps) : NULL;
+  if (!*buf2)
+  {
+    heap_caps_free(*buf1);
+    *buf1 = NULL;
+    debug_log_warning(DEBUG_TAG_LVGL_SETUP, "Ping-pong draw buffers did not fit, using a single draw buffer");
+    return 0;
+  }
+
+  debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Ping-pong draw buffers: 2 x %zu lines, %zu KB internal heap left",
+                   lines, heap_caps_get_free_size(caps) / 1024);
+  return size;
+}
+
+// Copies finished areas into the frame buffer while LVGL renders the next one
+static void lvgl_flush_task(void *arg)
+{
+  flush_job_t job;
+  while (1)
+  {
+    if (xQueueReceive(flush_queue, &job, portMAX_DELAY) != pdTRUE)
+      continue;
+
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+    if (gdma_flush(&job))
+      continue;
+#endif
+
+    // The RGB driver copies synchronously and reports through lvgl_notify_flush_ready()
+    esp_lcd_panel_draw_bitmap(job.panel, job.area.x1, job.area.y1, job.area.x2 + 1, job.area.y2 + 1, job.px_map);
+    xSemaphoreGive(flush_idle);
+  }
+}
+
+// Blocks the LVGL task instead of letting it spin on the flushing flag
+static void lvgl_flush_wait_cb(lv_display_t *disp)
+{
+  xSemaphoreTake(flush_idle, portMAX_DELAY);
+  xSemaphoreGive(flush_idle);
+}
+
+static esp_err_t start_flush_task(lv_display_t *display)
+{
+  QueueHandle_t queue = xQueueCreate(1, sizeof(flush_job_t));
+  SemaphoreHandle_t idle = xSemaphoreCreateBinary();
+  if (queue && idle)
+  {
+    xSemaphoreGive(idle);
+    flush_queue = queue;
+    flush_idle = idle;
+    TaskHandle_t task = NULL;
+    if (task_plan_create(TASK_PLAN_LCD_FLUSH, lvgl_flush_task, NULL, &task) == pdPASS)
+    {
+      lv_display_set_flush_wait_cb(display, lvgl_flush_wait_cb);
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+      flush_task_handle = task;
+      start_gdma_flush(display);
+#endif
+      return ESP_OK;
+    }
+  }
+
+  // lvgl_flush_cb() copies inline while flush_queue is NULL
+  flush_queue = NULL;
+  flush_idle = NULL;
+  if (queue)
+    vQueueDelete(queue);
+  if (idle)
+    vSemaphoreDelete(idle);
+  return ESP_ERR_NO_MEM;
+}
+#endif
+
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+// Widens every dirty area to whole cache lines of the frame buffer
+static void gdma_round_area_cb(lv_event_t *e)
+{
+  lv_area_t *area = lv_event_get_param(e);
+  area->x1 &= ~(LVGL_GDMA_ALIGN_PX - 1);
+  area->x2 |= LVGL_GDMA_ALIGN_PX - 1;
+}
+
+// Runs in the GDMA ISR for the last row of an area and at each backlog boundary
+static bool gdma_copy_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+  BaseType_t high_task_awoken = pdFALSE;
+  lv_display_t *disp = (lv_display_t *)cb_args;
+  if (disp)
+  {
+    if (lv_display_flush_is_last(disp))
+    {
+      touch_latency_mark_flush_done();
+    }
+    lv_display_flush_ready(disp);
+    xSemaphoreGiveFromISR(flush_idle, &high_task_awoken);
+  }
+  else
+  {
+    vTaskNotifyGiveFromISR(flush_task_handle, &high_task_awoken);
+  }
+  return high_task_awoken == pdTRUE;
+}
+
+static void start_gdma_flush(lv_display_t *display)
+{
+  // With a single frame buffer and no bounce buffers only the panel DMA reads it, never the CPU
+  void *fb = NULL;
+  esp_err_t err = esp_lcd_rgb_panel_get_frame_buffer(lv_display_get_user_data(display), 1, &fb);
+  if (err == ESP_OK)
+  {
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = LVGL_GDMA_BACKLOG;
+    err = esp_async_memcpy_install(&config, &gdma_copier);
+  }
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "GDMA flush unavailable (%s), copying with the CPU", esp_err_to_name(err));
+    gdma_copier = NULL;
+    return;
+  }
+
+  gdma_fb = fb;
+  lv_display_add_event_cb(display, gdma_round_area_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+  debug_log_info(DEBUG_TAG_LVGL_SETUP, "Draw buffers are copied to the frame buffer by GDMA");
+}
+
+/**
+ * @brief Queue an area to the frame buffer row by row, the last row ends the flush from the ISR
+ * @return false if the area is left to the RGB driver copy
+ */
+static bool gdma_flush(const flush_job_t *job)
+{
+  const size_t stride = LCD_H_RES * LCD_PIXEL_SIZE;
+  const size_t row_sz = (size_t)lv_area_get_width(&job->area) * LCD_PIXEL_SIZE;
+  const int32_t rows = lv_area_get_height(&job->area);
+  uint8_t *dst = gdma_fb + (size_t)job->area.y1 * stride + (size_t)job->area.x1 * LCD_PIXEL_SIZE;
+  uint8_t *src = job->px_map;
+
+  if (!gdma_copier || (((uintptr_t)dst | (uintptr_t)src | row_sz) % LVGL_DRAW_BUF_ALIGN) != 0)
+  {
+    return false;
+  }
+
+  for (int32_t row = 0; row < rows; row++, dst += stride, src += row_sz)
+  {
+    bool last = row == rows - 1;
+    bool backlog_full = !last && (row + 1) % LVGL_GDMA_BACKLOG == 0;
+    esp_err_t err = esp_async_memcpy(gdma_copier, dst, src, row_sz, (last || backlog_full) ? gdma_copy_done : NULL,
+                                     last ? job->disp : NULL);
+    if (err != ESP_OK)
+    {
+      if (row == 0)
+      {
+        return false;
+      }
+
+      // Rows already queued land within microseconds, the driver copies the rest
+      debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "GDMA copy failed at row %ld: %s", (long)row, esp_err_to_name(err));
+      vTaskDelay(1);
+      esp_lcd_panel_draw_bitmap(job->panel, job->area.x1, job->area.y1 + row, job->area.x2 + 1, job->area.y2 + 1, src);
+      xSemaphoreGive(flush_idle);
+      return true;
+    }
+
+    if (backlog_full)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+  return true;
+}
+#endif
+#endif
+
+// =======================================================================
+// DISPLAY PIPELINE METRICS
+// =======================================================================
+
+#if CONFIG_EXAMPLE_LCD_METRICS
+static void metrics_hist_add(lvgl_metrics_hist_t *hist, uint32_t value, uint32_t shift)
+{
+  uint32_t scaled = value >> shift;
+  uint32_t bucket = scaled ? (32 - __builtin_clz(scaled)) : 0;
+  if (bucket >= LVGL_METRICS_HIST_BUCKETS)
+  {
+    bucket = LVGL_METRICS_HIST_BUCKETS - 1;
+  }
+
+  hist->buckets[bucket]++;
+  hist->count++;
+  hist->sum += value;
+  if (value > hist->max)
+  {
+    hist->max = value;
+  }
+}
+
+static void metrics_add_frame(lvgl_metrics_t *metrics, uint32_t render_us, uint32_t flush_us, uint32_t inv_area_px)
+{
+  metrics->frames++;
+  metrics_hist_add(&metrics->render_us, render_us, LVGL_METRICS_TIME_SHIFT);
+  metrics_hist_add(&metrics->flush_us, flush_us, LVGL_METRICS_TIME_SHIFT);
+  metrics_hist_add(&metrics->inv_area_px, inv_area_px, LVGL_METRICS_AREA_SHIFT);
+}
+
+// Caller holds metrics_spinlock
+static void metrics_roll_window(int64_t now_us)
+{
+  int64_t elapsed_us = now_us - metrics_window_start_us;
+  if (elapsed_us < (int64_t)LVGL_METRICS_WINDOW_MS * 1000)
+  {
+    return;
+  }
+
+  metrics_current.window_ms = (uint32_t)(elapsed_us / 1000);
+  metrics_current.fps_x10 = (uint32_t)(((uint64_t)metrics_current.frames * 10000000ULL) / (uint64_t)elapsed_us);
+  metrics_last = metrics_current;
+  memset(&metrics_current, 0, sizeof(metrics_current));
+  metrics_window_start_us = now_us;
+}
+
+static void lvgl_metrics_record_lock_wait(int64_t wait_us)
+{
+  taskENTER_CRITICAL(&metrics_spinlock);
+  metrics_roll_window(esp_timer_get_time());
+  metrics_hist_add(&metrics_current.lock_wait_us, (uint32_t)wait_us, LVGL_METRICS_TIME_SHIFT);
+  if (metrics_capture_active)
+  {
+    metrics_hist_add(&metrics_capture.lock_wait_us, (uint32_t)wait_us, LVGL_METRICS_TIME_SHIFT);
+  }
+  taskEXIT_CRITICAL(&metrics_spinlock);
+}
+
+static void lvgl_metrics_event_cb(lv_event_t *e)
+{
+  int64_t now_us = esp_timer_get_time();
+
+  switch (lv_event_get_code(e))
+  {
+  case LV_EVENT_INVALIDATE_AREA:
+  {
+    // Clip to the screen, LVGL reports the requested area
+    lv_area_t area = *(const lv_area_t *)lv_event_get_param(e);
+    lv_area_t screen = {0, 0, LCD_H_RES - 1, LCD_V_RES - 1};
+    lv_area_t clipped;
+    if (lv_area_intersect(&clipped, &area, &screen))
+    {
+      frame_inv_area_px += lv_area_get_size(&clipped);
+    }
+    touch_latency_mark_invalidate();
+    break;
+  }
+  case LV_EVENT_REFR_START:
+    frame_start_us = now_us;
+    frame_flush_us = 0;
+    frame_flushed = false;
+    touch_latency_mark_refresh_start();
+    break;
+  case LV_EVENT_FLUSH_START:
+  case LV_EVENT_FLUSH_WAIT_START:
+    flush_start_us = now_us;
+    frame_flushed = true;
+    break;
+  case LV_EVENT_FLUSH_FINISH:
+  case LV_EVENT_FLUSH_WAIT_FINISH:
+    frame_flush_us += (uint32_t)(now_us - flush_start_us);
+    break;
+  case LV_EVENT_REFR_READY:
+    // Refresh passes without dirty areas are not frames
+    if (frame_flushed)
+    {
+      uint32_t frame_us = (uint32_t)(now_us - frame_start_us);
+      uint32_t render_us = frame_us > frame_flush_us ? frame_us - frame_flush_us : 0;
+      taskENTER_CRITICAL(&metrics_spinlock);
+      metrics_roll_window(now_us);
+      metrics_add_frame(&metrics_current, render_us, frame_flush_us, frame_inv_area_px);
+      if (metrics_capture_active)
+      {
+        metrics_add_frame(&metrics_capture, render_us, frame_flush_us, frame_inv_area_px);
+      }
+      taskEXIT_CRITICAL(&metrics_spinlock);
+      frame_inv_area_px = 0;
+    }
+    break;
+  default:
+    break;
+  }
+}
+#endif
+
+#if CONFIG_EXAMPLE_LCD_METRICS
+static int64_t read_display_metric(const metric_t *metric)
+{
+  lvgl_metrics_t m;
+  lvgl_setup_get_metrics(&m);
+
+  const lvgl_metrics_hist_t *hist;
+  switch (metric->arg)
+  {
+  case DISPLAY_METRIC_FPS_X10:
+    return m.fps_x10;
+  case DISPLAY_METRIC_RENDER_US:
+    hist = &m.render_us;
+    break;
+  case DISPLAY_METRIC_FLUSH_US:
+    hist = &m.flush_us;
+    break;
+  default:
+    hist = &m.lock_wait_us;
+    break;
+  }
+  return hist->count ? (int64_t)(hist->sum / hist->count) : 0;
+}
+#endif
+
+esp_err_t lvgl_setup_get_metrics(lvgl_metrics_t *metrics)
+{
+  if (!metrics)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_EXAMPLE_LCD_METRICS
+  taskENTER_CRITICAL(&metrics_spinlock);
+  metrics_roll_window(esp_timer_get_time());
+  *metrics = metrics_last;
+  taskEXIT_CRITICAL(&metrics_spinlock);
+  return ESP_OK;
+#else
+  memset(metrics, 0, sizeof(*metrics));
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t lvgl_setup_metrics_capture_start(void)
+{
+#if CONFIG_EXAMPLE_LCD_METRICS
+  taskENTER_CRITICAL(&metrics_spinlock);
+  memset(&metrics_capture, 0, sizeof(metrics_capture));
+  metrics_capture_start_us = esp_timer_get_time();
+  metrics_capture_active = true;
+  taskEXIT_CRITICAL(&metrics_spinlock);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t lvgl_setup_metrics_capture_stop(lvgl_metrics_t *metrics)
+{
+  if (!metrics)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_EXAMPLE_LCD_METRICS
+  taskENTER_CRITICAL(&metrics_spinlock);
+  if (!metrics_capture_active)
+  {
+    taskEXIT_CRITICAL(&metrics_spinlock);
+    return ESP_ERR_INVALID_STATE;
+  }
+  int64_t elapsed_us = esp_timer_get_time() - metrics_capture_start_us;
+  metrics_capture_active = false;
+  *metrics = metrics_capture;
+  taskEXIT_CRITICAL(&metrics_spinlock);
+
+  metrics->window_ms = (uint32_t)(elapsed_us / 1000);
+  metrics->fps_x10 = elapsed_us > 0 ? (uint32_t)(((uint64_t)metrics->frames * 10000000ULL) / (uint64_t)elapsed_us) : 0;
+  return ESP_OK;
+#else
+  memset(metrics, 0, sizeof(*metrics));
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+static int format_hist_json(char *buffer, size_t size, const char *name, const lvgl_metrics_hist_t *hist)
+{
+  int len = snprintf(buffer, size, "\"%s\":{\"n\":%lu,\"avg\":%lu,\"max\":%lu,\"h\":[",
+                     name, (unsigned long)hist->count,
+                     (unsigned long)(hist->count ? hist->sum / hist->count : 0), (unsigned long)hist->max);
+  for (int i = 0; i < LVGL_METRICS_HIST_BUCKETS && len > 0 && (size_t)len < size; i++)
+  {
+    len += snprintf(buffer + len, size - len, "%s%lu", i ? "," : "", (unsigned long)hist->buckets[i]);
+  }
+  if (len > 0 && (size_t)len < size)
+  {
+    len += snprintf(buffer + len, size - len, "]}");
+  }
+  return len;
+}
+
+size_t lvgl_setup_format_metrics_json(const lvgl_metrics_t *metrics, char *buffer, size_t size)
+{
+  if (!metrics || !buffer || size == 0)
+  {
+    return 0;
+  }
+
+  int len = snprintf(buffer, size, "{\"window_ms\":%lu,\"frames\":%lu,\"fps\":%lu.%lu,",
+                     (unsigned long)metrics->window_ms, (unsigned long)metrics->frames,
+                     (unsigned long)(metrics->fps_x10 / 10), (unsigned long)(metrics->fps_x10 % 10));
+
+  const struct
+  {
+    const char *name;
+    const lvgl_metrics_hist_t *hist;
+  } fields[] = {
+      {"render_us", &metrics->render_us},
+      {"flush_us", &metrics->flush_us},
+      {"lock_wait_us", &metrics->lock_wait_us},
+      {"inv_area_px", &metrics->inv_area_px},
+  };
+
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]) && len > 0 && (size_t)len < size; i++)
+  {
+    len += format_hist_json(buffer + len, size - len, fields[i].name, fields[i].hist);
+    if ((size_t)len < size)
+    {
+      len += snprintf(buffer + len, size - len, "%s", i + 1 < sizeof(fields) / sizeof(fields[0]) ? "," : "}");
+    }
+  }
+
+  if (len <= 0 || (size_t)len >= size)
+  {
+    buffer[0] = '\0';
+    return 0;
+  }
+  return (size_t)len;
 }
 
 static void lvgl_increase_tick(void *arg)
@@ -350,26 +1481,87 @@ static void lvgl_increase_tick(void *arg)
 static void lvgl_port_task(void *arg)
 {
   uint32_t time_till_next_ms = 0;
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+  uint32_t reported_underruns = 0;
+  int64_t last_underrun_report_us = 0;
+#endif
+  lvgl_stall_init(xTaskGetCurrentTaskHandle());
   while (1)
   {
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+    // Report new underruns at most every 5 s so heavy WiFi bursts don't flood the log
+    if (bounce_stats.underruns != reported_underruns &&
+        esp_timer_get_time() - last_underrun_report_us > 5000000)
+    {
+      reported_underruns = bounce_stats.underruns;
+      last_underrun_report_us = esp_timer_get_time();
+      debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "Bounce buffer underruns: %lu in %lu frames, max frame interval %lu us",
+                          (unsigned long)reported_underruns, (unsigned long)bounce_stats.frames,
+                          (unsigned long)bounce_stats.max_frame_interval_us);
+    }
+#endif
+
+    // Full clock for the pass, the wait below runs at the minimum
+    cpu_power_hold(CPU_POWER_RENDER, true);
+
     // Use the same mutex system as other UI components to prevent deadlocks
+    lvgl_stall_pass_begin();
     if (lvgl_port_lock(0)) // No timeout for the main LVGL task
     {
+      lvgl_stall_pass_locked();
+      // Event-mode input device: read it only when the touch task has a new report
+      if (touch_pending)
+      {
+        touch_pending = false;
+        lv_indev_read(touch_indev);
+      }
+      // Right after input, so the first touch out of idle already renders at full rate
+      display_activity_process();
+      if (update_handler)
+      {
+        TRACE_SPAN_BEGIN("ui_updates");
+        update_handler();
+        TRACE_SPAN_END("ui_updates");
+      }
+      TRACE_SPAN_BEGIN("lvgl_timers");
       time_till_next_ms = lv_timer_handler();
+      TRACE_SPAN_END("lvgl_timers");
       lvgl_port_unlock();
     }
+    lvgl_stall_pass_end();
     else
     {
       // If we can't get the lock immediately, just wait a bit and try again
       time_till_next_ms = 10;
     }
 
-    if (time_till_next_ms < 10)
+    // Block until a wakeup source fires or the next LVGL timer falls due
+    TickType_t wait_ticks;
+    if (time_till_next_ms == LV_NO_TIMER_READY)
     {
-      time_till_next_ms = 10;
+      wait_ticks = portMAX_DELAY;
     }
-
-    usleep(1000 * time_till_next_ms);
+    else
+    {
+      wait_ticks = pdMS_TO_TICKS(time_till_next_ms);
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+      // Work due within a frame: start it on the coming vsync instead of mid-scanout
+      if (time_till_next_ms < frame_period_ms)
+      {
+        vsync_wakeup_armed = true;
+        wait_ticks = pdMS_TO_TICKS(2 * frame_period_ms); // Fallback if vsync stalls
+      }
+#endif
+      if (wait_ticks == 0)
+      {
+        wait_ticks = 1;
+      }
+    }
+    cpu_power_hold(CPU_POWER_RENDER, false);
+    ulTaskNotifyTake(pdTRUE, wait_ticks);
+#if CONFIG_EXAMPLE_LCD_VSYNC_PACING
+    vsync_wakeup_armed = false;
+#endif
   }
 }
 
@@ -402,6 +1594,29 @@ void *lvgl_setup_init_touch(void)
   lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
   lv_indev_set_read_cb(indev, gt911_lvgl_read);
 
+  // The GT911 task does the I2C reads and wakes LVGL, so the indev timer never touches the bus
+  touch_indev = indev;
+  bool touch_in_background = false;
+#if CONFIG_GT911_USE_INT_WAKEUP
+  touch_in_background = gt911_enable_interrupt(lvgl_touch_ready) == ESP_OK;
+  if (touch_in_background)
+  {
+    debug_log_info(DEBUG_TAG_GT911_TOUCH, "Touch input is interrupt driven");
+  }
+  else
+  {
+    debug_log_warning(DEBUG_TAG_GT911_TOUCH, "Touch interrupt unavailable, falling back to polling");
+  }
+#endif
+  if (!touch_in_background)
+  {
+    touch_in_background = gt911_start_background_read(lvgl_touch_ready) == ESP_OK;
+  }
+  if (touch_in_background)
+  {
+    lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+  }
+
   debug_log_event(DEBUG_TAG_GT911_TOUCH, "Touch controller initialized successfully");
 
   if (indev == NULL)
@@ -411,3 +1626,9 @@ void *lvgl_setup_init_touch(void)
 
   return indev;
 }
+
+static void lvgl_touch_ready(void)
+{
+  touch_pending = true;
+  lvgl_setup_wake_task();
+}
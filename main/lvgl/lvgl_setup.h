@@ -16,10 +16,21 @@
 #define LCD_VBP 10
 #define LCD_VFP 5
 
-// Backlight control
-#define LCD_BK_LIGHT_ON_LEVEL 1
+// Panel refresh timing derived from the pixel clock (~23.7 ms / ~42 Hz per frame)
+#define LCD_H_TOTAL (LCD_H_RES + LCD_HSYNC + LCD_HBP + LCD_HFP)
+#define LCD_V_TOTAL (LCD_V_RES + LCD_VSYNC + LCD_VBP + LCD_VFP)
+#define LCD_FRAME_PERIOD_US ((uint32_t)(((uint64_t)LCD_H_TOTAL * LCD_V_TOTAL * 1000000ULL) / LCD_PIXEL_CLOCK_HZ))
+
+// Backlight control, levels are percent of full brightness
+#define LCD_BK_LIGHT_ON_LEVEL 100
 #define LCD_BK_LIGHT_OFF_LEVEL 0
 #define PIN_NUM_BK_LIGHT 2 // ESP32-8048S050: GPIO2 for backlight PWM control
+
+#ifdef CONFIG_LCD_BACKLIGHT_PWM_FREQ_HZ
+#define LCD_BK_LIGHT_PWM_FREQ_HZ CONFIG_LCD_BACKLIGHT_PWM_FREQ_HZ
+#else
+#define LCD_BK_LIGHT_PWM_FREQ_HZ 20000 // Above the audible range of the boost converter
+#endif
 #define PIN_NUM_DISP_EN -1
 
 // GPIO pin assignments using CONFIG constants
@@ -63,11 +74,100 @@
 #define LCD_NUM_FB 1
 #endif
 
+// Rotation follows esp_lvgl_port: LVGL renders and maps touch in the rotated
+// orientation, the RGB driver mirrors/swaps each area while copying it
+#if CONFIG_EXAMPLE_LCD_ROTATION_90
+#define LCD_ROTATION LV_DISPLAY_ROTATION_90
+#define LCD_ROTATION_SWAP_XY true
+#define LCD_ROTATION_MIRROR_X false
+#define LCD_ROTATION_MIRROR_Y true
+#elif CONFIG_EXAMPLE_LCD_ROTATION_180
+#define LCD_ROTATION LV_DISPLAY_ROTATION_180
+#define LCD_ROTATION_SWAP_XY false
+#define LCD_ROTATION_MIRROR_X true
+#define LCD_ROTATION_MIRROR_Y true
+#elif CONFIG_EXAMPLE_LCD_ROTATION_270
+#define LCD_ROTATION LV_DISPLAY_ROTATION_270
+#define LCD_ROTATION_SWAP_XY true
+#define LCD_ROTATION_MIRROR_X true
+#define LCD_ROTATION_MIRROR_Y false
+#else
+#define LCD_ROTATION LV_DISPLAY_ROTATION_0
+#define LCD_ROTATION_SWAP_XY false
+#define LCD_ROTATION_MIRROR_X false
+#define LCD_ROTATION_MIRROR_Y false
+#endif
+
+#if CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+#define LCD_BOUNCE_BUFFER_LINES CONFIG_EXAMPLE_LCD_BOUNCE_BUFFER_LINES
+#endif
+
 // LVGL configuration - DRAM optimized for frame buffer in internal RAM
+#ifdef CONFIG_EXAMPLE_LVGL_DRAW_BUF_LINES
+#define LVGL_DRAW_BUF_LINES CONFIG_EXAMPLE_LVGL_DRAW_BUF_LINES // 800x40x2 = 64KB by default
+#else
 #define LVGL_DRAW_BUF_LINES 30 // Reduced from 60 to save DRAM (800x30x2 = 48KB vs 96KB)
+#endif
+
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+// Each of the two buffers gets LVGL_DRAW_BUF_LINES at most, fewer when DRAM is short
+#define LVGL_DRAW_BUF_MIN_LINES 10
+#define LVGL_DRAW_BUF_DRAM_RESERVE (CONFIG_EXAMPLE_LVGL_DRAW_BUF_DRAM_RESERVE_KB * 1024)
+#define LVGL_DRAW_BUF_ALIGN 64  // Cache line, lets GDMA copy rows straight out of the buffer
+#endif
+
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+// Areas are widened to whole cache lines, so CPU and GDMA writes never share a line
+#define LVGL_GDMA_ALIGN_PX (LVGL_DRAW_BUF_ALIGN / LCD_PIXEL_SIZE)
+#define LVGL_GDMA_BACKLOG 16 // Rows in flight before the flush task waits
+#endif
+
 #define LVGL_TICK_PERIOD_MS 2
-#define LVGL_TASK_STACK_SIZE (16 * 1024)
-#define LVGL_TASK_PRIORITY 5
+
+/**
+ * @brief Bounce buffer health counters
+ *
+ * A frame counts as an underrun when the next vsync arrives before the
+ * driver finished streaming the previous frame out of the bounce buffers.
+ */
+typedef struct
+{
+  uint32_t frames;                // Frames fully streamed through the bounce buffers
+  uint32_t underruns;             // Vsyncs without a completed frame since the previous one
+  uint32_t max_frame_interval_us; // Longest time between two completed frames
+} lvgl_bounce_stats_t;
+
+// Rolling display metrics: histogram bucket i counts samples below (1 << i) units,
+// the last bucket collects everything above. Time unit is 128 us, area unit is 1024 px.
+#define LVGL_METRICS_HIST_BUCKETS 12
+#define LVGL_METRICS_TIME_SHIFT 7
+#define LVGL_METRICS_AREA_SHIFT 10
+#define LVGL_METRICS_WINDOW_MS 10000
+
+/**
+ * @brief Histogram of one metric over a window
+ */
+typedef struct
+{
+  uint32_t count;                             // Samples in the window
+  uint32_t max;                               // Largest sample
+  uint64_t sum;                               // Sum of all samples (for the mean)
+  uint32_t buckets[LVGL_METRICS_HIST_BUCKETS]; // Log2 histogram, see LVGL_METRICS_*_SHIFT
+} lvgl_metrics_hist_t;
+
+/**
+ * @brief Display pipeline metrics of the last complete window
+ */
+typedef struct
+{
+  uint32_t window_ms;               // Window length the values cover
+  uint32_t frames;                  // Frames that flushed at least one area
+  uint32_t fps_x10;                 // Frames per second times 10
+  lvgl_metrics_hist_t render_us;    // Refresh time minus flush time, per frame
+  lvgl_metrics_hist_t flush_us;     // Time in flush_cb plus waiting for flush ready, per frame
+  lvgl_metrics_hist_t lock_wait_us; // Time waiting in lvgl_port_lock(), per acquisition
+  lvgl_metrics_hist_t inv_area_px;  // Invalidated area, per frame
+} lvgl_metrics_t;
 
 /**
  * @brief Initialize LVGL with LCD panel
@@ -82,16 +182,41 @@ lv_display_t *lvgl_setup_init(esp_lcd_panel_handle_t panel_handle);
 void lvgl_setup_start_task(void);
 
 /**
- * @brief Initialize and turn on LCD backlight
+ * @brief Initialize the backlight PWM, the backlight starts off
  */
 void lvgl_setup_init_backlight(void);
 
 /**
- * @brief Set LCD backlight level
- * @param level Backlight level (0 = off, 1 = on)
+ * @brief Set LCD backlight level at once
+ * @param level Brightness in percent, LCD_BK_LIGHT_OFF_LEVEL to LCD_BK_LIGHT_ON_LEVEL
+ * @note Cancels a running or scheduled fade
  */
 void lvgl_setup_set_backlight(uint32_t level);
 
+/**
+ * @brief Fade the backlight in hardware, returns without waiting
+ * @param level Target brightness in percent
+ * @param fade_ms Fade duration, 0 sets the level at once
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the backlight is not initialized
+ * @note Cancels a running or scheduled fade
+ */
+esp_err_t lvgl_setup_fade_backlight(uint32_t level, uint32_t fade_ms);
+
+/**
+ * @brief Start a backlight fade later
+ * @param level Target brightness in percent
+ * @param delay_ms Time until the fade starts
+ * @param fade_ms Fade duration
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the backlight is not initialized
+ * @note Any later backlight call replaces the scheduled fade
+ */
+esp_err_t lvgl_setup_schedule_backlight(uint32_t level, uint32_t delay_ms, uint32_t fade_ms);
+
+/**
+ * @brief Brightness the backlight is at, or fading towards, in percent
+ */
+uint32_t lvgl_setup_get_backlight(void);
+
 /**
  * @brief Create and configure LCD RGB panel
  * @return LCD panel handle
@@ -110,12 +235,113 @@ void *lvgl_setup_init_touch(void);
  */
 void lvgl_setup_create_ui_safe(lv_display_t *display, void (*ui_create_func)(lv_display_t *));
 
+/**
+ * @brief Get bounce buffer health counters
+ * @param stats Output counters
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED when bounce buffer mode is disabled
+ */
+esp_err_t lvgl_setup_get_bounce_stats(lvgl_bounce_stats_t *stats);
+
+/**
+ * @brief Handler run by the LVGL task, with the LVGL lock held, before every timer pass
+ */
+typedef void (*lvgl_update_handler_t)(void);
+
+/**
+ * @brief Register the handler that applies queued UI updates
+ * @param handler Handler to run from the LVGL task (NULL to remove)
+ */
+void lvgl_setup_register_update_handler(lvgl_update_handler_t handler);
+
+/**
+ * @brief Wake the LVGL task so it runs its timers immediately
+ */
+void lvgl_setup_wake_task(void);
+
+/**
+ * @brief Refresh period lvgl_setup_init() configured, vsync aligned when pacing is on
+ */
+uint32_t lvgl_setup_get_refr_period_ms(void);
+
+/**
+ * @brief Stop or resume scan-out and rendering while the screen is dark
+ *
+ * Sleeping pauses the LVGL refresh timer and stops the RGB controller, so the
+ * frame buffer is no longer streamed out of PSRAM. Waking restarts scan-out
+ * and redraws the whole screen.
+ *
+ * @param display Display created by lvgl_setup_init()
+ * @param sleep true to sleep, false to wake
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for NULL; if the panel
+ *         driver cannot stop scan-out, rendering is still paused and its error is returned
+ * @note Call from the LVGL task or with the LVGL lock held
+ */
+esp_err_t lvgl_setup_set_display_sleep(lv_display_t *display, bool sleep);
+
+/**
+ * @brief Change the RGB pixel clock, and with it the scan-out frame rate
+ *
+ * A lower clock streams the frame buffer out of PSRAM less often, which
+ * frees PSRAM bandwidth and power while little changes on screen. The new
+ * clock applies from the next vsync.
+ *
+ * @param display Display created by lvgl_setup_init()
+ * @param pclk_hz New clock, at most LCD_PIXEL_CLOCK_HZ
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a NULL display or a
+ *         clock out of range, otherwise the panel driver's error
+ * @note Call from the LVGL task or with the LVGL lock held
+ */
+esp_err_t lvgl_setup_set_pixel_clock(lv_display_t *display, uint32_t pclk_hz);
+
+/**
+ * @brief Wake the LVGL task from an interrupt handler
+ * @return true if a higher priority task was woken and a yield is needed
+ */
+bool lvgl_setup_wake_task_from_isr(void);
+
+/**
+ * @brief Get display pipeline metrics of the last complete window
+ * @param metrics Output metrics
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for NULL, ESP_ERR_NOT_SUPPORTED if metrics are disabled
+ */
+esp_err_t lvgl_setup_get_metrics(lvgl_metrics_t *metrics);
+
+/**
+ * @brief Start collecting display metrics over a span of the caller's choosing
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if metrics are disabled
+ * @note Restarts a capture already running; the rolling window is unaffected
+ */
+esp_err_t lvgl_setup_metrics_capture_start(void);
+
+/**
+ * @brief End the capture and return what it collected
+ * @param metrics Output metrics, window_ms and fps_x10 cover the captured span
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for NULL, ESP_ERR_INVALID_STATE
+ *         without a running capture, ESP_ERR_NOT_SUPPORTED if metrics are disabled
+ */
+esp_err_t lvgl_setup_metrics_capture_stop(lvgl_metrics_t *metrics);
+
+/**
+ * @brief Format display metrics as a single-line JSON object
+ * @param metrics Metrics to format
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @return Number of characters written (excluding terminator), 0 on error
+ */
+size_t lvgl_setup_format_metrics_json(const lvgl_metrics_t *metrics, char *buffer, size_t size);
+
 /**
  * @brief Acquire LVGL API lock with timeout (for thread safety)
  * @param timeout_ms Timeout in milliseconds (0 = no timeout)
+ * @param site Caller's function, the entry in the lock profile (lvgl_lock_prof.h)
  * @return true if lock acquired, false if timeout
  */
-bool lvgl_port_lock(int timeout_ms);
+bool lvgl_port_lock_at(int timeout_ms, const char *site);
+
+/**
+ * @brief lvgl_port_lock_at() for the calling function
+ */
+#define lvgl_port_lock(timeout_ms) lvgl_port_lock_at((timeout_ms), __func__)
 
 /**
  * @brief Release LVGL API lock (for thread safety)
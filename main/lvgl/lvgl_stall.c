@@ -0,0 +1,329 @@
+/**
+ * @file lvgl_stall.c
+ * @brief Stall watchdog of the LVGL task
+ *
+ * The deadline callback runs on the esp_timer task while the LVGL task is
+ * stuck, so it can look at it; that task runs on the network core, so a
+ * busy LVGL task on the render core still shows as running. The backtrace is unwound from the context
+ * the task saved when it was switched out; FreeRTOS spills the register
+ * windows to its stack on every switch, so esp_backtrace_get_next_frame()
+ * walks it like its own. The task may wake during the walk, which at
+ * worst cuts the backtrace short or ends it in a stale frame.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "lvgl_stall.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_cpu.h"
+#include "esp_debug_helpers.h"
+#include "esp_timer.h"
+#include "lvgl_lock_prof.h"
+#include "metrics.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "esp_private/freertos_debug.h"
+#include "xtensa_context.h"
+#endif
+
+#if CONFIG_LVGL_STALL_WATCHDOG
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef enum
+{
+  STALL_LOCK_WAIT = 0,
+  STALL_BLOCKED,
+  STALL_PREEMPTED,
+  STALL_BUSY,
+  STALL_CAUSE_COUNT,
+} stall_cause_t;
+
+typedef enum
+{
+  PASS_IDLE = 0,
+  PASS_WAITING, ///< Before the LVGL lock
+  PASS_LOCKED,
+} pass_phase_t;
+
+typedef struct
+{
+  stall_cause_t cause;
+  int64_t start_us;
+  uint32_t ms; ///< Length once the pass ended, 0 while it goes on
+  const char *holder;
+  uint32_t bt[LVGL_STALL_BT_DEPTH];
+  int bt_depth;
+} stall_record_t;
+
+static const char *const cause_names[STALL_CAUSE_COUNT] = {"lock_wait", "blocked", "preempted", "busy"};
+
+#define STALL_METRIC(cause_)                         \
+  {.name = "ui_stalls_total",                        \
+   .help = "LVGL passes over the stall deadline",    \
+   .labels = "cause=\"" cause_ "\"",                 \
+   .type = METRIC_TYPE_COUNTER}
+
+static metric_t stall_metrics[STALL_CAUSE_COUNT] = {
+    [STALL_LOCK_WAIT] = STALL_METRIC("lock_wait"),
+    [STALL_BLOCKED] = STALL_METRIC("blocked"),
+    [STALL_PREEMPTED] = STALL_METRIC("preempted"),
+    [STALL_BUSY] = STALL_METRIC("busy"),
+};
+
+static TaskHandle_t watched_task = NULL;
+static esp_timer_handle_t deadline_timer = NULL;
+
+// Pass state written by the LVGL task, stall state by the deadline callback
+static portMUX_TYPE stall_lock = portMUX_INITIALIZER_UNLOCKED;
+static pass_phase_t pass_phase = PASS_IDLE;
+static int64_t pass_start_us = 0;
+static bool pass_stalled = false;
+static uint32_t stall_counts[STALL_CAUSE_COUNT];
+static uint32_t stall_max_ms = 0;
+static stall_record_t last_stall;
+static bool have_stall = false;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Return addresses of a switched-out task, innermost first
+ * @return Frames written, 0 if the task is running or the target has no unwinder
+ */
+static int task_backtrace(TaskHandle_t task, uint32_t *pcs, int depth)
+{
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+  TaskSnapshot_t snapshot;
+  if (vTaskGetSnapshot(task, &snapshot) != pdTRUE)
+    return 0;
+
+  // Preempted tasks saved a full exception frame, tasks that blocked a solicited one
+  esp_backtrace_frame_t frame = {0};
+  const XtExcFrame *exc = (const XtExcFrame *)snapshot.pxTopOfStack;
+  if (exc->exit)
+  {
+    frame.pc = exc->pc;
+    frame.sp = exc->a1;
+    frame.next_pc = exc->a0;
+  }
+  else
+  {
+    const XtSolFrame *sol = (const XtSolFrame *)snapshot.pxTopOfStack;
+    frame.pc = sol->pc;
+    frame.sp = sol->a1;
+    frame.next_pc = sol->a0;
+  }
+
+  int n = 0;
+  pcs[n++] = esp_cpu_process_stack_pc(frame.pc);
+  while (n < depth && frame.next_pc && esp_backtrace_get_next_frame(&frame))
+    pcs[n++] = esp_cpu_process_stack_pc(frame.pc);
+  return n;
+#else
+  (void)task;
+  (void)pcs;
+  (void)depth;
+  return 0;
+#endif
+}
+
+static void deadline_cb(void *arg)
+{
+  (void)arg;
+  portENTER_CRITICAL(&stall_lock);
+  pass_phase_t phase = pass_phase;
+  int64_t start_us = pass_start_us;
+  portEXIT_CRITICAL(&stall_lock);
+  if (phase == PASS_IDLE)
+    return; // Ended while the timer fired
+
+  eTaskState state = eTaskGetState(watched_task);
+  stall_record_t record = {.start_us = start_us};
+  if (phase == PASS_WAITING)
+    record.cause = STALL_LOCK_WAIT;
+  else if (state == eRunning)
+    record.cause = STALL_BUSY;
+  else if (state == eReady)
+    record.cause = STALL_PREEMPTED;
+  else
+    record.cause = STALL_BLOCKED;
+  if (record.cause == STALL_LOCK_WAIT)
+    record.holder = lvgl_lock_prof_begin_wait();
+  if (state != eRunning)
+    record.bt_depth = task_backtrace(watched_task, record.bt, LVGL_STALL_BT_DEPTH);
+
+  portENTER_CRITICAL(&stall_lock);
+  bool current = pass_phase != PASS_IDLE && pass_start_us == start_us;
+  if (current)
+  {
+    pass_stalled = true;
+    stall_counts[record.cause]++;
+    last_stall = record;
+    have_stall = true;
+  }
+  portEXIT_CRITICAL(&stall_lock);
+  if (!current)
+    return;
+
+  metrics_counter_add(&stall_metrics[record.cause], 1);
+  debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "UI stall over %d ms: %s, lock held by %s", CONFIG_LVGL_STALL_DEADLINE_MS,
+                      cause_names[record.cause],
+                      record.holder ? record.holder : (phase == PASS_LOCKED ? "lvgl_port_task" : "unknown"));
+  if (record.bt_depth > 0)
+  {
+    const uint32_t *bt = record.bt;
+    _Static_assert(LVGL_STALL_BT_DEPTH == 8, "One log line per backtrace");
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "UI stall backtrace: %08lx %08lx %08lx %08lx %08lx %08lx %08lx %08lx",
+                        (unsigned long)bt[0], (unsigned long)bt[1], (unsigned long)bt[2], (unsigned long)bt[3],
+                        (unsigned long)bt[4], (unsigned long)bt[5], (unsigned long)bt[6], (unsigned long)bt[7]);
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void lvgl_stall_init(TaskHandle_t lvgl_task)
+{
+  watched_task = lvgl_task;
+  const esp_timer_create_args_t timer_args = {
+      .callback = deadline_cb,
+      .name = "lvgl_stall",
+  };
+  if (esp_timer_create(&timer_args, &deadline_timer) != ESP_OK)
+  {
+    debug_log_error(DEBUG_TAG_LVGL_SETUP, "Stall watchdog timer not created");
+    return;
+  }
+  for (int i = 0; i < STALL_CAUSE_COUNT; i++)
+    metrics_register(&stall_metrics[i]);
+}
+
+void lvgl_stall_pass_begin(void)
+{
+  if (!deadline_timer)
+    return;
+  portENTER_CRITICAL(&stall_lock);
+  pass_phase = PASS_WAITING;
+  pass_start_us = esp_timer_get_time();
+  pass_stalled = false;
+  portEXIT_CRITICAL(&stall_lock);
+  esp_timer_start_once(deadline_timer, CONFIG_LVGL_STALL_DEADLINE_MS * 1000ULL);
+}
+
+void lvgl_stall_pass_locked(void)
+{
+  portENTER_CRITICAL(&stall_lock);
+  if (pass_phase == PASS_WAITING)
+    pass_phase = PASS_LOCKED;
+  portEXIT_CRITICAL(&stall_lock);
+}
+
+void lvgl_stall_pass_end(void)
+{
+  if (!deadline_timer)
+    return;
+  esp_timer_stop(deadline_timer);
+
+  uint32_t ms = 0;
+  stall_cause_t cause = STALL_BUSY;
+  portENTER_CRITICAL(&stall_lock);
+  bool stalled = pass_stalled;
+  if (stalled)
+  {
+    ms = (uint32_t)((esp_timer_get_time() - pass_start_us) / 1000);
+    last_stall.ms = ms;
+    cause = last_stall.cause;
+    if (ms > stall_max_ms)
+      stall_max_ms = ms;
+  }
+  pass_phase = PASS_IDLE;
+  pass_stalled = false;
+  portEXIT_CRITICAL(&stall_lock);
+
+  if (stalled)
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "UI froze for %lu ms (%s)", (unsigned long)ms, cause_names[cause]);
+}
+
+bool lvgl_stall_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_UI_STALLS") != 0)
+    return false;
+
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&stall_lock);
+  uint32_t counts[STALL_CAUSE_COUNT];
+  memcpy(counts, stall_counts, sizeof(counts));
+  uint32_t max_ms = stall_max_ms;
+  stall_record_t last = last_stall;
+  bool have_last = have_stall;
+  portEXIT_CRITICAL(&stall_lock);
+
+  uint32_t total = 0;
+  for (int i = 0; i < STALL_CAUSE_COUNT; i++)
+    total += counts[i];
+
+  char reply[512];
+  int len = snprintf(reply, sizeof(reply), "UI_STALLS {\"deadline_ms\":%d,\"stalls\":%lu,\"max_ms\":%lu,\"causes\":{",
+                     CONFIG_LVGL_STALL_DEADLINE_MS, (unsigned long)total, (unsigned long)max_ms);
+  for (int i = 0; i < STALL_CAUSE_COUNT; i++)
+    len += snprintf(reply + len, sizeof(reply) - len, "%s\"%s\":%lu", i ? "," : "", cause_names[i],
+                    (unsigned long)counts[i]);
+  if (!have_last)
+  {
+    len += snprintf(reply + len, sizeof(reply) - len, "},\"last\":null}\n");
+  }
+  else
+  {
+    // A stall still going on reports its length so far
+    uint32_t ms = last.ms ? last.ms : (uint32_t)((now_us - last.start_us) / 1000);
+    len += snprintf(reply + len, sizeof(reply) - len,
+                    "},\"last\":{\"cause\":\"%s\",\"ms\":%lu,\"ongoing\":%s,\"age_s\":%lld,\"holder\":",
+                    cause_names[last.cause], (unsigned long)ms, last.ms ? "false" : "true",
+                    (long long)((now_us - last.start_us) / 1000000));
+    len += snprintf(reply + len, sizeof(reply) - len, last.holder ? "\"%s\",\"bt\":[" : "null,\"bt\":[", last.holder);
+    for (int i = 0; i < last.bt_depth; i++)
+      len += snprintf(reply + len, sizeof(reply) - len, "%s\"0x%08lx\"", i ? "," : "", (unsigned long)last.bt[i]);
+    len += snprintf(reply + len, sizeof(reply) - len, "]}}\n");
+  }
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+void lvgl_stall_init(TaskHandle_t lvgl_task)
+{
+  (void)lvgl_task;
+}
+
+void lvgl_stall_pass_begin(void)
+{
+}
+
+void lvgl_stall_pass_locked(void)
+{
+}
+
+void lvgl_stall_pass_end(void)
+{
+}
+
+bool lvgl_stall_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_UI_STALLS") != 0)
+    return false;
+  static const char disabled[] = "UI_STALLS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_LVGL_STALL_WATCHDOG
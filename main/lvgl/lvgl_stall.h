@@ -0,0 +1,79 @@
+/**
+ * @file lvgl_stall.h
+ * @brief Stall watchdog of the LVGL task
+ *
+ * Each pass of lvgl_port_task (lock, UI updates, lv_timer_handler) arms a
+ * one-shot timer for CONFIG_LVGL_STALL_DEADLINE_MS. Sleeping between passes
+ * is idle, not a stall, so only the pass itself is timed. If the timer
+ * fires, the pass missed its deadline and the timer callback records why
+ * while the stall is still going on:
+ *
+ *   lock_wait  the LVGL task is still waiting for the LVGL lock, the site
+ *              holding it (lvgl_lock_prof.h) is recorded
+ *   blocked    it holds the lock and blocks on something else, e.g. an
+ *              event handler waiting for HTTP; its backtrace is recorded
+ *   preempted  it is ready but a higher priority task has its core
+ *   busy       it is running, rendering or looping
+ *
+ * The cause, holder and backtrace go to the log ring as they are found,
+ * the length of the stall when the pass ends. Stalls are counted per cause
+ * in the ui_stalls_total metric, and GET_UI_STALLS reports the counts and
+ * the last stall:
+ *   UI_STALLS {"deadline_ms":200,"stalls":3,"max_ms":1450,"causes":{"lock_wait":0,...},
+ *              "last":{"cause":"blocked","ms":1450,"age_s":12,"holder":null,"bt":["0x42012345",...]}}
+ *
+ * The backtrace comes from the saved context of the switched-out task, so
+ * only blocked and preempted stalls have one; the addresses resolve with
+ * addr2line against the firmware ELF.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define LVGL_STALL_BT_DEPTH 8 ///< Frames kept of a stalled task's backtrace
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create the deadline timer and register the stall metrics
+ * @param lvgl_task Task running the LVGL passes
+ */
+void lvgl_stall_init(TaskHandle_t lvgl_task);
+
+/**
+ * @brief A pass starts, before the LVGL lock is taken
+ * @note LVGL task
+ */
+void lvgl_stall_pass_begin(void);
+
+/**
+ * @brief The pass got the LVGL lock
+ * @note LVGL task
+ */
+void lvgl_stall_pass_locked(void);
+
+/**
+ * @brief The pass is over, after the LVGL lock was released
+ * @note LVGL task
+ */
+void lvgl_stall_pass_end(void);
+
+/**
+ * @brief Handle GET_UI_STALLS
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a stall command
+ */
+bool lvgl_stall_handle_command(const char *line);
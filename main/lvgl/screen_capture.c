@@ -0,0 +1,466 @@
+/**
+ * @file screen_capture.c
+ * @brief Frame buffer capture and dirty-area history over serial
+ *
+ * The copy is the only part done under the LVGL lock, a memcpy of one
+ * frame buffer within PSRAM takes a few milliseconds; encoding and the
+ * transfer, which take far longer, run on the copy. With two frame buffers
+ * the one on screen is the one LVGL is not drawing into next.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "screen_capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_rgb.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl_setup.h"
+#include "mbedtls/base64.h"
+#include "serial/serial_data_handler.h"
+#include "serial/serial_mux.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+#if CONFIG_SCREEN_CAPTURE
+
+#define CAPTURE_MAX_PACKET (1 + 128 * LCD_PIXEL_SIZE)
+#define CAPTURE_CHUNK_CAPACITY (SCREEN_CAPTURE_CHUNK_BYTES + CAPTURE_MAX_PACKET) // The last packet may overshoot
+#define CAPTURE_LINE_BYTES (sizeof("SCREENSHOT_DATA ") + ((CAPTURE_CHUNK_CAPACITY + 2) / 3) * 4 + 1)
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+/**
+ * @brief Areas invalidated for one refresh
+ */
+typedef struct
+{
+  uint32_t seq;
+  uint32_t t_ms;
+  uint32_t px; ///< Sum of the clipped areas, overlaps counted twice like LVGL's own metric
+  uint8_t count;
+  lv_area_t areas[SCREEN_CAPTURE_AREAS_PER_FRAME];
+} dirty_frame_t;
+
+static lv_display_t *capture_display = NULL;
+
+// Frame being refreshed, only touched from the LVGL task
+static dirty_frame_t pending_frame = {0};
+static uint32_t frame_seq = 0;
+
+// Completed frames, oldest first from dirty_next once the ring is full
+static portMUX_TYPE dirty_lock = portMUX_INITIALIZER_UNLOCKED;
+static dirty_frame_t dirty_ring[SCREEN_CAPTURE_FRAMES];
+static int dirty_next = 0;
+static int dirty_count = 0;
+
+static volatile bool running = false;
+static int requested_frames = SCREEN_CAPTURE_FRAMES;
+static uint16_t capture_request = 0; ///< Mux request the capture answers, 0 on the line protocol
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void dirty_event_cb(lv_event_t *e)
+{
+  switch (lv_event_get_code(e))
+  {
+  case LV_EVENT_INVALIDATE_AREA:
+  {
+    lv_area_t screen = {0, 0, lv_display_get_horizontal_resolution(capture_display) - 1,
+                        lv_display_get_vertical_resolution(capture_display) - 1};
+    lv_area_t clipped;
+    if (!lv_area_intersect(&clipped, (const lv_area_t *)lv_event_get_param(e), &screen))
+      break;
+
+    pending_frame.px += lv_area_get_size(&clipped);
+    if (pending_frame.count < SCREEN_CAPTURE_AREAS_PER_FRAME)
+    {
+      pending_frame.areas[pending_frame.count++] = clipped;
+    }
+    else
+    {
+      lv_area_t *last = &pending_frame.areas[SCREEN_CAPTURE_AREAS_PER_FRAME - 1];
+      last->x1 = LV_MIN(last->x1, clipped.x1);
+      last->y1 = LV_MIN(last->y1, clipped.y1);
+      last->x2 = LV_MAX(last->x2, clipped.x2);
+      last->y2 = LV_MAX(last->y2, clipped.y2);
+    }
+    break;
+  }
+  case LV_EVENT_REFR_READY:
+    // Refresh passes without dirty areas drew nothing
+    if (pending_frame.count > 0)
+    {
+      pending_frame.seq = ++frame_seq;
+      pending_frame.t_ms = (uint32_t)(esp_timer_get_time() / 1000);
+      taskENTER_CRITICAL(&dirty_lock);
+      dirty_ring[dirty_next] = pending_frame;
+      dirty_next = (dirty_next + 1) % SCREEN_CAPTURE_FRAMES;
+      if (dirty_count < SCREEN_CAPTURE_FRAMES)
+      {
+        dirty_count++;
+      }
+      taskEXIT_CRITICAL(&dirty_lock);
+      memset(&pending_frame, 0, sizeof(pending_frame));
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Frame buffer being scanned out, caller holds the LVGL lock
+ */
+static const uint8_t *front_buffer(void)
+{
+  void *fbs[2] = {NULL, NULL};
+  esp_lcd_panel_handle_t panel = lv_display_get_user_data(capture_display);
+#if LCD_NUM_FB == 2
+  if (esp_lcd_rgb_panel_get_frame_buffer(panel, 2, &fbs[0], &fbs[1]) != ESP_OK)
+    return NULL;
+  lv_draw_buf_t *active = lv_display_get_buf_active(capture_display);
+  return (active && active->data == fbs[0]) ? fbs[1] : fbs[0];
+#else
+  if (esp_lcd_rgb_panel_get_frame_buffer(panel, 1, &fbs[0]) != ESP_OK)
+    return NULL;
+  return fbs[0];
+#endif
+}
+
+static inline bool same_pixel(const uint8_t *a, const uint8_t *b)
+{
+  return memcmp(a, b, LCD_PIXEL_SIZE) == 0;
+}
+
+/**
+ * @brief Encode the next packet of pixels
+ * @return Bytes written to out, at most CAPTURE_MAX_PACKET
+ */
+static size_t encode_packet(const uint8_t *pixels, size_t count, size_t *pos, uint8_t *out)
+{
+  const uint8_t *start = pixels + *pos * LCD_PIXEL_SIZE;
+  size_t remaining = count - *pos;
+  size_t limit = remaining < 128 ? remaining : 128;
+
+  size_t run = 1;
+  while (run < limit && same_pixel(start + run * LCD_PIXEL_SIZE, start))
+  {
+    run++;
+  }
+  if (run > 1)
+  {
+    out[0] = 0x80 | (uint8_t)(run - 1);
+    memcpy(out + 1, start, LCD_PIXEL_SIZE);
+    *pos += run;
+    return 1 + LCD_PIXEL_SIZE;
+  }
+
+  // Literals up to the next pair of equal pixels, which starts a run instead
+  size_t literal = 1;
+  while (literal < limit &&
+         !(literal + 1 < remaining && same_pixel(start + literal * LCD_PIXEL_SIZE, start + (literal + 1) * LCD_PIXEL_SIZE)))
+  {
+    literal++;
+  }
+  out[0] = (uint8_t)(literal - 1);
+  memcpy(out + 1, start, literal * LCD_PIXEL_SIZE);
+  *pos += literal;
+  return 1 + literal * LCD_PIXEL_SIZE;
+}
+
+static void write_chunk(const uint8_t *chunk, size_t len, char *line)
+{
+  if (capture_request)
+  {
+    serial_mux_send(SERIAL_CHANNEL_BULK, SERIAL_MUX_FLAG_MORE, capture_request, chunk, len);
+    return;
+  }
+
+  static const char prefix[] = "SCREENSHOT_DATA ";
+  size_t olen = 0;
+  memcpy(line, prefix, sizeof(prefix) - 1);
+  mbedtls_base64_encode((unsigned char *)line + sizeof(prefix) - 1, CAPTURE_LINE_BYTES - sizeof(prefix), &olen, chunk,
+                        len);
+  olen += sizeof(prefix) - 1;
+  line[olen++] = '\n';
+  serial_data_write(line, olen);
+}
+
+static void write_dirty_frame(const dirty_frame_t *frame)
+{
+  char buf[96 + SCREEN_CAPTURE_AREAS_PER_FRAME * 28];
+  int len = snprintf(buf, sizeof(buf), "SCREENSHOT_DIRTY {\"seq\":%lu,\"t_ms\":%lu,\"px\":%lu,\"areas\":[",
+                     (unsigned long)frame->seq, (unsigned long)frame->t_ms, (unsigned long)frame->px);
+  for (int i = 0; i < frame->count; i++)
+  {
+    const lv_area_t *a = &frame->areas[i];
+    len += snprintf(buf + len, sizeof(buf) - len, "%s[%ld,%ld,%ld,%ld]", i ? "," : "", (long)a->x1, (long)a->y1,
+                    (long)a->x2, (long)a->y2);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "]}\n");
+  serial_mux_reply(capture_request, buf, len, false);
+}
+
+/**
+ * @brief Error reply, ends a deferred mux response
+ * @param request Request to end, 0 for a plain line (also inside a mux request that was not deferred)
+ */
+static void reply_error(uint16_t request, const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "SCREENSHOT {\"error\":\"%s\"}\n", message);
+  serial_mux_reply(request, buf, len, true);
+}
+
+/**
+ * @brief Copy the frame on screen and the last dirty frames
+ * @return NULL on success, else the error for the reply
+ */
+static const char *copy_screen(uint8_t *copy, dirty_frame_t *frames, int max_frames, int *frames_count)
+{
+  if (!lvgl_port_lock(SCREEN_CAPTURE_LOCK_MS))
+    return "lvgl busy";
+
+  const uint8_t *fb = front_buffer();
+  if (fb)
+  {
+    memcpy(copy, fb, (size_t)LCD_H_RES * LCD_V_RES * LCD_PIXEL_SIZE);
+  }
+  taskENTER_CRITICAL(&dirty_lock);
+  int count = dirty_count < max_frames ? dirty_count : max_frames;
+  for (int i = 0; i < count; i++)
+  {
+    int index = (dirty_next - count + i + SCREEN_CAPTURE_FRAMES) % SCREEN_CAPTURE_FRAMES;
+    frames[i] = dirty_ring[index];
+  }
+  taskEXIT_CRITICAL(&dirty_lock);
+  lvgl_port_unlock();
+
+  *frames_count = count;
+  return fb ? NULL : "no frame buffer";
+}
+
+/**
+ * @brief Claim the single capture slot
+ */
+static bool claim_capture(void)
+{
+  taskENTER_CRITICAL(&dirty_lock);
+  bool busy = running;
+  running = true;
+  taskEXIT_CRITICAL(&dirty_lock);
+  return !busy;
+}
+
+static void capture_task(void *arg)
+{
+  (void)arg;
+  const size_t pixel_count = (size_t)LCD_H_RES * LCD_V_RES;
+  const size_t frame_bytes = pixel_count * LCD_PIXEL_SIZE;
+  int64_t start_us = esp_timer_get_time();
+
+  uint8_t *copy = heap_caps_malloc(frame_bytes, MALLOC_CAP_SPIRAM);
+  uint8_t *chunk = malloc(CAPTURE_CHUNK_CAPACITY);
+  char *line = malloc(CAPTURE_LINE_BYTES);
+  dirty_frame_t *frames = malloc(sizeof(dirty_ring));
+  int frames_count = 0;
+  const char *error = NULL;
+
+  if (!copy || !chunk || !line || !frames)
+  {
+    error = "no memory";
+  }
+  else
+  {
+    error = copy_screen(copy, frames, requested_frames, &frames_count);
+  }
+
+  if (error)
+  {
+    reply_error(capture_request, error);
+  }
+  else
+  {
+    int64_t copied_us = esp_timer_get_time();
+    char head[224];
+    int len = snprintf(head, sizeof(head),
+                       "SCREENSHOT {\"w\":%d,\"h\":%d,\"format\":\"%s\",\"encoding\":\"rle\",\"rotation\":%d,"
+                       "\"raw_bytes\":%u,\"frames\":%d,\"copy_us\":%lld}\n",
+                       LCD_H_RES, LCD_V_RES, LCD_PIXEL_SIZE == 2 ? "rgb565" : "rgb888", (int)LCD_ROTATION * 90,
+                       (unsigned)frame_bytes, frames_count, (long long)(copied_us - start_us));
+    serial_mux_reply(capture_request, head, len, false);
+
+    size_t pos = 0;
+    size_t fill = 0;
+    size_t encoded = 0;
+    while (pos < pixel_count)
+    {
+      fill += encode_packet(copy, pixel_count, &pos, chunk + fill);
+      if (fill >= SCREEN_CAPTURE_CHUNK_BYTES || pos == pixel_count)
+      {
+        write_chunk(chunk, fill, line);
+        encoded += fill;
+        fill = 0;
+      }
+    }
+
+    // An empty frame without the more flag ends the bulk data
+    if (capture_request)
+      serial_mux_send(SERIAL_CHANNEL_BULK, 0, capture_request, NULL, 0);
+
+    for (int i = 0; i < frames_count; i++)
+    {
+      write_dirty_frame(&frames[i]);
+    }
+
+    uint32_t crc = esp_rom_crc32_le(0, copy, frame_bytes);
+    len = snprintf(head, sizeof(head), "SCREENSHOT {\"done\":true,\"bytes\":%u,\"crc32\":%lu,\"ms\":%lld}\n",
+                   (unsigned)encoded, (unsigned long)crc, (long long)((esp_timer_get_time() - start_us) / 1000));
+    serial_mux_reply(capture_request, head, len, true);
+    debug_log_info_f(DEBUG_TAG_LVGL_SETUP, "Screenshot sent: %u of %u bytes", (unsigned)encoded, (unsigned)frame_bytes);
+  }
+
+  heap_caps_free(copy);
+  free(chunk);
+  free(line);
+  free(frames);
+  running = false;
+  vTaskDelete(NULL);
+}
+
+#endif // CONFIG_SCREEN_CAPTURE
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t screen_capture_init(lv_display_t *display)
+{
+#if CONFIG_SCREEN_CAPTURE
+  if (!display)
+    return ESP_ERR_INVALID_ARG;
+  capture_display = display;
+  lv_display_add_event_cb(display, dirty_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+  lv_display_add_event_cb(display, dirty_event_cb, LV_EVENT_REFR_READY, NULL);
+  return ESP_OK;
+#else
+  (void)display;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool screen_capture_is_running(void)
+{
+#if CONFIG_SCREEN_CAPTURE
+  return running;
+#else
+  return false;
+#endif
+}
+
+esp_err_t screen_capture_write_bmp(screen_capture_write_fn_t write, void *ctx)
+{
+#if CONFIG_SCREEN_CAPTURE
+  if (!capture_display)
+    return ESP_ERR_INVALID_STATE;
+  if (!claim_capture())
+    return ESP_ERR_INVALID_STATE;
+
+  const size_t row_bytes = (size_t)LCD_H_RES * LCD_PIXEL_SIZE;
+  const size_t frame_bytes = row_bytes * LCD_V_RES;
+  uint8_t *copy = heap_caps_malloc(frame_bytes, MALLOC_CAP_SPIRAM);
+  esp_err_t ret = ESP_ERR_NO_MEM;
+  if (copy)
+  {
+    dirty_frame_t unused;
+    int unused_count;
+    ret = copy_screen(copy, &unused, 0, &unused_count) ? ESP_ERR_TIMEOUT : ESP_OK;
+  }
+
+  if (ret == ESP_OK)
+  {
+    // Top-down rows (negative height), RGB565 as bit fields or 24-bit B, G, R as stored
+    const uint32_t header_bytes = 14 + 40 + (LCD_PIXEL_SIZE == 2 ? 12 : 0);
+    const uint32_t stride = (row_bytes + 3) & ~3u;
+    uint32_t image_bytes = stride * LCD_V_RES;
+    uint8_t header[14 + 40 + 12] = {'B', 'M'};
+    uint32_t fields[] = {
+        header_bytes + image_bytes, 0, header_bytes, 40, LCD_H_RES, (uint32_t)-LCD_V_RES,
+        1 | (LCD_PIXEL_SIZE * 8) << 16, LCD_PIXEL_SIZE == 2 ? 3 : 0, image_bytes, 2835, 2835, 0, 0,
+        0xF800, 0x07E0, 0x001F,
+    };
+    memcpy(header + 2, fields, sizeof(fields));
+    ret = write(ctx, header, header_bytes);
+
+    // Rows go out straight from the copy, padded only if the width needs it
+    static const uint8_t padding[3] = {0};
+    const int rows_per_write = stride == row_bytes ? 16 : 1;
+    for (int y = 0; y < LCD_V_RES && ret == ESP_OK; y += rows_per_write)
+    {
+      int rows = (LCD_V_RES - y < rows_per_write) ? LCD_V_RES - y : rows_per_write;
+      ret = write(ctx, copy + y * row_bytes, rows * row_bytes);
+      if (ret == ESP_OK && stride != row_bytes)
+        ret = write(ctx, padding, stride - row_bytes);
+    }
+  }
+
+  heap_caps_free(copy);
+  running = false;
+  return ret;
+#else
+  (void)write;
+  (void)ctx;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool screen_capture_handle_command(const char *line)
+{
+  if (strncmp(line, "SCREENSHOT", 10) != 0 || (line[10] != '\0' && line[10] != ' '))
+    return false;
+
+#if CONFIG_SCREEN_CAPTURE
+  int frames = SCREEN_CAPTURE_FRAMES;
+  sscanf(line + 10, "%d", &frames);
+  if (frames < 0 || frames > SCREEN_CAPTURE_FRAMES)
+  {
+    reply_error(0, "bad frame count");
+    return true;
+  }
+  if (!capture_display)
+  {
+    reply_error(0, "no display");
+    return true;
+  }
+
+  if (!claim_capture())
+  {
+    reply_error(0, "busy");
+    return true;
+  }
+
+  requested_frames = frames;
+  capture_request = serial_mux_defer_reply();
+  if (task_plan_create(TASK_PLAN_SCREENSHOT, capture_task, NULL, NULL) != pdPASS)
+  {
+    running = false;
+    reply_error(capture_request, "no memory");
+  }
+#else
+  static const char disabled[] = "SCREENSHOT {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file screen_capture.h
+ * @brief Frame buffer capture and dirty-area history over serial
+ *
+ * SCREENSHOT [frames] copies the frame buffer on screen into PSRAM under the
+ * LVGL lock, then streams it from a short-lived task, run-length encoded
+ * per pixel and base64 wrapped so it survives the line-based serial
+ * protocol. The areas LVGL invalidated in the last frames follow, so a host
+ * can compare two captures and find areas that were redrawn unchanged.
+ * main/utils/screenshot.py decodes the stream.
+ *
+ * Reply lines, in order:
+ *   SCREENSHOT {"w":800,"h":480,"format":"rgb565","encoding":"rle",...}
+ *   SCREENSHOT_DATA <base64>                      one per chunk
+ *   SCREENSHOT_DIRTY {"seq":N,"t_ms":T,"px":P,"areas":[[x1,y1,x2,y2],...]}
+ *   SCREENSHOT {"done":true,"bytes":B,"crc32":C,"ms":M}
+ *
+ * Sent as a mux request (serial/serial_mux.h) the reply lines come back as
+ * response frames of the request and the encoded data as raw bulk frames
+ * with the same request id instead of SCREENSHOT_DATA lines, a third less
+ * on the wire and no base64 on either side.
+ *
+ * Encoding: a control byte c, then for c < 0x80 c + 1 literal pixels, for
+ * c >= 0x80 one pixel repeated (c & 0x7F) + 1 times. Pixels are stored as
+ * in the frame buffer, little-endian RGB565 or B, G, R.
+ *
+ * screen_capture_write_bmp() writes the same copy as an uncompressed BMP for
+ * the diagnostics HTTP server, unrotated.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "lvgl.h"
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define SCREEN_CAPTURE_FRAMES 16         // Frames of dirty areas kept
+#define SCREEN_CAPTURE_AREAS_PER_FRAME 8 // Further areas are merged into the last one
+#define SCREEN_CAPTURE_CHUNK_BYTES 768   // Encoded bytes per SCREENSHOT_DATA line
+#define SCREEN_CAPTURE_LOCK_MS 1000      // Wait for the LVGL lock before giving up
+
+/** Receives the next part of a BMP, returns an error to stop */
+typedef esp_err_t (*screen_capture_write_fn_t)(void *ctx, const void *data, size_t len);
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Start recording the dirty areas of a display
+ * @param display Display created by lvgl_setup_init()
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG without a display,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_SCREEN_CAPTURE is off
+ */
+esp_err_t screen_capture_init(lv_display_t *display);
+
+/**
+ * @brief Whether a capture is being streamed
+ */
+bool screen_capture_is_running(void);
+
+/**
+ * @brief Capture the frame on screen and write it as a BMP on the calling task
+ * @param write Receives the header, then rows of pixels straight from the PSRAM copy
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a display or while another capture
+ *         runs, ESP_ERR_NO_MEM, ESP_ERR_TIMEOUT if LVGL stayed busy, the first error
+ *         from write, or ESP_ERR_NOT_SUPPORTED if CONFIG_SCREEN_CAPTURE is off
+ */
+esp_err_t screen_capture_write_bmp(screen_capture_write_fn_t write, void *ctx);
+
+/**
+ * @brief Handle SCREENSHOT [frames]
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a capture command
+ */
+bool screen_capture_handle_command(const char *line);
@@ -0,0 +1,315 @@
+/**
+ * @file serial_baud.c
+ * @brief Baud Rate Negotiation on the UART Link Implementation
+ *
+ * Rate changes run from one-shot esp_timers, never from the command: the
+ * reply to BAUD_TRY has to leave at the old rate, also when it goes out as
+ * the last frame of a mux request after the handler returned.
+ */
+
+#include "serial_baud.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial_data_handler.h"
+#include "serial_transport.h"
+#include "utils/event_bus.h"
+#include "utils/system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define BAUD_SWITCH_DELAY_MS 20   ///< From the BAUD_TRY reply to the rate change
+#define BAUD_CONFIRM_MS 1000      ///< From the rate change to the latest BAUD_COMMIT
+#define BAUD_MIN 9600             ///< Lowest rate a host may ask for
+#ifdef CONFIG_SERIAL_UART_MAX_BAUD
+#define BAUD_MAX CONFIG_SERIAL_UART_MAX_BAUD
+#else
+#define BAUD_MAX 3000000
+#endif
+
+typedef enum
+{
+  BAUD_STATE_IDLE,      ///< At the committed rate
+  BAUD_STATE_SWITCHING, ///< BAUD_TRY answered, the change is due
+  BAUD_STATE_TESTING,   ///< At the new rate, waiting for BAUD_TEST
+  BAUD_STATE_TESTED,    ///< Test passed, waiting for BAUD_COMMIT
+} baud_state_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static portMUX_TYPE baud_lock = portMUX_INITIALIZER_UNLOCKED;
+static baud_state_t baud_state = BAUD_STATE_IDLE;
+static uint32_t committed_baud = SERIAL_UART_DEFAULT_BAUD;
+static uint32_t trial_baud = 0;
+static uint32_t baud_commits = 0;
+static uint32_t baud_reverts = 0;
+
+static esp_timer_handle_t switch_timer = NULL;
+static esp_timer_handle_t confirm_timer = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static const char *state_name(baud_state_t state)
+{
+  static const char *const names[] = {"idle", "switching", "testing", "tested"};
+  return names[state];
+}
+
+/**
+ * @brief Go back to a rate and drop a trial in progress
+ */
+static void revert_to(uint32_t baud, const char *reason)
+{
+  esp_timer_stop(switch_timer);
+  esp_timer_stop(confirm_timer);
+
+  taskENTER_CRITICAL(&baud_lock);
+  bool trial = baud_state != BAUD_STATE_IDLE;
+  baud_state = BAUD_STATE_IDLE;
+  committed_baud = baud;
+  if (trial)
+    baud_reverts++;
+  taskEXIT_CRITICAL(&baud_lock);
+
+  if (serial_transport_uart_baud() != baud)
+  {
+    debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "Back to %lu baud: %s", (unsigned long)baud, reason);
+    serial_transport_uart_set_baud(baud);
+  }
+}
+
+static void switch_timer_cb(void *arg)
+{
+  (void)arg;
+  taskENTER_CRITICAL(&baud_lock);
+  uint32_t baud = baud_state == BAUD_STATE_SWITCHING ? trial_baud : 0;
+  if (baud)
+    baud_state = BAUD_STATE_TESTING;
+  taskEXIT_CRITICAL(&baud_lock);
+
+  if (baud && serial_transport_uart_set_baud(baud) == ESP_OK)
+    esp_timer_start_once(confirm_timer, (uint64_t)BAUD_CONFIRM_MS * 1000);
+  else if (baud)
+    revert_to(committed_baud, "rate not supported by the UART");
+}
+
+static void confirm_timer_cb(void *arg)
+{
+  (void)arg;
+  revert_to(committed_baud, "no BAUD_COMMIT");
+}
+
+/**
+ * @brief A new host starts at the default rate
+ */
+static void on_connection(const event_t *event, void *ctx)
+{
+  (void)ctx;
+  if (event->serial_connection.source_id == SERIAL_SOURCE_LOCAL && !event->serial_connection.connected)
+    revert_to(SERIAL_UART_DEFAULT_BAUD, "host went quiet");
+}
+
+static void reply(const char *buf, int len)
+{
+  serial_data_write(buf, len < 0 ? 0 : (size_t)len);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  reply(buf, snprintf(buf, sizeof(buf), "BAUD {\"error\":\"%s\"}\n", message));
+}
+
+static void handle_try(const char *args)
+{
+  unsigned long baud = 0;
+  if (sscanf(args, "%lu", &baud) != 1 || baud < BAUD_MIN || baud > BAUD_MAX)
+  {
+    char buf[96];
+    reply(buf, snprintf(buf, sizeof(buf), "BAUD {\"error\":\"rate %d..%d\"}\n", BAUD_MIN, BAUD_MAX));
+    return;
+  }
+
+  taskENTER_CRITICAL(&baud_lock);
+  bool busy = baud_state != BAUD_STATE_IDLE;
+  if (!busy)
+  {
+    baud_state = BAUD_STATE_SWITCHING;
+    trial_baud = baud;
+  }
+  taskEXIT_CRITICAL(&baud_lock);
+  if (busy)
+  {
+    reply_error("busy");
+    return;
+  }
+
+  char buf[96];
+  reply(buf, snprintf(buf, sizeof(buf), "BAUD {\"rate\":%lu,\"switch_ms\":%d,\"confirm_ms\":%d}\n", baud,
+                      BAUD_SWITCH_DELAY_MS, BAUD_CONFIRM_MS));
+  esp_timer_start_once(switch_timer, (uint64_t)BAUD_SWITCH_DELAY_MS * 1000);
+}
+
+static void handle_test(const char *args)
+{
+  unsigned long seed = 0;
+  char received[SERIAL_BAUD_TEST_LEN + 2];
+  char expected[SERIAL_BAUD_TEST_LEN + 1];
+  bool ok = sscanf(args, "%lu %129s", &seed, received) == 2;
+  if (ok)
+  {
+    serial_baud_pattern((uint32_t)seed, expected);
+    ok = strcmp(received, expected) == 0;
+  }
+
+  taskENTER_CRITICAL(&baud_lock);
+  bool testing = baud_state == BAUD_STATE_TESTING || baud_state == BAUD_STATE_TESTED;
+  if (testing)
+    baud_state = ok ? BAUD_STATE_TESTED : BAUD_STATE_TESTING;
+  taskEXIT_CRITICAL(&baud_lock);
+  if (!testing)
+  {
+    reply_error("no rate on trial");
+    return;
+  }
+
+  // The echo tests the other direction, the host commits only if it arrives intact
+  char buf[sizeof("BAUD_TEST {\"ok\":true,\"echo\":\"\"}\n") + SERIAL_BAUD_TEST_LEN];
+  int len;
+  if (ok)
+  {
+    serial_baud_pattern(~(uint32_t)seed, expected);
+    len = snprintf(buf, sizeof(buf), "BAUD_TEST {\"ok\":true,\"echo\":\"%s\"}\n", expected);
+  }
+  else
+  {
+    len = snprintf(buf, sizeof(buf), "BAUD_TEST {\"ok\":false}\n");
+  }
+  reply(buf, len);
+}
+
+static void handle_commit(void)
+{
+  taskENTER_CRITICAL(&baud_lock);
+  bool tested = baud_state == BAUD_STATE_TESTED;
+  uint32_t baud = trial_baud;
+  if (tested)
+  {
+    baud_state = BAUD_STATE_IDLE;
+    committed_baud = trial_baud;
+    baud_commits++;
+  }
+  taskEXIT_CRITICAL(&baud_lock);
+  if (!tested)
+  {
+    reply_error("no passed BAUD_TEST");
+    return;
+  }
+
+  esp_timer_stop(confirm_timer);
+  char buf[64];
+  reply(buf, snprintf(buf, sizeof(buf), "BAUD {\"rate\":%lu,\"committed\":true}\n", (unsigned long)baud));
+}
+
+static void send_status(void)
+{
+  taskENTER_CRITICAL(&baud_lock);
+  baud_state_t state = baud_state;
+  uint32_t committed = committed_baud;
+  uint32_t commits = baud_commits;
+  uint32_t reverts = baud_reverts;
+  taskEXIT_CRITICAL(&baud_lock);
+
+  char buf[224];
+  int len = snprintf(buf, sizeof(buf),
+                     "BAUD {\"rate\":%lu,\"committed\":%lu,\"default\":%d,\"max\":%d,\"state\":\"%s\","
+                     "\"flow_control\":%s,\"commits\":%lu,\"reverts\":%lu}\n",
+                     (unsigned long)serial_transport_uart_baud(), (unsigned long)committed, SERIAL_UART_DEFAULT_BAUD,
+                     BAUD_MAX, state_name(state), serial_transport_uart_flow_control() ? "true" : "false",
+                     (unsigned long)commits, (unsigned long)reverts);
+  reply(buf, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t serial_baud_init(void)
+{
+  if (serial_data_get_transport() != SERIAL_TRANSPORT_UART)
+    return ESP_ERR_NOT_SUPPORTED;
+  if (switch_timer)
+    return ESP_OK;
+
+  const esp_timer_create_args_t switch_args = {
+      .callback = switch_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "baud_switch",
+  };
+  const esp_timer_create_args_t confirm_args = {
+      .callback = confirm_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "baud_confirm",
+  };
+  if (esp_timer_create(&switch_args, &switch_timer) != ESP_OK)
+    return ESP_ERR_NO_MEM;
+  if (esp_timer_create(&confirm_args, &confirm_timer) != ESP_OK)
+  {
+    esp_timer_delete(switch_timer);
+    switch_timer = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  return event_bus_subscribe(EVENT_TOPIC_SERIAL_CONNECTION, on_connection, NULL, NULL);
+}
+
+void serial_baud_pattern(uint32_t seed, char *out)
+{
+  // xorshift32, the host tool runs the same
+  uint32_t x = seed ? seed : 0x9E3779B9u;
+  for (int i = 0; i < SERIAL_BAUD_TEST_LEN; i++)
+  {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    char c = (char)(0x21 + x % 94);
+    out[i] = (c == '"' || c == '\\') ? c + 1 : c;
+  }
+  out[SERIAL_BAUD_TEST_LEN] = '\0';
+}
+
+bool serial_baud_handle_command(const char *line)
+{
+  static const char try_command[] = "BAUD_TRY ";
+  static const char test_command[] = "BAUD_TEST ";
+  bool status = strcmp(line, "GET_BAUD") == 0;
+  bool commit = strcmp(line, "BAUD_COMMIT") == 0;
+  bool trial = strncmp(line, try_command, sizeof(try_command) - 1) == 0;
+  bool test = strncmp(line, test_command, sizeof(test_command) - 1) == 0;
+  if (!status && !commit && !trial && !test)
+    return false;
+
+  if (!switch_timer)
+  {
+    reply_error("baud rate only on the UART link");
+    return true;
+  }
+
+  if (status)
+    send_status();
+  else if (commit)
+    handle_commit();
+  else if (trial)
+    handle_try(line + sizeof(try_command) - 1);
+  else
+    handle_test(line + sizeof(test_command) - 1);
+  return true;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file serial_baud.h
+ * @brief Baud Rate Negotiation on the UART Link
+ *
+ * The UART starts at SERIAL_UART_DEFAULT_BAUD, which any host can open. A
+ * host that wants more steps the link up one rate at a time and tests each
+ * step in both directions before keeping it, so a USB bridge or cable that
+ * cannot carry a rate only costs that attempt:
+ *
+ *   BAUD_TRY <rate>              at the old rate, replies
+ *     BAUD {"rate":R,"switch_ms":20,"confirm_ms":1000}
+ *                                and the UART changes after switch_ms
+ *   BAUD_TEST <seed> <pattern>   at the new rate, pattern is the 128 characters
+ *                                serial_baud_pattern(seed) makes, replies
+ *     BAUD_TEST {"ok":true,"echo":"<serial_baud_pattern(~seed)>"}
+ *   BAUD_COMMIT                  after the echo matched, replies
+ *     BAUD {"rate":R,"committed":true}
+ *
+ * Without a commit within confirm_ms of the change the UART returns to the
+ * last committed rate, where the host finds it again. Once the local source
+ * disconnects (SERIAL_SOURCE_TIMEOUT_MS without data) it returns to
+ * SERIAL_UART_DEFAULT_BAUD for the next host. GET_BAUD reports the rates,
+ * flow control and how often a step was reverted. main/utils/serial_link.py
+ * --baud-up negotiates 921600, 2000000 and 3000000 in turn.
+ *
+ * Only the UART transport has a rate, on USB CDC the commands reply an error.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// =======================================================================
+// CONSTANTS
+// =======================================================================
+
+#define SERIAL_BAUD_TEST_LEN 128 ///< Characters of the link test pattern
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create the timers and follow the local source's connection
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED unless the link is the UART, or ESP_ERR_NO_MEM
+ * @note Call after serial_data_init()
+ */
+esp_err_t serial_baud_init(void);
+
+/**
+ * @brief Link test pattern of a seed: printable ASCII without quote and backslash
+ * @param seed Seed sent by the host
+ * @param out Receives SERIAL_BAUD_TEST_LEN characters and a terminator
+ */
+void serial_baud_pattern(uint32_t seed, char *out);
+
+/**
+ * @brief Handle BAUD_TRY, BAUD_TEST, BAUD_COMMIT and GET_BAUD
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a baud command
+ */
+bool serial_baud_handle_command(const char *line);
@@ -2,8 +2,8 @@
  * @file serial_data_handler.c
  * @brief Serial Data Handler Implementation for System Monitor Dashboard
  *
- * Provides UART communication and JSON parsing functionality for real-time
- * system monitoring data. Handles connection timeout detection and data
+ * Provides JSON parsing and binary frame decoding for real-time system
+ * monitoring data received over a UART or USB CDC transport. Handles connection timeout detection and data
  * validation for reliable operation.
  *      }
 
@@ -18,50 +18,132 @@
 
 #include "serial_data_handler.h"
 
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include "cjson.h"
-#include "driver/uart.h"
+#include "esp_attr.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "serial_mux.h"
+#include "serial_transport.h"
+#include "telemetry_clock.h"
+#include "telemetry_frame.h"
+#include "telemetry_json.h"
+#include "telemetry_rate.h"
 #include "utils/system_debug_utils.h"
 #include "utils/crash_handler.h"
+#include "utils/cycle_prof.h"
+#include "utils/event_bus.h"
+#include "utils/metrics.h"
+#include "utils/shared_state.h"
+#include "utils/task_plan.h"
+#include "utils/trace_spans.h"
 
 // =======================================================================
 // CONSTANTS AND CONFIGURATION
 // =======================================================================
 
-// UART Hardware Configuration
-#define UART_PORT_NUM UART_NUM_0                ///< UART port number
-#define UART_BAUD_RATE 115200                   ///< Communication baud rate
-#define UART_DATA_BITS UART_DATA_8_BITS         ///< Data bits per frame
-#define UART_PARITY UART_PARITY_DISABLE         ///< Parity checking
-#define UART_STOP_BITS UART_STOP_BITS_1         ///< Stop bits per frame
-#define UART_FLOW_CTRL UART_HW_FLOWCTRL_DISABLE ///< Flow control
-#define UART_SOURCE_CLK UART_SCLK_DEFAULT       ///< Clock source
-
 // Buffer Management
-#define BUF_SIZE 2048         ///< UART receive buffer size
 #define JSON_BUFFER_SIZE 1024 ///< JSON parsing buffer size
+#define READ_CHUNK_SIZE 128   ///< Bytes taken from the transport per read
+#define READ_IN_PLACE_MIN 32  ///< Smallest buffer tail worth receiving into directly
+
+// Source Tracking
+#define SERIAL_SOURCE_TIMEOUT_MS 5000 ///< A source is connected if data arrived within this window
+#define SERIAL_RATE_WINDOW_MS 1000    ///< Shortest span the link rates are computed over
+
+// Link statistics (STATS command)
+#define STATS_LATENCY_EWMA_SHIFT 3 ///< Moving average weight 1/8
+#define STATS_REPLY_SIZE 2048      ///< Fits CONFIG_SERIAL_MAX_SOURCES at full counter width
+#define STATS_HOST_EPOCH_MIN_MS 1000000000000ULL ///< Host stamps are Unix ms, the unset device clock is far below
 
-// Task Configuration
-#define SERIAL_TASK_STACK_SIZE 12288 ///< Task stack size in bytes (increased for JSON parsing)
-#define SERIAL_TASK_PRIORITY 2       ///< FreeRTOS task priority (lowered for LVGL priority)
+// Parser benchmark (BENCH_JSON_PARSER command)
+#define PARSER_BENCH_ITERATIONS 500 ///< Parses per parser and run
 
 // =======================================================================
 // STATIC VARIABLES
 // =======================================================================
 
-static TaskHandle_t serial_task_handle = NULL;           ///< Serial reception task handle
-static TaskHandle_t connection_check_task_handle = NULL; ///< Connection check task handle
-static bool serial_running = false;                      ///< Task running state flag
-static uint32_t last_data_time = 0;                      ///< Last data reception timestamp
+static TaskHandle_t serial_task_handle = NULL;     ///< Serial reception task handle
+static bool serial_running = false;                ///< Task running state flag, shared_state.h access
+static const serial_transport_t *transport = NULL; ///< Active byte transport
+static serial_transport_type_t transport_type;     ///< Type of the active transport
+
+/**
+ * @brief Receive state and latest telemetry of one host
+ */
+typedef struct
+{
+  bool in_use;
+  char name[SERIAL_SOURCE_NAME_LEN];
+  system_data_t data; ///< Merged current state, written by the feeding task only
+  seqlock_t data_seq; ///< Guards data for readers in other tasks
+  bool connected;     ///< Last reported connection state, shared_state.h access
+
+  // Text line reassembly
+  char line_buffer[JSON_BUFFER_SIZE];
+  int line_pos;
+
+  // Binary frame reassembly (frames are 0x00 delimited, see telemetry_frame.h)
+  uint8_t frame_buffer[TELEMETRY_FRAME_MAX_ENCODED]; ///< Encoded bytes of the current frame
+  size_t frame_pos;                                  ///< Bytes collected in frame_buffer
+  bool in_binary_frame;                              ///< True between the opening and closing delimiter
+  bool awaiting_keyframe;                            ///< Deltas are dropped until a keyframe arrives
+
+  // Link statistics
+  serial_link_stats_t stats;
+  uint32_t rate_bytes_mark;   ///< stats.bytes at the last rate update
+  uint32_t rate_samples_mark; ///< stats.samples at the last rate update
+  uint32_t rate_time_ms;      ///< Time of the last rate update
+  int64_t last_sample_us;     ///< Dispatch time of the previous sample
+  int64_t last_interval_us;   ///< Interval before the previous sample
+  int64_t min_offset_ms;      ///< Smallest dispatch minus host timestamp seen
+  bool have_offset;
+} telemetry_source_t;
+
+static const uint16_t jitter_bucket_ms[SERIAL_JITTER_BUCKETS - 1] = {1, 2, 5, 10, 20, 50, 100};
+
+// Line and frame buffers make this several KB, PSRAM when the BSS may go there
+static EXT_RAM_BSS_ATTR telemetry_source_t sources[CONFIG_SERIAL_MAX_SOURCES]; ///< Source-keyed state table
+static portMUX_TYPE sources_lock = portMUX_INITIALIZER_UNLOCKED; ///< Guards registration and link statistics copies
+
+// One-shot per source, re-armed by every line or frame; expiry means the source went quiet.
+// Kept apart from sources[] so registering a source can clear its slot
+static esp_timer_handle_t stale_timers[CONFIG_SERIAL_MAX_SOURCES];
+static SemaphoreHandle_t connection_mutex = NULL; ///< Orders connection events of the feeding and timer tasks
+static StaticSemaphore_t connection_mutex_buffer;
+
+static serial_command_callback_t command_callback = NULL; ///< Host command callback
+
+CYCLE_PROF_SITE(handle_incoming_block);
+CYCLE_PROF_SITE(parse_telemetry_json);
+
+// Local link counters in the metrics registry, arg is the field offset in serial_link_stats_t
+static int64_t read_local_link_stat(const metric_t *metric)
+{
+  serial_link_stats_t stats;
+  if (serial_data_get_link_stats(SERIAL_SOURCE_LOCAL, &stats) != ESP_OK)
+    return 0;
+  return *(const uint32_t *)((const uint8_t *)&stats + metric->arg);
+}
+
+#define LINK_SERIES(name, help, field) \
+  METRIC_READ_INIT(METRIC_TYPE_COUNTER, name, help, NULL, read_local_link_stat, offsetof(serial_link_stats_t, field))
 
-// Callback function pointers
-static serial_connection_callback_t connection_callback = NULL; ///< Connection status callback
-static serial_data_callback_t data_callback = NULL;             ///< Data update callback
+static metric_t link_metrics[] = {
+    LINK_SERIES("serial_bytes_total", "Bytes received on the local link", bytes),
+    LINK_SERIES("serial_samples_total", "Telemetry samples delivered", samples),
+    LINK_SERIES("serial_parse_failures_total", "JSON lines that did not parse", parse_failures),
+    LINK_SERIES("serial_frame_errors_total", "Binary frames that failed to decode", frame_errors),
+    LINK_SERIES("serial_crc_errors_total", "Binary frames with a CRC mismatch", crc_errors),
+    LINK_SERIES("serial_rx_overruns_total", "Transport input lost", rx_overruns),
+};
 
 // =======================================================================
 // PRIVATE FUNCTION PROTOTYPES
@@ -70,49 +152,94 @@ static serial_data_callback_t data_callback = NULL;             ///< Data update
 /**
  * @brief Parse JSON string and extract system monitoring data
  * @param json_str Input JSON string to parse
+ * @param json_len Length of json_str without the terminator
  * @param data Output system data structure
  * @return true if parsing successful, false otherwise
  */
-static bool parse_json_data(const char *json_str, system_data_t *data);
+static bool parse_json_data(const char *json_str, size_t json_len, system_data_t *data);
+
+/**
+ * @brief Parse a telemetry JSON line with the configured parser
+ * @param json_str Input JSON string to parse
+ * @param json_len Length of json_str without the terminator
+ * @param data Output system data structure
+ * @return true if parsing successful, false otherwise
+ */
+static bool parse_telemetry_json(const char *json_str, size_t json_len, system_data_t *data);
+
+/**
+ * @brief Time the streaming parser against cJSON and report to the host
+ */
+static void run_parser_benchmark(void);
 
 /**
  * @brief Process a complete line of received data
- * @param line_buffer The line buffer containing the data
- * @param system_data System data structure to update
+ * @param src Source the line came from
  */
-static void process_received_line(const char *line_buffer, system_data_t *system_data);
+static void process_received_line(telemetry_source_t *src, size_t len);
 
 /**
- * @brief Add a byte to the line buffer and handle line completion
- * @param byte The byte to add
- * @param line_buffer The line buffer
- * @param line_pos Pointer to the current line position
- * @param system_data System data structure to update
- * @return true if a complete line was processed, false otherwise
+ * @brief Process a complete binary telemetry frame
+ * @param src Source the frame came from
  */
-static bool handle_incoming_byte(uint8_t byte, char *line_buffer, int *line_pos, system_data_t *system_data);
+static void process_received_frame(telemetry_source_t *src);
 
 /**
- * @brief Trigger a connection check (non-blocking)
+ * @brief Merge a new sample into a source and notify subscribers
+ * @param src Source to update
+ * @param next Merged new state
  */
-static void trigger_connection_check(void);
+static void publish_sample(telemetry_source_t *src, const system_data_t *next);
 
 /**
- * @brief Process crash test commands
- * @param command The command string to process
+ * @brief Add received bytes to the source's line or frame buffer and handle completions
+ * @param src Source the bytes came from
+ * @param bytes Received bytes
+ * @param len Number of bytes
  */
-static void process_crash_test_command(const char *command);
+static void handle_incoming_block(telemetry_source_t *src, const uint8_t *bytes, size_t len);
 
 /**
- * @brief Connection check task that runs independently
- * @param pvParameters Task parameters (unused)
+ * @brief Drop any partially received line or frame of a source
+ * @param src Source to resynchronise
  */
-static void connection_check_task(void *pvParameters);
+static void reset_source_parser(telemetry_source_t *src);
+
+/**
+ * @brief Free tail of the line or frame buffer the next bytes will go to
+ * @param src Source being assembled
+ * @param room Output bytes available at the returned address
+ * @return Address to receive into
+ */
+static uint8_t *receive_window(telemetry_source_t *src, size_t *room);
+
+/**
+ * @brief Update jitter and latency statistics for a dispatched sample
+ * @param src Source that produced the sample
+ */
+static void record_sample_timing(telemetry_source_t *src);
+
+/**
+ * @brief Reply to the STATS command with the statistics of every source
+ */
+static void send_link_stats(void);
+
+/**
+ * @brief Note a complete line or frame: re-arm the staleness timer, report a reconnect
+ * @param src Source the data came from
+ */
+static void source_alive(telemetry_source_t *src);
+
+/**
+ * @brief Process crash test commands
+ * @param command The command string to process
+ */
+static void process_crash_test_command(const char *command);
 
 // =======================================================================
 // PRIVATE FUNCTION IMPLEMENTATIONS
 // =======================================================================
-static bool parse_json_data(const char *json_str, system_data_t *data)
+static bool parse_json_data(const char *json_str, size_t json_len, system_data_t *data)
 {
   // Add safety checks to prevent crashes on malformed input
   if (json_str == NULL || data == NULL)
@@ -121,126 +248,59 @@ static bool parse_json_data(const char *json_str, system_data_t *data)
   }
 
   // Check JSON length to prevent memory issues
-  size_t json_len = strlen(json_str);
   if (json_len == 0 || json_len > JSON_BUFFER_SIZE - 1)
   {
     debug_log_warning(DEBUG_TAG_SERIAL_DATA, "JSON length invalid");
     return false;
   }
 
-  cJSON *json = cJSON_Parse(json_str);
-  if (json == NULL)
-  {
-    // Only log JSON errors when debug enabled - too verbose otherwise
-    return false;
-  }
-
-  // -----------------------------------------------------------------------
-  // Parse Timestamp
-  // -----------------------------------------------------------------------
-
-  cJSON *ts = cJSON_GetObjectItem(json, "ts");
-  if (cJSON_IsNumber(ts))
-  {
-    data->timestamp = (uint64_t)cJSON_GetNumberValue(ts);
-  }
-  else
-  {
-    data->timestamp = (uint64_t)time(NULL) * 1000; // Current time in ms
-  }
+  // Only log JSON errors when debug enabled - too verbose otherwise
+  return telemetry_json_parse_cjson(json_str, json_len, data);
+}
 
-  // Parse CPU data
-  cJSON *cpu = cJSON_GetObjectItem(json, "cpu");
-  if (cJSON_IsObject(cpu))
+static bool parse_telemetry_json(const char *json_str, size_t json_len, system_data_t *data)
+{
+#if CONFIG_SERIAL_JSON_STREAMING_PARSER
+  if (json_len == 0 || json_len > JSON_BUFFER_SIZE - 1)
   {
-    cJSON *cpu_usage = cJSON_GetObjectItem(cpu, "usage");
-    cJSON *cpu_temp = cJSON_GetObjectItem(cpu, "temp");
-    cJSON *cpu_fan = cJSON_GetObjectItem(cpu, "fan");
-    cJSON *cpu_name = cJSON_GetObjectItem(cpu, "name");
-
-    if (cJSON_IsNumber(cpu_usage))
-    {
-      data->cpu.usage = (uint8_t)cJSON_GetNumberValue(cpu_usage);
-    }
-    if (cJSON_IsNumber(cpu_temp))
-    {
-      data->cpu.temp = (uint8_t)cJSON_GetNumberValue(cpu_temp);
-    }
-    if (cJSON_IsNumber(cpu_fan))
-    {
-      data->cpu.fan = (uint16_t)cJSON_GetNumberValue(cpu_fan);
-    }
-    if (cJSON_IsString(cpu_name))
-    {
-      strncpy(data->cpu.name, cJSON_GetStringValue(cpu_name),
-              sizeof(data->cpu.name) - 1);
-      data->cpu.name[sizeof(data->cpu.name) - 1] = '\0';
-    }
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "JSON length invalid");
+    return false;
   }
+  return telemetry_json_parse(json_str, json_len, data);
+#else
+  return parse_json_data(json_str, json_len, data);
+#endif
+}
 
-  // Parse GPU data
-  cJSON *gpu = cJSON_GetObjectItem(json, "gpu");
-  if (cJSON_IsObject(gpu))
+static void run_parser_benchmark(void)
+{
+  static const char sample[] =
+      "{\"ts\":1712345678901,"
+      "\"cpu\":{\"usage\":42,\"temp\":61,\"fan\":1200,\"name\":\"Intel Core i9-13900K\"},"
+      "\"gpu\":{\"usage\":37,\"temp\":55,\"name\":\"NVIDIA GeForce RTX 4080\",\"mem_used\":4096,\"mem_total\":16384},"
+      "\"mem\":{\"usage\":48,\"used\":15.4,\"total\":31.9,\"avail\":16.5}}";
+  static system_data_t bench_data;
+
+  int64_t start = esp_timer_get_time();
+  for (int i = 0; i < PARSER_BENCH_ITERATIONS; i++)
   {
-    cJSON *gpu_usage = cJSON_GetObjectItem(gpu, "usage");
-    cJSON *gpu_temp = cJSON_GetObjectItem(gpu, "temp");
-    cJSON *gpu_name = cJSON_GetObjectItem(gpu, "name");
-    cJSON *gpu_mem_used = cJSON_GetObjectItem(gpu, "mem_used");
-    cJSON *gpu_mem_total = cJSON_GetObjectItem(gpu, "mem_total");
-
-    if (cJSON_IsNumber(gpu_usage))
-    {
-      data->gpu.usage = (uint8_t)cJSON_GetNumberValue(gpu_usage);
-    }
-    if (cJSON_IsNumber(gpu_temp))
-    {
-      data->gpu.temp = (uint8_t)cJSON_GetNumberValue(gpu_temp);
-    }
-    if (cJSON_IsString(gpu_name))
-    {
-      strncpy(data->gpu.name, cJSON_GetStringValue(gpu_name),
-              sizeof(data->gpu.name) - 1);
-      data->gpu.name[sizeof(data->gpu.name) - 1] = '\0';
-    }
-    if (cJSON_IsNumber(gpu_mem_used))
-    {
-      data->gpu.mem_used = (uint32_t)cJSON_GetNumberValue(gpu_mem_used);
-    }
-    if (cJSON_IsNumber(gpu_mem_total))
-    {
-      data->gpu.mem_total = (uint32_t)cJSON_GetNumberValue(gpu_mem_total);
-    }
+    telemetry_json_parse(sample, sizeof(sample) - 1, &bench_data);
   }
+  int64_t streaming_us = esp_timer_get_time() - start;
 
-  // Parse memory data
-  cJSON *mem = cJSON_GetObjectItem(json, "mem");
-  if (cJSON_IsObject(mem))
+  start = esp_timer_get_time();
+  for (int i = 0; i < PARSER_BENCH_ITERATIONS; i++)
   {
-    cJSON *mem_usage = cJSON_GetObjectItem(mem, "usage");
-    cJSON *mem_used = cJSON_GetObjectItem(mem, "used");
-    cJSON *mem_total = cJSON_GetObjectItem(mem, "total");
-    cJSON *mem_avail = cJSON_GetObjectItem(mem, "avail");
-
-    if (cJSON_IsNumber(mem_usage))
-    {
-      data->mem.usage = (uint8_t)cJSON_GetNumberValue(mem_usage);
-    }
-    if (cJSON_IsNumber(mem_used))
-    {
-      data->mem.used = (float)cJSON_GetNumberValue(mem_used);
-    }
-    if (cJSON_IsNumber(mem_total))
-    {
-      data->mem.total = (float)cJSON_GetNumberValue(mem_total);
-    }
-    if (cJSON_IsNumber(mem_avail))
-    {
-      data->mem.avail = (float)cJSON_GetNumberValue(mem_avail);
-    }
+    parse_json_data(sample, sizeof(sample) - 1, &bench_data);
   }
-
-  cJSON_Delete(json);
-  return true;
+  int64_t cjson_us = esp_timer_get_time() - start;
+
+  char reply[160];
+  int len = snprintf(reply, sizeof(reply),
+                     "PARSER_BENCH {\"iterations\":%d,\"bytes\":%u,\"streaming_ns\":%lld,\"cjson_ns\":%lld}\n",
+                     PARSER_BENCH_ITERATIONS, (unsigned)(sizeof(sample) - 1),
+                     streaming_us * 1000 / PARSER_BENCH_ITERATIONS, cjson_us * 1000 / PARSER_BENCH_ITERATIONS);
+  serial_data_write(reply, len < (int)sizeof(reply) ? len : sizeof(reply) - 1);
 }
 
 /**
@@ -252,9 +312,11 @@ static void process_crash_test_command(const char *command)
   debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Processing crash test command: %s", command);
 
   // Acknowledge the command
-  printf("ACK: %s\n", command);
+  char ack[64];
+  int ack_len = snprintf(ack, sizeof(ack), "ACK: %s\n", command);
+  serial_data_write(ack, ack_len < (int)sizeof(ack) ? ack_len : sizeof(ack) - 1);
 
-  // Add a small delay for acknowledgment to be transmitted
+  // Give the acknowledgment time to leave; this runs on the mux request task, not the receive loop
   vTaskDelay(pdMS_TO_TICKS(100));
 
   // Trigger the appropriate crash based on command
@@ -295,35 +357,98 @@ static void process_crash_test_command(const char *command)
   }
 }
 
+/**
+ * @brief Run a command of the local host, from a text line or a mux request
+ * @return false if the command is unknown
+ */
+static bool dispatch_command(const char *command)
+{
+  if (strncmp(command, "TEST_CRASH_", 11) == 0)
+  {
+    process_crash_test_command(command);
+    return true;
+  }
+
+  if (strcmp(command, "BENCH_JSON_PARSER") == 0)
+  {
+    run_parser_benchmark();
+    return true;
+  }
+
+  if (strcmp(command, "STATS") == 0)
+  {
+    send_link_stats();
+    return true;
+  }
+
+  if (strcmp(command, "STATS_RESET") == 0)
+  {
+    for (uint8_t id = 0; id < CONFIG_SERIAL_MAX_SOURCES; id++)
+    {
+      serial_data_reset_link_stats(id);
+    }
+    serial_data_write("STATS_RESET OK\n", 15);
+    return true;
+  }
+
+  // Anything else is a host command (e.g. GET_DISPLAY_METRICS)
+  return command_callback && command_callback(command);
+}
+
+static int transport_write(const uint8_t *data, size_t len)
+{
+  return transport ? transport->write(data, len) : -1;
+}
+
 /**
  * @brief Process a complete line of received data
  */
-static void process_received_line(const char *line_buffer, system_data_t *system_data)
+static void process_received_line(telemetry_source_t *src, size_t len)
 {
+  const char *line_buffer = src->line_buffer;
+  bool is_local = (src == &sources[SERIAL_SOURCE_LOCAL]);
+
   // Skip empty lines
-  if (strlen(line_buffer) < 3)
+  if (len < 3)
     return;
 
-  // Check if this is a crash test command
-  if (strncmp(line_buffer, "TEST_CRASH_", 11) == 0)
+  // Crash tests wait for their acknowledgment to go out, not on the receive loop
+  if (is_local && strncmp(line_buffer, "TEST_CRASH_", 11) == 0)
   {
-    process_crash_test_command(line_buffer);
+    if (serial_mux_run_command(line_buffer) != ESP_OK)
+      process_crash_test_command(line_buffer);
     return;
   }
 
-  // Skip lines that are too short for JSON
-  if (strlen(line_buffer) < 5)
-    return;
-
   // Check if this looks like JSON data (starts with { and ends with })
   const char *trimmed = line_buffer;
   while (*trimmed == ' ' || *trimmed == '\t')
     trimmed++; // Skip whitespace
+  len -= (size_t)(trimmed - line_buffer);
+
+  // Only the local link may issue commands, remote sources just deliver telemetry
+  if (!is_local && trimmed[0] != '{')
+    return;
+
+  if (is_local && telemetry_clock_handle_reply(trimmed))
+    return;
+
+  if (trimmed[0] != '{')
+  {
+    if (!dispatch_command(trimmed))
+    {
+      debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Unknown command: %.32s", trimmed);
+    }
+    return;
+  }
+
+  // Skip lines that are too short for JSON
+  if (len < 5)
+    return;
 
   if (trimmed[0] == '{')
   {
     // Find the end of JSON
-    size_t len = strlen(trimmed);
     const char *end = trimmed + len - 1;
     while (end > trimmed && (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r'))
       end--;
@@ -331,136 +456,489 @@ static void process_received_line(const char *line_buffer, system_data_t *system
     if (*end == '}')
     {
       // Parse and update UI with safety measures
-      if (parse_json_data(trimmed, system_data))
+      system_data_t next = src->data;
+      CYCLE_PROF_BEGIN(parse_telemetry_json);
+      bool parsed = parse_telemetry_json(trimmed, len, &next);
+      CYCLE_PROF_END(parse_telemetry_json);
+      if (parsed)
       {
         // Add small delay to prevent watchdog issues during first parse
         vTaskDelay(pdMS_TO_TICKS(1));
 
-        // Call data callback if registered
-        if (data_callback)
-        {
-          data_callback(system_data);
-        }
-        else
-        {
-          debug_log_warning(DEBUG_TAG_SERIAL_DATA, "No data callback registered");
-        }
+        publish_sample(src, &next);
       }
       else
       {
+        src->stats.parse_failures++;
         debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Failed to parse JSON data");
       }
     }
     else
     {
+      src->stats.parse_failures++;
       debug_log_debug(DEBUG_TAG_SERIAL_DATA, "Invalid JSON format - missing closing brace");
     }
 
-    trigger_connection_check();
+    source_alive(src);
   }
 }
 
 /**
- * @brief Add a byte to the line buffer and handle line completion
+ * @brief Process a complete binary telemetry frame
  */
-static bool handle_incoming_byte(uint8_t byte, char *line_buffer, int *line_pos, system_data_t *system_data)
+static void process_received_frame(telemetry_source_t *src)
 {
-  // Check for end of line
-  if (byte == '\n' || byte == '\r')
+  system_data_t next = src->data;
+  uint8_t msg_type = 0;
+  esp_err_t ret = ESP_ERR_NOT_FOUND;
+  src->stats.frames++;
+
+  // Commands come in mux frames on the local link only
+  if (src == &sources[SERIAL_SOURCE_LOCAL])
+    ret = serial_mux_handle_frame(src->frame_buffer, src->frame_pos);
+  if (ret == ESP_OK)
   {
-    // Process line if we have data
-    if (*line_pos > 0)
-    {
-      line_buffer[*line_pos] = '\0';
-      debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Processing line (%d chars): %.50s%s",
-                        *line_pos, line_buffer, (*line_pos > 50) ? "..." : "");
-      process_received_line(line_buffer, system_data);
-      *line_pos = 0; // Reset for next line
-      return true;
-    }
+    source_alive(src);
+    return;
   }
-  else if (byte >= 32 && byte <= 126) // Only accept printable ASCII characters
+  if (ret == ESP_ERR_NOT_FOUND)
+    ret = telemetry_frame_decode(src->frame_buffer, src->frame_pos, &next, &msg_type);
+  if (ret != ESP_OK)
   {
-    if (*line_pos < JSON_BUFFER_SIZE - 1)
-    {
-      // Add character to line buffer
-      line_buffer[(*line_pos)++] = byte;
-    }
+    if (ret == ESP_ERR_INVALID_CRC)
+      src->stats.crc_errors++;
     else
+      src->stats.frame_errors++;
+
+    debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "Dropped binary frame from %s (%u bytes): %s",
+                        src->name, (unsigned)src->frame_pos, esp_err_to_name(ret));
+    // A lost delta would leave stale fields behind, wait for a full set
+    src->awaiting_keyframe = true;
+    return;
+  }
+
+  if (msg_type == TELEMETRY_MSG_KEYFRAME)
+  {
+    src->awaiting_keyframe = false;
+  }
+  else if (src->awaiting_keyframe)
+  {
+    src->stats.deltas_dropped++;
+    debug_log_debug(DEBUG_TAG_SERIAL_DATA, "Delta frame ignored until next keyframe");
+    source_alive(src);
+    return;
+  }
+
+  publish_sample(src, &next);
+  source_alive(src);
+}
+
+/**
+ * @brief Merge a new sample into a source and notify subscribers
+ */
+static void publish_sample(telemetry_source_t *src, const system_data_t *next)
+{
+  uint8_t source_id = (uint8_t)(src - sources);
+  uint32_t changed = telemetry_frame_diff(&src->data, next);
+
+  seqlock_write_begin(&src->data_seq);
+  src->data = *next;
+  seqlock_write_end(&src->data_seq);
+
+  src->stats.samples++;
+  record_sample_timing(src);
+
+  // Inline subscribers run in the feeding task, the only writer, so the pointer is stable for the call.
+  // Queued subscribers get a copy; anything else reads through serial_data_get_source_data()
+  event_t event = {.topic = EVENT_TOPIC_TELEMETRY,
+                   .telemetry = {.source_id = source_id, .changed_fields = changed, .data = &src->data}};
+  event_bus_publish(&event);
+}
+
+/**
+ * @brief Update jitter and latency statistics for a dispatched sample
+ */
+static void record_sample_timing(telemetry_source_t *src)
+{
+  serial_link_stats_t *stats = &src->stats;
+  int64_t now_us = esp_timer_get_time();
+
+  if (src->last_sample_us > 0)
+  {
+    int64_t interval_us = now_us - src->last_sample_us;
+    if (src->last_interval_us > 0)
     {
-      debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Line buffer overflow, resetting");
-      *line_pos = 0;
+      int64_t deviation_us = interval_us - src->last_interval_us;
+      uint32_t deviation_ms = (uint32_t)((deviation_us < 0 ? -deviation_us : deviation_us) / 1000);
+      int bucket = 0;
+      while (bucket < SERIAL_JITTER_BUCKETS - 1 && deviation_ms >= jitter_bucket_ms[bucket])
+        bucket++;
+      stats->jitter_hist[bucket]++;
     }
+    src->last_interval_us = interval_us;
+  }
+  src->last_sample_us = now_us;
+
+  // Samples without a host timestamp carry the device clock, skip those
+  if (src->data.timestamp < STATS_HOST_EPOCH_MIN_MS)
+    return;
+
+  int64_t offset_ms = now_us / 1000 - (int64_t)src->data.timestamp;
+  if (!src->have_offset || offset_ms < src->min_offset_ms)
+  {
+    src->min_offset_ms = offset_ms;
+    src->have_offset = true;
+  }
+
+  uint32_t latency_ms = (uint32_t)(offset_ms - src->min_offset_ms);
+
+  // With the host clock known the latency is measured, not relative
+  uint64_t host_now_ms;
+  bool synced = src == &sources[SERIAL_SOURCE_LOCAL] && telemetry_clock_host_time_ms(now_us, &host_now_ms);
+  if (synced)
+  {
+    latency_ms = host_now_ms > src->data.timestamp ? (uint32_t)(host_now_ms - src->data.timestamp) : 0;
+  }
+  if (synced != stats->latency_synced)
+  {
+    stats->latency_synced = synced;
+    stats->latency_avg_ms = 0;
+    stats->latency_max_ms = 0;
   }
-  // Ignore other control characters without logging
 
-  return false;
+  stats->latency_last_ms = latency_ms;
+  if (latency_ms > stats->latency_max_ms)
+    stats->latency_max_ms = latency_ms;
+  if (stats->latency_avg_ms == 0)
+    stats->latency_avg_ms = latency_ms;
+  else
+    stats->latency_avg_ms += ((int32_t)latency_ms - (int32_t)stats->latency_avg_ms) >> STATS_LATENCY_EWMA_SHIFT;
 }
 
-// Static variable to track last check time
-static uint32_t last_check_time = 0;
+/**
+ * @brief Reply to the STATS command with the statistics of every source
+ */
+static void send_link_stats(void)
+{
+  static char reply[STATS_REPLY_SIZE];
+  size_t len = snprintf(reply, sizeof(reply), "STATS {\"sources\":[");
 
-// Static variable to track last connection status
-static bool last_connection_status = false;
+  bool first = true;
+  for (uint8_t id = 0; id < CONFIG_SERIAL_MAX_SOURCES && len < sizeof(reply); id++)
+  {
+    serial_link_stats_t s;
+    if (serial_data_get_link_stats(id, &s) != ESP_OK)
+      continue;
+
+    len += snprintf(reply + len, sizeof(reply) - len,
+                    "%s{\"id\":%u,\"name\":\"%s\",\"connected\":%s,"
+                    "\"bytes\":%lu,\"lines\":%lu,\"frames\":%lu,\"samples\":%lu,"
+                    "\"parse_failures\":%lu,\"line_overflows\":%lu,\"frame_errors\":%lu,"
+                    "\"crc_errors\":%lu,\"deltas_dropped\":%lu,\"rx_overruns\":%lu,"
+                    "\"bytes_per_sec\":%lu,\"samples_per_sec\":%lu,"
+                    "\"jitter_ms\":[%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu],"
+                    "\"latency_ms\":{\"last\":%lu,\"avg\":%lu,\"max\":%lu,\"synced\":%s}}",
+                    first ? "" : ",", id, serial_data_get_source_name(id),
+                    serial_data_is_source_connected(id) ? "true" : "false",
+                    s.bytes, s.lines, s.frames, s.samples, s.parse_failures, s.line_overflows,
+                    s.frame_errors, s.crc_errors, s.deltas_dropped, s.rx_overruns,
+                    s.bytes_per_sec, s.samples_per_sec,
+                    s.jitter_hist[0], s.jitter_hist[1], s.jitter_hist[2], s.jitter_hist[3],
+                    s.jitter_hist[4], s.jitter_hist[5], s.jitter_hist[6], s.jitter_hist[7],
+                    s.latency_last_ms, s.latency_avg_ms, s.latency_max_ms, s.latency_synced ? "true" : "false");
+    first = false;
+  }
+
+  if (len + 4 > sizeof(reply))
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "STATS reply truncated");
+    len = sizeof(reply) - 4;
+  }
+  memcpy(reply + len, "]}\n", 3);
+  serial_data_write(reply, len + 3);
+}
 
 /**
- * @brief Trigger a connection check (non-blocking)
+ * @brief Drop any partially received line or frame of a source
  */
-static void trigger_connection_check(void)
+static void reset_source_parser(telemetry_source_t *src)
 {
-  // Simply update the trigger time - the connection check task will handle the delay
-  last_check_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  src->line_pos = 0;
+  src->frame_pos = 0;
+  src->in_binary_frame = false;
+  src->awaiting_keyframe = true;
 }
 
 /**
- * @brief Connection check task that runs independently
+ * @brief Length of the leading run of printable ASCII (32..126) bytes
+ *
+ * Checks four bytes per aligned word and only falls back to bytes around the
+ * first word that holds a control, DEL or 8-bit byte. Newline, CR and the
+ * frame delimiter all end a run, so one scan finds the next byte that needs
+ * handling and validates everything before it.
  */
-static void connection_check_task(void *pvParameters)
+static size_t printable_run(const uint8_t *bytes, size_t len)
 {
-  while (serial_running)
+  size_t i = 0;
+
+  while (i < len && ((uintptr_t)(bytes + i) & 3) != 0)
+  {
+    if (bytes[i] < 32 || bytes[i] > 126)
+      return i;
+    i++;
+  }
+
+  for (; i + 4 <= len; i += 4)
   {
-    // Determine connection status based on data recency
-    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    bool current_connection_status = false;
+    uint32_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    uint32_t del = word ^ 0x7F7F7F7Fu;
+    uint32_t bad = ((word - 0x20202020u) & ~word) // a byte below 32
+                   | word                         // a byte above 127
+                   | ((del - 0x01010101u) & ~del); // a 127 byte
+    if (bad & 0x80808080u)
+      break;
+  }
 
-    if (serial_running && last_data_time > 0)
+  while (i < len && bytes[i] >= 32 && bytes[i] <= 126)
+    i++;
+  return i;
+}
+
+/**
+ * @brief Add received bytes to the line buffer and handle line completion
+ *
+ * A 0x00 byte switches to binary framing until the closing delimiter. Text
+ * never contains 0x00, so both formats can share the link and the format is
+ * detected per frame. Frame bodies are located with memchr and printable text
+ * with printable_run and copied in bulk; overflow handling matches feeding the
+ * bytes one at a time, the byte that does not fit is dropped.
+ *
+ * The bytes may lie inside the source's own line or frame buffer (see
+ * receive_window). Output never gets ahead of input, so the copies are
+ * memmoves and a plain line received in place is not copied at all.
+ */
+static void handle_incoming_block(telemetry_source_t *src, const uint8_t *bytes, size_t len)
+{
+  const uint8_t *end = bytes + len;
+
+  while (bytes < end)
+  {
+    if (src->in_binary_frame)
     {
-      uint32_t time_since_last_data = current_time - last_data_time;
-      current_connection_status = (time_since_last_data <= 5000); // Connected if data within 5 seconds
-    }
+      const uint8_t *delim = memchr(bytes, TELEMETRY_FRAME_DELIMITER, (size_t)(end - bytes));
+      const uint8_t *stop = delim ? delim : end;
+      size_t room = sizeof(src->frame_buffer) - src->frame_pos;
+      size_t count = (size_t)(stop - bytes);
 
-    // Only call callback when status actually changed
-    if (current_connection_status != last_connection_status)
+      if (count > room)
+      {
+        memmove(src->frame_buffer + src->frame_pos, bytes, room);
+        bytes += room + 1;
+        src->stats.frame_errors++;
+        debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Binary frame overflow, resetting");
+        src->frame_pos = 0;
+        src->in_binary_frame = false;
+        continue;
+      }
+
+      if (src->frame_buffer + src->frame_pos != bytes)
+        memmove(src->frame_buffer + src->frame_pos, bytes, count);
+      src->frame_pos += count;
+      bytes = stop;
+      if (!delim)
+        break;
+    }
+    else
     {
-      last_connection_status = current_connection_status;
+      size_t count = printable_run(bytes, (size_t)(end - bytes));
+      const uint8_t *stop = bytes + count;
+
+      while (bytes < stop)
+      {
+        size_t room = JSON_BUFFER_SIZE - 1 - (size_t)src->line_pos;
+        if (room == 0)
+        {
+          src->stats.line_overflows++;
+          debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Line buffer overflow, resetting");
+          src->line_pos = 0;
+          bytes++;
+          continue;
+        }
+        size_t chunk = (size_t)(stop - bytes) < room ? (size_t)(stop - bytes) : room;
+        if ((const uint8_t *)src->line_buffer + src->line_pos != bytes)
+          memmove(src->line_buffer + src->line_pos, bytes, chunk);
+        src->line_pos += (int)chunk;
+        bytes += chunk;
+      }
 
-      if (connection_callback)
+      if (bytes == end)
+        break;
+
+      // Check for end of line
+      if (*bytes == '\n' || *bytes == '\r')
+      {
+        // Process line if we have data
+        if (src->line_pos > 0)
+        {
+          src->line_buffer[src->line_pos] = '\0';
+          debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Processing line (%d chars): %.50s%s",
+                            src->line_pos, src->line_buffer, (src->line_pos > 50) ? "..." : "");
+          src->stats.lines++;
+          process_received_line(src, (size_t)src->line_pos);
+          src->line_pos = 0; // Reset for next line
+        }
+        bytes++;
+        continue;
+      }
+      if (*bytes != TELEMETRY_FRAME_DELIMITER)
       {
-        connection_callback(current_connection_status);
-        debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Connection status changed: %s (last data: %lu ms ago)",
-                          current_connection_status ? "connected" : "disconnected",
-                          last_data_time > 0 ? (current_time - last_data_time) : 0);
+        bytes++; // Ignore other control characters without logging
+        continue;
       }
     }
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // Delimiter: closes a frame with content, otherwise opens one
+    bytes++;
+    if (src->in_binary_frame && src->frame_pos > 0)
+    {
+      process_received_frame(src);
+      src->frame_pos = 0;
+      src->in_binary_frame = false;
+      continue;
+    }
+
+    // Opening delimiter, drop any partial text line
+    src->in_binary_frame = true;
+    src->frame_pos = 0;
+    src->line_pos = 0;
   }
+}
 
-  vTaskDelete(NULL);
+static uint8_t *receive_window(telemetry_source_t *src, size_t *room)
+{
+  if (src->in_binary_frame)
+  {
+    *room = sizeof(src->frame_buffer) - src->frame_pos;
+    return src->frame_buffer + src->frame_pos;
+  }
+
+  // Keep the last byte for the terminator
+  *room = JSON_BUFFER_SIZE - 1 - (size_t)src->line_pos;
+  return (uint8_t *)src->line_buffer + src->line_pos;
+}
+
+/**
+ * @brief Record a connection change and publish it, once per change
+ * @note Called by the feeding task and the esp_timer task, the mutex keeps
+ *       a reconnect from being published ahead of the disconnect it follows
+ */
+static void set_source_connected(int id, bool connected)
+{
+  telemetry_source_t *src = &sources[id];
+
+  xSemaphoreTake(connection_mutex, portMAX_DELAY);
+  // An expired timer that was re-armed meanwhile is not a disconnect
+  bool changed = shared_load_bool(&src->connected) != connected &&
+                 (connected || !esp_timer_is_active(stale_timers[id]));
+  if (changed)
+  {
+    shared_store_bool(&src->connected, connected);
+    if (!connected)
+    {
+      portENTER_CRITICAL(&sources_lock);
+      src->stats.bytes_per_sec = 0;
+      src->stats.samples_per_sec = 0;
+      portEXIT_CRITICAL(&sources_lock);
+    }
+
+    // The host clock is only trusted while the local link is up, a new host may follow
+    if (id == SERIAL_SOURCE_LOCAL && !connected)
+    {
+      telemetry_clock_reset();
+      telemetry_rate_reset();
+    }
+
+    debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Source %s %s", src->name, connected ? "connected" : "disconnected");
+
+    event_t event = {.topic = EVENT_TOPIC_SERIAL_CONNECTION,
+                     .serial_connection = {.source_id = (uint8_t)id, .connected = connected}};
+    event_bus_publish(&event);
+  }
+  xSemaphoreGive(connection_mutex);
+}
+
+/**
+ * @brief Staleness timer expired: nothing complete arrived for SERIAL_SOURCE_TIMEOUT_MS
+ */
+static void stale_timer_cb(void *arg)
+{
+  set_source_connected((int)(intptr_t)arg, false);
+}
+
+static void source_alive(telemetry_source_t *src)
+{
+  int id = (int)(src - sources);
+  if (!stale_timers[id])
+  {
+    const esp_timer_create_args_t timer_args = {
+        .callback = stale_timer_cb,
+        .arg = (void *)(intptr_t)id,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "serial_stale",
+    };
+    if (esp_timer_create(&timer_args, &stale_timers[id]) != ESP_OK)
+    {
+      stale_timers[id] = NULL;
+      return;
+    }
+  }
+
+  // Restart fails once the timer expired, then it is started afresh
+  if (esp_timer_restart(stale_timers[id], (uint64_t)SERIAL_SOURCE_TIMEOUT_MS * 1000) != ESP_OK)
+    esp_timer_start_once(stale_timers[id], (uint64_t)SERIAL_SOURCE_TIMEOUT_MS * 1000);
+
+  // Throughput over at least one rate window
+  uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  uint32_t elapsed_ms = now_ms - src->rate_time_ms;
+  if (elapsed_ms >= SERIAL_RATE_WINDOW_MS)
+  {
+    if (shared_load_bool(&src->connected))
+    {
+      src->stats.bytes_per_sec = (src->stats.bytes - src->rate_bytes_mark) * 1000 / elapsed_ms;
+      src->stats.samples_per_sec = (src->stats.samples - src->rate_samples_mark) * 1000 / elapsed_ms;
+    }
+    src->rate_bytes_mark = src->stats.bytes;
+    src->rate_samples_mark = src->stats.samples;
+    src->rate_time_ms = now_ms;
+  }
+
+  if (!shared_load_bool(&src->connected))
+    set_source_connected(id, true);
+
+  // Rate-limited inside, a sync or rate request goes out when one is due
+  if (id == SERIAL_SOURCE_LOCAL)
+  {
+    telemetry_clock_poll();
+    telemetry_rate_poll(true);
+  }
 }
 
 /**
  * @brief Serial data reception task
+ *
+ * Blocks in the transport until bytes arrive. The UART backend wakes once per
+ * complete line, the USB CDC backend whenever a USB packet was received.
+ *
+ * Bytes are received straight into the tail of the line or frame being
+ * assembled, so a line goes from the driver's ring buffer to the parser with
+ * a single copy. A stack chunk is only used once that tail gets short.
  */
 static void serial_data_task(void *pvParameters)
 {
-  static char line_buffer[JSON_BUFFER_SIZE];
-  static int line_pos = 0;
-
-  // Use static allocation to prevent stack issues on first JSON parse
-  static system_data_t system_data = {0};
-  uint32_t current_time;
+  telemetry_source_t *local = &sources[SERIAL_SOURCE_LOCAL];
 
+#if !CONFIG_SERIAL_JSON_STREAMING_PARSER
   // Initialize cJSON to prevent first-time allocation issues
   // This pre-allocates internal structures to avoid heap fragmentation
   cJSON *test_json = cJSON_CreateObject();
@@ -468,28 +946,40 @@ static void serial_data_task(void *pvParameters)
   {
     cJSON_Delete(test_json);
   }
+#endif
 
-  while (serial_running)
+  while (shared_load_bool(&serial_running))
   {
-    // Read multiple bytes at once for better performance, but smaller buffer
-    // to reduce risk of partial JSON objects
-    uint8_t data_buffer[32];                                                                       // Reduced from 64 to 32 bytes
-    int len = uart_read_bytes(UART_PORT_NUM, data_buffer, sizeof(data_buffer), pdMS_TO_TICKS(20)); // Reduced timeout
+    uint8_t chunk[READ_CHUNK_SIZE];
+    size_t room;
+    uint8_t *dst = receive_window(local, &room);
+    if (room < READ_IN_PLACE_MIN)
+    {
+      dst = chunk;
+      room = sizeof(chunk);
+    }
+    int len = transport->receive(dst, room, pdMS_TO_TICKS(1000));
 
-    current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (len < 0)
+    {
+      // Input was lost, the next line or frame starts clean
+      local->stats.rx_overruns++;
+      reset_source_parser(local);
+      telemetry_rate_note_overrun();
+      continue;
+    }
 
     if (len > 0)
     {
-      last_data_time = current_time;
-
-      // Process each received byte
-      for (int i = 0; i < len; i++)
-      {
-        handle_incoming_byte(data_buffer[i], line_buffer, &line_pos, &system_data);
-      }
+      TRACE_SPAN_BEGIN("serial_feed");
+      serial_data_feed(SERIAL_SOURCE_LOCAL, dst, len);
+      TRACE_SPAN_END("serial_feed");
+    }
+    else if (shared_load_bool(&local->connected))
+    {
+      // A quiet host still hears about a new rate within a receive timeout
+      telemetry_rate_poll(false);
     }
-
-    vTaskDelay(pdMS_TO_TICKS(20)); // Reduced delay for faster response
   }
 
   vTaskDelete(NULL);
@@ -497,75 +987,216 @@ static void serial_data_task(void *pvParameters)
 
 esp_err_t serial_data_init(void)
 {
-  uart_config_t uart_config = {
-      .baud_rate = UART_BAUD_RATE,
-      .data_bits = UART_DATA_BITS,
-      .parity = UART_PARITY,
-      .stop_bits = UART_STOP_BITS,
-      .flow_ctrl = UART_FLOW_CTRL,
-      .source_clk = UART_SOURCE_CLK,
-  };
+#if CONFIG_SERIAL_TELEMETRY_DEFAULT_USB_CDC
+  return serial_data_init_transport(SERIAL_TRANSPORT_USB_CDC);
+#else
+  return serial_data_init_transport(SERIAL_TRANSPORT_UART);
+#endif
+}
+
+esp_err_t serial_data_init_transport(serial_transport_type_t type)
+{
+  if (transport)
+    return ESP_ERR_INVALID_STATE;
+
+  if (!connection_mutex)
+    connection_mutex = xSemaphoreCreateMutexStatic(&connection_mutex_buffer);
+
+  const serial_transport_t *selected = NULL;
+  switch (type)
+  {
+  case SERIAL_TRANSPORT_UART:
+    selected = serial_transport_uart();
+    break;
+  case SERIAL_TRANSPORT_USB_CDC:
+    selected = serial_transport_usb_cdc();
+    break;
+  }
 
-  // Install UART driver
-  ESP_ERROR_CHECK(uart_driver_install(UART_PORT_NUM, BUF_SIZE * 2, 0, 0, NULL, 0));
-  ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));
+  if (!selected)
+  {
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "Requested serial transport not built in");
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  esp_err_t ret = selected->init();
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SERIAL_DATA, "%s transport init failed: %s", selected->name, esp_err_to_name(ret));
+    return ret;
+  }
+
+  transport = selected;
+  transport_type = type;
 
-  debug_log_startup(DEBUG_TAG_SERIAL_DATA, "Serial Port");
+  // The local link is always source 0
+  telemetry_source_t *local = &sources[SERIAL_SOURCE_LOCAL];
+  strncpy(local->name, transport->name, sizeof(local->name) - 1);
+  reset_source_parser(local);
+  local->in_use = true;
+
+  for (size_t i = 0; i < sizeof(link_metrics) / sizeof(link_metrics[0]); i++)
+  {
+    metrics_register(&link_metrics[i]);
+  }
+
+  debug_log_startup(DEBUG_TAG_SERIAL_DATA, transport->name);
 
   return ESP_OK;
 }
 
-void serial_data_start_task(void)
+serial_transport_type_t serial_data_get_transport(void)
 {
-  if (!serial_running)
+  return transport_type;
+}
+
+int serial_data_register_source(const char *name)
+{
+  int id = -1;
+
+  portENTER_CRITICAL(&sources_lock);
+  for (int i = SERIAL_SOURCE_LOCAL + 1; i < CONFIG_SERIAL_MAX_SOURCES; i++)
   {
-    debug_log_event(DEBUG_TAG_SERIAL_DATA, "Starting serial data task");
-    serial_running = true;
-    last_data_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-    // Create connection check task first
-    xTaskCreatePinnedToCore(
-        connection_check_task,         // Task function
-        "conn_check",                  // Task name
-        4096,                          // Stack size (increased from 2048 to prevent overflow)
-        NULL,                          // Parameters
-        1,                             // Priority (lower than serial task)
-        &connection_check_task_handle, // Task handle
-        1                              // Core ID (1, different from serial task)
-    );
-
-    // Use a safer approach for task creation to prevent first-time reset issues
-    // The previous SPIRAM allocation approach was causing memory corruption
-
-    debug_log_info(DEBUG_TAG_SERIAL_DATA, "Creating serial task with safe stack allocation");
-
-    // Create task with reduced stack size for stability
-    const uint32_t safe_stack_size = 8192; // 8KB should be sufficient
-    xTaskCreatePinnedToCore(
-        serial_data_task,     // Task function
-        "serial_data",        // Task name
-        safe_stack_size,      // Stack size in bytes
-        NULL,                 // Parameters
-        SERIAL_TASK_PRIORITY, // Priority
-        &serial_task_handle,  // Task handle
-        0                     // Core ID (0)
-    );
+    if (!sources[i].in_use)
+    {
+      memset(&sources[i], 0, sizeof(sources[i]));
+      strncpy(sources[i].name, name ? name : "remote", sizeof(sources[i].name) - 1);
+      sources[i].awaiting_keyframe = true;
+      sources[i].in_use = true;
+      id = i;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&sources_lock);
+
+  if (id < 0)
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "No free telemetry source slot");
+  }
+  else
+  {
+    debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Telemetry source %d registered: %s", id, sources[id].name);
   }
+  return id;
 }
 
-void serial_data_stop(void)
+esp_err_t serial_data_feed(uint8_t source_id, const uint8_t *bytes, size_t len)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use || !bytes)
+    return ESP_ERR_INVALID_ARG;
+
+  telemetry_source_t *src = &sources[source_id];
+  src->stats.bytes += len;
+  CYCLE_PROF_BEGIN(handle_incoming_block);
+  handle_incoming_block(src, bytes, len);
+  CYCLE_PROF_END(handle_incoming_block);
+  return ESP_OK;
+}
+
+esp_err_t serial_data_get_source_data(uint8_t source_id, system_data_t *data)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use || !data)
+    return ESP_ERR_INVALID_ARG;
+
+  telemetry_source_t *src = &sources[source_id];
+  SEQLOCK_READ(&src->data_seq, data, &src->data);
+  return ESP_OK;
+}
+
+esp_err_t serial_data_get_link_stats(uint8_t source_id, serial_link_stats_t *stats)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use || !stats)
+    return ESP_ERR_INVALID_ARG;
+
+  // Counters are written lock-free by the feeding task, a copy may be one sample stale
+  portENTER_CRITICAL(&sources_lock);
+  *stats = sources[source_id].stats;
+  portEXIT_CRITICAL(&sources_lock);
+  return ESP_OK;
+}
+
+void serial_data_reset_link_stats(uint8_t source_id)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use)
+    return;
+
+  telemetry_source_t *src = &sources[source_id];
+  portENTER_CRITICAL(&sources_lock);
+  memset(&src->stats, 0, sizeof(src->stats));
+  src->rate_bytes_mark = 0;
+  src->rate_samples_mark = 0;
+  src->have_offset = false;
+  portEXIT_CRITICAL(&sources_lock);
+}
+
+const char *serial_data_get_source_name(uint8_t source_id)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use)
+    return NULL;
+  return sources[source_id].name;
+}
+
+bool serial_data_is_source_connected(uint8_t source_id)
+{
+  return source_id < CONFIG_SERIAL_MAX_SOURCES && sources[source_id].in_use &&
+         shared_load_bool(&sources[source_id].connected);
+}
+
+esp_err_t serial_data_get_sample_age_ms(uint8_t source_id, uint32_t *age_ms)
+{
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES || !sources[source_id].in_use || !age_ms)
+    return ESP_ERR_INVALID_ARG;
+
+  uint64_t host_now_ms;
+  if (source_id != SERIAL_SOURCE_LOCAL || !telemetry_clock_host_time_ms(esp_timer_get_time(), &host_now_ms))
+    return ESP_ERR_INVALID_STATE;
+
+  telemetry_source_t *src = &sources[source_id];
+  uint64_t sample_ms;
+  SEQLOCK_READ(&src->data_seq, &sample_ms, &src->data.timestamp);
+
+  // Samples without a host timestamp carry the device clock
+  if (sample_ms < STATS_HOST_EPOCH_MIN_MS)
+    return ESP_ERR_INVALID_STATE;
+
+  *age_ms = host_now_ms > sample_ms ? (uint32_t)(host_now_ms - sample_ms) : 0;
+  return ESP_OK;
+}
+
+int serial_data_write(const void *data, size_t len)
 {
-  if (serial_running)
+  if (!transport || !data)
+    return -1;
+  if (serial_mux_route_write(data, len))
+    return (int)len;
+  return transport->write((const uint8_t *)data, len);
+}
+
+void serial_data_start_task(void)
+{
+  if (!shared_load_bool(&serial_running) && transport)
   {
-    serial_running = false;
+    debug_log_event(DEBUG_TAG_SERIAL_DATA, "Starting serial data task");
+    shared_store_bool(&serial_running, true);
 
-    // Stop connection check task first
-    if (connection_check_task_handle)
+    // The console shares the UART, so only there can logs move to the log channel
+    esp_err_t ret = serial_mux_init(dispatch_command, transport_write, transport_type == SERIAL_TRANSPORT_UART);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE && ret != ESP_ERR_NOT_SUPPORTED)
     {
-      vTaskDelete(connection_check_task_handle);
-      connection_check_task_handle = NULL;
+      debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "Command channel not started: %s", esp_err_to_name(ret));
     }
 
+    // The stack stays in internal RAM, a PSRAM stack here corrupted memory
+    task_plan_create(TASK_PLAN_SERIAL, serial_data_task, NULL, &serial_task_handle);
+  }
+}
+
+void serial_data_stop(void)
+{
+  if (shared_load_bool(&serial_running))
+  {
+    shared_store_bool(&serial_running, false);
+
     // Stop serial task
     if (serial_task_handle)
     {
@@ -579,20 +1210,8 @@ void serial_data_stop(void)
 // CALLBACK REGISTRATION FUNCTIONS
 // =======================================================================
 
-/**
- * @brief Register callback for connection status changes
- */
-void serial_data_register_connection_callback(serial_connection_callback_t callback)
-{
-  connection_callback = callback;
-  debug_log_event(DEBUG_TAG_SERIAL_DATA, "Connection callback registered");
-}
-
-/**
- * @brief Register callback for data updates
- */
-void serial_data_register_data_callback(serial_data_callback_t callback)
+void serial_data_register_command_callback(serial_command_callback_t callback)
 {
-  data_callback = callback;
-  debug_log_event(DEBUG_TAG_SERIAL_DATA, "Data callback registered");
+  command_callback = callback;
+  debug_log_event(DEBUG_TAG_SERIAL_DATA, "Command callback registered");
 }
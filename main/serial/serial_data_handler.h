@@ -2,10 +2,13 @@
  * @file serial_data_handler.h
  * @brief Serial Data Handler for System Monitor Dashboard
  *
- * This module handles UART communication and JSON parsing for real-time
- * system monitoring data reception. Designed for ESP32-S3 with LVGL
+ * This module handles the telemetry link (UART or USB CDC) and parsing
+ * for real-time system monitoring data reception. Designed for ESP32-S3 with LVGL
  * graphics integration.
  *
+ * Merged samples and connection changes of every source are published on
+ * the event bus as EVENT_TOPIC_TELEMETRY and EVENT_TOPIC_SERIAL_CONNECTION.
+ *
  * @author ESP32 System Monitor
  * @version 1.0
  * @date 2024
@@ -19,24 +22,83 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "dashboard_data.h"
 
 // =======================================================================
-// CALLBACK FUNCTION TYPES
+// TRANSPORT SELECTION
 // =======================================================================
 
 /**
- * @brief Callback function type for connection status changes
- * @param connected True if connection is active, false if lost
+ * @brief Physical link carrying the telemetry stream
  */
-typedef void (*serial_connection_callback_t)(bool connected);
+typedef enum
+{
+  SERIAL_TRANSPORT_UART,    ///< UART0, shared with the console
+  SERIAL_TRANSPORT_USB_CDC, ///< Native USB CDC-ACM (requires CONFIG_SERIAL_TELEMETRY_USB_CDC)
+} serial_transport_type_t;
+
+// =======================================================================
+// TELEMETRY SOURCES
+// =======================================================================
+
+#define SERIAL_SOURCE_LOCAL 0     ///< Source id of the local transport (UART or USB CDC)
+#define SERIAL_SOURCE_NAME_LEN 16 ///< Maximum source name length including terminator
+
+// =======================================================================
+// LINK STATISTICS
+// =======================================================================
+
+#define SERIAL_JITTER_BUCKETS 8 ///< Inter-arrival jitter bins: <1, <2, <5, <10, <20, <50, <100, >=100 ms
+
+/**
+ * @brief Link quality and throughput counters of one source
+ *
+ * Totals count since start or the last reset. Rates cover about the last
+ * second of traffic and drop to zero when the source goes quiet.
+ */
+typedef struct
+{
+  uint32_t bytes;          ///< Bytes received
+  uint32_t lines;          ///< Complete text lines
+  uint32_t frames;         ///< Complete binary frames
+  uint32_t samples;        ///< Samples delivered to subscribers
+  uint32_t parse_failures; ///< JSON lines that did not parse
+  uint32_t line_overflows; ///< Lines longer than the line buffer
+  uint32_t frame_errors;   ///< Binary frames that overflowed or failed to decode (excluding CRC)
+  uint32_t crc_errors;     ///< Binary frames with a CRC mismatch
+  uint32_t deltas_dropped; ///< Delta frames ignored while waiting for a keyframe
+  uint32_t rx_overruns;    ///< Transport reported lost input
+
+  uint32_t bytes_per_sec;   ///< Receive rate
+  uint32_t samples_per_sec; ///< Sample rate
+
+  /** Change of the inter-arrival interval between consecutive samples */
+  uint32_t jitter_hist[SERIAL_JITTER_BUCKETS];
+
+  /**
+   * Host timestamp to dispatch delay. Once the local link's clock is synced
+   * (see telemetry_clock.h) this is the measured sender-to-display latency,
+   * otherwise it is the delay above the fastest sample seen, i.e. the delay
+   * variation rather than the absolute one-way latency.
+   */
+  uint32_t latency_last_ms;
+  uint32_t latency_avg_ms; ///< Moving average (1/8 weight)
+  uint32_t latency_max_ms;
+  bool latency_synced; ///< The latency fields are measured against the synced host clock
+} serial_link_stats_t;
+
+// =======================================================================
+// CALLBACK FUNCTION TYPES
+// =======================================================================
 
 /**
- * @brief Callback function type for data updates
- * @param data Pointer to system data structure with new monitoring data
+ * @brief Callback function type for text commands from the host
+ * @param line Received line without line terminator
+ * @return true if the command was handled
  */
-typedef void (*serial_data_callback_t)(const system_data_t *data);
+typedef bool (*serial_command_callback_t)(const char *line);
 
 // =======================================================================
 // PUBLIC FUNCTION PROTOTYPES
@@ -45,10 +107,99 @@ typedef void (*serial_data_callback_t)(const system_data_t *data);
 /**
  * @brief Initialize serial data receiver system
  * @return ESP_OK on successful initialization, error code otherwise
- * @note Sets up UART configuration and internal data structures
+ * @note Uses the transport selected by CONFIG_SERIAL_TELEMETRY_DEFAULT_USB_CDC
  */
 esp_err_t serial_data_init(void);
 
+/**
+ * @brief Initialize serial data receiver system on a specific transport
+ * @param type Transport to receive telemetry on
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the transport is not built in,
+ *         ESP_ERR_INVALID_STATE if a transport is already initialized
+ */
+esp_err_t serial_data_init_transport(serial_transport_type_t type);
+
+/**
+ * @brief Get the transport the receiver was initialized with
+ * @return Active transport type
+ */
+serial_transport_type_t serial_data_get_transport(void);
+
+/**
+ * @brief Send bytes to the host over the active transport
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return Number of bytes queued, -1 if no transport is initialized
+ * @note Use for replies to host commands so they reach the telemetry peer
+ */
+int serial_data_write(const void *data, size_t len);
+
+/**
+ * @brief Register an additional telemetry source (e.g. a host reporting over WiFi)
+ * @param name Short display name, truncated to SERIAL_SOURCE_NAME_LEN - 1 characters
+ * @return Source id, or -1 if all CONFIG_SERIAL_MAX_SOURCES slots are taken
+ */
+int serial_data_register_source(const char *name);
+
+/**
+ * @brief Feed received bytes of a source into its line/frame parser
+ * @param source_id Source the bytes belong to
+ * @param bytes Received bytes (JSON lines or binary frames)
+ * @param len Number of bytes
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG for an unknown source
+ * @note Subscribers are called from the feeding task; feed each source from one task only
+ */
+esp_err_t serial_data_feed(uint8_t source_id, const uint8_t *bytes, size_t len);
+
+/**
+ * @brief Copy the latest merged state of a source
+ * @param source_id Source to read
+ * @param data Destination
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG for an unknown source
+ * @note Any task may call this: the copy never blocks the feeding task and is
+ *       retried if a sample lands during it, so it is never torn
+ */
+esp_err_t serial_data_get_source_data(uint8_t source_id, system_data_t *data);
+
+/**
+ * @brief Get the display name of a source
+ * @param source_id Source to query
+ * @return Name, or NULL for an unknown source
+ */
+const char *serial_data_get_source_name(uint8_t source_id);
+
+/**
+ * @brief Check whether a source delivered data recently
+ * @param source_id Source to query
+ * @return true if the source is registered and connected
+ */
+bool serial_data_is_source_connected(uint8_t source_id);
+
+/**
+ * @brief Real age of a source's newest sample, by the synced host clock
+ * @param source_id Source to query
+ * @param age_ms Output time since the host took the sample
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while the clock is not synced or the
+ *         sample has no host timestamp, ESP_ERR_INVALID_ARG for an unknown source
+ * @note Only the local source is synced
+ */
+esp_err_t serial_data_get_sample_age_ms(uint8_t source_id, uint32_t *age_ms);
+
+/**
+ * @brief Copy the link statistics of a source
+ * @param source_id Source to read
+ * @param stats Destination
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG for an unknown source
+ * @note Also available to the host as the STATS command
+ */
+esp_err_t serial_data_get_link_stats(uint8_t source_id, serial_link_stats_t *stats);
+
+/**
+ * @brief Clear the link statistics of a source
+ * @param source_id Source to reset
+ */
+void serial_data_reset_link_stats(uint8_t source_id);
+
 /**
  * @brief Start serial data reception task
  * @note Creates FreeRTOS task for continuous data monitoring
@@ -63,17 +214,8 @@ void serial_data_start_task(void);
 void serial_data_stop(void);
 
 /**
- * @brief Register callback for connection status changes
- * @param callback Function to call when connection status changes
+ * @brief Register callback for text command lines (anything that is not JSON data)
+ * @param callback Function to call for each command line
  * @note Pass NULL to unregister the callback
  */
-void serial_data_register_connection_callback(serial_connection_callback_t callback);
-
-/**
- * @brief Register callback for data updates
- * @param callback Function to call when new monitoring data arrives
- * @note Pass NULL to unregister the callback
- */
-void serial_data_register_data_callback(serial_data_callback_t callback);
-
-
+void serial_data_register_command_callback(serial_command_callback_t callback);
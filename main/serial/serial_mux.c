@@ -0,0 +1,349 @@
+/**
+ * @file serial_mux.c
+ * @brief Framed channels for commands, logs and bulk data on the local link
+ *
+ * The serial task only checks a frame and queues the request; the request
+ * task runs the commands. Replies are told apart from other output by the
+ * task that writes them, so the command handlers need no changes to
+ * answer in frames.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "serial_mux.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "serial_data_handler.h"
+#include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+
+#if CONFIG_SERIAL_MUX
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define MUX_QUEUE_DEPTH 4   ///< Requests waiting behind the running one
+#define MUX_LOG_LINE 160    ///< Longest log line sent on the log channel, the rest is cut
+#define MUX_FRAME_MAX (SERIAL_MUX_HEADER_SIZE + SERIAL_MUX_MAX_BODY + 2 + 8) ///< CRC, COBS and delimiters included
+
+typedef struct
+{
+  uint16_t id;
+  bool framed; ///< Came in a mux frame, replies go back in frames
+  char command[SERIAL_MUX_REQUEST_MAX + 1];
+} mux_request_t;
+
+static serial_mux_dispatch_fn dispatch = NULL;
+static serial_mux_write_fn raw_write = NULL;
+static bool log_channel_allowed = false;
+static QueueHandle_t request_queue = NULL;
+static TaskHandle_t request_task = NULL;
+
+// Request being run, only touched by the request task
+static uint16_t active_id = 0;
+static bool active_framed = false;
+static bool active_deferred = false;
+
+// One frame is built at a time in the shared buffers, which keeps logging
+// tasks from needing the stack for them
+static SemaphoreHandle_t tx_mutex = NULL;
+static StaticSemaphore_t tx_mutex_buffer;
+static uint8_t tx_payload[SERIAL_MUX_HEADER_SIZE + SERIAL_MUX_MAX_BODY];
+static uint8_t tx_frame[MUX_FRAME_MAX];
+
+static vprintf_like_t console_vprintf = NULL; ///< Log output before LOG_CHANNEL ON, NULL while off
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static esp_err_t send_frame(serial_channel_t channel, uint8_t flags, uint16_t request_id, const uint8_t *body,
+                            size_t len)
+{
+  xSemaphoreTake(tx_mutex, portMAX_DELAY);
+  tx_payload[0] = TELEMETRY_FRAME_VERSION;
+  tx_payload[1] = SERIAL_MUX_MSG;
+  tx_payload[2] = (uint8_t)channel;
+  tx_payload[3] = flags;
+  tx_payload[4] = (uint8_t)request_id;
+  tx_payload[5] = (uint8_t)(request_id >> 8);
+  if (len > 0)
+    memcpy(tx_payload + SERIAL_MUX_HEADER_SIZE, body, len);
+  size_t n = telemetry_frame_wrap(tx_payload, SERIAL_MUX_HEADER_SIZE + len, tx_frame, sizeof(tx_frame));
+  int written = n > 0 ? raw_write(tx_frame, n) : -1;
+  xSemaphoreGive(tx_mutex);
+  return written == (int)n ? ESP_OK : ESP_FAIL;
+}
+
+/**
+ * @brief ESP log output while LOG_CHANNEL is on, one frame per call
+ */
+static int log_channel_vprintf(const char *format, va_list args)
+{
+  // A log from inside a frame write would wait for itself, it goes out as before
+  if (xPortInIsrContext() || xSemaphoreGetMutexHolder(tx_mutex) == xTaskGetCurrentTaskHandle())
+    return console_vprintf(format, args);
+
+  char line[MUX_LOG_LINE];
+  int len = vsnprintf(line, sizeof(line), format, args);
+  if (len < 0)
+    return len;
+  size_t n = (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1;
+  send_frame(SERIAL_CHANNEL_LOG, 0, 0, (const uint8_t *)line, n);
+  return len;
+}
+
+/**
+ * @brief LOG_CHANNEL ON|OFF, handled here rather than by the dispatcher
+ */
+static bool handle_log_channel(const char *command)
+{
+  if (strncmp(command, "LOG_CHANNEL", 11) != 0 || (command[11] != '\0' && command[11] != ' '))
+    return false;
+
+  bool on = strcmp(command + 11, " ON") == 0;
+  char reply[64];
+  int len;
+  if (!log_channel_allowed)
+  {
+    len = snprintf(reply, sizeof(reply), "LOG_CHANNEL {\"error\":\"console is not on this link\"}\n");
+  }
+  else if (!on && strcmp(command + 11, " OFF") != 0)
+  {
+    len = snprintf(reply, sizeof(reply), "LOG_CHANNEL {\"error\":\"usage: LOG_CHANNEL ON|OFF\"}\n");
+  }
+  else
+  {
+    if (on && !console_vprintf)
+    {
+      console_vprintf = esp_log_set_vprintf(log_channel_vprintf);
+    }
+    else if (!on && console_vprintf)
+    {
+      esp_log_set_vprintf(console_vprintf);
+      console_vprintf = NULL;
+    }
+    len = snprintf(reply, sizeof(reply), "LOG_CHANNEL {\"on\":%s}\n", on ? "true" : "false");
+  }
+  serial_data_write(reply, (size_t)len);
+  return true;
+}
+
+static void request_task_fn(void *arg)
+{
+  (void)arg;
+  mux_request_t req;
+
+  while (true)
+  {
+    xQueueReceive(request_queue, &req, portMAX_DELAY);
+
+    active_id = req.id;
+    active_framed = req.framed;
+    active_deferred = false;
+    bool handled = handle_log_channel(req.command) || dispatch(req.command);
+    bool deferred = active_deferred;
+    active_framed = false;
+
+    if (!req.framed)
+    {
+      if (!handled)
+        debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Unknown command: %.32s", req.command);
+      continue;
+    }
+    if (!handled)
+    {
+      static const char unknown[] = "unknown command";
+      send_frame(SERIAL_CHANNEL_CONTROL, SERIAL_MUX_FLAG_ERROR, req.id, (const uint8_t *)unknown,
+                 sizeof(unknown) - 1);
+    }
+    else if (!deferred)
+    {
+      send_frame(SERIAL_CHANNEL_CONTROL, 0, req.id, NULL, 0);
+    }
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t serial_mux_init(serial_mux_dispatch_fn dispatch_fn, serial_mux_write_fn write, bool console_link)
+{
+  if (!dispatch_fn || !write)
+    return ESP_ERR_INVALID_ARG;
+  if (request_task)
+    return ESP_ERR_INVALID_STATE;
+
+  dispatch = dispatch_fn;
+  raw_write = write;
+  log_channel_allowed = console_link;
+  if (!tx_mutex)
+    tx_mutex = xSemaphoreCreateMutexStatic(&tx_mutex_buffer);
+  if (!request_queue)
+    request_queue = xQueueCreate(MUX_QUEUE_DEPTH, sizeof(mux_request_t));
+  if (!request_queue)
+    return ESP_ERR_NO_MEM;
+
+  if (task_plan_create(TASK_PLAN_SERIAL_MUX, request_task_fn, NULL, &request_task) != pdPASS)
+    return ESP_ERR_NO_MEM;
+  return ESP_OK;
+}
+
+esp_err_t serial_mux_handle_frame(const uint8_t *encoded, size_t len)
+{
+  // Version and type are never zero, so they are the first COBS block and
+  // the type is the third encoded byte; telemetry frames are passed on undecoded
+  if (!request_task || len < 3 || encoded[0] < 3 || encoded[2] != SERIAL_MUX_MSG)
+    return ESP_ERR_NOT_FOUND;
+
+  uint8_t payload[TELEMETRY_FRAME_MAX_PAYLOAD];
+  size_t payload_len;
+  esp_err_t err = telemetry_frame_unwrap(encoded, len, payload, sizeof(payload), &payload_len);
+  if (err != ESP_OK)
+    return err;
+  if (payload_len < SERIAL_MUX_HEADER_SIZE || payload[0] != TELEMETRY_FRAME_VERSION)
+    return ESP_ERR_INVALID_SIZE;
+
+  uint8_t channel = payload[2];
+  uint8_t flags = payload[3];
+  mux_request_t req = {.id = (uint16_t)(payload[4] | (payload[5] << 8)), .framed = true};
+
+  // The device only takes requests, on the control channel
+  if (channel != SERIAL_CHANNEL_CONTROL || !(flags & SERIAL_MUX_FLAG_REQUEST))
+  {
+    static const char unsupported[] = "unsupported channel";
+    send_frame((serial_channel_t)channel, SERIAL_MUX_FLAG_ERROR, req.id, (const uint8_t *)unsupported,
+               sizeof(unsupported) - 1);
+    return ESP_OK;
+  }
+
+  // The body is text without terminator
+  size_t body_len = payload_len - SERIAL_MUX_HEADER_SIZE;
+  memcpy(req.command, payload + SERIAL_MUX_HEADER_SIZE, body_len);
+  req.command[body_len] = '\0';
+
+  if (xQueueSend(request_queue, &req, 0) != pdTRUE)
+  {
+    static const char busy[] = "busy";
+    send_frame(SERIAL_CHANNEL_CONTROL, SERIAL_MUX_FLAG_ERROR, req.id, (const uint8_t *)busy, sizeof(busy) - 1);
+  }
+  return ESP_OK;
+}
+
+esp_err_t serial_mux_run_command(const char *command)
+{
+  if (!request_task || !command)
+    return ESP_ERR_INVALID_STATE;
+
+  mux_request_t req = {.id = 0, .framed = false};
+  strncpy(req.command, command, sizeof(req.command) - 1);
+  req.command[sizeof(req.command) - 1] = '\0';
+  return xQueueSend(request_queue, &req, 0) == pdTRUE ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t serial_mux_send(serial_channel_t channel, uint8_t flags, uint16_t request_id, const void *data,
+                          size_t len)
+{
+  if (!raw_write || (len > 0 && !data))
+    return ESP_ERR_INVALID_STATE;
+
+  const uint8_t *bytes = data;
+  do
+  {
+    size_t n = len < SERIAL_MUX_MAX_BODY ? len : SERIAL_MUX_MAX_BODY;
+    uint8_t frame_flags = n < len ? (flags | SERIAL_MUX_FLAG_MORE) : flags;
+    if (send_frame(channel, frame_flags, request_id, bytes, n) != ESP_OK)
+      return ESP_FAIL;
+    bytes += n;
+    len -= n;
+  } while (len > 0);
+  return ESP_OK;
+}
+
+bool serial_mux_route_write(const void *data, size_t len)
+{
+  if (!request_task || xTaskGetCurrentTaskHandle() != request_task || !active_framed)
+    return false;
+  serial_mux_send(SERIAL_CHANNEL_CONTROL, SERIAL_MUX_FLAG_MORE, active_id, data, len);
+  return true;
+}
+
+uint16_t serial_mux_defer_reply(void)
+{
+  if (!request_task || xTaskGetCurrentTaskHandle() != request_task || !active_framed)
+    return 0;
+  active_deferred = true;
+  return active_id;
+}
+
+esp_err_t serial_mux_reply(uint16_t request_id, const void *data, size_t len, bool last)
+{
+  if (request_id == 0)
+    return serial_data_write(data, len) < 0 ? ESP_FAIL : ESP_OK;
+  return serial_mux_send(SERIAL_CHANNEL_CONTROL, last ? 0 : SERIAL_MUX_FLAG_MORE, request_id, data, len);
+}
+
+#else // CONFIG_SERIAL_MUX
+
+esp_err_t serial_mux_init(serial_mux_dispatch_fn dispatch_fn, serial_mux_write_fn write, bool console_link)
+{
+  (void)dispatch_fn;
+  (void)write;
+  (void)console_link;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t serial_mux_handle_frame(const uint8_t *encoded, size_t len)
+{
+  (void)encoded;
+  (void)len;
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t serial_mux_run_command(const char *command)
+{
+  (void)command;
+  return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t serial_mux_send(serial_channel_t channel, uint8_t flags, uint16_t request_id, const void *data,
+                          size_t len)
+{
+  (void)channel;
+  (void)flags;
+  (void)request_id;
+  (void)data;
+  (void)len;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool serial_mux_route_write(const void *data, size_t len)
+{
+  (void)data;
+  (void)len;
+  return false;
+}
+
+uint16_t serial_mux_defer_reply(void)
+{
+  return 0;
+}
+
+esp_err_t serial_mux_reply(uint16_t request_id, const void *data, size_t len, bool last)
+{
+  (void)request_id;
+  (void)last;
+  return serial_data_write(data, len) < 0 ? ESP_FAIL : ESP_OK;
+}
+
+#endif // CONFIG_SERIAL_MUX
@@ -0,0 +1,129 @@
+/**
+ * @file serial_mux.h
+ * @brief Framed channels for commands, logs and bulk data on the local link
+ *
+ * Text commands, their replies, ESP log output and telemetry all share one
+ * byte stream, which a host can only take apart by guessing. Mux frames
+ * put everything but telemetry into the binary frame envelope of
+ * telemetry_frame.h (0x00 | COBS(payload + CRC16) | 0x00) with a channel
+ * and a request id:
+ *
+ *   offset 0   u8   version (TELEMETRY_FRAME_VERSION)
+ *   offset 1   u8   message type SERIAL_MUX_MSG
+ *   offset 2   u8   channel (serial_channel_t)
+ *   offset 3   u8   flags (SERIAL_MUX_FLAG_*)
+ *   offset 4   u16  request id, 0 for messages nobody asked for
+ *   offset 6   ...  body
+ *
+ * Telemetry frames are channel 0 implicitly and keep their own message
+ * types. On the control channel the host sends a request, a text command
+ * exactly as on the line protocol, with a request id of its choosing.
+ * Requests run one after another on their own task, so a slow command
+ * never holds up telemetry. Everything the command writes with
+ * serial_data_write() comes back as response frames with the same id and
+ * SERIAL_MUX_FLAG_MORE, and a frame without that flag ends the response.
+ * A command that answers later from another task takes its request id
+ * with serial_mux_defer_reply() and ends the response itself.
+ *
+ * The bulk channel carries binary data for a request, e.g. a screenshot,
+ * without base64; the log channel carries ESP log output once the host
+ * sends LOG_CHANNEL ON, on the UART link that shares its pins with the
+ * console. Hosts that never send a mux frame see the link as before.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "telemetry_frame.h"
+
+// =======================================================================
+// PROTOCOL CONSTANTS
+// =======================================================================
+
+#define SERIAL_MUX_MSG 0x10       ///< Message type of mux frames, next to TELEMETRY_MSG_*
+#define SERIAL_MUX_HEADER_SIZE 6  ///< Version, type, channel, flags, request id
+#define SERIAL_MUX_MAX_BODY 240   ///< Body bytes per frame sent, longer messages are split
+#define SERIAL_MUX_REQUEST_MAX (TELEMETRY_FRAME_MAX_PAYLOAD - SERIAL_MUX_HEADER_SIZE - 2) ///< Longest request
+
+#define SERIAL_MUX_FLAG_REQUEST 0x01 ///< Host to device request
+#define SERIAL_MUX_FLAG_MORE 0x02    ///< More frames of this message follow
+#define SERIAL_MUX_FLAG_ERROR 0x04   ///< The request failed or was not understood, the body says why
+
+typedef enum
+{
+  SERIAL_CHANNEL_TELEMETRY = 0, ///< Telemetry frames, never sent as mux frames
+  SERIAL_CHANNEL_CONTROL,       ///< Commands and their responses
+  SERIAL_CHANNEL_LOG,           ///< ESP log output, one frame per line
+  SERIAL_CHANNEL_BULK,          ///< Binary data belonging to a request
+} serial_channel_t;
+
+/** Runs a text command, returns false if it is unknown */
+typedef bool (*serial_mux_dispatch_fn)(const char *command);
+
+/** Writes bytes to the transport, bypassing the reply routing */
+typedef int (*serial_mux_write_fn)(const uint8_t *data, size_t len);
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Start the request task
+ * @param dispatch Runs a command, also for plain text commands queued with serial_mux_run_command()
+ * @param write Raw transport write
+ * @param console_link True if ESP log output goes to the same link, enables LOG_CHANNEL
+ * @return ESP_OK, ESP_ERR_NO_MEM, ESP_ERR_INVALID_STATE if already started,
+ *         ESP_ERR_NOT_SUPPORTED without CONFIG_SERIAL_MUX
+ */
+esp_err_t serial_mux_init(serial_mux_dispatch_fn dispatch, serial_mux_write_fn write, bool console_link);
+
+/**
+ * @brief Take a received frame if it is a mux frame
+ * @param encoded Encoded frame without delimiters
+ * @param len Number of encoded bytes
+ * @return ESP_OK if it was a mux frame and was handled, ESP_ERR_NOT_FOUND for
+ *         any other frame, or the telemetry_frame_unwrap() error of a damaged mux frame
+ * @note Never blocks, requests are queued; a full queue is answered with an error
+ */
+esp_err_t serial_mux_handle_frame(const uint8_t *encoded, size_t len);
+
+/**
+ * @brief Queue a plain text command for the request task, its replies stay plain text
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the task is not running, ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t serial_mux_run_command(const char *command);
+
+/**
+ * @brief Send a message on a channel, split into frames of SERIAL_MUX_MAX_BODY bytes
+ * @param flags SERIAL_MUX_FLAG_* of the message, all but its last frame also get SERIAL_MUX_FLAG_MORE
+ * @return ESP_OK, ESP_FAIL if the transport did not take a frame
+ * @note Any task, not from an ISR; frames of concurrent senders never interleave
+ */
+esp_err_t serial_mux_send(serial_channel_t channel, uint8_t flags, uint16_t request_id, const void *data,
+                          size_t len);
+
+/**
+ * @brief Send a reply as response frames of the current request, for serial_data_write()
+ * @return true if the calling task is handling a mux request and the bytes were sent
+ */
+bool serial_mux_route_write(const void *data, size_t len);
+
+/**
+ * @brief Keep the current request open after the command returns
+ * @return Request id to answer with serial_mux_reply(), 0 if the command did not come in a mux frame
+ * @note Call from the command handler, before handing the work to another task
+ */
+uint16_t serial_mux_defer_reply(void);
+
+/**
+ * @brief Continue or end a deferred response
+ * @param request_id From serial_mux_defer_reply(); 0 writes plain text with serial_data_write()
+ * @param last Ends the response
+ */
+esp_err_t serial_mux_reply(uint16_t request_id, const void *data, size_t len, bool last);
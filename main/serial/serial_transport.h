@@ -0,0 +1,89 @@
+/**
+ * @file serial_transport.h
+ * @brief Byte Transports for the Serial Telemetry Link
+ *
+ * The serial data handler parses a byte stream and does not care where it
+ * comes from. Each backend (UART, USB CDC-ACM) implements this small
+ * interface so the link can be chosen at runtime.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// =======================================================================
+// TRANSPORT INTERFACE
+// =======================================================================
+
+/**
+ * @brief Operations provided by a telemetry transport backend
+ */
+typedef struct
+{
+  const char *name; ///< Short name for logs
+
+  /**
+   * @brief Bring up the hardware and any driver resources
+   * @return ESP_OK on success
+   */
+  esp_err_t (*init)(void);
+
+  /**
+   * @brief Block until bytes arrive or the timeout expires
+   * @param buf Destination buffer
+   * @param size Buffer size
+   * @param timeout Maximum time to wait
+   * @return Number of bytes read, 0 on timeout, -1 if received data was lost
+   *         (the caller should resynchronise its parser)
+   */
+  int (*receive)(uint8_t *buf, size_t size, TickType_t timeout);
+
+  /**
+   * @brief Queue bytes for transmission to the host
+   * @return Number of bytes accepted, -1 on error
+   */
+  int (*write)(const uint8_t *data, size_t len);
+} serial_transport_t;
+
+// =======================================================================
+// BACKENDS
+// =======================================================================
+
+#define SERIAL_UART_DEFAULT_BAUD 115200 ///< Rate the UART starts at and returns to when the host goes away
+
+/**
+ * @brief UART backend (shared with the console on UART0)
+ */
+const serial_transport_t *serial_transport_uart(void);
+
+/**
+ * @brief Change the UART baud rate once what is queued for transmission has gone out
+ *
+ * Input received around the change is dropped, it was sent at either rate.
+ * The console follows the new rate too.
+ *
+ * @param baud New rate
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before init, or the driver error
+ * @note Any task; serial_baud.h negotiates the rate with the host
+ */
+esp_err_t serial_transport_uart_set_baud(uint32_t baud);
+
+/**
+ * @brief Current UART baud rate
+ */
+uint32_t serial_transport_uart_baud(void);
+
+/**
+ * @brief Whether RTS/CTS flow control is active (CONFIG_SERIAL_UART_FLOW_CONTROL with both pins set)
+ */
+bool serial_transport_uart_flow_control(void);
+
+/**
+ * @brief Native USB CDC-ACM backend
+ * @return Backend, or NULL when built without CONFIG_SERIAL_TELEMETRY_USB_CDC
+ */
+const serial_transport_t *serial_transport_usb_cdc(void);
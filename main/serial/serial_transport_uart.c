@@ -0,0 +1,200 @@
+/**
+ * @file serial_transport_uart.c
+ * @brief UART Telemetry Transport
+ *
+ * Event-queue driven UART reception. Pattern detection on '\n' wakes the
+ * reader as soon as a complete line is in the driver ring buffer.
+ *
+ * With RTS/CTS flow control a full ring buffer holds the host off through
+ * RTS instead of losing input, so a starved serial task only slows the
+ * link down. Without it a full buffer is flushed and reported as lost.
+ */
+
+#include "serial_transport.h"
+
+#include "driver/uart.h"
+#include "freertos/queue.h"
+#include "utils/system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+// UART Hardware Configuration
+#define UART_PORT_NUM UART_NUM_0                ///< UART port number
+#define UART_BAUD_RATE SERIAL_UART_DEFAULT_BAUD ///< Communication baud rate at start
+#define UART_DATA_BITS UART_DATA_8_BITS         ///< Data bits per frame
+#define UART_PARITY UART_PARITY_DISABLE         ///< Parity checking
+#define UART_STOP_BITS UART_STOP_BITS_1         ///< Stop bits per frame
+#define UART_SOURCE_CLK UART_SCLK_DEFAULT       ///< Clock source
+
+// Flow control, only with both pins assigned
+#if CONFIG_SERIAL_UART_FLOW_CONTROL && CONFIG_SERIAL_UART_RTS_GPIO >= 0 && CONFIG_SERIAL_UART_CTS_GPIO >= 0
+#define UART_FLOW_CTRL UART_HW_FLOWCTRL_CTS_RTS ///< Flow control
+#define UART_RX_FLOW_THRESH 96                  ///< RX FIFO level (of 128) that deasserts RTS
+#else
+#define UART_FLOW_CTRL UART_HW_FLOWCTRL_DISABLE ///< Flow control
+#define UART_RX_FLOW_THRESH 0
+#endif
+
+// Buffer Management
+#ifdef CONFIG_SERIAL_UART_RX_BUFFER_KB
+#define UART_RX_BUFFER_SIZE (CONFIG_SERIAL_UART_RX_BUFFER_KB * 1024) ///< UART receive ring buffer size
+#else
+#define UART_RX_BUFFER_SIZE 4096
+#endif
+#define UART_DRAIN_TIMEOUT_MS 200 ///< Longest wait for queued output before a rate change
+
+// UART Event Configuration
+#define UART_EVENT_QUEUE_SIZE 20   ///< Driver event queue depth
+#define UART_PATTERN_QUEUE_SIZE 16 ///< Line-end positions remembered by the driver
+#define UART_LINE_END '\n'         ///< Pattern character that completes a line
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static QueueHandle_t uart_event_queue = NULL; ///< UART driver event queue
+static int pending_bytes = 0;                 ///< Bytes announced by the last event, not yet read
+static uint32_t current_baud = UART_BAUD_RATE;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static esp_err_t uart_transport_init(void)
+{
+  uart_config_t uart_config = {
+      .baud_rate = UART_BAUD_RATE,
+      .data_bits = UART_DATA_BITS,
+      .parity = UART_PARITY,
+      .stop_bits = UART_STOP_BITS,
+      .flow_ctrl = UART_FLOW_CTRL,
+      .rx_flow_ctrl_thresh = UART_RX_FLOW_THRESH,
+      .source_clk = UART_SOURCE_CLK,
+  };
+
+  // Install UART driver
+  ESP_ERROR_CHECK(uart_driver_install(UART_PORT_NUM, UART_RX_BUFFER_SIZE, 0, UART_EVENT_QUEUE_SIZE, &uart_event_queue, 0));
+  ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));
+#if CONFIG_SERIAL_UART_FLOW_CONTROL
+  if (UART_FLOW_CTRL == UART_HW_FLOWCTRL_CTS_RTS)
+  {
+    ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, CONFIG_SERIAL_UART_RTS_GPIO,
+                                 CONFIG_SERIAL_UART_CTS_GPIO));
+  }
+  else
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "UART flow control needs both RTS and CTS pins, running without");
+  }
+#endif
+
+  // Raise UART_PATTERN_DET for every line end so the reader wakes once per line
+  ESP_ERROR_CHECK(uart_enable_pattern_det_baud_intr(UART_PORT_NUM, UART_LINE_END, 1, 9, 0, 0));
+  ESP_ERROR_CHECK(uart_pattern_queue_reset(UART_PORT_NUM, UART_PATTERN_QUEUE_SIZE));
+
+  return ESP_OK;
+}
+
+static int uart_buffered_len(void)
+{
+  size_t buffered = 0;
+  uart_get_buffered_data_len(UART_PORT_NUM, &buffered);
+  return (int)buffered;
+}
+
+static int uart_transport_receive(uint8_t *buf, size_t size, TickType_t timeout)
+{
+  while (pending_bytes <= 0)
+  {
+    uart_event_t event;
+    if (xQueueReceive(uart_event_queue, &event, timeout) != pdTRUE)
+      return 0;
+
+    switch (event.type)
+    {
+    case UART_PATTERN_DET:
+    {
+      // A full line is buffered, hand it out up to and including the '\n'
+      int pos = uart_pattern_pop_pos(UART_PORT_NUM);
+      pending_bytes = (pos >= 0) ? pos + 1 : uart_buffered_len(); // -1: already consumed by a data read
+      break;
+    }
+
+    case UART_DATA:
+      // Bytes without a line end yet (partial lines, binary frames)
+      pending_bytes = uart_buffered_len();
+      break;
+
+    case UART_BUFFER_FULL:
+      if (UART_FLOW_CTRL == UART_HW_FLOWCTRL_CTS_RTS)
+      {
+        // RTS holds the host off while the FIFO fills, nothing is lost: drain the ring
+        pending_bytes = uart_buffered_len();
+        break;
+      }
+      // fall through
+    case UART_FIFO_OVF:
+      debug_log_warning(DEBUG_TAG_SERIAL_DATA, "UART RX overflow, flushing input");
+      uart_flush_input(UART_PORT_NUM);
+      xQueueReset(uart_event_queue);
+      pending_bytes = 0;
+      return -1;
+
+    default:
+      break;
+    }
+  }
+
+  int want = pending_bytes < (int)size ? pending_bytes : (int)size;
+  int len = uart_read_bytes(UART_PORT_NUM, buf, want, 0);
+  pending_bytes = (len > 0) ? pending_bytes - len : 0;
+  return len > 0 ? len : 0;
+}
+
+static int uart_transport_write(const uint8_t *data, size_t len)
+{
+  return uart_write_bytes(UART_PORT_NUM, data, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t serial_transport_uart_set_baud(uint32_t baud)
+{
+  if (!uart_event_queue)
+    return ESP_ERR_INVALID_STATE;
+
+  // A reply announcing the change still goes out at the old rate
+  uart_wait_tx_done(UART_PORT_NUM, pdMS_TO_TICKS(UART_DRAIN_TIMEOUT_MS));
+  esp_err_t err = uart_set_baudrate(UART_PORT_NUM, baud);
+  if (err != ESP_OK)
+    return err;
+
+  current_baud = baud;
+  uart_flush_input(UART_PORT_NUM);
+  debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "UART now at %lu baud", (unsigned long)baud);
+  return ESP_OK;
+}
+
+uint32_t serial_transport_uart_baud(void)
+{
+  return current_baud;
+}
+
+bool serial_transport_uart_flow_control(void)
+{
+  return UART_FLOW_CTRL == UART_HW_FLOWCTRL_CTS_RTS;
+}
+
+const serial_transport_t *serial_transport_uart(void)
+{
+  static const serial_transport_t transport = {
+      .name = "UART",
+      .init = uart_transport_init,
+      .receive = uart_transport_receive,
+      .write = uart_transport_write,
+  };
+  return &transport;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file serial_transport_usb_cdc.c
+ * @brief Native USB CDC-ACM Telemetry Transport
+ *
+ * Runs the telemetry link over the ESP32-S3 USB OTG peripheral (GPIO19/20)
+ * with TinyUSB. There is no baud rate limit, and the console stays on UART0,
+ * so log output never interleaves with data frames.
+ */
+
+#include "serial_transport.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_SERIAL_TELEMETRY_USB_CDC
+
+#include "freertos/stream_buffer.h"
+#include "tinyusb.h"
+#include "tusb_cdc_acm.h"
+#include "utils/system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define CDC_RX_STREAM_SIZE 4096 ///< Bytes buffered between the USB task and the reader
+#define CDC_PORT TINYUSB_CDC_ACM_0
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static StreamBufferHandle_t rx_stream = NULL; ///< Received bytes waiting for the reader
+static volatile bool rx_overflow = false;     ///< Set when the stream buffer had no room
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief TinyUSB RX callback, runs in the TinyUSB task
+ */
+static void cdc_rx_callback(int itf, cdcacm_event_t *event)
+{
+  uint8_t buf[CONFIG_TINYUSB_CDC_RX_BUFSIZE];
+  size_t rx_size = 0;
+
+  if (tinyusb_cdcacm_read(itf, buf, sizeof(buf), &rx_size) != ESP_OK || rx_size == 0)
+    return;
+
+  if (xStreamBufferSend(rx_stream, buf, rx_size, 0) != rx_size)
+  {
+    rx_overflow = true;
+  }
+}
+
+static esp_err_t cdc_transport_init(void)
+{
+  rx_stream = xStreamBufferCreate(CDC_RX_STREAM_SIZE, 1);
+  if (!rx_stream)
+    return ESP_ERR_NO_MEM;
+
+  const tinyusb_config_t tusb_cfg = {
+      .device_descriptor = NULL, // Kconfig defaults
+      .string_descriptor = NULL,
+      .external_phy = false,
+      .configuration_descriptor = NULL,
+  };
+  esp_err_t ret = tinyusb_driver_install(&tusb_cfg);
+  if (ret != ESP_OK)
+    return ret;
+
+  const tinyusb_config_cdcacm_t acm_cfg = {
+      .usb_dev = TINYUSB_USBDEV_0,
+      .cdc_port = CDC_PORT,
+      .rx_unread_buf_sz = 64,
+      .callback_rx = cdc_rx_callback,
+      .callback_rx_wanted_char = NULL,
+      .callback_line_state_changed = NULL,
+      .callback_line_coding_changed = NULL,
+  };
+  return tusb_cdc_acm_init(&acm_cfg);
+}
+
+static int cdc_transport_receive(uint8_t *buf, size_t size, TickType_t timeout)
+{
+  if (rx_overflow)
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "USB CDC RX overflow, dropping buffered input");
+    xStreamBufferReset(rx_stream);
+    rx_overflow = false;
+    return -1;
+  }
+
+  return (int)xStreamBufferReceive(rx_stream, buf, size, timeout);
+}
+
+static int cdc_transport_write(const uint8_t *data, size_t len)
+{
+  size_t queued = tinyusb_cdcacm_write_queue(CDC_PORT, data, len);
+  tinyusb_cdcacm_write_flush(CDC_PORT, 0);
+  return (int)queued;
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+const serial_transport_t *serial_transport_usb_cdc(void)
+{
+  static const serial_transport_t transport = {
+      .name = "USB CDC",
+      .init = cdc_transport_init,
+      .receive = cdc_transport_receive,
+      .write = cdc_transport_write,
+  };
+  return &transport;
+}
+
+#else
+
+const serial_transport_t *serial_transport_usb_cdc(void)
+{
+  return NULL;
+}
+
+#endif // CONFIG_SERIAL_TELEMETRY_USB_CDC
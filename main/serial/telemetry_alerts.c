@@ -0,0 +1,382 @@
+/**
+ * @file telemetry_alerts.c
+ * @brief Threshold alerts on CPU/GPU temperature and usage
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "telemetry_alerts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// Also the names of GET_ALERTS, SET_ALERT and the alert sounds
+static const char *const alert_names[TELEMETRY_ALERT_COUNT] = {
+    [TELEMETRY_ALERT_CPU_TEMP] = "cpu_temp",
+    [TELEMETRY_ALERT_CPU_USAGE] = "cpu_usage",
+    [TELEMETRY_ALERT_GPU_TEMP] = "gpu_temp",
+    [TELEMETRY_ALERT_GPU_USAGE] = "gpu_usage",
+};
+
+#if CONFIG_TELEMETRY_ALERTS
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  uint8_t raise;
+  uint8_t clear;
+} alert_threshold_t;
+
+typedef struct
+{
+  uint8_t source_id;
+  uint8_t alert;
+  bool active;
+  int16_t value; ///< -1 when cleared without a sample
+  uint16_t changes;
+} batch_entry_t;
+
+static const uint32_t alert_fields[TELEMETRY_ALERT_COUNT] = {
+    [TELEMETRY_ALERT_CPU_TEMP] = SYSTEM_DATA_FIELD_CPU_TEMP,
+    [TELEMETRY_ALERT_CPU_USAGE] = SYSTEM_DATA_FIELD_CPU_USAGE,
+    [TELEMETRY_ALERT_GPU_TEMP] = SYSTEM_DATA_FIELD_GPU_TEMP,
+    [TELEMETRY_ALERT_GPU_USAGE] = SYSTEM_DATA_FIELD_GPU_USAGE,
+};
+
+// Sources feed from their own transport tasks, the batch is drained by the esp_timer task
+static portMUX_TYPE alerts_lock = portMUX_INITIALIZER_UNLOCKED;
+static alert_threshold_t thresholds[TELEMETRY_ALERT_COUNT];
+static uint32_t active_masks[CONFIG_SERIAL_MAX_SOURCES];
+
+static batch_entry_t batch[TELEMETRY_ALERT_BATCH_MAX];
+static int batch_count = 0;
+static uint32_t batch_dropped = 0;
+static esp_timer_handle_t batch_timer = NULL;
+static volatile telemetry_alert_sink_t alert_sink = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static alert_threshold_t default_threshold(int raise)
+{
+  int clear = raise - CONFIG_TELEMETRY_ALERT_HYSTERESIS;
+  return (alert_threshold_t){.raise = (uint8_t)raise, .clear = (uint8_t)(clear > 0 ? clear : 0)};
+}
+
+static int alert_value(telemetry_alert_t alert, const system_data_t *data)
+{
+  switch (alert)
+  {
+  case TELEMETRY_ALERT_CPU_TEMP:
+    return data->cpu.temp;
+  case TELEMETRY_ALERT_CPU_USAGE:
+    return data->cpu.usage;
+  case TELEMETRY_ALERT_GPU_TEMP:
+    return data->gpu.temp;
+  case TELEMETRY_ALERT_GPU_USAGE:
+    return data->gpu.usage;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Record a transition in the open batch (alerts_lock held)
+ * @return true if this opened the batch and the timer has to be started
+ */
+static bool batch_add(uint8_t source_id, telemetry_alert_t alert, bool active, int value)
+{
+  for (int i = 0; i < batch_count; i++)
+  {
+    batch_entry_t *entry = &batch[i];
+    if (entry->source_id == source_id && entry->alert == alert)
+    {
+      entry->active = active;
+      entry->value = (int16_t)value;
+      entry->changes++;
+      return false;
+    }
+  }
+
+  if (batch_count >= TELEMETRY_ALERT_BATCH_MAX)
+  {
+    batch_dropped++;
+    return false;
+  }
+  batch[batch_count++] = (batch_entry_t){
+      .source_id = source_id, .alert = (uint8_t)alert, .active = active, .value = (int16_t)value, .changes = 1};
+  return batch_count == 1;
+}
+
+static void start_batch_timer(void)
+{
+  if (batch_timer && esp_timer_start_once(batch_timer, (uint64_t)TELEMETRY_ALERT_BATCH_S * 1000000) != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Alert batch timer not started");
+  }
+}
+
+static void batch_timer_cb(void *arg)
+{
+  static batch_entry_t entries[TELEMETRY_ALERT_BATCH_MAX];
+  static char json[2048];
+
+  portENTER_CRITICAL(&alerts_lock);
+  int count = batch_count;
+  uint32_t dropped = batch_dropped;
+  memcpy(entries, batch, sizeof(batch_entry_t) * count);
+  batch_count = 0;
+  batch_dropped = 0;
+  portEXIT_CRITICAL(&alerts_lock);
+
+  if (dropped)
+  {
+    debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "%lu alert transitions did not fit the batch", (unsigned long)dropped);
+  }
+
+  telemetry_alert_sink_t sink = alert_sink;
+  if (count == 0 || !sink)
+    return;
+
+  size_t len = (size_t)snprintf(json, sizeof(json), "{\"alerts\":[");
+  for (int i = 0; i < count && len < sizeof(json); i++)
+  {
+    const batch_entry_t *entry = &entries[i];
+    char value[8] = "null";
+    if (entry->value >= 0)
+    {
+      snprintf(value, sizeof(value), "%d", entry->value);
+    }
+    len += (size_t)snprintf(json + len, sizeof(json) - len,
+                            "%s{\"source\":\"%s\",\"alert\":\"%s\",\"active\":%s,\"value\":%s,\"threshold\":%u,"
+                            "\"changes\":%u}",
+                            i ? "," : "", serial_data_get_source_name(entry->source_id), alert_names[entry->alert],
+                            entry->active ? "true" : "false", value, thresholds[entry->alert].raise, entry->changes);
+  }
+  if (len + 3 > sizeof(json))
+  {
+    debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Alert batch too long, dropped");
+    return;
+  }
+  memcpy(json + len, "]}", 3);
+  sink(json);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "ALERTS {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+#endif // CONFIG_TELEMETRY_ALERTS
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t telemetry_alerts_init(void)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  thresholds[TELEMETRY_ALERT_CPU_TEMP] = default_threshold(CONFIG_TELEMETRY_ALERT_CPU_TEMP);
+  thresholds[TELEMETRY_ALERT_CPU_USAGE] = default_threshold(CONFIG_TELEMETRY_ALERT_CPU_USAGE);
+  thresholds[TELEMETRY_ALERT_GPU_TEMP] = default_threshold(CONFIG_TELEMETRY_ALERT_GPU_TEMP);
+  thresholds[TELEMETRY_ALERT_GPU_USAGE] = default_threshold(CONFIG_TELEMETRY_ALERT_GPU_USAGE);
+
+  if (!batch_timer)
+  {
+    const esp_timer_create_args_t args = {.callback = batch_timer_cb, .name = "alert_batch"};
+    if (esp_timer_create(&args, &batch_timer) != ESP_OK)
+    {
+      debug_log_error(DEBUG_TAG_SERIAL_DATA, "Failed to create alert batch timer");
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t telemetry_alerts_evaluate(uint8_t source_id, const system_data_t *data, uint32_t changed_fields)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (!data || source_id >= CONFIG_SERIAL_MAX_SOURCES)
+    return 0;
+
+  bool start_timer = false;
+  portENTER_CRITICAL(&alerts_lock);
+  uint32_t mask = active_masks[source_id];
+  for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+  {
+    const alert_threshold_t *t = &thresholds[alert];
+    if (!(changed_fields & alert_fields[alert]) || t->raise == 0)
+      continue;
+
+    int value = alert_value(alert, data);
+    bool was_active = mask & (1u << alert);
+    bool active = was_active ? value >= t->clear : value >= t->raise;
+    if (active == was_active)
+      continue;
+
+    mask ^= 1u << alert;
+    start_timer |= batch_add(source_id, alert, active, value);
+  }
+  active_masks[source_id] = mask;
+  portEXIT_CRITICAL(&alerts_lock);
+
+  if (start_timer)
+  {
+    start_batch_timer();
+  }
+  return mask;
+#else
+  return 0;
+#endif
+}
+
+void telemetry_alerts_clear(uint8_t source_id)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES)
+    return;
+
+  bool start_timer = false;
+  portENTER_CRITICAL(&alerts_lock);
+  uint32_t mask = active_masks[source_id];
+  active_masks[source_id] = 0;
+  for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+  {
+    if (mask & (1u << alert))
+    {
+      start_timer |= batch_add(source_id, alert, false, -1);
+    }
+  }
+  portEXIT_CRITICAL(&alerts_lock);
+
+  if (start_timer)
+  {
+    start_batch_timer();
+  }
+#endif
+}
+
+uint32_t telemetry_alerts_get_active(uint8_t source_id)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (source_id >= CONFIG_SERIAL_MAX_SOURCES)
+    return 0;
+
+  portENTER_CRITICAL(&alerts_lock);
+  uint32_t mask = active_masks[source_id];
+  portEXIT_CRITICAL(&alerts_lock);
+  return mask;
+#else
+  return 0;
+#endif
+}
+
+esp_err_t telemetry_alerts_set_threshold(telemetry_alert_t alert, uint8_t raise, uint8_t clear)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (alert >= TELEMETRY_ALERT_COUNT || clear > raise)
+    return ESP_ERR_INVALID_ARG;
+
+  // Active alerts keep their state and follow the new levels from the next sample
+  portENTER_CRITICAL(&alerts_lock);
+  thresholds[alert] = (alert_threshold_t){.raise = raise, .clear = clear};
+  portEXIT_CRITICAL(&alerts_lock);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void telemetry_alerts_register_sink(telemetry_alert_sink_t sink)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  alert_sink = sink;
+#endif
+}
+
+const char *telemetry_alerts_name(telemetry_alert_t alert)
+{
+  return alert < TELEMETRY_ALERT_COUNT ? alert_names[alert] : "unknown";
+}
+
+bool telemetry_alerts_handle_command(const char *line)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (strncmp(line, "SET_ALERT ", 10) == 0)
+  {
+    char name[16];
+    unsigned raise = 0, clear = 0;
+    if (sscanf(line + 10, "%15s %u %u", name, &raise, &clear) != 3 || raise > 255)
+    {
+      reply_error("usage: SET_ALERT <name> <raise> <clear>");
+      return true;
+    }
+    for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+    {
+      if (strcmp(name, alert_names[alert]) == 0)
+      {
+        if (telemetry_alerts_set_threshold(alert, (uint8_t)raise, (uint8_t)clear) != ESP_OK)
+        {
+          reply_error("clear must not exceed raise");
+          return true;
+        }
+        static const char ok[] = "ALERTS {\"ok\":true}\n";
+        serial_data_write(ok, sizeof(ok) - 1);
+        return true;
+      }
+    }
+    reply_error("unknown alert");
+    return true;
+  }
+  if (strcmp(line, "GET_ALERTS") != 0)
+    return false;
+
+  char buf[128];
+  int len = snprintf(buf, sizeof(buf), "ALERTS {\"batch_s\":%d,\"thresholds\":[", TELEMETRY_ALERT_BATCH_S);
+  serial_data_write(buf, len);
+  for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+  {
+    portENTER_CRITICAL(&alerts_lock);
+    alert_threshold_t t = thresholds[alert];
+    portEXIT_CRITICAL(&alerts_lock);
+    len = snprintf(buf, sizeof(buf), "%s{\"alert\":\"%s\",\"raise\":%u,\"clear\":%u}", alert ? "," : "",
+                   alert_names[alert], t.raise, t.clear);
+    serial_data_write(buf, len);
+  }
+
+  serial_data_write("],\"active\":[", 12);
+  bool first = true;
+  for (uint8_t source_id = 0; source_id < CONFIG_SERIAL_MAX_SOURCES; source_id++)
+  {
+    uint32_t mask = telemetry_alerts_get_active(source_id);
+    for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+    {
+      if (!(mask & (1u << alert)))
+        continue;
+      len = snprintf(buf, sizeof(buf), "%s{\"source\":\"%s\",\"alert\":\"%s\"}", first ? "" : ",",
+                     serial_data_get_source_name(source_id), alert_names[alert]);
+      serial_data_write(buf, len);
+      first = false;
+    }
+  }
+  serial_data_write("]}\n", 3);
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,126 @@
+/**
+ * @file telemetry_alerts.h
+ * @brief Threshold alerts on CPU/GPU temperature and usage
+ *
+ * Every received sample is checked against per-metric thresholds with
+ * hysteresis: an alert raises when the value reaches its raise level and
+ * only clears once the value drops below its clear level, so a reading
+ * hovering at the threshold does not flap. Each telemetry source keeps its
+ * own alert state.
+ *
+ * Raise and clear transitions are collected for TELEMETRY_ALERT_BATCH_S
+ * after the first one and handed to the event sink as a single JSON
+ * document, e.g. for one Home Assistant event per batch. A metric that
+ * flaps inside a batch is reported once with its latest state and the
+ * number of changes.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dashboard_data.h"
+#include "esp_err.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Transitions collected into one event
+#ifdef CONFIG_TELEMETRY_ALERT_BATCH_S
+#define TELEMETRY_ALERT_BATCH_S CONFIG_TELEMETRY_ALERT_BATCH_S
+#else
+#define TELEMETRY_ALERT_BATCH_S 30
+#endif
+
+// Distinct source/alert pairs one batch can hold, later ones are dropped
+#define TELEMETRY_ALERT_BATCH_MAX 16
+
+// =======================================================================
+// TYPES
+// =======================================================================
+
+/**
+ * @brief Alerted metrics, also the bit positions of an active mask
+ */
+typedef enum
+{
+  TELEMETRY_ALERT_CPU_TEMP,  ///< Celsius
+  TELEMETRY_ALERT_CPU_USAGE, ///< Percent
+  TELEMETRY_ALERT_GPU_TEMP,  ///< Celsius
+  TELEMETRY_ALERT_GPU_USAGE, ///< Percent
+  TELEMETRY_ALERT_COUNT
+} telemetry_alert_t;
+
+/**
+ * @brief Receives a batch of transitions
+ * @param event_json {"alerts":[{"source":..,"alert":..,"active":..,"value":..,"threshold":..,"changes":..}]},
+ *                   only valid during the call
+ * @note Runs in the esp_timer task, must not block
+ */
+typedef void (*telemetry_alert_sink_t)(const char *event_json);
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Load the menuconfig thresholds and create the batch timer
+ * @return ESP_OK, ESP_ERR_NO_MEM if the timer cannot be created,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_TELEMETRY_ALERTS is disabled
+ */
+esp_err_t telemetry_alerts_init(void);
+
+/**
+ * @brief Check a received sample
+ * @param source_id Telemetry source the sample came from
+ * @param data Sample
+ * @param changed_fields SYSTEM_DATA_FIELD_* bits that changed, other metrics keep their state
+ * @return Active alerts of the source, one bit per telemetry_alert_t
+ * @note Called from the telemetry ingest path, any task
+ */
+uint32_t telemetry_alerts_evaluate(uint8_t source_id, const system_data_t *data, uint32_t changed_fields);
+
+/**
+ * @brief Drop all alerts of a source, e.g. after it disconnected
+ * @param source_id Telemetry source
+ * @note Active alerts are reported as cleared in the next batch
+ */
+void telemetry_alerts_clear(uint8_t source_id);
+
+/**
+ * @brief Active alerts of a source
+ * @param source_id Telemetry source
+ * @return One bit per telemetry_alert_t
+ */
+uint32_t telemetry_alerts_get_active(uint8_t source_id);
+
+/**
+ * @brief Change the thresholds of one alert until reboot
+ * @param alert Alert
+ * @param raise Level at which the alert raises, 0 disables it
+ * @param clear Level below which it clears again, at most raise
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG
+ */
+esp_err_t telemetry_alerts_set_threshold(telemetry_alert_t alert, uint8_t raise, uint8_t clear);
+
+/**
+ * @brief Register where batches go
+ * @param sink Called once per batch, NULL drops batches
+ */
+void telemetry_alerts_register_sink(telemetry_alert_sink_t sink);
+
+/**
+ * @brief Name of an alert as GET_ALERTS shows it, e.g. "cpu_temp"
+ */
+const char *telemetry_alerts_name(telemetry_alert_t alert);
+
+/**
+ * @brief Handle GET_ALERTS and SET_ALERT <name> <raise> <clear>
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was an alert command
+ */
+bool telemetry_alerts_handle_command(const char *line);
@@ -0,0 +1,304 @@
+/**
+ * @file telemetry_clock.c
+ * @brief Host clock estimate for the local telemetry link
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "telemetry_clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial_data_handler.h"
+#include "utils/system_debug_utils.h"
+
+#if CONFIG_TELEMETRY_CLOCK_SYNC
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define CLOCK_FAST_EXCHANGES 4           ///< Exchanges sent at the fast interval after the link comes up
+#define CLOCK_FAST_INTERVAL_US 2000000LL ///< Interval until the window has a few entries
+#define CLOCK_IDLE_INTERVAL_US 60000000LL ///< Interval once the host stopped answering
+#define CLOCK_IDLE_AFTER_UNANSWERED 3    ///< Consecutive timeouts before backing off
+#define CLOCK_SKEW_MIN_SPAN_US 20000000LL ///< Shortest window the skew is fitted over
+#define CLOCK_SKEW_MAX_PPB 500000        ///< Fits beyond 500 ppm are noise, not crystals
+#define CLOCK_RTT_SLACK_US 2000          ///< Exchanges within 2x + this of the best take part in the fit
+
+typedef struct
+{
+  int64_t device_us; ///< Midpoint of the exchange on the device clock
+  int64_t offset_us; ///< Host minus device time
+  uint32_t rtt_us;
+} clock_exchange_t;
+
+// Polled and fed replies by the serial task, reset by the staleness timer in the esp_timer task
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static clock_exchange_t window[TELEMETRY_CLOCK_WINDOW];
+static int window_count = 0;
+static int window_next = 0;
+
+static int64_t ref_device_us = 0; ///< Device time the offset applies at
+static telemetry_clock_status_t status;
+
+static uint32_t request_seq = 0;
+static bool request_pending = false;
+static int64_t request_sent_us = 0;
+static int64_t next_request_us = 0;
+static uint32_t unanswered_in_row = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Recompute offset and skew from the window, clock_lock held
+ */
+static void update_estimate(void)
+{
+  const clock_exchange_t *best = &window[0];
+  for (int i = 1; i < window_count; i++)
+  {
+    if (window[i].rtt_us < best->rtt_us)
+      best = &window[i];
+  }
+  ref_device_us = best->device_us;
+  status.offset_us = best->offset_us;
+  status.rtt_us = best->rtt_us;
+
+  // Fit the offset drift over the exchanges that were about as fast as the best one
+  uint32_t rtt_limit = best->rtt_us * 2 + CLOCK_RTT_SLACK_US;
+  int n = 0;
+  float sum_x = 0, sum_y = 0;
+  int64_t first_us = INT64_MAX, last_us = INT64_MIN;
+  for (int i = 0; i < window_count; i++)
+  {
+    if (window[i].rtt_us > rtt_limit)
+      continue;
+    sum_x += (float)(window[i].device_us - ref_device_us) / 1e6f;
+    sum_y += (float)(window[i].offset_us - best->offset_us);
+    first_us = window[i].device_us < first_us ? window[i].device_us : first_us;
+    last_us = window[i].device_us > last_us ? window[i].device_us : last_us;
+    n++;
+  }
+  if (n < 3 || last_us - first_us < CLOCK_SKEW_MIN_SPAN_US)
+    return; // Keep the previous skew
+
+  float mean_x = sum_x / n, mean_y = sum_y / n;
+  float sxx = 0, sxy = 0;
+  for (int i = 0; i < window_count; i++)
+  {
+    if (window[i].rtt_us > rtt_limit)
+      continue;
+    float dx = (float)(window[i].device_us - ref_device_us) / 1e6f - mean_x;
+    float dy = (float)(window[i].offset_us - best->offset_us) - mean_y;
+    sxx += dx * dx;
+    sxy += dx * dy;
+  }
+
+  // Microseconds of drift per second are ppm
+  float skew_ppb = sxx > 0 ? sxy / sxx * 1000.0f : 0;
+  if (skew_ppb > CLOCK_SKEW_MAX_PPB)
+    skew_ppb = CLOCK_SKEW_MAX_PPB;
+  if (skew_ppb < -CLOCK_SKEW_MAX_PPB)
+    skew_ppb = -CLOCK_SKEW_MAX_PPB;
+  status.skew_ppb = (int32_t)skew_ppb;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void telemetry_clock_poll(void)
+{
+  int64_t now_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&clock_lock);
+  if (request_pending && now_us - request_sent_us > TELEMETRY_CLOCK_REPLY_TIMEOUT_MS * 1000LL)
+  {
+    request_pending = false;
+    status.unanswered++;
+    unanswered_in_row++;
+  }
+  bool due = !request_pending && now_us >= next_request_us;
+  if (due)
+  {
+    int64_t interval_us = (int64_t)CONFIG_TELEMETRY_CLOCK_SYNC_INTERVAL_S * 1000000LL;
+    if (unanswered_in_row >= CLOCK_IDLE_AFTER_UNANSWERED)
+      interval_us = CLOCK_IDLE_INTERVAL_US;
+    else if (status.exchanges < CLOCK_FAST_EXCHANGES)
+      interval_us = CLOCK_FAST_INTERVAL_US;
+    next_request_us = now_us + interval_us;
+    request_seq++;
+    request_pending = true;
+  }
+  uint32_t seq = request_seq;
+  portEXIT_CRITICAL(&clock_lock);
+
+  if (!due)
+    return;
+
+  char request[48];
+  int len = snprintf(request, sizeof(request), "TIME_SYNC {\"seq\":%lu}\n", (unsigned long)seq);
+  // The send time is taken last, queueing behind other output only lengthens the round trip
+  int64_t sent_us = esp_timer_get_time();
+  portENTER_CRITICAL(&clock_lock);
+  request_sent_us = sent_us;
+  portEXIT_CRITICAL(&clock_lock);
+  serial_data_write(request, len);
+}
+
+void telemetry_clock_reset(void)
+{
+  portENTER_CRITICAL(&clock_lock);
+  window_count = 0;
+  window_next = 0;
+  ref_device_us = 0;
+  memset(&status, 0, sizeof(status));
+  request_pending = false;
+  next_request_us = 0;
+  unanswered_in_row = 0;
+  portEXIT_CRITICAL(&clock_lock);
+}
+
+bool telemetry_clock_handle_reply(const char *line)
+{
+  static const char prefix[] = "TIME_SYNC_REPLY ";
+  if (strncmp(line, prefix, sizeof(prefix) - 1) != 0)
+    return false;
+
+  int64_t received_us = esp_timer_get_time();
+  char *end;
+  const char *p = line + sizeof(prefix) - 1;
+  unsigned long seq = strtoul(p, &end, 10);
+  bool valid = end != p;
+  p = end;
+  double host_rx_ms = strtod(p, &end);
+  valid = valid && end != p;
+  p = end;
+  double host_tx_ms = strtod(p, &end);
+  valid = valid && end != p && host_tx_ms >= host_rx_ms;
+
+  portENTER_CRITICAL(&clock_lock);
+  // Late replies to earlier requests are ignored and leave the current one waiting
+  bool current = request_pending && seq == request_seq;
+  valid = valid && current;
+  int64_t rtt_us = 0;
+  if (valid)
+  {
+    // NTP: round trip without the host's turnaround, offset from the midpoints
+    int64_t host_rx_us = (int64_t)(host_rx_ms * 1000.0);
+    int64_t host_tx_us = (int64_t)(host_tx_ms * 1000.0);
+    rtt_us = (received_us - request_sent_us) - (host_tx_us - host_rx_us);
+    valid = rtt_us >= 0 && rtt_us <= TELEMETRY_CLOCK_MAX_RTT_US;
+    if (valid)
+    {
+      clock_exchange_t *entry = &window[window_next];
+      entry->device_us = request_sent_us + (received_us - request_sent_us) / 2;
+      entry->offset_us = ((host_rx_us - request_sent_us) + (host_tx_us - received_us)) / 2;
+      entry->rtt_us = (uint32_t)rtt_us;
+      window_next = (window_next + 1) % TELEMETRY_CLOCK_WINDOW;
+      if (window_count < TELEMETRY_CLOCK_WINDOW)
+        window_count++;
+      status.exchanges++;
+      status.synced = true;
+      unanswered_in_row = 0;
+      update_estimate();
+    }
+  }
+  if (current)
+  {
+    if (!valid)
+      status.unanswered++;
+    request_pending = false;
+  }
+  portEXIT_CRITICAL(&clock_lock);
+
+  if (!valid)
+  {
+    debug_log_debug_f(DEBUG_TAG_SERIAL_DATA, "Ignored time sync reply: %.48s", line);
+  }
+  return true;
+}
+
+bool telemetry_clock_host_time_ms(int64_t device_us, uint64_t *host_ms)
+{
+  portENTER_CRITICAL(&clock_lock);
+  bool synced = status.synced;
+  int64_t host_us = device_us + status.offset_us + (device_us - ref_device_us) * status.skew_ppb / 1000000000LL;
+  portEXIT_CRITICAL(&clock_lock);
+
+  if (synced && host_ms)
+    *host_ms = (uint64_t)(host_us / 1000);
+  return synced;
+}
+
+void telemetry_clock_get_status(telemetry_clock_status_t *out)
+{
+  if (!out)
+    return;
+  portENTER_CRITICAL(&clock_lock);
+  *out = status;
+  portEXIT_CRITICAL(&clock_lock);
+}
+
+#else
+
+void telemetry_clock_poll(void)
+{
+}
+
+void telemetry_clock_reset(void)
+{
+}
+
+bool telemetry_clock_handle_reply(const char *line)
+{
+  (void)line;
+  return false;
+}
+
+bool telemetry_clock_host_time_ms(int64_t device_us, uint64_t *host_ms)
+{
+  (void)device_us;
+  (void)host_ms;
+  return false;
+}
+
+void telemetry_clock_get_status(telemetry_clock_status_t *out)
+{
+  if (out)
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // CONFIG_TELEMETRY_CLOCK_SYNC
+
+bool telemetry_clock_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TIME_SYNC") != 0)
+    return false;
+
+#if CONFIG_TELEMETRY_CLOCK_SYNC
+  telemetry_clock_status_t s;
+  telemetry_clock_get_status(&s);
+  uint64_t host_ms = 0;
+  telemetry_clock_host_time_ms(esp_timer_get_time(), &host_ms);
+
+  char reply[224];
+  int len = snprintf(reply, sizeof(reply),
+                     "TIME_SYNC_STATUS {\"synced\":%s,\"host_ms\":%llu,\"offset_ms\":%lld,\"skew_ppm\":%.2f,"
+                     "\"rtt_ms\":%.2f,\"exchanges\":%lu,\"unanswered\":%lu}\n",
+                     s.synced ? "true" : "false", (unsigned long long)host_ms, (long long)(s.offset_us / 1000),
+                     s.skew_ppb / 1000.0, s.rtt_us / 1000.0, (unsigned long)s.exchanges, (unsigned long)s.unanswered);
+  serial_data_write(reply, len);
+#else
+  static const char disabled[] = "TIME_SYNC_STATUS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
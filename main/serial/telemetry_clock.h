@@ -0,0 +1,98 @@
+/**
+ * @file telemetry_clock.h
+ * @brief Host clock estimate for the local telemetry link
+ *
+ * The dashboard has no wall clock of its own before SNTP, and sample
+ * timestamps come from the host's clock anyway. While the local source is
+ * connected the device asks the host for its time NTP-style:
+ *
+ *   device -> host   TIME_SYNC {"seq":7}
+ *   host -> device   TIME_SYNC_REPLY 7 <t1> <t2>
+ *
+ * t1 is the host's epoch time in ms (fractions allowed) when the request
+ * arrived, t2 when the reply was sent. With the device's own send and
+ * receive times this gives the round trip and the host-minus-device
+ * offset. The exchange with the shortest round trip in the recent window
+ * sets the offset, and a least-squares fit over the good exchanges gives
+ * the skew between the two crystals, so the estimate stays usable between
+ * exchanges. Hosts that never reply are asked less and less often.
+ *
+ * Remote sources are not synced, they have their own clocks and no
+ * return channel.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define TELEMETRY_CLOCK_WINDOW 8            ///< Exchanges the estimate is taken from
+#define TELEMETRY_CLOCK_MAX_RTT_US 1000000  ///< Replies slower than this are discarded
+#define TELEMETRY_CLOCK_REPLY_TIMEOUT_MS 2000 ///< A request without reply by then counts as unanswered
+
+// =======================================================================
+// TYPES
+// =======================================================================
+
+/**
+ * @brief Current estimate, for diagnostics
+ */
+typedef struct
+{
+  bool synced;         ///< At least one valid exchange since the link came up
+  int64_t offset_us;   ///< Host epoch time minus esp_timer time at the reference exchange
+  int32_t skew_ppb;    ///< Host clock rate minus device clock rate
+  uint32_t rtt_us;     ///< Round trip of the reference exchange
+  uint32_t exchanges;  ///< Valid replies since the link came up
+  uint32_t unanswered; ///< Requests that timed out or got an invalid reply
+} telemetry_clock_status_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Send a sync request when one is due
+ * @note Call on each line or frame of the local source, it rate-limits itself
+ */
+void telemetry_clock_poll(void);
+
+/**
+ * @brief Forget the estimate, e.g. because the local link went down
+ */
+void telemetry_clock_reset(void);
+
+/**
+ * @brief Handle a TIME_SYNC_REPLY line from the local link
+ * @param line Trimmed line
+ * @return true if the line was a sync reply (valid or not)
+ */
+bool telemetry_clock_handle_reply(const char *line);
+
+/**
+ * @brief Host epoch time at a device time
+ * @param device_us esp_timer_get_time() value
+ * @param host_ms Output host epoch time in ms
+ * @return false while not synced
+ */
+bool telemetry_clock_host_time_ms(int64_t device_us, uint64_t *host_ms);
+
+/**
+ * @brief Copy the current estimate
+ */
+void telemetry_clock_get_status(telemetry_clock_status_t *status);
+
+/**
+ * @brief Handle GET_TIME_SYNC
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a clock command
+ */
+bool telemetry_clock_handle_command(const char *line);
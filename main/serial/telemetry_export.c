@@ -0,0 +1,187 @@
+/**
+ * @file telemetry_export.c
+ * @brief History Export over the Local Link Implementation
+ *
+ * The stores hand over text or blocks through a write callback; this module
+ * only frames them for the link. Its buffers are static, so an export takes
+ * nothing from the heap beyond the task.
+ */
+
+#include "telemetry_export.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/base64.h"
+#include "serial_data_handler.h"
+#include "serial_mux.h"
+#include "telemetry_history.h"
+#include "telemetry_sd_log.h"
+#include "utils/task_plan.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define EXPORT_CHUNK_BYTES 768 ///< Data bytes per EXPORT_DATA line
+#define EXPORT_LINE_BYTES (sizeof("EXPORT_DATA ") + ((EXPORT_CHUNK_BYTES + 2) / 3) * 4 + 1)
+#define EXPORT_SOURCE_SD (-1)  ///< Source value of the card log, tiers count from 0
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static portMUX_TYPE export_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool export_running = false;
+
+// The running export, set before its task starts
+static int export_source = EXPORT_SOURCE_SD;
+static bool export_binary = false;
+static uint64_t export_from_ms = 0;
+static uint64_t export_to_ms = 0;
+static uint16_t export_request = 0; ///< Mux request the export answers, 0 on the line protocol
+static uint32_t export_bytes = 0;
+static uint32_t export_crc = 0;
+
+static EXT_RAM_BSS_ATTR char export_line[EXPORT_LINE_BYTES];
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static const char *source_name(int source)
+{
+  return source == EXPORT_SOURCE_SD ? "sd" : telemetry_history_tier_name(source);
+}
+
+/**
+ * @brief Sink for the stores, sends the data as it comes
+ */
+static esp_err_t export_write(void *ctx, const void *data, size_t len)
+{
+  export_bytes += len;
+  export_crc = esp_rom_crc32_le(export_crc, data, len);
+  if (export_request)
+    return serial_mux_send(SERIAL_CHANNEL_BULK, SERIAL_MUX_FLAG_MORE, export_request, data, len);
+
+  static const char prefix[] = "EXPORT_DATA ";
+  const uint8_t *bytes = data;
+  while (len > 0)
+  {
+    size_t chunk = len < EXPORT_CHUNK_BYTES ? len : EXPORT_CHUNK_BYTES;
+    size_t olen = 0;
+    memcpy(export_line, prefix, sizeof(prefix) - 1);
+    mbedtls_base64_encode((unsigned char *)export_line + sizeof(prefix) - 1, EXPORT_LINE_BYTES - sizeof(prefix),
+                          &olen, bytes, chunk);
+    olen += sizeof(prefix) - 1;
+    export_line[olen++] = '\n';
+    serial_data_write(export_line, olen);
+    bytes += chunk;
+    len -= chunk;
+  }
+  return ESP_OK;
+}
+
+static void export_task(void *arg)
+{
+  (void)arg;
+  int64_t start_us = esp_timer_get_time();
+  export_bytes = 0;
+  export_crc = 0;
+
+  char buf[128];
+  int len = snprintf(buf, sizeof(buf), "EXPORT {\"source\":\"%s\",\"format\":\"%s\",\"from\":%llu,\"to\":%llu}\n",
+                     source_name(export_source), export_binary ? "bin" : "csv",
+                     (unsigned long long)export_from_ms, (unsigned long long)export_to_ms);
+  serial_mux_reply(export_request, buf, len, false);
+
+  esp_err_t err;
+  if (export_source == EXPORT_SOURCE_SD)
+    err = telemetry_sd_log_export(export_from_ms, export_to_ms,
+                                  export_binary ? TELEMETRY_SD_LOG_BINARY : TELEMETRY_SD_LOG_CSV, export_write, NULL);
+  else
+    err = telemetry_history_export(export_source, export_from_ms, export_to_ms, export_write, NULL);
+
+  if (err == ESP_OK)
+    len = snprintf(buf, sizeof(buf), "EXPORT {\"done\":true,\"bytes\":%lu,\"crc32\":%lu,\"ms\":%lld}\n",
+                   (unsigned long)export_bytes, (unsigned long)export_crc,
+                   (long long)((esp_timer_get_time() - start_us) / 1000));
+  else
+    len = snprintf(buf, sizeof(buf), "EXPORT {\"error\":\"%s\",\"bytes\":%lu}\n",
+                   err == ESP_ERR_INVALID_STATE ? "no data" : err == ESP_ERR_TIMEOUT ? "busy" : esp_err_to_name(err),
+                   (unsigned long)export_bytes);
+  serial_mux_reply(export_request, buf, len, true);
+
+  export_running = false;
+  vTaskDelete(NULL);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "EXPORT {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+bool telemetry_export_handle_command(const char *line)
+{
+  static const char command[] = "EXPORT_HISTORY";
+  if (strncmp(line, command, sizeof(command) - 1) != 0 ||
+      (line[sizeof(command) - 1] != '\0' && line[sizeof(command) - 1] != ' '))
+    return false;
+
+  // EXPORT_HISTORY <source> <from_ms> <to_ms> [csv|bin]
+  char source_arg[8] = "";
+  char format_arg[8] = "csv";
+  unsigned long long from_ms = 0, to_ms = 0;
+  int fields = sscanf(line + sizeof(command) - 1, "%7s %llu %llu %7s", source_arg, &from_ms, &to_ms, format_arg);
+
+  int source = strcmp(source_arg, "sd") == 0 ? EXPORT_SOURCE_SD : -2;
+  for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++)
+  {
+    if (strcmp(source_arg, telemetry_history_tier_name(tier)) == 0)
+      source = tier;
+  }
+  bool binary = strcmp(format_arg, "bin") == 0;
+  if (fields < 3 || source == -2 || (!binary && strcmp(format_arg, "csv") != 0))
+  {
+    reply_error("usage: EXPORT_HISTORY sd|raw|1s|10s|1m <from_ms> <to_ms> [csv|bin]");
+    return true;
+  }
+  if (binary && source != EXPORT_SOURCE_SD)
+  {
+    reply_error("bin is only available for sd");
+    return true;
+  }
+
+  taskENTER_CRITICAL(&export_lock);
+  bool busy = export_running;
+  export_running = true;
+  taskEXIT_CRITICAL(&export_lock);
+  if (busy)
+  {
+    reply_error("busy");
+    return true;
+  }
+
+  export_source = source;
+  export_binary = binary;
+  export_from_ms = from_ms;
+  export_to_ms = to_ms;
+  export_request = serial_mux_defer_reply();
+  if (task_plan_create(TASK_PLAN_HISTORY_EXPORT, export_task, NULL, NULL) != pdPASS)
+  {
+    export_running = false;
+    static const char oom[] = "EXPORT {\"error\":\"no memory\"}\n";
+    serial_mux_reply(export_request, oom, sizeof(oom) - 1, true);
+  }
+  return true;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file telemetry_export.h
+ * @brief History Export over the Local Link
+ *
+ * EXPORT_HISTORY <source> <from_ms> <to_ms> [csv|bin] streams a time range
+ * of the telemetry history from a short-lived task, so the receive loop
+ * keeps decoding while a day of data goes out. The source is "sd" for the
+ * card log (telemetry_sd_log.h), in CSV or as its raw blocks, or a PSRAM
+ * tier "raw", "1s", "10s" or "1m" (telemetry_history.h), in CSV. The data
+ * is read block by block or a few rows at a time and sent as it is read.
+ *
+ * Reply lines, in order:
+ *   EXPORT {"source":"sd","format":"csv","from":F,"to":T}
+ *   EXPORT_DATA <base64>                       one per chunk
+ *   EXPORT {"done":true,"bytes":B,"crc32":C,"ms":M}   or {"error":"..."}
+ *
+ * Sent as a mux request (serial_mux.h) the data comes as raw bulk frames of
+ * the request instead of EXPORT_DATA lines. The diagnostics server offers
+ * the same as GET /history (diag_http.h).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Handle EXPORT_HISTORY
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was an export command
+ */
+bool telemetry_export_handle_command(const char *line);
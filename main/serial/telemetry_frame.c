@@ -0,0 +1,511 @@
+/**
+ * @file telemetry_frame.c
+ * @brief Binary Telemetry Frame Decoder Implementation
+ *
+ * COBS decoding, CRC check and field extraction for the binary telemetry
+ * format described in telemetry_frame.h. Everything runs on caller-owned or
+ * stack memory so a frame costs no heap allocation. Field extraction, the
+ * encoder and the diff are expanded from telemetry_schema.h.
+ */
+
+#include "telemetry_frame.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Bounds-checked reader over a decoded payload
+ */
+typedef struct
+{
+  const uint8_t *buf;
+  size_t len;
+  size_t pos;
+  bool error; ///< Set once a read ran past the end
+} frame_reader_t;
+
+/**
+ * @brief Bounds-checked writer of a payload
+ */
+typedef struct
+{
+  uint8_t *buf;
+  size_t size;
+  size_t pos;
+  bool error; ///< Set once a write ran past the end
+} frame_writer_t;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Decode COBS bytes into out
+ * @return Number of decoded bytes, 0 on malformed input or overflow
+ */
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_size)
+{
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+
+  while (in_pos < len)
+  {
+    uint8_t code = in[in_pos++];
+    if (code == 0 || in_pos + code - 1 > len)
+      return 0;
+
+    for (uint8_t i = 1; i < code; i++)
+    {
+      if (out_pos >= out_size)
+        return 0;
+      out[out_pos++] = in[in_pos++];
+    }
+
+    // A full block (0xFF) has no implicit zero, neither does the last block
+    if (code != 0xFF && in_pos < len)
+    {
+      if (out_pos >= out_size)
+        return 0;
+      out[out_pos++] = 0;
+    }
+  }
+
+  return out_pos;
+}
+
+/**
+ * @brief COBS encoder state, bytes are added one at a time
+ */
+typedef struct
+{
+  uint8_t *out;
+  size_t size;
+  size_t pos;      ///< Next output byte
+  size_t code_pos; ///< Where the code byte of the current block goes
+  uint8_t code;
+  bool overflow;
+} cobs_writer_t;
+
+static void cobs_put(cobs_writer_t *w, uint8_t byte)
+{
+  if (byte != 0)
+  {
+    if (w->pos >= w->size)
+    {
+      w->overflow = true;
+      return;
+    }
+    w->out[w->pos++] = byte;
+    if (++w->code != 0xFF)
+      return;
+  }
+
+  // A zero or a full block closes the block and opens the next
+  if (w->pos >= w->size)
+  {
+    w->overflow = true;
+    return;
+  }
+  w->out[w->code_pos] = w->code;
+  w->code_pos = w->pos++;
+  w->code = 1;
+}
+
+static const uint8_t *reader_take(frame_reader_t *r, size_t n)
+{
+  if (r->error || r->pos + n > r->len)
+  {
+    r->error = true;
+    return NULL;
+  }
+  const uint8_t *p = r->buf + r->pos;
+  r->pos += n;
+  return p;
+}
+
+static uint8_t reader_u8(frame_reader_t *r)
+{
+  const uint8_t *p = reader_take(r, 1);
+  return p ? p[0] : 0;
+}
+
+static uint16_t reader_u16(frame_reader_t *r)
+{
+  const uint8_t *p = reader_take(r, 2);
+  return p ? (uint16_t)(p[0] | (p[1] << 8)) : 0;
+}
+
+static uint32_t reader_u32(frame_reader_t *r)
+{
+  const uint8_t *p = reader_take(r, 4);
+  return p ? ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24)) : 0;
+}
+
+static uint64_t reader_u64(frame_reader_t *r)
+{
+  uint64_t lo = reader_u32(r);
+  uint64_t hi = reader_u32(r);
+  return lo | (hi << 32);
+}
+
+static float reader_f32(frame_reader_t *r)
+{
+  uint32_t raw = reader_u32(r);
+  float value;
+  memcpy(&value, &raw, sizeof(value));
+  return value;
+}
+
+static void reader_string(frame_reader_t *r, char *dst, size_t dst_size)
+{
+  uint8_t len = reader_u8(r);
+  const uint8_t *p = reader_take(r, len);
+  if (!p)
+    return;
+
+  size_t copy = len < dst_size - 1 ? len : dst_size - 1;
+  memcpy(dst, p, copy);
+  dst[copy] = '\0';
+}
+
+static void reader_list_values(frame_reader_t *r, telemetry_u8_list_t *dst, uint8_t count)
+{
+  const uint8_t *p = reader_take(r, count);
+  if (!p)
+    return;
+
+  dst->count = count < TELEMETRY_LIST_MAX ? count : TELEMETRY_LIST_MAX;
+  memcpy(dst->value, p, dst->count);
+}
+
+static void reader_u8_list(frame_reader_t *r, telemetry_u8_list_t *dst)
+{
+  reader_list_values(r, dst, reader_u8(r));
+}
+
+/**
+ * @brief Read a LEB128 varint of at most 64 bits
+ */
+static uint64_t reader_varint(frame_reader_t *r)
+{
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7)
+  {
+    uint8_t byte = reader_u8(r);
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  r->error = true;
+  return 0;
+}
+
+/**
+ * @brief Apply a zigzag varint difference, the caller truncates to the field width
+ */
+static uint64_t reader_delta(frame_reader_t *r, uint64_t previous)
+{
+  uint64_t zigzag = reader_varint(r);
+  return previous + ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+}
+
+/**
+ * @brief Read a packed list, changed values only when the count is unchanged
+ */
+static void reader_packed_u8_list(frame_reader_t *r, telemetry_u8_list_t *dst)
+{
+  uint8_t head = reader_u8(r);
+  if (!(head & 0x80))
+  {
+    reader_list_values(r, dst, head);
+    return;
+  }
+
+  uint8_t count = head & 0x7F;
+  const uint8_t *changed = count == dst->count ? reader_take(r, (count + 7u) / 8u) : NULL;
+  if (!changed)
+  {
+    r->error = true;
+    return;
+  }
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (changed[i / 8] & (1u << (i % 8)))
+      dst->value[i] = reader_u8(r);
+  }
+}
+
+static void writer_bytes(frame_writer_t *w, const void *src, size_t n)
+{
+  if (w->error || w->pos + n > w->size)
+  {
+    w->error = true;
+    return;
+  }
+  memcpy(w->buf + w->pos, src, n);
+  w->pos += n;
+}
+
+static void writer_u8(frame_writer_t *w, uint8_t value)
+{
+  writer_bytes(w, &value, 1);
+}
+
+static void writer_u16(frame_writer_t *w, uint16_t value)
+{
+  uint8_t b[2] = {(uint8_t)value, (uint8_t)(value >> 8)};
+  writer_bytes(w, b, sizeof(b));
+}
+
+static void writer_u32(frame_writer_t *w, uint32_t value)
+{
+  uint8_t b[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+  writer_bytes(w, b, sizeof(b));
+}
+
+static void writer_u64(frame_writer_t *w, uint64_t value)
+{
+  writer_u32(w, (uint32_t)value);
+  writer_u32(w, (uint32_t)(value >> 32));
+}
+
+static void writer_f32(frame_writer_t *w, float value)
+{
+  uint32_t raw;
+  memcpy(&raw, &value, sizeof(raw));
+  writer_u32(w, raw);
+}
+
+static void writer_string(frame_writer_t *w, const char *src)
+{
+  size_t len = strnlen(src, TELEMETRY_STRING_LEN - 1);
+  writer_u8(w, (uint8_t)len);
+  writer_bytes(w, src, len);
+}
+
+static void writer_u8_list(frame_writer_t *w, const telemetry_u8_list_t *src)
+{
+  uint8_t count = src->count < TELEMETRY_LIST_MAX ? src->count : TELEMETRY_LIST_MAX;
+  writer_u8(w, count);
+  writer_bytes(w, src->value, count);
+}
+
+// =======================================================================
+// SCHEMA EXPANSION
+// =======================================================================
+
+// Wire decoding and comparison per telemetry_schema.h type
+#define FRAME_READ_U8(r, dst) (dst) = reader_u8(r)
+#define FRAME_READ_U16(r, dst) (dst) = reader_u16(r)
+#define FRAME_READ_U32(r, dst) (dst) = reader_u32(r)
+#define FRAME_READ_U64(r, dst) (dst) = reader_u64(r)
+#define FRAME_READ_F32(r, dst) (dst) = reader_f32(r)
+#define FRAME_READ_STR(r, dst) reader_string(r, (dst), sizeof(dst))
+#define FRAME_READ_U8_LIST(r, dst) reader_u8_list(r, &(dst))
+
+#define FRAME_READ_PACKED_U8(r, dst) (dst) = (uint8_t)reader_delta(r, (dst))
+#define FRAME_READ_PACKED_U16(r, dst) (dst) = (uint16_t)reader_delta(r, (dst))
+#define FRAME_READ_PACKED_U32(r, dst) (dst) = (uint32_t)reader_delta(r, (dst))
+#define FRAME_READ_PACKED_U64(r, dst) (dst) = reader_delta(r, (dst))
+#define FRAME_READ_PACKED_F32 FRAME_READ_F32
+#define FRAME_READ_PACKED_STR FRAME_READ_STR
+#define FRAME_READ_PACKED_U8_LIST(r, dst) reader_packed_u8_list(r, &(dst))
+
+#define FRAME_WRITE_U8(w, src) writer_u8(w, (src))
+#define FRAME_WRITE_U16(w, src) writer_u16(w, (src))
+#define FRAME_WRITE_U32(w, src) writer_u32(w, (src))
+#define FRAME_WRITE_U64(w, src) writer_u64(w, (src))
+#define FRAME_WRITE_F32(w, src) writer_f32(w, (src))
+#define FRAME_WRITE_STR(w, src) writer_string(w, (src))
+#define FRAME_WRITE_U8_LIST(w, src) writer_u8_list(w, &(src))
+
+#define FRAME_SAME_U8(a, b) ((a) == (b))
+#define FRAME_SAME_U16(a, b) ((a) == (b))
+#define FRAME_SAME_U32(a, b) ((a) == (b))
+#define FRAME_SAME_U64(a, b) ((a) == (b))
+#define FRAME_SAME_F32(a, b) ((a) == (b))
+#define FRAME_SAME_STR(a, b) (strncmp((a), (b), TELEMETRY_STRING_LEN) == 0)
+#define FRAME_SAME_U8_LIST(a, b) ((a).count == (b).count && memcmp((a).value, (b).value, (a).count) == 0)
+
+// The bitmap is a u16 and a keyframe with every field must fit the payload buffer
+#define FRAME_FIELD_WIRE_SIZE(ID, SECTION, field, key, TYPE, ...) +TELEMETRY_WIRE_SIZE_##TYPE
+_Static_assert(SYSTEM_DATA_FIELD_COUNT <= 16, "Frame field bitmap is 16 bits");
+_Static_assert(4 + 2 TELEMETRY_SCHEMA(FRAME_FIELD_WIRE_SIZE) <= TELEMETRY_FRAME_MAX_PAYLOAD,
+               "Keyframe does not fit TELEMETRY_FRAME_MAX_PAYLOAD");
+
+// A varint takes one byte per 7 bits, so a packed delta of every field can be larger than a keyframe
+#define FRAME_PACKED_SIZE_U8 2
+#define FRAME_PACKED_SIZE_U16 3
+#define FRAME_PACKED_SIZE_U32 5
+#define FRAME_PACKED_SIZE_U64 10
+#define FRAME_PACKED_SIZE_F32 TELEMETRY_WIRE_SIZE_F32
+#define FRAME_PACKED_SIZE_STR TELEMETRY_WIRE_SIZE_STR
+#define FRAME_PACKED_SIZE_U8_LIST (1 + (TELEMETRY_LIST_MAX + 7) / 8 + TELEMETRY_LIST_MAX)
+#define FRAME_FIELD_PACKED_SIZE(ID, SECTION, field, key, TYPE, ...) +FRAME_PACKED_SIZE_##TYPE
+_Static_assert(4 + 2 TELEMETRY_SCHEMA(FRAME_FIELD_PACKED_SIZE) <= TELEMETRY_FRAME_MAX_PAYLOAD,
+               "Packed delta does not fit TELEMETRY_FRAME_MAX_PAYLOAD");
+_Static_assert(TELEMETRY_LIST_MAX < 0x80, "Packed list count shares a byte with its flag");
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+uint16_t telemetry_frame_crc16(const uint8_t *buf, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= (uint16_t)buf[i] << 8;
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+esp_err_t telemetry_frame_unwrap(const uint8_t *encoded, size_t len, uint8_t *payload, size_t size,
+                                 size_t *payload_len)
+{
+  if (encoded == NULL || payload == NULL || payload_len == NULL)
+    return ESP_ERR_INVALID_ARG;
+
+  size_t n = cobs_decode(encoded, len, payload, size);
+
+  // Version and type (2) + CRC (2) is the smallest valid frame
+  if (n < 4)
+    return ESP_ERR_INVALID_SIZE;
+
+  uint16_t expected_crc = (uint16_t)(payload[n - 2] | (payload[n - 1] << 8));
+  if (telemetry_frame_crc16(payload, n - 2) != expected_crc)
+    return ESP_ERR_INVALID_CRC;
+
+  *payload_len = n - 2;
+  return ESP_OK;
+}
+
+size_t telemetry_frame_wrap(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size)
+{
+  if (payload == NULL || out == NULL || out_size < 3)
+    return 0;
+
+  uint16_t crc = telemetry_frame_crc16(payload, len);
+  out[0] = TELEMETRY_FRAME_DELIMITER;
+  // The closing delimiter is kept out of the writer's room
+  cobs_writer_t w = {.out = out, .size = out_size - 1, .pos = 2, .code_pos = 1, .code = 1};
+  for (size_t i = 0; i < len; i++)
+    cobs_put(&w, payload[i]);
+  cobs_put(&w, (uint8_t)crc);
+  cobs_put(&w, (uint8_t)(crc >> 8));
+  if (w.overflow)
+    return 0;
+
+  out[w.code_pos] = w.code;
+  out[w.pos++] = TELEMETRY_FRAME_DELIMITER;
+  return w.pos;
+}
+
+esp_err_t telemetry_frame_decode(const uint8_t *encoded, size_t len, system_data_t *data, uint8_t *msg_type)
+{
+  if (encoded == NULL || data == NULL)
+    return ESP_ERR_INVALID_ARG;
+
+  uint8_t payload[TELEMETRY_FRAME_MAX_PAYLOAD];
+  size_t payload_len;
+  esp_err_t err = telemetry_frame_unwrap(encoded, len, payload, sizeof(payload), &payload_len);
+  if (err != ESP_OK)
+    return err;
+
+  // Header (4) is the smallest telemetry frame
+  if (payload_len < 4)
+    return ESP_ERR_INVALID_SIZE;
+
+  frame_reader_t r = {.buf = payload, .len = payload_len, .pos = 0, .error = false};
+  uint8_t version = reader_u8(&r);
+  uint8_t type = reader_u8(&r);
+  uint16_t fields = reader_u16(&r);
+
+  if (version != TELEMETRY_FRAME_VERSION ||
+      (type != TELEMETRY_MSG_KEYFRAME && type != TELEMETRY_MSG_DELTA && type != TELEMETRY_MSG_DELTA_PACKED))
+    return ESP_ERR_NOT_SUPPORTED;
+
+  // Decode into a copy so a truncated frame leaves the caller's data intact
+  system_data_t out = *data;
+
+  // Present fields follow the header in schema order
+#define FRAME_READ_FIELD(ID, SECTION, field, key, TYPE, ...) \
+  if (fields & SYSTEM_DATA_FIELD_##ID)                      \
+    FRAME_READ_##TYPE(&r, TELEMETRY_MEMBER(&out, SECTION, field));
+#define FRAME_READ_PACKED_FIELD(ID, SECTION, field, key, TYPE, ...) \
+  if (fields & SYSTEM_DATA_FIELD_##ID)                             \
+    FRAME_READ_PACKED_##TYPE(&r, TELEMETRY_MEMBER(&out, SECTION, field));
+  if (type == TELEMETRY_MSG_DELTA_PACKED)
+  {
+    TELEMETRY_SCHEMA(FRAME_READ_PACKED_FIELD)
+  }
+  else
+  {
+    TELEMETRY_SCHEMA(FRAME_READ_FIELD)
+  }
+#undef FRAME_READ_PACKED_FIELD
+#undef FRAME_READ_FIELD
+
+  if (!(fields & TELEMETRY_FIELD_TIMESTAMP))
+    out.timestamp = (uint64_t)time(NULL) * 1000; // Same fallback as the JSON path
+
+  if (r.error)
+    return ESP_ERR_INVALID_SIZE;
+
+  *data = out;
+  if (msg_type)
+    *msg_type = type;
+  return ESP_OK;
+}
+
+size_t telemetry_frame_encode(const system_data_t *data, uint32_t fields, uint8_t msg_type, uint8_t *out,
+                              size_t out_size)
+{
+  if (data == NULL || out == NULL || (msg_type != TELEMETRY_MSG_KEYFRAME && msg_type != TELEMETRY_MSG_DELTA))
+    return 0;
+
+  if (msg_type == TELEMETRY_MSG_KEYFRAME)
+    fields = SYSTEM_DATA_FIELD_ALL;
+  fields &= SYSTEM_DATA_FIELD_ALL;
+
+  uint8_t payload[TELEMETRY_FRAME_MAX_PAYLOAD];
+  // The CRC counts against the payload limit of the receiver
+  frame_writer_t w = {.buf = payload, .size = sizeof(payload) - 2, .pos = 0, .error = false};
+  writer_u8(&w, TELEMETRY_FRAME_VERSION);
+  writer_u8(&w, msg_type);
+  writer_u16(&w, (uint16_t)fields);
+
+#define FRAME_WRITE_FIELD(ID, SECTION, field, key, TYPE, ...) \
+  if (fields & SYSTEM_DATA_FIELD_##ID)                       \
+    FRAME_WRITE_##TYPE(&w, TELEMETRY_MEMBER(data, SECTION, field));
+  TELEMETRY_SCHEMA(FRAME_WRITE_FIELD)
+#undef FRAME_WRITE_FIELD
+
+  // The size asserts above make this unreachable, keep the check for schema changes
+  if (w.error)
+    return 0;
+
+  return telemetry_frame_wrap(payload, w.pos, out, out_size);
+}
+
+uint32_t telemetry_frame_diff(const system_data_t *before, const system_data_t *after)
+{
+  uint32_t changed = 0;
+
+#define FRAME_DIFF_FIELD(ID, SECTION, field, key, TYPE, ...)                                                   \
+  if (!FRAME_SAME_##TYPE(TELEMETRY_MEMBER(before, SECTION, field), TELEMETRY_MEMBER(after, SECTION, field))) \
+    changed |= SYSTEM_DATA_FIELD_##ID;
+  TELEMETRY_SCHEMA(FRAME_DIFF_FIELD)
+#undef FRAME_DIFF_FIELD
+
+  return changed;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file telemetry_frame.h
+ * @brief Binary Telemetry Frame Decoder
+ *
+ * Compact alternative to the JSON line format for system_data_t samples.
+ * Frames are COBS encoded and wrapped in 0x00 delimiters on both sides, so
+ * they never collide with the newline-terminated text protocol on the same
+ * link:
+ *
+ *   0x00 | COBS(payload) | 0x00
+ *
+ * Decoded payload (all multi-byte values little-endian):
+ *
+ *   offset 0   u8   version (TELEMETRY_FRAME_VERSION)
+ *   offset 1   u8   message type (TELEMETRY_MSG_*)
+ *   offset 2   u16  field bitmap (TELEMETRY_FIELD_*)
+ *   offset 4   ...  present fields in bit order
+ *   last 2     u16  CRC16-CCITT (poly 0x1021, init 0xFFFF) over all preceding bytes
+ *
+ * Strings are encoded as a u8 length followed by that many bytes (no
+ * terminator), lists as a u8 count followed by that many u8 values. Fields missing from the bitmap keep their previous value,
+ * matching the JSON path where absent keys are left untouched.
+ *
+ * Senders emit a keyframe with every field periodically (and on connect)
+ * and delta frames with only the changed fields in between. After a
+ * dropped frame the receiver ignores deltas until the next keyframe.
+ *
+ * A packed delta (TELEMETRY_MSG_DELTA_PACKED) has the same layout, but each
+ * integer field is the difference to the receiver's current value, wrapped
+ * to the field width, zigzag mapped and written as a LEB128 varint: a
+ * counter or a temperature that moves by a few units costs one byte
+ * whatever its width. Floats and strings are sent as in a plain delta. A
+ * list whose count is unchanged is sent as 0x80 | count, a bitmap of
+ * ceil(count / 8) bytes (bit i set for value i changed, LSB first) and the
+ * changed values; any other list as in a plain delta, with a count below
+ * 0x80. Packed deltas only make sense against the state the sender last
+ * sent, so senders include the timestamp in each of them and switch back
+ * to a keyframe whenever they cannot be sure the receiver has that state.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dashboard_data.h"
+#include "esp_err.h"
+
+// =======================================================================
+// PROTOCOL CONSTANTS
+// =======================================================================
+
+#define TELEMETRY_FRAME_DELIMITER 0x00 ///< Frame delimiter byte
+#define TELEMETRY_FRAME_VERSION 1      ///< Supported payload version
+#define TELEMETRY_FRAME_MAX_PAYLOAD 160 ///< Largest decoded payload accepted
+
+/// Worst-case COBS overhead is one byte per 254 bytes of payload
+#define TELEMETRY_FRAME_MAX_ENCODED (TELEMETRY_FRAME_MAX_PAYLOAD + TELEMETRY_FRAME_MAX_PAYLOAD / 254 + 1)
+
+#define TELEMETRY_MSG_KEYFRAME 0x01 ///< Full field set, resynchronises the receiver
+#define TELEMETRY_MSG_DELTA 0x02    ///< Only the fields that changed since the previous frame
+#define TELEMETRY_MSG_DELTA_PACKED 0x03 ///< Like TELEMETRY_MSG_DELTA, integers as varint differences
+
+// Field bitmap (same bits as SYSTEM_DATA_FIELD_*), fields follow the header in this order
+#define TELEMETRY_FIELD_TIMESTAMP SYSTEM_DATA_FIELD_TIMESTAMP         ///< u64 milliseconds since epoch
+#define TELEMETRY_FIELD_CPU_USAGE SYSTEM_DATA_FIELD_CPU_USAGE         ///< u8 percent
+#define TELEMETRY_FIELD_CPU_TEMP SYSTEM_DATA_FIELD_CPU_TEMP           ///< u8 Celsius
+#define TELEMETRY_FIELD_CPU_FAN SYSTEM_DATA_FIELD_CPU_FAN             ///< u16 RPM
+#define TELEMETRY_FIELD_CPU_NAME SYSTEM_DATA_FIELD_CPU_NAME           ///< string
+#define TELEMETRY_FIELD_GPU_USAGE SYSTEM_DATA_FIELD_GPU_USAGE         ///< u8 percent
+#define TELEMETRY_FIELD_GPU_TEMP SYSTEM_DATA_FIELD_GPU_TEMP           ///< u8 Celsius
+#define TELEMETRY_FIELD_GPU_NAME SYSTEM_DATA_FIELD_GPU_NAME           ///< string
+#define TELEMETRY_FIELD_GPU_MEM_USED SYSTEM_DATA_FIELD_GPU_MEM_USED   ///< u32 MB
+#define TELEMETRY_FIELD_GPU_MEM_TOTAL SYSTEM_DATA_FIELD_GPU_MEM_TOTAL ///< u32 MB
+#define TELEMETRY_FIELD_MEM_USAGE SYSTEM_DATA_FIELD_MEM_USAGE         ///< u8 percent
+#define TELEMETRY_FIELD_MEM_USED SYSTEM_DATA_FIELD_MEM_USED           ///< float32 GB
+#define TELEMETRY_FIELD_MEM_TOTAL SYSTEM_DATA_FIELD_MEM_TOTAL         ///< float32 GB
+#define TELEMETRY_FIELD_MEM_AVAIL SYSTEM_DATA_FIELD_MEM_AVAIL         ///< float32 GB
+#define TELEMETRY_FIELD_CPU_CORES SYSTEM_DATA_FIELD_CPU_CORES         ///< u8 list, percent per core
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Decode one COBS frame (without delimiters) into system data
+ * @param encoded Encoded frame bytes
+ * @param len Number of encoded bytes
+ * @param data System data structure to update, only present fields are written
+ * @param msg_type Receives the message type on success (may be NULL)
+ * @return ESP_OK on success,
+ *         ESP_ERR_INVALID_SIZE if the frame is truncated or too large, or a packed
+ *         list does not match the stored count,
+ *         ESP_ERR_INVALID_CRC if the checksum does not match,
+ *         ESP_ERR_NOT_SUPPORTED for an unknown version or message type
+ * @note Uses no heap; data is left untouched unless ESP_OK is returned. Packed
+ *       deltas are applied to the values in data, so pass the receiver's state
+ */
+esp_err_t telemetry_frame_decode(const uint8_t *encoded, size_t len, system_data_t *data, uint8_t *msg_type);
+
+/**
+ * @brief Undo the COBS encoding of a frame (without delimiters) and check its CRC
+ * @param encoded Encoded frame bytes
+ * @param len Number of encoded bytes
+ * @param payload Receives the decoded payload
+ * @param size Size of payload, TELEMETRY_FRAME_MAX_PAYLOAD for any frame accepted on the link
+ * @param payload_len Receives the payload length without the CRC
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the frame is malformed, shorter than
+ *         version and type or larger than size, ESP_ERR_INVALID_CRC on a checksum mismatch
+ * @note For other message types sharing the framing, see serial_mux.h
+ */
+esp_err_t telemetry_frame_unwrap(const uint8_t *encoded, size_t len, uint8_t *payload, size_t size,
+                                 size_t *payload_len);
+
+/**
+ * @brief Append the CRC to a payload and COBS encode it between two delimiters
+ * @param payload Payload starting with version and message type
+ * @param len Payload length
+ * @param out Receives the complete frame
+ * @param out_size Size of out, len + 2 + (len + 2) / 254 + 3 always suffices
+ * @return Frame length including both delimiters, 0 if it does not fit out
+ */
+size_t telemetry_frame_wrap(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size);
+
+/**
+ * @brief Encode a sample as a complete frame, for relaying it to other panels
+ * @param data Sample to encode
+ * @param fields SYSTEM_DATA_FIELD_* mask of the fields to include, ignored for a keyframe
+ * @param msg_type TELEMETRY_MSG_KEYFRAME or TELEMETRY_MSG_DELTA
+ * @param out Receives the frame including both delimiters
+ * @param out_size Size of out, TELEMETRY_FRAME_MAX_ENCODED + 2 always suffices
+ * @return Frame length, 0 for an unsupported message type or if out is too small
+ * @note Uses no heap; strings longer than the wire allows are cut like on decode
+ */
+size_t telemetry_frame_encode(const system_data_t *data, uint32_t fields, uint8_t msg_type, uint8_t *out,
+                              size_t out_size);
+
+/**
+ * @brief Compare two samples field by field
+ * @param before Previous state
+ * @param after New state
+ * @return SYSTEM_DATA_FIELD_* mask of the fields that differ
+ */
+uint32_t telemetry_frame_diff(const system_data_t *before, const system_data_t *after);
+
+/**
+ * @brief Compute the frame checksum
+ * @param buf Input bytes
+ * @param len Number of bytes
+ * @return CRC16-CCITT (poly 0x1021, init 0xFFFF)
+ */
+uint16_t telemetry_frame_crc16(const uint8_t *buf, size_t len);
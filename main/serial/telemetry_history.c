@@ -0,0 +1,659 @@
+/**
+ * @file telemetry_history.c
+ * @brief Telemetry History Store Implementation
+ *
+ * Each tier is a ring of buckets. A raw sample feeds the 1 s accumulator;
+ * when a bucket closes it is stored and passed on to the next tier, which
+ * folds mins, maxes and count-weighted averages the same way.
+ */
+
+#include "telemetry_history.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "serial_data_handler.h"
+#include "utils/event_bus.h"
+#include "utils/mem_governor.h"
+#include "utils/system_debug_utils.h"
+
+#if CONFIG_TELEMETRY_HISTORY
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define HISTORY_REPLY_POINTS_DEFAULT 60 ///< Points per GET_HISTORY reply unless asked otherwise
+#define HISTORY_REPLY_POINTS_MAX 600    ///< Upper bound for one GET_HISTORY reply
+#define HISTORY_EXPORT_BATCH 8          ///< Rows copied per hold of the mutex
+#define HISTORY_EXPORT_SCAN 512         ///< Rows looked at per hold at most
+#define HISTORY_EXPORT_TEXT 1024        ///< CSV bytes handed to the sink at once
+#define HISTORY_EXPORT_ROW_MAX (24 + TELEMETRY_METRIC_COUNT * 3 * 12) ///< Longest CSV row
+#define HISTORY_SHED_MIN_ROWS 60        ///< A shed tier keeps at least this many rows
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Ring of buckets for one tier plus the bucket currently being built
+ */
+typedef struct
+{
+  uint32_t bucket_ms; ///< Bucket width, 0 for the raw tier
+  size_t capacity;
+  size_t head;  ///< Next slot to write
+  size_t count; ///< Valid slots
+  uint32_t written; ///< Slots ever written, so head == written % capacity
+
+  uint64_t *t_ms;
+  int32_t *min[TELEMETRY_METRIC_COUNT]; ///< Aliases avg on the raw tier
+  int32_t *max[TELEMETRY_METRIC_COUNT]; ///< Aliases avg on the raw tier
+  int32_t *avg[TELEMETRY_METRIC_COUNT];
+
+  // Open bucket
+  bool acc_open;
+  uint64_t acc_start;
+  uint32_t acc_n;
+  int64_t acc_sum[TELEMETRY_METRIC_COUNT];
+  int32_t acc_min[TELEMETRY_METRIC_COUNT];
+  int32_t acc_max[TELEMETRY_METRIC_COUNT];
+} history_tier_t;
+
+/**
+ * @brief Input folded into a tier: a raw sample (n = 1) or a closed bucket
+ */
+typedef struct
+{
+  uint64_t t_ms;
+  uint32_t n;
+  int32_t min[TELEMETRY_METRIC_COUNT];
+  int32_t max[TELEMETRY_METRIC_COUNT];
+  int32_t avg[TELEMETRY_METRIC_COUNT];
+} history_input_t;
+
+/**
+ * @brief A column of a tier being resized
+ */
+typedef struct
+{
+  void **column;
+  size_t size; ///< Bytes per row
+} history_column_t;
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static const struct
+{
+  size_t capacity;
+  uint32_t bucket_ms;
+  bool shed; ///< Shrunk under memory pressure, the coarse tiers are small and keep the long trends
+} tier_layout[TELEMETRY_TIER_COUNT] = {
+    {CONFIG_TELEMETRY_HISTORY_RAW_SAMPLES, 0, true},
+    {CONFIG_TELEMETRY_HISTORY_1S_BUCKETS, 1000, true},
+    {CONFIG_TELEMETRY_HISTORY_10S_BUCKETS, 10000, false},
+    {CONFIG_TELEMETRY_HISTORY_1MIN_BUCKETS, 60000, false},
+};
+
+static history_tier_t tiers[TELEMETRY_TIER_COUNT];
+static SemaphoreHandle_t history_mutex = NULL;
+static bool history_ready = false;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static void *psram_calloc(size_t count, size_t size)
+{
+  return heap_caps_calloc(count, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+static esp_err_t tier_alloc(history_tier_t *tier, size_t capacity, uint32_t bucket_ms)
+{
+  tier->capacity = capacity;
+  tier->bucket_ms = bucket_ms;
+  tier->t_ms = psram_calloc(capacity, sizeof(uint64_t));
+  if (!tier->t_ms)
+    return ESP_ERR_NO_MEM;
+
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    tier->avg[m] = psram_calloc(capacity, sizeof(int32_t));
+    if (!tier->avg[m])
+      return ESP_ERR_NO_MEM;
+
+    if (bucket_ms == 0)
+    {
+      // Raw samples have no spread, no need to store it
+      tier->min[m] = tier->avg[m];
+      tier->max[m] = tier->avg[m];
+      continue;
+    }
+
+    tier->min[m] = psram_calloc(capacity, sizeof(int32_t));
+    tier->max[m] = psram_calloc(capacity, sizeof(int32_t));
+    if (!tier->min[m] || !tier->max[m])
+      return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+/**
+ * @brief Rotate a column left in place, by three reversals
+ */
+static void column_rotate(uint8_t *column, size_t size, size_t rows, size_t by)
+{
+  if (by == 0 || by >= rows)
+    return;
+  size_t spans[3][2] = {{0, by}, {by, rows}, {0, rows}};
+  for (int s = 0; s < 3; s++)
+  {
+    for (size_t lo = spans[s][0], hi = spans[s][1]; hi - lo > 1; lo++, hi--)
+    {
+      uint8_t tmp[sizeof(uint64_t)];
+      memcpy(tmp, column + lo * size, size);
+      memcpy(column + lo * size, column + (hi - 1) * size, size);
+      memcpy(column + (hi - 1) * size, tmp, size);
+    }
+  }
+}
+
+/**
+ * @brief Move a column's rows to the slots of a new capacity
+ *
+ * Row number n (counted by written) ends up in slot n % capacity, as if the
+ * ring had always had the new capacity, so export cursors stay valid. The
+ * newest rows are kept when it shrinks. The column must hold max(old, new)
+ * rows while this runs.
+ */
+static void column_relayout(void *column, size_t size, const history_tier_t *tier, size_t capacity)
+{
+  size_t keep = tier->count < capacity ? tier->count : capacity;
+  // Oldest row first, then drop those that no longer fit
+  column_rotate(column, size, tier->capacity, (tier->written - tier->count) % tier->capacity);
+  if (keep < tier->count)
+    memmove(column, (uint8_t *)column + (tier->count - keep) * size, keep * size);
+  size_t offset = (tier->written - keep) % capacity;
+  column_rotate(column, size, capacity, (capacity - offset) % capacity);
+}
+
+/**
+ * @brief Give a tier a new capacity, keeping its newest rows
+ * @return ESP_OK, or ESP_ERR_NO_MEM if it could not grow; it keeps its rows and capacity then
+ * @note Called with history_mutex held
+ */
+static esp_err_t tier_resize(history_tier_t *tier, size_t capacity)
+{
+  if (capacity == tier->capacity)
+    return ESP_OK;
+
+  bool spread = tier->bucket_ms != 0;
+  history_column_t columns[1 + TELEMETRY_METRIC_COUNT * 3];
+  int n = 0;
+  columns[n++] = (history_column_t){(void **)&tier->t_ms, sizeof(uint64_t)};
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    columns[n++] = (history_column_t){(void **)&tier->avg[m], sizeof(int32_t)};
+    if (spread)
+    {
+      columns[n++] = (history_column_t){(void **)&tier->min[m], sizeof(int32_t)};
+      columns[n++] = (history_column_t){(void **)&tier->max[m], sizeof(int32_t)};
+    }
+  }
+
+  bool grow = capacity > tier->capacity;
+  esp_err_t err = ESP_OK;
+  for (int i = 0; i < n && grow && err == ESP_OK; i++)
+  {
+    // Columns grown before a failure keep their rows and are trimmed by the next shrink
+    void *bigger = heap_caps_realloc(*columns[i].column, capacity * columns[i].size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (bigger)
+      *columns[i].column = bigger;
+    else
+      err = ESP_ERR_NO_MEM;
+  }
+
+  for (int i = 0; i < n && err == ESP_OK; i++)
+  {
+    column_relayout(*columns[i].column, columns[i].size, tier, capacity);
+    if (!grow)
+    {
+      // Shrinking in place does not fail, keep the larger block if it does
+      void *smaller = heap_caps_realloc(*columns[i].column, capacity * columns[i].size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+      if (smaller)
+        *columns[i].column = smaller;
+    }
+  }
+  if (!spread)
+  {
+    // The spread aliases avg, which may have moved
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      tier->min[m] = tier->avg[m];
+      tier->max[m] = tier->avg[m];
+    }
+  }
+  if (err != ESP_OK)
+    return err;
+
+  if (tier->count > capacity)
+    tier->count = capacity;
+  tier->capacity = capacity;
+  tier->head = tier->written % capacity;
+  return ESP_OK;
+}
+
+static void tier_store(history_tier_t *tier, const history_input_t *in)
+{
+  size_t slot = tier->head;
+  tier->t_ms[slot] = in->t_ms;
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    tier->avg[m][slot] = in->avg[m];
+    if (tier->bucket_ms != 0)
+    {
+      tier->min[m][slot] = in->min[m];
+      tier->max[m][slot] = in->max[m];
+    }
+  }
+
+  tier->head = (tier->head + 1) % tier->capacity;
+  tier->written++;
+  if (tier->count < tier->capacity)
+    tier->count++;
+}
+
+static void tier_feed(int index, const history_input_t *in);
+
+static void tier_close_bucket(int index)
+{
+  history_tier_t *tier = &tiers[index];
+  if (!tier->acc_open || tier->acc_n == 0)
+    return;
+
+  history_input_t bucket = {.t_ms = tier->acc_start, .n = tier->acc_n};
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    bucket.min[m] = tier->acc_min[m];
+    bucket.max[m] = tier->acc_max[m];
+    bucket.avg[m] = (int32_t)(tier->acc_sum[m] / (int64_t)tier->acc_n);
+  }
+
+  tier_store(tier, &bucket);
+  tier->acc_open = false;
+
+  if (index + 1 < TELEMETRY_TIER_COUNT)
+    tier_feed(index + 1, &bucket);
+}
+
+static void tier_feed(int index, const history_input_t *in)
+{
+  history_tier_t *tier = &tiers[index];
+  uint64_t start = in->t_ms - (in->t_ms % tier->bucket_ms);
+
+  // Also closes on a backwards clock jump, so buckets never overlap
+  if (tier->acc_open && start != tier->acc_start)
+    tier_close_bucket(index);
+
+  if (!tier->acc_open)
+  {
+    tier->acc_open = true;
+    tier->acc_start = start;
+    tier->acc_n = 0;
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      tier->acc_sum[m] = 0;
+      tier->acc_min[m] = INT32_MAX;
+      tier->acc_max[m] = INT32_MIN;
+    }
+  }
+
+  tier->acc_n += in->n;
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    tier->acc_sum[m] += (int64_t)in->avg[m] * in->n;
+    if (in->min[m] < tier->acc_min[m])
+      tier->acc_min[m] = in->min[m];
+    if (in->max[m] > tier->acc_max[m])
+      tier->acc_max[m] = in->max[m];
+  }
+}
+
+static int find_name(const char *const *names, int count, const char *name, size_t len)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (strlen(names[i]) == len && strncmp(names[i], name, len) == 0)
+      return i;
+  }
+  return -1;
+}
+
+#endif // CONFIG_TELEMETRY_HISTORY
+
+static const char *const metric_names[TELEMETRY_METRIC_COUNT] = {
+#define HISTORY_METRIC_NAME(ID, SECTION, field, key, TYPE, unit, history, ...) \
+  TELEMETRY_IF_HIST(history, [TELEMETRY_METRIC_##ID] = TELEMETRY_HIST_NAME(history), )
+    TELEMETRY_SCHEMA(HISTORY_METRIC_NAME)
+#undef HISTORY_METRIC_NAME
+};
+
+static const char *const tier_names[TELEMETRY_TIER_COUNT] = {"raw", "1s", "10s", "1m"};
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+const char *telemetry_history_metric_name(telemetry_metric_t metric)
+{
+  return (metric >= 0 && metric < TELEMETRY_METRIC_COUNT) ? metric_names[metric] : "unknown";
+}
+
+const char *telemetry_history_tier_name(telemetry_tier_t tier)
+{
+  return (tier >= 0 && tier < TELEMETRY_TIER_COUNT) ? tier_names[tier] : "unknown";
+}
+
+void telemetry_history_metric_values(const system_data_t *data, int32_t values[TELEMETRY_METRIC_COUNT])
+{
+  // Scaled fields are fractional and rounded, the others are stored as they are
+#define HISTORY_METRIC_VALUE(ID, SECTION, field, key, TYPE, unit, history, ...)                                 \
+  TELEMETRY_IF_HIST(history, values[TELEMETRY_METRIC_##ID] =                                                    \
+                                 TELEMETRY_HIST_SCALE(history) == 1                                             \
+                                     ? (int32_t)TELEMETRY_MEMBER(data, SECTION, field)                          \
+                                     : (int32_t)(TELEMETRY_MEMBER(data, SECTION, field) * TELEMETRY_HIST_SCALE(history) + 0.5f);)
+  TELEMETRY_SCHEMA(HISTORY_METRIC_VALUE)
+#undef HISTORY_METRIC_VALUE
+}
+
+#if CONFIG_TELEMETRY_HISTORY
+
+/**
+ * @brief Memory governor shed callback: halve the fine tiers at HIGH, quarter them at CRITICAL
+ */
+static void history_shed(mem_pressure_t level, void *ctx)
+{
+  (void)ctx;
+  size_t divisor = level >= MEM_PRESSURE_CRITICAL ? 4 : level >= MEM_PRESSURE_HIGH ? 2 : 1;
+
+  xSemaphoreTake(history_mutex, portMAX_DELAY);
+  for (int i = 0; i < TELEMETRY_TIER_COUNT; i++)
+  {
+    if (!tier_layout[i].shed)
+      continue;
+    size_t capacity = tier_layout[i].capacity / divisor;
+    if (capacity < HISTORY_SHED_MIN_ROWS)
+      capacity = HISTORY_SHED_MIN_ROWS; // The Kconfig minimum, never above the configured size
+    size_t before = tiers[i].capacity;
+    if (tier_resize(&tiers[i], capacity) != ESP_OK)
+      debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "History tier %s stays at %u rows, no PSRAM to grow",
+                          tier_names[i], (unsigned)before);
+    else if (capacity != before)
+      debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "History tier %s now %u rows", tier_names[i], (unsigned)capacity);
+  }
+  xSemaphoreGive(history_mutex);
+}
+
+/**
+ * @brief Telemetry subscriber, inline in the feeding task
+ * @note The history models one host, it follows the local link
+ */
+static void history_on_telemetry(const event_t *event, void *ctx)
+{
+  if (event->telemetry.source_id == SERIAL_SOURCE_LOCAL)
+  {
+    telemetry_history_record(event->telemetry.data);
+  }
+}
+
+esp_err_t telemetry_history_init(void)
+{
+  if (history_ready)
+    return ESP_OK;
+
+  history_mutex = xSemaphoreCreateMutex();
+  if (!history_mutex)
+    return ESP_ERR_NO_MEM;
+
+  for (int i = 0; i < TELEMETRY_TIER_COUNT; i++)
+  {
+    if (tier_alloc(&tiers[i], tier_layout[i].capacity, tier_layout[i].bucket_ms) != ESP_OK)
+    {
+      debug_log_error_f(DEBUG_TAG_SERIAL_DATA, "History tier %s allocation failed", tier_names[i]);
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  history_ready = true;
+  event_bus_subscribe(EVENT_TOPIC_TELEMETRY, history_on_telemetry, NULL, NULL);
+  mem_governor_register("history", MEM_GOVERNOR_REGION(HEAP_REGION_SPIRAM), history_shed, NULL);
+  debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Telemetry history ready (raw %d, 1s %d, 10s %d, 1m %d)",
+                   CONFIG_TELEMETRY_HISTORY_RAW_SAMPLES, CONFIG_TELEMETRY_HISTORY_1S_BUCKETS,
+                   CONFIG_TELEMETRY_HISTORY_10S_BUCKETS, CONFIG_TELEMETRY_HISTORY_1MIN_BUCKETS);
+  return ESP_OK;
+}
+
+void telemetry_history_record(const system_data_t *data)
+{
+  if (!history_ready || !data)
+    return;
+
+  history_input_t sample = {.t_ms = data->timestamp, .n = 1};
+  int32_t values[TELEMETRY_METRIC_COUNT];
+  telemetry_history_metric_values(data, values);
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    sample.min[m] = sample.max[m] = sample.avg[m] = values[m];
+  }
+
+  xSemaphoreTake(history_mutex, portMAX_DELAY);
+  tier_store(&tiers[TELEMETRY_TIER_RAW], &sample);
+  tier_feed(TELEMETRY_TIER_1S, &sample);
+  xSemaphoreGive(history_mutex);
+}
+
+size_t telemetry_history_query(telemetry_tier_t tier, telemetry_metric_t metric, uint64_t since_ms,
+                               telemetry_history_point_t *out, size_t max_points)
+{
+  if (!history_ready || !out || max_points == 0 || tier < 0 || tier >= TELEMETRY_TIER_COUNT ||
+      metric < 0 || metric >= TELEMETRY_METRIC_COUNT)
+    return 0;
+
+  xSemaphoreTake(history_mutex, portMAX_DELAY);
+  const history_tier_t *t = &tiers[tier];
+
+  // Walk back from the newest slot to find how many points qualify
+  size_t n = 0;
+  while (n < t->count && n < max_points)
+  {
+    size_t slot = (t->head + t->capacity - 1 - n) % t->capacity;
+    if (t->t_ms[slot] < since_ms)
+      break;
+    n++;
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    size_t slot = (t->head + t->capacity - n + i) % t->capacity;
+    out[i].t_ms = t->t_ms[slot];
+    out[i].min = t->min[metric][slot];
+    out[i].max = t->max[metric][slot];
+    out[i].avg = t->avg[metric][slot];
+  }
+  xSemaphoreGive(history_mutex);
+
+  return n;
+}
+
+/**
+ * @brief Append one CSV row of an export
+ */
+static int export_row(char *out, const history_input_t *row, bool spread)
+{
+  int len = sprintf(out, "%llu", (unsigned long long)row->t_ms);
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    if (spread)
+      len += sprintf(out + len, ",%ld,%ld,%ld", (long)row->min[m], (long)row->avg[m], (long)row->max[m]);
+    else
+      len += sprintf(out + len, ",%ld", (long)row->avg[m]);
+  }
+  out[len++] = '\n';
+  return len;
+}
+
+esp_err_t telemetry_history_export(telemetry_tier_t tier, uint64_t from_ms, uint64_t to_ms,
+                                   telemetry_export_write_fn_t write, void *ctx)
+{
+  if (!history_ready)
+    return ESP_ERR_INVALID_STATE;
+  if (tier < 0 || tier >= TELEMETRY_TIER_COUNT || !write)
+    return ESP_ERR_INVALID_ARG;
+
+  const history_tier_t *t = &tiers[tier];
+  bool spread = t->bucket_ms != 0;
+  char text[HISTORY_EXPORT_TEXT];
+  int len = sprintf(text, "t_ms");
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    if (spread)
+      len += sprintf(text + len, ",%s_min,%s_avg,%s_max", metric_names[m], metric_names[m], metric_names[m]);
+    else
+      len += sprintf(text + len, ",%s", metric_names[m]);
+  }
+  text[len++] = '\n';
+
+  xSemaphoreTake(history_mutex, portMAX_DELAY);
+  uint32_t cursor = t->written - t->count;
+  uint32_t end = t->written;
+  xSemaphoreGive(history_mutex);
+
+  esp_err_t err = ESP_OK;
+  history_input_t rows[HISTORY_EXPORT_BATCH];
+  while (err == ESP_OK && cursor != end)
+  {
+    int n = 0;
+    xSemaphoreTake(history_mutex, portMAX_DELAY);
+    // Rows overwritten since the last batch are gone, go on from the oldest left
+    uint32_t oldest = t->written - t->count;
+    if ((int32_t)(cursor - oldest) < 0)
+      cursor = oldest;
+    for (int scanned = 0; cursor != end && n < HISTORY_EXPORT_BATCH && scanned < HISTORY_EXPORT_SCAN;
+         scanned++, cursor++)
+    {
+      size_t slot = cursor % t->capacity;
+      if (t->t_ms[slot] < from_ms || t->t_ms[slot] > to_ms)
+        continue;
+      rows[n].t_ms = t->t_ms[slot];
+      for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+      {
+        rows[n].min[m] = t->min[m][slot];
+        rows[n].avg[m] = t->avg[m][slot];
+        rows[n].max[m] = t->max[m][slot];
+      }
+      n++;
+    }
+    xSemaphoreGive(history_mutex);
+
+    for (int i = 0; i < n && err == ESP_OK; i++)
+    {
+      if (len + HISTORY_EXPORT_ROW_MAX > sizeof(text))
+      {
+        err = write(ctx, text, len);
+        len = 0;
+      }
+      len += export_row(text + len, &rows[i], spread);
+    }
+  }
+
+  if (err == ESP_OK && len > 0)
+    err = write(ctx, text, len);
+  return err;
+}
+
+bool telemetry_history_handle_command(const char *line)
+{
+  static const char command[] = "GET_HISTORY";
+  if (strncmp(line, command, sizeof(command) - 1) != 0)
+    return false;
+
+  // GET_HISTORY <tier> <metric> [max_points]
+  char tier_arg[8] = "";
+  char metric_arg[16] = "";
+  int max_points = HISTORY_REPLY_POINTS_DEFAULT;
+  sscanf(line + sizeof(command) - 1, "%7s %15s %d", tier_arg, metric_arg, &max_points);
+
+  int tier = find_name(tier_names, TELEMETRY_TIER_COUNT, tier_arg, strlen(tier_arg));
+  int metric = find_name(metric_names, TELEMETRY_METRIC_COUNT, metric_arg, strlen(metric_arg));
+  if (tier < 0 || metric < 0)
+  {
+    static const char usage[] = "HISTORY {\"error\":\"usage: GET_HISTORY raw|1s|10s|1m <metric> [max_points]\"}\n";
+    serial_data_write(usage, sizeof(usage) - 1);
+    return true;
+  }
+
+  if (max_points < 1)
+    max_points = 1;
+  if (max_points > HISTORY_REPLY_POINTS_MAX)
+    max_points = HISTORY_REPLY_POINTS_MAX;
+
+  telemetry_history_point_t *points = heap_caps_malloc(max_points * sizeof(*points), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!points)
+  {
+    static const char oom[] = "HISTORY {\"error\":\"no memory\"}\n";
+    serial_data_write(oom, sizeof(oom) - 1);
+    return true;
+  }
+  size_t count = telemetry_history_query(tier, metric, 0, points, max_points);
+
+  // One line, written in pieces so the reply needs no large buffer
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "HISTORY {\"tier\":\"%s\",\"metric\":\"%s\",\"points\":[",
+                     tier_names[tier], metric_names[metric]);
+  serial_data_write(buf, len);
+  for (size_t i = 0; i < count; i++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s[%llu,%ld,%ld,%ld]", i ? "," : "", (unsigned long long)points[i].t_ms,
+                   (long)points[i].min, (long)points[i].max, (long)points[i].avg);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+
+  heap_caps_free(points);
+  return true;
+}
+
+#else
+
+esp_err_t telemetry_history_init(void)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void telemetry_history_record(const system_data_t *data)
+{
+  (void)data;
+}
+
+size_t telemetry_history_query(telemetry_tier_t tier, telemetry_metric_t metric, uint64_t since_ms,
+                               telemetry_history_point_t *out, size_t max_points)
+{
+  return 0;
+}
+
+esp_err_t telemetry_history_export(telemetry_tier_t tier, uint64_t from_ms, uint64_t to_ms,
+                                   telemetry_export_write_fn_t write, void *ctx)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool telemetry_history_handle_command(const char *line)
+{
+  return false;
+}
+
+#endif // CONFIG_TELEMETRY_HISTORY
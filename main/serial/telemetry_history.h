@@ -0,0 +1,142 @@
+/**
+ * @file telemetry_history.h
+ * @brief Telemetry History Store
+ *
+ * Time-series store in PSRAM for received system_data_t samples. Keeps the
+ * most recent samples at full rate plus min/max/avg tiers at 1 s, 10 s and
+ * 1 min resolution. Each tier is stored as struct-of-arrays per metric so a
+ * trend chart can read one metric without touching the others.
+ *
+ * telemetry_history_export() streams a tier as CSV, a few rows per hold of
+ * the store's lock, so a long export never holds up recording.
+ *
+ * Under high memory pressure the raw and 1 s tiers give back half their
+ * rows, three quarters when critical, keeping the newest (mem_governor.h).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dashboard_data.h"
+#include "esp_err.h"
+
+// =======================================================================
+// TYPES
+// =======================================================================
+
+/**
+ * @brief Recorded metrics, the telemetry_schema.h entries with HIST(name, scale)
+ *
+ * Each is stored as an integer, the field value times its scale, in the
+ * schema's unit (e.g. mem_used_cgb in hundredths of a GB).
+ */
+typedef enum
+{
+#define TELEMETRY_HISTORY_METRIC_ID(ID, SECTION, field, key, TYPE, unit, history, ...) \
+  TELEMETRY_IF_HIST(history, TELEMETRY_METRIC_##ID, )
+  TELEMETRY_SCHEMA(TELEMETRY_HISTORY_METRIC_ID)
+#undef TELEMETRY_HISTORY_METRIC_ID
+  TELEMETRY_METRIC_COUNT
+} telemetry_metric_t;
+
+/**
+ * @brief Resolution tiers
+ */
+typedef enum
+{
+  TELEMETRY_TIER_RAW, ///< Every received sample
+  TELEMETRY_TIER_1S,  ///< 1 second buckets
+  TELEMETRY_TIER_10S, ///< 10 second buckets
+  TELEMETRY_TIER_1MIN, ///< 1 minute buckets
+  TELEMETRY_TIER_COUNT
+} telemetry_tier_t;
+
+/**
+ * @brief Sink of an export, e.g. an HTTP chunk or a serial reply
+ * @return ESP_OK to go on, any error ends the export with it
+ */
+typedef esp_err_t (*telemetry_export_write_fn_t)(void *ctx, const void *data, size_t len);
+
+/**
+ * @brief One point of a queried series
+ *
+ * For the raw tier min, max and avg are the sample value.
+ */
+typedef struct
+{
+  uint64_t t_ms; ///< Sample time or bucket start (ms, host timestamp domain)
+  int32_t min;
+  int32_t max;
+  int32_t avg;
+} telemetry_history_point_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Allocate the history store in PSRAM and follow the local source's telemetry
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if PSRAM is short,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_TELEMETRY_HISTORY is disabled
+ */
+esp_err_t telemetry_history_init(void);
+
+/**
+ * @brief Record one sample into all tiers
+ * @param data Received system data (timestamp is used as the time axis)
+ * @note No-op until telemetry_history_init() succeeded
+ */
+void telemetry_history_record(const system_data_t *data);
+
+/**
+ * @brief Read the newest points of one metric
+ * @param tier Resolution tier
+ * @param metric Metric to read
+ * @param since_ms Only points at or after this time (0 for all)
+ * @param out Output points, oldest first
+ * @param max_points Capacity of out
+ * @return Number of points written
+ */
+size_t telemetry_history_query(telemetry_tier_t tier, telemetry_metric_t metric, uint64_t since_ms,
+                               telemetry_history_point_t *out, size_t max_points);
+
+/**
+ * @brief Stream one tier as CSV, oldest first
+ * @param tier Resolution tier
+ * @param from_ms First time included
+ * @param to_ms Last time included
+ * @param write Receives the text in pieces of up to 1 KB
+ * @param ctx Passed to write
+ * @return ESP_OK, the error of write, ESP_ERR_INVALID_ARG,
+ *         ESP_ERR_INVALID_STATE until telemetry_history_init() succeeded
+ * @note Header "t_ms,cpu_usage,..." on the raw tier and "t_ms,cpu_usage_min,cpu_usage_avg,
+ *       cpu_usage_max,..." on the others; rows stored after the call started are left out
+ */
+esp_err_t telemetry_history_export(telemetry_tier_t tier, uint64_t from_ms, uint64_t to_ms,
+                                   telemetry_export_write_fn_t write, void *ctx);
+
+/**
+ * @brief Scaled integer value of every metric in a sample, as the store records them
+ * @param data Sample
+ * @param values Output, indexed by telemetry_metric_t
+ */
+void telemetry_history_metric_values(const system_data_t *data, int32_t values[TELEMETRY_METRIC_COUNT]);
+
+/**
+ * @brief Short, stable name of a metric (e.g. "cpu_usage")
+ */
+const char *telemetry_history_metric_name(telemetry_metric_t metric);
+
+/**
+ * @brief Short, stable name of a tier (e.g. "10s")
+ */
+const char *telemetry_history_tier_name(telemetry_tier_t tier);
+
+/**
+ * @brief Handle a "GET_HISTORY <tier> <metric> [max_points]" host command
+ * @param line Command line
+ * @return true if the line was a history command (reply already sent)
+ */
+bool telemetry_history_handle_command(const char *line);
@@ -0,0 +1,623 @@
+/**
+ * @file telemetry_json.c
+ * @brief Streaming JSON Parser for the Telemetry Line Schema
+ *
+ * Recursive descent over the line buffer with a fixed depth limit. Keys are
+ * matched against the known schema as they are read and values are
+ * converted in place, so a line never touches the heap. The key matching
+ * of both parsers is expanded from telemetry_schema.h.
+ */
+
+#include "telemetry_json.h"
+
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+#include "json_arena.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define JSON_MAX_DEPTH 8 ///< Nesting limit for skipped values
+#define JSON_KEY_MAX 16  ///< Longest key the schema uses, plus terminator
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Object whose members are currently being parsed
+ */
+typedef enum
+{
+#define JSON_SECTION_ID(SECTION, key) SECTION_##SECTION,
+  TELEMETRY_SECTIONS(JSON_SECTION_ID)
+#undef JSON_SECTION_ID
+  SECTION_OTHER, ///< Unknown object, members are skipped
+} json_section_t;
+
+typedef struct
+{
+  const char *p;
+  const char *end;
+  system_data_t *data;
+  uint32_t present; ///< SYSTEM_DATA_FIELD_* of the numbers stored
+} json_parser_t;
+
+// =======================================================================
+// SCHEMA EXPANSION
+// =======================================================================
+
+// Number conversion per telemetry_schema.h type, a number where the schema has text is ignored
+#define JSON_STORE_U8(dst, v) (dst) = (uint8_t)(v)
+#define JSON_STORE_U16(dst, v) (dst) = (uint16_t)(v)
+#define JSON_STORE_U32(dst, v) (dst) = (uint32_t)(v)
+#define JSON_STORE_U64(dst, v) (dst) = (uint64_t)(v)
+#define JSON_STORE_F32(dst, v) (dst) = (float)(v)
+#define JSON_STORE_STR(dst, v) return
+#define JSON_STORE_U8_LIST(dst, v) return
+
+// The same for cJSON items, a missing or mistyped item leaves the field as it is
+#define CJSON_STORE_NUMBER(item, dst, ctype)                    \
+  do                                                            \
+  {                                                             \
+    if (cJSON_IsNumber(item))                                   \
+      (dst) = (ctype)cJSON_GetNumberValue(item);                \
+  } while (0)
+#define CJSON_STORE_U8(item, dst) CJSON_STORE_NUMBER(item, dst, uint8_t)
+#define CJSON_STORE_U16(item, dst) CJSON_STORE_NUMBER(item, dst, uint16_t)
+#define CJSON_STORE_U32(item, dst) CJSON_STORE_NUMBER(item, dst, uint32_t)
+#define CJSON_STORE_U64(item, dst) CJSON_STORE_NUMBER(item, dst, uint64_t)
+#define CJSON_STORE_F32(item, dst) CJSON_STORE_NUMBER(item, dst, float)
+#define CJSON_STORE_STR(item, dst)                              \
+  do                                                            \
+  {                                                             \
+    if (cJSON_IsString(item))                                   \
+    {                                                           \
+      strncpy((dst), cJSON_GetStringValue(item), sizeof(dst) - 1); \
+      (dst)[sizeof(dst) - 1] = '\0';                           \
+    }                                                           \
+  } while (0)
+#define CJSON_STORE_U8_LIST(item, dst) cjson_store_u8_list(item, &(dst))
+
+// =======================================================================
+// PRIVATE FUNCTION PROTOTYPES
+// =======================================================================
+
+static bool parse_object(json_parser_t *ps, json_section_t section, int depth);
+static bool skip_value(json_parser_t *ps, int depth);
+
+// =======================================================================
+// LEXER
+// =======================================================================
+
+static void skip_ws(json_parser_t *ps)
+{
+  while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r'))
+    ps->p++;
+}
+
+static bool consume(json_parser_t *ps, char c)
+{
+  skip_ws(ps);
+  if (ps->p < ps->end && *ps->p == c)
+  {
+    ps->p++;
+    return true;
+  }
+  return false;
+}
+
+static char peek(json_parser_t *ps)
+{
+  skip_ws(ps);
+  return ps->p < ps->end ? *ps->p : '\0';
+}
+
+static int hex_value(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static bool read_hex4(json_parser_t *ps, unsigned *out)
+{
+  if (ps->end - ps->p < 4)
+    return false;
+
+  unsigned value = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    int h = hex_value(ps->p[i]);
+    if (h < 0)
+      return false;
+    value = (value << 4) | (unsigned)h;
+  }
+  ps->p += 4;
+  *out = value;
+  return true;
+}
+
+/**
+ * @brief Append a code point as UTF-8, truncating like strncpy into a fixed field
+ */
+static void put_utf8(char *dst, size_t size, size_t *pos, unsigned cp)
+{
+  char tmp[4];
+  size_t n;
+  if (cp < 0x80)
+  {
+    tmp[0] = (char)cp;
+    n = 1;
+  }
+  else if (cp < 0x800)
+  {
+    tmp[0] = (char)(0xC0 | (cp >> 6));
+    tmp[1] = (char)(0x80 | (cp & 0x3F));
+    n = 2;
+  }
+  else if (cp < 0x10000)
+  {
+    tmp[0] = (char)(0xE0 | (cp >> 12));
+    tmp[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    tmp[2] = (char)(0x80 | (cp & 0x3F));
+    n = 3;
+  }
+  else
+  {
+    tmp[0] = (char)(0xF0 | (cp >> 18));
+    tmp[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    tmp[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    tmp[3] = (char)(0x80 | (cp & 0x3F));
+    n = 4;
+  }
+
+  for (size_t i = 0; i < n && dst && *pos + 1 < size; i++)
+    dst[(*pos)++] = tmp[i];
+}
+
+/**
+ * @brief Read a string token
+ * @param dst Destination (NULL to skip the string)
+ * @param size Destination size, result is always terminated
+ * @param truncated Set when the string did not fit (may be NULL)
+ */
+static bool read_string(json_parser_t *ps, char *dst, size_t size, bool *truncated)
+{
+  if (!consume(ps, '"'))
+    return false;
+
+  size_t pos = 0;
+  size_t total = 0;
+  while (ps->p < ps->end)
+  {
+    char c = *ps->p++;
+    unsigned cp;
+
+    if (c == '"')
+    {
+      if (dst)
+        dst[pos] = '\0';
+      if (truncated)
+        *truncated = total > pos;
+      return true;
+    }
+
+    if ((unsigned char)c < 0x20)
+      return false;
+
+    if (c != '\\')
+    {
+      if (dst && pos + 1 < size)
+        dst[pos++] = c;
+      total++;
+      continue;
+    }
+
+    if (ps->p >= ps->end)
+      return false;
+    c = *ps->p++;
+    switch (c)
+    {
+    case '"':
+    case '\\':
+    case '/':
+      cp = (unsigned char)c;
+      break;
+    case 'b':
+      cp = '\b';
+      break;
+    case 'f':
+      cp = '\f';
+      break;
+    case 'n':
+      cp = '\n';
+      break;
+    case 'r':
+      cp = '\r';
+      break;
+    case 't':
+      cp = '\t';
+      break;
+    case 'u':
+      if (!read_hex4(ps, &cp))
+        return false;
+      // Combine a UTF-16 surrogate pair
+      if (cp >= 0xD800 && cp <= 0xDBFF && ps->end - ps->p >= 6 && ps->p[0] == '\\' && ps->p[1] == 'u')
+      {
+        unsigned low;
+        ps->p += 2;
+        if (!read_hex4(ps, &low) || low < 0xDC00 || low > 0xDFFF)
+          return false;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      }
+      break;
+    default:
+      return false;
+    }
+
+    size_t before = pos;
+    put_utf8(dst, size, &pos, cp);
+    total += (pos - before) ? (pos - before) : 1;
+  }
+
+  return false; // Unterminated string
+}
+
+/**
+ * @brief Read a JSON number without strtod (newlib's strtod may allocate)
+ */
+static bool read_number(json_parser_t *ps, double *out)
+{
+  skip_ws(ps);
+  const char *p = ps->p;
+  bool negative = false;
+
+  if (p < ps->end && *p == '-')
+  {
+    negative = true;
+    p++;
+  }
+  if (p >= ps->end || *p < '0' || *p > '9')
+    return false;
+
+  // Integer part exact up to 19 digits (covers millisecond timestamps)
+  uint64_t int_part = 0;
+  int int_digits = 0;
+  int extra_digits = 0;
+  while (p < ps->end && *p >= '0' && *p <= '9')
+  {
+    if (int_digits < 19)
+      int_part = int_part * 10 + (uint64_t)(*p - '0');
+    else
+      extra_digits++; // Beyond double precision anyway
+    int_digits++;
+    p++;
+  }
+  double value = (double)int_part;
+  while (extra_digits-- > 0)
+    value *= 10.0;
+
+  if (p < ps->end && *p == '.')
+  {
+    p++;
+    if (p >= ps->end || *p < '0' || *p > '9')
+      return false;
+    double scale = 0.1;
+    while (p < ps->end && *p >= '0' && *p <= '9')
+    {
+      value += (*p - '0') * scale;
+      scale *= 0.1;
+      p++;
+    }
+  }
+
+  if (p < ps->end && (*p == 'e' || *p == 'E'))
+  {
+    p++;
+    bool exp_negative = false;
+    if (p < ps->end && (*p == '+' || *p == '-'))
+    {
+      exp_negative = (*p == '-');
+      p++;
+    }
+    if (p >= ps->end || *p < '0' || *p > '9')
+      return false;
+    int exponent = 0;
+    while (p < ps->end && *p >= '0' && *p <= '9')
+    {
+      if (exponent < 400)
+        exponent = exponent * 10 + (*p - '0');
+      p++;
+    }
+    while (exponent-- > 0)
+      value = exp_negative ? value / 10.0 : value * 10.0;
+  }
+
+  ps->p = p;
+  *out = negative ? -value : value;
+  return true;
+}
+
+static bool match_literal(json_parser_t *ps, const char *literal)
+{
+  size_t n = strlen(literal);
+  skip_ws(ps);
+  if ((size_t)(ps->end - ps->p) < n || memcmp(ps->p, literal, n) != 0)
+    return false;
+  ps->p += n;
+  return true;
+}
+
+// =======================================================================
+// PARSER
+// =======================================================================
+
+static bool skip_value(json_parser_t *ps, int depth)
+{
+  if (depth > JSON_MAX_DEPTH)
+    return false;
+
+  double number;
+  switch (peek(ps))
+  {
+  case '{':
+    return parse_object(ps, SECTION_OTHER, depth + 1);
+  case '[':
+    ps->p++;
+    if (consume(ps, ']'))
+      return true;
+    do
+    {
+      if (!skip_value(ps, depth + 1))
+        return false;
+    } while (consume(ps, ','));
+    return consume(ps, ']');
+  case '"':
+    return read_string(ps, NULL, 0, NULL);
+  case 't':
+    return match_literal(ps, "true");
+  case 'f':
+    return match_literal(ps, "false");
+  case 'n':
+    return match_literal(ps, "null");
+  default:
+    return read_number(ps, &number);
+  }
+}
+
+/**
+ * @brief Store a numeric member of a known section
+ */
+static void store_number(json_parser_t *ps, json_section_t section, const char *key, double value)
+{
+  system_data_t *d = ps->data;
+
+#define JSON_STORE_FIELD(ID, SECTION, field, json_key, TYPE, ...)  \
+  if (section == SECTION_##SECTION && strcmp(key, json_key) == 0) \
+  {                                                               \
+    JSON_STORE_##TYPE(TELEMETRY_MEMBER(d, SECTION, field), value); \
+    ps->present |= SYSTEM_DATA_FIELD_##ID;                        \
+    return;                                                       \
+  }
+  TELEMETRY_SCHEMA(JSON_STORE_FIELD)
+#undef JSON_STORE_FIELD
+}
+
+/**
+ * @brief Destination for an array member, NULL if the schema has none
+ */
+static telemetry_u8_list_t *list_target(json_parser_t *ps, json_section_t section, const char *key)
+{
+#define JSON_LIST_FIELD(ID, SECTION, field, json_key, TYPE, ...)                 \
+  TELEMETRY_IF_LIST(TYPE, if (section == SECTION_##SECTION && strcmp(key, json_key) == 0) { \
+    ps->present |= SYSTEM_DATA_FIELD_##ID;                                        \
+    return &TELEMETRY_MEMBER(ps->data, SECTION, field);                           \
+  })
+  TELEMETRY_SCHEMA(JSON_LIST_FIELD)
+#undef JSON_LIST_FIELD
+  return NULL;
+}
+
+/**
+ * @brief Read an array of numbers, elements of another type or past TELEMETRY_LIST_MAX are skipped
+ */
+static bool read_u8_list(json_parser_t *ps, telemetry_u8_list_t *dst, int depth)
+{
+  if (!consume(ps, '['))
+    return false;
+
+  dst->count = 0;
+  if (consume(ps, ']'))
+    return true;
+
+  do
+  {
+    char c = peek(ps);
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+      double value;
+      if (!read_number(ps, &value))
+        return false;
+      if (dst->count < TELEMETRY_LIST_MAX)
+        JSON_STORE_U8(dst->value[dst->count++], value);
+    }
+    else if (!skip_value(ps, depth + 1))
+    {
+      return false;
+    }
+  } while (consume(ps, ','));
+
+  return consume(ps, ']');
+}
+
+/**
+ * @brief Destination for a string member, NULL if the schema has none
+ */
+static char *string_target(json_parser_t *ps, json_section_t section, const char *key, size_t *size)
+{
+#define JSON_STRING_FIELD(ID, SECTION, field, json_key, TYPE, ...)                 \
+  TELEMETRY_IF_STR(TYPE, if (section == SECTION_##SECTION && strcmp(key, json_key) == 0) { \
+    *size = sizeof(TELEMETRY_MEMBER(ps->data, SECTION, field));                    \
+    return TELEMETRY_MEMBER(ps->data, SECTION, field);                             \
+  })
+  TELEMETRY_SCHEMA(JSON_STRING_FIELD)
+#undef JSON_STRING_FIELD
+  return NULL;
+}
+
+static json_section_t child_section(json_section_t section, const char *key)
+{
+  if (section != SECTION_ROOT)
+    return SECTION_OTHER;
+
+#define JSON_CHILD_SECTION(SECTION, json_key)                          \
+  if (SECTION_##SECTION != SECTION_ROOT && strcmp(key, json_key) == 0) \
+    return SECTION_##SECTION;
+  TELEMETRY_SECTIONS(JSON_CHILD_SECTION)
+#undef JSON_CHILD_SECTION
+  return SECTION_OTHER;
+}
+
+static bool parse_member_value(json_parser_t *ps, json_section_t section, const char *key, int depth)
+{
+  if (section == SECTION_OTHER)
+    return skip_value(ps, depth);
+
+  char c = peek(ps);
+  if (c == '{')
+    return parse_object(ps, child_section(section, key), depth + 1);
+
+  if (c == '[')
+  {
+    telemetry_u8_list_t *list = list_target(ps, section, key);
+    return list ? read_u8_list(ps, list, depth) : skip_value(ps, depth);
+  }
+
+  if (c == '"')
+  {
+    size_t size = 0;
+    char *dst = string_target(ps, section, key, &size);
+    return read_string(ps, dst, size, NULL);
+  }
+
+  if (c == '-' || (c >= '0' && c <= '9'))
+  {
+    double value;
+    if (!read_number(ps, &value))
+      return false;
+    store_number(ps, section, key, value);
+    return true;
+  }
+
+  return skip_value(ps, depth);
+}
+
+static bool parse_object(json_parser_t *ps, json_section_t section, int depth)
+{
+  if (depth > JSON_MAX_DEPTH || !consume(ps, '{'))
+    return false;
+
+  if (consume(ps, '}'))
+    return true;
+
+  do
+  {
+    char key[JSON_KEY_MAX];
+    bool truncated = false;
+    if (!read_string(ps, key, sizeof(key), &truncated) || !consume(ps, ':'))
+      return false;
+
+    // Longer keys are not in the schema, keep them from matching a prefix
+    json_section_t member_section = truncated ? SECTION_OTHER : section;
+    if (!parse_member_value(ps, member_section, key, depth))
+      return false;
+  } while (consume(ps, ','));
+
+  return consume(ps, '}');
+}
+
+static void cjson_store_u8_list(const cJSON *item, telemetry_u8_list_t *dst)
+{
+  if (!cJSON_IsArray(item))
+    return;
+
+  const cJSON *element;
+  dst->count = 0;
+  cJSON_ArrayForEach(element, item)
+  {
+    if (cJSON_IsNumber(element) && dst->count < TELEMETRY_LIST_MAX)
+      JSON_STORE_U8(dst->value[dst->count++], cJSON_GetNumberValue(element));
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+bool telemetry_json_parse(const char *json, size_t len, system_data_t *data)
+{
+  if (json == NULL || data == NULL || len == 0)
+    return false;
+
+  // Parse into a copy so a malformed line leaves the caller's data intact
+  system_data_t out = *data;
+  json_parser_t ps = {.p = json, .end = json + len, .data = &out, .present = 0};
+
+  if (!parse_object(&ps, SECTION_ROOT, 0))
+    return false;
+
+  if (!(ps.present & SYSTEM_DATA_FIELD_TIMESTAMP))
+  {
+    out.timestamp = (uint64_t)time(NULL) * 1000; // Current time in ms
+  }
+
+  *data = out;
+  return true;
+}
+
+bool telemetry_json_parse_cjson(const char *json, size_t len, system_data_t *data)
+{
+  if (json == NULL || data == NULL || len == 0)
+    return false;
+
+  json_arena_t *arena = json_arena_begin(len);
+  cJSON *root = cJSON_ParseWithLength(json, len);
+  if (root == NULL)
+  {
+    json_arena_end(arena);
+    return false;
+  }
+
+  // Overwritten below when the line carries a timestamp
+  data->timestamp = (uint64_t)time(NULL) * 1000; // Current time in ms
+
+  cJSON *sections[SECTION_OTHER] = {[SECTION_ROOT] = root};
+#define CJSON_SECTION(SECTION, json_key)                          \
+  if (SECTION_##SECTION != SECTION_ROOT)                          \
+  {                                                               \
+    cJSON *object = cJSON_GetObjectItem(root, json_key);          \
+    sections[SECTION_##SECTION] = cJSON_IsObject(object) ? object : NULL; \
+  }
+  TELEMETRY_SECTIONS(CJSON_SECTION)
+#undef CJSON_SECTION
+
+#define CJSON_FIELD(ID, SECTION, field, json_key, TYPE, ...)                          \
+  if (sections[SECTION_##SECTION])                                                    \
+  {                                                                                   \
+    cJSON *item = cJSON_GetObjectItem(sections[SECTION_##SECTION], json_key);         \
+    CJSON_STORE_##TYPE(item, TELEMETRY_MEMBER(data, SECTION, field));                 \
+  }
+  TELEMETRY_SCHEMA(CJSON_FIELD)
+#undef CJSON_FIELD
+
+  cJSON_Delete(root);
+  json_arena_end(arena);
+  return true;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file telemetry_json.h
+ * @brief Streaming JSON Parser for the Telemetry Line Schema
+ *
+ * Schema-specific, single-pass parser for the JSON lines sent by
+ * SystemPerformanceNotifierService. Values are written straight into
+ * system_data_t while the line is scanned; no DOM is built and nothing is
+ * allocated, unlike the cJSON path.
+ *
+ * The cJSON path lives here as well, so the firmware's fallback and
+ * benchmark and the host build share one implementation of it.
+ *
+ * Accepted layout (unknown keys and values of the wrong type are skipped):
+ *
+ *   {"ts":N,
+ *    "cpu":{"usage":N,"temp":N,"fan":N,"name":"...","cores":[N,...]},
+ *    "gpu":{"usage":N,"temp":N,"name":"...","mem_used":N,"mem_total":N},
+ *    "mem":{"usage":N,"used":N,"total":N,"avail":N}}
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dashboard_data.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Parse one telemetry JSON object into system data
+ * @param json JSON text (need not be NUL terminated)
+ * @param len Length of json in bytes
+ * @param data System data structure to update, only present fields are written
+ * @return true on success; on a syntax error data is left untouched
+ * @note Same field semantics as the cJSON path, including the timestamp fallback
+ */
+bool telemetry_json_parse(const char *json, size_t len, system_data_t *data);
+
+/**
+ * @brief Parse one telemetry JSON object through a cJSON tree
+ * @param json JSON text (need not be NUL terminated)
+ * @param len Length of json in bytes
+ * @param data System data structure to update, only present fields are written
+ * @return true on success, false if cJSON rejects the text
+ * @note Reference implementation for telemetry_json_parse(); the tree is
+ *       built in a JSON arena when one is free, on the heap otherwise
+ */
+bool telemetry_json_parse_cjson(const char *json, size_t len, system_data_t *data);
@@ -0,0 +1,304 @@
+/**
+ * @file telemetry_net.c
+ * @brief Network Telemetry Ingest Implementation
+ *
+ * Uses the lwIP netconn API so received pbufs are handed to the decoder in
+ * place: each netbuf fragment is fed directly, nothing is copied into an
+ * intermediate buffer. Senders are told apart by their IP address.
+ * Joining the relay group (telemetry_relay.h) only adds a destination the
+ * socket accepts, relayed frames arrive like any other datagram.
+ */
+
+#include "telemetry_net.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "serial_data_handler.h"
+#include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+
+#if CONFIG_TELEMETRY_NET
+
+#include "lwip/api.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define NET_RECV_TIMEOUT_MS 500 ///< Receive poll interval, bounds stop latency
+#define NET_MAX_PEERS (CONFIG_SERIAL_MAX_SOURCES > 1 ? CONFIG_SERIAL_MAX_SOURCES - 1 : 1)
+
+#if CONFIG_TELEMETRY_NET_UDP
+#define NET_PROTOCOL_NAME "UDP"
+#else
+#define NET_PROTOCOL_NAME "TCP"
+#endif
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+/**
+ * @brief Sending host and the telemetry source it feeds
+ */
+typedef struct
+{
+  bool in_use;
+  ip_addr_t addr;
+  uint8_t source_id;
+} net_peer_t;
+
+static TaskHandle_t net_task_handle = NULL;
+static volatile bool net_running = false;
+static net_peer_t peers[NET_MAX_PEERS];
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Find or register the telemetry source of a sending host
+ * @return Source id, or -1 if no source slot is left
+ */
+static int peer_source(const ip_addr_t *addr)
+{
+  for (int i = 0; i < NET_MAX_PEERS; i++)
+  {
+    if (peers[i].in_use && ip_addr_cmp(&peers[i].addr, addr))
+      return peers[i].source_id;
+  }
+
+  for (int i = 0; i < NET_MAX_PEERS; i++)
+  {
+    if (peers[i].in_use)
+      continue;
+
+    char name[SERIAL_SOURCE_NAME_LEN];
+    ipaddr_ntoa_r(addr, name, sizeof(name));
+    int id = serial_data_register_source(name);
+    if (id < 0)
+      return -1;
+
+    peers[i].in_use = true;
+    ip_addr_copy(peers[i].addr, *addr);
+    peers[i].source_id = (uint8_t)id;
+    return id;
+  }
+  return -1;
+}
+
+/**
+ * @brief Feed every fragment of a netbuf into a source
+ * @param terminate Close an unterminated trailing line (datagram boundaries)
+ */
+static void feed_netbuf(uint8_t source_id, struct netbuf *buf, bool terminate)
+{
+  uint8_t last = '\n';
+  netbuf_first(buf);
+  do
+  {
+    void *data;
+    u16_t len;
+    netbuf_data(buf, &data, &len);
+    if (len > 0)
+    {
+      serial_data_feed(source_id, data, len);
+      last = ((const uint8_t *)data)[len - 1];
+    }
+  } while (netbuf_next(buf) >= 0);
+
+  // A datagram is self-contained, do not let a lost one merge two lines
+  if (terminate && last != '\n' && last != 0x00)
+  {
+    static const uint8_t eol = '\n';
+    serial_data_feed(source_id, &eol, 1);
+  }
+}
+
+#if CONFIG_TELEMETRY_NET_UDP
+
+/**
+ * @brief Receive datagrams from any number of hosts
+ */
+static void net_serve(struct netconn *conn)
+{
+  while (net_running)
+  {
+    struct netbuf *buf = NULL;
+    err_t err = netconn_recv(conn, &buf);
+    if (err == ERR_TIMEOUT)
+      continue;
+    if (err != ERR_OK)
+    {
+      debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "UDP receive failed: %d", err);
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+
+    int id = peer_source(netbuf_fromaddr(buf));
+    if (id >= 0)
+    {
+      feed_netbuf((uint8_t)id, buf, true);
+    }
+    netbuf_delete(buf);
+  }
+}
+
+#else
+
+/**
+ * @brief Serve one persistent TCP stream at a time
+ */
+static void net_serve(struct netconn *conn)
+{
+  if (netconn_listen(conn) != ERR_OK)
+  {
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "TCP listen failed");
+    return;
+  }
+
+  while (net_running)
+  {
+    struct netconn *client = NULL;
+    err_t err = netconn_accept(conn, &client);
+    if (err != ERR_OK)
+      continue;
+
+    ip_addr_t addr;
+    u16_t port;
+    int id = -1;
+    if (netconn_getaddr(client, &addr, &port, 0) == ERR_OK)
+    {
+      id = peer_source(&addr);
+    }
+
+    if (id >= 0)
+    {
+      debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Telemetry stream from %s", serial_data_get_source_name((uint8_t)id));
+      netconn_set_recvtimeout(client, NET_RECV_TIMEOUT_MS);
+
+      while (net_running)
+      {
+        struct netbuf *buf = NULL;
+        err = netconn_recv(client, &buf);
+        if (err == ERR_TIMEOUT)
+          continue;
+        if (err != ERR_OK)
+          break;
+
+        // The stream keeps line state across segments
+        feed_netbuf((uint8_t)id, buf, false);
+        netbuf_delete(buf);
+      }
+      debug_log_info(DEBUG_TAG_SERIAL_DATA, "Telemetry stream closed");
+    }
+    else
+    {
+      debug_log_warning(DEBUG_TAG_SERIAL_DATA, "Telemetry stream rejected, no free source");
+    }
+
+    netconn_close(client);
+    netconn_delete(client);
+  }
+}
+
+#endif // CONFIG_TELEMETRY_NET_UDP
+
+/**
+ * @brief Network ingest task
+ */
+static void net_task(void *pvParameters)
+{
+#if CONFIG_TELEMETRY_NET_UDP
+  struct netconn *conn = netconn_new(NETCONN_UDP);
+#else
+  struct netconn *conn = netconn_new(NETCONN_TCP);
+#endif
+#if CONFIG_TELEMETRY_NET_JOIN_RELAY
+  ip_addr_t group;
+  bool joined = false;
+#endif
+
+  if (!conn || netconn_bind(conn, IP_ADDR_ANY, CONFIG_TELEMETRY_NET_PORT) != ERR_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SERIAL_DATA, "Cannot bind telemetry port %d", CONFIG_TELEMETRY_NET_PORT);
+  }
+  else
+  {
+    netconn_set_recvtimeout(conn, NET_RECV_TIMEOUT_MS);
+#if CONFIG_TELEMETRY_NET_JOIN_RELAY
+    joined = ipaddr_aton(CONFIG_TELEMETRY_RELAY_GROUP, &group) &&
+             netconn_join_leave_group(conn, &group, IP_ADDR_ANY, NETCONN_JOIN) == ERR_OK;
+    if (!joined)
+    {
+      debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "Cannot join telemetry relay group %s", CONFIG_TELEMETRY_RELAY_GROUP);
+    }
+#endif
+    debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Listening for telemetry on " NET_PROTOCOL_NAME " port %d",
+                     CONFIG_TELEMETRY_NET_PORT);
+    net_serve(conn);
+  }
+
+  if (conn)
+  {
+#if CONFIG_TELEMETRY_NET_JOIN_RELAY
+    // A netconn does not leave its groups when deleted
+    if (joined)
+      netconn_join_leave_group(conn, &group, IP_ADDR_ANY, NETCONN_LEAVE);
+#endif
+    netconn_delete(conn);
+  }
+
+  net_running = false;
+  net_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t telemetry_net_start(void)
+{
+  if (net_running)
+    return ESP_OK;
+
+  net_running = true;
+  if (task_plan_create(TASK_PLAN_TELEMETRY_NET, net_task, NULL, &net_task_handle) != pdPASS)
+  {
+    net_running = false;
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "Failed to create telemetry_net task");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+void telemetry_net_stop(void)
+{
+  // The task notices within one receive timeout and cleans up itself
+  net_running = false;
+}
+
+bool telemetry_net_is_running(void)
+{
+  return net_running;
+}
+
+#else
+
+esp_err_t telemetry_net_start(void)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void telemetry_net_stop(void)
+{
+}
+
+bool telemetry_net_is_running(void)
+{
+  return false;
+}
+
+#endif // CONFIG_TELEMETRY_NET
@@ -0,0 +1,39 @@
+/**
+ * @file telemetry_net.h
+ * @brief Network Telemetry Ingest
+ *
+ * Receives telemetry over WiFi on a UDP port or a TCP listener and feeds it
+ * into the serial handler's line/frame decoder. Every sending host becomes a
+ * telemetry source of its own (see serial_data_register_source()), so the
+ * payload format is exactly the one used on the cable: JSON lines or
+ * 0x00-delimited binary frames, several of them per datagram if wanted.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Start the network ingest task
+ * @return ESP_OK on success (or if already running),
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_TELEMETRY_NET is disabled
+ * @note Call once the station has an IP address; the socket binds to all interfaces
+ */
+esp_err_t telemetry_net_start(void);
+
+/**
+ * @brief Stop the network ingest task and close the socket
+ * @note Registered sources stay allocated and simply time out
+ */
+void telemetry_net_stop(void);
+
+/**
+ * @brief Check whether the ingest task is running
+ * @return true if listening
+ */
+bool telemetry_net_is_running(void);
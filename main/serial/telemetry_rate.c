@@ -0,0 +1,193 @@
+/**
+ * @file telemetry_rate.c
+ * @brief Telemetry rate requests to the host on the local link
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "telemetry_rate.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial_data_handler.h"
+
+#if CONFIG_TELEMETRY_RATE_CONTROL
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define RATE_NONE UINT32_MAX ///< sent_interval_ms before the first request
+
+typedef struct
+{
+  uint32_t interval_ms;
+  uint32_t lease_ms;
+  const char *reason;
+} rate_request_t;
+
+// Inputs set from the LVGL and HA tasks, polled and reset by the serial task
+static portMUX_TYPE rate_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool viewing = true;
+static uint32_t busy_reasons = 0;
+static int64_t overrun_until_us = 0;
+
+static uint32_t request_seq = 0;
+static uint32_t sent_interval_ms = RATE_NONE;
+static int64_t sent_us = 0;
+static int64_t lease_end_us = 0;
+static uint32_t pauses = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Rate the device wants now, rate_lock held
+ */
+static rate_request_t wanted_rate(int64_t now_us)
+{
+  if (busy_reasons || now_us < overrun_until_us)
+    return (rate_request_t){0, TELEMETRY_RATE_PAUSE_MS, "busy"};
+  if (viewing)
+    return (rate_request_t){CONFIG_TELEMETRY_RATE_ACTIVE_MS, TELEMETRY_RATE_LEASE_MS, "active"};
+  return (rate_request_t){CONFIG_TELEMETRY_RATE_IDLE_MS, TELEMETRY_RATE_LEASE_MS, "idle"};
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void telemetry_rate_poll(bool data_arrived)
+{
+  int64_t now_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&rate_lock);
+  rate_request_t want = wanted_rate(now_us);
+  bool due;
+  if (want.interval_ms == 0)
+    // Another pause only after a sample showed the host is still there, or the link would time out
+    due = data_arrived && (sent_interval_ms != 0 || now_us >= lease_end_us);
+  else
+    due = want.interval_ms != sent_interval_ms || now_us >= sent_us + want.lease_ms * 500LL;
+  if (due)
+  {
+    request_seq++;
+    sent_interval_ms = want.interval_ms;
+    sent_us = now_us;
+    lease_end_us = now_us + want.lease_ms * 1000LL;
+    if (want.interval_ms == 0)
+      pauses++;
+  }
+  uint32_t seq = request_seq;
+  portEXIT_CRITICAL(&rate_lock);
+
+  if (!due)
+    return;
+
+  char request[112];
+  int len = snprintf(request, sizeof(request),
+                     "TELEMETRY_RATE {\"seq\":%lu,\"interval_ms\":%lu,\"lease_ms\":%lu,\"reason\":\"%s\"}\n",
+                     (unsigned long)seq, (unsigned long)want.interval_ms, (unsigned long)want.lease_ms, want.reason);
+  serial_data_write(request, len);
+}
+
+void telemetry_rate_reset(void)
+{
+  portENTER_CRITICAL(&rate_lock);
+  sent_interval_ms = RATE_NONE;
+  sent_us = 0;
+  lease_end_us = 0;
+  portEXIT_CRITICAL(&rate_lock);
+}
+
+void telemetry_rate_set_viewing(bool is_viewing)
+{
+  portENTER_CRITICAL(&rate_lock);
+  viewing = is_viewing;
+  portEXIT_CRITICAL(&rate_lock);
+}
+
+void telemetry_rate_set_busy(uint32_t reason, bool busy)
+{
+  portENTER_CRITICAL(&rate_lock);
+  if (busy)
+    busy_reasons |= reason;
+  else
+    busy_reasons &= ~reason;
+  portEXIT_CRITICAL(&rate_lock);
+}
+
+void telemetry_rate_note_overrun(void)
+{
+  int64_t until_us = esp_timer_get_time() + TELEMETRY_RATE_PAUSE_MS * 1000LL;
+  portENTER_CRITICAL(&rate_lock);
+  overrun_until_us = until_us;
+  portEXIT_CRITICAL(&rate_lock);
+}
+
+bool telemetry_rate_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TELEMETRY_RATE") != 0)
+    return false;
+
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&rate_lock);
+  rate_request_t want = wanted_rate(now_us);
+  uint32_t interval_ms = sent_interval_ms;
+  int64_t lease_left_us = lease_end_us - now_us;
+  uint32_t seq = request_seq;
+  uint32_t reasons = busy_reasons;
+  uint32_t pause_count = pauses;
+  portEXIT_CRITICAL(&rate_lock);
+
+  char reply[192];
+  int len = snprintf(reply, sizeof(reply),
+                     "TELEMETRY_RATE_STATUS {\"reason\":\"%s\",\"interval_ms\":%ld,\"lease_left_ms\":%lld,"
+                     "\"requests\":%lu,\"pauses\":%lu,\"busy\":%lu}\n",
+                     want.reason, interval_ms == RATE_NONE ? -1L : (long)interval_ms,
+                     (long long)(lease_left_us > 0 ? lease_left_us / 1000 : 0), (unsigned long)seq,
+                     (unsigned long)pause_count, (unsigned long)reasons);
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+void telemetry_rate_poll(bool data_arrived)
+{
+  (void)data_arrived;
+}
+
+void telemetry_rate_reset(void)
+{
+}
+
+void telemetry_rate_set_viewing(bool viewing)
+{
+  (void)viewing;
+}
+
+void telemetry_rate_set_busy(uint32_t reason, bool busy)
+{
+  (void)reason;
+  (void)busy;
+}
+
+void telemetry_rate_note_overrun(void)
+{
+}
+
+bool telemetry_rate_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TELEMETRY_RATE") != 0)
+    return false;
+  static const char disabled[] = "TELEMETRY_RATE_STATUS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_TELEMETRY_RATE_CONTROL
@@ -0,0 +1,82 @@
+/**
+ * @file telemetry_rate.h
+ * @brief Telemetry rate requests to the host on the local link
+ *
+ * The host sends at a fixed rate, but the dashboard only uses one sample
+ * per refresh while someone looks at it, few while it is dimmed, and none
+ * while a Home Assistant sync keeps it busy; the rest is parsed only to be
+ * thrown away. While the local source is connected the device tells the
+ * host which rate is useful:
+ *
+ *   device -> host   TELEMETRY_RATE {"seq":4,"interval_ms":2000,"lease_ms":10000,"reason":"idle"}
+ *
+ * The host sends at most one sample per interval_ms until lease_ms after
+ * the request arrived, then falls back to its own rate unless a newer
+ * request came. Requests go out when the wanted rate changes and are
+ * renewed halfway through the lease.
+ *
+ * interval_ms 0 asks for a pause ("busy"). Its lease is shorter than the
+ * link timeout and it is never renewed while the host is quiet, so the
+ * first sample after it keeps the link up and lets the device ask again.
+ * Hosts that ignore the requests keep sending as before.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define TELEMETRY_RATE_LEASE_MS 10000 ///< Lease of active and idle requests
+#define TELEMETRY_RATE_PAUSE_MS 2000  ///< Lease of a pause, well below the 5 s link timeout
+
+#define TELEMETRY_RATE_BUSY_HA_SYNC (1u << 0) ///< Home Assistant states are being fetched and parsed
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Send a rate request when one is due
+ * @param data_arrived True for a line or frame of the local source, false on a
+ *        receive timeout while it is connected; pauses only go out on data
+ * @note Serial task
+ */
+void telemetry_rate_poll(bool data_arrived);
+
+/**
+ * @brief Forget what was asked, e.g. because the local link went down
+ */
+void telemetry_rate_reset(void);
+
+/**
+ * @brief Whether someone is looking at the display
+ * @note Any task, takes effect with the next poll
+ */
+void telemetry_rate_set_viewing(bool viewing);
+
+/**
+ * @brief Set or clear a reason to pause the host
+ * @param reason TELEMETRY_RATE_BUSY_* bit
+ * @note Any task, takes effect with the next poll
+ */
+void telemetry_rate_set_busy(uint32_t reason, bool busy);
+
+/**
+ * @brief Input was lost, pause the host for one pause lease
+ */
+void telemetry_rate_note_overrun(void);
+
+/**
+ * @brief Handle GET_TELEMETRY_RATE
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a rate command
+ */
+bool telemetry_rate_handle_command(const char *line);
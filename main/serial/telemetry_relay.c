@@ -0,0 +1,251 @@
+/**
+ * @file telemetry_relay.c
+ * @brief Telemetry Relay Implementation
+ *
+ * Subscribes to the bus with a queue of its own, so the serial task only
+ * copies each sample into a slot and never waits for the network; the relay
+ * task encodes and sends it. What the receivers hold is tracked as the last
+ * sample sent, deltas are computed against it rather than taken from the
+ * event, so a sample dropped by a full queue is folded into the next delta.
+ */
+
+#include "telemetry_relay.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "serial_data_handler.h"
+#include "telemetry_frame.h"
+#include "utils/event_bus.h"
+#include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+
+#if CONFIG_TELEMETRY_RELAY
+
+#include "lwip/api.h"
+#include "lwip/udp.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define RELAY_QUEUE_DEPTH 4      ///< Samples waiting for the relay task
+#define RELAY_POLL_MS 500        ///< Queue wait, bounds stop latency
+#define RELAY_MULTICAST_TTL 1    ///< Frames stay on the local subnet
+#define RELAY_KEYFRAME_US ((int64_t)CONFIG_TELEMETRY_RELAY_KEYFRAME_S * 1000000)
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static TaskHandle_t relay_task_handle = NULL;
+static volatile bool relay_running = false;
+static QueueHandle_t relay_queue = NULL;
+static struct netconn *relay_conn = NULL;
+static ip_addr_t relay_group;
+
+// Relay task only
+static system_data_t relay_sent; ///< State the receivers hold after the last frame sent
+static bool relay_synced = false; ///< relay_sent starts from a keyframe that was sent
+static int64_t relay_keyframe_us = 0;
+
+// Written by the relay task, read by GET_TELEMETRY_RELAY
+static uint32_t relay_keyframes = 0;
+static uint32_t relay_deltas = 0;
+static uint32_t relay_errors = 0;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Send one frame to the group as a datagram of its own
+ */
+static bool relay_send(const uint8_t *frame, size_t len)
+{
+  struct netbuf *buf = netbuf_new();
+  if (!buf)
+    return false;
+
+  // The stack may hold the datagram after sendto returns, so it gets its own copy
+  void *payload = netbuf_alloc(buf, (u16_t)len);
+  bool sent = false;
+  if (payload)
+  {
+    memcpy(payload, frame, len);
+    sent = netconn_sendto(relay_conn, buf, &relay_group, CONFIG_TELEMETRY_RELAY_PORT) == ERR_OK;
+  }
+  netbuf_delete(buf);
+  return sent;
+}
+
+/**
+ * @brief Queued telemetry subscriber, runs in the relay task
+ */
+static void relay_on_telemetry(const event_t *event, void *ctx)
+{
+  // A network source is another panel or host, relaying it could echo frames between panels
+  if (event->telemetry.source_id != SERIAL_SOURCE_LOCAL || !relay_conn)
+    return;
+
+  const system_data_t *data = event->telemetry.data;
+  int64_t now_us = esp_timer_get_time();
+  uint8_t type = TELEMETRY_MSG_DELTA;
+  uint32_t fields = 0;
+  if (!relay_synced || now_us - relay_keyframe_us >= RELAY_KEYFRAME_US)
+  {
+    type = TELEMETRY_MSG_KEYFRAME;
+  }
+  else
+  {
+    // The timestamp keeps the source alive on the receivers when nothing else changed
+    fields = telemetry_frame_diff(&relay_sent, data) | TELEMETRY_FIELD_TIMESTAMP;
+  }
+
+  uint8_t frame[TELEMETRY_FRAME_MAX_ENCODED + 2];
+  size_t len = telemetry_frame_encode(data, fields, type, frame, sizeof(frame));
+  if (len == 0 || !relay_send(frame, len))
+  {
+    relay_errors++;
+    return;
+  }
+
+  relay_sent = *data;
+  if (type == TELEMETRY_MSG_KEYFRAME)
+  {
+    relay_synced = true;
+    relay_keyframe_us = now_us;
+    relay_keyframes++;
+  }
+  else
+  {
+    relay_deltas++;
+  }
+}
+
+/**
+ * @brief Queued connection subscriber, a reconnected host starts with a keyframe
+ */
+static void relay_on_connection(const event_t *event, void *ctx)
+{
+  if (event->serial_connection.source_id == SERIAL_SOURCE_LOCAL)
+  {
+    relay_synced = false;
+  }
+}
+
+/**
+ * @brief Relay task
+ */
+static void relay_task(void *pvParameters)
+{
+  relay_conn = netconn_new(NETCONN_UDP);
+  if (!relay_conn)
+  {
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "Cannot open telemetry relay socket");
+  }
+  else
+  {
+#if LWIP_MULTICAST_TX_OPTIONS
+    udp_set_multicast_ttl(relay_conn->pcb.udp, RELAY_MULTICAST_TTL);
+#endif
+    relay_synced = false;
+    event_bus_subscribe(EVENT_TOPIC_TELEMETRY, relay_on_telemetry, NULL, relay_queue);
+    event_bus_subscribe(EVENT_TOPIC_SERIAL_CONNECTION, relay_on_connection, NULL, relay_queue);
+    debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Relaying telemetry to %s:%d", CONFIG_TELEMETRY_RELAY_GROUP,
+                     CONFIG_TELEMETRY_RELAY_PORT);
+
+    while (relay_running)
+    {
+      event_bus_dispatch(relay_queue, pdMS_TO_TICKS(RELAY_POLL_MS));
+    }
+
+    event_bus_unsubscribe(EVENT_TOPIC_TELEMETRY, relay_on_telemetry, NULL);
+    event_bus_unsubscribe(EVENT_TOPIC_SERIAL_CONNECTION, relay_on_connection, NULL);
+    xQueueReset(relay_queue);
+    netconn_delete(relay_conn);
+    relay_conn = NULL;
+  }
+
+  relay_running = false;
+  relay_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t telemetry_relay_start(void)
+{
+  if (relay_running)
+    return ESP_OK;
+
+  if (!ipaddr_aton(CONFIG_TELEMETRY_RELAY_GROUP, &relay_group) || !ip_addr_ismulticast(&relay_group))
+  {
+    debug_log_error_f(DEBUG_TAG_SERIAL_DATA, "Telemetry relay group %s is not a multicast address",
+                      CONFIG_TELEMETRY_RELAY_GROUP);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (!relay_queue)
+  {
+    relay_queue = event_bus_queue_create(RELAY_QUEUE_DEPTH);
+    if (!relay_queue)
+      return ESP_ERR_NO_MEM;
+  }
+
+  relay_running = true;
+  if (task_plan_create(TASK_PLAN_TELEMETRY_RELAY, relay_task, NULL, &relay_task_handle) != pdPASS)
+  {
+    relay_running = false;
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "Failed to create telemetry_relay task");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+void telemetry_relay_stop(void)
+{
+  // The task notices within one queue wait and cleans up itself
+  relay_running = false;
+}
+
+bool telemetry_relay_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TELEMETRY_RELAY") != 0)
+    return false;
+
+  char reply[160];
+  int len = snprintf(reply, sizeof(reply),
+                     "TELEMETRY_RELAY_STATUS {\"running\":%s,\"group\":\"%s\",\"port\":%d,\"keyframes\":%lu,"
+                     "\"deltas\":%lu,\"errors\":%lu}\n",
+                     relay_running ? "true" : "false", CONFIG_TELEMETRY_RELAY_GROUP, CONFIG_TELEMETRY_RELAY_PORT,
+                     (unsigned long)relay_keyframes, (unsigned long)relay_deltas, (unsigned long)relay_errors);
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+esp_err_t telemetry_relay_start(void)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void telemetry_relay_stop(void)
+{
+}
+
+bool telemetry_relay_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TELEMETRY_RELAY") != 0)
+    return false;
+  static const char disabled[] = "TELEMETRY_RELAY_STATUS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_TELEMETRY_RELAY
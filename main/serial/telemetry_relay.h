@@ -0,0 +1,46 @@
+/**
+ * @file telemetry_relay.h
+ * @brief Telemetry Relay to Other Panels
+ *
+ * The panel with the cable re-sends what its local source decodes as binary
+ * frames (telemetry_frame.h) to a UDP multicast group, so other panels in
+ * the house show the same host without a cable of their own. A panel
+ * receives the relay with the network ingest (telemetry_net.h) joined to the
+ * group, where the relaying panel becomes a telemetry source like any other
+ * sending host and its samples take the same decoder and subscriber path.
+ *
+ * Only the local source is relayed, never a network one, so two relaying
+ * panels cannot echo each other's frames. Each datagram holds one frame: a
+ * keyframe every CONFIG_TELEMETRY_RELAY_KEYFRAME_S, so a panel that joins
+ * late or lost a datagram catches up, and otherwise a delta of the fields
+ * that changed since the last frame sent.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Open the multicast socket and start relaying the local source
+ * @return ESP_OK on success (or if already running),
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_TELEMETRY_RELAY is disabled
+ * @note Call once the station has an IP address
+ */
+esp_err_t telemetry_relay_start(void);
+
+/**
+ * @brief Stop relaying and close the socket
+ */
+void telemetry_relay_stop(void);
+
+/**
+ * @brief Handle GET_TELEMETRY_RELAY
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a relay command
+ */
+bool telemetry_relay_handle_command(const char *line);
@@ -0,0 +1,998 @@
+/**
+ * @file telemetry_sd_log.c
+ * @brief Telemetry Log on the SD Card Implementation
+ *
+ * The feeding task appends each sample to the open staging block in PSRAM
+ * and adds the encoded size of its deltas, so it knows exactly when the
+ * block is full without encoding anything. Full blocks go through a queue to
+ * the writer task, which encodes them into one DMA-capable buffer and writes
+ * it with a single unbuffered fwrite. If the card falls behind the staging
+ * blocks run out and samples are dropped and counted, the feeding task never
+ * blocks on the card.
+ */
+
+#include "telemetry_sd_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "serial_data_handler.h"
+#include "telemetry_history.h"
+#include "utils/event_bus.h"
+#include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+
+#if CONFIG_TELEMETRY_SD_LOG
+
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "driver/sdspi_host.h"
+#include "driver/spi_common.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define LOG_MOUNT_POINT "/sdcard"
+#define LOG_DIR LOG_MOUNT_POINT "/TLOG"
+#define LOG_SPI_HOST SPI2_HOST
+
+#define LOG_MAGIC 0x31424C54u ///< "TLB1" little-endian
+#define LOG_VERSION 1
+#define LOG_BLOCK_SIZE (CONFIG_TELEMETRY_SD_LOG_BLOCK_KB * 1024)
+#define LOG_COLUMNS (1 + TELEMETRY_METRIC_COUNT) ///< Timestamps, then one per metric
+#define LOG_COLUMN_SPACE (LOG_BLOCK_SIZE - sizeof(log_block_header_t))
+#define LOG_MAX_SAMPLES (LOG_COLUMN_SPACE / LOG_COLUMNS) ///< Every column takes at least a byte per sample
+#define LOG_FILE_BLOCKS ((uint32_t)CONFIG_TELEMETRY_SD_LOG_FILE_MB * 1024 * 1024 / LOG_BLOCK_SIZE)
+#define LOG_STAGING_BLOCKS 3 ///< One filling, two waiting for a slow card
+#define LOG_POLL_MS 1000     ///< Writer wait, also how often an old block is checked
+#define LOG_FLUSH_US ((int64_t)CONFIG_TELEMETRY_SD_LOG_FLUSH_S * 1000000)
+#define LOG_REPLY_POINTS_DEFAULT 120 ///< Points per GET_SD_HISTORY reply unless asked otherwise
+#define LOG_REPLY_POINTS_MAX 1000    ///< Upper bound for one GET_SD_HISTORY reply
+#define LOG_EXPORT_TEXT 1024         ///< CSV bytes handed to the sink at once
+#define LOG_EXPORT_ROW_MAX (24 + TELEMETRY_METRIC_COUNT * 12) ///< Longest CSV row
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Block header as stored on the card, little-endian
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t samples;
+  uint64_t t_first_ms;
+  uint64_t t_last_ms;
+  uint8_t metrics; ///< TELEMETRY_METRIC_COUNT of the writer
+  uint8_t reserved[3];
+  uint16_t column_end[LOG_COLUMNS]; ///< End of each column, from the block start
+  uint32_t column_crc[LOG_COLUMNS]; ///< CRC-32 of each column, a query checks only what it reads
+} log_block_header_t;
+
+_Static_assert(sizeof(log_block_header_t) < 256, "block header should stay small");
+
+/**
+ * @brief Samples of one block before encoding, in PSRAM
+ */
+typedef struct
+{
+  uint16_t count;
+  size_t bytes;      ///< Encoded size of the columns so far
+  int64_t opened_us; ///< When the first sample arrived
+  bool new_file;     ///< The host clock went backwards before this block
+  uint64_t t_ms[LOG_MAX_SAMPLES];
+  int32_t values[TELEMETRY_METRIC_COUNT][LOG_MAX_SAMPLES];
+} log_staging_t;
+
+/**
+ * @brief Sparse index entry, one per log file
+ */
+typedef struct
+{
+  uint32_t seq;
+  uint32_t blocks;
+  uint64_t t_first_ms;
+  uint64_t t_last_ms;
+} log_file_t;
+
+/**
+ * @brief One decoded point of a query
+ */
+typedef struct
+{
+  uint64_t t_ms;
+  int32_t value;
+} log_point_t;
+
+typedef enum
+{
+  LOG_STATE_OFF,
+  LOG_STATE_MOUNTING,
+  LOG_STATE_NO_CARD,
+  LOG_STATE_LOGGING,
+} log_state_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static const char *const state_names[] = {"off", "mounting", "no_card", "logging"};
+
+static TaskHandle_t log_task_handle = NULL;
+static volatile log_state_t log_state = LOG_STATE_OFF;
+static sdmmc_card_t *log_card = NULL;
+
+// Staging, guarded by log_mutex
+static SemaphoreHandle_t log_mutex = NULL;
+static QueueHandle_t log_free_queue = NULL; ///< Empty staging blocks
+static QueueHandle_t log_full_queue = NULL; ///< Blocks for the writer, in order
+static log_staging_t *log_filling = NULL;
+static bool log_have_last = false;
+static uint64_t log_last_t_ms = 0;
+
+// Files, guarded by files_mutex; the writer holds it while it writes a block
+static SemaphoreHandle_t files_mutex = NULL;
+static log_file_t log_files[CONFIG_TELEMETRY_SD_LOG_MAX_FILES]; ///< Ascending seq, the last is being written
+static int log_file_count = 0;
+static FILE *log_file = NULL;
+static uint8_t *log_block = NULL; ///< Writer's encode buffer
+
+// Export, one at a time
+static SemaphoreHandle_t export_mutex = NULL;
+static uint8_t *export_block = NULL; ///< Block being exported
+
+// Counters for GET_SD_LOG
+static uint32_t log_blocks_written = 0;
+static uint32_t log_samples_written = 0;
+static uint32_t log_samples_dropped = 0;
+static uint32_t log_errors = 0;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static inline uint64_t zigzag(int64_t v)
+{
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline size_t varint_len(uint64_t v)
+{
+  size_t n = 1;
+  while (v >= 0x80)
+  {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+static inline size_t varint_put(uint8_t *p, uint64_t v)
+{
+  size_t n = 0;
+  while (v >= 0x80)
+  {
+    p[n++] = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+/**
+ * @brief Read one LEB128 value, false if it runs past end
+ */
+static bool varint_get(const uint8_t **p, const uint8_t *end, uint64_t *out)
+{
+  uint64_t v = 0;
+  for (int shift = 0; *p < end && shift < 64; shift += 7)
+  {
+    uint8_t b = *(*p)++;
+    v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+    {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Hand the filling block to the writer
+ * @note log_mutex held
+ */
+static void seal_locked(void)
+{
+  if (log_filling)
+  {
+    // Never full, the queue holds every staging block
+    xQueueSend(log_full_queue, &log_filling, 0);
+    log_filling = NULL;
+  }
+}
+
+/**
+ * @brief Append one sample, sealing the block first if the sample does not fit
+ * @note log_mutex held
+ */
+static void append_locked(uint64_t t_ms, const int32_t *values)
+{
+  bool backwards = log_have_last && t_ms < log_last_t_ms;
+  log_staging_t *s = log_filling;
+
+  size_t need = 0;
+  if (s && !backwards)
+  {
+    size_t last = s->count - 1;
+    need = varint_len(t_ms - s->t_ms[last]);
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      need += varint_len(zigzag((int64_t)values[m] - s->values[m][last]));
+    }
+  }
+  if (s && (backwards || s->count == LOG_MAX_SAMPLES || s->bytes + need > LOG_COLUMN_SPACE))
+  {
+    seal_locked();
+    s = NULL;
+  }
+
+  if (!s)
+  {
+    if (xQueueReceive(log_free_queue, &s, 0) != pdTRUE)
+    {
+      log_samples_dropped++;
+      return;
+    }
+    s->count = 0;
+    s->opened_us = esp_timer_get_time();
+    s->new_file = backwards;
+    // The first sample is a zero timestamp delta and its values against 0
+    need = 1;
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      need += varint_len(zigzag(values[m]));
+    }
+    s->bytes = need;
+    log_filling = s;
+  }
+  else
+  {
+    s->bytes += need;
+  }
+
+  s->t_ms[s->count] = t_ms;
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    s->values[m][s->count] = values[m];
+  }
+  s->count++;
+  log_have_last = true;
+  log_last_t_ms = t_ms;
+}
+
+/**
+ * @brief Telemetry subscriber, inline in the feeding task
+ */
+static void log_on_telemetry(const event_t *event, void *ctx)
+{
+  if (event->telemetry.source_id != SERIAL_SOURCE_LOCAL)
+    return;
+
+  int32_t values[TELEMETRY_METRIC_COUNT];
+  telemetry_history_metric_values(event->telemetry.data, values);
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  append_locked(event->telemetry.data->timestamp, values);
+  xSemaphoreGive(log_mutex);
+}
+
+/**
+ * @brief Encode a staging block into log_block
+ */
+static void encode_block(const log_staging_t *s)
+{
+  memset(log_block, 0, LOG_BLOCK_SIZE);
+  log_block_header_t hdr = {
+      .magic = LOG_MAGIC,
+      .version = LOG_VERSION,
+      .samples = s->count,
+      .t_first_ms = s->t_ms[0],
+      .t_last_ms = s->t_ms[s->count - 1],
+      .metrics = TELEMETRY_METRIC_COUNT,
+  };
+
+  size_t pos = sizeof(hdr);
+  size_t start = pos;
+  uint64_t prev_t = s->t_ms[0];
+  for (uint16_t i = 0; i < s->count; i++)
+  {
+    pos += varint_put(log_block + pos, s->t_ms[i] - prev_t);
+    prev_t = s->t_ms[i];
+  }
+  hdr.column_end[0] = (uint16_t)pos;
+  hdr.column_crc[0] = esp_rom_crc32_le(0, log_block + start, pos - start);
+
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    start = pos;
+    int32_t prev = 0;
+    for (uint16_t i = 0; i < s->count; i++)
+    {
+      pos += varint_put(log_block + pos, zigzag((int64_t)s->values[m][i] - prev));
+      prev = s->values[m][i];
+    }
+    hdr.column_end[1 + m] = (uint16_t)pos;
+    hdr.column_crc[1 + m] = esp_rom_crc32_le(0, log_block + start, pos - start);
+  }
+
+  memcpy(log_block, &hdr, sizeof(hdr));
+}
+
+static void file_path(uint32_t seq, char *path, size_t size)
+{
+  snprintf(path, size, LOG_DIR "/%08lu.TLG", (unsigned long)seq);
+}
+
+static bool header_valid(const log_block_header_t *hdr)
+{
+  if (hdr->magic != LOG_MAGIC || hdr->version != LOG_VERSION || hdr->metrics != TELEMETRY_METRIC_COUNT ||
+      hdr->samples == 0)
+    return false;
+
+  uint16_t prev = sizeof(*hdr);
+  for (int c = 0; c < LOG_COLUMNS; c++)
+  {
+    if (hdr->column_end[c] < prev || hdr->column_end[c] > LOG_BLOCK_SIZE)
+      return false;
+    prev = hdr->column_end[c];
+  }
+  return true;
+}
+
+/**
+ * @brief Read and check a block header
+ */
+static bool read_header(FILE *f, uint32_t block, log_block_header_t *hdr)
+{
+  return fseek(f, (long)block * LOG_BLOCK_SIZE, SEEK_SET) == 0 && fread(hdr, sizeof(*hdr), 1, f) == 1 &&
+         header_valid(hdr);
+}
+
+/**
+ * @brief First block of a file that may hold samples at or after from_ms
+ */
+static uint32_t first_block(FILE *f, uint32_t blocks, uint64_t from_ms)
+{
+  // Time ascends within a file, so does each block's last sample
+  log_block_header_t hdr;
+  uint32_t lo = 0, hi = blocks;
+  while (lo < hi)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (read_header(f, mid, &hdr) && hdr.t_last_ms < from_ms)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/**
+ * @brief Close the current file and open the next one, dropping the oldest at the file limit
+ * @note files_mutex held
+ */
+static bool open_next_file_locked(void)
+{
+  if (log_file)
+  {
+    fclose(log_file);
+    log_file = NULL;
+  }
+
+  char path[32];
+  if (log_file_count == CONFIG_TELEMETRY_SD_LOG_MAX_FILES)
+  {
+    file_path(log_files[0].seq, path, sizeof(path));
+    unlink(path);
+    memmove(&log_files[0], &log_files[1], (log_file_count - 1) * sizeof(log_files[0]));
+    log_file_count--;
+  }
+
+  uint32_t seq = log_file_count ? log_files[log_file_count - 1].seq + 1 : 1;
+  file_path(seq, path, sizeof(path));
+  log_file = fopen(path, "wb");
+  if (!log_file)
+    return false;
+  // Blocks go to FATFS as they are, whole sectors straight from log_block
+  setvbuf(log_file, NULL, _IONBF, 0);
+
+  log_files[log_file_count++] = (log_file_t){.seq = seq};
+  return true;
+}
+
+/**
+ * @brief Encode and write one block, runs in the writer task
+ */
+static void write_block(const log_staging_t *s)
+{
+  encode_block(s);
+  const log_block_header_t *hdr = (const log_block_header_t *)log_block;
+
+  xSemaphoreTake(files_mutex, portMAX_DELAY);
+  bool ok = true;
+  if (!log_file || s->new_file || log_files[log_file_count - 1].blocks >= LOG_FILE_BLOCKS)
+  {
+    ok = open_next_file_locked();
+  }
+  if (ok)
+  {
+    // fsync per block keeps the file length on the card, at one FAT update per block
+    ok = fwrite(log_block, 1, LOG_BLOCK_SIZE, log_file) == LOG_BLOCK_SIZE && fsync(fileno(log_file)) == 0;
+    if (ok)
+    {
+      log_file_t *file = &log_files[log_file_count - 1];
+      if (file->blocks == 0)
+        file->t_first_ms = hdr->t_first_ms;
+      file->t_last_ms = hdr->t_last_ms;
+      file->blocks++;
+    }
+    else
+    {
+      // A partial block would misalign the rest, the next one starts a new file
+      fclose(log_file);
+      log_file = NULL;
+    }
+  }
+  xSemaphoreGive(files_mutex);
+
+  if (ok)
+  {
+    log_blocks_written++;
+    log_samples_written += s->count;
+  }
+  else
+  {
+    log_errors++;
+  }
+}
+
+static int compare_files(const void *a, const void *b)
+{
+  uint32_t sa = ((const log_file_t *)a)->seq, sb = ((const log_file_t *)b)->seq;
+  return sa < sb ? -1 : sa > sb;
+}
+
+/**
+ * @brief Index the files left by earlier boots from their first and last block header
+ */
+static void scan_files(void)
+{
+  mkdir(LOG_DIR, 0775);
+  DIR *dir = opendir(LOG_DIR);
+  if (!dir)
+    return;
+
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL)
+  {
+    unsigned long seq;
+    char ext[5];
+    if (sscanf(entry->d_name, "%8lu.%4s", &seq, ext) != 2 || strcasecmp(ext, "TLG") != 0)
+      continue;
+
+    char path[32];
+    file_path(seq, path, sizeof(path));
+    struct stat st;
+    FILE *f = stat(path, &st) == 0 ? fopen(path, "rb") : NULL;
+    if (!f)
+      continue;
+
+    // A torn tail from a power cut is left out
+    log_file_t file = {.seq = seq, .blocks = st.st_size / LOG_BLOCK_SIZE};
+    log_block_header_t hdr;
+    while (file.blocks > 0 && !read_header(f, file.blocks - 1, &hdr))
+      file.blocks--;
+    if (file.blocks > 0)
+    {
+      file.t_last_ms = hdr.t_last_ms;
+      if (read_header(f, 0, &hdr))
+        file.t_first_ms = hdr.t_first_ms;
+    }
+    fclose(f);
+
+    if (file.blocks == 0)
+    {
+      unlink(path);
+      continue;
+    }
+    if (log_file_count == CONFIG_TELEMETRY_SD_LOG_MAX_FILES)
+    {
+      // Keep the newest, the others go once everything is read
+      qsort(log_files, log_file_count, sizeof(log_files[0]), compare_files);
+      if (file.seq < log_files[0].seq)
+      {
+        unlink(path);
+        continue;
+      }
+      file_path(log_files[0].seq, path, sizeof(path));
+      unlink(path);
+      log_files[0] = file;
+      continue;
+    }
+    log_files[log_file_count++] = file;
+  }
+  closedir(dir);
+  qsort(log_files, log_file_count, sizeof(log_files[0]), compare_files);
+}
+
+static esp_err_t mount_card(void)
+{
+  spi_bus_config_t bus = {
+      .mosi_io_num = CONFIG_TELEMETRY_SD_LOG_MOSI_GPIO,
+      .miso_io_num = CONFIG_TELEMETRY_SD_LOG_MISO_GPIO,
+      .sclk_io_num = CONFIG_TELEMETRY_SD_LOG_CLK_GPIO,
+      .quadwp_io_num = -1,
+      .quadhd_io_num = -1,
+  };
+  esp_err_t err = spi_bus_initialize(LOG_SPI_HOST, &bus, SPI_DMA_CH_AUTO);
+  if (err != ESP_OK)
+    return err;
+
+  sdmmc_host_t host = SDSPI_HOST_DEFAULT();
+  host.slot = LOG_SPI_HOST;
+  sdspi_device_config_t slot = SDSPI_DEVICE_CONFIG_DEFAULT();
+  slot.gpio_cs = CONFIG_TELEMETRY_SD_LOG_CS_GPIO;
+  slot.host_id = LOG_SPI_HOST;
+
+  esp_vfs_fat_mount_config_t mount = {
+      .format_if_mount_failed = false,
+      .max_files = 3, ///< Writer, a query and a scan
+      .allocation_unit_size = LOG_BLOCK_SIZE,
+  };
+  err = esp_vfs_fat_sdspi_mount(LOG_MOUNT_POINT, &host, &slot, &mount, &log_card);
+  if (err != ESP_OK)
+    spi_bus_free(LOG_SPI_HOST);
+  return err;
+}
+
+/**
+ * @brief Writer task
+ */
+static void log_task(void *pvParameters)
+{
+  esp_err_t err = mount_card();
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SERIAL_DATA, "No SD card for the telemetry log: %s", esp_err_to_name(err));
+    log_state = LOG_STATE_NO_CARD;
+    log_task_handle = NULL;
+    vTaskDelete(NULL);
+    return;
+  }
+
+  xSemaphoreTake(files_mutex, portMAX_DELAY);
+  scan_files();
+  xSemaphoreGive(files_mutex);
+  debug_log_info_f(DEBUG_TAG_SERIAL_DATA, "Telemetry SD log on %s, %d earlier files", log_card->cid.name,
+                   log_file_count);
+
+  log_state = LOG_STATE_LOGGING;
+  event_bus_subscribe(EVENT_TOPIC_TELEMETRY, log_on_telemetry, NULL, NULL);
+
+  while (true)
+  {
+    log_staging_t *s;
+    if (xQueueReceive(log_full_queue, &s, pdMS_TO_TICKS(LOG_POLL_MS)) == pdTRUE)
+    {
+      write_block(s);
+      xQueueSend(log_free_queue, &s, 0);
+      continue;
+    }
+
+    // At a low sample rate a block would take long to fill, it is written part empty instead
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    if (log_filling && esp_timer_get_time() - log_filling->opened_us >= LOG_FLUSH_US)
+      seal_locked();
+    xSemaphoreGive(log_mutex);
+  }
+}
+
+/**
+ * @brief Collect the points of one metric in [from_ms, to_ms], oldest first
+ * @return Points written, *more set if the range holds further points
+ */
+static size_t query(int metric, uint64_t from_ms, uint64_t to_ms, log_point_t *out, size_t max_points, bool *more)
+{
+  size_t n = 0;
+  *more = false;
+  uint8_t *column = heap_caps_malloc(2 * LOG_BLOCK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!column)
+    return 0;
+  uint8_t *times = column + LOG_BLOCK_SIZE;
+
+  xSemaphoreTake(files_mutex, portMAX_DELAY);
+  for (int i = 0; i < log_file_count && !*more; i++)
+  {
+    // Files follow each other in time unless the host clock went back, so none is skipped by order
+    const log_file_t *file = &log_files[i];
+    if (file->blocks == 0 || file->t_last_ms < from_ms || file->t_first_ms > to_ms)
+      continue;
+
+    char path[32];
+    file_path(file->seq, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f)
+      continue;
+
+    log_block_header_t hdr;
+    for (uint32_t b = first_block(f, file->blocks, from_ms); b < file->blocks && !*more; b++)
+    {
+      if (!read_header(f, b, &hdr))
+        continue;
+      if (hdr.t_first_ms > to_ms)
+        break;
+
+      size_t t_start = sizeof(hdr), t_len = hdr.column_end[0] - t_start;
+      size_t v_start = hdr.column_end[metric], v_len = hdr.column_end[1 + metric] - v_start;
+      long base = (long)b * LOG_BLOCK_SIZE;
+      if (fseek(f, base + t_start, SEEK_SET) != 0 || fread(times, 1, t_len, f) != t_len ||
+          fseek(f, base + v_start, SEEK_SET) != 0 || fread(column, 1, v_len, f) != v_len ||
+          esp_rom_crc32_le(0, times, t_len) != hdr.column_crc[0] ||
+          esp_rom_crc32_le(0, column, v_len) != hdr.column_crc[1 + metric])
+      {
+        log_errors++;
+        continue;
+      }
+
+      const uint8_t *tp = times, *vp = column;
+      uint64_t t = hdr.t_first_ms;
+      int64_t v = 0;
+      for (uint16_t k = 0; k < hdr.samples; k++)
+      {
+        uint64_t dt, dv;
+        if (!varint_get(&tp, times + t_len, &dt) || !varint_get(&vp, column + v_len, &dv))
+          break;
+        t += dt;
+        v += unzigzag(dv);
+        if (t < from_ms)
+          continue;
+        if (t > to_ms)
+          break;
+        if (n == max_points)
+        {
+          *more = true;
+          break;
+        }
+        out[n].t_ms = t;
+        out[n].value = (int32_t)v;
+        n++;
+      }
+    }
+    fclose(f);
+  }
+  xSemaphoreGive(files_mutex);
+
+  heap_caps_free(column);
+  return n;
+}
+
+/**
+ * @brief Next file after seq holding samples in [from_ms, to_ms]
+ */
+static bool next_file(uint32_t after_seq, uint64_t from_ms, uint64_t to_ms, log_file_t *out)
+{
+  bool found = false;
+  xSemaphoreTake(files_mutex, portMAX_DELAY);
+  for (int i = 0; i < log_file_count && !found; i++)
+  {
+    const log_file_t *file = &log_files[i];
+    if (file->seq > after_seq && file->blocks > 0 && file->t_last_ms >= from_ms && file->t_first_ms <= to_ms)
+    {
+      *out = *file;
+      found = true;
+    }
+  }
+  xSemaphoreGive(files_mutex);
+  return found;
+}
+
+/**
+ * @brief Write the samples of export_block in [from_ms, to_ms] as CSV rows
+ * @param text Pending text, handed to write whenever the next row might not fit
+ */
+static esp_err_t export_csv_block(const log_block_header_t *hdr, uint64_t from_ms, uint64_t to_ms, char *text,
+                                  size_t *len, telemetry_export_write_fn_t write, void *ctx)
+{
+  const uint8_t *p[LOG_COLUMNS];
+  const uint8_t *end[LOG_COLUMNS];
+  size_t start = sizeof(*hdr);
+  for (int c = 0; c < LOG_COLUMNS; c++)
+  {
+    p[c] = export_block + start;
+    end[c] = export_block + hdr->column_end[c];
+    if (esp_rom_crc32_le(0, p[c], end[c] - p[c]) != hdr->column_crc[c])
+    {
+      log_errors++;
+      return ESP_OK;
+    }
+    start = hdr->column_end[c];
+  }
+
+  uint64_t t = hdr->t_first_ms;
+  int64_t v[TELEMETRY_METRIC_COUNT] = {0};
+  for (uint16_t k = 0; k < hdr->samples; k++)
+  {
+    uint64_t d;
+    if (!varint_get(&p[0], end[0], &d))
+      break;
+    t += d;
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      if (!varint_get(&p[1 + m], end[1 + m], &d))
+        return ESP_OK;
+      v[m] += unzigzag(d);
+    }
+    if (t < from_ms || t > to_ms)
+      continue;
+
+    if (*len + LOG_EXPORT_ROW_MAX > LOG_EXPORT_TEXT)
+    {
+      esp_err_t err = write(ctx, text, *len);
+      *len = 0;
+      if (err != ESP_OK)
+        return err;
+    }
+    *len += sprintf(text + *len, "%llu", (unsigned long long)t);
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      *len += sprintf(text + *len, ",%ld", (long)v[m]);
+    }
+    text[(*len)++] = '\n';
+  }
+  return ESP_OK;
+}
+
+static bool handle_history_command(const char *args)
+{
+  // GET_SD_HISTORY <metric> <from_ms> <to_ms> [max_points]
+  char metric_arg[16] = "";
+  unsigned long long from_ms = 0, to_ms = UINT64_MAX;
+  int max_points = LOG_REPLY_POINTS_DEFAULT;
+  int fields = sscanf(args, "%15s %llu %llu %d", metric_arg, &from_ms, &to_ms, &max_points);
+
+  int metric = -1;
+  for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+  {
+    if (strcmp(telemetry_history_metric_name(m), metric_arg) == 0)
+      metric = m;
+  }
+  if (fields < 3 || metric < 0)
+  {
+    static const char usage[] = "SD_HISTORY {\"error\":\"usage: GET_SD_HISTORY <metric> <from_ms> <to_ms> [max_points]\"}\n";
+    serial_data_write(usage, sizeof(usage) - 1);
+    return true;
+  }
+  if (log_state != LOG_STATE_LOGGING)
+  {
+    static const char no_card[] = "SD_HISTORY {\"error\":\"no card\"}\n";
+    serial_data_write(no_card, sizeof(no_card) - 1);
+    return true;
+  }
+
+  if (max_points < 1)
+    max_points = 1;
+  if (max_points > LOG_REPLY_POINTS_MAX)
+    max_points = LOG_REPLY_POINTS_MAX;
+
+  log_point_t *points = heap_caps_malloc(max_points * sizeof(*points), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!points)
+  {
+    static const char oom[] = "SD_HISTORY {\"error\":\"no memory\"}\n";
+    serial_data_write(oom, sizeof(oom) - 1);
+    return true;
+  }
+  bool more;
+  size_t count = query(metric, from_ms, to_ms, points, max_points, &more);
+
+  // One line, written in pieces so the reply needs no large buffer
+  char buf[64];
+  int len = snprintf(buf, sizeof(buf), "SD_HISTORY {\"metric\":\"%s\",\"points\":[", metric_arg);
+  serial_data_write(buf, len);
+  for (size_t i = 0; i < count; i++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s[%llu,%ld]", i ? "," : "", (unsigned long long)points[i].t_ms,
+                   (long)points[i].value);
+    serial_data_write(buf, len);
+  }
+  len = snprintf(buf, sizeof(buf), "],\"more\":%s}\n", more ? "true" : "false");
+  serial_data_write(buf, len);
+
+  heap_caps_free(points);
+  return true;
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t telemetry_sd_log_start(void)
+{
+  if (log_state != LOG_STATE_OFF)
+    return ESP_OK;
+
+  log_mutex = xSemaphoreCreateMutex();
+  files_mutex = xSemaphoreCreateMutex();
+  log_free_queue = xQueueCreate(LOG_STAGING_BLOCKS, sizeof(log_staging_t *));
+  log_full_queue = xQueueCreate(LOG_STAGING_BLOCKS, sizeof(log_staging_t *));
+  if (!log_mutex || !files_mutex || !log_free_queue || !log_full_queue)
+    return ESP_ERR_NO_MEM;
+
+  export_mutex = xSemaphoreCreateMutex();
+  export_block = heap_caps_malloc(LOG_BLOCK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!export_mutex || !export_block)
+    return ESP_ERR_NO_MEM;
+
+  // Internal DMA memory lets the SPI host send the block without a bounce copy per sector
+  log_block = heap_caps_malloc(LOG_BLOCK_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  if (!log_block)
+    log_block = heap_caps_malloc(LOG_BLOCK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!log_block)
+    return ESP_ERR_NO_MEM;
+  for (int i = 0; i < LOG_STAGING_BLOCKS; i++)
+  {
+    log_staging_t *s = heap_caps_malloc(sizeof(log_staging_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s)
+      return ESP_ERR_NO_MEM;
+    xQueueSend(log_free_queue, &s, 0);
+  }
+
+  log_state = LOG_STATE_MOUNTING;
+  if (task_plan_create(TASK_PLAN_TELEMETRY_SD_LOG, log_task, NULL, &log_task_handle) != pdPASS)
+  {
+    log_state = LOG_STATE_OFF;
+    debug_log_error(DEBUG_TAG_SERIAL_DATA, "Failed to create telemetry_sd_log task");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t telemetry_sd_log_export(uint64_t from_ms, uint64_t to_ms, telemetry_sd_log_format_t format,
+                                  telemetry_export_write_fn_t write, void *ctx)
+{
+  if (!write)
+    return ESP_ERR_INVALID_ARG;
+  if (log_state != LOG_STATE_LOGGING)
+    return ESP_ERR_INVALID_STATE;
+  if (xSemaphoreTake(export_mutex, 0) != pdTRUE)
+    return ESP_ERR_TIMEOUT;
+
+  char text[LOG_EXPORT_TEXT];
+  size_t len = 0;
+  if (format == TELEMETRY_SD_LOG_CSV)
+  {
+    len = sprintf(text, "t_ms");
+    for (int m = 0; m < TELEMETRY_METRIC_COUNT; m++)
+    {
+      len += sprintf(text + len, ",%s", telemetry_history_metric_name(m));
+    }
+    text[len++] = '\n';
+  }
+
+  // The file index is only held to pick the next file, blocks are read and sent without it
+  esp_err_t err = ESP_OK;
+  log_file_t file;
+  uint32_t seq = 0;
+  while (err == ESP_OK && next_file(seq, from_ms, to_ms, &file))
+  {
+    seq = file.seq;
+    char path[32];
+    file_path(file.seq, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f)
+      continue;
+
+    for (uint32_t b = first_block(f, file.blocks, from_ms); b < file.blocks && err == ESP_OK; b++)
+    {
+      log_block_header_t hdr;
+      if (fseek(f, (long)b * LOG_BLOCK_SIZE, SEEK_SET) != 0 ||
+          fread(export_block, 1, LOG_BLOCK_SIZE, f) != LOG_BLOCK_SIZE)
+        break;
+      memcpy(&hdr, export_block, sizeof(hdr));
+      if (!header_valid(&hdr) || hdr.t_last_ms < from_ms)
+        continue;
+      if (hdr.t_first_ms > to_ms)
+        break;
+
+      if (format == TELEMETRY_SD_LOG_BINARY)
+        err = write(ctx, export_block, LOG_BLOCK_SIZE);
+      else
+        err = export_csv_block(&hdr, from_ms, to_ms, text, &len, write, ctx);
+    }
+    fclose(f);
+  }
+
+  if (err == ESP_OK && len > 0)
+    err = write(ctx, text, len);
+  xSemaphoreGive(export_mutex);
+  return err;
+}
+
+bool telemetry_sd_log_handle_command(const char *line)
+{
+  static const char history[] = "GET_SD_HISTORY";
+  if (strncmp(line, history, sizeof(history) - 1) == 0 &&
+      (line[sizeof(history) - 1] == ' ' || line[sizeof(history) - 1] == '\0'))
+    return handle_history_command(line + sizeof(history) - 1);
+  if (strcmp(line, "GET_SD_LOG") != 0)
+    return false;
+
+  uint64_t total = 0, free_bytes = 0;
+  int files = 0;
+  unsigned long seq = 0;
+  unsigned long long oldest = 0;
+  if (log_state == LOG_STATE_LOGGING)
+  {
+    esp_vfs_fat_info(LOG_MOUNT_POINT, &total, &free_bytes);
+    xSemaphoreTake(files_mutex, portMAX_DELAY);
+    files = log_file_count;
+    seq = log_file ? (unsigned long)log_files[log_file_count - 1].seq : 0;
+    oldest = files ? (unsigned long long)log_files[0].t_first_ms : 0;
+    xSemaphoreGive(files_mutex);
+  }
+
+  char reply[320];
+  int len = snprintf(reply, sizeof(reply),
+                     "SD_LOG {\"state\":\"%s\",\"block_kb\":%d,\"files\":%d,\"file\":%lu,\"oldest_ms\":%llu,"
+                     "\"card_mb\":%llu,\"free_mb\":%llu,\"blocks\":%lu,\"samples\":%lu,\"dropped\":%lu,"
+                     "\"errors\":%lu}\n",
+                     state_names[log_state], CONFIG_TELEMETRY_SD_LOG_BLOCK_KB, files, seq, oldest,
+                     (unsigned long long)(total >> 20), (unsigned long long)(free_bytes >> 20),
+                     (unsigned long)log_blocks_written, (unsigned long)log_samples_written,
+                     (unsigned long)log_samples_dropped, (unsigned long)log_errors);
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+esp_err_t telemetry_sd_log_start(void)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t telemetry_sd_log_export(uint64_t from_ms, uint64_t to_ms, telemetry_sd_log_format_t format,
+                                  telemetry_export_write_fn_t write, void *ctx)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool telemetry_sd_log_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_SD_LOG") != 0 && strncmp(line, "GET_SD_HISTORY", 14) != 0)
+    return false;
+  static const char disabled[] = "SD_LOG {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_TELEMETRY_SD_LOG
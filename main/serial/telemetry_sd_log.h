@@ -0,0 +1,84 @@
+/**
+ * @file telemetry_sd_log.h
+ * @brief Telemetry Log on the SD Card
+ *
+ * Keeps the local source's samples on the TF card beyond what the PSRAM
+ * history (telemetry_history.h) holds. Samples are collected in PSRAM as
+ * one column per metric and written as fixed-size blocks from a low
+ * priority task, so the card sees whole-block writes at block-aligned
+ * offsets and the feeding task never waits for it.
+ *
+ * File layout, /sdcard/TLOG/<seq>.TLG, a new file per boot, per size limit
+ * and whenever the host clock goes backwards, so time is ascending within a
+ * file. Every block is CONFIG_TELEMETRY_SD_LOG_BLOCK_KB long:
+ *
+ *   header  magic "TLB1", version, sample and metric count, first and last
+ *           sample time (ms), CRC-32 of the columns, end offset of each column
+ *   column  timestamps: unsigned LEB128 deltas to the previous sample
+ *   column  one per metric (telemetry_metric_t order): zigzag LEB128 deltas,
+ *           the first against 0; the rest of the block is zero padding
+ *
+ * Each file's time range is kept in memory and blocks are found inside a
+ * file by binary search over their headers, so a query reads only the
+ * headers on its way and the timestamp and metric columns it returns.
+ *
+ * GET_SD_LOG reports the card and counters, GET_SD_HISTORY <metric>
+ * <from_ms> <to_ms> [max_points] replies
+ *   SD_HISTORY {"metric":"cpu_usage","points":[[t_ms,value],...],"more":false}
+ * where "more" asks for another query from the last t_ms + 1.
+ *
+ * telemetry_sd_log_export() streams a time range block by block as CSV or
+ * as the blocks themselves, for /history on the diagnostics server and
+ * EXPORT_HISTORY (telemetry_export.h).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "telemetry_history.h"
+
+// =======================================================================
+// TYPES
+// =======================================================================
+
+typedef enum
+{
+  TELEMETRY_SD_LOG_CSV,    ///< "t_ms,cpu_usage,..." header, one row per sample
+  TELEMETRY_SD_LOG_BINARY, ///< Every block that overlaps the range, as stored
+} telemetry_sd_log_format_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Allocate the block buffers and start the writer task, which mounts the card
+ * @return ESP_OK on success (or if already running), ESP_ERR_NO_MEM,
+ *         ESP_ERR_NOT_SUPPORTED if CONFIG_TELEMETRY_SD_LOG is disabled
+ * @note A missing card is reported by the task and in GET_SD_LOG, not here
+ */
+esp_err_t telemetry_sd_log_start(void);
+
+/**
+ * @brief Stream the samples of a time range, oldest file first
+ * @param from_ms First time included
+ * @param to_ms Last time included
+ * @param format CSV rows or raw blocks
+ * @param write Receives up to 1 KB of text or one block per call
+ * @param ctx Passed to write
+ * @return ESP_OK, the error of write, ESP_ERR_INVALID_STATE without a card,
+ *         ESP_ERR_TIMEOUT while another export runs, ESP_ERR_NOT_SUPPORTED if disabled
+ * @note Uses a block buffer allocated at start and 1 KB of the caller's stack, nothing from
+ *       the heap; the file index is held only between files, never while write runs
+ */
+esp_err_t telemetry_sd_log_export(uint64_t from_ms, uint64_t to_ms, telemetry_sd_log_format_t format,
+                                  telemetry_export_write_fn_t write, void *ctx);
+
+/**
+ * @brief Handle GET_SD_LOG and GET_SD_HISTORY
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was an SD log command
+ */
+bool telemetry_sd_log_handle_command(const char *line);
@@ -1,428 +1,1487 @@
-﻿/**
- * @file entity_states_parser.c
- * @brief Async Entity States JSON Parser Implementation
- *
- * This module provides asynchronous JSON parsing functionality for Home Assistant
- * entity states using SPIRAM for large response handling. The parser runs on
- * CPU idle time to avoid blocking the main application.
- *
- * @author System Monitor Dashboard
- * @date 2025-08-19
- */
-
-#include "entity_states_parser.h"
-
-#include <string.h>
-#include "cJSON.h"
-#include "esp_heap_caps.h"
-#include "esp_task_wdt.h"
-#include "esp_timer.h"
-#include "system_debug_utils.h"
-
-// =======================================================================
-// CONSTANTS AND MACROS
-// =======================================================================
-
-// =======================================================================
-// STATIC VARIABLES
-// =======================================================================
-
-static QueueHandle_t parse_queue = NULL;
-static TaskHandle_t parse_task_handle = NULL;
-static bool parser_initialized = false;
-static entity_parser_stats_t parser_stats = {0};
-
-// =======================================================================
-// PRIVATE FUNCTION DECLARATIONS
-// =======================================================================
-
-/**
- * @brief Main async JSON parsing task
- * @param pvParameters Task parameters (unused)
- */
-static void entity_parse_task(void *pvParameters);
-
-/**
- * @brief Parse entity states from JSON data
- * @param json_data Raw JSON string
- * @param entity_ids Array of entity IDs to find
- * @param entity_count Number of entities to find
- * @param states Output array for entity states
- * @return Number of entities successfully parsed
- */
-static int parse_entity_states_from_json(
-    const char *json_data,
-    const char **entity_ids,
-    int entity_count,
-    ha_entity_state_t *states);
-
-// =======================================================================
-// PUBLIC FUNCTION IMPLEMENTATIONS
-// =======================================================================
-
-esp_err_t entity_states_parser_init(void)
-{
-  if (parser_initialized)
-  {
-
-    return ESP_OK;
-  }
-
-  // Create queue for parsing jobs
-  parse_queue = xQueueCreate(ENTITY_PARSER_MAX_JOBS, sizeof(entity_parse_job_t));
-  if (parse_queue == NULL)
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Failed to create parse queue");
-    return ESP_ERR_NO_MEM;
-  }
-
-  // Create async parsing task with low priority (runs on CPU idle)
-  BaseType_t task_created = xTaskCreatePinnedToCore(
-      entity_parse_task,             // Task function
-      "entity_parser",               // Task name
-      ENTITY_PARSER_TASK_STACK_SIZE, // Stack size
-      NULL,                          // Parameters
-      ENTITY_PARSER_TASK_PRIORITY,   // Priority (low for idle processing)
-      &parse_task_handle,            // Task handle
-      ENTITY_PARSER_TASK_CORE        // Core affinity
-  );
-
-  if (task_created != pdPASS)
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Failed to create parse task");
-    vQueueDelete(parse_queue);
-    parse_queue = NULL;
-    return ESP_ERR_NO_MEM;
-  }
-
-  // Reset statistics
-  memset(&parser_stats, 0, sizeof(parser_stats));
-
-  parser_initialized = true;
-  debug_log_startup(DEBUG_TAG_PARSER, "Entity States Parser");
-
-  return ESP_OK;
-}
-
-void entity_states_parser_deinit(void)
-{
-  if (!parser_initialized)
-  {
-    return;
-  }
-
-  // Delete task
-  if (parse_task_handle)
-  {
-    vTaskDelete(parse_task_handle);
-    parse_task_handle = NULL;
-  }
-
-  // Delete queue
-  if (parse_queue)
-  {
-    vQueueDelete(parse_queue);
-    parse_queue = NULL;
-  }
-
-  parser_initialized = false;
-}
-
-esp_err_t entity_states_parser_submit_async(
-    const char *json_data,
-    size_t json_size,
-    const char **entity_ids,
-    int entity_count,
-    ha_entity_state_t *states)
-{
-  if (!parser_initialized)
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Parser not initialized");
-    return ESP_ERR_INVALID_STATE;
-  }
-
-  if (!json_data || !entity_ids || !states || entity_count <= 0)
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Invalid parameters");
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  // Allocate SPIRAM for JSON data copy
-  char *json_copy = heap_caps_malloc(json_size + 1, MALLOC_CAP_SPIRAM);
-  if (!json_copy)
-  {
-    debug_log_error_f(DEBUG_TAG_PARSER, "Failed to allocate %zu bytes in SPIRAM for JSON", json_size);
-    return ESP_ERR_NO_MEM;
-  }
-
-  // Copy JSON data to SPIRAM
-  memcpy(json_copy, json_data, json_size);
-  json_copy[json_size] = '\0';
-
-  // Create parse job
-  entity_parse_job_t job = {
-      .json_data = json_copy,
-      .json_size = json_size,
-      .entity_ids = entity_ids,
-      .entity_count = entity_count,
-      .states = states,
-      .caller_task = xTaskGetCurrentTaskHandle()};
-
-  // Submit job to queue
-  if (xQueueSend(parse_queue, &job, 0) != pdTRUE)
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Parse queue is full, cannot submit job");
-    heap_caps_free(json_copy);
-    return ESP_ERR_NO_MEM;
-  }
-
-  return ESP_OK;
-}
-
-esp_err_t entity_states_parser_wait_completion(uint32_t timeout_ms)
-{
-  if (!parser_initialized)
-  {
-    return ESP_ERR_INVALID_STATE;
-  }
-
-  // Convert timeout to ticks
-  TickType_t timeout_ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-
-  // Wait for notification from parse task
-  uint32_t notification_value = ulTaskNotifyTake(pdTRUE, timeout_ticks);
-
-  if (notification_value == 0)
-  {
-    debug_log_warning_f(DEBUG_TAG_PARSER, "Parse operation timed out after %lu ms", timeout_ms);
-    return ESP_ERR_TIMEOUT;
-  }
-
-  return ESP_OK;
-}
-
-esp_err_t entity_states_parser_parse_sync(
-    const char *json_data,
-    const char **entity_ids,
-    int entity_count,
-    ha_entity_state_t *states)
-{
-  if (!json_data || !entity_ids || !states || entity_count <= 0)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  int64_t start_time = esp_timer_get_time();
-
-  // Parse entities synchronously
-  int found_count = parse_entity_states_from_json(json_data, entity_ids, entity_count, states);
-
-  int64_t parse_time = esp_timer_get_time() - start_time;
-
-  // Update statistics
-  parser_stats.jobs_processed++;
-  parser_stats.entities_found += found_count;
-  parser_stats.entities_missing += (entity_count - found_count);
-  parser_stats.total_parse_time_ms += parse_time / 1000;
-  parser_stats.average_parse_time_ms = parser_stats.total_parse_time_ms / parser_stats.jobs_processed;
-
-  return (found_count > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
-}
-
-esp_err_t entity_states_parser_get_stats(entity_parser_stats_t *stats)
-{
-  if (!stats)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  memcpy(stats, &parser_stats, sizeof(entity_parser_stats_t));
-  return ESP_OK;
-}
-
-void entity_states_parser_reset_stats(void)
-{
-  memset(&parser_stats, 0, sizeof(parser_stats));
-}
-
-bool entity_states_parser_is_ready(void)
-{
-  return parser_initialized;
-}
-
-int entity_states_parser_get_queue_size(void)
-{
-  if (!parse_queue)
-  {
-    return -1;
-  }
-
-  return uxQueueMessagesWaiting(parse_queue);
-}
-
-// =======================================================================
-// PRIVATE FUNCTION IMPLEMENTATIONS
-// =======================================================================
-
-static void entity_parse_task(void *pvParameters)
-{
-  entity_parse_job_t job;
-
-  while (1)
-  {
-    // Wait for parse jobs with a timeout to allow periodic cleanup
-    const TickType_t QUEUE_TIMEOUT_MS = pdMS_TO_TICKS(10000); // 10 second timeout
-
-    if (xQueueReceive(parse_queue, &job, QUEUE_TIMEOUT_MS) == pdTRUE)
-    {
-
-      int64_t start_time = esp_timer_get_time();
-
-      // Parse entities from JSON
-      int found_count = parse_entity_states_from_json(
-          job.json_data,
-          job.entity_ids,
-          job.entity_count,
-          job.states);
-
-      int64_t parse_time = esp_timer_get_time() - start_time;
-
-      // Update statistics
-      parser_stats.jobs_processed++;
-      parser_stats.entities_found += found_count;
-      parser_stats.entities_missing += (job.entity_count - found_count);
-      parser_stats.total_parse_time_ms += parse_time / 1000;
-      parser_stats.average_parse_time_ms = parser_stats.total_parse_time_ms / parser_stats.jobs_processed;
-
-      // Update largest response size
-      if (job.json_size > parser_stats.largest_response_size)
-      {
-        parser_stats.largest_response_size = job.json_size;
-      }
-
-      // Free SPIRAM JSON data
-      if (job.json_data)
-      {
-        heap_caps_free(job.json_data);
-      }
-
-      // Notify caller that processing is complete
-      xTaskNotifyGive(job.caller_task);
-    }
-    // No else clause needed - timeout is just for periodic cleanup
-  }
-}
-
-static int parse_entity_states_from_json(
-    const char *json_data,
-    const char **entity_ids,
-    int entity_count,
-    ha_entity_state_t *states)
-{
-  if (!json_data || !entity_ids || !states)
-  {
-    return 0;
-  }
-
-  // Parse JSON
-  cJSON *json = cJSON_Parse(json_data);
-  if (!json)
-  {
-    const char *error_ptr = cJSON_GetErrorPtr();
-    if (error_ptr != NULL)
-    {
-      long error_pos = error_ptr - json_data;
-      debug_log_error_f(DEBUG_TAG_PARSER, "JSON parse failed: %s at position %ld", error_ptr, error_pos);
-    }
-    else
-    {
-      debug_log_error(DEBUG_TAG_PARSER, "JSON parse failed: Unknown error");
-    }
-    return 0;
-  }
-
-  if (!cJSON_IsArray(json))
-  {
-    debug_log_error(DEBUG_TAG_PARSER, "Expected JSON array for entity states");
-    cJSON_Delete(json);
-    return 0;
-  }
-
-  int array_size = cJSON_GetArraySize(json);
-  int success_count = 0;
-
-  debug_log_info_f(DEBUG_TAG_PARSER,
-                   "Processing JSON array with %d entities, searching for %d requested entities",
-                   array_size, entity_count);
-
-  // Clear all states first
-  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
-
-  // Look for our requested entities in the JSON response
-  for (int i = 0; i < entity_count; i++)
-  {
-    // Search through all entities in JSON response
-    int entity_index = 0;
-    cJSON *entity = NULL;
-    cJSON_ArrayForEach(entity, json)
-    {
-      entity_index++;
-
-      if (!cJSON_IsObject(entity))
-        continue;
-
-      cJSON *entity_id_json = cJSON_GetObjectItem(entity, "entity_id");
-      if (!entity_id_json || !cJSON_IsString(entity_id_json))
-        continue;
-
-      // Check if this is one of our requested entities
-      if (strcmp(cJSON_GetStringValue(entity_id_json), entity_ids[i]) == 0)
-      {
-        // Found matching entity, extract its state
-        cJSON *state_json = cJSON_GetObjectItem(entity, "state");
-        if (!state_json || !cJSON_IsString(state_json))
-        {
-          // Entity has no valid state - skip without verbose logging
-          break;
-        }
-
-        // Fill in the state data
-        ha_entity_state_t *state = &states[i];
-
-        // Copy entity ID
-        strncpy(state->entity_id, entity_ids[i], sizeof(state->entity_id) - 1);
-        state->entity_id[sizeof(state->entity_id) - 1] = '\0';
-
-        // Copy state value
-        strncpy(state->state, cJSON_GetStringValue(state_json), sizeof(state->state) - 1);
-        state->state[sizeof(state->state) - 1] = '\0';
-
-        // Extract friendly name from attributes if available
-        cJSON *attributes = cJSON_GetObjectItem(entity, "attributes");
-        if (attributes && cJSON_IsObject(attributes))
-        {
-          cJSON *friendly_name = cJSON_GetObjectItem(attributes, "friendly_name");
-          if (friendly_name && cJSON_IsString(friendly_name))
-          {
-            strncpy(state->friendly_name, cJSON_GetStringValue(friendly_name), sizeof(state->friendly_name) - 1);
-            state->friendly_name[sizeof(state->friendly_name) - 1] = '\0';
-          }
-        }
-
-        // Set timestamp
-        state->last_updated = time(NULL);
-
-        success_count++;
-        break;
-      }
-    }
-  }
-
-  cJSON_Delete(json);
-
-  debug_log_info_f(DEBUG_TAG_PARSER,
-                   "Parsing completed: found %d/%d entities",
-                   success_count, entity_count);
-
-  return success_count;
-}
+﻿/**
+ * @file entity_states_parser.c
+ * @brief Async Entity States JSON Parser Implementation
+ *
+ * This module provides asynchronous JSON parsing functionality for Home Assistant
+ * entity states using SPIRAM for large response handling. The parser runs on
+ * CPU idle time to avoid blocking the main application.
+ *
+ * @author System Monitor Dashboard
+ * @date 2025-08-19
+ */
+
+#include "entity_states_parser.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cycle_prof.h"
+#include "esp_heap_caps.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "json_arena.h"
+#include "metrics.h"
+#include "shared_state.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "task_stack.h"
+#include "trace_spans.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+/** Fields of an /api/states entity the streaming parser keeps */
+enum
+{
+  STREAM_FIELD_NONE = 0,
+  STREAM_FIELD_ENTITY_ID,
+  STREAM_FIELD_STATE,
+  STREAM_FIELD_ATTRIBUTES,
+  STREAM_FIELD_FRIENDLY_NAME,
+  STREAM_FIELD_LAST_CHANGED,
+  STREAM_FIELD_LAST_UPDATED,
+  STREAM_FIELD_BRIGHTNESS,
+  STREAM_FIELD_TEMPERATURE,
+};
+
+/** Depth of entity objects, inside the top-level array */
+#define STREAM_ENTITY_DEPTH 2
+
+/** Key every /api/states element starts with, marks where B may begin */
+#define SPLIT_MARKER "\"entity_id\""
+
+/**
+ * @brief Lifecycle of a job slot
+ */
+typedef enum
+{
+  PARSE_SLOT_FREE = 0,
+  PARSE_SLOT_QUEUED,
+  PARSE_SLOT_RUNNING,
+  PARSE_SLOT_DONE,
+} parse_slot_state_t;
+
+/**
+ * @brief One submitted job, owned by its handle until waited for or cancelled
+ */
+typedef struct
+{
+  entity_parse_handle_t handle;
+  parse_slot_state_t state;  ///< Changed under slots_lock
+  volatile bool cancel;      ///< Checked by the workers between chunks
+  char *json_data;           ///< Private SPIRAM copy
+  size_t json_size;
+  const char **entity_ids;
+  int entity_count;
+  ha_entity_state_t *states; ///< Caller's output
+  esp_err_t result;
+  int found_count;
+  SemaphoreHandle_t done;    ///< Given once when the job leaves RUNNING
+} parse_slot_t;
+
+/**
+ * @brief Back half of a split document, handed to the second worker
+ */
+typedef struct
+{
+  const char *data;          ///< First byte after the splitting comma
+  size_t len;
+  const char **entity_ids;
+  int entity_count;
+  ha_entity_state_t *states; ///< Scratch array, merged by the primary
+  volatile bool *cancel;
+  esp_err_t result;          ///< Written by the helper before range_done
+  int found_count;
+} parse_range_t;
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static QueueHandle_t parse_queue = NULL; ///< Handles of queued jobs
+static TaskHandle_t parse_task_handle = NULL;
+static bool parser_initialized = false;
+static entity_parser_stats_t parser_stats = {0};
+static seqlock_t parser_stats_seq = SEQLOCK_INIT;                      ///< Readers copy the stats lock-free
+static portMUX_TYPE parser_stats_lock = portMUX_INITIALIZER_UNLOCKED; ///< Serializes the stats writers
+
+CYCLE_PROF_SITE(parse_entity_states_from_json);
+
+// Reads a 32-bit field of parser_stats, size_t is 32 bits on this target
+static int64_t read_parser_stat(const metric_t *metric)
+{
+  return shared_load_u32((const uint32_t *)((const uint8_t *)&parser_stats + metric->arg));
+}
+
+static metric_t parser_metrics[] = {
+    METRIC_READ_INIT(METRIC_TYPE_COUNTER, "ha_parser_jobs_total", "State responses parsed", NULL,
+                     read_parser_stat, offsetof(entity_parser_stats_t, jobs_processed)),
+    METRIC_READ_INIT(METRIC_TYPE_COUNTER, "ha_parser_entities_found_total", "Registry entities found in responses",
+                     NULL, read_parser_stat, offsetof(entity_parser_stats_t, entities_found)),
+    METRIC_READ_INIT(METRIC_TYPE_COUNTER, "ha_parser_entities_missing_total",
+                     "Registry entities absent from responses", NULL, read_parser_stat,
+                     offsetof(entity_parser_stats_t, entities_missing)),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "ha_parser_largest_response_bytes", "Largest state response parsed", NULL,
+                     read_parser_stat, offsetof(entity_parser_stats_t, largest_response_size)),
+};
+
+// First bucket 64 us, the last finite one about 1 s
+static metric_histogram_t parse_duration_metric =
+    METRIC_HISTOGRAM_INIT("ha_parse_duration_us", "Time to parse one state response", 6);
+
+static parse_slot_t parse_slots[ENTITY_PARSER_MAX_JOBS];
+static portMUX_TYPE slots_lock = portMUX_INITIALIZER_UNLOCKED;
+static entity_parse_handle_t next_handle = 1;
+static entity_stream_parser_t job_parser; ///< Only used by entity_parse_task
+
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+static QueueHandle_t range_queue = NULL;
+static TaskHandle_t helper_task_handle = NULL;
+static SemaphoreHandle_t range_done = NULL;
+static entity_stream_parser_t helper_parser; ///< Only used by entity_parse_helper_task
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Main async JSON parsing task
+ * @param pvParameters Task parameters (unused)
+ */
+static void entity_parse_task(void *pvParameters);
+
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+/**
+ * @brief Second worker, parses the back half of split documents
+ * @param pvParameters Task parameters (unused)
+ */
+static void entity_parse_helper_task(void *pvParameters);
+#endif
+
+/**
+ * @brief Run one job to completion or cancellation
+ * @param slot Job in RUNNING state
+ */
+static void run_parse_job(parse_slot_t *slot);
+
+/**
+ * @brief Stream a byte range through a parser, framed as a complete array
+ * @param parser Parser to use
+ * @param prefix Text fed before the range, may be NULL
+ * @param data Range of the document
+ * @param len Range length
+ * @param suffix Text fed after the range, may be NULL
+ * @param entity_ids Array of entity IDs to find
+ * @param entity_count Number of entities to find
+ * @param states Output array for entity states
+ * @param cancel Polled between chunks
+ * @return Same codes as entity_states_stream_finish(), ESP_ERR_INVALID_STATE if cancelled
+ */
+static esp_err_t parse_range(entity_stream_parser_t *parser, const char *prefix, const char *data, size_t len,
+                             const char *suffix, const char **entity_ids, int entity_count,
+                             ha_entity_state_t *states, volatile bool *cancel);
+
+/**
+ * @brief Find where a document can be cut in two
+ * @param json_data Document
+ * @param json_size Document length
+ * @return Offset of a top-level comma near the middle, 0 if none was found
+ */
+static size_t find_split(const char *json_data, size_t json_size);
+
+/**
+ * @brief Account one parse in the statistics
+ */
+static void record_parse_stats(int found_count, int entity_count, int64_t parse_time_us, size_t bytes);
+
+/**
+ * @brief Result of a streaming parse, without logging or statistics
+ */
+static esp_err_t stream_result(const entity_stream_parser_t *parser);
+
+/**
+ * @brief Find a job slot by handle
+ * @return Slot, NULL if the handle is unknown; call with slots_lock held
+ */
+static parse_slot_t *find_slot(entity_parse_handle_t handle);
+
+/**
+ * @brief Return a slot to the free pool
+ */
+static void release_slot(parse_slot_t *slot);
+
+/**
+ * @brief Parse entity states from JSON data
+ * @param json_data Raw JSON string
+ * @param entity_ids Array of entity IDs to find
+ * @param entity_count Number of entities to find
+ * @param states Output array for entity states
+ * @return Number of entities successfully parsed
+ */
+static int parse_entity_states_from_json(
+    const char *json_data,
+    const char **entity_ids,
+    int entity_count,
+    ha_entity_state_t *states);
+
+/**
+ * @brief Hash an entity ID for the lookup table
+ * @param entity_id NUL terminated entity ID
+ * @return 32-bit hash
+ */
+static uint32_t entity_id_hash(const char *entity_id);
+
+/**
+ * @brief Advance the streaming tokeniser by one character
+ * @param parser Streaming parser state
+ * @param c Next character of the document
+ */
+static void stream_process_char(entity_stream_parser_t *parser, char c);
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t entity_states_parser_init(void)
+{
+  if (parser_initialized)
+  {
+
+    return ESP_OK;
+  }
+
+  for (size_t i = 0; i < sizeof(parser_metrics) / sizeof(parser_metrics[0]); i++)
+  {
+    metrics_register(&parser_metrics[i]);
+  }
+  metrics_register_histogram(&parse_duration_metric);
+
+  // Create queue for parsing jobs
+  parse_queue = xQueueCreate(ENTITY_PARSER_MAX_JOBS, sizeof(entity_parse_handle_t));
+  if (parse_queue == NULL)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Failed to create parse queue");
+    return ESP_ERR_NO_MEM;
+  }
+
+  // One completion semaphore per slot, so a result can only reach its own handle
+  for (int i = 0; i < ENTITY_PARSER_MAX_JOBS; i++)
+  {
+    memset(&parse_slots[i], 0, sizeof(parse_slot_t));
+    parse_slots[i].done = xSemaphoreCreateBinary();
+    if (parse_slots[i].done == NULL)
+    {
+      debug_log_error(DEBUG_TAG_PARSER, "Failed to create job semaphore");
+      entity_states_parser_deinit();
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  // Pure parsing never touches flash, so the stack can live in PSRAM
+  BaseType_t task_created = task_plan_create(TASK_PLAN_ENTITY_PARSER, entity_parse_task, NULL, &parse_task_handle);
+
+  if (task_created != pdPASS)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Failed to create parse task");
+    entity_states_parser_deinit();
+    return ESP_ERR_NO_MEM;
+  }
+
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+  // Without the helper every job is parsed whole by the primary
+  range_queue = xQueueCreate(1, sizeof(parse_range_t *));
+  range_done = xSemaphoreCreateBinary();
+  if (range_queue && range_done)
+  {
+    task_created = task_plan_create(TASK_PLAN_ENTITY_PARSER_HELPER, entity_parse_helper_task, NULL,
+                                    &helper_task_handle);
+  }
+  if (!range_queue || !range_done || task_created != pdPASS)
+  {
+    debug_log_warning(DEBUG_TAG_PARSER, "Second parse worker unavailable, large jobs will not be split");
+    if (range_queue)
+      vQueueDelete(range_queue);
+    if (range_done)
+      vSemaphoreDelete(range_done);
+    range_queue = NULL;
+    range_done = NULL;
+    helper_task_handle = NULL;
+  }
+#endif
+
+  // Reset statistics
+  memset(&parser_stats, 0, sizeof(parser_stats));
+
+  parser_initialized = true;
+  debug_log_startup(DEBUG_TAG_PARSER, "Entity States Parser");
+
+  return ESP_OK;
+}
+
+void entity_states_parser_deinit(void)
+{
+  // Delete tasks
+  if (parse_task_handle)
+  {
+    task_stack_delete(parse_task_handle);
+    parse_task_handle = NULL;
+  }
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+  if (helper_task_handle)
+  {
+    task_stack_delete(helper_task_handle);
+    helper_task_handle = NULL;
+  }
+  if (range_queue)
+  {
+    vQueueDelete(range_queue);
+    range_queue = NULL;
+  }
+  if (range_done)
+  {
+    vSemaphoreDelete(range_done);
+    range_done = NULL;
+  }
+#endif
+
+  // Delete queue
+  if (parse_queue)
+  {
+    vQueueDelete(parse_queue);
+    parse_queue = NULL;
+  }
+
+  // Unclaimed jobs die with the workers
+  for (int i = 0; i < ENTITY_PARSER_MAX_JOBS; i++)
+  {
+    if (parse_slots[i].json_data)
+      heap_caps_free(parse_slots[i].json_data);
+    if (parse_slots[i].done)
+      vSemaphoreDelete(parse_slots[i].done);
+    memset(&parse_slots[i], 0, sizeof(parse_slot_t));
+  }
+
+  parser_initialized = false;
+}
+
+esp_err_t entity_states_parser_submit(
+    const char *json_data,
+    size_t json_size,
+    const char **entity_ids,
+    int entity_count,
+    ha_entity_state_t *states,
+    entity_parse_handle_t *handle)
+{
+  if (!parser_initialized)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Parser not initialized");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (!json_data || !entity_ids || !states || entity_count <= 0 || !handle)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Invalid parameters");
+    return ESP_ERR_INVALID_ARG;
+  }
+  *handle = ENTITY_PARSE_HANDLE_NONE;
+
+  // Allocate SPIRAM for JSON data copy
+  char *json_copy = heap_caps_malloc(json_size + 1, MALLOC_CAP_SPIRAM);
+  if (!json_copy)
+  {
+    debug_log_error_f(DEBUG_TAG_PARSER, "Failed to allocate %zu bytes in SPIRAM for JSON", json_size);
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Copy JSON data to SPIRAM
+  memcpy(json_copy, json_data, json_size);
+  json_copy[json_size] = '\0';
+
+  // Claim a slot, the queue can never be fuller than the slots
+  parse_slot_t *slot = NULL;
+  portENTER_CRITICAL(&slots_lock);
+  for (int i = 0; i < ENTITY_PARSER_MAX_JOBS; i++)
+  {
+    if (parse_slots[i].state == PARSE_SLOT_FREE)
+    {
+      slot = &parse_slots[i];
+      break;
+    }
+  }
+  if (slot)
+  {
+    slot->handle = next_handle++;
+    if (next_handle == ENTITY_PARSE_HANDLE_NONE)
+      next_handle = 1;
+    slot->state = PARSE_SLOT_QUEUED;
+    slot->cancel = false;
+    slot->json_data = json_copy;
+    slot->json_size = json_size;
+    slot->entity_ids = entity_ids;
+    slot->entity_count = entity_count;
+    slot->states = states;
+    slot->result = ESP_FAIL;
+    slot->found_count = 0;
+  }
+  portEXIT_CRITICAL(&slots_lock);
+
+  if (!slot)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "All parse job slots are taken, cannot submit job");
+    heap_caps_free(json_copy);
+    return ESP_ERR_NO_MEM;
+  }
+
+  *handle = slot->handle;
+  xQueueSend(parse_queue, handle, 0);
+
+  return ESP_OK;
+}
+
+esp_err_t entity_states_parser_wait(entity_parse_handle_t handle, uint32_t timeout_ms, int *found_count)
+{
+  if (!parser_initialized)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  portENTER_CRITICAL(&slots_lock);
+  parse_slot_t *slot = find_slot(handle);
+  portEXIT_CRITICAL(&slots_lock);
+  if (!slot)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Convert timeout to ticks
+  TickType_t timeout_ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+  // Given exactly once per job, the slot stays ours until released below
+  if (xSemaphoreTake(slot->done, timeout_ticks) != pdTRUE)
+  {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  esp_err_t result = slot->result;
+  if (found_count)
+  {
+    *found_count = slot->found_count;
+  }
+  release_slot(slot);
+
+  return result;
+}
+
+esp_err_t entity_states_parser_cancel(entity_parse_handle_t handle)
+{
+  if (!parser_initialized)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  portENTER_CRITICAL(&slots_lock);
+  parse_slot_t *slot = find_slot(handle);
+  parse_slot_state_t state = slot ? slot->state : PARSE_SLOT_FREE;
+  char *json_data = NULL;
+  if (slot && state == PARSE_SLOT_QUEUED)
+  {
+    // Never started, the worker drops the stale handle when it dequeues it
+    json_data = slot->json_data;
+    slot->json_data = NULL;
+    slot->handle = ENTITY_PARSE_HANDLE_NONE;
+    slot->state = PARSE_SLOT_FREE;
+  }
+  else if (slot)
+  {
+    slot->cancel = true;
+  }
+  portEXIT_CRITICAL(&slots_lock);
+
+  if (!slot)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (state == PARSE_SLOT_QUEUED)
+  {
+    heap_caps_free(json_data);
+    return ESP_OK;
+  }
+
+  // Workers give up within one chunk
+  xSemaphoreTake(slot->done, portMAX_DELAY);
+  release_slot(slot);
+
+  return ESP_OK;
+}
+
+esp_err_t entity_states_parser_parse_sync(
+    const char *json_data,
+    const char **entity_ids,
+    int entity_count,
+    ha_entity_state_t *states)
+{
+  if (!json_data || !entity_ids || !states || entity_count <= 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  int64_t start_time = esp_timer_get_time();
+
+  // Parse entities synchronously
+  TRACE_SPAN_BEGIN("ha_parse");
+  CYCLE_PROF_BEGIN(parse_entity_states_from_json);
+  int found_count = parse_entity_states_from_json(json_data, entity_ids, entity_count, states);
+  CYCLE_PROF_END(parse_entity_states_from_json);
+  TRACE_SPAN_END("ha_parse");
+  TRACE_SPAN_COUNTER("entities_found", found_count);
+
+  record_parse_stats(found_count, entity_count, esp_timer_get_time() - start_time, strlen(json_data));
+
+  return (found_count > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t entity_states_parser_get_stats(entity_parser_stats_t *stats)
+{
+  if (!stats)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  SEQLOCK_READ(&parser_stats_seq, stats, &parser_stats);
+  return ESP_OK;
+}
+
+void entity_states_parser_reset_stats(void)
+{
+  portENTER_CRITICAL(&parser_stats_lock);
+  seqlock_write_begin(&parser_stats_seq);
+  memset(&parser_stats, 0, sizeof(parser_stats));
+  seqlock_write_end(&parser_stats_seq);
+  portEXIT_CRITICAL(&parser_stats_lock);
+}
+
+esp_err_t entity_states_stream_begin(
+    entity_stream_parser_t *parser,
+    const char **entity_ids,
+    int entity_count,
+    ha_entity_state_t *states)
+{
+  if (!parser || !entity_ids || !states || entity_count <= 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(parser, 0, sizeof(entity_stream_parser_t));
+  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
+  parser->entity_ids = entity_ids;
+  parser->entity_count = entity_count;
+  parser->states = states;
+  parser->start_time = esp_timer_get_time();
+  entity_lookup_build(&parser->lookup, entity_ids, entity_count);
+
+  return ESP_OK;
+}
+
+esp_err_t entity_states_stream_feed(entity_stream_parser_t *parser, const char *data, size_t len)
+{
+  if (!parser || (!data && len > 0))
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (size_t i = 0; i < len && !parser->error; i++)
+  {
+    stream_process_char(parser, data[i]);
+  }
+  parser->bytes_fed += len;
+
+  return parser->error ? ESP_ERR_INVALID_RESPONSE : ESP_OK;
+}
+
+esp_err_t entity_states_stream_finish(entity_stream_parser_t *parser)
+{
+  if (!parser)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  record_parse_stats(parser->found_count, parser->entity_count, esp_timer_get_time() - parser->start_time,
+                     parser->bytes_fed);
+
+  esp_err_t result = stream_result(parser);
+  if (result == ESP_ERR_INVALID_RESPONSE)
+  {
+    debug_log_error_f(DEBUG_TAG_PARSER, "Streamed states document %s after %zu bytes",
+                      parser->error ? "malformed" : "incomplete", parser->bytes_fed);
+    return result;
+  }
+
+  debug_log_info_f(DEBUG_TAG_PARSER, "Streaming parse completed: found %d/%d entities in %zu bytes",
+                   parser->found_count, parser->entity_count, parser->bytes_fed);
+
+  return result;
+}
+
+void entity_lookup_build(entity_lookup_t *lookup, const char *const *entity_ids, int entity_count)
+{
+  lookup->entity_ids = entity_ids;
+  lookup->entity_count = entity_count;
+  lookup->indexed = entity_count <= ENTITY_LOOKUP_MAX_ENTITIES;
+  memset(lookup->slots, -1, sizeof(lookup->slots));
+
+  if (!lookup->indexed)
+  {
+    debug_log_warning_f(DEBUG_TAG_PARSER, "%d entities requested, index holds %d, using linear lookup",
+                        entity_count, ENTITY_LOOKUP_MAX_ENTITIES);
+    return;
+  }
+
+  for (int i = 0; i < entity_count; i++)
+  {
+    uint32_t hash = entity_id_hash(entity_ids[i]);
+    uint32_t slot = hash & (ENTITY_LOOKUP_SLOTS - 1);
+
+    // Linear probing, the table is never more than half full
+    while (lookup->slots[slot] >= 0)
+    {
+      slot = (slot + 1) & (ENTITY_LOOKUP_SLOTS - 1);
+    }
+    lookup->slots[slot] = (int8_t)i;
+    lookup->hashes[slot] = hash;
+  }
+}
+
+int entity_lookup_find(const entity_lookup_t *lookup, const char *entity_id)
+{
+  if (!lookup->indexed)
+  {
+    for (int i = 0; i < lookup->entity_count; i++)
+    {
+      if (strcmp(lookup->entity_ids[i], entity_id) == 0)
+        return i;
+    }
+    return -1;
+  }
+
+  uint32_t hash = entity_id_hash(entity_id);
+  for (uint32_t slot = hash & (ENTITY_LOOKUP_SLOTS - 1); lookup->slots[slot] >= 0;
+       slot = (slot + 1) & (ENTITY_LOOKUP_SLOTS - 1))
+  {
+    int index = lookup->slots[slot];
+    if (lookup->hashes[slot] == hash && strcmp(lookup->entity_ids[index], entity_id) == 0)
+      return index;
+  }
+  return -1;
+}
+
+static void entity_parse_task(void *pvParameters)
+{
+  entity_parse_handle_t handle;
+
+  while (1)
+  {
+    if (xQueueReceive(parse_queue, &handle, portMAX_DELAY) != pdTRUE)
+      continue;
+
+    portENTER_CRITICAL(&slots_lock);
+    parse_slot_t *slot = find_slot(handle);
+    if (slot && slot->state == PARSE_SLOT_QUEUED)
+    {
+      slot->state = PARSE_SLOT_RUNNING;
+    }
+    else
+    {
+      // Cancelled while queued
+      slot = NULL;
+    }
+    portEXIT_CRITICAL(&slots_lock);
+
+    if (slot)
+    {
+      run_parse_job(slot);
+    }
+  }
+}
+
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+static void entity_parse_helper_task(void *pvParameters)
+{
+  parse_range_t *range;
+
+  while (1)
+  {
+    if (xQueueReceive(range_queue, &range, portMAX_DELAY) != pdTRUE)
+      continue;
+
+    range->result = parse_range(&helper_parser, "[", range->data, range->len, NULL, range->entity_ids,
+                                range->entity_count, range->states, range->cancel);
+    range->found_count = helper_parser.found_count;
+    xSemaphoreGive(range_done);
+  }
+}
+#endif
+
+static void run_parse_job(parse_slot_t *slot)
+{
+  int64_t start_time = esp_timer_get_time();
+  esp_err_t result = ESP_FAIL;
+  int found_count = 0;
+  bool parsed = false;
+
+#if CONFIG_HA_PARSER_SPLIT_WORKER
+  size_t split = 0;
+  ha_entity_state_t *scratch = NULL;
+  if (helper_task_handle && slot->json_size >= ENTITY_PARSER_SPLIT_MIN_BYTES)
+  {
+    split = find_split(slot->json_data, slot->json_size);
+  }
+  if (split > 0)
+  {
+    scratch = heap_caps_malloc(sizeof(ha_entity_state_t) * slot->entity_count, MALLOC_CAP_SPIRAM);
+  }
+  if (scratch)
+  {
+    parse_range_t range = {
+        .data = slot->json_data + split + 1,
+        .len = slot->json_size - split - 1,
+        .entity_ids = slot->entity_ids,
+        .entity_count = slot->entity_count,
+        .states = scratch,
+        .cancel = &slot->cancel,
+    };
+    parse_range_t *range_ptr = &range;
+    xQueueSend(range_queue, &range_ptr, portMAX_DELAY);
+
+    esp_err_t front = parse_range(&job_parser, NULL, slot->json_data, split, "]", slot->entity_ids,
+                                  slot->entity_count, slot->states, &slot->cancel);
+    found_count = job_parser.found_count;
+    xSemaphoreTake(range_done, portMAX_DELAY);
+
+    if (front != ESP_ERR_INVALID_STATE && range.result != ESP_ERR_INVALID_STATE)
+    {
+      if (front == ESP_ERR_INVALID_RESPONSE || range.result == ESP_ERR_INVALID_RESPONSE)
+      {
+        // The cut was not between two entities after all, parse it whole
+        debug_log_warning_f(DEBUG_TAG_PARSER, "Split at byte %zu of %zu did not hold, parsing in one piece",
+                            split, slot->json_size);
+      }
+      else
+      {
+        // Earlier occurrences win, as in a single pass
+        for (int i = 0; i < slot->entity_count; i++)
+        {
+          if (scratch[i].found && !slot->states[i].found)
+          {
+            slot->states[i] = scratch[i];
+            found_count++;
+          }
+        }
+        result = (found_count > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+        parsed = true;
+      }
+    }
+    else
+    {
+      result = ESP_ERR_INVALID_STATE;
+      parsed = true;
+    }
+    heap_caps_free(scratch);
+  }
+#endif
+
+  if (!parsed)
+  {
+    result = parse_range(&job_parser, NULL, slot->json_data, slot->json_size, NULL, slot->entity_ids,
+                         slot->entity_count, slot->states, &slot->cancel);
+    found_count = job_parser.found_count;
+  }
+
+  if (result != ESP_ERR_INVALID_STATE)
+  {
+    record_parse_stats(found_count, slot->entity_count, esp_timer_get_time() - start_time, slot->json_size);
+  }
+  if (result == ESP_ERR_INVALID_RESPONSE)
+  {
+    debug_log_error_f(DEBUG_TAG_PARSER, "Parse job %lu: malformed states document", (unsigned long)slot->handle);
+  }
+
+  heap_caps_free(slot->json_data);
+
+  portENTER_CRITICAL(&slots_lock);
+  slot->json_data = NULL;
+  slot->result = result;
+  slot->found_count = found_count;
+  slot->state = PARSE_SLOT_DONE;
+  portEXIT_CRITICAL(&slots_lock);
+
+  xSemaphoreGive(slot->done);
+}
+
+static esp_err_t parse_range(entity_stream_parser_t *parser, const char *prefix, const char *data, size_t len,
+                             const char *suffix, const char **entity_ids, int entity_count,
+                             ha_entity_state_t *states, volatile bool *cancel)
+{
+  entity_states_stream_begin(parser, entity_ids, entity_count, states);
+  if (prefix)
+  {
+    entity_states_stream_feed(parser, prefix, strlen(prefix));
+  }
+
+  for (size_t offset = 0; offset < len && !parser->error; offset += ENTITY_PARSER_CHUNK_BYTES)
+  {
+    if (*cancel)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    size_t chunk = len - offset;
+    if (chunk > ENTITY_PARSER_CHUNK_BYTES)
+      chunk = ENTITY_PARSER_CHUNK_BYTES;
+    entity_states_stream_feed(parser, data + offset, chunk);
+  }
+
+  if (suffix)
+  {
+    entity_states_stream_feed(parser, suffix, strlen(suffix));
+  }
+
+  return stream_result(parser);
+}
+
+static int parse_entity_states_from_json(
+    const char *json_data,
+    const char **entity_ids,
+    int entity_count,
+    ha_entity_state_t *states)
+{
+  if (!json_data || !entity_ids || !states)
+  {
+    return 0;
+  }
+
+  // Parse JSON, the tree lives in a PSRAM arena until json_arena_end()
+  json_arena_t *arena = json_arena_begin(strlen(json_data));
+  cJSON *json = cJSON_Parse(json_data);
+  if (!json)
+  {
+    const char *error_ptr = cJSON_GetErrorPtr();
+    if (error_ptr != NULL)
+    {
+      long error_pos = error_ptr - json_data;
+      debug_log_error_f(DEBUG_TAG_PARSER, "JSON parse failed: %s at position %ld", error_ptr, error_pos);
+    }
+    else
+    {
+      debug_log_error(DEBUG_TAG_PARSER, "JSON parse failed: Unknown error");
+    }
+    json_arena_end(arena);
+    return 0;
+  }
+
+  if (!cJSON_IsArray(json))
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Expected JSON array for entity states");
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    return 0;
+  }
+
+  int array_size = cJSON_GetArraySize(json);
+  int success_count = 0;
+
+  debug_log_info_f(DEBUG_TAG_PARSER,
+                   "Processing JSON array with %d entities, searching for %d requested entities",
+                   array_size, entity_count);
+
+  // Clear all states first
+  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
+
+  // One pass over the response, each element probes the index once
+  entity_lookup_t *lookup = malloc(sizeof(entity_lookup_t));
+  if (!lookup)
+  {
+    debug_log_error(DEBUG_TAG_PARSER, "Failed to allocate entity index");
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    return 0;
+  }
+  entity_lookup_build(lookup, entity_ids, entity_count);
+
+  cJSON *entity = NULL;
+  cJSON_ArrayForEach(entity, json)
+  {
+    if (!cJSON_IsObject(entity))
+      continue;
+
+    cJSON *entity_id_json = cJSON_GetObjectItem(entity, "entity_id");
+    if (!entity_id_json || !cJSON_IsString(entity_id_json))
+      continue;
+
+    // Check if this is one of our requested entities
+    int i = entity_lookup_find(lookup, cJSON_GetStringValue(entity_id_json));
+    if (i < 0 || states[i].found)
+      continue;
+
+    // Found matching entity, extract its state
+    cJSON *state_json = cJSON_GetObjectItem(entity, "state");
+    if (!state_json || !cJSON_IsString(state_json))
+    {
+      // Entity has no valid state - skip without verbose logging
+      continue;
+    }
+
+    // Extract friendly name from attributes if available
+    cJSON *attributes = cJSON_GetObjectItem(entity, "attributes");
+    cJSON *friendly_name = cJSON_IsObject(attributes) ? cJSON_GetObjectItem(attributes, "friendly_name") : NULL;
+    uint32_t changed = ha_parse_timestamp(cJSON_GetStringValue(cJSON_GetObjectItem(entity, "last_changed")));
+    if (changed == 0)
+    {
+      changed = ha_parse_timestamp(cJSON_GetStringValue(cJSON_GetObjectItem(entity, "last_updated")));
+    }
+
+    // Classify the state into the compact record
+    ha_entity_state_set(&states[i], cJSON_GetStringValue(state_json), cJSON_GetStringValue(friendly_name), changed);
+    ha_entity_state_read_attributes(&states[i], attributes);
+
+    // Stop once everything requested has been seen
+    if (++success_count == entity_count)
+      break;
+  }
+
+  free(lookup);
+  cJSON_Delete(json);
+  json_arena_end(arena);
+
+  debug_log_info_f(DEBUG_TAG_PARSER,
+                   "Parsing completed: found %d/%d entities",
+                   success_count, entity_count);
+
+  return success_count;
+}
+
+bool entity_states_parser_is_ready(void)
+{
+  return parser_initialized;
+}
+
+int entity_states_parser_get_queue_size(void)
+{
+  if (!parse_queue)
+  {
+    return -1;
+  }
+
+  int in_use = 0;
+  portENTER_CRITICAL(&slots_lock);
+  for (int i = 0; i < ENTITY_PARSER_MAX_JOBS; i++)
+  {
+    if (parse_slots[i].state != PARSE_SLOT_FREE)
+      in_use++;
+  }
+  portEXIT_CRITICAL(&slots_lock);
+
+  return in_use;
+}
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static parse_slot_t *find_slot(entity_parse_handle_t handle)
+{
+  if (handle == ENTITY_PARSE_HANDLE_NONE)
+    return NULL;
+
+  for (int i = 0; i < ENTITY_PARSER_MAX_JOBS; i++)
+  {
+    if (parse_slots[i].handle == handle && parse_slots[i].state != PARSE_SLOT_FREE)
+      return &parse_slots[i];
+  }
+  return NULL;
+}
+
+static void release_slot(parse_slot_t *slot)
+{
+  portENTER_CRITICAL(&slots_lock);
+  slot->handle = ENTITY_PARSE_HANDLE_NONE;
+  slot->state = PARSE_SLOT_FREE;
+  portEXIT_CRITICAL(&slots_lock);
+}
+
+/**
+ * @brief Look for an element boundary from the middle onwards
+ *
+ * Scanning from the start to track strings would cost the primary half the
+ * document before the helper could begin, so this looks for ',' '{' and the
+ * entity_id key with only whitespace between them. A cut that lands inside
+ * an attribute leaves one half malformed or incomplete, which the caller
+ * detects.
+ */
+static size_t find_split(const char *json_data, size_t json_size)
+{
+  const size_t marker_len = strlen(SPLIT_MARKER);
+
+  for (size_t i = json_size / 2; i + marker_len < json_size; i++)
+  {
+    if (json_data[i] != ',')
+      continue;
+
+    size_t j = i + 1;
+    while (j < json_size && (json_data[j] == ' ' || json_data[j] == '\n' || json_data[j] == '\r' ||
+                             json_data[j] == '\t'))
+      j++;
+    if (j >= json_size || json_data[j] != '{')
+      continue;
+    j++;
+    while (j < json_size && (json_data[j] == ' ' || json_data[j] == '\n' || json_data[j] == '\r' ||
+                             json_data[j] == '\t'))
+      j++;
+    if (j + marker_len <= json_size && memcmp(json_data + j, SPLIT_MARKER, marker_len) == 0)
+      return i;
+  }
+  return 0;
+}
+
+static void record_parse_stats(int found_count, int entity_count, int64_t parse_time_us, size_t bytes)
+{
+  metrics_histogram_observe(&parse_duration_metric, parse_time_us > UINT32_MAX ? UINT32_MAX : (uint32_t)parse_time_us);
+
+  // Inline, streamed and queued parses record from different tasks
+  portENTER_CRITICAL(&parser_stats_lock);
+  seqlock_write_begin(&parser_stats_seq);
+  parser_stats.jobs_processed++;
+  parser_stats.entities_found += found_count;
+  parser_stats.entities_missing += (entity_count - found_count);
+  parser_stats.total_parse_time_ms += parse_time_us / 1000;
+  parser_stats.average_parse_time_ms = parser_stats.total_parse_time_ms / parser_stats.jobs_processed;
+  if (bytes > parser_stats.largest_response_size)
+  {
+    parser_stats.largest_response_size = bytes;
+  }
+  seqlock_write_end(&parser_stats_seq);
+  portEXIT_CRITICAL(&parser_stats_lock);
+}
+
+static esp_err_t stream_result(const entity_stream_parser_t *parser)
+{
+  if (parser->error || !parser->complete)
+    return ESP_ERR_INVALID_RESPONSE;
+
+  return (parser->found_count > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief FNV-1a, cheap and good enough for entity IDs
+ */
+static uint32_t entity_id_hash(const char *entity_id)
+{
+  uint32_t hash = 2166136261u;
+  while (*entity_id)
+  {
+    hash ^= (uint8_t)*entity_id++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Append one byte to the string being captured
+ */
+static void stream_capture_byte(entity_stream_parser_t *parser, char c)
+{
+  if (!parser->capture)
+    return;
+
+  if (parser->capture_len + 1 < parser->capture_size)
+  {
+    parser->capture[parser->capture_len++] = c;
+    parser->capture[parser->capture_len] = '\0';
+  }
+  else
+  {
+    parser->capture_overflow = true;
+  }
+}
+
+/**
+ * @brief Append a decoded unicode escape as UTF-8
+ */
+static void stream_capture_code_unit(entity_stream_parser_t *parser, uint16_t value)
+{
+  if (value >= 0xD800 && value <= 0xDFFF)
+  {
+    // Surrogate pairs are rare in entity names, keep a placeholder
+    stream_capture_byte(parser, '?');
+  }
+  else if (value < 0x80)
+  {
+    stream_capture_byte(parser, (char)value);
+  }
+  else if (value < 0x800)
+  {
+    stream_capture_byte(parser, (char)(0xC0 | (value >> 6)));
+    stream_capture_byte(parser, (char)(0x80 | (value & 0x3F)));
+  }
+  else
+  {
+    stream_capture_byte(parser, (char)(0xE0 | (value >> 12)));
+    stream_capture_byte(parser, (char)(0x80 | ((value >> 6) & 0x3F)));
+    stream_capture_byte(parser, (char)(0x80 | (value & 0x3F)));
+  }
+}
+
+static bool stream_top_is_object(const entity_stream_parser_t *parser)
+{
+  return parser->depth > 0 && parser->depth <= ENTITY_STREAM_MAX_DEPTH &&
+         (parser->object_mask & (1u << (parser->depth - 1)));
+}
+
+/**
+ * @brief Store the entity object just closed if it is one of the requested ones
+ */
+static void stream_commit_entity(entity_stream_parser_t *parser)
+{
+  if (!parser->have_entity_id || !parser->have_state)
+    return;
+
+  int index = entity_lookup_find(&parser->lookup, parser->entity_id);
+  if (index < 0 || parser->states[index].found)
+    return;
+
+  // last_changed is omitted by some integrations, last_updated is the next best
+  uint32_t changed = ha_parse_timestamp(parser->last_changed);
+  if (changed == 0)
+  {
+    changed = ha_parse_timestamp(parser->last_updated);
+  }
+  ha_entity_state_set(&parser->states[index], parser->state, parser->friendly_name, changed);
+  if (parser->have_level)
+  {
+    ha_entity_state_set_level(&parser->states[index], parser->level);
+  }
+  parser->found_count++;
+}
+
+/**
+ * @brief Handle the end of a number literal read for a level field
+ */
+static void stream_end_number(entity_stream_parser_t *parser)
+{
+  parser->number[parser->number_len] = '\0';
+  parser->number_len = 0;
+
+  char *end = NULL;
+  float value = strtof(parser->number, &end);
+  if (end == parser->number || *end != '\0')
+    return;
+
+  if (parser->number_field == STREAM_FIELD_BRIGHTNESS)
+  {
+    parser->level_is_brightness = true;
+  }
+  else if (parser->level_is_brightness)
+  {
+    return;
+  }
+  parser->level = value;
+  parser->have_level = true;
+}
+
+/**
+ * @brief Handle the end of a string literal
+ */
+static void stream_end_string(entity_stream_parser_t *parser)
+{
+  if (parser->string_is_key)
+  {
+    parser->field = STREAM_FIELD_NONE;
+    if (parser->capture_overflow)
+    {
+      // Longer than any key we look for
+    }
+    else if (parser->depth == STREAM_ENTITY_DEPTH)
+    {
+      if (strcmp(parser->key, "entity_id") == 0)
+        parser->field = STREAM_FIELD_ENTITY_ID;
+      else if (strcmp(parser->key, "state") == 0)
+        parser->field = STREAM_FIELD_STATE;
+      else if (strcmp(parser->key, "last_changed") == 0)
+        parser->field = STREAM_FIELD_LAST_CHANGED;
+      else if (strcmp(parser->key, "last_updated") == 0)
+        parser->field = STREAM_FIELD_LAST_UPDATED;
+      else if (strcmp(parser->key, "attributes") == 0)
+        parser->field = STREAM_FIELD_ATTRIBUTES;
+    }
+    else if (parser->depth == STREAM_ENTITY_DEPTH + 1 && parser->in_attributes)
+    {
+      if (strcmp(parser->key, "friendly_name") == 0)
+        parser->field = STREAM_FIELD_FRIENDLY_NAME;
+      else if (strcmp(parser->key, "brightness") == 0)
+        parser->field = STREAM_FIELD_BRIGHTNESS;
+      else if (strcmp(parser->key, "temperature") == 0)
+        parser->field = STREAM_FIELD_TEMPERATURE;
+    }
+  }
+  else if (parser->capture == parser->entity_id)
+  {
+    // A truncated id cannot be one of ours
+    parser->have_entity_id = !parser->capture_overflow;
+  }
+  else if (parser->capture == parser->state)
+  {
+    parser->have_state = true;
+  }
+
+  parser->capture = NULL;
+}
+
+/**
+ * @brief Choose the buffer for a string value of the current field
+ */
+static void stream_start_value_capture(entity_stream_parser_t *parser)
+{
+  switch (parser->field)
+  {
+  case STREAM_FIELD_ENTITY_ID:
+    parser->capture = parser->entity_id;
+    parser->capture_size = sizeof(parser->entity_id);
+    break;
+  case STREAM_FIELD_STATE:
+    parser->capture = parser->state;
+    parser->capture_size = sizeof(parser->state);
+    break;
+  case STREAM_FIELD_FRIENDLY_NAME:
+    parser->capture = parser->friendly_name;
+    parser->capture_size = sizeof(parser->friendly_name);
+    break;
+  case STREAM_FIELD_LAST_CHANGED:
+    parser->capture = parser->last_changed;
+    parser->capture_size = sizeof(parser->last_changed);
+    break;
+  case STREAM_FIELD_LAST_UPDATED:
+    parser->capture = parser->last_updated;
+    parser->capture_size = sizeof(parser->last_updated);
+    break;
+  default:
+    parser->capture = NULL;
+    return;
+  }
+
+  parser->capture_len = 0;
+  parser->capture_overflow = false;
+  parser->capture[0] = '\0';
+}
+
+static void stream_process_char(entity_stream_parser_t *parser, char c)
+{
+  if (parser->in_string)
+  {
+    if (parser->unicode_digits > 0)
+    {
+      int digit;
+      if (c >= '0' && c <= '9')
+        digit = c - '0';
+      else if (c >= 'a' && c <= 'f')
+        digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        digit = c - 'A' + 10;
+      else
+      {
+        parser->error = true;
+        return;
+      }
+
+      parser->unicode_value = (uint16_t)((parser->unicode_value << 4) | digit);
+      if (--parser->unicode_digits == 0)
+      {
+        stream_capture_code_unit(parser, parser->unicode_value);
+      }
+    }
+    else if (parser->escape)
+    {
+      parser->escape = false;
+      switch (c)
+      {
+      case 'n':
+        stream_capture_byte(parser, '\n');
+        break;
+      case 't':
+        stream_capture_byte(parser, '\t');
+        break;
+      case 'r':
+        stream_capture_byte(parser, '\r');
+        break;
+      case 'b':
+        stream_capture_byte(parser, '\b');
+        break;
+      case 'f':
+        stream_capture_byte(parser, '\f');
+        break;
+      case 'u':
+        parser->unicode_digits = 4;
+        parser->unicode_value = 0;
+        break;
+      default: // '"', '\\' and '/'
+        stream_capture_byte(parser, c);
+        break;
+      }
+    }
+    else if (c == '\\')
+    {
+      parser->escape = true;
+    }
+    else if (c == '"')
+    {
+      parser->in_string = false;
+      stream_end_string(parser);
+    }
+    else
+    {
+      stream_capture_byte(parser, c);
+    }
+    return;
+  }
+
+  if (parser->number_len > 0)
+  {
+    if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E')
+    {
+      if (parser->number_len + 1 < sizeof(parser->number))
+      {
+        parser->number[parser->number_len++] = c;
+        return;
+      }
+      // Too long for a level, drop it
+      parser->number_len = 0;
+      return;
+    }
+    stream_end_number(parser);
+  }
+
+  if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+    return;
+
+  bool value_start = parser->value_pending;
+  parser->value_pending = false;
+
+  if (parser->complete)
+  {
+    // Only whitespace may follow the top-level array
+    parser->error = true;
+    return;
+  }
+
+  if (parser->depth == 0 && c != '[')
+  {
+    // /api/states always returns an array
+    parser->error = true;
+    return;
+  }
+
+  switch (c)
+  {
+  case '"':
+    parser->in_string = true;
+    parser->string_is_key = parser->expect_key && stream_top_is_object(parser);
+    parser->expect_key = false;
+    if (parser->string_is_key)
+    {
+      parser->capture = parser->key;
+      parser->capture_size = sizeof(parser->key);
+      parser->capture_len = 0;
+      parser->capture_overflow = false;
+      parser->key[0] = '\0';
+    }
+    else if (value_start)
+    {
+      stream_start_value_capture(parser);
+    }
+    else
+    {
+      parser->capture = NULL;
+    }
+    break;
+
+  case '{':
+  case '[':
+    parser->depth++;
+    if (parser->depth <= ENTITY_STREAM_MAX_DEPTH)
+    {
+      if (c == '{')
+        parser->object_mask |= (1u << (parser->depth - 1));
+      else
+        parser->object_mask &= ~(1u << (parser->depth - 1));
+    }
+    parser->expect_key = (c == '{');
+
+    if (parser->depth == STREAM_ENTITY_DEPTH && c == '{')
+    {
+      // New entity, forget the previous one's fields
+      parser->have_entity_id = false;
+      parser->have_state = false;
+      parser->have_level = false;
+      parser->level_is_brightness = false;
+      parser->entity_id[0] = '\0';
+      parser->state[0] = '\0';
+      parser->friendly_name[0] = '\0';
+      parser->last_changed[0] = '\0';
+      parser->last_updated[0] = '\0';
+    }
+    else if (parser->depth == STREAM_ENTITY_DEPTH + 1 && c == '{' && value_start &&
+             parser->field == STREAM_FIELD_ATTRIBUTES)
+    {
+      parser->in_attributes = true;
+    }
+    parser->field = STREAM_FIELD_NONE;
+    break;
+
+  case '}':
+  case ']':
+    if (parser->depth <= ENTITY_STREAM_MAX_DEPTH && stream_top_is_object(parser) != (c == '}'))
+    {
+      parser->error = true;
+      return;
+    }
+
+    if (parser->depth == STREAM_ENTITY_DEPTH && c == '}')
+    {
+      stream_commit_entity(parser);
+    }
+    else if (parser->depth == STREAM_ENTITY_DEPTH + 1)
+    {
+      parser->in_attributes = false;
+    }
+
+    parser->depth--;
+    parser->expect_key = false;
+    parser->field = STREAM_FIELD_NONE;
+    if (parser->depth == 0)
+    {
+      parser->complete = true;
+    }
+    break;
+
+  case ':':
+    parser->value_pending = true;
+    break;
+
+  case ',':
+    parser->expect_key = stream_top_is_object(parser);
+    parser->field = STREAM_FIELD_NONE;
+    break;
+
+  default:
+    // Literals are skipped, numbers only kept for the level attributes
+    if (value_start && (c == '-' || (c >= '0' && c <= '9')) &&
+        (parser->field == STREAM_FIELD_BRIGHTNESS || parser->field == STREAM_FIELD_TEMPERATURE))
+    {
+      parser->number[0] = c;
+      parser->number_len = 1;
+      parser->number_field = parser->field;
+    }
+    break;
+  }
+}
@@ -1,192 +1,343 @@
-﻿/**
- * @file entity_states_parser.h
- * @brief Async Entity States JSON Parser for Home Assistant API
- *
- * This module provides asynchronous JSON parsing functionality for Home Assistant
- * entity states using SPIRAM for large response handling. The parser runs on
- * CPU idle time to avoid blocking the main application.
- *
- * Features:
- * - Async JSON parsing using FreeRTOS task
- * - SPIRAM allocation for large responses
- * - Background processing with idle-time CPU usage
- * - Entity state extraction and filtering
- * - Performance timing and monitoring
- *
- * @author System Monitor Dashboard
- * @date 2025-08-19
- */
-
-#ifndef ENTITY_STATES_PARSER_H
-#define ENTITY_STATES_PARSER_H
-
-#include <stdbool.h>
-#include <stdint.h>
-#include "esp_err.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/task.h"
-#include "ha_api.h"
-
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-// =======================================================================
-// CONSTANTS AND CONFIGURATION
-// =======================================================================
-
-/** Maximum number of async parse jobs in queue */
-#define ENTITY_PARSER_MAX_JOBS 2
-
-/** Async parse task stack size */
-#define ENTITY_PARSER_TASK_STACK_SIZE 8192
-
-/** Async parse task priority (low for idle processing) */
-#define ENTITY_PARSER_TASK_PRIORITY 2
-
-/** Core affinity for parser task (same as LVGL) */
-#define ENTITY_PARSER_TASK_CORE 1
-
-  // =======================================================================
-  // DATA STRUCTURES
-  // =======================================================================
-
-  /**
-   * @brief Async JSON parsing job structure
-   *
-   * Contains all data needed for background JSON parsing in SPIRAM
-   */
-  typedef struct
-  {
-    char *json_data;           ///< JSON response data in SPIRAM
-    size_t json_size;          ///< Size of JSON data
-    const char **entity_ids;   ///< Array of entity IDs to search for
-    int entity_count;          ///< Number of entities to find
-    ha_entity_state_t *states; ///< Output states array
-    TaskHandle_t caller_task;  ///< Task to notify when complete
-  } entity_parse_job_t;
-
-  /**
-   * @brief Parser performance statistics
-   */
-  typedef struct
-  {
-    int64_t total_parse_time_ms;   ///< Total parsing time in milliseconds
-    int64_t average_parse_time_ms; ///< Average parsing time per job
-    uint32_t jobs_processed;       ///< Number of jobs processed
-    uint32_t entities_found;       ///< Total entities successfully found
-    uint32_t entities_missing;     ///< Total entities not found
-    size_t largest_response_size;  ///< Largest JSON response processed
-  } entity_parser_stats_t;
-
-  // =======================================================================
-  // PUBLIC FUNCTION DECLARATIONS
-  // =======================================================================
-
-  /**
-   * @brief Initialize the async entity states parser
-   *
-   * Creates the background task and queue for async JSON processing.
-   * Must be called before using any other parser functions.
-   *
-   * @return ESP_OK on success, error code on failure
-   */
-  esp_err_t entity_states_parser_init(void);
-
-  /**
-   * @brief Deinitialize the async entity states parser
-   *
-   * Cleans up resources and stops the background parsing task.
-   */
-  void entity_states_parser_deinit(void);
-
-  /**
-   * @brief Submit JSON data for async parsing
-   *
-   * Submits JSON response data to be parsed asynchronously in the background.
-   * The JSON data will be copied to SPIRAM and processed when CPU is idle.
-   * The calling task will be notified when parsing is complete.
-   *
-   * @param json_data Raw JSON response data (will be copied to SPIRAM)
-   * @param json_size Size of JSON data in bytes
-   * @param entity_ids Array of entity IDs to search for
-   * @param entity_count Number of entities in the array
-   * @param states Output array for entity states (must remain valid until completion)
-   * @return ESP_OK on success, error code on failure
-   */
-  esp_err_t entity_states_parser_submit_async(
-      const char *json_data,
-      size_t json_size,
-      const char **entity_ids,
-      int entity_count,
-      ha_entity_state_t *states);
-
-  /**
-   * @brief Wait for async parsing to complete
-   *
-   * Blocks the calling task until the async parsing job is complete.
-   * This function should be called after submitting a job with
-   * entity_states_parser_submit_async().
-   *
-   * @param timeout_ms Timeout in milliseconds (portMAX_DELAY for no timeout)
-   * @return ESP_OK if parsing completed successfully, ESP_ERR_TIMEOUT on timeout
-   */
-  esp_err_t entity_states_parser_wait_completion(uint32_t timeout_ms);
-
-  /**
-   * @brief Parse JSON synchronously (blocking)
-   *
-   * Parses JSON data immediately in the calling task. Use this for small
-   * responses or when immediate results are needed.
-   *
-   * @param json_data Raw JSON response data
-   * @param entity_ids Array of entity IDs to search for
-   * @param entity_count Number of entities in the array
-   * @param states Output array for entity states
-   * @return ESP_OK on success, error code on failure
-   */
-  esp_err_t entity_states_parser_parse_sync(
-      const char *json_data,
-      const char **entity_ids,
-      int entity_count,
-      ha_entity_state_t *states);
-
-  /**
-   * @brief Get parser performance statistics
-   *
-   * Returns performance metrics for the async parser including timing
-   * and success/failure counts.
-   *
-   * @param stats Pointer to statistics structure to fill
-   * @return ESP_OK on success, error code on failure
-   */
-  esp_err_t entity_states_parser_get_stats(entity_parser_stats_t *stats);
-
-  /**
-   * @brief Reset parser performance statistics
-   *
-   * Clears all performance counters and statistics.
-   */
-  void entity_states_parser_reset_stats(void);
-
-  /**
-   * @brief Check if parser is ready for use
-   *
-   * @return true if parser is initialized and ready, false otherwise
-   */
-  bool entity_states_parser_is_ready(void);
-
-  /**
-   * @brief Get number of pending parse jobs
-   *
-   * @return Number of jobs currently queued for processing
-   */
-  int entity_states_parser_get_queue_size(void);
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif // ENTITY_STATES_PARSER_H
+﻿/**
+ * @file entity_states_parser.h
+ * @brief Async Entity States JSON Parser for Home Assistant API
+ *
+ * This module provides asynchronous JSON parsing functionality for Home Assistant
+ * entity states using SPIRAM for large response handling. The parser runs on
+ * CPU idle time to avoid blocking the main application.
+ *
+ * Features:
+ * - Async parse jobs with handles, per-job results and cancellation
+ * - Optional second worker on the other core for large documents
+ * - SPIRAM allocation for large responses
+ * - Background processing with idle-time CPU usage
+ * - Entity state extraction and filtering
+ * - Performance timing and monitoring
+ * - Streaming parser fed chunk by chunk, independent of response size
+ *
+ * @author System Monitor Dashboard
+ * @date 2025-08-19
+ */
+
+#ifndef ENTITY_STATES_PARSER_H
+#define ENTITY_STATES_PARSER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "ha_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+/** Maximum number of async parse jobs in queue */
+#define ENTITY_PARSER_MAX_JOBS 2
+
+/** Documents smaller than this are not worth splitting */
+#define ENTITY_PARSER_SPLIT_MIN_BYTES 16384
+
+/** Bytes parsed between checks for cancellation */
+#define ENTITY_PARSER_CHUNK_BYTES 4096
+
+/** Handle that never refers to a job */
+#define ENTITY_PARSE_HANDLE_NONE 0
+
+/** Longest object key the streaming parser needs to recognise */
+#define ENTITY_STREAM_KEY_LEN 24
+
+/** ISO 8601 timestamp with microseconds and zone, plus terminator */
+#define ENTITY_STREAM_TIMESTAMP_LEN 40
+
+/** Nesting depth tracked exactly by the streaming parser */
+#define ENTITY_STREAM_MAX_DEPTH 32
+
+/** Requested entities indexed by hash, larger requests fall back to a linear scan */
+#define ENTITY_LOOKUP_MAX_ENTITIES 64
+
+/** Hash table slots, power of two and at least twice the entities for short probes */
+#define ENTITY_LOOKUP_SLOTS 128
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Identifies one async parse job until it is waited for or cancelled
+   */
+  typedef uint32_t entity_parse_handle_t;
+
+  /**
+   * @brief Open-addressing index of the requested entity IDs
+   *
+   * Built once per parse so each entity in the response costs one hash and
+   * usually a single strcmp, instead of a compare against every requested ID.
+   */
+  typedef struct
+  {
+    const char *const *entity_ids;          ///< Requested IDs, not copied
+    int entity_count;                       ///< Number of requested IDs
+    bool indexed;                           ///< false when entity_count exceeds the table
+    uint32_t hashes[ENTITY_LOOKUP_SLOTS];   ///< FNV-1a hash of the ID in each slot
+    int8_t slots[ENTITY_LOOKUP_SLOTS];      ///< Index into entity_ids, -1 if empty
+  } entity_lookup_t;
+
+  /**
+   * @brief Incremental /api/states parser
+   *
+   * Tokenises the response as it arrives and only keeps the fields of the
+   * entity object currently being read. Nothing outside the requested set is
+   * materialised, so memory use does not depend on the response size.
+   */
+  typedef struct
+  {
+    const char **entity_ids;   ///< Entities to look for
+    int entity_count;          ///< Number of entities to look for
+    ha_entity_state_t *states; ///< Output, filled in request order
+    entity_lookup_t lookup;    ///< Index of entity_ids
+    int found_count;           ///< Requested entities seen so far
+    size_t bytes_fed;          ///< Size of the document so far
+    int64_t start_time;        ///< esp_timer time of entity_states_stream_begin()
+
+    // Tokeniser
+    int depth;                  ///< Current nesting, 1 inside the top-level array
+    uint32_t object_mask;       ///< Bit per depth, set for objects
+    bool expect_key;            ///< Next string in this object is a key
+    bool value_pending;         ///< Key and ':' seen, value not started
+    bool in_string;             ///< Inside a string literal
+    bool string_is_key;         ///< Current string is an object key
+    bool escape;                ///< Previous character was a backslash
+    uint8_t unicode_digits;     ///< Hex digits of a unicode escape still to read
+    uint16_t unicode_value;     ///< Code unit being assembled
+    char *capture;              ///< Buffer receiving the current string, NULL to skip
+    size_t capture_size;        ///< Size of the capture buffer
+    size_t capture_len;         ///< Characters captured
+    bool capture_overflow;      ///< String was longer than the buffer
+    char number[16];            ///< Number literal being read for a level field
+    uint8_t number_len;         ///< Characters in number, 0 when not reading one
+    uint8_t number_field;       ///< Field the number belongs to
+    uint8_t field;              ///< Field the current key selects
+    bool in_attributes;         ///< Inside the attributes object of an entity
+    bool complete;              ///< Top-level array closed
+    bool error;                 ///< Malformed document
+
+    // Entity object being read
+    char key[ENTITY_STREAM_KEY_LEN];
+    char entity_id[HA_MAX_ENTITY_ID_LEN];
+    char state[HA_MAX_STATE_LEN];
+    char friendly_name[HA_MAX_FRIENDLY_NAME_LEN];
+    char last_changed[ENTITY_STREAM_TIMESTAMP_LEN];
+    char last_updated[ENTITY_STREAM_TIMESTAMP_LEN]; ///< Fallback when last_changed is absent
+    float level;                ///< Brightness or target temperature attribute
+    bool have_entity_id;
+    bool have_state;
+    bool have_level;
+    bool level_is_brightness;   ///< Brightness wins over temperature in either order
+  } entity_stream_parser_t;
+
+  /**
+   * @brief Parser performance statistics
+   */
+  typedef struct
+  {
+    int64_t total_parse_time_ms;   ///< Total parsing time in milliseconds
+    int64_t average_parse_time_ms; ///< Average parsing time per job
+    uint32_t jobs_processed;       ///< Number of jobs processed
+    uint32_t entities_found;       ///< Total entities successfully found
+    uint32_t entities_missing;     ///< Total entities not found
+    size_t largest_response_size;  ///< Largest JSON response processed
+  } entity_parser_stats_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Initialize the async entity states parser
+   *
+   * Creates the background task and queue for async JSON processing.
+   * Must be called before using any other parser functions.
+   *
+   * @return ESP_OK on success, error code on failure
+   */
+  esp_err_t entity_states_parser_init(void);
+
+  /**
+   * @brief Deinitialize the async entity states parser
+   *
+   * Cleans up resources and stops the background parsing task.
+   */
+  void entity_states_parser_deinit(void);
+
+  /**
+   * @brief Submit an /api/states document for async parsing
+   *
+   * The document is copied to SPIRAM and streamed through the incremental
+   * parser by the parser task. Documents of ENTITY_PARSER_SPLIT_MIN_BYTES or
+   * more are split at the entity boundary nearest the middle, the back half
+   * going to the second worker on the other core.
+   *
+   * Every handle must be passed to entity_states_parser_wait() until it
+   * stops returning ESP_ERR_TIMEOUT, or to entity_states_parser_cancel().
+   *
+   * @param json_data Raw JSON response data (will be copied to SPIRAM)
+   * @param json_size Size of JSON data in bytes
+   * @param entity_ids Array of entity IDs to search for
+   * @param entity_count Number of entities in the array
+   * @param states Output array for entity states (must remain valid until the job ends)
+   * @param handle Receives the job handle
+   * @return ESP_OK on success, ESP_ERR_NO_MEM if the copy fails or all job slots are taken
+   */
+  esp_err_t entity_states_parser_submit(
+      const char *json_data,
+      size_t json_size,
+      const char **entity_ids,
+      int entity_count,
+      ha_entity_state_t *states,
+      entity_parse_handle_t *handle);
+
+  /**
+   * @brief Wait for a parse job and collect its result
+   *
+   * The handle stays valid after ESP_ERR_TIMEOUT and is released by any
+   * other return value.
+   *
+   * @param handle Job from entity_states_parser_submit()
+   * @param timeout_ms Timeout in milliseconds (portMAX_DELAY for no timeout)
+   * @param found_count Receives the number of entities found, may be NULL
+   * @return Result of the job: ESP_OK, ESP_ERR_NOT_FOUND if no entity was
+   *         present, ESP_ERR_INVALID_RESPONSE for a malformed document;
+   *         ESP_ERR_TIMEOUT if it is still running, ESP_ERR_INVALID_ARG for
+   *         an unknown handle
+   */
+  esp_err_t entity_states_parser_wait(entity_parse_handle_t handle, uint32_t timeout_ms, int *found_count);
+
+  /**
+   * @brief Cancel a parse job and release its handle
+   *
+   * Returns once the workers no longer touch the job's states array, which
+   * is then left partly filled.
+   *
+   * @param handle Job from entity_states_parser_submit()
+   * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown handle
+   */
+  esp_err_t entity_states_parser_cancel(entity_parse_handle_t handle);
+
+  /**
+   * @brief Parse JSON synchronously (blocking)
+   *
+   * Parses JSON data immediately in the calling task. Use this for small
+   * responses or when immediate results are needed.
+   *
+   * @param json_data Raw JSON response data
+   * @param entity_ids Array of entity IDs to search for
+   * @param entity_count Number of entities in the array
+   * @param states Output array for entity states
+   * @return ESP_OK on success, error code on failure
+   */
+  esp_err_t entity_states_parser_parse_sync(
+      const char *json_data,
+      const char **entity_ids,
+      int entity_count,
+      ha_entity_state_t *states);
+
+  /**
+   * @brief Start a streaming parse
+   *
+   * @param parser Parser state to initialise
+   * @param entity_ids Array of entity IDs to search for
+   * @param entity_count Number of entities in the array
+   * @param states Output array for entity states, cleared here
+   * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters
+   */
+  esp_err_t entity_states_stream_begin(
+      entity_stream_parser_t *parser,
+      const char **entity_ids,
+      int entity_count,
+      ha_entity_state_t *states);
+
+  /**
+   * @brief Feed the next chunk of the /api/states response
+   *
+   * Chunks may split tokens anywhere, including inside escapes.
+   *
+   * @param parser Parser started with entity_states_stream_begin()
+   * @param data Chunk of the response
+   * @param len Chunk length
+   * @return ESP_OK, or ESP_ERR_INVALID_RESPONSE once the document is malformed
+   */
+  esp_err_t entity_states_stream_feed(entity_stream_parser_t *parser, const char *data, size_t len);
+
+  /**
+   * @brief Finish a streaming parse and update the statistics
+   *
+   * @param parser Parser that received the whole response
+   * @return ESP_OK if at least one entity was found, ESP_ERR_NOT_FOUND if none,
+   *         ESP_ERR_INVALID_RESPONSE if the document was malformed or incomplete
+   */
+  esp_err_t entity_states_stream_finish(entity_stream_parser_t *parser);
+
+  /**
+   * @brief Index a set of entity IDs
+   *
+   * @param lookup Table to fill
+   * @param entity_ids Array of entity IDs, must outlive the table
+   * @param entity_count Number of entity IDs
+   */
+  void entity_lookup_build(entity_lookup_t *lookup, const char *const *entity_ids, int entity_count);
+
+  /**
+   * @brief Find an entity in an indexed set
+   *
+   * @param lookup Table built by entity_lookup_build()
+   * @param entity_id Entity ID to look up
+   * @return Index into the indexed IDs, -1 if not present
+   */
+  int entity_lookup_find(const entity_lookup_t *lookup, const char *entity_id);
+
+  /**
+   * @brief Get parser performance statistics
+   *
+   * Returns performance metrics for the async parser including timing
+   * and success/failure counts.
+   *
+   * @param stats Pointer to statistics structure to fill
+   * @return ESP_OK on success, error code on failure
+   */
+  esp_err_t entity_states_parser_get_stats(entity_parser_stats_t *stats);
+
+  /**
+   * @brief Reset parser performance statistics
+   *
+   * Clears all performance counters and statistics.
+   */
+  void entity_states_parser_reset_stats(void);
+
+  /**
+   * @brief Check if parser is ready for use
+   *
+   * @return true if parser is initialized and ready, false otherwise
+   */
+  bool entity_states_parser_is_ready(void);
+
+  /**
+   * @brief Get number of pending parse jobs
+   *
+   * @return Number of jobs submitted and not yet waited for or cancelled
+   */
+  int entity_states_parser_get_queue_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENTITY_STATES_PARSER_H
@@ -1,975 +1,2482 @@
-﻿/**
- * @file ha_api.c
- * @brief Home Assistant REST API Client Implementation
- *
- * This module implements HTTP client functionality for Home Assistant REST API.
- *
- * @author System Monitor Dashboard
- * @date 2025-08-14
- */
-
-#include "ha_api.h"
-
-#include <stdio.h>
-#include <string.h>
-#include "cJSON.h"
-#include "entity_states_parser.h"
-#include "esp_http_client.h"
-#include "esp_netif.h"
-#include "esp_task_wdt.h"
-#include "esp_timer.h"
-#include "esp_wifi.h"
-#include "ha_status.h"
-#include "lwip/netdb.h"
-#include "smart_config.h"
-#include "system_debug_utils.h"
-
-/** HTTP User-Agent string */
-#define USER_AGENT "ESP32-SystemMonitor/1.0"
-
-/** HTTP headers template */
-#define AUTH_HEADER_TEMPLATE "Bearer %s"
-#define CONTENT_TYPE_JSON "application/json"
-
-// =======================================================================
-// PRIVATE VARIABLES
-// =======================================================================
-
-static bool ha_api_initialized = false;
-static char auth_header[256];
-static esp_http_client_handle_t persistent_client = NULL;
-static char current_base_url[256] = {0};
-
-// =======================================================================
-// PRIVATE FUNCTION DECLARATIONS
-// =======================================================================
-
-static esp_err_t http_event_handler(esp_http_client_event_t *evt);
-static esp_http_client_handle_t create_http_client(const char *url);
-static esp_http_client_handle_t get_persistent_client(const char *url);
-static void cleanup_persistent_client(void);
-static esp_err_t perform_http_request(const char *url, const char *method, const char *post_data, ha_api_response_t *response);
-
-// =======================================================================
-// PRIVATE FUNCTION IMPLEMENTATIONS
-// =======================================================================
-
-/**
- * @brief Check network connectivity to Home Assistant server
- * @return true if server is reachable, false otherwise
- */
-static bool check_network_connectivity(void)
-{
-  // Check WiFi connection first
-  wifi_ap_record_t ap_info;
-  esp_err_t ret = esp_wifi_sta_get_ap_info(&ap_info);
-  if (ret != ESP_OK)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "WiFi not connected");
-    return false;
-  }
-
-  return true;
-}
-
-/**
- * @brief HTTP event handler for response data collection
- */
-static esp_err_t http_event_handler(esp_http_client_event_t *evt)
-{
-  ha_api_response_t *response = (ha_api_response_t *)evt->user_data;
-
-  switch (evt->event_id)
-  {
-  case HTTP_EVENT_ERROR:
-    debug_log_error(DEBUG_TAG_HA_API, "HTTP_EVENT_ERROR occurred");
-    if (response)
-    {
-      snprintf(response->error_message, sizeof(response->error_message), "HTTP error occurred");
-      response->success = false;
-    }
-    break;
-
-  case HTTP_EVENT_ON_CONNECTED:
-  case HTTP_EVENT_HEADER_SENT:
-  case HTTP_EVENT_ON_HEADER:
-    break;
-
-  case HTTP_EVENT_ON_DATA:
-    if (response && evt->data_len > 0)
-    {
-      if (response->response_data == NULL)
-      {
-        response->response_data = malloc(HA_MAX_RESPONSE_SIZE);
-        if (response->response_data == NULL)
-        {
-          debug_log_error(DEBUG_TAG_HA_API, "Failed to allocate response buffer");
-          return ESP_FAIL;
-        }
-        response->response_len = 0;
-        response->response_data[0] = '\0'; // Initialize with null terminator
-      }
-
-      if (response->response_data && (response->response_len + evt->data_len) <= (HA_MAX_RESPONSE_SIZE - 1))
-      {
-        memcpy(response->response_data + response->response_len, evt->data, evt->data_len);
-        response->response_len += evt->data_len;
-        response->response_data[response->response_len] = '\0';
-
-        // Log progress for large responses (every 10KB)
-        if (response->response_len > 0 && (response->response_len % 10240) == 0)
-        {
-          // Progress logging skipped for performance
-        }
-      }
-      else if (response->response_data)
-      {
-        // Log if we're hitting buffer size limits
-        debug_log_warning_f(DEBUG_TAG_HA_API, "Response buffer limit reached: %zu + %d >= %d bytes",
-                            response->response_len, evt->data_len, HA_MAX_RESPONSE_SIZE - 1);
-      }
-    }
-    break;
-
-  case HTTP_EVENT_ON_FINISH:
-    if (response)
-    {
-      response->status_code = esp_http_client_get_status_code((esp_http_client_handle_t)evt->client);
-      response->success = (response->status_code >= 200 && response->status_code < 300);
-    }
-    break;
-
-  case HTTP_EVENT_DISCONNECTED:
-    break;
-
-  case HTTP_EVENT_REDIRECT:
-    break;
-
-  default:
-    break;
-  }
-
-  return ESP_OK;
-}
-
-/**
- * @brief Create and configure HTTP client
- */
-static esp_http_client_handle_t create_http_client(const char *url)
-{
-  esp_http_client_config_t config = {
-      .url = url,
-      .event_handler = http_event_handler,
-      .timeout_ms = HA_HTTP_TIMEOUT_MS, // 8 seconds total timeout
-      .user_agent = USER_AGENT,
-      .buffer_size = HA_MAX_RESPONSE_SIZE,
-      .buffer_size_tx = 2048,              // Increased TX buffer for better throughput
-      .keep_alive_enable = true,           // Enable keep-alive for multiple requests
-      .keep_alive_idle = 15,               // Keep connection alive for 15 seconds
-      .keep_alive_interval = 5,            // Send keep-alive every 5 seconds
-      .keep_alive_count = 3,               // Send up to 3 keep-alive probes
-      .disable_auto_redirect = false,      // Enable redirects
-      .max_redirection_count = 3,          // Allow up to 3 redirects
-      .max_authorization_retries = 1,      // Limit auth retries
-      .use_global_ca_store = false,        // Skip SSL verification for faster connections
-      .skip_cert_common_name_check = true, // Skip SSL cert name check
-  };
-
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  if (client)
-  {
-    // Client created successfully
-  }
-  else
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Failed to create HTTP client");
-  }
-
-  return client;
-}
-
-/**
- * @brief Get or create persistent HTTP client
- */
-static esp_http_client_handle_t get_persistent_client(const char *url)
-{
-  // Extract base URL (scheme + host + port)
-  char base_url[256] = {0};
-  const char *path_start = strstr(url, "://");
-  if (path_start)
-  {
-    path_start += 3; // Skip "://"
-    const char *path_end = strchr(path_start, '/');
-    if (path_end)
-    {
-      size_t base_len = path_end - url;
-      if (base_len < sizeof(base_url))
-      {
-        strncpy(base_url, url, base_len);
-        base_url[base_len] = '\0';
-      }
-    }
-    else
-    {
-      strncpy(base_url, url, sizeof(base_url) - 1);
-    }
-  }
-
-  // Check if we need to create a new client or can reuse existing one
-  if (persistent_client == NULL || strcmp(current_base_url, base_url) != 0)
-  {
-    // Clean up existing client if base URL changed
-    if (persistent_client != NULL)
-    {
-      // Base URL changed, cleaning up old client
-      cleanup_persistent_client();
-    }
-
-    // Creating new persistent HTTP client
-    persistent_client = create_http_client(base_url);
-    if (persistent_client)
-    {
-      strncpy(current_base_url, base_url, sizeof(current_base_url) - 1);
-      current_base_url[sizeof(current_base_url) - 1] = '\0';
-    }
-  }
-
-  return persistent_client;
-}
-
-/**
- * @brief Clean up persistent HTTP client
- */
-static void cleanup_persistent_client(void)
-{
-  if (persistent_client != NULL)
-  {
-    esp_http_client_cleanup(persistent_client);
-    persistent_client = NULL;
-    current_base_url[0] = '\0';
-  }
-}
-
-/**
- * @brief Perform HTTP request with retry logic
- */
-static esp_err_t perform_http_request(const char *url, const char *method, const char *post_data, ha_api_response_t *response)
-{
-  if (post_data)
-  {
-    // Large POST data logging skipped for performance
-  }
-
-  // Parameter validation
-  if (!ha_api_initialized)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "HA API not initialized");
-    return ESP_ERR_INVALID_STATE;
-  }
-
-  // Notify that we're starting a request (syncing)
-  ha_status_change(HA_STATUS_SYNCING);
-
-  // Check network connectivity before attempting HTTP request
-  if (!check_network_connectivity())
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Network connectivity check failed, skipping HTTP request");
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-    if (response)
-    {
-      response->success = false;
-      response->status_code = 0;
-    }
-    return ESP_ERR_NOT_FOUND;
-  }
-
-  esp_err_t err = ESP_FAIL;
-  int status_code = 0;
-
-  for (int retry = 0; retry < HA_SYNC_RETRY_COUNT; retry++)
-  {
-    esp_http_client_handle_t client;
-    bool use_fresh_client = true; // Always use fresh clients to avoid connection issues
-
-    if (use_fresh_client)
-    {
-      client = create_http_client(url);
-      if (client == NULL)
-      {
-        debug_log_error(DEBUG_TAG_HA_API, "Failed to create fresh HTTP client");
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        continue;
-      }
-    }
-    else
-    {
-      client = get_persistent_client(url);
-      if (client == NULL)
-      {
-        debug_log_error(DEBUG_TAG_HA_API, "Failed to get HTTP client");
-        vTaskDelay(pdMS_TO_TICKS(1000)); // Wait before retry
-        continue;
-      }
-    }
-
-    // Set URL for this specific request (in case of persistent client)
-    esp_http_client_set_url(client, url);
-
-    // Set headers
-    esp_http_client_set_header(client, "Authorization", auth_header);
-
-    if (strcmp(method, "POST") == 0)
-    {
-      esp_http_client_set_header(client, "Content-Type", CONTENT_TYPE_JSON);
-    }
-
-    // Set method
-    if (strcmp(method, "POST") == 0)
-    {
-      esp_http_client_set_method(client, HTTP_METHOD_POST);
-      if (post_data)
-      {
-        esp_http_client_set_post_field(client, post_data, strlen(post_data));
-      }
-    }
-    else
-    {
-      esp_http_client_set_method(client, HTTP_METHOD_GET);
-    }
-
-    // Set user data for event handler
-    if (response)
-    {
-      memset(response, 0, sizeof(ha_api_response_t));
-      esp_http_client_set_user_data(client, response);
-    }
-
-    // Perform request with timeout tracking
-    int64_t request_start_time = esp_timer_get_time();
-
-    // Perform the HTTP request
-    err = esp_http_client_perform(client);
-
-    // Record completion time
-    int64_t request_end_time = esp_timer_get_time();
-    int64_t request_duration = (request_end_time - request_start_time) / 1000; // Convert to milliseconds
-
-    // Log timeout-specific information
-    if (err == ESP_ERR_TIMEOUT)
-    {
-      debug_log_error_f(DEBUG_TAG_HA_API, "HTTP request timed out after %lld ms (timeout limit: %d ms)",
-                        request_duration, HA_HTTP_TIMEOUT_MS);
-    }
-    else if (request_duration > (HA_HTTP_TIMEOUT_MS / 2))
-    {
-      debug_log_warning_f(DEBUG_TAG_HA_API, "Slow HTTP request: %lld ms (more than half timeout)", request_duration);
-    }
-
-    // Get status code for logging
-    status_code = esp_http_client_get_status_code(client);
-
-    // Handle client cleanup/connection management
-    if (use_fresh_client)
-    {
-      esp_http_client_cleanup(client);
-    }
-    else
-    {
-      // For persistent client, DON'T close the connection - keep it alive for reuse
-      // esp_http_client_close(client); // REMOVED - this was breaking keep-alive
-    }
-
-    if (err == ESP_OK)
-    {
-      break;
-    }
-    else
-    {
-      debug_log_warning_f(DEBUG_TAG_HA_API, "HTTP request failed (attempt %d/%d): %s (status: %d)",
-                          retry + 1, HA_SYNC_RETRY_COUNT, esp_err_to_name(err), status_code);
-      if (response)
-      {
-        snprintf(response->error_message, sizeof(response->error_message),
-                 "HTTP request failed: %s (status: %d)", esp_err_to_name(err), status_code);
-      }
-    }
-
-    // Wait before retry
-    if (retry < HA_SYNC_RETRY_COUNT - 1)
-    {
-      // Notify retry status
-      {
-        ha_status_change(HA_STATUS_SYNCING);
-      }
-
-      vTaskDelay(pdMS_TO_TICKS(500)); // Fixed 500ms delay for faster retries
-    }
-  }
-
-  if (err != ESP_OK)
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "HTTP request failed (Final status: %d, Error: %s)", status_code, esp_err_to_name(err));
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-  }
-
-  return err;
-}
-
-// =======================================================================
-// PUBLIC FUNCTION IMPLEMENTATIONS
-// =======================================================================
-
-esp_err_t ha_api_init(void)
-{
-  if (ha_api_initialized)
-  {
-    debug_log_warning(DEBUG_TAG_HA_API, "Home Assistant API already initialized");
-    return ESP_OK;
-  }
-
-  // Check if constants are properly defined
-  if (HA_API_TOKEN == NULL || strlen(HA_API_TOKEN) == 0)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "HA API Token is not defined or empty");
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  if (HA_SERVER_HOST_NAME == NULL || strlen(HA_SERVER_HOST_NAME) == 0)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "HA Server Host Name is not defined or empty");
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  // Format authorization header with error checking
-  int ret = snprintf(auth_header, sizeof(auth_header), AUTH_HEADER_TEMPLATE, HA_API_TOKEN);
-  if (ret < 0 || ret >= sizeof(auth_header))
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "Failed to format authorization header: %d", ret);
-    return ESP_ERR_NO_MEM;
-  }
-
-  // Initialize async entity states parser
-  esp_err_t parser_err = entity_states_parser_init();
-  if (parser_err != ESP_OK)
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "Failed to initialize entity states parser: %s", esp_err_to_name(parser_err));
-    return parser_err;
-  }
-
-  ha_api_initialized = true;
-
-  // Notify status callback about initialization
-  ha_status_change(HA_STATUS_READY);
-
-  return ESP_OK;
-}
-
-esp_err_t ha_api_deinit(void)
-{
-  if (!ha_api_initialized)
-  {
-    return ESP_OK;
-  }
-
-  // Deinitialize async entity states parser
-  entity_states_parser_deinit();
-
-  // Clean up persistent HTTP client
-  cleanup_persistent_client();
-
-  ha_api_initialized = false;
-  memset(auth_header, 0, sizeof(auth_header));
-
-  // Notify status callback about deinitialization
-  ha_status_change(HA_STATUS_OFFLINE);
-
-  return ESP_OK;
-}
-
-esp_err_t ha_api_get_entity_state(const char *entity_id, ha_entity_state_t *state)
-{
-  if (!entity_id || !state)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  char url[256];
-  snprintf(url, sizeof(url), "%s/%s", HA_API_STATES_URL, entity_id);
-
-  ha_api_response_t response;
-  esp_err_t err = perform_http_request(url, "GET", NULL, &response);
-
-  if (err == ESP_OK && response.success)
-  {
-    err = ha_api_parse_entity_state(response.response_data, state);
-  }
-
-  ha_api_free_response(&response);
-  return err;
-}
-
-esp_err_t ha_api_get_multiple_entity_states(const char **entity_ids, int entity_count, ha_entity_state_t *states)
-{
-  if (!entity_ids || !states || entity_count <= 0)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  // Notify that we're starting a sync operation
-  ha_status_change(HA_STATUS_SYNCING);
-
-  // Clear all states first
-  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
-
-  esp_err_t overall_result = ESP_OK;
-  int success_count = 0;
-  int consecutive_failures = 0;
-
-  // Fetch each entity state individually but with early exit on consecutive failures
-  for (int i = 0; i < entity_count; i++)
-  {
-    esp_err_t result = ha_api_get_entity_state(entity_ids[i], &states[i]);
-    if (result == ESP_OK)
-    {
-      success_count++;
-      consecutive_failures = 0; // Reset failure counter on success
-      // Entity state fetched successfully
-    }
-    else
-    {
-      consecutive_failures++;
-      debug_log_warning_f(DEBUG_TAG_HA_API, "Failed to fetch entity %s: %s", entity_ids[i], esp_err_to_name(result));
-      overall_result = result; // Keep track of last error
-
-      // Early exit with more intelligent failure detection
-      if (consecutive_failures >= 2)
-      {
-        // Stop for persistent connection issues
-        if (result == ESP_ERR_HTTP_CONNECT || result == ESP_ERR_HTTP_EAGAIN)
-        {
-          debug_log_error(DEBUG_TAG_HA_API, "Multiple consecutive connection failures, aborting sync to prevent timeout");
-          break;
-        }
-        // Also stop for timeout errors that indicate network issues
-        else if (result == ESP_ERR_TIMEOUT)
-        {
-          debug_log_error(DEBUG_TAG_HA_API, "Multiple consecutive timeouts, network appears unstable");
-          break;
-        }
-      }
-    }
-
-    // Adaptive delay between requests based on failure status
-    if (i < entity_count - 1) // Don't delay after the last request
-    {
-      if (consecutive_failures > 0)
-      {
-        // Longer delay after failures to let network recover
-        vTaskDelay(pdMS_TO_TICKS(250)); // 250ms delay after failures
-      }
-      else
-      {
-        // Normal delay for successful requests
-        vTaskDelay(pdMS_TO_TICKS(100)); // 100ms delay between successful requests
-      }
-    }
-  }
-
-  if (success_count == entity_count)
-  {
-
-    // Notify successful sync completion
-    ha_status_change(HA_STATUS_STATES_SYNCED);
-
-    return ESP_OK;
-  }
-  else if (success_count > 0)
-  {
-    debug_log_warning_f(DEBUG_TAG_HA_API, "Fetched %d/%d entity states", success_count, entity_count);
-
-    // Notify partial sync
-    ha_status_change(HA_STATUS_PARTIAL_SYNC);
-
-    return ESP_ERR_NOT_FOUND;
-  }
-  else
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Failed to fetch any entity states");
-
-    // Notify sync failure
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-
-    return overall_result;
-  }
-}
-
-/**
- * @brief Get multiple entity states using bulk API request
- * This method fetches ALL states and filters the requested entities
- * Much faster than individual requests but larger response payload
- */
-esp_err_t ha_api_get_multiple_entity_states_bulk(const char **entity_ids, int entity_count, ha_entity_state_t *states)
-{
-  if (!entity_ids || !states || entity_count <= 0)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  // Notify that we're starting a sync operation
-  ha_status_change(HA_STATUS_SYNCING);
-
-  // Clear all states first
-  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
-
-  // Measure timing
-  int64_t start_time = esp_timer_get_time();
-  int64_t request_time = 0; // Will be set after HTTP request completes
-
-  // Make single bulk request to get ALL states
-  ha_api_response_t response = {0};
-  esp_err_t err = perform_http_request(HA_API_STATES_URL, "GET", NULL, &response);
-
-  request_time = esp_timer_get_time() - start_time;
-
-  debug_log_debug_f(DEBUG_TAG_HA_API, "Bulk request completed in %lld ms", request_time / 1000);
-
-  if (err != ESP_OK)
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "Bulk request failed: %s", esp_err_to_name(err));
-
-    // Provide more specific error information
-    if (err == ESP_ERR_TIMEOUT)
-    {
-      debug_log_error(DEBUG_TAG_HA_API, "Request timed out - Home Assistant may be slow or response too large");
-    }
-    else if (err == ESP_ERR_NOT_FOUND)
-    {
-      debug_log_error(DEBUG_TAG_HA_API, "Network connectivity issue - check Home Assistant server");
-    }
-
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-    return err;
-  }
-
-  // Check response size and completeness
-  size_t response_size = response.response_data ? strlen(response.response_data) : 0;
-
-  if (response_size == 0)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Empty bulk response received");
-    ha_api_free_response(&response);
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-    return ESP_ERR_INVALID_RESPONSE;
-  }
-
-  // Check if response looks complete (should be JSON array ending with ']')
-  if (response_size > 0 && response.response_data[response_size - 1] != ']')
-  {
-    debug_log_warning_f(DEBUG_TAG_HA_API, "Response may be truncated - doesn't end with ']' (last char: '%c', 0x%02X)",
-                        response.response_data[response_size - 1],
-                        (unsigned char)response.response_data[response_size - 1]);
-  }
-
-  if (response_size > 32768) // 32KB limit for safety
-  {
-    debug_log_warning_f(DEBUG_TAG_HA_API, "Very large response (%zu bytes), this may cause memory issues", response_size);
-  }
-
-  // Start JSON parsing timing
-  int64_t parse_start = esp_timer_get_time();
-
-  // Parse JSON response using entity states parser
-  const size_t ASYNC_THRESHOLD = 16384; // 16KB threshold
-  bool use_async = (response_size > ASYNC_THRESHOLD) && entity_states_parser_is_ready();
-
-  esp_err_t parse_err;
-  int success_count = 0;
-
-  if (use_async)
-  {
-    // Submit for async parsing
-    parse_err = entity_states_parser_submit_async(
-        response.response_data,
-        response_size,
-        entity_ids,
-        entity_count,
-        states);
-
-    if (parse_err == ESP_OK)
-    {
-      // Wait for completion with timeout, resetting watchdog periodically
-      const int timeout_ms = 30000;       // 30 second total timeout
-      const int check_interval_ms = 2000; // Check every 2 seconds
-      int elapsed_ms = 0;
-
-      while (elapsed_ms < timeout_ms)
-      {
-        parse_err = entity_states_parser_wait_completion(check_interval_ms);
-
-        if (parse_err != ESP_ERR_TIMEOUT)
-        {
-          break; // Completed or failed
-        }
-
-        elapsed_ms += check_interval_ms;
-        // Async parsing still in progress
-      }
-
-      if (parse_err == ESP_OK)
-      {
-        // Count successful entities (states with non-empty entity_id)
-        for (int i = 0; i < entity_count; i++)
-        {
-          if (strlen(states[i].entity_id) > 0)
-          {
-            success_count++;
-          }
-        }
-      }
-      else if (parse_err == ESP_ERR_TIMEOUT)
-      {
-        debug_log_error(DEBUG_TAG_HA_API, "Async parsing timed out");
-      }
-      else
-      {
-        debug_log_error_f(DEBUG_TAG_HA_API, "Async parsing failed: %s", esp_err_to_name(parse_err));
-      }
-    }
-    else
-    {
-      debug_log_warning_f(DEBUG_TAG_HA_API, "Failed to submit async parsing: %s, falling back to sync", esp_err_to_name(parse_err));
-      use_async = false; // Fall back to sync parsing
-    }
-  }
-
-  if (!use_async)
-  {
-    parse_err = entity_states_parser_parse_sync(
-        response.response_data,
-        entity_ids,
-        entity_count,
-        states);
-
-    if (parse_err == ESP_OK)
-    {
-      // Count successful entities (states with non-empty entity_id)
-      for (int i = 0; i < entity_count; i++)
-      {
-        if (strlen(states[i].entity_id) > 0)
-        {
-          success_count++;
-        }
-      }
-    }
-    else
-    {
-      debug_log_error_f(DEBUG_TAG_HA_API, "Sync parsing failed: %s", esp_err_to_name(parse_err));
-    }
-  }
-
-  ha_api_free_response(&response);
-
-  // Handle parsing failure
-  if (parse_err != ESP_OK)
-  {
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-    return parse_err;
-  }
-
-  int64_t parse_time = esp_timer_get_time() - parse_start;
-  int64_t total_time = esp_timer_get_time() - start_time;
-
-  debug_log_debug_f(DEBUG_TAG_HA_API, "Performance: Request %lld ms, Parse %lld ms, Total %lld ms",
-                    (request_time / 1000), (parse_time / 1000), (total_time / 1000));
-
-  // Determine result based on success count
-  if (success_count == entity_count)
-  {
-
-    ha_status_change(HA_STATUS_STATES_SYNCED);
-    return ESP_OK;
-  }
-  else if (success_count > 0)
-  {
-    debug_log_warning_f(DEBUG_TAG_HA_API, "Fetched %d/%d entity states via bulk request", success_count, entity_count);
-    ha_status_change(HA_STATUS_PARTIAL_SYNC);
-    return ESP_ERR_NOT_FOUND;
-  }
-  else
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Failed to fetch any entity states via bulk request");
-    ha_status_change(HA_STATUS_SYNC_FAILED);
-    return ESP_ERR_NOT_FOUND;
-  }
-}
-
-esp_err_t ha_api_call_service(const ha_service_call_t *service_call, ha_api_response_t *response)
-{
-  if (!service_call)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  char url[256];
-  snprintf(url, sizeof(url), "%s/%s/%s", HA_API_SERVICES_URL, service_call->domain, service_call->service);
-
-  // Create service data JSON
-  cJSON *json = cJSON_CreateObject();
-  cJSON *entity_id = cJSON_CreateString(service_call->entity_id);
-  cJSON_AddItemToObject(json, "entity_id", entity_id);
-
-  // Add additional service data if provided
-  if (service_call->service_data)
-  {
-    cJSON *data_item = NULL;
-    cJSON_ArrayForEach(data_item, service_call->service_data)
-    {
-      cJSON_AddItemToObject(json, data_item->string, cJSON_Duplicate(data_item, true));
-    }
-  }
-
-  char *json_string = cJSON_Print(json);
-
-  ha_api_response_t local_response;
-  ha_api_response_t *resp = response ? response : &local_response;
-
-  esp_err_t err = perform_http_request(url, "POST", json_string, resp);
-
-  if (err == ESP_OK && resp->success)
-  {
-  }
-  else
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "Service %s.%s failed for %s: %s",
-                      service_call->domain, service_call->service, service_call->entity_id,
-                      resp->error_message[0] ? resp->error_message : "Unknown error");
-  }
-
-  // Cleanup
-  free(json_string);
-  cJSON_Delete(json);
-
-  if (!response)
-  {
-    ha_api_free_response(&local_response);
-  }
-
-  return err;
-}
-
-esp_err_t ha_api_turn_on_switch(const char *entity_id)
-{
-
-  ha_service_call_t service_call = {
-      .domain = "switch",
-      .service = "turn_on",
-      .service_data = NULL};
-  strncpy(service_call.entity_id, entity_id, sizeof(service_call.entity_id) - 1);
-
-  ha_api_response_t response;
-  esp_err_t result = ha_api_call_service(&service_call, &response);
-
-  if (result == ESP_OK)
-  {
-  }
-  else
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "<<< TURN ON FAILED: %s (Error: %s)", entity_id, esp_err_to_name(result));
-  }
-
-  ha_api_free_response(&response);
-  return result;
-}
-
-esp_err_t ha_api_turn_off_switch(const char *entity_id)
-{
-
-  ha_service_call_t service_call = {
-      .domain = "switch",
-      .service = "turn_off",
-      .service_data = NULL};
-  strncpy(service_call.entity_id, entity_id, sizeof(service_call.entity_id) - 1);
-
-  ha_api_response_t response;
-  esp_err_t result = ha_api_call_service(&service_call, &response);
-
-  if (result == ESP_OK)
-  {
-  }
-  else
-  {
-    debug_log_error_f(DEBUG_TAG_HA_API, "<<< TURN OFF FAILED: %s (Error: %s)", entity_id, esp_err_to_name(result));
-  }
-
-  ha_api_free_response(&response);
-  return result;
-}
-
-esp_err_t ha_api_parse_entity_state(const char *json_str, ha_entity_state_t *state)
-{
-  if (!json_str || !state)
-  {
-    return ESP_ERR_INVALID_ARG;
-  }
-
-  memset(state, 0, sizeof(ha_entity_state_t));
-
-  cJSON *json = cJSON_Parse(json_str);
-  if (json == NULL)
-  {
-    debug_log_error(DEBUG_TAG_HA_API, "Failed to parse JSON response");
-    return ESP_ERR_INVALID_RESPONSE;
-  }
-
-  // Parse entity ID
-  cJSON *entity_id = cJSON_GetObjectItem(json, "entity_id");
-  if (cJSON_IsString(entity_id))
-  {
-    strncpy(state->entity_id, entity_id->valuestring, sizeof(state->entity_id) - 1);
-  }
-
-  // Parse state
-  cJSON *state_item = cJSON_GetObjectItem(json, "state");
-  if (cJSON_IsString(state_item))
-  {
-    strncpy(state->state, state_item->valuestring, sizeof(state->state) - 1);
-  }
-
-  // Parse friendly name from attributes
-  cJSON *attributes = cJSON_GetObjectItem(json, "attributes");
-  if (cJSON_IsObject(attributes))
-  {
-    cJSON *friendly_name = cJSON_GetObjectItem(attributes, "friendly_name");
-    if (cJSON_IsString(friendly_name))
-    {
-      strncpy(state->friendly_name, friendly_name->valuestring, sizeof(state->friendly_name) - 1);
-    }
-  }
-
-  // Parse last_updated timestamp
-  cJSON *last_updated = cJSON_GetObjectItem(json, "last_updated");
-  if (cJSON_IsString(last_updated))
-  {
-    // Convert ISO timestamp to Unix time if needed
-    // For now, just set to current time
-    state->last_updated = time(NULL);
-  }
-
-  cJSON_Delete(json);
-  return ESP_OK;
-}
-
-void ha_api_free_response(ha_api_response_t *response)
-{
-  if (response && response->response_data)
-  {
-    free(response->response_data);
-    response->response_data = NULL;
-    response->response_len = 0;
-  }
-}
-
-bool ha_api_is_ready(void)
-{
-  return ha_api_initialized;
-}
+﻿/**
+ * @file ha_api.c
+ * @brief Home Assistant REST API Client Implementation
+ *
+ * This module implements HTTP client functionality for Home Assistant REST API.
+ *
+ * @author System Monitor Dashboard
+ * @date 2025-08-14
+ */
+
+#include "ha_api.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "cJSON.h"
+#include "cycle_prof.h"
+#include "entity_states_parser.h"
+#include "esp_heap_caps.h"
+#include "esp_http_client.h"
+#if CONFIG_HA_HTTPS_CA_BUNDLE || (CONFIG_HA_SERVER_FAILOVER && CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+#include "esp_crt_bundle.h"
+#endif
+#include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "ha_http_cache.h"
+#include "ha_metrics.h"
+#include "ha_servers.h"
+#include "ha_status.h"
+#include "http_inflate.h"
+#include "json_arena.h"
+#include "lwip/inet.h"
+#include "lwip/netdb.h"
+#include "metrics.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "trace_spans.h"
+#include "wifi_power_policy.h"
+
+#ifndef HA_API_TEMPLATE_URL
+#define HA_API_TEMPLATE_URL HA_API_BASE_URL "/template"
+#endif
+
+#if CONFIG_HA_HTTPS && !CONFIG_HA_HTTPS_CA_BUNDLE && !defined(HA_SERVER_CA_CERT_PEM)
+#error "CONFIG_HA_HTTPS without the CA bundle needs HA_SERVER_CA_CERT_PEM in smart_config.h"
+#endif
+
+/** Renders [{"entity_id","state","friendly_name",...}, ...] for the ids spliced in between, the
+ *  attributes ha_entity_state_read_attributes() uses sit next to the state */
+#define STATE_TEMPLATE_HEAD "{% set ns = namespace(out=[]) %}{% for e in "
+#define STATE_TEMPLATE_TAIL " %}{% set s = expand(e) | first %}{% if s %}"                     \
+                            "{% set ns.out = ns.out + [{'entity_id': s.entity_id, 'state': s.state, " \
+                            "'friendly_name': s.name, 'last_changed': s.last_changed.timestamp() | int, " \
+                            "'brightness': s.attributes.get('brightness'), 'temperature': s.attributes.get('temperature'), " \
+                            "'unit_of_measurement': s.attributes.get('unit_of_measurement')}] %}" \
+                            "{% endif %}{% endfor %}{{ ns.out | tojson }}"
+
+/** HTTP User-Agent string */
+#define USER_AGENT "ESP32-SystemMonitor/1.0"
+
+/** HTTP headers template */
+#define AUTH_HEADER_TEMPLATE "Bearer %s"
+#define CONTENT_TYPE_JSON "application/json"
+
+/** Request headers, tracked per client because esp_http_client copies every value it is given */
+#define REQUEST_HEADER_AUTH (1u << 0)
+#define REQUEST_HEADER_HOST (1u << 1)
+#define REQUEST_HEADER_JSON (1u << 2)
+#define REQUEST_HEADER_GZIP (1u << 3)
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+/**
+ * @brief One keep-alive connection of the pool
+ */
+typedef struct
+{
+  esp_http_client_handle_t client;
+  char base_url[128];        ///< Scheme + host + port the connection belongs to
+  bool in_use;               ///< Held by a request
+  uint8_t headers;           ///< REQUEST_HEADER_* the client carries from its last request
+  int64_t last_used_us;      ///< End of the last request
+  ha_api_pool_stats_t stats; ///< Counters, base_url/in_use filled in on query
+} pooled_client_t;
+
+/**
+ * @brief Who is waiting for a request
+ */
+typedef enum
+{
+  REQUEST_INTERACTIVE = 0, ///< Service call from a user action
+  REQUEST_BACKGROUND       ///< State sync and polls, no one is watching
+} request_priority_t;
+
+/** Pool slot only interactive requests may take, so a tap never queues behind a sync */
+#define INTERACTIVE_POOL_SLOT 0
+
+/** Set while no interactive request is in flight */
+#define INTERACTIVE_IDLE_BIT BIT0
+
+/**
+ * @brief Circuit breaker state
+ */
+typedef enum
+{
+  CIRCUIT_CLOSED = 0, ///< Requests go through
+  CIRCUIT_OPEN,       ///< Requests fail fast until open_until_us
+  CIRCUIT_HALF_OPEN   ///< One probe is out, everything else fails fast
+} circuit_state_t;
+
+/**
+ * @brief Circuit breaker of one API endpoint
+ */
+typedef struct
+{
+  circuit_state_t state;
+  uint8_t failures;        ///< Consecutive failed attempts while closed
+  uint8_t trips;           ///< Times opened since the last success, scales the open period
+  int64_t open_until_us;   ///< esp_timer time the next probe may go out
+} circuit_breaker_t;
+
+/**
+ * @brief Multi-entity fetch shared by the caller and its helper tasks
+ */
+typedef struct
+{
+  const char **entity_ids;
+  ha_entity_state_t *states;
+  int entity_count;
+  int next;                 ///< Next index to fetch
+  int success_count;
+  int consecutive_failures; ///< Across all workers, reset by any success
+  esp_err_t last_error;
+  bool abort;               ///< HA is unreachable, leave the rest
+  portMUX_TYPE lock;
+  SemaphoreHandle_t done;   ///< Given by each helper when it exits
+} entity_fetch_job_t;
+
+/**
+ * @brief Receives body chunks instead of the response buffer
+ * @note Called with data NULL when a retry starts, earlier chunks are void
+ */
+typedef esp_err_t (*http_data_sink_t)(void *sink_ctx, const char *data, size_t len);
+
+/**
+ * @brief Per-request state handed to the HTTP event handler
+ */
+typedef struct
+{
+  ha_api_response_t *response;
+  http_data_sink_t sink;
+  void *sink_ctx;
+  int64_t start_us;      ///< esp_http_client_perform() called
+  int64_t connected_us;  ///< New connection up, 0 on a reused one
+  int64_t first_byte_us; ///< First response header
+  size_t bytes_in;
+  http_inflate_t *inflate;         ///< Decoder between a compressed body and the sink, NULL if not compressed
+  esp_err_t inflate_err;           ///< First decode error, the rest of the body is dropped
+  ha_http_cache_exchange_t *cache; ///< Collects the caching headers, NULL if the request is not cached
+} http_request_ctx_t;
+
+/** Buffers per grade the pool has room for, the largest HA_RESPONSE_BUFFER_*_COUNT */
+#define RESPONSE_GRADE_MAX_BUFFERS 3
+
+_Static_assert(HA_RESPONSE_BUFFER_SMALL_COUNT <= RESPONSE_GRADE_MAX_BUFFERS &&
+                   HA_RESPONSE_BUFFER_MEDIUM_COUNT <= RESPONSE_GRADE_MAX_BUFFERS &&
+                   HA_RESPONSE_BUFFER_LARGE_COUNT <= RESPONSE_GRADE_MAX_BUFFERS,
+               "response grade count exceeds RESPONSE_GRADE_MAX_BUFFERS");
+
+/**
+ * @brief One grade of preallocated response buffers
+ */
+typedef struct
+{
+  size_t size;
+  uint32_t caps;  ///< heap_caps flags the buffers come from
+  uint8_t count;  ///< Buffers wanted
+  char *buffers[RESPONSE_GRADE_MAX_BUFFERS];
+  bool in_use[RESPONSE_GRADE_MAX_BUFFERS];
+  ha_api_buffer_stats_t stats;
+} response_grade_t;
+
+static bool ha_api_initialized = false;
+
+// Whole esp_http_client_perform(), 1 ms up to about 16 s
+static metric_histogram_t request_duration_metric =
+    METRIC_HISTOGRAM_INIT("ha_request_duration_ms", "HA HTTP request time, retries counted separately", 0);
+static char auth_header[256];
+static pooled_client_t client_pool[HA_HTTP_POOL_SIZE];
+static SemaphoreHandle_t pool_mutex = NULL;
+
+// Keep-alive connection per server for the failover probes, apart from the pool
+static esp_http_client_handle_t probe_clients[HA_SERVERS_MAX];
+
+// Interactive requests in flight, background ones hold off while it is non-zero
+static EventGroupHandle_t scheduler_events = NULL;
+static int interactive_in_flight = 0;
+static portMUX_TYPE scheduler_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Buffers live from ha_api_init() to ha_api_deinit(), responses borrow them
+static response_grade_t response_grades[HA_RESPONSE_BUFFER_GRADES] = {
+    {.size = HA_RESPONSE_BUFFER_SMALL_SIZE, .caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, .count = HA_RESPONSE_BUFFER_SMALL_COUNT},
+    {.size = HA_RESPONSE_BUFFER_MEDIUM_SIZE, .caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, .count = HA_RESPONSE_BUFFER_MEDIUM_COUNT},
+    {.size = HA_RESPONSE_BUFFER_LARGE_SIZE, .caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, .count = HA_RESPONSE_BUFFER_LARGE_COUNT},
+};
+static portMUX_TYPE response_grades_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Last resolved address of HA_SERVER_HOST_NAME
+ */
+typedef struct
+{
+  char ip[INET_ADDRSTRLEN]; ///< Dotted IPv4, "" while unresolved
+  int64_t expires_us;       ///< esp_timer time the address goes stale
+  bool refreshing;          ///< Background lookup running
+} host_cache_t;
+
+static host_cache_t host_cache = {0};
+static portMUX_TYPE host_cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static circuit_breaker_t circuit_breakers[HA_ENDPOINT_COUNT] = {0};
+static portMUX_TYPE circuit_lock = portMUX_INITIALIZER_UNLOCKED;
+static ha_api_recovery_callback_t recovery_callback = NULL;
+
+CYCLE_PROF_SITE(http_on_data);
+
+// =======================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =======================================================================
+
+static esp_err_t http_event_handler(esp_http_client_event_t *evt);
+static void init_response_buffers(void);
+static void free_response_buffers(void);
+static bool reserve_response_buffer(ha_api_response_t *response, size_t needed);
+static void release_response_buffer(char *buffer);
+static esp_http_client_handle_t create_http_client(const char *url, int server);
+static pooled_client_t *acquire_pooled_client(const char *url, int server, request_priority_t priority);
+static void release_pooled_client(pooled_client_t *entry, esp_err_t result);
+static void cleanup_client_pool(void);
+static bool resolve_ha_host(void);
+static void request_host_refresh(bool invalidate);
+static const char *apply_cached_host(const char *url, char *buffer, size_t size);
+static uint32_t backoff_delay_ms(uint32_t base_ms, uint32_t max_ms, int attempt);
+static bool circuit_allow(ha_endpoint_t endpoint, bool *probe);
+static bool circuit_record(ha_endpoint_t endpoint, bool success);
+static void begin_interactive_request(void);
+static void end_interactive_request(void);
+static bool defer_background_request(void);
+static void run_entity_fetch(entity_fetch_job_t *job);
+static void entity_fetch_task(void *arg);
+static esp_err_t perform_http_request(const char *url, const char *method, const char *post_data,
+                                      ha_api_response_t *response, request_priority_t priority);
+static esp_err_t perform_http_request_ex(const char *url, const char *method, const char *post_data,
+                                         ha_api_response_t *response, http_data_sink_t sink, void *sink_ctx,
+                                         request_priority_t priority, ha_http_cache_exchange_t *cache);
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Check network connectivity to Home Assistant server
+ * @return true if server is reachable, false otherwise
+ */
+static bool check_network_connectivity(void)
+{
+  // Check WiFi connection first
+  wifi_ap_record_t ap_info;
+  esp_err_t ret = esp_wifi_sta_get_ap_info(&ap_info);
+  if (ret != ESP_OK)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "WiFi not connected");
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Preallocate the response buffer grades
+ */
+static void init_response_buffers(void)
+{
+  for (int g = 0; g < HA_RESPONSE_BUFFER_GRADES; g++)
+  {
+    response_grade_t *grade = &response_grades[g];
+    for (int i = 0; i < grade->count; i++)
+    {
+      if (grade->buffers[i] == NULL)
+      {
+        grade->buffers[i] = heap_caps_malloc(grade->size, grade->caps);
+      }
+      if (grade->buffers[i] == NULL)
+      {
+        debug_log_warning_f(DEBUG_TAG_HA_API, "Could not preallocate %zu byte response buffer, grade has %d",
+                            grade->size, grade->stats.buffers);
+        break;
+      }
+      grade->stats.buffers++;
+    }
+    grade->stats.size = grade->size;
+  }
+}
+
+static void free_response_buffers(void)
+{
+  portENTER_CRITICAL(&response_grades_lock);
+  for (int g = 0; g < HA_RESPONSE_BUFFER_GRADES; g++)
+  {
+    response_grade_t *grade = &response_grades[g];
+    for (int i = 0; i < RESPONSE_GRADE_MAX_BUFFERS; i++)
+    {
+      // A buffer still out is freed by its response
+      if (grade->buffers[i] && !grade->in_use[i])
+      {
+        heap_caps_free(grade->buffers[i]);
+        grade->buffers[i] = NULL;
+      }
+    }
+    memset(&grade->stats, 0, sizeof(grade->stats));
+  }
+  portEXIT_CRITICAL(&response_grades_lock);
+}
+
+/**
+ * @brief Make response_data hold at least needed bytes, keeping its content
+ *
+ * Takes the smallest free pooled buffer that fits, or a larger grade when
+ * that one is exhausted. The heap is only used when every fitting buffer is
+ * out, and counted as a fallback of the grade that should have served it.
+ */
+static bool reserve_response_buffer(ha_api_response_t *response, size_t needed)
+{
+  if (needed > HA_MAX_RESPONSE_SIZE)
+  {
+    needed = HA_MAX_RESPONSE_SIZE;
+  }
+  if (response->response_data && response->buffer_size >= needed)
+  {
+    return true;
+  }
+
+  char *buffer = NULL;
+  size_t size = 0;
+  int wanted_grade = -1;
+
+  portENTER_CRITICAL(&response_grades_lock);
+  for (int g = 0; g < HA_RESPONSE_BUFFER_GRADES && !buffer; g++)
+  {
+    response_grade_t *grade = &response_grades[g];
+    if (grade->size < needed)
+      continue;
+    if (wanted_grade < 0)
+      wanted_grade = g;
+
+    for (int i = 0; i < RESPONSE_GRADE_MAX_BUFFERS; i++)
+    {
+      if (grade->buffers[i] && !grade->in_use[i])
+      {
+        grade->in_use[i] = true;
+        grade->stats.acquired++;
+        if (++grade->stats.in_use > grade->stats.high_water)
+          grade->stats.high_water = grade->stats.in_use;
+        buffer = grade->buffers[i];
+        size = grade->size;
+        break;
+      }
+    }
+  }
+  if (!buffer && wanted_grade >= 0)
+  {
+    response_grades[wanted_grade].stats.fallbacks++;
+  }
+  portEXIT_CRITICAL(&response_grades_lock);
+
+  if (!buffer && wanted_grade >= 0)
+  {
+    // Every fitting buffer is out, borrow from the heap for this response only
+    size = response_grades[wanted_grade].size;
+    buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buffer)
+      buffer = malloc(size);
+    if (!buffer)
+      return false;
+  }
+
+  if (response->response_data)
+  {
+    memcpy(buffer, response->response_data, response->response_len + 1);
+    release_response_buffer(response->response_data);
+  }
+  else
+  {
+    buffer[0] = '\0';
+  }
+  response->response_data = buffer;
+  response->buffer_size = size;
+  return true;
+}
+
+/**
+ * @brief Return a response buffer to its grade, or to the heap if it came from there
+ */
+static void release_response_buffer(char *buffer)
+{
+  bool pooled = false;
+
+  portENTER_CRITICAL(&response_grades_lock);
+  for (int g = 0; g < HA_RESPONSE_BUFFER_GRADES && !pooled; g++)
+  {
+    response_grade_t *grade = &response_grades[g];
+    for (int i = 0; i < RESPONSE_GRADE_MAX_BUFFERS; i++)
+    {
+      if (grade->buffers[i] == buffer && grade->in_use[i])
+      {
+        grade->in_use[i] = false;
+        grade->stats.in_use--;
+        pooled = true;
+        break;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&response_grades_lock);
+
+  if (!pooled)
+  {
+    heap_caps_free(buffer);
+  }
+}
+
+/**
+ * @brief Hands decoded body bytes on to the request's sink
+ */
+static esp_err_t inflated_sink(void *sink_ctx, const char *data, size_t len)
+{
+  http_request_ctx_t *ctx = (http_request_ctx_t *)sink_ctx;
+  if (ctx->response)
+  {
+    ctx->response->response_len += len;
+  }
+  // As with uncompressed bodies, the sink reports its own errors later
+  ctx->sink(ctx->sink_ctx, data, len);
+  return ESP_OK;
+}
+
+/**
+ * @brief HTTP event handler for response data collection
+ */
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+  http_request_ctx_t *ctx = (http_request_ctx_t *)evt->user_data;
+  ha_api_response_t *response = ctx ? ctx->response : NULL;
+  // Only ON_DATA is counted, the other events do next to nothing
+  CYCLE_PROF_BEGIN(http_on_data);
+
+  switch (evt->event_id)
+  {
+  case HTTP_EVENT_ERROR:
+    debug_log_error(DEBUG_TAG_HA_API, "HTTP_EVENT_ERROR occurred");
+    if (response)
+    {
+      snprintf(response->error_message, sizeof(response->error_message), "HTTP error occurred");
+      response->success = false;
+    }
+    break;
+
+  case HTTP_EVENT_ON_CONNECTED:
+    if (ctx)
+    {
+      ctx->connected_us = esp_timer_get_time();
+    }
+    break;
+
+  case HTTP_EVENT_HEADER_SENT:
+    break;
+
+  case HTTP_EVENT_ON_HEADER:
+    if (ctx && ctx->first_byte_us == 0)
+    {
+      ctx->first_byte_us = esp_timer_get_time();
+    }
+    if (ctx && ctx->cache)
+    {
+      ha_http_cache_on_header(ctx->cache, evt->header_key, evt->header_value);
+    }
+#if CONFIG_HA_HTTP_COMPRESSION
+    // Only streamed bodies are asked for compressed
+    if (ctx && ctx->sink && !ctx->inflate && evt->header_key && strcasecmp(evt->header_key, "Content-Encoding") == 0)
+    {
+      http_inflate_encoding_t encoding = http_inflate_encoding(evt->header_value);
+      if (encoding != HTTP_INFLATE_IDENTITY)
+      {
+        ctx->inflate = http_inflate_begin(encoding, inflated_sink, ctx);
+        if (!ctx->inflate)
+        {
+          ctx->inflate_err = ESP_ERR_NO_MEM;
+        }
+      }
+    }
+#endif
+    break;
+
+  case HTTP_EVENT_ON_DATA:
+    if (ctx)
+    {
+      ctx->bytes_in += evt->data_len > 0 ? evt->data_len : 0;
+    }
+    if (ctx && ctx->sink && evt->data_len > 0)
+    {
+      // Streamed, nothing is buffered; a compressed body is decoded on the way
+      if (ctx->inflate)
+      {
+        if (ctx->inflate_err == ESP_OK)
+        {
+          ctx->inflate_err = http_inflate_feed(ctx->inflate, evt->data, evt->data_len);
+        }
+      }
+      else if (ctx->inflate_err == ESP_OK)
+      {
+        ctx->sink(ctx->sink_ctx, (const char *)evt->data, evt->data_len);
+        if (response)
+        {
+          response->response_len += evt->data_len;
+        }
+      }
+    }
+    else if (response && evt->data_len > 0)
+    {
+      // Room for this chunk and the terminator; the first chunk sizes by
+      // Content-Length when sent, chunked replies move up a grade as they grow
+      size_t needed = response->response_len + evt->data_len + 1;
+      if (response->response_data == NULL)
+      {
+        int64_t content_length = esp_http_client_get_content_length((esp_http_client_handle_t)evt->client);
+        if (content_length > 0 && (size_t)content_length + 1 > needed)
+        {
+          needed = (size_t)content_length + 1;
+        }
+        response->response_len = 0;
+      }
+      if (!reserve_response_buffer(response, needed))
+      {
+        debug_log_error(DEBUG_TAG_HA_API, "Failed to allocate response buffer");
+        CYCLE_PROF_END(http_on_data);
+        return ESP_FAIL;
+      }
+
+      if ((response->response_len + evt->data_len) <= (response->buffer_size - 1))
+      {
+        memcpy(response->response_data + response->response_len, evt->data, evt->data_len);
+        response->response_len += evt->data_len;
+        response->response_data[response->response_len] = '\0';
+
+        // Log progress for large responses (every 10KB)
+        if (response->response_len > 0 && (response->response_len % 10240) == 0)
+        {
+          // Progress logging skipped for performance
+        }
+      }
+      else if (response->response_data)
+      {
+        // Log if we're hitting buffer size limits
+        debug_log_warning_f(DEBUG_TAG_HA_API, "Response buffer limit reached: %zu + %d >= %d bytes",
+                            response->response_len, evt->data_len, HA_MAX_RESPONSE_SIZE - 1);
+      }
+    }
+    CYCLE_PROF_END(http_on_data);
+    break;
+
+  case HTTP_EVENT_ON_FINISH:
+    if (response)
+    {
+      response->status_code = esp_http_client_get_status_code((esp_http_client_handle_t)evt->client);
+      response->success = (response->status_code >= 200 && response->status_code < 300);
+    }
+    break;
+
+  case HTTP_EVENT_DISCONNECTED:
+    break;
+
+  case HTTP_EVENT_REDIRECT:
+    break;
+
+  default:
+    break;
+  }
+
+  return ESP_OK;
+}
+
+/**
+ * @brief Create and configure HTTP client
+ * @param server ha_servers index the URL points at
+ */
+static esp_http_client_handle_t create_http_client(const char *url, int server)
+{
+  esp_http_client_config_t config = {
+      .url = url,
+      .event_handler = http_event_handler,
+      .timeout_ms = HA_HTTP_TIMEOUT_MS, // 8 seconds total timeout
+      .user_agent = USER_AGENT,
+      .buffer_size = HA_MAX_RESPONSE_SIZE,
+      .buffer_size_tx = 2048,              // Increased TX buffer for better throughput
+      .keep_alive_enable = true,           // Enable keep-alive for multiple requests
+      .keep_alive_idle = 15,               // Keep connection alive for 15 seconds
+      .keep_alive_interval = 5,            // Send keep-alive every 5 seconds
+      .keep_alive_count = 3,               // Send up to 3 keep-alive probes
+      .disable_auto_redirect = false,      // Enable redirects
+      .max_redirection_count = 3,          // Allow up to 3 redirects
+      .max_authorization_retries = 1,      // Limit auth retries
+#if CONFIG_HA_HTTPS
+#if CONFIG_HA_HTTPS_CA_BUNDLE
+      .crt_bundle_attach = esp_crt_bundle_attach,
+#else
+      .cert_pem = HA_SERVER_CA_CERT_PEM,
+#endif
+      .common_name = HA_SERVER_HOST_NAME, // Verified against the name, also when connected by cached address
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+      .save_client_session = true, // Reconnects of this pooled client resume the TLS session
+#endif
+#else
+      .use_global_ca_store = false,        // Plain HTTP, nothing to verify
+      .skip_cert_common_name_check = true, // Skip SSL cert name check
+#endif
+  };
+
+#if CONFIG_HA_SERVER_FAILOVER
+  if (server != HA_SERVERS_PRIMARY)
+  {
+    // Alternative URLs are never rewritten to an address; a remote one (Nabu Casa) has a public certificate
+    config.cert_pem = NULL;
+    config.common_name = NULL;
+    config.skip_cert_common_name_check = false;
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+#endif
+  }
+#endif
+
+  esp_http_client_handle_t client = esp_http_client_init(&config);
+  if (client)
+  {
+    // Client created successfully
+  }
+  else
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to create HTTP client");
+  }
+
+  return client;
+}
+
+/**
+ * @brief Bring a client's headers to the wanted set
+ *
+ * Only headers that changed since the client's last request are set or
+ * deleted, so a pooled connection sends a service call without copying
+ * a header value. The Authorization value is formatted once at init.
+ *
+ * @param current REQUEST_HEADER_* the client carries, updated
+ * @param wanted REQUEST_HEADER_* this request needs
+ */
+static void apply_request_headers(esp_http_client_handle_t client, uint8_t *current, uint8_t wanted)
+{
+  uint8_t added = wanted & ~*current;
+  uint8_t removed = *current & ~wanted;
+
+  if (added & REQUEST_HEADER_AUTH)
+    esp_http_client_set_header(client, "Authorization", auth_header);
+  if (added & REQUEST_HEADER_HOST)
+    esp_http_client_set_header(client, "Host", HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT));
+  else if (removed & REQUEST_HEADER_HOST)
+    esp_http_client_delete_header(client, "Host");
+  if (added & REQUEST_HEADER_JSON)
+    esp_http_client_set_header(client, "Content-Type", CONTENT_TYPE_JSON);
+  else if (removed & REQUEST_HEADER_JSON)
+    esp_http_client_delete_header(client, "Content-Type");
+  if (added & REQUEST_HEADER_GZIP)
+    esp_http_client_set_header(client, "Accept-Encoding", "gzip, deflate");
+  else if (removed & REQUEST_HEADER_GZIP)
+    esp_http_client_delete_header(client, "Accept-Encoding");
+
+  *current = wanted;
+}
+
+/**
+ * @brief Extract scheme + host + port from a URL
+ */
+static void get_base_url(const char *url, char *base_url, size_t size)
+{
+  base_url[0] = '\0';
+  const char *host = strstr(url, "://");
+  const char *path = host ? strchr(host + 3, '/') : NULL;
+  size_t base_len = path ? (size_t)(path - url) : strlen(url);
+  if (base_len < size)
+  {
+    memcpy(base_url, url, base_len);
+    base_url[base_len] = '\0';
+  }
+}
+
+/**
+ * @brief Take a pooled keep-alive client for a URL
+ *
+ * Prefers an idle connection to the same base URL, then an empty slot, then
+ * recycles an idle connection to another host. Background requests leave
+ * INTERACTIVE_POOL_SLOT alone, so a user command always finds a warm socket.
+ *
+ * @return Pool entry, or NULL if every connection is busy
+ */
+static pooled_client_t *acquire_pooled_client(const char *url, int server, request_priority_t priority)
+{
+  char base_url[sizeof(client_pool[0].base_url)];
+  get_base_url(url, base_url, sizeof(base_url));
+
+  if (!pool_mutex || xSemaphoreTake(pool_mutex, pdMS_TO_TICKS(HA_HTTP_TIMEOUT_MS)) != pdTRUE)
+    return NULL;
+
+  pooled_client_t *match = NULL;
+  pooled_client_t *empty = NULL;
+  pooled_client_t *other = NULL;
+  for (int i = 0; i < HA_HTTP_POOL_SIZE; i++)
+  {
+    pooled_client_t *entry = &client_pool[i];
+    if (entry->in_use)
+      continue;
+    if (priority == REQUEST_BACKGROUND && i == INTERACTIVE_POOL_SLOT && HA_HTTP_POOL_SIZE > 1)
+      continue;
+    if (entry->client == NULL)
+      empty = empty ? empty : entry;
+    else if (strcmp(entry->base_url, base_url) == 0)
+      match = match ? match : entry;
+    else
+      other = other ? other : entry;
+  }
+
+  pooled_client_t *entry = match ? match : (empty ? empty : other);
+  if (entry)
+  {
+    entry->in_use = true;
+  }
+  xSemaphoreGive(pool_mutex);
+
+  if (!entry)
+    return NULL;
+
+  if (entry == other)
+  {
+    // Different host, the socket is of no use
+    esp_http_client_cleanup(entry->client);
+    entry->client = NULL;
+  }
+
+  if (entry->client == NULL)
+  {
+    entry->client = create_http_client(url, server);
+    if (entry->client == NULL)
+    {
+      entry->in_use = false;
+      return NULL;
+    }
+    strncpy(entry->base_url, base_url, sizeof(entry->base_url) - 1);
+    entry->base_url[sizeof(entry->base_url) - 1] = '\0';
+    entry->headers = 0;
+    memset(&entry->stats, 0, sizeof(entry->stats));
+  }
+  else if (esp_timer_get_time() - entry->last_used_us > (int64_t)HA_HTTP_POOL_MAX_IDLE_MS * 1000)
+  {
+    // Health check: the server has likely dropped an idle socket by now,
+    // close it here rather than fail the first write on a dead connection
+    esp_http_client_close(entry->client);
+    entry->stats.reconnects++;
+  }
+
+  return entry;
+}
+
+/**
+ * @brief Return a client to the pool
+ * @param result Outcome of the request, connection level errors drop the socket
+ */
+static void release_pooled_client(pooled_client_t *entry, esp_err_t result)
+{
+  entry->stats.requests++;
+  if (result != ESP_OK)
+  {
+    entry->stats.failures++;
+    // Reconnect on next use instead of reusing a broken socket
+    esp_http_client_close(entry->client);
+  }
+  entry->last_used_us = esp_timer_get_time();
+
+  xSemaphoreTake(pool_mutex, portMAX_DELAY);
+  entry->in_use = false;
+  xSemaphoreGive(pool_mutex);
+}
+
+/**
+ * @brief Close and free every pooled client
+ */
+static void cleanup_client_pool(void)
+{
+  for (int i = 0; i < HA_HTTP_POOL_SIZE; i++)
+  {
+    if (client_pool[i].client != NULL)
+    {
+      esp_http_client_cleanup(client_pool[i].client);
+    }
+  }
+  memset(client_pool, 0, sizeof(client_pool));
+}
+
+/**
+ * @brief Look up HA_SERVER_HOST_NAME and store the result in the cache
+ * @return true if an address was found
+ */
+static bool resolve_ha_host(void)
+{
+  struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_STREAM};
+  struct addrinfo *result = NULL;
+  int64_t start_time = esp_timer_get_time();
+
+  int ret = getaddrinfo(HA_SERVER_HOST_NAME, NULL, &hints, &result);
+  if (ret != 0 || result == NULL)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Could not resolve %s (%d)", HA_SERVER_HOST_NAME, ret);
+    if (result)
+      freeaddrinfo(result);
+
+    // Not cold any more, later lookups run in the background
+    portENTER_CRITICAL(&host_cache_lock);
+    if (host_cache.expires_us == 0)
+      host_cache.expires_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&host_cache_lock);
+    return false;
+  }
+
+  char ip[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &((struct sockaddr_in *)result->ai_addr)->sin_addr, ip, sizeof(ip));
+  freeaddrinfo(result);
+
+  portENTER_CRITICAL(&host_cache_lock);
+  strlcpy(host_cache.ip, ip, sizeof(host_cache.ip));
+  host_cache.expires_us = esp_timer_get_time() + (int64_t)HA_DNS_CACHE_TTL_S * 1000000;
+  portEXIT_CRITICAL(&host_cache_lock);
+
+  debug_log_info_f(DEBUG_TAG_HA_API, "Resolved %s to %s in %lld ms", HA_SERVER_HOST_NAME, ip,
+                   (esp_timer_get_time() - start_time) / 1000);
+  return true;
+}
+
+static void host_refresh_task(void *arg)
+{
+  (void)arg;
+  resolve_ha_host();
+
+  portENTER_CRITICAL(&host_cache_lock);
+  host_cache.refreshing = false;
+  portEXIT_CRITICAL(&host_cache_lock);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Re-resolve the HA host without blocking the caller
+ * @param invalidate Drop the cached address now, requests use the host name meanwhile
+ */
+static void request_host_refresh(bool invalidate)
+{
+  bool start = false;
+
+  portENTER_CRITICAL(&host_cache_lock);
+  if (invalidate)
+  {
+    host_cache.ip[0] = '\0';
+  }
+  if (!host_cache.refreshing)
+  {
+    host_cache.refreshing = true;
+    start = true;
+  }
+  portEXIT_CRITICAL(&host_cache_lock);
+
+  if (start && task_plan_create(TASK_PLAN_HA_DNS, host_refresh_task, NULL, NULL) != pdPASS)
+  {
+    portENTER_CRITICAL(&host_cache_lock);
+    host_cache.refreshing = false;
+    portEXIT_CRITICAL(&host_cache_lock);
+  }
+}
+
+/**
+ * @brief Swap the HA host name in a URL for its cached address
+ *
+ * Only the first request waits for the lookup. A stale address keeps being
+ * used while a background lookup replaces it; esp_http_client sets the Host
+ * header from the URL, the caller puts the real name back.
+ *
+ * @return buffer holding the rewritten URL, or url if it cannot be rewritten
+ */
+static const char *apply_cached_host(const char *url, char *buffer, size_t size)
+{
+  static const char host_prefix[] = "://" HA_SERVER_HOST_NAME ":";
+  struct in_addr literal;
+
+  const char *host = strstr(url, host_prefix);
+  if (!host || inet_aton(HA_SERVER_HOST_NAME, &literal))
+  {
+    // Other host, or already an address
+    return url;
+  }
+
+  bool cold = false;
+  bool stale = false;
+  portENTER_CRITICAL(&host_cache_lock);
+  cold = (host_cache.ip[0] == '\0' && host_cache.expires_us == 0);
+  stale = (host_cache.ip[0] == '\0' || esp_timer_get_time() > host_cache.expires_us);
+  portEXIT_CRITICAL(&host_cache_lock);
+
+  if (cold)
+  {
+    resolve_ha_host();
+  }
+  else if (stale)
+  {
+    request_host_refresh(false);
+  }
+
+  char ip[INET_ADDRSTRLEN];
+  portENTER_CRITICAL(&host_cache_lock);
+  strlcpy(ip, host_cache.ip, sizeof(ip));
+  portEXIT_CRITICAL(&host_cache_lock);
+  if (ip[0] == '\0')
+  {
+    return url;
+  }
+
+  size_t scheme_len = (size_t)(host - url) + 3;
+  int len = snprintf(buffer, size, "%.*s%s%s", (int)scheme_len, url, ip, host + sizeof(host_prefix) - 2);
+  return (len > 0 && (size_t)len < size) ? buffer : url;
+}
+
+/**
+ * @brief Exponential backoff with equal jitter
+ *
+ * Half the delay is fixed and half random, so devices that lost HA at the
+ * same moment do not come back in lockstep.
+ *
+ * @param attempt 0 for the first wait
+ */
+static uint32_t backoff_delay_ms(uint32_t base_ms, uint32_t max_ms, int attempt)
+{
+  uint32_t delay = base_ms;
+  while (attempt-- > 0 && delay < max_ms)
+  {
+    delay *= 2;
+  }
+  if (delay > max_ms)
+  {
+    delay = max_ms;
+  }
+  return delay / 2 + esp_random() % (delay / 2 + 1);
+}
+
+/**
+ * @brief Whether a request may go out on this endpoint
+ * @param probe Set when the request is the single half-open probe
+ */
+static bool circuit_allow(ha_endpoint_t endpoint, bool *probe)
+{
+  circuit_breaker_t *circuit = &circuit_breakers[endpoint];
+  bool allowed = true;
+  *probe = false;
+
+  portENTER_CRITICAL(&circuit_lock);
+  if (circuit->state == CIRCUIT_OPEN && esp_timer_get_time() >= circuit->open_until_us)
+  {
+    circuit->state = CIRCUIT_HALF_OPEN;
+    *probe = true;
+  }
+  else if (circuit->state != CIRCUIT_CLOSED)
+  {
+    allowed = false;
+  }
+  portEXIT_CRITICAL(&circuit_lock);
+
+  return allowed;
+}
+
+/**
+ * @brief Feed the outcome of one attempt into the endpoint's breaker
+ * @return true if this attempt opened the circuit
+ */
+static bool circuit_record(ha_endpoint_t endpoint, bool success)
+{
+  circuit_breaker_t *circuit = &circuit_breakers[endpoint];
+  bool recovered = false;
+  bool opened = false;
+  uint32_t open_ms = 0;
+
+  portENTER_CRITICAL(&circuit_lock);
+  if (success)
+  {
+    recovered = (circuit->state != CIRCUIT_CLOSED);
+    circuit->state = CIRCUIT_CLOSED;
+    circuit->failures = 0;
+    circuit->trips = 0;
+  }
+  else if (circuit->state == CIRCUIT_OPEN)
+  {
+    // Late result of a request sent before the circuit opened
+  }
+  else if (circuit->state == CIRCUIT_HALF_OPEN || ++circuit->failures >= HA_CIRCUIT_FAILURE_THRESHOLD)
+  {
+    open_ms = backoff_delay_ms(HA_CIRCUIT_OPEN_MIN_MS, HA_CIRCUIT_OPEN_MAX_MS, circuit->trips);
+    if (circuit->trips < UINT8_MAX)
+      circuit->trips++;
+    circuit->state = CIRCUIT_OPEN;
+    circuit->failures = 0;
+    circuit->open_until_us = esp_timer_get_time() + (int64_t)open_ms * 1000;
+    opened = true;
+  }
+  portEXIT_CRITICAL(&circuit_lock);
+
+  if (recovered)
+  {
+    debug_log_info_f(DEBUG_TAG_HA_API, "HA %s endpoint answering again, circuit closed",
+                     ha_metrics_endpoint_name(endpoint));
+    ha_api_recovery_callback_t callback = recovery_callback;
+    if (callback)
+    {
+      callback();
+    }
+  }
+  else if (opened)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "HA %s endpoint failing, circuit open for %lu ms",
+                        ha_metrics_endpoint_name(endpoint), (unsigned long)open_ms);
+  }
+  return opened;
+}
+
+/**
+ * @brief Mark an interactive request as started, background polls hold off
+ */
+static void begin_interactive_request(void)
+{
+  // Out of modem sleep first, so the request does not wait for a DTIM beacon
+  wifi_power_policy_request_begin();
+
+  portENTER_CRITICAL(&scheduler_lock);
+  interactive_in_flight++;
+  portEXIT_CRITICAL(&scheduler_lock);
+
+  if (scheduler_events)
+  {
+    xEventGroupClearBits(scheduler_events, INTERACTIVE_IDLE_BIT);
+  }
+}
+
+static void end_interactive_request(void)
+{
+  bool idle = false;
+
+  portENTER_CRITICAL(&scheduler_lock);
+  if (interactive_in_flight > 0)
+    interactive_in_flight--;
+  idle = (interactive_in_flight == 0);
+  portEXIT_CRITICAL(&scheduler_lock);
+
+  if (idle && scheduler_events)
+  {
+    xEventGroupSetBits(scheduler_events, INTERACTIVE_IDLE_BIT);
+  }
+
+  wifi_power_policy_request_end();
+}
+
+/**
+ * @brief Hold a background request back while user commands are in flight
+ *
+ * Waits at most HA_BACKGROUND_DEFER_MAX_MS, so a burst of taps delays a
+ * sync but never starves it.
+ *
+ * @return true if the request had to wait
+ */
+static bool defer_background_request(void)
+{
+  if (!scheduler_events || (xEventGroupGetBits(scheduler_events) & INTERACTIVE_IDLE_BIT))
+  {
+    return false;
+  }
+
+  int64_t start_time = esp_timer_get_time();
+  EventBits_t bits = xEventGroupWaitBits(scheduler_events, INTERACTIVE_IDLE_BIT, pdFALSE, pdTRUE,
+                                         pdMS_TO_TICKS(HA_BACKGROUND_DEFER_MAX_MS));
+
+  if (!(bits & INTERACTIVE_IDLE_BIT))
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "User commands still running after %d ms, background request goes ahead",
+                        HA_BACKGROUND_DEFER_MAX_MS);
+  }
+  else
+  {
+    debug_log_debug_f(DEBUG_TAG_HA_API, "Background request deferred %lld ms for a user command",
+                      (esp_timer_get_time() - start_time) / 1000);
+  }
+  return true;
+}
+
+/**
+ * @brief Perform HTTP request with retry logic
+ */
+static esp_err_t perform_http_request(const char *url, const char *method, const char *post_data,
+                                      ha_api_response_t *response, request_priority_t priority)
+{
+  TRACE_SPAN_BEGIN("ha_http");
+  esp_err_t err = perform_http_request_ex(url, method, post_data, response, NULL, NULL, priority, NULL);
+  TRACE_SPAN_END("ha_http");
+  return err;
+}
+
+/**
+ * @brief Perform a request, optionally streaming the body into a sink
+ *
+ * Interactive requests run at once and keep background ones waiting until
+ * they are done; a background request checks before every attempt, so a
+ * sync between retries gives way to a tap as well.
+ *
+ * Each endpoint has a circuit breaker. Retries back off exponentially with
+ * jitter; once an endpoint keeps failing its circuit opens and requests
+ * fail fast with HA_API_ERR_CIRCUIT_OPEN, keeping the radio quiet, until a
+ * single probe gets through.
+ *
+ * With several HA servers (ha_servers.h) each attempt goes to the active
+ * one. When a failure marks it down and another server takes over, the
+ * attempt is repeated there at once and not counted against the circuit.
+ *
+ * With a cache exchange the request carries its validators and the
+ * exchange collects the caching headers of the reply.
+ */
+static esp_err_t perform_http_request_ex(const char *url, const char *method, const char *post_data,
+                                         ha_api_response_t *response, http_data_sink_t sink, void *sink_ctx,
+                                         request_priority_t priority, ha_http_cache_exchange_t *cache)
+{
+  if (post_data)
+  {
+    // Large POST data logging skipped for performance
+  }
+
+  // Parameter validation
+  if (!ha_api_initialized)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "HA API not initialized");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Check network connectivity before attempting HTTP request
+  if (!check_network_connectivity())
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Network connectivity check failed, skipping HTTP request");
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    if (response)
+    {
+      response->success = false;
+      response->status_code = 0;
+    }
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  const ha_endpoint_t endpoint = ha_metrics_endpoint_for_url(url);
+  bool probe = false;
+  if (!circuit_allow(endpoint, &probe))
+  {
+    debug_log_debug_f(DEBUG_TAG_HA_API, "HA %s circuit open, request not sent", ha_metrics_endpoint_name(endpoint));
+    if (response)
+    {
+      memset(response, 0, sizeof(ha_api_response_t));
+      snprintf(response->error_message, sizeof(response->error_message), "HA %s endpoint unreachable",
+               ha_metrics_endpoint_name(endpoint));
+    }
+    ha_request_sample_t sample = {.phase_us = {-1, -1, -1, -1}, .err = HA_API_ERR_CIRCUIT_OPEN};
+    ha_metrics_record_request(endpoint, &sample);
+    return HA_API_ERR_CIRCUIT_OPEN;
+  }
+
+  // Counted while in flight, the status debounce decides what the UI sees
+  ha_status_request_begin();
+
+  esp_err_t err = ESP_FAIL;
+  int status_code = 0;
+  bool circuit_opened = false;
+  int failovers = 0;
+
+  // A probe only finds out whether HA is back, it does not retry
+  const int attempts = probe ? 1 : HA_SYNC_RETRY_COUNT;
+
+  if (priority == REQUEST_INTERACTIVE)
+  {
+    begin_interactive_request();
+  }
+
+  for (int retry = 0; retry < attempts; retry++)
+  {
+    if (priority == REQUEST_BACKGROUND)
+    {
+      defer_background_request();
+    }
+
+    // Active HA server, then connect by cached address, skipping a DNS/mDNS lookup per connection
+    char server_buffer[256];
+    int server = HA_SERVERS_PRIMARY;
+    const char *server_url = ha_servers_apply(url, server_buffer, sizeof(server_buffer), &server);
+    char resolved_url[256];
+    int64_t dns_start_time = esp_timer_get_time();
+    const char *request_url = apply_cached_host(server_url, resolved_url, sizeof(resolved_url));
+    int64_t dns_duration_us = esp_timer_get_time() - dns_start_time;
+
+    // Pooled keep-alive connection, a one-shot client only when all are busy
+    pooled_client_t *pooled = acquire_pooled_client(request_url, server, priority);
+    esp_http_client_handle_t client = pooled ? pooled->client : create_http_client(request_url, server);
+    if (client == NULL)
+    {
+      debug_log_error(DEBUG_TAG_HA_API, "Failed to get HTTP client");
+      if (probe)
+      {
+        // Hand the probe back, otherwise the circuit stays half-open for good
+        circuit_opened = circuit_record(endpoint, false);
+      }
+      if (retry < attempts - 1)
+      {
+        vTaskDelay(pdMS_TO_TICKS(backoff_delay_ms(HA_RETRY_BACKOFF_BASE_MS, HA_RETRY_BACKOFF_MAX_MS, retry)));
+      }
+      continue;
+    }
+
+    // Set URL for this specific request (pooled clients keep the previous one)
+    esp_http_client_set_url(client, request_url);
+
+    // HA still sees its own name when connected by address
+    bool is_post = strcmp(method, "POST") == 0;
+    uint8_t wanted_headers = REQUEST_HEADER_AUTH | (request_url != server_url ? REQUEST_HEADER_HOST : 0) |
+                             (is_post ? REQUEST_HEADER_JSON : 0);
+#if CONFIG_HA_HTTP_COMPRESSION
+    // A streamed body is decoded chunk by chunk, a buffered one would need a second full copy
+    if (sink)
+    {
+      wanted_headers |= REQUEST_HEADER_GZIP;
+    }
+#endif
+    uint8_t one_shot_headers = 0;
+    apply_request_headers(client, pooled ? &pooled->headers : &one_shot_headers, wanted_headers);
+
+    // Conditional headers differ per URL, they are removed again after the request
+    if (cache && cache->sent.etag[0])
+    {
+      esp_http_client_set_header(client, "If-None-Match", cache->sent.etag);
+    }
+    if (cache && cache->sent.last_modified[0])
+    {
+      esp_http_client_set_header(client, "If-Modified-Since", cache->sent.last_modified);
+    }
+
+    // Set method, clearing what a previous request on this connection left behind
+    if (is_post)
+    {
+      esp_http_client_set_method(client, HTTP_METHOD_POST);
+      esp_http_client_set_post_field(client, post_data, post_data ? strlen(post_data) : 0);
+    }
+    else
+    {
+      esp_http_client_set_method(client, HTTP_METHOD_GET);
+      esp_http_client_set_post_field(client, NULL, 0);
+    }
+
+    // Set user data for event handler, dropping what a failed attempt received
+    if (response)
+    {
+      if (retry > 0 || failovers > 0)
+      {
+        ha_api_free_response(response);
+      }
+      memset(response, 0, sizeof(ha_api_response_t));
+    }
+    if (sink)
+    {
+      sink(sink_ctx, NULL, 0);
+    }
+    if (cache)
+    {
+      memset(&cache->received, 0, sizeof(cache->received));
+      cache->received.max_age_s = -1;
+    }
+    http_request_ctx_t ctx = {.response = response, .sink = sink, .sink_ctx = sink_ctx, .cache = cache};
+    esp_http_client_set_user_data(client, &ctx);
+
+    // Perform request with timeout tracking
+    int64_t request_start_time = esp_timer_get_time();
+    ctx.start_us = request_start_time;
+
+    // Perform the HTTP request
+    err = esp_http_client_perform(client);
+
+    // ctx lives on this stack frame, later close events must not see it
+    esp_http_client_set_user_data(client, NULL);
+    if (cache && cache->sent.etag[0])
+    {
+      esp_http_client_delete_header(client, "If-None-Match");
+    }
+    if (cache && cache->sent.last_modified[0])
+    {
+      esp_http_client_delete_header(client, "If-Modified-Since");
+    }
+
+    // A compressed body that was cut short or corrupt fails the attempt like a broken connection
+    esp_err_t inflate_err = ctx.inflate_err;
+    if (ctx.inflate)
+    {
+      if (inflate_err == ESP_OK)
+      {
+        inflate_err = http_inflate_finish(ctx.inflate, NULL);
+      }
+      http_inflate_free(ctx.inflate);
+    }
+    if (err == ESP_OK && inflate_err != ESP_OK)
+    {
+      debug_log_error_f(DEBUG_TAG_HA_API, "Compressed response not decoded: %s", esp_err_to_name(inflate_err));
+      err = inflate_err;
+    }
+
+    // Record completion time
+    int64_t request_end_time = esp_timer_get_time();
+    int64_t request_duration = (request_end_time - request_start_time) / 1000; // Convert to milliseconds
+    metrics_histogram_observe(&request_duration_metric, (uint32_t)request_duration);
+
+    // Log timeout-specific information
+    if (err == ESP_ERR_TIMEOUT)
+    {
+      debug_log_error_f(DEBUG_TAG_HA_API, "HTTP request timed out after %lld ms (timeout limit: %d ms)",
+                        request_duration, HA_HTTP_TIMEOUT_MS);
+    }
+    else if (request_duration > (HA_HTTP_TIMEOUT_MS / 2))
+    {
+      debug_log_warning_f(DEBUG_TAG_HA_API, "Slow HTTP request: %lld ms (more than half timeout)", request_duration);
+    }
+
+    // Get status code for logging
+    status_code = esp_http_client_get_status_code(client);
+
+    ha_request_sample_t sample = {
+        .phase_us = {
+            [HA_PHASE_DNS] = dns_duration_us,
+            [HA_PHASE_CONNECT] = ctx.connected_us ? ctx.connected_us - request_start_time : -1,
+            [HA_PHASE_TTFB] = ctx.first_byte_us ? ctx.first_byte_us - request_start_time : -1,
+            [HA_PHASE_TOTAL] = request_end_time - request_start_time,
+        },
+        .bytes_out = post_data ? strlen(post_data) : 0,
+        .bytes_in = ctx.bytes_in,
+        .err = err,
+        .status_code = status_code,
+        .retry = retry > 0,
+    };
+    ha_metrics_record_request(endpoint, &sample);
+
+    // Keep the connection alive for reuse unless it failed
+    if (pooled)
+    {
+      if (err == ESP_ERR_HTTP_CONNECT)
+      {
+        pooled->stats.reconnects++;
+      }
+      release_pooled_client(pooled, err);
+    }
+    else
+    {
+      esp_http_client_cleanup(client);
+    }
+
+    if (err == ESP_ERR_HTTP_CONNECT && request_url != server_url)
+    {
+      // The address may have moved (DHCP), retry by name and look it up again
+      request_host_refresh(true);
+    }
+
+    // An HA that answers with an error page is as good as down
+    bool reachable = err == ESP_OK && status_code < 500;
+    if (ha_servers_report(server, reachable) && failovers < HA_SERVERS_MAX)
+    {
+      // Another server took over, it gets this attempt
+      failovers++;
+      retry--;
+      continue;
+    }
+    circuit_opened = circuit_record(endpoint, reachable);
+
+    if (err == ESP_OK)
+    {
+      break;
+    }
+    else
+    {
+      debug_log_warning_f(DEBUG_TAG_HA_API, "HTTP request failed (attempt %d/%d): %s (status: %d)",
+                          retry + 1, HA_SYNC_RETRY_COUNT, esp_err_to_name(err), status_code);
+      if (response)
+      {
+        snprintf(response->error_message, sizeof(response->error_message),
+                 "HTTP request failed: %s (status: %d)", esp_err_to_name(err), status_code);
+      }
+    }
+
+    if (circuit_opened)
+    {
+      break;
+    }
+
+    // Wait before retry
+    if (retry < attempts - 1)
+    {
+      vTaskDelay(pdMS_TO_TICKS(backoff_delay_ms(HA_RETRY_BACKOFF_BASE_MS, HA_RETRY_BACKOFF_MAX_MS, retry)));
+    }
+  }
+
+  if (priority == REQUEST_INTERACTIVE)
+  {
+    end_interactive_request();
+  }
+
+  if (err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "HTTP request failed (Final status: %d, Error: %s)", status_code, esp_err_to_name(err));
+    ha_status_change(circuit_opened ? HA_STATUS_UNREACHABLE : HA_STATUS_SYNC_FAILED);
+  }
+  ha_status_request_end();
+
+  return err;
+}
+
+/**
+ * @brief Fill a response with the body an exchange found in the cache
+ */
+static bool serve_cached(const ha_http_cache_exchange_t *cache, ha_api_response_t *response, int status_code)
+{
+  ha_api_free_response(response);
+  memset(response, 0, sizeof(ha_api_response_t));
+  if (!reserve_response_buffer(response, cache->body_len + 1))
+  {
+    return false;
+  }
+
+  int len = ha_http_cache_copy(cache, response->response_data, response->buffer_size);
+  if (len < 0)
+  {
+    ha_api_free_response(response);
+    return false;
+  }
+  response->response_len = (size_t)len;
+  response->status_code = status_code;
+  response->success = true;
+  response->unchanged = true;
+  return true;
+}
+
+/**
+ * @brief Perform a background request through the metadata cache
+ *
+ * A fresh entry is served without a request, a stale one is revalidated.
+ * When the entry went away between the lookup and a 304, the request is
+ * repeated once without validators.
+ */
+static esp_err_t perform_cached_request(const char *url, const char *method, const char *post_data,
+                                        ha_api_response_t *response)
+{
+  ha_http_cache_exchange_t cache;
+  ha_http_cache_result_t cached = ha_http_cache_lookup(&cache, url, post_data);
+  if (cached == HA_HTTP_CACHE_FRESH && serve_cached(&cache, response, 200))
+  {
+    debug_log_debug_f(DEBUG_TAG_HA_API, "Served %zu bytes from the HTTP cache", response->response_len);
+    return ESP_OK;
+  }
+
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    TRACE_SPAN_BEGIN("ha_http");
+    esp_err_t err = perform_http_request_ex(url, method, post_data, response, NULL, NULL, REQUEST_BACKGROUND, &cache);
+    TRACE_SPAN_END("ha_http");
+    if (err != ESP_OK)
+    {
+      return err;
+    }
+
+    if (response->status_code == 304)
+    {
+      if (serve_cached(&cache, response, 304))
+      {
+        ha_http_cache_revalidated(&cache);
+        return ESP_OK;
+      }
+      memset(&cache.sent, 0, sizeof(cache.sent));
+      continue;
+    }
+
+    if (response->success && response->response_data)
+    {
+      response->unchanged = ha_http_cache_store(&cache, response->response_data, response->response_len);
+    }
+    return ESP_OK;
+  }
+
+  snprintf(response->error_message, sizeof(response->error_message), "304 without a cached body");
+  return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief Fetch entities of a job until none are left or it is aborted
+ */
+static void run_entity_fetch(entity_fetch_job_t *job)
+{
+  for (;;)
+  {
+    portENTER_CRITICAL(&job->lock);
+    int index = job->abort ? job->entity_count : job->next++;
+    portEXIT_CRITICAL(&job->lock);
+    if (index >= job->entity_count)
+    {
+      break;
+    }
+
+    esp_err_t result = ha_api_get_entity_state(job->entity_ids[index], &job->states[index]);
+    if (result != ESP_OK)
+    {
+      debug_log_warning_f(DEBUG_TAG_HA_API, "Failed to fetch entity %s: %s", job->entity_ids[index], esp_err_to_name(result));
+    }
+
+    bool give_up = false;
+    bool aborted = false;
+    int failures = 0;
+    portENTER_CRITICAL(&job->lock);
+    if (result == ESP_OK)
+    {
+      job->success_count++;
+      job->consecutive_failures = 0;
+    }
+    else
+    {
+      failures = ++job->consecutive_failures;
+      job->last_error = result;
+
+      // The rest would fail fast too, or hit the same dead network
+      bool unreachable = (result == HA_API_ERR_CIRCUIT_OPEN) ||
+                         (failures >= 2 && (result == ESP_ERR_HTTP_CONNECT || result == ESP_ERR_HTTP_EAGAIN ||
+                                            result == ESP_ERR_TIMEOUT));
+      give_up = unreachable && !job->abort;
+      job->abort = job->abort || unreachable;
+    }
+    aborted = job->abort;
+    portEXIT_CRITICAL(&job->lock);
+
+    if (give_up)
+    {
+      debug_log_error_f(DEBUG_TAG_HA_API, "Aborting entity fetch after %s", esp_err_to_name(result));
+    }
+    else if (failures > 0 && !aborted)
+    {
+      // Back-to-back on a healthy keep-alive connection, back off only after failures
+      vTaskDelay(pdMS_TO_TICKS(backoff_delay_ms(HA_RETRY_BACKOFF_BASE_MS, HA_RETRY_BACKOFF_MAX_MS, failures - 1)));
+    }
+  }
+}
+
+static void entity_fetch_task(void *arg)
+{
+  entity_fetch_job_t *job = (entity_fetch_job_t *)arg;
+  run_entity_fetch(job);
+  xSemaphoreGive(job->done);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Sink feeding /api/states chunks into the streaming parser
+ */
+static esp_err_t states_stream_sink(void *sink_ctx, const char *data, size_t len)
+{
+  entity_stream_parser_t *parser = (entity_stream_parser_t *)sink_ctx;
+
+  if (!data)
+  {
+    // Retry, start over with a clean parser
+    return entity_states_stream_begin(parser, parser->entity_ids, parser->entity_count, parser->states);
+  }
+  return entity_states_stream_feed(parser, data, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_api_init(void)
+{
+  if (ha_api_initialized)
+  {
+    debug_log_warning(DEBUG_TAG_HA_API, "Home Assistant API already initialized");
+    return ESP_OK;
+  }
+
+  // Check if constants are properly defined
+  if (HA_API_TOKEN == NULL || strlen(HA_API_TOKEN) == 0)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "HA API Token is not defined or empty");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (HA_SERVER_HOST_NAME == NULL || strlen(HA_SERVER_HOST_NAME) == 0)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "HA Server Host Name is not defined or empty");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  ha_metrics_init();
+  metrics_register_histogram(&request_duration_metric);
+
+  // Format authorization header with error checking
+  int ret = snprintf(auth_header, sizeof(auth_header), AUTH_HEADER_TEMPLATE, HA_API_TOKEN);
+  if (ret < 0 || ret >= sizeof(auth_header))
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Failed to format authorization header: %d", ret);
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (pool_mutex == NULL)
+  {
+    pool_mutex = xSemaphoreCreateMutex();
+    if (pool_mutex == NULL)
+    {
+      debug_log_error(DEBUG_TAG_HA_API, "Failed to create connection pool mutex");
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  if (scheduler_events == NULL)
+  {
+    scheduler_events = xEventGroupCreate();
+    if (scheduler_events == NULL)
+    {
+      debug_log_error(DEBUG_TAG_HA_API, "Failed to create request scheduler event group");
+      return ESP_ERR_NO_MEM;
+    }
+    xEventGroupSetBits(scheduler_events, INTERACTIVE_IDLE_BIT);
+  }
+
+  // Preallocated once, so responses never carve the heap
+  init_response_buffers();
+
+  // Initialize async entity states parser
+  esp_err_t parser_err = entity_states_parser_init();
+  if (parser_err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Failed to initialize entity states parser: %s", esp_err_to_name(parser_err));
+    return parser_err;
+  }
+
+  ha_api_initialized = true;
+
+  // Notify status callback about initialization
+  ha_status_change(HA_STATUS_READY);
+
+  return ESP_OK;
+}
+
+esp_err_t ha_api_deinit(void)
+{
+  if (!ha_api_initialized)
+  {
+    return ESP_OK;
+  }
+
+  // Deinitialize async entity states parser
+  entity_states_parser_deinit();
+
+  // Close pooled keep-alive connections
+  cleanup_client_pool();
+  for (int i = 0; i < HA_SERVERS_MAX; i++)
+  {
+    if (probe_clients[i])
+    {
+      esp_http_client_cleanup(probe_clients[i]);
+      probe_clients[i] = NULL;
+    }
+  }
+  free_response_buffers();
+
+  ha_api_initialized = false;
+  memset(auth_header, 0, sizeof(auth_header));
+
+  // Notify status callback about deinitialization
+  ha_status_change(HA_STATUS_OFFLINE);
+
+  return ESP_OK;
+}
+
+esp_err_t ha_api_get_entity_state(const char *entity_id, ha_entity_state_t *state)
+{
+  if (!entity_id || !state)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  char url[256];
+  snprintf(url, sizeof(url), "%s/%s", HA_API_STATES_URL, entity_id);
+
+  ha_api_response_t response;
+  esp_err_t err = perform_http_request(url, "GET", NULL, &response, REQUEST_BACKGROUND);
+
+  if (err == ESP_OK && response.success)
+  {
+    int64_t parse_start_time = esp_timer_get_time();
+    err = ha_api_parse_entity_state(response.response_data, state);
+    ha_metrics_record_parse(HA_ENDPOINT_STATES, esp_timer_get_time() - parse_start_time);
+  }
+
+  ha_api_free_response(&response);
+  return err;
+}
+
+esp_err_t ha_api_get_multiple_entity_states(const char **entity_ids, int entity_count, ha_entity_state_t *states)
+{
+  if (!entity_ids || !states || entity_count <= 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Notify that we're starting a sync operation
+  ha_status_change(HA_STATUS_SYNCING);
+
+  // Clear all states first
+  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
+
+  entity_fetch_job_t job = {
+      .entity_ids = entity_ids,
+      .states = states,
+      .entity_count = entity_count,
+      .last_error = ESP_OK,
+      .lock = portMUX_INITIALIZER_UNLOCKED,
+  };
+
+  // The caller is one worker, helpers take the other connections
+  int helpers = HA_PARALLEL_FETCH_CONCURRENCY - 1;
+  if (helpers > entity_count - 1)
+  {
+    helpers = entity_count - 1;
+  }
+  if (helpers > 0)
+  {
+    job.done = xSemaphoreCreateCounting(helpers, 0);
+    if (job.done == NULL)
+    {
+      helpers = 0;
+    }
+  }
+
+  int started = 0;
+  for (int i = 0; i < helpers; i++)
+  {
+    if (task_plan_create(TASK_PLAN_HA_FETCH, entity_fetch_task, &job, NULL) != pdPASS)
+    {
+      debug_log_warning_f(DEBUG_TAG_HA_API, "Fetching with %d of %d connections", started + 1, helpers + 1);
+      break;
+    }
+    started++;
+  }
+
+  run_entity_fetch(&job);
+
+  // job lives on this stack, wait until no helper can touch it
+  for (int i = 0; i < started; i++)
+  {
+    xSemaphoreTake(job.done, portMAX_DELAY);
+  }
+  if (job.done)
+  {
+    vSemaphoreDelete(job.done);
+  }
+
+  const int success_count = job.success_count;
+  const esp_err_t overall_result = job.last_error;
+
+  if (success_count == entity_count)
+  {
+
+    // Notify successful sync completion
+    ha_status_change(HA_STATUS_STATES_SYNCED);
+
+    return ESP_OK;
+  }
+  else if (success_count > 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Fetched %d/%d entity states", success_count, entity_count);
+
+    // Notify partial sync
+    ha_status_change(HA_STATUS_PARTIAL_SYNC);
+
+    return ESP_ERR_NOT_FOUND;
+  }
+  else
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to fetch any entity states");
+
+    // Notify sync failure
+    ha_status_change(overall_result == HA_API_ERR_CIRCUIT_OPEN ? HA_STATUS_UNREACHABLE : HA_STATUS_SYNC_FAILED);
+
+    return overall_result;
+  }
+}
+
+esp_err_t ha_api_get_multiple_entity_states_bulk(const char **entity_ids, int entity_count, ha_entity_state_t *states)
+{
+  if (!entity_ids || !states || entity_count <= 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Notify that we're starting a sync operation
+  ha_status_change(HA_STATUS_SYNCING);
+
+  entity_stream_parser_t *parser = malloc(sizeof(entity_stream_parser_t));
+  if (!parser)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to allocate states parser");
+    return ESP_ERR_NO_MEM;
+  }
+  entity_states_stream_begin(parser, entity_ids, entity_count, states);
+
+  // Measure timing
+  int64_t start_time = esp_timer_get_time();
+
+  // The body goes straight into the parser, whatever its size
+  ha_api_response_t response = {0};
+  TRACE_SPAN_BEGIN("ha_http_states");
+  esp_err_t err = perform_http_request_ex(HA_API_STATES_URL, "GET", NULL, &response, states_stream_sink, parser,
+                                          REQUEST_BACKGROUND, NULL);
+  TRACE_SPAN_END("ha_http_states");
+
+  int64_t total_time = esp_timer_get_time() - start_time;
+
+  if (err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Bulk request failed: %s", esp_err_to_name(err));
+
+    // Provide more specific error information
+    if (err == ESP_ERR_TIMEOUT)
+    {
+      debug_log_error(DEBUG_TAG_HA_API, "Request timed out - Home Assistant may be slow or response too large");
+    }
+    else if (err == ESP_ERR_NOT_FOUND)
+    {
+      debug_log_error(DEBUG_TAG_HA_API, "Network connectivity issue - check Home Assistant server");
+    }
+
+    free(parser);
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return err;
+  }
+
+  if (!response.success)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Bulk request rejected (status: %d)", response.status_code);
+    free(parser);
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  esp_err_t parse_err = entity_states_stream_finish(parser);
+  int success_count = parser->found_count;
+  free(parser);
+
+  debug_log_debug_f(DEBUG_TAG_HA_API, "Performance: %zu bytes streamed and parsed in %lld ms",
+                    response.response_len, (total_time / 1000));
+
+  // Handle parsing failure
+  if (parse_err == ESP_ERR_INVALID_RESPONSE)
+  {
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return parse_err;
+  }
+
+  // Determine result based on success count
+  if (success_count == entity_count)
+  {
+
+    ha_status_change(HA_STATUS_STATES_SYNCED);
+    return ESP_OK;
+  }
+  else if (success_count > 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Fetched %d/%d entity states via bulk request", success_count, entity_count);
+    ha_status_change(HA_STATUS_PARTIAL_SYNC);
+    return ESP_ERR_NOT_FOUND;
+  }
+  else
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to fetch any entity states via bulk request");
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return ESP_ERR_NOT_FOUND;
+  }
+}
+
+/**
+ * @brief POST /api/template, through the metadata cache if asked to
+ */
+static esp_err_t render_template(const char *template_string, ha_api_response_t *response, bool cached)
+{
+  if (!template_string || !response)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  cJSON *body = cJSON_CreateObject();
+  cJSON_AddStringToObject(body, "template", template_string);
+  char *body_string = cJSON_PrintUnformatted(body);
+  cJSON_Delete(body);
+  if (!body_string)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  int64_t start_time = esp_timer_get_time();
+  memset(response, 0, sizeof(*response));
+  esp_err_t err = cached ? perform_cached_request(HA_API_TEMPLATE_URL, "POST", body_string, response)
+                         : perform_http_request(HA_API_TEMPLATE_URL, "POST", body_string, response, REQUEST_BACKGROUND);
+  free(body_string);
+
+  if (err != ESP_OK)
+  {
+    ha_api_free_response(response);
+    return err;
+  }
+
+  if (!response->success)
+  {
+    // Old HA versions or restricted tokens, the caller picks another method
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Template request refused (status: %d)", response->status_code);
+    ha_api_free_response(response);
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  debug_log_debug_f(DEBUG_TAG_HA_API, "Template request completed in %lld ms, %zu bytes%s",
+                    (esp_timer_get_time() - start_time) / 1000, response->response_len,
+                    response->unchanged ? ", unchanged" : "");
+  return ESP_OK;
+}
+
+esp_err_t ha_api_render_template(const char *template_string, ha_api_response_t *response)
+{
+  return render_template(template_string, response, false);
+}
+
+esp_err_t ha_api_render_template_cached(const char *template_string, ha_api_response_t *response)
+{
+  return render_template(template_string, response, true);
+}
+
+esp_err_t ha_api_get_metadata(const char *path, ha_api_response_t *response)
+{
+  if (!path || path[0] != '/' || !response)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  char url[HA_HTTP_CACHE_URL_LEN];
+  if (snprintf(url, sizeof(url), "%s%s", HA_API_BASE_URL, path) >= (int)sizeof(url))
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  memset(response, 0, sizeof(*response));
+  esp_err_t err = perform_cached_request(url, "GET", NULL, response);
+  if (err == ESP_OK && !response->success)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Metadata request %s failed (status: %d)", path, response->status_code);
+    ha_api_free_response(response);
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+  if (err != ESP_OK)
+  {
+    ha_api_free_response(response);
+  }
+  return err;
+}
+
+esp_err_t ha_api_get_streamed(const char *path, ha_api_sink_t sink, void *ctx, int *status_code)
+{
+  if (!path || path[0] != '/' || !sink)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  char url[256];
+  if (snprintf(url, sizeof(url), "%s%s", HA_API_BASE_URL, path) >= (int)sizeof(url))
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Only the status and the byte count land in the response
+  ha_api_response_t response = {0};
+  TRACE_SPAN_BEGIN("ha_http");
+  esp_err_t err = perform_http_request_ex(url, "GET", NULL, &response, sink, ctx, REQUEST_BACKGROUND, NULL);
+  TRACE_SPAN_END("ha_http");
+  if (status_code)
+  {
+    *status_code = response.status_code;
+  }
+  if (err == ESP_OK && !response.success)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Streamed request %s failed (status: %d)", path, response.status_code);
+    err = ESP_ERR_INVALID_RESPONSE;
+  }
+  return err;
+}
+
+esp_err_t ha_api_get_multiple_entity_states_template(const char **entity_ids, int entity_count, ha_entity_state_t *states)
+{
+  if (!entity_ids || !states || entity_count <= 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  ha_status_change(HA_STATUS_SYNCING);
+  memset(states, 0, sizeof(ha_entity_state_t) * entity_count);
+
+  // Entity list as a JSON array doubles as a Jinja list literal
+  cJSON *ids = cJSON_CreateStringArray(entity_ids, entity_count);
+  char *ids_string = ids ? cJSON_PrintUnformatted(ids) : NULL;
+  cJSON_Delete(ids);
+  if (!ids_string)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  size_t template_len = strlen(STATE_TEMPLATE_HEAD) + strlen(ids_string) + strlen(STATE_TEMPLATE_TAIL) + 1;
+  char *template_string = malloc(template_len);
+  if (!template_string)
+  {
+    free(ids_string);
+    return ESP_ERR_NO_MEM;
+  }
+  snprintf(template_string, template_len, "%s%s%s", STATE_TEMPLATE_HEAD, ids_string, STATE_TEMPLATE_TAIL);
+  free(ids_string);
+
+  ha_api_response_t response = {0};
+  esp_err_t err = ha_api_render_template(template_string, &response);
+  free(template_string);
+
+  if (err != ESP_OK)
+  {
+    if (err != ESP_ERR_NOT_SUPPORTED)
+    {
+      ha_status_change(HA_STATUS_SYNC_FAILED);
+    }
+    return err;
+  }
+
+  int64_t parse_start_time = esp_timer_get_time();
+  json_arena_t *arena = json_arena_begin(response.response_len);
+  cJSON *json = response.response_data ? cJSON_Parse(response.response_data) : NULL;
+  ha_api_free_response(&response);
+  if (!cJSON_IsArray(json))
+  {
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    ha_metrics_record_parse(HA_ENDPOINT_TEMPLATE, esp_timer_get_time() - parse_start_time);
+    debug_log_error(DEBUG_TAG_HA_API, "Template response is not a JSON array");
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  int success_count = 0;
+  cJSON *item = NULL;
+  cJSON_ArrayForEach(item, json)
+  {
+    cJSON *entity_id = cJSON_GetObjectItem(item, "entity_id");
+    cJSON *state = cJSON_GetObjectItem(item, "state");
+    cJSON *friendly_name = cJSON_GetObjectItem(item, "friendly_name");
+    cJSON *last_changed = cJSON_GetObjectItem(item, "last_changed");
+    if (!cJSON_IsString(entity_id) || !cJSON_IsString(state))
+      continue;
+
+    for (int i = 0; i < entity_count; i++)
+    {
+      if (!states[i].found && strcmp(entity_ids[i], entity_id->valuestring) == 0)
+      {
+        ha_entity_state_set(&states[i], state->valuestring, cJSON_GetStringValue(friendly_name),
+                            cJSON_IsNumber(last_changed) ? (uint32_t)last_changed->valuedouble : 0);
+        ha_entity_state_read_attributes(&states[i], item);
+        success_count++;
+        break;
+      }
+    }
+  }
+  cJSON_Delete(json);
+  json_arena_end(arena);
+  ha_metrics_record_parse(HA_ENDPOINT_TEMPLATE, esp_timer_get_time() - parse_start_time);
+
+  if (success_count == entity_count)
+  {
+    ha_status_change(HA_STATUS_STATES_SYNCED);
+    return ESP_OK;
+  }
+  else if (success_count > 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Fetched %d/%d entity states via template", success_count, entity_count);
+    ha_status_change(HA_STATUS_PARTIAL_SYNC);
+    return ESP_ERR_NOT_FOUND;
+  }
+  else
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "None of the requested entities exist in Home Assistant");
+    ha_status_change(HA_STATUS_SYNC_FAILED);
+    return ESP_ERR_NOT_FOUND;
+  }
+}
+
+/**
+ * @brief Append a JSON string literal, quotes included, escaping as needed
+ * @return New length, or -1 if it does not fit
+ */
+static int encode_json_string(char *buf, size_t size, int len, const char *value)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  if (len < 0 || (size_t)len >= size)
+    return -1;
+  buf[len++] = '"';
+  for (const unsigned char *p = (const unsigned char *)value; *p; p++)
+  {
+    // Worst case is \u00XX plus the closing quote and terminator
+    if ((size_t)len + 8 > size)
+      return -1;
+    if (*p == '"' || *p == '\\')
+    {
+      buf[len++] = '\\';
+      buf[len++] = (char)*p;
+    }
+    else if (*p < 0x20)
+    {
+      memcpy(buf + len, "\\u00", 4);
+      buf[len + 4] = hex[*p >> 4];
+      buf[len + 5] = hex[*p & 0x0f];
+      len += 6;
+    }
+    else
+    {
+      buf[len++] = (char)*p;
+    }
+  }
+  if ((size_t)len + 2 > size)
+    return -1;
+  buf[len++] = '"';
+  buf[len] = '\0';
+  return len;
+}
+
+int ha_api_encode_service_body(const ha_service_call_t *service_call, char *buf, size_t size)
+{
+  if (!service_call || !buf || service_call->param_count > HA_SERVICE_MAX_PARAMS)
+    return -1;
+
+  int len = snprintf(buf, size, "{\"entity_id\":");
+  len = encode_json_string(buf, size, len, service_call->entity_id);
+
+  for (uint8_t i = 0; i < service_call->param_count && len >= 0; i++)
+  {
+    const ha_service_param_t *param = &service_call->params[i];
+    int added;
+    switch (param->type)
+    {
+    case HA_SERVICE_PARAM_INT:
+      added = snprintf(buf + len, size - len, ",\"%s\":%ld", param->key, (long)param->value.i);
+      break;
+    case HA_SERVICE_PARAM_NUMBER:
+      added = snprintf(buf + len, size - len, ",\"%s\":%g", param->key, (double)param->value.number);
+      break;
+    case HA_SERVICE_PARAM_BOOL:
+      added = snprintf(buf + len, size - len, ",\"%s\":%s", param->key, param->value.boolean ? "true" : "false");
+      break;
+    case HA_SERVICE_PARAM_STRING:
+      added = snprintf(buf + len, size - len, ",\"%s\":", param->key);
+      if (added > 0 && (size_t)(len + added) < size)
+      {
+        int end = encode_json_string(buf, size, len + added, param->value.string ? param->value.string : "");
+        added = end < 0 ? -1 : end - len;
+      }
+      break;
+    default:
+      added = -1;
+      break;
+    }
+    len = (added < 0 || (size_t)(len + added) >= size) ? -1 : len + added;
+  }
+
+  if (len < 0 || (size_t)len + 2 > size)
+    return -1;
+  buf[len++] = '}';
+  buf[len] = '\0';
+  return len;
+}
+
+esp_err_t ha_api_call_service(const ha_service_call_t *service_call, ha_api_response_t *response)
+{
+  if (!service_call)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // URL and body live on the stack, a service call builds no cJSON tree
+  char url[256];
+  int url_len = snprintf(url, sizeof(url), "%s/%s/%s", HA_API_SERVICES_URL, service_call->domain,
+                         service_call->service);
+  char body[HA_SERVICE_BODY_SIZE];
+  if (url_len < 0 || (size_t)url_len >= sizeof(url) ||
+      ha_api_encode_service_body(service_call, body, sizeof(body)) < 0)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Service %s.%s for %s does not fit the request buffers",
+                      service_call->domain, service_call->service, service_call->entity_id);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  ha_api_response_t local_response;
+  ha_api_response_t *resp = response ? response : &local_response;
+
+  // A user is waiting for this one
+  esp_err_t err = perform_http_request(url, "POST", body, resp, REQUEST_INTERACTIVE);
+
+  if (err == ESP_OK && resp->success)
+  {
+  }
+  else
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Service %s.%s failed for %s: %s",
+                      service_call->domain, service_call->service, service_call->entity_id,
+                      resp->error_message[0] ? resp->error_message : "Unknown error");
+  }
+
+  if (!response)
+  {
+    ha_api_free_response(&local_response);
+  }
+
+  return err;
+}
+
+esp_err_t ha_api_fire_event(const char *event_type, const char *event_data)
+{
+  if (!event_type || !event_type[0])
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  char url[256];
+  snprintf(url, sizeof(url), "%s/events/%s", HA_API_BASE_URL, event_type);
+
+  // Nobody waits on an event, it yields to user actions like a state sync
+  ha_api_response_t response;
+  memset(&response, 0, sizeof(response));
+  esp_err_t err = perform_http_request(url, "POST", event_data ? event_data : "{}", &response, REQUEST_BACKGROUND);
+  if (err != ESP_OK || !response.success)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "Event %s failed: %s", event_type,
+                      response.error_message[0] ? response.error_message : "Unknown error");
+    if (err == ESP_OK)
+    {
+      err = ESP_FAIL;
+    }
+  }
+
+  ha_api_free_response(&response);
+  return err;
+}
+
+esp_err_t ha_api_turn_on_switch(const char *entity_id)
+{
+
+  ha_service_call_t service_call = {
+      .domain = "switch",
+      .service = "turn_on"};
+  strncpy(service_call.entity_id, entity_id, sizeof(service_call.entity_id) - 1);
+
+  ha_api_response_t response;
+  esp_err_t result = ha_api_call_service(&service_call, &response);
+
+  if (result == ESP_OK)
+  {
+  }
+  else
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "<<< TURN ON FAILED: %s (Error: %s)", entity_id, esp_err_to_name(result));
+  }
+
+  ha_api_free_response(&response);
+  return result;
+}
+
+esp_err_t ha_api_turn_off_switch(const char *entity_id)
+{
+
+  ha_service_call_t service_call = {
+      .domain = "switch",
+      .service = "turn_off"};
+  strncpy(service_call.entity_id, entity_id, sizeof(service_call.entity_id) - 1);
+
+  ha_api_response_t response;
+  esp_err_t result = ha_api_call_service(&service_call, &response);
+
+  if (result == ESP_OK)
+  {
+  }
+  else
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "<<< TURN OFF FAILED: %s (Error: %s)", entity_id, esp_err_to_name(result));
+  }
+
+  ha_api_free_response(&response);
+  return result;
+}
+
+esp_err_t ha_api_parse_entity_state(const char *json_str, ha_entity_state_t *state)
+{
+  if (!json_str || !state)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(state, 0, sizeof(ha_entity_state_t));
+
+  json_arena_t *arena = json_arena_begin(strlen(json_str));
+  cJSON *json = cJSON_Parse(json_str);
+  if (json == NULL)
+  {
+    json_arena_end(arena);
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to parse JSON response");
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  cJSON *state_item = cJSON_GetObjectItem(json, "state");
+  if (!cJSON_IsString(state_item))
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Entity state missing from response");
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  // Friendly name from attributes, last_changed (or last_updated) as ISO 8601
+  cJSON *attributes = cJSON_GetObjectItem(json, "attributes");
+  cJSON *friendly_name = cJSON_IsObject(attributes) ? cJSON_GetObjectItem(attributes, "friendly_name") : NULL;
+  uint32_t changed = ha_parse_timestamp(cJSON_GetStringValue(cJSON_GetObjectItem(json, "last_changed")));
+  if (changed == 0)
+  {
+    changed = ha_parse_timestamp(cJSON_GetStringValue(cJSON_GetObjectItem(json, "last_updated")));
+  }
+
+  ha_entity_state_set(state, state_item->valuestring, cJSON_GetStringValue(friendly_name), changed);
+  ha_entity_state_read_attributes(state, attributes);
+
+  cJSON_Delete(json);
+  json_arena_end(arena);
+  return ESP_OK;
+}
+
+void ha_api_free_response(ha_api_response_t *response)
+{
+  if (response && response->response_data)
+  {
+    release_response_buffer(response->response_data);
+    response->response_data = NULL;
+    response->response_len = 0;
+    response->buffer_size = 0;
+  }
+}
+
+bool ha_api_is_ready(void)
+{
+  return ha_api_initialized;
+}
+
+int ha_api_get_pool_stats(ha_api_pool_stats_t *stats, int max_entries)
+{
+  if (!stats || max_entries <= 0 || !pool_mutex)
+  {
+    return 0;
+  }
+
+  int count = 0;
+  xSemaphoreTake(pool_mutex, portMAX_DELAY);
+  for (int i = 0; i < HA_HTTP_POOL_SIZE && count < max_entries; i++)
+  {
+    if (client_pool[i].client != NULL)
+    {
+      stats[count] = client_pool[i].stats;
+      stats[count].in_use = client_pool[i].in_use;
+      strncpy(stats[count].base_url, client_pool[i].base_url, sizeof(stats[count].base_url) - 1);
+      stats[count].base_url[sizeof(stats[count].base_url) - 1] = '\0';
+      count++;
+    }
+  }
+  xSemaphoreGive(pool_mutex);
+  return count;
+}
+
+int ha_api_get_buffer_stats(ha_api_buffer_stats_t *stats, int max_entries)
+{
+  if (!stats || max_entries <= 0)
+  {
+    return 0;
+  }
+
+  int count = 0;
+  portENTER_CRITICAL(&response_grades_lock);
+  for (int g = 0; g < HA_RESPONSE_BUFFER_GRADES && count < max_entries; g++)
+  {
+    stats[count++] = response_grades[g].stats;
+  }
+  portEXIT_CRITICAL(&response_grades_lock);
+  return count;
+}
+
+void ha_api_register_recovery_callback(ha_api_recovery_callback_t callback)
+{
+  recovery_callback = callback;
+}
+
+esp_err_t ha_api_probe_server(int server, uint32_t *latency_ms)
+{
+  const char *base_url = ha_servers_base_url(server);
+  if (!base_url || server >= HA_SERVERS_MAX || !latency_ms)
+    return ESP_ERR_INVALID_ARG;
+  if (!ha_api_initialized || !check_network_connectivity())
+    return ESP_ERR_INVALID_STATE;
+
+  char url[HA_SERVERS_URL_LEN + 8];
+  snprintf(url, sizeof(url), "%s/api/", base_url);
+  char resolved_url[sizeof(url) + INET_ADDRSTRLEN];
+  const char *request_url = apply_cached_host(url, resolved_url, sizeof(resolved_url));
+
+  esp_http_client_handle_t client = probe_clients[server];
+  if (!client)
+  {
+    client = create_http_client(request_url, server);
+    if (!client)
+      return ESP_ERR_NO_MEM;
+    esp_http_client_set_header(client, "Authorization", auth_header);
+    if (server == HA_SERVERS_PRIMARY)
+    {
+      // Right whether connected by name or by cached address
+      esp_http_client_set_header(client, "Host", HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT));
+    }
+    probe_clients[server] = client;
+  }
+  esp_http_client_set_url(client, request_url);
+  esp_http_client_set_method(client, HTTP_METHOD_GET);
+
+  int64_t start_us = esp_timer_get_time();
+  esp_err_t err = esp_http_client_perform(client);
+  int status_code = esp_http_client_get_status_code(client);
+  *latency_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+  if (err != ESP_OK)
+  {
+    esp_http_client_close(client);
+  }
+  else if (status_code != 200)
+  {
+    err = ESP_ERR_INVALID_RESPONSE;
+  }
+  return err;
+}
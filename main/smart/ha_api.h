@@ -10,7 +10,7 @@
  * - Entity state reading and writing
  * - Service calls (switch toggle, etc.)
  * - JSON response parsing
- * - Connection pooling and retry logic
+ * - Keep-alive connection pool and retry logic
  *
  * @author System Monitor Dashboard
  * @date 2025-08-14
@@ -25,6 +25,7 @@
 #include "cJSON.h"
 #include "esp_err.h"
 #include "esp_http_client.h"
+#include "ha_entity_state.h"
 #include "ha_status.h"
 
 #ifdef __cplusplus
@@ -39,12 +40,18 @@ extern "C"
 /** Maximum length for entity IDs */
 #define HA_MAX_ENTITY_ID_LEN 64
 
-/** Maximum length for entity states */
+/** Maximum length of a raw state string while it is parsed */
 #define HA_MAX_STATE_LEN 256
 
 /** Maximum length for friendly names */
 #define HA_MAX_FRIENDLY_NAME_LEN 64
 
+/** Typed parameters a service call carries besides entity_id */
+#define HA_SERVICE_MAX_PARAMS 4
+
+/** Request body buffer of a service call, on the caller's stack */
+#define HA_SERVICE_BODY_SIZE 256
+
 // =======================================================================
 // HTTP CLIENT CONFIGURATION
 // =======================================================================
@@ -53,7 +60,11 @@ extern "C"
 #define HA_HTTP_TIMEOUT_MS 5000
 
 /** Maximum response buffer size for HA API responses */
+#ifdef CONFIG_HA_MAX_RESPONSE_KB
+#define HA_MAX_RESPONSE_SIZE (CONFIG_HA_MAX_RESPONSE_KB * 1024)
+#else
 #define HA_MAX_RESPONSE_SIZE 65536
+#endif
 
 /** Number of retry attempts for failed HTTP requests */
 #define HA_SYNC_RETRY_COUNT 2
@@ -61,22 +72,52 @@ extern "C"
 /** Status update interval in milliseconds */
 #define HA_STATUS_UPDATE_INTERVAL_MS 30000
 
+/** Per-entity requests in flight at once during a multi-entity fetch */
+#ifdef CONFIG_HA_PARALLEL_FETCH_CONCURRENCY
+#define HA_PARALLEL_FETCH_CONCURRENCY CONFIG_HA_PARALLEL_FETCH_CONCURRENCY
+#else
+#define HA_PARALLEL_FETCH_CONCURRENCY 1
+#endif
+
+/** Number of pooled keep-alive HTTP connections, one kept for service calls */
+#define HA_HTTP_POOL_SIZE (1 + HA_PARALLEL_FETCH_CONCURRENCY)
+
+/** Pooled connections idle longer than this are reopened before use (HA drops idle sockets after 75 s) */
+#define HA_HTTP_POOL_MAX_IDLE_MS 60000
+
+/** Longest a background poll waits for user commands to finish before it goes ahead anyway */
+#define HA_BACKGROUND_DEFER_MAX_MS 3000
+
+/** Retry delay before jitter, doubled per attempt up to the maximum */
+#define HA_RETRY_BACKOFF_BASE_MS 250
+#define HA_RETRY_BACKOFF_MAX_MS 4000
+
+/** Consecutive failed attempts that open an endpoint's circuit */
+#define HA_CIRCUIT_FAILURE_THRESHOLD 3
+
+/** First open period of a circuit, doubled after every failed probe up to the maximum */
+#define HA_CIRCUIT_OPEN_MIN_MS 2000
+#define HA_CIRCUIT_OPEN_MAX_MS 60000
+
+/** Returned without touching the network while an endpoint's circuit is open */
+#define HA_API_ERR_CIRCUIT_OPEN ESP_ERR_NOT_ALLOWED
+
+/** Resolved HA host address is reused this long before it is looked up again */
+#define HA_DNS_CACHE_TTL_S 600
+
+/** Response buffer grades: service replies, single states and templates, full /api/states */
+#define HA_RESPONSE_BUFFER_GRADES 3
+#define HA_RESPONSE_BUFFER_SMALL_SIZE 1024
+#define HA_RESPONSE_BUFFER_SMALL_COUNT 3
+#define HA_RESPONSE_BUFFER_MEDIUM_SIZE 8192
+#define HA_RESPONSE_BUFFER_MEDIUM_COUNT 2
+#define HA_RESPONSE_BUFFER_LARGE_SIZE HA_MAX_RESPONSE_SIZE
+#define HA_RESPONSE_BUFFER_LARGE_COUNT 1
+
   // =======================================================================
   // DATA STRUCTURES
   // =======================================================================
 
-  /**
-   * @brief Simplified Home Assistant entity state structure
-   * Optimized for switch states without complex attributes
-   */
-  typedef struct
-  {
-    char entity_id[HA_MAX_ENTITY_ID_LEN];         ///< Entity ID (e.g., "switch.pump")
-    char state[HA_MAX_STATE_LEN];                 ///< Current state (e.g., "on", "off")
-    char friendly_name[HA_MAX_FRIENDLY_NAME_LEN]; ///< Human-readable name
-    time_t last_updated;                          ///< Last update timestamp (Unix time)
-  } ha_entity_state_t;
-
   /**
    * @brief Home Assistant API response structure
    */
@@ -85,21 +126,88 @@ extern "C"
     int status_code;         ///< HTTP status code
     char *response_data;     ///< Raw response data (JSON)
     size_t response_len;     ///< Response data length
+    size_t buffer_size;      ///< Capacity of response_data
     bool success;            ///< Operation success flag
+    bool unchanged;          ///< Cached request: same body as the last time, see ha_http_cache.h
     char error_message[128]; ///< Error description if failed
   } ha_api_response_t;
 
+  /**
+   * @brief Receives the body chunks of a streamed request
+   * @note Called with data NULL when a retry starts, earlier chunks are void
+   */
+  typedef esp_err_t (*ha_api_sink_t)(void *ctx, const char *data, size_t len);
+
+  /**
+   * @brief Type of a service call parameter
+   */
+  typedef enum
+  {
+    HA_SERVICE_PARAM_INT = 0, ///< JSON integer, e.g. brightness
+    HA_SERVICE_PARAM_NUMBER,  ///< JSON number, e.g. temperature
+    HA_SERVICE_PARAM_BOOL,    ///< JSON true/false
+    HA_SERVICE_PARAM_STRING,  ///< JSON string, escaped when encoded
+  } ha_service_param_type_t;
+
+  /**
+   * @brief One service data field besides entity_id
+   */
+  typedef struct
+  {
+    const char *key; ///< Field name, a string literal, sent unescaped
+    ha_service_param_type_t type;
+    union
+    {
+      int32_t i;
+      float number;
+      bool boolean;
+      const char *string; ///< Must stay valid until the call returns
+    } value;
+  } ha_service_param_t;
+
   /**
    * @brief Service call data structure
    */
   typedef struct
   {
-    char domain[32];                      ///< Service domain (e.g., "switch")
-    char service[32];                     ///< Service name (e.g., "toggle")
-    char entity_id[HA_MAX_ENTITY_ID_LEN]; ///< Target entity ID
-    cJSON *service_data;                  ///< Additional service data (optional)
+    char domain[32];                                 ///< Service domain (e.g., "switch")
+    char service[32];                                ///< Service name (e.g., "toggle")
+    char entity_id[HA_MAX_ENTITY_ID_LEN];            ///< Target entity ID
+    ha_service_param_t params[HA_SERVICE_MAX_PARAMS]; ///< Service data besides entity_id
+    uint8_t param_count;                             ///< Entries of params in use
   } ha_service_call_t;
 
+  /**
+   * @brief Counters of one pooled HTTP connection
+   */
+  typedef struct
+  {
+    char base_url[64];   ///< Host the connection belongs to (truncated)
+    bool in_use;         ///< Currently serving a request
+    uint32_t requests;   ///< Requests performed on this connection
+    uint32_t failures;   ///< Requests that failed at HTTP level
+    uint32_t reconnects; ///< Times the socket had to be reopened
+  } ha_api_pool_stats_t;
+
+  /**
+   * @brief Usage of one response buffer grade
+   */
+  typedef struct
+  {
+    size_t size;        ///< Bytes per buffer
+    uint8_t buffers;    ///< Buffers preallocated in this grade
+    uint8_t in_use;     ///< Buffers handed out right now
+    uint8_t high_water; ///< Most buffers ever handed out at once
+    uint32_t acquired;  ///< Responses served from this grade
+    uint32_t fallbacks; ///< Responses that needed a heap buffer because the grade was exhausted
+  } ha_api_buffer_stats_t;
+
+  /**
+   * @brief Called when a request succeeds on an endpoint whose circuit was open
+   * @note Runs in the task that made the request, must not block
+   */
+  typedef void (*ha_api_recovery_callback_t)(void);
+
   // =======================================================================
   // PUBLIC FUNCTION DECLARATIONS
   // =======================================================================
@@ -135,9 +243,10 @@ extern "C"
   esp_err_t ha_api_get_entity_state(const char *entity_id, ha_entity_state_t *state);
 
   /**
-   * @brief Get states of multiple entities in bulk
+   * @brief Get states of multiple entities, one request each
    *
-   * Retrieves current states for multiple entities efficiently using the bulk states API.
+   * Up to HA_PARALLEL_FETCH_CONCURRENCY requests run at once, each on its own
+   * pooled connection. Stops early once HA is clearly unreachable.
    *
    * @param entity_ids Array of entity IDs to query
    * @param entity_count Number of entities to query
@@ -149,8 +258,9 @@ extern "C"
   /**
    * @brief Get states of multiple entities using bulk API request
    *
-   * More efficient alternative that fetches ALL states in one request and filters results.
-   * Better for multiple entities but larger payload size.
+   * Fetches ALL states in one request and streams the body through the
+   * incremental parser, so only the requested entities are kept in memory
+   * and the response size is not limited by HA_MAX_RESPONSE_SIZE.
    *
    * @param entity_ids Array of entity IDs to query
    * @param entity_count Number of entities to query
@@ -159,17 +269,111 @@ extern "C"
    */
   esp_err_t ha_api_get_multiple_entity_states_bulk(const char **entity_ids, int entity_count, ha_entity_state_t *states);
 
+  /**
+   * @brief Get states of multiple entities through a rendered template
+   *
+   * POSTs to /api/template with a template that emits state and friendly_name
+   * of the requested entities only, so the payload does not grow with the
+   * number of entities in Home Assistant.
+   *
+   * @param entity_ids Array of entity IDs to query
+   * @param entity_count Number of entities to query
+   * @param states Array of state structures to fill (must be same size as entity_ids)
+   * @return ESP_OK on success, ESP_ERR_NOT_FOUND if some entities are missing,
+   *         ESP_ERR_NOT_SUPPORTED if HA rejected the template request
+   */
+  esp_err_t ha_api_get_multiple_entity_states_template(const char **entity_ids, int entity_count, ha_entity_state_t *states);
+
+  /**
+   * @brief Render a template through POST /api/template
+   *
+   * @param template_string Jinja template, sent as is
+   * @param response Filled with the rendered text on success, free it with
+   *        ha_api_free_response()
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if HA rejected the
+   *         template request, or the transport error
+   */
+  esp_err_t ha_api_render_template(const char *template_string, ha_api_response_t *response);
+
+  /**
+   * @brief Render a template that answers with slow-changing metadata, through the HTTP cache
+   *
+   * As ha_api_render_template(), keyed by the template. The reply may come
+   * from the cache without a request; response->unchanged is set when it
+   * is the same text as last time, also across restarts.
+   */
+  esp_err_t ha_api_render_template_cached(const char *template_string, ha_api_response_t *response);
+
+  /**
+   * @brief GET a slow-changing API document through the HTTP cache
+   *
+   * For /config, /states/<entity_id> attributes and the like; the request
+   * is conditional once HA or a proxy in front of it sent validators.
+   *
+   * @param path Path below /api, e.g. "/config"
+   * @param response Filled with the body on success, response->unchanged as
+   *        for ha_api_render_template_cached(); free it with ha_api_free_response()
+   * @return ESP_OK, ESP_ERR_INVALID_SIZE if the URL does not fit
+   *         HA_HTTP_CACHE_URL_LEN, ESP_ERR_INVALID_RESPONSE on an error
+   *         status, or the transport error
+   */
+  esp_err_t ha_api_get_metadata(const char *path, ha_api_response_t *response);
+
+  /**
+   * @brief GET a document below /api into a sink, nothing is buffered
+   *
+   * For bodies too large to hold, such as camera snapshots; the sink runs
+   * in the caller's task and may block to pace the download.
+   *
+   * @param path Path below /api, e.g. "/camera_proxy/camera.front_door"
+   * @param sink Called for each chunk
+   * @param ctx Passed to sink
+   * @param status_code Receives the HTTP status, may be NULL
+   * @return ESP_OK, ESP_ERR_INVALID_SIZE if the URL is too long,
+   *         ESP_ERR_INVALID_RESPONSE on an error status, or the transport error
+   */
+  esp_err_t ha_api_get_streamed(const char *path, ha_api_sink_t sink, void *ctx, int *status_code);
+
+  /**
+   * @brief Encode the JSON body of a service call
+   *
+   * Writes {"entity_id":"...",<params>} into buf with bounded formatting
+   * and string escaping, no heap involved.
+   *
+   * @param service_call Service call to encode
+   * @param buf Output buffer
+   * @param size Size of buf
+   * @return Body length without terminator, or -1 if it does not fit
+   */
+  int ha_api_encode_service_body(const ha_service_call_t *service_call, char *buf, size_t size);
+
   /**
    * @brief Call a Home Assistant service
    *
-   * Executes a service call (like turning on/off a switch).
+   * Executes a service call (like turning on/off a switch). The body is
+   * encoded into a HA_SERVICE_BODY_SIZE buffer on the stack and the request
+   * headers of the pooled connection are only updated when they change, so
+   * the call itself allocates nothing; the response goes to a pooled
+   * response buffer.
    *
    * @param service_call Service call configuration
    * @param response Response structure (optional, can be NULL)
-   * @return ESP_OK on success, error code on failure
+   * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the body does not fit,
+   *         error code on failure
    */
   esp_err_t ha_api_call_service(const ha_service_call_t *service_call, ha_api_response_t *response);
 
+  /**
+   * @brief Fire a Home Assistant event
+   *
+   * POSTs to /api/events/<event_type>, automations can trigger on it.
+   *
+   * @param event_type Event type, e.g. "system_monitor_alert"
+   * @param event_data JSON object sent as the event data (may be NULL)
+   * @return ESP_OK on success, error code on failure
+   */
+  esp_err_t ha_api_fire_event(const char *event_type, const char *event_data);
+
   /**
    * @brief Turn on a switch entity
    *
@@ -217,6 +421,44 @@ extern "C"
    */
   bool ha_api_is_ready(void);
 
+  /**
+   * @brief Get counters of the pooled HTTP connections
+   *
+   * @param stats Array to fill
+   * @param max_entries Size of the array
+   * @return Number of open connections written
+   */
+  int ha_api_get_pool_stats(ha_api_pool_stats_t *stats, int max_entries);
+
+  /**
+   * @brief Get usage of the response buffer grades, smallest first
+   *
+   * @param stats Array to fill
+   * @param max_entries Size of the array
+   * @return Number of grades written
+   */
+  int ha_api_get_buffer_stats(ha_api_buffer_stats_t *stats, int max_entries);
+
+  /**
+   * @brief Register the function told when HA answers again after an outage
+   * @param callback Called whenever a circuit closes, NULL to stop
+   */
+  void ha_api_register_recovery_callback(ha_api_recovery_callback_t callback);
+
+  /**
+   * @brief Time a GET of /api/ on one of the configured HA servers
+   *
+   * Uses a keep-alive connection per server of its own, so probes neither
+   * wait for nor evict the pooled connections, and bypasses the circuit
+   * breakers and the HA status.
+   *
+   * @param server ha_servers index
+   * @param latency_ms Receives the request time on success
+   * @return ESP_OK if the server answered 200, ESP_ERR_INVALID_STATE without
+   *         WiFi or before ha_api_init(), or the request error
+   */
+  esp_err_t ha_api_probe_server(int server, uint32_t *latency_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,453 @@
+/**
+ * @file ha_camera.c
+ * @brief Camera snapshots decoded while they download
+ *
+ * TJpgDec pulls its input and the HTTP client pushes the body, so they run
+ * on two tasks joined by a stream buffer: ha_camera performs the request
+ * and its sink blocks while the buffer is full, cam_decode runs the
+ * decoder, whose input callback blocks while it is empty. The sink drops
+ * the rest of a body once the decoder has finished with it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_camera.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_rom_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+#include "ha_api.h"
+#include "serial/serial_data_handler.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "utils/mem_governor.h"
+
+#if defined(HA_CAMERA_ENTITY_ID) && ESP_ROM_HAS_JPEG_DECODE
+#define HA_CAMERA_ENABLED 1
+#include "rom/tjpgd.h"
+#else
+#define HA_CAMERA_ENABLED 0
+#endif
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#if HA_CAMERA_ENABLED
+
+/** Body bytes between download and decoder */
+#define CAMERA_STREAM_SIZE 4096
+
+/** TJpgDec work area, its tables and one MCU; 3100 bytes is the decoder's minimum */
+#define CAMERA_WORK_SIZE 4096
+
+/** Longest the input callback waits before it checks for the end of the body */
+#define CAMERA_INPUT_POLL_MS 50
+
+/** Longest the sink waits for room before it checks whether the decoder gave up */
+#define CAMERA_SINK_POLL_MS 100
+
+#define CAMERA_PATH "/camera_proxy/" HA_CAMERA_ENTITY_ID
+
+#define RGB565(r, g, b) (uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief One snapshot on its way from the request into a frame
+ */
+typedef struct
+{
+  uint16_t *frame;        ///< Frame the decoder writes, not on screen
+  uint32_t out_w, out_h;  ///< Picture size within the tile
+  uint32_t off_x, off_y;  ///< Top left of the picture, the bars around it stay black
+  uint32_t src_w, src_h;  ///< Snapshot size at the decoder scale
+  size_t pushed;          ///< Body bytes into the stream buffer
+  volatile bool eof;      ///< The request is over, what is buffered is all there is
+  volatile bool finished; ///< The decoder is done, the sink drops the rest
+  bool broken;            ///< A retry started over after bytes were pushed
+  JRESULT result;
+} camera_decode_t;
+
+#endif
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static portMUX_TYPE camera_lock = portMUX_INITIALIZER_UNLOCKED;
+static int displayed = 0; ///< Frame the LVGL task draws
+static int ready = -1;    ///< Frame decoded and not yet swapped in, -1 if none
+static ha_camera_stats_t stats;
+
+#if HA_CAMERA_ENABLED
+static uint16_t *frames[2];
+static volatile bool active = false;
+static volatile bool shed = false;
+static TaskHandle_t camera_task_handle = NULL;
+static TaskHandle_t decode_task_handle = NULL;
+static StreamBufferHandle_t stream = NULL;
+static SemaphoreHandle_t decode_done = NULL;
+static uint8_t *work_pool = NULL;
+static camera_decode_t decode;
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if HA_CAMERA_ENABLED
+
+/**
+ * @brief Fit the snapshot into the tile and pick the decoder scale
+ *
+ * The decoder scales by 1/2, 1/4 or 1/8 for free; the largest of those
+ * that still leaves at least the picture size is taken, and the output
+ * callback picks the nearest pixels for the rest.
+ */
+static uint8_t plan_geometry(camera_decode_t *d, uint32_t width, uint32_t height)
+{
+  d->out_w = HA_CAMERA_WIDTH;
+  d->out_h = height * HA_CAMERA_WIDTH / width;
+  if (d->out_h > HA_CAMERA_HEIGHT)
+  {
+    d->out_h = HA_CAMERA_HEIGHT;
+    d->out_w = width * HA_CAMERA_HEIGHT / height;
+  }
+  d->out_w = d->out_w ? d->out_w : 1;
+  d->out_h = d->out_h ? d->out_h : 1;
+  d->off_x = (HA_CAMERA_WIDTH - d->out_w) / 2;
+  d->off_y = (HA_CAMERA_HEIGHT - d->out_h) / 2;
+
+  uint8_t scale = 0;
+  while (scale < 3 && (width >> (scale + 1)) >= d->out_w && (height >> (scale + 1)) >= d->out_h)
+    scale++;
+  d->src_w = width >> scale;
+  d->src_h = height >> scale;
+  return scale;
+}
+
+/**
+ * @brief TJpgDec input: body bytes, or skip them when buf is NULL
+ * @return Bytes delivered, short only at the end of the body
+ */
+static uint32_t jpeg_input(JDEC *jd, uint8_t *buf, uint32_t len)
+{
+  (void)jd;
+  uint8_t skipped[64];
+  uint32_t got = 0;
+  while (got < len)
+  {
+    uint32_t want = buf ? len - got : (len - got < sizeof(skipped) ? len - got : sizeof(skipped));
+    size_t n = xStreamBufferReceive(stream, buf ? buf + got : skipped, want, pdMS_TO_TICKS(CAMERA_INPUT_POLL_MS));
+    got += n;
+    if (n == 0 && decode.eof && xStreamBufferIsEmpty(stream))
+      break;
+  }
+  return got;
+}
+
+static uint32_t ceil_div(uint32_t a, uint32_t b)
+{
+  return (a + b - 1) / b;
+}
+
+/**
+ * @brief TJpgDec output: one RGB888 block at the decoder scale into the frame
+ *
+ * Each tile pixel takes the nearest snapshot pixel, so only the tile
+ * pixels whose source falls inside the block are written.
+ */
+static uint32_t jpeg_output(JDEC *jd, void *bitmap, JRECT *rect)
+{
+  camera_decode_t *d = jd->device;
+  uint32_t right = rect->right < d->src_w ? rect->right : d->src_w - 1;
+  uint32_t bottom = rect->bottom < d->src_h ? rect->bottom : d->src_h - 1;
+  if (rect->left > right || rect->top > bottom)
+    return 1;
+
+  uint32_t block_w = (uint32_t)(rect->right - rect->left + 1);
+  uint32_t x0 = ceil_div(rect->left * d->out_w, d->src_w);
+  uint32_t x1 = ceil_div((right + 1) * d->out_w, d->src_w);
+  uint32_t y0 = ceil_div(rect->top * d->out_h, d->src_h);
+  uint32_t y1 = ceil_div((bottom + 1) * d->out_h, d->src_h);
+  const uint8_t *rgb = bitmap;
+
+  for (uint32_t y = y0; y < y1; y++)
+  {
+    const uint8_t *src_row = rgb + (y * d->src_h / d->out_h - rect->top) * block_w * 3;
+    uint16_t *row = d->frame + (d->off_y + y) * HA_CAMERA_WIDTH + d->off_x;
+    for (uint32_t x = x0; x < x1; x++)
+    {
+      const uint8_t *p = src_row + (x * d->src_w / d->out_w - rect->left) * 3;
+      row[x] = RGB565(p[0], p[1], p[2]);
+    }
+  }
+  return 1;
+}
+
+static void decode_task(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    JDEC jd;
+    JRESULT result = jd_prepare(&jd, jpeg_input, work_pool, CAMERA_WORK_SIZE, &decode);
+    if (result == JDR_OK && (jd.width == 0 || jd.height == 0))
+      result = JDR_FMT1;
+    if (result == JDR_OK)
+    {
+      uint8_t scale = plan_geometry(&decode, jd.width, jd.height);
+      if (decode.out_w < HA_CAMERA_WIDTH || decode.out_h < HA_CAMERA_HEIGHT)
+        memset(decode.frame, 0, HA_CAMERA_WIDTH * HA_CAMERA_HEIGHT * sizeof(uint16_t));
+      result = jd_decomp(&jd, jpeg_output, scale);
+
+      portENTER_CRITICAL(&camera_lock);
+      stats.source_width = (uint16_t)jd.width;
+      stats.source_height = (uint16_t)jd.height;
+      stats.scale = scale;
+      portEXIT_CRITICAL(&camera_lock);
+    }
+    decode.result = result;
+    decode.finished = true;
+    xSemaphoreGive(decode_done);
+  }
+}
+
+/**
+ * @brief Body chunks into the stream buffer, paced by the decoder
+ */
+static esp_err_t stream_sink(void *ctx, const char *data, size_t len)
+{
+  camera_decode_t *d = ctx;
+  if (!data)
+  {
+    // The decoder already holds the start of the lost attempt
+    if (d->pushed > 0)
+      d->broken = true;
+    return ESP_OK;
+  }
+
+  while (len > 0 && !d->finished && !d->broken)
+  {
+    size_t sent = xStreamBufferSend(stream, data, len, pdMS_TO_TICKS(CAMERA_SINK_POLL_MS));
+    data += sent;
+    len -= sent;
+    d->pushed += sent;
+  }
+  return ESP_OK;
+}
+
+static void fetch_frame(void)
+{
+  portENTER_CRITICAL(&camera_lock);
+  int target = 1 - displayed;
+  ready = -1;
+  portEXIT_CRITICAL(&camera_lock);
+
+  xStreamBufferReset(stream);
+  memset(&decode, 0, sizeof(decode));
+  decode.frame = frames[target];
+  xTaskNotifyGive(decode_task_handle);
+
+  int64_t start_us = esp_timer_get_time();
+  int status = 0;
+  esp_err_t err = ha_api_get_streamed(CAMERA_PATH, stream_sink, &decode, &status);
+  decode.eof = true;
+  xSemaphoreTake(decode_done, portMAX_DELAY);
+
+  if (err == ESP_OK && (decode.broken || decode.result != JDR_OK))
+  {
+    err = ESP_ERR_INVALID_RESPONSE;
+    debug_log_warning_f(DEBUG_TAG_HA_API, "Camera snapshot not decoded: %d after %u bytes%s", (int)decode.result,
+                        (unsigned)decode.pushed, decode.broken ? ", request retried" : "");
+  }
+
+  portENTER_CRITICAL(&camera_lock);
+  stats.last_error = err;
+  if (err == ESP_OK)
+  {
+    ready = target;
+    stats.frames++;
+    stats.last_bytes = (uint32_t)decode.pushed;
+    stats.last_frame_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    stats.last_frame_us = esp_timer_get_time();
+  }
+  else
+  {
+    stats.failures++;
+  }
+  portEXIT_CRITICAL(&camera_lock);
+}
+
+static void camera_task(void *arg)
+{
+  (void)arg;
+  int64_t due_us = 0;
+  for (;;)
+  {
+    int64_t now = esp_timer_get_time();
+    TickType_t wait = !active ? portMAX_DELAY : due_us > now ? pdMS_TO_TICKS((due_us - now) / 1000) : 0;
+    // Woken early by ha_camera_set_active(true), the page wants a frame at once
+    if (ulTaskNotifyTake(pdTRUE, wait) > 0)
+      due_us = 0;
+    if (!active || shed || esp_timer_get_time() < due_us)
+      continue;
+
+    due_us = esp_timer_get_time() + (int64_t)HA_CAMERA_REFRESH_MS * 1000;
+    fetch_frame();
+  }
+}
+
+/**
+ * @brief Memory governor: no snapshots while memory is short
+ */
+static void camera_shed(mem_pressure_t level, void *ctx)
+{
+  (void)ctx;
+  shed = level >= MEM_PRESSURE_HIGH;
+}
+
+static bool start_tasks(void)
+{
+  if (camera_task_handle)
+    return true;
+
+  stream = xStreamBufferCreate(CAMERA_STREAM_SIZE, 1);
+  decode_done = xSemaphoreCreateBinary();
+  work_pool = heap_caps_malloc(CAMERA_WORK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!stream || !decode_done || !work_pool)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Camera buffers not allocated");
+    return false;
+  }
+  if (task_plan_create(TASK_PLAN_HA_CAMERA_DECODE, decode_task, NULL, &decode_task_handle) != pdPASS ||
+      task_plan_create(TASK_PLAN_HA_CAMERA, camera_task, NULL, &camera_task_handle) != pdPASS)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "Camera tasks not created");
+    return false;
+  }
+  mem_governor_register("camera", MEM_GOVERNOR_REGION(HEAP_REGION_INTERNAL) | MEM_GOVERNOR_REGION(HEAP_REGION_SPIRAM),
+                        camera_shed, NULL);
+  return true;
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+bool ha_camera_configured(void)
+{
+  return HA_CAMERA_ENABLED;
+}
+
+const char *ha_camera_entity_id(void)
+{
+#if HA_CAMERA_ENABLED
+  return HA_CAMERA_ENTITY_ID;
+#else
+  return "";
+#endif
+}
+
+esp_err_t ha_camera_frames(uint16_t *out[2])
+{
+#if HA_CAMERA_ENABLED
+  if (!frames[0])
+  {
+    size_t size = (size_t)HA_CAMERA_WIDTH * HA_CAMERA_HEIGHT * sizeof(uint16_t);
+    for (int i = 0; i < 2; i++)
+    {
+      frames[i] = heap_caps_aligned_calloc(16, 1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (!frames[0] || !frames[1])
+    {
+      heap_caps_free(frames[0]);
+      heap_caps_free(frames[1]);
+      frames[0] = frames[1] = NULL;
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  out[0] = frames[0];
+  out[1] = frames[1];
+  return ESP_OK;
+#else
+  (void)out;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void ha_camera_set_active(bool on)
+{
+#if HA_CAMERA_ENABLED
+  if (on == active || !frames[0])
+    return;
+  if (on && !start_tasks())
+    return;
+  active = on;
+  if (on)
+    xTaskNotifyGive(camera_task_handle);
+#else
+  (void)on;
+#endif
+}
+
+int ha_camera_acquire_frame(bool *swapped)
+{
+  portENTER_CRITICAL(&camera_lock);
+  bool fresh = ready >= 0;
+  if (fresh)
+  {
+    displayed = ready;
+    ready = -1;
+  }
+  int index = displayed;
+  portEXIT_CRITICAL(&camera_lock);
+
+  if (swapped)
+    *swapped = fresh;
+  return index;
+}
+
+void ha_camera_get_stats(ha_camera_stats_t *out)
+{
+  portENTER_CRITICAL(&camera_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&camera_lock);
+}
+
+bool ha_camera_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_CAMERA") != 0)
+    return false;
+
+  ha_camera_stats_t s;
+  ha_camera_get_stats(&s);
+  int64_t age_ms = s.last_frame_us ? (esp_timer_get_time() - s.last_frame_us) / 1000 : -1;
+
+  char buf[320];
+  int len = snprintf(buf, sizeof(buf),
+                     "CAMERA {\"entity_id\":\"%s\",\"configured\":%s,\"tile\":[%d,%d],\"refresh_ms\":%d,"
+                     "\"frames\":%lu,\"failures\":%lu,\"last_error\":\"%s\",\"frame_ms\":%lu,\"bytes\":%lu,"
+                     "\"source\":[%u,%u],\"scale\":\"1/%u\",\"age_ms\":%lld}\n",
+                     ha_camera_entity_id(), ha_camera_configured() ? "true" : "false", HA_CAMERA_WIDTH,
+                     HA_CAMERA_HEIGHT, HA_CAMERA_REFRESH_MS, (unsigned long)s.frames, (unsigned long)s.failures,
+                     esp_err_to_name(s.last_error), (unsigned long)s.last_frame_ms, (unsigned long)s.last_bytes,
+                     (unsigned)s.source_width, (unsigned)s.source_height, 1u << s.scale, (long long)age_ms);
+  serial_data_write(buf, len < 0 ? 0 : (size_t)len);
+  return true;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file ha_camera.h
+ * @brief Camera snapshots decoded while they download
+ *
+ * The camera page shows HA_CAMERA_ENTITY_ID (smart_config.h), refreshed
+ * from /api/camera_proxy every HA_CAMERA_REFRESH_MS while the page is on
+ * screen. The JPEG is never held in full: the HTTP body is streamed
+ * through a small buffer into the ROM TJpgDec decoder on a second task,
+ * which asks the decoder for the largest 1/2, 1/4 or 1/8 scale that still
+ * covers the tile and writes each MCU block, scaled the rest of the way,
+ * straight into an RGB565 frame in PSRAM.
+ *
+ * There are two frames of HA_CAMERA_WIDTH x HA_CAMERA_HEIGHT. The decoder
+ * only writes the one not on screen and hands it over when the last block
+ * is in; the LVGL task swaps at its next update, so a half-decoded frame
+ * is never drawn. A snapshot is fitted into the tile with its aspect ratio
+ * kept, the bars stay black.
+ *
+ * Snapshots pause at memory pressure HIGH and above. GET_CAMERA reports
+ * frames, failures, the snapshot size and the decoder scale.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_CAMERA_H
+#define HA_CAMERA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Tile size, 16:9 within the page panel */
+#define HA_CAMERA_WIDTH 576
+#define HA_CAMERA_HEIGHT 324
+
+  /** Snapshot interval while the page is shown, measured start to start */
+#ifdef CONFIG_HA_CAMERA_REFRESH_MS
+#define HA_CAMERA_REFRESH_MS CONFIG_HA_CAMERA_REFRESH_MS
+#else
+#define HA_CAMERA_REFRESH_MS 5000
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef struct
+  {
+    uint32_t frames;         ///< Snapshots decoded and handed over
+    uint32_t failures;       ///< Snapshots lost to the request or the decoder
+    uint32_t last_frame_ms;  ///< Request start to last block of the newest frame
+    uint32_t last_bytes;     ///< JPEG size of the newest frame
+    uint16_t source_width;   ///< Snapshot size
+    uint16_t source_height;
+    uint8_t scale;           ///< Decoder scale of the newest frame, 1/2^scale
+    int64_t last_frame_us;   ///< esp_timer time of the newest frame, 0 before the first
+    esp_err_t last_error;    ///< ESP_OK after a good frame
+  } ha_camera_stats_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Whether a camera is configured and the ROM has the decoder
+   */
+  bool ha_camera_configured(void);
+
+  /**
+   * @brief Entity shown, "" if none is configured
+   */
+  const char *ha_camera_entity_id(void);
+
+  /**
+   * @brief The two frames, allocated in PSRAM on the first call and kept
+   * @param frames Receives HA_CAMERA_WIDTH * HA_CAMERA_HEIGHT pixels each, black until decoded
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without a camera, or ESP_ERR_NO_MEM
+   */
+  esp_err_t ha_camera_frames(uint16_t *frames[2]);
+
+  /**
+   * @brief Start or stop the snapshots
+   * @note Starting creates the tasks the first time and fetches at once
+   */
+  void ha_camera_set_active(bool active);
+
+  /**
+   * @brief Frame to draw, switching to a newly decoded one
+   * @param swapped Set to true if the frame is new since the last call, may be NULL
+   * @return 0 or 1, index into ha_camera_frames()
+   * @note LVGL task only: the frame returned is not written until the next call
+   */
+  int ha_camera_acquire_frame(bool *swapped);
+
+  /**
+   * @brief Copy the counters
+   */
+  void ha_camera_get_stats(ha_camera_stats_t *stats);
+
+  /**
+   * @brief Handle GET_CAMERA
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a camera command
+   */
+  bool ha_camera_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_CAMERA_H
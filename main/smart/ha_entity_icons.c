@@ -0,0 +1,269 @@
+/**
+ * @file ha_entity_icons.c
+ * @brief HA icon names of the registry entities, cached in NVS
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_entity_icons.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "ha_api.h"
+#include "ha_entity_registry.h"
+#include "json_arena.h"
+#include "nvs.h"
+#include "nvs_store.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define ICONS_NVS_NAMESPACE "ha_icons"
+#define ICONS_NVS_KEY "list"
+#define ICONS_BLOB_VERSION 1
+
+// Written once per boot at most, no need to wait for other edits
+#define ICONS_SAVE_DELAY_MS 1000
+
+// The registry IDs as a JSON array go between head and tail, it doubles as a Jinja list
+#define ICONS_TEMPLATE_HEAD "{% set ns = namespace(out=[]) %}{% for id in "
+#define ICONS_TEMPLATE_TAIL " %}{% set ns.out = ns.out + [{'entity_id': id, 'icon': state_attr(id, 'icon')}] %}" \
+                            "{% endfor %}{{ ns.out | tojson }}"
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef struct
+{
+  char entity_id[HA_MAX_ENTITY_ID_LEN];
+  char icon[HA_ENTITY_ICON_LEN]; ///< Without "mdi:", empty if none
+} entity_icon_t;
+
+/**
+ * @brief NVS layout, only the first count entries are written
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t count;
+  entity_icon_t items[HA_REGISTRY_MAX_ENTITIES];
+} icons_blob_t;
+
+#define ICONS_BLOB_SIZE(count) (offsetof(icons_blob_t, items) + (size_t)(count) * sizeof(entity_icon_t))
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+// Indexed like the registry, which does not change until restart
+static char icons[HA_REGISTRY_MAX_ENTITIES][HA_ENTITY_ICON_LEN];
+static volatile uint32_t icons_generation = 0;
+static portMUX_TYPE icons_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Fill items from the rendered template, entries of unknown entities are skipped
+ * @return Number of entries filled, -1 if the reply is not a JSON array
+ */
+static int parse_icons(const char *json_text, size_t json_len, entity_icon_t *items)
+{
+  json_arena_t *arena = json_arena_begin(json_len);
+  cJSON *json = cJSON_Parse(json_text);
+  if (!cJSON_IsArray(json))
+  {
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    return -1;
+  }
+
+  int count = 0;
+  const cJSON *item = NULL;
+  cJSON_ArrayForEach(item, json)
+  {
+    if (count >= HA_REGISTRY_MAX_ENTITIES)
+      break;
+
+    const cJSON *entity_id = cJSON_GetObjectItem(item, "entity_id");
+    if (!cJSON_IsString(entity_id) || ha_registry_find(entity_id->valuestring) < 0)
+      continue;
+
+    entity_icon_t *entry = &items[count++];
+    memset(entry, 0, sizeof(*entry));
+    strlcpy(entry->entity_id, entity_id->valuestring, sizeof(entry->entity_id));
+
+    // Only "mdi:" names map to atlas icons
+    const cJSON *icon = cJSON_GetObjectItem(item, "icon");
+    if (cJSON_IsString(icon) && strncmp(icon->valuestring, "mdi:", 4) == 0 &&
+        strlen(icon->valuestring + 4) < sizeof(entry->icon))
+      strlcpy(entry->icon, icon->valuestring + 4, sizeof(entry->icon));
+  }
+
+  cJSON_Delete(json);
+  json_arena_end(arena);
+  return count;
+}
+
+/**
+ * @brief Map entries onto registry indices and replace the live names
+ * @return true if any name changed
+ */
+static bool publish_icons(const entity_icon_t *items, int count)
+{
+  static char next[HA_REGISTRY_MAX_ENTITIES][HA_ENTITY_ICON_LEN]; // Callers are init and the sync task
+  memset(next, 0, sizeof(next));
+  for (int i = 0; i < count; i++)
+  {
+    int index = ha_registry_find(items[i].entity_id);
+    if (index >= 0)
+      memcpy(next[index], items[i].icon, HA_ENTITY_ICON_LEN);
+  }
+
+  bool changed;
+  portENTER_CRITICAL(&icons_lock);
+  changed = memcmp(icons, next, sizeof(icons)) != 0;
+  if (changed)
+  {
+    memcpy(icons, next, sizeof(icons));
+    icons_generation++;
+  }
+  portEXIT_CRITICAL(&icons_lock);
+  return changed;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ha_entity_icons_init(void)
+{
+  icons_blob_t *blob = malloc(sizeof(icons_blob_t));
+  if (!blob)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  size_t size = sizeof(*blob);
+  esp_err_t err = nvs_store_get(ICONS_NVS_NAMESPACE, ICONS_NVS_KEY, blob, &size);
+  if (err == ESP_OK && (size < offsetof(icons_blob_t, items) || blob->version != ICONS_BLOB_VERSION ||
+                        blob->count > HA_REGISTRY_MAX_ENTITIES || size != ICONS_BLOB_SIZE(blob->count)))
+  {
+    debug_log_warning(DEBUG_TAG_SMART_HOME, "Stored entity icons have an unknown layout, ignoring them");
+    err = ESP_ERR_INVALID_SIZE;
+  }
+
+  if (err == ESP_OK)
+  {
+    // Never trust flash contents to be terminated
+    for (int i = 0; i < blob->count; i++)
+    {
+      blob->items[i].entity_id[HA_MAX_ENTITY_ID_LEN - 1] = '\0';
+      blob->items[i].icon[HA_ENTITY_ICON_LEN - 1] = '\0';
+    }
+    publish_icons(blob->items, blob->count);
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "Entity icons: %d cached", blob->count);
+  }
+  else if (err != ESP_ERR_NVS_NOT_FOUND && err != ESP_ERR_INVALID_SIZE)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Entity icons not loaded: %s", esp_err_to_name(err));
+  }
+
+  free(blob);
+  return ESP_OK;
+}
+
+esp_err_t ha_entity_icons_refresh(void)
+{
+  int entity_count = ha_registry_count();
+  if (entity_count == 0)
+  {
+    return ESP_OK;
+  }
+
+  cJSON *ids = cJSON_CreateStringArray(ha_registry_entity_ids(), entity_count);
+  char *ids_string = ids ? cJSON_PrintUnformatted(ids) : NULL;
+  cJSON_Delete(ids);
+  if (!ids_string)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+  size_t template_len = strlen(ICONS_TEMPLATE_HEAD) + strlen(ids_string) + strlen(ICONS_TEMPLATE_TAIL) + 1;
+  char *template_string = malloc(template_len);
+  if (!template_string)
+  {
+    free(ids_string);
+    return ESP_ERR_NO_MEM;
+  }
+  snprintf(template_string, template_len, "%s%s%s", ICONS_TEMPLATE_HEAD, ids_string, ICONS_TEMPLATE_TAIL);
+  free(ids_string);
+
+  ha_api_response_t response = {0};
+  esp_err_t err = ha_api_render_template_cached(template_string, &response);
+  free(template_string);
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Entity icons not fetched: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // The icons loaded from NVS were parsed from this very reply
+  if (response.unchanged && icons_generation != 0)
+  {
+    ha_api_free_response(&response);
+    debug_log_debug(DEBUG_TAG_SMART_HOME, "Entity icons unchanged");
+    return ESP_OK;
+  }
+
+  icons_blob_t *blob = malloc(sizeof(icons_blob_t));
+  if (!blob)
+  {
+    ha_api_free_response(&response);
+    return ESP_ERR_NO_MEM;
+  }
+
+  int count = response.response_data ? parse_icons(response.response_data, response.response_len, blob->items) : -1;
+  ha_api_free_response(&response);
+  if (count < 0)
+  {
+    free(blob);
+    debug_log_error(DEBUG_TAG_SMART_HOME, "Entity icon template reply is not a JSON array");
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  if (publish_icons(blob->items, count))
+  {
+    blob->version = ICONS_BLOB_VERSION;
+    blob->count = (uint8_t)count;
+    nvs_store_set(ICONS_NVS_NAMESPACE, ICONS_NVS_KEY, blob, ICONS_BLOB_SIZE(count), ICONS_SAVE_DELAY_MS);
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "Entity icons: %d entities from HA", count);
+  }
+
+  free(blob);
+  return ESP_OK;
+}
+
+bool ha_entity_icons_get(int index, char *icon, size_t size)
+{
+  if (index < 0 || index >= HA_REGISTRY_MAX_ENTITIES || !icon || size == 0)
+    return false;
+
+  portENTER_CRITICAL(&icons_lock);
+  strlcpy(icon, icons[index], size);
+  portEXIT_CRITICAL(&icons_lock);
+  return icon[0] != '\0';
+}
+
+uint32_t ha_entity_icons_generation(void)
+{
+  return icons_generation;
+}
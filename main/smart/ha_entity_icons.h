@@ -0,0 +1,73 @@
+/**
+ * @file ha_entity_icons.h
+ * @brief HA icon names of the registry entities, cached in NVS
+ *
+ * The "icon" attribute of every registered entity (e.g. mdi:water-pump)
+ * is read in one template query after the first sync of each boot, next
+ * to the scene and script metadata, and kept in NVS with the entity IDs
+ * it belongs to. The controls panel draws the matching icon from the
+ * asset pack icon atlas at startup, before the network is up. Entities
+ * without a custom icon in HA have none here and keep their domain icon.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_ENTITY_ICONS_H
+#define HA_ENTITY_ICONS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Icon name including terminator, without the "mdi:" prefix; longer names have no atlas icon either */
+#define HA_ENTITY_ICON_LEN 28
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the cached icon names for the current registry
+   * @return ESP_OK, also when nothing is cached yet
+   * @note Call once after ha_registry_init() and before the UI is created
+   */
+  esp_err_t ha_entity_icons_init(void);
+
+  /**
+   * @brief Fetch the icon attributes of all registered entities in one template query
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if HA refuses templates, or the
+   *         request or parse error; the cached names are kept on error
+   * @note Blocks on HTTP, call from the sync task
+   */
+  esp_err_t ha_entity_icons_refresh(void);
+
+  /**
+   * @brief Icon name of a registry entity
+   * @param index Registry index
+   * @param icon Output, at least HA_ENTITY_ICON_LEN bytes
+   * @return true if the entity has an mdi icon
+   * @note Safe from any task
+   */
+  bool ha_entity_icons_get(int index, char *icon, size_t size);
+
+  /**
+   * @brief Counter bumped whenever a name changes, for cheap polling
+   */
+  uint32_t ha_entity_icons_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_ENTITY_ICONS_H
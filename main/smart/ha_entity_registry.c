@@ -0,0 +1,454 @@
+/**
+ * @file ha_entity_registry.c
+ * @brief Home Assistant Entity Registry Implementation
+ *
+ * The live table is filled once by ha_registry_init() and never changes
+ * afterwards, so readers on any task index it without locking. Serial
+ * edits work on the stored copy in NVS only.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ha_entity_registry.h"
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "entity_states_parser.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define REGISTRY_NVS_NAMESPACE "ha_registry"
+#define REGISTRY_NVS_KEY "entities"
+#define REGISTRY_BLOB_VERSION 1
+#define REGISTRY_PACK_ASSET "config/entities" ///< Defaults from the asset pack
+
+// Edits made in a row are stored together, a restart writes them right away
+#define REGISTRY_SAVE_DELAY_MS 5000
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief NVS layout, only the first count records are written
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t count;
+  ha_entity_record_t records[HA_REGISTRY_MAX_ENTITIES];
+} registry_blob_t;
+
+#define REGISTRY_BLOB_SIZE(count) (offsetof(registry_blob_t, records) + (size_t)(count) * sizeof(ha_entity_record_t))
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static const char *const domain_names[HA_DOMAIN_COUNT] = {
+    "switch", "light", "sensor", "binary_sensor", "climate", "scene", "other"};
+
+static ha_entity_record_t entities[HA_REGISTRY_MAX_ENTITIES];
+static const char *entity_ids[HA_REGISTRY_MAX_ENTITIES];
+static int entity_count = 0;
+static entity_lookup_t entity_index;
+static bool restart_needed = false; ///< Stored registry differs from the live one
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static ha_entity_domain_t domain_from_entity_id(const char *entity_id)
+{
+  const char *dot = strchr(entity_id, '.');
+  size_t len = dot ? (size_t)(dot - entity_id) : 0;
+
+  for (int i = 0; i < HA_DOMAIN_OTHER; i++)
+  {
+    if (strlen(domain_names[i]) == len && strncmp(entity_id, domain_names[i], len) == 0)
+      return (ha_entity_domain_t)i;
+  }
+  return HA_DOMAIN_OTHER;
+}
+
+/**
+ * @brief HA entity IDs are "<domain>.<object_id>" in lowercase, digits and '_'
+ */
+static bool is_valid_entity_id(const char *entity_id)
+{
+  size_t len = strlen(entity_id);
+  const char *dot = strchr(entity_id, '.');
+  if (len == 0 || len >= HA_MAX_ENTITY_ID_LEN || !dot || dot == entity_id || dot[1] == '\0')
+    return false;
+
+  for (const char *p = entity_id; *p; p++)
+  {
+    if (!(islower((unsigned char)*p) || isdigit((unsigned char)*p) || *p == '_' || (p == dot)))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Labels end up in JSON replies unescaped, keep them printable
+ */
+static bool is_valid_label(const char *label)
+{
+  for (const char *p = label; *p; p++)
+  {
+    if (*p == '"' || *p == '\\' || (unsigned char)*p < 0x20)
+      return false;
+  }
+  return true;
+}
+
+static void fill_record(ha_entity_record_t *record, const char *entity_id, const char *label)
+{
+  memset(record, 0, sizeof(*record));
+  strlcpy(record->entity_id, entity_id, sizeof(record->entity_id));
+  if (!label || label[0] == '\0')
+  {
+    // Object id is a readable enough default
+    label = strchr(entity_id, '.') + 1;
+  }
+  strlcpy(record->label, label, sizeof(record->label));
+  record->domain = domain_from_entity_id(entity_id);
+}
+
+/**
+ * @brief Defaults from the asset pack, one "entity_id,label" per line
+ * @return true if the pack had at least one valid entity
+ */
+static bool load_pack_defaults(registry_blob_t *blob)
+{
+  asset_t asset;
+  if (!asset_pack_find(REGISTRY_PACK_ASSET, ASSET_TYPE_BLOB, &asset))
+    return false;
+
+  const char *p = asset.data;
+  const char *end = p + asset.size;
+  while (p < end && blob->count < HA_REGISTRY_MAX_ENTITIES)
+  {
+    const char *nl = memchr(p, '\n', end - p);
+    const char *line_end = nl ? nl : end;
+    size_t len = (size_t)(line_end - p);
+    if (len > 0 && line_end[-1] == '\r')
+      len--;
+
+    char line[HA_MAX_ENTITY_ID_LEN + HA_REGISTRY_LABEL_LEN + 1];
+    bool fits = len > 0 && len < sizeof(line);
+    if (fits)
+    {
+      memcpy(line, p, len);
+      line[len] = '\0';
+    }
+    p = nl ? nl + 1 : end;
+    if (!fits || line[0] == '#')
+      continue;
+
+    char *comma = strchr(line, ',');
+    const char *label = NULL;
+    if (comma)
+    {
+      *comma = '\0';
+      label = comma + 1;
+    }
+    if (!is_valid_entity_id(line) || (label && (!is_valid_label(label) || strlen(label) >= HA_REGISTRY_LABEL_LEN)))
+    {
+      debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Skipping asset pack entity line: %.40s", line);
+      continue;
+    }
+    fill_record(&blob->records[blob->count++], line, label);
+  }
+  return blob->count > 0;
+}
+
+static void load_defaults(registry_blob_t *blob)
+{
+  memset(blob, 0, sizeof(*blob));
+  blob->version = REGISTRY_BLOB_VERSION;
+  if (load_pack_defaults(blob))
+    return;
+  fill_record(&blob->records[blob->count++], HA_ENTITY_A_ID, HA_ENTITY_A_LABEL);
+  fill_record(&blob->records[blob->count++], HA_ENTITY_B_ID, HA_ENTITY_B_LABEL);
+  fill_record(&blob->records[blob->count++], HA_ENTITY_C_ID, HA_ENTITY_C_LABEL);
+  fill_record(&blob->records[blob->count++], HA_ENTITY_D_ID, HA_ENTITY_D_LABEL);
+}
+
+/**
+ * @brief Read the stored registry
+ * @return ESP_OK, ESP_ERR_NVS_NOT_FOUND if nothing is stored, or an NVS error
+ */
+static esp_err_t load_blob(registry_blob_t *blob)
+{
+  size_t size = sizeof(*blob);
+  esp_err_t err = nvs_store_get(REGISTRY_NVS_NAMESPACE, REGISTRY_NVS_KEY, blob, &size);
+  if (err != ESP_OK)
+    return err;
+
+  if (size < offsetof(registry_blob_t, records) || blob->version != REGISTRY_BLOB_VERSION ||
+      blob->count > HA_REGISTRY_MAX_ENTITIES || size != REGISTRY_BLOB_SIZE(blob->count))
+  {
+    debug_log_warning(DEBUG_TAG_SMART_HOME, "Stored entity registry has an unknown layout, ignoring it");
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Never trust flash contents to be terminated
+  for (int i = 0; i < blob->count; i++)
+  {
+    blob->records[i].entity_id[HA_MAX_ENTITY_ID_LEN - 1] = '\0';
+    blob->records[i].label[HA_REGISTRY_LABEL_LEN - 1] = '\0';
+    if (blob->records[i].domain >= HA_DOMAIN_COUNT)
+      blob->records[i].domain = HA_DOMAIN_OTHER;
+  }
+  return ESP_OK;
+}
+
+static esp_err_t save_blob(const registry_blob_t *blob)
+{
+  return nvs_store_set(REGISTRY_NVS_NAMESPACE, REGISTRY_NVS_KEY, blob, REGISTRY_BLOB_SIZE(blob->count),
+                       REGISTRY_SAVE_DELAY_MS);
+}
+
+static esp_err_t erase_blob(void)
+{
+  return nvs_store_erase(REGISTRY_NVS_NAMESPACE, REGISTRY_NVS_KEY, REGISTRY_SAVE_DELAY_MS);
+}
+
+static void reply(const char *text)
+{
+  serial_data_write(text, strlen(text));
+}
+
+static void reply_error(const char *message)
+{
+  char buf[112];
+  int len = snprintf(buf, sizeof(buf), "HA_ENTITY {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+static void reply_list(void)
+{
+  char buf[160];
+  reply("HA_ENTITIES {\"entities\":[");
+  for (int i = 0; i < entity_count; i++)
+  {
+    int len = snprintf(buf, sizeof(buf), "%s{\"id\":\"%s\",\"label\":\"%s\",\"domain\":\"%s\"}", i ? "," : "",
+                       entities[i].entity_id, entities[i].label, domain_names[entities[i].domain]);
+    serial_data_write(buf, len);
+  }
+  int len = snprintf(buf, sizeof(buf), "],\"restart_needed\":%s}\n", restart_needed ? "true" : "false");
+  serial_data_write(buf, len);
+}
+
+/**
+ * @brief Apply an add or delete to the stored registry
+ * @param entity_id Entity to add or remove
+ * @param label Label for an add, NULL to remove
+ */
+static void edit_stored_registry(const char *entity_id, const char *label)
+{
+  if (!is_valid_entity_id(entity_id))
+  {
+    reply_error("invalid entity_id");
+    return;
+  }
+  if (label && !is_valid_label(label))
+  {
+    reply_error("invalid label");
+    return;
+  }
+
+  registry_blob_t *blob = malloc(sizeof(registry_blob_t));
+  if (!blob)
+  {
+    reply_error("no memory");
+    return;
+  }
+  if (load_blob(blob) != ESP_OK)
+  {
+    // First edit starts from what is running
+    memset(blob, 0, sizeof(*blob));
+    blob->version = REGISTRY_BLOB_VERSION;
+    blob->count = entity_count;
+    memcpy(blob->records, entities, entity_count * sizeof(ha_entity_record_t));
+  }
+
+  int found = -1;
+  for (int i = 0; i < blob->count; i++)
+  {
+    if (strcmp(blob->records[i].entity_id, entity_id) == 0)
+    {
+      found = i;
+      break;
+    }
+  }
+
+  const char *error = NULL;
+  if (label)
+  {
+    if (found >= 0)
+      fill_record(&blob->records[found], entity_id, label);
+    else if (blob->count >= HA_REGISTRY_MAX_ENTITIES)
+      error = "registry full";
+    else
+      fill_record(&blob->records[blob->count++], entity_id, label);
+  }
+  else if (found < 0)
+  {
+    error = "not registered";
+  }
+  else
+  {
+    memmove(&blob->records[found], &blob->records[found + 1],
+            (blob->count - found - 1) * sizeof(ha_entity_record_t));
+    blob->count--;
+  }
+
+  if (!error && save_blob(blob) != ESP_OK)
+    error = "nvs store full";
+  free(blob);
+
+  if (error)
+  {
+    reply_error(error);
+    return;
+  }
+
+  restart_needed = true;
+  reply("HA_ENTITY OK restart to apply\n");
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_registry_init(void)
+{
+  registry_blob_t *blob = malloc(sizeof(registry_blob_t));
+  if (!blob)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_err_t err = load_blob(blob);
+  if (err != ESP_OK)
+  {
+    if (err != ESP_ERR_NVS_NOT_FOUND)
+    {
+      debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Entity registry not loaded: %s", esp_err_to_name(err));
+    }
+    load_defaults(blob);
+  }
+
+  entity_count = blob->count;
+  memcpy(entities, blob->records, entity_count * sizeof(ha_entity_record_t));
+  free(blob);
+
+  for (int i = 0; i < entity_count; i++)
+  {
+    entity_ids[i] = entities[i].entity_id;
+  }
+  entity_lookup_build(&entity_index, entity_ids, entity_count);
+
+  debug_log_info_f(DEBUG_TAG_SMART_HOME, "Entity registry: %d entities (%s)", entity_count,
+                   err == ESP_OK ? "stored" : "defaults");
+  return ESP_OK;
+}
+
+int ha_registry_count(void)
+{
+  return entity_count;
+}
+
+const ha_entity_record_t *ha_registry_get(int index)
+{
+  if (index < 0 || index >= entity_count)
+    return NULL;
+  return &entities[index];
+}
+
+const char *const *ha_registry_entity_ids(void)
+{
+  return entity_ids;
+}
+
+int ha_registry_find(const char *entity_id)
+{
+  if (!entity_id || entity_count == 0)
+    return -1;
+  return entity_lookup_find(&entity_index, entity_id);
+}
+
+bool ha_registry_is_toggle(ha_entity_domain_t domain)
+{
+  return domain == HA_DOMAIN_SWITCH || domain == HA_DOMAIN_LIGHT;
+}
+
+bool ha_registry_is_sensor(ha_entity_domain_t domain)
+{
+  return domain == HA_DOMAIN_SENSOR || domain == HA_DOMAIN_BINARY_SENSOR;
+}
+
+const char *ha_registry_domain_name(ha_entity_domain_t domain)
+{
+  return domain < HA_DOMAIN_COUNT ? domain_names[domain] : domain_names[HA_DOMAIN_OTHER];
+}
+
+bool ha_registry_handle_command(const char *line)
+{
+  if (strcmp(line, "HA_ENTITIES") == 0)
+  {
+    reply_list();
+    return true;
+  }
+
+  if (strcmp(line, "HA_ENTITY_RESET") == 0)
+  {
+    if (erase_blob() != ESP_OK)
+    {
+      reply_error("nvs store full");
+      return true;
+    }
+    restart_needed = true;
+    reply("HA_ENTITY OK restart to apply\n");
+    return true;
+  }
+
+  // HA_ENTITY_ADD <entity_id> [label...] / HA_ENTITY_DEL <entity_id>
+  static const char add_command[] = "HA_ENTITY_ADD ";
+  static const char del_command[] = "HA_ENTITY_DEL ";
+  bool is_add = strncmp(line, add_command, sizeof(add_command) - 1) == 0;
+  bool is_del = strncmp(line, del_command, sizeof(del_command) - 1) == 0;
+  if (!is_add && !is_del)
+    return false;
+
+  char entity_id[HA_MAX_ENTITY_ID_LEN] = "";
+  int consumed = 0;
+  if (sscanf(line + sizeof(add_command) - 1, "%63s%n", entity_id, &consumed) != 1)
+  {
+    reply_error("usage: HA_ENTITY_ADD <entity_id> [label] | HA_ENTITY_DEL <entity_id>");
+    return true;
+  }
+
+  const char *label = NULL;
+  if (is_add)
+  {
+    label = line + sizeof(add_command) - 1 + consumed;
+    while (*label == ' ')
+      label++;
+  }
+  edit_stored_registry(entity_id, label);
+  return true;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file ha_entity_registry.h
+ * @brief Home Assistant Entity Registry
+ *
+ * Runtime list of the entities shown on the dashboard, loaded from NVS at
+ * boot and falling back to the entities in smart_config.h. Every other
+ * module refers to an entity by its registry index, so sync, push updates,
+ * commands and UI widgets dispatch without string compare chains.
+ *
+ * The registry is edited over the serial port (HA_ENTITY_* commands). Edits
+ * are stored right away and take effect after the next restart, because
+ * the controls panel builds its widgets once at startup.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HA_ENTITY_REGISTRY_H
+#define HA_ENTITY_REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ha_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Entities the registry holds, also the size of every per-entity table */
+#define HA_REGISTRY_MAX_ENTITIES 32
+
+  /** Display label including terminator */
+#define HA_REGISTRY_LABEL_LEN 24
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Entity domain, taken from the entity_id prefix
+   */
+  typedef enum
+  {
+    HA_DOMAIN_SWITCH = 0,
+    HA_DOMAIN_LIGHT,
+    HA_DOMAIN_SENSOR,
+    HA_DOMAIN_BINARY_SENSOR,
+    HA_DOMAIN_CLIMATE,
+    HA_DOMAIN_SCENE,
+    HA_DOMAIN_OTHER,
+    HA_DOMAIN_COUNT
+  } ha_entity_domain_t;
+
+  /**
+   * @brief One registered entity, stored in NVS as is
+   */
+  typedef struct
+  {
+    char entity_id[HA_MAX_ENTITY_ID_LEN]; ///< e.g. "switch.pump"
+    char label[HA_REGISTRY_LABEL_LEN];    ///< Text shown on the panel
+    uint8_t domain;                       ///< ha_entity_domain_t
+  } ha_entity_record_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the registry from NVS, or the smart_config.h defaults
+   * @return ESP_OK on success (defaults count as success)
+   * @note Call once after nvs_flash_init() and before the UI is created
+   */
+  esp_err_t ha_registry_init(void);
+
+  /**
+   * @brief Number of registered entities
+   */
+  int ha_registry_count(void);
+
+  /**
+   * @brief Get an entity by index
+   * @return Record, NULL if index is out of range
+   */
+  const ha_entity_record_t *ha_registry_get(int index);
+
+  /**
+   * @brief Entity IDs in index order, for bulk requests and subscriptions
+   * @return Array of ha_registry_count() entity IDs
+   */
+  const char *const *ha_registry_entity_ids(void);
+
+  /**
+   * @brief Find an entity by ID through the hash index
+   * @return Registry index, -1 if the entity is not registered
+   */
+  int ha_registry_find(const char *entity_id);
+
+  /**
+   * @brief Whether the domain is driven by turn_on/turn_off and shown as a switch
+   */
+  bool ha_registry_is_toggle(ha_entity_domain_t domain);
+
+  /**
+   * @brief Whether the domain is a read-only sensor, shown as a tile and fed by pushes
+   */
+  bool ha_registry_is_sensor(ha_entity_domain_t domain);
+
+  /**
+   * @brief Domain name as used in entity IDs and service calls
+   */
+  const char *ha_registry_domain_name(ha_entity_domain_t domain);
+
+  /**
+   * @brief Handle HA_ENTITIES / HA_ENTITY_ADD / HA_ENTITY_DEL / HA_ENTITY_RESET
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a registry command
+   */
+  bool ha_registry_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_ENTITY_REGISTRY_H
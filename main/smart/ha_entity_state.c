@@ -0,0 +1,336 @@
+/**
+ * @file ha_entity_state.c
+ * @brief Compact typed Home Assistant entity state
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ha_entity_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+/** Hash slots for the pool, power of two and about twice the atom count */
+#define ATOM_HASH_SLOTS 256
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Strings are appended and never removed, so a handle stays valid forever
+static char atom_pool[HA_ATOM_POOL_SIZE];
+static size_t atom_pool_used = 0;
+static uint16_t atom_offsets[HA_ATOM_MAX_COUNT + 1]; ///< Indexed by handle, slot 0 unused
+static uint16_t atom_count = 0;
+static uint8_t atom_slots[ATOM_HASH_SLOTS]; ///< Handle per slot, HA_ATOM_NONE if empty
+static bool atom_pool_full_logged = false;
+static portMUX_TYPE atom_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief FNV-1a over at most len bytes
+ */
+static uint32_t atom_hash(const char *text, size_t len)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= (uint8_t)text[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static bool atom_equals(ha_atom_t atom, const char *text, size_t len)
+{
+  const char *stored = &atom_pool[atom_offsets[atom]];
+  return strncmp(stored, text, len) == 0 && stored[len] == '\0';
+}
+
+/**
+ * @brief Parse exactly count decimal digits
+ * @return Value, -1 if a character is not a digit
+ */
+static int parse_digits(const char *text, int count)
+{
+  int value = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (text[i] < '0' || text[i] > '9')
+      return -1;
+    value = value * 10 + (text[i] - '0');
+  }
+  return value;
+}
+
+/**
+ * @brief Days since 1970-01-01 of a proleptic Gregorian date
+ */
+static int64_t days_from_civil(int year, int month, int day)
+{
+  year -= month <= 2;
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  int64_t year_of_era = year - era * 400;
+  int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+ha_atom_t ha_atom_intern(const char *text)
+{
+  if (!text || text[0] == '\0')
+    return HA_ATOM_NONE;
+
+  size_t len = strnlen(text, HA_ATOM_MAX_LEN);
+  uint32_t slot = atom_hash(text, len) & (ATOM_HASH_SLOTS - 1);
+  ha_atom_t atom = HA_ATOM_NONE;
+  bool pool_full = false;
+
+  portENTER_CRITICAL(&atom_lock);
+  while (atom_slots[slot] != HA_ATOM_NONE && !atom_equals(atom_slots[slot], text, len))
+  {
+    slot = (slot + 1) & (ATOM_HASH_SLOTS - 1);
+  }
+
+  if (atom_slots[slot] != HA_ATOM_NONE)
+  {
+    atom = atom_slots[slot];
+  }
+  else if (atom_count < HA_ATOM_MAX_COUNT && atom_pool_used + len + 1 <= sizeof(atom_pool))
+  {
+    atom = ++atom_count;
+    atom_offsets[atom] = (uint16_t)atom_pool_used;
+    memcpy(&atom_pool[atom_pool_used], text, len);
+    atom_pool[atom_pool_used + len] = '\0';
+    atom_pool_used += len + 1;
+    atom_slots[slot] = (uint8_t)atom;
+  }
+  else if (!atom_pool_full_logged)
+  {
+    atom_pool_full_logged = true;
+    pool_full = true;
+  }
+  portEXIT_CRITICAL(&atom_lock);
+
+  if (pool_full)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "String pool full (%u strings, %u bytes), new names and texts are dropped",
+                        (unsigned)atom_count, (unsigned)atom_pool_used);
+  }
+  return atom;
+}
+
+const char *ha_atom_str(ha_atom_t atom)
+{
+  if (atom == HA_ATOM_NONE || atom > atom_count)
+    return "";
+  return &atom_pool[atom_offsets[atom]];
+}
+
+void ha_entity_state_set(ha_entity_state_t *state, const char *state_text, const char *friendly_name,
+                         uint32_t last_changed)
+{
+  if (!state)
+    return;
+
+  memset(state, 0, sizeof(ha_entity_state_t));
+  state->found = true;
+  state->last_changed = last_changed;
+  state->friendly_name = ha_atom_intern(friendly_name);
+
+  if (!state_text || strcmp(state_text, "unknown") == 0 || state_text[0] == '\0')
+  {
+    state->kind = HA_STATE_UNKNOWN;
+  }
+  else if (strcmp(state_text, "on") == 0)
+  {
+    state->kind = HA_STATE_ON;
+    state->is_on = true;
+  }
+  else if (strcmp(state_text, "off") == 0)
+  {
+    state->kind = HA_STATE_OFF;
+  }
+  else if (strcmp(state_text, "unavailable") == 0)
+  {
+    state->kind = HA_STATE_UNAVAILABLE;
+  }
+  else
+  {
+    char *end = NULL;
+    float value = strtof(state_text, &end);
+    if (end != state_text && *end == '\0')
+    {
+      state->kind = HA_STATE_NUMERIC;
+      state->value = value;
+    }
+    else
+    {
+      state->kind = HA_STATE_TEXT;
+      state->text = ha_atom_intern(state_text);
+    }
+  }
+}
+
+void ha_entity_state_set_level(ha_entity_state_t *state, float level)
+{
+  if (!state || state->kind == HA_STATE_NUMERIC)
+    return;
+  state->value = level;
+  state->has_level = true;
+}
+
+bool ha_entity_state_read_attributes(ha_entity_state_t *state, const struct cJSON *attributes)
+{
+  if (state && state->kind == HA_STATE_NUMERIC)
+  {
+    const cJSON *unit = cJSON_GetObjectItem(attributes, "unit_of_measurement");
+    if (cJSON_IsString(unit))
+      state->text = ha_atom_intern(unit->valuestring);
+    return false;
+  }
+
+  // Lights report brightness only while on, thermostats temperature only in a heating or cooling mode
+  const cJSON *level = cJSON_GetObjectItem(attributes, "brightness");
+  if (!cJSON_IsNumber(level))
+    level = cJSON_GetObjectItem(attributes, "temperature");
+  if (!cJSON_IsNumber(level))
+    return false;
+
+  ha_entity_state_set_level(state, (float)level->valuedouble);
+  return state->has_level;
+}
+
+bool ha_entity_state_same(const ha_entity_state_t *a, const ha_entity_state_t *b)
+{
+  if (a->found != b->found || a->kind != b->kind || a->is_on != b->is_on || a->has_level != b->has_level)
+    return false;
+  if (a->kind == HA_STATE_NUMERIC || a->has_level)
+  {
+    if (a->value != b->value)
+      return false;
+  }
+  if (a->kind == HA_STATE_NUMERIC || a->kind == HA_STATE_TEXT)
+    return a->text == b->text;
+  return true;
+}
+
+const char *ha_entity_state_unit(const ha_entity_state_t *state)
+{
+  return (state && state->kind == HA_STATE_NUMERIC) ? ha_atom_str(state->text) : "";
+}
+
+int ha_entity_state_format(const ha_entity_state_t *state, char *buffer, size_t buffer_size)
+{
+  if (!state || !buffer || buffer_size == 0)
+    return 0;
+
+  switch (state->kind)
+  {
+  case HA_STATE_ON:
+    return snprintf(buffer, buffer_size, "on");
+  case HA_STATE_OFF:
+    return snprintf(buffer, buffer_size, "off");
+  case HA_STATE_UNAVAILABLE:
+    return snprintf(buffer, buffer_size, "unavailable");
+  case HA_STATE_NUMERIC:
+    return snprintf(buffer, buffer_size, "%g", (double)state->value);
+  case HA_STATE_TEXT:
+    return snprintf(buffer, buffer_size, "%s", ha_atom_str(state->text));
+  default:
+    return snprintf(buffer, buffer_size, "unknown");
+  }
+}
+
+int64_t ha_parse_timestamp_ms(const char *text)
+{
+  // YYYY-MM-DDTHH:MM:SS, then optional fraction and zone; fixed positions,
+  // no strptime()/mktime() and nothing read past the terminator
+  if (!text || strnlen(text, 19) < 19 || text[4] != '-' || text[7] != '-' || (text[10] != 'T' && text[10] != ' ') ||
+      text[13] != ':' || text[16] != ':')
+    return 0;
+
+  int year = parse_digits(text, 4);
+  int month = parse_digits(text + 5, 2);
+  int day = parse_digits(text + 8, 2);
+  int hour = parse_digits(text + 11, 2);
+  int minute = parse_digits(text + 14, 2);
+  int second = parse_digits(text + 17, 2);
+  if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 || minute < 0 ||
+      minute > 59 || second < 0 || second > 60)
+    return 0;
+
+  // Milliseconds from the first three fraction digits, HA sends six
+  const char *zone = text + 19;
+  int millis = 0;
+  if (*zone == '.')
+  {
+    zone++;
+    if (*zone < '0' || *zone > '9')
+      return 0;
+    for (int scale = 100; *zone >= '0' && *zone <= '9'; zone++, scale /= 10)
+      millis += (*zone - '0') * scale;
+  }
+
+  int64_t offset = 0;
+  if (*zone == '+' || *zone == '-')
+  {
+    int zone_hour = parse_digits(zone + 1, 2);
+    int zone_minute = (zone[3] == ':') ? parse_digits(zone + 4, 2) : parse_digits(zone + 3, 2);
+    if (zone_hour < 0 || zone_minute < 0)
+      return 0;
+    offset = (zone_hour * 60 + zone_minute) * 60;
+    if (*zone == '-')
+      offset = -offset;
+  }
+  else if (*zone != 'Z' && *zone != '\0')
+  {
+    return 0;
+  }
+
+  int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+  return seconds > 0 ? seconds * 1000 + millis : 0;
+}
+
+uint32_t ha_parse_timestamp(const char *text)
+{
+  int64_t ms = ha_parse_timestamp_ms(text);
+  return (ms / 1000 <= UINT32_MAX) ? (uint32_t)(ms / 1000) : 0;
+}
+
+int ha_format_age(uint32_t since, uint32_t now, char *buffer, size_t buffer_size)
+{
+  if (!buffer || buffer_size == 0)
+    return 0;
+  if (since == 0 || now == 0)
+  {
+    buffer[0] = '\0';
+    return 0;
+  }
+
+  // A clock slightly behind HA's reads as just now
+  uint32_t age = now > since ? now - since : 0;
+  if (age < 60)
+    return snprintf(buffer, buffer_size, "just now");
+  if (age < 3600)
+    return snprintf(buffer, buffer_size, "%lu min ago", (unsigned long)(age / 60));
+  if (age < 2 * 86400)
+    return snprintf(buffer, buffer_size, "%lu h ago", (unsigned long)(age / 3600));
+  return snprintf(buffer, buffer_size, "%lu d ago", (unsigned long)(age / 86400));
+}
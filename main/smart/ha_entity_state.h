@@ -0,0 +1,171 @@
+/**
+ * @file ha_entity_state.h
+ * @brief Compact typed Home Assistant entity state
+ *
+ * HA reports every state as a string. The dashboard only ever needs to know
+ * whether a toggle is on, a sensor's number, or a short mode text, so states
+ * are classified once when they arrive and stored in a 16-byte record. Lights
+ * and thermostats also carry one level: the brightness or target temperature.
+ * Friendly names and text states are interned: equal strings share one copy
+ * in a fixed pool and compare as integers.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HA_ENTITY_STATE_H
+#define HA_ENTITY_STATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct cJSON;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Bytes reserved for interned strings, terminators included */
+#define HA_ATOM_POOL_SIZE 2048
+
+  /** Distinct interned strings */
+#define HA_ATOM_MAX_COUNT 127
+
+  /** Longer strings are truncated before interning */
+#define HA_ATOM_MAX_LEN 48
+
+  /** Handle of no string */
+#define HA_ATOM_NONE 0
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /** Handle of an interned string, equal handles mean equal strings */
+  typedef uint16_t ha_atom_t;
+
+  /**
+   * @brief What an HA state string turned out to be
+   */
+  typedef enum
+  {
+    HA_STATE_UNKNOWN = 0, ///< "unknown" or never received
+    HA_STATE_OFF,
+    HA_STATE_ON,
+    HA_STATE_UNAVAILABLE,
+    HA_STATE_NUMERIC, ///< Number, see value
+    HA_STATE_TEXT     ///< Anything else, see text
+  } ha_state_kind_t;
+
+  /**
+   * @brief Home Assistant entity state
+   *
+   * Arrays of these are indexed like the entity ID list they were fetched
+   * for, so the record carries no entity ID of its own.
+   */
+  typedef struct
+  {
+    uint32_t last_changed;   ///< Unix time of the last state change, 0 if unknown
+    float value;             ///< Reading for HA_STATE_NUMERIC, else the level if has_level
+    ha_atom_t text;          ///< State text for HA_STATE_TEXT, unit of measurement for HA_STATE_NUMERIC
+    ha_atom_t friendly_name; ///< Human-readable name
+    uint8_t kind;            ///< ha_state_kind_t
+    bool found;              ///< Entity was present in the last fetch or push
+    bool is_on;              ///< Last real toggle position, kept across unavailable
+    bool has_level;          ///< value holds a light's brightness (0-255) or a climate setpoint
+  } ha_entity_state_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Intern a string
+   * @param text String to intern, truncated to HA_ATOM_MAX_LEN
+   * @return Handle, HA_ATOM_NONE for empty strings or once the pool is full
+   * @note Safe from any task; interned strings live until reboot
+   */
+  ha_atom_t ha_atom_intern(const char *text);
+
+  /**
+   * @brief Get the string behind a handle
+   * @return Interned string, "" for HA_ATOM_NONE or unknown handles
+   */
+  const char *ha_atom_str(ha_atom_t atom);
+
+  /**
+   * @brief Fill a state record from the strings HA sends
+   * @param state Record to fill, marked found
+   * @param state_text HA state string
+   * @param friendly_name Friendly name, NULL or "" if not reported
+   * @param last_changed Unix time of the change, 0 if not reported
+   */
+  void ha_entity_state_set(ha_entity_state_t *state, const char *state_text, const char *friendly_name,
+                           uint32_t last_changed);
+
+  /**
+   * @brief Attach a level to a non-numeric state
+   * @param state Record filled by ha_entity_state_set()
+   * @param level Brightness 0-255 for lights, target temperature for climate
+   * @note Ignored for HA_STATE_NUMERIC, whose value is the reading
+   */
+  void ha_entity_state_set_level(ha_entity_state_t *state, float level);
+
+  /**
+   * @brief Take the level and unit from an entity's attributes object
+   * @param state Record filled by ha_entity_state_set()
+   * @param attributes HA attributes, "brightness" is used before "temperature" as the level and
+   *        "unit_of_measurement" for numeric states; may be NULL
+   * @return true if a level was found
+   */
+  bool ha_entity_state_read_attributes(ha_entity_state_t *state, const struct cJSON *attributes);
+
+  /**
+   * @brief Unit of a numeric state, e.g. "°C"
+   * @return Interned unit, "" if none was reported or the state is not numeric
+   */
+  const char *ha_entity_state_unit(const ha_entity_state_t *state);
+
+  /**
+   * @brief Whether two records show the same thing (timestamps ignored)
+   */
+  bool ha_entity_state_same(const ha_entity_state_t *a, const ha_entity_state_t *b);
+
+  /**
+   * @brief Render the state as HA would report it
+   * @return Characters written, excluding the terminator
+   */
+  int ha_entity_state_format(const ha_entity_state_t *state, char *buffer, size_t buffer_size);
+
+  /**
+   * @brief Parse an ISO 8601 timestamp such as "2025-08-19T10:20:30.123456+00:00"
+   * @return Unix time in milliseconds, 0 if the text is not a timestamp
+   * @note Fixed layout as HA writes it, no locale, no allocation
+   */
+  int64_t ha_parse_timestamp_ms(const char *text);
+
+  /**
+   * @brief ha_parse_timestamp_ms() in whole seconds, as last_changed keeps it
+   * @return Unix time, 0 if the text is not a timestamp
+   */
+  uint32_t ha_parse_timestamp(const char *text);
+
+  /**
+   * @brief Age of a change for a badge: "just now", "3 min ago", "5 h ago", "2 d ago"
+   * @param since Unix time of the change, e.g. last_changed
+   * @param now Current Unix time
+   * @return Characters written, 0 with an empty string if either time is unknown
+   */
+  int ha_format_age(uint32_t since, uint32_t now, char *buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_ENTITY_STATE_H
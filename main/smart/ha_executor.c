@@ -0,0 +1,291 @@
+/**
+ * @file ha_executor.c
+ * @brief Home Assistant Command Executor Implementation
+ *
+ * A single worker drains the queue in order, so commands for the same
+ * entity reach Home Assistant in the order they were issued. Switch commands
+ * open a short coalescing window; a newer command for the same entity that
+ * arrives inside it replaces the older one in the batch.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ha_executor.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "ha_mqtt.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "task_stack.h"
+#include "wifi_power_policy.h"
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static QueueHandle_t command_queue = NULL;
+static TaskHandle_t worker_task_handle = NULL;
+static ha_command_done_callback_t command_done_callback = NULL;
+static uint32_t next_seq = 1;
+static portMUX_TYPE seq_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Perform one command with the blocking REST client
+ */
+static esp_err_t execute_command(const ha_command_t *command)
+{
+  switch (command->type)
+  {
+  case HA_COMMAND_SWITCH:
+  {
+    // Routed switches go straight to the device, REST is the fallback
+    if (ha_mqtt_publish_switch(command->entity_id, command->turn_on) == ESP_OK)
+      return ESP_OK;
+
+    // The service domain is the entity_id prefix, e.g. light.turn_on
+    ha_service_call_t toggle_call = {0};
+    const char *dot = strchr(command->entity_id, '.');
+    size_t domain_len = dot ? (size_t)(dot - command->entity_id) : 0;
+    if (domain_len == 0 || domain_len >= sizeof(toggle_call.domain))
+      return ESP_ERR_INVALID_ARG;
+
+    memcpy(toggle_call.domain, command->entity_id, domain_len);
+    strlcpy(toggle_call.service, command->turn_on ? "turn_on" : "turn_off", sizeof(toggle_call.service));
+    strncpy(toggle_call.entity_id, command->entity_id, sizeof(toggle_call.entity_id) - 1);
+    return ha_api_call_service(&toggle_call, NULL);
+  }
+
+  case HA_COMMAND_SCENE:
+  {
+    // script.turn_on starts the script and returns without waiting for it
+    ha_service_call_t scene_call = {.service = "turn_on"};
+    strlcpy(scene_call.domain, strncmp(command->entity_id, "script.", 7) == 0 ? "script" : "scene",
+            sizeof(scene_call.domain));
+    strncpy(scene_call.entity_id, command->entity_id, sizeof(scene_call.entity_id) - 1);
+    return ha_api_call_service(&scene_call, NULL);
+  }
+
+  case HA_COMMAND_EVENT:
+    return ha_api_fire_event(command->entity_id, command->event_data);
+
+  case HA_COMMAND_LEVEL:
+  {
+    ha_service_call_t level_call = {0};
+    strncpy(level_call.entity_id, command->entity_id, sizeof(level_call.entity_id) - 1);
+    if (strncmp(command->entity_id, "light.", 6) == 0)
+    {
+      strlcpy(level_call.domain, "light", sizeof(level_call.domain));
+      if (command->level <= 0)
+      {
+        strlcpy(level_call.service, "turn_off", sizeof(level_call.service));
+        return ha_api_call_service(&level_call, NULL);
+      }
+      strlcpy(level_call.service, "turn_on", sizeof(level_call.service));
+      level_call.params[0] = (ha_service_param_t){
+          .key = "brightness", .type = HA_SERVICE_PARAM_INT, .value.i = (int32_t)(command->level + 0.5f)};
+      level_call.param_count = 1;
+    }
+    else if (strncmp(command->entity_id, "climate.", 8) == 0)
+    {
+      strlcpy(level_call.domain, "climate", sizeof(level_call.domain));
+      strlcpy(level_call.service, "set_temperature", sizeof(level_call.service));
+      level_call.params[0] = (ha_service_param_t){
+          .key = "temperature", .type = HA_SERVICE_PARAM_NUMBER, .value.number = command->level};
+      level_call.param_count = 1;
+    }
+    else
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+    return ha_api_call_service(&level_call, NULL);
+  }
+
+  default:
+    return ESP_ERR_INVALID_ARG;
+  }
+}
+
+/**
+ * @brief Add a command to the batch, replacing a stale switch or level command for the same entity
+ * @return Number of commands in the batch
+ */
+static int add_to_batch(ha_command_t *batch, int count, const ha_command_t *command)
+{
+  if (command->type == HA_COMMAND_SWITCH || command->type == HA_COMMAND_LEVEL)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      if (batch[i].type == command->type && strcmp(batch[i].entity_id, command->entity_id) == 0)
+      {
+        debug_log_debug_f(DEBUG_TAG_SMART_HOME, "Command #%lu for %s superseded by #%lu", batch[i].seq,
+                          command->entity_id, command->seq);
+        batch[i] = *command;
+        return count;
+      }
+    }
+  }
+
+  batch[count] = *command;
+  return count + 1;
+}
+
+/**
+ * @brief Collect commands arriving within the coalescing window
+ * @return Number of commands in the batch
+ */
+static int collect_batch(ha_command_t *batch, int count)
+{
+  TickType_t window = pdMS_TO_TICKS(HA_EXECUTOR_DEBOUNCE_MS);
+  TickType_t start = xTaskGetTickCount();
+  ha_command_t command;
+
+  while (count < HA_EXECUTOR_QUEUE_LENGTH)
+  {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= window)
+      break;
+    if (xQueueReceive(command_queue, &command, window - elapsed) != pdTRUE)
+      break;
+    count = add_to_batch(batch, count, &command);
+  }
+
+  return count;
+}
+
+static void worker_task(void *pvParameters)
+{
+  static ha_command_t batch[HA_EXECUTOR_QUEUE_LENGTH];
+
+  while (1)
+  {
+    if (xQueueReceive(command_queue, &batch[0], portMAX_DELAY) != pdTRUE)
+      continue;
+
+    // Wake the radio during the coalescing window rather than after it
+    wifi_power_policy_request_begin();
+
+    // Scenes and MQTT switches go out right away, other switches wait for the user to settle
+    int count = 1;
+    if (batch[0].type == HA_COMMAND_SWITCH && HA_EXECUTOR_DEBOUNCE_MS > 0 && !ha_mqtt_routes(batch[0].entity_id))
+    {
+      count = collect_batch(batch, count);
+    }
+    else if (batch[0].type == HA_COMMAND_LEVEL)
+    {
+      // Slider values queued behind a slow request are stale, only the newest is sent
+      ha_command_t command;
+      while (count < HA_EXECUTOR_QUEUE_LENGTH && xQueueReceive(command_queue, &command, 0) == pdTRUE)
+      {
+        count = add_to_batch(batch, count, &command);
+      }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+      int64_t start = esp_timer_get_time();
+      esp_err_t result = execute_command(&batch[i]);
+      debug_log_debug_f(DEBUG_TAG_SMART_HOME, "Command #%lu for %s done in %lld ms: %s", batch[i].seq,
+                        batch[i].entity_id, (esp_timer_get_time() - start) / 1000, esp_err_to_name(result));
+
+      if (command_done_callback)
+      {
+        command_done_callback(&batch[i], result);
+      }
+      free(batch[i].event_data);
+      batch[i].event_data = NULL;
+    }
+
+    wifi_power_policy_request_end();
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_executor_start(ha_command_done_callback_t done_callback)
+{
+  if (worker_task_handle)
+    return ESP_OK;
+
+  command_done_callback = done_callback;
+
+  if (!command_queue)
+  {
+    command_queue = xQueueCreate(HA_EXECUTOR_QUEUE_LENGTH, sizeof(ha_command_t));
+    if (!command_queue)
+    {
+      debug_log_error(DEBUG_TAG_SMART_HOME, "Failed to create command queue");
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  // Commands are HTTP requests only, the stack can live in PSRAM
+  if (task_plan_create(TASK_PLAN_HA_WORKER, worker_task, NULL, &worker_task_handle) != pdPASS)
+  {
+    debug_log_error(DEBUG_TAG_SMART_HOME, "Failed to create HA worker task");
+    return ESP_ERR_NO_MEM;
+  }
+
+  debug_log_startup(DEBUG_TAG_SMART_HOME, "HA Executor");
+  return ESP_OK;
+}
+
+void ha_executor_stop(void)
+{
+  if (worker_task_handle)
+  {
+    task_stack_delete(worker_task_handle);
+    worker_task_handle = NULL;
+  }
+
+  if (command_queue)
+  {
+    // Queued events own their data
+    ha_command_t command;
+    while (xQueueReceive(command_queue, &command, 0) == pdTRUE)
+    {
+      free(command.event_data);
+    }
+  }
+}
+
+esp_err_t ha_executor_submit(ha_command_t *command)
+{
+  if (!command)
+    return ESP_ERR_INVALID_ARG;
+  if (!command_queue || !worker_task_handle)
+    return ESP_ERR_INVALID_STATE;
+
+  if (command->seq == 0)
+  {
+    command->seq = ha_executor_next_seq();
+  }
+
+  // Never wait here, the caller may be the LVGL task
+  if (xQueueSend(command_queue, command, 0) != pdTRUE)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Command queue full, dropped command for %s", command->entity_id);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+uint32_t ha_executor_next_seq(void)
+{
+  portENTER_CRITICAL(&seq_lock);
+  uint32_t seq = next_seq++;
+  portEXIT_CRITICAL(&seq_lock);
+  return seq;
+}
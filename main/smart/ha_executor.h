@@ -0,0 +1,115 @@
+/**
+ * @file ha_executor.h
+ * @brief Home Assistant Command Executor
+ *
+ * Runs service calls (switch on/off, scenes, scripts) on a dedicated worker
+ * task so callers such as LVGL event handlers never wait on HTTP. Commands
+ * are queued and the outcome is reported through a completion callback.
+ * Switch commands are held for HA_EXECUTOR_DEBOUNCE_MS so a burst of
+ * toggles on one entity sends only the final state. Level commands are
+ * already rate limited by the panel and go out at once, a newer one for
+ * the same entity still queued replaces the older. Events carry their
+ * data on the heap; the executor owns it from a successful submit on.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HA_EXECUTOR_H
+#define HA_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ha_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Commands waiting for the worker */
+#define HA_EXECUTOR_QUEUE_LENGTH 8
+
+  /** Window in which switch commands for one entity are coalesced */
+#ifdef CONFIG_HA_COMMAND_DEBOUNCE_MS
+#define HA_EXECUTOR_DEBOUNCE_MS CONFIG_HA_COMMAND_DEBOUNCE_MS
+#else
+#define HA_EXECUTOR_DEBOUNCE_MS 250
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Kind of command
+   */
+  typedef enum
+  {
+    HA_COMMAND_SWITCH, ///< <domain>.turn_on / turn_off for switches and lights
+    HA_COMMAND_SCENE,  ///< scene.turn_on, or script.turn_on for script entities
+    HA_COMMAND_EVENT,  ///< POST /api/events/<entity_id>, entity_id holds the event type
+    HA_COMMAND_LEVEL,  ///< light.turn_on with brightness or climate.set_temperature
+  } ha_command_type_t;
+
+  /**
+   * @brief Queued service call
+   */
+  typedef struct
+  {
+    ha_command_type_t type;
+    char entity_id[HA_MAX_ENTITY_ID_LEN];
+    bool turn_on;  ///< Desired on/off state (HA_COMMAND_SWITCH)
+    float level;   ///< Brightness 0-255, 0 turns off, or target temperature (HA_COMMAND_LEVEL)
+    char *event_data; ///< malloc'd JSON object (HA_COMMAND_EVENT), freed by the executor
+    uint32_t seq;  ///< Caller's sequence tag, assigned on submit when left 0
+  } ha_command_t;
+
+  /**
+   * @brief Completion callback
+   * @param command Command that finished
+   * @param result ESP_OK if Home Assistant accepted it
+   * @note Runs in the worker task. Commands superseded inside the
+   *       coalescing window are dropped without a callback.
+   */
+  typedef void (*ha_command_done_callback_t)(const ha_command_t *command, esp_err_t result);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create the command queue and worker task
+   * @param done_callback Function receiving command outcomes (may be NULL)
+   * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue or task cannot be created
+   */
+  esp_err_t ha_executor_start(ha_command_done_callback_t done_callback);
+
+  /**
+   * @brief Stop the worker task and drop pending commands
+   */
+  void ha_executor_stop(void);
+
+  /**
+   * @brief Queue a command without blocking
+   * @param command Command to run, seq is filled in if 0
+   * @return ESP_OK if queued, ESP_ERR_INVALID_STATE if not started,
+   *         ESP_ERR_NO_MEM if the queue is full; on error event_data stays with the caller
+   */
+  esp_err_t ha_executor_submit(ha_command_t *command);
+
+  /**
+   * @brief Take the next sequence tag, for callers that track a command before submitting it
+   */
+  uint32_t ha_executor_next_seq(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_EXECUTOR_H
@@ -0,0 +1,516 @@
+/**
+ * @file ha_http_cache.c
+ * @brief Response cache for slow-changing Home Assistant metadata
+ *
+ * Each entry is one PSRAM allocation, header and body together, and is
+ * written to NVS as it is under its slot's key. Entries only go back to
+ * NVS when the body, the validators or the expiry changed.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_http_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "wifi_time_sync.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define CACHE_NVS_NAMESPACE "ha_http_cache"
+#define CACHE_RECORD_VERSION 1
+
+// Metadata comes in once per boot, there is no hurry
+#define CACHE_SAVE_DELAY_MS 5000
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief One entry, stored in NVS as is
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t body_hash;    ///< Of the POST body the reply answered
+  uint32_t content_hash; ///< Of body
+  uint32_t expires_at;   ///< Wall-clock seconds it is fresh until, 0 if stale at once
+  uint32_t body_len;
+  char url[HA_HTTP_CACHE_URL_LEN];
+  char etag[HA_HTTP_CACHE_ETAG_LEN];
+  char last_modified[HA_HTTP_CACHE_DATE_LEN];
+  char body[]; ///< body_len bytes and a terminator, the terminator is not stored
+} cache_record_t;
+
+#define CACHE_RECORD_SIZE(body_len) (sizeof(cache_record_t) + (size_t)(body_len))
+
+/**
+ * @brief Runtime state of a slot
+ */
+typedef struct
+{
+  cache_record_t *record; ///< NULL if empty
+  int64_t last_used_us;
+  uint32_t hits; ///< Served fresh, after a 304 or as an unchanged 200
+} cache_slot_t;
+
+typedef struct
+{
+  uint32_t fresh;        ///< Served without a request
+  uint32_t not_modified; ///< 304 answers
+  uint32_t unchanged;    ///< 200 answers with the cached body
+  uint32_t changed;      ///< 200 answers stored over an entry or into a new one
+  uint32_t misses;       ///< Lookups that found nothing
+  uint64_t bytes_saved;  ///< Body bytes not downloaded
+} cache_stats_t;
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static cache_slot_t slots[HA_HTTP_CACHE_ENTRIES];
+static cache_stats_t stats;
+static SemaphoreHandle_t cache_mutex = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static uint32_t fnv1a(uint32_t hash, const char *data, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= (uint8_t)data[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+static void slot_key(int index, char *key, size_t size)
+{
+  snprintf(key, size, "e%d", index);
+}
+
+/**
+ * @brief Slot of an exchange's URL and body, -1 if none; call with the mutex held
+ */
+static int find_slot(const ha_http_cache_exchange_t *exchange)
+{
+  for (int i = 0; i < HA_HTTP_CACHE_ENTRIES; i++)
+  {
+    const cache_record_t *record = slots[i].record;
+    if (record && record->body_hash == exchange->body_hash && strcmp(record->url, exchange->url) == 0)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Empty slot, or the least recently used one; call with the mutex held
+ */
+static int victim_slot(void)
+{
+  int victim = 0;
+  for (int i = 0; i < HA_HTTP_CACHE_ENTRIES; i++)
+  {
+    if (!slots[i].record)
+      return i;
+    if (slots[i].last_used_us < slots[victim].last_used_us)
+      victim = i;
+  }
+  return victim;
+}
+
+static bool is_fresh(const cache_record_t *record)
+{
+  return record->expires_at != 0 && wifi_time_sync_is_valid() && (uint32_t)time(NULL) < record->expires_at;
+}
+
+/**
+ * @brief Wall-clock expiry of a reply with these validators
+ *
+ * Validators without max-age mean the server wants to be asked each time;
+ * a reply with neither is HA's REST API, which gets the configured age.
+ */
+static uint32_t expiry_of(const ha_http_cache_validators_t *validators, bool has_validators)
+{
+  int32_t max_age = validators->max_age_s >= 0 ? validators->max_age_s : has_validators ? 0 : HA_HTTP_CACHE_MAX_AGE_S;
+  if (max_age <= 0 || !wifi_time_sync_is_valid())
+    return 0;
+  return (uint32_t)time(NULL) + (uint32_t)max_age;
+}
+
+static void persist_slot(int index)
+{
+  char key[8];
+  slot_key(index, key, sizeof(key));
+  const cache_record_t *record = slots[index].record;
+  if (record)
+    nvs_store_set(CACHE_NVS_NAMESPACE, key, record, CACHE_RECORD_SIZE(record->body_len), CACHE_SAVE_DELAY_MS);
+  else
+    nvs_store_erase(CACHE_NVS_NAMESPACE, key, CACHE_SAVE_DELAY_MS);
+}
+
+static void drop_slot(int index)
+{
+  free(slots[index].record);
+  slots[index].record = NULL;
+  slots[index].hits = 0;
+  persist_slot(index);
+}
+
+/**
+ * @brief Read one slot back from NVS
+ */
+static void load_slot(int index)
+{
+  char key[8];
+  slot_key(index, key, sizeof(key));
+  size_t size = 0;
+  if (nvs_store_get(CACHE_NVS_NAMESPACE, key, NULL, &size) != ESP_OK || size < sizeof(cache_record_t) ||
+      size > CACHE_RECORD_SIZE(HA_HTTP_CACHE_MAX_BODY))
+    return;
+
+  // One more byte for the terminator
+  cache_record_t *record = heap_caps_malloc(size + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!record)
+    return;
+  if (nvs_store_get(CACHE_NVS_NAMESPACE, key, record, &size) != ESP_OK || record->version != CACHE_RECORD_VERSION ||
+      CACHE_RECORD_SIZE(record->body_len) != size)
+  {
+    free(record);
+    return;
+  }
+
+  // Never trust flash contents to be terminated
+  record->url[HA_HTTP_CACHE_URL_LEN - 1] = '\0';
+  record->etag[HA_HTTP_CACHE_ETAG_LEN - 1] = '\0';
+  record->last_modified[HA_HTTP_CACHE_DATE_LEN - 1] = '\0';
+  record->body[record->body_len] = '\0';
+  slots[index].record = record;
+}
+
+/**
+ * @brief Copy a header value into a field, empty if it does not fit
+ */
+static void copy_validator(char *dest, const char *value, size_t size)
+{
+  if (strlcpy(dest, value, size) >= size)
+    dest[0] = '\0';
+}
+
+static void parse_cache_control(ha_http_cache_validators_t *validators, const char *value)
+{
+  const char *p = value;
+  while (*p)
+  {
+    while (*p == ' ' || *p == ',')
+      p++;
+    if (strncasecmp(p, "no-store", 8) == 0)
+      validators->no_store = true;
+    else if (strncasecmp(p, "no-cache", 8) == 0)
+      validators->max_age_s = 0;
+    else if (strncasecmp(p, "max-age=", 8) == 0 && validators->max_age_s != 0)
+      validators->max_age_s = (int32_t)strtol(p + 8, NULL, 10);
+    p = strchr(p, ',');
+    if (!p)
+      break;
+  }
+}
+
+static void reply(const char *buf, int len)
+{
+  serial_data_write(buf, len < 0 ? 0 : (size_t)len);
+}
+
+static void send_status(void)
+{
+  char buf[288];
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  cache_stats_t counters = stats;
+  xSemaphoreGive(cache_mutex);
+
+  reply(buf, snprintf(buf, sizeof(buf),
+                      "HTTP_CACHE {\"max_body\":%d,\"default_max_age_s\":%d,\"fresh\":%lu,\"not_modified\":%lu,"
+                      "\"unchanged\":%lu,\"changed\":%lu,\"misses\":%lu,\"bytes_saved\":%llu,\"entries\":[",
+                      HA_HTTP_CACHE_MAX_BODY, HA_HTTP_CACHE_MAX_AGE_S, (unsigned long)counters.fresh,
+                      (unsigned long)counters.not_modified, (unsigned long)counters.unchanged,
+                      (unsigned long)counters.changed, (unsigned long)counters.misses,
+                      (unsigned long long)counters.bytes_saved));
+
+  bool first = true;
+  for (int i = 0; i < HA_HTTP_CACHE_ENTRIES; i++)
+  {
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    const cache_record_t *record = slots[i].record;
+    int len = 0;
+    if (record)
+    {
+      int64_t fresh_s = is_fresh(record) ? (int64_t)record->expires_at - (int64_t)time(NULL) : 0;
+      len = snprintf(buf, sizeof(buf),
+                     "%s{\"url\":\"%s\",\"body_hash\":\"%08lx\",\"bytes\":%lu,\"etag\":%s,\"last_modified\":%s,"
+                     "\"fresh_s\":%lld,\"hits\":%lu}",
+                     first ? "" : ",", record->url, (unsigned long)record->body_hash, (unsigned long)record->body_len,
+                     record->etag[0] ? "true" : "false", record->last_modified[0] ? "true" : "false",
+                     (long long)fresh_s, (unsigned long)slots[i].hits);
+    }
+    xSemaphoreGive(cache_mutex);
+    if (len > 0)
+    {
+      reply(buf, len);
+      first = false;
+    }
+  }
+  serial_data_write("]}\n", 3);
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ha_http_cache_init(void)
+{
+#if CONFIG_HA_HTTP_CACHE
+  if (cache_mutex)
+    return ESP_OK;
+
+  cache_mutex = xSemaphoreCreateMutex();
+  if (!cache_mutex)
+    return ESP_ERR_NO_MEM;
+
+  int loaded = 0;
+  for (int i = 0; i < HA_HTTP_CACHE_ENTRIES; i++)
+  {
+    load_slot(i);
+    loaded += slots[i].record ? 1 : 0;
+  }
+  if (loaded > 0)
+    debug_log_info_f(DEBUG_TAG_HA_API, "HTTP cache: %d entries from NVS", loaded);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+ha_http_cache_result_t ha_http_cache_lookup(ha_http_cache_exchange_t *exchange, const char *url,
+                                            const char *post_data)
+{
+  memset(exchange, 0, sizeof(*exchange));
+  exchange->url = url;
+  exchange->body_hash = post_data ? fnv1a(FNV_OFFSET, post_data, strlen(post_data)) : 0;
+  exchange->sent.max_age_s = -1;
+  exchange->received.max_age_s = -1;
+  if (!cache_mutex || strlen(url) >= HA_HTTP_CACHE_URL_LEN)
+    return HA_HTTP_CACHE_MISS;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  ha_http_cache_result_t result = HA_HTTP_CACHE_MISS;
+  int index = find_slot(exchange);
+  if (index >= 0)
+  {
+    const cache_record_t *record = slots[index].record;
+    strlcpy(exchange->sent.etag, record->etag, sizeof(exchange->sent.etag));
+    strlcpy(exchange->sent.last_modified, record->last_modified, sizeof(exchange->sent.last_modified));
+    exchange->content_hash = record->content_hash;
+    exchange->body_len = record->body_len;
+    result = is_fresh(record) ? HA_HTTP_CACHE_FRESH : HA_HTTP_CACHE_STALE;
+    if (result == HA_HTTP_CACHE_FRESH)
+    {
+      stats.fresh++;
+      stats.bytes_saved += record->body_len;
+      slots[index].hits++;
+      slots[index].last_used_us = esp_timer_get_time();
+    }
+  }
+  else
+  {
+    stats.misses++;
+  }
+  xSemaphoreGive(cache_mutex);
+  return result;
+}
+
+int ha_http_cache_copy(const ha_http_cache_exchange_t *exchange, char *buf, size_t size)
+{
+  if (!cache_mutex || !buf)
+    return -1;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  int len = -1;
+  int index = find_slot(exchange);
+  const cache_record_t *record = index >= 0 ? slots[index].record : NULL;
+  if (record && record->content_hash == exchange->content_hash && record->body_len < size)
+  {
+    memcpy(buf, record->body, record->body_len + 1);
+    len = (int)record->body_len;
+  }
+  xSemaphoreGive(cache_mutex);
+  return len;
+}
+
+void ha_http_cache_on_header(ha_http_cache_exchange_t *exchange, const char *key, const char *value)
+{
+  if (!exchange || !key || !value)
+    return;
+
+  if (strcasecmp(key, "ETag") == 0)
+    copy_validator(exchange->received.etag, value, sizeof(exchange->received.etag));
+  else if (strcasecmp(key, "Last-Modified") == 0)
+    copy_validator(exchange->received.last_modified, value, sizeof(exchange->received.last_modified));
+  else if (strcasecmp(key, "Cache-Control") == 0)
+    parse_cache_control(&exchange->received, value);
+}
+
+void ha_http_cache_revalidated(const ha_http_cache_exchange_t *exchange)
+{
+  if (!cache_mutex)
+    return;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  int index = find_slot(exchange);
+  if (index >= 0)
+  {
+    cache_record_t *record = slots[index].record;
+    stats.not_modified++;
+    stats.bytes_saved += record->body_len;
+    slots[index].hits++;
+    slots[index].last_used_us = esp_timer_get_time();
+
+    // A 304 updates the validators it carries, the others stay
+    const ha_http_cache_validators_t *received = &exchange->received;
+    bool changed = false;
+    if (received->etag[0] && strcmp(received->etag, record->etag) != 0)
+    {
+      strlcpy(record->etag, received->etag, sizeof(record->etag));
+      changed = true;
+    }
+    if (received->last_modified[0] && strcmp(received->last_modified, record->last_modified) != 0)
+    {
+      strlcpy(record->last_modified, received->last_modified, sizeof(record->last_modified));
+      changed = true;
+    }
+    uint32_t expires_at = expiry_of(received, record->etag[0] || record->last_modified[0]);
+    if (expires_at != record->expires_at)
+    {
+      record->expires_at = expires_at;
+      changed = true;
+    }
+    if (changed)
+      persist_slot(index);
+  }
+  xSemaphoreGive(cache_mutex);
+}
+
+bool ha_http_cache_store(const ha_http_cache_exchange_t *exchange, const char *body, size_t len)
+{
+  if (!cache_mutex || !body || strlen(exchange->url) >= HA_HTTP_CACHE_URL_LEN)
+    return false;
+
+  const ha_http_cache_validators_t *received = &exchange->received;
+  bool has_validators = received->etag[0] || received->last_modified[0];
+  uint32_t content_hash = fnv1a(FNV_OFFSET, body, len);
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  int index = find_slot(exchange);
+  cache_record_t *record = index >= 0 ? slots[index].record : NULL;
+  bool unchanged = record && !received->no_store && record->content_hash == content_hash &&
+                   record->body_len == len && memcmp(record->body, body, len) == 0;
+
+  if (unchanged)
+  {
+    // Same bytes, only the validators and the expiry may have moved
+    stats.unchanged++;
+    slots[index].hits++;
+    slots[index].last_used_us = esp_timer_get_time();
+    uint32_t expires_at = expiry_of(received, has_validators);
+    if (strcmp(record->etag, received->etag) != 0 || strcmp(record->last_modified, received->last_modified) != 0 ||
+        record->expires_at != expires_at)
+    {
+      strlcpy(record->etag, received->etag, sizeof(record->etag));
+      strlcpy(record->last_modified, received->last_modified, sizeof(record->last_modified));
+      record->expires_at = expires_at;
+      persist_slot(index);
+    }
+  }
+  else if (received->no_store || len > HA_HTTP_CACHE_MAX_BODY)
+  {
+    if (record)
+      drop_slot(index);
+  }
+  else
+  {
+    cache_record_t *fresh = heap_caps_malloc(CACHE_RECORD_SIZE(len) + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (fresh)
+    {
+      memset(fresh, 0, sizeof(cache_record_t));
+      fresh->version = CACHE_RECORD_VERSION;
+      fresh->body_hash = exchange->body_hash;
+      fresh->content_hash = content_hash;
+      fresh->expires_at = expiry_of(received, has_validators);
+      fresh->body_len = (uint32_t)len;
+      strlcpy(fresh->url, exchange->url, sizeof(fresh->url));
+      strlcpy(fresh->etag, received->etag, sizeof(fresh->etag));
+      strlcpy(fresh->last_modified, received->last_modified, sizeof(fresh->last_modified));
+      memcpy(fresh->body, body, len);
+      fresh->body[len] = '\0';
+
+      if (index < 0)
+        index = victim_slot();
+      free(slots[index].record);
+      slots[index].record = fresh;
+      slots[index].hits = 0;
+      slots[index].last_used_us = esp_timer_get_time();
+      stats.changed++;
+      persist_slot(index);
+    }
+  }
+  xSemaphoreGive(cache_mutex);
+  return unchanged;
+}
+
+bool ha_http_cache_handle_command(const char *line)
+{
+  bool status = strcmp(line, "GET_HTTP_CACHE") == 0;
+  bool clear = strcmp(line, "HTTP_CACHE_CLEAR") == 0;
+  if (!status && !clear)
+    return false;
+
+  if (!cache_mutex)
+  {
+    static const char disabled[] = "HTTP_CACHE {\"error\":\"disabled\"}\n";
+    serial_data_write(disabled, sizeof(disabled) - 1);
+    return true;
+  }
+
+  if (clear)
+  {
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < HA_HTTP_CACHE_ENTRIES; i++)
+    {
+      if (slots[i].record)
+        drop_slot(i);
+    }
+    xSemaphoreGive(cache_mutex);
+    debug_log_info(DEBUG_TAG_HA_API, "HTTP cache cleared");
+  }
+  send_status();
+  return true;
+}
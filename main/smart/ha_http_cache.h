@@ -0,0 +1,168 @@
+/**
+ * @file ha_http_cache.h
+ * @brief Response cache for slow-changing Home Assistant metadata
+ *
+ * Names, icons, scene lists and the HA configuration hardly ever change,
+ * yet each boot asked for them again and parsed the full reply. Requests
+ * made through the cache (ha_api_get_metadata(),
+ * ha_api_render_template_cached()) keep the body with its validators in
+ * PSRAM, keyed by URL and a hash of the POST body, and in NVS so the
+ * entries survive a restart:
+ *
+ *   fresh   Cache-Control max-age has not run out: served without a request
+ *   stale   with an ETag or Last-Modified the request is conditional
+ *           (If-None-Match, If-Modified-Since); a 304 is served from the cache
+ *   changed a 200 replaces the entry, no-store drops it
+ *
+ * HA's REST API sends no validators, for its replies HA_HTTP_CACHE_MAX_AGE_S
+ * stands in for max-age. A 200 with the same bytes as the entry counts as
+ * unchanged as well: the response carries the unchanged flag either way,
+ * so a caller that still holds what it parsed from the entry skips the
+ * parse. Freshness is wall-clock time, before the clock is set every
+ * entry is stale.
+ *
+ * GET_HTTP_CACHE lists the entries and counters, HTTP_CACHE_CLEAR drops
+ * them all.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_HTTP_CACHE_H
+#define HA_HTTP_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Entries kept, the least recently used one makes room */
+#define HA_HTTP_CACHE_ENTRIES 4
+
+  /** Longest body kept, larger replies pass through uncached */
+#ifdef CONFIG_HA_HTTP_CACHE_MAX_BODY_KB
+#define HA_HTTP_CACHE_MAX_BODY (CONFIG_HA_HTTP_CACHE_MAX_BODY_KB * 1024)
+#else
+#define HA_HTTP_CACHE_MAX_BODY (8 * 1024)
+#endif
+
+  /** Freshness of a reply without max-age, ETag or Last-Modified, 0 to always ask */
+#ifdef CONFIG_HA_HTTP_CACHE_MAX_AGE_S
+#define HA_HTTP_CACHE_MAX_AGE_S CONFIG_HA_HTTP_CACHE_MAX_AGE_S
+#else
+#define HA_HTTP_CACHE_MAX_AGE_S 300
+#endif
+
+  /** URL including terminator, longer URLs are not cached */
+#define HA_HTTP_CACHE_URL_LEN 128
+
+  /** ETag including quotes and terminator, a longer one is not kept */
+#define HA_HTTP_CACHE_ETAG_LEN 64
+
+  /** HTTP date including terminator, "Sun, 06 Nov 1994 08:49:37 GMT" */
+#define HA_HTTP_CACHE_DATE_LEN 32
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    HA_HTTP_CACHE_MISS = 0, ///< Nothing cached, the request goes out as is
+    HA_HTTP_CACHE_STALE,    ///< Cached, the request goes out, conditional if there are validators
+    HA_HTTP_CACHE_FRESH     ///< Cached and within max-age, no request needed
+  } ha_http_cache_result_t;
+
+  /**
+   * @brief Caching headers of one side of an exchange
+   */
+  typedef struct
+  {
+    char etag[HA_HTTP_CACHE_ETAG_LEN];
+    char last_modified[HA_HTTP_CACHE_DATE_LEN];
+    int32_t max_age_s; ///< Cache-Control max-age, 0 for no-cache, -1 if not sent
+    bool no_store;     ///< Cache-Control no-store
+  } ha_http_cache_validators_t;
+
+  /**
+   * @brief One request through the cache, on the requester's stack
+   */
+  typedef struct
+  {
+    const char *url;
+    uint32_t body_hash;                  ///< Of the POST body, 0 for GET
+    uint32_t content_hash;               ///< Of the cached body
+    size_t body_len;                     ///< Of the cached body
+    ha_http_cache_validators_t sent;     ///< From the entry, for the conditional request
+    ha_http_cache_validators_t received; ///< From the response headers
+  } ha_http_cache_exchange_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the entries kept in NVS
+   * @return ESP_OK, also when nothing is stored, ESP_ERR_NOT_SUPPORTED if
+   *         disabled in menuconfig, or ESP_ERR_NO_MEM
+   * @note Call once after nvs_store_init(); until then nothing is cached
+   */
+  esp_err_t ha_http_cache_init(void);
+
+  /**
+   * @brief Start an exchange and look its URL up
+   * @param exchange Filled in, sent holds the validators to send
+   * @param url Request URL, must stay valid for the exchange
+   * @param post_data POST body or NULL
+   */
+  ha_http_cache_result_t ha_http_cache_lookup(ha_http_cache_exchange_t *exchange, const char *url,
+                                              const char *post_data);
+
+  /**
+   * @brief Copy the cached body of an exchange
+   * @param buf Receives the body and a terminator
+   * @param size Capacity of buf, at least exchange->body_len + 1
+   * @return Bytes copied, or -1 if the entry was replaced or dropped since the lookup
+   */
+  int ha_http_cache_copy(const ha_http_cache_exchange_t *exchange, char *buf, size_t size);
+
+  /**
+   * @brief Take a response header into exchange->received
+   * @note Called from the HTTP event handler, ignores headers it does not know
+   */
+  void ha_http_cache_on_header(ha_http_cache_exchange_t *exchange, const char *key, const char *value);
+
+  /**
+   * @brief A 304 answered the exchange: refresh the entry's validators and freshness
+   */
+  void ha_http_cache_revalidated(const ha_http_cache_exchange_t *exchange);
+
+  /**
+   * @brief A 200 answered the exchange: keep, replace or drop the entry
+   * @param body Response body
+   * @param len Bytes of body
+   * @return true if the body is the one cached before
+   */
+  bool ha_http_cache_store(const ha_http_cache_exchange_t *exchange, const char *body, size_t len);
+
+  /**
+   * @brief Handle GET_HTTP_CACHE and HTTP_CACHE_CLEAR
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an HTTP cache command
+   */
+  bool ha_http_cache_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_HTTP_CACHE_H
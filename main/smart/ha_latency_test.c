@@ -0,0 +1,336 @@
+/**
+ * @file ha_latency_test.c
+ * @brief Home Assistant Sync and Command Latency Test
+ *
+ * A short-lived task calls the same ha_api entry points the sync task and
+ * the command executor use, so each sample covers connection reuse, the
+ * request scheduler, transfer and parsing. Samples of one series are kept
+ * whole and sorted at the end; the ha_metrics histograms are too coarse
+ * for percentiles. Failed calls are counted but not timed, a timeout would
+ * otherwise dominate the upper percentiles.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_latency_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ha_api.h"
+#include "ha_entity_registry.h"
+#include "serial/serial_data_handler.h"
+#include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+
+#if CONFIG_HA_LATENCY_TEST
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef enum
+{
+  PATH_PER_ENTITY,
+  PATH_BULK,
+  PATH_TEMPLATE,
+  PATH_COUNT,
+} fetch_path_t;
+
+static const char *const path_names[PATH_COUNT] = {
+    [PATH_PER_ENTITY] = "per_entity",
+    [PATH_BULK] = "bulk",
+    [PATH_TEMPLATE] = "template",
+};
+
+/**
+ * @brief Timed calls of one series
+ */
+typedef struct
+{
+  uint32_t *samples_us; ///< Successful calls only
+  int count;
+  int partial; ///< Syncs that found only some of the entities
+  int failed;
+  esp_err_t last_error;
+} series_t;
+
+static portMUX_TYPE test_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool running = false;
+static int requested_path = -1; ///< -1 runs every path
+static int sync_runs = 0;
+static int command_runs = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void add_sample(series_t *series, int64_t start_us)
+{
+  int64_t us = esp_timer_get_time() - start_us;
+  series->samples_us[series->count++] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+/**
+ * @brief Nearest-rank percentile of sorted samples
+ */
+static uint32_t percentile(const uint32_t *sorted, int count, int pct)
+{
+  int rank = (pct * count + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * @brief One HA_LATENCY line
+ * @param head Leading members without braces, e.g. "\"path\":\"bulk\",\"entities\":8"
+ */
+static void report_series(const char *head, series_t *series)
+{
+  char buf[320];
+  int len = snprintf(buf, sizeof(buf), "HA_LATENCY {%s,\"ok\":%d,\"partial\":%d,\"failed\":%d", head,
+                     series->count, series->partial, series->failed);
+  if (series->failed)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len, ",\"last_error\":\"%s\"", esp_err_to_name(series->last_error));
+  }
+  if (series->count)
+  {
+    qsort(series->samples_us, series->count, sizeof(uint32_t), compare_u32);
+    const uint32_t *s = series->samples_us;
+    int n = series->count;
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    ",\"min_ms\":%.1f,\"p50_ms\":%.1f,\"p90_ms\":%.1f,\"p99_ms\":%.1f,\"max_ms\":%.1f",
+                    s[0] / 1000.0, percentile(s, n, 50) / 1000.0, percentile(s, n, 90) / 1000.0,
+                    percentile(s, n, 99) / 1000.0, s[n - 1] / 1000.0);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+  serial_data_write(buf, len);
+}
+
+static esp_err_t fetch_states(fetch_path_t path, const char **ids, int count, ha_entity_state_t *states)
+{
+  switch (path)
+  {
+  case PATH_BULK:
+    return ha_api_get_multiple_entity_states_bulk(ids, count, states);
+  case PATH_TEMPLATE:
+    return ha_api_get_multiple_entity_states_template(ids, count, states);
+  default:
+    return ha_api_get_multiple_entity_states(ids, count, states);
+  }
+}
+
+static void run_syncs(fetch_path_t path, series_t *series)
+{
+  const int count = ha_registry_count();
+  const char **ids = (const char **)ha_registry_entity_ids();
+  ha_entity_state_t states[HA_REGISTRY_MAX_ENTITIES];
+
+  for (int i = 0; i < sync_runs; i++)
+  {
+    memset(states, 0, sizeof(states));
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = fetch_states(path, ids, count, states);
+    if (ret == ESP_OK)
+    {
+      add_sample(series, start);
+    }
+    else if (ret == ESP_ERR_NOT_FOUND)
+    {
+      // Partial syncs are timed too, a slow truncated reply is still a sync
+      add_sample(series, start);
+      series->partial++;
+    }
+    else
+    {
+      series->failed++;
+      series->last_error = ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(HA_LATENCY_TEST_GAP_MS));
+  }
+
+  char head[64];
+  snprintf(head, sizeof(head), "\"path\":\"%s\",\"entities\":%d", path_names[path], count);
+  report_series(head, series);
+}
+
+static void run_commands(series_t *series)
+{
+  // update_entity only makes HA poll the entity, nothing switches
+  ha_service_call_t call = {.domain = "homeassistant", .service = "update_entity"};
+  strlcpy(call.entity_id, ha_registry_entity_ids()[0], sizeof(call.entity_id));
+
+  for (int i = 0; i < command_runs; i++)
+  {
+    ha_api_response_t response = {0};
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = ha_api_call_service(&call, &response);
+    if (ret == ESP_OK && !response.success)
+      ret = ESP_ERR_INVALID_RESPONSE;
+    if (ret == ESP_OK)
+    {
+      add_sample(series, start);
+    }
+    else
+    {
+      series->failed++;
+      series->last_error = ret;
+    }
+    ha_api_free_response(&response);
+    vTaskDelay(pdMS_TO_TICKS(HA_LATENCY_TEST_GAP_MS));
+  }
+
+  report_series("\"commands\":\"homeassistant.update_entity\"", series);
+}
+
+static void latency_task(void *arg)
+{
+  (void)arg;
+  int runs = sync_runs > command_runs ? sync_runs : command_runs;
+  series_t series = {0};
+  series.samples_us = malloc(runs * sizeof(uint32_t));
+
+  if (!series.samples_us)
+  {
+    static const char oom[] = "HA_LATENCY {\"error\":\"no memory\"}\n";
+    serial_data_write(oom, sizeof(oom) - 1);
+  }
+  else
+  {
+    debug_log_info_f(DEBUG_TAG_HA_API, "Latency test started: %d syncs per path, %d commands", sync_runs,
+                     command_runs);
+    for (int path = 0; path < PATH_COUNT && sync_runs > 0; path++)
+    {
+      if (requested_path < 0 || requested_path == path)
+      {
+        uint32_t *samples = series.samples_us;
+        series = (series_t){.samples_us = samples};
+        run_syncs((fetch_path_t)path, &series);
+      }
+    }
+    if (command_runs > 0)
+    {
+      uint32_t *samples = series.samples_us;
+      series = (series_t){.samples_us = samples};
+      run_commands(&series);
+    }
+    free(series.samples_us);
+    debug_log_info(DEBUG_TAG_HA_API, "Latency test finished");
+  }
+
+  static const char done[] = "HA_LATENCY {\"done\":true}\n";
+  serial_data_write(done, sizeof(done) - 1);
+  running = false;
+  vTaskDelete(NULL);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "HA_LATENCY {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+#endif // CONFIG_HA_LATENCY_TEST
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ha_latency_test_start(const char *path, int syncs, int commands)
+{
+#if CONFIG_HA_LATENCY_TEST
+  int index = -1;
+  if (path && strcmp(path, "all") != 0)
+  {
+    for (int i = 0; i < PATH_COUNT && index < 0; i++)
+    {
+      if (strcmp(path, path_names[i]) == 0)
+        index = i;
+    }
+    if (index < 0)
+      return ESP_ERR_NOT_FOUND;
+  }
+  if (syncs < 0 || syncs > HA_LATENCY_TEST_MAX_RUNS || commands < 0 || commands > HA_LATENCY_TEST_MAX_RUNS ||
+      syncs + commands == 0)
+    return ESP_ERR_INVALID_ARG;
+  if (!ha_api_is_ready() || ha_registry_count() == 0)
+    return ESP_ERR_INVALID_STATE;
+
+  portENTER_CRITICAL(&test_lock);
+  bool busy = running;
+  running = true;
+  portEXIT_CRITICAL(&test_lock);
+  if (busy)
+    return ESP_ERR_INVALID_STATE;
+
+  requested_path = index;
+  sync_runs = syncs;
+  command_runs = commands;
+  if (task_plan_create(TASK_PLAN_HA_LATENCY, latency_task, NULL, NULL) != pdPASS)
+  {
+    running = false;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+#else
+  (void)path;
+  (void)syncs;
+  (void)commands;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool ha_latency_test_is_running(void)
+{
+#if CONFIG_HA_LATENCY_TEST
+  return running;
+#else
+  return false;
+#endif
+}
+
+bool ha_latency_test_handle_command(const char *line)
+{
+#if CONFIG_HA_LATENCY_TEST
+  if (strncmp(line, "HA_LATENCY_TEST", 15) != 0 || (line[15] != '\0' && line[15] != ' '))
+    return false;
+
+  char path[16] = "all";
+  int syncs = HA_LATENCY_TEST_DEFAULT_RUNS;
+  int commands = HA_LATENCY_TEST_DEFAULT_RUNS;
+  sscanf(line + 15, "%15s %d %d", path, &syncs, &commands);
+
+  esp_err_t ret = ha_latency_test_start(path, syncs, commands);
+  if (ret == ESP_ERR_INVALID_STATE)
+    reply_error(running ? "busy" : "ha not ready");
+  else if (ret == ESP_ERR_NOT_FOUND)
+    reply_error("unknown path");
+  else if (ret == ESP_ERR_INVALID_ARG)
+    reply_error("bad count");
+  else if (ret != ESP_OK)
+    reply_error(esp_err_to_name(ret));
+  else
+  {
+    char buf[96];
+    int len = snprintf(buf, sizeof(buf), "HA_LATENCY {\"started\":true,\"path\":\"%s\",\"syncs\":%d,\"commands\":%d}\n",
+                       path, syncs, commands);
+    serial_data_write(buf, len);
+  }
+  return true;
+#else
+  (void)line;
+  return false;
+#endif
+}
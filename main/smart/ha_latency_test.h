@@ -0,0 +1,75 @@
+/**
+ * @file ha_latency_test.h
+ * @brief Home Assistant Sync and Command Latency Test
+ *
+ * Test mode that times whole state syncs through each fetch path
+ * (per-entity, bulk /api/states, /api/template) and service calls, end to
+ * end as the dashboard sees them, and reports min/p50/p90/p99/max. Meant
+ * to run against the host mock server (main/utils/mock_ha_server.py) with
+ * a large entity count or injected latency, but harmless against a real
+ * HA: the commands are homeassistant.update_entity, which changes nothing.
+ *
+ * Started over the serial port with
+ *   HA_LATENCY_TEST [per_entity|bulk|template|all] [syncs] [commands]
+ * Each path and the commands are reported as an HA_LATENCY line.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_LATENCY_TEST_H
+#define HA_LATENCY_TEST_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Syncs per path and commands when the command line gives no count */
+#define HA_LATENCY_TEST_DEFAULT_RUNS 20
+
+  /** Upper limit of syncs per path and of commands, bounds the sample buffer */
+#define HA_LATENCY_TEST_MAX_RUNS 500
+
+  /** Pause between two measurements so they do not queue behind each other */
+#define HA_LATENCY_TEST_GAP_MS 100
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start a run in the background
+   * @param path "per_entity", "bulk", "template", or NULL/"all" for every path
+   * @param syncs Syncs per path, 0 for none
+   * @param commands Service calls, 0 for none
+   * @return ESP_OK when started, ESP_ERR_INVALID_STATE while a run is in progress
+   *         or HA is not initialized, ESP_ERR_NOT_FOUND for an unknown path,
+   *         ESP_ERR_INVALID_ARG for counts out of range, ESP_ERR_NOT_SUPPORTED if disabled
+   */
+  esp_err_t ha_latency_test_start(const char *path, int syncs, int commands);
+
+  /**
+   * @brief Whether a run is in progress
+   */
+  bool ha_latency_test_is_running(void);
+
+  /**
+   * @brief Handle HA_LATENCY_TEST [path] [syncs] [commands]
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a latency test command
+   */
+  bool ha_latency_test_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_LATENCY_TEST_H
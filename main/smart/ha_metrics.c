@@ -0,0 +1,361 @@
+/**
+ * @file ha_metrics.c
+ * @brief Home Assistant Client Metrics
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ha_metrics.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "entity_states_parser.h"
+#include "freertos/FreeRTOS.h"
+#include "ha_api.h"
+#include "metrics.h"
+#include "serial/serial_data_handler.h"
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Distribution of one phase
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t buckets[HA_METRICS_BUCKET_COUNT];
+  uint64_t total_us;
+  uint32_t max_us;
+} phase_metrics_t;
+
+/**
+ * @brief Everything counted for one endpoint
+ */
+typedef struct
+{
+  uint32_t attempts;    ///< Every attempt, retries and fast fails included
+  uint32_t retries;     ///< Attempts after the first of a request
+  uint32_t failures;    ///< Attempts that failed at transport level
+  uint32_t http_errors; ///< Attempts answered with status 400 or above
+  uint32_t reused;      ///< Attempts on an already open connection
+  uint64_t bytes_out;
+  uint64_t bytes_in;
+  uint32_t parse_count;
+  uint64_t parse_total_us;
+  uint32_t parse_max_us;
+  phase_metrics_t phases[HA_PHASE_COUNT];
+} endpoint_metrics_t;
+
+typedef struct
+{
+  esp_err_t code;
+  uint32_t count;
+} error_count_t;
+
+typedef struct
+{
+  endpoint_metrics_t endpoints[HA_ENDPOINT_COUNT];
+  error_count_t errors[HA_METRICS_MAX_ERROR_CODES];
+  uint32_t other_errors; ///< Codes beyond HA_METRICS_MAX_ERROR_CODES
+} ha_metrics_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static const char *const endpoint_names[HA_ENDPOINT_COUNT] = {
+    [HA_ENDPOINT_SERVICES] = "services",
+    [HA_ENDPOINT_TEMPLATE] = "template",
+    [HA_ENDPOINT_STATES] = "states",
+    [HA_ENDPOINT_OTHER] = "other",
+};
+
+static const char *const phase_names[HA_PHASE_COUNT] = {
+    [HA_PHASE_DNS] = "dns",
+    [HA_PHASE_CONNECT] = "connect",
+    [HA_PHASE_TTFB] = "ttfb",
+    [HA_PHASE_TOTAL] = "total",
+};
+
+static const uint32_t bucket_edges_ms[HA_METRICS_BUCKET_COUNT - 1] = HA_METRICS_BUCKET_EDGES_MS;
+
+static ha_metrics_t metrics = {0};
+static portMUX_TYPE metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Only the serial task replies, a copy keeps the lock short and the stack small
+static ha_metrics_t snapshot;
+
+static int64_t read_endpoint_counter(const metric_t *metric);
+
+// Registry arg: offset of a uint32_t in endpoint_metrics_t, endpoint in the low 4 bits
+#define ENDPOINT_ARG(endpoint, field) ((offsetof(endpoint_metrics_t, field) << 4) | (endpoint))
+#define ENDPOINT_SERIES(endpoint, label, name, help, field)                   \
+  METRIC_READ_INIT(METRIC_TYPE_COUNTER, name, help, "endpoint=\"" label "\"", \
+                   read_endpoint_counter, ENDPOINT_ARG(endpoint, field))
+#define ENDPOINT_SERIES_ALL(name, help, field)                              \
+  ENDPOINT_SERIES(HA_ENDPOINT_SERVICES, "services", name, help, field),     \
+      ENDPOINT_SERIES(HA_ENDPOINT_TEMPLATE, "template", name, help, field), \
+      ENDPOINT_SERIES(HA_ENDPOINT_STATES, "states", name, help, field),     \
+      ENDPOINT_SERIES(HA_ENDPOINT_OTHER, "other", name, help, field)
+
+static metric_t endpoint_series[] = {
+    ENDPOINT_SERIES_ALL("ha_requests_total", "HA request attempts", attempts),
+    ENDPOINT_SERIES_ALL("ha_request_retries_total", "HA attempts after the first of a request", retries),
+    ENDPOINT_SERIES_ALL("ha_request_failures_total", "HA attempts failed at transport level", failures),
+    ENDPOINT_SERIES_ALL("ha_http_errors_total", "HA attempts answered with status 400 or above", http_errors),
+};
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static void add_phase(phase_metrics_t *phase, int64_t duration_us)
+{
+  uint32_t us = duration_us > UINT32_MAX ? UINT32_MAX : (uint32_t)duration_us;
+  int bucket = 0;
+  while (bucket < HA_METRICS_BUCKET_COUNT - 1 && us > bucket_edges_ms[bucket] * 1000)
+  {
+    bucket++;
+  }
+
+  phase->count++;
+  phase->buckets[bucket]++;
+  phase->total_us += us;
+  if (us > phase->max_us)
+    phase->max_us = us;
+}
+
+static void add_error(esp_err_t code)
+{
+  for (int i = 0; i < HA_METRICS_MAX_ERROR_CODES; i++)
+  {
+    if (metrics.errors[i].count == 0)
+    {
+      metrics.errors[i].code = code;
+    }
+    if (metrics.errors[i].code == code)
+    {
+      metrics.errors[i].count++;
+      return;
+    }
+  }
+  metrics.other_errors++;
+}
+
+static int64_t read_endpoint_counter(const metric_t *metric)
+{
+  const endpoint_metrics_t *m = &metrics.endpoints[metric->arg & 0xF];
+  portENTER_CRITICAL(&metrics_lock);
+  uint32_t value = *(const uint32_t *)((const uint8_t *)m + (metric->arg >> 4));
+  portEXIT_CRITICAL(&metrics_lock);
+  return value;
+}
+
+static void write_text(const char *text)
+{
+  serial_data_write(text, strlen(text));
+}
+
+static void write_phase(const char *name, const phase_metrics_t *phase)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), ",\"%s\":{\"count\":%lu,\"avg_us\":%llu,\"max_us\":%lu,\"hist\":[", name,
+                     (unsigned long)phase->count,
+                     (unsigned long long)(phase->count ? phase->total_us / phase->count : 0),
+                     (unsigned long)phase->max_us);
+  serial_data_write(buf, len);
+  for (int b = 0; b < HA_METRICS_BUCKET_COUNT; b++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s%lu", b ? "," : "", (unsigned long)phase->buckets[b]);
+    serial_data_write(buf, len);
+  }
+  write_text("]}");
+}
+
+/**
+ * @brief One HA_METRICS line, written in pieces so the reply needs no large buffer
+ */
+static void reply_metrics(void)
+{
+  char buf[192];
+
+  portENTER_CRITICAL(&metrics_lock);
+  memcpy(&snapshot, &metrics, sizeof(snapshot));
+  portEXIT_CRITICAL(&metrics_lock);
+
+  write_text("HA_METRICS {\"buckets_ms\":[");
+  for (int b = 0; b < HA_METRICS_BUCKET_COUNT - 1; b++)
+  {
+    int len = snprintf(buf, sizeof(buf), "%s%lu", b ? "," : "", (unsigned long)bucket_edges_ms[b]);
+    serial_data_write(buf, len);
+  }
+  write_text("],\"endpoints\":[");
+
+  for (int e = 0; e < HA_ENDPOINT_COUNT; e++)
+  {
+    const endpoint_metrics_t *m = &snapshot.endpoints[e];
+    int len = snprintf(buf, sizeof(buf),
+                       "%s{\"name\":\"%s\",\"attempts\":%lu,\"retries\":%lu,\"failures\":%lu,\"http_errors\":%lu,"
+                       "\"reused\":%lu,\"bytes_out\":%llu,\"bytes_in\":%llu",
+                       e ? "," : "", endpoint_names[e], (unsigned long)m->attempts, (unsigned long)m->retries,
+                       (unsigned long)m->failures, (unsigned long)m->http_errors, (unsigned long)m->reused,
+                       (unsigned long long)m->bytes_out, (unsigned long long)m->bytes_in);
+    serial_data_write(buf, len);
+    len = snprintf(buf, sizeof(buf), ",\"parse\":{\"count\":%lu,\"avg_us\":%llu,\"max_us\":%lu}",
+                   (unsigned long)m->parse_count,
+                   (unsigned long long)(m->parse_count ? m->parse_total_us / m->parse_count : 0),
+                   (unsigned long)m->parse_max_us);
+    serial_data_write(buf, len);
+    for (int p = 0; p < HA_PHASE_COUNT; p++)
+    {
+      write_phase(phase_names[p], &m->phases[p]);
+    }
+    write_text("}");
+  }
+
+  write_text("],\"errors\":{");
+  bool first = true;
+  for (int i = 0; i < HA_METRICS_MAX_ERROR_CODES && snapshot.errors[i].count; i++)
+  {
+    int len = snprintf(buf, sizeof(buf), "%s\"%s\":%lu", first ? "" : ",", esp_err_to_name(snapshot.errors[i].code),
+                       (unsigned long)snapshot.errors[i].count);
+    serial_data_write(buf, len);
+    first = false;
+  }
+  if (snapshot.other_errors)
+  {
+    int len = snprintf(buf, sizeof(buf), "%s\"other\":%lu", first ? "" : ",", (unsigned long)snapshot.other_errors);
+    serial_data_write(buf, len);
+  }
+
+  ha_api_pool_stats_t pool[HA_HTTP_POOL_SIZE];
+  int pool_count = ha_api_get_pool_stats(pool, HA_HTTP_POOL_SIZE);
+  write_text("},\"pool\":[");
+  for (int i = 0; i < pool_count; i++)
+  {
+    int len = snprintf(buf, sizeof(buf), "%s{\"in_use\":%s,\"requests\":%lu,\"failures\":%lu,\"reconnects\":%lu}",
+                       i ? "," : "", pool[i].in_use ? "true" : "false", (unsigned long)pool[i].requests,
+                       (unsigned long)pool[i].failures, (unsigned long)pool[i].reconnects);
+    serial_data_write(buf, len);
+  }
+
+  ha_api_buffer_stats_t grades[HA_RESPONSE_BUFFER_GRADES];
+  int grade_count = ha_api_get_buffer_stats(grades, HA_RESPONSE_BUFFER_GRADES);
+  write_text("],\"buffers\":[");
+  for (int i = 0; i < grade_count; i++)
+  {
+    int len = snprintf(buf, sizeof(buf),
+                       "%s{\"size\":%u,\"buffers\":%u,\"in_use\":%u,\"high_water\":%u,\"acquired\":%lu,\"fallbacks\":%lu}",
+                       i ? "," : "", (unsigned)grades[i].size, grades[i].buffers, grades[i].in_use, grades[i].high_water,
+                       (unsigned long)grades[i].acquired, (unsigned long)grades[i].fallbacks);
+    serial_data_write(buf, len);
+  }
+
+  entity_parser_stats_t parser = {0};
+  entity_states_parser_get_stats(&parser);
+  int len = snprintf(buf, sizeof(buf),
+                     "],\"parser\":{\"jobs\":%lu,\"total_ms\":%lld,\"avg_ms\":%lld,\"found\":%lu,\"missing\":%lu,"
+                     "\"largest_response\":%u}}\n",
+                     (unsigned long)parser.jobs_processed, (long long)parser.total_parse_time_ms,
+                     (long long)parser.average_parse_time_ms, (unsigned long)parser.entities_found,
+                     (unsigned long)parser.entities_missing, (unsigned)parser.largest_response_size);
+  serial_data_write(buf, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+ha_endpoint_t ha_metrics_endpoint_for_url(const char *url)
+{
+  if (!url)
+    return HA_ENDPOINT_OTHER;
+  if (strstr(url, "/api/services/"))
+    return HA_ENDPOINT_SERVICES;
+  if (strstr(url, "/api/template"))
+    return HA_ENDPOINT_TEMPLATE;
+  if (strstr(url, "/api/states"))
+    return HA_ENDPOINT_STATES;
+  return HA_ENDPOINT_OTHER;
+}
+
+void ha_metrics_init(void)
+{
+  for (size_t i = 0; i < sizeof(endpoint_series) / sizeof(endpoint_series[0]); i++)
+  {
+    metrics_register(&endpoint_series[i]);
+  }
+}
+
+const char *ha_metrics_endpoint_name(ha_endpoint_t endpoint)
+{
+  return endpoint < HA_ENDPOINT_COUNT ? endpoint_names[endpoint] : "unknown";
+}
+
+void ha_metrics_record_request(ha_endpoint_t endpoint, const ha_request_sample_t *sample)
+{
+  if (endpoint >= HA_ENDPOINT_COUNT || !sample)
+    return;
+
+  portENTER_CRITICAL(&metrics_lock);
+  endpoint_metrics_t *m = &metrics.endpoints[endpoint];
+  m->attempts++;
+  if (sample->retry)
+    m->retries++;
+  if (sample->err != ESP_OK)
+  {
+    m->failures++;
+    add_error(sample->err);
+  }
+  else if (sample->status_code >= 400)
+  {
+    m->http_errors++;
+  }
+  if (sample->phase_us[HA_PHASE_TOTAL] >= 0 && sample->phase_us[HA_PHASE_CONNECT] < 0)
+    m->reused++;
+  m->bytes_out += sample->bytes_out;
+  m->bytes_in += sample->bytes_in;
+  for (int p = 0; p < HA_PHASE_COUNT; p++)
+  {
+    if (sample->phase_us[p] >= 0)
+      add_phase(&m->phases[p], sample->phase_us[p]);
+  }
+  portEXIT_CRITICAL(&metrics_lock);
+}
+
+void ha_metrics_record_parse(ha_endpoint_t endpoint, int64_t parse_us)
+{
+  if (endpoint >= HA_ENDPOINT_COUNT || parse_us < 0)
+    return;
+
+  uint32_t us = parse_us > UINT32_MAX ? UINT32_MAX : (uint32_t)parse_us;
+  portENTER_CRITICAL(&metrics_lock);
+  endpoint_metrics_t *m = &metrics.endpoints[endpoint];
+  m->parse_count++;
+  m->parse_total_us += us;
+  if (us > m->parse_max_us)
+    m->parse_max_us = us;
+  portEXIT_CRITICAL(&metrics_lock);
+}
+
+bool ha_metrics_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_HA_METRICS") == 0)
+  {
+    reply_metrics();
+    return true;
+  }
+  if (strcmp(line, "RESET_HA_METRICS") == 0)
+  {
+    portENTER_CRITICAL(&metrics_lock);
+    memset(&metrics, 0, sizeof(metrics));
+    portEXIT_CRITICAL(&metrics_lock);
+    write_text("HA_METRICS {\"reset\":true}\n");
+    return true;
+  }
+  return false;
+}
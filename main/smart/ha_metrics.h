@@ -0,0 +1,120 @@
+/**
+ * @file ha_metrics.h
+ * @brief Home Assistant Client Metrics
+ *
+ * Counters and latency histograms of every request the HA client makes,
+ * split by endpoint. Each attempt is broken into DNS, connect, time to first
+ * byte and total time, so a slow switch can be put down to the network, to
+ * HA itself or to parsing. Read over the serial port with GET_HA_METRICS.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HA_METRICS_H
+#define HA_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Latency histogram buckets, upper edges in ms plus one overflow bucket */
+#define HA_METRICS_BUCKET_EDGES_MS {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000}
+#define HA_METRICS_BUCKET_COUNT 11
+
+  /** Distinct error codes counted, later ones are lumped together */
+#define HA_METRICS_MAX_ERROR_CODES 8
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief API endpoint a request went to
+   */
+  typedef enum
+  {
+    HA_ENDPOINT_SERVICES = 0, ///< /api/services/<domain>/<service>
+    HA_ENDPOINT_TEMPLATE,     ///< /api/template
+    HA_ENDPOINT_STATES,       ///< /api/states and /api/states/<entity_id>
+    HA_ENDPOINT_OTHER,
+    HA_ENDPOINT_COUNT
+  } ha_endpoint_t;
+
+  /**
+   * @brief Timed phases of one attempt
+   */
+  typedef enum
+  {
+    HA_PHASE_DNS = 0, ///< Host lookup, near zero while the address is cached
+    HA_PHASE_CONNECT, ///< TCP and TLS setup, skipped on a reused connection
+    HA_PHASE_TTFB,    ///< Start of the request to the first response header
+    HA_PHASE_TOTAL,   ///< Whole attempt
+    HA_PHASE_COUNT
+  } ha_request_phase_t;
+
+  /**
+   * @brief Measurements of one request attempt
+   */
+  typedef struct
+  {
+    int64_t phase_us[HA_PHASE_COUNT]; ///< Duration per phase, -1 if it did not happen
+    size_t bytes_out;                 ///< Request body
+    size_t bytes_in;                  ///< Response body
+    esp_err_t err;                    ///< Transport result
+    int status_code;                  ///< HTTP status, 0 if none arrived
+    bool retry;                       ///< Not the first attempt of its request
+  } ha_request_sample_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Export the per-endpoint counters through the metrics registry
+   */
+  void ha_metrics_init(void);
+
+  /**
+   * @brief Endpoint a URL belongs to
+   */
+  ha_endpoint_t ha_metrics_endpoint_for_url(const char *url);
+
+  /**
+   * @brief Endpoint name as reported in metrics and logs
+   */
+  const char *ha_metrics_endpoint_name(ha_endpoint_t endpoint);
+
+  /**
+   * @brief Account one request attempt
+   * @note Safe from any task
+   */
+  void ha_metrics_record_request(ha_endpoint_t endpoint, const ha_request_sample_t *sample);
+
+  /**
+   * @brief Account the time spent turning a response into states
+   */
+  void ha_metrics_record_parse(ha_endpoint_t endpoint, int64_t parse_us);
+
+  /**
+   * @brief Handle GET_HA_METRICS / RESET_HA_METRICS
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a metrics command
+   */
+  bool ha_metrics_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_METRICS_H
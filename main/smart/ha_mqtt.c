@@ -0,0 +1,350 @@
+/**
+ * @file ha_mqtt.c
+ * @brief Direct MQTT path for latency-critical switches
+ *
+ * Commands are published with QoS 1 and without retain, like HA's own MQTT
+ * switch does, so a device that reconnects later does not replay an old
+ * command. State topics are usually retained by the device, the broker
+ * sends the current state right after each subscribe.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_mqtt.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "ha_api.h"
+#include "serial/serial_data_handler.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+#if CONFIG_HA_MQTT
+
+#include "asset_pack.h"
+#include "mqtt_client.h"
+#if CONFIG_HA_HTTPS_CA_BUNDLE
+#include "esp_crt_bundle.h"
+#endif
+
+#define HA_MQTT_PACK_ASSET "config/mqtt"
+#define HA_MQTT_KEEPALIVE_S 30 ///< Also keeps idle NAT entries open
+#define HA_MQTT_RECONNECT_MS 5000
+#define HA_MQTT_QOS 1
+
+#ifndef HA_MQTT_USERNAME
+#define HA_MQTT_USERNAME NULL
+#endif
+#ifndef HA_MQTT_PASSWORD
+#define HA_MQTT_PASSWORD NULL
+#endif
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  char entity_id[HA_MAX_ENTITY_ID_LEN];
+  char command_topic[HA_MQTT_TOPIC_LEN];
+  char state_topic[HA_MQTT_TOPIC_LEN];
+  char payload_on[HA_MQTT_PAYLOAD_LEN];
+  char payload_off[HA_MQTT_PAYLOAD_LEN];
+} mqtt_route_t;
+
+static mqtt_route_t routes[HA_MQTT_MAX_ROUTES];
+static int route_count = 0;
+static esp_mqtt_client_handle_t mqtt_client = NULL;
+static ha_mqtt_state_callback_t mqtt_state_callback = NULL;
+static volatile bool mqtt_connected = false;
+
+// Counters for GET_MQTT
+static volatile uint32_t publish_count = 0;
+static volatile uint32_t publish_failures = 0;
+static volatile uint32_t states_received = 0;
+static volatile uint32_t connect_count = 0;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Copy the next comma separated field
+ * @return false if it is empty or does not fit
+ */
+static bool next_field(char **cursor, char *out, size_t size)
+{
+  char *start = *cursor;
+  if (!start)
+    return false;
+
+  char *comma = strchr(start, ',');
+  size_t len = comma ? (size_t)(comma - start) : strlen(start);
+  *cursor = comma ? comma + 1 : NULL;
+  if (len == 0 || len >= size)
+    return false;
+
+  memcpy(out, start, len);
+  out[len] = '\0';
+  return true;
+}
+
+/**
+ * @brief Routes from the asset pack, one per line
+ */
+static void load_routes(void)
+{
+  asset_t asset;
+  route_count = 0;
+  if (!asset_pack_find(HA_MQTT_PACK_ASSET, ASSET_TYPE_BLOB, &asset))
+    return;
+
+  const char *p = asset.data;
+  const char *end = p + asset.size;
+  while (p < end && route_count < HA_MQTT_MAX_ROUTES)
+  {
+    const char *nl = memchr(p, '\n', end - p);
+    const char *line_end = nl ? nl : end;
+    size_t len = (size_t)(line_end - p);
+    if (len > 0 && line_end[-1] == '\r')
+      len--;
+
+    char line[HA_MAX_ENTITY_ID_LEN + 2 * HA_MQTT_TOPIC_LEN + 2 * HA_MQTT_PAYLOAD_LEN];
+    bool fits = len > 0 && len < sizeof(line);
+    if (fits)
+    {
+      memcpy(line, p, len);
+      line[len] = '\0';
+    }
+    p = nl ? nl + 1 : end;
+    if (!fits || line[0] == '#')
+      continue;
+
+    mqtt_route_t *route = &routes[route_count];
+    memset(route, 0, sizeof(*route));
+    char *cursor = line;
+    if (!next_field(&cursor, route->entity_id, sizeof(route->entity_id)) ||
+        !next_field(&cursor, route->command_topic, sizeof(route->command_topic)) ||
+        !next_field(&cursor, route->state_topic, sizeof(route->state_topic)))
+    {
+      debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Skipping MQTT route line: %.40s", line);
+      continue;
+    }
+    if (!cursor || !next_field(&cursor, route->payload_on, sizeof(route->payload_on)) ||
+        !next_field(&cursor, route->payload_off, sizeof(route->payload_off)))
+    {
+      strlcpy(route->payload_on, "ON", sizeof(route->payload_on));
+      strlcpy(route->payload_off, "OFF", sizeof(route->payload_off));
+    }
+    route_count++;
+  }
+}
+
+static const mqtt_route_t *find_route(const char *entity_id)
+{
+  for (int i = 0; i < route_count; i++)
+  {
+    if (strcmp(routes[i].entity_id, entity_id) == 0)
+      return &routes[i];
+  }
+  return NULL;
+}
+
+static void handle_state(const char *topic, int topic_len, const char *data, int data_len)
+{
+  char payload[HA_MQTT_PAYLOAD_LEN * 2];
+  if (data_len < 0 || data_len >= (int)sizeof(payload))
+    return;
+  memcpy(payload, data, data_len);
+  payload[data_len] = '\0';
+
+  for (int i = 0; i < route_count; i++)
+  {
+    const mqtt_route_t *route = &routes[i];
+    if ((int)strlen(route->state_topic) != topic_len || strncmp(route->state_topic, topic, topic_len) != 0)
+      continue;
+
+    const char *state = payload;
+    if (strcmp(payload, route->payload_on) == 0)
+      state = "on";
+    else if (strcmp(payload, route->payload_off) == 0)
+      state = "off";
+
+    states_received++;
+    if (mqtt_state_callback)
+      mqtt_state_callback(route->entity_id, state);
+  }
+}
+
+static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+  esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+
+  switch ((esp_mqtt_event_id_t)event_id)
+  {
+  case MQTT_EVENT_CONNECTED:
+    debug_log_info_f(DEBUG_TAG_HA_API, "MQTT: connected, %d routes", route_count);
+    connect_count++;
+    mqtt_connected = true;
+    for (int i = 0; i < route_count; i++)
+    {
+      esp_mqtt_client_subscribe(mqtt_client, routes[i].state_topic, HA_MQTT_QOS);
+    }
+    break;
+
+  case MQTT_EVENT_DISCONNECTED:
+    if (mqtt_connected)
+      debug_log_warning(DEBUG_TAG_HA_API, "MQTT: connection lost, commands go through REST");
+    mqtt_connected = false;
+    break;
+
+  case MQTT_EVENT_DATA:
+    // States are a few bytes, a fragmented message is not one of them
+    if (event->current_data_offset == 0 && event->data_len == event->total_data_len)
+      handle_state(event->topic, event->topic_len, event->data, event->data_len);
+    break;
+
+  case MQTT_EVENT_ERROR:
+    debug_log_warning(DEBUG_TAG_HA_API, "MQTT: transport error");
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void reply(const char *text)
+{
+  serial_data_write(text, strlen(text));
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_mqtt_start(ha_mqtt_state_callback_t callback)
+{
+  if (mqtt_client)
+    return ESP_OK;
+
+  load_routes();
+  if (route_count == 0)
+    return ESP_ERR_NOT_FOUND;
+  mqtt_state_callback = callback;
+
+  esp_mqtt_client_config_t config = {
+      .broker.address.uri = CONFIG_HA_MQTT_BROKER_URI,
+#if CONFIG_HA_HTTPS_CA_BUNDLE
+      .broker.verification.crt_bundle_attach = esp_crt_bundle_attach,
+#endif
+      .credentials.username = HA_MQTT_USERNAME,
+      .credentials.authentication.password = HA_MQTT_PASSWORD,
+      .session.keepalive = HA_MQTT_KEEPALIVE_S,
+      .network.reconnect_timeout_ms = HA_MQTT_RECONNECT_MS,
+      // The core comes from MQTT_USE_CORE_0 in sdkconfig
+      .task.priority = (int)task_plan_get(TASK_PLAN_MQTT)->priority,
+      .task.stack_size = (int)task_plan_get(TASK_PLAN_MQTT)->stack_size,
+  };
+
+  mqtt_client = esp_mqtt_client_init(&config);
+  if (!mqtt_client)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "MQTT: client init failed");
+    return ESP_FAIL;
+  }
+
+  esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+  esp_err_t ret = esp_mqtt_client_start(mqtt_client);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "MQTT: start failed: %s", esp_err_to_name(ret));
+    esp_mqtt_client_destroy(mqtt_client);
+    mqtt_client = NULL;
+  }
+  return ret;
+}
+
+void ha_mqtt_stop(void)
+{
+  if (!mqtt_client)
+    return;
+
+  esp_mqtt_client_stop(mqtt_client);
+  esp_mqtt_client_destroy(mqtt_client);
+  mqtt_client = NULL;
+  mqtt_connected = false;
+}
+
+bool ha_mqtt_routes(const char *entity_id)
+{
+  return mqtt_connected && entity_id && find_route(entity_id);
+}
+
+esp_err_t ha_mqtt_publish_switch(const char *entity_id, bool turn_on)
+{
+  const mqtt_route_t *route = entity_id ? find_route(entity_id) : NULL;
+  if (!route)
+    return ESP_ERR_NOT_FOUND;
+  if (!mqtt_connected)
+    return ESP_ERR_INVALID_STATE;
+
+  const char *payload = turn_on ? route->payload_on : route->payload_off;
+  int msg_id = esp_mqtt_client_publish(mqtt_client, route->command_topic, payload, 0, HA_MQTT_QOS, 0);
+  if (msg_id < 0)
+  {
+    publish_failures++;
+    debug_log_warning_f(DEBUG_TAG_HA_API, "MQTT: publish to %s failed", route->command_topic);
+    return ESP_FAIL;
+  }
+  publish_count++;
+  return ESP_OK;
+}
+
+bool ha_mqtt_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_MQTT") != 0)
+    return false;
+
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "MQTT {\"enabled\":true,\"connected\":%s,\"routes\":%d,\"connects\":%lu,\"published\":%lu,"
+           "\"publish_failures\":%lu,\"states\":%lu}\n",
+           mqtt_connected ? "true" : "false", route_count, (unsigned long)connect_count,
+           (unsigned long)publish_count, (unsigned long)publish_failures, (unsigned long)states_received);
+  reply(buf);
+  return true;
+}
+
+#else
+
+esp_err_t ha_mqtt_start(ha_mqtt_state_callback_t callback)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ha_mqtt_stop(void)
+{
+}
+
+bool ha_mqtt_routes(const char *entity_id)
+{
+  return false;
+}
+
+esp_err_t ha_mqtt_publish_switch(const char *entity_id, bool turn_on)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool ha_mqtt_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_MQTT") != 0)
+    return false;
+
+  serial_data_write("MQTT {\"enabled\":false}\n", 23);
+  return true;
+}
+
+#endif // CONFIG_HA_MQTT
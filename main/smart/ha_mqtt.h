@@ -0,0 +1,102 @@
+/**
+ * @file ha_mqtt.h
+ * @brief Direct MQTT path for latency-critical switches
+ *
+ * Entities listed in the asset pack file "config/mqtt" are switched by
+ * publishing straight to the device's command topic on the broker Home
+ * Assistant uses, and their state topics are subscribed on the same
+ * connection. One persistent connection carries both, so a toggle costs a
+ * publish instead of an HTTP round trip through HA. Entities without a
+ * route, and every command while the broker is unreachable, keep going
+ * through the REST API.
+ *
+ * One route per line: "entity_id,command_topic,state_topic[,on,off]", the
+ * payloads default to ON and OFF. State payloads that match neither are
+ * passed on as they are, so sensors can be routed as well.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_MQTT_H
+#define HA_MQTT_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Routed entities */
+#define HA_MQTT_MAX_ROUTES 8
+
+  /** Topic length including terminator */
+#define HA_MQTT_TOPIC_LEN 96
+
+  /** Payload length including terminator */
+#define HA_MQTT_PAYLOAD_LEN 16
+
+  // =======================================================================
+  // CALLBACK TYPES
+  // =======================================================================
+
+  /**
+   * @brief State received on a routed entity's state topic
+   * @param entity_id Routed entity
+   * @param state "on" or "off" for the configured payloads, the payload itself otherwise
+   * @note Runs in the MQTT client task
+   */
+  typedef void (*ha_mqtt_state_callback_t)(const char *entity_id, const char *state);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the routes and connect to the broker
+   *
+   * The client keeps the connection up and resubscribes on its own.
+   *
+   * @param callback Function receiving states from the state topics
+   * @return ESP_OK, ESP_ERR_NOT_FOUND if no route is configured,
+   *         ESP_ERR_NOT_SUPPORTED if CONFIG_HA_MQTT is disabled, or an error
+   */
+  esp_err_t ha_mqtt_start(ha_mqtt_state_callback_t callback);
+
+  /**
+   * @brief Disconnect and release the client
+   */
+  void ha_mqtt_stop(void);
+
+  /**
+   * @brief Whether a switch command for this entity would go over MQTT now
+   */
+  bool ha_mqtt_routes(const char *entity_id);
+
+  /**
+   * @brief Publish a switch command on the entity's command topic
+   * @return ESP_OK once written to the socket, ESP_ERR_NOT_FOUND without a
+   *         route, ESP_ERR_INVALID_STATE while disconnected, ESP_FAIL if the
+   *         publish failed; the caller falls back to REST on any error
+   * @note Blocks for the socket write, call from the HA worker task
+   */
+  esp_err_t ha_mqtt_publish_switch(const char *entity_id, bool turn_on);
+
+  /**
+   * @brief Handle GET_MQTT
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an MQTT command
+   */
+  bool ha_mqtt_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_MQTT_H
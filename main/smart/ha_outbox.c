@@ -0,0 +1,403 @@
+/**
+ * @file ha_outbox.c
+ * @brief Commands held while Home Assistant is unreachable
+ *
+ * Records are kept in the order their command was issued; replacing one
+ * moves it to the end. The whole list is one NVS blob, written through
+ * nvs_store after every change.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_outbox.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "esp_http_client.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "wifi_time_sync.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define OUTBOX_NVS_NAMESPACE "ha_outbox"
+#define OUTBOX_NVS_KEY "commands"
+#define OUTBOX_BLOB_VERSION 1
+
+// Outages come with bursts of taps, they are stored together
+#define OUTBOX_SAVE_DELAY_MS 2000
+
+#define OUTBOX_US_PER_S 1000000LL
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief One held command as stored in NVS
+ */
+typedef struct
+{
+  char entity_id[HA_MAX_ENTITY_ID_LEN];
+  float level;      ///< HA_COMMAND_LEVEL
+  uint32_t held_at; ///< Wall-clock seconds, 0 if the clock was not set
+  uint8_t type;     ///< ha_command_type_t
+  bool turn_on;     ///< HA_COMMAND_SWITCH
+} outbox_record_t;
+
+/**
+ * @brief NVS layout, only the first count records are written
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t count;
+  outbox_record_t records[HA_OUTBOX_MAX];
+} outbox_blob_t;
+
+#define OUTBOX_BLOB_SIZE(count) (offsetof(outbox_blob_t, records) + (size_t)(count) * sizeof(outbox_record_t))
+
+/**
+ * @brief Runtime state of a record, not stored
+ */
+typedef struct
+{
+  int64_t held_us; ///< esp_timer time it was held, 0 for records loaded from NVS
+  uint32_t seq;    ///< Executor tag of the newest command, 0 until replayed after a restart
+  bool in_flight;  ///< Submitted, waiting for the executor's verdict
+} outbox_slot_t;
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static outbox_blob_t outbox = {.version = OUTBOX_BLOB_VERSION};
+static outbox_slot_t slots[HA_OUTBOX_MAX];
+static portMUX_TYPE outbox_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Replay order, lower goes first: the state of devices before scenes built on them
+ */
+static int command_priority(uint8_t type)
+{
+  switch (type)
+  {
+  case HA_COMMAND_SWITCH:
+    return 0;
+  case HA_COMMAND_LEVEL:
+    return 1;
+  default:
+    return 2;
+  }
+}
+#define OUTBOX_PRIORITIES 3
+
+static int find_record(const char *entity_id)
+{
+  for (int i = 0; i < outbox.count; i++)
+  {
+    if (strcmp(outbox.records[i].entity_id, entity_id) == 0)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Remove a record, keeping the issue order of the others (lock held)
+ */
+static void remove_record(int index)
+{
+  int tail = outbox.count - index - 1;
+  memmove(&outbox.records[index], &outbox.records[index + 1], tail * sizeof(outbox_record_t));
+  memmove(&slots[index], &slots[index + 1], tail * sizeof(outbox_slot_t));
+  outbox.count--;
+}
+
+/**
+ * @brief Store the list within OUTBOX_SAVE_DELAY_MS
+ */
+static void save_outbox(void)
+{
+  static outbox_blob_t copy; // Too big for the callers' stacks, only touched under the lock below
+  size_t size;
+
+  portENTER_CRITICAL(&outbox_lock);
+  size = OUTBOX_BLOB_SIZE(outbox.count);
+  memcpy(&copy, &outbox, size);
+  portEXIT_CRITICAL(&outbox_lock);
+
+  // nvs_store copies before returning, a concurrent save overwrites with newer data at worst
+  esp_err_t err = copy.count ? nvs_store_set(OUTBOX_NVS_NAMESPACE, OUTBOX_NVS_KEY, &copy, size, OUTBOX_SAVE_DELAY_MS)
+                             : nvs_store_erase(OUTBOX_NVS_NAMESPACE, OUTBOX_NVS_KEY, OUTBOX_SAVE_DELAY_MS);
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Held commands not stored: %s", esp_err_to_name(err));
+  }
+}
+
+/**
+ * @brief Seconds since a record was held, -1 if that cannot be known
+ */
+static int64_t record_age_s(const outbox_record_t *record, const outbox_slot_t *slot)
+{
+  if (slot->held_us)
+    return (esp_timer_get_time() - slot->held_us) / OUTBOX_US_PER_S;
+  if (record->held_at && wifi_time_sync_is_valid())
+    return (int64_t)time(NULL) - record->held_at;
+  return -1;
+}
+
+static void record_to_command(const outbox_record_t *record, uint32_t seq, ha_command_t *command)
+{
+  memset(command, 0, sizeof(*command));
+  command->type = (ha_command_type_t)record->type;
+  strlcpy(command->entity_id, record->entity_id, sizeof(command->entity_id));
+  command->turn_on = record->turn_on;
+  command->level = record->level;
+  command->seq = seq;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ha_outbox_init(void)
+{
+  size_t size = sizeof(outbox);
+  esp_err_t err = nvs_store_get(OUTBOX_NVS_NAMESPACE, OUTBOX_NVS_KEY, &outbox, &size);
+  if (err == ESP_OK && (size < offsetof(outbox_blob_t, records) || outbox.version != OUTBOX_BLOB_VERSION ||
+                        outbox.count > HA_OUTBOX_MAX || size != OUTBOX_BLOB_SIZE(outbox.count)))
+  {
+    debug_log_warning(DEBUG_TAG_SMART_HOME, "Stored held commands have an unknown layout, ignoring them");
+    err = ESP_ERR_INVALID_SIZE;
+  }
+
+  if (err != ESP_OK)
+  {
+    if (err != ESP_ERR_NVS_NOT_FOUND && err != ESP_ERR_INVALID_SIZE)
+    {
+      debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Held commands not loaded: %s", esp_err_to_name(err));
+    }
+    outbox.version = OUTBOX_BLOB_VERSION;
+    outbox.count = 0;
+    return ESP_OK;
+  }
+
+  // Never trust flash contents to be terminated
+  for (int i = 0; i < outbox.count; i++)
+  {
+    outbox.records[i].entity_id[HA_MAX_ENTITY_ID_LEN - 1] = '\0';
+  }
+  memset(slots, 0, sizeof(slots));
+
+  if (outbox.count)
+  {
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "%d commands held from before the restart", outbox.count);
+  }
+  return ESP_OK;
+}
+
+bool ha_outbox_is_transient(esp_err_t result)
+{
+  switch (result)
+  {
+  case HA_API_ERR_CIRCUIT_OPEN: // HA failing, requests are not even sent
+  case ESP_ERR_NOT_FOUND:       // No network
+  case ESP_ERR_INVALID_STATE:   // HA API not up yet
+  case ESP_ERR_TIMEOUT:
+  case ESP_FAIL:
+    return true;
+  default:
+    // Connect, read and write errors of the HTTP client
+    return result >= ESP_ERR_HTTP_BASE && result < ESP_ERR_HTTP_BASE + 0x100;
+  }
+}
+
+bool ha_outbox_hold(const ha_command_t *command)
+{
+  if (!command || (command->type != HA_COMMAND_SWITCH && command->type != HA_COMMAND_LEVEL &&
+                   command->type != HA_COMMAND_SCENE))
+    return false;
+
+  outbox_record_t record = {
+      .level = command->level,
+      .held_at = wifi_time_sync_is_valid() ? (uint32_t)time(NULL) : 0,
+      .type = (uint8_t)command->type,
+      .turn_on = command->turn_on,
+  };
+  strlcpy(record.entity_id, command->entity_id, sizeof(record.entity_id));
+  outbox_slot_t slot = {.held_us = esp_timer_get_time(), .seq = command->seq};
+
+  bool held = true;
+  portENTER_CRITICAL(&outbox_lock);
+  int index = find_record(command->entity_id);
+  if (index >= 0 && slots[index].seq > command->seq)
+  {
+    // A newer command for the entity is already held, this one is stale
+    index = -2;
+  }
+  else
+  {
+    // Last write wins and counts as issued now
+    if (index >= 0)
+      remove_record(index);
+    if (outbox.count < HA_OUTBOX_MAX)
+    {
+      outbox.records[outbox.count] = record;
+      slots[outbox.count] = slot;
+      outbox.count++;
+    }
+    else
+    {
+      held = false;
+    }
+  }
+  portEXIT_CRITICAL(&outbox_lock);
+
+  if (index == -2)
+    return true;
+  if (!held)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Outbox full, command for %s not held", command->entity_id);
+    return false;
+  }
+
+  save_outbox();
+  return true;
+}
+
+void ha_outbox_forget(const char *entity_id, uint32_t seq)
+{
+  if (!entity_id)
+    return;
+
+  bool removed = false;
+  portENTER_CRITICAL(&outbox_lock);
+  int index = find_record(entity_id);
+  if (index >= 0 && slots[index].seq <= seq)
+  {
+    remove_record(index);
+    removed = true;
+  }
+  portEXIT_CRITICAL(&outbox_lock);
+
+  if (removed)
+    save_outbox();
+}
+
+int ha_outbox_count(void)
+{
+  return outbox.count;
+}
+
+int ha_outbox_replay(ha_outbox_stale_callback_t stale_callback)
+{
+  ha_command_t commands[HA_OUTBOX_MAX];
+  ha_command_t stale[HA_OUTBOX_MAX];
+  int command_count = 0;
+  int stale_count = 0;
+
+  // Take the due commands in replay order, drop the ones that waited too long
+  portENTER_CRITICAL(&outbox_lock);
+  for (int priority = 0; priority < OUTBOX_PRIORITIES; priority++)
+  {
+    for (int i = 0; i < outbox.count; i++)
+    {
+      if (slots[i].in_flight || command_priority(outbox.records[i].type) != priority)
+        continue;
+      int64_t age_s = record_age_s(&outbox.records[i], &slots[i]);
+      if (age_s < 0 || age_s > HA_OUTBOX_MAX_AGE_S)
+      {
+        record_to_command(&outbox.records[i], slots[i].seq, &stale[stale_count++]);
+        continue;
+      }
+      record_to_command(&outbox.records[i], slots[i].seq, &commands[command_count++]);
+      slots[i].in_flight = true;
+    }
+  }
+  for (int i = 0; i < stale_count; i++)
+  {
+    remove_record(find_record(stale[i].entity_id));
+  }
+  portEXIT_CRITICAL(&outbox_lock);
+
+  for (int i = 0; i < stale_count; i++)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Held command for %s too old, dropped", stale[i].entity_id);
+    if (stale_callback)
+      stale_callback(&stale[i]);
+  }
+
+  int submitted = 0;
+  for (int i = 0; i < command_count; i++)
+  {
+    // A fresh tag for commands held before a restart, kept in the slot so forget() matches it
+    uint32_t held_seq = commands[i].seq;
+    esp_err_t err = ha_executor_submit(&commands[i]);
+
+    portENTER_CRITICAL(&outbox_lock);
+    int index = find_record(commands[i].entity_id);
+    if (index >= 0 && slots[index].seq == held_seq)
+    {
+      slots[index].in_flight = err == ESP_OK;
+      slots[index].seq = commands[i].seq;
+    }
+    portEXIT_CRITICAL(&outbox_lock);
+
+    if (err == ESP_OK)
+      submitted++;
+  }
+
+  if (stale_count)
+    save_outbox();
+  if (submitted)
+  {
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "Replaying %d held commands", submitted);
+  }
+  return submitted;
+}
+
+bool ha_outbox_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_OUTBOX") != 0)
+    return false;
+
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf), "OUTBOX {\"max\":%d,\"max_age_s\":%d,\"commands\":[", HA_OUTBOX_MAX,
+                     HA_OUTBOX_MAX_AGE_S);
+  serial_data_write(buf, len);
+
+  for (int i = 0; i < HA_OUTBOX_MAX; i++)
+  {
+    portENTER_CRITICAL(&outbox_lock);
+    if (i >= outbox.count)
+    {
+      portEXIT_CRITICAL(&outbox_lock);
+      break;
+    }
+    outbox_record_t record = outbox.records[i];
+    outbox_slot_t slot = slots[i];
+    portEXIT_CRITICAL(&outbox_lock);
+
+    len = snprintf(buf, sizeof(buf), "%s{\"entity_id\":\"%s\",\"type\":%u,\"on\":%s,\"level\":%.1f,\"age_s\":%lld,"
+                                     "\"in_flight\":%s}",
+                   i ? "," : "", record.entity_id, (unsigned)record.type, record.turn_on ? "true" : "false",
+                   (double)record.level, (long long)record_age_s(&record, &slot), slot.in_flight ? "true" : "false");
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+  return true;
+}
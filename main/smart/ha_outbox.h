@@ -0,0 +1,109 @@
+/**
+ * @file ha_outbox.h
+ * @brief Commands held while Home Assistant is unreachable
+ *
+ * A switch, level or scene command that fails because HA or WiFi is down
+ * is not rolled back but kept here, one desired state per entity: a newer
+ * command for the same entity replaces the held one, so a burst of taps
+ * during an outage costs one request afterwards. The list is bounded,
+ * stored in NVS, and replayed through the executor once HA answers again,
+ * switches first, then levels, then scenes, each group in the order it was
+ * issued. Commands older than HA_OUTBOX_MAX_AGE_S are dropped instead.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_OUTBOX_H
+#define HA_OUTBOX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ha_executor.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Entities with a held command, a command for one more is not held */
+#define HA_OUTBOX_MAX 16
+
+  /** Held commands older than this are dropped instead of replayed */
+#ifdef CONFIG_HA_OUTBOX_MAX_AGE_S
+#define HA_OUTBOX_MAX_AGE_S CONFIG_HA_OUTBOX_MAX_AGE_S
+#else
+#define HA_OUTBOX_MAX_AGE_S 600
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Called for a held command that is dropped as too old
+   */
+  typedef void (*ha_outbox_stale_callback_t)(const ha_command_t *command);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the commands held before the last restart
+   * @return ESP_OK, also when nothing is stored
+   * @note Call once after nvs_store_init()
+   */
+  esp_err_t ha_outbox_init(void);
+
+  /**
+   * @brief Whether a failed command should be held rather than rolled back
+   * @param result Result the executor reported
+   * @return true for transport errors and open circuits, false for success
+   *         and for commands HA itself could not take
+   */
+  bool ha_outbox_is_transient(esp_err_t result);
+
+  /**
+   * @brief Hold a command, replacing any held one for the same entity
+   * @return false if the command kind is not held or the outbox is full
+   */
+  bool ha_outbox_hold(const ha_command_t *command);
+
+  /**
+   * @brief Drop the held command of an entity once a command reached HA
+   * @param entity_id Entity the finished command was for
+   * @param seq Sequence tag of that command; a held command issued after it stays
+   */
+  void ha_outbox_forget(const char *entity_id, uint32_t seq);
+
+  /**
+   * @brief Number of held commands
+   */
+  int ha_outbox_count(void);
+
+  /**
+   * @brief Submit the held commands to the executor
+   * @param stale_callback Receives commands dropped as too old (may be NULL)
+   * @return Number of commands submitted
+   * @note Never blocks; commands the executor queue cannot take stay held
+   */
+  int ha_outbox_replay(ha_outbox_stale_callback_t stale_callback);
+
+  /**
+   * @brief Handle GET_OUTBOX
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an outbox command
+   */
+  bool ha_outbox_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_OUTBOX_H
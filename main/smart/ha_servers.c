@@ -0,0 +1,418 @@
+/**
+ * @file ha_servers.c
+ * @brief Home Assistant server failover implementation
+ *
+ * Server health is fed from two sides: every request reports its outcome,
+ * so a dead server is noticed on the next tap, and the probe task measures
+ * every server so a healthy one is known before it is needed. All state
+ * sits behind one spinlock; the switch callback runs outside of it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_servers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "ha_api.h"
+#include "serial/serial_data_handler.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+/** Scheme, host and port of HA_SERVER_HOST_NAME, the prefix of every HA API URL */
+#define PRIMARY_BASE_URL HA_HTTP_SCHEME HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT)
+
+#ifndef HA_WEBSOCKET_URL
+#define HA_WEBSOCKET_URL "ws://" HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT) "/api/websocket"
+#endif
+
+#if CONFIG_HA_SERVER_FAILOVER && defined(HA_SERVER_ALT_URLS)
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define SERVER_FAIL_THRESHOLD 2 ///< Failures in a row that mark a server down
+#define SERVER_FASTER_ROUNDS 2  ///< Probe rounds another server must win before it takes over
+#define PROBE_STOP_WAIT_MS (HA_HTTP_TIMEOUT_MS + 1000)
+
+static const char *const server_urls[] = {PRIMARY_BASE_URL, HA_SERVER_ALT_URLS};
+#define SERVER_COUNT ((int)(sizeof(server_urls) / sizeof(server_urls[0])))
+_Static_assert(SERVER_COUNT <= HA_SERVERS_MAX, "HA_SERVER_ALT_URLS lists more than HA_SERVERS_MAX - 1 URLs");
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+/**
+ * @brief What is known about one server
+ */
+typedef struct
+{
+  bool healthy;
+  uint8_t failures;      ///< Failed requests and probes in a row
+  uint8_t faster_rounds; ///< Probe rounds in a row it beat the active server by the margin
+  uint32_t latency_ms;   ///< Smoothed probe latency, 0 before the first answer
+  uint32_t probes;
+} server_state_t;
+
+static server_state_t servers[SERVER_COUNT];
+static int active_server = HA_SERVERS_PRIMARY;
+static uint32_t switch_count = 0;
+static portMUX_TYPE servers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static ha_servers_switch_callback_t switch_callback = NULL;
+static TaskHandle_t probe_task_handle = NULL;
+static volatile bool probe_running = false;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Healthy server with the lowest latency, servers not yet measured last
+ * @return Index, or -1 if every server is down
+ * @note Call with servers_lock held
+ */
+static int fastest_healthy_locked(void)
+{
+  int best = -1;
+  for (int i = 0; i < SERVER_COUNT; i++)
+  {
+    if (!servers[i].healthy)
+      continue;
+    if (best < 0 || (servers[i].latency_ms &&
+                     (!servers[best].latency_ms || servers[i].latency_ms < servers[best].latency_ms)))
+      best = i;
+  }
+  return best;
+}
+
+/**
+ * @brief Make a server the active one
+ * @note Call with servers_lock held
+ */
+static void switch_to_locked(int server)
+{
+  active_server = server;
+  switch_count++;
+  for (int i = 0; i < SERVER_COUNT; i++)
+    servers[i].faster_rounds = 0;
+}
+
+/**
+ * @brief Announce a switch, outside the lock
+ */
+static void announce_switch(int server, const char *reason)
+{
+  debug_log_warning_f(DEBUG_TAG_HA_API, "HA requests move to %s (%s)", server_urls[server], reason);
+  ha_servers_switch_callback_t callback = switch_callback;
+  if (callback)
+    callback(server);
+}
+
+/**
+ * @brief Count a failure or success of a server
+ * @return Index of the server that took over, -1 if the active one stays
+ */
+static int record_result(int server, bool reachable)
+{
+  int took_over = -1;
+
+  portENTER_CRITICAL(&servers_lock);
+  server_state_t *state = &servers[server];
+  if (reachable)
+  {
+    state->healthy = true;
+    state->failures = 0;
+  }
+  else
+  {
+    if (state->failures < UINT8_MAX)
+      state->failures++;
+    if (state->failures >= SERVER_FAIL_THRESHOLD)
+      state->healthy = false;
+
+    if (!servers[active_server].healthy)
+    {
+      int best = fastest_healthy_locked();
+      if (best >= 0)
+      {
+        switch_to_locked(best);
+        took_over = best;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&servers_lock);
+
+  if (took_over >= 0)
+    announce_switch(took_over, "server down");
+  return took_over;
+}
+
+/**
+ * @brief Move to a healthy server that has been clearly faster for a while,
+ *        or to any healthy one if the active server is down
+ * @note After each probe round
+ */
+static void evaluate_round(void)
+{
+  int took_over = -1;
+
+  portENTER_CRITICAL(&servers_lock);
+  const server_state_t *active = &servers[active_server];
+  for (int i = 0; i < SERVER_COUNT; i++)
+  {
+    server_state_t *state = &servers[i];
+    bool faster = i != active_server && state->healthy && active->healthy && state->latency_ms &&
+                  active->latency_ms &&
+                  state->latency_ms * 100 <= active->latency_ms * (100 - CONFIG_HA_SERVER_SWITCH_MARGIN_PCT);
+    state->faster_rounds = faster ? state->faster_rounds + 1 : 0;
+    if (state->faster_rounds >= SERVER_FASTER_ROUNDS &&
+        (took_over < 0 || state->latency_ms < servers[took_over].latency_ms))
+      took_over = i;
+  }
+  const char *reason = "faster";
+  if (!active->healthy)
+  {
+    // Everything was down when the active server failed, take the first one back
+    took_over = fastest_healthy_locked();
+    reason = "server back";
+  }
+  if (took_over >= 0)
+    switch_to_locked(took_over);
+  portEXIT_CRITICAL(&servers_lock);
+
+  if (took_over >= 0)
+    announce_switch(took_over, reason);
+}
+
+/**
+ * @brief Probe every server each CONFIG_HA_SERVER_PROBE_S
+ */
+static void probe_task(void *arg)
+{
+  while (probe_running)
+  {
+    for (int i = 0; i < SERVER_COUNT && probe_running; i++)
+    {
+      uint32_t latency_ms = 0;
+      esp_err_t err = ha_api_probe_server(i, &latency_ms);
+      if (err == ESP_ERR_INVALID_STATE)
+        break; // No WiFi or no API, nothing learned about the servers
+
+      if (err == ESP_OK)
+      {
+        portENTER_CRITICAL(&servers_lock);
+        server_state_t *state = &servers[i];
+        if (latency_ms == 0)
+          latency_ms = 1;
+        state->latency_ms = state->latency_ms ? (state->latency_ms * 3 + latency_ms) / 4 : latency_ms;
+        state->probes++;
+        portEXIT_CRITICAL(&servers_lock);
+      }
+      record_result(i, err == ESP_OK);
+    }
+    evaluate_round();
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_HA_SERVER_PROBE_S * 1000));
+  }
+
+  probe_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_servers_start(ha_servers_switch_callback_t callback)
+{
+  if (probe_running)
+    return ESP_OK;
+
+  switch_callback = callback;
+  portENTER_CRITICAL(&servers_lock);
+  for (int i = 0; i < SERVER_COUNT; i++)
+  {
+    servers[i] = (server_state_t){.healthy = true};
+  }
+  portEXIT_CRITICAL(&servers_lock);
+
+  probe_running = true;
+  if (task_plan_create(TASK_PLAN_HA_PROBE, probe_task, NULL, &probe_task_handle) != pdPASS)
+  {
+    probe_running = false;
+    debug_log_error(DEBUG_TAG_HA_API, "Failed to create HA server probe task");
+    return ESP_ERR_NO_MEM;
+  }
+
+  debug_log_info_f(DEBUG_TAG_HA_API, "HA failover across %d servers, probing every %d s", SERVER_COUNT,
+                   CONFIG_HA_SERVER_PROBE_S);
+  return ESP_OK;
+}
+
+void ha_servers_stop(void)
+{
+  if (!probe_running)
+    return;
+
+  probe_running = false;
+  TaskHandle_t task = probe_task_handle;
+  if (task)
+    xTaskNotifyGive(task);
+
+  // The probe uses the API clients, it has to be done before they are freed
+  for (int waited = 0; probe_task_handle && waited < PROBE_STOP_WAIT_MS; waited += 50)
+    vTaskDelay(pdMS_TO_TICKS(50));
+}
+
+int ha_servers_active(void)
+{
+  portENTER_CRITICAL(&servers_lock);
+  int server = active_server;
+  portEXIT_CRITICAL(&servers_lock);
+  return server;
+}
+
+const char *ha_servers_base_url(int server)
+{
+  return server >= 0 && server < SERVER_COUNT ? server_urls[server] : NULL;
+}
+
+const char *ha_servers_apply(const char *url, char *buffer, size_t size, int *server)
+{
+  int active = ha_servers_active();
+  static const char primary[] = PRIMARY_BASE_URL;
+  if (active == HA_SERVERS_PRIMARY || strncmp(url, primary, sizeof(primary) - 1) != 0)
+  {
+    *server = HA_SERVERS_PRIMARY;
+    return url;
+  }
+
+  int len = snprintf(buffer, size, "%s%s", server_urls[active], url + sizeof(primary) - 1);
+  if (len < 0 || (size_t)len >= size)
+  {
+    *server = HA_SERVERS_PRIMARY;
+    return url;
+  }
+  *server = active;
+  return buffer;
+}
+
+const char *ha_servers_websocket_url(char *buffer, size_t size, int *server)
+{
+  int active = ha_servers_active();
+  const char *url = server_urls[active];
+  if (server)
+    *server = active;
+  if (active == HA_SERVERS_PRIMARY)
+  {
+    snprintf(buffer, size, "%s", HA_WEBSOCKET_URL);
+  }
+  else if (strncmp(url, "https://", 8) == 0)
+  {
+    snprintf(buffer, size, "wss://%s/api/websocket", url + 8);
+  }
+  else
+  {
+    snprintf(buffer, size, "ws://%s/api/websocket", strncmp(url, "http://", 7) == 0 ? url + 7 : url);
+  }
+  return buffer;
+}
+
+bool ha_servers_report(int server, bool reachable)
+{
+  if (server < 0 || server >= SERVER_COUNT)
+    return false;
+
+  if (record_result(server, reachable) >= 0)
+    return true;
+
+  // Another request already moved on, this one follows
+  return !reachable && ha_servers_active() != server;
+}
+
+bool ha_servers_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_HA_SERVERS") != 0)
+    return false;
+
+  server_state_t snapshot[SERVER_COUNT];
+  portENTER_CRITICAL(&servers_lock);
+  memcpy(snapshot, servers, sizeof(snapshot));
+  int active = active_server;
+  uint32_t switches = switch_count;
+  portEXIT_CRITICAL(&servers_lock);
+
+  char buf[160 + SERVER_COUNT * (HA_SERVERS_URL_LEN + 96)];
+  int len = snprintf(buf, sizeof(buf), "HA_SERVERS {\"active\":%d,\"switches\":%lu,\"servers\":[", active,
+                     (unsigned long)switches);
+  for (int i = 0; i < SERVER_COUNT; i++)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    "%s{\"url\":\"%.*s\",\"healthy\":%s,\"latency_ms\":%lu,\"failures\":%u,\"probes\":%lu}",
+                    i ? "," : "", HA_SERVERS_URL_LEN, server_urls[i], snapshot[i].healthy ? "true" : "false",
+                    (unsigned long)snapshot[i].latency_ms, snapshot[i].failures, (unsigned long)snapshot[i].probes);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "]}\n");
+  serial_data_write(buf, len);
+  return true;
+}
+
+#else
+
+esp_err_t ha_servers_start(ha_servers_switch_callback_t callback)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ha_servers_stop(void)
+{
+}
+
+int ha_servers_active(void)
+{
+  return HA_SERVERS_PRIMARY;
+}
+
+const char *ha_servers_base_url(int server)
+{
+  return server == HA_SERVERS_PRIMARY ? PRIMARY_BASE_URL : NULL;
+}
+
+const char *ha_servers_apply(const char *url, char *buffer, size_t size, int *server)
+{
+  *server = HA_SERVERS_PRIMARY;
+  return url;
+}
+
+const char *ha_servers_websocket_url(char *buffer, size_t size, int *server)
+{
+  if (server)
+    *server = HA_SERVERS_PRIMARY;
+  snprintf(buffer, size, "%s", HA_WEBSOCKET_URL);
+  return buffer;
+}
+
+bool ha_servers_report(int server, bool reachable)
+{
+  return false;
+}
+
+bool ha_servers_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_HA_SERVERS") != 0)
+    return false;
+
+  static const char disabled[] = "HA_SERVERS {\"enabled\":false}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_HA_SERVER_FAILOVER && HA_SERVER_ALT_URLS
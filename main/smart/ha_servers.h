@@ -0,0 +1,123 @@
+/**
+ * @file ha_servers.h
+ * @brief Failover between several Home Assistant URLs
+ *
+ * The same Home Assistant can often be reached more than one way, e.g. the
+ * local instance and the Nabu Casa remote URL. With CONFIG_HA_SERVER_FAILOVER
+ * the URLs in HA_SERVER_ALT_URLS (smart_config.h) back up the primary
+ * HA_SERVER_HOST_NAME: every request is sent to the active server, so the
+ * pooled connections follow it, and a server that fails twice in a row is
+ * marked down and the request goes on at the fastest healthy one.
+ *
+ * A low priority task probes every server each CONFIG_HA_SERVER_PROBE_S on
+ * a keep-alive connection of its own and keeps a smoothed latency. The
+ * active server is sticky: another one takes over only once the active is
+ * down, or once it has been faster by CONFIG_HA_SERVER_SWITCH_MARGIN_PCT in
+ * two probe rounds in a row. So the panel moves to the remote URL while the
+ * local HA restarts and back once it answers again.
+ *
+ * GET_HA_SERVERS reports the servers:
+ *   HA_SERVERS {"active":0,"switches":2,"servers":[{"url":"http://homeassistant:8123","healthy":true,
+ *               "latency_ms":9,"failures":0,"probes":41},...]}
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_SERVERS_H
+#define HA_SERVERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define HA_SERVERS_MAX 4      ///< Primary plus alternative URLs
+#define HA_SERVERS_PRIMARY 0  ///< Index of HA_SERVER_HOST_NAME
+#define HA_SERVERS_URL_LEN 96 ///< Scheme, host and port of a server
+
+  /**
+   * @brief The active server changed
+   * @param server Index of the new active server
+   * @note Runs in the task that noticed, keep it short
+   */
+  typedef void (*ha_servers_switch_callback_t)(int server);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start probing the configured servers
+   * @param callback Called whenever the active server changes, may be NULL
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if CONFIG_HA_SERVER_FAILOVER is disabled or
+   *         no alternative URL is configured, or an error
+   * @note Call after ha_api_init(), the probes are HA API requests
+   */
+  esp_err_t ha_servers_start(ha_servers_switch_callback_t callback);
+
+  /**
+   * @brief Stop probing, waits for a probe in flight
+   * @note Requests keep going to the server that was active
+   */
+  void ha_servers_stop(void);
+
+  /**
+   * @brief Index of the server requests currently go to
+   */
+  int ha_servers_active(void);
+
+  /**
+   * @brief Scheme, host and port of a server, without a trailing slash
+   * @return URL, or NULL for an unknown index
+   */
+  const char *ha_servers_base_url(int server);
+
+  /**
+   * @brief Point a URL of the primary server at the active one
+   * @param url URL starting with HA_API_BASE_URL
+   * @param buffer Receives the rewritten URL
+   * @param size Size of buffer
+   * @param server Receives the index of the server the result points at
+   * @return buffer, or url itself if the primary is active or the URL is not rewritten
+   */
+  const char *ha_servers_apply(const char *url, char *buffer, size_t size, int *server);
+
+  /**
+   * @brief WebSocket URL of the active server
+   * @param buffer Receives the URL
+   * @param size Size of buffer
+   * @param server Receives the index of the server, may be NULL
+   * @return buffer
+   */
+  const char *ha_servers_websocket_url(char *buffer, size_t size, int *server);
+
+  /**
+   * @brief Feed the outcome of a request into its server's health
+   * @param server Index from ha_servers_apply()
+   * @param reachable The server answered, with anything but a 5xx status
+   * @return true if another server took over and the request may go on there
+   * @note Any task
+   */
+  bool ha_servers_report(int server, bool reachable);
+
+  /**
+   * @brief Handle GET_HA_SERVERS
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a servers command
+   */
+  bool ha_servers_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_SERVERS_H
@@ -0,0 +1,793 @@
+/**
+ * @file ha_share.c
+ * @brief Entity states shared between panels over ESP-NOW
+ *
+ * Every frame is a broadcast on the STA channel: a header, entries for
+ * STATES frames, and a truncated HMAC-SHA256 over both. Fields are packed
+ * little-endian, all panels run the same firmware. The receive callback
+ * runs in the WiFi task and only queues the frame; checking, applying and
+ * the election all happen in the share task, so the role and the leader
+ * fields need no lock. Only the dirty mask is written from other tasks.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_share.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+#if CONFIG_HA_SHARE
+
+#include "esp_mac.h"
+#include "esp_now.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "ha_entity_registry.h"
+#include "ha_status.h"
+#include "mbedtls/md.h"
+#include "smart_config.h"
+#include "task_plan.h"
+#include "utils/shared_state.h"
+
+#ifndef HA_SHARE_KEY
+#define HA_SHARE_KEY HA_API_TOKEN
+#endif
+
+#define SHARE_MAGIC 0x5348 ///< "HS"
+#define SHARE_VERSION 1
+#define SHARE_TAG_LEN 8
+#define SHARE_RX_QUEUE_LEN 8
+#define SHARE_FLUSH_MS 20       ///< Changes are batched this long before they go out
+#define SHARE_JITTER_MAX_MS 500 ///< Spreads takeovers, derived from the MAC
+
+#define SHARE_BEACON_US ((int64_t)CONFIG_HA_SHARE_BEACON_MS * 1000)
+#define SHARE_TIMEOUT_US ((int64_t)CONFIG_HA_SHARE_LEADER_TIMEOUT_MS * 1000)
+#define SHARE_SNAPSHOT_US ((int64_t)CONFIG_HA_SHARE_SNAPSHOT_S * 1000000)
+
+_Static_assert(HA_REGISTRY_MAX_ENTITIES <= 32, "dirty mask holds one bit per registry entry");
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+enum
+{
+  FRAME_BEACON = 1,   ///< Leader heartbeat
+  FRAME_STATES,       ///< Entity states from the leader
+  FRAME_SNAPSHOT_REQ, ///< A new follower asks for every state
+};
+
+#define ENTRY_FOUND (1u << 0)
+#define ENTRY_ON (1u << 1)
+#define ENTRY_LEVEL (1u << 2)
+
+typedef struct __attribute__((packed))
+{
+  uint16_t magic;
+  uint8_t version;
+  uint8_t type;
+  uint32_t group; ///< Server and entity list fingerprint
+  uint32_t term;  ///< Leadership the sender claims, 0 from followers
+  uint32_t seq;   ///< Per sender, increasing
+  uint8_t priority;
+  uint8_t ha_status; ///< ha_status_t of the sender
+  uint8_t count;     ///< Entries of a STATES frame
+  uint8_t reserved;
+} share_header_t;
+
+typedef struct __attribute__((packed))
+{
+  uint8_t index; ///< Registry index
+  uint8_t kind;  ///< ha_state_kind_t
+  uint8_t flags; ///< ENTRY_*
+  uint8_t text_len;
+  float value;
+  uint32_t last_changed;
+  // text_len bytes of state text or unit follow, no terminator
+} share_entry_t;
+
+typedef struct
+{
+  uint8_t src[ESP_NOW_ETH_ALEN];
+  uint16_t len; ///< 0 only wakes the task
+  uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} rx_frame_t;
+
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+static QueueHandle_t rx_queue = NULL;
+static TaskHandle_t share_task_handle = NULL;
+static volatile bool stop_requested = false;
+static ha_share_get_callback_t get_callback = NULL;
+static ha_share_apply_callback_t apply_callback = NULL;
+static ha_share_role_callback_t role_callback = NULL;
+
+static uint32_t role = HA_SHARE_OFF; ///< ha_share_role_t, shared_state.h access
+static uint8_t own_mac[ESP_NOW_ETH_ALEN];
+static uint32_t group_id = 0;
+static uint32_t jitter_us = 0;
+
+// Share task only
+static uint8_t leader_mac[ESP_NOW_ETH_ALEN];
+static uint8_t leader_priority = 0;
+static uint32_t leader_term = 0;
+static uint32_t leader_seq = 0;
+static uint32_t highest_term = 0;
+static uint32_t tx_seq = 0;
+static uint8_t applied_ha_status = 0xff;
+static int64_t role_since_us = 0;
+static int64_t last_beacon_us = 0; ///< Heard from the leader, or sent when leading
+static int64_t last_snapshot_us = 0;
+
+// Written by any task
+static portMUX_TYPE dirty_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t dirty_mask = 0;
+static int64_t dirty_since_us = 0;
+static bool snapshot_wanted = false;
+
+// Counters for GET_HA_SHARE
+static uint32_t frames_sent = 0;
+static uint32_t send_failures = 0;
+static uint32_t frames_received = 0;
+static uint32_t states_applied = 0;
+static uint32_t bad_frames = 0; ///< Wrong group, version or tag
+static uint32_t stale_frames = 0;
+static uint32_t takeovers = 0;
+static volatile uint32_t rx_dropped = 0;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static const char *role_name(ha_share_role_t value)
+{
+  switch (value)
+  {
+  case HA_SHARE_ELECTING:
+    return "electing";
+  case HA_SHARE_LEADER:
+    return "leader";
+  case HA_SHARE_FOLLOWER:
+    return "follower";
+  default:
+    return "off";
+  }
+}
+
+static uint32_t fnv1a(uint32_t hash, const char *text)
+{
+  for (const unsigned char *p = (const unsigned char *)text; *p; p++)
+  {
+    hash ^= *p;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Panels only share with panels of the same server and entity list
+ */
+static uint32_t compute_group_id(void)
+{
+  uint32_t hash = fnv1a(2166136261u, HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT));
+  const char *const *ids = ha_registry_entity_ids();
+  for (int i = 0; i < ha_registry_count(); i++)
+  {
+    hash = fnv1a(hash, "\n");
+    hash = fnv1a(hash, ids[i]);
+  }
+  return hash;
+}
+
+static void frame_tag(const uint8_t *frame, size_t len, uint8_t tag[SHARE_TAG_LEN])
+{
+  uint8_t full[32];
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char *)HA_SHARE_KEY,
+                  strlen(HA_SHARE_KEY), frame, len, full);
+  memcpy(tag, full, SHARE_TAG_LEN);
+}
+
+/**
+ * @brief First rank stays leader: higher priority, then lower MAC
+ */
+static bool outranks(uint8_t priority_a, const uint8_t *mac_a, uint8_t priority_b, const uint8_t *mac_b)
+{
+  if (priority_a != priority_b)
+    return priority_a > priority_b;
+  return memcmp(mac_a, mac_b, ESP_NOW_ETH_ALEN) < 0;
+}
+
+static void set_role(ha_share_role_t next, int64_t now_us)
+{
+  ha_share_role_t previous = (ha_share_role_t)shared_load_u32(&role);
+  if (previous == next)
+    return;
+  shared_store_u32(&role, next);
+  role_since_us = now_us;
+  debug_log_info_f(DEBUG_TAG_SMART_HOME, "HA share: %s -> %s", role_name(previous), role_name(next));
+  if (role_callback)
+    role_callback(next);
+}
+
+static void fill_header(share_header_t *header, uint8_t type, uint8_t count)
+{
+  bool leading = shared_load_u32(&role) == HA_SHARE_LEADER;
+  *header = (share_header_t){
+      .magic = SHARE_MAGIC,
+      .version = SHARE_VERSION,
+      .type = type,
+      .group = group_id,
+      .term = leading ? leader_term : 0,
+      .seq = ++tx_seq,
+      .priority = CONFIG_HA_SHARE_PRIORITY,
+      .ha_status = (uint8_t)ha_status_get_current(),
+      .count = count,
+  };
+}
+
+/**
+ * @brief Tag and broadcast a frame, frame must have room for the tag
+ */
+static bool send_frame(uint8_t *frame, size_t len)
+{
+  frame_tag(frame, len, frame + len);
+  esp_err_t err = esp_now_send(broadcast_mac, frame, len + SHARE_TAG_LEN);
+  if (err != ESP_OK)
+  {
+    send_failures++;
+    return false;
+  }
+  frames_sent++;
+  return true;
+}
+
+static void send_simple(uint8_t type)
+{
+  uint8_t frame[sizeof(share_header_t) + SHARE_TAG_LEN];
+  fill_header((share_header_t *)frame, type, 0);
+  send_frame(frame, sizeof(share_header_t));
+}
+
+static void mark_all_dirty(void)
+{
+  uint32_t all = ha_registry_count() >= 32 ? UINT32_MAX : ((1u << ha_registry_count()) - 1);
+  portENTER_CRITICAL(&dirty_lock);
+  dirty_mask |= all;
+  dirty_since_us = 0; // Due right away
+  portEXIT_CRITICAL(&dirty_lock);
+}
+
+static void become_leader(int64_t now_us)
+{
+  leader_term = highest_term + 1;
+  highest_term = leader_term;
+  memcpy(leader_mac, own_mac, sizeof(leader_mac));
+  leader_priority = CONFIG_HA_SHARE_PRIORITY;
+  takeovers++;
+  set_role(HA_SHARE_LEADER, now_us);
+
+  send_simple(FRAME_BEACON);
+  last_beacon_us = now_us;
+  // Followers may have missed changes while nobody led
+  mark_all_dirty();
+  last_snapshot_us = now_us;
+}
+
+static void become_follower(const uint8_t *mac, const share_header_t *header, int64_t now_us)
+{
+  memcpy(leader_mac, mac, sizeof(leader_mac));
+  leader_priority = header->priority;
+  leader_term = header->term;
+  leader_seq = 0;
+  set_role(HA_SHARE_FOLLOWER, now_us);
+  portENTER_CRITICAL(&dirty_lock);
+  dirty_mask = 0;
+  portEXIT_CRITICAL(&dirty_lock);
+  send_simple(FRAME_SNAPSHOT_REQ);
+}
+
+/**
+ * @brief Append one entry
+ * @return Bytes written, 0 if it does not fit in room
+ */
+static size_t encode_entry(uint8_t *out, size_t room, int index, const ha_entity_state_t *state)
+{
+  const char *text = state->text != HA_ATOM_NONE ? ha_atom_str(state->text) : "";
+  size_t text_len = strnlen(text, HA_ATOM_MAX_LEN);
+  if (sizeof(share_entry_t) + text_len > room)
+    return 0;
+
+  share_entry_t entry = {
+      .index = (uint8_t)index,
+      .kind = state->kind,
+      .flags = (state->found ? ENTRY_FOUND : 0) | (state->is_on ? ENTRY_ON : 0) | (state->has_level ? ENTRY_LEVEL : 0),
+      .text_len = (uint8_t)text_len,
+      .value = state->value,
+      .last_changed = state->last_changed,
+  };
+  memcpy(out, &entry, sizeof(entry));
+  memcpy(out + sizeof(entry), text, text_len);
+  return sizeof(entry) + text_len;
+}
+
+/**
+ * @brief Broadcast the dirty states, packed as many per frame as fit
+ */
+static void flush_states(void)
+{
+  portENTER_CRITICAL(&dirty_lock);
+  uint32_t pending = dirty_mask;
+  dirty_mask = 0;
+  portEXIT_CRITICAL(&dirty_lock);
+
+  uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+  const size_t body_end = sizeof(frame) - SHARE_TAG_LEN;
+  size_t len = sizeof(share_header_t);
+  uint32_t frame_bits = 0;
+  uint32_t failed_bits = 0;
+  int count = 0;
+
+  for (int index = 0; pending; index++)
+  {
+    uint32_t bit = 1u << index;
+    if (!(pending & bit))
+      continue;
+    pending &= ~bit;
+
+    ha_entity_state_t state;
+    if (!get_callback || !get_callback(index, &state))
+      continue;
+
+    size_t written = encode_entry(frame + len, body_end - len, index, &state);
+    if (written == 0)
+    {
+      fill_header((share_header_t *)frame, FRAME_STATES, (uint8_t)count);
+      if (!send_frame(frame, len))
+        failed_bits |= frame_bits;
+      len = sizeof(share_header_t);
+      frame_bits = 0;
+      count = 0;
+      written = encode_entry(frame + len, body_end - len, index, &state);
+    }
+    len += written;
+    frame_bits |= bit;
+    count++;
+  }
+
+  if (count > 0)
+  {
+    fill_header((share_header_t *)frame, FRAME_STATES, (uint8_t)count);
+    if (!send_frame(frame, len))
+      failed_bits |= frame_bits;
+  }
+
+  // ESP-NOW is out of buffers, try again with the next flush
+  if (failed_bits)
+  {
+    portENTER_CRITICAL(&dirty_lock);
+    if (!dirty_mask)
+      dirty_since_us = esp_timer_get_time();
+    dirty_mask |= failed_bits;
+    portEXIT_CRITICAL(&dirty_lock);
+  }
+}
+
+static void apply_states(const share_header_t *header, const uint8_t *body, size_t body_len)
+{
+  int indices[HA_REGISTRY_MAX_ENTITIES];
+  ha_entity_state_t states[HA_REGISTRY_MAX_ENTITIES];
+  int count = 0;
+  size_t offset = 0;
+
+  for (int i = 0; i < header->count && count < HA_REGISTRY_MAX_ENTITIES; i++)
+  {
+    share_entry_t entry;
+    if (offset + sizeof(entry) > body_len)
+      break;
+    memcpy(&entry, body + offset, sizeof(entry));
+    offset += sizeof(entry);
+    if (entry.text_len > HA_ATOM_MAX_LEN || offset + entry.text_len > body_len)
+      break;
+    if (entry.index >= ha_registry_count() || entry.kind > HA_STATE_TEXT)
+    {
+      offset += entry.text_len;
+      continue;
+    }
+
+    char text[HA_ATOM_MAX_LEN + 1];
+    memcpy(text, body + offset, entry.text_len);
+    text[entry.text_len] = '\0';
+    offset += entry.text_len;
+
+    ha_entity_state_t *state = &states[count];
+    memset(state, 0, sizeof(*state));
+    state->kind = entry.kind;
+    state->found = entry.flags & ENTRY_FOUND;
+    state->is_on = entry.flags & ENTRY_ON;
+    state->has_level = entry.flags & ENTRY_LEVEL;
+    state->value = entry.value;
+    state->last_changed = entry.last_changed;
+    state->text = entry.text_len ? ha_atom_intern(text) : HA_ATOM_NONE;
+    indices[count++] = entry.index;
+  }
+
+  if (count > 0 && apply_callback)
+  {
+    apply_callback(indices, states, count);
+    states_applied += count;
+  }
+}
+
+/**
+ * @brief Check a received frame and act on it, share task
+ */
+static void handle_frame(const rx_frame_t *rx, int64_t now_us)
+{
+  if (rx->len < sizeof(share_header_t) + SHARE_TAG_LEN)
+  {
+    bad_frames++;
+    return;
+  }
+
+  share_header_t header;
+  memcpy(&header, rx->data, sizeof(header));
+  size_t signed_len = rx->len - SHARE_TAG_LEN;
+  if (header.magic != SHARE_MAGIC || header.version != SHARE_VERSION || header.group != group_id)
+  {
+    bad_frames++;
+    return;
+  }
+  uint8_t tag[SHARE_TAG_LEN];
+  frame_tag(rx->data, signed_len, tag);
+  uint8_t diff = 0;
+  for (int i = 0; i < SHARE_TAG_LEN; i++)
+    diff |= tag[i] ^ rx->data[signed_len + i];
+  if (diff)
+  {
+    bad_frames++;
+    return;
+  }
+  frames_received++;
+
+  ha_share_role_t current = (ha_share_role_t)shared_load_u32(&role);
+  if (header.type == FRAME_SNAPSHOT_REQ)
+  {
+    if (current == HA_SHARE_LEADER)
+    {
+      portENTER_CRITICAL(&dirty_lock);
+      snapshot_wanted = true;
+      portEXIT_CRITICAL(&dirty_lock);
+    }
+    return;
+  }
+  if (header.type != FRAME_BEACON && header.type != FRAME_STATES)
+    return;
+
+  // Beacons and states come from a leader
+  if (header.term > highest_term)
+    highest_term = header.term;
+  bool from_leader = memcmp(rx->src, leader_mac, sizeof(leader_mac)) == 0;
+
+  if (current == HA_SHARE_LEADER)
+  {
+    // Two leaders hear each other, the lower rank steps down
+    if (!outranks(header.priority, rx->src, CONFIG_HA_SHARE_PRIORITY, own_mac))
+      return;
+    debug_log_info(DEBUG_TAG_SMART_HOME, "HA share: yielding to a higher ranked leader");
+    become_follower(rx->src, &header, now_us);
+  }
+  else if (current == HA_SHARE_ELECTING || !from_leader)
+  {
+    // Another leader: follow it if ours went quiet or it outranks ours
+    bool leader_quiet = now_us - last_beacon_us > 2 * SHARE_BEACON_US;
+    if (current == HA_SHARE_FOLLOWER && !leader_quiet &&
+        !outranks(header.priority, rx->src, leader_priority, leader_mac))
+      return;
+    become_follower(rx->src, &header, now_us);
+  }
+  else if (header.term < leader_term || (header.term == leader_term && header.seq <= leader_seq))
+  {
+    // Replayed or reordered
+    stale_frames++;
+    return;
+  }
+
+  leader_term = header.term;
+  leader_seq = header.seq;
+  last_beacon_us = now_us;
+
+  if (header.ha_status != applied_ha_status)
+  {
+    // The panel shows how the leader gets on with HA
+    applied_ha_status = header.ha_status;
+    ha_status_change((ha_status_t)header.ha_status);
+  }
+  if (header.type == FRAME_STATES)
+    apply_states(&header, rx->data + sizeof(header), signed_len - sizeof(header));
+}
+
+/**
+ * @brief Ticks until the next deadline of the current role
+ */
+static TickType_t next_wait(int64_t now_us)
+{
+  int64_t due_us;
+  switch ((ha_share_role_t)shared_load_u32(&role))
+  {
+  case HA_SHARE_ELECTING:
+    due_us = role_since_us + SHARE_TIMEOUT_US + jitter_us;
+    break;
+  case HA_SHARE_FOLLOWER:
+    due_us = last_beacon_us + SHARE_TIMEOUT_US + jitter_us;
+    break;
+  default:
+  {
+    due_us = last_beacon_us + SHARE_BEACON_US;
+    portENTER_CRITICAL(&dirty_lock);
+    if (dirty_mask && dirty_since_us + SHARE_FLUSH_MS * 1000 < due_us)
+      due_us = dirty_since_us + SHARE_FLUSH_MS * 1000;
+    if (snapshot_wanted)
+      due_us = now_us;
+    portEXIT_CRITICAL(&dirty_lock);
+    break;
+  }
+  }
+  if (due_us <= now_us)
+    return 0;
+  return pdMS_TO_TICKS((due_us - now_us + 999) / 1000) + 1;
+}
+
+static void share_task(void *arg)
+{
+  static rx_frame_t rx; // Share task only, keeps the stack small
+  (void)arg;
+
+  while (!stop_requested)
+  {
+    if (xQueueReceive(rx_queue, &rx, next_wait(esp_timer_get_time())) == pdTRUE && rx.len > 0)
+      handle_frame(&rx, esp_timer_get_time());
+
+    int64_t now_us = esp_timer_get_time();
+    switch ((ha_share_role_t)shared_load_u32(&role))
+    {
+    case HA_SHARE_ELECTING:
+      if (now_us >= role_since_us + SHARE_TIMEOUT_US + jitter_us)
+        become_leader(now_us);
+      break;
+
+    case HA_SHARE_FOLLOWER:
+      if (now_us >= last_beacon_us + SHARE_TIMEOUT_US + jitter_us)
+      {
+        debug_log_warning(DEBUG_TAG_SMART_HOME, "HA share: leader lost, taking over");
+        become_leader(now_us);
+      }
+      break;
+
+    case HA_SHARE_LEADER:
+    {
+      if (now_us >= last_beacon_us + SHARE_BEACON_US)
+      {
+        send_simple(FRAME_BEACON);
+        last_beacon_us = now_us;
+      }
+
+      bool snapshot = now_us >= last_snapshot_us + SHARE_SNAPSHOT_US;
+      portENTER_CRITICAL(&dirty_lock);
+      snapshot |= snapshot_wanted;
+      snapshot_wanted = false;
+      bool flush_due = dirty_mask && now_us >= dirty_since_us + SHARE_FLUSH_MS * 1000;
+      portEXIT_CRITICAL(&dirty_lock);
+      if (snapshot)
+      {
+        mark_all_dirty();
+        last_snapshot_us = now_us;
+        flush_due = true;
+      }
+      if (flush_due)
+        flush_states();
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+  share_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief ESP-NOW receive, WiFi task: copy and hand over
+ */
+static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+  if (!rx_queue || !info || len <= 0 || len > ESP_NOW_MAX_DATA_LEN)
+    return;
+
+  static rx_frame_t rx; // WiFi task only
+  memcpy(rx.src, info->src_addr, sizeof(rx.src));
+  rx.len = (uint16_t)len;
+  memcpy(rx.data, data, len);
+  if (xQueueSend(rx_queue, &rx, 0) != pdTRUE)
+    rx_dropped++;
+}
+
+static void reply(const char *text)
+{
+  serial_data_write(text, strlen(text));
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_share_start(ha_share_get_callback_t get_cb, ha_share_apply_callback_t apply_cb,
+                         ha_share_role_callback_t role_cb)
+{
+  if (share_task_handle)
+    return ESP_OK;
+
+  get_callback = get_cb;
+  apply_callback = apply_cb;
+  role_callback = role_cb;
+  group_id = compute_group_id();
+  esp_wifi_get_mac(WIFI_IF_STA, own_mac);
+  jitter_us = (uint32_t)((own_mac[4] << 8 | own_mac[5]) % SHARE_JITTER_MAX_MS) * 1000;
+
+  if (!rx_queue)
+  {
+    rx_queue = xQueueCreate(SHARE_RX_QUEUE_LEN, sizeof(rx_frame_t));
+    if (!rx_queue)
+      return ESP_ERR_NO_MEM;
+  }
+
+  esp_err_t ret = esp_now_init();
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "HA share: ESP-NOW init failed: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  esp_now_peer_info_t peer = {.channel = 0, .ifidx = WIFI_IF_STA, .encrypt = false};
+  memcpy(peer.peer_addr, broadcast_mac, sizeof(peer.peer_addr));
+  ret = esp_now_add_peer(&peer);
+  if (ret == ESP_OK)
+    ret = esp_now_register_recv_cb(espnow_recv_cb);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "HA share: ESP-NOW setup failed: %s", esp_err_to_name(ret));
+    esp_now_deinit();
+    return ret;
+  }
+
+  stop_requested = false;
+  int64_t now_us = esp_timer_get_time();
+  last_beacon_us = now_us;
+  set_role(HA_SHARE_ELECTING, now_us);
+
+  if (task_plan_create(TASK_PLAN_HA_SHARE, share_task, NULL, &share_task_handle) != pdPASS)
+  {
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    shared_store_u32(&role, HA_SHARE_OFF);
+    return ESP_ERR_NO_MEM;
+  }
+
+  debug_log_info_f(DEBUG_TAG_SMART_HOME, "HA share: group %08lx, priority %d", (unsigned long)group_id,
+                   CONFIG_HA_SHARE_PRIORITY);
+  return ESP_OK;
+}
+
+void ha_share_stop(void)
+{
+  if (!share_task_handle)
+    return;
+
+  esp_now_unregister_recv_cb();
+  stop_requested = true;
+  rx_frame_t wake = {.len = 0};
+  xQueueSend(rx_queue, &wake, 0);
+  for (int i = 0; i < 50 && share_task_handle; i++)
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+  esp_now_deinit();
+  xQueueReset(rx_queue);
+  set_role(HA_SHARE_OFF, esp_timer_get_time());
+}
+
+ha_share_role_t ha_share_get_role(void)
+{
+  return (ha_share_role_t)shared_load_u32(&role);
+}
+
+ha_share_role_t ha_share_wait_elected(TickType_t timeout)
+{
+  TickType_t start = xTaskGetTickCount();
+  ha_share_role_t current;
+  while ((current = ha_share_get_role()) == HA_SHARE_ELECTING && xTaskGetTickCount() - start < timeout)
+    vTaskDelay(pdMS_TO_TICKS(100));
+  return current;
+}
+
+void ha_share_state_changed(int index)
+{
+  if (index < 0 || index >= HA_REGISTRY_MAX_ENTITIES || ha_share_get_role() != HA_SHARE_LEADER)
+    return;
+
+  portENTER_CRITICAL(&dirty_lock);
+  bool first = dirty_mask == 0;
+  if (first)
+    dirty_since_us = esp_timer_get_time();
+  dirty_mask |= 1u << index;
+  portEXIT_CRITICAL(&dirty_lock);
+
+  // The task sleeps until the next beacon, wake it to schedule the flush
+  if (first && rx_queue)
+  {
+    rx_frame_t wake = {.len = 0};
+    xQueueSend(rx_queue, &wake, 0);
+  }
+}
+
+bool ha_share_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_HA_SHARE") != 0)
+    return false;
+
+  char buf[384];
+  snprintf(buf, sizeof(buf),
+           "HA_SHARE {\"enabled\":true,\"role\":\"%s\",\"group\":\"%08lx\",\"priority\":%d,"
+           "\"leader\":\"" MACSTR "\",\"term\":%lu,\"takeovers\":%lu,\"sent\":%lu,\"send_failures\":%lu,"
+           "\"received\":%lu,\"states_applied\":%lu,\"bad\":%lu,\"stale\":%lu,\"rx_dropped\":%lu}\n",
+           role_name(ha_share_get_role()), (unsigned long)group_id, CONFIG_HA_SHARE_PRIORITY, MAC2STR(leader_mac),
+           (unsigned long)leader_term, (unsigned long)takeovers, (unsigned long)frames_sent,
+           (unsigned long)send_failures, (unsigned long)frames_received, (unsigned long)states_applied,
+           (unsigned long)bad_frames, (unsigned long)stale_frames, (unsigned long)rx_dropped);
+  reply(buf);
+  return true;
+}
+
+#else
+
+esp_err_t ha_share_start(ha_share_get_callback_t get_cb, ha_share_apply_callback_t apply_cb,
+                         ha_share_role_callback_t role_cb)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ha_share_stop(void)
+{
+}
+
+ha_share_role_t ha_share_get_role(void)
+{
+  return HA_SHARE_OFF;
+}
+
+ha_share_role_t ha_share_wait_elected(TickType_t timeout)
+{
+  return HA_SHARE_OFF;
+}
+
+void ha_share_state_changed(int index)
+{
+}
+
+bool ha_share_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_HA_SHARE") != 0)
+    return false;
+
+  static const char disabled[] = "HA_SHARE {\"enabled\":false}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_HA_SHARE
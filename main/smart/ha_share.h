@@ -0,0 +1,130 @@
+/**
+ * @file ha_share.h
+ * @brief Entity states shared between panels over ESP-NOW
+ *
+ * With several panels in one house every panel would poll Home Assistant
+ * for the same entities. With CONFIG_HA_SHARE enabled the panels elect one
+ * leader among themselves: the leader alone syncs with HA (REST and
+ * WebSocket) and broadcasts every change of a confirmed entity state over
+ * ESP-NOW; followers stop talking to HA for states and apply what the
+ * leader sends as if it had come from HA. HA load stays that of one panel
+ * however many are added. Commands are not shared, each panel still sends
+ * its own service calls.
+ *
+ * Only panels with the same HA server and the same entity list (registry
+ * order included) form a group, so a frame can name entities by registry
+ * index. Frames carry an HMAC over HA_SHARE_KEY, or the HA token if that
+ * is not set, so a device in radio range cannot fake states.
+ *
+ * Election: the leader sends a beacon every CONFIG_HA_SHARE_BEACON_MS. A
+ * panel that hears no beacon for CONFIG_HA_SHARE_LEADER_TIMEOUT_MS, plus a
+ * per-panel jitter, takes over; of two leaders that hear each other the one
+ * with the higher CONFIG_HA_SHARE_PRIORITY, then the lower MAC, stays. A
+ * new follower asks for a snapshot, and the leader repeats the full state
+ * every CONFIG_HA_SHARE_SNAPSHOT_S for frames lost to the air or to modem
+ * sleep.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_SHARE_H
+#define HA_SHARE_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "ha_entity_state.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Part a panel plays in its group
+   */
+  typedef enum
+  {
+    HA_SHARE_OFF = 0,    ///< Disabled or not started, the panel syncs on its own
+    HA_SHARE_ELECTING,   ///< Listening for a leader after start
+    HA_SHARE_LEADER,     ///< Syncs with HA and broadcasts the states
+    HA_SHARE_FOLLOWER,   ///< Takes its states from the leader
+  } ha_share_role_t;
+
+  /**
+   * @brief Confirmed state of an entity, for the leader to broadcast
+   * @param index Registry index
+   * @param state Output
+   * @return false if the entity has no state yet
+   * @note Runs in the share task
+   */
+  typedef bool (*ha_share_get_callback_t)(int index, ha_entity_state_t *state);
+
+  /**
+   * @brief States received from the leader
+   * @param indices Registry index of each state
+   * @param states States, text interned locally
+   * @param count Entries
+   * @note Runs in the share task
+   */
+  typedef void (*ha_share_apply_callback_t)(const int *indices, const ha_entity_state_t *states, int count);
+
+  /**
+   * @brief The panel's role changed
+   * @note Runs in the share task, keep it short
+   */
+  typedef void (*ha_share_role_callback_t)(ha_share_role_t role);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start ESP-NOW and the election
+   * @note Call once WiFi is started; the group follows the STA channel
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if CONFIG_HA_SHARE is disabled, or an error
+   */
+  esp_err_t ha_share_start(ha_share_get_callback_t get_callback, ha_share_apply_callback_t apply_callback,
+                           ha_share_role_callback_t role_callback);
+
+  /**
+   * @brief Stop sharing, the panel syncs on its own again
+   */
+  void ha_share_stop(void);
+
+  /**
+   * @brief Current role
+   */
+  ha_share_role_t ha_share_get_role(void);
+
+  /**
+   * @brief Wait until the election after start is decided
+   * @param timeout Longest wait
+   * @return Role at return, HA_SHARE_ELECTING on timeout
+   */
+  ha_share_role_t ha_share_wait_elected(TickType_t timeout);
+
+  /**
+   * @brief A confirmed state changed, the leader broadcasts it
+   * @param index Registry index
+   * @note Any task; does nothing unless leading
+   */
+  void ha_share_state_changed(int index);
+
+  /**
+   * @brief Handle GET_HA_SHARE
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a share command
+   */
+  bool ha_share_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_SHARE_H
@@ -0,0 +1,261 @@
+/**
+ * @file ha_shortcuts.c
+ * @brief Scene and script shortcuts with metadata cached in NVS
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ha_shortcuts.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "json_arena.h"
+#include "nvs.h"
+#include "nvs_store.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define SHORTCUTS_NVS_NAMESPACE "ha_shortcuts"
+#define SHORTCUTS_NVS_KEY "list"
+#define SHORTCUTS_BLOB_VERSION 1
+
+// Written once per boot at most, no need to wait for other edits
+#define SHORTCUTS_SAVE_DELAY_MS 1000
+
+#define SHORTCUTS_STRINGIFY(x) #x
+#define SHORTCUTS_TO_STRING(x) SHORTCUTS_STRINGIFY(x)
+
+/** Scenes and scripts sorted by name, cut to HA_SHORTCUTS_MAX so the reply stays small */
+#define SHORTCUTS_TEMPLATE "{% set ns = namespace(out=[]) %}{% for s in "                            \
+                           "((states.scene | list + states.script | list) | sort(attribute='name'))" \
+                           "[:" SHORTCUTS_TO_STRING(HA_SHORTCUTS_MAX) "] %}"                         \
+                           "{% set ns.out = ns.out + [{'entity_id': s.entity_id, 'name': s.name, "   \
+                           "'icon': s.attributes.get('icon')}] %}"                                   \
+                           "{% endfor %}{{ ns.out | tojson }}"
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief NVS layout, only the first count entries are written
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t count;
+  ha_shortcut_t items[HA_SHORTCUTS_MAX];
+} shortcuts_blob_t;
+
+#define SHORTCUTS_BLOB_SIZE(count) (offsetof(shortcuts_blob_t, items) + (size_t)(count) * sizeof(ha_shortcut_t))
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static ha_shortcut_t shortcuts[HA_SHORTCUTS_MAX];
+static int shortcut_count = 0;
+static volatile uint32_t shortcut_generation = 0;
+static portMUX_TYPE shortcuts_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief strlcpy that does not leave half a UTF-8 sequence at the cut
+ */
+static void copy_utf8(char *dest, const char *src, size_t size)
+{
+  size_t len = strlcpy(dest, src, size);
+  if (len < size)
+    return;
+
+  size_t end = size - 1;
+  while (end > 0 && ((unsigned char)dest[end] & 0xC0) == 0x80)
+    end--;
+  dest[end] = '\0';
+}
+
+static bool is_shortcut_entity(const char *entity_id)
+{
+  return strncmp(entity_id, "scene.", 6) == 0 || strncmp(entity_id, "script.", 7) == 0;
+}
+
+/**
+ * @brief Fill items from the rendered template, entries that do not fit are skipped
+ * @return Number of entries filled, -1 if the reply is not a JSON array
+ */
+static int parse_shortcuts(const char *json_text, size_t json_len, ha_shortcut_t *items)
+{
+  json_arena_t *arena = json_arena_begin(json_len);
+  cJSON *json = cJSON_Parse(json_text);
+  if (!cJSON_IsArray(json))
+  {
+    cJSON_Delete(json);
+    json_arena_end(arena);
+    return -1;
+  }
+
+  int count = 0;
+  const cJSON *item = NULL;
+  cJSON_ArrayForEach(item, json)
+  {
+    if (count >= HA_SHORTCUTS_MAX)
+      break;
+
+    const cJSON *entity_id = cJSON_GetObjectItem(item, "entity_id");
+    if (!cJSON_IsString(entity_id) || !is_shortcut_entity(entity_id->valuestring) ||
+        strlen(entity_id->valuestring) >= HA_MAX_ENTITY_ID_LEN)
+      continue;
+
+    ha_shortcut_t *shortcut = &items[count++];
+    memset(shortcut, 0, sizeof(*shortcut));
+    strlcpy(shortcut->entity_id, entity_id->valuestring, sizeof(shortcut->entity_id));
+
+    const cJSON *name = cJSON_GetObjectItem(item, "name");
+    copy_utf8(shortcut->label, cJSON_IsString(name) ? name->valuestring : entity_id->valuestring,
+              sizeof(shortcut->label));
+
+    // Only "mdi:" names map to asset pack icons, anything longer has no asset either
+    const cJSON *icon = cJSON_GetObjectItem(item, "icon");
+    if (cJSON_IsString(icon) && strncmp(icon->valuestring, "mdi:", 4) == 0 &&
+        strlen(icon->valuestring + 4) < sizeof(shortcut->icon))
+      strlcpy(shortcut->icon, icon->valuestring + 4, sizeof(shortcut->icon));
+  }
+
+  cJSON_Delete(json);
+  json_arena_end(arena);
+  return count;
+}
+
+/**
+ * @brief Replace the live list
+ * @return true if it changed
+ */
+static bool publish_shortcuts(const ha_shortcut_t *items, int count)
+{
+  bool changed;
+  portENTER_CRITICAL(&shortcuts_lock);
+  changed = count != shortcut_count || memcmp(shortcuts, items, count * sizeof(ha_shortcut_t)) != 0;
+  if (changed)
+  {
+    memcpy(shortcuts, items, count * sizeof(ha_shortcut_t));
+    shortcut_count = count;
+    shortcut_generation++;
+  }
+  portEXIT_CRITICAL(&shortcuts_lock);
+  return changed;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ha_shortcuts_init(void)
+{
+  shortcuts_blob_t *blob = malloc(sizeof(shortcuts_blob_t));
+  if (!blob)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  size_t size = sizeof(*blob);
+  esp_err_t err = nvs_store_get(SHORTCUTS_NVS_NAMESPACE, SHORTCUTS_NVS_KEY, blob, &size);
+  if (err == ESP_OK && (size < offsetof(shortcuts_blob_t, items) || blob->version != SHORTCUTS_BLOB_VERSION ||
+                        blob->count > HA_SHORTCUTS_MAX || size != SHORTCUTS_BLOB_SIZE(blob->count)))
+  {
+    debug_log_warning(DEBUG_TAG_SMART_HOME, "Stored shortcuts have an unknown layout, ignoring them");
+    err = ESP_ERR_INVALID_SIZE;
+  }
+
+  if (err == ESP_OK)
+  {
+    // Never trust flash contents to be terminated
+    for (int i = 0; i < blob->count; i++)
+    {
+      blob->items[i].entity_id[HA_MAX_ENTITY_ID_LEN - 1] = '\0';
+      blob->items[i].label[HA_SHORTCUT_LABEL_LEN - 1] = '\0';
+      blob->items[i].icon[HA_SHORTCUT_ICON_LEN - 1] = '\0';
+    }
+    publish_shortcuts(blob->items, blob->count);
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "Shortcuts: %d cached", blob->count);
+  }
+  else if (err != ESP_ERR_NVS_NOT_FOUND && err != ESP_ERR_INVALID_SIZE)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Shortcuts not loaded: %s", esp_err_to_name(err));
+  }
+
+  free(blob);
+  return ESP_OK;
+}
+
+esp_err_t ha_shortcuts_refresh(void)
+{
+  ha_api_response_t response = {0};
+  esp_err_t err = ha_api_render_template_cached(SHORTCUTS_TEMPLATE, &response);
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Shortcut metadata not fetched: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // The list loaded from NVS was parsed from this very reply
+  if (response.unchanged && shortcut_generation != 0)
+  {
+    ha_api_free_response(&response);
+    debug_log_debug(DEBUG_TAG_SMART_HOME, "Shortcuts unchanged");
+    return ESP_OK;
+  }
+
+  shortcuts_blob_t *blob = malloc(sizeof(shortcuts_blob_t));
+  if (!blob)
+  {
+    ha_api_free_response(&response);
+    return ESP_ERR_NO_MEM;
+  }
+
+  int count = response.response_data ? parse_shortcuts(response.response_data, response.response_len, blob->items) : -1;
+  ha_api_free_response(&response);
+  if (count < 0)
+  {
+    free(blob);
+    debug_log_error(DEBUG_TAG_SMART_HOME, "Shortcut template reply is not a JSON array");
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+
+  if (publish_shortcuts(blob->items, count))
+  {
+    blob->version = SHORTCUTS_BLOB_VERSION;
+    blob->count = (uint8_t)count;
+    nvs_store_set(SHORTCUTS_NVS_NAMESPACE, SHORTCUTS_NVS_KEY, blob, SHORTCUTS_BLOB_SIZE(count), SHORTCUTS_SAVE_DELAY_MS);
+    debug_log_info_f(DEBUG_TAG_SMART_HOME, "Shortcuts: %d scenes and scripts from HA", count);
+  }
+
+  free(blob);
+  return ESP_OK;
+}
+
+int ha_shortcuts_get(ha_shortcut_t *out)
+{
+  if (!out)
+    return 0;
+
+  portENTER_CRITICAL(&shortcuts_lock);
+  int count = shortcut_count;
+  memcpy(out, shortcuts, count * sizeof(ha_shortcut_t));
+  portEXIT_CRITICAL(&shortcuts_lock);
+  return count;
+}
+
+uint32_t ha_shortcuts_generation(void)
+{
+  return shortcut_generation;
+}
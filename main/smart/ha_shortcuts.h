@@ -0,0 +1,92 @@
+/**
+ * @file ha_shortcuts.h
+ * @brief Scene and script shortcuts with metadata cached in NVS
+ *
+ * The scenes and scripts Home Assistant knows, with their names and icons,
+ * are read in one template query after the first sync of each boot and
+ * kept in NVS, so the shortcut grid is filled at startup before the
+ * network is up and a tap never waits for a metadata fetch. The list is
+ * only written back when HA reports something different; the query goes
+ * through the HTTP metadata cache, so an unchanged reply is not parsed.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HA_SHORTCUTS_H
+#define HA_SHORTCUTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ha_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Shortcuts kept, HA is asked for no more than this */
+#define HA_SHORTCUTS_MAX 16
+
+  /** Display label including terminator */
+#define HA_SHORTCUT_LABEL_LEN 24
+
+  /** Icon name including terminator, e.g. "movie-open" for mdi:movie-open; fits an "icon/" asset name */
+#define HA_SHORTCUT_ICON_LEN 27
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief One scene or script, stored in NVS as is
+   */
+  typedef struct
+  {
+    char entity_id[HA_MAX_ENTITY_ID_LEN]; ///< "scene.*" or "script.*"
+    char label[HA_SHORTCUT_LABEL_LEN];    ///< Friendly name, cut to fit
+    char icon[HA_SHORTCUT_ICON_LEN];      ///< Icon without the "mdi:" prefix, empty if none
+  } ha_shortcut_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Load the cached list from NVS
+   * @return ESP_OK, also when nothing is cached yet
+   * @note Call once after nvs_store_init() and before the UI is created
+   */
+  esp_err_t ha_shortcuts_init(void);
+
+  /**
+   * @brief Fetch names and icons of all scenes and scripts in one template query
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if HA refuses templates, or the
+   *         request or parse error; the cached list is kept on error
+   * @note Blocks on HTTP, call from the sync task
+   */
+  esp_err_t ha_shortcuts_refresh(void);
+
+  /**
+   * @brief Copy the current list
+   * @param out Array of at least HA_SHORTCUTS_MAX entries
+   * @return Number of shortcuts copied
+   * @note Safe from any task
+   */
+  int ha_shortcuts_get(ha_shortcut_t *out);
+
+  /**
+   * @brief Counter bumped whenever the list changes, for cheap polling
+   */
+  uint32_t ha_shortcuts_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_SHORTCUTS_H
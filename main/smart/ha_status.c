@@ -3,7 +3,15 @@
  * @brief Home Assistant Status Management Module Implementation
  *
  * This module provides centralized status management for Home Assistant integration,
- * including status change notifications and callbacks.
+ * including status change notifications on the event bus.
+ *
+ * Two inputs make up the status: the outcome callers report with
+ * ha_status_change() and the count of requests in flight. Both are written
+ * under one spinlock from any task. What they add up to is only published
+ * once it has held for CONFIG_HA_STATUS_SETTLE_MS, and a published status
+ * stays up for at least CONFIG_HA_STATUS_MIN_DISPLAY_MS. A one-shot timer
+ * publishes a pending status when it falls due. Only the timer task
+ * publishes, so events arrive in order.
  *
  * @author System Monitor Dashboard
  * @date 2025-08-19
@@ -12,23 +20,36 @@
 #include "ha_status.h"
 
 #include <string.h>
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
-#include "freertos/task.h"
+#include "utils/event_bus.h"
+#include "utils/shared_state.h"
 #include "utils/system_debug_utils.h"
 
 // =======================================================================
 // CONSTANTS AND MACROS
 // =======================================================================
 
+#define STATUS_SETTLE_US ((int64_t)CONFIG_HA_STATUS_SETTLE_MS * 1000)
+#define STATUS_MIN_DISPLAY_US ((int64_t)CONFIG_HA_STATUS_MIN_DISPLAY_MS * 1000)
+
 // =======================================================================
 // STATIC VARIABLES
 // =======================================================================
 
-static ha_status_t current_status = HA_STATUS_OFFLINE;
-static ha_status_change_callback_t status_callback = NULL;
-static SemaphoreHandle_t status_mutex = NULL;
-static bool initialized = false;
+static bool initialized = false; ///< shared_state.h access
+static esp_timer_handle_t publish_timer = NULL;
+
+// Aggregated status, all under status_lock
+static portMUX_TYPE status_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t in_flight = 0;                 ///< Requests between request_begin and request_end
+static bool sync_pending = false;              ///< A sync began and has not reported its outcome
+static ha_status_t settled = HA_STATUS_OFFLINE; ///< Last outcome reported
+static ha_status_t target = HA_STATUS_OFFLINE;  ///< What the inputs add up to now
+static int64_t target_since_us = 0;
+static ha_status_t published = HA_STATUS_OFFLINE; ///< Last status on the bus
+static int64_t published_since_us = 0;
+static uint32_t suppressed = 0; ///< Targets that changed again before they were published
 
 // =======================================================================
 // STATUS TEXT MAPPING
@@ -41,18 +62,110 @@ static const char *status_text_map[] = {
     [HA_STATUS_STATES_SYNCED] = "States Synced",
     [HA_STATUS_PARTIAL_SYNC] = "Partial Sync",
     [HA_STATUS_SYNC_FAILED] = "Sync Failed",
+    [HA_STATUS_UNREACHABLE] = "Unreachable",
 };
 
-static bool ha_status_is_ready(void)
+/**
+ * @brief Publish a status, retained by the bus for late subscribers
+ */
+static void ha_status_publish(ha_status_t status)
+{
+  event_t event = {.topic = EVENT_TOPIC_HA_STATUS,
+                   .ha_status = {.status = status,
+                                 .is_ready = (status == HA_STATUS_READY || status == HA_STATUS_STATES_SYNCED),
+                                 .is_syncing = (status == HA_STATUS_SYNCING),
+                                 .text = ha_status_get_text(status)}};
+  event_bus_publish(&event);
+}
+
+/**
+ * @brief Recompute the target after an input changed, status_lock held
+ */
+static void update_target_locked(int64_t now_us)
+{
+  ha_status_t next = (in_flight > 0 || sync_pending) ? HA_STATUS_SYNCING : settled;
+  if (next == target)
+    return;
+  // A target replaced before it was published was a flap the UI never saw
+  if (target != published)
+    suppressed++;
+  target = next;
+  target_since_us = now_us;
+}
+
+/**
+ * @brief Time until the target may be published, status_lock held
+ * @return Microseconds, 0 if due now, -1 if nothing is pending
+ */
+static int64_t publish_due_in_locked(int64_t now_us)
+{
+  if (target == published)
+    return -1;
+  int64_t due_us = target_since_us + STATUS_SETTLE_US;
+  if (published_since_us + STATUS_MIN_DISPLAY_US > due_us)
+    due_us = published_since_us + STATUS_MIN_DISPLAY_US;
+  return due_us > now_us ? due_us - now_us : 0;
+}
+
+/**
+ * @brief Arm the publish timer for the pending target, if there is one
+ */
+static void schedule_publish(int64_t due_in_us)
+{
+  if (due_in_us < 0 || !publish_timer)
+    return;
+  // Restarting keeps one deadline, the callback re-arms if it fired early
+  esp_timer_stop(publish_timer);
+  esp_timer_start_once(publish_timer, due_in_us > 1000 ? (uint64_t)due_in_us : 1000);
+}
+
+/**
+ * @brief Feed an input change through the debounce
+ */
+static void inputs_changed(void)
 {
-  ha_status_t status = ha_status_get_current();
-  return (status == HA_STATUS_READY || status == HA_STATUS_STATES_SYNCED);
+  int64_t now_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&status_lock);
+  update_target_locked(now_us);
+  int64_t due_in_us = publish_due_in_locked(now_us);
+  portEXIT_CRITICAL(&status_lock);
+
+  schedule_publish(due_in_us);
 }
 
-static bool ha_status_is_syncing(void)
+/**
+ * @brief Publish the target once it is due, esp_timer task
+ */
+static void publish_timer_cb(void *arg)
 {
-  ha_status_t status = ha_status_get_current();
-  return (status == HA_STATUS_SYNCING);
+  (void)arg;
+  int64_t now_us = esp_timer_get_time();
+  ha_status_t old_status = HA_STATUS_OFFLINE;
+  ha_status_t new_status = HA_STATUS_OFFLINE;
+  bool publish = false;
+
+  portENTER_CRITICAL(&status_lock);
+  int64_t due_in_us = publish_due_in_locked(now_us);
+  if (due_in_us == 0)
+  {
+    old_status = published;
+    new_status = target;
+    published = target;
+    published_since_us = now_us;
+    publish = true;
+  }
+  portEXIT_CRITICAL(&status_lock);
+
+  if (!publish)
+  {
+    schedule_publish(due_in_us);
+    return;
+  }
+
+  debug_log_info_f(DEBUG_TAG_HA_SYNC, "Status changed: %s -> %s", ha_status_get_text(old_status),
+                   ha_status_get_text(new_status));
+  ha_status_publish(new_status);
 }
 
 // =======================================================================
@@ -61,22 +174,37 @@ static bool ha_status_is_syncing(void)
 
 esp_err_t ha_status_init(void)
 {
-  if (initialized)
+  if (shared_load_bool(&initialized))
   {
     debug_log_warning(DEBUG_TAG_HA_SYNC, "Already initialized");
     return ESP_OK;
   }
 
-  // Create mutex for thread safety
-  status_mutex = xSemaphoreCreateMutex();
-  if (status_mutex == NULL)
+  if (!publish_timer)
   {
-    debug_log_error(DEBUG_TAG_HA_SYNC, "Failed to create status mutex");
-    return ESP_ERR_NO_MEM;
+    const esp_timer_create_args_t timer_args = {
+        .callback = publish_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ha_status",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &publish_timer);
+    if (ret != ESP_OK)
+    {
+      debug_log_error_f(DEBUG_TAG_HA_SYNC, "Status timer creation failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
   }
 
-  initialized = true;
-  ha_status_change(HA_STATUS_OFFLINE);
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&status_lock);
+  in_flight = 0;
+  sync_pending = false;
+  settled = target = published = HA_STATUS_OFFLINE;
+  target_since_us = published_since_us = now_us;
+  portEXIT_CRITICAL(&status_lock);
+
+  shared_store_bool(&initialized, true);
+  ha_status_publish(HA_STATUS_OFFLINE);
 
   debug_log_startup(DEBUG_TAG_HA_SYNC, "HA Status Module");
   return ESP_OK;
@@ -84,112 +212,105 @@ esp_err_t ha_status_init(void)
 
 esp_err_t ha_status_deinit(void)
 {
-  if (!initialized)
+  if (!shared_load_bool(&initialized))
   {
     return ESP_OK;
   }
 
-  if (xSemaphoreTake(status_mutex, pdMS_TO_TICKS(1000)) == pdTRUE)
+  shared_store_bool(&initialized, false);
+  if (publish_timer)
   {
-    status_callback = NULL;
-    current_status = HA_STATUS_OFFLINE;
-    xSemaphoreGive(status_mutex);
+    esp_timer_stop(publish_timer);
   }
 
-  if (status_mutex != NULL)
-  {
-    vSemaphoreDelete(status_mutex);
-    status_mutex = NULL;
-  }
-
-  initialized = false;
+  portENTER_CRITICAL(&status_lock);
+  settled = target = published = HA_STATUS_OFFLINE;
+  sync_pending = false;
+  portEXIT_CRITICAL(&status_lock);
 
   return ESP_OK;
 }
 
-void ha_status_register_change_callback(ha_status_change_callback_t callback)
+void ha_status_change(ha_status_t status)
 {
-  if (!initialized)
+  if (!shared_load_bool(&initialized))
   {
     debug_log_error(DEBUG_TAG_HA_SYNC, "Module not initialized");
     return;
   }
 
-  if (xSemaphoreTake(status_mutex, pdMS_TO_TICKS(1000)) == pdTRUE)
+  // Validate status enum
+  if (status >= sizeof(status_text_map) / sizeof(status_text_map[0]))
+  {
+    debug_log_error_f(DEBUG_TAG_HA_SYNC, "Invalid status value: %d", status);
+    return;
+  }
+
+  portENTER_CRITICAL(&status_lock);
+  if (status == HA_STATUS_SYNCING)
   {
-    status_callback = callback;
-    debug_log_info_f(DEBUG_TAG_HA_SYNC, "Status change callback %s",
-                     callback ? "registered" : "unregistered");
-    xSemaphoreGive(status_mutex);
+    sync_pending = true;
   }
   else
   {
-    debug_log_error(DEBUG_TAG_HA_SYNC, "Failed to acquire mutex for callback registration");
+    sync_pending = false;
+    settled = status;
   }
+  portEXIT_CRITICAL(&status_lock);
+
+  inputs_changed();
 }
 
-void ha_status_change(ha_status_t status)
+void ha_status_request_begin(void)
 {
-  if (!initialized)
-  {
-    debug_log_error(DEBUG_TAG_HA_SYNC, "Module not initialized");
-    return;
-  }
+  portENTER_CRITICAL(&status_lock);
+  in_flight++;
+  bool first = in_flight == 1;
+  portEXIT_CRITICAL(&status_lock);
 
-  // Validate status enum
-  if (status >= sizeof(status_text_map) / sizeof(status_text_map[0]))
+  if (first && shared_load_bool(&initialized))
   {
-    debug_log_error_f(DEBUG_TAG_HA_SYNC, "Invalid status value: %d", status);
-    return;
+    inputs_changed();
   }
+}
 
-  ha_status_change_callback_t callback_to_call = NULL;
-  const char *status_text = ha_status_get_text(status);
-
-  if (xSemaphoreTake(status_mutex, pdMS_TO_TICKS(1000)) == pdTRUE)
-  {
-    // Only update if status actually changed
-    if (current_status != status)
-    {
-      ha_status_t old_status = current_status;
-      current_status = status;
-      callback_to_call = status_callback;
-
-      debug_log_info_f(DEBUG_TAG_HA_SYNC, "Status changed: %s -> %s",
-                       ha_status_get_text(old_status),
-                       ha_status_get_text(status));
-    }
-    xSemaphoreGive(status_mutex);
-  }
-  else
+void ha_status_request_end(void)
+{
+  portENTER_CRITICAL(&status_lock);
+  if (in_flight > 0)
   {
-    debug_log_error(DEBUG_TAG_HA_SYNC, "Failed to acquire mutex for status change");
-    return;
+    in_flight--;
   }
+  bool last = in_flight == 0;
+  portEXIT_CRITICAL(&status_lock);
 
-  // Call callback outside of mutex to avoid deadlock
-  if (callback_to_call != NULL)
+  if (last && shared_load_bool(&initialized))
   {
-    callback_to_call(ha_status_is_ready(), ha_status_is_syncing(), status_text);
+    inputs_changed();
   }
 }
 
 ha_status_t ha_status_get_current(void)
 {
-  if (!initialized)
+  if (!shared_load_bool(&initialized))
   {
     return HA_STATUS_OFFLINE;
   }
 
-  ha_status_t status = HA_STATUS_OFFLINE;
-  if (xSemaphoreTake(status_mutex, pdMS_TO_TICKS(1000)) == pdTRUE)
-  {
-    status = current_status;
-    xSemaphoreGive(status_mutex);
-  }
+  portENTER_CRITICAL(&status_lock);
+  ha_status_t status = target;
+  portEXIT_CRITICAL(&status_lock);
   return status;
 }
 
+uint32_t ha_status_get_suppressed(void)
+{
+  portENTER_CRITICAL(&status_lock);
+  uint32_t count = suppressed;
+  portEXIT_CRITICAL(&status_lock);
+  return count;
+}
+
 const char *ha_status_get_text(ha_status_t status)
 {
   if (status >= sizeof(status_text_map) / sizeof(status_text_map[0]))
@@ -198,9 +319,3 @@ const char *ha_status_get_text(ha_status_t status)
   }
   return status_text_map[status];
 }
-
-void ha_status_register_callback(ha_status_change_callback_t callback)
-{
-  // This is an alias for ha_status_register_change_callback
-  ha_status_register_change_callback(callback);
-}
@@ -3,7 +3,13 @@
  * @brief Home Assistant Status Management Module
  *
  * This module provides centralized status management for Home Assistant integration,
- * including status change notifications and callbacks.
+ * including status change notifications on the event bus (EVENT_TOPIC_HA_STATUS).
+ *
+ * The published status is debounced: requests in flight show as syncing,
+ * and a status has to hold for CONFIG_HA_STATUS_SETTLE_MS before it is
+ * published and then stays for at least CONFIG_HA_STATUS_MIN_DISPLAY_MS.
+ * A burst of requests with outcomes in between reaches the UI as one
+ * syncing period and one result, not as a flip per request.
  *
  * @author System Monitor Dashboard
  * @date 2025-08-19
@@ -13,6 +19,7 @@
 #define HA_STATUS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -35,21 +42,9 @@ extern "C"
     HA_STATUS_STATES_SYNCED, /**< Entity states successfully synced */
     HA_STATUS_PARTIAL_SYNC,  /**< Partial sync completed */
     HA_STATUS_SYNC_FAILED,   /**< Sync operation failed */
+    HA_STATUS_UNREACHABLE,   /**< Requests fail fast until HA answers again */
   } ha_status_t;
 
-  // =======================================================================
-  // CALLBACK TYPES
-  // =======================================================================
-
-  /**
-   * @brief HA status change callback function type
-   * @param status Current HA status
-   * @param status_text Human-readable status description
-   * @param is_ready True if the HA API is ready, false otherwise
-   * @param is_syncing True if the HA API is syncing, false otherwise
-   */
-  typedef void (*ha_status_change_callback_t)(bool is_ready, bool is_syncing, const char *status_text);
-
   // =======================================================================
   // PUBLIC FUNCTIONS
   // =======================================================================
@@ -67,23 +62,37 @@ extern "C"
   esp_err_t ha_status_deinit(void);
 
   /**
-   * @brief Register a callback for HA status changes
-   * @param callback Function to call when HA status changes (NULL to unregister)
+   * @brief Report the outcome of an operation, published once it settles
+   *
+   * HA_STATUS_SYNCING announces a sync whose outcome follows in a later
+   * call; it shows as syncing until then, like a request in flight.
+   *
+   * @param status New HA status
    */
-  void ha_status_register_change_callback(ha_status_change_callback_t callback);
+  void ha_status_change(ha_status_t status);
 
   /**
-   * @brief Update the current HA status
-   * @param status New HA status
+   * @brief A request to HA started, the status shows syncing while any runs
    */
-  void ha_status_change(ha_status_t status);
+  void ha_status_request_begin(void);
+
+  /**
+   * @brief A request started with ha_status_request_begin() ended
+   */
+  void ha_status_request_end(void);
 
   /**
-   * @brief Get the current HA status
-   * @return Current HA status
+   * @brief Get the current HA status, not yet debounced
+   * @return Syncing while requests run, otherwise the last outcome reported
    */
   ha_status_t ha_status_get_current(void);
 
+  /**
+   * @brief Count of statuses that changed again before they were published
+   * @return Flips the debounce kept from the UI since boot
+   */
+  uint32_t ha_status_get_suppressed(void);
+
   /**
    * @brief Get human-readable status text for a status enum
    * @param status HA status enum value
@@ -0,0 +1,379 @@
+/**
+ * @file ha_websocket.c
+ * @brief Home Assistant WebSocket Subscription Client Implementation
+ *
+ * Protocol: the server opens with auth_required, the client answers with
+ * its access token, and after auth_ok sends one subscribe_entities command,
+ * and a subscribe_events command if an event callback is registered.
+ * Events arrive in the compressed format: "a" carries full states of added
+ * entities (sent once after subscribing), "c" carries diffs with the new
+ * state under "+".
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ha_websocket.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "ha_servers.h"
+#include "json_arena.h"
+#include "smart_config.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+#if CONFIG_HA_WEBSOCKET
+
+#include "esp_websocket_client.h"
+#if CONFIG_HA_HTTPS_CA_BUNDLE || (CONFIG_HA_SERVER_FAILOVER && CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+#include "esp_crt_bundle.h"
+#endif
+
+#define HA_WS_RECONNECT_MS 10000     ///< Delay between reconnect attempts
+#define HA_WS_NETWORK_TIMEOUT_MS 10000
+#define HA_WS_PING_INTERVAL_S 30     ///< Protocol level ping, keeps idle NAT entries open
+#define HA_WS_SEND_TIMEOUT_MS 2000
+#define HA_WS_SUBSCRIBE_ID 1         ///< Message id of the subscription, ids restart per connection
+#define HA_WS_EVENTS_ID 2            ///< Message id of the event subscription
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static esp_websocket_client_handle_t ws_client = NULL;
+static const char *const *ws_entity_ids = NULL;
+static int ws_entity_count = 0;
+static ha_websocket_state_callback_t ws_state_callback = NULL;
+static ha_websocket_drop_callback_t ws_drop_callback = NULL;
+static const char *ws_event_type = NULL;
+static ha_websocket_event_callback_t ws_event_callback = NULL;
+static volatile bool ws_subscribed = false;
+static bool ws_auth_rejected = false; ///< Token was refused, stop offering it
+
+// Fragment reassembly, only touched from the client task
+static char *rx_buffer = NULL;
+static size_t rx_len = 0;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static void send_json(cJSON *json)
+{
+  char *text = cJSON_PrintUnformatted(json);
+  if (text)
+  {
+    esp_websocket_client_send_text(ws_client, text, strlen(text), pdMS_TO_TICKS(HA_WS_SEND_TIMEOUT_MS));
+    cJSON_free(text); // May come from the message's arena
+
+  }
+  cJSON_Delete(json);
+}
+
+static void send_auth(void)
+{
+  cJSON *json = cJSON_CreateObject();
+  cJSON_AddStringToObject(json, "type", "auth");
+  cJSON_AddStringToObject(json, "access_token", HA_API_TOKEN);
+  send_json(json);
+}
+
+static void send_subscribe(void)
+{
+  cJSON *json = cJSON_CreateObject();
+  cJSON_AddNumberToObject(json, "id", HA_WS_SUBSCRIBE_ID);
+  cJSON_AddStringToObject(json, "type", "subscribe_entities");
+  cJSON *ids = cJSON_AddArrayToObject(json, "entity_ids");
+  for (int i = 0; i < ws_entity_count; i++)
+  {
+    cJSON_AddItemToArray(ids, cJSON_CreateString(ws_entity_ids[i]));
+  }
+  send_json(json);
+}
+
+static void send_subscribe_events(void)
+{
+  cJSON *json = cJSON_CreateObject();
+  cJSON_AddNumberToObject(json, "id", HA_WS_EVENTS_ID);
+  cJSON_AddStringToObject(json, "type", "subscribe_events");
+  cJSON_AddStringToObject(json, "event_type", ws_event_type);
+  send_json(json);
+}
+
+/**
+ * @brief Forward the "s" and "a" members of each entity in an event section
+ * @param section Object keyed by entity id
+ * @param diff True for "c" entries, where the new values sit under "+"
+ *
+ * "lc" (last changed) is only sent when it differs from "lu" (last updated).
+ * A diff that only changes attributes, such as a dimmed light, has no "s".
+ */
+static void dispatch_states(const cJSON *section, bool diff)
+{
+  const cJSON *entity = NULL;
+  cJSON_ArrayForEach(entity, section)
+  {
+    const cJSON *values = diff ? cJSON_GetObjectItem(entity, "+") : entity;
+    const cJSON *state = cJSON_GetObjectItem(values, "s");
+    const cJSON *attributes = cJSON_GetObjectItem(values, "a");
+    const cJSON *changed = cJSON_GetObjectItem(values, "lc");
+    if (!cJSON_IsNumber(changed))
+      changed = cJSON_GetObjectItem(values, "lu");
+    if (!cJSON_IsObject(attributes))
+      attributes = NULL;
+    if ((cJSON_IsString(state) || (diff && attributes)) && ws_state_callback)
+    {
+      ws_state_callback(entity->string, cJSON_GetStringValue(state), attributes,
+                        cJSON_IsNumber(changed) ? (uint32_t)changed->valuedouble : 0);
+    }
+  }
+}
+
+static void handle_message(const char *text)
+{
+  json_arena_t *arena = json_arena_begin(strlen(text));
+  cJSON *json = cJSON_Parse(text);
+  if (!json)
+  {
+    json_arena_end(arena);
+    debug_log_warning(DEBUG_TAG_HA_API, "WebSocket: unparsable message");
+    return;
+  }
+
+  const cJSON *type = cJSON_GetObjectItem(json, "type");
+  const char *type_str = cJSON_IsString(type) ? type->valuestring : "";
+  const cJSON *id = cJSON_GetObjectItem(json, "id");
+  bool events_reply = cJSON_IsNumber(id) && id->valueint == HA_WS_EVENTS_ID;
+
+  if (strcmp(type_str, "auth_required") == 0)
+  {
+    if (!ws_auth_rejected)
+      send_auth();
+  }
+  else if (strcmp(type_str, "auth_ok") == 0)
+  {
+    send_subscribe();
+    if (ws_event_callback)
+      send_subscribe_events();
+  }
+  else if (strcmp(type_str, "auth_invalid") == 0)
+  {
+    // Retrying with the same token would only trigger HA's login ban; the
+    // client can't be stopped from its own task, so just stop authenticating
+    debug_log_error(DEBUG_TAG_HA_API, "WebSocket: access token rejected, REST polling only");
+    ws_auth_rejected = true;
+  }
+  else if (strcmp(type_str, "result") == 0 && events_reply)
+  {
+    if (!cJSON_IsTrue(cJSON_GetObjectItem(json, "success")))
+      debug_log_error_f(DEBUG_TAG_HA_API, "WebSocket: %s subscription rejected", ws_event_type);
+  }
+  else if (strcmp(type_str, "result") == 0)
+  {
+    const cJSON *success = cJSON_GetObjectItem(json, "success");
+    ws_subscribed = cJSON_IsTrue(success);
+    if (ws_subscribed)
+      debug_log_info_f(DEBUG_TAG_HA_API, "WebSocket: subscribed to %d entities", ws_entity_count);
+    else
+      debug_log_error(DEBUG_TAG_HA_API, "WebSocket: subscription rejected");
+  }
+  else if (strcmp(type_str, "event") == 0 && events_reply)
+  {
+    const cJSON *data = cJSON_GetObjectItem(cJSON_GetObjectItem(json, "event"), "data");
+    ha_websocket_event_callback_t callback = ws_event_callback;
+    if (callback)
+      callback(cJSON_IsObject(data) ? data : NULL);
+  }
+  else if (strcmp(type_str, "event") == 0)
+  {
+    const cJSON *event = cJSON_GetObjectItem(json, "event");
+    dispatch_states(cJSON_GetObjectItem(event, "a"), false);
+    dispatch_states(cJSON_GetObjectItem(event, "c"), true);
+  }
+
+  cJSON_Delete(json);
+  json_arena_end(arena);
+}
+
+static void websocket_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+  esp_websocket_event_data_t *data = (esp_websocket_event_data_t *)event_data;
+
+  switch (event_id)
+  {
+  case WEBSOCKET_EVENT_CONNECTED:
+    debug_log_info(DEBUG_TAG_HA_API, "WebSocket: connected");
+    rx_len = 0;
+    break;
+
+  case WEBSOCKET_EVENT_DISCONNECTED:
+  case WEBSOCKET_EVENT_CLOSED:
+    if (ws_subscribed)
+    {
+      debug_log_warning(DEBUG_TAG_HA_API, "WebSocket: connection lost, REST polling takes over");
+      ws_subscribed = false;
+      if (ws_drop_callback)
+        ws_drop_callback();
+    }
+    break;
+
+  case WEBSOCKET_EVENT_DATA:
+    // Text frames only; control frames and binary data are not used by HA
+    if (data->op_code != 0x01 && data->op_code != 0x00)
+      break;
+
+    if (data->payload_offset == 0)
+      rx_len = 0;
+
+    if (rx_len + data->data_len >= HA_WS_RX_BUFFER_SIZE)
+    {
+      if (rx_len < HA_WS_RX_BUFFER_SIZE)
+        debug_log_warning_f(DEBUG_TAG_HA_API, "WebSocket: message of %d bytes dropped", data->payload_len);
+      rx_len = HA_WS_RX_BUFFER_SIZE; // Swallow the remaining fragments
+      break;
+    }
+
+    memcpy(rx_buffer + rx_len, data->data_ptr, data->data_len);
+    rx_len += data->data_len;
+
+    if (data->payload_offset + data->data_len >= data->payload_len)
+    {
+      rx_buffer[rx_len] = '\0';
+      handle_message(rx_buffer);
+      rx_len = 0;
+    }
+    break;
+
+  case WEBSOCKET_EVENT_ERROR:
+    debug_log_warning(DEBUG_TAG_HA_API, "WebSocket: transport error");
+    break;
+
+  default:
+    break;
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ha_websocket_start(const char *const *entity_ids, int entity_count, ha_websocket_state_callback_t callback)
+{
+  if (!entity_ids || entity_count <= 0 || entity_count > HA_WS_MAX_ENTITIES || !callback)
+    return ESP_ERR_INVALID_ARG;
+
+  if (ws_client)
+    return ESP_OK;
+
+  if (!rx_buffer)
+  {
+    rx_buffer = heap_caps_malloc(HA_WS_RX_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!rx_buffer)
+      return ESP_ERR_NO_MEM;
+  }
+
+  ws_entity_ids = entity_ids;
+  ws_entity_count = entity_count;
+  ws_state_callback = callback;
+
+  // The active HA server, HA_WEBSOCKET_URL for the primary
+  char uri[HA_SERVERS_URL_LEN + 16];
+  int server = HA_SERVERS_PRIMARY;
+  ha_servers_websocket_url(uri, sizeof(uri), &server);
+  esp_websocket_client_config_t config = {
+      .uri = uri,
+      .task_prio = (int)task_plan_get(TASK_PLAN_WEBSOCKET)->priority,
+      .task_stack = (int)task_plan_get(TASK_PLAN_WEBSOCKET)->stack_size,
+      .reconnect_timeout_ms = HA_WS_RECONNECT_MS,
+      .network_timeout_ms = HA_WS_NETWORK_TIMEOUT_MS,
+      .ping_interval_sec = HA_WS_PING_INTERVAL_S,
+#if CONFIG_HA_HTTPS_CA_BUNDLE
+      .crt_bundle_attach = esp_crt_bundle_attach,
+#elif CONFIG_HA_HTTPS
+      .cert_pem = HA_SERVER_CA_CERT_PEM,
+#endif
+  };
+#if CONFIG_HA_SERVER_FAILOVER
+  if (server != HA_SERVERS_PRIMARY)
+  {
+    // Alternative URLs (Nabu Casa) have public certificates
+    config.cert_pem = NULL;
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+#endif
+  }
+#endif
+
+  ws_client = esp_websocket_client_init(&config);
+  if (!ws_client)
+  {
+    debug_log_error(DEBUG_TAG_HA_API, "WebSocket: client init failed");
+    return ESP_FAIL;
+  }
+
+  esp_websocket_register_events(ws_client, WEBSOCKET_EVENT_ANY, websocket_event_handler, NULL);
+  esp_err_t ret = esp_websocket_client_start(ws_client);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_HA_API, "WebSocket: start failed: %s", esp_err_to_name(ret));
+    esp_websocket_client_destroy(ws_client);
+    ws_client = NULL;
+  }
+  return ret;
+}
+
+void ha_websocket_stop(void)
+{
+  if (!ws_client)
+    return;
+
+  esp_websocket_client_stop(ws_client);
+  esp_websocket_client_destroy(ws_client);
+  ws_client = NULL;
+  ws_subscribed = false;
+}
+
+bool ha_websocket_is_subscribed(void)
+{
+  return ws_subscribed;
+}
+
+void ha_websocket_register_drop_callback(ha_websocket_drop_callback_t callback)
+{
+  ws_drop_callback = callback;
+}
+
+void ha_websocket_register_event_callback(const char *event_type, ha_websocket_event_callback_t callback)
+{
+  ws_event_type = event_type;
+  ws_event_callback = event_type ? callback : NULL;
+}
+
+#else
+
+esp_err_t ha_websocket_start(const char *const *entity_ids, int entity_count, ha_websocket_state_callback_t callback)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ha_websocket_stop(void)
+{
+}
+
+bool ha_websocket_is_subscribed(void)
+{
+  return false;
+}
+
+void ha_websocket_register_drop_callback(ha_websocket_drop_callback_t callback)
+{
+}
+
+void ha_websocket_register_event_callback(const char *event_type, ha_websocket_event_callback_t callback)
+{
+}
+
+#endif // CONFIG_HA_WEBSOCKET
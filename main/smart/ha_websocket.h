@@ -0,0 +1,121 @@
+/**
+ * @file ha_websocket.h
+ * @brief Home Assistant WebSocket Subscription Client
+ *
+ * Keeps one connection to the Home Assistant WebSocket API
+ * (/api/websocket), authenticates with the long-lived token and subscribes
+ * to state changes of a fixed set of entities (subscribe_entities). State
+ * changes are pushed to a callback as they happen; REST stays in charge of
+ * the initial snapshot and of polling while the socket is down.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HA_WEBSOCKET_H
+#define HA_WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ha_entity_registry.h"
+
+struct cJSON;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Maximum number of entities in one subscription */
+#define HA_WS_MAX_ENTITIES HA_REGISTRY_MAX_ENTITIES
+
+  /** Reassembly buffer for fragmented messages, allocated in PSRAM.
+   *  The first event carries the full state of every subscribed entity */
+#define HA_WS_RX_BUFFER_SIZE 16384
+
+  // =======================================================================
+  // CALLBACK TYPES
+  // =======================================================================
+
+  /**
+   * @brief Entity state change callback
+   * @param entity_id Entity whose state changed
+   * @param state New state string (e.g. "on", "off", "unavailable"), NULL if only attributes changed
+   * @param attributes Attributes sent with it, only the changed ones for updates; may be NULL
+   * @param last_changed Unix time of the change, 0 if not sent
+   * @note Runs in the WebSocket client task
+   */
+  typedef void (*ha_websocket_state_callback_t)(const char *entity_id, const char *state,
+                                                const struct cJSON *attributes, uint32_t last_changed);
+
+  /**
+   * @brief Told when a confirmed subscription is lost, changes may have been missed
+   * @note Runs in the WebSocket client task
+   */
+  typedef void (*ha_websocket_drop_callback_t)(void);
+
+  /**
+   * @brief Receives the events of the type given to ha_websocket_register_event_callback()
+   * @param data The event's "data" object, NULL if it had none
+   * @note Runs in the WebSocket client task, must not block
+   */
+  typedef void (*ha_websocket_event_callback_t)(const struct cJSON *data);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Connect and subscribe to state changes
+   *
+   * The client reconnects and resubscribes on its own after a connection
+   * loss. Entity IDs must stay valid until ha_websocket_stop().
+   *
+   * @param entity_ids Entities to subscribe to
+   * @param entity_count Number of entities (at most HA_WS_MAX_ENTITIES)
+   * @param callback Function receiving state changes
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if CONFIG_HA_WEBSOCKET is disabled,
+   *         error code on failure
+   */
+  esp_err_t ha_websocket_start(const char *const *entity_ids, int entity_count, ha_websocket_state_callback_t callback);
+
+  /**
+   * @brief Close the connection and release the client
+   */
+  void ha_websocket_stop(void);
+
+  /**
+   * @brief Check whether state changes are currently being pushed
+   * @return true once authenticated and the subscription is confirmed
+   */
+  bool ha_websocket_is_subscribed(void);
+
+  /**
+   * @brief Register the function told when the subscription drops
+   * @param callback Called once per lost subscription, NULL to stop
+   */
+  void ha_websocket_register_drop_callback(ha_websocket_drop_callback_t callback);
+
+  /**
+   * @brief Subscribe to one HA event type besides the entity states
+   *
+   * The subscription (subscribe_events) is sent after every authentication,
+   * next to the entity subscription; a rejected one is logged and leaves
+   * the entity states alone.
+   *
+   * @param event_type Event type, e.g. one fired by an automation; must stay valid
+   * @param callback Called for each event, NULL to stop
+   * @note Call before ha_websocket_start(), one event type at a time
+   */
+  void ha_websocket_register_event_callback(const char *event_type, ha_websocket_event_callback_t callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HA_WEBSOCKET_H
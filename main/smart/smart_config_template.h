@@ -10,6 +10,8 @@
 #ifndef SMART_CONFIG_H
 #define SMART_CONFIG_H
 
+#include "sdkconfig.h"
+
 // =======================================================================
 // HOME ASSISTANT CONFIGURATION
 // =======================================================================
@@ -23,10 +25,36 @@
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
+// URL schemes, CONFIG_HA_HTTPS switches both to TLS
+#if CONFIG_HA_HTTPS
+#define HA_HTTP_SCHEME "https://"
+#define HA_WS_SCHEME "wss://"
+#else
+#define HA_HTTP_SCHEME "http://"
+#define HA_WS_SCHEME "ws://"
+#endif
+
+// CA certificate when CONFIG_HA_HTTPS_CA_BUNDLE is off (self-signed or local CA)
+// #define HA_SERVER_CA_CERT_PEM "-----BEGIN CERTIFICATE-----\n...\n-----END CERTIFICATE-----\n"
+
 // Home Assistant API Endpoints
-#define HA_API_BASE_URL "http://" HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT) "/api"
+#define HA_API_BASE_URL HA_HTTP_SCHEME HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT) "/api"
 #define HA_API_STATES_URL HA_API_BASE_URL "/states"
 #define HA_API_SERVICES_URL HA_API_BASE_URL "/services"
+#define HA_API_TEMPLATE_URL HA_API_BASE_URL "/template"
+#define HA_WEBSOCKET_URL HA_WS_SCHEME HA_SERVER_HOST_NAME ":" TOSTRING(HA_SERVER_PORT) "/api/websocket"
+
+// Other URLs of the same Home Assistant when CONFIG_HA_SERVER_FAILOVER is on, scheme, host
+// and port without a path, up to three; the token above must be valid on all of them
+// #define HA_SERVER_ALT_URLS "https://YOUR_REMOTE_ID.ui.nabu.casa:443"
+
+// MQTT broker login when CONFIG_HA_MQTT is on and the broker requires one
+// #define HA_MQTT_USERNAME "dashboard"
+// #define HA_MQTT_PASSWORD "YOUR_MQTT_PASSWORD_HERE"
+
+// Key authenticating panel-to-panel frames when CONFIG_HA_SHARE is on, the same
+// on every panel; defaults to HA_API_TOKEN
+// #define HA_SHARE_KEY "YOUR_SHARED_PANEL_KEY_HERE"
 
 // =======================================================================
 // SMART HOME ENTITY CONFIGURATION
@@ -45,4 +73,8 @@
 #define HA_ENTITY_C_LABEL "Switch C"
 #define HA_ENTITY_D_LABEL "Scene"
 
+// Camera shown on the camera page, snapshots come from /api/camera_proxy;
+// leave it out for no camera page
+// #define HA_CAMERA_ENTITY_ID "camera.your_camera_entity_id"
+
 #endif // SMART_CONFIG_H
@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include "cJSON.h"
 #include "esp_err.h"
 #include "esp_task_wdt.h"
 #include "esp_timer.h"
@@ -20,13 +21,53 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ha_api.h"
+#include "ha_entity_icons.h"
+#include "ha_entity_registry.h"
+#include "ha_executor.h"
+#include "ha_mqtt.h"
+#include "ha_outbox.h"
+#include "ha_servers.h"
+#include "ha_share.h"
+#include "ha_shortcuts.h"
 #include "ha_status.h"
+#include "ha_websocket.h"
 #include "smart_config.h"
-#include "ui/ui_controls_panel.h"
+#include "utils/boot_graph.h"
+#include "utils/event_bus.h"
+#include "utils/mem_governor.h"
 #include "utils/system_debug_utils.h"
+#include "utils/task_plan.h"
+#include "utils/task_stack.h"
+#include "utils/touch_latency.h"
+#include "utils/trace_spans.h"
+#include "wifi_manager.h"
 
-// External callback from dashboard_main.c
-extern void ha_status_change_callback(bool is_ready, bool is_syncing, const char *status_text);
+// =======================================================================
+// CONSTANTS AND CONFIGURATION
+// =======================================================================
+
+#define HA_REST_POLL_INTERVAL_S 30 ///< REST polling while no push channel is up
+
+#ifdef CONFIG_HA_REST_POLL_MAX_SECONDS
+#define HA_REST_POLL_MAX_INTERVAL_S CONFIG_HA_REST_POLL_MAX_SECONDS
+#else
+#define HA_REST_POLL_MAX_INTERVAL_S 120
+#endif
+
+#if CONFIG_HA_WEBSOCKET
+#define HA_PUSH_RESYNC_INTERVAL_S CONFIG_HA_WEBSOCKET_RESYNC_SECONDS
+#else
+#define HA_PUSH_RESYNC_INTERVAL_S HA_REST_POLL_INTERVAL_S
+#endif
+
+#define SYNC_WDT_FEED_S 10 ///< Longest sleep of the sync task while it is watched
+#define SHARE_ELECTION_WAIT_MS 10000 ///< Longest the first sync waits for the panel election
+
+#if CONFIG_HA_TEMPLATE_STATE_FETCH
+#define TEMPLATE_FETCH_ALWAYS true
+#else
+#define TEMPLATE_FETCH_ALWAYS false ///< Only while the internal heap is short
+#endif
 
 // =======================================================================
 // PRIVATE VARIABLES
@@ -34,24 +75,395 @@ extern void ha_status_change_callback(bool is_ready, bool is_syncing, const char
 
 static bool smart_home_initialized = false;
 static TaskHandle_t sync_task_handle = NULL;
-static smart_home_states_sync_callback_t states_sync_callback = NULL;
+
+/**
+ * @brief Toggle command sent from the panel but not answered by HA yet
+ */
+typedef struct
+{
+  bool active;
+  uint32_t seq;  ///< Sequence of the newest command, older completions are stale
+  bool desired;  ///< State shown optimistically while pending
+  bool previous; ///< State shown before the first pending command, rollback target
+} pending_toggle_t;
+
+/**
+ * @brief Brightness or setpoint sent from the panel but not answered by HA yet
+ */
+typedef struct
+{
+  bool active;
+  uint32_t seq; ///< Sequence of the newest command, older completions are stale
+  float level;  ///< Level shown while pending
+} pending_level_t;
+
+// Last confirmed entity states by registry index, fed by REST sync, WebSocket pushes and command results
+static ha_entity_state_t entity_states[HA_REGISTRY_MAX_ENTITIES];
+static pending_toggle_t pending_toggles[HA_REGISTRY_MAX_ENTITIES];
+static pending_level_t pending_levels[HA_REGISTRY_MAX_ENTITIES];
+static portMUX_TYPE entity_states_lock = portMUX_INITIALIZER_UNLOCKED; ///< Guards states and pending commands
+static volatile uint32_t state_activity_count = 0; ///< Bumped by every state change and panel command, drives poll backoff
+static bool push_paused = false; ///< WebSocket stopped while another panel leads, sync task only
+static volatile bool push_server_changed = false; ///< Active HA server changed, the sync task moves the WebSocket
+static volatile bool lean_fetch = false; ///< Internal heap under pressure, fetch states in one small request
 
 // =======================================================================
 // PRIVATE FUNCTION DECLARATIONS
 // =======================================================================
 
 static void sync_task_function(void *pvParameters);
+static void wake_sync_task(void);
 static esp_err_t run_sync_states_task(void);
+static bool update_entity_state(int index, const ha_entity_state_t *state);
+static void publish_entity_states(void);
+static void websocket_state_callback(const char *entity_id, const char *state, const cJSON *attributes,
+                                     uint32_t last_changed);
+static esp_err_t start_push_channel(void);
+static void command_done_callback(const ha_command_t *command, esp_err_t result);
 
 // =======================================================================
 // PRIVATE FUNCTION IMPLEMENTATIONS
 // =======================================================================
 
-static void sync_task_function(void *pvParameters)
+/**
+ * @brief Merge a fetched or pushed state into the confirmed states
+ * @return true if the entity changed since it was last seen
+ */
+static bool update_entity_state(int index, const ha_entity_state_t *state)
+{
+  if (index < 0 || index >= ha_registry_count())
+    return false;
+
+  ha_entity_state_t *entry = &entity_states[index];
+
+  portENTER_CRITICAL(&entity_states_lock);
+  ha_entity_state_t previous = *entry;
+  *entry = *state;
+  if (previous.found && state->kind != HA_STATE_ON && state->kind != HA_STATE_OFF)
+  {
+    // unavailable/unknown keep the last real switch position on screen
+    entry->is_on = previous.is_on;
+  }
+  // Pushes carry neither name nor always a timestamp
+  if (entry->friendly_name == HA_ATOM_NONE)
+    entry->friendly_name = previous.friendly_name;
+  if (entry->last_changed == 0)
+    entry->last_changed = previous.last_changed;
+  // Only some fetch paths report units, a reading keeps the one it had
+  if (entry->kind == HA_STATE_NUMERIC && entry->text == HA_ATOM_NONE && previous.kind == HA_STATE_NUMERIC)
+    entry->text = previous.text;
+  // An off light reports no brightness, its slider keeps the last one
+  if (!entry->has_level && previous.has_level && entry->kind != HA_STATE_NUMERIC)
+  {
+    entry->value = previous.value;
+    entry->has_level = true;
+  }
+
+  // A moved last_changed counts even if the state came back to the same value
+  bool changed = !ha_entity_state_same(&previous, entry) || entry->last_changed != previous.last_changed;
+  if (changed)
+    state_activity_count++;
+  portEXIT_CRITICAL(&entity_states_lock);
+  if (changed)
+  {
+    wake_sync_task();
+    ha_share_state_changed(index);
+  }
+  return changed;
+}
+
+static void publish_entity_states(void)
+{
+  ha_entity_state_t states[HA_REGISTRY_MAX_ENTITIES];
+  int count = ha_registry_count();
+
+  portENTER_CRITICAL(&entity_states_lock);
+  memcpy(states, entity_states, count * sizeof(ha_entity_state_t));
+  // A sync must not undo what the user just did, pending commands stay visible
+  for (int i = 0; i < count; i++)
+  {
+    if (pending_toggles[i].active)
+    {
+      states[i].is_on = pending_toggles[i].desired;
+      states[i].kind = states[i].is_on ? HA_STATE_ON : HA_STATE_OFF;
+      states[i].found = true;
+    }
+    if (pending_levels[i].active && states[i].kind != HA_STATE_NUMERIC)
+    {
+      states[i].value = pending_levels[i].level;
+      states[i].has_level = true;
+    }
+  }
+  portEXIT_CRITICAL(&entity_states_lock);
+
+  // Entities without a real state yet are flagged, receivers leave them alone
+  event_t event = {.topic = EVENT_TOPIC_HA_STATES, .ha_states = {.states = states, .count = count}};
+  event_bus_publish(&event);
+}
+
+/**
+ * @brief Confirm or drop the level a finished HA_COMMAND_LEVEL showed
+ */
+static void level_command_done(const ha_command_t *command, esp_err_t result)
+{
+  int index = ha_registry_find(command->entity_id);
+  if (index < 0)
+    return;
+
+  pending_level_t *pending = &pending_levels[index];
+  ha_entity_state_t *entry = &entity_states[index];
+  bool rollback = false;
+
+  portENTER_CRITICAL(&entity_states_lock);
+  if (result == ESP_OK && entry->kind != HA_STATE_NUMERIC)
+  {
+    entry->value = command->level;
+    entry->has_level = true;
+    if (strncmp(command->entity_id, "light.", 6) == 0)
+    {
+      // Brightness 0 was sent as turn_off
+      entry->is_on = command->level > 0;
+      entry->kind = entry->is_on ? HA_STATE_ON : HA_STATE_OFF;
+      entry->found = true;
+    }
+  }
+  if (pending->active && pending->seq == command->seq)
+  {
+    // A failure leaves the last confirmed level on screen
+    pending->active = false;
+    rollback = result != ESP_OK;
+  }
+  portEXIT_CRITICAL(&entity_states_lock);
+
+  if (rollback)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Rolling back level of %s", command->entity_id);
+  }
+  publish_entity_states();
+}
+
+/**
+ * @brief Confirm or roll back what the panel shows for a command that is over
+ */
+static void finish_command(const ha_command_t *command, esp_err_t result)
+{
+  if (result != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "Command #%lu for %s failed: %s", command->seq, command->entity_id,
+                      esp_err_to_name(result));
+  }
+
+  if (command->type == HA_COMMAND_LEVEL)
+  {
+    level_command_done(command, result);
+    return;
+  }
+
+  int index = (command->type == HA_COMMAND_SWITCH) ? ha_registry_find(command->entity_id) : -1;
+  if (index < 0)
+    return;
+
+  pending_toggle_t *pending = &pending_toggles[index];
+  ha_entity_state_t *entry = &entity_states[index];
+  bool rollback = false;
+
+  portENTER_CRITICAL(&entity_states_lock);
+  if (result == ESP_OK)
+  {
+    // HA accepted the command, it is the confirmed state now
+    entry->is_on = command->turn_on;
+    entry->kind = command->turn_on ? HA_STATE_ON : HA_STATE_OFF;
+    entry->found = true;
+  }
+
+  if (pending->active && pending->seq == command->seq)
+  {
+    // Newest command finished; a failure restores the last confirmed state,
+    // or what the panel showed before the toggle if none is known yet
+    pending->active = false;
+    if (result != ESP_OK)
+    {
+      rollback = true;
+      if (!entry->found)
+      {
+        entry->is_on = pending->previous;
+        entry->found = true;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&entity_states_lock);
+
+  if (result == ESP_OK)
+  {
+    touch_latency_mark_command_done();
+  }
+
+  if (rollback)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Rolling back %s", command->entity_id);
+  }
+  publish_entity_states();
+}
+
+static void command_done_callback(const ha_command_t *command, esp_err_t result)
 {
-  // Wait for network to be ready before starting sync
+  // HA or WiFi down: keep the command and what the panel shows, it is replayed later
+  if (result != ESP_OK && ha_outbox_is_transient(result) && ha_outbox_hold(command))
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Command #%lu for %s held until HA answers: %s", command->seq,
+                        command->entity_id, esp_err_to_name(result));
+    return;
+  }
 
-  vTaskDelay(pdMS_TO_TICKS(10000));
+  ha_outbox_forget(command->entity_id, command->seq);
+  finish_command(command, result);
+}
+
+/**
+ * @brief A held command waited too long, show the last confirmed state again
+ */
+static void outbox_stale_callback(const ha_command_t *command)
+{
+  finish_command(command, ESP_ERR_TIMEOUT);
+}
+
+/**
+ * @brief A circuit closed, HA takes requests again
+ */
+static void api_recovery_callback(void)
+{
+  if (ha_outbox_count() > 0)
+  {
+    ha_outbox_replay(outbox_stale_callback);
+  }
+}
+
+/**
+ * @brief Memory governor shed callback
+ *
+ * The per-entity fetch runs a helper task and an HTTP client per
+ * connection; the template fetch is one request with a reply under 1 KB.
+ */
+static void smart_home_shed(mem_pressure_t level, void *ctx)
+{
+  (void)ctx;
+  lean_fetch = level >= MEM_PRESSURE_ELEVATED;
+}
+
+static void websocket_state_callback(const char *entity_id, const char *state, const cJSON *attributes,
+                                     uint32_t last_changed)
+{
+  int index = ha_registry_find(entity_id);
+  if (index >= 0)
+  {
+    ha_entity_state_t pushed;
+    if (state)
+    {
+      ha_entity_state_set(&pushed, state, NULL, last_changed);
+    }
+    else
+    {
+      // Only attributes changed, e.g. a light was dimmed
+      portENTER_CRITICAL(&entity_states_lock);
+      pushed = entity_states[index];
+      portEXIT_CRITICAL(&entity_states_lock);
+      pushed.has_level = false;
+      pushed.last_changed = 0;
+    }
+    ha_entity_state_read_attributes(&pushed, attributes);
+    if (!update_entity_state(index, &pushed))
+      return;
+    publish_entity_states();
+    debug_log_info_f(DEBUG_TAG_HA_SYNC, "Pushed state: %s=%s", entity_id, state ? state : "(attributes)");
+  }
+}
+
+/**
+ * @brief States from the device's own topics, same path as WebSocket pushes
+ */
+static void mqtt_state_callback(const char *entity_id, const char *state)
+{
+  websocket_state_callback(entity_id, state, NULL, 0);
+}
+
+/**
+ * @brief Confirmed state for the other panels, when this one leads
+ */
+static bool share_get_state(int index, ha_entity_state_t *state)
+{
+  if (index < 0 || index >= ha_registry_count())
+    return false;
+
+  portENTER_CRITICAL(&entity_states_lock);
+  *state = entity_states[index];
+  portEXIT_CRITICAL(&entity_states_lock);
+  return state->found;
+}
+
+/**
+ * @brief States from the leading panel, same path as a REST sync
+ */
+static void share_apply_states(const int *indices, const ha_entity_state_t *states, int count)
+{
+  int changed = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (states[i].found && update_entity_state(indices[i], &states[i]))
+      changed++;
+  }
+  if (changed > 0)
+    publish_entity_states();
+}
+
+static void share_role_callback(ha_share_role_t role)
+{
+  wake_sync_task();
+}
+
+static void server_switch_callback(int server)
+{
+  push_server_changed = true;
+  wake_sync_task();
+}
+
+/**
+ * @brief Follow the panel's share role: a follower leaves HA to the leader
+ * @return true while following
+ */
+static bool apply_share_role(void)
+{
+  bool following = ha_share_get_role() == HA_SHARE_FOLLOWER;
+  if (following && !push_paused)
+  {
+    debug_log_info(DEBUG_TAG_HA_SYNC, "Another panel leads, states come from it");
+    ha_websocket_stop();
+    push_paused = true;
+  }
+  else if (!following && push_paused)
+  {
+    debug_log_info(DEBUG_TAG_HA_SYNC, "Syncing with HA again");
+    push_paused = false;
+    start_push_channel();
+  }
+  return following;
+}
+
+/**
+ * @brief Have the sync task re-evaluate its wait instead of polling for changes
+ */
+static void wake_sync_task(void)
+{
+  TaskHandle_t task = sync_task_handle;
+  if (task)
+    xTaskNotifyGive(task);
+}
+
+static void sync_task_function(void *pvParameters)
+{
+  // Start as soon as the station has an address instead of after a fixed delay
+  wifi_manager_wait_for_ip(portMAX_DELAY);
+  // Panels that share states let the election pick who talks to HA first
+  ha_share_wait_elected(pdMS_TO_TICKS(SHARE_ELECTION_WAIT_MS));
 
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
   // Subscribe current task to task watchdog (disabled for large HA installations)
@@ -68,6 +480,11 @@ static void sync_task_function(void *pvParameters)
   debug_log_info(DEBUG_TAG_SMART_HOME, "Sync task watchdog monitoring disabled for large HA responses");
 #endif
 
+  int poll_interval_s = HA_REST_POLL_INTERVAL_S;
+  uint32_t seen_activity = state_activity_count;
+  bool shortcuts_fetched = false;
+  bool icons_fetched = false;
+
   while (1)
   {
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
@@ -79,8 +496,44 @@ static void sync_task_function(void *pvParameters)
     }
 #endif
 
+    // A follower gets every state from the leading panel and stays off HA
+    if (apply_share_role())
+    {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SYNC_WDT_FEED_S * 1000));
+      continue;
+    }
+
+    // Requests went over to another HA server, the push channel follows and the sync below catches up
+    if (push_server_changed)
+    {
+      push_server_changed = false;
+      ha_websocket_stop();
+      start_push_channel();
+    }
+
     // Add error handling to prevent task crashes
     smart_home_sync_switch_states();
+    boot_graph_mark_milestone("ha_first_sync");
+
+    // A sync that got through also covers outages too short to open a circuit
+    ha_status_t sync_status = ha_status_get_current();
+    if (ha_outbox_count() > 0 && (sync_status == HA_STATUS_STATES_SYNCED || sync_status == HA_STATUS_PARTIAL_SYNC))
+    {
+      ha_outbox_replay(outbox_stale_callback);
+    }
+
+    // Scene and script names and icons once per boot, retried until HA answers;
+    // the grid shows the NVS copy meanwhile
+    if (!shortcuts_fetched)
+    {
+      esp_err_t shortcuts_err = ha_shortcuts_refresh();
+      shortcuts_fetched = shortcuts_err == ESP_OK || shortcuts_err == ESP_ERR_NOT_SUPPORTED;
+    }
+    if (!icons_fetched)
+    {
+      esp_err_t icons_err = ha_entity_icons_refresh();
+      icons_fetched = icons_err == ESP_OK || icons_err == ESP_ERR_NOT_SUPPORTED;
+    }
 
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
     // Feed watchdog after sync completion
@@ -91,31 +544,79 @@ static void sync_task_function(void *pvParameters)
     }
 #endif
 
-    // Wait for 30 seconds before next sync (longer interval due to connection issues)
-    // Break the delay into smaller chunks to feed watchdog periodically
-    for (int i = 0; i < 30; i++)
+    // While the WebSocket pushes changes REST only resyncs as a safety net.
+    // Otherwise poll every 30 seconds, doubling the interval while nothing
+    // changes so a quiet house costs fewer requests
+    uint32_t activity = state_activity_count;
+    if (activity != seen_activity)
+    {
+      poll_interval_s = HA_REST_POLL_INTERVAL_S;
+    }
+    else if (poll_interval_s < HA_REST_POLL_MAX_INTERVAL_S)
     {
-      vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second delay
+      poll_interval_s = (poll_interval_s * 2 < HA_REST_POLL_MAX_INTERVAL_S) ? poll_interval_s * 2 : HA_REST_POLL_MAX_INTERVAL_S;
+      debug_log_debug_f(DEBUG_TAG_HA_SYNC, "No state changes, next poll in %d s", poll_interval_s);
+    }
+    seen_activity = activity;
+
+    bool push_active = ha_websocket_is_subscribed();
+    int wait_s = push_active ? HA_PUSH_RESYNC_INTERVAL_S : poll_interval_s;
+
+    // Sleep until the next sync is due. A dropped push channel and state
+    // activity notify the task, so it wakes for them instead of polling
+    TickType_t wait_start = xTaskGetTickCount();
+    TickType_t wait_ticks = pdMS_TO_TICKS(wait_s * 1000);
+    TickType_t elapsed;
+    while ((elapsed = xTaskGetTickCount() - wait_start) < wait_ticks)
+    {
+      // Push channel dropped: changes may have been missed, resync now
+      if ((push_active && !ha_websocket_is_subscribed()) || push_server_changed)
+      {
+        break;
+      }
+
+      TickType_t sleep = wait_ticks - elapsed;
+      // The panel was used, poll at the base rate again
+      if (!push_active && state_activity_count != seen_activity)
+      {
+        TickType_t base_ticks = pdMS_TO_TICKS(HA_REST_POLL_INTERVAL_S * 1000);
+        if (elapsed >= base_ticks)
+        {
+          break;
+        }
+        sleep = base_ticks - elapsed;
+      }
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
-      if (i % 10 == 0) // Feed watchdog every 10 seconds during wait
+      if (sleep > pdMS_TO_TICKS(SYNC_WDT_FEED_S * 1000))
       {
-        esp_task_wdt_reset();
+        sleep = pdMS_TO_TICKS(SYNC_WDT_FEED_S * 1000);
       }
+#endif
+      ulTaskNotifyTake(pdTRUE, sleep);
+#ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
+      esp_task_wdt_reset();
 #endif
     }
   }
 }
 
+/**
+ * @brief Push channel for state changes, REST polling covers for it when unavailable
+ */
+static esp_err_t start_push_channel(void)
+{
+  esp_err_t ret = ha_websocket_start(ha_registry_entity_ids(), ha_registry_count(), websocket_state_callback);
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "WebSocket client not started: %s", esp_err_to_name(ret));
+  }
+  return ret;
+}
+
 static esp_err_t run_sync_states_task(void)
 {
-  BaseType_t result = xTaskCreate(
-      sync_task_function,
-      "SyncStatesTask",
-      16384, // Stack size - increased to 16KB for individual API call operations and watchdog prevention
-      NULL,
-      2,                // Priority
-      &sync_task_handle // Store task handle for cleanup
-  );
+  // HTTP and parsing only, no flash writes, so the stack can live in PSRAM
+  BaseType_t result = task_plan_create(TASK_PLAN_SYNC_STATES, sync_task_function, NULL, &sync_task_handle);
 
   if (result != pdPASS)
   {
@@ -156,12 +657,35 @@ esp_err_t smart_home_init(void)
     return ret;
   }
 
+  // Worker for service calls, callers only enqueue
+  ret = ha_executor_start(command_done_callback);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "Failed to start HA executor: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  // Commands held through an outage go out as soon as HA answers again
+  ha_api_register_recovery_callback(api_recovery_callback);
+  ha_websocket_register_drop_callback(wake_sync_task);
+  mem_governor_register("ha_fetch", MEM_GOVERNOR_REGION(HEAP_REGION_INTERNAL), smart_home_shed, NULL);
+
+  // Other URLs of the same HA take over while the primary is down or slow
+  ret = ha_servers_start(server_switch_callback);
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "HA server failover not started: %s", esp_err_to_name(ret));
+  }
+
   smart_home_initialized = true;
   debug_log_event(DEBUG_TAG_SMART_HOME, "Smart Home integration initialized successfully");
 
-  // Register the status change callback now that HA status module is initialized
-  ha_status_register_change_callback(ha_status_change_callback);
-  debug_log_info(DEBUG_TAG_SMART_HOME, "HA status change callback registered");
+  // Elect which panel syncs with HA, the others take states from it
+  ret = ha_share_start(share_get_state, share_apply_states, share_role_callback);
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "Panel state sharing not started: %s", esp_err_to_name(ret));
+  }
 
   // Start periodic sync task
   ret = run_sync_states_task();
@@ -171,6 +695,16 @@ esp_err_t smart_home_init(void)
     return ret;
   }
 
+  // A follower never needs it, the sync task stops it once the election is over
+  start_push_channel();
+
+  // Direct device path for the switches routed over MQTT
+  ret = ha_mqtt_start(mqtt_state_callback);
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED && ret != ESP_ERR_NOT_FOUND)
+  {
+    debug_log_warning_f(DEBUG_TAG_SMART_HOME, "MQTT client not started: %s", esp_err_to_name(ret));
+  }
+
   return ESP_OK;
 }
 
@@ -183,11 +717,17 @@ esp_err_t smart_home_deinit(void)
 
   debug_log_event(DEBUG_TAG_SMART_HOME, "Deinitializing integration");
 
+  ha_mqtt_stop();
+  ha_share_stop();
+  ha_servers_stop();
+  ha_websocket_stop();
+  ha_executor_stop();
+
   // Stop and cleanup sync task
   if (sync_task_handle != NULL)
   {
     // Task will unsubscribe from watchdog automatically when deleted
-    vTaskDelete(sync_task_handle);
+    task_stack_delete(sync_task_handle);
     sync_task_handle = NULL;
   }
 
@@ -211,46 +751,142 @@ esp_err_t smart_home_control_switch(const char *entity_id, bool turn_on)
 
   const char *action = turn_on ? "ON" : "OFF";
 
-  esp_err_t result;
-  if (turn_on)
+  // Queued for the HA worker, the outcome arrives in command_done_callback()
+  ha_command_t command = {.type = HA_COMMAND_SWITCH, .turn_on = turn_on};
+  strncpy(command.entity_id, entity_id, sizeof(command.entity_id) - 1);
+
+  // Track the optimistic state before queueing, the worker may finish first
+  int index = ha_registry_find(entity_id);
+  pending_toggle_t saved = {0};
+  if (index >= 0)
   {
-    result = ha_api_turn_on_switch(entity_id);
+    pending_toggle_t *pending = &pending_toggles[index];
+    portENTER_CRITICAL(&entity_states_lock);
+    saved = *pending;
+    if (!pending->active)
+    {
+      pending->previous = !turn_on; // The panel flipped the switch already
+    }
+    pending->active = true;
+    pending->desired = turn_on;
+    pending->seq = ha_executor_next_seq();
+    command.seq = pending->seq;
+    state_activity_count++;
+    portEXIT_CRITICAL(&entity_states_lock);
   }
-  else
+
+  // Marks the tap on the timeline, the HA worker's ha_http span follows it
+  TRACE_SPAN_INSTANT("ha_switch_queued");
+  esp_err_t result = ha_executor_submit(&command);
+  if (result != ESP_OK)
   {
-    result = ha_api_turn_off_switch(entity_id);
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "Failed to queue %s for switch %s: %s", action, entity_id, esp_err_to_name(result));
+    if (index >= 0)
+    {
+      // Nothing was sent, the caller reverts the switch
+      portENTER_CRITICAL(&entity_states_lock);
+      pending_toggles[index] = saved;
+      portEXIT_CRITICAL(&entity_states_lock);
+    }
   }
 
-  if (result == ESP_OK)
+  return result;
+}
+
+esp_err_t smart_home_set_level(const char *entity_id, float level)
+{
+  if (!smart_home_initialized)
   {
+    return ESP_ERR_INVALID_STATE;
   }
-  else
+  if (!entity_id)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  ha_command_t command = {.type = HA_COMMAND_LEVEL, .level = level};
+  strncpy(command.entity_id, entity_id, sizeof(command.entity_id) - 1);
+
+  // Shown until HA answers, so a sync in between does not snap the slider back
+  int index = ha_registry_find(entity_id);
+  pending_level_t saved = {0};
+  if (index >= 0)
+  {
+    pending_level_t *pending = &pending_levels[index];
+    portENTER_CRITICAL(&entity_states_lock);
+    saved = *pending;
+    pending->active = true;
+    pending->level = level;
+    pending->seq = ha_executor_next_seq();
+    command.seq = pending->seq;
+    state_activity_count++;
+    portEXIT_CRITICAL(&entity_states_lock);
+    wake_sync_task();
+  }
+
+  esp_err_t result = ha_executor_submit(&command);
+  if (result != ESP_OK)
   {
-    debug_log_error_f(DEBUG_TAG_SMART_HOME, "Failed to turn %s switch %s: %s", action, entity_id, esp_err_to_name(result));
+    debug_log_error_f(DEBUG_TAG_SMART_HOME, "Failed to queue level %.1f for %s: %s", (double)level, entity_id,
+                      esp_err_to_name(result));
+    if (index >= 0)
+    {
+      portENTER_CRITICAL(&entity_states_lock);
+      pending_levels[index] = saved;
+      portEXIT_CRITICAL(&entity_states_lock);
+    }
   }
 
   return result;
 }
 
-esp_err_t smart_home_trigger_scene(void)
+esp_err_t smart_home_trigger_scene(const char *entity_id)
 {
   if (!smart_home_initialized)
   {
     return ESP_ERR_INVALID_STATE;
   }
+  if (!entity_id)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  debug_log_info_f(DEBUG_TAG_SMART_HOME, "Triggering %s", entity_id);
 
-  debug_log_event(DEBUG_TAG_SMART_HOME, "Triggering scene button");
+  // The worker picks scene.turn_on or script.turn_on from the entity_id
+  ha_command_t command = {.type = HA_COMMAND_SCENE};
+  strncpy(command.entity_id, entity_id, sizeof(command.entity_id) - 1);
+  return ha_executor_submit(&command);
+}
 
-  // For scene entities, we use the scene.turn_on service
-  ha_service_call_t scene_call = {
-      .domain = "scene",
-      .service = "turn_on",
-      .entity_id = HA_ENTITY_D_ID};
+esp_err_t smart_home_fire_event(const char *event_type, const char *event_data)
+{
+  if (!smart_home_initialized)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!event_type)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
 
-  ha_api_response_t response;
-  esp_err_t ret = ha_api_call_service(&scene_call, &response);
+  ha_command_t command = {.type = HA_COMMAND_EVENT};
+  strlcpy(command.entity_id, event_type, sizeof(command.entity_id));
+  if (event_data)
+  {
+    command.event_data = strdup(event_data);
+    if (!command.event_data)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+  }
 
-  return ret;
+  esp_err_t result = ha_executor_submit(&command);
+  if (result != ESP_OK)
+  {
+    free(command.event_data);
+  }
+  return result;
 }
 
 void smart_home_sync_switch_states(void)
@@ -269,68 +905,79 @@ void smart_home_sync_switch_states(void)
     return;
   }
 
-  // Entity IDs from smart config
-  const char *switch_entity_ids[] = {
-      HA_ENTITY_A_ID, // Switch A
-      HA_ENTITY_B_ID, // Switch B
-      HA_ENTITY_C_ID  // Switch C
-  };
-  const int switch_count = sizeof(switch_entity_ids) / sizeof(switch_entity_ids[0]);
-
-  // Allocate switch states on heap instead of stack (each ha_entity_state_t is ~5.4KB)
-  ha_entity_state_t *switch_states = (ha_entity_state_t *)malloc(switch_count * sizeof(ha_entity_state_t));
-  if (!switch_states)
+  // While pushes arrive sensors are left to them, every subscription starts
+  // with their full state, so dozens of sensors cost no REST time
+  const char *const *registry_ids = ha_registry_entity_ids();
+  bool push_active = ha_websocket_is_subscribed();
+  const char *entity_ids[HA_REGISTRY_MAX_ENTITIES];
+  int registry_index[HA_REGISTRY_MAX_ENTITIES];
+  int entity_count = 0;
+  for (int i = 0; i < ha_registry_count(); i++)
+  {
+    if (push_active && ha_registry_is_sensor(ha_registry_get(i)->domain))
+      continue;
+    entity_ids[entity_count] = registry_ids[i];
+    registry_index[entity_count++] = i;
+  }
+  if (entity_count == 0)
   {
-    debug_log_error(DEBUG_TAG_HA_SYNC, "Failed to allocate memory for switch states");
     return;
   }
 
+  // Compact states fit on the stack, 16 bytes per entity
+  ha_entity_state_t fetched[HA_REGISTRY_MAX_ENTITIES];
+
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
   // Feed watchdog before potentially long HTTP operation
   esp_task_wdt_reset();
 #endif
 
-  esp_err_t ret = ha_api_get_multiple_entity_states(switch_entity_ids, switch_count, switch_states);
+  // One small rendered reply instead of a request per entity, also without the option while memory is short
+  esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+  if (TEMPLATE_FETCH_ALWAYS || lean_fetch)
+  {
+    ret = ha_api_get_multiple_entity_states_template(entity_ids, entity_count, fetched);
+  }
+  if (ret == ESP_ERR_NOT_SUPPORTED)
+  {
+    ret = ha_api_get_multiple_entity_states(entity_ids, entity_count, fetched);
+  }
 
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
   // Feed watchdog after HTTP operation completes
   esp_task_wdt_reset();
 #endif
 
-  if (ret == ESP_OK)
+  if (ret == ESP_OK || ret == ESP_ERR_NOT_FOUND)
   {
-    // Update UI with switch states
-    bool switch_a_on = (strcmp(switch_states[0].state, "on") == 0);
-    bool switch_b_on = (strcmp(switch_states[1].state, "on") == 0);
-    bool switch_c_on = (strcmp(switch_states[2].state, "on") == 0);
+    // Entities missing from a partial sync keep their previous state
+    int updated = 0;
+    int changed = 0;
+    for (int i = 0; i < entity_count; i++)
+    {
+      if (fetched[i].found)
+      {
+        updated++;
+        if (update_entity_state(registry_index[i], &fetched[i]))
+          changed++;
+      }
+    }
 
-    // Notify states sync callback if registered
-    if (states_sync_callback)
+    // Receivers only hear about syncs that moved something
+    if (changed > 0)
     {
-      bool switch_state_array[3] = {switch_a_on, switch_b_on, switch_c_on};
-      states_sync_callback(switch_state_array, 3);
+      publish_entity_states();
     }
 
-    debug_log_info_f(DEBUG_TAG_HA_SYNC, "Immediate sync completed: %s=%s, %s=%s, %s=%s",
-                     switch_entity_ids[0], switch_states[0].state,
-                     switch_entity_ids[1], switch_states[1].state,
-                     switch_entity_ids[2], switch_states[2].state);
+    debug_log_info_f(DEBUG_TAG_HA_SYNC, "Sync completed: %d/%d entities fetched, %d changed", updated, entity_count, changed);
   }
   else
   {
     debug_log_warning_f(DEBUG_TAG_HA_SYNC, "Immediate sync failed: %s", esp_err_to_name(ret));
   }
 
-  // Free allocated memory
-  free(switch_states);
-
 #ifndef HA_DISABLE_SYNC_TASK_WATCHDOG
   // Final watchdog feed
   esp_task_wdt_reset();
 #endif
 }
-
-void smart_home_register_states_sync_callback(smart_home_states_sync_callback_t callback)
-{
-  states_sync_callback = callback;
-}
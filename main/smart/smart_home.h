@@ -7,7 +7,10 @@
  *
  * Features:
  * - Simplified device control interface
- * - Periodic switch state synchronization (30s intervals)
+ * - Entities taken from the runtime registry (ha_entity_registry.h)
+ * - Periodic entity state synchronization (30s intervals)
+ * - Entity state changes published on the event bus (EVENT_TOPIC_HA_STATES),
+ *   indexed like the registry; syncs that find nothing new are not published
  * - Smart home status monitoring
  * - Integration with system monitor UI
  * - WiFi connection status handling
@@ -23,16 +26,21 @@
 #include <stdint.h>
 #include "esp_err.h"
 #include "ha_api.h"
+#include "ha_entity_registry.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
+
   /**
    * @brief Initialize smart home integration
    *
    * Sets up Home Assistant connection and starts periodic sync tasks.
-   * Creates a background task that syncs switch states every 30 seconds.
+   * State changes are pushed over the WebSocket API when CONFIG_HA_WEBSOCKET
+   * is enabled; a background task syncs switch states over REST while that
+   * channel is down, every 30 seconds and backing off while nothing changes,
+   * and as an occasional resync otherwise.
    *
    * @return ESP_OK on success, error code on failure
    */
@@ -48,27 +56,55 @@ extern "C"
   esp_err_t smart_home_deinit(void);
 
   /**
-   * @brief Control any switch entity
+   * @brief Control any toggle entity
    *
-   * Generic function to control any switch-type entity.
+   * Generic function to turn a switch or light on or off. The request is
+   * queued for the HA worker task and this function returns immediately.
    *
-   * @param entity_id Entity ID of the switch
+   * @param entity_id Entity ID of the switch or light
    * @param turn_on True to turn on, false to turn off
-   * @return ESP_OK on success, error code on failure
+   * @return ESP_OK if queued, error code if the command could not be queued
    */
   esp_err_t smart_home_control_switch(const char *entity_id, bool turn_on);
 
   /**
-   * @brief Trigger the scene
+   * @brief Set a light's brightness or a thermostat's target temperature
    *
-   * @return ESP_OK on success, error code on failure
+   * Queued for the HA worker like switch commands. The level is shown in
+   * published states until HA answers, a failure brings back the last
+   * confirmed one.
+   *
+   * @param entity_id light.* or climate.* entity
+   * @param level Brightness 0-255 (0 turns the light off) or temperature in HA's unit
+   * @return ESP_OK if queued, error code if the command could not be queued
+   */
+  esp_err_t smart_home_set_level(const char *entity_id, float level);
+
+  /**
+   * @brief Trigger a scene or start a script
+   *
+   * Queued for the HA worker task like switch commands.
+   *
+   * @param entity_id Entity ID of the scene or script
+   * @return ESP_OK if queued, error code on failure
+   */
+  esp_err_t smart_home_trigger_scene(const char *entity_id);
+
+  /**
+   * @brief Fire a Home Assistant event
+   *
+   * Queued for the HA worker task like switch commands, the data is copied.
+   *
+   * @param event_type Event type, e.g. "system_monitor_alert"
+   * @param event_data JSON object sent as the event data (may be NULL)
+   * @return ESP_OK if queued, error code on failure
    */
-  esp_err_t smart_home_trigger_scene(void);
+  esp_err_t smart_home_fire_event(const char *event_type, const char *event_data);
 
   /**
-   * @brief Sync switch states with Home Assistant
+   * @brief Sync entity states with Home Assistant
    *
-   * Immediately fetches current switch states from HA and updates the UI.
+   * Immediately fetches the states of every registry entity and updates the UI.
    * This function is called both manually and by the periodic sync task.
    *
    * @note This function performs network operations and may block briefly
@@ -86,23 +122,6 @@ extern "C"
    */
   void smart_home_update_wifi_status(bool is_connected);
 
-  /**
-   * @brief Smart home states sync callback function type
-   * @param switch_states Array of switch states (A, B, C)
-   * @param state_count Number of switch states in the array
-   */
-  typedef void (*smart_home_states_sync_callback_t)(bool switch_states[3], int state_count);
-
-  /**
-   * @brief Register a callback for smart home states synchronization updates
-   *
-   * The callback will be called whenever switch states are synchronized with Home Assistant.
-   * This allows other components to be notified of state changes without tight coupling.
-   *
-   * @param callback Function to call when states are synced (can be NULL to unregister)
-   */
-  void smart_home_register_states_sync_callback(smart_home_states_sync_callback_t callback);
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,202 @@
+/**
+ * @file telemetry_schema.h
+ * @brief The one list of telemetry metrics everything else is generated from
+ *
+ * Each metric is one X-macro entry. system_data_t, the SYSTEM_DATA_FIELD_*
+ * bits, the JSON and binary frame decoders, the change diff, the history
+ * store layout and the dashboard subjects are all expanded from these
+ * lists at compile time, so adding a metric is one line here plus whatever
+ * panel shows it, and no two of them can disagree.
+ *
+ * An entry is X(ID, SECTION, field, "json_key", TYPE, "unit", history, ui):
+ *
+ *   ID        SYSTEM_DATA_FIELD_<ID>, TELEMETRY_METRIC_<ID>, UI_DATA_<ID>
+ *   SECTION   ROOT, CPU, GPU or MEM: JSON object and system_data_t member
+ *   field     member name inside the section struct
+ *   json_key  key inside the section's JSON object
+ *   TYPE      U8, U16, U32, U64, F32, STR or U8_LIST: C type and wire encoding
+ *   unit      for documentation and host tools
+ *   history   HIST("name", scale) records value * scale as an integer
+ *             under that GET_HISTORY name, NO_HIST records nothing
+ *   ui        UI_INT, UI_TEXT or UI_LIST publishes a dashboard subject,
+ *             UI_NONE not
+ *
+ * Entry order is the binary frame bitmap order and so part of the wire
+ * protocol (see telemetry_frame.h): the section lists are concatenated
+ * ROOT first, and metrics added since go to TELEMETRY_SCHEMA_ADDED,
+ * whatever their section, so no earlier bit moves.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+#include <stdint.h>
+
+// =======================================================================
+// SCHEMA
+// =======================================================================
+
+#define TELEMETRY_STRING_LEN 32 ///< Storage of a STR field, terminator included
+#define TELEMETRY_LIST_MAX 32   ///< Values a U8_LIST field keeps, later ones are dropped
+
+/** Storage of a U8_LIST field, e.g. the usage of each CPU core */
+typedef struct
+{
+  uint8_t count; ///< Values in use, 0 while the host sends none
+  uint8_t value[TELEMETRY_LIST_MAX];
+} telemetry_u8_list_t;
+
+// clang-format off
+#define TELEMETRY_SCHEMA_ROOT(X) \
+  X(TIMESTAMP,     ROOT, timestamp, "ts",        U64, "ms",  NO_HIST,                      UI_NONE)
+
+#define TELEMETRY_SCHEMA_CPU(X) \
+  X(CPU_USAGE,     CPU,  usage,     "usage",     U8,  "%",   HIST("cpu_usage", 1),         UI_INT)  \
+  X(CPU_TEMP,      CPU,  temp,      "temp",      U8,  "C",   HIST("cpu_temp", 1),          UI_INT)  \
+  X(CPU_FAN,       CPU,  fan,       "fan",       U16, "RPM", HIST("cpu_fan", 1),           UI_INT)  \
+  X(CPU_NAME,      CPU,  name,      "name",      STR, "",    NO_HIST,                      UI_TEXT)
+
+#define TELEMETRY_SCHEMA_GPU(X) \
+  X(GPU_USAGE,     GPU,  usage,     "usage",     U8,  "%",   HIST("gpu_usage", 1),         UI_INT)  \
+  X(GPU_TEMP,      GPU,  temp,      "temp",      U8,  "C",   HIST("gpu_temp", 1),          UI_INT)  \
+  X(GPU_NAME,      GPU,  name,      "name",      STR, "",    NO_HIST,                      UI_TEXT) \
+  X(GPU_MEM_USED,  GPU,  mem_used,  "mem_used",  U32, "MB",  HIST("gpu_mem_used", 1),      UI_NONE) \
+  X(GPU_MEM_TOTAL, GPU,  mem_total, "mem_total", U32, "MB",  NO_HIST,                      UI_NONE)
+
+#define TELEMETRY_SCHEMA_MEM(X) \
+  X(MEM_USAGE,     MEM,  usage,     "usage",     U8,  "%",   HIST("mem_usage", 1),         UI_INT)  \
+  X(MEM_USED,      MEM,  used,      "used",      F32, "GB",  HIST("mem_used_cgb", 100),    UI_NONE) \
+  X(MEM_TOTAL,     MEM,  total,     "total",     F32, "GB",  NO_HIST,                      UI_NONE) \
+  X(MEM_AVAIL,     MEM,  avail,     "avail",     F32, "GB",  NO_HIST,                      UI_NONE)
+
+#define TELEMETRY_SCHEMA_ADDED(X) \
+  X(CPU_CORES,     CPU,  cores,     "cores",     U8_LIST, "%", NO_HIST,                    UI_LIST)
+// clang-format on
+
+#define TELEMETRY_SCHEMA(X)                                                                                    \
+  TELEMETRY_SCHEMA_ROOT(X) TELEMETRY_SCHEMA_CPU(X) TELEMETRY_SCHEMA_GPU(X) TELEMETRY_SCHEMA_MEM(X)             \
+  TELEMETRY_SCHEMA_ADDED(X)
+
+/** Sections as X(SECTION, "json_key"), ROOT is the top-level object */
+#define TELEMETRY_SECTIONS(X) X(ROOT, "") X(CPU, "cpu") X(GPU, "gpu") X(MEM, "mem")
+
+// =======================================================================
+// TYPE TRAITS
+// =======================================================================
+
+#define TELEMETRY_CTYPE_U8 uint8_t
+#define TELEMETRY_CTYPE_U16 uint16_t
+#define TELEMETRY_CTYPE_U32 uint32_t
+#define TELEMETRY_CTYPE_U64 uint64_t
+#define TELEMETRY_CTYPE_F32 float
+#define TELEMETRY_CTYPE_STR char
+#define TELEMETRY_CTYPE_U8_LIST telemetry_u8_list_t
+
+#define TELEMETRY_EXTENT_U8
+#define TELEMETRY_EXTENT_U16
+#define TELEMETRY_EXTENT_U32
+#define TELEMETRY_EXTENT_U64
+#define TELEMETRY_EXTENT_F32
+#define TELEMETRY_EXTENT_STR [TELEMETRY_STRING_LEN]
+#define TELEMETRY_EXTENT_U8_LIST
+
+/** Largest encoding of a field in a binary frame, a string or list is a count byte plus its bytes */
+#define TELEMETRY_WIRE_SIZE_U8 1
+#define TELEMETRY_WIRE_SIZE_U16 2
+#define TELEMETRY_WIRE_SIZE_U32 4
+#define TELEMETRY_WIRE_SIZE_U64 8
+#define TELEMETRY_WIRE_SIZE_F32 4
+#define TELEMETRY_WIRE_SIZE_STR (1 + TELEMETRY_STRING_LEN - 1)
+#define TELEMETRY_WIRE_SIZE_U8_LIST (1 + TELEMETRY_LIST_MAX)
+
+/** Member path of a field inside system_data_t */
+#define TELEMETRY_PATH_ROOT(field) field
+#define TELEMETRY_PATH_CPU(field) cpu.field
+#define TELEMETRY_PATH_GPU(field) gpu.field
+#define TELEMETRY_PATH_MEM(field) mem.field
+#define TELEMETRY_MEMBER(data, SECTION, field) ((data)->TELEMETRY_PATH_##SECTION(field))
+
+#define TELEMETRY_IF_SECTION_ROOT_ROOT TELEMETRY_KEEP
+#define TELEMETRY_IF_SECTION_ROOT_CPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_ROOT_GPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_ROOT_MEM TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_CPU_ROOT TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_CPU_CPU TELEMETRY_KEEP
+#define TELEMETRY_IF_SECTION_CPU_GPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_CPU_MEM TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_GPU_ROOT TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_GPU_CPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_GPU_GPU TELEMETRY_KEEP
+#define TELEMETRY_IF_SECTION_GPU_MEM TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_MEM_ROOT TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_MEM_CPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_MEM_GPU TELEMETRY_DROP
+#define TELEMETRY_IF_SECTION_MEM_MEM TELEMETRY_KEEP
+
+/** Expands to its arguments for entries of section WANT */
+#define TELEMETRY_IF_SECTION(SECTION, WANT, ...) TELEMETRY_IF_SECTION_##SECTION##_##WANT(__VA_ARGS__)
+
+// =======================================================================
+// COLUMN SELECTORS
+// =======================================================================
+
+// TELEMETRY_KEEP(...) passes its arguments through, TELEMETRY_DROP(...) swallows them
+#define TELEMETRY_KEEP(...) __VA_ARGS__
+#define TELEMETRY_DROP(...)
+
+#define TELEMETRY_IF_HIST_HIST(name, scale) TELEMETRY_KEEP
+#define TELEMETRY_IF_HIST_NO_HIST TELEMETRY_DROP
+#define TELEMETRY_HIST_NAME_HIST(name, scale) name
+#define TELEMETRY_HIST_SCALE_HIST(name, scale) scale
+
+/** Expands to its arguments for entries that are recorded in the history */
+#define TELEMETRY_IF_HIST(history, ...) TELEMETRY_IF_HIST_##history(__VA_ARGS__)
+#define TELEMETRY_HIST_NAME(history) TELEMETRY_HIST_NAME_##history
+#define TELEMETRY_HIST_SCALE(history) TELEMETRY_HIST_SCALE_##history
+
+#define TELEMETRY_IF_UI_UI_INT TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_UI_TEXT TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_UI_LIST TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_UI_NONE TELEMETRY_DROP
+#define TELEMETRY_IF_UI_INT_UI_INT TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_INT_UI_TEXT TELEMETRY_DROP
+#define TELEMETRY_IF_UI_INT_UI_LIST TELEMETRY_DROP
+#define TELEMETRY_IF_UI_INT_UI_NONE TELEMETRY_DROP
+#define TELEMETRY_IF_UI_TEXT_UI_INT TELEMETRY_DROP
+#define TELEMETRY_IF_UI_TEXT_UI_TEXT TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_TEXT_UI_LIST TELEMETRY_DROP
+#define TELEMETRY_IF_UI_TEXT_UI_NONE TELEMETRY_DROP
+#define TELEMETRY_IF_UI_LIST_UI_INT TELEMETRY_DROP
+#define TELEMETRY_IF_UI_LIST_UI_TEXT TELEMETRY_DROP
+#define TELEMETRY_IF_UI_LIST_UI_LIST TELEMETRY_KEEP
+#define TELEMETRY_IF_UI_LIST_UI_NONE TELEMETRY_DROP
+
+/** Expand to their arguments for entries with a dashboard subject, of any or of one kind */
+#define TELEMETRY_IF_UI(ui, ...) TELEMETRY_IF_UI_##ui(__VA_ARGS__)
+#define TELEMETRY_IF_UI_INT(ui, ...) TELEMETRY_IF_UI_INT_##ui(__VA_ARGS__)
+#define TELEMETRY_IF_UI_TEXT(ui, ...) TELEMETRY_IF_UI_TEXT_##ui(__VA_ARGS__)
+#define TELEMETRY_IF_UI_LIST(ui, ...) TELEMETRY_IF_UI_LIST_##ui(__VA_ARGS__)
+
+#define TELEMETRY_IF_STR_U8 TELEMETRY_DROP
+#define TELEMETRY_IF_STR_U16 TELEMETRY_DROP
+#define TELEMETRY_IF_STR_U32 TELEMETRY_DROP
+#define TELEMETRY_IF_STR_U64 TELEMETRY_DROP
+#define TELEMETRY_IF_STR_F32 TELEMETRY_DROP
+#define TELEMETRY_IF_STR_STR TELEMETRY_KEEP
+#define TELEMETRY_IF_STR_U8_LIST TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_U8 TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_U16 TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_U32 TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_U64 TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_F32 TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_STR TELEMETRY_DROP
+#define TELEMETRY_IF_LIST_U8_LIST TELEMETRY_KEEP
+
+/** Expand to their arguments for string or for list entries */
+#define TELEMETRY_IF_STR(TYPE, ...) TELEMETRY_IF_STR_##TYPE(__VA_ARGS__)
+#define TELEMETRY_IF_LIST(TYPE, ...) TELEMETRY_IF_LIST_##TYPE(__VA_ARGS__)
+
+#endif // TELEMETRY_SCHEMA_H
@@ -0,0 +1,373 @@
+/**
+ * @file gt911_config.c
+ * @brief GT911 config profile: report rate, thresholds and noise reduction
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "gt911_config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "gt911_touch.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+#define PROFILE_NVS_NAMESPACE "gt911"
+#define PROFILE_NVS_KEY "profiles"
+#define PROFILE_BLOB_VERSION 1
+
+// Profiles set while tuning within this window are stored once
+#define PROFILE_SAVE_DELAY_MS 2000
+
+#define LOW_NIBBLE 0x0F
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/**
+ * @brief Settings of one panel
+ */
+typedef struct
+{
+  char product_id[4]; // "911", not terminated
+  uint16_t x_max;     // Resolution in the panel's config
+  uint16_t y_max;
+  gt911_config_settings_t settings;
+  gt911_config_settings_t original; // Values before the first profile, for TOUCH_CONFIG_RESET
+} profile_t;
+
+typedef struct
+{
+  uint32_t version;
+  uint32_t count;
+  profile_t profiles[GT911_CONFIG_MAX_PROFILES];
+} profile_blob_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Serializes the read/modify/write of the config block and of the profile blob
+static SemaphoreHandle_t config_mutex = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void settings_from_config(const uint8_t *config, gt911_config_settings_t *settings)
+{
+  settings->report_ms = GT911_REPORT_MS_MIN + (config[GT911_CFG_REFRESH_RATE] & LOW_NIBBLE);
+  settings->touch_level = config[GT911_CFG_TOUCH_LEVEL];
+  settings->leave_level = config[GT911_CFG_LEAVE_LEVEL];
+  settings->noise_reduction = config[GT911_CFG_NOISE_REDUCTION] & LOW_NIBBLE;
+}
+
+static void settings_to_config(const gt911_config_settings_t *settings, uint8_t *config)
+{
+  // Reserved high bits stay as the panel maker set them
+  config[GT911_CFG_REFRESH_RATE] =
+      (config[GT911_CFG_REFRESH_RATE] & ~LOW_NIBBLE) | (uint8_t)(settings->report_ms - GT911_REPORT_MS_MIN);
+  config[GT911_CFG_TOUCH_LEVEL] = settings->touch_level;
+  config[GT911_CFG_LEAVE_LEVEL] = settings->leave_level;
+  config[GT911_CFG_NOISE_REDUCTION] =
+      (config[GT911_CFG_NOISE_REDUCTION] & ~LOW_NIBBLE) | settings->noise_reduction;
+}
+
+static bool settings_equal(const gt911_config_settings_t *a, const gt911_config_settings_t *b)
+{
+  return a->report_ms == b->report_ms && a->touch_level == b->touch_level && a->leave_level == b->leave_level &&
+         a->noise_reduction == b->noise_reduction;
+}
+
+static bool settings_valid(const gt911_config_settings_t *settings)
+{
+  return settings->report_ms >= GT911_REPORT_MS_MIN && settings->report_ms <= GT911_REPORT_MS_MAX &&
+         settings->leave_level > 0 && settings->touch_level > settings->leave_level &&
+         settings->noise_reduction <= GT911_NOISE_REDUCTION_MAX;
+}
+
+/**
+ * @brief Read the config block and the identity of the attached panel
+ */
+static esp_err_t read_panel(uint8_t *config, profile_t *panel)
+{
+  esp_err_t err = gt911_read_config(config);
+  if (err != ESP_OK)
+    return err;
+
+  char product_id[5];
+  err = gt911_get_product_id(product_id);
+  if (err != ESP_OK)
+    return err;
+
+  memset(panel, 0, sizeof(*panel));
+  memcpy(panel->product_id, product_id, sizeof(panel->product_id));
+  panel->x_max = config[GT911_CFG_X_MAX] | (config[GT911_CFG_X_MAX + 1] << 8);
+  panel->y_max = config[GT911_CFG_Y_MAX] | (config[GT911_CFG_Y_MAX + 1] << 8);
+  settings_from_config(config, &panel->settings);
+  return ESP_OK;
+}
+
+static void load_profiles(profile_blob_t *blob)
+{
+  size_t size = sizeof(*blob);
+  if (nvs_store_get(PROFILE_NVS_NAMESPACE, PROFILE_NVS_KEY, blob, &size) == ESP_OK && size == sizeof(*blob) &&
+      blob->version == PROFILE_BLOB_VERSION && blob->count <= GT911_CONFIG_MAX_PROFILES)
+    return;
+
+  memset(blob, 0, sizeof(*blob));
+  blob->version = PROFILE_BLOB_VERSION;
+}
+
+static esp_err_t save_profiles(const profile_blob_t *blob)
+{
+  if (blob->count == 0)
+    return nvs_store_erase(PROFILE_NVS_NAMESPACE, PROFILE_NVS_KEY, PROFILE_SAVE_DELAY_MS);
+  return nvs_store_set(PROFILE_NVS_NAMESPACE, PROFILE_NVS_KEY, blob, sizeof(*blob), PROFILE_SAVE_DELAY_MS);
+}
+
+static int find_profile(const profile_blob_t *blob, const profile_t *panel)
+{
+  for (uint32_t i = 0; i < blob->count; i++)
+  {
+    const profile_t *profile = &blob->profiles[i];
+    if (memcmp(profile->product_id, panel->product_id, sizeof(profile->product_id)) == 0 &&
+        profile->x_max == panel->x_max && profile->y_max == panel->y_max)
+      return (int)i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Write settings into the block, only if the controller holds other values
+ */
+static esp_err_t apply_settings(uint8_t *config, const profile_t *panel, const gt911_config_settings_t *settings)
+{
+  if (settings_equal(&panel->settings, settings))
+    return ESP_OK;
+
+  settings_to_config(settings, config);
+  return gt911_write_config(config);
+}
+
+static void reply_settings(const gt911_config_settings_t *settings, bool stored)
+{
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf),
+                     "TOUCH_CONFIG {\"report_ms\":%u,\"report_hz\":%u,\"touch_level\":%u,\"leave_level\":%u,"
+                     "\"noise_reduction\":%u,\"stored\":%s}\n",
+                     settings->report_ms, 1000u / settings->report_ms, settings->touch_level, settings->leave_level,
+                     settings->noise_reduction, stored ? "true" : "false");
+  serial_data_write(buf, len);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[112];
+  int len = snprintf(buf, sizeof(buf), "TOUCH_CONFIG {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+static const char *error_message(esp_err_t err)
+{
+  switch (err)
+  {
+  case ESP_ERR_INVALID_CRC:
+    return "controller config checksum mismatch";
+  case ESP_ERR_INVALID_ARG:
+    return "report_ms 5..20, leave_level 1..touch_level-1, noise_reduction 0..15";
+  case ESP_ERR_NO_MEM:
+    return "profile table full";
+  case ESP_ERR_NOT_FOUND:
+    return "no profile for this panel";
+  default:
+    return esp_err_to_name(err);
+  }
+}
+
+/**
+ * @brief Restore the panel's values from before its profile and drop the profile
+ */
+static esp_err_t reset_profile(gt911_config_settings_t *settings)
+{
+  xSemaphoreTake(config_mutex, portMAX_DELAY);
+  uint8_t config[GT911_CONFIG_SIZE];
+  profile_t panel;
+  profile_blob_t blob;
+  esp_err_t err = read_panel(config, &panel);
+  int index = -1;
+  if (err == ESP_OK)
+  {
+    load_profiles(&blob);
+    index = find_profile(&blob, &panel);
+    err = index < 0 ? ESP_ERR_NOT_FOUND : ESP_OK;
+  }
+  if (err == ESP_OK)
+  {
+    *settings = blob.profiles[index].original;
+    err = apply_settings(config, &panel, settings);
+  }
+  if (err == ESP_OK)
+  {
+    blob.count--;
+    memmove(&blob.profiles[index], &blob.profiles[index + 1], (blob.count - index) * sizeof(profile_t));
+    err = save_profiles(&blob);
+  }
+  xSemaphoreGive(config_mutex);
+  return err;
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void gt911_config_init(void)
+{
+  if (!config_mutex)
+    config_mutex = xSemaphoreCreateMutex();
+  if (!config_mutex)
+    return;
+
+#if CONFIG_GT911_CONFIG_PROFILE
+  xSemaphoreTake(config_mutex, portMAX_DELAY);
+  uint8_t config[GT911_CONFIG_SIZE];
+  profile_t panel;
+  esp_err_t err = read_panel(config, &panel);
+  if (err == ESP_OK)
+  {
+    profile_blob_t blob;
+    load_profiles(&blob);
+    int index = find_profile(&blob, &panel);
+    if (index >= 0 && !settings_equal(&panel.settings, &blob.profiles[index].settings))
+    {
+      err = apply_settings(config, &panel, &blob.profiles[index].settings);
+      if (err == ESP_OK)
+        debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "Touch config profile applied, report period %u ms",
+                         blob.profiles[index].settings.report_ms);
+    }
+  }
+  if (err != ESP_OK)
+    debug_log_warning_f(DEBUG_TAG_GT911_TOUCH, "Touch config profile not applied: %s", esp_err_to_name(err));
+  xSemaphoreGive(config_mutex);
+#endif
+}
+
+esp_err_t gt911_config_get(gt911_config_settings_t *settings)
+{
+  uint8_t config[GT911_CONFIG_SIZE];
+  esp_err_t err = gt911_read_config(config);
+  if (err == ESP_OK)
+    settings_from_config(config, settings);
+  return err;
+}
+
+esp_err_t gt911_config_set(const gt911_config_settings_t *settings)
+{
+  if (!settings_valid(settings))
+    return ESP_ERR_INVALID_ARG;
+  if (!config_mutex)
+    return ESP_ERR_INVALID_STATE;
+
+  xSemaphoreTake(config_mutex, portMAX_DELAY);
+  uint8_t config[GT911_CONFIG_SIZE];
+  profile_t panel;
+  profile_blob_t blob;
+  esp_err_t err = read_panel(config, &panel);
+  int index = -1;
+  if (err == ESP_OK)
+  {
+    load_profiles(&blob);
+    index = find_profile(&blob, &panel);
+    if (index < 0 && blob.count == GT911_CONFIG_MAX_PROFILES)
+      err = ESP_ERR_NO_MEM;
+  }
+  if (err == ESP_OK)
+    err = apply_settings(config, &panel, settings);
+  if (err == ESP_OK && (index < 0 || !settings_equal(&blob.profiles[index].settings, settings)))
+  {
+    if (index < 0)
+    {
+      // A new panel: what it holds now is what TOUCH_CONFIG_RESET goes back to
+      index = (int)blob.count++;
+      blob.profiles[index] = panel;
+      blob.profiles[index].original = panel.settings;
+    }
+    blob.profiles[index].settings = *settings;
+    err = save_profiles(&blob);
+  }
+  xSemaphoreGive(config_mutex);
+  return err;
+}
+
+bool gt911_config_handle_command(const char *line)
+{
+  static const char set_command[] = "TOUCH_CONFIG_SET ";
+  bool show = strcmp(line, "TOUCH_CONFIG") == 0;
+  bool reset = strcmp(line, "TOUCH_CONFIG_RESET") == 0;
+  bool set = strncmp(line, set_command, sizeof(set_command) - 1) == 0;
+  if (!show && !reset && !set)
+    return false;
+
+  if (!config_mutex)
+  {
+    reply_error("touch not initialized");
+    return true;
+  }
+
+  gt911_config_settings_t settings;
+  bool stored = set;
+  esp_err_t err;
+  if (set)
+  {
+    // TOUCH_CONFIG_SET <report_ms> <touch_level> <leave_level> <noise_reduction>
+    unsigned int values[4];
+    if (sscanf(line + sizeof(set_command) - 1, "%u %u %u %u", &values[0], &values[1], &values[2], &values[3]) != 4 ||
+        values[0] > UINT8_MAX || values[1] > UINT8_MAX || values[2] > UINT8_MAX || values[3] > UINT8_MAX)
+    {
+      reply_error("usage: TOUCH_CONFIG_SET <report_ms> <touch_level> <leave_level> <noise_reduction>");
+      return true;
+    }
+    settings.report_ms = (uint8_t)values[0];
+    settings.touch_level = (uint8_t)values[1];
+    settings.leave_level = (uint8_t)values[2];
+    settings.noise_reduction = (uint8_t)values[3];
+    err = gt911_config_set(&settings);
+  }
+  else if (reset)
+  {
+    err = reset_profile(&settings);
+  }
+  else
+  {
+    uint8_t config[GT911_CONFIG_SIZE];
+    profile_t panel;
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    err = read_panel(config, &panel);
+    if (err == ESP_OK)
+    {
+      profile_blob_t blob;
+      load_profiles(&blob);
+      stored = find_profile(&blob, &panel) >= 0;
+      settings = panel.settings;
+    }
+    xSemaphoreGive(config_mutex);
+  }
+  if (err != ESP_OK)
+  {
+    reply_error(error_message(err));
+    return true;
+  }
+
+  reply_settings(&settings, stored);
+  return true;
+}
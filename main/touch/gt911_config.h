@@ -0,0 +1,105 @@
+/**
+ * @file gt911_config.h
+ * @brief GT911 config profile: report rate, thresholds and noise reduction
+ *
+ * The GT911 keeps a 184 byte config block at 0x8047 that the panel maker
+ * wrote, usually with a 10 ms report period and thresholds tuned for a bare
+ * panel. This module changes four of its fields by read/modify/write, so
+ * every other byte stays as the maker tuned it:
+ *
+ *   report_ms        0x8056 bits 3:0, report period 5 + N ms (5 ms = 200 Hz)
+ *   touch_level      0x8053, signal a finger must exceed to count as down
+ *   leave_level      0x8054, signal below which it counts as lifted
+ *   noise_reduction  0x8052 bits 3:0, white noise reduction 0..15
+ *
+ * A profile is stored in NVS per board, keyed by the controller's product
+ * ID and the resolution in its config, so one image carries the settings of
+ * several panels. At boot the profile of the attached panel is written if
+ * the controller holds anything else; the controller keeps the block in its
+ * own flash, so an unchanged config costs no write. The values the panel
+ * had before its first profile are kept for TOUCH_CONFIG_RESET.
+ *
+ * A faster report rate only reaches LVGL with the INT line or a poll period
+ * (GT911_POLL_PERIOD_MS) at least as short.
+ *
+ * Serial commands:
+ *   TOUCH_CONFIG                       controller values and the stored profile
+ *   TOUCH_CONFIG_SET <report_ms> <touch_level> <leave_level> <noise_reduction>
+ *   TOUCH_CONFIG_RESET                 restore the panel's values, drop the profile
+ * All reply TOUCH_CONFIG {"report_ms":5,"report_hz":200,"touch_level":70,...}.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// =======================================================================
+// CONFIG BLOCK LAYOUT
+// =======================================================================
+
+// Offsets into the block read by gt911_read_config()
+#define GT911_CFG_VERSION 0x00         // Config version, a lower one is ignored by the controller
+#define GT911_CFG_X_MAX 0x01           // X resolution, little endian
+#define GT911_CFG_Y_MAX 0x03           // Y resolution, little endian
+#define GT911_CFG_NOISE_REDUCTION 0x0B // 0x8052
+#define GT911_CFG_TOUCH_LEVEL 0x0C     // 0x8053
+#define GT911_CFG_LEAVE_LEVEL 0x0D     // 0x8054
+#define GT911_CFG_REFRESH_RATE 0x0F    // 0x8056
+
+#define GT911_REPORT_MS_MIN 5  // 200 Hz
+#define GT911_REPORT_MS_MAX 20 // 50 Hz, 5 + 15
+#define GT911_NOISE_REDUCTION_MAX 15
+
+#define GT911_CONFIG_MAX_PROFILES 4 // Boards remembered in NVS
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief The config fields a profile sets
+ */
+typedef struct
+{
+  uint8_t report_ms;       // Report period, GT911_REPORT_MS_MIN..GT911_REPORT_MS_MAX
+  uint8_t touch_level;     // Press threshold, above leave_level
+  uint8_t leave_level;     // Release threshold, at least 1
+  uint8_t noise_reduction; // 0..GT911_NOISE_REDUCTION_MAX
+} gt911_config_settings_t;
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Write the stored profile of the attached panel if the controller differs
+ * @note Called by gt911_init() once the controller answers; NVS must be initialized
+ */
+void gt911_config_init(void);
+
+/**
+ * @brief Read the profile fields from the controller
+ * @param settings Receives the current values
+ * @return ESP_OK, or the error of gt911_read_config()
+ */
+esp_err_t gt911_config_get(gt911_config_settings_t *settings);
+
+/**
+ * @brief Write the profile fields to the controller and store them for this panel
+ * @param settings New values
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for values out of range, ESP_ERR_NO_MEM if
+ *         GT911_CONFIG_MAX_PROFILES other panels are stored, or the I2C or NVS error
+ */
+esp_err_t gt911_config_set(const gt911_config_settings_t *settings);
+
+/**
+ * @brief Handle TOUCH_CONFIG, TOUCH_CONFIG_SET and TOUCH_CONFIG_RESET
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a touch config command
+ */
+bool gt911_config_handle_command(const char *line);
@@ -0,0 +1,343 @@
+/**
+ * @file gt911_filter.c
+ * @brief GT911 coordinate calibration and jitter filter
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "gt911_filter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+#define CAL_NVS_NAMESPACE "gt911"
+#define CAL_NVS_KEY "cal"
+#define CAL_BLOB_VERSION 1
+
+// Matrices set while tuning within this window are stored once
+#define CAL_SAVE_DELAY_MS 2000
+
+#define MEDIAN_TAPS 3
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  uint32_t version;
+  int32_t matrix[GT911_CAL_MATRIX_SIZE];
+} cal_blob_t;
+
+/**
+ * @brief State of one finger
+ */
+typedef struct
+{
+  bool used;
+  bool seen; // Present in the current report
+  uint8_t track_id;
+  uint8_t samples; // Valid entries in the median window
+  uint8_t next;    // Next median slot to overwrite
+  int32_t window_x[MEDIAN_TAPS];
+  int32_t window_y[MEDIAN_TAPS];
+  int32_t pos_x; // Tracked position, Q8 pixels
+  int32_t pos_y;
+  int32_t vel_x; // Tracked velocity, Q8 pixels per ms
+  int32_t vel_y;
+  int64_t last_us;
+  uint16_t out_x; // Last reported coordinates
+  uint16_t out_y;
+} track_filter_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static const int32_t identity_matrix[GT911_CAL_MATRIX_SIZE] = {GT911_CAL_Q16_ONE, 0, 0, 0, GT911_CAL_Q16_ONE, 0};
+
+// Written by the serial task, read by the touch task
+static int32_t cal_matrix[GT911_CAL_MATRIX_SIZE] = {GT911_CAL_Q16_ONE, 0, 0, 0, GT911_CAL_Q16_ONE, 0};
+static bool cal_stored = false;
+static portMUX_TYPE cal_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static track_filter_t tracks[GT911_MAX_TOUCH_POINTS];
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void set_matrix(const int32_t *matrix, bool stored)
+{
+  portENTER_CRITICAL(&cal_lock);
+  memcpy(cal_matrix, matrix, sizeof(cal_matrix));
+  cal_stored = stored;
+  portEXIT_CRITICAL(&cal_lock);
+}
+
+static esp_err_t save_matrix(const int32_t *matrix)
+{
+  cal_blob_t blob = {.version = CAL_BLOB_VERSION};
+  memcpy(blob.matrix, matrix, sizeof(blob.matrix));
+  return nvs_store_set(CAL_NVS_NAMESPACE, CAL_NVS_KEY, &blob, sizeof(blob), CAL_SAVE_DELAY_MS);
+}
+
+static esp_err_t erase_matrix(void)
+{
+  return nvs_store_erase(CAL_NVS_NAMESPACE, CAL_NVS_KEY, CAL_SAVE_DELAY_MS);
+}
+
+static int32_t median3(const int32_t *window)
+{
+  int32_t a = window[0], b = window[1], c = window[2];
+  if (a > b)
+  {
+    int32_t t = a;
+    a = b;
+    b = t;
+  }
+  // a <= b, the median is b clamped into [a, c]
+  if (b > c)
+    b = (a > c) ? a : c;
+  return b;
+}
+
+static int32_t clamp_coord(int32_t value, int32_t limit)
+{
+  if (value < 0)
+    return 0;
+  if (value >= limit)
+    return limit - 1;
+  return value;
+}
+
+static track_filter_t *track_for(uint8_t track_id)
+{
+  track_filter_t *free_slot = NULL;
+  for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
+  {
+    if (tracks[i].used && tracks[i].track_id == track_id)
+      return &tracks[i];
+    if (!tracks[i].used && !free_slot)
+      free_slot = &tracks[i];
+  }
+  if (free_slot)
+  {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->used = true;
+    free_slot->track_id = track_id;
+  }
+  return free_slot;
+}
+
+/**
+ * @brief Run one axis of the alpha-beta tracker
+ * @return Predicted coordinate in whole pixels
+ */
+static int32_t track_axis(int32_t *pos, int32_t *vel, int32_t measured, int32_t dt_ms)
+{
+  int32_t predicted = *pos + *vel * dt_ms;
+  int32_t residual = (measured << 8) - predicted;
+  *pos = predicted + ((GT911_FILTER_ALPHA_Q8 * residual) >> 8);
+  *vel += ((GT911_FILTER_BETA_Q8 * residual) >> 8) / dt_ms;
+  return (*pos + *vel * GT911_FILTER_LEAD_MS + 128) >> 8;
+}
+
+static uint16_t apply_deadband(uint16_t previous, int32_t value)
+{
+  return (abs(value - previous) <= GT911_FILTER_DEADBAND_PX) ? previous : (uint16_t)value;
+}
+
+static void filter_point(gt911_touch_point_t *point, int64_t now_us)
+{
+  track_filter_t *track = track_for(point->track_id);
+  if (!track)
+    return;
+  track->seen = true;
+
+  if (track->samples > 0 && now_us - track->last_us > (int64_t)GT911_FILTER_RESET_MS * 1000)
+  {
+    // Stale history would drag the new position back
+    track->samples = 0;
+    track->next = 0;
+  }
+
+  track->window_x[track->next] = point->x;
+  track->window_y[track->next] = point->y;
+  track->next = (track->next + 1) % MEDIAN_TAPS;
+  if (track->samples < MEDIAN_TAPS)
+    track->samples++;
+
+  if (track->samples == 1)
+  {
+    // Finger just landed, start the tracker where it is
+    track->pos_x = (int32_t)point->x << 8;
+    track->pos_y = (int32_t)point->y << 8;
+    track->vel_x = 0;
+    track->vel_y = 0;
+    track->out_x = point->x;
+    track->out_y = point->y;
+    track->last_us = now_us;
+    return;
+  }
+
+  int32_t median_x = point->x;
+  int32_t median_y = point->y;
+  if (track->samples == MEDIAN_TAPS)
+  {
+    median_x = median3(track->window_x);
+    median_y = median3(track->window_y);
+  }
+
+  int32_t dt_ms = (int32_t)((now_us - track->last_us) / 1000);
+  if (dt_ms < 1)
+    dt_ms = 1;
+  track->last_us = now_us;
+
+  int32_t x = clamp_coord(track_axis(&track->pos_x, &track->vel_x, median_x, dt_ms), TOUCH_SCREEN_WIDTH);
+  int32_t y = clamp_coord(track_axis(&track->pos_y, &track->vel_y, median_y, dt_ms), TOUCH_SCREEN_HEIGHT);
+  track->out_x = apply_deadband(track->out_x, x);
+  track->out_y = apply_deadband(track->out_y, y);
+
+  point->x = track->out_x;
+  point->y = track->out_y;
+}
+
+static void reply_matrix(void)
+{
+  int32_t matrix[GT911_CAL_MATRIX_SIZE];
+  portENTER_CRITICAL(&cal_lock);
+  memcpy(matrix, cal_matrix, sizeof(matrix));
+  bool stored = cal_stored;
+  portEXIT_CRITICAL(&cal_lock);
+
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf), "TOUCH_CAL {\"matrix\":[%ld,%ld,%ld,%ld,%ld,%ld],\"q\":16,\"stored\":%s}\n",
+                     (long)matrix[0], (long)matrix[1], (long)matrix[2], (long)matrix[3], (long)matrix[4],
+                     (long)matrix[5], stored ? "true" : "false");
+  serial_data_write(buf, len);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[112];
+  int len = snprintf(buf, sizeof(buf), "TOUCH_CAL {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void gt911_filter_init(void)
+{
+  gt911_filter_reset();
+
+  cal_blob_t blob;
+  size_t size = sizeof(blob);
+  if (nvs_store_get(CAL_NVS_NAMESPACE, CAL_NVS_KEY, &blob, &size) != ESP_OK)
+    return;
+
+  if (size != sizeof(blob) || blob.version != CAL_BLOB_VERSION)
+  {
+    debug_log_warning(DEBUG_TAG_GT911_TOUCH, "Stored touch calibration has an unknown layout, ignoring it");
+    return;
+  }
+
+  set_matrix(blob.matrix, true);
+  debug_log_info(DEBUG_TAG_GT911_TOUCH, "Touch calibration loaded from NVS");
+}
+
+void gt911_filter_map(uint16_t raw_x, uint16_t raw_y, int32_t *x, int32_t *y)
+{
+  int32_t m[GT911_CAL_MATRIX_SIZE];
+  portENTER_CRITICAL(&cal_lock);
+  memcpy(m, cal_matrix, sizeof(m));
+  portEXIT_CRITICAL(&cal_lock);
+
+  *x = (int32_t)(((int64_t)m[0] * raw_x + (int64_t)m[1] * raw_y + m[2]) >> 16);
+  *y = (int32_t)(((int64_t)m[3] * raw_x + (int64_t)m[4] * raw_y + m[5]) >> 16);
+}
+
+void gt911_filter_apply(gt911_touch_data_t *touch_data, int64_t now_us)
+{
+  for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
+  {
+    tracks[i].seen = false;
+  }
+
+  for (int i = 0; i < touch_data->touch_count; i++)
+  {
+    filter_point(&touch_data->points[i], now_us);
+  }
+
+  // Lifted fingers free their slot, a returning track ID starts afresh
+  for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
+  {
+    if (!tracks[i].seen)
+      tracks[i].used = false;
+  }
+}
+
+void gt911_filter_reset(void)
+{
+  memset(tracks, 0, sizeof(tracks));
+}
+
+bool gt911_filter_handle_command(const char *line)
+{
+  if (strcmp(line, "TOUCH_CAL") == 0)
+  {
+    reply_matrix();
+    return true;
+  }
+
+  if (strcmp(line, "TOUCH_CAL_RESET") == 0)
+  {
+    if (erase_matrix() != ESP_OK)
+    {
+      reply_error("nvs store full");
+      return true;
+    }
+    set_matrix(identity_matrix, false);
+    reply_matrix();
+    return true;
+  }
+
+  // TOUCH_CAL_SET <m0> <m1> <m2> <m3> <m4> <m5>, Q16 fixed point
+  static const char set_command[] = "TOUCH_CAL_SET ";
+  if (strncmp(line, set_command, sizeof(set_command) - 1) != 0)
+    return false;
+
+  long values[GT911_CAL_MATRIX_SIZE];
+  if (sscanf(line + sizeof(set_command) - 1, "%ld %ld %ld %ld %ld %ld", &values[0], &values[1], &values[2],
+             &values[3], &values[4], &values[5]) != GT911_CAL_MATRIX_SIZE)
+  {
+    reply_error("usage: TOUCH_CAL_SET <m0> <m1> <m2> <m3> <m4> <m5> (Q16)");
+    return true;
+  }
+
+  int32_t matrix[GT911_CAL_MATRIX_SIZE];
+  for (int i = 0; i < GT911_CAL_MATRIX_SIZE; i++)
+  {
+    matrix[i] = (int32_t)values[i];
+  }
+  if (save_matrix(matrix) != ESP_OK)
+  {
+    reply_error("nvs store full");
+    return true;
+  }
+  set_matrix(matrix, true);
+  reply_matrix();
+  return true;
+}
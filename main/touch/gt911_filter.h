@@ -0,0 +1,79 @@
+/**
+ * @file gt911_filter.h
+ * @brief GT911 coordinate calibration and jitter filter
+ *
+ * Raw points first go through an affine calibration matrix, which is stored
+ * in NVS and set over serial. Each finger, keyed by GT911 track ID, then gets
+ * a median of its last three samples to drop single-sample spikes. An
+ * alpha-beta tracker follows the median and reports the position slightly
+ * ahead in time, and a small deadband keeps a resting finger from producing
+ * new coordinates.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gt911_touch.h"
+
+// =======================================================================
+// FILTER CONFIGURATION
+// =======================================================================
+
+#define GT911_FILTER_ALPHA_Q8 128   // Position gain, 0.5
+#define GT911_FILTER_BETA_Q8 32     // Velocity gain, 0.125
+#define GT911_FILTER_DEADBAND_PX 1  // Output changes smaller than this are dropped
+#define GT911_FILTER_RESET_MS 100   // A gap this long restarts the tracker
+
+// How far ahead of the last sample coordinates are predicted
+#ifdef CONFIG_GT911_FILTER_LEAD_MS
+#define GT911_FILTER_LEAD_MS CONFIG_GT911_FILTER_LEAD_MS
+#else
+#define GT911_FILTER_LEAD_MS 8
+#endif
+
+// Calibration matrix: x' = (m[0]*x + m[1]*y + m[2]) >> 16, y' = (m[3]*x + m[4]*y + m[5]) >> 16
+#define GT911_CAL_Q16_ONE 65536
+#define GT911_CAL_MATRIX_SIZE 6
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Load the calibration matrix from NVS, identity if none is stored
+ * @note NVS must be initialized first
+ */
+void gt911_filter_init(void);
+
+/**
+ * @brief Apply the calibration matrix
+ * @param raw_x Raw X coordinate from GT911
+ * @param raw_y Raw Y coordinate from GT911
+ * @param x Calibrated X, not clamped to the screen
+ * @param y Calibrated Y, not clamped to the screen
+ */
+void gt911_filter_map(uint16_t raw_x, uint16_t raw_y, int32_t *x, int32_t *y);
+
+/**
+ * @brief Filter the calibrated points of one fresh report in place
+ * @param touch_data Report parsed from the controller
+ * @param now_us esp_timer time of the report
+ * @note Only call for new reports, from the task that reads the controller
+ */
+void gt911_filter_apply(gt911_touch_data_t *touch_data, int64_t now_us);
+
+/**
+ * @brief Forget all tracked fingers
+ */
+void gt911_filter_reset(void);
+
+/**
+ * @brief Handle TOUCH_CAL / TOUCH_CAL_SET / TOUCH_CAL_RESET
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a calibration command
+ */
+bool gt911_filter_handle_command(const char *line);
@@ -0,0 +1,332 @@
+/**
+ * @file gt911_gesture.c
+ * @brief Multi-touch gesture recogniser for the GT911
+ *
+ * One touch runs from the first finger down to the last finger up. A single
+ * finger that stays inside the slop circle long enough is a long press. Once
+ * a second finger lands, the pair is followed by track ID, and when either
+ * finger lifts, what the pair did is classified. If the distance between the
+ * fingers changed more than their centroid moved, it is a pinch. Otherwise
+ * enough centroid travel makes a swipe. At most one gesture is reported per
+ * touch.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "gt911_gesture.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  bool active;         // A finger is down
+  bool fired;          // This touch already produced its gesture
+  int64_t start_us;    // First finger down
+  uint8_t max_fingers; // Most fingers seen during the touch
+
+  // First finger, for the long press
+  uint8_t first_id;
+  uint16_t first_x;
+  uint16_t first_y;
+  bool moved; // Left the slop circle or was replaced
+
+  // Two-finger phase
+  bool pair_active;
+  uint8_t pair_id[2];
+  int64_t pair_start_us;
+  int64_t pair_last_us;
+  int32_t start_cx; // Centroid when the second finger landed
+  int32_t start_cy;
+  int32_t last_cx;
+  int32_t last_cy;
+  uint32_t start_dist_sq; // Squared finger distance, no square root per sample
+  uint32_t last_dist_sq;
+} gesture_state_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static gesture_state_t gesture = {0};
+static gt911_gesture_cb_t gesture_cb = NULL;
+static void *gesture_cb_ctx = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Integer square root
+ */
+static uint32_t isqrt64(uint64_t value)
+{
+  uint64_t result = 0;
+  uint64_t bit = 1ULL << 62;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+  while (bit)
+  {
+    if (value >= result + bit)
+    {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    }
+    else
+    {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)result;
+}
+
+static const gt911_touch_point_t *find_track(const gt911_touch_data_t *touch_data, uint8_t track_id)
+{
+  for (int i = 0; i < touch_data->touch_count; i++)
+  {
+    if (touch_data->points[i].track_id == track_id)
+    {
+      return &touch_data->points[i];
+    }
+  }
+  return NULL;
+}
+
+static void pair_measure(const gt911_touch_point_t *a, const gt911_touch_point_t *b, int32_t *cx, int32_t *cy,
+                         uint32_t *dist_sq)
+{
+  int32_t dx = (int32_t)b->x - a->x;
+  int32_t dy = (int32_t)b->y - a->y;
+  *cx = ((int32_t)a->x + b->x) / 2;
+  *cy = ((int32_t)a->y + b->y) / 2;
+  *dist_sq = (uint32_t)(dx * dx + dy * dy);
+}
+
+#if CONFIG_EXAMPLE_LCD_ROTATION_90 || CONFIG_EXAMPLE_LCD_ROTATION_180 || CONFIG_EXAMPLE_LCD_ROTATION_270
+/**
+ * @brief Turn an event into the rotated display's coordinates, the same mapping LVGL applies to touch
+ */
+static void rotate_event(gt911_gesture_event_t *event)
+{
+  int32_t x = event->x, y = event->y;
+  int32_t dx = event->dx, dy = event->dy;
+  int32_t vx = event->velocity_x, vy = event->velocity_y;
+#if CONFIG_EXAMPLE_LCD_ROTATION_90
+  event->x = (uint16_t)(TOUCH_SCREEN_HEIGHT - 1 - y);
+  event->y = (uint16_t)x;
+  event->dx = (int16_t)-dy;
+  event->dy = (int16_t)dx;
+  event->velocity_x = -vy;
+  event->velocity_y = vx;
+#elif CONFIG_EXAMPLE_LCD_ROTATION_180
+  event->x = (uint16_t)(TOUCH_SCREEN_WIDTH - 1 - x);
+  event->y = (uint16_t)(TOUCH_SCREEN_HEIGHT - 1 - y);
+  event->dx = (int16_t)-dx;
+  event->dy = (int16_t)-dy;
+  event->velocity_x = -vx;
+  event->velocity_y = -vy;
+#else
+  event->x = (uint16_t)y;
+  event->y = (uint16_t)(TOUCH_SCREEN_WIDTH - 1 - x);
+  event->dx = (int16_t)dy;
+  event->dy = (int16_t)-dx;
+  event->velocity_x = vy;
+  event->velocity_y = -vx;
+#endif
+
+  // Quarter turns keep the dominant axis test, only the direction names change
+  bool swipe = event->type >= GT911_GESTURE_SWIPE_LEFT && event->type <= GT911_GESTURE_SWIPE_DOWN;
+  if (swipe && abs(event->dx) >= abs(event->dy))
+    event->type = (event->dx > 0) ? GT911_GESTURE_SWIPE_RIGHT : GT911_GESTURE_SWIPE_LEFT;
+  else if (swipe)
+    event->type = (event->dy > 0) ? GT911_GESTURE_SWIPE_DOWN : GT911_GESTURE_SWIPE_UP;
+}
+#endif
+
+static void emit(gt911_gesture_event_t *event, int64_t now_us)
+{
+  gesture.fired = true;
+#if CONFIG_EXAMPLE_LCD_ROTATION_90 || CONFIG_EXAMPLE_LCD_ROTATION_180 || CONFIG_EXAMPLE_LCD_ROTATION_270
+  rotate_event(event);
+#endif
+  event->duration_ms = (uint32_t)((now_us - gesture.start_us) / 1000);
+
+  debug_log_debug_f(DEBUG_TAG_GT911_TOUCH, "Gesture %d at %u,%u: d=%d,%d v=%ld,%ld px/s scale=%u/256",
+                    event->type, event->x, event->y, event->dx, event->dy, (long)event->velocity_x,
+                    (long)event->velocity_y, event->scale_q8);
+
+  if (gesture_cb)
+  {
+    gesture_cb(event, gesture_cb_ctx);
+  }
+}
+
+/**
+ * @brief Classify the two-finger phase that just ended
+ */
+static void pair_finish(int64_t now_us)
+{
+  gesture.pair_active = false;
+  if (gesture.fired)
+  {
+    return;
+  }
+
+  gt911_gesture_event_t event = {
+      .type = GT911_GESTURE_NONE,
+      .x = (uint16_t)gesture.start_cx,
+      .y = (uint16_t)gesture.start_cy,
+      .dx = (int16_t)(gesture.last_cx - gesture.start_cx),
+      .dy = (int16_t)(gesture.last_cy - gesture.start_cy),
+      .scale_q8 = GT911_GESTURE_Q8_ONE,
+  };
+
+  int64_t pair_us = gesture.pair_last_us - gesture.pair_start_us;
+  if (pair_us > 0)
+  {
+    event.velocity_x = (int32_t)((int64_t)event.dx * 1000000 / pair_us);
+    event.velocity_y = (int32_t)((int64_t)event.dy * 1000000 / pair_us);
+  }
+
+  int32_t spread = 0;
+  if (gesture.start_dist_sq > 0)
+  {
+    uint32_t scale = isqrt64(((uint64_t)gesture.last_dist_sq << 16) / gesture.start_dist_sq);
+    event.scale_q8 = (scale > UINT16_MAX) ? UINT16_MAX : (uint16_t)scale;
+    spread = abs((int32_t)isqrt64(gesture.last_dist_sq) - (int32_t)isqrt64(gesture.start_dist_sq));
+  }
+
+  int32_t travel_x = abs(event.dx);
+  int32_t travel_y = abs(event.dy);
+  int32_t travel = (travel_x > travel_y) ? travel_x : travel_y;
+
+  if (abs((int32_t)event.scale_q8 - GT911_GESTURE_Q8_ONE) >= GT911_GESTURE_PINCH_MIN_Q8 && spread > travel)
+  {
+    event.type = (event.scale_q8 > GT911_GESTURE_Q8_ONE) ? GT911_GESTURE_PINCH_OUT : GT911_GESTURE_PINCH_IN;
+  }
+  else if (travel >= GT911_GESTURE_SWIPE_MIN_PX)
+  {
+    if (travel_x >= travel_y)
+      event.type = (event.dx > 0) ? GT911_GESTURE_SWIPE_RIGHT : GT911_GESTURE_SWIPE_LEFT;
+    else
+      event.type = (event.dy > 0) ? GT911_GESTURE_SWIPE_DOWN : GT911_GESTURE_SWIPE_UP;
+  }
+
+  if (event.type != GT911_GESTURE_NONE)
+  {
+    emit(&event, now_us);
+  }
+  else
+  {
+    // Two fingers that did nothing still rule out a long press
+    gesture.fired = true;
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void gt911_gesture_set_callback(gt911_gesture_cb_t callback, void *user_ctx)
+{
+  gesture_cb_ctx = user_ctx;
+  gesture_cb = callback;
+}
+
+void gt911_gesture_reset(void)
+{
+  memset(&gesture, 0, sizeof(gesture));
+}
+
+void gt911_gesture_process(const gt911_touch_data_t *touch_data, int64_t now_us)
+{
+  if (!touch_data)
+  {
+    return;
+  }
+
+  if (touch_data->touch_count == 0)
+  {
+    if (gesture.pair_active)
+    {
+      pair_finish(gesture.pair_last_us);
+    }
+    gt911_gesture_reset();
+    return;
+  }
+
+  const gt911_touch_point_t *first = &touch_data->points[0];
+  if (!gesture.active)
+  {
+    gesture.active = true;
+    gesture.start_us = now_us;
+    gesture.first_id = first->track_id;
+    gesture.first_x = first->x;
+    gesture.first_y = first->y;
+  }
+  if (touch_data->touch_count > gesture.max_fingers)
+  {
+    gesture.max_fingers = touch_data->touch_count;
+  }
+
+  // Long press: one finger, never joined by another, held inside the slop circle
+  if (gesture.max_fingers == 1 && !gesture.fired && !gesture.moved)
+  {
+    if (first->track_id != gesture.first_id || abs((int32_t)first->x - gesture.first_x) > GT911_GESTURE_SLOP_PX ||
+        abs((int32_t)first->y - gesture.first_y) > GT911_GESTURE_SLOP_PX)
+    {
+      gesture.moved = true;
+    }
+    else if (now_us - gesture.start_us >= (int64_t)GT911_GESTURE_LONG_PRESS_MS * 1000)
+    {
+      gt911_gesture_event_t event = {
+          .type = GT911_GESTURE_LONG_PRESS,
+          .x = gesture.first_x,
+          .y = gesture.first_y,
+          .scale_q8 = GT911_GESTURE_Q8_ONE,
+      };
+      emit(&event, now_us);
+    }
+  }
+
+  if (gesture.pair_active)
+  {
+    const gt911_touch_point_t *a = find_track(touch_data, gesture.pair_id[0]);
+    const gt911_touch_point_t *b = find_track(touch_data, gesture.pair_id[1]);
+    if (a && b)
+    {
+      pair_measure(a, b, &gesture.last_cx, &gesture.last_cy, &gesture.last_dist_sq);
+      gesture.pair_last_us = now_us;
+    }
+    else
+    {
+      // One of the pair lifted, judge what they did together
+      pair_finish(gesture.pair_last_us);
+    }
+  }
+  else if (touch_data->touch_count >= 2 && !gesture.fired)
+  {
+    const gt911_touch_point_t *a = &touch_data->points[0];
+    const gt911_touch_point_t *b = &touch_data->points[1];
+    gesture.pair_active = true;
+    gesture.pair_id[0] = a->track_id;
+    gesture.pair_id[1] = b->track_id;
+    gesture.pair_start_us = now_us;
+    gesture.pair_last_us = now_us;
+    pair_measure(a, b, &gesture.start_cx, &gesture.start_cy, &gesture.start_dist_sq);
+    gesture.last_cx = gesture.start_cx;
+    gesture.last_cy = gesture.start_cy;
+    gesture.last_dist_sq = gesture.start_dist_sq;
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file gt911_gesture.h
+ * @brief Multi-touch gesture recogniser for the GT911
+ *
+ * Follows fingers across samples by GT911 track ID and turns them into
+ * two-finger swipes, pinches and long presses. Only integer and Q8 fixed-point
+ * arithmetic is used, so it is cheap enough to run on every touch report.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "gt911_touch.h"
+
+// =======================================================================
+// GESTURE CONFIGURATION
+// =======================================================================
+
+#define GT911_GESTURE_SLOP_PX 12          // Movement still counted as holding still
+#define GT911_GESTURE_LONG_PRESS_MS 600   // Single finger held this long
+#define GT911_GESTURE_SWIPE_MIN_PX 80     // Two-finger centroid travel for a swipe
+#define GT911_GESTURE_PINCH_MIN_Q8 51     // Distance change for a pinch, 51/256 = 20 %
+#define GT911_GESTURE_Q8_ONE 256          // 1.0 in Q8
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief Recognised gesture
+ */
+typedef enum
+{
+  GT911_GESTURE_NONE = 0,
+  GT911_GESTURE_LONG_PRESS,  // One finger held still
+  GT911_GESTURE_SWIPE_LEFT,  // Two fingers moved together
+  GT911_GESTURE_SWIPE_RIGHT,
+  GT911_GESTURE_SWIPE_UP,
+  GT911_GESTURE_SWIPE_DOWN,
+  GT911_GESTURE_PINCH_IN,    // Two fingers moved towards each other
+  GT911_GESTURE_PINCH_OUT,   // Two fingers moved apart
+} gt911_gesture_type_t;
+
+/**
+ * @brief Gesture report
+ */
+typedef struct
+{
+  gt911_gesture_type_t type;
+  uint16_t x;           // Finger, or centroid of both fingers, where the gesture started
+  uint16_t y;
+  int16_t dx;           // Centroid travel in pixels
+  int16_t dy;
+  int32_t velocity_x;   // Centroid speed in pixels per second
+  int32_t velocity_y;
+  uint16_t scale_q8;    // Final over initial finger distance, 256 = unchanged
+  uint32_t duration_ms; // From the first finger down to recognition
+} gt911_gesture_event_t;
+
+/**
+ * @brief Gesture callback, runs in the task that feeds the recogniser
+ * @param event Gesture, only valid during the call
+ * @param user_ctx Pointer given to gt911_gesture_set_callback()
+ */
+typedef void (*gt911_gesture_cb_t)(const gt911_gesture_event_t *event, void *user_ctx);
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Register the gesture callback
+ * @param callback Called for every recognised gesture, NULL to stop
+ * @param user_ctx Passed back to the callback
+ */
+void gt911_gesture_set_callback(gt911_gesture_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Feed one touch sample
+ * @param touch_data Sample from gt911_read_touch()
+ * @param now_us esp_timer time of the sample
+ * @note Called by the touch driver for every read, from a single task
+ */
+void gt911_gesture_process(const gt911_touch_data_t *touch_data, int64_t now_us);
+
+/**
+ * @brief Forget any gesture in progress
+ */
+void gt911_gesture_reset(void);
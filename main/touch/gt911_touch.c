@@ -1,75 +1,124 @@
 ﻿/**
  * @file gt911_touch.c
- * @brief GT911 Capacitiv  esp_err_t ret = i2c_param_config(GT911_I2C_MASTER_NUM, &conf);
-  if (ret != ESP_OK)
-  {
-    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "I2C param config failed: %s", esp_err_to_name(ret));uch Controller Driver for ESP32-S3-8048S050
+ * @brief GT911 Capacitive Touch Controller Driver for ESP32-S3-8048S050
  *
  * This driver provides complete GT911 touch controller support including:
- * - I2C communication and initialization
+ * - I2C communication over the i2c_master bus/device driver
  * - Multi-touch point reading (up to 5 points)
  * - LVGL integration with input device callback
- * - Touch coordinate calibration
+ * - Every sample fed to the gesture recogniser (gt911_gesture.h)
+ * - Touch coordinate calibration and jitter filtering (gt911_filter.h)
+ * - Config block read/write and the stored per-board profile (gt911_config.h)
  * - Hardware reset and configuration
  */
 
 #include "gt911_touch.h"
+#include "gt911_config.h"
+#include "gt911_filter.h"
+#include "gt911_gesture.h"
+#include "touch_feedback.h"
+#include "touch_inject.h"
 
 #include <string.h>
 #include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "system_debug_utils.h"
+#include "utils/cycle_prof.h"
+#include "utils/task_plan.h"
+#include "utils/touch_latency.h"
+#include "utils/trace_spans.h"
 
 // Static variables
 static bool gt911_initialized = false;
 static gt911_touch_data_t last_touch_data = {0};
 static uint8_t gt911_i2c_addr = GT911_I2C_ADDR_1; // Default address
+static i2c_master_bus_handle_t gt911_bus = NULL;
+static i2c_master_dev_handle_t gt911_dev = NULL;
+static gt911_interrupt_cb_t gt911_interrupt_cb = NULL;
+
+// Background mode: the touch task owns the bus, LVGL reads its latest report
+static TaskHandle_t touch_task_handle = NULL;
+static TickType_t touch_wait_ticks = portMAX_DELAY; ///< INT driven, or the poll period
+static portMUX_TYPE touch_data_lock = portMUX_INITIALIZER_UNLOCKED;
+static gt911_touch_data_t reported_touch_data = {0};
+static volatile int64_t int_edge_us = 0; ///< Last INT pulse, the touch time for the latency probe
+
+CYCLE_PROF_SITE(gt911_parse_touch_data);
 
 // =======================================================================
 // PRIVATE FUNCTION PROTOTYPES
 // =======================================================================
 
 static esp_err_t gt911_i2c_init(void);
+static esp_err_t gt911_i2c_attach(uint8_t addr);
 static esp_err_t gt911_i2c_write_reg(uint16_t reg_addr, uint8_t *data, size_t len);
 static esp_err_t gt911_i2c_read_reg(uint16_t reg_addr, uint8_t *data, size_t len);
 static esp_err_t gt911_hardware_reset(void);
 static esp_err_t gt911_detect_i2c_address(void);
+static uint8_t gt911_config_checksum(const uint8_t *config);
 static void gt911_parse_touch_data(uint8_t *raw_data, gt911_touch_data_t *touch_data);
+static void gt911_touch_task(void *arg);
+static esp_err_t gt911_start_touch_task(gt911_interrupt_cb_t callback, TickType_t wait_ticks);
 
 // =======================================================================
 // I2C COMMUNICATION FUNCTIONS
 // =======================================================================
 
 /**
- * @brief Initialize I2C for GT911 communication
+ * @brief Create the I2C master bus for GT911 communication
  */
 static esp_err_t gt911_i2c_init(void)
 {
-  i2c_config_t conf = {
-      .mode = I2C_MODE_MASTER,
+  i2c_master_bus_config_t bus_config = {
+      .i2c_port = GT911_I2C_NUM,
       .sda_io_num = GT911_SDA_GPIO,
       .scl_io_num = GT911_SCL_GPIO,
-      .sda_pullup_en = GPIO_PULLUP_ENABLE,
-      .scl_pullup_en = GPIO_PULLUP_ENABLE,
-      .master.clk_speed = GT911_I2C_FREQ_HZ,
+      .clk_source = I2C_CLK_SRC_DEFAULT,
+      .glitch_ignore_cnt = 7,
+      .flags.enable_internal_pullup = true,
   };
 
-  esp_err_t ret = i2c_param_config(GT911_I2C_NUM, &conf);
+  esp_err_t ret = i2c_new_master_bus(&bus_config, &gt911_bus);
   if (ret != ESP_OK)
   {
-    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "I2C param config failed: %s", esp_err_to_name(ret));
+    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "I2C bus creation failed: %s", esp_err_to_name(ret));
+    gt911_bus = NULL;
     return ret;
   }
 
-  ret = i2c_driver_install(GT911_I2C_NUM, conf.mode, 0, 0, 0);
+  debug_log_info(DEBUG_TAG_GT911_TOUCH, "I2C initialized successfully");
+  return ESP_OK;
+}
+
+/**
+ * @brief Bind the GT911 device handle to an address
+ */
+static esp_err_t gt911_i2c_attach(uint8_t addr)
+{
+  if (gt911_dev)
+  {
+    i2c_master_bus_rm_device(gt911_dev);
+    gt911_dev = NULL;
+  }
+
+  i2c_device_config_t dev_config = {
+      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+      .device_address = addr,
+      .scl_speed_hz = GT911_I2C_FREQ_HZ,
+  };
+
+  esp_err_t ret = i2c_master_bus_add_device(gt911_bus, &dev_config, &gt911_dev);
   if (ret != ESP_OK)
   {
-    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "I2C driver install failed: %s", esp_err_to_name(ret));
+    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "I2C device add failed: %s", esp_err_to_name(ret));
+    gt911_dev = NULL;
     return ret;
   }
 
-  debug_log_info(DEBUG_TAG_GT911_TOUCH, "I2C initialized successfully");
+  gt911_i2c_addr = addr;
   return ESP_OK;
 }
 
@@ -78,21 +127,20 @@ static esp_err_t gt911_i2c_init(void)
  */
 static esp_err_t gt911_i2c_write_reg(uint16_t reg_addr, uint8_t *data, size_t len)
 {
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-  i2c_master_start(cmd);
-  i2c_master_write_byte(cmd, (gt911_i2c_addr << 1) | I2C_MASTER_WRITE, true);
-  i2c_master_write_byte(cmd, (reg_addr >> 8) & 0xFF, true); // Register address high byte
-  i2c_master_write_byte(cmd, reg_addr & 0xFF, true);        // Register address low byte
-
-  if (data && len > 0)
+  if ((len > 0 && !data) || len > GT911_I2C_MAX_WRITE_LEN)
   {
-    i2c_master_write(cmd, data, len, true);
+    return ESP_ERR_INVALID_ARG;
   }
 
-  i2c_master_stop(cmd);
-  esp_err_t ret = i2c_master_cmd_begin(GT911_I2C_NUM, cmd, pdMS_TO_TICKS(GT911_I2C_TIMEOUT_MS));
-  i2c_cmd_link_delete(cmd);
+  uint8_t buffer[2 + GT911_I2C_MAX_WRITE_LEN];
+  buffer[0] = (reg_addr >> 8) & 0xFF; // Register address high byte
+  buffer[1] = reg_addr & 0xFF;        // Register address low byte
+  if (len > 0)
+  {
+    memcpy(&buffer[2], data, len);
+  }
 
+  esp_err_t ret = i2c_master_transmit(gt911_dev, buffer, 2 + len, GT911_I2C_TIMEOUT_MS);
   if (ret != ESP_OK)
   {
     debug_log_warning_f(DEBUG_TAG_GT911_TOUCH, "I2C write failed: %s", esp_err_to_name(ret));
@@ -102,7 +150,7 @@ static esp_err_t gt911_i2c_write_reg(uint16_t reg_addr, uint8_t *data, size_t le
 }
 
 /**
- * @brief Read data from GT911 register
+ * @brief Read data from GT911 register in one repeated-start transaction
  */
 static esp_err_t gt911_i2c_read_reg(uint16_t reg_addr, uint8_t *data, size_t len)
 {
@@ -111,25 +159,8 @@ static esp_err_t gt911_i2c_read_reg(uint16_t reg_addr, uint8_t *data, size_t len
     return ESP_ERR_INVALID_ARG;
   }
 
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-  i2c_master_start(cmd);
-  i2c_master_write_byte(cmd, (gt911_i2c_addr << 1) | I2C_MASTER_WRITE, true);
-  i2c_master_write_byte(cmd, (reg_addr >> 8) & 0xFF, true); // Register address high byte
-  i2c_master_write_byte(cmd, reg_addr & 0xFF, true);        // Register address low byte
-
-  i2c_master_start(cmd); // Repeated start
-  i2c_master_write_byte(cmd, (gt911_i2c_addr << 1) | I2C_MASTER_READ, true);
-
-  if (len > 1)
-  {
-    i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK);
-  }
-  i2c_master_read_byte(cmd, &data[len - 1], I2C_MASTER_NACK);
-
-  i2c_master_stop(cmd);
-  esp_err_t ret = i2c_master_cmd_begin(GT911_I2C_NUM, cmd, pdMS_TO_TICKS(GT911_I2C_TIMEOUT_MS));
-  i2c_cmd_link_delete(cmd);
-
+  uint8_t reg[2] = {(reg_addr >> 8) & 0xFF, reg_addr & 0xFF};
+  esp_err_t ret = i2c_master_transmit_receive(gt911_dev, reg, sizeof(reg), data, len, GT911_I2C_TIMEOUT_MS);
   if (ret != ESP_OK)
   {
     debug_log_warning_f(DEBUG_TAG_GT911_TOUCH, "I2C read failed: %s", esp_err_to_name(ret));
@@ -183,28 +214,34 @@ static esp_err_t gt911_hardware_reset(void)
  */
 static esp_err_t gt911_detect_i2c_address(void)
 {
-  uint8_t test_data;
-
-  // Try first address (0x5D - INT low during reset)
-  gt911_i2c_addr = GT911_I2C_ADDR_1;
-  if (gt911_i2c_read_reg(GT911_REG_ID, &test_data, 1) == ESP_OK)
+  // Try first address (0x5D - INT low during reset), then second (0x14 - INT high during reset)
+  const uint8_t candidates[] = {GT911_I2C_ADDR_1, GT911_I2C_ADDR_2};
+  for (size_t i = 0; i < sizeof(candidates); i++)
   {
-    debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "GT911 detected at address 0x%02X", gt911_i2c_addr);
-    return ESP_OK;
-  }
-
-  // Try second address (0x14 - INT high during reset)
-  gt911_i2c_addr = GT911_I2C_ADDR_2;
-  if (gt911_i2c_read_reg(GT911_REG_ID, &test_data, 1) == ESP_OK)
-  {
-    debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "GT911 detected at address 0x%02X", gt911_i2c_addr);
-    return ESP_OK;
+    if (i2c_master_probe(gt911_bus, candidates[i], GT911_I2C_TIMEOUT_MS) == ESP_OK)
+    {
+      debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "GT911 detected at address 0x%02X", candidates[i]);
+      return gt911_i2c_attach(candidates[i]);
+    }
   }
 
   debug_log_error(DEBUG_TAG_GT911_TOUCH, "GT911 not found at any address");
   return ESP_FAIL;
 }
 
+/**
+ * @brief Checksum of a config block, the byte sum of block and checksum is 0
+ */
+static uint8_t gt911_config_checksum(const uint8_t *config)
+{
+  uint8_t sum = 0;
+  for (size_t i = 0; i < GT911_CONFIG_SIZE; i++)
+  {
+    sum += config[i];
+  }
+  return (uint8_t)(~sum + 1);
+}
+
 // =======================================================================
 // TOUCH DATA PROCESSING
 // =======================================================================
@@ -214,6 +251,8 @@ static esp_err_t gt911_detect_i2c_address(void)
  */
 static void gt911_parse_touch_data(uint8_t *raw_data, gt911_touch_data_t *touch_data)
 {
+  CYCLE_PROF_BEGIN(gt911_parse_touch_data);
+
   // Clear previous data
   memset(touch_data, 0, sizeof(gt911_touch_data_t));
 
@@ -228,7 +267,7 @@ static void gt911_parse_touch_data(uint8_t *raw_data, gt911_touch_data_t *touch_
   // Parse individual touch points
   for (int i = 0; i < touch_data->touch_count; i++)
   {
-    uint8_t *point_data = &raw_data[1 + i * 8]; // Each point is 8 bytes
+    uint8_t *point_data = &raw_data[1 + i * GT911_POINT_SIZE];
 
     touch_data->points[i].track_id = point_data[0];
     touch_data->points[i].x = ((uint16_t)point_data[2] << 8) | point_data[1];
@@ -241,7 +280,12 @@ static void gt911_parse_touch_data(uint8_t *raw_data, gt911_touch_data_t *touch_
                            &touch_data->points[i].x, &touch_data->points[i].y);
   }
 
+#if CONFIG_GT911_TOUCH_FILTER
+  gt911_filter_apply(touch_data, esp_timer_get_time());
+#endif
+
   touch_data->data_ready = (touch_data->touch_count > 0);
+  CYCLE_PROF_END(gt911_parse_touch_data);
 }
 
 // =======================================================================
@@ -252,12 +296,15 @@ esp_err_t gt911_init(void)
 {
   if (gt911_initialized)
   {
-    debug_log_warning(DEBUG_TAG_GT911_TOUCH, "GT911 already initialized");
+    debug_log_debug(DEBUG_TAG_GT911_TOUCH, "GT911 already initialized");
     return ESP_OK;
   }
 
   debug_log_info(DEBUG_TAG_GT911_TOUCH, "Initializing GT911 touch controller...");
 
+  // Calibration matrix from NVS, identity until one is set
+  gt911_filter_init();
+
   // Initialize I2C
   esp_err_t ret = gt911_i2c_init();
   if (ret != ESP_OK)
@@ -267,15 +314,15 @@ esp_err_t gt911_init(void)
 
   // Perform hardware reset
   ret = gt911_hardware_reset();
-  if (ret != ESP_OK)
+  if (ret == ESP_OK)
   {
-    return ret;
+    // Detect I2C address
+    ret = gt911_detect_i2c_address();
   }
-
-  // Detect I2C address
-  ret = gt911_detect_i2c_address();
   if (ret != ESP_OK)
   {
+    i2c_del_master_bus(gt911_bus);
+    gt911_bus = NULL;
     return ret;
   }
 
@@ -291,6 +338,10 @@ esp_err_t gt911_init(void)
   gt911_i2c_write_reg(GT911_REG_STATUS, &clear_cmd, 1);
 
   gt911_initialized = true;
+
+  // Apply the stored profile of this panel, if it differs from the controller's config
+  gt911_config_init();
+
   debug_log_info(DEBUG_TAG_GT911_TOUCH, "GT911 initialization completed successfully");
 
   return ESP_OK;
@@ -303,28 +354,51 @@ esp_err_t gt911_deinit(void)
     return ESP_OK;
   }
 
-  i2c_driver_delete(GT911_I2C_NUM);
+  if (gt911_interrupt_cb)
+  {
+    gpio_isr_handler_remove(GT911_INT_GPIO);
+    gt911_interrupt_cb = NULL;
+  }
+  if (touch_task_handle)
+  {
+    vTaskDelete(touch_task_handle);
+    touch_task_handle = NULL;
+  }
+
+  if (gt911_dev)
+  {
+    i2c_master_bus_rm_device(gt911_dev);
+    gt911_dev = NULL;
+  }
+  if (gt911_bus)
+  {
+    i2c_del_master_bus(gt911_bus);
+    gt911_bus = NULL;
+  }
   gt911_initialized = false;
 
   debug_log_info(DEBUG_TAG_GT911_TOUCH, "GT911 deinitialized");
   return ESP_OK;
 }
 
-esp_err_t gt911_read_touch(gt911_touch_data_t *touch_data)
+static esp_err_t read_touch_report(gt911_touch_data_t *touch_data)
 {
   if (!gt911_initialized || !touch_data)
   {
     return ESP_ERR_INVALID_STATE;
   }
+  int64_t read_start_us = esp_timer_get_time();
 
-  uint8_t status;
-  esp_err_t ret = gt911_i2c_read_reg(GT911_REG_STATUS, &status, 1);
+  // Status and the first point in one burst; a single finger needs nothing more
+  uint8_t touch_raw_data[1 + GT911_MAX_TOUCH_POINTS * GT911_POINT_SIZE];
+  esp_err_t ret = gt911_i2c_read_reg(GT911_REG_STATUS, touch_raw_data, 1 + GT911_POINT_SIZE);
   if (ret != ESP_OK)
   {
     return ret;
   }
 
   // Check if new touch data is available
+  uint8_t status = touch_raw_data[0];
   if (!(status & 0x80))
   {
     // No new data, return previous state
@@ -332,17 +406,34 @@ esp_err_t gt911_read_touch(gt911_touch_data_t *touch_data)
     return ESP_OK;
   }
 
-  // Read touch point data (up to 5 points, 8 bytes each + 1 status byte = 41 bytes)
-  uint8_t touch_raw_data[41];
-  ret = gt911_i2c_read_reg(GT911_REG_STATUS, touch_raw_data, sizeof(touch_raw_data));
-  if (ret != ESP_OK)
+  // Further points only for multi-touch
+  uint8_t touch_count = status & 0x0F;
+  if (touch_count > GT911_MAX_TOUCH_POINTS)
   {
-    return ret;
+    touch_count = GT911_MAX_TOUCH_POINTS;
+  }
+  if (touch_count > 1)
+  {
+    ret = gt911_i2c_read_reg(GT911_REG_POINT_2, &touch_raw_data[1 + GT911_POINT_SIZE],
+                             (touch_count - 1) * GT911_POINT_SIZE);
+    if (ret != ESP_OK)
+    {
+      return ret;
+    }
   }
 
   // Parse the touch data
   gt911_parse_touch_data(touch_raw_data, touch_data);
 
+  // A new press starts a latency measurement, at the INT edge when there is one
+  if (last_touch_data.touch_count == 0 && touch_data->touch_count > 0)
+  {
+    int64_t edge_us = int_edge_us;
+    touch_latency_mark_touch((edge_us > 0 && edge_us <= read_start_us) ? edge_us : read_start_us);
+    // Before LVGL sees the press, so the pulse does not wait for a frame
+    touch_feedback_press(touch_data->points[0].x, touch_data->points[0].y);
+  }
+
   // Store as last known state
   last_touch_data = *touch_data;
 
@@ -353,15 +444,49 @@ esp_err_t gt911_read_touch(gt911_touch_data_t *touch_data)
   return ESP_OK;
 }
 
+esp_err_t gt911_read_touch(gt911_touch_data_t *touch_data)
+{
+  TRACE_SPAN_BEGIN("touch_read");
+  esp_err_t ret = read_touch_report(touch_data);
+  TRACE_SPAN_END("touch_read");
+
+  // Injected fingers go after the real ones, a failed bus read does not stop a script
+  if (touch_inject_active())
+  {
+    if (ret != ESP_OK && gt911_initialized && touch_data)
+    {
+      memset(touch_data, 0, sizeof(*touch_data));
+      ret = ESP_OK;
+    }
+    if (ret == ESP_OK)
+    {
+      touch_inject_merge(touch_data, esp_timer_get_time());
+    }
+  }
+  return ret;
+}
+
 void gt911_lvgl_read(lv_indev_t *indev, lv_indev_data_t *data)
 {
   static gt911_touch_data_t touch_data;
+  static uint32_t pressed_point = UINT32_MAX; ///< Packed last point while pressed, for the release trace
 
-  if (gt911_read_touch(&touch_data) != ESP_OK)
+  if (touch_task_handle)
+  {
+    // Background mode, the touch task already read the report
+    portENTER_CRITICAL(&touch_data_lock);
+    touch_data = reported_touch_data;
+    portEXIT_CRITICAL(&touch_data_lock);
+  }
+  else if (gt911_read_touch(&touch_data) != ESP_OK)
   {
     data->state = LV_INDEV_STATE_RELEASED;
     return;
   }
+  else
+  {
+    gt911_gesture_process(&touch_data, esp_timer_get_time());
+  }
 
   if (touch_data.data_ready && touch_data.touch_count > 0)
   {
@@ -370,23 +495,179 @@ void gt911_lvgl_read(lv_indev_t *indev, lv_indev_data_t *data)
     data->point.y = touch_data.points[0].y;
     data->state = LV_INDEV_STATE_PRESSED;
 
-    // Enhanced debugging for touch events
-    debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "Touch: Count=%d, X=%d, Y=%d, TrackID=%d",
-                     touch_data.touch_count, data->point.x, data->point.y,
-                     touch_data.points[0].track_id);
+    // Runs for every sample while a finger is down, a trace record instead of a log line
+    pressed_point = (uint32_t)data->point.x | ((uint32_t)data->point.y << 16);
+    DEBUG_TRACE(DEBUG_TAG_GT911_TOUCH, DEBUG_TRACE_LEVEL_SAMPLE, DEBUG_TRACE_TOUCH_SAMPLE, pressed_point,
+                touch_data.touch_count | (touch_data.points[0].track_id << 8));
   }
   else
   {
     data->state = LV_INDEV_STATE_RELEASED;
+    if (pressed_point != UINT32_MAX)
+    {
+      DEBUG_TRACE(DEBUG_TAG_GT911_TOUCH, DEBUG_TRACE_LEVEL_EVENT, DEBUG_TRACE_TOUCH_RELEASE, pressed_point, 0);
+      pressed_point = UINT32_MAX;
+    }
+  }
+}
+
+static void IRAM_ATTR gt911_isr_handler(void *arg)
+{
+  BaseType_t high_task_awoken = pdFALSE;
+  int_edge_us = esp_timer_get_time();
+  if (touch_task_handle)
+  {
+    vTaskNotifyGiveFromISR(touch_task_handle, &high_task_awoken);
+  }
+  if (high_task_awoken == pdTRUE)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
 
-    // Debug log for touch release (only when transitioning from pressed)
-    static bool was_pressed = false;
-    if (was_pressed && touch_data.data_ready)
+/**
+ * @brief Read the controller on each INT pulse or poll period and hand reports to LVGL
+ */
+static void gt911_touch_task(void *arg)
+{
+  gt911_touch_data_t touch_data;
+
+  while (1)
+  {
+    // Injected fingers have no INT pulses, they are sampled at the poll period
+    TickType_t wait_ticks = touch_wait_ticks;
+    if (touch_inject_active() && wait_ticks > pdMS_TO_TICKS(GT911_POLL_PERIOD_MS))
+    {
+      wait_ticks = pdMS_TO_TICKS(GT911_POLL_PERIOD_MS);
+    }
+    ulTaskNotifyTake(pdTRUE, wait_ticks);
+
+    if (gt911_read_touch(&touch_data) != ESP_OK)
     {
-      debug_log_info(DEBUG_TAG_GT911_TOUCH, "Touch released");
+      continue;
     }
-    was_pressed = (data->state == LV_INDEV_STATE_PRESSED);
+    gt911_gesture_process(&touch_data, esp_timer_get_time());
+
+    portENTER_CRITICAL(&touch_data_lock);
+    bool changed = memcmp(&reported_touch_data, &touch_data, sizeof(touch_data)) != 0;
+    reported_touch_data = touch_data;
+    portEXIT_CRITICAL(&touch_data_lock);
+
+    // Keep LVGL reading while a finger is down so long-press timing still works
+    if (gt911_interrupt_cb && (changed || touch_data.data_ready))
+    {
+      gt911_interrupt_cb();
+    }
+  }
+}
+
+/**
+ * @brief Start the task that owns the bus in background mode
+ */
+static esp_err_t gt911_start_touch_task(gt911_interrupt_cb_t callback, TickType_t wait_ticks)
+{
+  gt911_interrupt_cb = callback;
+  touch_wait_ticks = wait_ticks;
+  if (task_plan_create(TASK_PLAN_TOUCH, gt911_touch_task, NULL, &touch_task_handle) != pdPASS)
+  {
+    debug_log_error(DEBUG_TAG_GT911_TOUCH, "Failed to create touch task");
+    gt911_interrupt_cb = NULL;
+    touch_task_handle = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t gt911_start_background_read(gt911_interrupt_cb_t callback)
+{
+  if (!gt911_initialized || touch_task_handle)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t ret = gt911_start_touch_task(callback, pdMS_TO_TICKS(GT911_POLL_PERIOD_MS));
+  if (ret == ESP_OK)
+  {
+    debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "Touch read in background every %d ms", GT911_POLL_PERIOD_MS);
+  }
+  return ret;
+}
+
+esp_err_t gt911_set_poll_period(uint32_t period_ms)
+{
+  if (period_ms == 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // INT-driven reads have no period to change
+  if (!touch_task_handle || touch_wait_ticks == portMAX_DELAY)
+  {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  TickType_t wait_ticks = pdMS_TO_TICKS(period_ms);
+  touch_wait_ticks = (wait_ticks > 0) ? wait_ticks : 1;
+  xTaskNotifyGive(touch_task_handle);
+  return ESP_OK;
+}
+
+void gt911_touch_wake(void)
+{
+  if (touch_task_handle)
+  {
+    xTaskNotifyGive(touch_task_handle);
+  }
+}
+
+esp_err_t gt911_enable_interrupt(gt911_interrupt_cb_t callback)
+{
+  if (!gt911_initialized)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!callback)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (touch_task_handle)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // GT911 pulls INT low for every new report (default config: falling edge)
+  esp_err_t ret = gpio_set_intr_type(GT911_INT_GPIO, GPIO_INTR_NEGEDGE);
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  // The ISR service may already be installed by another driver
+  ret = gpio_install_isr_service(0);
+  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+  {
+    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "GPIO ISR service install failed: %s", esp_err_to_name(ret));
+    return ret;
   }
+
+  ret = gt911_start_touch_task(callback, portMAX_DELAY);
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  ret = gpio_isr_handler_add(GT911_INT_GPIO, gt911_isr_handler, NULL);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "Touch ISR handler add failed: %s", esp_err_to_name(ret));
+    vTaskDelete(touch_task_handle);
+    touch_task_handle = NULL;
+    gt911_interrupt_cb = NULL;
+    return ret;
+  }
+
+  debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "Touch interrupt enabled on GPIO%d", GT911_INT_GPIO);
+  return ESP_OK;
 }
 
 esp_err_t gt911_get_product_id(char *product_id)
@@ -413,6 +694,54 @@ esp_err_t gt911_get_product_id(char *product_id)
   return ESP_OK;
 }
 
+esp_err_t gt911_read_config(uint8_t *config)
+{
+  if (!gt911_initialized || !config)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Block and checksum in one transfer, so both come from the same config
+  uint8_t raw[GT911_CONFIG_SIZE + 1];
+  esp_err_t ret = gt911_i2c_read_reg(GT911_REG_CONFIG, raw, sizeof(raw));
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  memcpy(config, raw, GT911_CONFIG_SIZE);
+  return raw[GT911_CONFIG_SIZE] == gt911_config_checksum(config) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+esp_err_t gt911_write_config(const uint8_t *config)
+{
+  if (!gt911_initialized || !config)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Register address, block, checksum and fresh flag in one write: the controller
+  // reloads on the fresh flag and must not see a block without its checksum
+  uint8_t buffer[2 + GT911_CONFIG_SIZE + 2];
+  buffer[0] = (GT911_REG_CONFIG >> 8) & 0xFF;
+  buffer[1] = GT911_REG_CONFIG & 0xFF;
+  memcpy(&buffer[2], config, GT911_CONFIG_SIZE);
+  buffer[2 + GT911_CONFIG_SIZE] = gt911_config_checksum(config);
+  buffer[2 + GT911_CONFIG_SIZE + 1] = 1;
+
+  esp_err_t ret = i2c_master_transmit(gt911_dev, buffer, sizeof(buffer), GT911_I2C_TIMEOUT_MS);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_GT911_TOUCH, "Config write failed: %s", esp_err_to_name(ret));
+  }
+  else
+  {
+    vTaskDelay(pdMS_TO_TICKS(10)); // The controller loads the block before it reports again
+  }
+
+  return ret;
+}
+
 esp_err_t gt911_soft_reset(void)
 {
   if (!gt911_initialized)
@@ -433,27 +762,29 @@ esp_err_t gt911_soft_reset(void)
 
 void gt911_calibrate_coords(uint16_t raw_x, uint16_t raw_y, uint16_t *cal_x, uint16_t *cal_y)
 {
-  // Basic coordinate mapping - adjust these values based on your screen orientation
-  // and calibration requirements
-
-  // For ESP32-S3-8048S050 (800x480 display)
-  // Assuming GT911 coordinates need to be mapped to screen coordinates
-
-  *cal_x = raw_x;
-  *cal_y = raw_y;
+  // Rotation, mirroring and scaling all come from the calibration matrix (TOUCH_CAL_SET).
+  // Points stay in panel coordinates, LVGL maps them for a rotated display.
+  int32_t x, y;
+  gt911_filter_map(raw_x, raw_y, &x, &y);
 
   // Bounds checking
-  if (*cal_x >= TOUCH_SCREEN_WIDTH)
+  if (x < 0)
+  {
+    x = 0;
+  }
+  else if (x >= TOUCH_SCREEN_WIDTH)
+  {
+    x = TOUCH_SCREEN_WIDTH - 1;
+  }
+  if (y < 0)
   {
-    *cal_x = TOUCH_SCREEN_WIDTH - 1;
+    y = 0;
   }
-  if (*cal_y >= TOUCH_SCREEN_HEIGHT)
+  else if (y >= TOUCH_SCREEN_HEIGHT)
   {
-    *cal_y = TOUCH_SCREEN_HEIGHT - 1;
+    y = TOUCH_SCREEN_HEIGHT - 1;
   }
 
-  // Optional: Apply rotation/mirroring transformations here
-  // Example for 180-degree rotation:
-  // *cal_x = TOUCH_SCREEN_WIDTH - 1 - *cal_x;
-  // *cal_y = TOUCH_SCREEN_HEIGHT - 1 - *cal_y;
+  *cal_x = (uint16_t)x;
+  *cal_y = (uint16_t)y;
 }
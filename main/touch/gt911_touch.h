@@ -4,7 +4,7 @@
 // STANDARD INCLUDES
 // =======================================================================
 
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
 #include "esp_err.h"
 #include "lvgl.h"
 
@@ -25,6 +25,11 @@
 #define GT911_REG_POINT_3 0x815F // Third touch point data
 #define GT911_REG_POINT_4 0x8167 // Fourth touch point data
 #define GT911_REG_POINT_5 0x816F // Fifth touch point data
+#define GT911_POINT_SIZE 8        // Bytes per touch point record
+#define GT911_REG_CONFIG 0x8047         // Config block, version byte first
+#define GT911_REG_CONFIG_CHECKSUM 0x80FF // Two's complement of the config block's byte sum
+#define GT911_REG_CONFIG_FRESH 0x8100   // Written 1 to make the controller take the block
+#define GT911_CONFIG_SIZE 184           // Config bytes 0x8047..0x80FE
 
 // Hardware pin definitions (ESP32-S3-8048S050 specific)
 #define GT911_SDA_GPIO 19 // I2C SDA pin
@@ -34,8 +39,20 @@
 
 // I2C Configuration
 #define GT911_I2C_NUM I2C_NUM_0
+#ifdef CONFIG_GT911_I2C_FREQ_HZ
+#define GT911_I2C_FREQ_HZ CONFIG_GT911_I2C_FREQ_HZ
+#else
 #define GT911_I2C_FREQ_HZ 400000 // 400kHz
+#endif
 #define GT911_I2C_TIMEOUT_MS 100
+#define GT911_I2C_MAX_WRITE_LEN 8 // Longest register write the driver issues
+
+// Background read period when the INT line is not used
+#ifdef CONFIG_GT911_POLL_PERIOD_MS
+#define GT911_POLL_PERIOD_MS CONFIG_GT911_POLL_PERIOD_MS
+#else
+#define GT911_POLL_PERIOD_MS 30
+#endif
 
 // Touch Configuration
 #define GT911_MAX_TOUCH_POINTS 5 // Maximum simultaneous touch points
@@ -68,6 +85,11 @@ typedef struct
   bool data_ready;                                    // Data ready flag
 } gt911_touch_data_t;
 
+/**
+ * @brief New report callback, called from the touch task when a report changed or a finger is down
+ */
+typedef void (*gt911_interrupt_cb_t)(void);
+
 // =======================================================================
 // FUNCTION DECLARATIONS
 // =======================================================================
@@ -91,8 +113,56 @@ esp_err_t gt911_deinit(void);
  */
 esp_err_t gt911_read_touch(gt911_touch_data_t *touch_data);
 
+/**
+ * @brief Enable the GT911 INT line interrupt
+ *
+ * The ISR wakes a touch task that reads the report over I2C, so the bus is
+ * only used when the controller has data. gt911_lvgl_read() then returns the
+ * latest report without touching the bus.
+ *
+ * @param callback Called from the touch task after every report
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if callback is NULL, ESP_ERR_INVALID_STATE if not initialized,
+ *         ESP_ERR_NO_MEM if the touch task could not be created
+ */
+esp_err_t gt911_enable_interrupt(gt911_interrupt_cb_t callback);
+
+/**
+ * @brief Read the GT911 from the touch task on a fixed period
+ *
+ * For boards where INT cannot be used. The I2C transfers run in the touch
+ * task every GT911_POLL_PERIOD_MS, and gt911_lvgl_read() returns the latest
+ * report, so the LVGL task never waits on the bus.
+ *
+ * @param callback Called from the touch task while touched and on release, may be NULL
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized or already started,
+ *         ESP_ERR_NO_MEM if the touch task could not be created
+ */
+esp_err_t gt911_start_background_read(gt911_interrupt_cb_t callback);
+
+/**
+ * @brief Change the background read period
+ *
+ * Takes effect at once: the touch task reads the controller and then waits
+ * the new period.
+ *
+ * @param period_ms New period, GT911_POLL_PERIOD_MS is the configured one
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if period_ms is 0,
+ *         ESP_ERR_NOT_SUPPORTED unless gt911_start_background_read() is running
+ */
+esp_err_t gt911_set_poll_period(uint32_t period_ms);
+
+/**
+ * @brief Make the touch task read now instead of waiting for INT or the period
+ * @note No effect unless the touch task is running
+ */
+void gt911_touch_wake(void);
+
 /**
  * @brief LVGL input device read callback for GT911
+ *
+ * Polls the controller, or with the touch task running returns the report it
+ * read last.
+ *
  * @param indev LVGL input device
  * @param data LVGL input data structure
  */
@@ -105,6 +175,26 @@ void gt911_lvgl_read(lv_indev_t *indev, lv_indev_data_t *data);
  */
 esp_err_t gt911_get_product_id(char *product_id);
 
+/**
+ * @brief Read the config block
+ * @param config Receives GT911_CONFIG_SIZE bytes from GT911_REG_CONFIG
+ * @return ESP_OK, ESP_ERR_INVALID_CRC if the stored checksum does not match (config is
+ *         filled anyway), ESP_ERR_INVALID_STATE if not initialized, or the I2C error
+ */
+esp_err_t gt911_read_config(uint8_t *config);
+
+/**
+ * @brief Write the config block with its checksum and the config-fresh flag
+ *
+ * The controller takes the block only if its version byte is not below the
+ * one it holds, so pass a block read with gt911_read_config() and change
+ * single fields. It stores the block in its own flash, write only on change.
+ *
+ * @param config GT911_CONFIG_SIZE bytes for GT911_REG_CONFIG
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not initialized, or the I2C error
+ */
+esp_err_t gt911_write_config(const uint8_t *config);
+
 /**
  * @brief Software reset GT911 controller
  * @return ESP_OK on success, ESP_FAIL on failure
@@ -112,7 +202,7 @@ esp_err_t gt911_get_product_id(char *product_id);
 esp_err_t gt911_soft_reset(void);
 
 /**
- * @brief Calibrate GT911 touch coordinates
+ * @brief Calibrate GT911 touch coordinates with the stored matrix and clamp them to the screen
  * @param raw_x Raw X coordinate from GT911
  * @param raw_y Raw Y coordinate from GT911
  * @param cal_x Pointer to store calibrated X coordinate
@@ -0,0 +1,280 @@
+/**
+ * @file touch_feedback.c
+ * @brief Buzzer or haptic pulse on a press over a control
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "touch_feedback.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "serial_data_handler.h"
+
+#if CONFIG_TOUCH_FEEDBACK
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "gt911_touch.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+// Timer 0 and channel 0 drive the backlight
+#define FEEDBACK_LEDC_MODE LEDC_LOW_SPEED_MODE
+#define FEEDBACK_LEDC_TIMER LEDC_TIMER_1
+#define FEEDBACK_LEDC_CHANNEL LEDC_CHANNEL_1
+#define FEEDBACK_LEDC_RESOLUTION LEDC_TIMER_10_BIT
+#define FEEDBACK_LEDC_HALF_DUTY (1U << (FEEDBACK_LEDC_RESOLUTION - 1))
+
+#define GRID_CELL_W ((TOUCH_SCREEN_WIDTH + TOUCH_FEEDBACK_GRID_COLS - 1) / TOUCH_FEEDBACK_GRID_COLS)
+#define GRID_CELL_H ((TOUCH_SCREEN_HEIGHT + TOUCH_FEEDBACK_GRID_ROWS - 1) / TOUCH_FEEDBACK_GRID_ROWS)
+
+_Static_assert(TOUCH_FEEDBACK_MAX_TARGETS <= 64, "a grid cell holds one bit per target");
+
+#if CONFIG_TOUCH_FEEDBACK_BUZZER
+#define FEEDBACK_KIND "tone"
+#else
+#define FEEDBACK_KIND "pulse"
+#endif
+
+// Written by the LVGL task, scanned by the touch task
+static portMUX_TYPE feedback_lock = portMUX_INITIALIZER_UNLOCKED;
+static touch_feedback_rect_t targets[TOUCH_FEEDBACK_MAX_TARGETS];
+static uint64_t grid[TOUCH_FEEDBACK_GRID_ROWS][TOUCH_FEEDBACK_GRID_COLS]; ///< Targets reaching into each cell
+static int target_count = 0;
+static bool enabled = true;
+
+static esp_timer_handle_t pulse_timer = NULL;
+static uint32_t presses = 0;
+static uint32_t pulses = 0;
+static uint32_t rects_tested = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void set_output(bool on)
+{
+#if CONFIG_TOUCH_FEEDBACK_BUZZER
+  ledc_set_duty(FEEDBACK_LEDC_MODE, FEEDBACK_LEDC_CHANNEL, on ? FEEDBACK_LEDC_HALF_DUTY : 0);
+  ledc_update_duty(FEEDBACK_LEDC_MODE, FEEDBACK_LEDC_CHANNEL);
+#else
+  gpio_set_level(CONFIG_TOUCH_FEEDBACK_GPIO, on);
+#endif
+}
+
+static int grid_col(int32_t x)
+{
+  int col = x / GRID_CELL_W;
+  return col < 0 ? 0 : col >= TOUCH_FEEDBACK_GRID_COLS ? TOUCH_FEEDBACK_GRID_COLS - 1 : col;
+}
+
+static int grid_row(int32_t y)
+{
+  int row = y / GRID_CELL_H;
+  return row < 0 ? 0 : row >= TOUCH_FEEDBACK_GRID_ROWS ? TOUCH_FEEDBACK_GRID_ROWS - 1 : row;
+}
+
+static void pulse_timer_cb(void *arg)
+{
+  (void)arg;
+  set_output(false);
+}
+
+static void pulse(void)
+{
+  if (!pulse_timer)
+    return;
+  // A pulse still running is restarted, not stacked
+  esp_timer_stop(pulse_timer);
+  set_output(true);
+  esp_timer_start_once(pulse_timer, CONFIG_TOUCH_FEEDBACK_PULSE_MS * 1000ULL);
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t touch_feedback_init(void)
+{
+  esp_err_t err;
+#if CONFIG_TOUCH_FEEDBACK_BUZZER
+  ledc_timer_config_t timer_config = {
+      .speed_mode = FEEDBACK_LEDC_MODE,
+      .duty_resolution = FEEDBACK_LEDC_RESOLUTION,
+      .timer_num = FEEDBACK_LEDC_TIMER,
+      .freq_hz = CONFIG_TOUCH_FEEDBACK_TONE_HZ,
+      .clk_cfg = LEDC_AUTO_CLK,
+  };
+  ledc_channel_config_t channel_config = {
+      .gpio_num = CONFIG_TOUCH_FEEDBACK_GPIO,
+      .speed_mode = FEEDBACK_LEDC_MODE,
+      .channel = FEEDBACK_LEDC_CHANNEL,
+      .timer_sel = FEEDBACK_LEDC_TIMER,
+      .duty = 0,
+      .hpoint = 0,
+  };
+  err = ledc_timer_config(&timer_config);
+  if (err == ESP_OK)
+    err = ledc_channel_config(&channel_config);
+#else
+  gpio_config_t io_config = {
+      .pin_bit_mask = 1ULL << CONFIG_TOUCH_FEEDBACK_GPIO,
+      .mode = GPIO_MODE_OUTPUT,
+  };
+  err = gpio_config(&io_config);
+  if (err == ESP_OK)
+    err = gpio_set_level(CONFIG_TOUCH_FEEDBACK_GPIO, 0);
+#endif
+  if (err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_GT911_TOUCH, "Touch feedback output on GPIO %d failed: %s", CONFIG_TOUCH_FEEDBACK_GPIO,
+                      esp_err_to_name(err));
+    return err;
+  }
+
+  // Ends the pulse from the timer task, never from the touch task that started it
+  const esp_timer_create_args_t timer_args = {
+      .callback = pulse_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "touch_pulse",
+  };
+  err = esp_timer_create(&timer_args, &pulse_timer);
+  if (err != ESP_OK)
+  {
+    return err;
+  }
+
+  debug_log_info_f(DEBUG_TAG_GT911_TOUCH, "Touch feedback: %d ms " FEEDBACK_KIND " on GPIO %d", CONFIG_TOUCH_FEEDBACK_PULSE_MS,
+                   CONFIG_TOUCH_FEEDBACK_GPIO);
+  return ESP_OK;
+}
+
+void touch_feedback_set_targets(const touch_feedback_rect_t *rects, int count)
+{
+  if (count > TOUCH_FEEDBACK_MAX_TARGETS)
+    count = TOUCH_FEEDBACK_MAX_TARGETS;
+  if (count < 0 || !rects)
+    count = 0;
+
+  // Built outside the lock, only the copy blocks the touch task
+  static uint64_t next_grid[TOUCH_FEEDBACK_GRID_ROWS][TOUCH_FEEDBACK_GRID_COLS];
+  memset(next_grid, 0, sizeof(next_grid));
+  for (int i = 0; i < count; i++)
+  {
+    const touch_feedback_rect_t *r = &rects[i];
+    int col_end = grid_col(r->x2 + TOUCH_FEEDBACK_SLOP_PX);
+    int row_end = grid_row(r->y2 + TOUCH_FEEDBACK_SLOP_PX);
+    for (int row = grid_row(r->y1 - TOUCH_FEEDBACK_SLOP_PX); row <= row_end; row++)
+    {
+      for (int col = grid_col(r->x1 - TOUCH_FEEDBACK_SLOP_PX); col <= col_end; col++)
+        next_grid[row][col] |= 1ULL << i;
+    }
+  }
+
+  portENTER_CRITICAL(&feedback_lock);
+  memcpy(targets, rects, (size_t)count * sizeof(targets[0]));
+  memcpy(grid, next_grid, sizeof(grid));
+  target_count = count;
+  portEXIT_CRITICAL(&feedback_lock);
+}
+
+void touch_feedback_set_enabled(bool enable)
+{
+  portENTER_CRITICAL(&feedback_lock);
+  enabled = enable;
+  portEXIT_CRITICAL(&feedback_lock);
+}
+
+void touch_feedback_press(int32_t x, int32_t y)
+{
+  bool hit = false;
+  portENTER_CRITICAL(&feedback_lock);
+  presses++;
+  uint64_t candidates = enabled ? grid[grid_row(y)][grid_col(x)] : 0;
+  while (candidates && !hit)
+  {
+    const touch_feedback_rect_t *r = &targets[__builtin_ctzll(candidates)];
+    candidates &= candidates - 1;
+    rects_tested++;
+    hit = x >= r->x1 - TOUCH_FEEDBACK_SLOP_PX && x <= r->x2 + TOUCH_FEEDBACK_SLOP_PX &&
+          y >= r->y1 - TOUCH_FEEDBACK_SLOP_PX && y <= r->y2 + TOUCH_FEEDBACK_SLOP_PX;
+  }
+  if (hit)
+    pulses++;
+  portEXIT_CRITICAL(&feedback_lock);
+
+  if (hit)
+    pulse();
+}
+
+bool touch_feedback_handle_command(const char *line)
+{
+  if (strcmp(line, "TOUCH_FEEDBACK TEST") == 0)
+  {
+    pulse();
+    static const char ok[] = "TOUCH_FEEDBACK {\"test\":true}\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+    return true;
+  }
+  if (strcmp(line, "GET_TOUCH_FEEDBACK") != 0)
+    return false;
+
+  portENTER_CRITICAL(&feedback_lock);
+  int count = target_count;
+  bool is_enabled = enabled;
+  uint32_t press_count = presses;
+  uint32_t pulse_count = pulses;
+  uint32_t tested = rects_tested;
+  portEXIT_CRITICAL(&feedback_lock);
+
+  char reply[192];
+  int len = snprintf(reply, sizeof(reply),
+                     "TOUCH_FEEDBACK {\"enabled\":%s,\"targets\":%d,\"presses\":%lu,\"pulses\":%lu,"
+                     "\"rects_tested\":%lu,\"pulse_ms\":%d}\n",
+                     is_enabled ? "true" : "false", count, (unsigned long)press_count, (unsigned long)pulse_count,
+                     (unsigned long)tested, CONFIG_TOUCH_FEEDBACK_PULSE_MS);
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+esp_err_t touch_feedback_init(void)
+{
+  return ESP_OK;
+}
+
+void touch_feedback_set_targets(const touch_feedback_rect_t *rects, int count)
+{
+  (void)rects;
+  (void)count;
+}
+
+void touch_feedback_set_enabled(bool enabled)
+{
+  (void)enabled;
+}
+
+void touch_feedback_press(int32_t x, int32_t y)
+{
+  (void)x;
+  (void)y;
+}
+
+bool touch_feedback_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TOUCH_FEEDBACK") != 0 && strcmp(line, "TOUCH_FEEDBACK TEST") != 0)
+    return false;
+  static const char disabled[] = "TOUCH_FEEDBACK {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_TOUCH_FEEDBACK
@@ -0,0 +1,85 @@
+/**
+ * @file touch_feedback.h
+ * @brief Buzzer or haptic pulse on a press over a control
+ *
+ * A tap on a switch shows nothing until LVGL has handled it and the next
+ * frame is out, and the Home Assistant round trip comes after that. The
+ * pulse is fired by the touch task itself on the read that sees a new
+ * press, before LVGL reads the report, if the point lies inside one of
+ * the control rectangles the UI published (ui_touch_targets.h). The
+ * rectangles are bucketed into a coarse grid when they are published, so
+ * a press only tests the few controls of its own cell, however many the
+ * screen has, and needs nothing from the LVGL task.
+ *
+ * The output is a square wave on an LEDC channel for a passive buzzer, or
+ * a plain GPIO pulse for a haptic driver, ended by a one-shot esp_timer.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define TOUCH_FEEDBACK_MAX_TARGETS 64 ///< Control rectangles kept, one bit each in a grid cell
+#define TOUCH_FEEDBACK_SLOP_PX 6      ///< Presses this close outside a control still count
+#define TOUCH_FEEDBACK_GRID_COLS 10   ///< Hit test grid over the touch area, 80 px cells at 800x480
+#define TOUCH_FEEDBACK_GRID_ROWS 6
+
+/**
+ * @brief Control rectangle in touch controller coordinates, edges inclusive
+ */
+typedef struct
+{
+  int16_t x1;
+  int16_t y1;
+  int16_t x2;
+  int16_t y2;
+} touch_feedback_rect_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Set up the output pin and the pulse timer
+ * @return ESP_OK, also when the feature is compiled out
+ */
+esp_err_t touch_feedback_init(void);
+
+/**
+ * @brief Replace the control rectangles
+ * @param rects Rectangles, copied
+ * @param count Number of rectangles, cut to TOUCH_FEEDBACK_MAX_TARGETS
+ * @note Any task
+ */
+void touch_feedback_set_targets(const touch_feedback_rect_t *rects, int count);
+
+/**
+ * @brief Allow pulses, e.g. only while touches reach the controls
+ * @note Any task
+ */
+void touch_feedback_set_enabled(bool enabled);
+
+/**
+ * @brief A finger landed, pulse if it is over a control
+ * @param x Touch controller x after calibration
+ * @param y Touch controller y after calibration
+ * @note Touch task, or the LVGL task when it reads the controller itself
+ */
+void touch_feedback_press(int32_t x, int32_t y);
+
+/**
+ * @brief Handle GET_TOUCH_FEEDBACK and TOUCH_FEEDBACK TEST
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a feedback command
+ */
+bool touch_feedback_handle_command(const char *line);
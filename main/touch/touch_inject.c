@@ -0,0 +1,379 @@
+/**
+ * @file touch_inject.c
+ * @brief Virtual touch input merged with the GT911 reports
+ *
+ * The queue is advanced by the reads themselves: a step starts at the first
+ * read that reaches it and ends at the first read past its duration, so the
+ * timing follows the touch sampling the real controller gets. A finished
+ * stroke yields one read without its fingers before the next step starts,
+ * otherwise LVGL would see two taps in a row as one long press.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "touch_inject.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+#include "utils/touch_latency.h"
+
+#if CONFIG_TOUCH_INJECT
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  touch_inject_path_t paths[TOUCH_INJECT_MAX_FINGERS];
+  uint8_t fingers; ///< 0 for a pause
+  uint32_t duration_ms;
+} inject_step_t;
+
+static inject_step_t queue[TOUCH_INJECT_QUEUE_LENGTH];
+static int queue_head = 0;
+static int queue_count = 0;
+static bool step_running = false;
+static int64_t step_start_us = 0;
+static portMUX_TYPE inject_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static bool path_on_screen(const touch_inject_path_t *path)
+{
+  return path->x0 < TOUCH_SCREEN_WIDTH && path->x1 < TOUCH_SCREEN_WIDTH && path->y0 < TOUCH_SCREEN_HEIGHT &&
+         path->y1 < TOUCH_SCREEN_HEIGHT;
+}
+
+static bool step_valid(const inject_step_t *step)
+{
+  if (step->duration_ms == 0 || step->duration_ms > TOUCH_INJECT_MAX_STEP_MS ||
+      step->fingers > TOUCH_INJECT_MAX_FINGERS)
+    return false;
+  for (int i = 0; i < step->fingers; i++)
+  {
+    if (!path_on_screen(&step->paths[i]))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Append steps all or nothing
+ */
+static esp_err_t enqueue(const inject_step_t *steps, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (!step_valid(&steps[i]))
+      return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t ret = ESP_OK;
+  portENTER_CRITICAL(&inject_lock);
+  if (queue_count + count > TOUCH_INJECT_QUEUE_LENGTH)
+  {
+    ret = ESP_ERR_NO_MEM;
+  }
+  else
+  {
+    for (int i = 0; i < count; i++)
+    {
+      queue[(queue_head + queue_count) % TOUCH_INJECT_QUEUE_LENGTH] = steps[i];
+      queue_count++;
+    }
+  }
+  portEXIT_CRITICAL(&inject_lock);
+
+  // In INT mode the touch task would otherwise sleep until a real touch
+  if (ret == ESP_OK)
+    gt911_touch_wake();
+  return ret;
+}
+
+static uint16_t lerp(uint16_t from, uint16_t to, int64_t elapsed_us, int64_t duration_us)
+{
+  return (uint16_t)(from + ((int32_t)to - from) * elapsed_us / duration_us);
+}
+
+static uint16_t clamp_x(int32_t x)
+{
+  return (uint16_t)(x < 0 ? 0 : (x >= TOUCH_SCREEN_WIDTH ? TOUCH_SCREEN_WIDTH - 1 : x));
+}
+
+/**
+ * @brief One TOUCH_SCRIPT step, e.g. "drag 100 240 700 240 300"
+ */
+static bool parse_step(const char *text, inject_step_t *step)
+{
+  char verb[8];
+  unsigned v[5] = {0};
+  int n = sscanf(text, "%7s %u %u %u %u %u", verb, &v[0], &v[1], &v[2], &v[3], &v[4]) - 1;
+  for (int i = 0; i < n; i++)
+  {
+    if (v[i] > UINT16_MAX)
+      return false;
+  }
+
+  memset(step, 0, sizeof(*step));
+  if (strcmp(verb, "tap") == 0 && (n == 2 || n == 3))
+  {
+    step->fingers = 1;
+    step->paths[0] = (touch_inject_path_t){v[0], v[1], v[0], v[1]};
+    step->duration_ms = n == 3 ? v[2] : TOUCH_INJECT_TAP_MS;
+  }
+  else if (strcmp(verb, "drag") == 0 && n == 5)
+  {
+    step->fingers = 1;
+    step->paths[0] = (touch_inject_path_t){v[0], v[1], v[2], v[3]};
+    step->duration_ms = v[4];
+  }
+  else if (strcmp(verb, "swipe2") == 0 && n == 5)
+  {
+    step->fingers = 2;
+    step->paths[0] = (touch_inject_path_t){v[0], v[1], v[2], v[3]};
+    step->paths[1] = (touch_inject_path_t){clamp_x(v[0] + TOUCH_INJECT_FINGER_SPACING_PX), v[1],
+                                           clamp_x(v[2] + TOUCH_INJECT_FINGER_SPACING_PX), v[3]};
+    step->duration_ms = v[4];
+  }
+  else if (strcmp(verb, "pinch") == 0 && n == 5)
+  {
+    // Two fingers level with the centre, spread from distance d0 to d1
+    int32_t cx = v[0], cy = v[1], d0 = v[2] / 2, d1 = v[3] / 2;
+    step->fingers = 2;
+    step->paths[0] = (touch_inject_path_t){clamp_x(cx - d0), cy, clamp_x(cx - d1), cy};
+    step->paths[1] = (touch_inject_path_t){clamp_x(cx + d0), cy, clamp_x(cx + d1), cy};
+    step->duration_ms = v[4];
+  }
+  else if (strcmp(verb, "wait") == 0 && n == 1)
+  {
+    step->duration_ms = v[0];
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+static void reply(const char *command, esp_err_t ret, int queued)
+{
+  char buf[128];
+  int len;
+  if (ret == ESP_OK)
+  {
+    len = snprintf(buf, sizeof(buf), "%s {\"queued\":%d,\"pending\":%d}\n", command, queued, queue_count);
+  }
+  else if (ret == ESP_ERR_INVALID_ARG)
+  {
+    len = snprintf(buf, sizeof(buf), "%s {\"error\":\"bad step, see touch_inject.h\"}\n", command);
+  }
+  else if (ret == ESP_ERR_NO_MEM)
+  {
+    len = snprintf(buf, sizeof(buf), "%s {\"error\":\"queue full\",\"pending\":%d}\n", command, queue_count);
+  }
+  else
+  {
+    len = snprintf(buf, sizeof(buf), "%s {\"error\":\"%s\"}\n", command, esp_err_to_name(ret));
+  }
+  serial_data_write(buf, len);
+}
+
+static bool handle_inject(const char *args)
+{
+  unsigned v[6] = {0};
+  int n = sscanf(args, "%u %u %u %u %u %u", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+  char step_text[64];
+  if (n == 2 || n == 3)
+    snprintf(step_text, sizeof(step_text), "tap %u %u %u", v[0], v[1], n == 3 ? v[2] : TOUCH_INJECT_TAP_MS);
+  else if (n == 5 || (n == 6 && v[5] == 1))
+    snprintf(step_text, sizeof(step_text), "drag %u %u %u %u %u", v[0], v[1], v[2], v[3], v[4]);
+  else if (n == 6 && v[5] == 2)
+    snprintf(step_text, sizeof(step_text), "swipe2 %u %u %u %u %u", v[0], v[1], v[2], v[3], v[4]);
+  else
+    step_text[0] = '\0';
+
+  inject_step_t step;
+  esp_err_t ret = parse_step(step_text, &step) ? enqueue(&step, 1) : ESP_ERR_INVALID_ARG;
+  reply("TOUCH_INJECT", ret, ret == ESP_OK ? 1 : 0);
+  return true;
+}
+
+static bool handle_script(const char *script)
+{
+  if (strcmp(script, "clear") == 0)
+  {
+    touch_inject_clear();
+    reply("TOUCH_SCRIPT", ESP_OK, 0);
+    return true;
+  }
+
+  inject_step_t steps[TOUCH_INJECT_QUEUE_LENGTH];
+  int count = 0;
+  esp_err_t ret = ESP_OK;
+  const char *cursor = script;
+  while (*cursor && ret == ESP_OK)
+  {
+    const char *end = strchr(cursor, ';');
+    size_t len = end ? (size_t)(end - cursor) : strlen(cursor);
+    char text[48];
+    if (len >= sizeof(text) || count == TOUCH_INJECT_QUEUE_LENGTH)
+    {
+      ret = len >= sizeof(text) ? ESP_ERR_INVALID_ARG : ESP_ERR_NO_MEM;
+      break;
+    }
+    memcpy(text, cursor, len);
+    text[len] = '\0';
+    if (!parse_step(text, &steps[count++]))
+      ret = ESP_ERR_INVALID_ARG;
+    cursor = end ? end + 1 : cursor + len;
+  }
+
+  if (ret == ESP_OK)
+    ret = count ? enqueue(steps, count) : ESP_ERR_INVALID_ARG;
+  reply("TOUCH_SCRIPT", ret, ret == ESP_OK ? count : 0);
+  return true;
+}
+
+#endif // CONFIG_TOUCH_INJECT
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t touch_inject_stroke(const touch_inject_path_t *paths, uint8_t fingers, uint32_t duration_ms)
+{
+#if CONFIG_TOUCH_INJECT
+  if (!paths || fingers < 1 || fingers > TOUCH_INJECT_MAX_FINGERS)
+    return ESP_ERR_INVALID_ARG;
+
+  inject_step_t step = {.fingers = fingers, .duration_ms = duration_ms};
+  memcpy(step.paths, paths, fingers * sizeof(touch_inject_path_t));
+  return enqueue(&step, 1);
+#else
+  (void)paths;
+  (void)fingers;
+  (void)duration_ms;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t touch_inject_wait(uint32_t duration_ms)
+{
+#if CONFIG_TOUCH_INJECT
+  inject_step_t step = {.fingers = 0, .duration_ms = duration_ms};
+  return enqueue(&step, 1);
+#else
+  (void)duration_ms;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void touch_inject_clear(void)
+{
+#if CONFIG_TOUCH_INJECT
+  portENTER_CRITICAL(&inject_lock);
+  // A running stroke stays at the head until its lift has been reported
+  int keep = step_running && queue[queue_head].fingers ? 1 : 0;
+  queue_count = keep;
+  if (keep)
+    queue[queue_head].duration_ms = 0;
+  else
+    step_running = false;
+  portEXIT_CRITICAL(&inject_lock);
+#endif
+}
+
+bool touch_inject_active(void)
+{
+#if CONFIG_TOUCH_INJECT
+  return queue_count > 0;
+#else
+  return false;
+#endif
+}
+
+void touch_inject_merge(gt911_touch_data_t *touch_data, int64_t now_us)
+{
+#if CONFIG_TOUCH_INJECT
+  if (queue_count == 0)
+    return;
+
+  inject_step_t step;
+  int64_t elapsed_us = 0;
+  bool pressed = false;
+  bool started = false;
+
+  portENTER_CRITICAL(&inject_lock);
+  while (queue_count > 0)
+  {
+    inject_step_t *head = &queue[queue_head];
+    if (!step_running)
+    {
+      step_running = true;
+      step_start_us = now_us;
+      started = head->fingers > 0;
+    }
+    elapsed_us = now_us - step_start_us;
+    if (elapsed_us < (int64_t)head->duration_ms * 1000)
+    {
+      step = *head;
+      pressed = head->fingers > 0;
+      break;
+    }
+
+    // Step over; a stroke reports its lift first, a pause hands over at once
+    bool was_stroke = head->fingers > 0;
+    queue_head = (queue_head + 1) % TOUCH_INJECT_QUEUE_LENGTH;
+    queue_count--;
+    step_running = false;
+    started = false;
+    if (was_stroke)
+      break;
+  }
+  portEXIT_CRITICAL(&inject_lock);
+
+  if (!pressed)
+    return;
+
+  // A real finger on the panel keeps the first slot, LVGL follows it
+  if (started && touch_data->touch_count == 0)
+    touch_latency_mark_touch(now_us);
+
+  int64_t duration_us = (int64_t)step.duration_ms * 1000;
+  for (int i = 0; i < step.fingers && touch_data->touch_count < GT911_MAX_TOUCH_POINTS; i++)
+  {
+    const touch_inject_path_t *path = &step.paths[i];
+    gt911_touch_point_t *point = &touch_data->points[touch_data->touch_count++];
+    point->x = lerp(path->x0, path->x1, elapsed_us, duration_us);
+    point->y = lerp(path->y0, path->y1, elapsed_us, duration_us);
+    point->size = 20;
+    point->track_id = TOUCH_INJECT_TRACK_ID_BASE + i;
+    point->pressed = true;
+  }
+  touch_data->data_ready = true;
+#else
+  (void)touch_data;
+  (void)now_us;
+#endif
+}
+
+bool touch_inject_handle_command(const char *line)
+{
+#if CONFIG_TOUCH_INJECT
+  if (strncmp(line, "TOUCH_INJECT ", 13) == 0)
+    return handle_inject(line + 13);
+  if (strncmp(line, "TOUCH_SCRIPT ", 13) == 0)
+    return handle_script(line + 13);
+  return false;
+#else
+  (void)line;
+  return false;
+#endif
+}
@@ -0,0 +1,99 @@
+/**
+ * @file touch_inject.h
+ * @brief Virtual touch input merged with the GT911 reports
+ *
+ * Touch scripts arrive over the serial port as a queue of steps: strokes
+ * of one or two fingers, each moving in a straight line over a duration,
+ * and pauses between them. Every controller read adds the fingers of the
+ * running stroke after the real ones, so the gesture recogniser, the
+ * latency probe and LVGL treat them as touches while a real finger still
+ * takes priority. Injected fingers use their own track IDs.
+ *
+ * Commands:
+ *   TOUCH_INJECT <x> <y> [ms]                          tap or long press
+ *   TOUCH_INJECT <x0> <y0> <x1> <y1> <ms> [fingers]    drag, two-finger swipe
+ *   TOUCH_SCRIPT <step>; <step>; ...                   queue several steps
+ *     tap x y [ms] | drag x0 y0 x1 y1 ms | swipe2 x0 y0 x1 y1 ms |
+ *     pinch cx cy d0 d1 ms | wait ms | clear
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "gt911_touch.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define TOUCH_INJECT_QUEUE_LENGTH 16       // Steps waiting to run
+#define TOUCH_INJECT_MAX_FINGERS 2         // Fingers per stroke
+#define TOUCH_INJECT_MAX_STEP_MS 10000     // Longest stroke or pause
+#define TOUCH_INJECT_TAP_MS 80             // Tap without a duration
+#define TOUCH_INJECT_FINGER_SPACING_PX 80  // Second finger of TOUCH_INJECT, to the right of the first
+#define TOUCH_INJECT_TRACK_ID_BASE 10      // Above the GT911's own track IDs
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief Straight path of one finger in screen coordinates
+ */
+typedef struct
+{
+  uint16_t x0;
+  uint16_t y0;
+  uint16_t x1;
+  uint16_t y1;
+} touch_inject_path_t;
+
+// =======================================================================
+// FUNCTION DECLARATIONS
+// =======================================================================
+
+/**
+ * @brief Queue a stroke
+ * @param paths One path per finger
+ * @param fingers 1 or 2
+ * @param duration_ms Time the fingers are down, then they lift
+ * @return ESP_OK if queued, ESP_ERR_INVALID_ARG for points off screen or a bad
+ *         duration or finger count, ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t touch_inject_stroke(const touch_inject_path_t *paths, uint8_t fingers, uint32_t duration_ms);
+
+/**
+ * @brief Queue a pause with no injected finger down
+ * @return ESP_OK if queued, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM
+ */
+esp_err_t touch_inject_wait(uint32_t duration_ms);
+
+/**
+ * @brief Drop the queued steps, a stroke in progress is lifted at the next read
+ */
+void touch_inject_clear(void);
+
+/**
+ * @brief Whether steps are queued or running, touch readers keep sampling meanwhile
+ */
+bool touch_inject_active(void);
+
+/**
+ * @brief Add the running stroke's fingers to a controller report
+ * @param touch_data Report from the controller, extended in place
+ * @param now_us esp_timer time of the read
+ * @note Called from whichever task reads the controller
+ */
+void touch_inject_merge(gt911_touch_data_t *touch_data, int64_t now_us);
+
+/**
+ * @brief Handle TOUCH_INJECT and TOUCH_SCRIPT
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was an injection command
+ */
+bool touch_inject_handle_command(const char *line);
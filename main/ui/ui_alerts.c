@@ -0,0 +1,130 @@
+/**
+ * @file ui_alerts.c
+ * @brief Blinking badges for active telemetry alerts
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_alerts.h"
+
+#include "lvgl_setup.h"
+#include "ui_helpers.h"
+
+#if CONFIG_TELEMETRY_ALERTS
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static lv_obj_t *badges[TELEMETRY_ALERT_COUNT];
+static lv_style_t badge_style;
+static bool badge_style_ready = false;
+static lv_timer_t *blink_timer = NULL;
+static bool blink_on = true;
+
+// Written by the telemetry tasks, the LVGL task applies it
+static volatile uint32_t requested_mask = 0;
+static uint32_t shown_mask = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void show_badges(bool on)
+{
+  for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+  {
+    if (badges[alert])
+    {
+      lv_obj_update_flag(badges[alert], LV_OBJ_FLAG_HIDDEN, !(on && (shown_mask & (1u << alert))));
+    }
+  }
+}
+
+static void blink_timer_cb(lv_timer_t *timer)
+{
+  LV_UNUSED(timer);
+  blink_on = !blink_on;
+  show_badges(blink_on);
+}
+
+#endif // CONFIG_TELEMETRY_ALERTS
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_alerts_attach(telemetry_alert_t alert, lv_obj_t *panel, int field_x)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (alert >= TELEMETRY_ALERT_COUNT || !panel)
+    return;
+
+  if (!badge_style_ready)
+  {
+    lv_style_init(&badge_style);
+    lv_style_set_bg_color(&badge_style, lv_color_hex(0xff4444));
+    lv_style_set_bg_opa(&badge_style, LV_OPA_COVER);
+    lv_style_set_radius(&badge_style, LV_RADIUS_CIRCLE);
+    lv_style_set_border_width(&badge_style, 0);
+    lv_style_set_pad_all(&badge_style, 0);
+    badge_style_ready = true;
+  }
+  if (!blink_timer)
+  {
+    blink_timer = lv_timer_create(blink_timer_cb, UI_ALERT_BLINK_MS, NULL);
+    lv_timer_pause(blink_timer);
+  }
+
+  lv_obj_t *badge = lv_obj_create(panel);
+  lv_obj_remove_style_all(badge);
+  lv_obj_add_style(badge, &badge_style, 0);
+  lv_obj_set_size(badge, UI_ALERT_BADGE_SIZE, UI_ALERT_BADGE_SIZE);
+  lv_obj_set_pos(badge, field_x + UI_ALERT_BADGE_OFFSET_X, UI_ALERT_BADGE_Y);
+  lv_obj_remove_flag(badge, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_flag(badge, LV_OBJ_FLAG_HIDDEN);
+  ui_mark_dynamic(badge);
+  badges[alert] = badge;
+#else
+  LV_UNUSED(alert);
+  LV_UNUSED(panel);
+  LV_UNUSED(field_x);
+#endif
+}
+
+void ui_alerts_set_active(uint32_t active_mask)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  if (requested_mask == active_mask)
+    return;
+
+  requested_mask = active_mask;
+  lvgl_setup_wake_task();
+#else
+  LV_UNUSED(active_mask);
+#endif
+}
+
+void ui_alerts_process_updates(void)
+{
+#if CONFIG_TELEMETRY_ALERTS
+  uint32_t mask = requested_mask;
+  if (mask == shown_mask || !blink_timer)
+    return;
+
+  // Newly raised badges light up at once, the blink continues from there
+  shown_mask = mask;
+  blink_on = true;
+  show_badges(true);
+  if (mask)
+  {
+    lv_timer_reset(blink_timer);
+    lv_timer_resume(blink_timer);
+  }
+  else
+  {
+    lv_timer_pause(blink_timer);
+  }
+#endif
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ui_alerts.h
+ * @brief Blinking badges for active telemetry alerts
+ *
+ * Each alerted number field gets a small dot next to its value. Raising or
+ * clearing an alert only shows or hides that dot, and one shared timer
+ * blinks the dots of all active alerts, so an alert invalidates a few
+ * pixels per blink instead of restyling its panel.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "telemetry_alerts.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Badge diameter and its place relative to a ui_metric_tile_create() column
+#define UI_ALERT_BADGE_SIZE 8
+#define UI_ALERT_BADGE_OFFSET_X 98
+#define UI_ALERT_BADGE_Y 84
+
+// Half period of the blink
+#define UI_ALERT_BLINK_MS 500
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Add the badge of an alert to a number field
+ * @param alert Alert the badge shows
+ * @param panel Panel holding the field
+ * @param field_x X position the field was created at
+ * @note LVGL lock held; no-op if CONFIG_TELEMETRY_ALERTS is disabled
+ */
+void ui_alerts_attach(telemetry_alert_t alert, lv_obj_t *panel, int field_x);
+
+/**
+ * @brief Show the alerts of the displayed source
+ * @param active_mask One bit per telemetry_alert_t
+ * @note Safe from any task, applied by the LVGL task
+ */
+void ui_alerts_set_active(uint32_t active_mask);
+
+/**
+ * @brief Apply a pending alert change (LVGL task only, lock held)
+ */
+void ui_alerts_process_updates(void);
@@ -0,0 +1,473 @@
+/**
+ * @file ui_assets.c
+ * @brief LVGL fonts and images from the asset pack
+ *
+ * A font asset is the lv_font_conv C output with its pointers replaced by
+ * offsets from the start of the asset, everything 4-byte aligned:
+ *
+ *   font_blob_header_t
+ *   font_blob_cmap_t[cmap_num]
+ *   kern record (font_blob_kern_classes_t or font_blob_kern_pairs_t)
+ *   tables: glyph bitmaps, glyph descriptors (lv_font_fmt_txt_glyph_dsc_t
+ *           as GCC lays it out, 8 bytes), unicode and glyph id lists,
+ *           kerning tables
+ *
+ * Loading a font allocates lv_font_t, the format descriptor and the cmap
+ * and kern structs (a few hundred bytes) with pointers into the mapping.
+ * Every offset is bounds checked first, a damaged font falls back to the
+ * built-in one.
+ *
+ * The icon atlas "icons/mdi" holds small icons under their MDI names:
+ *
+ *   icon_atlas_header_t
+ *   icon_atlas_entry_t[count], sorted by name hash, then name
+ *   pixels of each icon: RGB565 plane, then A8 plane, 4-byte aligned
+ *
+ * A lookup is a binary search on the FNV-1a hash; the descriptor it
+ * returns points at the planes, which LVGL draws as RGB565A8.
+ *
+ * Fonts and images are created on first use and live until reboot. Only
+ * the LVGL task and boot code before it look assets up, so no lock.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_assets.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define FONT_BLOB_MAGIC 0x544E4644u ///< "DFNT"
+#define FONT_BLOB_VERSION 1
+#define UI_ASSETS_MAX_LOADED 48 ///< Fonts and images created from the pack, room for an icon per entity
+#define ICON_ATLAS_NAME "icons/mdi"
+#define ICON_ATLAS_MAGIC 0x4E434944u ///< "DICN"
+#define ICON_ATLAS_VERSION 1
+#define ICON_ATLAS_NAME_LEN 28     ///< Including terminator
+#define ICON_ATLAS_MAX_SIZE 64     ///< Largest icon side accepted
+#define UI_ASSETS_MAX_ICONS 32     ///< Atlas icons with a descriptor, one per entity and shortcut at most
+
+enum
+{
+  FONT_KERN_NONE = 0,
+  FONT_KERN_CLASSES = 1,
+  FONT_KERN_PAIRS = 2,
+};
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint8_t bpp;
+  uint8_t bitmap_format; ///< 0 plain, 1 and 2 compressed
+  int16_t line_height;
+  int16_t base_line;
+  int8_t underline_position;
+  int8_t underline_thickness;
+  uint16_t kern_scale;
+  uint16_t cmap_num;
+  uint8_t kern_type; ///< FONT_KERN_*
+  uint8_t reserved;
+  uint32_t glyph_count;
+  uint32_t bitmap_offset;
+  uint32_t bitmap_size;
+  uint32_t glyph_dsc_offset;
+  uint32_t cmaps_offset;
+  uint32_t kern_offset;
+} font_blob_header_t;
+
+typedef struct
+{
+  uint32_t range_start;
+  uint16_t range_length;
+  uint16_t glyph_id_start;
+  uint32_t unicode_list_offset;      ///< 0 if none
+  uint32_t glyph_id_ofs_list_offset; ///< 0 if none
+  uint16_t list_length;
+  uint8_t type; ///< lv_font_fmt_txt_cmap_type_t
+  uint8_t reserved;
+} font_blob_cmap_t;
+
+typedef struct
+{
+  uint32_t values_offset; ///< int8_t[left_cnt * right_cnt]
+  uint32_t left_map_offset;
+  uint32_t right_map_offset;
+  uint8_t left_cnt;
+  uint8_t right_cnt;
+  uint16_t reserved;
+} font_blob_kern_classes_t;
+
+typedef struct
+{
+  uint32_t glyph_ids_offset;
+  uint32_t values_offset;
+  uint32_t pair_cnt;
+  uint8_t glyph_ids_size; ///< 0: uint8_t ids, 1: uint16_t ids
+  uint8_t reserved[3];
+} font_blob_kern_pairs_t;
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+} icon_atlas_header_t;
+
+typedef struct
+{
+  uint32_t name_hash;
+  char name[ICON_ATLAS_NAME_LEN]; ///< Without "mdi:", terminated
+  uint16_t w;
+  uint16_t h;
+  uint32_t offset; ///< Of the RGB565 plane from the start of the asset
+} icon_atlas_entry_t;
+
+_Static_assert(sizeof(font_blob_header_t) == 44, "font blob header layout");
+_Static_assert(sizeof(icon_atlas_header_t) == 8, "icon atlas header layout");
+_Static_assert(sizeof(icon_atlas_entry_t) == 40, "icon atlas entry layout");
+_Static_assert(sizeof(font_blob_cmap_t) == 20, "font blob cmap layout");
+_Static_assert(sizeof(lv_font_fmt_txt_glyph_dsc_t) == 8 || LV_FONT_FMT_TXT_LARGE,
+               "glyph descriptors are stored in the small layout");
+
+/** Font with everything that is not in flash */
+typedef struct
+{
+  lv_font_t font;
+  lv_font_fmt_txt_dsc_t dsc;
+  union
+  {
+    lv_font_fmt_txt_kern_classes_t classes;
+    lv_font_fmt_txt_kern_pair_t pairs;
+  } kern;
+  lv_font_fmt_txt_cmap_t cmaps[];
+} loaded_font_t;
+
+typedef struct
+{
+  const char *name; ///< Points into the pack directory
+  const void *object;
+} loaded_asset_t;
+
+static loaded_asset_t loaded[UI_ASSETS_MAX_LOADED];
+static int loaded_count = 0;
+
+// Kept apart from loaded[], atlas names are not asset names
+static loaded_asset_t loaded_icons[UI_ASSETS_MAX_ICONS];
+static int loaded_icon_count = 0;
+static asset_t icon_atlas;
+static bool icon_atlas_checked = false;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static const void *find_loaded(const char *name)
+{
+  for (int i = 0; i < loaded_count; i++)
+  {
+    if (strcmp(loaded[i].name, name) == 0)
+      return loaded[i].object;
+  }
+  return NULL;
+}
+
+static void remember(const char *name, const void *object)
+{
+  if (loaded_count < UI_ASSETS_MAX_LOADED)
+  {
+    loaded[loaded_count++] = (loaded_asset_t){.name = name, .object = object};
+  }
+}
+
+/**
+ * @brief The icon atlas, validated once
+ * @return Header, or NULL if the pack has no usable atlas
+ */
+static const icon_atlas_header_t *get_icon_atlas(void)
+{
+  if (!icon_atlas_checked)
+  {
+    icon_atlas_checked = true;
+    if (asset_pack_find(ICON_ATLAS_NAME, ASSET_TYPE_ICON_ATLAS, &icon_atlas))
+    {
+      const icon_atlas_header_t *header = icon_atlas.data;
+      if (icon_atlas.size < sizeof(*header) || header->magic != ICON_ATLAS_MAGIC ||
+          header->version != ICON_ATLAS_VERSION ||
+          (icon_atlas.size - sizeof(*header)) / sizeof(icon_atlas_entry_t) < header->count)
+      {
+        debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Icon atlas in the asset pack is not usable");
+        icon_atlas.data = NULL;
+      }
+    }
+  }
+  return icon_atlas.data;
+}
+
+/**
+ * @brief Binary search of the atlas index
+ */
+static const icon_atlas_entry_t *find_icon_entry(const icon_atlas_header_t *header, const char *icon)
+{
+  const icon_atlas_entry_t *entries = (const icon_atlas_entry_t *)(header + 1);
+  uint32_t hash = asset_pack_hash(icon);
+  int low = 0;
+  int high = (int)header->count - 1;
+  while (low <= high)
+  {
+    int mid = (low + high) / 2;
+    const icon_atlas_entry_t *e = &entries[mid];
+    int order = e->name_hash < hash ? -1 : e->name_hash > hash ? 1 : strncmp(e->name, icon, ICON_ATLAS_NAME_LEN);
+    if (order == 0)
+      return e;
+    if (order < 0)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Check that a table lies inside the asset and is aligned for its elements
+ */
+static bool table_ok(const asset_t *asset, uint32_t offset, size_t count, size_t elem_size)
+{
+  if (offset == 0 || offset % 4 != 0 || offset > asset->size)
+    return false;
+  return count <= (asset->size - offset) / elem_size;
+}
+
+static const lv_font_t *load_font(const asset_t *asset)
+{
+#if LV_FONT_FMT_TXT_LARGE
+  debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Pack fonts need LV_FONT_FMT_TXT_LARGE off");
+  return NULL;
+#else
+  const uint8_t *base = asset->data;
+  const font_blob_header_t *h = asset->data;
+  if (asset->size < sizeof(*h) || h->magic != FONT_BLOB_MAGIC || h->version != FONT_BLOB_VERSION)
+    return NULL;
+#if !LV_USE_FONT_COMPRESSED
+  if (h->bitmap_format != 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Font %s is compressed, LVGL is built without compressed fonts",
+                        asset->name);
+    return NULL;
+  }
+#endif
+  if (!table_ok(asset, h->bitmap_offset, h->bitmap_size, 1) ||
+      !table_ok(asset, h->glyph_dsc_offset, h->glyph_count, sizeof(lv_font_fmt_txt_glyph_dsc_t)) ||
+      !table_ok(asset, h->cmaps_offset, h->cmap_num, sizeof(font_blob_cmap_t)) || h->cmap_num >= 512)
+    return NULL;
+
+  // Every glyph's bitmap has to start inside the bitmap table
+  const lv_font_fmt_txt_glyph_dsc_t *glyphs = (const void *)(base + h->glyph_dsc_offset);
+  for (uint32_t i = 0; i < h->glyph_count; i++)
+  {
+    if (glyphs[i].bitmap_index > h->bitmap_size)
+      return NULL;
+  }
+
+  loaded_font_t *lf = calloc(1, sizeof(*lf) + h->cmap_num * sizeof(lf->cmaps[0]));
+  if (!lf)
+    return NULL;
+
+  const font_blob_cmap_t *cmaps = (const void *)(base + h->cmaps_offset);
+  for (uint16_t i = 0; i < h->cmap_num; i++)
+  {
+    const font_blob_cmap_t *c = &cmaps[i];
+    lv_font_fmt_txt_cmap_t *out = &lf->cmaps[i];
+    out->range_start = c->range_start;
+    out->range_length = c->range_length;
+    out->glyph_id_start = c->glyph_id_start;
+    out->list_length = c->list_length;
+    out->type = (lv_font_fmt_txt_cmap_type_t)c->type;
+
+    bool ok = c->type <= LV_FONT_FMT_TXT_CMAP_SPARSE_TINY;
+    if (c->unicode_list_offset)
+    {
+      ok = ok && table_ok(asset, c->unicode_list_offset, c->list_length, sizeof(uint16_t));
+      out->unicode_list = (const uint16_t *)(base + c->unicode_list_offset);
+    }
+    if (c->glyph_id_ofs_list_offset)
+    {
+      // Format 0 lists one byte per code point of the range, sparse lists a word per entry
+      size_t elem = c->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL ? sizeof(uint16_t) : sizeof(uint8_t);
+      size_t count = c->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL ? c->range_length : c->list_length;
+      ok = ok && table_ok(asset, c->glyph_id_ofs_list_offset, count, elem);
+      out->glyph_id_ofs_list = base + c->glyph_id_ofs_list_offset;
+    }
+    if (!ok)
+    {
+      free(lf);
+      return NULL;
+    }
+  }
+
+  bool kern_ok = true;
+  const void *kern_dsc = NULL;
+  if (h->kern_type == FONT_KERN_CLASSES)
+  {
+    const font_blob_kern_classes_t *k = (const void *)(base + h->kern_offset);
+    kern_ok = table_ok(asset, h->kern_offset, 1, sizeof(*k)) &&
+              table_ok(asset, k->values_offset, (size_t)k->left_cnt * k->right_cnt, 1) &&
+              table_ok(asset, k->left_map_offset, h->glyph_count, 1) &&
+              table_ok(asset, k->right_map_offset, h->glyph_count, 1);
+    if (kern_ok)
+    {
+      lf->kern.classes.class_pair_values = (const int8_t *)(base + k->values_offset);
+      lf->kern.classes.left_class_mapping = base + k->left_map_offset;
+      lf->kern.classes.right_class_mapping = base + k->right_map_offset;
+      lf->kern.classes.left_class_cnt = k->left_cnt;
+      lf->kern.classes.right_class_cnt = k->right_cnt;
+      kern_dsc = &lf->kern.classes;
+    }
+  }
+  else if (h->kern_type == FONT_KERN_PAIRS)
+  {
+    const font_blob_kern_pairs_t *k = (const void *)(base + h->kern_offset);
+    kern_ok = table_ok(asset, h->kern_offset, 1, sizeof(*k)) && k->glyph_ids_size <= 1 &&
+              table_ok(asset, k->glyph_ids_offset, (size_t)k->pair_cnt * 2, k->glyph_ids_size ? 2 : 1) &&
+              table_ok(asset, k->values_offset, k->pair_cnt, 1);
+    if (kern_ok)
+    {
+      lf->kern.pairs.glyph_ids = base + k->glyph_ids_offset;
+      lf->kern.pairs.values = (const int8_t *)(base + k->values_offset);
+      lf->kern.pairs.pair_cnt = k->pair_cnt;
+      lf->kern.pairs.glyph_ids_size = k->glyph_ids_size;
+      kern_dsc = &lf->kern.pairs;
+    }
+  }
+  if (!kern_ok)
+  {
+    free(lf);
+    return NULL;
+  }
+
+  lf->dsc.glyph_bitmap = base + h->bitmap_offset;
+  lf->dsc.glyph_dsc = glyphs;
+  lf->dsc.cmaps = lf->cmaps;
+  lf->dsc.kern_dsc = kern_dsc;
+  lf->dsc.kern_scale = h->kern_scale;
+  lf->dsc.cmap_num = h->cmap_num;
+  lf->dsc.bpp = h->bpp;
+  lf->dsc.kern_classes = h->kern_type == FONT_KERN_CLASSES;
+  lf->dsc.bitmap_format = h->bitmap_format;
+
+  lf->font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+  lf->font.get_glyph_bitmap = lv_font_get_bitmap_fmt_txt;
+  lf->font.line_height = h->line_height;
+  lf->font.base_line = h->base_line;
+  lf->font.subpx = LV_FONT_SUBPX_NONE;
+  lf->font.underline_position = h->underline_position;
+  lf->font.underline_thickness = h->underline_thickness;
+  lf->font.dsc = &lf->dsc;
+  return &lf->font;
+#endif
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+const lv_font_t *ui_assets_font(const char *name, const lv_font_t *fallback)
+{
+  const lv_font_t *font = find_loaded(name);
+  if (font)
+    return font;
+
+  asset_t asset;
+  if (!asset_pack_find(name, ASSET_TYPE_FONT, &asset))
+    return fallback;
+
+  font = load_font(&asset);
+  if (!font)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Font %s in the asset pack is not usable", name);
+    return fallback;
+  }
+  remember(asset.name, font);
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Font %s from the asset pack (%u bytes in flash)", name,
+                   (unsigned)asset.size);
+  return font;
+}
+
+const lv_image_dsc_t *ui_assets_image(const char *name)
+{
+  const lv_image_dsc_t *image = find_loaded(name);
+  if (image)
+    return image;
+
+  asset_t asset;
+  if (!asset_pack_find(name, ASSET_TYPE_IMAGE, &asset))
+    return NULL;
+
+  const lv_image_header_t *header = asset.data;
+  size_t data_size = asset.size - sizeof(*header);
+  if (asset.size < sizeof(*header) || header->magic != LV_IMAGE_HEADER_MAGIC ||
+      (size_t)header->stride * header->h > data_size)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Image %s in the asset pack is not usable", name);
+    return NULL;
+  }
+
+  lv_image_dsc_t *dsc = calloc(1, sizeof(*dsc));
+  if (!dsc)
+    return NULL;
+  dsc->header = *header;
+  dsc->data_size = data_size;
+  dsc->data = (const uint8_t *)asset.data + sizeof(*header);
+  remember(asset.name, dsc);
+  return dsc;
+}
+
+const lv_image_dsc_t *ui_assets_icon(const char *icon)
+{
+  if (!icon)
+    return NULL;
+  if (strncmp(icon, "mdi:", 4) == 0)
+    icon += 4;
+  if (icon[0] == '\0' || strlen(icon) >= ICON_ATLAS_NAME_LEN)
+    return NULL;
+
+  for (int i = 0; i < loaded_icon_count; i++)
+  {
+    if (strcmp(loaded_icons[i].name, icon) == 0)
+      return loaded_icons[i].object;
+  }
+
+  const icon_atlas_header_t *header = get_icon_atlas();
+  const icon_atlas_entry_t *entry = header ? find_icon_entry(header, icon) : NULL;
+  if (!entry)
+    return NULL;
+
+  size_t pixels = (size_t)entry->w * entry->h;
+  if (entry->w == 0 || entry->h == 0 || entry->w > ICON_ATLAS_MAX_SIZE || entry->h > ICON_ATLAS_MAX_SIZE ||
+      entry->offset % 4 != 0 || entry->offset > icon_atlas.size || icon_atlas.size - entry->offset < pixels * 3)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Atlas icon %s is not usable", icon);
+    return NULL;
+  }
+
+  lv_image_dsc_t *dsc = calloc(1, sizeof(*dsc));
+  if (!dsc)
+    return NULL;
+  dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+  dsc->header.cf = LV_COLOR_FORMAT_RGB565A8;
+  dsc->header.w = entry->w;
+  dsc->header.h = entry->h;
+  dsc->header.stride = entry->w * 2; // Of the RGB565 plane, the A8 plane follows with stride w
+  dsc->data_size = pixels * 3;
+  dsc->data = (const uint8_t *)icon_atlas.data + entry->offset;
+  if (loaded_icon_count < UI_ASSETS_MAX_ICONS)
+    loaded_icons[loaded_icon_count++] = (loaded_asset_t){.name = entry->name, .object = dsc};
+  return dsc;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file ui_assets.h
+ * @brief LVGL fonts and images from the asset pack
+ *
+ * Turns asset pack entries into LVGL objects without copying their data:
+ * an image descriptor points at the pixels in the flash mapping, and a
+ * font gets small RAM descriptors whose glyph bitmaps, glyph metrics,
+ * character maps and kerning tables all stay in flash.
+ *
+ * Fonts are stored by utils/asset_pack.py as a relocatable form of the
+ * lv_font_conv C output (see ui_assets.c), images as LVGL binary images.
+ * Small icons named like the Material Design Icons HA uses ("mdi:fan")
+ * share one atlas asset, so an entity's own HA icon can be drawn without
+ * a pack entry per entity.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Font from the asset pack
+ * @param name Asset name, e.g. "font_dash_title"
+ * @param fallback Returned when the pack has no usable font of that name
+ * @return Pack font, created once and kept until reboot, or fallback
+ */
+const lv_font_t *ui_assets_font(const char *name, const lv_font_t *fallback);
+
+/**
+ * @brief Image from the asset pack
+ * @param name Asset name
+ * @return Descriptor whose data points into flash, or NULL if not in the pack
+ */
+const lv_image_dsc_t *ui_assets_image(const char *name);
+
+/**
+ * @brief Icon from the asset pack icon atlas
+ * @param icon Icon name with or without the "mdi:" prefix, e.g. "water-pump"
+ * @return RGB565A8 descriptor whose data points into flash, or NULL if the atlas has no such icon
+ */
+const lv_image_dsc_t *ui_assets_icon(const char *icon);
@@ -0,0 +1,367 @@
+/**
+ * @file ui_benchmark.c
+ * @brief Reproducible rendering benchmark on the real dashboard
+ *
+ * A short-lived task drives each scene from outside the LVGL task, the
+ * way telemetry and page changes arrive in normal operation, so the
+ * figures include the update mailboxes and wake-ups as well as drawing.
+ * Frame figures come from a display metrics capture spanning the scene;
+ * CPU load is the idle tasks' share of the run-time counters, the LVGL
+ * task's share is reported on its own.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "display_activity.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl_setup.h"
+#include "serial/serial_data_handler.h"
+#include "serial/telemetry_frame.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "ui_dashboard.h"
+#include "ui_pages.h"
+
+#if CONFIG_UI_BENCHMARK
+
+#define BENCH_TELEMETRY_PERIOD_MS 100
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+#define BENCH_PAGE_PERIOD_MS (CONFIG_UI_PAGE_TRANSITION_MS + 250)
+#else
+#define BENCH_PAGE_PERIOD_MS 500
+#endif
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef enum
+{
+  SCENE_FULL_REDRAW,
+  SCENE_LABEL_UPDATE,
+  SCENE_TELEMETRY_10HZ,
+  SCENE_PAGE_TRANSITION,
+  SCENE_COUNT,
+} bench_scene_t;
+
+static const char *const scene_names[SCENE_COUNT] = {
+    [SCENE_FULL_REDRAW] = "full_redraw",
+    [SCENE_LABEL_UPDATE] = "label_update",
+    [SCENE_TELEMETRY_10HZ] = "telemetry_10hz",
+    [SCENE_PAGE_TRANSITION] = "page_transition",
+};
+
+typedef struct
+{
+  int64_t time_us;
+  uint32_t idle[2];
+  uint32_t lvgl;
+} cpu_sample_t;
+
+static portMUX_TYPE bench_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool running = false;
+static int requested_scene = -1; ///< -1 runs every scene
+static void (*done_callback)(void) = NULL;
+static lv_timer_t *redraw_timer = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void make_sample(uint32_t step, system_data_t *s)
+{
+  memset(s, 0, sizeof(*s));
+  s->timestamp = 1760515200000ULL + (uint64_t)step * BENCH_TELEMETRY_PERIOD_MS;
+  s->cpu.usage = (uint8_t)(10 + (step * 37) % 85);
+  s->cpu.temp = (uint8_t)(40 + (step * 13) % 45);
+  s->cpu.fan = (uint16_t)(800 + (step * 97) % 1400);
+  strcpy(s->cpu.name, "Benchmark CPU");
+  s->cpu.cores.count = TELEMETRY_LIST_MAX;
+  for (uint8_t core = 0; core < TELEMETRY_LIST_MAX; core++)
+  {
+    s->cpu.cores.value[core] = (uint8_t)((step * 37 + core * 29) % 100);
+  }
+  s->gpu.usage = (uint8_t)((step * 53) % 100);
+  s->gpu.temp = (uint8_t)(35 + (step * 7) % 50);
+  strcpy(s->gpu.name, "Benchmark GPU");
+  s->gpu.mem_used = 1024 + (step * 331) % 14000;
+  s->gpu.mem_total = 16384;
+  s->mem.usage = (uint8_t)(30 + (step * 11) % 60);
+  s->mem.total = 32.0f;
+  s->mem.used = s->mem.total * s->mem.usage / 100.0f;
+  s->mem.avail = s->mem.total - s->mem.used;
+}
+
+static void cpu_sample(cpu_sample_t *sample, TaskHandle_t lvgl_task)
+{
+  memset(sample, 0, sizeof(*sample));
+  sample->time_us = esp_timer_get_time();
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++)
+  {
+    sample->idle[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+  }
+  sample->lvgl = lvgl_task ? ulTaskGetRunTimeCounter(lvgl_task) : 0;
+#endif
+}
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+// Run-time counters tick in esp_timer microseconds, a delta over wall time is the share of one core
+static uint32_t share_pct(uint32_t delta, int64_t wall_us)
+{
+  return wall_us > 0 ? (uint32_t)((uint64_t)delta * 100 / (uint64_t)wall_us) : 0;
+}
+#endif
+
+static void redraw_timer_cb(lv_timer_t *timer)
+{
+  LV_UNUSED(timer);
+  lv_obj_invalidate(lv_screen_active());
+}
+
+static void scene_begin(bench_scene_t scene)
+{
+  if (scene != SCENE_FULL_REDRAW)
+    return;
+
+  if (lvgl_port_lock(0))
+  {
+    redraw_timer = lv_timer_create(redraw_timer_cb, lvgl_setup_get_refr_period_ms(), NULL);
+    lvgl_port_unlock();
+  }
+}
+
+static void scene_end(bench_scene_t scene)
+{
+  if (scene != SCENE_FULL_REDRAW || !redraw_timer)
+    return;
+
+  if (lvgl_port_lock(0))
+  {
+    lv_timer_delete(redraw_timer);
+    redraw_timer = NULL;
+    lvgl_port_unlock();
+  }
+}
+
+/**
+ * @brief Apply one step of a scene
+ * @return Time until the next step in ms
+ */
+static uint32_t scene_step(bench_scene_t scene, uint32_t step, system_data_t *last)
+{
+  system_data_t sample;
+
+  switch (scene)
+  {
+  case SCENE_LABEL_UPDATE:
+    // Only the CPU temperature changes, one label per frame
+    make_sample(0, last);
+    last->cpu.temp = (uint8_t)(40 + step % 45);
+    ui_dashboard_update(last, SYSTEM_DATA_FIELD_CPU_TEMP);
+    return lvgl_setup_get_refr_period_ms();
+
+  case SCENE_TELEMETRY_10HZ:
+    make_sample(step, &sample);
+    ui_dashboard_update(&sample, step ? telemetry_frame_diff(last, &sample) : SYSTEM_DATA_FIELD_ALL);
+    *last = sample;
+    return BENCH_TELEMETRY_PERIOD_MS;
+
+  case SCENE_PAGE_TRANSITION:
+    ui_pages_show((step & 1) ? 0 : 1);
+    return BENCH_PAGE_PERIOD_MS;
+
+  case SCENE_FULL_REDRAW:
+  default:
+    // The redraw timer does the work, only keep the screen awake
+    return 100;
+  }
+}
+
+static void report_scene(bench_scene_t scene, const lvgl_metrics_t *m, const cpu_sample_t *before,
+                         const cpu_sample_t *after)
+{
+  char reply[384];
+  int len = snprintf(reply, sizeof(reply),
+                     "UI_BENCH {\"scene\":\"%s\",\"mode\":\"%s\",\"ms\":%lu,\"frames\":%lu,\"fps\":%lu.%lu,"
+                     "\"render_us\":{\"avg\":%lu,\"max\":%lu},\"flush_us\":{\"avg\":%lu,\"max\":%lu},"
+                     "\"inv_area_px_avg\":%lu",
+                     scene_names[scene], UI_BENCHMARK_BUFFER_MODE, (unsigned long)m->window_ms, (unsigned long)m->frames,
+                     (unsigned long)(m->fps_x10 / 10), (unsigned long)(m->fps_x10 % 10),
+                     (unsigned long)(m->render_us.count ? m->render_us.sum / m->render_us.count : 0),
+                     (unsigned long)m->render_us.max,
+                     (unsigned long)(m->flush_us.count ? m->flush_us.sum / m->flush_us.count : 0),
+                     (unsigned long)m->flush_us.max,
+                     (unsigned long)(m->inv_area_px.count ? m->inv_area_px.sum / m->inv_area_px.count : 0));
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  int64_t wall_us = after->time_us - before->time_us;
+  uint32_t idle0 = share_pct(after->idle[0] - before->idle[0], wall_us);
+  uint32_t idle1 = share_pct(after->idle[1] - before->idle[1], wall_us);
+  len += snprintf(reply + len, sizeof(reply) - len, ",\"cpu_pct\":[%lu,%lu],\"lvgl_cpu_pct\":%lu}\n",
+                  (unsigned long)(idle0 < 100 ? 100 - idle0 : 0), (unsigned long)(idle1 < 100 ? 100 - idle1 : 0),
+                  (unsigned long)share_pct(after->lvgl - before->lvgl, wall_us));
+#else
+  len += snprintf(reply + len, sizeof(reply) - len, ",\"cpu_pct\":null,\"lvgl_cpu_pct\":null}\n");
+#endif
+  serial_data_write(reply, len < (int)sizeof(reply) ? len : sizeof(reply) - 1);
+}
+
+static void run_scene(bench_scene_t scene, TaskHandle_t lvgl_task)
+{
+  ui_pages_show(0);
+  display_activity_notify_telemetry();
+  vTaskDelay(pdMS_TO_TICKS(UI_BENCHMARK_SETTLE_MS));
+
+  system_data_t last;
+  make_sample(0, &last);
+  cpu_sample_t before;
+  cpu_sample_t after;
+  lvgl_metrics_t metrics;
+
+  scene_begin(scene);
+  cpu_sample(&before, lvgl_task);
+  lvgl_setup_metrics_capture_start();
+
+  TickType_t wake = xTaskGetTickCount();
+  int64_t end_us = before.time_us + (int64_t)UI_BENCHMARK_SCENE_S * 1000000;
+  for (uint32_t step = 0; esp_timer_get_time() < end_us; step++)
+  {
+    uint32_t period_ms = scene_step(scene, step, &last);
+    display_activity_notify_telemetry();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(period_ms) ? pdMS_TO_TICKS(period_ms) : 1);
+  }
+
+  lvgl_setup_metrics_capture_stop(&metrics);
+  cpu_sample(&after, lvgl_task);
+  scene_end(scene);
+  report_scene(scene, &metrics, &before, &after);
+}
+
+static void bench_task(void *arg)
+{
+  LV_UNUSED(arg);
+  TaskHandle_t lvgl_task = xTaskGetHandle("LVGL");
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "UI benchmark started, %s mode", UI_BENCHMARK_BUFFER_MODE);
+  for (int scene = 0; scene < SCENE_COUNT; scene++)
+  {
+    if (requested_scene < 0 || requested_scene == scene)
+    {
+      run_scene((bench_scene_t)scene, lvgl_task);
+    }
+  }
+  ui_pages_show(0);
+
+  static const char done[] = "UI_BENCH {\"done\":true}\n";
+  serial_data_write(done, sizeof(done) - 1);
+  debug_log_info(DEBUG_TAG_UI_DASHBOARD, "UI benchmark finished");
+
+  running = false;
+  if (done_callback)
+    done_callback();
+  vTaskDelete(NULL);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "UI_BENCH {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+#endif // CONFIG_UI_BENCHMARK
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ui_benchmark_start(const char *scene)
+{
+#if CONFIG_UI_BENCHMARK
+  int index = -1;
+  if (scene)
+  {
+    for (int i = 0; i < SCENE_COUNT && index < 0; i++)
+    {
+      if (strcmp(scene, scene_names[i]) == 0)
+        index = i;
+    }
+    if (index < 0)
+      return ESP_ERR_NOT_FOUND;
+  }
+
+  portENTER_CRITICAL(&bench_lock);
+  bool busy = running;
+  running = true;
+  portEXIT_CRITICAL(&bench_lock);
+  if (busy)
+    return ESP_ERR_INVALID_STATE;
+
+  requested_scene = index;
+  if (task_plan_create(TASK_PLAN_UI_BENCH, bench_task, NULL, NULL) != pdPASS)
+  {
+    running = false;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+#else
+  (void)scene;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool ui_benchmark_is_running(void)
+{
+#if CONFIG_UI_BENCHMARK
+  return running;
+#else
+  return false;
+#endif
+}
+
+void ui_benchmark_register_done_callback(void (*callback)(void))
+{
+#if CONFIG_UI_BENCHMARK
+  done_callback = callback;
+#else
+  (void)callback;
+#endif
+}
+
+bool ui_benchmark_handle_command(const char *line)
+{
+#if CONFIG_UI_BENCHMARK
+  const char *scene = NULL;
+  if (strncmp(line, "BENCH_UI ", 9) == 0)
+    scene = line + 9;
+  else if (strcmp(line, "BENCH_UI") != 0)
+    return false;
+
+  esp_err_t ret = ui_benchmark_start(scene);
+  if (ret == ESP_ERR_INVALID_STATE)
+    reply_error("busy");
+  else if (ret == ESP_ERR_NOT_FOUND)
+    reply_error("unknown scene");
+  else if (ret != ESP_OK)
+    reply_error(esp_err_to_name(ret));
+  else
+  {
+    char buf[96];
+    int len = snprintf(buf, sizeof(buf), "UI_BENCH {\"started\":true,\"scenes\":%d,\"scene_s\":%d}\n",
+                       scene ? 1 : SCENE_COUNT, UI_BENCHMARK_SCENE_S);
+    serial_data_write(buf, len);
+  }
+  return true;
+#else
+  (void)line;
+  return false;
+#endif
+}
@@ -0,0 +1,79 @@
+/**
+ * @file ui_benchmark.h
+ * @brief Reproducible rendering benchmark on the real dashboard
+ *
+ * Plays a fixed set of scenes through the live panels and display
+ * pipeline and reports, per scene, frame rate, render and flush time from
+ * the display metrics, and CPU load from the FreeRTOS run-time counters:
+ *
+ *   full_redraw      whole screen invalidated every refresh
+ *   label_update     one value label changed every refresh
+ *   telemetry_10hz   a full synthetic sample every 100 ms
+ *   page_transition  home and next page swapped back and forth
+ *
+ * Samples are generated from the step number and every scene runs for
+ * CONFIG_UI_BENCHMARK_SCENE_S, so runs of the same build are comparable,
+ * and builds that differ only in the LCD buffer mode compare the modes.
+ * Real telemetry is kept off the screen while a run is in progress.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#ifdef CONFIG_UI_BENCHMARK_SCENE_S
+#define UI_BENCHMARK_SCENE_S CONFIG_UI_BENCHMARK_SCENE_S
+#else
+#define UI_BENCHMARK_SCENE_S 5
+#endif
+
+// Quiet time on the home page before each scene, lets the previous one drain
+#define UI_BENCHMARK_SETTLE_MS 500
+
+// LCD buffer mode, reported with every result so runs of two builds compare
+#if CONFIG_EXAMPLE_USE_DOUBLE_FB
+#define UI_BENCHMARK_BUFFER_MODE "double_fb"
+#elif CONFIG_EXAMPLE_USE_BOUNCE_BUFFER
+#define UI_BENCHMARK_BUFFER_MODE "bounce_buffer"
+#else
+#define UI_BENCHMARK_BUFFER_MODE "single_fb"
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Start a run in the background
+ * @param scene Scene name to run alone, NULL for all of them
+ * @return ESP_OK when started, ESP_ERR_INVALID_STATE while a run is in progress,
+ *         ESP_ERR_NOT_FOUND for an unknown scene, ESP_ERR_NOT_SUPPORTED if disabled
+ * @note Each scene is reported as a UI_BENCH line on the serial port
+ */
+esp_err_t ui_benchmark_start(const char *scene);
+
+/**
+ * @brief Whether a run is in progress, the dashboard then ignores real telemetry
+ */
+bool ui_benchmark_is_running(void);
+
+/**
+ * @brief Register a function called when a run ends, e.g. to repaint real telemetry
+ * @param callback Called from the benchmark task, NULL to remove
+ */
+void ui_benchmark_register_done_callback(void (*callback)(void));
+
+/**
+ * @brief Handle BENCH_UI [scene]
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a benchmark command
+ */
+bool ui_benchmark_handle_command(const char *line);
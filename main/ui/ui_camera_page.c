@@ -0,0 +1,148 @@
+/**
+ * @file ui_camera_page.c
+ * @brief Camera snapshot tile, built on first use
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_camera_page.h"
+
+#include <stdio.h>
+#include "smart/ha_camera.h"
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "ui_pages.h"
+
+#define CAMERA_TILE_Y 50
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// LVGL task only
+static lv_draw_buf_t frame_bufs[2];
+static bool frame_bufs_ready = false;
+static lv_obj_t *page_screen = NULL; ///< NULL while the page is not built
+static lv_obj_t *tile = NULL;
+static lv_obj_t *status_label = NULL;
+static uint32_t shown_failures = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Wrap the camera frames once, the draw buffers live as long as they do
+ */
+static bool init_frame_bufs(void)
+{
+  if (frame_bufs_ready)
+    return true;
+
+  uint16_t *frames[2];
+  if (ha_camera_frames(frames) != ESP_OK)
+    return false;
+
+  uint32_t stride = HA_CAMERA_WIDTH * sizeof(uint16_t);
+  for (int i = 0; i < 2; i++)
+  {
+    lv_draw_buf_init(&frame_bufs[i], HA_CAMERA_WIDTH, HA_CAMERA_HEIGHT, LV_COLOR_FORMAT_RGB565, stride, frames[i],
+                     stride * HA_CAMERA_HEIGHT);
+  }
+  frame_bufs_ready = true;
+  return true;
+}
+
+static void update_status(void)
+{
+  ha_camera_stats_t stats;
+  ha_camera_get_stats(&stats);
+  shown_failures = stats.failures;
+
+  char text[96];
+  if (stats.last_error != ESP_OK)
+    snprintf(text, sizeof(text), "Snapshot failed: %s", esp_err_to_name(stats.last_error));
+  else if (stats.frames == 0)
+    snprintf(text, sizeof(text), "Waiting for the first snapshot");
+  else
+    snprintf(text, sizeof(text), "%ux%u snapshot, %lu KB in %lu ms", (unsigned)stats.source_width,
+             (unsigned)stats.source_height, (unsigned long)(stats.last_bytes / 1024),
+             (unsigned long)stats.last_frame_ms);
+  lv_label_set_text(status_label, text);
+}
+
+static void build(lv_obj_t *screen)
+{
+  lv_obj_t *panel = ui_create_panel(screen, 780, 430, 10, 10, 0x1a1a2e, 0x16213e);
+  ui_create_title_with_separator(panel, ha_camera_entity_id(), 0x03a9f4, 750);
+
+  tile = lv_image_create(panel);
+  lv_obj_set_size(tile, HA_CAMERA_WIDTH, HA_CAMERA_HEIGHT);
+  lv_obj_align(tile, LV_ALIGN_TOP_MID, 0, CAMERA_TILE_Y);
+
+  status_label = lv_label_create(panel);
+  lv_obj_add_style(status_label, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(status_label, LV_ALIGN_TOP_MID, 0, CAMERA_TILE_Y + HA_CAMERA_HEIGHT + 10);
+
+  if (init_frame_bufs())
+  {
+    lv_image_set_src(tile, &frame_bufs[ha_camera_acquire_frame(NULL)]);
+    update_status();
+  }
+  else
+  {
+    lv_label_set_text(status_label, "Not enough PSRAM for the camera frames");
+  }
+  page_screen = screen;
+}
+
+static void evict(void)
+{
+  ha_camera_set_active(false);
+  page_screen = NULL;
+  tile = NULL;
+  status_label = NULL;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_camera_page_register(void)
+{
+  if (!ha_camera_configured())
+    return;
+
+  static const ui_page_t page = {
+      .name = "camera",
+      .build = build,
+      .evict = evict,
+  };
+  ui_pages_register(&page);
+}
+
+void ui_camera_page_process_updates(void)
+{
+  if (!page_screen || !frame_bufs_ready)
+    return;
+
+  ha_camera_set_active(lv_screen_active() == page_screen);
+
+  bool swapped = false;
+  int index = ha_camera_acquire_frame(&swapped);
+  if (swapped)
+  {
+    // Same buffer address as two frames ago, the cached decode would be stale
+    lv_image_cache_drop(&frame_bufs[index]);
+    lv_image_set_src(tile, &frame_bufs[index]);
+    update_status();
+  }
+  else
+  {
+    ha_camera_stats_t stats;
+    ha_camera_get_stats(&stats);
+    if (stats.failures != shown_failures)
+      update_status();
+  }
+}
@@ -0,0 +1,26 @@
+/**
+ * @file ui_camera_page.h
+ * @brief Camera snapshot tile, built on first use
+ *
+ * Shows the frames ha_camera decodes. The tile draws one of its two PSRAM
+ * frames straight from an lv_draw_buf, and is pointed at the other one only
+ * once it is complete, so a snapshot never tears. Snapshots are fetched
+ * only while the page is on screen.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+/**
+ * @brief Register the page with ui_pages if a camera is configured
+ * @note LVGL lock held
+ */
+void ui_camera_page_register(void);
+
+/**
+ * @brief Swap in a newly decoded frame, start or stop the snapshots with the
+ *        page's visibility (LVGL task only, lock held)
+ */
+void ui_camera_page_process_updates(void);
@@ -8,10 +8,25 @@
 
 #include "ui_config.h"
 
+#include "ui_assets.h"
+#include "ui_font_cache.h"
+
 // =======================================================================
 // FONT DEFINITIONS
 // =======================================================================
 
+#if CONFIG_UI_SUBSET_FONTS
+// Generated at build time by utils/font_subset.py
+LV_FONT_DECLARE(font_dash_title);
+LV_FONT_DECLARE(font_dash_normal);
+LV_FONT_DECLARE(font_dash_small);
+LV_FONT_DECLARE(font_dash_big_numbers);
+
+const lv_font_t *font_title = &font_dash_title;
+const lv_font_t *font_normal = &font_dash_normal;
+const lv_font_t *font_small = &font_dash_small;
+const lv_font_t *font_big_numbers = &font_dash_big_numbers;
+#else
 #ifdef CONFIG_LV_FONT_MONTSERRAT_28
 const lv_font_t *font_title = &lv_font_montserrat_28; // Large title font (28px)
 #else
@@ -31,3 +46,19 @@ const lv_font_t *font_big_numbers = &lv_font_montserrat_32; // Large numbers (32
 #else
 const lv_font_t *font_big_numbers = &lv_font_montserrat_14; // Fallback to 14px
 #endif
+#endif // CONFIG_UI_SUBSET_FONTS
+
+void ui_config_init_fonts(void)
+{
+  // Fonts in the asset pack replace the built-in ones of the same name
+  font_title = ui_assets_font("font_dash_title", font_title);
+  font_normal = ui_assets_font("font_dash_normal", font_normal);
+  font_small = ui_assets_font("font_dash_small", font_small);
+  font_big_numbers = ui_assets_font("font_dash_big_numbers", font_big_numbers);
+
+  // No-op unless the glyph cache is enabled
+  font_title = ui_font_cache_wrap(font_title);
+  font_normal = ui_font_cache_wrap(font_normal);
+  font_small = ui_font_cache_wrap(font_small);
+  font_big_numbers = ui_font_cache_wrap(font_big_numbers);
+}
@@ -20,12 +20,8 @@ extern const lv_font_t *font_normal;      // Normal text
 extern const lv_font_t *font_small;       // Small text
 extern const lv_font_t *font_big_numbers; // Large numbers
 
-// =======================================================================
-// UI CONSTANTS
-// =======================================================================
-
-// UI Control Labels
-#define UI_CONTROLS_LABEL_A HA_ENTITY_A_LABEL
-#define UI_CONTROLS_LABEL_B HA_ENTITY_B_LABEL
-#define UI_CONTROLS_LABEL_C HA_ENTITY_C_LABEL
-#define UI_CONTROLS_LABEL_D HA_ENTITY_D_LABEL
+/**
+ * @brief Finish font setup, call before any widget uses the fonts
+ * @note Swaps in the glyph caching copies when CONFIG_UI_FONT_GLYPH_CACHE is set
+ */
+void ui_config_init_fonts(void);
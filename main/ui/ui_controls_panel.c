@@ -9,94 +9,310 @@
 #include "ui_controls_panel.h"
 
 #include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "asset_pack.h"
 #include "lvgl_setup.h"
-#include "smart/smart_config.h"
+#include "smart/ha_entity_icons.h"
+#include "smart/ha_entity_registry.h"
 #include "system_debug_utils.h"
+#include "touch_latency.h"
+#include "ui_assets.h"
 #include "ui_config.h"
 #include "ui_helpers.h"
+#include "ui_touch_targets.h"
+
+/** Width of one entity cell in the scrolling row */
+#define ENTITY_CELL_WIDTH 140
+
+/** HA status line, fixed so a new text only invalidates the title cell left of the separator */
+#define HA_STATUS_WIDTH 130
+
+/** Offset of the optional icon from the start of a switch or value cell, icons up to 32 px */
+#define ENTITY_ICON_X 84
+
+/** Opacity of entity widgets that show last-known states */
+#define ENTITY_STALE_OPA LV_OPA_50
+
+/** Brightness and setpoint slider under light and climate cells */
+#define LEVEL_SLIDER_WIDTH 110
+#define LEVEL_SLIDER_HEIGHT 8
+#define LEVEL_SLIDER_Y 35
+
+/** Least time between two commands from one slider while it is dragged */
+#ifdef CONFIG_HA_LEVEL_THROTTLE_MS
+#define LEVEL_THROTTLE_MS CONFIG_HA_LEVEL_THROTTLE_MS
+#else
+#define LEVEL_THROTTLE_MS 250
+#endif
+
+/** Setpoint range of climate sliders in HA's temperature unit, in 0.5 steps */
+#ifdef CONFIG_HA_CLIMATE_MIN_TEMP
+#define CLIMATE_MIN_TEMP CONFIG_HA_CLIMATE_MIN_TEMP
+#define CLIMATE_MAX_TEMP CONFIG_HA_CLIMATE_MAX_TEMP
+#else
+#define CLIMATE_MIN_TEMP 7
+#define CLIMATE_MAX_TEMP 30
+#endif
+
+/** Pushed levels are not applied this long after a send, HA may still echo older values */
+#define LEVEL_SETTLE_MS 1000
+
+/**
+ * @brief Slider of a light or climate cell and its send throttle
+ */
+typedef struct
+{
+  lv_obj_t *slider;
+  lv_timer_t *timer;  ///< Trailing send, NULL when none is due
+  uint32_t sent_tick; ///< lv_tick_get() of the last send
+  int32_t sent_value; ///< Slider value last sent, -1 before the first
+} level_control_t;
 
-static lv_obj_t *switch_a = NULL;
-static lv_obj_t *switch_b = NULL;
-static lv_obj_t *switch_c = NULL;
-static lv_obj_t *scene_button = NULL;
 static lv_obj_t *ha_status_label = NULL;
 
+// Widget per registry index: switch for toggles, button for scenes, value label otherwise
+static lv_obj_t *entity_widgets[HA_REGISTRY_MAX_ENTITIES] = {NULL};
+static level_control_t level_controls[HA_REGISTRY_MAX_ENTITIES];
+static ha_entity_state_t applied_states[HA_REGISTRY_MAX_ENTITIES];
+static bool showing_cached_states = false;
+
+// Icon image per registry index, NULL without an icon; re-resolved when the HA icon names change
+static lv_obj_t *entity_row = NULL;
+static lv_obj_t *entity_icons[HA_REGISTRY_MAX_ENTITIES] = {NULL};
+static uint32_t applied_icons_generation = 0;
+
+// =======================================================================
+// UPDATE MAILBOXES (PRODUCERS OVERWRITE, LVGL TASK DRAINS)
+// =======================================================================
+
+typedef struct
+{
+  bool is_ready;
+  bool is_syncing;
+  char text[64];
+} ha_status_msg_t;
+
+typedef struct
+{
+  int count;
+  bool cached; ///< Last-known states from an earlier run
+  ha_entity_state_t states[HA_REGISTRY_MAX_ENTITIES];
+} entity_states_msg_t;
+
+static QueueHandle_t ha_status_mailbox = NULL;
+static QueueHandle_t entity_states_mailbox = NULL;
+
 // =======================================================================
 // CALLBACK FUNCTION POINTERS (DECOUPLING)
 // =======================================================================
 
 static switch_control_callback_t g_switch_control_callback = NULL;
 static scene_trigger_callback_t g_scene_trigger_callback = NULL;
+static level_control_callback_t g_level_control_callback = NULL;
 
 // =======================================================================
-// SWITCH ENUMERATION AND HELPER TYPES
+// LEVEL SLIDERS
 // =======================================================================
 
-typedef struct
+/**
+ * @brief Slider value for a level: percent for lights, half degrees for climate
+ */
+static int32_t level_to_slider(const ha_entity_record_t *record, float level)
+{
+  if (record->domain == HA_DOMAIN_LIGHT)
+    return (int32_t)((level * 100.0f + 127.0f) / 255.0f);
+  return (int32_t)(level * 2.0f + 0.5f);
+}
+
+static float slider_to_level(const ha_entity_record_t *record, int32_t value)
+{
+  if (record->domain == HA_DOMAIN_LIGHT)
+    return (float)((value * 255 + 50) / 100);
+  return value / 2.0f;
+}
+
+/**
+ * @brief Show a climate state with its setpoint, e.g. "heat 21.5"
+ */
+static void format_climate_text(const ha_entity_state_t *state, float setpoint, char *text, size_t size)
+{
+  int len = ha_entity_state_format(state, text, size);
+  if (len >= 0 && (size_t)len < size)
+    snprintf(text + len, size - len, " %.1f", (double)setpoint);
+}
+
+/**
+ * @brief Send the slider's value unless it was the last one sent
+ */
+static void level_send(int index)
+{
+  const ha_entity_record_t *record = ha_registry_get(index);
+  level_control_t *level = &level_controls[index];
+  int32_t value = lv_slider_get_value(level->slider);
+  if (!record || value == level->sent_value)
+    return;
+
+  if (!g_level_control_callback)
+  {
+    debug_log_error(DEBUG_TAG_UI_CONTROLS, "Level callback not registered - slider changes will not trigger HA requests");
+    return;
+  }
+
+  esp_err_t ret = g_level_control_callback(record->entity_id, slider_to_level(record, value));
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_UI_CONTROLS, "Level of %s failed: %s", record->label, esp_err_to_name(ret));
+    return;
+  }
+  level->sent_value = value;
+  level->sent_tick = lv_tick_get();
+}
+
+static void level_timer_cb(lv_timer_t *timer)
+{
+  int index = (int)(intptr_t)lv_timer_get_user_data(timer);
+  level_controls[index].timer = NULL; // One-shot, LVGL deletes it after this call
+  level_send(index);
+}
+
+/**
+ * @brief Slider event handler, sends at most every LEVEL_THROTTLE_MS and the final value on release
+ * @param e LVGL event object, user data is the registry index
+ */
+static void level_slider_event_handler(lv_event_t *e)
+{
+  lv_event_code_t code = lv_event_get_code(e);
+  void *user_data = lv_event_get_user_data(e);
+  int index = (int)(intptr_t)user_data;
+  const ha_entity_record_t *record = ha_registry_get(index);
+  level_control_t *level = &level_controls[index];
+  if (!record || !level->slider)
+    return;
+
+  if (code == LV_EVENT_VALUE_CHANGED)
+  {
+    if (record->domain == HA_DOMAIN_CLIMATE && applied_states[index].found)
+    {
+      char text[32];
+      format_climate_text(&applied_states[index], slider_to_level(record, lv_slider_get_value(level->slider)), text,
+                          sizeof(text));
+      lv_label_set_text(entity_widgets[index], text);
+    }
+
+    // A pending trailing send picks up the newest value by itself
+    if (level->timer)
+      return;
+    uint32_t elapsed = lv_tick_elaps(level->sent_tick);
+    if (elapsed >= LEVEL_THROTTLE_MS)
+    {
+      level_send(index);
+    }
+    else
+    {
+      level->timer = lv_timer_create(level_timer_cb, LEVEL_THROTTLE_MS - elapsed, user_data);
+      lv_timer_set_repeat_count(level->timer, 1);
+    }
+  }
+  else if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST)
+  {
+    // The final position goes out now, not after the throttle
+    if (level->timer)
+    {
+      lv_timer_delete(level->timer);
+      level->timer = NULL;
+    }
+    level_send(index);
+  }
+}
+
+/**
+ * @brief Create the slider under a light or climate cell
+ */
+static void create_level_slider(lv_obj_t *row, int index, int x)
 {
-  lv_obj_t **switch_obj;
-  const char *label;
-  const char *entity;
-} switch_config_t;
+  const ha_entity_record_t *record = ha_registry_get(index);
+  lv_obj_t *slider = lv_slider_create(row);
+  lv_obj_set_size(slider, LEVEL_SLIDER_WIDTH, LEVEL_SLIDER_HEIGHT);
+  lv_obj_align(slider, LV_ALIGN_LEFT_MID, x, LEVEL_SLIDER_Y);
+  lv_obj_set_ext_click_area(slider, 10);
+  if (record->domain == HA_DOMAIN_LIGHT)
+    lv_slider_set_range(slider, 0, 100);
+  else
+    lv_slider_set_range(slider, CLIMATE_MIN_TEMP * 2, CLIMATE_MAX_TEMP * 2);
+  ui_mark_dynamic(slider);
+
+  void *user_data = (void *)(intptr_t)index;
+  lv_obj_add_event_cb(slider, level_slider_event_handler, LV_EVENT_VALUE_CHANGED, user_data);
+  lv_obj_add_event_cb(slider, level_slider_event_handler, LV_EVENT_RELEASED, user_data);
+  lv_obj_add_event_cb(slider, level_slider_event_handler, LV_EVENT_PRESS_LOST, user_data);
+
+  level_control_t *level = &level_controls[index];
+  level->slider = slider;
+  level->timer = NULL;
+  level->sent_value = -1;
+}
 
-// Switch configuration table
-static const switch_config_t switch_configs[3] = {
-    {&switch_a, UI_CONTROLS_LABEL_A, HA_ENTITY_A_ID},
-    {&switch_b, UI_CONTROLS_LABEL_B, HA_ENTITY_B_ID},
-    {&switch_c, UI_CONTROLS_LABEL_C, HA_ENTITY_C_ID}};
+/**
+ * @brief Whether an incoming level would fight the user's finger
+ */
+static bool level_busy(const level_control_t *level)
+{
+  return lv_obj_has_state(level->slider, LV_STATE_PRESSED) || level->timer ||
+         (level->sent_value >= 0 && lv_tick_elaps(level->sent_tick) < LEVEL_SETTLE_MS);
+}
 
 // =======================================================================
 // LOCAL EVENT HANDLERS
 // =======================================================================
 
+#if CONFIG_SYSTEM_DEBUG_TRACE
 /**
- * @brief Debug touch handler for logging UI touch events
+ * @brief Trace presses on a control, user data is the registry index
  */
 static void debug_touch_handler(lv_event_t *e)
 {
-  (void)e; // Suppress unused parameter warning
+  debug_trace_event_t event = (lv_event_get_code(e) == LV_EVENT_PRESSED) ? DEBUG_TRACE_UI_PRESSED
+                                                                         : DEBUG_TRACE_UI_RELEASED;
+  DEBUG_TRACE(DEBUG_TAG_UI_CONTROLS, DEBUG_TRACE_LEVEL_EVENT, event, (intptr_t)lv_event_get_user_data(e), 0);
 }
+#endif
 
 /**
  * @brief Generic switch event handler
- * @param e LVGL event object
+ * @param e LVGL event object, user data is the registry index
  */
 static void switch_event_handler(lv_event_t *e)
 {
   lv_event_code_t code = lv_event_get_code(e);
   lv_obj_t *obj = lv_event_get_target(e);
+  const ha_entity_record_t *config = ha_registry_get((int)(intptr_t)lv_event_get_user_data(e));
 
-  // Find which switch was triggered
-  switch_id_t switch_id = SWITCH_A;
-  for (int i = 0; i < 3; i++)
-  {
-    if (obj == *switch_configs[i].switch_obj)
-    {
-      switch_id = i;
-      break;
-    }
-  }
-
-  const switch_config_t *config = &switch_configs[switch_id];
-
-  if (code == LV_EVENT_VALUE_CHANGED)
+  if (code == LV_EVENT_VALUE_CHANGED && config)
   {
+    touch_latency_mark_dispatch();
     bool state = lv_obj_has_state(obj, LV_STATE_CHECKED);
     debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Switch %s state changed to %s", config->label, state ? "ON" : "OFF");
 
-    // Control the actual device via registered callback (decoupled)
+    // Control the actual device via registered callback (decoupled, only queues the request)
     if (g_switch_control_callback != NULL)
     {
-      debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Calling switch control callback for %s", config->entity);
-      esp_err_t ret = g_switch_control_callback(config->entity, state);
+      debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Calling switch control callback for %s", config->entity_id);
+      esp_err_t ret = g_switch_control_callback(config->entity_id, state);
       if (ret != ESP_OK)
       {
         debug_log_error_f(DEBUG_TAG_UI_CONTROLS, "Switch %s control failed: %s", config->label, esp_err_to_name(ret));
-        // TODO: Consider reverting the switch state on failure
+        // The request never went out, undo the toggle. Failures reported
+        // later by HA are rolled back through controls_panel_set_entity_states()
+        if (state)
+          lv_obj_clear_state(obj, LV_STATE_CHECKED);
+        else
+          lv_obj_add_state(obj, LV_STATE_CHECKED);
       }
       else
       {
-        debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Switch %s control succeeded", config->label);
+        debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Switch %s control queued", config->label);
       }
     }
     else
@@ -108,27 +324,29 @@ static void switch_event_handler(lv_event_t *e)
 
 /**
  * @brief Scene button event handler
+ * @param e LVGL event object, user data is the registry index
  */
 static void scene_button_event_handler(lv_event_t *e)
 {
   lv_event_code_t code = lv_event_get_code(e);
+  const ha_entity_record_t *config = ha_registry_get((int)(intptr_t)lv_event_get_user_data(e));
 
-  if (code == LV_EVENT_CLICKED)
+  if (code == LV_EVENT_CLICKED && config)
   {
-    debug_log_info(DEBUG_TAG_UI_CONTROLS, "Scene button pressed");
+    debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Scene button %s pressed", config->label);
 
     // Trigger the scene via registered callback (decoupled)
     if (g_scene_trigger_callback != NULL)
     {
       debug_log_info(DEBUG_TAG_UI_CONTROLS, "Calling scene trigger callback");
-      esp_err_t ret = g_scene_trigger_callback();
+      esp_err_t ret = g_scene_trigger_callback(config->entity_id);
       if (ret != ESP_OK)
       {
         debug_log_error_f(DEBUG_TAG_UI_CONTROLS, "Scene trigger failed: %s", esp_err_to_name(ret));
       }
       else
       {
-        debug_log_info(DEBUG_TAG_UI_CONTROLS, "Scene triggered successfully");
+        debug_log_info(DEBUG_TAG_UI_CONTROLS, "Scene trigger queued");
       }
     }
     else
@@ -138,8 +356,216 @@ static void scene_button_event_handler(lv_event_t *e)
   }
 }
 
+// =======================================================================
+// ENTITY WIDGETS
+// =======================================================================
+
+/**
+ * @brief Create the scene button of one cell
+ */
+static lv_obj_t *create_scene_button(lv_obj_t *parent, const char *label_text, int x_offset)
+{
+  lv_obj_t *button = lv_btn_create(parent);
+  lv_obj_set_size(button, 120, 50);
+  lv_obj_align(button, LV_ALIGN_LEFT_MID, x_offset, 0);
+  lv_obj_set_style_bg_color(button, lv_color_hex(0x4caf50), 0);
+  lv_obj_set_style_radius(button, 10, 0);
+  ui_mark_dynamic(button);
+
+  lv_obj_t *label = lv_label_create(button);
+  lv_label_set_text(label, label_text);
+  lv_obj_add_style(label, ui_get_text_style(font_normal, 0xffffff), 0);
+  lv_obj_center(label);
+  return button;
+}
+
+/**
+ * @brief Create a read-only value field (sensors, climate), returns the value label
+ */
+static lv_obj_t *create_value_field(lv_obj_t *parent, const char *label_text, int x_offset)
+{
+  lv_obj_t *label = lv_label_create(parent);
+  lv_label_set_text(label, label_text);
+  lv_obj_add_style(label, ui_get_text_style(font_small, 0xcccccc), 0);
+  lv_obj_align(label, LV_ALIGN_LEFT_MID, x_offset, -25);
+
+  lv_obj_t *value = lv_label_create(parent);
+  lv_label_set_text(value, "--");
+  lv_obj_add_style(value, ui_get_text_style(font_normal, 0xffffff), 0);
+  lv_obj_align(value, LV_ALIGN_LEFT_MID, x_offset, 10);
+  ui_mark_dynamic(value);
+  return value;
+}
+
+/**
+ * @brief Icon of an entity from the asset pack: "icon/<entity_id>", else its HA
+ *        icon from the icon atlas, else "icon/<domain>"
+ */
+static const lv_image_dsc_t *find_entity_icon(int index)
+{
+  const ha_entity_record_t *record = ha_registry_get(index);
+  char name[ASSET_PACK_NAME_LEN];
+  const lv_image_dsc_t *icon = NULL;
+  if (snprintf(name, sizeof(name), "icon/%s", record->entity_id) < (int)sizeof(name))
+    icon = ui_assets_image(name);
+  if (!icon && ha_entity_icons_get(index, name, sizeof(name)))
+    icon = ui_assets_icon(name);
+  if (!icon)
+  {
+    snprintf(name, sizeof(name), "icon/%s", ha_registry_domain_name(record->domain));
+    icon = ui_assets_image(name);
+  }
+  return icon;
+}
+
+/**
+ * @brief Show, change or remove the icon of an entity cell
+ *
+ * The image is drawn straight from the flash mapping, nothing is decoded.
+ */
+static void update_entity_icon(int index)
+{
+  const lv_image_dsc_t *icon = find_entity_icon(index);
+  lv_obj_t *image = entity_icons[index];
+  if (!icon)
+  {
+    if (image)
+      lv_obj_delete(image);
+    entity_icons[index] = NULL;
+    return;
+  }
+
+  if (!image)
+  {
+    image = lv_image_create(entity_row);
+    lv_obj_align(image, LV_ALIGN_LEFT_MID, index * ENTITY_CELL_WIDTH + 10 + ENTITY_ICON_X, 10);
+    entity_icons[index] = image;
+  }
+  if (lv_image_get_src(image) != icon)
+    lv_image_set_src(image, icon);
+}
+
+/**
+ * @brief Create the widget of one registry entity in its cell
+ */
+static void create_entity_widget(lv_obj_t *row, int index)
+{
+  const ha_entity_record_t *record = ha_registry_get(index);
+  int x = index * ENTITY_CELL_WIDTH + 10;
+  void *user_data = (void *)(intptr_t)index;
+  lv_obj_t *widget;
+
+  if (ha_registry_is_toggle(record->domain))
+  {
+    widget = ui_create_switch_field(row, record->label, x);
+    lv_obj_add_event_cb(widget, switch_event_handler, LV_EVENT_VALUE_CHANGED, user_data);
+  }
+  else if (record->domain == HA_DOMAIN_SCENE)
+  {
+    widget = create_scene_button(row, record->label, x);
+    lv_obj_add_event_cb(widget, scene_button_event_handler, LV_EVENT_CLICKED, user_data);
+  }
+  else
+  {
+    widget = create_value_field(row, record->label, x);
+  }
+  if (record->domain == HA_DOMAIN_LIGHT || record->domain == HA_DOMAIN_CLIMATE)
+  {
+    create_level_slider(row, index, x);
+  }
+  // Scene buttons fill their cell
+  if (record->domain != HA_DOMAIN_SCENE)
+  {
+    update_entity_icon(index);
+  }
+#if CONFIG_SYSTEM_DEBUG_TRACE
+  // Only the two codes of interest, an LV_EVENT_ALL handler runs for every draw event too
+  lv_obj_add_event_cb(widget, debug_touch_handler, LV_EVENT_PRESSED, user_data);
+  lv_obj_add_event_cb(widget, debug_touch_handler, LV_EVENT_RELEASED, user_data);
+#endif
+  entity_widgets[index] = widget;
+
+  // Vertical separator after the cell
+  if (index < ha_registry_count() - 1)
+  {
+    ui_create_centered_vertical_separator(row, (index + 1) * ENTITY_CELL_WIDTH - 10, 60, 0x555555);
+  }
+}
+
+/**
+ * @brief Apply one entity state to its widget if it changed
+ */
+static void apply_entity_state(int index, const ha_entity_state_t *state)
+{
+  const ha_entity_record_t *record = ha_registry_get(index);
+  ha_entity_state_t *applied = &applied_states[index];
+  lv_obj_t *widget = entity_widgets[index];
+
+  if (!record || !widget || !state->found || record->domain == HA_DOMAIN_SCENE)
+    return;
+  if (applied->found && ha_entity_state_same(applied, state))
+    return;
+
+  // While a slider is dragged or its command settles, its level and text stay as the user set them
+  level_control_t *level = &level_controls[index];
+  bool hold_level = level->slider && level_busy(level);
+
+  if (ha_registry_is_toggle(record->domain))
+  {
+    if (!applied->found || applied->is_on != state->is_on)
+    {
+      if (state->is_on)
+        lv_obj_add_state(widget, LV_STATE_CHECKED);
+      else
+        lv_obj_clear_state(widget, LV_STATE_CHECKED);
+    }
+  }
+  else if (!hold_level)
+  {
+    char text[32];
+    if (record->domain == HA_DOMAIN_CLIMATE && state->has_level)
+      format_climate_text(state, state->value, text, sizeof(text));
+    else
+      ha_entity_state_format(state, text, sizeof(text));
+    lv_label_set_text(widget, text);
+  }
+
+  if (level->slider && state->has_level && !hold_level)
+  {
+    lv_slider_set_value(level->slider, level_to_slider(record, state->value), LV_ANIM_OFF);
+  }
+
+  *applied = *state;
+  if (hold_level)
+  {
+    // Not all shown, the next update is applied in full
+    applied->found = false;
+  }
+}
+
+/**
+ * @brief Dim or undim every entity widget except scene buttons
+ * @param stale True while the widgets show last-known states
+ */
+static void set_entities_stale(bool stale)
+{
+  for (int i = 0; i < HA_REGISTRY_MAX_ENTITIES; i++)
+  {
+    const ha_entity_record_t *record = ha_registry_get(i);
+    if (entity_widgets[i] && record && record->domain != HA_DOMAIN_SCENE)
+    {
+      lv_obj_set_style_opa(entity_widgets[i], stale ? ENTITY_STALE_OPA : LV_OPA_COVER, 0);
+    }
+    if (level_controls[i].slider)
+    {
+      lv_obj_set_style_opa(level_controls[i].slider, stale ? ENTITY_STALE_OPA : LV_OPA_COVER, 0);
+    }
+  }
+  showing_cached_states = stale;
+}
+
 /**
- * @brief Create the control panel with smart home switches and scene button
+ * @brief Create the control panel with one widget per registry entity
  * @param parent Parent screen object
  * @return Created control panel
  */
@@ -150,98 +576,89 @@ lv_obj_t *create_controls_panel(lv_obj_t *parent)
   // Controls title (moved up)
   lv_obj_t *controls_title = lv_label_create(control_panel);
   lv_label_set_text(controls_title, "Controls");
-  lv_obj_set_style_text_font(controls_title, font_title, 0);
-  lv_obj_set_style_text_color(controls_title, lv_color_hex(0x4fc3f7), 0);
+  lv_obj_add_style(controls_title, ui_get_text_style(font_title, 0x4fc3f7), 0);
   lv_obj_align(controls_title, LV_ALIGN_TOP_LEFT, 0, 5);
 
   // HA status text below title
   ha_status_label = lv_label_create(control_panel);
   lv_label_set_text(ha_status_label, "HA: Connecting...");
-  lv_obj_set_style_text_font(ha_status_label, font_small, 0);
-  lv_obj_set_style_text_color(ha_status_label, lv_color_hex(0x888888), 0);
+  lv_obj_add_style(ha_status_label, ui_get_text_style(font_small, 0x888888), 0);
   lv_obj_align(ha_status_label, LV_ALIGN_TOP_LEFT, 0, 40);
+  lv_obj_set_width(ha_status_label, HA_STATUS_WIDTH);
+  lv_label_set_long_mode(ha_status_label, LV_LABEL_LONG_DOT);
+  ui_mark_dynamic(ha_status_label);
 
-  // Better spacing layout: Title section (140px) + 3 switches (120px each) + separators + button section
-  // Total: 140 + 120*3 + 4*10 + 120 = 140 + 360 + 40 + 120 = 660px (fits in 780px panel)
+  // Layout: title section (140px) + one 140px cell per registry entity;
+  // four cells fit the panel, more scroll horizontally
 
   // Vertical separator after controls title
   ui_create_centered_vertical_separator(control_panel, 140, 60, 0x4fc3f7);
 
-  // Switch A field - positioned with better spacing
-  switch_a = ui_create_switch_field(control_panel, UI_CONTROLS_LABEL_A, 160);
-  lv_obj_add_event_cb(switch_a, debug_touch_handler, LV_EVENT_ALL, NULL);
-  lv_obj_add_event_cb(switch_a, switch_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
-  lv_obj_add_event_cb(switch_a, switch_event_handler, LV_EVENT_CLICKED, NULL);
-
-  // Vertical separator after switch A
-  ui_create_centered_vertical_separator(control_panel, 280, 60, 0x555555);
-
-  // Switch B field - proper spacing from separator
-  switch_b = ui_create_switch_field(control_panel, UI_CONTROLS_LABEL_B, 300);
-  lv_obj_add_event_cb(switch_b, debug_touch_handler, LV_EVENT_ALL, NULL);
-  lv_obj_add_event_cb(switch_b, switch_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
-  lv_obj_add_event_cb(switch_b, switch_event_handler, LV_EVENT_CLICKED, NULL);
-
-  // Vertical separator after switch B
-  ui_create_centered_vertical_separator(control_panel, 420, 60, 0x555555);
-
-  // Switch C field - proper spacing from separator
-  switch_c = ui_create_switch_field(control_panel, UI_CONTROLS_LABEL_C, 440);
-  lv_obj_add_event_cb(switch_c, debug_touch_handler, LV_EVENT_ALL, NULL);
-  lv_obj_add_event_cb(switch_c, switch_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
-  lv_obj_add_event_cb(switch_c, switch_event_handler, LV_EVENT_CLICKED, NULL);
-
-  // Vertical separator before scene button
-  ui_create_centered_vertical_separator(control_panel, 560, 60, 0x555555);
-
-  // Scene button (right with proper padding, centered using align API)
-  scene_button = lv_btn_create(control_panel);
-  lv_obj_set_size(scene_button, 120, 50);
-  lv_obj_align(scene_button, LV_ALIGN_RIGHT_MID, -20, 0); // 20px margin from right edge
-  lv_obj_set_style_bg_color(scene_button, lv_color_hex(0x4caf50), 0);
-  lv_obj_set_style_radius(scene_button, 10, 0);
-  lv_obj_add_event_cb(scene_button, debug_touch_handler, LV_EVENT_ALL, NULL);
-  lv_obj_add_event_cb(scene_button, scene_button_event_handler, LV_EVENT_CLICKED, NULL);
-
-  lv_obj_t *scene_label = lv_label_create(scene_button);
-  lv_label_set_text(scene_label, UI_CONTROLS_LABEL_D);
-  lv_obj_set_style_text_font(scene_label, font_normal, 0);
-  lv_obj_set_style_text_color(scene_label, lv_color_hex(0xffffff), 0);
-  lv_obj_center(scene_label);
+  entity_row = lv_obj_create(control_panel);
+  lv_obj_remove_style_all(entity_row);
+  lv_obj_set_size(entity_row, 780 - 150 - 30, 100);
+  lv_obj_align(entity_row, LV_ALIGN_LEFT_MID, 150, 0);
+  lv_obj_set_scroll_dir(entity_row, LV_DIR_HOR);
+  lv_obj_set_scrollbar_mode(entity_row, LV_SCROLLBAR_MODE_OFF);
+  ui_touch_targets_track_scroll(entity_row);
+  // Holds the live widgets, a cached panel background must not swallow it
+  ui_mark_dynamic(entity_row);
+
+  applied_icons_generation = ha_entity_icons_generation();
+  for (int i = 0; i < ha_registry_count(); i++)
+  {
+    create_entity_widget(entity_row, i);
+  }
+
+  if (!ha_status_mailbox)
+  {
+    ha_status_mailbox = xQueueCreate(1, sizeof(ha_status_msg_t));
+    entity_states_mailbox = xQueueCreate(1, sizeof(entity_states_msg_t));
+  }
   return control_panel;
 }
 
 /**
- * @brief Generic function to set switch state
- * @param switch_id Which switch to control (SWITCH_A, SWITCH_B, SWITCH_C)
- * @param state True to turn on, false to turn off
+ * @brief Queue entity states for the LVGL task
+ * @param states States indexed like the registry
+ * @param count Number of states
  */
-void controls_panel_set_switch(int switch_id, bool state)
+static void queue_entity_states(const ha_entity_state_t *states, int count, bool cached)
 {
-  if (switch_id < 0 || switch_id >= SWITCH_COUNT || !*switch_configs[switch_id].switch_obj)
-    return;
+  entity_states_msg_t msg;
 
-  if (!lvgl_port_lock(300)) // Use timeout-based lock to prevent deadlocks
-  {
-    debug_log_warning(DEBUG_TAG_UI_CONTROLS, "Could not acquire LVGL lock for switch set (timeout)");
+  if (!entity_states_mailbox || !states || count <= 0)
     return;
-  }
+  if (count > HA_REGISTRY_MAX_ENTITIES)
+    count = HA_REGISTRY_MAX_ENTITIES;
+
+  // Only the latest snapshot matters, an undrained one is replaced
+  msg.count = count;
+  msg.cached = cached;
+  memcpy(msg.states, states, count * sizeof(ha_entity_state_t));
+  xQueueOverwrite(entity_states_mailbox, &msg);
+  lvgl_setup_wake_task();
+}
 
-  if (state)
-    lv_obj_add_state(*switch_configs[switch_id].switch_obj, LV_STATE_CHECKED);
-  else
-    lv_obj_clear_state(*switch_configs[switch_id].switch_obj, LV_STATE_CHECKED);
-  lvgl_port_unlock();
+void controls_panel_set_entity_states(const ha_entity_state_t *states, int count)
+{
+  queue_entity_states(states, count, false);
+}
+
+void controls_panel_show_cached_states(const ha_entity_state_t *states, int count)
+{
+  queue_entity_states(states, count, true);
 }
 
 /**
  * @brief Generic function to get switch state
- * @param switch_id Which switch to query (SWITCH_A, SWITCH_B, SWITCH_C)
- * @return True if on, false if off
+ * @param index Registry index of a toggle entity
+ * @return True if on, false if off or not a switch
  */
-bool controls_panel_get_switch(int switch_id)
+bool controls_panel_get_switch(int index)
 {
-  if (switch_id < 0 || switch_id >= SWITCH_COUNT || !*switch_configs[switch_id].switch_obj)
+  const ha_entity_record_t *record = ha_registry_get(index);
+  if (!record || !ha_registry_is_toggle(record->domain) || !entity_widgets[index])
     return false;
 
   bool state = false;
@@ -251,50 +668,79 @@ bool controls_panel_get_switch(int switch_id)
     return false;
   }
 
-  state = lv_obj_has_state(*switch_configs[switch_id].switch_obj, LV_STATE_CHECKED);
+  state = lv_obj_has_state(entity_widgets[index], LV_STATE_CHECKED);
   lvgl_port_unlock();
   return state;
 }
 
 void controls_panel_update_ha_status(bool is_ready, bool is_syncing, const char *status_text)
 {
-  static uint32_t last_update_time = 0;
-  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  if (!ha_status_mailbox || !status_text)
+    return;
+
+  // Bursts of status changes collapse into the latest one, nothing waits on the LVGL lock
+  ha_status_msg_t msg = {.is_ready = is_ready, .is_syncing = is_syncing};
+  strlcpy(msg.text, status_text, sizeof(msg.text));
+  xQueueOverwrite(ha_status_mailbox, &msg);
+  lvgl_setup_wake_task();
+}
 
-  // Throttle HA status updates to max 5 Hz (200ms minimum interval) to reduce LVGL lock contention
-  if (current_time - last_update_time < 200)
+void controls_panel_process_updates(void)
+{
+  static entity_states_msg_t states_msg; // LVGL task only
+
+  if (entity_states_mailbox && xQueueReceive(entity_states_mailbox, &states_msg, 0) == pdTRUE)
   {
-    return; // Skip update if too soon since last update
+    for (int i = 0; i < states_msg.count; i++)
+    {
+      apply_entity_state(i, &states_msg.states[i]);
+    }
+    if (states_msg.cached != showing_cached_states)
+    {
+      set_entities_stale(states_msg.cached);
+    }
+  }
+
+  // HA icon names arrive once per boot, after the panel showed the cached ones
+  uint32_t icons_generation = ha_entity_icons_generation();
+  if (entity_row && icons_generation != applied_icons_generation)
+  {
+    applied_icons_generation = icons_generation;
+    for (int i = 0; i < ha_registry_count(); i++)
+    {
+      if (ha_registry_get(i)->domain != HA_DOMAIN_SCENE)
+        update_entity_icon(i);
+    }
   }
 
-  if (!ha_status_label || !status_text)
+  ha_status_msg_t msg;
+  if (!ha_status_mailbox || !ha_status_label || xQueueReceive(ha_status_mailbox, &msg, 0) != pdTRUE)
     return;
 
-  // Try to acquire LVGL lock with timeout to avoid deadlocks
-  if (!lvgl_port_lock(300)) // Increased timeout to 300ms
+  // Setting the same text or color again would still invalidate the label
+  if (strcmp(lv_label_get_text(ha_status_label), msg.text) != 0)
   {
-    debug_log_warning(DEBUG_TAG_UI_CONTROLS, "Could not acquire LVGL lock for HA status update (timeout)");
-    return;
+    lv_label_set_text(ha_status_label, msg.text);
   }
 
-  lv_label_set_text(ha_status_label, status_text);
-
   // Set color based on connection status
-  if (is_syncing)
+  lv_color_t color;
+  if (msg.is_syncing)
   {
-    lv_obj_set_style_text_color(ha_status_label, lv_color_hex(0x00bcd4), 0); // Light Blue Syncing
+    color = lv_color_hex(0x00bcd4); // Light Blue Syncing
   }
-  else if (is_ready)
+  else if (msg.is_ready)
   {
-    lv_obj_set_style_text_color(ha_status_label, lv_color_hex(0x00ff88), 0); // Green
+    color = lv_color_hex(0x00ff88); // Green
   }
   else
   {
-    lv_obj_set_style_text_color(ha_status_label, lv_color_hex(0xff4444), 0); // Red
+    color = lv_color_hex(0xff4444); // Red
+  }
+  if (!lv_color_eq(lv_obj_get_style_text_color(ha_status_label, 0), color))
+  {
+    lv_obj_set_style_text_color(ha_status_label, color, 0);
   }
-
-  lvgl_port_unlock();
-  last_update_time = current_time;
 }
 
 // =======================================================================
@@ -315,6 +761,7 @@ void controls_panel_register_event_callbacks(const smart_home_callbacks_t *callb
 
   g_switch_control_callback = callbacks->switch_callback;
   g_scene_trigger_callback = callbacks->scene_callback;
+  g_level_control_callback = callbacks->level_callback;
 
   debug_log_info_f(DEBUG_TAG_UI_CONTROLS, "Event callbacks registered - switch: %p, scene: %p",
                    (void *)callbacks->switch_callback, (void *)callbacks->scene_callback);
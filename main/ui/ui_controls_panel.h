@@ -10,18 +10,10 @@
 
 #include <stdbool.h>
 #include "lvgl.h"
-
-// Switch identifiers for generic functions
-typedef enum
-{
-  SWITCH_A = 0,
-  SWITCH_B = 1,
-  SWITCH_C = 2,
-  SWITCH_COUNT
-} switch_id_t;
+#include "smart/smart_home.h"
 
 /**
- * @brief Create the control panel with smart home switches and scene button
+ * @brief Create the control panel with one widget per registered HA entity
  * @param parent Parent screen object
  * @return Created control panel object
  */
@@ -35,23 +27,37 @@ lv_obj_t *create_controls_panel(lv_obj_t *parent);
  */
 void controls_panel_update_ha_status(bool is_ready, bool is_syncing, const char *status_text);
 
+/**
+ * @brief Apply queued HA status and entity state updates (LVGL task only, lock held)
+ */
+void controls_panel_process_updates(void);
+
 // =======================================================================
 // SMART HOME CONTROL FUNCTIONS
 // =======================================================================
 
 /**
- * @brief Set the state of any switch
- * @param switch_id Switch identifier (0=A, 1=B, 2=C)
- * @param state True to turn on, false to turn off
+ * @brief Queue the states of all registered entities for display
+ * @param states States indexed like the entity registry
+ * @param count Number of states
+ * @note Safe from any task, only widgets whose state changed are redrawn
  */
-void controls_panel_set_switch(int switch_id, bool state);
+void controls_panel_set_entity_states(const ha_entity_state_t *states, int count);
 
 /**
- * @brief Get the state of any switch
- * @param switch_id Switch identifier (0=A, 1=B, 2=C)
- * @return True if on, false if off
+ * @brief Queue last-known states from an earlier run, dimmed until HA reports
+ * @param states States indexed like the entity registry
+ * @param count Number of states
+ * @note Safe from any task, the next controls_panel_set_entity_states() undims them
  */
-bool controls_panel_get_switch(int switch_id);
+void controls_panel_show_cached_states(const ha_entity_state_t *states, int count);
+
+/**
+ * @brief Get the state of a switch
+ * @param index Registry index of a switch or light entity
+ * @return True if on, false if off or not a toggle entity
+ */
+bool controls_panel_get_switch(int index);
 
 // =======================================================================
 // EVENT CALLBACK REGISTRATION (DECOUPLING)
@@ -61,15 +67,26 @@ bool controls_panel_get_switch(int switch_id);
  * @brief Callback function type for switch control
  * @param entity_id Home Assistant entity ID
  * @param state True to turn on, false to turn off
- * @return ESP_OK on success, error code on failure
+ * @return ESP_OK if the request was accepted, error code on failure
+ * @note Called from the LVGL task, must not block on network I/O
  */
 typedef esp_err_t (*switch_control_callback_t)(const char *entity_id, bool state);
 
 /**
  * @brief Callback function type for scene trigger
+ * @param entity_id Home Assistant scene entity ID
  * @return ESP_OK on success, error code on failure
  */
-typedef esp_err_t (*scene_trigger_callback_t)(void);
+typedef esp_err_t (*scene_trigger_callback_t)(const char *entity_id);
+
+/**
+ * @brief Callback function type for brightness and setpoint sliders
+ * @param entity_id Home Assistant light or climate entity ID
+ * @param level Brightness 0-255 or target temperature
+ * @return ESP_OK if the request was accepted, error code on failure
+ * @note Called from the LVGL task at most every HA_LEVEL_THROTTLE_MS per slider
+ */
+typedef esp_err_t (*level_control_callback_t)(const char *entity_id, float level);
 
 /**
  * @brief Smart home callback structure for UI decoupling
@@ -78,6 +95,7 @@ typedef struct
 {
   switch_control_callback_t switch_callback; /**< Function to call when switch state changes */
   scene_trigger_callback_t scene_callback;   /**< Function to call when scene button is pressed */
+  level_control_callback_t level_callback;   /**< Function to call when a slider moves */
 } smart_home_callbacks_t;
 
 /**
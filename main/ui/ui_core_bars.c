@@ -0,0 +1,164 @@
+/**
+ * @file ui_core_bars.c
+ * @brief Per-core CPU usage strip drawn as one widget
+ *
+ * The strip keeps a copy of the values it last invalidated for and draws
+ * from that copy, so what is on screen and what was invalidated always
+ * agree. Bars share the strip width evenly; the draw handler skips bars
+ * outside the clip area, so a single changed core redraws a single column.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_core_bars.h"
+
+#include <string.h>
+#include "ui_helpers.h"
+
+#if CONFIG_UI_CORE_BARS
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  lv_color_t cool;
+  lv_color_t hot;
+  telemetry_u8_list_t shown; ///< Values on screen
+} core_bars_t;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Column of one core, with a one pixel gap to the next when the bars are wide enough
+ */
+static lv_area_t bar_slot(const lv_area_t *coords, uint8_t count, uint8_t index)
+{
+  int32_t width = lv_area_get_width(coords);
+  lv_area_t slot = {
+      .x1 = coords->x1 + index * width / count,
+      .y1 = coords->y1,
+      .x2 = coords->x1 + (index + 1) * width / count - 1,
+      .y2 = coords->y2,
+  };
+  if (slot.x2 - slot.x1 >= 2)
+    slot.x2--;
+  return slot;
+}
+
+static int32_t bar_top(const lv_area_t *coords, uint8_t value)
+{
+  int32_t height = lv_area_get_height(coords);
+  int32_t filled = (height * LV_MIN(value, 100) + 50) / 100;
+  return coords->y2 + 1 - filled;
+}
+
+static void core_bars_event_cb(lv_event_t *e)
+{
+  lv_obj_t *obj = lv_event_get_current_target(e);
+  core_bars_t *b = lv_obj_get_user_data(obj);
+
+  if (lv_event_get_code(e) == LV_EVENT_DELETE)
+  {
+    lv_free(b);
+    return;
+  }
+
+  lv_layer_t *layer = lv_event_get_layer(e);
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+
+  lv_draw_rect_dsc_t rect;
+  lv_draw_rect_dsc_init(&rect);
+  rect.bg_opa = LV_OPA_COVER;
+
+  for (uint8_t i = 0; i < b->shown.count; i++)
+  {
+    lv_area_t bar = bar_slot(&coords, b->shown.count, i);
+    if (bar.x2 < layer->_clip_area.x1 || bar.x1 > layer->_clip_area.x2)
+      continue;
+
+    uint8_t value = b->shown.value[i];
+    bar.y1 = bar_top(&coords, value);
+    if (bar.y1 > bar.y2)
+      continue;
+
+    rect.bg_color = lv_color_mix(b->hot, b->cool, (uint8_t)(LV_MIN(value, 100) * 255 / 100));
+    lv_draw_rect(layer, &rect, &bar);
+  }
+}
+
+static void core_bars_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+  lv_obj_t *obj = lv_observer_get_target_obj(observer);
+  core_bars_t *b = lv_observer_get_user_data(observer);
+  const telemetry_u8_list_t *list = lv_subject_get_pointer(subject);
+
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+
+  if (list->count != b->shown.count)
+  {
+    // Every bar changes width
+    lv_obj_invalidate(obj);
+  }
+  else
+  {
+    // Only the part of a column between the old and the new top changes, plus the color below it
+    for (uint8_t i = 0; i < list->count; i++)
+    {
+      if (list->value[i] == b->shown.value[i])
+        continue;
+
+      lv_area_t column = bar_slot(&coords, list->count, i);
+      column.y1 = LV_MIN(bar_top(&coords, list->value[i]), bar_top(&coords, b->shown.value[i]));
+      lv_obj_invalidate_area(obj, &column);
+    }
+  }
+
+  b->shown = *list;
+}
+
+#endif // CONFIG_UI_CORE_BARS
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+lv_obj_t *ui_core_bars_create(lv_obj_t *parent, ui_data_field_t field, int x, int y, int width, int height,
+                              uint32_t cool_color, uint32_t hot_color)
+{
+#if CONFIG_UI_CORE_BARS
+  if (!parent || width < TELEMETRY_LIST_MAX || height < 2)
+    return NULL;
+
+  // Lives as long as the dashboard, freed with the object
+  core_bars_t *b = lv_malloc_zeroed(sizeof(core_bars_t));
+  if (!b)
+    return NULL;
+  b->cool = lv_color_hex(cool_color);
+  b->hot = lv_color_hex(hot_color);
+
+  lv_obj_t *obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_pos(obj, x, y);
+  lv_obj_set_size(obj, width, height);
+
+  // Faint track behind the bars, drawn by the object itself as one rectangle
+  lv_obj_set_style_bg_color(obj, b->cool, 0);
+  lv_obj_set_style_bg_opa(obj, LV_OPA_10, 0);
+
+  lv_obj_set_user_data(obj, b);
+  lv_obj_add_event_cb(obj, core_bars_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+  lv_obj_add_event_cb(obj, core_bars_event_cb, LV_EVENT_DELETE, NULL);
+  ui_data_bind_list(obj, field, core_bars_observer_cb, b);
+  return obj;
+#else
+  return NULL;
+#endif
+}
@@ -0,0 +1,39 @@
+/**
+ * @file ui_core_bars.h
+ * @brief Per-core CPU usage strip drawn as one widget
+ *
+ * One bar per core, as tall as its usage and colored from cool to hot.
+ * All bars belong to a single LVGL object and are drawn by its own draw
+ * handler, so 32 cores cost one object instead of 32 bars with their
+ * styles, layout and heap. A new sample only invalidates the columns of
+ * the cores whose value changed.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "ui_data_binding.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create a core usage strip bound to a list field
+ * @param parent Parent panel
+ * @param field List data field with one percentage per core
+ * @param x X position
+ * @param y Y position
+ * @param width Width in pixels, shared evenly by the cores
+ * @param height Height in pixels, a bar at 100% fills it
+ * @param cool_color Bar color at 0% (hex)
+ * @param hot_color Bar color at 100% (hex)
+ * @return Widget, NULL if disabled in menuconfig or out of memory
+ * @note LVGL lock held; the strip stays empty while the host sends no per-core values
+ */
+lv_obj_t *ui_core_bars_create(lv_obj_t *parent, ui_data_field_t field, int x, int y, int width, int height,
+                              uint32_t cool_color, uint32_t hot_color);
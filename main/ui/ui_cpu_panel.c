@@ -9,14 +9,13 @@
 
 #include "ui_cpu_panel.h"
 
-#include <stdio.h>
+#include "ui_alerts.h"
 #include "ui_config.h"
+#include "ui_core_bars.h"
+#include "ui_data_binding.h"
 #include "ui_helpers.h"
-
-static lv_obj_t *cpu_name_label = NULL;
-static lv_obj_t *cpu_usage_label = NULL;
-static lv_obj_t *cpu_temp_label = NULL;
-static lv_obj_t *cpu_fan_label = NULL;
+#include "ui_metric_tile.h"
+#include "ui_sparkline.h"
 
 /**
  * @brief Create the CPU monitoring panel
@@ -31,81 +30,28 @@ lv_obj_t *create_cpu_panel(lv_obj_t *parent)
   ui_create_title_with_separator(cpu_panel, "CPU", 0x4fc3f7, 355);
 
   // CPU Name (positioned to the right of title, baseline aligned)
-  cpu_name_label = ui_create_device_name(cpu_panel, "Unknown CPU", 80, font_small, 0x808080);
-
-  // Create CPU fields - Temperature first
-  cpu_temp_label = ui_create_field(cpu_panel, "Temp", "--°C", 10, font_normal, font_big_numbers, 0xaaaaaa, 0xff7043);
-  cpu_usage_label = ui_create_field(cpu_panel, "Usage", "--%", 128, font_normal, font_big_numbers, 0xaaaaaa, 0x4fc3f7);
-  cpu_fan_label = ui_create_field(cpu_panel, "Fan (RPM)", "--", 246, font_normal, font_big_numbers, 0xaaaaaa, 0x81c784);
-
-  // Create vertical separators between fields
-  ui_create_vertical_separator(cpu_panel, 118, 50, 60, 0x555555);
-  ui_create_vertical_separator(cpu_panel, 236, 50, 60, 0x555555);
-
-  return cpu_panel;
-}
-
-/**
- * @brief Update CPU panel with new data
- * @param cpu_data Pointer to CPU monitoring data from system_data_t
- */
-void update_cpu_panel(const void *cpu_data)
-{
-  if (!cpu_data)
-    return;
+  lv_obj_t *cpu_name_label = ui_create_device_name(cpu_panel, "Unknown CPU", 80, font_small, 0x808080);
+  ui_data_bind_text(cpu_name_label, UI_DATA_CPU_NAME);
 
-  // Cast void* to the actual struct type
-  const struct cpu_info *cpu = (const struct cpu_info *)cpu_data;
+  // Create CPU fields - Temperature first, each tile draws its caption, value and separator
+  lv_obj_t *cpu_temp_label = ui_metric_tile_create(cpu_panel, "Temp", "--°C", 10, 109, font_normal, font_big_numbers, 0xaaaaaa, 0xff7043, true);
+  lv_obj_t *cpu_usage_label = ui_metric_tile_create(cpu_panel, "Usage", "--%", 128, 109, font_normal, font_big_numbers, 0xaaaaaa, 0x4fc3f7, true);
+  lv_obj_t *cpu_fan_label = ui_metric_tile_create(cpu_panel, "Fan (RPM)", "--", 246, 109, font_normal, font_big_numbers, 0xaaaaaa, 0x81c784, false);
 
-  if (cpu_name_label)
-  {
-    lv_label_set_text(cpu_name_label, cpu->name);
-  }
+  // Labels follow the published subjects, they are only redrawn when a value changes
+  ui_data_bind_label(cpu_temp_label, UI_DATA_CPU_TEMP, "%d°C", "--°C");
+  ui_data_bind_label(cpu_usage_label, UI_DATA_CPU_USAGE, "%d%%", "--%");
+  ui_data_bind_label(cpu_fan_label, UI_DATA_CPU_FAN, "%d", "--");
 
-  if (cpu_usage_label)
-  {
-    char usage_str[16];
-    snprintf(usage_str, sizeof(usage_str), "%d%%", cpu->usage);
-    lv_label_set_text(cpu_usage_label, usage_str);
-  }
+  // Badges blink while a threshold alert is active
+  ui_alerts_attach(TELEMETRY_ALERT_CPU_TEMP, cpu_panel, 10);
+  ui_alerts_attach(TELEMETRY_ALERT_CPU_USAGE, cpu_panel, 128);
 
-  if (cpu_temp_label)
-  {
-    char temp_str[16];
-    snprintf(temp_str, sizeof(temp_str), "%d°C", cpu->temp);
-    lv_label_set_text(cpu_temp_label, temp_str);
-  }
+  // Recent usage next to the Usage caption
+  ui_sparkline_create(cpu_panel, TELEMETRY_METRIC_CPU_USAGE, 180, 57, 44, 16, 0x4fc3f7, 100);
 
-  if (cpu_fan_label)
-  {
-    char fan_str[16];
-    snprintf(fan_str, sizeof(fan_str), "%d", cpu->fan);
-    lv_label_set_text(cpu_fan_label, fan_str);
-  }
-}
+  // Per-core usage between the title separator and the field captions
+  ui_core_bars_create(cpu_panel, UI_DATA_CPU_CORES, 0, 39, 355, 12, 0x4fc3f7, 0xff7043);
 
-/**
- * @brief Reset CPU panel to default values (no connection)
- */
-void reset_cpu_panel(void)
-{
-  if (cpu_name_label)
-  {
-    lv_label_set_text(cpu_name_label, "No Connection");
-  }
-
-  if (cpu_usage_label)
-  {
-    lv_label_set_text(cpu_usage_label, "--%");
-  }
-
-  if (cpu_temp_label)
-  {
-    lv_label_set_text(cpu_temp_label, "--°C");
-  }
-
-  if (cpu_fan_label)
-  {
-    lv_label_set_text(cpu_fan_label, "--");
-  }
+  return cpu_panel;
 }
@@ -18,36 +18,148 @@
 #include "ui_dashboard.h"
 
 #include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "display_activity.h"
 #include "lvgl_setup.h"
 #include "smart/ha_api.h"
 #include "smart/smart_config.h"
+#include "shared_state.h"
 #include "system_debug_utils.h"
+#include "ui_alerts.h"
+#include "ui_camera_page.h"
 #include "ui_config.h"
 #include "ui_cpu_panel.h"
+#include "ui_data_binding.h"
 #include "ui_gpu_panel.h"
 #include "ui_helpers.h"
+#include "ui_layout.h"
 #include "ui_memory_panel.h"
+#include "ui_night_page.h"
+#include "ui_pages.h"
+#include "ui_perf_page.h"
+#include "ui_sensor_page.h"
+#include "ui_shortcuts_page.h"
+#include "ui_sparkline.h"
 #include "ui_status_info.h"
+#include "ui_system_page.h"
+#include "ui_touch_targets.h"
 #include <time.h>
 
+// Latest telemetry frame, copied lock-free by the LVGL task. Producers in several tasks
+// write it under pending_fields_lock; the sequence of the frame last taken tells a new one apart
+static system_data_t latest_frame;
+static seqlock_t latest_frame_seq = SEQLOCK_INIT;
+static uint32_t taken_frame_seq = 0; // LVGL task only
+
+// Pending reset request, drained by the LVGL task
+static QueueHandle_t dashboard_reset_mailbox = NULL;
+
+// Changed-field bits of frames not yet published (frames overwrite each other, masks accumulate)
+static uint32_t pending_changed_fields = 0;
+static bool pending_frame_cached = false; // Latest frame is last-known, not live
+static portMUX_TYPE pending_fields_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Values are dimmed while the shown frame is last-known or its sample is too old
+static bool shown_frame_cached = false;
+static volatile bool data_age_stale = false;
+
+// Applies the newest telemetry at most once per display refresh, paused while nothing is queued
+static lv_timer_t *telemetry_apply_timer = NULL;
+
+static void ui_dashboard_process_updates(void);
+static void ui_dashboard_apply_telemetry(lv_timer_t *timer);
+
+/**
+ * @brief Replace the latest frame, the caller holds pending_fields_lock
+ */
+static void store_latest_frame(const system_data_t *data)
+{
+  seqlock_write_begin(&latest_frame_seq);
+  latest_frame = *data;
+  seqlock_write_end(&latest_frame_seq);
+}
+
+/**
+ * @brief Copy the latest frame if it is newer than the one taken last
+ * @return false if no frame was written since
+ */
+static bool take_latest_frame(system_data_t *data)
+{
+  uint32_t seq;
+  do
+  {
+    seq = seqlock_read_begin(&latest_frame_seq);
+    if (seq == taken_frame_seq)
+      return false;
+    *data = latest_frame;
+  } while (seqlock_read_retry(&latest_frame_seq, seq));
+
+  taken_frame_seq = seq;
+  return true;
+}
+
 /**
  * @brief Create the complete dashboard UI
  * @param disp LVGL display handle
  */
 void ui_dashboard_create(lv_display_t *disp)
 {
+  ui_config_init_fonts();
+
   // Initialize LVGL theme with dark mode and blue/red accents
   lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_BLUE), lv_palette_main(LV_PALETTE_RED),
                         LV_THEME_DEFAULT_DARK, font_normal);
 
   lv_obj_t *screen = lv_display_get_screen_active(disp);
 
-  // Create all UI panels (smart panel at top, status panel at bottom)
-  create_controls_panel(screen);
-  create_cpu_panel(screen);
-  create_gpu_panel(screen);
-  create_memory_panel(screen);
-  create_status_info_panel(screen);
+  // Subjects must exist before the panels bind their widgets to them
+  ui_data_binding_init();
+
+  // Create all UI panels, then place them once where the active layout says
+  lv_obj_t *panels[UI_LAYOUT_PANEL_COUNT] = {
+      [UI_LAYOUT_PANEL_CONTROLS] = create_controls_panel(screen),
+      [UI_LAYOUT_PANEL_CPU] = create_cpu_panel(screen),
+      [UI_LAYOUT_PANEL_GPU] = create_gpu_panel(screen),
+      [UI_LAYOUT_PANEL_MEMORY] = create_memory_panel(screen),
+      [UI_LAYOUT_PANEL_STATUS] = create_status_info_panel(screen),
+  };
+  ui_layout_load();
+  ui_layout_apply(panels);
+
+#if CONFIG_UI_CACHE_PANEL_BACKGROUNDS
+  // Static panel parts are rendered once, only live widgets are drawn per frame afterwards
+  for (size_t i = 0; i < UI_LAYOUT_PANEL_COUNT; i++)
+  {
+    if (!ui_layout_is_shown(i))
+      continue;
+    esp_err_t ret = ui_cache_panel_background(panels[i]);
+    if (ret != ESP_OK)
+    {
+      debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Panel %u background not cached: %s", (unsigned)i, esp_err_to_name(ret));
+    }
+  }
+#else
+  (void)panels;
+#endif
+
+  dashboard_reset_mailbox = xQueueCreate(1, sizeof(uint8_t));
+  if (!dashboard_reset_mailbox)
+  {
+    debug_log_error(DEBUG_TAG_UI_DASHBOARD, "Failed to create dashboard reset mailbox");
+  }
+  telemetry_apply_timer = lv_timer_create(ui_dashboard_apply_telemetry, lvgl_setup_get_refr_period_ms(), NULL);
+  lv_timer_pause(telemetry_apply_timer);
+  lvgl_setup_register_update_handler(ui_dashboard_process_updates);
+
+  // The dashboard is the home page, the others are built when first opened
+  ui_pages_init(screen);
+  ui_system_page_register();
+  ui_perf_page_register();
+  ui_sensor_page_register();
+  ui_shortcuts_page_register();
+  ui_camera_page_register();
+  ui_night_page_register();
 
   debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Dashboard UI created successfully");
 }
@@ -55,55 +167,147 @@ void ui_dashboard_create(lv_display_t *disp)
 /**
  * @brief Update all dashboard display elements with new data
  * @param data Pointer to system monitoring data structure
- * @note This function is thread-safe and handles LVGL mutex locking
+ * @param changed_fields SYSTEM_DATA_FIELD_* mask of fields that changed
+ * @note Thread-safe and non-blocking: the frame replaces any not yet drawn one
  */
-void ui_dashboard_update(const system_data_t *data)
+void ui_dashboard_update(const system_data_t *data, uint32_t changed_fields)
 {
-  static uint32_t last_update_time = 0;
-  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  if (!data)
+    return;
 
-  // Throttle updates to max 10 Hz (100ms minimum interval)
-  if (current_time - last_update_time < 100)
-  {
-    return; // Skip update if too soon since last update
-  }
+  // Mask and frame change together; the consumer may see bits early, never late
+  portENTER_CRITICAL(&pending_fields_lock);
+  pending_changed_fields |= changed_fields;
+  pending_frame_cached = false;
+  store_latest_frame(data);
+  portEXIT_CRITICAL(&pending_fields_lock);
+
+  lvgl_setup_wake_task();
+}
 
+void ui_dashboard_show_cached(const system_data_t *data)
+{
   if (!data)
     return;
 
-  if (!lvgl_port_lock(500)) // Increased timeout to 500ms
+  // A live frame already waiting is newer, keep it
+  portENTER_CRITICAL(&pending_fields_lock);
+  bool live_pending = pending_changed_fields != 0 && !pending_frame_cached;
+  if (!live_pending)
   {
-    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Could not acquire LVGL lock for dashboard update (timeout)");
-    return;
+    pending_changed_fields = SYSTEM_DATA_FIELD_ALL;
+    pending_frame_cached = true;
+    store_latest_frame(data);
   }
+  portEXIT_CRITICAL(&pending_fields_lock);
 
-  update_cpu_panel(&data->cpu);
-  update_gpu_panel(&data->gpu);
-  update_memory_panel(&data->mem);
-  lvgl_port_unlock();
-
-  last_update_time = current_time;
+  if (!live_pending)
+  {
+    lvgl_setup_wake_task();
+  }
 }
 
 /**
  * @brief Reset dashboard display to default values when serial connection is lost
- * @note This function is thread-safe and handles LVGL mutex locking
+ * @note Thread-safe and non-blocking, applied by the LVGL task
  */
+void ui_dashboard_set_data_stale(bool stale)
+{
+  if (data_age_stale == stale)
+    return;
+
+  data_age_stale = stale;
+  lvgl_setup_wake_task();
+}
+
 void ui_dashboard_reset_to_defaults(void)
 {
-  if (!lvgl_port_lock(500)) // Increased timeout to 500ms
-  {
-    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Could not acquire LVGL lock for dashboard reset (timeout)");
+  if (!dashboard_reset_mailbox)
     return;
+
+  uint8_t request = 1;
+  xQueueOverwrite(dashboard_reset_mailbox, &request);
+  lvgl_setup_wake_task();
+}
+
+/**
+ * @brief Apply all queued UI updates, runs in the LVGL task with the lock held
+ */
+static void ui_dashboard_process_updates(void)
+{
+  // Telemetry waits for the apply timer: frames arriving faster than the display refreshes
+  // overwrite each other, and only the newest is published
+  bool telemetry_queued = seqlock_sequence(&latest_frame_seq) != taken_frame_seq ||
+                          (dashboard_reset_mailbox && uxQueueMessagesWaiting(dashboard_reset_mailbox));
+  if (telemetry_queued && telemetry_apply_timer)
+  {
+    bool active = display_activity_get_state() == DISPLAY_ACTIVITY_ACTIVE;
+    lv_timer_set_period(telemetry_apply_timer, active ? lvgl_setup_get_refr_period_ms() : DISPLAY_IDLE_REFR_PERIOD_MS);
+    lv_timer_resume(telemetry_apply_timer);
+  }
+
+  ui_data_binding_set_stale(shown_frame_cached || data_age_stale);
+
+  controls_panel_process_updates();
+  ui_sensor_page_process_updates();
+  ui_shortcuts_page_process_updates();
+  ui_camera_page_process_updates();
+  status_info_process_updates();
+  ui_alerts_process_updates();
+  ui_pages_process_updates();
+  ui_touch_targets_process_updates();
+}
+
+/**
+ * @brief Publish the newest telemetry snapshot, runs at most once per refresh period
+ * @param timer Apply timer, paused again until the next frame is queued
+ */
+static void ui_dashboard_apply_telemetry(lv_timer_t *timer)
+{
+  // Everything is published after startup and after a reset, placeholders must all be replaced
+  static bool publish_all = true;
+
+  uint8_t reset_request;
+  if (dashboard_reset_mailbox && xQueueReceive(dashboard_reset_mailbox, &reset_request, 0) == pdTRUE)
+  {
+    ui_data_binding_reset();
+    shown_frame_cached = false;
+    ui_data_binding_set_stale(data_age_stale);
+    ui_sparkline_reset();
+    publish_all = true;
+    debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Dashboard reset to default values");
   }
 
-  // Use individual panel reset functions for cleaner implementation
-  reset_cpu_panel();
-  reset_gpu_panel();
-  reset_memory_panel();
-  lvgl_port_unlock();
+  portENTER_CRITICAL(&pending_fields_lock);
+  uint32_t changed_fields = pending_changed_fields;
+  bool frame_cached = pending_frame_cached;
+  pending_changed_fields = 0;
+  portEXIT_CRITICAL(&pending_fields_lock);
+
+  // Only the newest frame is published, and only the fields that changed since the last one
+  static system_data_t data;
+  if (take_latest_frame(&data))
+  {
+    // A last-known frame leaves publish_all set, the first live one replaces all of it
+    if (publish_all)
+    {
+      changed_fields = SYSTEM_DATA_FIELD_ALL;
+      publish_all = frame_cached;
+    }
+    ui_data_binding_publish(&data, changed_fields);
+    shown_frame_cached = frame_cached;
+    ui_data_binding_set_stale(frame_cached || data_age_stale);
+  }
+  else if (changed_fields)
+  {
+    // Frame already taken on an earlier pass, keep the bits for the next one
+    portENTER_CRITICAL(&pending_fields_lock);
+    pending_changed_fields |= changed_fields;
+    portEXIT_CRITICAL(&pending_fields_lock);
+  }
 
-  debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Dashboard reset to default values");
+  ui_sparkline_process_updates();
+  lv_timer_pause(timer);
 }
 
 /**
@@ -113,5 +317,6 @@ void ui_dashboard_reset_to_defaults(void)
 void ui_dashboard_register_smart_home_callbacks(const smart_home_callbacks_t *callbacks)
 {
   controls_panel_register_event_callbacks(callbacks);
+  ui_shortcuts_page_set_trigger_callback(callbacks->scene_callback);
   debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Smart home callbacks registered with UI dashboard");
 }
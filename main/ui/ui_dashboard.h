@@ -38,8 +38,23 @@ void ui_dashboard_create(lv_display_t *disp);
 /**
  * @brief Update dashboard display with new data
  * @param data System monitoring data
+ * @param changed_fields SYSTEM_DATA_FIELD_* mask of fields that changed
  */
-void ui_dashboard_update(const system_data_t *data);
+void ui_dashboard_update(const system_data_t *data, uint32_t changed_fields);
+
+/**
+ * @brief Show a last-known frame, dimmed until the first live frame replaces it
+ * @param data Frame stored by an earlier run
+ * @note Thread-safe and non-blocking, like ui_dashboard_update()
+ */
+void ui_dashboard_show_cached(const system_data_t *data);
+
+/**
+ * @brief Dim the shown values because the newest sample is too old
+ * @param stale True while the sample's real age is above the stale limit
+ * @note Thread-safe and non-blocking, applied by the LVGL task
+ */
+void ui_dashboard_set_data_stale(bool stale);
 
 /**
  * @brief Reset dashboard display to default values when serial connection is lost
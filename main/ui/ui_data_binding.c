@@ -0,0 +1,389 @@
+/**
+ * @file ui_data_binding.c
+ * @brief Observer Binding for System Monitoring Data
+ *
+ * Subjects are only written when a value differs from the published one,
+ * so LVGL observers (and with them label invalidations) run on change only.
+ *
+ * With CONFIG_UI_VALUE_TRANSITIONS, integer labels and bars ease towards a
+ * new value instead of jumping. One shared LVGL timer steps every running
+ * transition once per display refresh, and a widget is only touched when
+ * its rounded displayed value changes.
+ */
+
+#include "ui_data_binding.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "lvgl_setup.h"
+#include "ui_digits.h"
+#include "ui_helpers.h"
+
+#define UI_DATA_STRING_LEN 48
+
+// Opacity of widgets that show last-known values
+#define UI_DATA_STALE_OPA LV_OPA_50
+
+// Integer bindings that can ease, later ones jump to new values
+#define UI_DATA_MAX_TRANSITIONS 16
+
+// Fixed point scale of the easing curve
+#define EASE_ONE 1024
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  lv_obj_t *obj;
+  const char *format; ///< NULL for a bar
+  const char *placeholder;
+  int32_t shown; ///< Value on screen, UI_DATA_NO_VALUE for the placeholder
+  int32_t from;
+  int32_t to;
+  uint32_t start_tick;
+  bool eased;  ///< Stepped by the transition timer
+  bool active; ///< Transition running
+} int_binding_t;
+
+static lv_subject_t subjects[UI_DATA_FIELD_COUNT];
+static lv_subject_t stale_subject; // 1 while the values are last-known
+static char string_values[UI_DATA_FIELD_COUNT][UI_DATA_STRING_LEN];
+static telemetry_u8_list_t list_values[UI_DATA_FIELD_COUNT]; // What the pointer subjects of list fields point to
+static bool binding_initialized = false;
+
+#if CONFIG_UI_VALUE_TRANSITIONS
+static int_binding_t *transitions[UI_DATA_MAX_TRANSITIONS];
+static size_t transition_count = 0;
+static lv_timer_t *transition_timer = NULL;
+#endif
+
+static const char *const string_placeholders[UI_DATA_FIELD_COUNT] = {
+    [UI_DATA_CPU_NAME] = "Unknown CPU",
+    [UI_DATA_GPU_NAME] = "Unknown GPU",
+    [UI_DATA_MEM_INFO] = "(-.- GB / -.- GB)",
+};
+
+static const bool list_fields[UI_DATA_FIELD_COUNT] = {
+#define UI_DATA_LIST_FIELD(ID, SECTION, field, key, TYPE, unit, history, ui) \
+  TELEMETRY_IF_UI_LIST(ui, [UI_DATA_##ID] = true, )
+    TELEMETRY_SCHEMA(UI_DATA_LIST_FIELD)
+#undef UI_DATA_LIST_FIELD
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static bool is_string_field(ui_data_field_t field)
+{
+  return string_placeholders[field] != NULL;
+}
+
+static bool is_int_field(ui_data_field_t field)
+{
+  return !is_string_field(field) && !list_fields[field];
+}
+
+static void publish_int(ui_data_field_t field, int32_t value)
+{
+  if (lv_subject_get_int(&subjects[field]) != value)
+  {
+    lv_subject_set_int(&subjects[field], value);
+  }
+}
+
+static void publish_string(ui_data_field_t field, const char *value)
+{
+  if (strncmp(lv_subject_get_string(&subjects[field]), value, UI_DATA_STRING_LEN - 1) != 0)
+  {
+    lv_subject_copy_string(&subjects[field], value);
+  }
+}
+
+static void publish_list(ui_data_field_t field, const telemetry_u8_list_t *value)
+{
+  telemetry_u8_list_t *shown = &list_values[field];
+  if (shown->count != value->count || memcmp(shown->value, value->value, value->count) != 0)
+  {
+    *shown = *value;
+    lv_subject_notify(&subjects[field]);
+  }
+}
+
+static void int_binding_show(int_binding_t *binding, int32_t value)
+{
+  binding->shown = value;
+  if (!binding->format)
+  {
+    lv_bar_set_value(binding->obj, value == UI_DATA_NO_VALUE ? 0 : value, LV_ANIM_OFF);
+  }
+  else if (value == UI_DATA_NO_VALUE)
+  {
+    ui_digits_set_text(binding->obj, binding->placeholder);
+  }
+  else
+  {
+    char text[16];
+    snprintf(text, sizeof(text), binding->format, (int)value);
+    ui_digits_set_text(binding->obj, text);
+  }
+}
+
+#if CONFIG_UI_VALUE_TRANSITIONS
+static int32_t ease_out(const int_binding_t *binding, uint32_t elapsed)
+{
+  // Cubic ease-out: 1 - (1 - t)^3
+  int32_t rest = EASE_ONE - (int32_t)(elapsed * EASE_ONE / CONFIG_UI_VALUE_TRANSITION_MS);
+  int32_t eased = EASE_ONE - rest * rest / EASE_ONE * rest / EASE_ONE;
+  int64_t delta = (int64_t)(binding->to - binding->from) * eased;
+  return binding->from + (int32_t)((delta + (delta < 0 ? -EASE_ONE / 2 : EASE_ONE / 2)) / EASE_ONE);
+}
+
+static void transition_timer_cb(lv_timer_t *timer)
+{
+  bool running = false;
+  for (size_t i = 0; i < transition_count; i++)
+  {
+    int_binding_t *binding = transitions[i];
+    if (!binding->active)
+      continue;
+
+    uint32_t elapsed = lv_tick_elaps(binding->start_tick);
+    int32_t value = binding->to;
+    if (elapsed < CONFIG_UI_VALUE_TRANSITION_MS)
+    {
+      value = ease_out(binding, elapsed);
+      running = true;
+    }
+    else
+    {
+      binding->active = false;
+    }
+
+    // Steps that round to the value already shown cost nothing
+    if (value != binding->shown)
+    {
+      int_binding_show(binding, value);
+    }
+  }
+
+  if (!running)
+  {
+    lv_timer_pause(timer);
+  }
+}
+#endif
+
+static void int_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+  int_binding_t *binding = lv_observer_get_user_data(observer);
+  int32_t value = lv_subject_get_int(subject);
+
+#if CONFIG_UI_VALUE_TRANSITIONS
+  // Placeholders and first values appear at once, only real changes ease
+  if (binding->eased && value != UI_DATA_NO_VALUE && binding->shown != UI_DATA_NO_VALUE)
+  {
+    // A retarget starts from what is on screen, so the motion never jumps
+    binding->from = binding->shown;
+    binding->to = value;
+    binding->start_tick = lv_tick_get();
+    binding->active = true;
+    lv_timer_resume(transition_timer);
+    return;
+  }
+  binding->active = false;
+#endif
+
+  int_binding_show(binding, value);
+}
+
+static int_binding_t *int_binding_create(lv_obj_t *obj, const char *format, const char *placeholder)
+{
+  // Bindings live as long as the dashboard, so they can be allocated once
+  int_binding_t *binding = lv_malloc_zeroed(sizeof(int_binding_t));
+  if (!binding)
+    return NULL;
+  binding->obj = obj;
+  binding->format = format;
+  binding->placeholder = placeholder;
+  binding->shown = UI_DATA_NO_VALUE;
+
+#if CONFIG_UI_VALUE_TRANSITIONS
+  if (!transition_timer)
+  {
+    transition_timer = lv_timer_create(transition_timer_cb, lvgl_setup_get_refr_period_ms(), NULL);
+    if (transition_timer)
+    {
+      lv_timer_pause(transition_timer);
+    }
+  }
+  if (transition_timer && transition_count < UI_DATA_MAX_TRANSITIONS)
+  {
+    transitions[transition_count++] = binding;
+    binding->eased = true;
+  }
+#endif
+  return binding;
+}
+
+static void stale_observer_cb(lv_observer_t *observer, lv_subject_t *subject)
+{
+  lv_obj_t *obj = lv_observer_get_target_obj(observer);
+  lv_obj_set_style_opa(obj, lv_subject_get_int(subject) ? UI_DATA_STALE_OPA : LV_OPA_COVER, 0);
+}
+
+static void bind_stale(lv_obj_t *obj)
+{
+  lv_subject_add_observer_obj(&stale_subject, stale_observer_cb, obj, NULL);
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_data_binding_init(void)
+{
+  if (binding_initialized)
+    return;
+
+  for (int i = 0; i < UI_DATA_FIELD_COUNT; i++)
+  {
+    if (is_string_field(i))
+    {
+      lv_subject_init_string(&subjects[i], string_values[i], NULL, UI_DATA_STRING_LEN, string_placeholders[i]);
+    }
+    else if (list_fields[i])
+    {
+      lv_subject_init_pointer(&subjects[i], &list_values[i]);
+    }
+    else
+    {
+      lv_subject_init_int(&subjects[i], UI_DATA_NO_VALUE);
+    }
+  }
+  lv_subject_init_int(&stale_subject, 0);
+  binding_initialized = true;
+}
+
+lv_subject_t *ui_data_binding_subject(ui_data_field_t field)
+{
+  if (field < 0 || field >= UI_DATA_FIELD_COUNT)
+    return NULL;
+  return &subjects[field];
+}
+
+void ui_data_binding_publish(const system_data_t *data, uint32_t changed_fields)
+{
+  if (!data || !binding_initialized)
+    return;
+
+  // Fields shown as they are
+#define PUBLISH_SCHEMA_FIELD(ID, SECTION, field, key, TYPE, unit, history, ui)                                   \
+  TELEMETRY_IF_UI_INT(ui, if (changed_fields & SYSTEM_DATA_FIELD_##ID)                                           \
+                              publish_int(UI_DATA_##ID, (int32_t)TELEMETRY_MEMBER(data, SECTION, field));)       \
+  TELEMETRY_IF_UI_TEXT(ui, if (changed_fields & SYSTEM_DATA_FIELD_##ID)                                          \
+                               publish_string(UI_DATA_##ID, TELEMETRY_MEMBER(data, SECTION, field));)       \
+  TELEMETRY_IF_UI_LIST(ui, if (changed_fields & SYSTEM_DATA_FIELD_##ID)                                          \
+                               publish_list(UI_DATA_##ID, &TELEMETRY_MEMBER(data, SECTION, field));)
+  TELEMETRY_SCHEMA(PUBLISH_SCHEMA_FIELD)
+#undef PUBLISH_SCHEMA_FIELD
+
+  // Fields derived from several metrics
+  if (changed_fields & (SYSTEM_DATA_FIELD_GPU_MEM_USED | SYSTEM_DATA_FIELD_GPU_MEM_TOTAL))
+  {
+    // Prevent division by zero crash - check for valid mem_total first
+    int32_t gpu_mem_pct = 0;
+    if (data->gpu.mem_total > 0)
+    {
+      gpu_mem_pct = (int32_t)(((uint64_t)data->gpu.mem_used * 100) / data->gpu.mem_total);
+    }
+    publish_int(UI_DATA_GPU_MEM, gpu_mem_pct);
+  }
+  if (changed_fields & (SYSTEM_DATA_FIELD_MEM_USED | SYSTEM_DATA_FIELD_MEM_TOTAL))
+  {
+    char mem_str[UI_DATA_STRING_LEN];
+    snprintf(mem_str, sizeof(mem_str), "(%.1f GB / %.1f GB)", data->mem.used, data->mem.total);
+    publish_string(UI_DATA_MEM_INFO, mem_str);
+  }
+}
+
+void ui_data_binding_reset(void)
+{
+  if (!binding_initialized)
+    return;
+
+  for (int i = 0; i < UI_DATA_FIELD_COUNT; i++)
+  {
+    if (is_string_field(i))
+    {
+      // Names read "No Connection" while the host is gone, the memory info keeps its placeholder
+      publish_string(i, i == UI_DATA_MEM_INFO ? string_placeholders[i] : "No Connection");
+    }
+    else if (list_fields[i])
+    {
+      publish_list(i, &(telemetry_u8_list_t){.count = 0});
+    }
+    else
+    {
+      publish_int(i, UI_DATA_NO_VALUE);
+    }
+  }
+}
+
+void ui_data_binding_set_stale(bool stale)
+{
+  if (binding_initialized && lv_subject_get_int(&stale_subject) != (int32_t)stale)
+  {
+    lv_subject_set_int(&stale_subject, stale);
+  }
+}
+
+void ui_data_bind_label(lv_obj_t *label, ui_data_field_t field, const char *format, const char *placeholder)
+{
+  if (!label || !format || field < 0 || field >= UI_DATA_FIELD_COUNT || !is_int_field(field))
+    return;
+
+  int_binding_t *binding = int_binding_create(label, format, placeholder ? placeholder : "--");
+  if (!binding)
+    return;
+
+  ui_mark_dynamic(label);
+  lv_subject_add_observer_obj(&subjects[field], int_observer_cb, label, binding);
+  bind_stale(label);
+}
+
+void ui_data_bind_text(lv_obj_t *label, ui_data_field_t field)
+{
+  if (!label || field < 0 || field >= UI_DATA_FIELD_COUNT || !is_string_field(field))
+    return;
+
+  ui_mark_dynamic(label);
+  lv_label_bind_text(label, &subjects[field], NULL);
+  bind_stale(label);
+}
+
+void ui_data_bind_bar(lv_obj_t *bar, ui_data_field_t field)
+{
+  if (!bar || field < 0 || field >= UI_DATA_FIELD_COUNT || !is_int_field(field))
+    return;
+
+  int_binding_t *binding = int_binding_create(bar, NULL, NULL);
+  if (!binding)
+    return;
+
+  ui_mark_dynamic(bar);
+  lv_subject_add_observer_obj(&subjects[field], int_observer_cb, bar, binding);
+  bind_stale(bar);
+}
+
+void ui_data_bind_list(lv_obj_t *obj, ui_data_field_t field, lv_observer_cb_t cb, void *user_data)
+{
+  if (!obj || !cb || field < 0 || field >= UI_DATA_FIELD_COUNT || !list_fields[field])
+    return;
+
+  ui_mark_dynamic(obj);
+  lv_subject_add_observer_obj(&subjects[field], cb, obj, user_data);
+  bind_stale(obj);
+}
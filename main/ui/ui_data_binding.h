@@ -0,0 +1,98 @@
+/**
+ * @file ui_data_binding.h
+ * @brief Observer Binding for System Monitoring Data
+ *
+ * Publishes every displayed system_data_t field as an LVGL subject.
+ * Panels bind their widgets once at creation time; publishing a frame
+ * only notifies the widgets whose value actually changed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "dashboard_data.h"
+
+// Value shown as the placeholder text while no data is available
+#define UI_DATA_NO_VALUE INT32_MIN
+
+/**
+ * @brief Published data fields
+ *
+ * UI_DATA_<ID> for every telemetry_schema.h entry marked UI_INT, UI_TEXT or
+ * UI_LIST, in schema order, followed by the fields derived from several
+ * metrics.
+ */
+typedef enum
+{
+#define UI_DATA_SCHEMA_FIELD(ID, SECTION, field, key, TYPE, unit, history, ui) TELEMETRY_IF_UI(ui, UI_DATA_##ID, )
+  TELEMETRY_SCHEMA(UI_DATA_SCHEMA_FIELD)
+#undef UI_DATA_SCHEMA_FIELD
+  UI_DATA_GPU_MEM,  // Percent of GPU memory in use
+  UI_DATA_MEM_INFO, // String "(used GB / total GB)"
+  UI_DATA_FIELD_COUNT
+} ui_data_field_t;
+
+/**
+ * @brief Initialize all subjects with their placeholder values
+ * @note Must be called before any panel binds to a subject
+ */
+void ui_data_binding_init(void);
+
+/**
+ * @brief Get the subject of a data field
+ * @param field Data field
+ * @return Subject, or NULL for an invalid field
+ */
+lv_subject_t *ui_data_binding_subject(ui_data_field_t field);
+
+/**
+ * @brief Publish a telemetry frame (LVGL task only, lock held)
+ * @param data System monitoring data
+ * @param changed_fields SYSTEM_DATA_FIELD_* mask, subjects of other fields are not touched
+ */
+void ui_data_binding_publish(const system_data_t *data, uint32_t changed_fields);
+
+/**
+ * @brief Return every field to its placeholder (LVGL task only, lock held)
+ */
+void ui_data_binding_reset(void);
+
+/**
+ * @brief Dim every bound widget while the values are from an earlier run (LVGL task only, lock held)
+ * @param stale True while the published values are last-known rather than live
+ */
+void ui_data_binding_set_stale(bool stale);
+
+/**
+ * @brief Bind a label to an integer field
+ * @param label Label object
+ * @param field Integer data field
+ * @param format printf format with a single integer conversion (e.g. "%d%%")
+ * @param placeholder Text shown while the field has no value (e.g. "--%")
+ */
+void ui_data_bind_label(lv_obj_t *label, ui_data_field_t field, const char *format, const char *placeholder);
+
+/**
+ * @brief Bind a label to a string field
+ * @param label Label object
+ * @param field String data field
+ */
+void ui_data_bind_text(lv_obj_t *label, ui_data_field_t field);
+
+/**
+ * @brief Bind a bar to an integer field, placeholder shows as 0
+ * @param bar Bar object
+ * @param field Integer data field
+ */
+void ui_data_bind_bar(lv_obj_t *bar, ui_data_field_t field);
+
+/**
+ * @brief Bind a custom-drawn widget to a list field
+ * @param obj Widget, dimmed with the others while the values are last-known
+ * @param field List data field
+ * @param cb Observer called on every change of the list, including the first binding
+ * @param user_data Observer user data
+ * @note The subject is a pointer to the telemetry_u8_list_t, the widget invalidates what changed itself
+ */
+void ui_data_bind_list(lv_obj_t *obj, ui_data_field_t field, lv_observer_cb_t cb, void *user_data);
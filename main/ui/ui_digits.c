@@ -0,0 +1,376 @@
+/**
+ * @file ui_digits.c
+ * @brief Fixed-width number widget drawn from a pre-rasterised glyph atlas
+ *
+ * The atlas is rendered once through a scratch canvas with the regular
+ * label renderer, so glyphs look exactly like font_big_numbers labels,
+ * and only the coverage is kept. Cells are as tall as the font's line, so
+ * a widget lines up with the label it replaces.
+ *
+ * A digits widget is nothing but a ui_digits_text_t; other widgets embed
+ * one and call the same set and draw functions.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_digits.h"
+
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "system_debug_utils.h"
+#include "ui_helpers.h"
+
+#if CONFIG_UI_DIGIT_ATLAS
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define DEGREE_SIGN 0xB0
+
+// Digits first, they share one cell width
+static const uint32_t atlas_letters[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '%', '-', 'C', ' ', DEGREE_SIGN};
+static const char *const atlas_text[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "%", "-", "C", " ", "\xC2\xB0"};
+
+#define ATLAS_GLYPHS (sizeof(atlas_letters) / sizeof(atlas_letters[0]))
+#define ATLAS_DIGITS 10
+#define ATLAS_SPACE 13
+
+typedef struct
+{
+  int32_t width;     ///< Cell width, digits share the widest digit
+  lv_draw_buf_t buf; ///< A8 coverage, width x atlas_height
+} atlas_glyph_t;
+
+static atlas_glyph_t atlas[ATLAS_GLYPHS];
+static const lv_font_t *atlas_font = NULL;
+static int32_t atlas_height = 0;
+static bool atlas_failed = false;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static bool atlas_build(const lv_font_t *font)
+{
+  int32_t height = lv_font_get_line_height(font);
+  int32_t advance[ATLAS_GLYPHS];
+  int32_t digit_w = 0;
+  int32_t max_w = 0;
+  for (size_t i = 0; i < ATLAS_GLYPHS; i++)
+  {
+    advance[i] = lv_font_get_glyph_width(font, atlas_letters[i], 0);
+    if (i < ATLAS_DIGITS && advance[i] > digit_w)
+      digit_w = advance[i];
+  }
+  for (size_t i = 0; i < ATLAS_GLYPHS; i++)
+  {
+    atlas[i].width = (i < ATLAS_DIGITS || i == ATLAS_SPACE) ? digit_w : advance[i];
+    if (atlas[i].width > max_w)
+      max_w = atlas[i].width;
+  }
+  if (height <= 0 || max_w <= 0)
+    return false;
+
+  // Rendered in ARGB8888 through a hidden canvas, only the alpha channel is kept
+  uint32_t stride = max_w * 4;
+  size_t scratch_size = stride * height;
+  uint8_t *scratch_data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, scratch_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!scratch_data)
+    return false;
+  lv_draw_buf_t scratch;
+  lv_draw_buf_init(&scratch, max_w, height, LV_COLOR_FORMAT_ARGB8888, stride, scratch_data, scratch_size);
+
+  lv_obj_t *canvas = lv_canvas_create(lv_layer_top());
+  lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+  lv_canvas_set_draw_buf(canvas, &scratch);
+
+  bool ok = true;
+  for (size_t i = 0; i < ATLAS_GLYPHS && ok; i++)
+  {
+    int32_t width = atlas[i].width;
+    uint8_t *coverage = heap_caps_calloc(1, (size_t)width * height, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!coverage)
+    {
+      ok = false;
+      break;
+    }
+
+    memset(scratch_data, 0, scratch_size);
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = font;
+    dsc.color = lv_color_white();
+    dsc.text = atlas_text[i];
+    lv_area_t area = {(width - advance[i]) / 2, 0, max_w - 1, height - 1};
+    lv_draw_label(&layer, &dsc, &area);
+    lv_canvas_finish_layer(canvas, &layer);
+
+    for (int32_t y = 0; y < height; y++)
+    {
+      const lv_color32_t *row = (const lv_color32_t *)(scratch_data + (size_t)y * stride);
+      for (int32_t x = 0; x < width; x++)
+      {
+        coverage[y * width + x] = row[x].alpha;
+      }
+    }
+    lv_draw_buf_init(&atlas[i].buf, width, height, LV_COLOR_FORMAT_A8, width, coverage, (uint32_t)width * height);
+  }
+
+  lv_obj_delete(canvas);
+  heap_caps_free(scratch_data);
+
+  if (!ok)
+  {
+    for (size_t i = 0; i < ATLAS_GLYPHS; i++)
+    {
+      heap_caps_free(atlas[i].buf.data);
+      atlas[i].buf.data = NULL;
+    }
+    return false;
+  }
+
+  atlas_font = font;
+  atlas_height = height;
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Digit atlas: %u glyphs, %ld px cells, %ld px high", (unsigned)ATLAS_GLYPHS,
+                   (long)digit_w, (long)height);
+  return true;
+}
+
+static int atlas_index(uint32_t letter)
+{
+  for (int i = 0; i < (int)ATLAS_GLYPHS; i++)
+  {
+    if (atlas_letters[i] == letter)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Map text to atlas cells
+ * @return false if the text is too long or has a character the atlas does not hold
+ */
+static bool parse_text(const char *text, uint8_t *glyph, uint8_t *len)
+{
+  const uint8_t *p = (const uint8_t *)text;
+  *len = 0;
+  while (*p)
+  {
+    // The degree sign is the only non-ASCII character in the atlas
+    int index;
+    if (p[0] == 0xC2 && p[1] == DEGREE_SIGN)
+    {
+      index = atlas_index(DEGREE_SIGN);
+      p += 2;
+    }
+    else
+    {
+      index = atlas_index(*p);
+      p++;
+    }
+    if (index < 0 || *len >= UI_DIGITS_MAX_CHARS)
+      return false;
+    glyph[(*len)++] = (uint8_t)index;
+  }
+  return true;
+}
+
+/**
+ * @brief Walk old and new cells side by side, only differing cells are redrawn
+ */
+static void invalidate_changed_cells(const ui_digits_text_t *t, lv_obj_t *obj, const lv_area_t *area,
+                                     const uint8_t *glyph, uint8_t len)
+{
+  int32_t old_x = area->x1;
+  int32_t new_x = area->x1;
+  for (uint8_t i = 0; i < LV_MAX(len, t->len); i++)
+  {
+    int32_t old_w = i < t->len ? atlas[t->glyph[i]].width : 0;
+    int32_t new_w = i < len ? atlas[glyph[i]].width : 0;
+    bool same = i < t->len && i < len && t->glyph[i] == glyph[i] && old_x == new_x;
+    if (!same)
+    {
+      lv_area_t cell = {LV_MIN(old_x, new_x), area->y1, LV_MAX(old_x + old_w, new_x + new_w) - 1, area->y2};
+      lv_obj_invalidate_area(obj, &cell);
+    }
+    old_x += old_w;
+    new_x += new_w;
+  }
+}
+
+static void draw_cells(const ui_digits_text_t *t, lv_layer_t *layer, const lv_area_t *area)
+{
+  lv_draw_image_dsc_t img;
+  lv_draw_image_dsc_init(&img);
+  img.recolor = t->color;
+  img.recolor_opa = LV_OPA_COVER;
+
+  // A8 sources are drawn as masks in the recolor color
+  int32_t x = area->x1;
+  for (uint8_t i = 0; i < t->len; i++)
+  {
+    const atlas_glyph_t *g = &atlas[t->glyph[i]];
+    lv_area_t cell = {x, area->y1, x + g->width - 1, area->y1 + atlas_height - 1};
+    x += g->width;
+    if (t->glyph[i] == ATLAS_SPACE)
+      continue;
+
+    img.src = &g->buf;
+    lv_draw_image(layer, &img, &cell);
+  }
+}
+
+#endif // CONFIG_UI_DIGIT_ATLAS
+
+/**
+ * @brief Screen area of an embedded value, from its origin to the right edge of the widget
+ */
+static void text_area(const ui_digits_text_t *t, lv_obj_t *obj, lv_area_t *area)
+{
+  lv_obj_get_coords(obj, area);
+  area->x1 += t->x;
+  area->y1 += t->y;
+  area->y2 = area->y1 + lv_font_get_line_height(t->font) - 1;
+}
+
+#if CONFIG_UI_DIGIT_ATLAS
+static void digits_event_cb(lv_event_t *e)
+{
+  lv_obj_t *obj = lv_event_get_current_target(e);
+  ui_digits_text_t *t = lv_obj_get_user_data(obj);
+
+  if (lv_event_get_code(e) == LV_EVENT_DELETE)
+  {
+    lv_free(t);
+    return;
+  }
+
+  ui_digits_text_draw(t, obj, lv_event_get_layer(e));
+}
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+bool ui_digits_text_init(ui_digits_text_t *text, const lv_font_t *font, uint32_t color, int32_t x, int32_t y)
+{
+  memset(text, 0, sizeof(*text));
+  text->font = font;
+  text->color = lv_color_hex(color);
+  text->x = x;
+  text->y = y;
+
+#if CONFIG_UI_DIGIT_ATLAS
+  if (!atlas_font && !atlas_failed && !atlas_build(font))
+  {
+    atlas_failed = true;
+    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Digit atlas unavailable, numbers use labels");
+  }
+  return atlas_font == font;
+#else
+  return false;
+#endif
+}
+
+void ui_digits_text_set(ui_digits_text_t *text, lv_obj_t *obj, const char *value)
+{
+  lv_area_t area;
+  text_area(text, obj, &area);
+
+#if CONFIG_UI_DIGIT_ATLAS
+  uint8_t glyph[UI_DIGITS_MAX_CHARS];
+  uint8_t len = 0;
+  bool atlas = atlas_font == text->font && parse_text(value, glyph, &len);
+  if (atlas && text->atlas)
+  {
+    invalidate_changed_cells(text, obj, &area, glyph, len);
+    memcpy(text->glyph, glyph, len);
+    text->len = len;
+    strlcpy(text->text, value, sizeof(text->text));
+    return;
+  }
+  if (atlas)
+  {
+    memcpy(text->glyph, glyph, len);
+    text->len = len;
+  }
+#else
+  bool atlas = false;
+#endif
+
+  // Label text, or a switch between cells and label text, redraws the whole value
+  if (atlas == text->atlas && strcmp(text->text, value) == 0)
+    return;
+  text->atlas = atlas;
+  strlcpy(text->text, value, sizeof(text->text));
+  lv_obj_invalidate_area(obj, &area);
+}
+
+void ui_digits_text_draw(const ui_digits_text_t *text, lv_obj_t *obj, lv_layer_t *layer)
+{
+  lv_area_t area;
+  text_area(text, obj, &area);
+
+#if CONFIG_UI_DIGIT_ATLAS
+  if (text->atlas)
+  {
+    draw_cells(text, layer, &area);
+    return;
+  }
+#endif
+
+  if (text->text[0] == '\0')
+    return;
+
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  dsc.font = text->font;
+  dsc.color = text->color;
+  dsc.text = text->text;
+  lv_draw_label(layer, &dsc, &area);
+}
+
+lv_obj_t *ui_digits_create(lv_obj_t *parent, const lv_font_t *font, uint32_t color)
+{
+  if (!parent || !font)
+    return NULL;
+
+#if CONFIG_UI_DIGIT_ATLAS
+  ui_digits_text_t *t = lv_malloc_zeroed(sizeof(ui_digits_text_t));
+  if (t && ui_digits_text_init(t, font, color, 0, 0))
+  {
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(obj, UI_DIGITS_MAX_CHARS * atlas[ATLAS_SPACE].width, atlas_height);
+    lv_obj_set_user_data(obj, t);
+    lv_obj_add_event_cb(obj, digits_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, digits_event_cb, LV_EVENT_DELETE, NULL);
+    return obj;
+  }
+  lv_free(t);
+#endif
+
+  lv_obj_t *label = lv_label_create(parent);
+  lv_obj_add_style(label, ui_get_text_style(font, color), 0);
+  return label;
+}
+
+void ui_digits_set_text(lv_obj_t *obj, const char *text)
+{
+  if (!obj || !text)
+    return;
+
+  if (lv_obj_check_type(obj, &lv_label_class))
+  {
+    lv_label_set_text(obj, text);
+    return;
+  }
+
+  ui_digits_text_set(lv_obj_get_user_data(obj), obj, text);
+}
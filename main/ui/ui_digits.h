@@ -0,0 +1,104 @@
+/**
+ * @file ui_digits.h
+ * @brief Fixed-width number widget drawn from a pre-rasterised glyph atlas
+ *
+ * The big telemetry values only ever show digits, '%', '-' and "°C".
+ * Those glyphs are rasterised once into an A8 atlas in internal RAM. A
+ * digits widget draws its characters as recoloured atlas cells, all
+ * digits in cells of the widest digit, and a new value only invalidates
+ * the cells that changed. There is no text layout on update.
+ *
+ * The same drawing is available to other widgets as a ui_digits_text_t
+ * embedded in their own state, see ui_metric_tile.h. A value with
+ * characters the atlas does not hold is drawn as ordinary label text.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Characters one widget can show, "12345°C" needs 7
+#define UI_DIGITS_MAX_CHARS 8
+
+// Longest value text in bytes, terminator included
+#define UI_DIGITS_MAX_TEXT 24
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief A value drawn from the atlas, embedded in the state of a widget
+ *
+ * The widget's user data must point at this struct (or at a struct that
+ * starts with it), which is how ui_digits_set_text() finds it.
+ */
+typedef struct
+{
+  const lv_font_t *font;
+  lv_color_t color;
+  int32_t x;  ///< Left edge inside the widget
+  int32_t y;  ///< Top edge inside the widget
+  bool atlas; ///< Shown as atlas cells, otherwise as label text
+  uint8_t len;
+  uint8_t glyph[UI_DIGITS_MAX_CHARS]; ///< Atlas indices while atlas is set
+  char text[UI_DIGITS_MAX_TEXT];
+} ui_digits_text_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create a digits widget
+ * @param parent Parent object
+ * @param font Font the atlas is rasterised from, the first widget fixes it
+ * @param color Text color (hex)
+ * @return Widget, a plain label when the atlas is disabled, unavailable or built from another font
+ * @note LVGL lock held, the first call builds the atlas
+ */
+lv_obj_t *ui_digits_create(lv_obj_t *parent, const lv_font_t *font, uint32_t color);
+
+/**
+ * @brief Show a value
+ * @param obj Widget from ui_digits_create() or ui_metric_tile_create()
+ * @param text Digits, '%', '-', ' ' and "°C" are drawn from the atlas, other text as a label
+ * @note LVGL task only, lock held
+ */
+void ui_digits_set_text(lv_obj_t *obj, const char *text);
+
+/**
+ * @brief Prepare an embedded value, the first call builds the atlas
+ * @param text Value state inside the widget's own state
+ * @param font Value font, the atlas is only used for the font it was built from
+ * @param color Text color (hex)
+ * @param x Left edge inside the widget
+ * @param y Top edge inside the widget
+ * @return true if the value can be drawn from the atlas
+ */
+bool ui_digits_text_init(ui_digits_text_t *text, const lv_font_t *font, uint32_t color, int32_t x, int32_t y);
+
+/**
+ * @brief Change an embedded value, invalidating only what changed on screen
+ * @param text Value state
+ * @param obj Widget that draws it
+ * @param value New value text
+ */
+void ui_digits_text_set(ui_digits_text_t *text, lv_obj_t *obj, const char *value);
+
+/**
+ * @brief Draw an embedded value from the widget's LV_EVENT_DRAW_MAIN handler
+ * @param text Value state
+ * @param obj Widget that draws it
+ * @param layer Layer of the draw event
+ */
+void ui_digits_text_draw(const ui_digits_text_t *text, lv_obj_t *obj, lv_layer_t *layer);
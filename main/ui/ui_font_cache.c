@@ -0,0 +1,173 @@
+/**
+ * @file ui_font_cache.c
+ * @brief PSRAM cache of decompressed glyphs for the subset dashboard fonts
+ *
+ * Each cached font has a small open-addressed table keyed by glyph index.
+ * The font engine decompresses into the draw unit's A8 buffer, a miss
+ * copies that buffer to PSRAM and a hit copies it back. Entries are never
+ * evicted: the subset fonts hold about a hundred glyphs each, so the set
+ * in use fits the budget and stops changing after the first screens.
+ *
+ * With more than one SW draw unit, glyphs are fetched from several draw
+ * threads at once, and LVGL's RLE decoder keeps its state in one global.
+ * A wrapped font therefore fetches its glyphs under a mutex, which the
+ * cache tables share; the wrapper is kept for that alone when the cache is
+ * disabled. Blending, where the draw threads spend their time, runs
+ * outside it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_font_cache.h"
+
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "system_debug_utils.h"
+
+#if CONFIG_UI_FONT_GLYPH_CACHE || LV_DRAW_SW_DRAW_UNIT_CNT > 1
+#define FONT_WRAP 1
+#else
+#define FONT_WRAP 0
+#endif
+
+#if FONT_WRAP
+
+// Table slots per font, a power of two above the subset glyph count
+#define FONT_CACHE_SLOTS 256
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  uint32_t index;  ///< Glyph index + 1, 0 marks a free slot
+  uint32_t stride; ///< Row stride the bitmap was decompressed with
+  uint32_t size;   ///< Bytes at data
+  uint8_t *data;   ///< A8 bitmap in PSRAM
+} glyph_slot_t;
+
+typedef struct
+{
+  lv_font_t font; ///< First member, resolved_font points here
+  const lv_font_t *base;
+  glyph_slot_t *slots; ///< NULL without the cache
+} cached_font_t;
+
+#if CONFIG_UI_FONT_GLYPH_CACHE
+static size_t cache_budget = (size_t)CONFIG_UI_FONT_GLYPH_CACHE_KB * 1024;
+#else
+static size_t cache_budget = 0;
+#endif
+static bool budget_logged = false;
+static SemaphoreHandle_t glyph_mutex = NULL; ///< Held by the draw thread fetching a glyph
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static glyph_slot_t *find_slot(cached_font_t *cf, uint32_t index)
+{
+  if (!cf->slots)
+    return NULL;
+  uint32_t key = index + 1;
+  uint32_t pos = (index * 2654435761u) & (FONT_CACHE_SLOTS - 1);
+  for (uint32_t probe = 0; probe < FONT_CACHE_SLOTS; probe++)
+  {
+    glyph_slot_t *slot = &cf->slots[(pos + probe) & (FONT_CACHE_SLOTS - 1)];
+    if (slot->index == key || slot->index == 0)
+      return slot;
+  }
+  return NULL;
+}
+
+static const void *fetch_glyph_bitmap(cached_font_t *cf, lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+  glyph_slot_t *slot = draw_buf ? find_slot(cf, g_dsc->gid.index) : NULL;
+  uint32_t size = draw_buf ? draw_buf->header.stride * g_dsc->box_h : 0;
+
+  if (slot && slot->data && slot->stride == draw_buf->header.stride && slot->size == size)
+  {
+    memcpy(draw_buf->data, slot->data, size);
+    return draw_buf;
+  }
+
+  const void *bitmap = cf->base->get_glyph_bitmap(g_dsc, draw_buf);
+  if (bitmap != draw_buf || !slot || slot->data || size == 0)
+    return bitmap;
+
+  if (size > cache_budget)
+  {
+    if (!budget_logged)
+    {
+      budget_logged = true;
+      debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Glyph cache budget used up, further glyphs are decompressed each time");
+    }
+    return bitmap;
+  }
+
+  uint8_t *data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (data)
+  {
+    memcpy(data, draw_buf->data, size);
+    slot->index = g_dsc->gid.index + 1;
+    slot->stride = draw_buf->header.stride;
+    slot->size = size;
+    slot->data = data;
+    cache_budget -= size;
+  }
+  return bitmap;
+}
+
+static const void *cached_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+  cached_font_t *cf = (cached_font_t *)g_dsc->resolved_font;
+  xSemaphoreTake(glyph_mutex, portMAX_DELAY);
+  const void *bitmap = fetch_glyph_bitmap(cf, g_dsc, draw_buf);
+  xSemaphoreGive(glyph_mutex);
+  return bitmap;
+}
+
+#endif // FONT_WRAP
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+const lv_font_t *ui_font_cache_wrap(const lv_font_t *font)
+{
+#if FONT_WRAP
+  if (!font || !font->get_glyph_bitmap)
+    return font;
+
+  if (!glyph_mutex)
+    glyph_mutex = xSemaphoreCreateMutex();
+  cached_font_t *cf = heap_caps_calloc(1, sizeof(cached_font_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  glyph_slot_t *slots = NULL;
+#if CONFIG_UI_FONT_GLYPH_CACHE
+  slots = heap_caps_calloc(FONT_CACHE_SLOTS, sizeof(glyph_slot_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!slots)
+    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Glyph cache unavailable, font used uncached");
+#endif
+  if (!cf || !glyph_mutex)
+  {
+    heap_caps_free(cf);
+    heap_caps_free(slots);
+    // Without the wrapper several draw units would share the RLE decoder
+    debug_log_error(DEBUG_TAG_UI_DASHBOARD, "Font wrapper unavailable, font used as is");
+    return font;
+  }
+
+  // The fmt_txt callbacks only read font->dsc, a copy renders like the original
+  cf->font = *font;
+  cf->font.get_glyph_bitmap = cached_get_glyph_bitmap;
+  cf->base = font;
+  cf->slots = slots;
+  return &cf->font;
+#else
+  return font;
+#endif
+}
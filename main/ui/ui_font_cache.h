@@ -0,0 +1,30 @@
+/**
+ * @file ui_font_cache.h
+ * @brief PSRAM cache of decompressed glyphs for the subset dashboard fonts
+ *
+ * The subset fonts are RLE compressed in flash, so every glyph drawn is
+ * decompressed again. A cached font is a RAM copy of the font whose bitmap
+ * callback keeps each decompressed glyph in PSRAM and copies it out on the
+ * next use.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Get a caching copy of a font
+ * @param font Bitmap font (lv_font_fmt_txt)
+ * @return Caching copy, or font itself when the cache is disabled or out of memory;
+ *         with several SW draw units the copy is kept without the cache to lock glyph fetches
+ * @note Glyphs are only cached while CONFIG_UI_FONT_GLYPH_CACHE_KB of PSRAM lasts,
+ *       later glyphs are decompressed every time
+ */
+const lv_font_t *ui_font_cache_wrap(const lv_font_t *font);
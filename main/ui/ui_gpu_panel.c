@@ -9,14 +9,12 @@
 
 #include "ui_gpu_panel.h"
 
-#include <stdio.h>
+#include "ui_alerts.h"
 #include "ui_config.h"
+#include "ui_data_binding.h"
 #include "ui_helpers.h"
-
-static lv_obj_t *gpu_name_label = NULL;
-static lv_obj_t *gpu_usage_label = NULL;
-static lv_obj_t *gpu_temp_label = NULL;
-static lv_obj_t *gpu_mem_label = NULL;
+#include "ui_metric_tile.h"
+#include "ui_sparkline.h"
 
 /**
  * @brief Create the GPU monitoring panel
@@ -31,87 +29,25 @@ lv_obj_t *create_gpu_panel(lv_obj_t *parent)
   ui_create_title_with_separator(gpu_panel, "GPU", 0x4caf50, 355);
 
   // GPU Name (positioned to the right of title, baseline aligned)
-  gpu_name_label = ui_create_device_name(gpu_panel, "Unknown GPU", 80, font_small, 0x808080);
-
-  // Create GPU fields - Temperature first
-  gpu_temp_label = ui_create_field(gpu_panel, "Temp", "--°C", 10, font_normal, font_big_numbers, 0xaaaaaa, 0xff7043);
-  gpu_usage_label = ui_create_field(gpu_panel, "Usage", "--%", 128, font_normal, font_big_numbers, 0xaaaaaa, 0x4caf50);
-  gpu_mem_label = ui_create_field(gpu_panel, "Memory", "--%", 246, font_normal, font_big_numbers, 0xaaaaaa, 0x81c784);
-
-  // Create vertical separators between GPU fields
-  ui_create_vertical_separator(gpu_panel, 118, 50, 60, 0x555555);
-  ui_create_vertical_separator(gpu_panel, 236, 50, 60, 0x555555);
-
-  return gpu_panel;
-}
-
-/**
- * @brief Update GPU panel with new data
- * @param gpu_data Pointer to GPU monitoring data from system_data_t
- */
-void update_gpu_panel(const void *gpu_data)
-{
-  if (!gpu_data)
-    return;
+  lv_obj_t *gpu_name_label = ui_create_device_name(gpu_panel, "Unknown GPU", 80, font_small, 0x808080);
+  ui_data_bind_text(gpu_name_label, UI_DATA_GPU_NAME);
 
-  // Cast void* to the actual struct type
-  const struct gpu_info *gpu = (const struct gpu_info *)gpu_data;
+  // Create GPU fields - Temperature first, each tile draws its caption, value and separator
+  lv_obj_t *gpu_temp_label = ui_metric_tile_create(gpu_panel, "Temp", "--°C", 10, 109, font_normal, font_big_numbers, 0xaaaaaa, 0xff7043, true);
+  lv_obj_t *gpu_usage_label = ui_metric_tile_create(gpu_panel, "Usage", "--%", 128, 109, font_normal, font_big_numbers, 0xaaaaaa, 0x4caf50, true);
+  lv_obj_t *gpu_mem_label = ui_metric_tile_create(gpu_panel, "Memory", "--%", 246, 109, font_normal, font_big_numbers, 0xaaaaaa, 0x81c784, false);
 
-  if (gpu_name_label)
-  {
-    lv_label_set_text(gpu_name_label, gpu->name);
-  }
+  // Labels follow the published subjects, they are only redrawn when a value changes
+  ui_data_bind_label(gpu_temp_label, UI_DATA_GPU_TEMP, "%d°C", "--°C");
+  ui_data_bind_label(gpu_usage_label, UI_DATA_GPU_USAGE, "%d%%", "--%");
+  ui_data_bind_label(gpu_mem_label, UI_DATA_GPU_MEM, "%d%%", "--%");
 
-  if (gpu_usage_label)
-  {
-    char usage_str[16];
-    snprintf(usage_str, sizeof(usage_str), "%d%%", gpu->usage);
-    lv_label_set_text(gpu_usage_label, usage_str);
-  }
+  // Badges blink while a threshold alert is active
+  ui_alerts_attach(TELEMETRY_ALERT_GPU_TEMP, gpu_panel, 10);
+  ui_alerts_attach(TELEMETRY_ALERT_GPU_USAGE, gpu_panel, 128);
 
-  if (gpu_temp_label)
-  {
-    char temp_str[16];
-    snprintf(temp_str, sizeof(temp_str), "%d°C", gpu->temp);
-    lv_label_set_text(gpu_temp_label, temp_str);
-  }
+  // Recent usage next to the Usage caption
+  ui_sparkline_create(gpu_panel, TELEMETRY_METRIC_GPU_USAGE, 180, 57, 44, 16, 0x4caf50, 100);
 
-  if (gpu_mem_label)
-  {
-    // Prevent division by zero crash - check for valid mem_total first
-    uint8_t mem_usage_pct = 0;
-    if (gpu->mem_total > 0)
-    {
-      mem_usage_pct = (gpu->mem_used * 100) / gpu->mem_total;
-    }
-    char mem_str[32];
-    snprintf(mem_str, sizeof(mem_str), "%d%%", mem_usage_pct);
-    lv_label_set_text(gpu_mem_label, mem_str);
-  }
-}
-
-/**
- * @brief Reset GPU panel to default values (no connection)
- */
-void reset_gpu_panel(void)
-{
-  if (gpu_name_label)
-  {
-    lv_label_set_text(gpu_name_label, "No Connection");
-  }
-
-  if (gpu_usage_label)
-  {
-    lv_label_set_text(gpu_usage_label, "--%");
-  }
-
-  if (gpu_temp_label)
-  {
-    lv_label_set_text(gpu_temp_label, "--°C");
-  }
-
-  if (gpu_mem_label)
-  {
-    lv_label_set_text(gpu_mem_label, "--%");
-  }
+  return gpu_panel;
 }
@@ -17,14 +17,3 @@
  * @return Created GPU panel object
  */
 lv_obj_t *create_gpu_panel(lv_obj_t *parent);
-
-/**
- * @brief Update GPU panel with new data
- * @param gpu_data Pointer to GPU monitoring data
- */
-void update_gpu_panel(const void *gpu_data);
-
-/**
- * @brief Reset GPU panel to default values (no connection)
- */
-void reset_gpu_panel(void);
@@ -0,0 +1,141 @@
+/**
+ * @file ui_gradient.c
+ * @brief Pre-rendered, dithered vertical gradient tiles for panel backgrounds
+ *
+ * Each row is interpolated in 8.8 fixed point per channel. Before the
+ * channels are cut to 5/6/5 bits a 4x4 Bayer threshold, scaled to the
+ * bits being dropped, is added, so the fraction turns into a fine
+ * pattern instead of a band edge. The pattern repeats every 4 px, which
+ * is why the tile can be narrow and tiled across the object.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_gradient.h"
+
+#include "esp_heap_caps.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  int32_t height;
+  uint32_t top_color;
+  uint32_t bottom_color;
+  lv_draw_buf_t buf;
+  bool used;
+} gradient_tile_t;
+
+static gradient_tile_t tiles[UI_GRADIENT_CACHE_SIZE];
+
+// 4x4 ordered dither thresholds, 0..15
+static const uint8_t bayer4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static uint32_t channel_at(uint32_t top, uint32_t bottom, int32_t y, int32_t height)
+{
+  // 8.8 fixed point, exact at both ends
+  int32_t span = height > 1 ? height - 1 : 1;
+  return (top << 8) + (int32_t)(((int32_t)bottom - (int32_t)top) * 256 * y) / span;
+}
+
+static uint32_t dither(uint32_t value_8_8, uint32_t dropped_bits, uint8_t threshold)
+{
+  // Threshold spans one output step: (threshold + 0.5) / 16 of 1 << dropped_bits
+  uint32_t offset = ((2 * threshold + 1) << (dropped_bits + 8)) / 32;
+  uint32_t value = (value_8_8 + offset) >> 8;
+  return LV_MIN(value, 255) >> dropped_bits;
+}
+
+static void render_tile(uint16_t *pixels, int32_t height, uint32_t top_color, uint32_t bottom_color)
+{
+  for (int32_t y = 0; y < height; y++)
+  {
+    uint32_t r = channel_at((top_color >> 16) & 0xFF, (bottom_color >> 16) & 0xFF, y, height);
+    uint32_t g = channel_at((top_color >> 8) & 0xFF, (bottom_color >> 8) & 0xFF, y, height);
+    uint32_t b = channel_at(top_color & 0xFF, bottom_color & 0xFF, y, height);
+
+    uint16_t row[4];
+    for (int32_t x = 0; x < 4; x++)
+    {
+      uint8_t t = bayer4[y & 3][x];
+      row[x] = (uint16_t)((dither(r, 3, t) << 11) | (dither(g, 2, t) << 5) | dither(b, 3, t));
+    }
+
+    uint16_t *out = pixels + (size_t)y * UI_GRADIENT_TILE_WIDTH;
+    for (int32_t x = 0; x < UI_GRADIENT_TILE_WIDTH; x++)
+    {
+      out[x] = row[x & 3];
+    }
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+const lv_draw_buf_t *ui_gradient_get(int32_t height, uint32_t top_color, uint32_t bottom_color)
+{
+  if (height <= 0)
+    return NULL;
+
+  gradient_tile_t *slot = NULL;
+  for (int i = 0; i < UI_GRADIENT_CACHE_SIZE; i++)
+  {
+    gradient_tile_t *tile = &tiles[i];
+    if (!tile->used)
+    {
+      slot = slot ? slot : tile;
+      continue;
+    }
+    if (tile->height == height && tile->top_color == top_color && tile->bottom_color == bottom_color)
+      return &tile->buf;
+  }
+  if (!slot)
+  {
+    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Gradient cache full, increase UI_GRADIENT_CACHE_SIZE");
+    return NULL;
+  }
+
+  uint32_t stride = UI_GRADIENT_TILE_WIDTH * 2;
+  size_t data_size = (size_t)stride * height;
+  uint16_t *data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!data)
+    return NULL;
+
+  render_tile(data, height, top_color, bottom_color);
+  lv_draw_buf_init(&slot->buf, UI_GRADIENT_TILE_WIDTH, height, LV_COLOR_FORMAT_RGB565, stride, data, data_size);
+  slot->height = height;
+  slot->top_color = top_color;
+  slot->bottom_color = bottom_color;
+  slot->used = true;
+  return &slot->buf;
+}
+
+bool ui_gradient_apply(lv_obj_t *obj, uint32_t top_color, uint32_t bottom_color)
+{
+  if (!obj)
+    return false;
+
+  lv_obj_update_layout(obj);
+  const lv_draw_buf_t *tile = ui_gradient_get(lv_obj_get_height(obj), top_color, bottom_color);
+  if (!tile)
+    return false;
+
+  // The fill stays underneath for the rounded corners the image is clipped from
+  lv_obj_set_style_bg_image_src(obj, tile, 0);
+  lv_obj_set_style_bg_image_tiled(obj, true, 0);
+  return true;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file ui_gradient.h
+ * @brief Pre-rendered, dithered vertical gradient tiles for panel backgrounds
+ *
+ * LVGL renders gradients per pixel on every redraw, and in RGB565 a slow
+ * gradient shows visible bands. A gradient tile is rendered once into
+ * PSRAM with ordered dithering and then drawn as a tiled background
+ * image, which costs the same per frame as any other image blit.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Tile width, a multiple of the 4 px dither pattern; wider tiles mean fewer blits per row
+#define UI_GRADIENT_TILE_WIDTH 64
+
+// Distinct gradients kept, panels of equal height and colors share one
+#define UI_GRADIENT_CACHE_SIZE 8
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Get the tile for a vertical gradient, rendering it on first use
+ * @param height Tile height, the height of the object it fills
+ * @param top_color Color of the first row (hex)
+ * @param bottom_color Color of the last row (hex)
+ * @return RGB565 draw buffer usable as an image source, NULL when out of memory or slots
+ * @note LVGL task only, tiles are never freed
+ */
+const lv_draw_buf_t *ui_gradient_get(int32_t height, uint32_t top_color, uint32_t bottom_color);
+
+/**
+ * @brief Give an object a vertical gradient background
+ * @param obj Object, its current height sets the tile height
+ * @param top_color Color of the top edge (hex)
+ * @param bottom_color Color of the bottom edge (hex)
+ * @return true if the gradient was applied, false leaves the background as it was
+ */
+bool ui_gradient_apply(lv_obj_t *obj, uint32_t top_color, uint32_t bottom_color);
@@ -8,7 +8,128 @@
  */
 
 #include "ui_helpers.h"
+
+#include <stdio.h>
+#include "esp_heap_caps.h"
 #include "ui_config.h"
+#include "ui_gradient.h"
+
+// =======================================================================
+// SHARED STYLE TABLE
+// =======================================================================
+
+// Enough for every font/colour/panel combination the dashboard uses
+#define UI_STYLE_TABLE_SIZE 32
+
+typedef enum
+{
+  UI_STYLE_TEXT,  // Font + text colour
+  UI_STYLE_PANEL, // Background, border, radius and padding
+  UI_STYLE_FILL,  // Borderless solid fill (separators)
+} ui_style_kind_t;
+
+typedef struct
+{
+  lv_style_t style;
+  ui_style_kind_t kind;
+  const lv_font_t *font;
+  uint32_t color;
+  uint32_t border_color;
+  int32_t border_width;
+  int32_t radius;
+  int32_t pad;
+  bool used;
+} ui_style_entry_t;
+
+static ui_style_entry_t style_table[UI_STYLE_TABLE_SIZE];
+
+static bool ui_style_matches(const ui_style_entry_t *entry, const ui_style_entry_t *key)
+{
+  return entry->kind == key->kind && entry->font == key->font && entry->color == key->color &&
+         entry->border_color == key->border_color && entry->border_width == key->border_width &&
+         entry->radius == key->radius && entry->pad == key->pad;
+}
+
+static void ui_style_fill(lv_style_t *style, const ui_style_entry_t *key)
+{
+  lv_style_init(style);
+  switch (key->kind)
+  {
+  case UI_STYLE_TEXT:
+    lv_style_set_text_font(style, key->font);
+    lv_style_set_text_color(style, lv_color_hex(key->color));
+    break;
+  case UI_STYLE_PANEL:
+    lv_style_set_bg_color(style, lv_color_hex(key->color));
+    lv_style_set_border_color(style, lv_color_hex(key->border_color));
+    lv_style_set_border_width(style, key->border_width);
+    lv_style_set_radius(style, key->radius);
+    lv_style_set_pad_all(style, key->pad);
+    break;
+  case UI_STYLE_FILL:
+    lv_style_set_bg_color(style, lv_color_hex(key->color));
+    lv_style_set_border_width(style, 0);
+    lv_style_set_radius(style, key->radius);
+    break;
+  }
+}
+
+/**
+ * @brief Look up (or create) the shared style for a key
+ *
+ * Styles are created on first use and live for the lifetime of the UI, so
+ * every object with the same look references one lv_style_t instead of
+ * carrying its own local style list.
+ */
+static lv_style_t *ui_style_get(const ui_style_entry_t *key)
+{
+  for (int i = 0; i < UI_STYLE_TABLE_SIZE; i++)
+  {
+    ui_style_entry_t *entry = &style_table[i];
+    if (!entry->used)
+    {
+      *entry = *key;
+      entry->used = true;
+      ui_style_fill(&entry->style, key);
+      return &entry->style;
+    }
+    if (ui_style_matches(entry, key))
+      return &entry->style;
+  }
+
+  // Table full: still hand out a working (unshared) style
+  LV_LOG_WARN("UI style table full, increase UI_STYLE_TABLE_SIZE");
+  lv_style_t *style = lv_malloc(sizeof(lv_style_t));
+  LV_ASSERT_MALLOC(style);
+  ui_style_fill(style, key);
+  return style;
+}
+
+lv_style_t *ui_get_text_style(const lv_font_t *font, uint32_t color)
+{
+  ui_style_entry_t key = {.kind = UI_STYLE_TEXT, .font = font, .color = color};
+  return ui_style_get(&key);
+}
+
+static lv_style_t *ui_get_panel_style(uint32_t bg_color, uint32_t border_color, int32_t border_width,
+                                      int32_t radius, int32_t pad)
+{
+  ui_style_entry_t key = {
+      .kind = UI_STYLE_PANEL,
+      .color = bg_color,
+      .border_color = border_color,
+      .border_width = border_width,
+      .radius = radius,
+      .pad = pad,
+  };
+  return ui_style_get(&key);
+}
+
+static lv_style_t *ui_get_fill_style(uint32_t color, int32_t radius)
+{
+  ui_style_entry_t key = {.kind = UI_STYLE_FILL, .color = color, .radius = radius};
+  return ui_style_get(&key);
+}
 
 // =======================================================================
 // HELPER FUNCTIONS FOR UI CREATION
@@ -28,8 +149,7 @@ lv_obj_t *ui_create_device_name(lv_obj_t *parent, const char *device_name, int x
 {
   lv_obj_t *label = lv_label_create(parent);
   lv_label_set_text(label, device_name);
-  lv_obj_set_style_text_font(label, font, 0);
-  lv_obj_set_style_text_color(label, lv_color_hex(color), 0);
+  lv_obj_add_style(label, ui_get_text_style(font, color), 0);
   lv_obj_set_pos(label, x, 8); // Fixed Y position of 8
   return label;
 }
@@ -51,12 +171,18 @@ lv_obj_t *ui_create_panel(lv_obj_t *parent, int width, int height, int x, int y,
   lv_obj_t *panel = lv_obj_create(parent);
   lv_obj_set_size(panel, width, height);
   lv_obj_set_pos(panel, x, y);
-  lv_obj_set_style_bg_color(panel, lv_color_hex(bg_color), 0);
-  lv_obj_set_style_border_color(panel, lv_color_hex(border_color), 0);
-  lv_obj_set_style_border_width(panel, 2, 0);
-  lv_obj_set_style_radius(panel, 8, 0);
-  lv_obj_set_style_pad_all(panel, 15, 0);
+  lv_obj_add_style(panel, ui_get_panel_style(bg_color, border_color, 2, 8, 15), 0);
   lv_obj_set_scrollbar_mode(panel, LV_SCROLLBAR_MODE_OFF);
+#if CONFIG_UI_GRADIENT_PANELS
+  // Lit from above: the top edge moves an eighth of the way towards white
+  uint32_t top_color = 0;
+  for (int shift = 0; shift < 24; shift += 8)
+  {
+    uint32_t c = (bg_color >> shift) & 0xFF;
+    top_color |= (c + (255 - c) / 8) << shift;
+  }
+  ui_gradient_apply(panel, top_color, bg_color);
+#endif
   return panel;
 }
 
@@ -74,55 +200,18 @@ lv_obj_t *ui_create_title_with_separator(lv_obj_t *parent, const char *title,
   // Title label
   lv_obj_t *title_label = lv_label_create(parent);
   lv_label_set_text(title_label, title);
-  lv_obj_set_style_text_font(title_label, font_title, 0);
-  lv_obj_set_style_text_color(title_label, lv_color_hex(title_color), 0);
+  lv_obj_add_style(title_label, ui_get_text_style(font_title, title_color), 0);
   lv_obj_set_pos(title_label, 0, 0);
 
   // Separator line
   lv_obj_t *separator = lv_obj_create(parent);
   lv_obj_set_size(separator, separator_width, 2);
   lv_obj_set_pos(separator, 0, 35);
-  lv_obj_set_style_bg_color(separator, lv_color_hex(title_color), 0);
-  lv_obj_set_style_border_width(separator, 0, 0);
-  lv_obj_set_style_radius(separator, 1, 0);
+  lv_obj_add_style(separator, ui_get_fill_style(title_color, 1), 0);
 
   return title_label;
 }
 
-/**
- * @brief Create a field (label + value) pair
- * @param parent Parent panel
- * @param field_name Field name text
- * @param default_value Default value text
- * @param x X position
- * @param label_font Font for field label
- * @param value_font Font for field value
- * @param label_color Color for field label
- * @param value_color Color for field value
- * @return Pointer to the value label (for updating)
- */
-lv_obj_t *ui_create_field(lv_obj_t *parent, const char *field_name, const char *default_value,
-                          int x, const lv_font_t *label_font, const lv_font_t *value_font,
-                          uint32_t label_color, uint32_t value_color)
-{
-  // Field label
-  lv_obj_t *label = lv_label_create(parent);
-  lv_label_set_text(label, field_name);
-  lv_obj_set_style_text_font(label, label_font, 0);
-  lv_obj_set_style_text_color(label, lv_color_hex(label_color), 0);
-  lv_obj_set_pos(label, x, 55);
-
-  // Field value - using left-bottom anchor for consistent baseline alignment
-  lv_obj_t *value = lv_label_create(parent);
-  lv_label_set_text(value, default_value);
-  lv_obj_set_style_text_font(value, value_font, 0);
-  lv_obj_set_style_text_color(value, lv_color_hex(value_color), 0);
-  // Use align to position value text with left-bottom anchor at consistent Y baseline
-  lv_obj_align(value, LV_ALIGN_BOTTOM_LEFT, x, -5); // Bottom-left anchor, very close to bottom for maximum spacing
-
-  return value;
-}
-
 /**
  * @brief Create a vertical separator line
  * @param parent Parent panel
@@ -137,9 +226,7 @@ lv_obj_t *ui_create_vertical_separator(lv_obj_t *parent, int x, int y, int heigh
   lv_obj_t *separator = lv_obj_create(parent);
   lv_obj_set_size(separator, 1, height);
   lv_obj_set_pos(separator, x, y);
-  lv_obj_set_style_bg_color(separator, lv_color_hex(color), 0);
-  lv_obj_set_style_border_width(separator, 0, 0);
-  lv_obj_set_style_radius(separator, 0, 0);
+  lv_obj_add_style(separator, ui_get_fill_style(color, 0), 0);
   return separator;
 }
 
@@ -155,9 +242,7 @@ lv_obj_t *ui_create_centered_vertical_separator(lv_obj_t *parent, int x, int hei
 {
   lv_obj_t *separator = lv_obj_create(parent);
   lv_obj_set_size(separator, 1, height);
-  lv_obj_set_style_bg_color(separator, lv_color_hex(color), 0);
-  lv_obj_set_style_border_width(separator, 0, 0);
-  lv_obj_set_style_radius(separator, 0, 0);
+  lv_obj_add_style(separator, ui_get_fill_style(color, 0), 0);
   lv_obj_align(separator, LV_ALIGN_LEFT_MID, x, 0);
   return separator;
 }
@@ -174,14 +259,14 @@ lv_obj_t *ui_create_switch_field(lv_obj_t *parent, const char *label_text, int x
   // Create the label first (positioned above where the switch will be)
   lv_obj_t *label = lv_label_create(parent);
   lv_label_set_text(label, label_text);
-  lv_obj_set_style_text_font(label, font_small, 0);
-  lv_obj_set_style_text_color(label, lv_color_hex(0xcccccc), 0);
+  lv_obj_add_style(label, ui_get_text_style(font_small, 0xcccccc), 0);
   lv_obj_align(label, LV_ALIGN_LEFT_MID, x_offset, -25); // Position 25px above center
 
   // Create the switch (moved down 10px from center)
   lv_obj_t *switch_obj = lv_switch_create(parent);
   lv_obj_set_size(switch_obj, 60, 30);
   lv_obj_align(switch_obj, LV_ALIGN_LEFT_MID, x_offset, 10);
+  ui_mark_dynamic(switch_obj);
 
   return switch_obj;
 }
@@ -228,11 +313,179 @@ lv_obj_t *ui_create_status_panel(lv_obj_t *parent, int width, int height, int x,
   lv_obj_t *panel = lv_obj_create(parent);
   lv_obj_set_size(panel, width, height);
   lv_obj_set_pos(panel, x, y);
-  lv_obj_set_style_bg_color(panel, lv_color_hex(bg_color), 0);
-  lv_obj_set_style_border_color(panel, lv_color_hex(border_color), 0);
-  lv_obj_set_style_border_width(panel, 1, 0);
-  lv_obj_set_style_radius(panel, 6, 0);
-  lv_obj_set_style_pad_all(panel, 6, 0);
+  lv_obj_add_style(panel, ui_get_panel_style(bg_color, border_color, 1, 6, 6), 0);
   lv_obj_set_scrollbar_mode(panel, LV_SCROLLBAR_MODE_OFF);
   return panel;
 }
+
+// =======================================================================
+// BOUND FIELD FUNCTIONS
+// =======================================================================
+
+// FNV-1a, only used to detect text changes
+static uint32_t ui_text_hash(const char *text)
+{
+  uint32_t hash = 2166136261u;
+  while (*text)
+  {
+    hash ^= (uint8_t)*text++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void ui_bound_field_init(ui_bound_field_t *field, lv_obj_t *obj)
+{
+  if (!field)
+    return;
+
+  field->obj = obj;
+  field->last_value = 0;
+  field->last_hash = 0;
+  field->valid = false;
+}
+
+bool ui_bound_field_set_int(ui_bound_field_t *field, int32_t value, const char *format)
+{
+  if (!field || !field->obj || !format)
+    return false;
+
+  if (field->valid && field->last_value == value)
+    return false;
+
+  char text[32];
+  snprintf(text, sizeof(text), format, (int)value);
+  lv_label_set_text(field->obj, text);
+
+  field->last_value = value;
+  field->valid = true;
+  return true;
+}
+
+bool ui_bound_field_set_text(ui_bound_field_t *field, const char *text)
+{
+  if (!field || !field->obj || !text)
+    return false;
+
+  uint32_t hash = ui_text_hash(text);
+  if (field->valid && field->last_hash == hash)
+    return false;
+
+  lv_label_set_text(field->obj, text);
+
+  field->last_hash = hash;
+  field->valid = true;
+  return true;
+}
+
+bool ui_bound_field_set_bar(ui_bound_field_t *field, int32_t value)
+{
+  if (!field || !field->obj)
+    return false;
+
+  if (field->valid && field->last_value == value)
+    return false;
+
+  lv_bar_set_value(field->obj, value, LV_ANIM_OFF);
+
+  field->last_value = value;
+  field->valid = true;
+  return true;
+}
+
+void ui_bound_field_reset(ui_bound_field_t *field, const char *text)
+{
+  if (!field || !field->obj)
+    return;
+
+  if (text)
+  {
+    lv_label_set_text(field->obj, text);
+  }
+  field->valid = false;
+}
+
+// =======================================================================
+// STATIC PANEL BACKGROUND CACHE
+// =======================================================================
+
+void ui_mark_dynamic(lv_obj_t *obj)
+{
+  if (obj)
+  {
+    lv_obj_add_flag(obj, UI_OBJ_FLAG_DYNAMIC);
+  }
+}
+
+esp_err_t ui_cache_panel_background(lv_obj_t *panel)
+{
+#if LV_USE_SNAPSHOT
+  if (!panel)
+    return ESP_ERR_INVALID_ARG;
+
+  lv_obj_update_layout(panel);
+
+  // The cached image replaces the panel background, so it must not extend past the panel
+  if (lv_obj_get_ext_draw_size(panel) != 0)
+    return ESP_ERR_NOT_SUPPORTED;
+
+  int32_t width = lv_obj_get_width(panel);
+  int32_t height = lv_obj_get_height(panel);
+  uint32_t stride = width * 4; // ARGB8888 keeps the rounded corners transparent
+  size_t data_size = stride * height;
+
+  lv_draw_buf_t *draw_buf = heap_caps_calloc(1, sizeof(lv_draw_buf_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  uint8_t *data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!draw_buf || !data)
+  {
+    heap_caps_free(draw_buf);
+    heap_caps_free(data);
+    return ESP_ERR_NO_MEM;
+  }
+  lv_draw_buf_init(draw_buf, width, height, LV_COLOR_FORMAT_ARGB8888, stride, data, data_size);
+
+  // Render everything except the dynamic widgets
+  uint32_t child_count = lv_obj_get_child_count(panel);
+  for (uint32_t i = 0; i < child_count; i++)
+  {
+    lv_obj_t *child = lv_obj_get_child(panel, i);
+    if (lv_obj_has_flag(child, UI_OBJ_FLAG_DYNAMIC))
+    {
+      lv_obj_add_flag(child, LV_OBJ_FLAG_HIDDEN);
+    }
+  }
+
+  lv_result_t result = lv_snapshot_take_to_draw_buf(panel, LV_COLOR_FORMAT_ARGB8888, draw_buf);
+
+  for (int32_t i = (int32_t)child_count - 1; i >= 0; i--)
+  {
+    lv_obj_t *child = lv_obj_get_child(panel, i);
+    if (lv_obj_has_flag(child, UI_OBJ_FLAG_DYNAMIC))
+    {
+      lv_obj_remove_flag(child, LV_OBJ_FLAG_HIDDEN);
+    }
+    else if (result == LV_RESULT_OK)
+    {
+      lv_obj_delete(child);
+    }
+  }
+
+  if (result != LV_RESULT_OK)
+  {
+    heap_caps_free(data);
+    heap_caps_free(draw_buf);
+    return ESP_FAIL;
+  }
+
+  // The panel now only blits the cached pixels; padding stays so live children keep their positions
+  lv_obj_set_style_bg_opa(panel, LV_OPA_TRANSP, 0);
+  lv_obj_set_style_border_width(panel, 0, 0);
+  lv_obj_set_style_shadow_width(panel, 0, 0);
+  lv_obj_set_style_outline_width(panel, 0, 0);
+  lv_obj_set_style_bg_image_src(panel, draw_buf, 0);
+  return ESP_OK;
+#else
+  (void)panel;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
@@ -9,9 +9,41 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "esp_err.h"
 #include "lvgl.h"
 
+// Marks widgets whose content changes at runtime (kept live by the panel background cache)
+#define UI_OBJ_FLAG_DYNAMIC LV_OBJ_FLAG_USER_1
+
+// =======================================================================
+// BOUND FIELD (SKIP-IF-UNCHANGED VALUE CACHE)
+// =======================================================================
+
+/**
+ * @brief Widget bound to a cached value, LVGL is only touched on change
+ */
+typedef struct
+{
+  lv_obj_t *obj;       // Bound label or bar
+  int32_t last_value;  // Last numeric value shown
+  uint32_t last_hash;  // Hash of the last text shown
+  bool valid;          // False until the first value was set
+} ui_bound_field_t;
+
+// =======================================================================
+// SHARED STYLES
+// =======================================================================
+
+/**
+ * @brief Get the shared text style for a font/colour pair
+ * @param font Font to use
+ * @param color Text color (hex)
+ * @return Style owned by ui_helpers, attach with lv_obj_add_style()
+ */
+lv_style_t *ui_get_text_style(const lv_font_t *font, uint32_t color);
+
 // =======================================================================
 // UI HELPER FUNCTION DECLARATIONS
 // =======================================================================
@@ -53,22 +85,6 @@ lv_obj_t *ui_create_panel(lv_obj_t *parent, int width, int height, int x, int y,
 lv_obj_t *ui_create_title_with_separator(lv_obj_t *parent, const char *title,
                                          uint32_t title_color, int separator_width);
 
-/**
- * @brief Create a field (label + value) pair
- * @param parent Parent panel
- * @param field_name Field name text
- * @param default_value Default value text
- * @param x X position
- * @param label_font Font for field label
- * @param value_font Font for field value
- * @param label_color Color for field label
- * @param value_color Color for field value
- * @return Pointer to the value label (for updating)
- */
-lv_obj_t *ui_create_field(lv_obj_t *parent, const char *field_name, const char *default_value,
-                          int x, const lv_font_t *label_font, const lv_font_t *value_font,
-                          uint32_t label_color, uint32_t value_color);
-
 /**
  * @brief Create a vertical separator line
  * @param parent Parent panel
@@ -127,3 +143,69 @@ lv_obj_t *ui_create_progress_bar(lv_obj_t *parent, int width, int height, int x,
  */
 lv_obj_t *ui_create_status_panel(lv_obj_t *parent, int width, int height, int x, int y,
                                  uint32_t bg_color, uint32_t border_color);
+
+// =======================================================================
+// BOUND FIELD FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Bind a widget to a value cache
+ * @param field Field to initialize
+ * @param obj Label or bar object
+ */
+void ui_bound_field_init(ui_bound_field_t *field, lv_obj_t *obj);
+
+/**
+ * @brief Show an integer on a bound label using a printf format
+ * @param field Bound label field
+ * @param value Value to show
+ * @param format printf format with a single integer conversion (e.g. "%d%%")
+ * @return true if the label was updated
+ */
+bool ui_bound_field_set_int(ui_bound_field_t *field, int32_t value, const char *format);
+
+/**
+ * @brief Show text on a bound label
+ * @param field Bound label field
+ * @param text Text to show
+ * @return true if the label was updated
+ */
+bool ui_bound_field_set_text(ui_bound_field_t *field, const char *text);
+
+/**
+ * @brief Set the value of a bound bar
+ * @param field Bound bar field
+ * @param value Bar value
+ * @return true if the bar was updated
+ */
+bool ui_bound_field_set_bar(ui_bound_field_t *field, int32_t value);
+
+/**
+ * @brief Show placeholder text and drop the cached value
+ * @param field Bound label field
+ * @param text Placeholder text (e.g. "--")
+ */
+void ui_bound_field_reset(ui_bound_field_t *field, const char *text);
+
+// =======================================================================
+// STATIC PANEL BACKGROUND CACHE
+// =======================================================================
+
+/**
+ * @brief Mark a widget as dynamic so it stays a live object when the panel is cached
+ * @param obj Widget whose content or state changes at runtime
+ */
+void ui_mark_dynamic(lv_obj_t *obj);
+
+/**
+ * @brief Render the static parts of a panel once into a PSRAM image
+ *
+ * Direct children without UI_OBJ_FLAG_DYNAMIC are rendered into the image
+ * together with the panel background and border, then deleted. The panel
+ * afterwards draws the image as its background.
+ *
+ * @param panel Panel created with ui_create_panel() or ui_create_status_panel()
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the image cannot be allocated,
+ *         ESP_ERR_NOT_SUPPORTED if snapshots are disabled or the panel draws outside its area
+ */
+esp_err_t ui_cache_panel_background(lv_obj_t *panel);
@@ -0,0 +1,353 @@
+/**
+ * @file ui_layout.c
+ * @brief Dashboard panel layouts compiled once into absolute positions
+ *
+ * The JSON is parsed once at startup, every layout in it is turned into a
+ * rectangle table and the tree is freed again. Rows are split by integer
+ * weights, each panel ending where the weights so far put it, so the
+ * rows close flush at the right margin. A layout with a panel outside
+ * the screen, a panel placed twice or nothing to show is skipped whole.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_layout.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "cJSON.h"
+#include "json_arena.h"
+#include "lvgl_setup.h"
+#include "nvs_store.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define LAYOUT_PACK_ASSET "config/layout"
+#define LAYOUT_NVS_NAMESPACE "ui_layout"
+#define LAYOUT_NVS_KEY "active"
+#define LAYOUT_DEFAULT_MARGIN 10
+#define LAYOUT_DEFAULT_GAP 10
+
+typedef struct
+{
+  int16_t x;
+  int16_t y;
+  int16_t w; ///< 0 if the layout does not show the panel
+  int16_t h;
+} layout_rect_t;
+
+typedef struct
+{
+  char name[UI_LAYOUT_NAME_LEN];
+  layout_rect_t rects[UI_LAYOUT_PANEL_COUNT];
+} compiled_layout_t;
+
+static const char *const panel_names[UI_LAYOUT_PANEL_COUNT] = {
+    [UI_LAYOUT_PANEL_CONTROLS] = "controls",
+    [UI_LAYOUT_PANEL_CPU] = "cpu",
+    [UI_LAYOUT_PANEL_GPU] = "gpu",
+    [UI_LAYOUT_PANEL_MEMORY] = "memory",
+    [UI_LAYOUT_PANEL_STATUS] = "status",
+};
+
+// The positions the panels were designed for
+static const compiled_layout_t builtin_layout = {
+    .name = "default",
+    .rects = {
+        [UI_LAYOUT_PANEL_CONTROLS] = {10, 10, 780, 100},
+        [UI_LAYOUT_PANEL_CPU] = {10, 120, 385, 150},
+        [UI_LAYOUT_PANEL_GPU] = {405, 120, 385, 150},
+        [UI_LAYOUT_PANEL_MEMORY] = {10, 280, 780, 120},
+        [UI_LAYOUT_PANEL_STATUS] = {10, 410, 780, 50},
+    },
+};
+
+// Written by ui_layout_load() before the UI exists, read-only afterwards
+static compiled_layout_t layouts[UI_LAYOUT_MAX];
+static int layout_count = 0;
+static int active_layout = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static int panel_index(const char *name)
+{
+  for (int i = 0; i < UI_LAYOUT_PANEL_COUNT; i++)
+  {
+    if (strcmp(panel_names[i], name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static int find_layout(const char *name)
+{
+  for (int i = 0; i < layout_count; i++)
+  {
+    if (strcmp(layouts[i].name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static int get_int(const cJSON *json, const char *key, int fallback)
+{
+  const cJSON *item = cJSON_GetObjectItem(json, key);
+  return cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+/**
+ * @brief Put one panel into a layout
+ * @return false if the panel is unknown, already placed or not on the screen
+ */
+static bool place(compiled_layout_t *out, const char *panel, int x, int y, int w, int h)
+{
+  int index = panel ? panel_index(panel) : -1;
+  if (index < 0 || out->rects[index].w != 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Layout %s: unknown or repeated panel %s", out->name,
+                        panel ? panel : "?");
+    return false;
+  }
+  if (w <= 0 || h <= 0 || x < 0 || y < 0 || x + w > LCD_H_RES || y + h > LCD_V_RES)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Layout %s: panel %s at %d,%d %dx%d is off screen", out->name,
+                        panel, x, y, w, h);
+    return false;
+  }
+  out->rects[index] = (layout_rect_t){x, y, w, h};
+  return true;
+}
+
+/**
+ * @brief Stack rows from the top margin down, each split across its panels by weight
+ */
+static bool compile_rows(const cJSON *rows, int margin, int gap, compiled_layout_t *out)
+{
+  int y = margin;
+  const cJSON *row = NULL;
+  cJSON_ArrayForEach(row, rows)
+  {
+    const cJSON *panels = cJSON_GetObjectItem(row, "panels");
+    int height = get_int(row, "height", 0);
+    int count = cJSON_GetArraySize(panels);
+    if (!cJSON_IsArray(panels) || count == 0)
+      return false;
+
+    int total_weight = 0;
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, panels)
+    {
+      int weight = cJSON_IsObject(item) ? get_int(item, "weight", 1) : 1;
+      if (weight <= 0)
+        return false;
+      total_weight += weight;
+    }
+
+    int width = LCD_H_RES - 2 * margin - (count - 1) * gap;
+    int x = margin;
+    int used = 0;
+    int gaps = 0;
+    cJSON_ArrayForEach(item, panels)
+    {
+      const char *id = cJSON_GetStringValue(cJSON_IsObject(item) ? cJSON_GetObjectItem(item, "id") : item);
+      used += cJSON_IsObject(item) ? get_int(item, "weight", 1) : 1;
+      // Rounded from the weight so far, the last panel ends exactly at the right margin
+      int end = margin + width * used / total_weight + gaps * gap;
+      if (!place(out, id, x, y, end - x, height))
+        return false;
+      x = end + gap;
+      gaps++;
+    }
+    y += height + gap;
+  }
+  return true;
+}
+
+static bool compile_panels(const cJSON *panels, compiled_layout_t *out)
+{
+  const cJSON *item = NULL;
+  cJSON_ArrayForEach(item, panels)
+  {
+    if (!place(out, cJSON_GetStringValue(cJSON_GetObjectItem(item, "id")), get_int(item, "x", -1),
+               get_int(item, "y", -1), get_int(item, "w", 0), get_int(item, "h", 0)))
+      return false;
+  }
+  return true;
+}
+
+static bool compile_layout(const cJSON *json, compiled_layout_t *out)
+{
+  memset(out, 0, sizeof(*out));
+  const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(json, "name"));
+  if (!name || strlen(name) >= sizeof(out->name))
+    return false;
+  strlcpy(out->name, name, sizeof(out->name));
+
+  const cJSON *rows = cJSON_GetObjectItem(json, "rows");
+  const cJSON *panels = cJSON_GetObjectItem(json, "panels");
+  bool ok;
+  if (cJSON_IsArray(rows))
+    ok = compile_rows(rows, get_int(json, "margin", LAYOUT_DEFAULT_MARGIN), get_int(json, "gap", LAYOUT_DEFAULT_GAP),
+                      out);
+  else
+    ok = cJSON_IsArray(panels) && compile_panels(panels, out);
+
+  bool shows_any = false;
+  for (int i = 0; i < UI_LAYOUT_PANEL_COUNT; i++)
+    shows_any |= out->rects[i].w != 0;
+  return ok && shows_any;
+}
+
+/**
+ * @brief Compile the layouts of the pack file
+ * @param active Output, the "active" name of the file, empty if none
+ */
+static void load_pack_layouts(char *active, size_t active_size)
+{
+  active[0] = '\0';
+  asset_t asset;
+  if (!asset_pack_find(LAYOUT_PACK_ASSET, ASSET_TYPE_BLOB, &asset))
+    return;
+
+  json_arena_t *arena = json_arena_begin(asset.size);
+  cJSON *json = cJSON_ParseWithLength(asset.data, asset.size);
+  const cJSON *list = cJSON_GetObjectItem(json, "layouts");
+  if (!cJSON_IsArray(list))
+  {
+    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Layout file has no layouts list, using the built-in layout");
+    list = NULL;
+  }
+
+  const cJSON *item = NULL;
+  cJSON_ArrayForEach(item, list)
+  {
+    if (layout_count >= UI_LAYOUT_MAX)
+      break;
+    if (compile_layout(item, &layouts[layout_count]) && find_layout(layouts[layout_count].name) < 0)
+      layout_count++;
+    else
+      debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Skipping an invalid or duplicate layout");
+  }
+
+  const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(json, "active"));
+  if (name)
+    strlcpy(active, name, active_size);
+  cJSON_Delete(json);
+  json_arena_end(arena);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "LAYOUT {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ui_layout_load(void)
+{
+  char active[UI_LAYOUT_NAME_LEN];
+  layout_count = 0;
+  load_pack_layouts(active, sizeof(active));
+  if (layout_count == 0)
+    layouts[layout_count++] = builtin_layout;
+
+  // The stored choice wins over the file's, as long as the file still has it
+  char stored[UI_LAYOUT_NAME_LEN];
+  size_t size = sizeof(stored);
+  if (nvs_store_get(LAYOUT_NVS_NAMESPACE, LAYOUT_NVS_KEY, stored, &size) == ESP_OK && size > 0)
+  {
+    stored[size - 1] = '\0';
+    if (find_layout(stored) >= 0)
+      strlcpy(active, stored, sizeof(active));
+  }
+
+  int index = find_layout(active);
+  active_layout = index >= 0 ? index : 0;
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Layout %s (%d compiled)", layouts[active_layout].name, layout_count);
+  return ESP_OK;
+}
+
+void ui_layout_apply(lv_obj_t *const panels[UI_LAYOUT_PANEL_COUNT])
+{
+  const compiled_layout_t *layout = &layouts[active_layout];
+  for (int i = 0; i < UI_LAYOUT_PANEL_COUNT; i++)
+  {
+    const layout_rect_t *rect = &layout->rects[i];
+    if (!panels[i])
+      continue;
+    if (rect->w == 0)
+    {
+      // Hidden objects are neither drawn nor invalidated by their updates
+      lv_obj_add_flag(panels[i], LV_OBJ_FLAG_HIDDEN);
+      continue;
+    }
+    lv_obj_set_pos(panels[i], rect->x, rect->y);
+    lv_obj_set_size(panels[i], rect->w, rect->h);
+  }
+}
+
+bool ui_layout_is_shown(ui_layout_panel_t panel)
+{
+  return layout_count > 0 && layouts[active_layout].rects[panel].w != 0;
+}
+
+bool ui_layout_handle_command(const char *line)
+{
+  if (strncmp(line, "LAYOUT ", 7) == 0)
+  {
+    const char *name = line + 7;
+    if (find_layout(name) < 0)
+    {
+      reply_error("unknown layout");
+      return true;
+    }
+    esp_err_t err = nvs_store_set(LAYOUT_NVS_NAMESPACE, LAYOUT_NVS_KEY, name, strlen(name) + 1, 0);
+    if (err != ESP_OK)
+    {
+      reply_error(esp_err_to_name(err));
+      return true;
+    }
+    // Panel backgrounds are cached at their laid-out size, so a new layout waits for the next boot
+    static const char ok[] = "LAYOUT {\"ok\":true,\"restart\":true}\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+    return true;
+  }
+  if (strcmp(line, "GET_LAYOUT") != 0)
+    return false;
+
+  char buf[128];
+  int len = snprintf(buf, sizeof(buf), "LAYOUT {\"active\":\"%s\",\"layouts\":[", layouts[active_layout].name);
+  serial_data_write(buf, len);
+  for (int i = 0; i < layout_count; i++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s\"%s\"", i ? "," : "", layouts[i].name);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("],\"panels\":[", 12);
+
+  int n = 0;
+  for (int i = 0; i < UI_LAYOUT_PANEL_COUNT; i++)
+  {
+    const layout_rect_t *rect = &layouts[active_layout].rects[i];
+    if (rect->w == 0)
+      continue;
+    len = snprintf(buf, sizeof(buf), "%s{\"id\":\"%s\",\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d}", n++ ? "," : "",
+                   panel_names[i], rect->x, rect->y, rect->w, rect->h);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+  return true;
+}
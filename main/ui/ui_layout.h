@@ -0,0 +1,89 @@
+/**
+ * @file ui_layout.h
+ * @brief Dashboard panel layouts compiled once into absolute positions
+ *
+ * Which dashboard panels are shown and where comes from the asset pack
+ * entry config/layout, a JSON file with one or more named layouts. Each
+ * layout is compiled at startup into one rectangle per panel; the panels
+ * are placed with plain lv_obj_set_pos()/lv_obj_set_size() and never get
+ * an LVGL flex or grid layout, so nothing is laid out again at runtime.
+ *
+ *   {
+ *     "active": "default",
+ *     "layouts": [
+ *       {"name": "default", "margin": 10, "gap": 10, "rows": [
+ *         {"height": 100, "panels": ["controls"]},
+ *         {"height": 150, "panels": ["cpu", {"id": "gpu", "weight": 2}]},
+ *         {"height": 50, "panels": ["status"]}]},
+ *       {"name": "pc", "panels": [
+ *         {"id": "cpu", "x": 10, "y": 10, "w": 780, "h": 150}]}
+ *     ]
+ *   }
+ *
+ * "rows" are stacked from the top, each row split across its panels by
+ * weight (1 unless given); "panels" places each one absolutely. Panels a
+ * layout leaves out are hidden. The panels keep the inner design they
+ * were drawn for, so a layout should not make them smaller than that.
+ *
+ * Without a pack layout the built-in one reproduces the original
+ * positions. LAYOUT <name> stores the choice in NVS for the next boot.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+#define UI_LAYOUT_MAX 4       ///< Layouts kept from the pack
+#define UI_LAYOUT_NAME_LEN 16 ///< Including terminator
+
+/**
+ * @brief Dashboard panels a layout can place, in creation order
+ */
+typedef enum
+{
+  UI_LAYOUT_PANEL_CONTROLS = 0,
+  UI_LAYOUT_PANEL_CPU,
+  UI_LAYOUT_PANEL_GPU,
+  UI_LAYOUT_PANEL_MEMORY,
+  UI_LAYOUT_PANEL_STATUS,
+  UI_LAYOUT_PANEL_COUNT,
+} ui_layout_panel_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Compile the pack layouts and pick the active one
+ * @return ESP_OK, also when the built-in layout is used
+ * @note Call once before ui_layout_apply(), after the asset pack and NVS are up
+ */
+esp_err_t ui_layout_load(void);
+
+/**
+ * @brief Move, size and hide the dashboard panels as the active layout says
+ * @param panels Panels indexed by ui_layout_panel_t, NULL entries are skipped
+ * @note LVGL task, once after the panels are created
+ */
+void ui_layout_apply(lv_obj_t *const panels[UI_LAYOUT_PANEL_COUNT]);
+
+/**
+ * @brief Whether the active layout shows a panel
+ */
+bool ui_layout_is_shown(ui_layout_panel_t panel);
+
+/**
+ * @brief Handle GET_LAYOUT and LAYOUT <name>
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a layout command
+ */
+bool ui_layout_handle_command(const char *line);
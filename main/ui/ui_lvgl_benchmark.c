@@ -0,0 +1,271 @@
+/**
+ * @file ui_lvgl_benchmark.c
+ * @brief LVGL's own benchmark demo on the firmware's display pipeline
+ *
+ * lv_demo_benchmark() runs inside the LVGL task like any other screen and
+ * has no completion callback in 9.2; it ends by logging its summary as
+ * comma separated rows. The log callback turns those rows into report
+ * lines and wakes a small task that has kept the display out of its idle
+ * policy meanwhile and now closes the pipeline capture.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_lvgl_benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "lvgl_setup.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "ui_benchmark.h"
+
+#if CONFIG_UI_LVGL_BENCHMARK
+
+#include "demos/lv_demos.h"
+
+#define LVGL_BENCH_KEEPALIVE_MS 1000
+#define LVGL_BENCH_LOCK_TIMEOUT_MS 1000
+
+#if CONFIG_EXAMPLE_LVGL_PINGPONG_DRAW_BUF
+#define LVGL_BENCH_PINGPONG "true"
+#else
+#define LVGL_BENCH_PINGPONG "false"
+#endif
+#if CONFIG_EXAMPLE_LCD_GDMA_FLUSH
+#define LVGL_BENCH_GDMA_FLUSH "true"
+#else
+#define LVGL_BENCH_GDMA_FLUSH "false"
+#endif
+#if CONFIG_LV_DRAW_SW_ASM_CUSTOM
+#define LVGL_BENCH_BLEND_HOOKS "true"
+#else
+#define LVGL_BENCH_BLEND_HOOKS "false"
+#endif
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  char name[48];
+  unsigned long cpu_pct;
+  unsigned long fps;
+  unsigned long avg_ms;
+  unsigned long render_ms;
+  unsigned long flush_ms;
+} bench_row_t;
+
+static portMUX_TYPE bench_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool started = false; ///< Once per boot, the demo keeps its screen
+static TaskHandle_t bench_task_handle = NULL;
+static volatile int scene_count = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void reply(const char *text, int len)
+{
+  serial_data_write(text, len);
+}
+
+/**
+ * @brief Parse "name,C%,F,T,R,L", the row format of LVGL's summary
+ */
+static bool parse_row(const char *line, bench_row_t *row)
+{
+  while (*line == '\r' || *line == '\n' || *line == ' ')
+    line++;
+  const char *comma = strchr(line, ',');
+  if (!comma || comma == line || (size_t)(comma - line) >= sizeof(row->name))
+    return false;
+  if (sscanf(comma + 1, "%lu %% ,%lu ,%lu ,%lu ,%lu", &row->cpu_pct, &row->fps, &row->avg_ms, &row->render_ms,
+             &row->flush_ms) != 5)
+    return false;
+
+  memcpy(row->name, line, comma - line);
+  row->name[comma - line] = '\0';
+  return true;
+}
+
+static void report_row(const bench_row_t *row, bool summary)
+{
+  char buf[192];
+  int len;
+  if (summary)
+    len = snprintf(buf, sizeof(buf), "LVGL_BENCH {\"summary\":true");
+  else
+    len = snprintf(buf, sizeof(buf), "LVGL_BENCH {\"scene\":\"%s\"", row->name);
+  len += snprintf(buf + len, sizeof(buf) - len,
+                  ",\"cpu_pct\":%lu,\"fps\":%lu,\"avg_ms\":%lu,\"render_ms\":%lu,\"flush_ms\":%lu}\n", row->cpu_pct,
+                  row->fps, row->avg_ms, row->render_ms, row->flush_ms);
+  reply(buf, len < (int)sizeof(buf) ? len : (int)sizeof(buf) - 1);
+}
+
+/**
+ * @brief LVGL log output while the demo runs, in the LVGL task
+ */
+static void log_cb(lv_log_level_t level, const char *buf)
+{
+  bench_row_t row;
+  if (parse_row(buf, &row))
+  {
+    bool summary = strncmp(row.name, "All scenes", 10) == 0;
+    report_row(&row, summary);
+    if (!summary)
+    {
+      scene_count++;
+    }
+    else if (bench_task_handle)
+    {
+      xTaskNotifyGive(bench_task_handle);
+    }
+    return;
+  }
+
+  if (level >= LV_LOG_LEVEL_WARN && level <= LV_LOG_LEVEL_ERROR)
+  {
+    char line[128];
+    strlcpy(line, buf, sizeof(line));
+    line[strcspn(line, "\r\n")] = '\0';
+    debug_log_warning_f(DEBUG_TAG_LVGL_SETUP, "LVGL: %s", line);
+  }
+}
+
+static void report_start(void)
+{
+  char buf[256];
+  int len = snprintf(buf, sizeof(buf),
+                     "LVGL_BENCH {\"started\":true,\"lvgl\":\"%d.%d.%d\",\"mode\":\"%s\",\"color_depth\":%d,"
+                     "\"draw_buf_lines\":%d,\"pingpong\":%s,\"gdma_flush\":%s,\"blend_hooks\":%s,"
+                     "\"refr_period_ms\":%lu}\n",
+                     LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH, UI_BENCHMARK_BUFFER_MODE,
+                     LV_COLOR_DEPTH, LVGL_DRAW_BUF_LINES, LVGL_BENCH_PINGPONG, LVGL_BENCH_GDMA_FLUSH,
+                     LVGL_BENCH_BLEND_HOOKS,
+                     (unsigned long)lvgl_setup_get_refr_period_ms());
+  reply(buf, len < (int)sizeof(buf) ? len : (int)sizeof(buf) - 1);
+}
+
+static void bench_task(void *arg)
+{
+  LV_UNUSED(arg);
+  bool capturing = lvgl_setup_metrics_capture_start() == ESP_OK;
+  int64_t start_us = esp_timer_get_time();
+  bool timed_out = false;
+
+  while (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LVGL_BENCH_KEEPALIVE_MS)))
+  {
+    // Nobody touches the panel during a run, keep it from going idle
+    if (lvgl_port_lock(LVGL_BENCH_LOCK_TIMEOUT_MS))
+    {
+      lv_display_trigger_activity(lv_display_get_default());
+      lvgl_port_unlock();
+    }
+    if (esp_timer_get_time() - start_us >= (int64_t)UI_LVGL_BENCHMARK_TIMEOUT_S * 1000000)
+    {
+      timed_out = true;
+      break;
+    }
+  }
+
+  static char buf[768];
+  int len = snprintf(buf, sizeof(buf), "LVGL_BENCH {\"done\":%s,\"ms\":%lu,\"scenes\":%d,\"pipeline\":",
+                     timed_out ? "false,\"error\":\"timeout\"" : "true",
+                     (unsigned long)((esp_timer_get_time() - start_us) / 1000), scene_count);
+  lvgl_metrics_t metrics;
+  size_t json_len = 0;
+  if (capturing && lvgl_setup_metrics_capture_stop(&metrics) == ESP_OK)
+    json_len = lvgl_setup_format_metrics_json(&metrics, buf + len, sizeof(buf) - len - 2);
+  if (json_len == 0)
+    json_len = snprintf(buf + len, sizeof(buf) - len - 2, "null");
+  len += json_len;
+  buf[len++] = '}';
+  buf[len++] = '\n';
+  reply(buf, len);
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "LVGL benchmark %s after %d scenes", timed_out ? "timed out" : "finished",
+                   scene_count);
+  bench_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "LVGL_BENCH {\"error\":\"%s\"}\n", message);
+  reply(buf, len);
+}
+
+#endif // CONFIG_UI_LVGL_BENCHMARK
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t ui_lvgl_benchmark_start(void)
+{
+#if CONFIG_UI_LVGL_BENCHMARK
+  portENTER_CRITICAL(&bench_lock);
+  bool busy = started || ui_benchmark_is_running();
+  if (!busy)
+    started = true;
+  portEXIT_CRITICAL(&bench_lock);
+  if (busy)
+    return ESP_ERR_INVALID_STATE;
+
+  if (!lvgl_port_lock(LVGL_BENCH_LOCK_TIMEOUT_MS))
+  {
+    started = false;
+    return ESP_ERR_TIMEOUT;
+  }
+
+  if (task_plan_create(TASK_PLAN_LVGL_BENCH, bench_task, NULL, &bench_task_handle) != pdPASS)
+  {
+    lvgl_port_unlock();
+    started = false;
+    return ESP_ERR_NO_MEM;
+  }
+
+  // A screen of its own, the demo cleans the active screen before each scene
+  report_start();
+  lv_log_register_print_cb(log_cb);
+  lv_screen_load(lv_obj_create(NULL));
+  lv_demo_benchmark();
+  lvgl_port_unlock();
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "LVGL benchmark started, %s mode", UI_BENCHMARK_BUFFER_MODE);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool ui_lvgl_benchmark_handle_command(const char *line)
+{
+#if CONFIG_UI_LVGL_BENCHMARK
+  if (strcmp(line, "BENCH_LVGL") != 0)
+    return false;
+
+  esp_err_t ret = ui_lvgl_benchmark_start();
+  if (ret == ESP_ERR_INVALID_STATE)
+    reply_error("busy or already run this boot");
+  else if (ret != ESP_OK)
+    reply_error(esp_err_to_name(ret));
+  return true;
+#else
+  if (strcmp(line, "BENCH_LVGL") != 0)
+    return false;
+
+  static const char disabled[] = "LVGL_BENCH {\"enabled\":false}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+#endif
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ui_lvgl_benchmark.h
+ * @brief LVGL's own benchmark demo on the firmware's display pipeline
+ *
+ * Runs lv_demo_benchmark() on a screen of its own, rendered and flushed by
+ * lvgl_setup.c exactly as the dashboard is, with whatever buffer mode, draw
+ * buffer and blend options the build has. The numbers are therefore the
+ * ones to hold against the Arduino_GFX LvglBenchmark sketch on the same
+ * board, or against another build of this firmware.
+ *
+ * Report lines on the serial port, in order:
+ *   LVGL_BENCH {"started":true,"lvgl":"9.2.0","mode":"single_fb",...}
+ *   LVGL_BENCH {"scene":"Empty screen","cpu_pct":C,"fps":F,"avg_ms":T,"render_ms":R,"flush_ms":L}
+ *   LVGL_BENCH {"summary":true,"cpu_pct":C,"fps":F,"avg_ms":T,"render_ms":R,"flush_ms":L}
+ *   LVGL_BENCH {"done":true,"ms":M,"scenes":N,"pipeline":{...}}
+ *
+ * Scene lines are LVGL's own summary, read from its log; "pipeline" is the
+ * display metrics capture over the whole run, as GET_DISPLAY_METRICS
+ * prints it. The demo replaces nothing: the dashboard stays alive on its
+ * screen underneath, and the summary stays on screen until the next boot,
+ * so one run per boot.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// A run that has not reported its summary by then is reported as timed out
+#define UI_LVGL_BENCHMARK_TIMEOUT_S 300
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Switch to the benchmark screen and start lv_demo_benchmark()
+ * @return ESP_OK when started, ESP_ERR_INVALID_STATE if it already ran this
+ *         boot or BENCH_UI is running, ESP_ERR_TIMEOUT if the LVGL lock was
+ *         not free, ESP_ERR_NOT_SUPPORTED if disabled
+ * @note Call after the LVGL task is running
+ */
+esp_err_t ui_lvgl_benchmark_start(void);
+
+/**
+ * @brief Handle BENCH_LVGL
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was the LVGL benchmark command
+ */
+bool ui_lvgl_benchmark_handle_command(const char *line);
@@ -17,14 +17,3 @@
  * @return Created memory panel object
  */
 lv_obj_t *create_memory_panel(lv_obj_t *parent);
-
-/**
- * @brief Update memory panel with new data
- * @param memory_data Pointer to memory monitoring data
- */
-void update_memory_panel(const void *memory_data);
-
-/**
- * @brief Reset memory panel to default values (no connection)
- */
-void reset_memory_panel(void);
@@ -0,0 +1,111 @@
+/**
+ * @file ui_metric_tile.c
+ * @brief Caption, value and separator of a panel field drawn as one widget
+ *
+ * The tile state starts with its ui_digits_text_t and is the object's
+ * user data, which is all ui_digits_set_text() needs to update the value.
+ * Captions and separators are only drawn when LVGL redraws an area that
+ * covers them, a value change never touches them.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_metric_tile.h"
+
+#include "ui_digits.h"
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  ui_digits_text_t value; ///< First, ui_digits_set_text() reads it through the user data
+  const char *caption;
+  const lv_font_t *caption_font;
+  lv_color_t caption_color;
+  bool separator;
+} metric_tile_t;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void tile_event_cb(lv_event_t *e)
+{
+  lv_obj_t *obj = lv_event_get_current_target(e);
+  metric_tile_t *tile = lv_obj_get_user_data(obj);
+
+  if (lv_event_get_code(e) == LV_EVENT_DELETE)
+  {
+    lv_free(tile);
+    return;
+  }
+
+  lv_layer_t *layer = lv_event_get_layer(e);
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+
+  lv_draw_label_dsc_t label;
+  lv_draw_label_dsc_init(&label);
+  label.font = tile->caption_font;
+  label.color = tile->caption_color;
+  label.text = tile->caption;
+  lv_area_t caption_area = {coords.x1, coords.y1 + UI_METRIC_TILE_CAPTION_Y, coords.x2,
+                            coords.y1 + UI_METRIC_TILE_CAPTION_Y + lv_font_get_line_height(tile->caption_font) - 1};
+  lv_draw_label(layer, &label, &caption_area);
+
+  if (tile->separator)
+  {
+    lv_draw_rect_dsc_t line;
+    lv_draw_rect_dsc_init(&line);
+    line.bg_color = lv_color_hex(UI_METRIC_TILE_SEPARATOR_COLOR);
+    line.bg_opa = LV_OPA_COVER;
+    lv_area_t line_area = {coords.x2, coords.y1, coords.x2, coords.y2};
+    lv_draw_rect(layer, &line, &line_area);
+  }
+
+  ui_digits_text_draw(&tile->value, obj, layer);
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+lv_obj_t *ui_metric_tile_create(lv_obj_t *parent, const char *caption, const char *default_value, int x, int width,
+                                const lv_font_t *caption_font, const lv_font_t *value_font, uint32_t caption_color,
+                                uint32_t value_color, bool separator)
+{
+  if (!parent || !caption || !caption_font || !value_font)
+    return NULL;
+
+  // Lives as long as the tile, freed with it
+  metric_tile_t *tile = lv_malloc_zeroed(sizeof(metric_tile_t));
+  if (!tile)
+    return NULL;
+
+  // The value sits on the bottom edge like the labels it replaces
+  lv_obj_update_layout(parent);
+  int32_t height = lv_obj_get_content_height(parent) - UI_METRIC_TILE_Y - UI_METRIC_TILE_BOTTOM_GAP;
+  int32_t value_y = height - lv_font_get_line_height(value_font);
+
+  // The tile starts at the caption, so the caption and value are at x = 0 inside it
+  tile->caption = caption;
+  tile->caption_font = caption_font;
+  tile->caption_color = lv_color_hex(caption_color);
+  tile->separator = separator;
+  ui_digits_text_init(&tile->value, value_font, value_color, 0, value_y);
+
+  lv_obj_t *obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_pos(obj, x, UI_METRIC_TILE_Y);
+  lv_obj_set_size(obj, width, height);
+  lv_obj_set_user_data(obj, tile);
+  lv_obj_add_event_cb(obj, tile_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+  lv_obj_add_event_cb(obj, tile_event_cb, LV_EVENT_DELETE, NULL);
+
+  ui_digits_set_text(obj, default_value ? default_value : "");
+  return obj;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ui_metric_tile.h
+ * @brief Caption, value and separator of a panel field drawn as one widget
+ *
+ * A panel field used to be a caption label, a value widget and a separator
+ * object, each a full lv_obj_t with its own styles. A metric tile is one
+ * object that draws all three from a plain struct in its own draw
+ * handler. The value is a ui_digits_text_t, so it comes from the digit
+ * atlas where it can and a new value only invalidates the cells that
+ * changed; the caption and separator are never redrawn on their own.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Top of a tile in its panel, the caption sits UI_METRIC_TILE_CAPTION_Y below it
+#define UI_METRIC_TILE_Y 50
+#define UI_METRIC_TILE_CAPTION_Y 5
+
+// Gap between the value and the bottom of the panel content
+#define UI_METRIC_TILE_BOTTOM_GAP 5
+
+// Color of the separator on the right edge
+#define UI_METRIC_TILE_SEPARATOR_COLOR 0x555555
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create a metric tile reaching from UI_METRIC_TILE_Y to the bottom of the panel content
+ * @param parent Parent panel, sized before the tile is created
+ * @param caption Caption text, must outlive the tile (a string literal)
+ * @param default_value Value shown until the first update
+ * @param x X position of the caption and value
+ * @param width Tile width, the separator is its rightmost column
+ * @param caption_font Caption font
+ * @param value_font Value font
+ * @param caption_color Caption color (hex)
+ * @param value_color Value color (hex)
+ * @param separator Draw a separator on the right edge
+ * @return Tile, update its value with ui_digits_set_text() or bind it with ui_data_bind_label()
+ * @note LVGL lock held
+ */
+lv_obj_t *ui_metric_tile_create(lv_obj_t *parent, const char *caption, const char *default_value, int x, int width,
+                                const lv_font_t *caption_font, const lv_font_t *value_font, uint32_t caption_color,
+                                uint32_t value_color, bool separator);
@@ -0,0 +1,152 @@
+/**
+ * @file ui_night_page.c
+ * @brief Night page with the clock and active alerts only
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_night_page.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sdkconfig.h"
+#include "telemetry_alerts.h"
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "ui_pages.h"
+#include "wifi/wifi_time_sync.h"
+
+#define NIGHT_PAGE_REFRESH_MS 1000
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static int page_index = -1;
+static volatile bool shown_for_night = false;
+
+static lv_obj_t *clock_label = NULL;
+static lv_obj_t *alerts_label = NULL;
+static lv_timer_t *refresh_timer = NULL;
+static int shown_minute = -1;
+static uint32_t shown_alerts = UINT32_MAX;
+
+static const char *const alert_names[TELEMETRY_ALERT_COUNT] = {
+    [TELEMETRY_ALERT_CPU_TEMP] = "CPU temperature",
+    [TELEMETRY_ALERT_CPU_USAGE] = "CPU load",
+    [TELEMETRY_ALERT_GPU_TEMP] = "GPU temperature",
+    [TELEMETRY_ALERT_GPU_USAGE] = "GPU load",
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void update_values(void)
+{
+  // Labels are only set on a change, the rest of the minute draws nothing
+  int minute = -2;
+  struct tm local = {0};
+  if (wifi_time_sync_is_valid())
+  {
+    time_t now = time(NULL);
+    localtime_r(&now, &local);
+    minute = local.tm_hour * 60 + local.tm_min;
+  }
+  if (minute != shown_minute)
+  {
+    char text[8];
+    if (minute >= 0)
+      strftime(text, sizeof(text), "%H:%M", &local);
+    else
+      strcpy(text, "--:--");
+    lv_label_set_text(clock_label, text);
+    shown_minute = minute;
+  }
+
+  // Any source counts at night, nobody is watching which one is displayed
+  uint32_t alerts = 0;
+  for (int source = 0; source < CONFIG_SERIAL_MAX_SOURCES; source++)
+    alerts |= telemetry_alerts_get_active((uint8_t)source);
+  if (alerts != shown_alerts)
+  {
+    char text[96] = "";
+    size_t len = 0;
+    for (int alert = 0; alert < TELEMETRY_ALERT_COUNT && len < sizeof(text); alert++)
+    {
+      if (alerts & (1u << alert))
+        len += snprintf(text + len, sizeof(text) - len, "%s%s", len ? "   " : "", alert_names[alert]);
+    }
+    lv_label_set_text(alerts_label, text);
+    shown_alerts = alerts;
+  }
+}
+
+static void refresh_cb(lv_timer_t *timer)
+{
+  LV_UNUSED(timer);
+  // Kept built but not shown, nothing to refresh
+  if (lv_obj_get_screen(clock_label) != lv_screen_active())
+    return;
+  update_values();
+}
+
+static void build(lv_obj_t *screen)
+{
+  // Black background, dim text: little light even before the backlight is down
+  lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+
+  clock_label = lv_label_create(screen);
+  lv_obj_add_style(clock_label, ui_get_text_style(font_big_numbers, 0x607d8b), 0);
+  lv_obj_align(clock_label, LV_ALIGN_CENTER, 0, -30);
+
+  alerts_label = lv_label_create(screen);
+  lv_label_set_text(alerts_label, "");
+  lv_obj_add_style(alerts_label, ui_get_text_style(font_normal, 0xb71c1c), 0);
+  lv_obj_align(alerts_label, LV_ALIGN_CENTER, 0, 80);
+
+  shown_minute = -1;
+  shown_alerts = UINT32_MAX;
+  refresh_timer = lv_timer_create(refresh_cb, NIGHT_PAGE_REFRESH_MS, NULL);
+  update_values();
+}
+
+static void evict(void)
+{
+  lv_timer_delete(refresh_timer);
+  refresh_timer = NULL;
+  clock_label = alerts_label = NULL;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_night_page_register(void)
+{
+  static const ui_page_t page = {
+      .name = "night",
+      .build = build,
+      .evict = evict,
+  };
+  page_index = ui_pages_register(&page);
+}
+
+void ui_night_page_show(bool night)
+{
+  if (page_index < 0)
+    return;
+
+  if (night)
+  {
+    shown_for_night = true;
+    ui_pages_show(page_index);
+  }
+  else if (shown_for_night)
+  {
+    shown_for_night = false;
+    ui_pages_show(0);
+  }
+}
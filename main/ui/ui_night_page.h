@@ -0,0 +1,27 @@
+/**
+ * @file ui_night_page.h
+ * @brief Night page with the clock and active alerts only
+ *
+ * Shown while the display is in night mode. Everything else on screen
+ * stays still, so the slow night refresh only redraws the clock once a
+ * minute and the alert line when an alert changes.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * @brief Register the page with ui_pages, nothing is built until it is opened
+ */
+void ui_night_page_register(void);
+
+/**
+ * @brief Switch to the night page, or back to the dashboard
+ * @param night true on entering night, false on leaving it
+ * @note Safe from any task; leaving only returns home if entering switched away
+ */
+void ui_night_page_show(bool night);
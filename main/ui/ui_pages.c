@@ -0,0 +1,475 @@
+/**
+ * @file ui_pages.c
+ * @brief Screen pages built on first use and evicted least recently used
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_pages.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "display_activity.h"
+#include "freertos/FreeRTOS.h"
+#include "lvgl_setup.h"
+#include "mem_governor.h"
+#include "serial/serial_data_handler.h"
+#if CONFIG_UI_PAGE_TRANSITIONS
+#include "esp_heap_caps.h"
+#endif
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  const ui_page_t *page;
+  lv_obj_t *screen;   ///< NULL while not built
+  uint32_t last_used; ///< use_clock value of the last time it was shown
+  uint32_t pool_used; ///< LVGL pool bytes the build took, 0 if unknown
+} page_slot_t;
+
+static const ui_page_t home_page = {.name = "dashboard"};
+
+static page_slot_t slots[UI_PAGES_MAX];
+static int slot_count = 0;
+static int current_index = 0;
+static uint32_t use_clock = 0;
+
+// Requests come from the touch and serial tasks; page state is read by GET_PAGES
+static portMUX_TYPE pages_lock = portMUX_INITIALIZER_UNLOCKED;
+static int pending_index = -1;
+static int pending_step = 0;
+static mem_pressure_t shed_level = MEM_PRESSURE_NORMAL; ///< Set by the memory governor
+
+// LVGL task only
+static mem_pressure_t applied_level = MEM_PRESSURE_NORMAL; ///< shed_level as the LVGL task last acted on it
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+typedef struct
+{
+  lv_draw_buf_t shots[2]; ///< Outgoing and incoming page, allocated on the first page change
+  bool allocated;
+  lv_obj_t *screen; ///< Screen showing the snapshots, NULL while no transition runs
+  lv_obj_t *images[2];
+  int32_t width;
+  int target;
+  int step; ///< Slide direction, 0 fades
+} page_transition_t;
+
+static page_transition_t transition;
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static size_t pool_used_bytes(void)
+{
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  return mon.total_size - mon.free_size;
+}
+
+static void evict_page(int index)
+{
+  page_slot_t *slot = &slots[index];
+  if (slot->page->evict)
+  {
+    slot->page->evict();
+  }
+
+  lv_obj_t *screen = slot->screen;
+  portENTER_CRITICAL(&pages_lock);
+  slot->screen = NULL;
+  portEXIT_CRITICAL(&pages_lock);
+  lv_obj_delete(screen);
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Page %s evicted, %u bytes back to the LVGL pool", slot->page->name,
+                   (unsigned)slot->pool_used);
+}
+
+/**
+ * @brief Keep at most UI_PAGES_CACHED built pages besides the home page, none under high memory pressure
+ */
+static void evict_least_recent(void)
+{
+  int cached = applied_level >= MEM_PRESSURE_HIGH ? 0 : UI_PAGES_CACHED;
+  while (true)
+  {
+    int built = 0;
+    int oldest = -1;
+    for (int i = 1; i < slot_count; i++)
+    {
+      if (!slots[i].screen)
+        continue;
+      built++;
+      if (i != current_index && (oldest < 0 || slots[i].last_used < slots[oldest].last_used))
+        oldest = i;
+    }
+    if (built <= cached || oldest < 0)
+      return;
+    evict_page(oldest);
+  }
+}
+
+static bool build_page(int index)
+{
+  page_slot_t *slot = &slots[index];
+  size_t used_before = pool_used_bytes();
+
+  lv_obj_t *screen = lv_obj_create(NULL);
+  if (!screen)
+  {
+    debug_log_error_f(DEBUG_TAG_UI_DASHBOARD, "No memory for page %s", slot->page->name);
+    return false;
+  }
+  slot->page->build(screen);
+
+  size_t used_after = pool_used_bytes();
+  slot->pool_used = used_after > used_before ? (uint32_t)(used_after - used_before) : 0;
+  portENTER_CRITICAL(&pages_lock);
+  slot->screen = screen;
+  portEXIT_CRITICAL(&pages_lock);
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Page %s built, %u bytes of the LVGL pool", slot->page->name,
+                   (unsigned)slot->pool_used);
+  return true;
+}
+
+static void load_page(int index)
+{
+  lv_screen_load(slots[index].screen);
+  slots[index].last_used = ++use_clock;
+  portENTER_CRITICAL(&pages_lock);
+  current_index = index;
+  portEXIT_CRITICAL(&pages_lock);
+
+  // The page shown before may now be the oldest
+  evict_least_recent();
+}
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+
+static bool alloc_snapshots(void)
+{
+  if (transition.allocated)
+    return true;
+  // Pages switch instantly until memory is back
+  if (applied_level >= MEM_PRESSURE_ELEVATED)
+    return false;
+
+  int32_t width = lv_display_get_horizontal_resolution(NULL);
+  int32_t height = lv_display_get_vertical_resolution(NULL);
+  uint32_t stride = lv_draw_buf_width_to_stride(width, LCD_COLOR_FORMAT);
+  size_t data_size = (size_t)stride * height;
+
+  uint8_t *data[2];
+  for (int i = 0; i < 2; i++)
+  {
+    data[i] = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+  if (!data[0] || !data[1])
+  {
+    heap_caps_free(data[0]);
+    heap_caps_free(data[1]);
+    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "No PSRAM for page transitions, pages switch instantly");
+    return false;
+  }
+
+  for (int i = 0; i < 2; i++)
+  {
+    lv_draw_buf_init(&transition.shots[i], width, height, LCD_COLOR_FORMAT, stride, data[i], data_size);
+  }
+  transition.width = width;
+  transition.allocated = true;
+  return true;
+}
+
+static void slide_exec(void *var, int32_t value)
+{
+  page_transition_t *t = var;
+  int32_t offset = t->step > 0 ? -value : value;
+  lv_obj_set_x(t->images[0], offset);
+  lv_obj_set_x(t->images[1], offset + (t->step > 0 ? t->width : -t->width));
+}
+
+static void fade_exec(void *var, int32_t value)
+{
+  page_transition_t *t = var;
+  lv_obj_set_style_opa(t->images[1], (lv_opa_t)value, 0);
+}
+
+/**
+ * @brief Put the live target page on screen and drop the snapshot screen
+ */
+static void finish_transition(void)
+{
+  lv_obj_t *screen = transition.screen;
+  transition.screen = NULL;
+  load_page(transition.target);
+  lv_obj_delete(screen);
+
+  // The buffers are rewritten by the next transition
+  lv_image_cache_drop(&transition.shots[0]);
+  lv_image_cache_drop(&transition.shots[1]);
+}
+
+static void transition_completed(lv_anim_t *anim)
+{
+  LV_UNUSED(anim);
+  finish_transition();
+}
+
+static void free_snapshots(void)
+{
+  if (!transition.allocated)
+    return;
+  for (int i = 0; i < 2; i++)
+  {
+    lv_image_cache_drop(&transition.shots[i]);
+    heap_caps_free(transition.shots[i].data);
+    transition.shots[i].data = NULL;
+  }
+  transition.allocated = false;
+  debug_log_info(DEBUG_TAG_UI_DASHBOARD, "Page transition snapshots freed under memory pressure");
+}
+
+/**
+ * @brief Snapshot both pages once and animate the two images
+ * @return false if the page has to be loaded directly
+ */
+static bool start_transition(int index, int step)
+{
+  lv_obj_t *from = lv_screen_active();
+  lv_obj_t *to = slots[index].screen;
+  // Animations are paused outside the active state, e.g. on the switch to the night page
+  if (CONFIG_UI_PAGE_TRANSITION_MS == 0 || display_activity_get_state() != DISPLAY_ACTIVITY_ACTIVE ||
+      !alloc_snapshots())
+    return false;
+
+  lv_obj_update_layout(to);
+  if (lv_snapshot_take_to_draw_buf(from, LCD_COLOR_FORMAT, &transition.shots[0]) != LV_RESULT_OK ||
+      lv_snapshot_take_to_draw_buf(to, LCD_COLOR_FORMAT, &transition.shots[1]) != LV_RESULT_OK)
+    return false;
+
+  lv_obj_t *screen = lv_obj_create(NULL);
+  if (!screen)
+    return false;
+  lv_obj_remove_style_all(screen);
+  lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(screen, LV_OPA_COVER, 0);
+  lv_obj_remove_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+
+  for (int i = 0; i < 2; i++)
+  {
+    transition.images[i] = lv_image_create(screen);
+    lv_image_set_src(transition.images[i], &transition.shots[i]);
+    lv_obj_set_pos(transition.images[i], 0, 0);
+  }
+  transition.screen = screen;
+  transition.target = index;
+  transition.step = step > 0 ? 1 : (step < 0 ? -1 : 0);
+
+  lv_anim_t anim;
+  lv_anim_init(&anim);
+  lv_anim_set_var(&anim, &transition);
+  if (transition.step)
+  {
+    lv_anim_set_exec_cb(&anim, slide_exec);
+    lv_anim_set_values(&anim, 0, transition.width);
+  }
+  else
+  {
+    lv_anim_set_exec_cb(&anim, fade_exec);
+    lv_anim_set_values(&anim, LV_OPA_TRANSP, LV_OPA_COVER);
+  }
+  lv_anim_set_duration(&anim, CONFIG_UI_PAGE_TRANSITION_MS);
+  lv_anim_set_path_cb(&anim, lv_anim_path_ease_out);
+  lv_anim_set_completed_cb(&anim, transition_completed);
+  anim.exec_cb(&transition, anim.start_value);
+
+  lv_screen_load(screen);
+  lv_anim_start(&anim);
+  return true;
+}
+
+#endif // CONFIG_UI_PAGE_TRANSITIONS
+
+static void open_page(int index, int step)
+{
+  if (index == current_index && slots[index].screen)
+    return;
+
+  if (!slots[index].screen && !build_page(index))
+    return;
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+  if (start_transition(index, step))
+    return;
+#else
+  LV_UNUSED(step);
+#endif
+  load_page(index);
+}
+
+static void reply_error(const char *message)
+{
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "PAGES {\"error\":\"%s\"}\n", message);
+  serial_data_write(buf, len);
+}
+
+/**
+ * @brief Memory governor shed callback, the LVGL task acts on it
+ */
+static void pages_shed(mem_pressure_t level, void *ctx)
+{
+  (void)ctx;
+  portENTER_CRITICAL(&pages_lock);
+  shed_level = level;
+  portEXIT_CRITICAL(&pages_lock);
+  lvgl_setup_wake_task();
+}
+
+/**
+ * @brief Give back snapshots and cached pages as the pressure level asks
+ */
+static void apply_shed_level(mem_pressure_t level)
+{
+  applied_level = level;
+#if CONFIG_UI_PAGE_TRANSITIONS
+  if (level >= MEM_PRESSURE_ELEVATED)
+    free_snapshots();
+#endif
+  evict_least_recent();
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_pages_init(lv_obj_t *home_screen)
+{
+  slots[0].page = &home_page;
+  slots[0].screen = home_screen;
+  slots[0].last_used = ++use_clock;
+  slot_count = 1;
+  current_index = 0;
+  mem_governor_register("pages", MEM_GOVERNOR_REGION(HEAP_REGION_INTERNAL) | MEM_GOVERNOR_REGION(HEAP_REGION_SPIRAM),
+                        pages_shed, NULL);
+}
+
+int ui_pages_register(const ui_page_t *page)
+{
+  if (!page || !page->name || !page->build || slot_count == 0 || slot_count >= UI_PAGES_MAX)
+    return -1;
+
+  memset(&slots[slot_count], 0, sizeof(slots[slot_count]));
+  slots[slot_count].page = page;
+  return slot_count++;
+}
+
+void ui_pages_show(int index)
+{
+  portENTER_CRITICAL(&pages_lock);
+  pending_index = index;
+  pending_step = 0;
+  portEXIT_CRITICAL(&pages_lock);
+  lvgl_setup_wake_task();
+}
+
+void ui_pages_show_relative(int step)
+{
+  portENTER_CRITICAL(&pages_lock);
+  pending_index = -1;
+  pending_step += step;
+  portEXIT_CRITICAL(&pages_lock);
+  lvgl_setup_wake_task();
+}
+
+void ui_pages_process_updates(void)
+{
+  portENTER_CRITICAL(&pages_lock);
+  int index = pending_index;
+  int step = pending_step;
+  mem_pressure_t level = shed_level;
+  pending_index = -1;
+  pending_step = 0;
+  portEXIT_CRITICAL(&pages_lock);
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+  // The snapshots on screen and the page being opened wait for the transition to end
+  bool shed_due = !transition.screen && (level != applied_level || (level >= MEM_PRESSURE_ELEVATED && transition.allocated));
+#else
+  bool shed_due = level != applied_level;
+#endif
+  if (shed_due)
+    apply_shed_level(level);
+
+  if (slot_count == 0 || (index < 0 && step == 0))
+    return;
+
+#if CONFIG_UI_PAGE_TRANSITIONS
+  // A new request cuts the running transition short, the step counts from its target
+  if (transition.screen)
+  {
+    lv_anim_delete(&transition, NULL);
+    finish_transition();
+  }
+#endif
+
+  if (index < 0)
+  {
+    index = ((current_index + step) % slot_count + slot_count) % slot_count;
+  }
+  if (index < slot_count)
+  {
+    open_page(index, step);
+  }
+}
+
+bool ui_pages_handle_command(const char *line)
+{
+  if (strncmp(line, "SHOW_PAGE ", 10) == 0)
+  {
+    const char *name = line + 10;
+    for (int i = 0; i < slot_count; i++)
+    {
+      if (strcmp(slots[i].page->name, name) == 0)
+      {
+        ui_pages_show(i);
+        static const char ok[] = "PAGES {\"ok\":true}\n";
+        serial_data_write(ok, sizeof(ok) - 1);
+        return true;
+      }
+    }
+    reply_error("unknown page");
+    return true;
+  }
+  if (strcmp(line, "GET_PAGES") != 0)
+    return false;
+
+  char buf[128];
+  portENTER_CRITICAL(&pages_lock);
+  int current = current_index;
+  portEXIT_CRITICAL(&pages_lock);
+  int len = snprintf(buf, sizeof(buf), "PAGES {\"current\":\"%s\",\"cached\":%d,\"pages\":[",
+                     slot_count ? slots[current].page->name : "", UI_PAGES_CACHED);
+  serial_data_write(buf, len);
+
+  for (int i = 0; i < slot_count; i++)
+  {
+    portENTER_CRITICAL(&pages_lock);
+    bool built = slots[i].screen != NULL;
+    portEXIT_CRITICAL(&pages_lock);
+    len = snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"built\":%s,\"pool_bytes\":%lu}", i ? "," : "",
+                   slots[i].page->name, built ? "true" : "false", (unsigned long)slots[i].pool_used);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+  return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ui_pages.h
+ * @brief Screen pages built on first use and evicted least recently used
+ *
+ * The dashboard is the home page: it is built at startup and never
+ * evicted. Every other page is only a build function until it is first
+ * opened. Opening builds it onto a fresh screen; once more than
+ * UI_PAGES_CACHED pages besides the home page are built, the one used
+ * longest ago is deleted and its LVGL memory returns to the pool. Memory
+ * therefore follows what has been looked at recently, not how many pages
+ * exist.
+ *
+ * With CONFIG_UI_PAGE_TRANSITIONS a page change snapshots the outgoing
+ * and incoming page into PSRAM once and animates only those two images,
+ * sliding for next/previous and fading for a direct jump. An unscaled,
+ * opaque image in the display's color format is drawn as a row copy, so
+ * each frame costs a PSRAM read instead of a redraw of every widget. The
+ * live page is loaded when the animation ends.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "lvgl.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Registered pages, the home page included
+#define UI_PAGES_MAX 8
+
+// Built pages kept besides the home page
+#ifdef CONFIG_UI_PAGES_CACHED
+#define UI_PAGES_CACHED CONFIG_UI_PAGES_CACHED
+#else
+#define UI_PAGES_CACHED 1
+#endif
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+/**
+ * @brief A lazily built page
+ */
+typedef struct
+{
+  const char *name;
+  void (*build)(lv_obj_t *screen); ///< Create the widgets on an empty screen
+  void (*evict)(void);             ///< Drop widget pointers and timers, the screen is deleted right after; may be NULL
+} ui_page_t;
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Adopt the already built active screen as the home page
+ * @param home_screen Screen holding the dashboard
+ * @note LVGL lock held, call before registering other pages
+ */
+void ui_pages_init(lv_obj_t *home_screen);
+
+/**
+ * @brief Register a page, nothing is built yet
+ * @param page Page description, must stay valid
+ * @return Page index, -1 if the table is full
+ * @note LVGL lock held; pages are ordered as registered
+ */
+int ui_pages_register(const ui_page_t *page);
+
+/**
+ * @brief Ask for a page to be shown
+ * @param index Page index from ui_pages_register(), 0 for the home page
+ * @note Safe from any task, applied by the LVGL task
+ */
+void ui_pages_show(int index);
+
+/**
+ * @brief Ask for the next or previous page, wrapping around
+ * @param step +1 for the next page, -1 for the previous one
+ * @note Safe from any task, applied by the LVGL task
+ */
+void ui_pages_show_relative(int step);
+
+/**
+ * @brief Apply a pending page change (LVGL task only, lock held)
+ */
+void ui_pages_process_updates(void);
+
+/**
+ * @brief Handle SHOW_PAGE <name> and GET_PAGES
+ * @param line Trimmed command line from the serial port
+ * @return true if the line was a page command
+ */
+bool ui_pages_handle_command(const char *line);
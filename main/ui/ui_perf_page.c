@@ -0,0 +1,409 @@
+/**
+ * @file ui_perf_page.c
+ * @brief Performance overlay page with trend graphs, built on first use
+ *
+ * Six small line charts of the last minute: frame rate, render time, free
+ * heap per region, core load, serial samples per second and HA request
+ * latency, all read from the metrics registry by name. A line below them
+ * names the busiest tasks from the task profiler. Samples are taken for as
+ * long as the page is built, shown or not, so the trend is already there
+ * when it is opened again; everything goes when the page is evicted.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_perf_page.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "metrics.h"
+#include "task_profiler.h"
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "ui_pages.h"
+
+#define PERF_PAGE_SAMPLE_MS 1000
+#define PERF_PAGE_POINTS 60 // One minute at PERF_PAGE_SAMPLE_MS
+#define PERF_PAGE_GRAPHS 6
+#define PERF_PAGE_MAX_SERIES 2
+#define PERF_PAGE_TOP_TASKS 4
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef enum
+{
+  TREND_GAUGE, ///< Plot the value as read
+  TREND_RATE,  ///< Plot a counter's increase per second
+  TREND_MEAN,  ///< Plot the mean of a histogram's observations since the last sample
+} trend_kind_t;
+
+typedef struct
+{
+  const char *metric;
+  const char *labels;
+  trend_kind_t kind;
+  uint32_t div; ///< Raw units per plotted unit
+  uint32_t color;
+  bool secondary; ///< Plotted against its own axis
+} trend_series_def_t;
+
+typedef struct
+{
+  const char *title;
+  const char *unit;
+  bool tenths;       ///< Plotted values are tenths of the unit
+  int32_t fixed_max; ///< Fixed axis top, 0 to follow the data
+  uint8_t series_count;
+  trend_series_def_t series[PERF_PAGE_MAX_SERIES];
+} trend_graph_def_t;
+
+typedef struct
+{
+  const metric_t *metric; ///< NULL if the module is not built in or not started
+  lv_chart_series_t *series;
+  int64_t last_value; ///< Counter, or histogram sum, at the previous sample
+  int64_t last_count; ///< Histogram count at the previous sample
+  int32_t shown;      ///< Newest plotted value
+  bool primed;
+} trend_series_t;
+
+typedef struct
+{
+  lv_obj_t *chart;
+  lv_obj_t *value_label;
+  trend_series_t series[PERF_PAGE_MAX_SERIES];
+} trend_graph_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static const trend_graph_def_t graph_defs[PERF_PAGE_GRAPHS] = {
+    {.title = "FPS",
+     .tenths = true,
+     .series_count = 1,
+     .series = {{.metric = "display_fps_x10", .kind = TREND_GAUGE, .div = 1, .color = 0x4fc3f7}}},
+    {.title = "Render",
+     .unit = " ms",
+     .tenths = true,
+     .series_count = 1,
+     .series = {{.metric = "display_render_us", .kind = TREND_GAUGE, .div = 100, .color = 0xff7043}}},
+    {.title = "Heap free int / PSRAM",
+     .unit = " KB",
+     .series_count = 2,
+     .series = {{.metric = "heap_free_bytes",
+                 .labels = "region=\"internal\"",
+                 .kind = TREND_GAUGE,
+                 .div = 1024,
+                 .color = 0x4fc3f7},
+                {.metric = "heap_free_bytes",
+                 .labels = "region=\"spiram\"",
+                 .kind = TREND_GAUGE,
+                 .div = 1024,
+                 .color = 0x81c784,
+                 .secondary = true}}},
+    {.title = "CPU core 0 / 1",
+     .unit = " %",
+     .fixed_max = 100,
+     .series_count = 2,
+     .series = {{.metric = "cpu_load_permille",
+                 .labels = "core=\"0\"",
+                 .kind = TREND_GAUGE,
+                 .div = 10,
+                 .color = 0x4fc3f7},
+                {.metric = "cpu_load_permille",
+                 .labels = "core=\"1\"",
+                 .kind = TREND_GAUGE,
+                 .div = 10,
+                 .color = 0xff7043}}},
+    {.title = "Serial samples",
+     .unit = " /s",
+     .series_count = 1,
+     .series = {{.metric = "serial_samples_total", .kind = TREND_RATE, .div = 1, .color = 0x81c784}}},
+    {.title = "HA latency",
+     .unit = " ms",
+     .series_count = 1,
+     .series = {{.metric = "ha_request_duration_ms", .kind = TREND_MEAN, .div = 1, .color = 0xffd54f}}},
+};
+
+static trend_graph_t graphs[PERF_PAGE_GRAPHS];
+static lv_obj_t *tasks_label = NULL;
+static lv_timer_t *sample_timer = NULL;
+static task_profile_t *task_buf = NULL; // PSRAM, only while built
+static int64_t last_sample_us = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Next plotted value of one series
+ * @return LV_CHART_POINT_NONE when there is nothing to plot, such as no HA request since the last sample
+ */
+static int32_t sample_series(const trend_series_def_t *def, trend_series_t *s, int64_t elapsed_ms)
+{
+  if (!s->metric)
+  {
+    return LV_CHART_POINT_NONE;
+  }
+
+  int64_t value = LV_CHART_POINT_NONE;
+  switch (def->kind)
+  {
+  case TREND_GAUGE:
+    value = metrics_read(s->metric) / def->div;
+    break;
+
+  case TREND_RATE:
+  {
+    int64_t now = metrics_read(s->metric);
+    // 32-bit counters wrap, skip that sample
+    if (s->primed && elapsed_ms > 0 && now >= s->last_value)
+      value = (now - s->last_value) * 1000 / elapsed_ms / def->div;
+    s->last_value = now;
+    break;
+  }
+
+  case TREND_MEAN:
+  {
+    uint64_t count, sum;
+    metrics_histogram_totals((const metric_histogram_t *)s->metric, &count, &sum);
+    if (s->primed && (int64_t)count > s->last_count)
+      value = ((int64_t)sum - s->last_value) / ((int64_t)count - s->last_count) / def->div;
+    s->last_value = (int64_t)sum;
+    s->last_count = (int64_t)count;
+    break;
+  }
+  }
+
+  s->primed = true;
+  return value > INT32_MAX ? INT32_MAX : (int32_t)value;
+}
+
+/**
+ * @brief Scale one axis to a quarter above the largest point shown
+ */
+static void fit_axis(const trend_graph_def_t *def, trend_graph_t *graph, bool secondary)
+{
+  int32_t max = 0;
+  bool any = false;
+  for (int i = 0; i < def->series_count; i++)
+  {
+    if (def->series[i].secondary != secondary || !graph->series[i].series)
+      continue;
+
+    const int32_t *points = lv_chart_get_y_array(graph->chart, graph->series[i].series);
+    for (int p = 0; p < PERF_PAGE_POINTS; p++)
+    {
+      if (points[p] != LV_CHART_POINT_NONE && points[p] >= max)
+      {
+        max = points[p];
+        any = true;
+      }
+    }
+  }
+
+  if (any)
+  {
+    lv_chart_set_range(graph->chart, secondary ? LV_CHART_AXIS_SECONDARY_Y : LV_CHART_AXIS_PRIMARY_Y, 0,
+                       max + max / 4 + 1);
+  }
+}
+
+static void update_value_label(const trend_graph_def_t *def, const trend_graph_t *graph)
+{
+  char text[48];
+  int len = 0;
+  for (int i = 0; i < def->series_count && len < (int)sizeof(text); i++)
+  {
+    int32_t v = graph->series[i].shown;
+    const char *sep = i ? " / " : "";
+    if (v == LV_CHART_POINT_NONE)
+      len += snprintf(text + len, sizeof(text) - len, "%s--", sep);
+    else if (def->tenths)
+      len += snprintf(text + len, sizeof(text) - len, "%s%ld.%ld", sep, (long)(v / 10), (long)(v % 10));
+    else
+      len += snprintf(text + len, sizeof(text) - len, "%s%ld", sep, (long)v);
+  }
+  if (len < (int)sizeof(text))
+    snprintf(text + len, sizeof(text) - len, "%s", def->unit ? def->unit : "");
+  lv_label_set_text(graph->value_label, text);
+}
+
+static void update_top_tasks(void)
+{
+  int count = task_buf ? task_profiler_snapshot(task_buf, TASK_PROFILER_MAX_TASKS, NULL) : 0;
+  if (count == 0)
+  {
+    lv_label_set_text(tasks_label, "Top tasks: profiler not running");
+    return;
+  }
+
+  char text[160];
+  int len = snprintf(text, sizeof(text), "Top tasks:");
+  for (int rank = 0; rank < PERF_PAGE_TOP_TASKS && rank < count; rank++)
+  {
+    // Partial selection sort, only the first few places matter
+    int best = rank;
+    for (int i = rank + 1; i < count; i++)
+    {
+      if (task_buf[i].cpu_permille > task_buf[best].cpu_permille)
+        best = i;
+    }
+    task_profile_t tmp = task_buf[rank];
+    task_buf[rank] = task_buf[best];
+    task_buf[best] = tmp;
+
+    if (len < (int)sizeof(text))
+    {
+      len += snprintf(text + len, sizeof(text) - len, "%s %s %u.%u%%", rank ? "," : "", task_buf[rank].name,
+                      task_buf[rank].cpu_permille / 10, task_buf[rank].cpu_permille % 10);
+    }
+  }
+  lv_label_set_text(tasks_label, text);
+}
+
+static void sample(void)
+{
+  int64_t now = esp_timer_get_time();
+  int64_t elapsed_ms = (now - last_sample_us) / 1000;
+  last_sample_us = now;
+
+  for (int g = 0; g < PERF_PAGE_GRAPHS; g++)
+  {
+    const trend_graph_def_t *def = &graph_defs[g];
+    trend_graph_t *graph = &graphs[g];
+    bool has_secondary = false;
+    for (int i = 0; i < def->series_count; i++)
+    {
+      trend_series_t *s = &graph->series[i];
+      s->shown = sample_series(&def->series[i], s, elapsed_ms);
+      lv_chart_set_next_value(graph->chart, s->series, s->shown);
+      has_secondary |= def->series[i].secondary;
+    }
+
+    if (!def->fixed_max)
+    {
+      fit_axis(def, graph, false);
+      if (has_secondary)
+        fit_axis(def, graph, true);
+    }
+  }
+}
+
+static void update_labels(void)
+{
+  for (int g = 0; g < PERF_PAGE_GRAPHS; g++)
+  {
+    update_value_label(&graph_defs[g], &graphs[g]);
+  }
+  update_top_tasks();
+}
+
+static void sample_cb(lv_timer_t *timer)
+{
+  sample();
+
+  // Numbers and the task list are only read off the page while it is shown
+  if (lv_obj_get_screen(tasks_label) != lv_screen_active())
+    return;
+  update_labels();
+}
+
+static void build_graph(lv_obj_t *screen, int g)
+{
+  const trend_graph_def_t *def = &graph_defs[g];
+  trend_graph_t *graph = &graphs[g];
+
+  lv_obj_t *panel = ui_create_panel(screen, 256, 200, 8 + (g % 3) * 264, 8 + (g / 3) * 208, 0x1a1a2e, 0x16213e);
+  lv_obj_remove_flag(panel, LV_OBJ_FLAG_SCROLLABLE);
+
+  lv_obj_t *title = lv_label_create(panel);
+  lv_label_set_text(title, def->title);
+  lv_obj_add_style(title, ui_get_text_style(font_small, 0xaaaaaa), 0);
+  lv_obj_align(title, LV_ALIGN_TOP_LEFT, 0, 0);
+
+  graph->value_label = lv_label_create(panel);
+  lv_label_set_text(graph->value_label, "--");
+  lv_obj_add_style(graph->value_label, ui_get_text_style(font_normal, def->series[0].color), 0);
+  lv_obj_align(graph->value_label, LV_ALIGN_TOP_RIGHT, 0, -4);
+
+  graph->chart = lv_chart_create(panel);
+  lv_obj_set_size(graph->chart, 222, 140);
+  lv_obj_align(graph->chart, LV_ALIGN_BOTTOM_MID, 0, 0);
+  lv_chart_set_type(graph->chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(graph->chart, PERF_PAGE_POINTS);
+  lv_chart_set_update_mode(graph->chart, LV_CHART_UPDATE_MODE_SHIFT);
+  lv_chart_set_div_line_count(graph->chart, 4, 0);
+  lv_obj_set_style_bg_opa(graph->chart, LV_OPA_TRANSP, 0);
+  lv_obj_set_style_border_width(graph->chart, 0, 0);
+  lv_obj_set_style_pad_all(graph->chart, 0, 0);
+  lv_obj_set_style_line_color(graph->chart, lv_color_hex(0x333344), LV_PART_MAIN);
+  lv_obj_set_style_size(graph->chart, 0, 0, LV_PART_INDICATOR);
+  if (def->fixed_max)
+    lv_chart_set_range(graph->chart, LV_CHART_AXIS_PRIMARY_Y, 0, def->fixed_max);
+
+  for (int i = 0; i < def->series_count; i++)
+  {
+    const trend_series_def_t *sdef = &def->series[i];
+    trend_series_t *s = &graph->series[i];
+    s->metric = metrics_find(sdef->metric, sdef->labels);
+    s->series = lv_chart_add_series(graph->chart, lv_color_hex(sdef->color),
+                                    sdef->secondary ? LV_CHART_AXIS_SECONDARY_Y : LV_CHART_AXIS_PRIMARY_Y);
+  }
+}
+
+static void build(lv_obj_t *screen)
+{
+  for (int g = 0; g < PERF_PAGE_GRAPHS; g++)
+  {
+    build_graph(screen, g);
+  }
+
+  tasks_label = lv_label_create(screen);
+  lv_label_set_text(tasks_label, "Top tasks: --");
+  lv_obj_add_style(tasks_label, ui_get_text_style(font_small, 0xdddddd), 0);
+  lv_obj_align(tasks_label, LV_ALIGN_BOTTOM_LEFT, 12, -36);
+
+  lv_obj_t *hint = lv_label_create(screen);
+  lv_label_set_text(hint, "Swipe with two fingers to change pages");
+  lv_obj_add_style(hint, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -10);
+
+  task_buf = heap_caps_malloc(TASK_PROFILER_MAX_TASKS * sizeof(task_profile_t), MALLOC_CAP_SPIRAM);
+
+  // The first sample only primes the rates
+  last_sample_us = esp_timer_get_time();
+  sample_timer = lv_timer_create(sample_cb, PERF_PAGE_SAMPLE_MS, NULL);
+  sample();
+  update_labels();
+}
+
+static void evict(void)
+{
+  lv_timer_delete(sample_timer);
+  sample_timer = NULL;
+  heap_caps_free(task_buf);
+  task_buf = NULL;
+  memset(graphs, 0, sizeof(graphs));
+  tasks_label = NULL;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_perf_page_register(void)
+{
+  static const ui_page_t page = {
+      .name = "perf",
+      .build = build,
+      .evict = evict,
+  };
+  ui_pages_register(&page);
+}
@@ -0,0 +1,14 @@
+/**
+ * @file ui_perf_page.h
+ * @brief Performance overlay page with trend graphs, built on first use
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+/**
+ * @brief Register the page with ui_pages, nothing is built until it is opened
+ */
+void ui_perf_page_register(void);
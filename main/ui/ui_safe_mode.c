@@ -0,0 +1,57 @@
+/**
+ * @file ui_safe_mode.c
+ * @brief Single status screen of the safe-mode boot
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_safe_mode.h"
+
+#include <stdio.h>
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "utils/crash_log_manager.h"
+#include "utils/safe_mode.h"
+
+#define SAFE_MODE_ACCENT 0xff9800
+
+void ui_safe_mode_create(lv_display_t *disp)
+{
+  // Fonts stay the compiled-in defaults, the asset pack may be what crashed
+  lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_ORANGE), lv_palette_main(LV_PALETTE_RED),
+                        LV_THEME_DEFAULT_DARK, font_normal);
+  lv_obj_t *screen = lv_display_get_screen_active(disp);
+
+  lv_obj_t *panel = ui_create_panel(screen, 780, 460, 10, 10, 0x1a1a2e, 0x16213e);
+  ui_create_title_with_separator(panel, "Safe Mode", SAFE_MODE_ACCENT, 750);
+
+  safe_mode_status_t status;
+  safe_mode_get_status(&status);
+
+  char text[256];
+  int len = snprintf(text, sizeof(text),
+                     "The dashboard crashed %u times in a row while starting up.\n"
+                     "Home Assistant, WiFi and the saved UI state are not loaded.",
+                     status.crashes);
+
+  crash_log_entry_t entry;
+  if (crash_log_get_entry(0, &entry) == ESP_OK && len < (int)sizeof(text))
+  {
+    snprintf(text + len, sizeof(text) - len, "\n\nLast crash: %s in task %s at 0x%08lx",
+             crash_log_reason_name(entry.reset_reason), entry.task[0] ? entry.task : "?", (unsigned long)entry.pc);
+  }
+
+  lv_obj_t *summary = lv_label_create(panel);
+  lv_label_set_text(summary, text);
+  lv_obj_set_width(summary, 750);
+  lv_obj_add_style(summary, ui_get_text_style(font_normal, 0xdddddd), 0);
+  lv_obj_align(summary, LV_ALIGN_TOP_LEFT, 0, 60);
+
+  lv_obj_t *hint = lv_label_create(panel);
+  lv_label_set_text(hint, "GET_CRASH_LOG over serial lists the crashes.\n"
+                          "SAFE_MODE_EXIT or a power cycle tries a normal boot again.");
+  lv_obj_set_width(hint, 750);
+  lv_obj_add_style(hint, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(hint, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+}
@@ -0,0 +1,21 @@
+/**
+ * @file ui_safe_mode.h
+ * @brief Single status screen of the safe-mode boot
+ *
+ * Built instead of the dashboard when utils/safe_mode detects a crash
+ * loop. It uses the compiled-in fonts only and nothing from the asset
+ * pack, the registry or the cached state, and never changes once drawn.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Build the safe-mode screen, for lvgl_setup_create_ui_safe()
+ * @param disp Display to build on
+ */
+void ui_safe_mode_create(lv_display_t *disp);
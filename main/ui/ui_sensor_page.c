@@ -0,0 +1,295 @@
+/**
+ * @file ui_sensor_page.c
+ * @brief Sensor tiles page, built on first use
+ *
+ * The newest snapshot is kept while the page is not built, 16 bytes per
+ * entity, and drawn in one go when it is opened. Each tile also shows how
+ * long ago HA last saw the reading change, once the clock is synced.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_sensor_page.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lvgl_setup.h"
+#include "smart/ha_entity_registry.h"
+#include "system_debug_utils.h"
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "ui_pages.h"
+#include "wifi/wifi_time_sync.h"
+
+#define SENSOR_TILE_COLUMNS 4
+#define SENSOR_TILE_WIDTH 177
+#define SENSOR_TILE_HEIGHT 100
+#define SENSOR_TILE_GAP 10
+
+#define SENSOR_VALUE_COLOR 0x4fc3f7
+
+/** Seconds between refreshes of the "N min ago" labels */
+#define SENSOR_AGE_REFRESH_S 30
+
+/** Opacity of readings HA reports as unavailable or unknown */
+#define SENSOR_STALE_OPA LV_OPA_40
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  lv_obj_t *value;
+  lv_obj_t *unit;
+  lv_obj_t *age;
+  uint8_t index; ///< Registry index
+  bool drawn;    ///< shown holds what the labels display
+  ha_entity_state_t shown;
+} sensor_tile_t;
+
+typedef struct
+{
+  int count;
+  ha_entity_state_t states[HA_REGISTRY_MAX_ENTITIES];
+} sensor_states_msg_t;
+
+static QueueHandle_t states_mailbox = NULL;
+
+// LVGL task only
+static ha_entity_state_t latest[HA_REGISTRY_MAX_ENTITIES];
+static int latest_count = 0;
+static bool latest_dirty = false;
+static sensor_tile_t tiles[HA_REGISTRY_MAX_ENTITIES];
+static int tile_count = 0; ///< 0 while the page is not built
+static time_t ages_drawn_at = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Reading with as many decimals as fit a tile, "21.5", "1234", "0.42"
+ */
+static void format_reading(float value, char *text, size_t size)
+{
+  float magnitude = fabsf(value);
+  if (value == truncf(value) || magnitude >= 1000.0f)
+    snprintf(text, size, "%.0f", (double)value);
+  else if (magnitude >= 1.0f)
+    snprintf(text, size, "%.1f", (double)value);
+  else
+    snprintf(text, size, "%.2f", (double)value);
+}
+
+static void draw_tile(sensor_tile_t *tile, const ha_entity_state_t *state)
+{
+  bool numeric = state->kind == HA_STATE_NUMERIC;
+  bool was_numeric = tile->drawn && tile->shown.kind == HA_STATE_NUMERIC;
+
+  char text[24];
+  if (numeric)
+    format_reading(state->value, text, sizeof(text));
+  else
+    ha_entity_state_format(state, text, sizeof(text));
+
+  // The big number font only holds digits and units
+  if (!tile->drawn || numeric != was_numeric)
+    lv_obj_set_style_text_font(tile->value, numeric ? font_big_numbers : font_title, 0);
+  lv_label_set_text(tile->value, text);
+
+  if (!tile->drawn || !numeric || !was_numeric || tile->shown.text != state->text)
+    lv_label_set_text(tile->unit, ha_entity_state_unit(state));
+
+  bool stale = state->kind == HA_STATE_UNAVAILABLE || state->kind == HA_STATE_UNKNOWN;
+  lv_obj_set_style_opa(tile->value, stale ? SENSOR_STALE_OPA : LV_OPA_COVER, 0);
+
+  tile->shown = *state;
+  tile->drawn = true;
+}
+
+/**
+ * @brief Redraw the tiles whose entity changed since they were drawn
+ */
+static void draw_changed_tiles(void)
+{
+  for (int i = 0; i < tile_count; i++)
+  {
+    sensor_tile_t *tile = &tiles[i];
+    if (tile->index >= latest_count)
+      continue;
+    const ha_entity_state_t *state = &latest[tile->index];
+    if (!state->found || (tile->drawn && ha_entity_state_same(&tile->shown, state)))
+      continue;
+    draw_tile(tile, state);
+  }
+}
+
+/**
+ * @brief Set every tile's "changed N min ago" label, blank before time sync
+ */
+static void draw_ages(void)
+{
+  uint32_t now = wifi_time_sync_is_valid() ? (uint32_t)time(NULL) : 0;
+  for (int i = 0; i < tile_count; i++)
+  {
+    sensor_tile_t *tile = &tiles[i];
+    uint32_t since = tile->index < latest_count && latest[tile->index].found ? latest[tile->index].last_changed : 0;
+
+    char text[20];
+    ha_format_age(since, now, text, sizeof(text));
+    if (strcmp(text, lv_label_get_text(tile->age)) != 0)
+      lv_label_set_text(tile->age, text);
+  }
+  ages_drawn_at = time(NULL);
+}
+
+static void create_tile(lv_obj_t *parent, int slot, int index)
+{
+  const ha_entity_record_t *record = ha_registry_get(index);
+  int x = (slot % SENSOR_TILE_COLUMNS) * (SENSOR_TILE_WIDTH + SENSOR_TILE_GAP);
+  int y = (slot / SENSOR_TILE_COLUMNS) * (SENSOR_TILE_HEIGHT + SENSOR_TILE_GAP);
+  lv_obj_t *tile = ui_create_panel(parent, SENSOR_TILE_WIDTH, SENSOR_TILE_HEIGHT, x, y, 0x16213e, 0x2e2e4a);
+
+  lv_obj_t *name = lv_label_create(tile);
+  lv_label_set_text(name, record->label);
+  lv_label_set_long_mode(name, LV_LABEL_LONG_DOT);
+  lv_obj_set_width(name, SENSOR_TILE_WIDTH - 70);
+  lv_obj_add_style(name, ui_get_text_style(font_small, 0xaaaaaa), 0);
+  lv_obj_align(name, LV_ALIGN_TOP_LEFT, 0, 0);
+
+  sensor_tile_t *entry = &tiles[slot];
+  memset(entry, 0, sizeof(*entry));
+  entry->index = (uint8_t)index;
+
+  entry->unit = lv_label_create(tile);
+  lv_label_set_text(entry->unit, "");
+  lv_obj_add_style(entry->unit, ui_get_text_style(font_normal, 0xaaaaaa), 0);
+  lv_obj_align(entry->unit, LV_ALIGN_TOP_RIGHT, 0, 0);
+  ui_mark_dynamic(entry->unit);
+
+  entry->age = lv_label_create(tile);
+  lv_label_set_text(entry->age, "");
+  lv_obj_add_style(entry->age, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(entry->age, LV_ALIGN_TOP_LEFT, 0, 18);
+  ui_mark_dynamic(entry->age);
+
+  entry->value = lv_label_create(tile);
+  lv_label_set_text(entry->value, "--");
+  lv_obj_add_style(entry->value, ui_get_text_style(font_big_numbers, SENSOR_VALUE_COLOR), 0);
+  lv_obj_align(entry->value, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+  ui_mark_dynamic(entry->value);
+}
+
+static void build(lv_obj_t *screen)
+{
+  lv_obj_t *panel = ui_create_panel(screen, 780, 430, 10, 10, 0x1a1a2e, 0x16213e);
+  ui_create_title_with_separator(panel, "Sensors", 0x4fc3f7, 750);
+
+  lv_obj_t *grid = lv_obj_create(panel);
+  lv_obj_remove_style_all(grid);
+  lv_obj_set_size(grid, 750, 340);
+  lv_obj_set_pos(grid, 0, 50);
+  lv_obj_set_scroll_dir(grid, LV_DIR_VER);
+  lv_obj_set_scrollbar_mode(grid, LV_SCROLLBAR_MODE_AUTO);
+
+  int count = 0;
+  for (int i = 0; i < ha_registry_count(); i++)
+  {
+    const ha_entity_record_t *record = ha_registry_get(i);
+    if (record && ha_registry_is_sensor(record->domain))
+      create_tile(grid, count++, i);
+  }
+  tile_count = count;
+
+  if (count == 0)
+  {
+    lv_obj_t *empty = lv_label_create(grid);
+    lv_label_set_text(empty, "No sensors registered, add one with HA_ENTITY_ADD sensor.<name> <label>");
+    lv_obj_add_style(empty, ui_get_text_style(font_normal, 0x888888), 0);
+    lv_obj_align(empty, LV_ALIGN_TOP_LEFT, 0, 10);
+  }
+
+  lv_obj_t *hint = lv_label_create(screen);
+  lv_label_set_text(hint, "Swipe with two fingers to change pages");
+  lv_obj_add_style(hint, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -10);
+
+  draw_changed_tiles();
+  draw_ages();
+}
+
+static void evict(void)
+{
+  tile_count = 0;
+  memset(tiles, 0, sizeof(tiles));
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_sensor_page_register(void)
+{
+  static const ui_page_t page = {
+      .name = "sensors",
+      .build = build,
+      .evict = evict,
+  };
+  if (!states_mailbox)
+  {
+    states_mailbox = xQueueCreate(1, sizeof(sensor_states_msg_t));
+    if (!states_mailbox)
+    {
+      debug_log_error(DEBUG_TAG_UI_DASHBOARD, "Failed to create sensor page mailbox");
+      return;
+    }
+  }
+  ui_pages_register(&page);
+}
+
+void ui_sensor_page_set_entity_states(const ha_entity_state_t *states, int count)
+{
+  sensor_states_msg_t msg;
+
+  if (!states_mailbox || !states || count <= 0)
+    return;
+  if (count > HA_REGISTRY_MAX_ENTITIES)
+    count = HA_REGISTRY_MAX_ENTITIES;
+
+  msg.count = count;
+  memcpy(msg.states, states, count * sizeof(ha_entity_state_t));
+  xQueueOverwrite(states_mailbox, &msg);
+  lvgl_setup_wake_task();
+}
+
+void ui_sensor_page_process_updates(void)
+{
+  static sensor_states_msg_t msg; // LVGL task only
+
+  if (states_mailbox && xQueueReceive(states_mailbox, &msg, 0) == pdTRUE)
+  {
+    memcpy(latest, msg.states, msg.count * sizeof(ha_entity_state_t));
+    latest_count = msg.count;
+    latest_dirty = true;
+  }
+
+  // Not built: the snapshot waits in latest until the page is opened
+  if (tile_count == 0)
+    return;
+  if (latest_dirty)
+  {
+    latest_dirty = false;
+    draw_changed_tiles();
+    draw_ages();
+  }
+  else if (time(NULL) - ages_drawn_at >= SENSOR_AGE_REFRESH_S)
+  {
+    draw_ages();
+  }
+}
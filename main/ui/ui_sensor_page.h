@@ -0,0 +1,37 @@
+/**
+ * @file ui_sensor_page.h
+ * @brief Sensor tiles page, built on first use
+ *
+ * One tile per sensor and binary_sensor in the entity registry: label,
+ * reading and unit. Tiles take their states from the same snapshots as the
+ * controls panel; while the WebSocket is subscribed those sensors are
+ * left out of REST syncs and only change through pushed events. A tile is
+ * redrawn only when its compact state record differs from the one it
+ * shows, so idle sensors cost nothing.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "smart/ha_entity_state.h"
+
+/**
+ * @brief Register the page with ui_pages, nothing is built until it is opened
+ * @note LVGL lock held, call after the entity registry is loaded
+ */
+void ui_sensor_page_register(void);
+
+/**
+ * @brief Queue entity states for the LVGL task
+ * @param states States indexed like the registry
+ * @param count Number of states
+ * @note Safe from any task, an undrained snapshot is replaced
+ */
+void ui_sensor_page_set_entity_states(const ha_entity_state_t *states, int count);
+
+/**
+ * @brief Redraw the tiles whose state changed (LVGL task only, lock held)
+ */
+void ui_sensor_page_process_updates(void);
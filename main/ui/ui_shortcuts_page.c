@@ -0,0 +1,191 @@
+/**
+ * @file ui_shortcuts_page.c
+ * @brief Scene and script shortcut grid, built on first use
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_shortcuts_page.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "smart/ha_shortcuts.h"
+#include "system_debug_utils.h"
+#include "ui_assets.h"
+#include "ui_config.h"
+#include "ui_helpers.h"
+#include "ui_pages.h"
+#include "ui_touch_targets.h"
+
+#define SHORTCUT_COLUMNS 4
+#define SHORTCUT_WIDTH 177
+#define SHORTCUT_HEIGHT 100
+#define SHORTCUT_GAP 10
+
+#define SHORTCUT_SCENE_COLOR 0x4caf50
+#define SHORTCUT_SCRIPT_COLOR 0x3f51b5
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static scene_trigger_callback_t trigger_callback = NULL;
+
+// LVGL task only
+static ha_shortcut_t shown[HA_SHORTCUTS_MAX];
+static int shown_count = 0;
+static uint32_t shown_generation = 0;
+static lv_obj_t *grid = NULL; ///< NULL while the page is not built
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @param e LVGL event object, user data is the index into shown
+ */
+static void shortcut_event_handler(lv_event_t *e)
+{
+  int index = (int)(intptr_t)lv_event_get_user_data(e);
+  if (index >= shown_count)
+    return;
+
+  const ha_shortcut_t *shortcut = &shown[index];
+  if (!trigger_callback)
+  {
+    debug_log_error(DEBUG_TAG_UI_CONTROLS, "Shortcut trigger callback not registered");
+    return;
+  }
+
+  esp_err_t ret = trigger_callback(shortcut->entity_id);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_UI_CONTROLS, "Shortcut %s not queued: %s", shortcut->label, esp_err_to_name(ret));
+  }
+}
+
+/**
+ * @brief Asset pack icon: "icon/<entity_id>", the HA icon from the atlas or as
+ *        "icon/<name>", else "icon/<domain>"
+ */
+static const lv_image_dsc_t *find_icon(const ha_shortcut_t *shortcut, bool script)
+{
+  char name[ASSET_PACK_NAME_LEN];
+  const lv_image_dsc_t *icon = NULL;
+
+  if (snprintf(name, sizeof(name), "icon/%s", shortcut->entity_id) < (int)sizeof(name))
+    icon = ui_assets_image(name);
+  if (!icon)
+    icon = ui_assets_icon(shortcut->icon);
+  if (!icon && shortcut->icon[0])
+  {
+    snprintf(name, sizeof(name), "icon/%s", shortcut->icon);
+    icon = ui_assets_image(name);
+  }
+  if (!icon)
+    icon = ui_assets_image(script ? "icon/script" : "icon/scene");
+  return icon;
+}
+
+static void create_shortcut(int index)
+{
+  const ha_shortcut_t *shortcut = &shown[index];
+  bool script = strncmp(shortcut->entity_id, "script.", 7) == 0;
+
+  lv_obj_t *button = lv_btn_create(grid);
+  lv_obj_set_size(button, SHORTCUT_WIDTH, SHORTCUT_HEIGHT);
+  lv_obj_set_pos(button, (index % SHORTCUT_COLUMNS) * (SHORTCUT_WIDTH + SHORTCUT_GAP),
+                 (index / SHORTCUT_COLUMNS) * (SHORTCUT_HEIGHT + SHORTCUT_GAP));
+  lv_obj_set_style_bg_color(button, lv_color_hex(script ? SHORTCUT_SCRIPT_COLOR : SHORTCUT_SCENE_COLOR), 0);
+  lv_obj_set_style_radius(button, 10, 0);
+  lv_obj_add_event_cb(button, shortcut_event_handler, LV_EVENT_CLICKED, (void *)(intptr_t)index);
+
+  const lv_image_dsc_t *icon = find_icon(shortcut, script);
+  if (icon)
+  {
+    lv_obj_t *image = lv_image_create(button);
+    lv_image_set_src(image, icon);
+    lv_obj_align(image, LV_ALIGN_TOP_LEFT, 0, 0);
+  }
+
+  lv_obj_t *label = lv_label_create(button);
+  lv_label_set_text(label, shortcut->label);
+  lv_label_set_long_mode(label, LV_LABEL_LONG_DOT);
+  lv_obj_set_width(label, SHORTCUT_WIDTH - 20);
+  lv_obj_add_style(label, ui_get_text_style(font_normal, 0xffffff), 0);
+  lv_obj_align(label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+}
+
+static void fill_grid(void)
+{
+  lv_obj_clean(grid);
+  shown_generation = ha_shortcuts_generation();
+  shown_count = ha_shortcuts_get(shown);
+
+  for (int i = 0; i < shown_count; i++)
+    create_shortcut(i);
+
+  if (shown_count == 0)
+  {
+    lv_obj_t *empty = lv_label_create(grid);
+    lv_label_set_text(empty, "No scenes or scripts yet, they are read from Home Assistant after it connects");
+    lv_obj_add_style(empty, ui_get_text_style(font_normal, 0x888888), 0);
+    lv_obj_align(empty, LV_ALIGN_TOP_LEFT, 0, 10);
+  }
+  ui_touch_targets_invalidate();
+}
+
+static void build(lv_obj_t *screen)
+{
+  lv_obj_t *panel = ui_create_panel(screen, 780, 430, 10, 10, 0x1a1a2e, 0x16213e);
+  ui_create_title_with_separator(panel, "Shortcuts", 0x4caf50, 750);
+
+  grid = lv_obj_create(panel);
+  lv_obj_remove_style_all(grid);
+  lv_obj_set_size(grid, 750, 340);
+  lv_obj_set_pos(grid, 0, 50);
+  lv_obj_set_scroll_dir(grid, LV_DIR_VER);
+  lv_obj_set_scrollbar_mode(grid, LV_SCROLLBAR_MODE_AUTO);
+  ui_touch_targets_track_scroll(grid);
+  fill_grid();
+
+  lv_obj_t *hint = lv_label_create(screen);
+  lv_label_set_text(hint, "Swipe with two fingers to change pages");
+  lv_obj_add_style(hint, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -10);
+}
+
+static void evict(void)
+{
+  grid = NULL;
+  shown_count = 0;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_shortcuts_page_register(void)
+{
+  static const ui_page_t page = {
+      .name = "shortcuts",
+      .build = build,
+      .evict = evict,
+  };
+  ui_pages_register(&page);
+}
+
+void ui_shortcuts_page_set_trigger_callback(scene_trigger_callback_t callback)
+{
+  trigger_callback = callback;
+}
+
+void ui_shortcuts_page_process_updates(void)
+{
+  // Not built: the list is read when the page is opened
+  if (grid && ha_shortcuts_generation() != shown_generation)
+    fill_grid();
+}
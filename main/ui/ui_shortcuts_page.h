@@ -0,0 +1,34 @@
+/**
+ * @file ui_shortcuts_page.h
+ * @brief Scene and script shortcut grid, built on first use
+ *
+ * One button per scene and script from ha_shortcuts, labelled with the
+ * friendly name and the matching asset pack icon. Names and icons come
+ * from the NVS copy, so the grid is complete at startup and a tap only
+ * queues a command for the HA worker task. The grid is rebuilt when the
+ * fetch after the first sync brings a different list.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "ui_controls_panel.h"
+
+/**
+ * @brief Register the page with ui_pages, nothing is built until it is opened
+ * @note LVGL lock held, call after ha_shortcuts_init()
+ */
+void ui_shortcuts_page_register(void);
+
+/**
+ * @brief Set the function a tap calls with the scene or script entity_id
+ * @param callback Must queue the command and return without waiting on HTTP
+ */
+void ui_shortcuts_page_set_trigger_callback(scene_trigger_callback_t callback);
+
+/**
+ * @brief Rebuild the grid if the shortcut list changed (LVGL task only, lock held)
+ */
+void ui_shortcuts_page_process_updates(void);
@@ -0,0 +1,215 @@
+/**
+ * @file ui_sparkline.c
+ * @brief Compact history sparklines fed from the telemetry history store
+ *
+ * Pixels are written straight into the canvas buffer, one column per
+ * sample: the vertical span from the previous value to the new one, so
+ * consecutive columns join into a line. The buffer is never shifted, the
+ * cursor wraps instead, which is why only the touched columns need to be
+ * invalidated.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_sparkline.h"
+
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "ui_helpers.h"
+
+#if CONFIG_UI_SPARKLINES
+
+// Cleared columns ahead of the cursor
+#define SPARKLINE_GAP_COLUMNS 2
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  lv_obj_t *canvas;
+  lv_draw_buf_t *buf;
+  telemetry_metric_t metric;
+  int32_t range;
+  lv_color32_t color;
+  int32_t cursor; ///< Next column to draw
+  int32_t last_y; ///< Row of the previous sample, -1 after a reset
+  uint64_t last_t_ms;
+  bool have_samples; ///< last_t_ms is valid
+} sparkline_t;
+
+static sparkline_t sparklines[UI_SPARKLINE_MAX];
+static int sparkline_count = 0;
+
+// Shared by all polls, only used from the LVGL task
+static telemetry_history_point_t poll_points[UI_SPARKLINE_MAX_WIDTH];
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static lv_color32_t *column_pixel(const sparkline_t *s, int32_t x, int32_t y)
+{
+  return (lv_color32_t *)(s->buf->data + (size_t)y * s->buf->header.stride) + x;
+}
+
+static void clear_column(sparkline_t *s, int32_t x)
+{
+  for (int32_t y = 0; y < (int32_t)s->buf->header.h; y++)
+  {
+    *column_pixel(s, x, y) = (lv_color32_t){0};
+  }
+}
+
+static void invalidate_column(const sparkline_t *s, int32_t x)
+{
+  lv_area_t area;
+  lv_obj_get_coords(s->canvas, &area);
+  area.x1 += x;
+  area.x2 = area.x1;
+  lv_obj_invalidate_area(s->canvas, &area);
+}
+
+static int32_t value_to_row(const sparkline_t *s, int32_t value)
+{
+  int32_t height = (int32_t)s->buf->header.h;
+  if (value < 0)
+    value = 0;
+  if (value > s->range)
+    value = s->range;
+  return (height - 1) - (value * (height - 1)) / s->range;
+}
+
+/**
+ * @brief Draw one sample at the cursor and advance it
+ * @param invalidate False while a batch is drawn that invalidates the whole canvas
+ */
+static void push_sample(sparkline_t *s, int32_t value, bool invalidate)
+{
+  int32_t width = (int32_t)s->buf->header.w;
+  int32_t x = s->cursor;
+  int32_t y = value_to_row(s, value);
+  int32_t y0 = s->last_y < 0 ? y : s->last_y;
+
+  clear_column(s, x);
+  for (int32_t row = LV_MIN(y0, y); row <= LV_MAX(y0, y); row++)
+  {
+    *column_pixel(s, x, row) = s->color;
+  }
+  if (invalidate)
+    invalidate_column(s, x);
+
+  for (int32_t gap = 1; gap <= SPARKLINE_GAP_COLUMNS; gap++)
+  {
+    int32_t gx = (x + gap) % width;
+    clear_column(s, gx);
+    if (invalidate)
+      invalidate_column(s, gx);
+  }
+
+  s->last_y = y;
+  s->cursor = (x + 1) % width;
+}
+
+static void poll_sparkline(sparkline_t *s)
+{
+  size_t max_points = s->buf->header.w;
+  size_t n = telemetry_history_query(TELEMETRY_TIER_RAW, s->metric, s->have_samples ? s->last_t_ms + 1 : 0,
+                                     poll_points, max_points);
+
+  if (n == 0 && s->have_samples)
+  {
+    // A restarted host starts its clock over, follow it instead of waiting to catch up
+    n = telemetry_history_query(TELEMETRY_TIER_RAW, s->metric, 0, poll_points, 1);
+    if (n == 0 || poll_points[0].t_ms >= s->last_t_ms)
+      return;
+  }
+  if (n == 0)
+    return;
+
+  // A long batch (first fill, page switch back) redraws the canvas once instead of column by column
+  bool batch = n > SPARKLINE_GAP_COLUMNS + 1;
+  for (size_t i = 0; i < n; i++)
+  {
+    push_sample(s, poll_points[i].avg, !batch);
+  }
+  if (batch)
+    lv_obj_invalidate(s->canvas);
+
+  s->last_t_ms = poll_points[n - 1].t_ms;
+  s->have_samples = true;
+}
+
+#endif // CONFIG_UI_SPARKLINES
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+lv_obj_t *ui_sparkline_create(lv_obj_t *parent, telemetry_metric_t metric, int x, int y, int width, int height,
+                              uint32_t color, int32_t range)
+{
+#if CONFIG_UI_SPARKLINES
+  if (!parent || sparkline_count >= UI_SPARKLINE_MAX || width <= SPARKLINE_GAP_COLUMNS ||
+      width > UI_SPARKLINE_MAX_WIDTH || height < 2 || range <= 0)
+    return NULL;
+
+  // ARGB8888 so the panel background shows through, PSRAM like the cached panel images
+  uint32_t stride = width * 4;
+  size_t data_size = stride * height;
+  lv_draw_buf_t *buf = heap_caps_calloc(1, sizeof(lv_draw_buf_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  uint8_t *data = heap_caps_aligned_calloc(LV_DRAW_BUF_ALIGN, 1, data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!buf || !data)
+  {
+    heap_caps_free(buf);
+    heap_caps_free(data);
+    return NULL;
+  }
+  lv_draw_buf_init(buf, width, height, LV_COLOR_FORMAT_ARGB8888, stride, data, data_size);
+
+  lv_obj_t *canvas = lv_canvas_create(parent);
+  lv_canvas_set_draw_buf(canvas, buf);
+  lv_obj_set_pos(canvas, x, y);
+  ui_mark_dynamic(canvas);
+
+  sparkline_t *s = &sparklines[sparkline_count++];
+  lv_color_t c = lv_color_hex(color);
+  *s = (sparkline_t){
+      .canvas = canvas,
+      .buf = buf,
+      .metric = metric,
+      .range = range,
+      .color = {.blue = c.blue, .green = c.green, .red = c.red, .alpha = LV_OPA_COVER},
+      .last_y = -1,
+  };
+  return canvas;
+#else
+  return NULL;
+#endif
+}
+
+void ui_sparkline_process_updates(void)
+{
+#if CONFIG_UI_SPARKLINES
+  for (int i = 0; i < sparkline_count; i++)
+  {
+    poll_sparkline(&sparklines[i]);
+  }
+#endif
+}
+
+void ui_sparkline_reset(void)
+{
+#if CONFIG_UI_SPARKLINES
+  for (int i = 0; i < sparkline_count; i++)
+  {
+    sparkline_t *s = &sparklines[i];
+    memset(s->buf->data, 0, s->buf->data_size);
+    s->cursor = 0;
+    s->last_y = -1;
+    lv_obj_invalidate(s->canvas);
+  }
+#endif
+}
@@ -0,0 +1,59 @@
+/**
+ * @file ui_sparkline.h
+ * @brief Compact history sparklines fed from the telemetry history store
+ *
+ * A sparkline is a small canvas that sweeps left to right like a monitor
+ * trace: each new raw sample is drawn as one column at the cursor, and the
+ * column after it is cleared to mark where the trace continues. Only those
+ * columns are invalidated, so a 10 Hz feed redraws a few pixels per sample
+ * instead of the whole chart.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "telemetry_history.h"
+
+// =======================================================================
+// CONFIGURATION
+// =======================================================================
+
+// Sparklines on the dashboard
+#define UI_SPARKLINE_MAX 4
+
+// Widest sparkline, also the most samples read back in one poll
+#define UI_SPARKLINE_MAX_WIDTH 128
+
+// =======================================================================
+// PUBLIC FUNCTION PROTOTYPES
+// =======================================================================
+
+/**
+ * @brief Create a sparkline for one telemetry metric
+ * @param parent Parent panel
+ * @param metric Metric plotted from the raw history tier
+ * @param x X position
+ * @param y Y position
+ * @param width Width in pixels, one sample per column, at most UI_SPARKLINE_MAX_WIDTH
+ * @param height Height in pixels
+ * @param color Trace color (hex)
+ * @param range Value at the top edge, the bottom edge is 0
+ * @return Canvas object, NULL if disabled in menuconfig or out of memory
+ * @note LVGL lock held; the canvas is marked dynamic for the panel background cache
+ */
+lv_obj_t *ui_sparkline_create(lv_obj_t *parent, telemetry_metric_t metric, int x, int y, int width, int height,
+                              uint32_t color, int32_t range);
+
+/**
+ * @brief Draw the samples recorded since the last call (LVGL task only, lock held)
+ */
+void ui_sparkline_process_updates(void);
+
+/**
+ * @brief Clear every sparkline, e.g. after the host disconnected (LVGL task only, lock held)
+ */
+void ui_sparkline_reset(void);
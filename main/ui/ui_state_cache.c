@@ -0,0 +1,275 @@
+/**
+ * @file ui_state_cache.c
+ * @brief Last-known dashboard state, kept in NVS for an instant-on UI
+ *
+ * Producers update a RAM copy and hand it to the NVS store
+ * (utils/nvs_store.h), which folds bursts of changes into one write:
+ * - toggle and kind changes of entities are written UI_STATE_HA_SAVE_DELAY_S
+ *   after the first one
+ * - telemetry and sensor readings change all the time and are written at
+ *   most every UI_STATE_TELEMETRY_SAVE_S
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_state_cache.h"
+
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs_store.h"
+#include "smart/ha_entity_registry.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define CACHE_NVS_NAMESPACE "ui_state"
+#define CACHE_NVS_KEY_TELEMETRY "telemetry"
+#define CACHE_NVS_KEY_ENTITIES "entities"
+#define CACHE_BLOB_VERSION 4
+
+// First telemetry snapshot after boot, so even a short run leaves one behind
+#define CACHE_FIRST_TELEMETRY_SAVE_S 10
+
+#define CACHE_MS_PER_S 1000u
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef struct
+{
+  uint8_t version;
+  system_data_t data;
+} telemetry_blob_t;
+
+/**
+ * @brief Entity state without interned strings, which do not survive a reboot
+ */
+typedef struct
+{
+  uint32_t id_hash; ///< Entity ID hash, matches records to a changed registry
+  float value;  ///< Reading, or the level if has_level
+  uint8_t kind; ///< ha_state_kind_t
+  bool is_on;
+  bool has_level;
+} cached_entity_t;
+
+/**
+ * @brief NVS layout, only the first count records are written
+ */
+typedef struct
+{
+  uint8_t version;
+  uint8_t count;
+  cached_entity_t entities[HA_REGISTRY_MAX_ENTITIES];
+} entities_blob_t;
+
+#define ENTITIES_BLOB_SIZE(count) (offsetof(entities_blob_t, entities) + (size_t)(count) * sizeof(cached_entity_t))
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+// Producers are the serial task and the HA sync task
+static SemaphoreHandle_t cache_mutex = NULL;
+
+static telemetry_blob_t telemetry = {.version = CACHE_BLOB_VERSION};
+static entities_blob_t entities = {.version = CACHE_BLOB_VERSION};
+static bool telemetry_loaded = false;
+static bool entities_loaded = false;
+static bool telemetry_stored = false; ///< A frame was handed to the store this run
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static uint32_t hash_entity_id(const char *entity_id)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (const char *p = entity_id; *p; p++)
+  {
+    hash = (hash ^ (uint8_t)*p) * 16777619u;
+  }
+  return hash;
+}
+
+static bool load_blob(const char *key, void *blob, size_t min_size, size_t max_size)
+{
+  size_t size = max_size;
+  if (nvs_store_get(CACHE_NVS_NAMESPACE, key, blob, &size) != ESP_OK)
+    return false;
+
+  // The version byte leads every blob
+  if (size < min_size || *(const uint8_t *)blob != CACHE_BLOB_VERSION)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Stored UI state %s has an unknown layout, ignoring it", key);
+    return false;
+  }
+  return true;
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t ui_state_cache_init(void)
+{
+#if CONFIG_UI_STATE_CACHE
+  if (cache_mutex)
+  {
+    return ESP_OK;
+  }
+
+  telemetry_loaded = load_blob(CACHE_NVS_KEY_TELEMETRY, &telemetry, sizeof(telemetry), sizeof(telemetry));
+  entities_loaded =
+      load_blob(CACHE_NVS_KEY_ENTITIES, &entities, offsetof(entities_blob_t, entities), sizeof(entities)) &&
+      entities.count <= HA_REGISTRY_MAX_ENTITIES;
+  if (!telemetry_loaded)
+  {
+    memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.version = CACHE_BLOB_VERSION;
+  }
+  if (!entities_loaded)
+  {
+    memset(&entities, 0, sizeof(entities));
+    entities.version = CACHE_BLOB_VERSION;
+  }
+
+  cache_mutex = xSemaphoreCreateMutex();
+  if (!cache_mutex)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  debug_log_info_f(DEBUG_TAG_UI_DASHBOARD, "Last-known UI state: telemetry %s, %d entity states",
+                   telemetry_loaded ? "stored" : "none", entities_loaded ? entities.count : 0);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool ui_state_cache_get_telemetry(system_data_t *data)
+{
+  if (!cache_mutex || !telemetry_loaded || !data)
+    return false;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  *data = telemetry.data;
+  xSemaphoreGive(cache_mutex);
+  return true;
+}
+
+int ui_state_cache_get_entity_states(ha_entity_state_t *states)
+{
+  if (!cache_mutex || !entities_loaded || !states)
+    return 0;
+
+  int count = ha_registry_count();
+  int matched = 0;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  for (int i = 0; i < count; i++)
+  {
+    memset(&states[i], 0, sizeof(states[i]));
+    uint32_t hash = hash_entity_id(ha_registry_get(i)->entity_id);
+
+    // Same index unless the registry was edited
+    int found = -1;
+    if (i < entities.count && entities.entities[i].id_hash == hash)
+    {
+      found = i;
+    }
+    for (int j = 0; found < 0 && j < entities.count; j++)
+    {
+      if (entities.entities[j].id_hash == hash)
+        found = j;
+    }
+    if (found < 0 || entities.entities[found].kind == HA_STATE_TEXT)
+      continue;
+
+    const cached_entity_t *cached = &entities.entities[found];
+    states[i].kind = cached->kind;
+    states[i].is_on = cached->is_on;
+    states[i].value = cached->value;
+    states[i].has_level = cached->has_level;
+    states[i].found = true;
+    matched++;
+  }
+  xSemaphoreGive(cache_mutex);
+
+  return matched ? count : 0;
+}
+
+void ui_state_cache_store_telemetry(const system_data_t *data)
+{
+  if (!cache_mutex || !data)
+    return;
+
+  // The store keeps an earlier pending write, so frames in between only refresh the value
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  telemetry.data = *data;
+  telemetry_loaded = true;
+  uint32_t delay_s = telemetry_stored ? UI_STATE_TELEMETRY_SAVE_S : CACHE_FIRST_TELEMETRY_SAVE_S;
+  telemetry_stored = true;
+  nvs_store_set(CACHE_NVS_NAMESPACE, CACHE_NVS_KEY_TELEMETRY, &telemetry, sizeof(telemetry), delay_s * CACHE_MS_PER_S);
+  xSemaphoreGive(cache_mutex);
+}
+
+void ui_state_cache_store_entity_states(const ha_entity_state_t *states, int count)
+{
+  if (!cache_mutex || !states || count <= 0)
+    return;
+  if (count > HA_REGISTRY_MAX_ENTITIES)
+    count = HA_REGISTRY_MAX_ENTITIES;
+
+  entities_blob_t fresh = {.version = CACHE_BLOB_VERSION, .count = (uint8_t)count};
+  for (int i = 0; i < count; i++)
+  {
+    const ha_entity_record_t *record = ha_registry_get(i);
+    cached_entity_t *cached = &fresh.entities[i];
+    cached->id_hash = record ? hash_entity_id(record->entity_id) : 0;
+    if (!states[i].found)
+    {
+      cached->kind = HA_STATE_TEXT; // Nothing to restore
+      continue;
+    }
+    cached->kind = states[i].kind;
+    cached->is_on = states[i].is_on;
+    cached->has_level = states[i].has_level;
+    cached->value = (states[i].kind == HA_STATE_NUMERIC || states[i].has_level) ? states[i].value : 0.0f;
+  }
+
+  // Toggles and kinds are what the panel shows at a glance, readings and levels can wait
+  bool urgent = fresh.count != entities.count;
+  bool changed = urgent;
+  for (int i = 0; i < count && !urgent; i++)
+  {
+    const cached_entity_t *a = &fresh.entities[i];
+    const cached_entity_t *b = &entities.entities[i];
+    if (a->id_hash != b->id_hash || a->kind != b->kind || a->is_on != b->is_on)
+      urgent = true;
+    else if (a->value != b->value || a->has_level != b->has_level)
+      changed = true;
+  }
+  if (!urgent && !changed)
+    return;
+
+  xSemaphoreTake(cache_mutex, portMAX_DELAY);
+  entities = fresh;
+  entities_loaded = true;
+  uint32_t delay_s = urgent ? UI_STATE_HA_SAVE_DELAY_S : UI_STATE_TELEMETRY_SAVE_S;
+  esp_err_t err = nvs_store_set(CACHE_NVS_NAMESPACE, CACHE_NVS_KEY_ENTITIES, &entities,
+                                ENTITIES_BLOB_SIZE(entities.count), delay_s * CACHE_MS_PER_S);
+  xSemaphoreGive(cache_mutex);
+  if (err != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_UI_DASHBOARD, "Entity states not saved: %s", esp_err_to_name(err));
+  }
+}
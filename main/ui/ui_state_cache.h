@@ -0,0 +1,69 @@
+/**
+ * @file ui_state_cache.h
+ * @brief Last-known dashboard state, kept in NVS for an instant-on UI
+ *
+ * The newest telemetry frame (host CPU and GPU names included) and the
+ * Home Assistant entity states are mirrored in RAM as they arrive and
+ * written to NVS now and then. At boot they are read back so the
+ * dashboard can show them, dimmed, before WiFi, the host and HA report.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dashboard_data.h"
+#include "smart/ha_entity_state.h"
+
+// Telemetry snapshot written at most this often
+#ifdef CONFIG_UI_STATE_TELEMETRY_SAVE_S
+#define UI_STATE_TELEMETRY_SAVE_S CONFIG_UI_STATE_TELEMETRY_SAVE_S
+#else
+#define UI_STATE_TELEMETRY_SAVE_S 300
+#endif
+
+// Entity state changes within this window are written together
+#ifdef CONFIG_UI_STATE_HA_SAVE_DELAY_S
+#define UI_STATE_HA_SAVE_DELAY_S CONFIG_UI_STATE_HA_SAVE_DELAY_S
+#else
+#define UI_STATE_HA_SAVE_DELAY_S 15
+#endif
+
+/**
+ * @brief Load the stored state
+ * @note Call after nvs_store_init() and ha_registry_init()
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+ */
+esp_err_t ui_state_cache_init(void);
+
+/**
+ * @brief Get the telemetry frame stored by the previous run
+ * @param data Filled with the frame
+ * @return true if a frame was stored
+ */
+bool ui_state_cache_get_telemetry(system_data_t *data);
+
+/**
+ * @brief Get the entity states stored by the previous run
+ * @param states Array of at least ha_registry_count() records, indexed like the registry
+ * @return Number of records filled, 0 if nothing matches the current registry
+ * @note Entities that were removed or reordered are matched by entity ID;
+ *       text states are not kept, those entities stay not found
+ */
+int ui_state_cache_get_entity_states(ha_entity_state_t *states);
+
+/**
+ * @brief Remember the newest telemetry frame
+ * @param data Frame as shown on the dashboard
+ */
+void ui_state_cache_store_telemetry(const system_data_t *data);
+
+/**
+ * @brief Remember the newest entity states
+ * @param states Records indexed like the entity registry
+ * @param count Number of records
+ */
+void ui_state_cache_store_entity_states(const ha_entity_state_t *states, int count);
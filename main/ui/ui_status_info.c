@@ -10,17 +10,57 @@
 #include "ui_status_info.h"
 
 #include <stdio.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "lvgl_setup.h"
 #include "ui_config.h"
 #include "ui_helpers.h"
 #include "utils/system_debug_utils.h"
+#include "wifi/wifi_time_sync.h"
 #include <string.h>
+#include <sys/time.h>
 #include <time.h>
 
 // Status and Info Elements
 static lv_obj_t *connection_status_label = NULL;
 static lv_obj_t *wifi_status_label = NULL;
-static lv_obj_t *runtime_label = NULL;
+static ui_bound_field_t runtime_field;
+static ui_bound_field_t clock_field;
+
+// Runtime and clock are redrawn by an LVGL timer that only fires when a shown minute ends
+static lv_timer_t *clock_timer = NULL;
+static int64_t shown_runtime_minute = -1;
+static int64_t shown_clock_minute = -1;
+static volatile bool clock_resync = false;
+
+// Latest-value mailboxes: producers overwrite, the LVGL task drains
+typedef struct
+{
+  bool connected;
+  char text[96];
+} wifi_status_msg_t;
+
+typedef struct
+{
+  bool connected;
+  bool degraded;
+  int8_t rssi;
+} wifi_link_msg_t;
+
+static QueueHandle_t wifi_status_mailbox = NULL;
+static QueueHandle_t wifi_link_mailbox = NULL;
+static QueueHandle_t serial_status_mailbox = NULL;
+
+// Last applied values, the label combines both
+static wifi_status_msg_t shown_wifi_status = {0};
+static wifi_link_msg_t shown_wifi_link = {0};
+
+static void apply_wifi_status(const char *status_text, bool connected);
+static void render_wifi_label(void);
+static void apply_serial_status(bool connected);
+static void apply_runtime(uint32_t runtime_seconds);
+static void clock_timer_cb(lv_timer_t *timer);
 
 lv_obj_t *create_status_info_panel(lv_obj_t *parent)
 {
@@ -29,38 +69,136 @@ lv_obj_t *create_status_info_panel(lv_obj_t *parent)
   // Serial connection status (left side)
   connection_status_label = lv_label_create(status_panel);
   lv_label_set_text(connection_status_label, "[SERIAL] No connection");
-  lv_obj_set_style_text_font(connection_status_label, font_small, 0);
-  lv_obj_set_style_text_color(connection_status_label, lv_color_hex(0xffaa00), 0);
+  lv_obj_add_style(connection_status_label, ui_get_text_style(font_small, 0xffaa00), 0);
   lv_obj_set_pos(connection_status_label, 10, 11);
+  ui_mark_dynamic(connection_status_label);
 
   // Runtime display (center-left)
-  runtime_label = lv_label_create(status_panel);
+  lv_obj_t *runtime_label = lv_label_create(status_panel);
   lv_label_set_text(runtime_label, "Running: --");
-  lv_obj_set_style_text_font(runtime_label, font_small, 0);
-  lv_obj_set_style_text_color(runtime_label, lv_color_hex(0xbbbbbb), 0);
+  lv_obj_add_style(runtime_label, ui_get_text_style(font_small, 0xbbbbbb), 0);
   lv_obj_align(runtime_label, LV_ALIGN_CENTER, -80, 0);
+  ui_bound_field_init(&runtime_field, runtime_label);
+  ui_mark_dynamic(runtime_label);
+
+  // Wall clock (center-right), SNTP time once synced
+  lv_obj_t *clock_label = lv_label_create(status_panel);
+  lv_label_set_text(clock_label, "--:--");
+  lv_obj_add_style(clock_label, ui_get_text_style(font_small, 0xbbbbbb), 0);
+  lv_obj_align(clock_label, LV_ALIGN_CENTER, 90, 0);
+  ui_bound_field_init(&clock_field, clock_label);
+  ui_mark_dynamic(clock_label);
 
   // WiFi status (right side)
   wifi_status_label = lv_label_create(status_panel);
   lv_label_set_text(wifi_status_label, "[WIFI] Connecting...");
-  lv_obj_set_style_text_font(wifi_status_label, font_small, 0);
-  lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0x00aaff), 0);
+  lv_obj_add_style(wifi_status_label, ui_get_text_style(font_small, 0x00aaff), 0);
   lv_obj_align(wifi_status_label, LV_ALIGN_TOP_RIGHT, -10, 11);
+  ui_mark_dynamic(wifi_status_label);
+
+  if (!wifi_status_mailbox)
+  {
+    wifi_status_mailbox = xQueueCreate(1, sizeof(wifi_status_msg_t));
+    wifi_link_mailbox = xQueueCreate(1, sizeof(wifi_link_msg_t));
+    serial_status_mailbox = xQueueCreate(1, sizeof(bool));
+  }
+
+  if (!clock_timer)
+  {
+    clock_timer = lv_timer_create(clock_timer_cb, 1000, NULL);
+  }
+  shown_runtime_minute = -1;
+  shown_clock_minute = -1;
+  lv_timer_ready(clock_timer);
 
   return status_panel;
 }
 
 void status_info_update_wifi_status(const char *status_text, bool connected)
 {
-  if (!status_text || !wifi_status_label)
+  if (!status_text || !wifi_status_mailbox)
     return;
 
-  // Acquire LVGL lock with timeout
-  if (!lvgl_port_lock(200))
-  {
-    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Failed to acquire LVGL lock for WiFi status update");
+  wifi_status_msg_t msg = {.connected = connected};
+  strlcpy(msg.text, status_text, sizeof(msg.text));
+  xQueueOverwrite(wifi_status_mailbox, &msg);
+  lvgl_setup_wake_task();
+}
+
+void status_info_update_wifi_link(bool connected, int8_t rssi, bool degraded)
+{
+  if (!wifi_link_mailbox)
     return;
+
+  wifi_link_msg_t msg = {.connected = connected, .degraded = degraded, .rssi = rssi};
+  xQueueOverwrite(wifi_link_mailbox, &msg);
+  lvgl_setup_wake_task();
+}
+
+void status_info_update_serial_status(bool connected)
+{
+  if (!serial_status_mailbox)
+    return;
+
+  xQueueOverwrite(serial_status_mailbox, &connected);
+  lvgl_setup_wake_task();
+}
+
+void status_info_clock_changed(void)
+{
+  clock_resync = true;
+  lvgl_setup_wake_task();
+}
+
+void status_info_process_updates(void)
+{
+  wifi_status_msg_t wifi_msg;
+  wifi_link_msg_t link_msg;
+  bool serial_connected;
+
+  if (wifi_status_mailbox && xQueueReceive(wifi_status_mailbox, &wifi_msg, 0) == pdTRUE)
+  {
+    apply_wifi_status(wifi_msg.text, wifi_msg.connected);
   }
+  if (wifi_link_mailbox && xQueueReceive(wifi_link_mailbox, &link_msg, 0) == pdTRUE)
+  {
+    // Only the shown value matters, a 1 dB wobble in the average still redraws
+    if (memcmp(&link_msg, &shown_wifi_link, sizeof(link_msg)) != 0)
+    {
+      shown_wifi_link = link_msg;
+      render_wifi_label();
+    }
+  }
+  if (serial_status_mailbox && xQueueReceive(serial_status_mailbox, &serial_connected, 0) == pdTRUE)
+  {
+    apply_serial_status(serial_connected);
+  }
+  if (clock_resync && clock_timer)
+  {
+    // The clock may have jumped by less than a minute, redraw regardless
+    clock_resync = false;
+    shown_clock_minute = -1;
+    lv_timer_ready(clock_timer);
+  }
+}
+
+static void apply_wifi_status(const char *status_text, bool connected)
+{
+  if (!status_text)
+    return;
+
+  shown_wifi_status.connected = connected;
+  strlcpy(shown_wifi_status.text, status_text, sizeof(shown_wifi_status.text));
+  render_wifi_label();
+}
+
+static void render_wifi_label(void)
+{
+  if (!wifi_status_label)
+    return;
+
+  const char *status_text = shown_wifi_status.text;
+  bool connected = shown_wifi_status.connected;
 
   // Create formatted status message
   char wifi_msg[128];
@@ -93,10 +231,21 @@ void status_info_update_wifi_status(const char *status_text, bool connected)
     snprintf(wifi_msg, sizeof(wifi_msg), "[WIFI] %s", status_text);
   }
 
+  bool show_link = connected && shown_wifi_link.connected;
+  if (show_link)
+  {
+    size_t len = strlen(wifi_msg);
+    snprintf(wifi_msg + len, sizeof(wifi_msg) - len, " %d dBm", shown_wifi_link.rssi);
+  }
+
   lv_label_set_text(wifi_status_label, wifi_msg);
 
   // Set color based on connection status
-  if (connected)
+  if (show_link && shown_wifi_link.degraded)
+  {
+    lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0xffaa00), 0); // Amber
+  }
+  else if (connected)
   {
     lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0x00ff88), 0); // Green
   }
@@ -104,22 +253,13 @@ void status_info_update_wifi_status(const char *status_text, bool connected)
   {
     lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0xff4444), 0); // Red
   }
-
-  lvgl_port_unlock();
 }
 
-void status_info_update_serial_status(bool connected)
+static void apply_serial_status(bool connected)
 {
   if (!connection_status_label)
     return;
 
-  // Acquire LVGL lock with timeout
-  if (!lvgl_port_lock(200))
-  {
-    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Failed to acquire LVGL lock for serial status update");
-    return;
-  }
-
   char combined_status[128];
   if (connected)
   {
@@ -133,21 +273,12 @@ void status_info_update_serial_status(bool connected)
     lv_label_set_text(connection_status_label, combined_status);
     lv_obj_set_style_text_color(connection_status_label, lv_color_hex(0xff4444), 0); // Red
   }
-
-  lvgl_port_unlock();
 }
 
-void status_info_update_runtime(uint32_t runtime_seconds)
+static void apply_runtime(uint32_t runtime_seconds)
 {
-  if (!runtime_label)
-    return;
-
-  // Acquire LVGL lock with timeout
-  if (!lvgl_port_lock(200))
-  {
-    debug_log_warning(DEBUG_TAG_UI_DASHBOARD, "Failed to acquire LVGL lock for runtime update");
+  if (!runtime_field.obj)
     return;
-  }
 
   char runtime_msg[64];
 
@@ -172,7 +303,56 @@ void status_info_update_runtime(uint32_t runtime_seconds)
     snprintf(runtime_msg, sizeof(runtime_msg), "Running: %lum", minutes);
   }
 
-  lv_label_set_text(runtime_label, runtime_msg);
+  ui_bound_field_set_text(&runtime_field, runtime_msg);
+}
+
+static void apply_clock(const struct tm *local)
+{
+  char clock_msg[32];
+  if (local)
+  {
+    strftime(clock_msg, sizeof(clock_msg), "%a %d %b  %H:%M", local);
+  }
+  else
+  {
+    strlcpy(clock_msg, "--:--", sizeof(clock_msg));
+  }
+  ui_bound_field_set_text(&clock_field, clock_msg);
+}
+
+static void clock_timer_cb(lv_timer_t *timer)
+{
+  // Uptime minutes and wall-clock minutes end at different moments, wake for the nearer one
+  int64_t uptime_ms = esp_timer_get_time() / 1000;
+  int64_t runtime_minute = uptime_ms / 60000;
+  uint32_t next_ms = 60000 - (uint32_t)(uptime_ms % 60000);
+  if (runtime_minute != shown_runtime_minute)
+  {
+    shown_runtime_minute = runtime_minute;
+    apply_runtime((uint32_t)(runtime_minute * 60));
+  }
+
+  if (wifi_time_sync_is_valid())
+  {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t clock_minute = now.tv_sec / 60;
+    uint32_t clock_next_ms = 60000 - (uint32_t)((now.tv_sec % 60) * 1000 + now.tv_usec / 1000);
+    next_ms = LV_MIN(next_ms, clock_next_ms);
+    if (clock_minute != shown_clock_minute)
+    {
+      shown_clock_minute = clock_minute;
+      struct tm local;
+      localtime_r(&now.tv_sec, &local);
+      apply_clock(&local);
+    }
+  }
+  else if (shown_clock_minute != 0)
+  {
+    shown_clock_minute = 0;
+    apply_clock(NULL);
+  }
 
-  lvgl_port_unlock();
+  // A few ms late so the new minute has started when it fires
+  lv_timer_set_period(timer, next_ms + 5);
 }
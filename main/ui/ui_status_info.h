@@ -25,6 +25,14 @@ lv_obj_t *create_status_info_panel(lv_obj_t *parent);
  */
 void status_info_update_wifi_status(const char *status_text, bool connected);
 
+/**
+ * @brief Update the WiFi link quality shown next to the WiFi status
+ * @param connected True while associated, hides the readout otherwise
+ * @param rssi Smoothed signal strength in dBm
+ * @param degraded True if the link is weak enough to look for another AP
+ */
+void status_info_update_wifi_link(bool connected, int8_t rssi, bool degraded);
+
 /**
  * @brief Update serial connection status in the status panel
  * @param connected True if serial is connected, false otherwise
@@ -32,7 +40,13 @@ void status_info_update_wifi_status(const char *status_text, bool connected);
 void status_info_update_serial_status(bool connected);
 
 /**
- * @brief Update runtime display in the status panel
- * @param runtime_seconds Total runtime in seconds since boot
+ * @brief The system clock was set, redraw the wall clock
+ * @note Safe from any task. Runtime and clock otherwise update themselves
+ *       from an LVGL timer when the shown minute changes
+ */
+void status_info_clock_changed(void);
+
+/**
+ * @brief Apply queued status updates (LVGL task only, lock held)
  */
-void status_info_update_runtime(uint32_t runtime_seconds);
+void status_info_process_updates(void);
@@ -0,0 +1,104 @@
+/**
+ * @file ui_system_page.c
+ * @brief System information page, built on first use
+ *
+ * Shows the device's own heap, LVGL pool and uptime. The values are only
+ * refreshed while the page is built, by a timer that goes with it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "ui_system_page.h"
+
+#include <stdio.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "ui_config.h"
+#include "ui_digits.h"
+#include "ui_helpers.h"
+#include "ui_metric_tile.h"
+#include "ui_pages.h"
+
+#define SYSTEM_PAGE_REFRESH_MS 1000
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static lv_obj_t *internal_tile = NULL;
+static lv_obj_t *psram_tile = NULL;
+static lv_obj_t *pool_tile = NULL;
+static lv_obj_t *uptime_tile = NULL;
+static lv_timer_t *refresh_timer = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void update_values(void)
+{
+  char text[UI_DIGITS_MAX_TEXT];
+
+  snprintf(text, sizeof(text), "%u KB", (unsigned)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024));
+  ui_digits_set_text(internal_tile, text);
+  snprintf(text, sizeof(text), "%u KB", (unsigned)(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024));
+  ui_digits_set_text(psram_tile, text);
+
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  snprintf(text, sizeof(text), "%u%%", (unsigned)mon.used_pct);
+  ui_digits_set_text(pool_tile, text);
+
+  uint32_t seconds = (uint32_t)(esp_timer_get_time() / 1000000);
+  snprintf(text, sizeof(text), "%luh %02lum", (unsigned long)(seconds / 3600), (unsigned long)((seconds / 60) % 60));
+  ui_digits_set_text(uptime_tile, text);
+}
+
+static void refresh_cb(lv_timer_t *timer)
+{
+  // Kept built but not shown, nothing to refresh
+  if (lv_obj_get_screen(uptime_tile) != lv_screen_active())
+    return;
+  update_values();
+}
+
+static void build(lv_obj_t *screen)
+{
+  lv_obj_t *panel = ui_create_panel(screen, 780, 150, 10, 10, 0x1a1a2e, 0x16213e);
+  ui_create_title_with_separator(panel, "System", 0x4fc3f7, 750);
+
+  internal_tile = ui_metric_tile_create(panel, "Internal free", "--", 10, 181, font_normal, font_big_numbers, 0xaaaaaa, 0x4fc3f7, true);
+  psram_tile = ui_metric_tile_create(panel, "PSRAM free", "--", 200, 181, font_normal, font_big_numbers, 0xaaaaaa, 0x81c784, true);
+  pool_tile = ui_metric_tile_create(panel, "LVGL pool", "--", 390, 161, font_normal, font_big_numbers, 0xaaaaaa, 0xff7043, true);
+  uptime_tile = ui_metric_tile_create(panel, "Uptime", "--", 560, 190, font_normal, font_big_numbers, 0xaaaaaa, 0xaaaaaa, false);
+
+  lv_obj_t *hint = lv_label_create(screen);
+  lv_label_set_text(hint, "Swipe with two fingers to change pages");
+  lv_obj_add_style(hint, ui_get_text_style(font_small, 0x888888), 0);
+  lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -10);
+
+  refresh_timer = lv_timer_create(refresh_cb, SYSTEM_PAGE_REFRESH_MS, NULL);
+  update_values();
+}
+
+static void evict(void)
+{
+  lv_timer_delete(refresh_timer);
+  refresh_timer = NULL;
+  internal_tile = psram_tile = pool_tile = uptime_tile = NULL;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_system_page_register(void)
+{
+  static const ui_page_t page = {
+      .name = "system",
+      .build = build,
+      .evict = evict,
+  };
+  ui_pages_register(&page);
+}
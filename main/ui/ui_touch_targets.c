@@ -0,0 +1,136 @@
+/**
+ * @file ui_touch_targets.c
+ * @brief Control rectangles of the shown screen for touch feedback
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ui_touch_targets.h"
+
+#include <stdbool.h>
+#include "lvgl_setup.h"
+#include "sdkconfig.h"
+#include "touch_feedback.h"
+
+#if CONFIG_TOUCH_FEEDBACK
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static lv_obj_t *mapped_screen = NULL;
+static bool map_stale = true;
+
+static touch_feedback_rect_t rects[TOUCH_FEEDBACK_MAX_TARGETS];
+static int rect_count = 0;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static bool is_control(const lv_obj_t *obj)
+{
+  return lv_obj_check_type(obj, &lv_button_class) || lv_obj_check_type(obj, &lv_switch_class) ||
+         lv_obj_check_type(obj, &lv_slider_class);
+}
+
+/**
+ * @brief Display coordinates to touch controller coordinates, undoing what LVGL does to pointer input
+ */
+static touch_feedback_rect_t to_touch_rect(const lv_area_t *area)
+{
+  // LCD_ROTATION is an enum value, the preprocessor cannot tell them apart
+  switch (LCD_ROTATION)
+  {
+  case LV_DISPLAY_ROTATION_90:
+    return (touch_feedback_rect_t){area->y1, LCD_V_RES - 1 - area->x2, area->y2, LCD_V_RES - 1 - area->x1};
+  case LV_DISPLAY_ROTATION_180:
+    return (touch_feedback_rect_t){LCD_H_RES - 1 - area->x2, LCD_V_RES - 1 - area->y2, LCD_H_RES - 1 - area->x1,
+                                   LCD_V_RES - 1 - area->y1};
+  case LV_DISPLAY_ROTATION_270:
+    return (touch_feedback_rect_t){LCD_H_RES - 1 - area->y2, area->x1, LCD_H_RES - 1 - area->y1, area->x2};
+  default:
+    return (touch_feedback_rect_t){area->x1, area->y1, area->x2, area->y2};
+  }
+}
+
+/**
+ * @brief Collect the controls below obj that show inside clip
+ */
+static void collect(lv_obj_t *obj, const lv_area_t *clip)
+{
+  if (rect_count >= TOUCH_FEEDBACK_MAX_TARGETS || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN))
+    return;
+
+  lv_area_t visible;
+  lv_obj_get_coords(obj, &visible);
+  if (!lv_area_intersect(&visible, &visible, clip))
+    return;
+
+  if (is_control(obj))
+  {
+    if (lv_obj_has_flag(obj, LV_OBJ_FLAG_CLICKABLE) && !lv_obj_has_state(obj, LV_STATE_DISABLED))
+      rects[rect_count++] = to_touch_rect(&visible);
+    // Labels and images inside a control are covered by it
+    return;
+  }
+
+  uint32_t child_count = lv_obj_get_child_count(obj);
+  for (uint32_t i = 0; i < child_count; i++)
+  {
+    collect(lv_obj_get_child(obj, (int32_t)i), &visible);
+  }
+}
+
+static void scroll_end_cb(lv_event_t *e)
+{
+  (void)e;
+  map_stale = true;
+}
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+void ui_touch_targets_invalidate(void)
+{
+  map_stale = true;
+}
+
+void ui_touch_targets_track_scroll(lv_obj_t *obj)
+{
+  lv_obj_add_event_cb(obj, scroll_end_cb, LV_EVENT_SCROLL_END, NULL);
+}
+
+void ui_touch_targets_process_updates(void)
+{
+  lv_obj_t *screen = lv_screen_active();
+  if (!screen || (!map_stale && screen == mapped_screen))
+    return;
+
+  map_stale = false;
+  mapped_screen = screen;
+  rect_count = 0;
+  lv_area_t clip;
+  lv_obj_get_coords(screen, &clip);
+  collect(screen, &clip);
+  touch_feedback_set_targets(rects, rect_count);
+}
+
+#else
+
+void ui_touch_targets_invalidate(void)
+{
+}
+
+void ui_touch_targets_track_scroll(lv_obj_t *obj)
+{
+  (void)obj;
+}
+
+void ui_touch_targets_process_updates(void)
+{
+}
+
+#endif // CONFIG_TOUCH_FEEDBACK
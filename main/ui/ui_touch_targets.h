@@ -0,0 +1,34 @@
+/**
+ * @file ui_touch_targets.h
+ * @brief Control rectangles of the shown screen for touch feedback
+ *
+ * Walks the active screen for enabled, visible buttons, switches, sliders
+ * and checkboxes, clips each to its scrolling parents and hands the
+ * rectangles, in touch controller coordinates, to touch_feedback.h. The
+ * walk runs again only when another screen is shown or a page reports a
+ * change of its controls, e.g. a scroll that ended or a rebuilt grid.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Controls moved, were added or removed; the map is rebuilt on the next update
+ * @note LVGL task
+ */
+void ui_touch_targets_invalidate(void);
+
+/**
+ * @brief Invalidate the map whenever a scrolling container comes to rest
+ * @param obj Container whose children are controls
+ */
+void ui_touch_targets_track_scroll(lv_obj_t *obj);
+
+/**
+ * @brief Rebuild the map if it is stale (LVGL task only, lock held)
+ */
+void ui_touch_targets_process_updates(void);
@@ -0,0 +1,424 @@
+/**
+ * @file alert_audio.c
+ * @brief Short alert clips from the asset pack on the I2S amplifier
+ *
+ * The S3's GDMA cannot read the flash mapping, so the I2S driver copies
+ * each chunk into its DMA ring; that copy, plus the ADPCM decode or the
+ * volume scaling, is all the CPU does while a clip plays, a few hundred
+ * microseconds per chunk.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "alert_audio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "serial/serial_data_handler.h"
+
+#if CONFIG_ALERT_AUDIO
+
+#include "asset_pack.h"
+#include "driver/i2s_std.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "serial/telemetry_alerts.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+#if CONFIG_TOUCH_FEEDBACK &&                                                                                    \
+    (CONFIG_TOUCH_FEEDBACK_GPIO == CONFIG_ALERT_AUDIO_DOUT_GPIO ||                                              \
+     CONFIG_TOUCH_FEEDBACK_GPIO == CONFIG_ALERT_AUDIO_BCLK_GPIO || CONFIG_TOUCH_FEEDBACK_GPIO == CONFIG_ALERT_AUDIO_WS_GPIO)
+#error "CONFIG_TOUCH_FEEDBACK_GPIO is one of the I2S pins of CONFIG_ALERT_AUDIO, move one of them"
+#endif
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+/** DMA ring, 6 x 240 frames: about 65 ms at 22.05 kHz for the task to come back */
+#define AUDIO_DMA_DESC_NUM 6
+#define AUDIO_DMA_FRAME_NUM 240
+
+/** Samples handed to the driver at a time, fits the ring so the first one preloads whole */
+#define AUDIO_CHUNK_SAMPLES 512
+
+/** Longest a chunk may wait for room in the ring before the clip is given up */
+#define AUDIO_WRITE_TIMEOUT_MS 500
+
+#define AUDIO_MIN_RATE 8000
+#define AUDIO_MAX_RATE 48000
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef struct
+{
+  const alert_audio_clip_t *clip; ///< In the flash mapping, valid until reboot
+  char name[ALERT_AUDIO_NAME_LEN];
+} audio_request_t;
+
+typedef struct
+{
+  int32_t predictor;
+  int index;
+} adpcm_state_t;
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+static const int8_t adpcm_index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+static const int16_t adpcm_step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static i2s_chan_handle_t tx_channel = NULL;
+static QueueHandle_t play_queue = NULL;
+static TaskHandle_t audio_task_handle = NULL;
+static int16_t chunk[AUDIO_CHUNK_SAMPLES]; ///< Decoded or scaled samples, internal RAM
+static uint32_t channel_rate = 0;
+static volatile int volume = CONFIG_ALERT_AUDIO_VOLUME; ///< Percent
+
+// Counters, read by GET_AUDIO
+static portMUX_TYPE audio_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t clips_played = 0;
+static uint32_t clips_dropped = 0;
+static uint32_t clips_failed = 0;
+static uint32_t samples_played = 0;
+static char last_clip[ALERT_AUDIO_NAME_LEN] = "";
+static volatile bool playing = false;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Find and check "sound/<name>"
+ */
+static esp_err_t find_clip(const char *name, const alert_audio_clip_t **clip)
+{
+  char asset_name[ASSET_PACK_NAME_LEN];
+  if (snprintf(asset_name, sizeof(asset_name), "sound/%s", name) >= (int)sizeof(asset_name))
+    return ESP_ERR_NOT_FOUND;
+
+  asset_t asset;
+  if (!asset_pack_find(asset_name, ASSET_TYPE_SOUND, &asset))
+    return ESP_ERR_NOT_FOUND;
+
+  const alert_audio_clip_t *c = asset.data;
+  if (asset.size < sizeof(*c) || c->magic != ALERT_AUDIO_MAGIC || c->version != ALERT_AUDIO_VERSION ||
+      c->sample_rate < AUDIO_MIN_RATE || c->sample_rate > AUDIO_MAX_RATE || c->adpcm_index > 88)
+    return ESP_ERR_INVALID_SIZE;
+
+  size_t data_size = asset.size - sizeof(*c);
+  if ((c->format == ALERT_AUDIO_PCM16 && c->samples > data_size / sizeof(int16_t)) ||
+      (c->format == ALERT_AUDIO_IMA_ADPCM && c->samples > data_size * 2) || c->format > ALERT_AUDIO_IMA_ADPCM)
+    return ESP_ERR_INVALID_SIZE;
+
+  *clip = c;
+  return ESP_OK;
+}
+
+static int16_t adpcm_decode(adpcm_state_t *state, uint8_t nibble)
+{
+  int32_t step = adpcm_step_table[state->index];
+  int32_t diff = step >> 3;
+  if (nibble & 4)
+    diff += step;
+  if (nibble & 2)
+    diff += step >> 1;
+  if (nibble & 1)
+    diff += step >> 2;
+  state->predictor += (nibble & 8) ? -diff : diff;
+  if (state->predictor > INT16_MAX)
+    state->predictor = INT16_MAX;
+  else if (state->predictor < INT16_MIN)
+    state->predictor = INT16_MIN;
+
+  state->index += adpcm_index_table[nibble];
+  if (state->index < 0)
+    state->index = 0;
+  else if (state->index > 88)
+    state->index = 88;
+  return (int16_t)state->predictor;
+}
+
+/**
+ * @brief Samples [first, first + count) of a clip at the current volume
+ * @return The samples in the flash mapping for full-volume PCM, else in chunk
+ */
+static const int16_t *render(const alert_audio_clip_t *clip, uint32_t first, uint32_t count, adpcm_state_t *adpcm)
+{
+  const uint8_t *data = (const uint8_t *)(clip + 1);
+  int gain = volume * 256 / 100;
+
+  if (clip->format == ALERT_AUDIO_PCM16)
+  {
+    const int16_t *pcm = (const int16_t *)data + first;
+    if (gain == 256)
+      return pcm;
+    for (uint32_t i = 0; i < count; i++)
+      chunk[i] = (int16_t)((pcm[i] * gain) >> 8);
+    return chunk;
+  }
+
+  // Decoded in order, first is always where the previous chunk ended
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t n = first + i;
+    uint8_t nibble = (n & 1) ? data[n / 2] >> 4 : data[n / 2] & 0x0F;
+    chunk[i] = (int16_t)((adpcm_decode(adpcm, nibble) * gain) >> 8);
+  }
+  return chunk;
+}
+
+static esp_err_t set_rate(uint32_t rate)
+{
+  if (rate == channel_rate)
+    return ESP_OK;
+  i2s_std_clk_config_t clk = I2S_STD_CLK_DEFAULT_CONFIG(rate);
+  esp_err_t err = i2s_channel_reconfig_std_clock(tx_channel, &clk);
+  if (err == ESP_OK)
+    channel_rate = rate;
+  return err;
+}
+
+/**
+ * @brief Play one clip, the channel runs only for its length
+ */
+static esp_err_t play_clip(const alert_audio_clip_t *clip)
+{
+  esp_err_t err = set_rate(clip->sample_rate);
+  if (err != ESP_OK)
+    return err;
+
+  adpcm_state_t adpcm = {.predictor = clip->adpcm_predictor, .index = clip->adpcm_index};
+  bool started = false;
+  uint32_t done = 0;
+  while (done < clip->samples && err == ESP_OK)
+  {
+    uint32_t count = clip->samples - done < AUDIO_CHUNK_SAMPLES ? clip->samples - done : AUDIO_CHUNK_SAMPLES;
+    const int16_t *samples = render(clip, done, count, &adpcm);
+    size_t bytes = count * sizeof(int16_t);
+    size_t loaded = 0;
+
+    // Filled ring first, so the channel does not start on an empty one
+    if (!started)
+    {
+      i2s_channel_preload_data(tx_channel, samples, bytes, &loaded);
+      err = i2s_channel_enable(tx_channel);
+      started = err == ESP_OK;
+    }
+    if (err == ESP_OK && loaded < bytes)
+    {
+      size_t written = 0;
+      err = i2s_channel_write(tx_channel, (const uint8_t *)samples + loaded, bytes - loaded, &written,
+                              pdMS_TO_TICKS(AUDIO_WRITE_TIMEOUT_MS));
+    }
+    done += count;
+  }
+
+  if (started)
+  {
+    // Let the ring drain, the driver sends silence after the last chunk
+    uint32_t ring_ms = AUDIO_DMA_DESC_NUM * AUDIO_DMA_FRAME_NUM * 1000 / clip->sample_rate;
+    vTaskDelay(pdMS_TO_TICKS(ring_ms + 10));
+    i2s_channel_disable(tx_channel);
+  }
+
+  portENTER_CRITICAL(&audio_lock);
+  samples_played += done;
+  portEXIT_CRITICAL(&audio_lock);
+  return err;
+}
+
+static void audio_task(void *arg)
+{
+  (void)arg;
+  audio_request_t request;
+  for (;;)
+  {
+    xQueueReceive(play_queue, &request, portMAX_DELAY);
+    playing = true;
+    esp_err_t err = play_clip(request.clip);
+    playing = false;
+
+    portENTER_CRITICAL(&audio_lock);
+    if (err == ESP_OK)
+      clips_played++;
+    else
+      clips_failed++;
+    strlcpy(last_clip, request.name, sizeof(last_clip));
+    portEXIT_CRITICAL(&audio_lock);
+
+    if (err != ESP_OK)
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "Sound %s stopped: %s", request.name, esp_err_to_name(err));
+  }
+}
+
+static void reply_error(const char *message)
+{
+  char reply[96];
+  int len = snprintf(reply, sizeof(reply), "AUDIO {\"error\":\"%s\"}\n", message);
+  serial_data_write(reply, len);
+}
+
+#endif // CONFIG_ALERT_AUDIO
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t alert_audio_init(void)
+{
+#if CONFIG_ALERT_AUDIO
+  if (tx_channel)
+    return ESP_OK;
+
+  i2s_chan_config_t chan_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
+  chan_config.dma_desc_num = AUDIO_DMA_DESC_NUM;
+  chan_config.dma_frame_num = AUDIO_DMA_FRAME_NUM;
+  chan_config.auto_clear = true;
+  esp_err_t err = i2s_new_channel(&chan_config, &tx_channel, NULL);
+  if (err != ESP_OK)
+    return err;
+
+  channel_rate = 22050;
+  i2s_std_config_t std_config = {
+      .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(22050),
+      .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+      .gpio_cfg =
+          {
+              .mclk = I2S_GPIO_UNUSED,
+              .bclk = CONFIG_ALERT_AUDIO_BCLK_GPIO,
+              .ws = CONFIG_ALERT_AUDIO_WS_GPIO,
+              .dout = CONFIG_ALERT_AUDIO_DOUT_GPIO,
+              .din = I2S_GPIO_UNUSED,
+          },
+  };
+  err = i2s_channel_init_std_mode(tx_channel, &std_config);
+  if (err == ESP_OK)
+  {
+    play_queue = xQueueCreate(ALERT_AUDIO_QUEUE_LEN, sizeof(audio_request_t));
+    if (!play_queue || task_plan_create(TASK_PLAN_ALERT_AUDIO, audio_task, NULL, &audio_task_handle) != pdPASS)
+      err = ESP_ERR_NO_MEM;
+  }
+  if (err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Alert audio not started: %s", esp_err_to_name(err));
+    i2s_del_channel(tx_channel);
+    tx_channel = NULL;
+    return err;
+  }
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Alert audio on I2S, BCLK %d WS %d DOUT %d", CONFIG_ALERT_AUDIO_BCLK_GPIO,
+                   CONFIG_ALERT_AUDIO_WS_GPIO, CONFIG_ALERT_AUDIO_DOUT_GPIO);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t alert_audio_play(const char *name)
+{
+#if CONFIG_ALERT_AUDIO
+  if (!audio_task_handle)
+    return ESP_ERR_INVALID_STATE;
+
+  audio_request_t request;
+  esp_err_t err = find_clip(name, &request.clip);
+  if (err != ESP_OK)
+    return err;
+  strlcpy(request.name, name, sizeof(request.name));
+
+  if (xQueueSend(play_queue, &request, 0) != pdTRUE)
+  {
+    portENTER_CRITICAL(&audio_lock);
+    clips_dropped++;
+    portEXIT_CRITICAL(&audio_lock);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+#else
+  (void)name;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void alert_audio_play_alerts(uint32_t raised)
+{
+#if CONFIG_ALERT_AUDIO
+  if (!raised)
+    return;
+  for (int alert = 0; alert < TELEMETRY_ALERT_COUNT; alert++)
+  {
+    if ((raised & (1u << alert)) && alert_audio_play(telemetry_alerts_name((telemetry_alert_t)alert)) == ESP_OK)
+      return;
+  }
+  alert_audio_play("alert");
+#else
+  (void)raised;
+#endif
+}
+
+bool alert_audio_handle_command(const char *line)
+{
+  bool get = strcmp(line, "GET_AUDIO") == 0;
+  bool play = strncmp(line, "PLAY_SOUND ", 11) == 0;
+  bool set_volume = strncmp(line, "AUDIO_VOLUME ", 13) == 0;
+  if (!get && !play && !set_volume)
+    return false;
+
+#if CONFIG_ALERT_AUDIO
+  if (play)
+  {
+    esp_err_t err = alert_audio_play(line + 11);
+    if (err != ESP_OK)
+    {
+      reply_error(esp_err_to_name(err));
+      return true;
+    }
+  }
+  else if (set_volume)
+  {
+    char *end = NULL;
+    long value = strtol(line + 13, &end, 10);
+    if (end == line + 13 || *end != '\0' || value < 0 || value > 100)
+    {
+      reply_error("volume is 0 to 100");
+      return true;
+    }
+    volume = (int)value;
+  }
+
+  portENTER_CRITICAL(&audio_lock);
+  uint32_t played = clips_played;
+  uint32_t dropped = clips_dropped;
+  uint32_t failed = clips_failed;
+  uint32_t samples = samples_played;
+  char last[ALERT_AUDIO_NAME_LEN];
+  strlcpy(last, last_clip, sizeof(last));
+  portEXIT_CRITICAL(&audio_lock);
+
+  char reply[256];
+  int len = snprintf(reply, sizeof(reply),
+                     "AUDIO {\"playing\":%s,\"queued\":%u,\"volume\":%d,\"rate\":%lu,\"played\":%lu,"
+                     "\"dropped\":%lu,\"failed\":%lu,\"samples\":%lu,\"last\":\"%s\"}\n",
+                     playing ? "true" : "false", play_queue ? (unsigned)uxQueueMessagesWaiting(play_queue) : 0,
+                     volume, (unsigned long)channel_rate, (unsigned long)played, (unsigned long)dropped,
+                     (unsigned long)failed, (unsigned long)samples, last);
+  serial_data_write(reply, len);
+#else
+  static const char disabled[] = "AUDIO {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
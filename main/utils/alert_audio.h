@@ -0,0 +1,118 @@
+/**
+ * @file alert_audio.h
+ * @brief Short alert clips from the asset pack on the I2S amplifier
+ *
+ * Clips are "sound/<name>" assets (utils/asset_pack.py --sound), mono
+ * 16-bit PCM or 4-bit IMA ADPCM behind an alert_audio_clip_t header, and
+ * are played from the flash mapping: PCM at full volume goes to the I2S
+ * driver as it is, ADPCM and scaled PCM through one small chunk buffer.
+ * One task plays the queued clips in turn; the first chunk is preloaded
+ * into the DMA ring before the channel starts, and the channel is stopped
+ * again between clips, so an idle player costs no interrupts.
+ *
+ * A threshold alert that raises plays "sound/<alert>" (e.g. sound/cpu_temp),
+ * or "sound/alert" if the pack has no clip of its own for it. Home
+ * Assistant plays a clip by firing the system_monitor_sound event with
+ * {"clip": "<name>"}, "sound/notify" if the event names none.
+ *
+ * GET_AUDIO reports the player, PLAY_SOUND <name> queues a clip and
+ * AUDIO_VOLUME <0-100> sets the volume until reboot.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef ALERT_AUDIO_H
+#define ALERT_AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define ALERT_AUDIO_MAGIC 0x444E5344u ///< "DSND"
+#define ALERT_AUDIO_VERSION 1
+
+  /** Clips waiting behind the one playing, later requests are dropped */
+#define ALERT_AUDIO_QUEUE_LEN 4
+
+  /** Clip name including terminator, what an asset name leaves after "sound/" */
+#define ALERT_AUDIO_NAME_LEN 26
+
+  /** Event fired by Home Assistant to play a clip */
+#define ALERT_AUDIO_HA_EVENT "system_monitor_sound"
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    ALERT_AUDIO_PCM16 = 0,     ///< Signed 16-bit samples
+    ALERT_AUDIO_IMA_ADPCM = 1, ///< 4-bit IMA ADPCM, low nibble first, one block from the header's predictor
+  } alert_audio_format_t;
+
+  /**
+   * @brief Header of a sound asset, the samples follow, little-endian
+   */
+  typedef struct
+  {
+    uint32_t magic;          ///< ALERT_AUDIO_MAGIC
+    uint16_t version;        ///< ALERT_AUDIO_VERSION
+    uint8_t format;          ///< alert_audio_format_t
+    uint8_t reserved;
+    uint32_t sample_rate;    ///< Hz, 8000 to 48000
+    uint32_t samples;        ///< Mono samples in the clip
+    int16_t adpcm_predictor; ///< First sample, IMA ADPCM only
+    uint8_t adpcm_index;     ///< First step index, IMA ADPCM only
+    uint8_t reserved2;
+  } alert_audio_clip_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create the I2S channel and the player task, the channel stays stopped
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if CONFIG_ALERT_AUDIO is disabled,
+   *         or the I2S driver's error
+   * @note Call after asset_pack_init()
+   */
+  esp_err_t alert_audio_init(void);
+
+  /**
+   * @brief Queue "sound/<name>"
+   * @return ESP_OK, ESP_ERR_NOT_FOUND without such a clip, ESP_ERR_INVALID_SIZE
+   *         for a damaged one, ESP_ERR_NO_MEM if the queue is full,
+   *         ESP_ERR_INVALID_STATE before alert_audio_init()
+   * @note Any task, does not wait
+   */
+  esp_err_t alert_audio_play(const char *name);
+
+  /**
+   * @brief Sound newly raised threshold alerts, one clip per call
+   * @param raised One bit per telemetry_alert_t that was not active before
+   * @note Any task, does not wait
+   */
+  void alert_audio_play_alerts(uint32_t raised);
+
+  /**
+   * @brief Handle GET_AUDIO, PLAY_SOUND <name> and AUDIO_VOLUME <0-100>
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an audio command
+   */
+  bool alert_audio_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALERT_AUDIO_H
@@ -0,0 +1,214 @@
+/**
+ * @file asset_pack.c
+ * @brief Read-only asset pack on the spiffs data partition
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "asset_pack.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+#if CONFIG_ASSET_PACK
+// Written once at boot before any lookup, read-only afterwards
+static const uint8_t *pack_base = NULL;
+static const asset_pack_entry_t *pack_entries = NULL;
+static uint16_t pack_count = 0;
+static uint32_t pack_size = 0;
+static esp_partition_mmap_handle_t pack_mmap;
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_ASSET_PACK
+static int compare_entries(const asset_pack_entry_t *a, const asset_pack_entry_t *b)
+{
+  if (a->name_hash != b->name_hash)
+    return a->name_hash < b->name_hash ? -1 : 1;
+  return strncmp(a->name, b->name, ASSET_PACK_NAME_LEN);
+}
+
+/**
+ * @brief Check that every entry is terminated, hashed, sorted, aligned and inside the pack
+ */
+static bool directory_valid(const asset_pack_entry_t *entries, uint16_t count, uint32_t size)
+{
+  uint32_t data_start = sizeof(asset_pack_header_t) + count * sizeof(asset_pack_entry_t);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    const asset_pack_entry_t *e = &entries[i];
+    if (memchr(e->name, '\0', ASSET_PACK_NAME_LEN) == NULL || e->offset % 4 != 0 || e->offset < data_start ||
+        e->offset > size || e->size > size - e->offset || e->name_hash != asset_pack_hash(e->name))
+      return false;
+    if (i > 0 && compare_entries(&entries[i - 1], e) >= 0)
+      return false;
+  }
+  return true;
+}
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t asset_pack_init(void)
+{
+#if CONFIG_ASSET_PACK
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                         CONFIG_ASSET_PACK_PARTITION);
+  if (!part)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Asset partition not found, using built-in assets");
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // The header says how much to map, an erased partition reads 0xFF
+  asset_pack_header_t header;
+  esp_err_t err = esp_partition_read(part, 0, &header, sizeof(header));
+  if (err != ESP_OK)
+    return err;
+  if (header.magic != ASSET_PACK_MAGIC)
+  {
+    debug_log_info(DEBUG_TAG_SYSTEM, "No asset pack, using built-in assets");
+    return ESP_ERR_NOT_FOUND;
+  }
+  uint32_t dir_end = sizeof(header) + header.count * sizeof(asset_pack_entry_t);
+  if (header.version != ASSET_PACK_VERSION || header.size > part->size || header.size < dir_end)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Asset pack v%u of %lu bytes not usable", header.version,
+                        (unsigned long)header.size);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  const void *mapped;
+  err = esp_partition_mmap(part, 0, header.size, ESP_PARTITION_MMAP_DATA, &mapped, &pack_mmap);
+  if (err != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Asset pack mmap failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  const asset_pack_entry_t *entries = (const asset_pack_entry_t *)((const uint8_t *)mapped + sizeof(header));
+  size_t dir_bytes = header.count * sizeof(asset_pack_entry_t);
+  if (esp_rom_crc32_le(0, (const uint8_t *)entries, dir_bytes) != header.dir_crc32 ||
+      !directory_valid(entries, header.count, header.size))
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "Asset pack directory damaged, using built-in assets");
+    esp_partition_munmap(pack_mmap);
+    return ESP_ERR_INVALID_CRC;
+  }
+
+  pack_base = mapped;
+  pack_entries = entries;
+  pack_count = header.count;
+  pack_size = header.size;
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Asset pack: %u assets, %lu KB mapped", pack_count,
+                   (unsigned long)(pack_size / 1024));
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t asset_pack_hash(const char *name)
+{
+  uint32_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)name; *p; p++)
+  {
+    hash = (hash ^ *p) * 16777619u;
+  }
+  return hash;
+}
+
+bool asset_pack_find(const char *name, asset_type_t type, asset_t *asset)
+{
+#if CONFIG_ASSET_PACK
+  if (!pack_base || !name || !asset)
+    return false;
+
+  // First entry with this hash, colliding names follow it in name order
+  uint32_t hash = asset_pack_hash(name);
+  size_t lo = 0, hi = pack_count;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (pack_entries[mid].name_hash < hash)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  const asset_pack_entry_t *e = NULL;
+  for (; lo < pack_count && pack_entries[lo].name_hash == hash; lo++)
+  {
+    if (strncmp(pack_entries[lo].name, name, ASSET_PACK_NAME_LEN) == 0)
+    {
+      e = &pack_entries[lo];
+      break;
+    }
+  }
+  if (!e || e->type != type)
+    return false;
+
+  asset->name = e->name;
+  asset->type = (asset_type_t)e->type;
+  asset->data = pack_base + e->offset;
+  asset->size = e->size;
+  return true;
+#else
+  (void)name;
+  (void)type;
+  (void)asset;
+  return false;
+#endif
+}
+
+bool asset_pack_handle_command(const char *line)
+{
+  bool verify = strcmp(line, "GET_ASSETS verify") == 0;
+  if (!verify && strcmp(line, "GET_ASSETS") != 0)
+    return false;
+
+#if CONFIG_ASSET_PACK
+  static const char *const type_names[] = {"blob", "image", "font", "icons", "sound"};
+  char buf[160];
+  uint32_t bad = 0;
+  for (uint16_t i = 0; i < pack_count && pack_base; i++)
+  {
+    const asset_pack_entry_t *e = &pack_entries[i];
+    const char *crc = "";
+    if (verify)
+    {
+      // Reads the whole asset through the cache, fine for a diagnostic
+      bool ok = esp_rom_crc32_le(0, pack_base + e->offset, e->size) == e->crc32;
+      bad += !ok;
+      crc = ok ? ",\"crc\":\"ok\"" : ",\"crc\":\"bad\"";
+    }
+    int len = snprintf(buf, sizeof(buf), "ASSETS {\"name\":\"%s\",\"type\":\"%s\",\"size\":%lu%s}\n", e->name,
+                       e->type < sizeof(type_names) / sizeof(type_names[0]) ? type_names[e->type] : "unknown",
+                       (unsigned long)e->size, crc);
+    serial_data_write(buf, len);
+  }
+  int len = snprintf(buf, sizeof(buf), "ASSETS {\"mounted\":%s,\"count\":%u,\"bytes\":%lu", pack_base ? "true" : "false",
+                     pack_count, (unsigned long)pack_size);
+  if (verify)
+    len += snprintf(buf + len, sizeof(buf) - len, ",\"bad\":%lu", (unsigned long)bad);
+  len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+  serial_data_write(buf, len);
+#else
+  static const char disabled[] = "ASSETS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file asset_pack.h
+ * @brief Read-only asset pack on the spiffs data partition
+ *
+ * Fonts, images and config files can be stored in a pack written to the
+ * spiffs partition with utils/asset_pack.py and parttool.py, so they can
+ * be updated without reflashing the app. The partition is memory-mapped
+ * through the flash cache and every asset is handed out as a pointer into
+ * that mapping, nothing is copied to RAM.
+ *
+ * Layout, little-endian, every asset 4-byte aligned:
+ *
+ *   asset_pack_header_t
+ *   asset_pack_entry_t[count]     sorted by name hash, then name
+ *   asset data
+ *
+ * Lookups hash the name once and binary-search the directory comparing
+ * 32-bit hashes, names are only compared for the matching entry.
+ *
+ * The directory CRC is checked at mount, asset CRCs by GET_ASSETS verify.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define ASSET_PACK_MAGIC 0x4B415044u ///< "DPAK"
+#define ASSET_PACK_VERSION 2
+#define ASSET_PACK_NAME_LEN 32 ///< Including terminator
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief How an asset is to be interpreted
+   */
+  typedef enum
+  {
+    ASSET_TYPE_BLOB = 0,       ///< Raw bytes, e.g. a config file
+    ASSET_TYPE_IMAGE = 1,      ///< LVGL binary image (lv_image_header_t followed by pixels, RGB565 from the packer)
+    ASSET_TYPE_FONT = 2,       ///< Relocatable LVGL bitmap font, see ui_assets.c
+    ASSET_TYPE_ICON_ATLAS = 3, ///< Named RGB565A8 icons behind a sorted index, see ui_assets.c
+    ASSET_TYPE_SOUND = 4,      ///< Alert clip, alert_audio_clip_t followed by samples, see alert_audio.h
+  } asset_type_t;
+
+  typedef struct
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;     ///< Directory entries
+    uint32_t size;      ///< Bytes of the whole pack
+    uint32_t dir_crc32; ///< CRC32 of the directory entries
+  } asset_pack_header_t;
+
+  typedef struct
+  {
+    uint32_t name_hash; ///< FNV-1a of the name, see asset_pack_hash()
+    char name[ASSET_PACK_NAME_LEN];
+    uint8_t type; ///< asset_type_t
+    uint8_t reserved[3];
+    uint32_t offset; ///< From the start of the pack
+    uint32_t size;
+    uint32_t crc32;
+  } asset_pack_entry_t;
+
+  /**
+   * @brief One asset, pointing into the flash mapping
+   */
+  typedef struct
+  {
+    const char *name;
+    asset_type_t type;
+    const void *data;
+    size_t size;
+  } asset_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Map the pack partition and check its directory
+   * @return ESP_OK, ESP_ERR_NOT_FOUND without partition or pack,
+   *         ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_SIZE for a damaged pack,
+   *         ESP_ERR_NOT_SUPPORTED if CONFIG_ASSET_PACK is disabled
+   * @note Without a pack every lookup fails and built-in assets are used
+   */
+  esp_err_t asset_pack_init(void);
+
+  /**
+   * @brief 32-bit FNV-1a hash of an asset name, as stored in the directory
+   */
+  uint32_t asset_pack_hash(const char *name);
+
+  /**
+   * @brief Look up an asset by name
+   * @param name Asset name, e.g. "font_dash_title"
+   * @param type Expected type
+   * @param asset Output, data stays valid until reboot
+   * @return true if found with that type
+   */
+  bool asset_pack_find(const char *name, asset_type_t type, asset_t *asset);
+
+  /**
+   * @brief Handle GET_ASSETS and GET_ASSETS verify
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an asset command
+   */
+  bool asset_pack_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASSET_PACK_H
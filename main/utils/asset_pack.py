@@ -0,0 +1,485 @@
+#!/usr/bin/env python3
+"""
+Dashboard Asset Packer
+======================
+
+Builds the read-only asset pack that CONFIG_ASSET_PACK maps from the
+spiffs partition (see asset_pack.h for the layout). Fonts, images and
+config files in the pack replace the built-in ones without reflashing
+the app:
+
+- Fonts: lv_font_conv C output (e.g. from font_subset.py), turned into
+  the relocatable form ui_assets.c loads. Names must match ui_config.c,
+  e.g. font_dash_title.
+- Images: PNGs, converted to native RGB565 (RGB565A8 with transparency)
+  LVGL images that are drawn straight from flash, or LVGL binary images
+  (.bin from LVGLImage.py). Entity icons are named icon/<entity_id> or
+  icon/<domain>, e.g. icon/light.
+- Icon atlas: a directory of small PNGs named like Material Design Icons
+  (water-pump.png for mdi:water-pump), packed into one icons/mdi asset
+  behind a sorted index. Entities whose HA "icon" attribute names one of
+  them show that icon.
+- Sounds: WAV files, mixed down to mono and stored as 16-bit PCM, or as
+  4-bit IMA ADPCM with --adpcm (a quarter of the size), for the alert
+  clips of alert_audio.c. Names are sound/<name>, e.g. sound/alert.
+- Files: any bytes, e.g. config/entities with one "entity_id,label" per
+  line for the default HA entity registry, or config/layout with the
+  dashboard panel layouts (see ui/ui_layout.h).
+
+Usage:
+    python asset_pack.py --font font_dash_title=fonts/font_dash_title.c \\
+                         --file config/entities=entities.txt --icons mdi_icons/ \\
+                         --sound sound/alert=chime.wav --adpcm -o assets.bin
+    parttool.py write_partition --partition-name spiffs --input assets.bin
+    python asset_pack.py --list assets.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import wave
+import zlib
+from typing import Dict, List, Tuple
+
+PACK_MAGIC = 0x4B415044  # "DPAK"
+PACK_VERSION = 2
+NAME_LEN = 32
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<I32sB3xIII")
+
+TYPE_BLOB, TYPE_IMAGE, TYPE_FONT, TYPE_ICON_ATLAS, TYPE_SOUND = 0, 1, 2, 3, 4
+TYPE_NAMES = {TYPE_BLOB: "blob", TYPE_IMAGE: "image", TYPE_FONT: "font", TYPE_ICON_ATLAS: "icons", TYPE_SOUND: "sound"}
+
+FONT_MAGIC = 0x544E4644  # "DFNT"
+FONT_VERSION = 1
+FONT_HEADER = struct.Struct("<IHBBhhbbHHBBIIIIII")
+FONT_CMAP = struct.Struct("<IHHIIHBB")
+FONT_KERN_CLASSES = struct.Struct("<IIIBBH")
+FONT_KERN_PAIRS = struct.Struct("<IIIB3x")
+GLYPH_DSC = struct.Struct("<IBBbb")  # bitmap_index:20, adv_w:12 share the first word
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_COLOR_FORMAT_RGB565 = 0x12
+LV_COLOR_FORMAT_RGB565A8 = 0x14
+IMAGE_HEADER = struct.Struct("<BBHHHHH")  # lv_image_header_t
+
+ICON_ATLAS_NAME = "icons/mdi"
+ICON_ATLAS_MAGIC = 0x4E434944  # "DICN"
+ICON_ATLAS_VERSION = 1
+ICON_ATLAS_HEADER = struct.Struct("<IHH")
+ICON_ATLAS_ENTRY = struct.Struct("<I28sHHI")
+ICON_MAX_SIZE = 64
+ICON_NAME_PATTERN = re.compile(r"^[a-z0-9-]{1,27}$")
+
+SOUND_MAGIC = 0x444E5344  # "DSND"
+SOUND_VERSION = 1
+SOUND_HEADER = struct.Struct("<IHBxIIhBx")  # alert_audio_clip_t
+SOUND_PCM16, SOUND_IMA_ADPCM = 0, 1
+SOUND_RATES = (8000, 48000)
+ADPCM_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+ADPCM_STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97,
+    107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871,
+    5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+    24623, 27086, 29794, 32767,
+]
+
+CMAP_TYPES = {
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL": 0,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_FULL": 1,
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY": 2,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_TINY": 3,
+}
+
+NAME_PATTERN = re.compile(r"^[A-Za-z0-9_./-]{1,31}$")
+ARRAY = re.compile(r"(?:static\s+)?(?:LV_ATTRIBUTE_LARGE_CONST\s+)?const\s+(\w+)\s+(\w+)\s*\[\]\s*=\s*\{(.*?)\};", re.S)
+STRUCT = re.compile(r"(?:static\s+)?(?:const\s+)?(lv_font_fmt_txt_\w+|lv_font_t)\s+(\w+)\s*=\s*\{(.*?)\};", re.S)
+FIELD = re.compile(r"\.(\w+)\s*=\s*([^,{}]+)")
+
+
+# =============================================================================
+# lv_font_conv C output
+# =============================================================================
+
+
+def strip_c(source: str) -> str:
+    """Drop comments and preprocessor lines, lv_font_conv guards are version checks."""
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    source = re.sub(r"//[^\n]*", "", source)
+    return "\n".join(line for line in source.splitlines() if not line.lstrip().startswith("#"))
+
+
+def c_int(value: str) -> int:
+    value = value.strip().rstrip("uUlL")
+    return int(value, 0)
+
+
+def fields(body: str) -> Dict[str, str]:
+    return {key: value.strip() for key, value in FIELD.findall(body)}
+
+
+class FontSource:
+    """Arrays and structs of one lv_font_conv .c file"""
+
+    def __init__(self, path: str):
+        source = strip_c(open(path, encoding="utf-8").read())
+        self.arrays: Dict[str, Tuple[str, str]] = {name: (ctype, body) for ctype, name, body in ARRAY.findall(source)}
+        self.structs: Dict[str, Tuple[str, str]] = {name: (ctype, body) for ctype, name, body in STRUCT.findall(source)}
+
+    def ints(self, name: str) -> List[int]:
+        _, body = self.arrays[name]
+        return [c_int(v) for v in body.split(",") if v.strip()]
+
+    def struct_of_type(self, ctype: str) -> Dict[str, str]:
+        for struct_type, body in self.structs.values():
+            if struct_type == ctype:
+                return fields(body)
+        raise ValueError(f"no {ctype} in font source")
+
+    def glyph_dsc(self, name: str) -> List[Dict[str, int]]:
+        _, body = self.arrays[name]
+        return [{k: c_int(v) for k, v in fields(entry).items()} for entry in re.findall(r"\{([^{}]*)\}", body)]
+
+    def cmaps(self, name: str) -> List[Dict[str, str]]:
+        _, body = self.arrays[name]
+        return [fields(entry) for entry in re.findall(r"\{([^{}]*)\}", body)]
+
+
+class BlobWriter:
+    """Appends 4-byte aligned tables and returns their offsets"""
+
+    def __init__(self, head_size: int):
+        self.data = bytearray(head_size)
+
+    def add(self, payload: bytes) -> int:
+        self.data += b"\0" * (-len(self.data) % 4)
+        offset = len(self.data)
+        self.data += payload
+        return offset
+
+
+def pack_array(values: List[int], fmt: str) -> bytes:
+    return struct.pack(f"<{len(values)}{fmt}", *values)
+
+
+def array_format(source: FontSource, name: str) -> str:
+    ctype = source.arrays[name][0]
+    return {"uint8_t": "B", "int8_t": "b", "uint16_t": "H"}[ctype]
+
+
+def convert_font(path: str) -> bytes:
+    """lv_font_conv C output to the relocatable font blob of ui_assets.c"""
+    src = FontSource(path)
+    font = src.struct_of_type("lv_font_t")
+    dsc = src.struct_of_type("lv_font_fmt_txt_dsc_t")
+
+    glyphs = src.glyph_dsc(dsc["glyph_dsc"])
+    bitmap = bytes(v & 0xFF for v in src.ints(dsc["glyph_bitmap"]))
+    cmaps = src.cmaps(dsc["cmaps"])
+    kern_ref = dsc.get("kern_dsc", "NULL").lstrip("&").strip()
+    kern_type = 0 if kern_ref == "NULL" else (1 if c_int(dsc.get("kern_classes", "0")) else 2)
+    kern_record = FONT_KERN_CLASSES.size if kern_type == 1 else FONT_KERN_PAIRS.size
+
+    cmaps_offset = FONT_HEADER.size
+    kern_offset = cmaps_offset + len(cmaps) * FONT_CMAP.size
+    blob = BlobWriter(kern_offset + (kern_record if kern_type else 0))
+
+    bitmap_offset = blob.add(bitmap)
+    glyph_words = []
+    for g in glyphs:
+        if g["bitmap_index"] >= 1 << 20 or g["adv_w"] >= 1 << 12:
+            raise ValueError("font needs LV_FONT_FMT_TXT_LARGE, not supported in packs")
+        glyph_words.append(GLYPH_DSC.pack(g["bitmap_index"] | g["adv_w"] << 20, g["box_w"], g["box_h"], g["ofs_x"], g["ofs_y"]))
+    glyph_dsc_offset = blob.add(b"".join(glyph_words))
+
+    cmap_records = []
+    for cmap in cmaps:
+        unicode_offset = ids_offset = 0
+        if cmap.get("unicode_list", "NULL") != "NULL":
+            unicode_offset = blob.add(pack_array(src.ints(cmap["unicode_list"]), "H"))
+        if cmap.get("glyph_id_ofs_list", "NULL") != "NULL":
+            name = cmap["glyph_id_ofs_list"]
+            ids_offset = blob.add(pack_array(src.ints(name), array_format(src, name)))
+        cmap_records.append(
+            FONT_CMAP.pack(
+                c_int(cmap["range_start"]),
+                c_int(cmap["range_length"]),
+                c_int(cmap["glyph_id_start"]),
+                unicode_offset,
+                ids_offset,
+                c_int(cmap["list_length"]),
+                CMAP_TYPES[cmap["type"]],
+                0,
+            )
+        )
+
+    kern = b""
+    if kern_type == 1:
+        k = fields(src.structs[kern_ref][1])
+        values = blob.add(pack_array(src.ints(k["class_pair_values"]), "b"))
+        left = blob.add(pack_array(src.ints(k["left_class_mapping"]), "B"))
+        right = blob.add(pack_array(src.ints(k["right_class_mapping"]), "B"))
+        kern = FONT_KERN_CLASSES.pack(values, left, right, c_int(k["left_class_cnt"]), c_int(k["right_class_cnt"]), 0)
+    elif kern_type == 2:
+        k = fields(src.structs[kern_ref][1])
+        ids_size = c_int(k.get("glyph_ids_size", "0"))
+        ids = blob.add(pack_array(src.ints(k["glyph_ids"]), "H" if ids_size else "B"))
+        values = blob.add(pack_array(src.ints(k["values"]), "b"))
+        kern = FONT_KERN_PAIRS.pack(ids, values, c_int(k["pair_cnt"]), ids_size)
+
+    header = FONT_HEADER.pack(
+        FONT_MAGIC,
+        FONT_VERSION,
+        c_int(dsc["bpp"]),
+        c_int(dsc.get("bitmap_format", "0")),
+        c_int(font["line_height"]),
+        c_int(font["base_line"]),
+        c_int(font.get("underline_position", "0")),
+        c_int(font.get("underline_thickness", "0")),
+        c_int(dsc.get("kern_scale", "0")),
+        len(cmaps),
+        kern_type,
+        0,
+        len(glyphs),
+        bitmap_offset,
+        len(bitmap),
+        glyph_dsc_offset,
+        cmaps_offset,
+        kern_offset if kern_type else 0,
+    )
+    blob.data[: kern_offset + len(kern)] = header + b"".join(cmap_records) + kern
+    return bytes(blob.data)
+
+
+# =============================================================================
+# Pack
+# =============================================================================
+
+
+def fnv1a(name: str) -> int:
+    """Name hash of the directory, asset_pack_hash() on the device"""
+    h = 2166136261
+    for b in name.encode():
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def rgba_to_lvgl(width: int, height: int, rgba: bytes) -> bytes:
+    """RGBA8888 pixels to an LVGL RGB565 image, RGB565A8 if any pixel is transparent"""
+    pixels = bytearray()
+    alpha = rgba[3::4]
+    for i in range(0, len(rgba), 4):
+        r, g, b = rgba[i], rgba[i + 1], rgba[i + 2]
+        pixels += struct.pack("<H", (r >> 3) << 11 | (g >> 2) << 5 | b >> 3)
+    if all(a == 0xFF for a in alpha):
+        return IMAGE_HEADER.pack(LV_IMAGE_HEADER_MAGIC, LV_COLOR_FORMAT_RGB565, 0, width, height, width * 2, 0) + pixels
+    # RGB565A8 keeps the alpha plane after the color plane
+    header = IMAGE_HEADER.pack(LV_IMAGE_HEADER_MAGIC, LV_COLOR_FORMAT_RGB565A8, 0, width, height, width * 2, 0)
+    return header + pixels + bytes(alpha)
+
+
+def load_png(path: str) -> Tuple[int, int, bytes]:
+    """Width, height and RGBA8888 pixels of a PNG"""
+    try:
+        from PIL import Image
+    except ImportError:
+        raise ValueError("PNG images need Pillow: pip install pillow")
+    with Image.open(path) as image:
+        image = image.convert("RGBA")
+        return image.width, image.height, image.tobytes()
+
+
+def load_image(name: str, path: str) -> bytes:
+    if path.lower().endswith(".png"):
+        return rgba_to_lvgl(*load_png(path))
+
+    data = open(path, "rb").read()
+    if len(data) < IMAGE_HEADER.size or data[0] != LV_IMAGE_HEADER_MAGIC:
+        raise ValueError(f"{name}: not a PNG or an LVGL v9 binary image")
+    _, _, _, w, h, stride, _ = IMAGE_HEADER.unpack_from(data)
+    if stride * h > len(data) - IMAGE_HEADER.size:
+        raise ValueError(f"{name}: {w}x{h} image is truncated")
+    return data
+
+
+def build_icon_atlas(directory: str) -> bytes:
+    """Every PNG of a directory as one RGB565A8 atlas, indexed like the pack directory"""
+    icons = []
+    for file_name in sorted(os.listdir(directory)):
+        stem, ext = os.path.splitext(file_name)
+        if ext.lower() != ".png":
+            continue
+        if not ICON_NAME_PATTERN.match(stem):
+            raise ValueError(f"{file_name}: icon names are up to 27 of [a-z0-9-], as in mdi:<name>")
+        width, height, rgba = load_png(os.path.join(directory, file_name))
+        if width > ICON_MAX_SIZE or height > ICON_MAX_SIZE:
+            raise ValueError(f"{file_name}: {width}x{height} is larger than {ICON_MAX_SIZE}x{ICON_MAX_SIZE}")
+        # Same planes as an RGB565A8 image, without the header
+        pixels = rgba_to_lvgl(width, height, rgba)[IMAGE_HEADER.size:]
+        if len(pixels) == width * height * 2:
+            pixels += b"\xff" * (width * height)
+        icons.append((stem, width, height, pixels))
+    if not icons:
+        raise ValueError(f"{directory}: no PNG icons")
+    if len(icons) > 0xFFFF:
+        raise ValueError(f"{directory}: too many icons")
+
+    icons.sort(key=lambda i: (fnv1a(i[0]), i[0].encode()))
+    offset = ICON_ATLAS_HEADER.size + len(icons) * ICON_ATLAS_ENTRY.size
+    entries, data = [], bytearray()
+    for name, width, height, pixels in icons:
+        data += b"\0" * (-(offset + len(data)) % 4)
+        entries.append(ICON_ATLAS_ENTRY.pack(fnv1a(name), name.encode(), width, height, offset + len(data)))
+        data += pixels
+    return ICON_ATLAS_HEADER.pack(ICON_ATLAS_MAGIC, ICON_ATLAS_VERSION, len(icons)) + b"".join(entries) + bytes(data)
+
+
+def load_wav(path: str) -> Tuple[int, List[int]]:
+    """Sample rate and mono 16-bit samples of a PCM WAV file"""
+    try:
+        with wave.open(path, "rb") as wav:
+            channels, width, rate = wav.getnchannels(), wav.getsampwidth(), wav.getframerate()
+            frames = wav.readframes(wav.getnframes())
+    except wave.Error as e:
+        raise ValueError(f"{path}: {e}")
+    if width not in (1, 2):
+        raise ValueError(f"{path}: {width * 8}-bit samples, expected 8 or 16-bit PCM")
+    if not SOUND_RATES[0] <= rate <= SOUND_RATES[1]:
+        raise ValueError(f"{path}: {rate} Hz is outside {SOUND_RATES[0]}-{SOUND_RATES[1]} Hz")
+    if width == 1:
+        values = [(b - 128) << 8 for b in frames]
+    else:
+        values = list(struct.unpack(f"<{len(frames) // 2}h", frames))
+    mono = [sum(values[i : i + channels]) // channels for i in range(0, len(values), channels)]
+    return rate, mono
+
+
+def adpcm_encode(samples: List[int]) -> Tuple[int, int, bytes]:
+    """First predictor, first step index and the 4-bit IMA ADPCM codes, low nibble first"""
+    predictor, index = samples[0], 0
+    codes = []
+    for sample in samples:
+        step = ADPCM_STEPS[index]
+        diff = sample - predictor
+        code = 8 if diff < 0 else 0
+        diff = abs(diff)
+        # Same rounding as the decoder in alert_audio.c
+        delta = step >> 3
+        if diff >= step:
+            code |= 4
+            diff -= step
+            delta += step
+        if diff >= step >> 1:
+            code |= 2
+            diff -= step >> 1
+            delta += step >> 1
+        if diff >= step >> 2:
+            code |= 1
+            delta += step >> 2
+        predictor = max(-32768, min(32767, predictor - delta if code & 8 else predictor + delta))
+        index = max(0, min(88, index + ADPCM_INDEX[code]))
+        codes.append(code)
+    if len(codes) % 2:
+        codes.append(0)
+    return samples[0], 0, bytes(codes[i] | codes[i + 1] << 4 for i in range(0, len(codes), 2))
+
+
+def load_sound(name: str, path: str, adpcm: bool) -> bytes:
+    if not name.startswith("sound/") or len(name) > NAME_LEN - 1:
+        raise ValueError(f"{name}: sound names are sound/<name>")
+    rate, samples = load_wav(path)
+    if not samples:
+        raise ValueError(f"{name}: {path} has no samples")
+    if adpcm:
+        predictor, index, data = adpcm_encode(samples)
+        return SOUND_HEADER.pack(SOUND_MAGIC, SOUND_VERSION, SOUND_IMA_ADPCM, rate, len(samples), predictor, index) + data
+    data = struct.pack(f"<{len(samples)}h", *samples)
+    return SOUND_HEADER.pack(SOUND_MAGIC, SOUND_VERSION, SOUND_PCM16, rate, len(samples), 0, 0) + data
+
+
+def build_pack(assets: List[Tuple[str, int, bytes]]) -> bytes:
+    assets = sorted(assets, key=lambda a: (fnv1a(a[0]), a[0].encode()))
+    names = [a[0] for a in assets]
+    if len(set(names)) != len(names):
+        raise ValueError("duplicate asset name")
+
+    offset = HEADER.size + len(assets) * ENTRY.size
+    entries, data = [], bytearray()
+    for name, asset_type, payload in assets:
+        pad = -(offset + len(data)) % 4
+        data += b"\0" * pad
+        entries.append(ENTRY.pack(fnv1a(name), name.encode(), asset_type, offset + len(data), len(payload), zlib.crc32(payload)))
+        data += payload
+
+    directory = b"".join(entries)
+    size = offset + len(data)
+    return HEADER.pack(PACK_MAGIC, PACK_VERSION, len(assets), size, zlib.crc32(directory)) + directory + bytes(data)
+
+
+def list_pack(path: str) -> None:
+    pack = open(path, "rb").read()
+    magic, version, count, size, dir_crc = HEADER.unpack_from(pack)
+    if magic != PACK_MAGIC or version != PACK_VERSION:
+        sys.exit(f"{path}: not an asset pack v{PACK_VERSION}")
+    directory = pack[HEADER.size : HEADER.size + count * ENTRY.size]
+    print(f"{count} assets, {size} bytes, directory {'ok' if zlib.crc32(directory) == dir_crc else 'DAMAGED'}")
+    for i in range(count):
+        _, name, asset_type, offset, length, crc = ENTRY.unpack_from(directory, i * ENTRY.size)
+        ok = zlib.crc32(pack[offset : offset + length]) == crc
+        name = name.rstrip(b"\0").decode()
+        print(f"  {name:32} {TYPE_NAMES.get(asset_type, '?'):6} {length:8} {'ok' if ok else 'BAD CRC'}")
+
+
+def parse_spec(spec: str) -> Tuple[str, str]:
+    name, sep, path = spec.partition("=")
+    if not sep or not NAME_PATTERN.match(name):
+        raise argparse.ArgumentTypeError(f"expected NAME=PATH with a name of up to 31 of [A-Za-z0-9_./-]: {spec}")
+    return name, path
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the dashboard asset pack")
+    parser.add_argument("--font", type=parse_spec, action="append", default=[], help="NAME=lv_font_conv .c file")
+    parser.add_argument("--image", type=parse_spec, action="append", default=[], help="NAME=PNG or LVGL binary image")
+    parser.add_argument("--file", type=parse_spec, action="append", default=[], help="NAME=any file")
+    parser.add_argument("--icons", metavar="DIR", help="Directory of <mdi name>.png icons for the icon atlas")
+    parser.add_argument("--sound", type=parse_spec, action="append", default=[], help="sound/NAME=WAV file")
+    parser.add_argument("--adpcm", action="store_true", help="Store the sounds as IMA ADPCM instead of PCM")
+    parser.add_argument("--output", "-o", default="assets.bin", help="Pack to write")
+    parser.add_argument("--partition-size", type=lambda v: int(v, 0), default=0x360000, help="Size of the spiffs partition")
+    parser.add_argument("--list", metavar="PACK", help="Print the contents of a pack and check its CRCs")
+    args = parser.parse_args()
+
+    if args.list:
+        list_pack(args.list)
+        return
+
+    assets = []
+    try:
+        for name, path in args.font:
+            assets.append((name, TYPE_FONT, convert_font(path)))
+        for name, path in args.image:
+            assets.append((name, TYPE_IMAGE, load_image(name, path)))
+        for name, path in args.file:
+            assets.append((name, TYPE_BLOB, open(path, "rb").read()))
+        if args.icons:
+            assets.append((ICON_ATLAS_NAME, TYPE_ICON_ATLAS, build_icon_atlas(args.icons)))
+        for name, path in args.sound:
+            assets.append((name, TYPE_SOUND, load_sound(name, path, args.adpcm)))
+        pack = build_pack(assets)
+    except (KeyError, ValueError, OSError) as e:
+        sys.exit(f"asset_pack: {e}")
+
+    if len(pack) > args.partition_size:
+        sys.exit(f"asset_pack: {len(pack)} bytes do not fit the {args.partition_size} byte partition")
+    with open(args.output, "wb") as f:
+        f.write(pack)
+    print(f"{args.output}: {len(assets)} assets, {len(pack)} bytes")
+    print(f"Flash with: parttool.py write_partition --partition-name spiffs --input {os.path.abspath(args.output)}")
+
+
+if __name__ == "__main__":
+    main()
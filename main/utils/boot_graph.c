@@ -0,0 +1,443 @@
+/**
+ * @file boot_graph.c
+ * @brief Dependency-aware parallel init orchestrator
+ *
+ * The calling task is the scheduler: it starts every step whose
+ * dependencies are done, then sleeps on an event group until one of the
+ * running steps finishes. Only running steps hold a stack, so a wide graph
+ * costs no more RAM than the steps that actually overlap.
+ *
+ * The RTC trace is written as steps finish, so a boot that hangs or
+ * crashes half way still leaves the phases it got through for the next
+ * boot to report.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "boot_graph.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+#define BOOT_TRACE_MAGIC 0x42544331 // "BTC1", bump when boot_trace_t changes
+#define BOOT_TRACE_MAX_ENTRIES (BOOT_GRAPH_MAX_STEPS + BOOT_GRAPH_MAX_MILESTONES)
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+typedef struct
+{
+  const char *name;
+  esp_err_t (*run)(void);
+  int64_t start_us; // Since boot
+  int64_t end_us;
+  esp_err_t result;
+  bool skipped; // A dependency failed
+} step_record_t;
+
+typedef struct
+{
+  const char *name;
+  int64_t at_us; // Since boot
+} milestone_t;
+
+typedef struct
+{
+  char name[BOOT_TRACE_NAME_LEN];
+  uint32_t done_ms;  // Since boot
+  uint32_t took_ms;  // 0 for milestones
+  int32_t result;    // esp_err_t, ESP_ERR_INVALID_STATE for a skipped step
+  bool milestone;
+} boot_trace_entry_t;
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t boot_number; // Boots since power-on
+  uint32_t reset_reason;
+  uint32_t count;
+  boot_trace_entry_t entries[BOOT_TRACE_MAX_ENTRIES];
+} boot_trace_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static EventGroupHandle_t step_events = NULL;
+static step_record_t records[BOOT_GRAPH_MAX_STEPS];
+static int record_count = 0;
+static int64_t graph_start_us = 0;
+static int64_t graph_end_us = 0;
+
+static milestone_t milestones[BOOT_GRAPH_MAX_MILESTONES];
+static int milestone_count = 0;
+
+// Guards the milestones and the trace, written from any task
+static portMUX_TYPE trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Left alone by the startup code, so it outlives a soft reset
+static RTC_NOINIT_ATTR boot_trace_t rtc_trace;
+static boot_trace_t previous_trace;
+static bool trace_open = false;
+
+static const char *const reset_names[] = {
+    [ESP_RST_UNKNOWN] = "unknown",
+    [ESP_RST_POWERON] = "power_on",
+    [ESP_RST_EXT] = "external",
+    [ESP_RST_SW] = "software",
+    [ESP_RST_PANIC] = "panic",
+    [ESP_RST_INT_WDT] = "int_wdt",
+    [ESP_RST_TASK_WDT] = "task_wdt",
+    [ESP_RST_WDT] = "wdt",
+    [ESP_RST_DEEPSLEEP] = "deep_sleep",
+    [ESP_RST_BROWNOUT] = "brownout",
+    [ESP_RST_SDIO] = "sdio",
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Append one line to the RTC trace
+ * @note Call with trace_lock held
+ */
+static void trace_append_locked(const char *name, int64_t done_us, int64_t took_us, esp_err_t result, bool milestone)
+{
+  if (!trace_open || rtc_trace.count >= BOOT_TRACE_MAX_ENTRIES)
+  {
+    return;
+  }
+
+  boot_trace_entry_t *entry = &rtc_trace.entries[rtc_trace.count];
+  strncpy(entry->name, name, sizeof(entry->name) - 1);
+  entry->name[sizeof(entry->name) - 1] = '\0';
+  entry->done_ms = (uint32_t)(done_us / 1000);
+  entry->took_ms = (uint32_t)(took_us / 1000);
+  entry->result = result;
+  entry->milestone = milestone;
+  rtc_trace.count++;
+}
+
+static void trace_append(const char *name, int64_t done_us, int64_t took_us, esp_err_t result)
+{
+  portENTER_CRITICAL(&trace_lock);
+  trace_append_locked(name, done_us, took_us, result, false);
+  portEXIT_CRITICAL(&trace_lock);
+}
+
+static const char *reset_name(uint32_t reason)
+{
+  if (reason < sizeof(reset_names) / sizeof(reset_names[0]) && reset_names[reason])
+  {
+    return reset_names[reason];
+  }
+  return "other";
+}
+
+static void print_trace(const char *title, const boot_trace_t *trace)
+{
+  char buf[128];
+  int len;
+  if (trace->magic != BOOT_TRACE_MAGIC)
+  {
+    len = snprintf(buf, sizeof(buf), "BOOT_TRACE %s: none\n", title);
+    serial_data_write(buf, len);
+    return;
+  }
+
+  len = snprintf(buf, sizeof(buf), "BOOT_TRACE %s: boot %lu, reset %s\n", title, (unsigned long)trace->boot_number,
+                 reset_name(trace->reset_reason));
+  serial_data_write(buf, len);
+  len = snprintf(buf, sizeof(buf), "BOOT_TRACE   %-16s %8s %8s  %s\n", "phase", "done_ms", "took_ms", "result");
+  serial_data_write(buf, len);
+
+  for (uint32_t i = 0; i < trace->count; i++)
+  {
+    const boot_trace_entry_t *entry = &trace->entries[i];
+    if (entry->milestone)
+    {
+      len = snprintf(buf, sizeof(buf), "BOOT_TRACE   %-16.*s %8lu %8s\n", BOOT_TRACE_NAME_LEN - 1, entry->name,
+                     (unsigned long)entry->done_ms, "-");
+    }
+    else
+    {
+      len = snprintf(buf, sizeof(buf), "BOOT_TRACE   %-16.*s %8lu %8lu  %s\n", BOOT_TRACE_NAME_LEN - 1, entry->name,
+                     (unsigned long)entry->done_ms, (unsigned long)entry->took_ms, esp_err_to_name(entry->result));
+    }
+    serial_data_write(buf, len);
+  }
+}
+
+static void step_task(void *arg)
+{
+  int index = (int)(intptr_t)arg;
+  step_record_t *record = &records[index];
+
+  record->start_us = esp_timer_get_time();
+  record->result = record->run();
+  record->end_us = esp_timer_get_time();
+
+  xEventGroupSetBits(step_events, BOOT_DEP(index));
+  vTaskDelete(NULL);
+}
+
+static bool launch_step(const boot_step_t *step, int index)
+{
+  uint32_t stack = step->stack_size ? step->stack_size : BOOT_GRAPH_DEFAULT_STACK;
+  BaseType_t core = (step->core == BOOT_CORE_ANY) ? tskNO_AFFINITY : (BaseType_t)step->core;
+
+  // Same priority as the caller, steps may not starve the scheduler
+  return xTaskCreatePinnedToCore(step_task, step->name, stack, (void *)(intptr_t)index,
+                                 uxTaskPriorityGet(NULL), NULL, core) == pdPASS;
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void boot_graph_trace_begin(void)
+{
+  if (trace_open)
+  {
+    return;
+  }
+
+  esp_reset_reason_t reason = esp_reset_reason();
+  uint32_t boot_number = 1;
+
+  // RTC memory holds noise after power-on and may be corrupt after a brownout
+  bool kept = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && rtc_trace.magic == BOOT_TRACE_MAGIC &&
+              rtc_trace.count <= BOOT_TRACE_MAX_ENTRIES;
+  if (kept)
+  {
+    previous_trace = rtc_trace;
+    boot_number = rtc_trace.boot_number + 1;
+  }
+  else
+  {
+    memset(&previous_trace, 0, sizeof(previous_trace));
+  }
+
+  memset(&rtc_trace, 0, sizeof(rtc_trace));
+  rtc_trace.magic = BOOT_TRACE_MAGIC;
+  rtc_trace.boot_number = boot_number;
+  rtc_trace.reset_reason = reason;
+  trace_open = true;
+
+  if (kept)
+  {
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Boot %lu, previous boot traced %lu phases", (unsigned long)boot_number,
+                     (unsigned long)previous_trace.count);
+  }
+}
+
+esp_err_t boot_graph_run(const boot_step_t *steps, int count)
+{
+  if (!steps || count <= 0 || count > BOOT_GRAPH_MAX_STEPS)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    // Dependencies on earlier steps only, so the graph cannot have a cycle
+    if (!steps[i].run || (steps[i].deps & ~(BOOT_DEP(i) - 1)) != 0)
+    {
+      debug_log_error_f(DEBUG_TAG_SYSTEM, "Boot step %d (%s) is invalid", i, steps[i].name ? steps[i].name : "?");
+      return ESP_ERR_INVALID_ARG;
+    }
+  }
+
+  if (!step_events)
+  {
+    step_events = xEventGroupCreate();
+    if (!step_events)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  xEventGroupClearBits(step_events, BOOT_DEP(count) - 1);
+
+  memset(records, 0, sizeof(records));
+  record_count = count;
+  for (int i = 0; i < count; i++)
+  {
+    records[i].name = steps[i].name;
+    records[i].run = steps[i].run;
+  }
+
+  const uint32_t all = BOOT_DEP(count) - 1;
+  uint32_t done = 0;
+  uint32_t failed = 0;
+  uint32_t launched = 0;
+  esp_err_t first_error = ESP_OK;
+  graph_start_us = esp_timer_get_time();
+
+  while (done != all)
+  {
+    // Start everything that is ready; skipping a step can make others ready
+    bool progress = true;
+    while (progress)
+    {
+      progress = false;
+      for (int i = 0; i < count; i++)
+      {
+        uint32_t bit = BOOT_DEP(i);
+        if ((launched & bit) || (steps[i].deps & done) != steps[i].deps)
+        {
+          continue;
+        }
+
+        launched |= bit;
+        records[i].start_us = records[i].end_us = esp_timer_get_time();
+        if (steps[i].deps & failed)
+        {
+          records[i].skipped = true;
+          records[i].result = ESP_ERR_INVALID_STATE;
+          done |= bit;
+          failed |= bit;
+          progress = true;
+          trace_append(steps[i].name, records[i].end_us, 0, ESP_ERR_INVALID_STATE);
+          debug_log_warning_f(DEBUG_TAG_SYSTEM, "Boot step %s skipped, a dependency failed", steps[i].name);
+        }
+        else if (!launch_step(&steps[i], i))
+        {
+          records[i].result = ESP_ERR_NO_MEM;
+          done |= bit;
+          failed |= bit;
+          progress = true;
+          if (first_error == ESP_OK)
+            first_error = ESP_ERR_NO_MEM;
+          trace_append(steps[i].name, records[i].end_us, 0, ESP_ERR_NO_MEM);
+          debug_log_error_f(DEBUG_TAG_SYSTEM, "Boot step %s could not be started", steps[i].name);
+        }
+      }
+    }
+
+    uint32_t running = launched & ~done;
+    if (!running)
+    {
+      break;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(step_events, running, pdFALSE, pdFALSE, portMAX_DELAY);
+    uint32_t finished = (uint32_t)bits & running;
+    for (int i = 0; i < count; i++)
+    {
+      if (!(finished & BOOT_DEP(i)))
+      {
+        continue;
+      }
+
+      done |= BOOT_DEP(i);
+      step_record_t *record = &records[i];
+      trace_append(record->name, record->end_us, record->end_us - record->start_us, record->result);
+      debug_log_info_f(DEBUG_TAG_SYSTEM, "Boot step %s: %lld ms at +%lld ms, %s", record->name,
+                       (record->end_us - record->start_us) / 1000, (record->start_us - graph_start_us) / 1000,
+                       esp_err_to_name(record->result));
+      if (record->result != ESP_OK)
+      {
+        failed |= BOOT_DEP(i);
+        if (first_error == ESP_OK)
+          first_error = record->result;
+      }
+    }
+  }
+
+  graph_end_us = esp_timer_get_time();
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Boot graph done in %lld ms", (graph_end_us - graph_start_us) / 1000);
+  return first_error;
+}
+
+void boot_graph_mark_milestone(const char *name)
+{
+  int64_t now_us = esp_timer_get_time();
+  bool stamped = false;
+
+  portENTER_CRITICAL(&trace_lock);
+  bool seen = false;
+  for (int i = 0; i < milestone_count; i++)
+  {
+    if (strcmp(milestones[i].name, name) == 0)
+    {
+      seen = true;
+      break;
+    }
+  }
+  if (!seen && milestone_count < BOOT_GRAPH_MAX_MILESTONES)
+  {
+    milestones[milestone_count].name = name;
+    milestones[milestone_count].at_us = now_us;
+    milestone_count++;
+    stamped = true;
+    trace_append_locked(name, now_us, 0, ESP_OK, true);
+  }
+  portEXIT_CRITICAL(&trace_lock);
+
+  if (stamped)
+  {
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Boot milestone %s at %lld ms", name, now_us / 1000);
+  }
+}
+
+bool boot_graph_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_BOOT_TRACE") == 0)
+  {
+    // The live trace keeps growing, print a snapshot of it
+    static boot_trace_t current;
+    portENTER_CRITICAL(&trace_lock);
+    current = rtc_trace;
+    portEXIT_CRITICAL(&trace_lock);
+
+    print_trace("this boot", &current);
+    print_trace("previous boot", &previous_trace);
+    return true;
+  }
+  if (strcmp(line, "GET_BOOT_TIMES") != 0)
+    return false;
+
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf), "BOOT_TIMES {\"graph_start_ms\":%lld,\"graph_ms\":%lld,\"steps\":[",
+                     graph_start_us / 1000, (graph_end_us - graph_start_us) / 1000);
+  serial_data_write(buf, len);
+
+  for (int i = 0; i < record_count; i++)
+  {
+    const step_record_t *record = &records[i];
+    len = snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"start_ms\":%lld,\"ms\":%lld,\"result\":\"%s\"}",
+                   i ? "," : "", record->name, (record->start_us - graph_start_us) / 1000,
+                   (record->end_us - record->start_us) / 1000,
+                   record->skipped ? "skipped" : esp_err_to_name(record->result));
+    serial_data_write(buf, len);
+  }
+
+  milestone_t copy[BOOT_GRAPH_MAX_MILESTONES];
+  portENTER_CRITICAL(&trace_lock);
+  int count = milestone_count;
+  memcpy(copy, milestones, sizeof(copy));
+  portEXIT_CRITICAL(&trace_lock);
+
+  serial_data_write("],\"milestones\":{", 16);
+  for (int i = 0; i < count; i++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s\"%s\":%lld", i ? "," : "", copy[i].name, copy[i].at_us / 1000);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("}}\n", 3);
+  return true;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file boot_graph.h
+ * @brief Dependency-aware parallel init orchestrator
+ *
+ * Startup is described as a table of steps, each naming the steps it needs
+ * finished first. Every step whose dependencies are done runs on its own
+ * short-lived task, so independent work such as the touch controller reset,
+ * UI creation and WiFi start overlaps instead of running in series. Each
+ * step is timed, and later milestones (first frame, first IP, first HA
+ * sync) can be stamped against the same clock. GET_BOOT_TIMES reports all
+ * of it as JSON.
+ *
+ * Every step and milestone is also appended to a trace in RTC memory. It
+ * survives a soft reset, panic or watchdog reset, so GET_BOOT_TRACE can
+ * print this boot and the one before it side by side as a table.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef BOOT_GRAPH_H
+#define BOOT_GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Steps per graph, one event group bit each */
+#define BOOT_GRAPH_MAX_STEPS 24
+
+  /** Stack of a step task when the step leaves stack_size at 0 */
+#define BOOT_GRAPH_DEFAULT_STACK 4096
+
+  /** Milestones kept for GET_BOOT_TIMES */
+#define BOOT_GRAPH_MAX_MILESTONES 12
+
+  /** Longest step or milestone name kept in the RTC trace, with the terminator */
+#define BOOT_TRACE_NAME_LEN 16
+
+  /** Dependency mask bit of a step index */
+#define BOOT_DEP(step) (1UL << (step))
+
+  /** Run the step on whichever core is free */
+#define BOOT_CORE_ANY -1
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief One init step
+   */
+  typedef struct
+  {
+    const char *name;
+    esp_err_t (*run)(void); ///< Runs on its own task, a failure skips every step that depends on it
+    uint32_t deps;          ///< BOOT_DEP() of earlier steps that must finish first
+    uint32_t stack_size;    ///< 0 for BOOT_GRAPH_DEFAULT_STACK
+    int core;               ///< Core to run on, 0 like app_main by default, or BOOT_CORE_ANY
+  } boot_step_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Open the boot trace
+   * @note Call first thing in app_main(), it keeps the previous boot's trace
+   *       and starts an empty one for this boot
+   */
+  void boot_graph_trace_begin(void);
+
+  /**
+   * @brief Run all steps, each as soon as its dependencies are done
+   * @param steps Step table, dependencies may only name earlier entries
+   * @param count Number of steps, at most BOOT_GRAPH_MAX_STEPS
+   * @return ESP_OK if every step succeeded, otherwise the first failure
+   * @note Blocks the caller until every step has finished or been skipped
+   */
+  esp_err_t boot_graph_run(const boot_step_t *steps, int count);
+
+  /**
+   * @brief Stamp a milestone with the time since boot
+   * @param name Static string, the first stamp of a name wins
+   * @note Callable from any task
+   */
+  void boot_graph_mark_milestone(const char *name);
+
+  /**
+   * @brief Handle GET_BOOT_TIMES and GET_BOOT_TRACE
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a boot timing command
+   */
+  bool boot_graph_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_GRAPH_H
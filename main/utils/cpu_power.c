@@ -0,0 +1,261 @@
+/**
+ * @file cpu_power.c
+ * @brief CPU frequency scaling held up by rendering, touch and HA work
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "cpu_power.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "driver/temperature_sensor.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial_data_handler.h"
+#include "system_debug_utils.h"
+
+#if CONFIG_CPU_POWER_SCALING
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static const char *const reason_names[CPU_POWER_REASON_COUNT] = {
+    [CPU_POWER_RENDER] = "render",
+    [CPU_POWER_TOUCH] = "touch",
+    [CPU_POWER_HA_SYNC] = "ha_sync",
+    [CPU_POWER_SCANOUT] = "scanout",
+};
+
+// Each reason has a single writer task; the lock keeps the bookkeeping consistent for readers
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_pm_lock_handle_t pm_locks[CPU_POWER_REASON_COUNT];
+static bool pm_configured = false;
+static uint32_t held_mask = 0;
+static int64_t held_since_us[CPU_POWER_REASON_COUNT];
+static int64_t held_total_us[CPU_POWER_REASON_COUNT];
+
+// Thermal check, esp_timer task
+static temperature_sensor_handle_t temp_sensor = NULL;
+static esp_timer_handle_t thermal_timer = NULL;
+static volatile bool throttled = false;
+static volatile float chip_celsius = 0.0f;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static esp_err_t configure(int max_freq_mhz)
+{
+  esp_pm_config_t config = {
+      .max_freq_mhz = max_freq_mhz,
+      .min_freq_mhz = CPU_POWER_MIN_FREQ_MHZ,
+      .light_sleep_enable = false,
+  };
+  return esp_pm_configure(&config);
+}
+
+static void thermal_timer_cb(void *arg)
+{
+  float celsius;
+  if (temperature_sensor_get_celsius(temp_sensor, &celsius) != ESP_OK)
+  {
+    return;
+  }
+  chip_celsius = celsius;
+
+  bool hot = throttled ? celsius > CONFIG_CPU_POWER_THERMAL_LIMIT_C - CPU_POWER_THERMAL_HYSTERESIS_C
+                       : celsius >= CONFIG_CPU_POWER_THERMAL_LIMIT_C;
+  if (hot == throttled)
+  {
+    return;
+  }
+  if (configure(hot ? CPU_POWER_THERMAL_FREQ_MHZ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ) == ESP_OK)
+  {
+    throttled = hot;
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Chip at %.1f C, CPU maximum %d MHz", celsius,
+                        hot ? CPU_POWER_THERMAL_FREQ_MHZ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+  }
+}
+
+static void start_thermal_check(void)
+{
+  temperature_sensor_config_t sensor_config = TEMPERATURE_SENSOR_CONFIG_DEFAULT(20, 100);
+  if (temperature_sensor_install(&sensor_config, &temp_sensor) != ESP_OK)
+  {
+    debug_log_warning(DEBUG_TAG_SYSTEM, "No chip temperature sensor, CPU maximum fixed");
+    return;
+  }
+  temperature_sensor_enable(temp_sensor);
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = thermal_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "cpu_thermal",
+      .skip_unhandled_events = true,
+  };
+  if (esp_timer_create(&timer_args, &thermal_timer) == ESP_OK)
+  {
+    esp_timer_start_periodic(thermal_timer, (uint64_t)CPU_POWER_THERMAL_PERIOD_S * 1000000);
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t cpu_power_init(void)
+{
+  if (pm_configured)
+  {
+    return ESP_OK;
+  }
+
+  for (int reason = 0; reason < CPU_POWER_REASON_COUNT; reason++)
+  {
+    esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, reason_names[reason], &pm_locks[reason]);
+    if (ret != ESP_OK)
+    {
+      return ret;
+    }
+  }
+
+  // Holds taken before now only changed the bookkeeping
+  portENTER_CRITICAL(&power_lock);
+  uint32_t mask = held_mask;
+  pm_configured = true;
+  portEXIT_CRITICAL(&power_lock);
+  for (int reason = 0; reason < CPU_POWER_REASON_COUNT; reason++)
+  {
+    if (mask & (1u << reason))
+    {
+      esp_pm_lock_acquire(pm_locks[reason]);
+    }
+  }
+
+  esp_err_t ret = configure(CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "CPU frequency scaling not configured: %s", esp_err_to_name(ret));
+    return ret;
+  }
+  start_thermal_check();
+
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "CPU scaling %d-%d MHz", CPU_POWER_MIN_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+  return ESP_OK;
+}
+
+void cpu_power_hold(cpu_power_reason_t reason, bool hold)
+{
+  if (reason >= CPU_POWER_REASON_COUNT)
+  {
+    return;
+  }
+
+  uint32_t bit = 1u << reason;
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&power_lock);
+  bool change = hold != ((held_mask & bit) != 0);
+  bool configured = pm_configured;
+  if (change)
+  {
+    if (hold)
+    {
+      held_mask |= bit;
+      held_since_us[reason] = now_us;
+    }
+    else
+    {
+      held_mask &= ~bit;
+      held_total_us[reason] += now_us - held_since_us[reason];
+    }
+  }
+  portEXIT_CRITICAL(&power_lock);
+
+  if (!change || !configured)
+  {
+    return;
+  }
+  if (hold)
+  {
+    esp_pm_lock_acquire(pm_locks[reason]);
+  }
+  else
+  {
+    esp_pm_lock_release(pm_locks[reason]);
+  }
+}
+
+bool cpu_power_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_CPU_POWER") != 0)
+  {
+    return false;
+  }
+
+  int64_t now_us = esp_timer_get_time();
+  int64_t held_ms[CPU_POWER_REASON_COUNT];
+  portENTER_CRITICAL(&power_lock);
+  uint32_t mask = held_mask;
+  for (int reason = 0; reason < CPU_POWER_REASON_COUNT; reason++)
+  {
+    int64_t total_us = held_total_us[reason];
+    if (mask & (1u << reason))
+    {
+      total_us += now_us - held_since_us[reason];
+    }
+    held_ms[reason] = total_us / 1000;
+  }
+  portEXIT_CRITICAL(&power_lock);
+
+  char reply[320];
+  int len = snprintf(reply, sizeof(reply),
+                     "CPU_POWER {\"min_mhz\":%d,\"max_mhz\":%d,\"throttled\":%s,\"chip_c\":%.1f,\"uptime_ms\":%lld,"
+                     "\"held\":{",
+                     CPU_POWER_MIN_FREQ_MHZ, throttled ? CPU_POWER_THERMAL_FREQ_MHZ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+                     throttled ? "true" : "false", (double)chip_celsius, (long long)(now_us / 1000));
+  for (int reason = 0; reason < CPU_POWER_REASON_COUNT && len < (int)sizeof(reply); reason++)
+  {
+    len += snprintf(reply + len, sizeof(reply) - len, "%s\"%s\":{\"now\":%s,\"ms\":%lld}", reason ? "," : "",
+                    reason_names[reason], (mask & (1u << reason)) ? "true" : "false", (long long)held_ms[reason]);
+  }
+  if (len < (int)sizeof(reply))
+  {
+    len += snprintf(reply + len, sizeof(reply) - len, "}}\n");
+  }
+  if (len >= (int)sizeof(reply))
+  {
+    len = sizeof(reply) - 1;
+  }
+  serial_data_write(reply, len);
+  return true;
+}
+
+#else
+
+esp_err_t cpu_power_init(void)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void cpu_power_hold(cpu_power_reason_t reason, bool hold)
+{
+  (void)reason;
+  (void)hold;
+}
+
+bool cpu_power_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_CPU_POWER") != 0)
+  {
+    return false;
+  }
+  static const char disabled[] = "CPU_POWER {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+  return true;
+}
+
+#endif // CONFIG_CPU_POWER_SCALING
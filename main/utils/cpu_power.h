@@ -0,0 +1,94 @@
+/**
+ * @file cpu_power.h
+ * @brief CPU frequency scaling held up by rendering, touch and HA work
+ *
+ * With CONFIG_PM_ENABLE the CPU runs at CPU_POWER_MIN_FREQ_MHZ while
+ * nothing needs it and jumps to the maximum while a reason holds an
+ * ESP_PM_CPU_FREQ_MAX lock: an LVGL pass, the active (recently touched)
+ * display, a Home Assistant sync, and RGB scan-out when bounce buffers are
+ * copied by the CPU. Light sleep is not used, the RGB panel driver keeps
+ * its PLL clock, and with it the CPU, out of light sleep while it exists.
+ *
+ * The chip temperature is read every CPU_POWER_THERMAL_PERIOD_S; above
+ * CONFIG_CPU_POWER_THERMAL_LIMIT_C the maximum drops to 160 MHz until it
+ * has cooled by CPU_POWER_THERMAL_HYSTERESIS_C. GET_CPU_POWER reports the
+ * frequencies, the held reasons and how long each was held.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef CPU_POWER_H
+#define CPU_POWER_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#ifdef CONFIG_CPU_POWER_MIN_FREQ_MHZ
+#define CPU_POWER_MIN_FREQ_MHZ CONFIG_CPU_POWER_MIN_FREQ_MHZ
+#else
+#define CPU_POWER_MIN_FREQ_MHZ 80
+#endif
+
+  /** Maximum while the chip is too hot */
+#define CPU_POWER_THERMAL_FREQ_MHZ 160
+#define CPU_POWER_THERMAL_PERIOD_S 5
+#define CPU_POWER_THERMAL_HYSTERESIS_C 5
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Why the CPU needs its maximum frequency, one lock each
+   */
+  typedef enum
+  {
+    CPU_POWER_RENDER = 0, ///< LVGL task pass: input, UI updates, timers and rendering
+    CPU_POWER_TOUCH,      ///< Display active after a touch
+    CPU_POWER_HA_SYNC,    ///< Home Assistant states are fetched and parsed
+    CPU_POWER_SCANOUT,    ///< Bounce buffers are refilled by the CPU while scan-out runs
+    CPU_POWER_REASON_COUNT
+  } cpu_power_reason_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Configure frequency scaling and start the thermal check
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without CONFIG_CPU_POWER_SCALING,
+   *         otherwise the esp_pm error
+   * @note Call early in boot; holds taken before only count once it ran
+   */
+  esp_err_t cpu_power_init(void);
+
+  /**
+   * @brief Hold or release the maximum frequency for a reason
+   * @param reason Reason to set
+   * @param hold true to hold, false to release; repeating a state does nothing
+   * @note Any task
+   */
+  void cpu_power_hold(cpu_power_reason_t reason, bool hold);
+
+  /**
+   * @brief Handle GET_CPU_POWER
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a CPU power command
+   */
+  bool cpu_power_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPU_POWER_H
@@ -12,58 +12,70 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <sys/param.h>
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "utils/system_debug_utils.h"
 
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+#include "esp_core_dump.h"
+#endif
+
 static bool crash_handler_initialized = false;
 
+#define CRASH_HANDLER_HAS_COREDUMP (CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH && CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF)
+
+#if CRASH_HANDLER_HAS_COREDUMP
 /**
- * @brief Custom panic handler that stores crash information
+ * @brief Copy the coredump summary written by the panic handler into an entry
+ * @return true if a valid coredump was found
  */
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-function"
-static void crash_panic_handler(void *info)
+static bool read_coredump_summary(crash_log_entry_t *entry)
 {
-  // Try to extract crash information
-  char reason[64] = "Unknown crash";
-  char backtrace[256] = "Backtrace unavailable";
-
-  // Get basic crash reason
-  esp_reset_reason_t reset_reason = esp_reset_reason();
-  switch (reset_reason)
+  if (esp_core_dump_image_check() != ESP_OK)
   {
-  case ESP_RST_PANIC:
-    strncpy(reason, "Kernel panic", sizeof(reason) - 1);
-    break;
-  case ESP_RST_WDT:
-    strncpy(reason, "Watchdog timeout", sizeof(reason) - 1);
-    break;
-  case ESP_RST_BROWNOUT:
-    strncpy(reason, "Brownout reset", sizeof(reason) - 1);
-    break;
-  case ESP_RST_TASK_WDT:
-    strncpy(reason, "Task watchdog", sizeof(reason) - 1);
-    break;
-  default:
-    snprintf(reason, sizeof(reason), "Reset reason: %d", reset_reason);
-    break;
+    return false;
   }
 
-  // Try to get a simple backtrace
-  snprintf(backtrace, sizeof(backtrace), "Backtrace: Post-crash analysis");
-  // Note: Full backtrace formatting would require more complex implementation
-  // For now, we just store basic information
+  // Several hundred bytes, too many for the main task stack this early
+  esp_core_dump_summary_t *summary = malloc(sizeof(esp_core_dump_summary_t));
+  if (!summary)
+  {
+    return false;
+  }
 
-  // Store the crash log (this should be safe in panic context)
-  esp_err_t err = crash_log_store(reason, backtrace);
-  if (err != ESP_OK)
+  bool found = esp_core_dump_get_summary(summary) == ESP_OK;
+  if (found)
   {
-    // Can't do much here, just continue with default panic behavior
+    entry->flags |= CRASH_LOG_FLAG_COREDUMP;
+    entry->pc = summary->exc_pc;
+    strncpy(entry->task, summary->exc_task, CRASH_TASK_NAME_LEN - 1);
+    memcpy(entry->elf_sha, summary->app_elf_sha256,
+           MIN(sizeof(entry->elf_sha), strnlen((const char *)summary->app_elf_sha256, sizeof(summary->app_elf_sha256))));
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    entry->exc_cause = summary->ex_info.exc_cause;
+    entry->exc_vaddr = summary->ex_info.exc_vaddr;
+    entry->bt_depth = MIN(summary->exc_bt_info.depth, CRASH_BACKTRACE_MAX_DEPTH);
+    memcpy(entry->bt, summary->exc_bt_info.bt, entry->bt_depth * sizeof(uint32_t));
+    if (summary->exc_bt_info.corrupted)
+    {
+      entry->flags |= CRASH_LOG_FLAG_BT_CORRUPTED;
+    }
+#else
+    entry->exc_cause = summary->ex_info.mcause;
+    entry->exc_vaddr = summary->ex_info.mtval;
+#endif
   }
+  free(summary);
+
+#if !CONFIG_CRASH_LOG_KEEP_COREDUMP
+  // The summary is all the log keeps, and a stale image must not be pinned on the next reset
+  esp_core_dump_image_erase();
+#endif
+  return found;
 }
-#pragma GCC diagnostic pop
+#endif
 
 /**
  * @brief Check if the last reset was due to a crash and log it
@@ -73,38 +85,38 @@ static void check_and_log_reset_reason(void)
   esp_reset_reason_t reset_reason = esp_reset_reason();
 
   // Only log if it was a crash-related reset
-  if (reset_reason == ESP_RST_PANIC ||
-      reset_reason == ESP_RST_WDT ||
-      reset_reason == ESP_RST_TASK_WDT ||
-      reset_reason == ESP_RST_BROWNOUT)
+  if (reset_reason != ESP_RST_PANIC &&
+      reset_reason != ESP_RST_INT_WDT &&
+      reset_reason != ESP_RST_TASK_WDT &&
+      reset_reason != ESP_RST_WDT &&
+      reset_reason != ESP_RST_BROWNOUT)
   {
+    return;
+  }
 
-    char reason[64];
-    char backtrace[256] = "Post-reset analysis";
+  crash_log_entry_t entry = {0};
+  entry.reset_reason = (uint8_t)reset_reason;
 
-    switch (reset_reason)
-    {
-    case ESP_RST_PANIC:
-      strncpy(reason, "Previous: Kernel panic", sizeof(reason) - 1);
-      break;
-    case ESP_RST_WDT:
-      strncpy(reason, "Previous: Watchdog timeout", sizeof(reason) - 1);
-      break;
-    case ESP_RST_TASK_WDT:
-      strncpy(reason, "Previous: Task watchdog", sizeof(reason) - 1);
-      break;
-    case ESP_RST_BROWNOUT:
-      strncpy(reason, "Previous: Brownout reset", sizeof(reason) - 1);
-      break;
-    default:
-      snprintf(reason, sizeof(reason), "Previous: Reset %d", reset_reason);
-      break;
-    }
+#if CRASH_HANDLER_HAS_COREDUMP
+  // A brownout does not go through the panic handler, any image there is older
+  if (reset_reason != ESP_RST_BROWNOUT)
+  {
+    read_coredump_summary(&entry);
+  }
+#endif
 
-    // Store this crash information
-    crash_log_store(reason, backtrace);
+  // Store this crash information
+  crash_log_store(&entry);
 
-    debug_log_warning_f(DEBUG_TAG_SYSTEM, "System recovered from crash: %s", reason);
+  if (entry.flags & CRASH_LOG_FLAG_COREDUMP)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "System recovered from crash: %s in task %s at 0x%08lx",
+                        crash_log_reason_name(entry.reset_reason), entry.task, (unsigned long)entry.pc);
+  }
+  else
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "System recovered from crash: %s",
+                        crash_log_reason_name(entry.reset_reason));
   }
 }
 
@@ -125,12 +137,9 @@ esp_err_t crash_handler_init(void)
     return err;
   }
 
-  // Check if we're recovering from a crash
+  // Check if we're recovering from a crash, the panic handler's coredump has the details
   check_and_log_reset_reason();
 
-  // Note: ESP-IDF doesn't provide a clean way to register custom panic handlers
-  // The crash detection will primarily work through reset reason analysis
-
   crash_handler_initialized = true;
   debug_log_info(DEBUG_TAG_SYSTEM, "Crash handler initialized");
 
@@ -145,25 +154,15 @@ void crash_handler_trigger_test(const char *reason)
     return;
   }
 
-  char test_reason[64];
-  char test_backtrace[256];
-
-  if (reason)
-  {
-    snprintf(test_reason, sizeof(test_reason), "TEST: %s", reason);
-  }
-  else
-  {
-    strncpy(test_reason, "TEST: Manual crash test", sizeof(test_reason) - 1);
-  }
-
-  strncpy(test_backtrace, "Test backtrace - no actual crash", sizeof(test_backtrace) - 1);
+  crash_log_entry_t entry = {0};
+  entry.reset_reason = ESP_RST_SW;
+  entry.flags = CRASH_LOG_FLAG_TEST;
 
   // Store test crash log
-  esp_err_t err = crash_log_store(test_reason, test_backtrace);
+  esp_err_t err = crash_log_store(&entry);
   if (err == ESP_OK)
   {
-    debug_log_info_f(DEBUG_TAG_SYSTEM, "Test crash logged: %s", test_reason);
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Test crash logged: %s", reason ? reason : "Manual crash test");
   }
   else
   {
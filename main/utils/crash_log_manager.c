@@ -16,13 +16,18 @@
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "serial/serial_data_handler.h"
 #include "utils/system_debug_utils.h"
 
 #define CRASH_LOG_NVS_NAMESPACE "crash_logs"
 #define CRASH_LOG_COUNT_KEY "count"
 #define CRASH_LOG_INDEX_KEY "index"
+#define CRASH_LOG_VERSION_KEY "version"
 #define CRASH_LOG_ENTRY_KEY_PREFIX "log_"
 
+// Bump when crash_log_entry_t changes, older entries are dropped at init
+#define CRASH_LOG_VERSION 2
+
 static nvs_handle_t crash_log_nvs_handle = 0;
 static bool crash_log_initialized = false;
 static uint8_t crash_log_count = 0;
@@ -81,6 +86,35 @@ static esp_err_t load_crash_log_metadata(void)
   return ESP_OK;
 }
 
+/**
+ * @brief Drop entries written with another layout
+ * @note Version 1 entries carried text reasons and no version key
+ */
+static esp_err_t check_crash_log_version(void)
+{
+  uint8_t version = 0;
+  esp_err_t err = nvs_get_u8(crash_log_nvs_handle, CRASH_LOG_VERSION_KEY, &version);
+  if (err == ESP_OK && version == CRASH_LOG_VERSION)
+  {
+    return ESP_OK;
+  }
+  if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND)
+  {
+    return err;
+  }
+
+  err = nvs_erase_all(crash_log_nvs_handle);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_u8(crash_log_nvs_handle, CRASH_LOG_VERSION_KEY, CRASH_LOG_VERSION);
+  }
+  if (err == ESP_OK)
+  {
+    err = nvs_commit(crash_log_nvs_handle);
+  }
+  return err;
+}
+
 /**
  * @brief Save crash log metadata to NVS
  */
@@ -121,7 +155,11 @@ esp_err_t crash_log_manager_init(void)
   }
 
   // Load existing metadata
-  err = load_crash_log_metadata();
+  err = check_crash_log_version();
+  if (err == ESP_OK)
+  {
+    err = load_crash_log_metadata();
+  }
   if (err != ESP_OK)
   {
     debug_log_error_f(DEBUG_TAG_SYSTEM, "Failed to load crash log metadata: %s", esp_err_to_name(err));
@@ -144,28 +182,26 @@ esp_err_t crash_log_manager_init(void)
   return ESP_OK;
 }
 
-esp_err_t crash_log_store(const char *reason, const char *backtrace)
+esp_err_t crash_log_store(const crash_log_entry_t *summary)
 {
   if (!crash_log_initialized)
   {
     return ESP_ERR_INVALID_STATE;
   }
 
-  if (!reason || !backtrace)
+  if (!summary)
   {
     return ESP_ERR_INVALID_ARG;
   }
 
-  crash_log_entry_t entry = {0};
-
-  // Fill entry data
+  crash_log_entry_t entry = *summary;
+  entry.version = CRASH_LOG_VERSION;
   entry.timestamp = (uint32_t)time(NULL);
-  entry.uptime_seconds = xTaskGetTickCount() / configTICK_RATE_HZ;
-  strncpy(entry.reason, reason, CRASH_REASON_MAX_LEN - 1);
-  strncpy(entry.backtrace, backtrace, CRASH_BACKTRACE_MAX_LEN - 1);
-  entry.free_heap = esp_get_free_heap_size();
-  entry.min_free_heap = esp_get_minimum_free_heap_size();
-  entry.valid = true;
+  entry.task[CRASH_TASK_NAME_LEN - 1] = '\0';
+  if (entry.bt_depth > CRASH_BACKTRACE_MAX_DEPTH)
+  {
+    entry.bt_depth = CRASH_BACKTRACE_MAX_DEPTH;
+  }
 
   // Generate key for this entry
   char key[32];
@@ -217,11 +253,28 @@ void crash_log_print_all(void)
 
       debug_log_info_f(DEBUG_TAG_SYSTEM, "--- CRASH LOG %d ---", display_index);
       debug_log_info_f(DEBUG_TAG_SYSTEM, "Timestamp: %lu", entry.timestamp);
-      debug_log_info_f(DEBUG_TAG_SYSTEM, "Uptime: %lu seconds", entry.uptime_seconds);
-      debug_log_info_f(DEBUG_TAG_SYSTEM, "Reason: %s", entry.reason);
-      debug_log_info_f(DEBUG_TAG_SYSTEM, "Free heap: %lu bytes", entry.free_heap);
-      debug_log_info_f(DEBUG_TAG_SYSTEM, "Min free heap: %lu bytes", entry.min_free_heap);
-      debug_log_info_f(DEBUG_TAG_SYSTEM, "Backtrace: %s", entry.backtrace);
+      debug_log_info_f(DEBUG_TAG_SYSTEM, "Reason: %s%s", crash_log_reason_name(entry.reset_reason),
+                       (entry.flags & CRASH_LOG_FLAG_TEST) ? " (test)" : "");
+      if (!(entry.flags & CRASH_LOG_FLAG_COREDUMP))
+      {
+        debug_log_info(DEBUG_TAG_SYSTEM, "No coredump for this crash");
+        continue;
+      }
+
+      // addr2line -e <elf with this SHA> <addresses>
+      char backtrace[CRASH_BACKTRACE_MAX_DEPTH * 11 + 1];
+      size_t len = 0;
+      backtrace[0] = '\0';
+      for (uint8_t f = 0; f < entry.bt_depth; f++)
+      {
+        len += snprintf(backtrace + len, sizeof(backtrace) - len, " 0x%08lx", (unsigned long)entry.bt[f]);
+      }
+
+      debug_log_info_f(DEBUG_TAG_SYSTEM, "Task: %s, PC: 0x%08lx, cause: %lu, vaddr: 0x%08lx, ELF: %.*s",
+                       entry.task, (unsigned long)entry.pc, (unsigned long)entry.exc_cause,
+                       (unsigned long)entry.exc_vaddr, CRASH_ELF_SHA_LEN, entry.elf_sha);
+      debug_log_info_f(DEBUG_TAG_SYSTEM, "Backtrace:%s%s", backtrace,
+                       (entry.flags & CRASH_LOG_FLAG_BT_CORRUPTED) ? " |<-CORRUPTED" : "");
     }
   }
 }
@@ -238,7 +291,7 @@ esp_err_t crash_log_clear_all(void)
     return ESP_ERR_INVALID_STATE;
   }
 
-  // Clear all entries
+  // Clear all entries, the version key stays
   for (uint8_t i = 0; i < CRASH_LOG_MAX_ENTRIES; i++)
   {
     char key[32];
@@ -290,10 +343,102 @@ esp_err_t crash_log_get_entry(uint8_t index, crash_log_entry_t *entry)
   size_t required_size = sizeof(crash_log_entry_t);
   esp_err_t err = nvs_get_blob(crash_log_nvs_handle, key, entry, &required_size);
 
-  if (err != ESP_OK || !entry->valid)
+  if (err != ESP_OK || required_size != sizeof(crash_log_entry_t) || entry->version != CRASH_LOG_VERSION)
   {
     return ESP_ERR_NOT_FOUND;
   }
 
   return ESP_OK;
 }
+
+const char *crash_log_reason_name(uint8_t reason)
+{
+  switch ((esp_reset_reason_t)reason)
+  {
+  case ESP_RST_PANIC:
+    return "panic";
+  case ESP_RST_INT_WDT:
+    return "int_wdt";
+  case ESP_RST_TASK_WDT:
+    return "task_wdt";
+  case ESP_RST_WDT:
+    return "wdt";
+  case ESP_RST_BROWNOUT:
+    return "brownout";
+  case ESP_RST_SW:
+    return "software";
+  default:
+    return "other";
+  }
+}
+
+// =======================================================================
+// SERIAL COMMANDS
+// =======================================================================
+
+/**
+ * @brief Write one entry as a JSON object
+ */
+static void write_entry_json(const crash_log_entry_t *entry, bool first)
+{
+  char buf[448];
+  int len = snprintf(buf, sizeof(buf),
+                     "%s{\"reason\":\"%s\",\"ts\":%lu,\"test\":%s,\"coredump\":%s",
+                     first ? "" : ",", crash_log_reason_name(entry->reset_reason), (unsigned long)entry->timestamp,
+                     (entry->flags & CRASH_LOG_FLAG_TEST) ? "true" : "false",
+                     (entry->flags & CRASH_LOG_FLAG_COREDUMP) ? "true" : "false");
+
+  if (entry->flags & CRASH_LOG_FLAG_COREDUMP)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    ",\"task\":\"%s\",\"pc\":\"0x%08lx\",\"cause\":%lu,\"vaddr\":\"0x%08lx\","
+                    "\"elf\":\"%.*s\",\"bt_corrupted\":%s,\"bt\":[",
+                    entry->task, (unsigned long)entry->pc, (unsigned long)entry->exc_cause,
+                    (unsigned long)entry->exc_vaddr, CRASH_ELF_SHA_LEN, entry->elf_sha,
+                    (entry->flags & CRASH_LOG_FLAG_BT_CORRUPTED) ? "true" : "false");
+    for (uint8_t f = 0; f < entry->bt_depth; f++)
+    {
+      len += snprintf(buf + len, sizeof(buf) - len, "%s\"0x%08lx\"", f ? "," : "", (unsigned long)entry->bt[f]);
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "]");
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "}");
+
+  serial_data_write(buf, len < (int)sizeof(buf) ? len : sizeof(buf) - 1);
+}
+
+bool crash_log_handle_command(const char *line)
+{
+  if (strcmp(line, "CRASH_LOG_CLEAR") == 0)
+  {
+    esp_err_t err = crash_log_clear_all();
+    char reply[64];
+    int len = snprintf(reply, sizeof(reply), "CRASH_LOG {\"ok\":%s}\n", err == ESP_OK ? "true" : "false");
+    serial_data_write(reply, len);
+    return true;
+  }
+
+  if (strcmp(line, "GET_CRASH_LOG") != 0)
+  {
+    return false;
+  }
+
+  char head[64];
+  int len = snprintf(head, sizeof(head), "CRASH_LOG {\"count\":%u,\"entries\":[", crash_log_count);
+  serial_data_write(head, len);
+
+  bool first = true;
+  for (uint8_t i = 0; i < crash_log_count; i++)
+  {
+    crash_log_entry_t entry;
+    if (crash_log_get_entry(i, &entry) == ESP_OK)
+    {
+      write_entry_json(&entry, first);
+      first = false;
+    }
+  }
+
+  static const char tail[] = "]}\n";
+  serial_data_write(tail, sizeof(tail) - 1);
+  return true;
+}
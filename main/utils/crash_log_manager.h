@@ -4,6 +4,11 @@
  *
  * Provides crash logging functionality with persistent storage in flash
  * for the ESP32-S3-8048S050 system monitor dashboard.
+ *
+ * Each entry is a compact summary of one crash: reset reason, faulting PC,
+ * exception cause, task name and backtrace addresses taken from the
+ * coredump partition on the next boot. Addresses are kept raw and resolved
+ * offline with addr2line against the ELF whose SHA prefix is stored too.
  */
 
 #pragma once
@@ -23,27 +28,43 @@ extern "C"
 #define CRASH_LOG_MAX_ENTRIES 5
 
 /**
- * @brief Maximum size for crash reason string
+ * @brief Backtrace frames kept per crash, as in the coredump summary
+ */
+#define CRASH_BACKTRACE_MAX_DEPTH 16
+
+/**
+ * @brief Task name length, with the terminator
+ */
+#define CRASH_TASK_NAME_LEN 16
+
+/**
+ * @brief Hex characters of the app ELF SHA-256 kept per crash
  */
-#define CRASH_REASON_MAX_LEN 64
+#define CRASH_ELF_SHA_LEN 8
 
 /**
- * @brief Maximum size for backtrace string
+ * @brief Entry flags
  */
-#define CRASH_BACKTRACE_MAX_LEN 256
+#define CRASH_LOG_FLAG_COREDUMP 0x01     // PC, cause and backtrace come from a coredump
+#define CRASH_LOG_FLAG_BT_CORRUPTED 0x02 // Backtrace walk hit a corrupted frame
+#define CRASH_LOG_FLAG_TEST 0x04         // Stored by crash_handler_trigger_test()
 
   /**
    * @brief Crash log entry structure
    */
   typedef struct
   {
-    uint32_t timestamp;                      // Unix timestamp of crash
-    uint32_t uptime_seconds;                 // System uptime at crash
-    char reason[CRASH_REASON_MAX_LEN];       // Crash reason (exception type)
-    char backtrace[CRASH_BACKTRACE_MAX_LEN]; // Stack backtrace
-    uint32_t free_heap;                      // Free heap at crash time
-    uint32_t min_free_heap;                  // Minimum free heap ever
-    bool valid;                              // Entry validity flag
+    uint8_t version;                              // Layout version, entries of another layout are skipped
+    uint8_t reset_reason;                         // esp_reset_reason_t of the boot after the crash
+    uint8_t flags;                                // CRASH_LOG_FLAG_*
+    uint8_t bt_depth;                             // Valid entries in bt[]
+    uint32_t timestamp;                           // Unix timestamp when the entry was stored
+    uint32_t pc;                                  // Faulting program counter
+    uint32_t exc_cause;                           // EXCCAUSE register
+    uint32_t exc_vaddr;                           // EXCVADDR register
+    char task[CRASH_TASK_NAME_LEN];               // Task running at the crash
+    char elf_sha[CRASH_ELF_SHA_LEN];              // App ELF SHA-256 prefix, not terminated
+    uint32_t bt[CRASH_BACKTRACE_MAX_DEPTH];       // Backtrace PCs, innermost first
   } crash_log_entry_t;
 
   /**
@@ -54,11 +75,10 @@ extern "C"
 
   /**
    * @brief Store a crash log entry
-   * @param reason Crash reason string
-   * @param backtrace Stack backtrace string
+   * @param summary Summary to store, version and timestamp are filled in
    * @return ESP_OK on success, error code otherwise
    */
-  esp_err_t crash_log_store(const char *reason, const char *backtrace);
+  esp_err_t crash_log_store(const crash_log_entry_t *summary);
 
   /**
    * @brief Print all stored crash logs to console
@@ -85,6 +105,20 @@ extern "C"
    */
   esp_err_t crash_log_get_entry(uint8_t index, crash_log_entry_t *entry);
 
+  /**
+   * @brief Get a short name for a reset reason
+   * @param reason esp_reset_reason_t value
+   * @return Static string
+   */
+  const char *crash_log_reason_name(uint8_t reason);
+
+  /**
+   * @brief Handle GET_CRASH_LOG and CRASH_LOG_CLEAR
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a crash log command
+   */
+  bool crash_log_handle_command(const char *line);
+
 #ifdef __cplusplus
 }
 #endif
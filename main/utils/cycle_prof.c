@@ -0,0 +1,122 @@
+/**
+ * @file cycle_prof.c
+ * @brief Per-site CPU cycle counts of hot routines
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "cycle_prof.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+#if CONFIG_CYCLE_PROF
+// Guards the statistics and the list, sites link themselves in on first use
+static portMUX_TYPE prof_lock = portMUX_INITIALIZER_UNLOCKED;
+static cycle_prof_site_t *site_list = NULL;
+static cycle_prof_site_t *site_tail = NULL;
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+#if CONFIG_CYCLE_PROF
+void IRAM_ATTR cycle_prof_add(cycle_prof_site_t *site, uint32_t start_cycles, int start_core)
+{
+  uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+  bool migrated = esp_cpu_get_core_id() != start_core;
+
+  portENTER_CRITICAL_SAFE(&prof_lock);
+  if (!site->linked)
+  {
+    // Appended, so GET_CYCLES lists sites in the order they first ran
+    site->linked = true;
+    site->min = UINT32_MAX;
+    if (site_tail)
+      site_tail->next = site;
+    else
+      site_list = site;
+    site_tail = site;
+  }
+  if (migrated)
+  {
+    site->migrated++;
+  }
+  else
+  {
+    site->count++;
+    site->total += cycles;
+    if (cycles < site->min)
+      site->min = cycles;
+    if (cycles > site->max)
+      site->max = cycles;
+  }
+  portEXIT_CRITICAL_SAFE(&prof_lock);
+}
+#endif
+
+bool cycle_prof_handle_command(const char *line)
+{
+  if (strcmp(line, "RESET_CYCLES") == 0)
+  {
+#if CONFIG_CYCLE_PROF
+    portENTER_CRITICAL(&prof_lock);
+    for (cycle_prof_site_t *site = site_list; site; site = site->next)
+    {
+      site->count = 0;
+      site->total = 0;
+      site->min = UINT32_MAX;
+      site->max = 0;
+      site->migrated = 0;
+    }
+    portEXIT_CRITICAL(&prof_lock);
+#endif
+    static const char ok[] = "CYCLES OK\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+    return true;
+  }
+
+  if (strcmp(line, "GET_CYCLES") != 0)
+    return false;
+
+#if CONFIG_CYCLE_PROF
+  const uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+  char buf[224];
+  int sites = 0;
+
+  // Sites are never unlinked, so the list can be walked outside the lock
+  for (cycle_prof_site_t *site = site_list; site; site = site->next)
+  {
+    portENTER_CRITICAL(&prof_lock);
+    cycle_prof_site_t copy = *site;
+    portEXIT_CRITICAL(&prof_lock);
+
+    uint32_t avg = copy.count ? (uint32_t)(copy.total / copy.count) : 0;
+    int len = snprintf(buf, sizeof(buf),
+                       "CYCLES {\"site\":\"%s\",\"count\":%lu,\"min\":%lu,\"avg\":%lu,\"max\":%lu,\"total\":%llu,"
+                       "\"avg_us\":%.2f,\"migrated\":%lu}\n",
+                       copy.name, (unsigned long)copy.count, (unsigned long)(copy.count ? copy.min : 0),
+                       (unsigned long)avg, (unsigned long)copy.max, (unsigned long long)copy.total,
+                       mhz ? (double)avg / mhz : 0.0, (unsigned long)copy.migrated);
+    serial_data_write(buf, len);
+    sites++;
+  }
+
+  int len = snprintf(buf, sizeof(buf), "CYCLES {\"sites\":%d,\"cpu_mhz\":%lu}\n", sites, (unsigned long)mhz);
+  serial_data_write(buf, len);
+#else
+  static const char disabled[] = "CYCLES {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
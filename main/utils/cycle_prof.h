@@ -0,0 +1,90 @@
+/**
+ * @file cycle_prof.h
+ * @brief Per-site CPU cycle counts of hot routines
+ *
+ * Each site reads the core's CCOUNT register on entry and exit and keeps
+ * count, min, average and max of the difference, so optimisation work can
+ * compare cycles instead of wall-clock times that include DMA and I/O
+ * waits. Preemption and interrupts inside a section are counted too and
+ * show up in max. A section that ends on the other core is dropped, the
+ * two counters are not synchronised. GET_CYCLES prints the table.
+ *
+ *   CYCLE_PROF_SITE(gt911_parse);          // file scope, once per site
+ *   CYCLE_PROF_BEGIN(gt911_parse);         // entry
+ *   CYCLE_PROF_END(gt911_parse);           // every exit
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef CYCLE_PROF_H
+#define CYCLE_PROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#if CONFIG_CYCLE_PROF
+#include "esp_cpu.h"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Statistics of one call site, linked into the table on first use
+   */
+  typedef struct cycle_prof_site
+  {
+    const char *name;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t migrated; ///< Sections dropped because they ended on the other core
+    uint64_t total;
+    struct cycle_prof_site *next;
+    bool linked;
+  } cycle_prof_site_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+#if CONFIG_CYCLE_PROF
+  /**
+   * @brief Add one section to a site
+   * @param start_cycles CCOUNT at entry
+   * @param start_core Core the entry ran on
+   * @note Callable from tasks and ISRs; use CYCLE_PROF_END
+   */
+  void cycle_prof_add(cycle_prof_site_t *site, uint32_t start_cycles, int start_core);
+
+#define CYCLE_PROF_SITE(site) static cycle_prof_site_t cycle_prof_site_##site = {.name = #site}
+#define CYCLE_PROF_BEGIN(site)                                   \
+  const int cycle_prof_core_##site = esp_cpu_get_core_id();      \
+  const uint32_t cycle_prof_start_##site = esp_cpu_get_cycle_count()
+#define CYCLE_PROF_END(site) cycle_prof_add(&cycle_prof_site_##site, cycle_prof_start_##site, cycle_prof_core_##site)
+#else
+#define CYCLE_PROF_SITE(site) struct cycle_prof_site_##site##_unused
+#define CYCLE_PROF_BEGIN(site) ((void)0)
+#define CYCLE_PROF_END(site) ((void)0)
+#endif
+
+  /**
+   * @brief Handle GET_CYCLES and RESET_CYCLES
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a cycle profiling command
+   */
+  bool cycle_prof_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CYCLE_PROF_H
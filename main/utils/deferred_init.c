@@ -0,0 +1,212 @@
+/**
+ * @file deferred_init.c
+ * @brief Low-priority background task for heavy subsystem init
+ *
+ * Jobs run one at a time in submission order. The task stays alive after
+ * the last job so that later submissions (a reconnect, a subsystem started
+ * on demand) need no new stack.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "deferred_init.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "boot_graph.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  const char *name;
+  esp_err_t (*run)(void);
+  deferred_init_state_t state;
+  esp_err_t result;
+  int64_t queued_us;
+  int64_t started_us;
+  int64_t finished_us;
+} deferred_job_t;
+
+static deferred_job_t jobs[DEFERRED_INIT_MAX_JOBS];
+static int job_count = 0;
+
+// Submitters are event callbacks on any task, GET_INIT_STATE reads from the serial task
+static portMUX_TYPE jobs_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t job_queue = NULL;
+
+static const char *const state_names[] = {
+    [DEFERRED_INIT_UNKNOWN] = "unknown", [DEFERRED_INIT_QUEUED] = "queued", [DEFERRED_INIT_RUNNING] = "running",
+    [DEFERRED_INIT_DONE] = "done",       [DEFERRED_INIT_FAILED] = "failed",
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static int find_job_locked(const char *name)
+{
+  for (int i = 0; i < job_count; i++)
+  {
+    if (strcmp(jobs[i].name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static void deferred_init_task(void *arg)
+{
+  int index;
+  while (true)
+  {
+    if (xQueueReceive(job_queue, &index, portMAX_DELAY) != pdTRUE)
+      continue;
+
+    portENTER_CRITICAL(&jobs_lock);
+    deferred_job_t *job = &jobs[index];
+    job->state = DEFERRED_INIT_RUNNING;
+    job->started_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&jobs_lock);
+
+    esp_err_t ret = job->run();
+
+    int64_t finished_us = esp_timer_get_time();
+    bool ok = ret == ESP_OK || ret == ESP_ERR_NOT_SUPPORTED;
+    portENTER_CRITICAL(&jobs_lock);
+    job->result = ret;
+    job->finished_us = finished_us;
+    job->state = ok ? DEFERRED_INIT_DONE : DEFERRED_INIT_FAILED;
+    portEXIT_CRITICAL(&jobs_lock);
+
+    if (ok)
+    {
+      debug_log_info_f(DEBUG_TAG_SYSTEM, "Deferred init %s done in %lld ms (queued %lld ms)", job->name,
+                       (finished_us - job->started_us) / 1000, (job->started_us - job->queued_us) / 1000);
+      boot_graph_mark_milestone(job->name);
+    }
+    else
+    {
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "Deferred init %s failed: %s", job->name, esp_err_to_name(ret));
+    }
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t deferred_init_start(void)
+{
+  if (job_queue)
+  {
+    return ESP_OK;
+  }
+
+  QueueHandle_t queue = xQueueCreate(DEFERRED_INIT_MAX_JOBS, sizeof(int));
+  if (!queue)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (task_plan_create(TASK_PLAN_DEFERRED_INIT, deferred_init_task, NULL, NULL) != pdPASS)
+  {
+    vQueueDelete(queue);
+    return ESP_ERR_NO_MEM;
+  }
+  job_queue = queue;
+  return ESP_OK;
+}
+
+esp_err_t deferred_init_submit(const char *name, esp_err_t (*run)(void))
+{
+  if (!name || !run)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!job_queue)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  portENTER_CRITICAL(&jobs_lock);
+  if (find_job_locked(name) >= 0)
+  {
+    portEXIT_CRITICAL(&jobs_lock);
+    return ESP_OK;
+  }
+  if (job_count >= DEFERRED_INIT_MAX_JOBS)
+  {
+    portEXIT_CRITICAL(&jobs_lock);
+    return ESP_ERR_NO_MEM;
+  }
+  int index = job_count++;
+  jobs[index] = (deferred_job_t){
+      .name = name,
+      .run = run,
+      .state = DEFERRED_INIT_QUEUED,
+      .result = ESP_OK,
+      .queued_us = esp_timer_get_time(),
+  };
+  portEXIT_CRITICAL(&jobs_lock);
+
+  // The queue holds DEFERRED_INIT_MAX_JOBS, one entry per job ever submitted
+  xQueueSend(job_queue, &index, 0);
+  debug_log_debug_f(DEBUG_TAG_SYSTEM, "Deferred init %s queued", name);
+  return ESP_OK;
+}
+
+deferred_init_state_t deferred_init_get_state(const char *name)
+{
+  if (!name)
+  {
+    return DEFERRED_INIT_UNKNOWN;
+  }
+
+  portENTER_CRITICAL(&jobs_lock);
+  int index = find_job_locked(name);
+  deferred_init_state_t state = index >= 0 ? jobs[index].state : DEFERRED_INIT_UNKNOWN;
+  portEXIT_CRITICAL(&jobs_lock);
+  return state;
+}
+
+bool deferred_init_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_INIT_STATE") != 0)
+  {
+    return false;
+  }
+
+  deferred_job_t copy[DEFERRED_INIT_MAX_JOBS];
+  portENTER_CRITICAL(&jobs_lock);
+  int count = job_count;
+  memcpy(copy, jobs, sizeof(copy[0]) * count);
+  portEXIT_CRITICAL(&jobs_lock);
+
+  serial_data_write("INIT_STATE {\"jobs\":[", 20);
+  for (int i = 0; i < count; i++)
+  {
+    const deferred_job_t *job = &copy[i];
+    int64_t wait_ms = job->started_us ? (job->started_us - job->queued_us) / 1000 : -1;
+    int64_t run_ms = job->finished_us ? (job->finished_us - job->started_us) / 1000 : -1;
+
+    char buf[160];
+    int len = snprintf(buf, sizeof(buf),
+                       "%s{\"name\":\"%s\",\"state\":\"%s\",\"queued_ms\":%lld,\"wait_ms\":%lld,\"ms\":%lld,"
+                       "\"result\":\"%s\"}",
+                       i ? "," : "", job->name, state_names[job->state], job->queued_us / 1000, wait_ms, run_ms,
+                       esp_err_to_name(job->result));
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+  return true;
+}
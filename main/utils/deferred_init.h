@@ -0,0 +1,84 @@
+/**
+ * @file deferred_init.h
+ * @brief Low-priority background task for heavy subsystem init
+ *
+ * Subsystems that create HTTP clients, worker tasks or sockets (Home
+ * Assistant, network telemetry) are started from event callbacks such as
+ * "WiFi connected". Running them there stalls the event loop, and anything
+ * queued behind it, for as long as they take. Instead the callback submits
+ * a job, and one low-priority task runs the jobs in order. Each job keeps
+ * an explicit state that other modules and GET_INIT_STATE can read.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef DEFERRED_INIT_H
+#define DEFERRED_INIT_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Jobs that can be submitted over the device's lifetime */
+#define DEFERRED_INIT_MAX_JOBS 8
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    DEFERRED_INIT_UNKNOWN, ///< Never submitted
+    DEFERRED_INIT_QUEUED,
+    DEFERRED_INIT_RUNNING,
+    DEFERRED_INIT_DONE,
+    DEFERRED_INIT_FAILED,
+  } deferred_init_state_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create the background init task
+   * @return ESP_OK on success, ESP_ERR_NO_MEM if the task or queue could not be created
+   */
+  esp_err_t deferred_init_start(void);
+
+  /**
+   * @brief Queue a job for the background init task
+   * @param name Static string, also stamped as a boot milestone when the job finishes
+   * @param run Init function; ESP_ERR_NOT_SUPPORTED counts as done
+   * @return ESP_OK if queued or already submitted under this name,
+   *         ESP_ERR_INVALID_STATE before deferred_init_start(), ESP_ERR_NO_MEM if full
+   * @note Callable from any task, returns without waiting for the job
+   */
+  esp_err_t deferred_init_submit(const char *name, esp_err_t (*run)(void));
+
+  /**
+   * @brief Get the state of a job
+   * @param name Name the job was submitted under
+   */
+  deferred_init_state_t deferred_init_get_state(const char *name);
+
+  /**
+   * @brief Handle GET_INIT_STATE
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a deferred init command
+   */
+  bool deferred_init_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEFERRED_INIT_H
@@ -0,0 +1,307 @@
+/**
+ * @file delta_patch.c
+ * @brief Streaming binary delta patch applier
+ *
+ * The patch is inflated with the tinfl decoder in ROM into its 32 KB
+ * window, and the records are parsed straight out of that window as a
+ * state machine, so a record may be split across any number of feeds.
+ * Diff bytes are added to old image bytes read in 1 KB pieces and land
+ * in a 4 KB output block, extra bytes are copied into it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "delta_patch.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "mbedtls/sha256.h"
+#include "rom/miniz.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define PATCH_OLD_CHUNK 1024
+#define PATCH_OUT_BLOCK 4096
+#define PATCH_RECORD_HEADER 12
+
+typedef enum
+{
+  STAGE_HEADER, ///< Collecting the uncompressed header
+  STAGE_RECORD, ///< Collecting diff_len, extra_len and seek
+  STAGE_DIFF,
+  STAGE_EXTRA,
+} patch_stage_t;
+
+struct delta_patch
+{
+  tinfl_decompressor inflator;
+  uint8_t window[TINFL_LZ_DICT_SIZE]; ///< Inflated output, also the back-reference window
+  size_t window_pos;
+  tinfl_status inflate_status;
+
+  uint8_t old_chunk[PATCH_OLD_CHUNK];
+  uint8_t out[PATCH_OUT_BLOCK];
+  size_t out_len;
+
+  delta_patch_header_t header;
+  uint8_t pending[sizeof(delta_patch_header_t)]; ///< Partial header or record header
+  size_t pending_len;
+  patch_stage_t stage;
+  uint32_t remaining; ///< Bytes left of the current diff or extra run
+  uint32_t extra_len;
+  int32_t seek;
+
+  uint8_t old_sha256[32];
+  uint32_t old_size;
+  uint32_t old_pos;
+  uint32_t new_pos;
+  mbedtls_sha256_context sha;
+
+  delta_patch_read_fn read_old;
+  delta_patch_write_fn write_new;
+  void *ctx;
+  esp_err_t error; ///< Sticky, the first error
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static esp_err_t flush_out(delta_patch_t *p)
+{
+  if (p->out_len == 0)
+    return ESP_OK;
+  mbedtls_sha256_update(&p->sha, p->out, p->out_len);
+  esp_err_t err = p->write_new(p->ctx, p->out, p->out_len);
+  p->out_len = 0;
+  return err;
+}
+
+static esp_err_t start_record(delta_patch_t *p)
+{
+  uint32_t diff_len = get_u32(p->pending);
+  p->extra_len = get_u32(p->pending + 4);
+  p->seek = (int32_t)get_u32(p->pending + 8);
+  p->pending_len = 0;
+
+  // Checked up front, the runs below only need to stay inside these bounds
+  uint32_t new_left = p->header.new_size - p->new_pos;
+  if (diff_len > new_left || p->extra_len > new_left - diff_len || diff_len > p->old_size - p->old_pos)
+    return ESP_ERR_INVALID_RESPONSE;
+
+  p->remaining = diff_len;
+  p->stage = STAGE_DIFF;
+  return ESP_OK;
+}
+
+/**
+ * @brief Move on from a finished diff or extra run
+ */
+static esp_err_t end_run(delta_patch_t *p)
+{
+  if (p->stage == STAGE_DIFF)
+  {
+    p->remaining = p->extra_len;
+    p->stage = STAGE_EXTRA;
+    return ESP_OK;
+  }
+  int64_t old_pos = (int64_t)p->old_pos + p->seek;
+  if (old_pos < 0 || old_pos > p->old_size)
+    return ESP_ERR_INVALID_RESPONSE;
+  p->old_pos = (uint32_t)old_pos;
+  p->stage = STAGE_RECORD;
+  return ESP_OK;
+}
+
+/**
+ * @brief Apply inflated record bytes
+ */
+static esp_err_t apply_records(delta_patch_t *p, const uint8_t *data, size_t len)
+{
+  while (len > 0 || (p->stage >= STAGE_DIFF && p->remaining == 0))
+  {
+    if (p->stage == STAGE_RECORD)
+    {
+      size_t n = PATCH_RECORD_HEADER - p->pending_len;
+      n = n < len ? n : len;
+      memcpy(p->pending + p->pending_len, data, n);
+      p->pending_len += n;
+      data += n;
+      len -= n;
+      if (p->pending_len == PATCH_RECORD_HEADER)
+      {
+        esp_err_t err = start_record(p);
+        if (err != ESP_OK)
+          return err;
+      }
+      continue;
+    }
+
+    if (p->remaining == 0)
+    {
+      esp_err_t err = end_run(p);
+      if (err != ESP_OK)
+        return err;
+      continue;
+    }
+
+    size_t n = PATCH_OUT_BLOCK - p->out_len;
+    n = n < len ? n : len;
+    n = n < p->remaining ? n : p->remaining;
+    uint8_t *out = p->out + p->out_len;
+    if (p->stage == STAGE_DIFF)
+    {
+      n = n < PATCH_OLD_CHUNK ? n : PATCH_OLD_CHUNK;
+      esp_err_t err = p->read_old(p->ctx, p->old_pos, p->old_chunk, n);
+      if (err != ESP_OK)
+        return err;
+      for (size_t i = 0; i < n; i++)
+      {
+        out[i] = (uint8_t)(p->old_chunk[i] + data[i]);
+      }
+      p->old_pos += n;
+    }
+    else
+    {
+      memcpy(out, data, n);
+    }
+    p->out_len += n;
+    p->new_pos += n;
+    p->remaining -= n;
+    data += n;
+    len -= n;
+    if (p->out_len == PATCH_OUT_BLOCK)
+    {
+      esp_err_t err = flush_out(p);
+      if (err != ESP_OK)
+        return err;
+    }
+  }
+  return ESP_OK;
+}
+
+static esp_err_t check_header(delta_patch_t *p)
+{
+  memcpy(&p->header, p->pending, sizeof(p->header));
+  p->pending_len = 0;
+  const delta_patch_header_t *h = &p->header;
+  if (h->magic != DELTA_PATCH_MAGIC || h->version != DELTA_PATCH_VERSION ||
+      h->compression != DELTA_PATCH_COMPRESSION_ZLIB)
+    return ESP_ERR_INVALID_RESPONSE;
+  if (h->old_size > p->old_size || memcmp(h->old_sha256, p->old_sha256, sizeof(p->old_sha256)) != 0)
+    return ESP_ERR_INVALID_VERSION;
+  p->old_size = h->old_size;
+  p->stage = STAGE_RECORD;
+  return ESP_OK;
+}
+
+static esp_err_t inflate_feed(delta_patch_t *p, const uint8_t *data, size_t len)
+{
+  do
+  {
+    if (p->inflate_status == TINFL_STATUS_DONE)
+      return len == 0 ? ESP_OK : ESP_ERR_INVALID_RESPONSE; // Trailing bytes after the stream
+
+    size_t in_bytes = len;
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - p->window_pos;
+    p->inflate_status = tinfl_decompress(&p->inflator, data, &in_bytes, p->window, p->window + p->window_pos,
+                                         &out_bytes, TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+    if (p->inflate_status < 0)
+      return ESP_ERR_INVALID_RESPONSE;
+    data += in_bytes;
+    len -= in_bytes;
+
+    esp_err_t err = apply_records(p, p->window + p->window_pos, out_bytes);
+    if (err != ESP_OK)
+      return err;
+    p->window_pos = (p->window_pos + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+  } while (len > 0 || p->inflate_status == TINFL_STATUS_HAS_MORE_OUTPUT);
+  return ESP_OK;
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+delta_patch_t *delta_patch_begin(const uint8_t old_sha256[32], uint32_t old_size, delta_patch_read_fn read_old,
+                                 delta_patch_write_fn write_new, void *ctx)
+{
+  delta_patch_t *p = heap_caps_calloc(1, sizeof(*p), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!p)
+    return NULL;
+  tinfl_init(&p->inflator);
+  p->inflate_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+  memcpy(p->old_sha256, old_sha256, sizeof(p->old_sha256));
+  p->old_size = old_size;
+  p->read_old = read_old;
+  p->write_new = write_new;
+  p->ctx = ctx;
+  p->stage = STAGE_HEADER;
+  mbedtls_sha256_init(&p->sha);
+  mbedtls_sha256_starts(&p->sha, 0);
+  return p;
+}
+
+esp_err_t delta_patch_feed(delta_patch_t *p, const void *data, size_t len)
+{
+  if (p->error != ESP_OK)
+    return p->error;
+
+  const uint8_t *bytes = data;
+  if (p->stage == STAGE_HEADER)
+  {
+    size_t n = sizeof(p->header) - p->pending_len;
+    n = n < len ? n : len;
+    memcpy(p->pending + p->pending_len, bytes, n);
+    p->pending_len += n;
+    bytes += n;
+    len -= n;
+    if (p->pending_len < sizeof(p->header))
+      return ESP_OK;
+    p->error = check_header(p);
+    if (p->error != ESP_OK)
+      return p->error;
+  }
+
+  p->error = inflate_feed(p, bytes, len);
+  return p->error;
+}
+
+esp_err_t delta_patch_finish(delta_patch_t *p, uint32_t *new_size)
+{
+  if (p->error != ESP_OK)
+    return p->error;
+  if (new_size)
+    *new_size = p->new_pos;
+
+  if (p->inflate_status != TINFL_STATUS_DONE || p->stage != STAGE_RECORD || p->pending_len != 0 ||
+      p->new_pos != p->header.new_size)
+    return p->error = ESP_ERR_INVALID_SIZE;
+
+  p->error = flush_out(p);
+  if (p->error != ESP_OK)
+    return p->error;
+
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&p->sha, digest);
+  if (memcmp(digest, p->header.new_sha256, sizeof(digest)) != 0)
+    p->error = ESP_ERR_INVALID_CRC;
+  return p->error;
+}
+
+void delta_patch_free(delta_patch_t *p)
+{
+  if (!p)
+    return;
+  mbedtls_sha256_free(&p->sha);
+  heap_caps_free(p);
+}
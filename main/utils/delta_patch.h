@@ -0,0 +1,119 @@
+/**
+ * @file delta_patch.h
+ * @brief Streaming binary delta patch applier
+ *
+ * Rebuilds a new firmware image from the running one and a patch made by
+ * utils/ota_package.py, while the patch is still downloading. Nothing the
+ * size of an image is held in RAM: the old image is read where needed and
+ * the new one is handed out in 4 KB blocks.
+ *
+ * Patch layout, little-endian:
+ *
+ *   delta_patch_header_t          uncompressed
+ *   zlib stream of records:
+ *     uint32_t diff_len           bytes added to the old image at the old position
+ *     uint32_t extra_len          bytes copied as they are
+ *     int32_t  seek               old position change after the record
+ *     uint8_t  diff[diff_len]
+ *     uint8_t  extra[extra_len]
+ *
+ * This is the bsdiff record structure with one zlib stream instead of
+ * three bzip2 blocks, so it can be applied front to back with the ROM
+ * inflater. The old image's hash is checked before the first byte is
+ * written and the new image's after the last.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define DELTA_PATCH_MAGIC 0x544C4444u ///< "DDLT"
+#define DELTA_PATCH_VERSION 1
+#define DELTA_PATCH_COMPRESSION_ZLIB 1
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef struct
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t compression;   ///< DELTA_PATCH_COMPRESSION_ZLIB
+    uint32_t old_size;      ///< Bytes of the image the patch applies to
+    uint32_t new_size;      ///< Bytes of the image it produces
+    uint8_t old_sha256[32]; ///< Identity of the old image, as esp_partition_get_sha256() reports it
+    uint8_t new_sha256[32]; ///< SHA-256 of all new_size bytes produced
+  } delta_patch_header_t;
+
+  /**
+   * @brief Read bytes of the old image
+   * @return ESP_OK or an error that aborts the patch
+   */
+  typedef esp_err_t (*delta_patch_read_fn)(void *ctx, uint32_t offset, void *buf, size_t len);
+
+  /**
+   * @brief Take the next bytes of the new image, in order
+   * @return ESP_OK or an error that aborts the patch
+   */
+  typedef esp_err_t (*delta_patch_write_fn)(void *ctx, const void *buf, size_t len);
+
+  typedef struct delta_patch delta_patch_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start applying a patch
+   * @param old_sha256 Hash of the old image, the patch must have been made against it
+   * @param old_size Readable bytes of the old image
+   * @param read_old Reads the old image
+   * @param write_new Receives the new image
+   * @param ctx Passed to both callbacks
+   * @return Patch state (about 48 KB of PSRAM), NULL if out of memory
+   */
+  delta_patch_t *delta_patch_begin(const uint8_t old_sha256[32], uint32_t old_size, delta_patch_read_fn read_old,
+                                   delta_patch_write_fn write_new, void *ctx);
+
+  /**
+   * @brief Apply the next bytes of the patch
+   * @return ESP_OK, ESP_ERR_INVALID_VERSION if the patch is for another image,
+   *         ESP_ERR_INVALID_RESPONSE for a malformed patch, or a callback error
+   * @note After an error every further call returns the same error
+   */
+  esp_err_t delta_patch_feed(delta_patch_t *patch, const void *data, size_t len);
+
+  /**
+   * @brief Check that the patch was complete and the result is the intended image
+   * @param new_size Output, bytes written, may be NULL
+   * @return ESP_OK, ESP_ERR_INVALID_SIZE if the patch ended early,
+   *         ESP_ERR_INVALID_CRC if the new image's SHA-256 differs, or the feed error
+   */
+  esp_err_t delta_patch_finish(delta_patch_t *patch, uint32_t *new_size);
+
+  /**
+   * @brief Free the patch state, NULL is allowed
+   */
+  void delta_patch_free(delta_patch_t *patch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DELTA_PATCH_H
@@ -0,0 +1,329 @@
+/**
+ * @file diag_http.c
+ * @brief Diagnostics over HTTP, the network side of the serial commands
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "diag_http.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_app_desc.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl/screen_capture.h"
+#include "metrics.h"
+#include "serial/telemetry_history.h"
+#include "serial/telemetry_sd_log.h"
+#include "smart/ha_outbox.h"
+#include "smart/ha_status.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+#include "wifi/wifi_manager.h"
+
+#if CONFIG_DIAG_HTTP
+
+#include "esp_http_server.h"
+
+#define DIAG_HTTP_MAX_SOCKETS 3
+#define DIAG_HTTP_TIMEOUT_S 5
+#define DIAG_HTTP_FOLLOW_POLL_MS 250
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+/**
+ * @brief Collects emitted lines into chunks
+ */
+typedef struct
+{
+  httpd_req_t *req;
+  esp_err_t err;
+  int len;
+  char buf[1024];
+} chunk_writer_t;
+
+/**
+ * @brief Passes BMP or export parts through, remembering whether any went out
+ */
+typedef struct
+{
+  httpd_req_t *req;
+  bool started;
+  const char *type; ///< Content type set before the first part
+} part_writer_t;
+
+static httpd_handle_t http_server = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static esp_err_t chunk_flush(chunk_writer_t *writer)
+{
+  if (writer->err == ESP_OK && writer->len > 0)
+    writer->err = httpd_resp_send_chunk(writer->req, writer->buf, writer->len);
+  writer->len = 0;
+  return writer->err;
+}
+
+/**
+ * @brief Emit function for metrics_export() and debug_log_ring_export()
+ */
+static void chunk_emit(void *ctx, const char *line, int len)
+{
+  chunk_writer_t *writer = ctx;
+  if (writer->err != ESP_OK)
+    return;
+
+  if (writer->len + len > (int)sizeof(writer->buf))
+    chunk_flush(writer);
+  if (len > (int)sizeof(writer->buf))
+    len = sizeof(writer->buf);
+  memcpy(writer->buf + writer->len, line, len);
+  writer->len += len;
+}
+
+static chunk_writer_t *chunk_writer_new(httpd_req_t *req)
+{
+  chunk_writer_t *writer = malloc(sizeof(chunk_writer_t));
+  if (!writer)
+  {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    return NULL;
+  }
+  writer->req = req;
+  writer->err = ESP_OK;
+  writer->len = 0;
+  return writer;
+}
+
+/**
+ * @brief Flush, end the chunked response and free the writer
+ */
+static esp_err_t chunk_writer_finish(chunk_writer_t *writer)
+{
+  esp_err_t err = chunk_flush(writer);
+  httpd_req_t *req = writer->req;
+  free(writer);
+  if (err != ESP_OK)
+    return err;
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t metrics_get_handler(httpd_req_t *req)
+{
+  chunk_writer_t *writer = chunk_writer_new(req);
+  if (!writer)
+    return ESP_FAIL;
+
+  httpd_resp_set_type(req, "text/plain; version=0.0.4");
+  metrics_export(chunk_emit, writer);
+  return chunk_writer_finish(writer);
+}
+
+static esp_err_t status_get_handler(httpd_req_t *req)
+{
+  wifi_info_t wifi;
+  bool wifi_up = wifi_manager_get_info(&wifi) == ESP_OK;
+  ha_status_t ha = ha_status_get_current();
+
+  char buf[512];
+  int len = snprintf(buf, sizeof(buf),
+                     "{\"version\":\"%s\",\"profile\":\"%s\",\"uptime_s\":%lld,"
+                     "\"heap\":{\"internal_free\":%u,\"internal_min\":%u,\"psram_free\":%u,\"psram_min\":%u},"
+                     "\"wifi\":{\"connected\":%s,\"rssi\":%d,\"ip\":\"%s\",\"channel\":%u},"
+                     "\"ha\":{\"status\":\"%s\",\"held_commands\":%d,\"status_flaps_suppressed\":%lu}}\n",
+                     esp_app_get_description()->version, CONFIG_DASHBOARD_PROFILE_NAME,
+                     (long long)(esp_timer_get_time() / 1000000),
+                     (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+                     (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+                     (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                     (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM), wifi_up ? "true" : "false",
+                     wifi_up ? wifi.rssi : 0, wifi_up ? wifi.ip_address : "", wifi_up ? wifi.channel : 0,
+                     ha_status_get_text(ha), ha_outbox_count(), (unsigned long)ha_status_get_suppressed());
+
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t err = httpd_resp_send_chunk(req, buf, len);
+  if (err != ESP_OK)
+    return err;
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t part_write(void *ctx, const void *data, size_t len)
+{
+  part_writer_t *writer = ctx;
+  if (!writer->started)
+  {
+    httpd_resp_set_type(writer->req, writer->type);
+    writer->started = true;
+  }
+  return httpd_resp_send_chunk(writer->req, data, len);
+}
+
+static esp_err_t screenshot_get_handler(httpd_req_t *req)
+{
+  part_writer_t writer = {.req = req, .type = "image/bmp"};
+  esp_err_t ret = screen_capture_write_bmp(part_write, &writer);
+  if (ret == ESP_OK)
+    return httpd_resp_send_chunk(req, NULL, 0);
+
+  // Nothing sent yet, the status line can still report the failure
+  if (!writer.started)
+  {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_sendstr(req, ret == ESP_ERR_NOT_SUPPORTED ? "Screen capture disabled\n" : esp_err_to_name(ret));
+    return ESP_OK;
+  }
+  return ret;
+}
+
+static esp_err_t logs_get_handler(httpd_req_t *req)
+{
+  int follow_s = 0;
+  char query[32];
+  char value[8];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "follow", value, sizeof(value)) == ESP_OK)
+  {
+    follow_s = atoi(value);
+    if (follow_s < 0)
+      follow_s = 0;
+    if (follow_s > DIAG_HTTP_FOLLOW_MAX_S)
+      follow_s = DIAG_HTTP_FOLLOW_MAX_S;
+  }
+
+#if !CONFIG_SYSTEM_DEBUG_LOG_RING
+  httpd_resp_set_status(req, "503 Service Unavailable");
+  return httpd_resp_sendstr(req, "Log ring disabled\n");
+#endif
+
+  chunk_writer_t *writer = chunk_writer_new(req);
+  if (!writer)
+    return ESP_FAIL;
+
+  httpd_resp_set_type(req, "text/plain; charset=utf-8");
+  uint32_t since = debug_log_ring_export(0, chunk_emit, writer);
+  chunk_flush(writer);
+
+  int64_t end_us = esp_timer_get_time() + (int64_t)follow_s * 1000000;
+  while (writer->err == ESP_OK && esp_timer_get_time() < end_us)
+  {
+    vTaskDelay(pdMS_TO_TICKS(DIAG_HTTP_FOLLOW_POLL_MS));
+    since = debug_log_ring_export(since, chunk_emit, writer);
+    chunk_flush(writer);
+  }
+  return chunk_writer_finish(writer);
+}
+
+static esp_err_t history_get_handler(httpd_req_t *req)
+{
+  // ?source=sd|raw|1s|10s|1m&from=MS&to=MS&format=csv|bin, the whole card log as CSV by default
+  char source[8] = "sd";
+  char format[8] = "csv";
+  uint64_t from_ms = 0, to_ms = UINT64_MAX;
+  char query[128];
+  char value[24];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+  {
+    httpd_query_key_value(query, "source", source, sizeof(source));
+    httpd_query_key_value(query, "format", format, sizeof(format));
+    if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK)
+      from_ms = strtoull(value, NULL, 10);
+    if (httpd_query_key_value(query, "to", value, sizeof(value)) == ESP_OK)
+      to_ms = strtoull(value, NULL, 10);
+  }
+
+  bool binary = strcmp(format, "bin") == 0;
+  part_writer_t writer = {.req = req, .type = binary ? "application/octet-stream" : "text/csv"};
+  esp_err_t ret = ESP_ERR_INVALID_ARG;
+  if (strcmp(source, "sd") == 0)
+  {
+    ret = telemetry_sd_log_export(from_ms, to_ms, binary ? TELEMETRY_SD_LOG_BINARY : TELEMETRY_SD_LOG_CSV,
+                                  part_write, &writer);
+  }
+  else if (!binary)
+  {
+    for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++)
+    {
+      if (strcmp(source, telemetry_history_tier_name(tier)) == 0)
+        ret = telemetry_history_export(tier, from_ms, to_ms, part_write, &writer);
+    }
+  }
+  if (ret == ESP_OK)
+  {
+    // An empty range still answers with an empty body
+    if (!writer.started)
+      httpd_resp_set_type(req, writer.type);
+    return httpd_resp_send_chunk(req, NULL, 0);
+  }
+
+  if (!writer.started)
+  {
+    httpd_resp_set_status(req, ret == ESP_ERR_INVALID_ARG ? "400 Bad Request" : "503 Service Unavailable");
+    httpd_resp_sendstr(req, ret == ESP_ERR_INVALID_ARG     ? "Unknown source or format\n"
+                            : ret == ESP_ERR_INVALID_STATE ? "No history\n"
+                            : ret == ESP_ERR_TIMEOUT       ? "Another export is running\n"
+                                                           : esp_err_to_name(ret));
+    return ESP_OK;
+  }
+  return ret;
+}
+
+#endif // CONFIG_DIAG_HTTP
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t diag_http_start(void)
+{
+#if CONFIG_DIAG_HTTP
+  if (http_server)
+    return ESP_OK;
+
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = DIAG_HTTP_PORT;
+  config.ctrl_port = DIAG_HTTP_PORT + 1;
+  config.task_priority = task_plan_get(TASK_PLAN_DIAG_HTTP)->priority;
+  config.stack_size = task_plan_get(TASK_PLAN_DIAG_HTTP)->stack_size;
+  config.core_id = task_plan_get(TASK_PLAN_DIAG_HTTP)->core;
+  config.max_open_sockets = DIAG_HTTP_MAX_SOCKETS;
+  config.backlog_conn = 2;
+  config.lru_purge_enable = true;
+  config.recv_wait_timeout = DIAG_HTTP_TIMEOUT_S;
+  config.send_wait_timeout = DIAG_HTTP_TIMEOUT_S;
+  config.max_uri_handlers = 5;
+
+  esp_err_t ret = httpd_start(&http_server, &config);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Diagnostics server failed to start: %s", esp_err_to_name(ret));
+    http_server = NULL;
+    return ret;
+  }
+
+  static const httpd_uri_t uris[] = {
+      {.uri = "/metrics", .method = HTTP_GET, .handler = metrics_get_handler},
+      {.uri = "/status", .method = HTTP_GET, .handler = status_get_handler},
+      {.uri = "/screenshot", .method = HTTP_GET, .handler = screenshot_get_handler},
+      {.uri = "/logs", .method = HTTP_GET, .handler = logs_get_handler},
+      {.uri = "/history", .method = HTTP_GET, .handler = history_get_handler},
+  };
+  for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++)
+  {
+    httpd_register_uri_handler(http_server, &uris[i]);
+  }
+
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Diagnostics server on port %d", DIAG_HTTP_PORT);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
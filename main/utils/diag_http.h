@@ -0,0 +1,62 @@
+/**
+ * @file diag_http.h
+ * @brief Diagnostics over HTTP, the network side of the serial commands
+ *
+ * One small esp_http_server instance on DIAG_HTTP_PORT:
+ *   GET /metrics        Prometheus text, as GET_METRICS
+ *   GET /status         JSON with firmware, uptime, heap, WiFi and HA state
+ *   GET /screenshot     The frame on screen as a BMP
+ *   GET /logs[?follow=S] The log ring as LOG_DUMP prints it, then new lines
+ *                       for up to S seconds (at most DIAG_HTTP_FOLLOW_MAX_S)
+ *   GET /history[?source=sd|raw|1s|10s|1m&from=MS&to=MS&format=csv|bin]
+ *                       A time range of the card log or a PSRAM history tier,
+ *                       as EXPORT_HISTORY streams it (telemetry_export.h)
+ *
+ * Every response is sent with chunked transfer encoding while it is being
+ * produced, nothing is buffered whole. The server task runs below the LVGL,
+ * touch and HA tasks and handles one request at a time with few sockets, so
+ * a busy client slows only itself.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef DIAG_HTTP_H
+#define DIAG_HTTP_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#ifdef CONFIG_DIAG_HTTP_PORT
+#define DIAG_HTTP_PORT CONFIG_DIAG_HTTP_PORT
+#else
+#define DIAG_HTTP_PORT 9100
+#endif
+
+  /** Longest /logs follows the ring, the server serves nothing else meanwhile */
+#define DIAG_HTTP_FOLLOW_MAX_S 60
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start the diagnostics server on DIAG_HTTP_PORT
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   * @note Needs the network stack, call once WiFi is up
+   */
+  esp_err_t diag_http_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DIAG_HTTP_H
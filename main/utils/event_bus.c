@@ -0,0 +1,303 @@
+/**
+ * @file event_bus.c
+ * @brief In-process publish/subscribe bus with typed topics
+ *
+ * The subscriber table is a fixed array behind a spinlock. A publish takes
+ * a snapshot of the topic's subscribers and calls them with the lock
+ * released, so a handler may publish or subscribe itself. Queued
+ * subscribers share one slot built on the publisher's stack on first need;
+ * the queue copies it, and the payload pointers are pointed back into the
+ * copy when it is dispatched.
+ *
+ * Retained topics publish under a recursive mutex, which a late subscriber
+ * also holds while the last event is replayed to it, so the replay can not
+ * overtake or follow a concurrent publish out of order.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "event_bus.h"
+
+#include <string.h>
+#include "freertos/semphr.h"
+#include "metrics.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef struct
+{
+  event_topic_t topic;
+  event_handler_t handler; ///< NULL marks a free entry
+  void *ctx;
+  QueueHandle_t queue; ///< NULL for inline delivery
+} subscriber_t;
+
+/**
+ * @brief Fixed-size queue item, payloads the event points to travel inside it
+ */
+typedef struct
+{
+  event_t event;
+  event_handler_t handler;
+  void *ctx;
+  union
+  {
+    system_data_t telemetry;
+    char text[EVENT_BUS_TEXT_MAX];
+  } payload;
+} event_slot_t;
+
+static const struct
+{
+  bool retained;
+  bool inline_only;
+} topic_info[EVENT_TOPIC_COUNT] = {
+    [EVENT_TOPIC_WIFI_STATUS] = {.retained = true},
+    [EVENT_TOPIC_HA_STATUS] = {.retained = true},
+    [EVENT_TOPIC_HA_STATES] = {.inline_only = true},
+};
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static portMUX_TYPE bus_lock = portMUX_INITIALIZER_UNLOCKED;
+static subscriber_t subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+
+static SemaphoreHandle_t retain_mutex = NULL;
+static StaticSemaphore_t retain_mutex_buffer;
+static event_slot_t retained_events[EVENT_TOPIC_COUNT];
+static bool retained_valid[EVENT_TOPIC_COUNT];
+
+#define EVENT_PUBLISHED_METRIC(topic_)                \
+  {.name = "event_bus_published_total",               \
+   .help = "Events published per topic",              \
+   .labels = "topic=\"" topic_ "\"",                  \
+   .type = METRIC_TYPE_COUNTER}
+
+static metric_t published_metrics[EVENT_TOPIC_COUNT] = {
+    [EVENT_TOPIC_TELEMETRY] = EVENT_PUBLISHED_METRIC("telemetry"),
+    [EVENT_TOPIC_SERIAL_CONNECTION] = EVENT_PUBLISHED_METRIC("serial_connection"),
+    [EVENT_TOPIC_WIFI_STATUS] = EVENT_PUBLISHED_METRIC("wifi_status"),
+    [EVENT_TOPIC_HA_STATUS] = EVENT_PUBLISHED_METRIC("ha_status"),
+    [EVENT_TOPIC_HA_STATES] = EVENT_PUBLISHED_METRIC("ha_states"),
+};
+static metric_t dropped_metric =
+    METRIC_COUNTER_INIT("event_bus_dropped_total", "Queued deliveries lost to a full subscriber queue");
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @brief Point the event of a slot at the payload copy inside the slot
+ */
+static void slot_link_payload(event_slot_t *slot)
+{
+  switch (slot->event.topic)
+  {
+  case EVENT_TOPIC_TELEMETRY:
+    slot->event.telemetry.data = &slot->payload.telemetry;
+    break;
+  case EVENT_TOPIC_WIFI_STATUS:
+    slot->event.wifi_status.text = slot->payload.text;
+    break;
+  case EVENT_TOPIC_HA_STATUS:
+    slot->event.ha_status.text = slot->payload.text;
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Copy an event and whatever it points to into a slot
+ */
+static void slot_fill(event_slot_t *slot, const event_t *event)
+{
+  slot->event = *event;
+  switch (event->topic)
+  {
+  case EVENT_TOPIC_TELEMETRY:
+    slot->payload.telemetry = *event->telemetry.data;
+    break;
+  case EVENT_TOPIC_WIFI_STATUS:
+    strlcpy(slot->payload.text, event->wifi_status.text ? event->wifi_status.text : "", EVENT_BUS_TEXT_MAX);
+    break;
+  case EVENT_TOPIC_HA_STATUS:
+    strlcpy(slot->payload.text, event->ha_status.text ? event->ha_status.text : "", EVENT_BUS_TEXT_MAX);
+    break;
+  default:
+    break;
+  }
+  slot_link_payload(slot);
+}
+
+/**
+ * @brief Hand an event to a queued subscriber, the slot is filled on first use
+ */
+static void enqueue(const subscriber_t *sub, const event_t *event, event_slot_t *slot, bool *filled)
+{
+  if (!*filled)
+  {
+    slot_fill(slot, event);
+    *filled = true;
+  }
+  slot->handler = sub->handler;
+  slot->ctx = sub->ctx;
+  if (xQueueSend(sub->queue, slot, 0) != pdTRUE)
+  {
+    metrics_counter_add(&dropped_metric, 1);
+  }
+}
+
+static void deliver(const subscriber_t *sub, const event_t *event, event_slot_t *slot, bool *filled)
+{
+  if (sub->queue)
+  {
+    enqueue(sub, event, slot, filled);
+  }
+  else
+  {
+    sub->handler(event, sub->ctx);
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+void event_bus_init(void)
+{
+  if (retain_mutex)
+    return;
+
+  retain_mutex = xSemaphoreCreateRecursiveMutexStatic(&retain_mutex_buffer);
+  for (int i = 0; i < EVENT_TOPIC_COUNT; i++)
+  {
+    metrics_register(&published_metrics[i]);
+  }
+  metrics_register(&dropped_metric);
+}
+
+esp_err_t event_bus_subscribe(event_topic_t topic, event_handler_t handler, void *ctx, QueueHandle_t queue)
+{
+  if (topic >= EVENT_TOPIC_COUNT || !handler)
+    return ESP_ERR_INVALID_ARG;
+  if (queue && topic_info[topic].inline_only)
+    return ESP_ERR_INVALID_ARG;
+
+  bool retained = topic_info[topic].retained && retain_mutex;
+  if (retained)
+    xSemaphoreTakeRecursive(retain_mutex, portMAX_DELAY);
+
+  esp_err_t ret = ESP_ERR_NO_MEM;
+  bool added = false;
+  subscriber_t sub = {.topic = topic, .handler = handler, .ctx = ctx, .queue = queue};
+  portENTER_CRITICAL(&bus_lock);
+  for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++)
+  {
+    if (subscribers[i].handler == handler && subscribers[i].ctx == ctx && subscribers[i].topic == topic)
+    {
+      ret = ESP_OK;
+      break;
+    }
+  }
+  for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS && ret != ESP_OK; i++)
+  {
+    if (subscribers[i].handler == NULL)
+    {
+      subscribers[i] = sub;
+      ret = ESP_OK;
+      added = true;
+    }
+  }
+  portEXIT_CRITICAL(&bus_lock);
+
+  // Start the newcomer from the current state
+  if (added && retained && retained_valid[topic])
+  {
+    event_slot_t slot;
+    bool filled = false;
+    deliver(&sub, &retained_events[topic].event, &slot, &filled);
+  }
+
+  if (retained)
+    xSemaphoreGiveRecursive(retain_mutex);
+
+  if (ret != ESP_OK)
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Event bus full, topic %d not subscribed", topic);
+  return ret;
+}
+
+void event_bus_unsubscribe(event_topic_t topic, event_handler_t handler, void *ctx)
+{
+  portENTER_CRITICAL(&bus_lock);
+  for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++)
+  {
+    if (subscribers[i].handler == handler && subscribers[i].ctx == ctx && subscribers[i].topic == topic)
+    {
+      subscribers[i].handler = NULL;
+    }
+  }
+  portEXIT_CRITICAL(&bus_lock);
+}
+
+void event_bus_publish(const event_t *event)
+{
+  if (!event || event->topic >= EVENT_TOPIC_COUNT)
+    return;
+
+  event_topic_t topic = event->topic;
+  bool retained = topic_info[topic].retained && retain_mutex;
+  if (retained)
+  {
+    xSemaphoreTakeRecursive(retain_mutex, portMAX_DELAY);
+    slot_fill(&retained_events[topic], event);
+    retained_valid[topic] = true;
+  }
+
+  subscriber_t snapshot[EVENT_BUS_MAX_SUBSCRIBERS];
+  int count = 0;
+  portENTER_CRITICAL(&bus_lock);
+  for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++)
+  {
+    if (subscribers[i].handler && subscribers[i].topic == topic)
+    {
+      snapshot[count++] = subscribers[i];
+    }
+  }
+  portEXIT_CRITICAL(&bus_lock);
+
+  event_slot_t slot;
+  bool filled = false;
+  for (int i = 0; i < count; i++)
+  {
+    deliver(&snapshot[i], event, &slot, &filled);
+  }
+
+  if (retained)
+    xSemaphoreGiveRecursive(retain_mutex);
+
+  metrics_counter_add(&published_metrics[topic], 1);
+}
+
+QueueHandle_t event_bus_queue_create(uint32_t depth)
+{
+  return xQueueCreate(depth, sizeof(event_slot_t));
+}
+
+bool event_bus_dispatch(QueueHandle_t queue, TickType_t timeout)
+{
+  event_slot_t slot;
+  if (xQueueReceive(queue, &slot, timeout) != pdTRUE)
+    return false;
+
+  slot_link_payload(&slot);
+  slot.handler(&slot.event, slot.ctx);
+  return true;
+}
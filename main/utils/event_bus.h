@@ -0,0 +1,171 @@
+/**
+ * @file event_bus.h
+ * @brief In-process publish/subscribe bus with typed topics
+ *
+ * Producers publish an event_t on a topic and do not know who listens;
+ * any number of subscribers attach to a topic at boot or later. Each
+ * subscriber picks its delivery:
+ *
+ *   inline  - the handler runs in the publishing task, before publish
+ *             returns, and may read the payload pointers as they are
+ *   queued  - the event is copied into a fixed-size slot of the
+ *             subscriber's own queue and the handler runs wherever that
+ *             queue is drained with event_bus_dispatch(); a full queue
+ *             drops the event for that subscriber, the producer never waits
+ *
+ * Payloads that point at producer state (telemetry frames, status text)
+ * are copied into the slot, so a queued handler sees them exactly as they
+ * were published. Entity state arrays are too large for a slot and are
+ * inline only. Nothing is allocated per event; queues are allocated once,
+ * by event_bus_queue_create().
+ *
+ * Status topics are retained: the last event is replayed to a subscriber
+ * that joins later, so it starts from the current state.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dashboard_data.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "ha_entity_state.h"
+#include "ha_status.h"
+#include "wifi_manager.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define EVENT_BUS_MAX_SUBSCRIBERS 16 ///< Across all topics
+#define EVENT_BUS_TEXT_MAX 80        ///< Status text kept in a slot, longer text is cut
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    EVENT_TOPIC_TELEMETRY = 0,     ///< A merged sample of one telemetry source
+    EVENT_TOPIC_SERIAL_CONNECTION, ///< A telemetry source came up or went quiet
+    EVENT_TOPIC_WIFI_STATUS,       ///< WiFi status changed, retained
+    EVENT_TOPIC_HA_STATUS,         ///< Home Assistant status changed, retained
+    EVENT_TOPIC_HA_STATES,         ///< Entity states changed, inline only
+    EVENT_TOPIC_COUNT
+  } event_topic_t;
+
+  /**
+   * @brief One event, the payload member is the one named after the topic
+   */
+  typedef struct
+  {
+    event_topic_t topic;
+    union
+    {
+      struct
+      {
+        uint8_t source_id;
+        uint32_t changed_fields;   ///< SYSTEM_DATA_FIELD_* mask against the previous sample
+        const system_data_t *data; ///< Merged current state of the source
+      } telemetry;
+
+      struct
+      {
+        uint8_t source_id;
+        bool connected;
+      } serial_connection;
+
+      struct
+      {
+        wifi_status_t status;
+        bool is_connected;
+        const char *text; ///< Human-readable status
+      } wifi_status;
+
+      struct
+      {
+        ha_status_t status;
+        bool is_ready;
+        bool is_syncing;
+        const char *text; ///< Human-readable status
+      } ha_status;
+
+      struct
+      {
+        const ha_entity_state_t *states; ///< Indexed like the entity registry
+        int count;                       ///< ha_registry_count()
+      } ha_states;
+    };
+  } event_t;
+
+  /**
+   * @brief Subscriber handler
+   * @param event Valid for the duration of the call only
+   * @param ctx As given to event_bus_subscribe()
+   */
+  typedef void (*event_handler_t)(const event_t *event, void *ctx);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create the retained-event lock and register the bus metrics
+   * @note Call first thing in app_main(), before any producer starts
+   */
+  void event_bus_init(void);
+
+  /**
+   * @brief Attach a handler to a topic
+   * @param topic Topic to follow
+   * @param handler Called once per event
+   * @param ctx Passed to the handler
+   * @param queue NULL for inline delivery, else a queue from event_bus_queue_create()
+   * @return ESP_OK, ESP_ERR_INVALID_ARG for a queue on an inline-only topic,
+   *         ESP_ERR_NO_MEM if the subscriber table is full
+   * @note Subscribing the same handler and ctx twice to a topic does nothing
+   */
+  esp_err_t event_bus_subscribe(event_topic_t topic, event_handler_t handler, void *ctx, QueueHandle_t queue);
+
+  /**
+   * @brief Detach a handler, events already queued for it are still dispatched
+   */
+  void event_bus_unsubscribe(event_topic_t topic, event_handler_t handler, void *ctx);
+
+  /**
+   * @brief Deliver an event to every subscriber of its topic
+   * @note Runs the inline handlers in the calling task, never blocks on a queue
+   */
+  void event_bus_publish(const event_t *event);
+
+  /**
+   * @brief Create a queue of fixed-size event slots for queued delivery
+   * @param depth Events held before new ones are dropped
+   * @return The queue, NULL if out of memory
+   */
+  QueueHandle_t event_bus_queue_create(uint32_t depth);
+
+  /**
+   * @brief Take one event from a queue and run its handler in the calling task
+   * @param queue Queue from event_bus_queue_create()
+   * @param timeout Ticks to wait for an event
+   * @return true if an event was dispatched
+   */
+  bool event_bus_dispatch(QueueHandle_t queue, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_BUS_H
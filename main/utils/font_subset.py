@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Dashboard Font Subsetter
+========================
+
+Build step behind CONFIG_UI_SUBSET_FONTS. Generates the four dashboard
+fonts (font_title, font_normal, font_small, font_big_numbers) as
+compressed LVGL bitmap fonts that only hold the glyphs the UI can show:
+
+1. Printable ASCII for the text fonts, since CPU/GPU names, HA entity
+   labels and status strings arrive at runtime
+2. Digits, units and punctuation only for the big number font
+3. Every non-ASCII character found in a string literal under main/,
+   e.g. the degree sign of "°C"
+4. Every character of the HA_ENTITY_*_LABEL defines in smart_config.h
+5. The characters of CONFIG_UI_FONT_EXTRA_CHARS, for labels that only
+   exist in the NVS entity registry
+
+Glyphs are rendered with lv_font_conv at 4 bpp and RLE compressed. The
+result is const data and stays in flash; the optional PSRAM glyph cache
+(ui_font_cache.c) keeps decompressed glyphs at runtime.
+
+Requirements:
+    npm install -g lv_font_conv
+
+Usage:
+    python font_subset.py --ttf Montserrat-Medium.ttf --out build/fonts
+    python font_subset.py --ttf Montserrat-Medium.ttf --out fonts --extra "äöü" --list
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+from typing import Dict, Iterable, Set
+
+MAIN_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PRINTABLE_ASCII = "".join(chr(c) for c in range(0x20, 0x7F))
+
+# Numbers, the units printed next to them ("KB", "RPM", "1h 05m") and "°"
+BIG_NUMBER_CHARS = "0123456789 %+-.,:/" + "BCGKMPRTbdhms"
+
+# name -> (pixel size, base characters), names must match ui_config.c
+FONTS = {
+    "font_dash_title": (28, PRINTABLE_ASCII),
+    "font_dash_normal": (16, PRINTABLE_ASCII),
+    "font_dash_small": (14, PRINTABLE_ASCII),
+    "font_dash_big_numbers": (32, BIG_NUMBER_CHARS),
+}
+
+STRING_LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+ENTITY_LABEL = re.compile(r'#define\s+HA_ENTITY_\w+_LABEL\s+"((?:[^"\\\n]|\\.)*)"')
+
+SKIP_DIRS = {"fonts", "__pycache__"}
+
+
+def unescape_c(literal: str) -> str:
+    """Decode a C string literal body, \\x and octal escapes are UTF-8 bytes"""
+    out = bytearray()
+    i = 0
+    raw = literal.encode("utf-8")
+    while i < len(raw):
+        c = raw[i]
+        if c != 0x5C or i + 1 >= len(raw):
+            out.append(c)
+            i += 1
+            continue
+        nxt = chr(raw[i + 1])
+        if nxt == "x":
+            m = re.match(rb"[0-9A-Fa-f]{1,2}", raw[i + 2 : i + 4])
+            if m:
+                out.append(int(m.group(0), 16))
+                i += 2 + len(m.group(0))
+                continue
+        elif nxt in "01234567":
+            m = re.match(rb"[0-7]{1,3}", raw[i + 1 : i + 4])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+            continue
+        elif nxt in "\\\"'":
+            out.append(ord(nxt))
+        # \n, \t and friends are never drawn
+        i += 2
+    return out.decode("utf-8", errors="ignore")
+
+
+def source_files(root: str) -> Iterable[str]:
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = [d for d in dirnames if d not in SKIP_DIRS]
+        for name in filenames:
+            if name.endswith((".c", ".h")):
+                yield os.path.join(dirpath, name)
+
+
+def literal_chars(root: str) -> Set[str]:
+    """Non-ASCII characters used in any string literal"""
+    chars: Set[str] = set()
+    for path in source_files(root):
+        with open(path, encoding="utf-8", errors="ignore") as f:
+            for literal in STRING_LITERAL.findall(f.read()):
+                chars.update(ch for ch in unescape_c(literal) if ord(ch) >= 0xA0)
+    return chars
+
+
+def entity_label_chars(config_path: str) -> Set[str]:
+    if not os.path.exists(config_path):
+        return set()
+    with open(config_path, encoding="utf-8", errors="ignore") as f:
+        labels = ENTITY_LABEL.findall(f.read())
+    return {ch for label in labels for ch in unescape_c(label) if ord(ch) >= 0x20}
+
+
+def font_charsets(extra: str) -> Dict[str, str]:
+    shared = literal_chars(MAIN_DIR)
+    labels = entity_label_chars(os.path.join(MAIN_DIR, "smart", "smart_config.h"))
+    extra_set = {ch for ch in extra if ord(ch) >= 0x20}
+
+    charsets = {}
+    for name, (_, base) in FONTS.items():
+        chars = set(base) | shared | extra_set
+        if base == PRINTABLE_ASCII:
+            chars |= labels
+        charsets[name] = "".join(sorted(chars))
+    return charsets
+
+
+def convert(lv_font_conv: str, ttf: str, name: str, size: int, chars: str, out_dir: str) -> None:
+    # Code points keep the command line free of shell-hostile characters
+    codepoints = sorted(ord(ch) for ch in chars)
+    args = [lv_font_conv, "--bpp", "4", "--size", str(size), "--format", "lvgl", "--font", ttf]
+    args += ["--range", ",".join(hex(cp) for cp in codepoints)]
+    args += ["--lv-font-name", name, "--lv-include", "lvgl.h", "-o", os.path.join(out_dir, name + ".c")]
+    subprocess.run(args, check=True, stdout=subprocess.DEVNULL)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Subset and compress the dashboard fonts")
+    parser.add_argument("--ttf", required=True, help="Source TTF, e.g. lvgl/scripts/built_in_font/Montserrat-Medium.ttf")
+    parser.add_argument("--out", "-o", required=True, help="Output directory for the generated .c files")
+    parser.add_argument("--extra", default="", help="Extra characters for every font (CONFIG_UI_FONT_EXTRA_CHARS)")
+    parser.add_argument("--lv-font-conv", default=shutil.which("lv_font_conv"), help="lv_font_conv executable")
+    parser.add_argument("--list", action="store_true", help="Print each font's character set")
+    args = parser.parse_args()
+
+    if not args.lv_font_conv:
+        sys.exit("lv_font_conv not found, install it with: npm install -g lv_font_conv")
+
+    os.makedirs(args.out, exist_ok=True)
+    charsets = font_charsets(args.extra)
+    for name, (size, _) in FONTS.items():
+        chars = charsets[name]
+        if args.list:
+            print(f"{name} ({size} px, {len(chars)} glyphs): {chars}")
+        convert(args.lv_font_conv, args.ttf, name, size, chars, args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,420 @@
+/**
+ * @file heap_monitor.c
+ * @brief Heap fragmentation monitor and allocation-site histogram
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "heap_monitor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "mem_governor.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+#if CONFIG_HEAP_MONITOR_ALLOC_SITES
+#include "esp_debug_helpers.h"
+#endif
+
+#define SITES_REPORTED 16
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  const char *name;
+  uint32_t caps;
+} region_desc_t;
+
+static const region_desc_t region_descs[HEAP_REGION_COUNT] = {
+    [HEAP_REGION_INTERNAL] = {"internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+    [HEAP_REGION_SPIRAM] = {"spiram", MALLOC_CAP_SPIRAM},
+    [HEAP_REGION_DMA] = {"dma", MALLOC_CAP_DMA},
+};
+
+#if CONFIG_HEAP_MONITOR
+// Written by the sample timer and allocating tasks, read by the serial task
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t sample_timer = NULL;
+static heap_region_stats_t region_stats[HEAP_REGION_COUNT];
+static bool sampled = false;
+static bool frag_warned[HEAP_REGION_COUNT];
+static size_t baseline_free[HEAP_REGION_COUNT];
+static int64_t baseline_us = 0;
+
+static uint32_t failed_allocs = 0;
+static uint32_t failed_reported = 0;
+static size_t last_failed_size = 0;
+static uint32_t last_failed_caps = 0;
+static const char *last_failed_func = NULL;
+#endif
+
+#if CONFIG_HEAP_MONITOR_ALLOC_SITES
+typedef struct
+{
+  uint32_t pc;     ///< Return address at CONFIG_HEAP_MONITOR_SITE_DEPTH, 0 for a free entry
+  uint32_t caller; ///< One frame further up
+  uint32_t allocs;
+  uint32_t bytes;
+} alloc_site_t;
+
+static portMUX_TYPE sites_lock = portMUX_INITIALIZER_UNLOCKED;
+static alloc_site_t sites[HEAP_MONITOR_MAX_SITES];
+static uint32_t other_allocs = 0;
+static uint32_t other_bytes = 0;
+#endif
+
+// =======================================================================
+// ALLOCATION HOOKS
+// =======================================================================
+
+#if CONFIG_HEAP_MONITOR_ALLOC_SITES
+
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+  if (!ptr)
+    return;
+
+  // Frame 0 is this hook, the allocator's own frames come next
+  esp_backtrace_frame_t frame;
+  esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+  uint32_t pc = 0;
+  uint32_t caller = 0;
+  for (int depth = 0; depth <= CONFIG_HEAP_MONITOR_SITE_DEPTH + 1; depth++)
+  {
+    if (!esp_backtrace_get_next_frame(&frame))
+      break;
+    if (depth == CONFIG_HEAP_MONITOR_SITE_DEPTH)
+      pc = esp_cpu_process_stack_pc(frame.pc);
+    else if (depth == CONFIG_HEAP_MONITOR_SITE_DEPTH + 1)
+      caller = esp_cpu_process_stack_pc(frame.pc);
+  }
+
+  portENTER_CRITICAL_SAFE(&sites_lock);
+  alloc_site_t *site = NULL;
+  for (int i = 0; i < HEAP_MONITOR_MAX_SITES && pc; i++)
+  {
+    if (sites[i].pc == pc && sites[i].caller == caller)
+    {
+      site = &sites[i];
+      break;
+    }
+    if (sites[i].pc == 0)
+    {
+      site = &sites[i];
+      site->pc = pc;
+      site->caller = caller;
+      break;
+    }
+  }
+  if (site)
+  {
+    site->allocs++;
+    site->bytes += size;
+  }
+  else
+  {
+    other_allocs++;
+    other_bytes += size;
+  }
+  portEXIT_CRITICAL_SAFE(&sites_lock);
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+  // Sites count allocations made, frees are not matched back to them
+  (void)ptr;
+}
+
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_HEAP_MONITOR
+
+static void failed_alloc_callback(size_t size, uint32_t caps, const char *function_name)
+{
+  // Any task, possibly deep in a caller that is about to handle NULL: only take note
+  portENTER_CRITICAL_SAFE(&stats_lock);
+  failed_allocs++;
+  last_failed_size = size;
+  last_failed_caps = caps;
+  last_failed_func = function_name;
+  portEXIT_CRITICAL_SAFE(&stats_lock);
+  mem_governor_note_alloc_failure(size, caps);
+}
+
+static void sample_region(heap_region_t region, int64_t now_us, heap_region_stats_t *stats)
+{
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, region_descs[region].caps);
+
+  stats->total = heap_caps_get_total_size(region_descs[region].caps);
+  stats->free = info.total_free_bytes;
+  stats->largest_free = info.largest_free_block;
+  stats->min_free = info.minimum_free_bytes;
+  if (!sampled || info.largest_free_block < stats->min_largest)
+    stats->min_largest = info.largest_free_block;
+  stats->alloc_blocks = (uint32_t)info.allocated_blocks;
+  stats->free_blocks = (uint32_t)info.free_blocks;
+  stats->frag_pct = (info.total_free_bytes > 0)
+                        ? (uint8_t)(100 - (uint64_t)info.largest_free_block * 100 / info.total_free_bytes)
+                        : 0;
+
+  if (baseline_us > 0 && now_us - baseline_us >= 60 * 1000000LL)
+  {
+    int64_t delta = (int64_t)info.total_free_bytes - (int64_t)baseline_free[region];
+    stats->drift_per_hour = (int32_t)(delta * 3600LL * 1000000LL / (now_us - baseline_us));
+  }
+
+  // Judged while the heap still has room, an empty heap is a different problem
+  if (!frag_warned[region] && stats->frag_pct >= HEAP_MONITOR_FRAG_WARN_PCT &&
+      stats->free >= HEAP_MONITOR_FRAG_MIN_FREE)
+  {
+    frag_warned[region] = true;
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Heap %s fragmented: %u%%, largest block %u of %u bytes free",
+                        region_descs[region].name, stats->frag_pct, (unsigned)stats->largest_free,
+                        (unsigned)stats->free);
+  }
+  else if (frag_warned[region] && stats->frag_pct + 10 < HEAP_MONITOR_FRAG_WARN_PCT)
+  {
+    frag_warned[region] = false;
+  }
+}
+
+static void sample_timer_cb(void *arg)
+{
+  int64_t now_us = esp_timer_get_time();
+  heap_region_stats_t fresh[HEAP_REGION_COUNT];
+
+  portENTER_CRITICAL(&stats_lock);
+  memcpy(fresh, region_stats, sizeof(fresh));
+  portEXIT_CRITICAL(&stats_lock);
+
+  for (int region = 0; region < HEAP_REGION_COUNT; region++)
+  {
+    sample_region(region, now_us, &fresh[region]);
+  }
+  if (baseline_us == 0 && now_us >= HEAP_MONITOR_SETTLE_S * 1000000LL)
+  {
+    baseline_us = now_us;
+    for (int region = 0; region < HEAP_REGION_COUNT; region++)
+    {
+      baseline_free[region] = fresh[region].free;
+    }
+  }
+
+  portENTER_CRITICAL(&stats_lock);
+  memcpy(region_stats, fresh, sizeof(region_stats));
+  sampled = true;
+  uint32_t failed = failed_allocs;
+  size_t size = last_failed_size;
+  uint32_t caps = last_failed_caps;
+  const char *func = last_failed_func;
+  portEXIT_CRITICAL(&stats_lock);
+
+  if (failed != failed_reported)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "%lu allocation(s) failed, last %u bytes caps 0x%lx in %s",
+                      (unsigned long)(failed - failed_reported), (unsigned)size, (unsigned long)caps,
+                      func ? func : "?");
+    failed_reported = failed;
+  }
+}
+
+static void reply_stats(void)
+{
+  heap_region_stats_t copy[HEAP_REGION_COUNT];
+  portENTER_CRITICAL(&stats_lock);
+  memcpy(copy, region_stats, sizeof(copy));
+  bool have = sampled;
+  uint32_t failed = failed_allocs;
+  size_t size = last_failed_size;
+  uint32_t caps = last_failed_caps;
+  const char *func = last_failed_func;
+  portEXIT_CRITICAL(&stats_lock);
+
+  if (!have)
+  {
+    static const char none[] = "HEAP_STATS {\"error\":\"no sample yet\"}\n";
+    serial_data_write(none, sizeof(none) - 1);
+    return;
+  }
+
+  char buf[256];
+  serial_data_write("HEAP_STATS {\"regions\":[", 23);
+  for (int region = 0; region < HEAP_REGION_COUNT; region++)
+  {
+    const heap_region_stats_t *stats = &copy[region];
+    int len = snprintf(buf, sizeof(buf),
+                       "%s{\"name\":\"%s\",\"total\":%u,\"free\":%u,\"largest\":%u,\"min_free\":%u,"
+                       "\"min_largest\":%u,\"frag_pct\":%u,\"alloc_blocks\":%lu,\"free_blocks\":%lu,"
+                       "\"drift_per_h\":%ld}",
+                       region ? "," : "", region_descs[region].name, (unsigned)stats->total, (unsigned)stats->free,
+                       (unsigned)stats->largest_free, (unsigned)stats->min_free, (unsigned)stats->min_largest,
+                       stats->frag_pct, (unsigned long)stats->alloc_blocks, (unsigned long)stats->free_blocks,
+                       (long)stats->drift_per_hour);
+    serial_data_write(buf, len);
+  }
+  int len = snprintf(buf, sizeof(buf), "],\"failed_allocs\":%lu,\"last_failed\":{\"size\":%u,\"caps\":%lu,\"func\":\"%s\"}}\n",
+                     (unsigned long)failed, (unsigned)size, (unsigned long)caps, func ? func : "");
+  serial_data_write(buf, len);
+}
+
+#endif
+
+#if CONFIG_HEAP_MONITOR_ALLOC_SITES
+
+static void reply_sites(void)
+{
+  // Only the serial task asks, a static copy keeps the table off its stack
+  static alloc_site_t copy[HEAP_MONITOR_MAX_SITES];
+  portENTER_CRITICAL(&sites_lock);
+  memcpy(copy, sites, sizeof(copy));
+  uint32_t allocs = other_allocs;
+  uint32_t bytes = other_bytes;
+  portEXIT_CRITICAL(&sites_lock);
+
+  char buf[128];
+  serial_data_write("HEAP_SITES {\"sites\":[", 21);
+  for (int reported = 0; reported < SITES_REPORTED; reported++)
+  {
+    // Heaviest by bytes first
+    int best = -1;
+    for (int i = 0; i < HEAP_MONITOR_MAX_SITES; i++)
+    {
+      if (copy[i].pc && (best < 0 || copy[i].bytes > copy[best].bytes))
+        best = i;
+    }
+    if (best < 0)
+      break;
+    int len = snprintf(buf, sizeof(buf), "%s{\"pc\":\"0x%08lx\",\"caller\":\"0x%08lx\",\"allocs\":%lu,\"bytes\":%lu}",
+                       reported ? "," : "", (unsigned long)copy[best].pc, (unsigned long)copy[best].caller,
+                       (unsigned long)copy[best].allocs, (unsigned long)copy[best].bytes);
+    serial_data_write(buf, len);
+    copy[best].pc = 0;
+  }
+  int len = snprintf(buf, sizeof(buf), "],\"other\":{\"allocs\":%lu,\"bytes\":%lu}}\n", (unsigned long)allocs,
+                     (unsigned long)bytes);
+  serial_data_write(buf, len);
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t heap_monitor_start(void)
+{
+#if CONFIG_HEAP_MONITOR
+  if (sample_timer)
+  {
+    return ESP_OK;
+  }
+
+  esp_err_t ret = heap_caps_register_failed_alloc_callback(failed_alloc_callback);
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = sample_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "heap_monitor",
+  };
+  ret = esp_timer_create(&timer_args, &sample_timer);
+  if (ret == ESP_OK)
+  {
+    ret = esp_timer_start_periodic(sample_timer, (uint64_t)HEAP_MONITOR_PERIOD_S * 1000000);
+  }
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Heap monitor timer failed: %s", esp_err_to_name(ret));
+    if (sample_timer)
+    {
+      esp_timer_delete(sample_timer);
+      sample_timer = NULL;
+    }
+    return ret;
+  }
+
+  // First figures right away rather than one period in
+  sample_timer_cb(NULL);
+  debug_log_info(DEBUG_TAG_SYSTEM, "Heap monitor started");
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t heap_monitor_get_stats(heap_region_t region, heap_region_stats_t *stats)
+{
+  if (region >= HEAP_REGION_COUNT || !stats)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_HEAP_MONITOR
+  portENTER_CRITICAL(&stats_lock);
+  bool have = sampled;
+  *stats = region_stats[region];
+  portEXIT_CRITICAL(&stats_lock);
+  return have ? ESP_OK : ESP_ERR_INVALID_STATE;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool heap_monitor_handle_command(const char *line)
+{
+  bool is_stats = strcmp(line, "GET_HEAP_STATS") == 0;
+  bool is_sites = strcmp(line, "HEAP_SITES") == 0;
+  bool is_reset = strcmp(line, "HEAP_SITES_RESET") == 0;
+  if (!is_stats && !is_sites && !is_reset)
+  {
+    return false;
+  }
+
+  if (is_stats)
+  {
+#if CONFIG_HEAP_MONITOR
+    reply_stats();
+#else
+    static const char disabled[] = "HEAP_STATS {\"error\":\"disabled\"}\n";
+    serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+    return true;
+  }
+
+#if CONFIG_HEAP_MONITOR_ALLOC_SITES
+  if (is_reset)
+  {
+    portENTER_CRITICAL(&sites_lock);
+    memset(sites, 0, sizeof(sites));
+    other_allocs = 0;
+    other_bytes = 0;
+    portEXIT_CRITICAL(&sites_lock);
+    static const char ok[] = "HEAP_SITES {\"ok\":true}\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+  }
+  else
+  {
+    reply_sites();
+  }
+#else
+  static const char disabled[] = "HEAP_SITES {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
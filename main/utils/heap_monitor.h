@@ -0,0 +1,116 @@
+/**
+ * @file heap_monitor.h
+ * @brief Heap fragmentation monitor and allocation-site histogram
+ *
+ * Samples heap_caps_get_info() for the internal, PSRAM and DMA-capable
+ * heaps on a periodic esp_timer: free bytes, largest free block,
+ * fragmentation (how much of the free memory is not in the largest
+ * block), the all-time minimum, and the drift of free memory per hour
+ * once the system has settled. Rising fragmentation is logged before an
+ * allocation of a usual size starts to fail; allocations that do fail
+ * are counted with their size and caps.
+ *
+ * Debug builds with CONFIG_HEAP_USE_HOOKS can also count allocations per
+ * call site (a return address, resolve with addr2line). GET_HEAP_STATS
+ * and HEAP_SITES read it all over serial.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Sample period */
+#ifdef CONFIG_HEAP_MONITOR_PERIOD_S
+#define HEAP_MONITOR_PERIOD_S CONFIG_HEAP_MONITOR_PERIOD_S
+#else
+#define HEAP_MONITOR_PERIOD_S 10
+#endif
+
+  /** Fragmentation at which a heap is reported, re-armed 10 points lower */
+#ifdef CONFIG_HEAP_MONITOR_FRAG_WARN_PCT
+#define HEAP_MONITOR_FRAG_WARN_PCT CONFIG_HEAP_MONITOR_FRAG_WARN_PCT
+#else
+#define HEAP_MONITOR_FRAG_WARN_PCT 70
+#endif
+
+  /** Free memory below this is too little to judge fragmentation by */
+#define HEAP_MONITOR_FRAG_MIN_FREE 16384
+
+  /** Boot allocations are done by then, the drift is measured from there */
+#define HEAP_MONITOR_SETTLE_S 300
+
+  /** Call sites counted, later new ones are lumped together */
+#define HEAP_MONITOR_MAX_SITES 64
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    HEAP_REGION_INTERNAL = 0,
+    HEAP_REGION_SPIRAM,
+    HEAP_REGION_DMA,
+    HEAP_REGION_COUNT
+  } heap_region_t;
+
+  /**
+   * @brief Latest figures of one heap
+   */
+  typedef struct
+  {
+    size_t total;
+    size_t free;
+    size_t largest_free;
+    size_t min_free;        ///< Lowest free since boot
+    size_t min_largest;     ///< Smallest largest free block seen since boot
+    uint32_t alloc_blocks;
+    uint32_t free_blocks;
+    uint8_t frag_pct;       ///< 100 - largest free block * 100 / free
+    int32_t drift_per_hour; ///< Change of free bytes per hour since settling, negative is creep
+  } heap_region_stats_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start sampling and register the failed allocation callback
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t heap_monitor_start(void);
+
+  /**
+   * @brief Get the latest figures of a heap
+   * @return ESP_OK, ESP_ERR_INVALID_STATE before the first sample, ESP_ERR_INVALID_ARG for a bad region
+   */
+  esp_err_t heap_monitor_get_stats(heap_region_t region, heap_region_stats_t *stats);
+
+  /**
+   * @brief Handle GET_HEAP_STATS, HEAP_SITES and HEAP_SITES_RESET
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a heap monitor command
+   */
+  bool heap_monitor_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,325 @@
+/**
+ * @file http_inflate.c
+ * @brief Streaming gzip/deflate decoder for HTTP response bodies
+ *
+ * The gzip header and trailer are parsed as a small state machine around
+ * the tinfl decoder in ROM, the same one delta_patch.c uses, so any of
+ * them may be split across chunks. Decoded bytes go to the sink straight
+ * out of the 32 KB window.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "http_inflate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "rom/miniz.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define GZIP_HEADER_SIZE 10
+#define GZIP_TRAILER_SIZE 8
+
+// gzip header flags, RFC 1952
+#define GZIP_FHCRC 0x02
+#define GZIP_FEXTRA 0x04
+#define GZIP_FNAME 0x08
+#define GZIP_FCOMMENT 0x10
+
+typedef enum
+{
+  STAGE_DEFLATE_DETECT, ///< Collecting two bytes to tell zlib from raw deflate
+  STAGE_GZIP_HEADER,    ///< Collecting the fixed gzip header
+  STAGE_GZIP_EXTRA_LEN, ///< Collecting the length of the extra field
+  STAGE_GZIP_SKIP,      ///< Skipping the extra field or the header CRC
+  STAGE_GZIP_NAME,      ///< Skipping a zero-terminated file name
+  STAGE_GZIP_COMMENT,   ///< Skipping a zero-terminated comment
+  STAGE_BODY,
+  STAGE_GZIP_TRAILER, ///< Collecting CRC32 and length
+  STAGE_END,
+} inflate_stage_t;
+
+struct http_inflate
+{
+  tinfl_decompressor inflator;
+  uint8_t window[TINFL_LZ_DICT_SIZE]; ///< Decoded output, also the back-reference window
+  size_t window_pos;
+  tinfl_status status;
+  uint32_t tinfl_flags;
+
+  inflate_stage_t stage;
+  bool gzip;
+  uint8_t gzip_flags;              ///< Optional header fields still to skip
+  uint8_t pending[GZIP_HEADER_SIZE]; ///< Partial header or trailer
+  size_t pending_len;
+  uint32_t skip; ///< Bytes left in STAGE_GZIP_SKIP
+
+  uint32_t crc;   ///< CRC32 of the decoded bytes, gzip only
+  size_t out_len; ///< Decoded bytes
+
+  http_inflate_sink_fn sink;
+  void *ctx;
+  esp_err_t error; ///< Sticky, the first error
+};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Move bytes into pending until it holds want of them
+ * @return true once it does
+ */
+static bool collect(http_inflate_t *z, const uint8_t **data, size_t *len, size_t want)
+{
+  size_t n = want - z->pending_len;
+  n = n < *len ? n : *len;
+  memcpy(z->pending + z->pending_len, *data, n);
+  z->pending_len += n;
+  *data += n;
+  *len -= n;
+  return z->pending_len == want;
+}
+
+/**
+ * @brief Stage after the fixed header or an optional field, in RFC 1952 order
+ */
+static inflate_stage_t next_gzip_stage(http_inflate_t *z)
+{
+  z->pending_len = 0;
+  if (z->gzip_flags & GZIP_FEXTRA)
+  {
+    z->gzip_flags &= ~GZIP_FEXTRA;
+    return STAGE_GZIP_EXTRA_LEN;
+  }
+  if (z->gzip_flags & GZIP_FNAME)
+  {
+    z->gzip_flags &= ~GZIP_FNAME;
+    return STAGE_GZIP_NAME;
+  }
+  if (z->gzip_flags & GZIP_FCOMMENT)
+  {
+    z->gzip_flags &= ~GZIP_FCOMMENT;
+    return STAGE_GZIP_COMMENT;
+  }
+  if (z->gzip_flags & GZIP_FHCRC)
+  {
+    z->gzip_flags &= ~GZIP_FHCRC;
+    z->skip = 2;
+    return STAGE_GZIP_SKIP;
+  }
+  return STAGE_BODY;
+}
+
+static esp_err_t check_trailer(http_inflate_t *z)
+{
+  z->stage = STAGE_END;
+  // ISIZE is the length modulo 2^32
+  if (get_u32(z->pending) != z->crc || get_u32(z->pending + 4) != (uint32_t)z->out_len)
+    return ESP_ERR_INVALID_CRC;
+  return ESP_OK;
+}
+
+/**
+ * @brief Take back the whole bytes tinfl read ahead past the end of a raw deflate stream
+ *
+ * They are the start of the gzip trailer. The bit buffer holds them low
+ * byte first, above the unused bits of the last deflate byte.
+ */
+static void reclaim_lookahead(http_inflate_t *z)
+{
+  uint32_t bits = z->inflator.m_num_bits;
+  tinfl_bit_buf_t buf = z->inflator.m_bit_buf >> (bits & 7);
+  for (bits >>= 3; bits > 0 && z->pending_len < GZIP_TRAILER_SIZE; bits--)
+  {
+    z->pending[z->pending_len++] = (uint8_t)buf;
+    buf >>= 8;
+  }
+}
+
+static esp_err_t inflate_body(http_inflate_t *z, const uint8_t *data, size_t len, size_t *used)
+{
+  *used = 0;
+  do
+  {
+    size_t in_bytes = len - *used;
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - z->window_pos;
+    z->status = tinfl_decompress(&z->inflator, data + *used, &in_bytes, z->window, z->window + z->window_pos,
+                                 &out_bytes, z->tinfl_flags | TINFL_FLAG_HAS_MORE_INPUT);
+    if (z->status < 0)
+      return ESP_ERR_INVALID_RESPONSE;
+    *used += in_bytes;
+
+    if (out_bytes > 0)
+    {
+      const uint8_t *out = z->window + z->window_pos;
+      if (z->gzip)
+        z->crc = esp_rom_crc32_le(z->crc, out, out_bytes);
+      z->out_len += out_bytes;
+      esp_err_t err = z->sink(z->ctx, (const char *)out, out_bytes);
+      if (err != ESP_OK)
+        return err;
+      z->window_pos = (z->window_pos + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+    }
+  } while (z->status == TINFL_STATUS_HAS_MORE_OUTPUT || (z->status == TINFL_STATUS_NEEDS_MORE_INPUT && *used < len));
+
+  if (z->status != TINFL_STATUS_DONE)
+    return ESP_OK;
+
+  if (!z->gzip)
+  {
+    z->stage = STAGE_END;
+    return ESP_OK;
+  }
+  z->stage = STAGE_GZIP_TRAILER;
+  z->pending_len = 0;
+  reclaim_lookahead(z);
+  return z->pending_len == GZIP_TRAILER_SIZE ? check_trailer(z) : ESP_OK;
+}
+
+static esp_err_t feed_step(http_inflate_t *z, const uint8_t **data, size_t *len)
+{
+  size_t used;
+  esp_err_t err;
+
+  switch (z->stage)
+  {
+  case STAGE_DEFLATE_DETECT:
+    if (!collect(z, data, len, 2))
+      return ESP_OK;
+    // zlib: method 8, window up to 32 KB, header check a multiple of 31
+    if ((z->pending[0] & 0x0F) == 8 && (z->pending[0] >> 4) <= 7 && ((z->pending[0] << 8) | z->pending[1]) % 31 == 0)
+      z->tinfl_flags = TINFL_FLAG_PARSE_ZLIB_HEADER;
+    z->stage = STAGE_BODY;
+    z->pending_len = 0;
+    return inflate_body(z, z->pending, 2, &used);
+
+  case STAGE_GZIP_HEADER:
+    if (!collect(z, data, len, GZIP_HEADER_SIZE))
+      return ESP_OK;
+    if (z->pending[0] != 0x1F || z->pending[1] != 0x8B || z->pending[2] != 8)
+      return ESP_ERR_INVALID_RESPONSE;
+    z->gzip_flags = z->pending[3];
+    z->stage = next_gzip_stage(z);
+    return ESP_OK;
+
+  case STAGE_GZIP_EXTRA_LEN:
+    if (!collect(z, data, len, 2))
+      return ESP_OK;
+    z->skip = (uint32_t)z->pending[0] | (uint32_t)z->pending[1] << 8;
+    z->stage = z->skip ? STAGE_GZIP_SKIP : next_gzip_stage(z);
+    z->pending_len = 0;
+    return ESP_OK;
+
+  case STAGE_GZIP_SKIP:
+  {
+    size_t n = z->skip < *len ? z->skip : *len;
+    *data += n;
+    *len -= n;
+    z->skip -= n;
+    if (z->skip == 0)
+      z->stage = next_gzip_stage(z);
+    return ESP_OK;
+  }
+
+  case STAGE_GZIP_NAME:
+  case STAGE_GZIP_COMMENT:
+  {
+    const uint8_t *end = memchr(*data, 0, *len);
+    size_t n = end ? (size_t)(end - *data) + 1 : *len;
+    *data += n;
+    *len -= n;
+    if (end)
+      z->stage = next_gzip_stage(z);
+    return ESP_OK;
+  }
+
+  case STAGE_BODY:
+    err = inflate_body(z, *data, *len, &used);
+    *data += used;
+    *len -= used;
+    return err;
+
+  case STAGE_GZIP_TRAILER:
+    if (!collect(z, data, len, GZIP_TRAILER_SIZE))
+      return ESP_OK;
+    return check_trailer(z);
+
+  default:
+    // Bytes after the end of the stream
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+http_inflate_encoding_t http_inflate_encoding(const char *content_encoding)
+{
+  if (!content_encoding)
+    return HTTP_INFLATE_IDENTITY;
+  while (*content_encoding == ' ')
+    content_encoding++;
+  if (strcasecmp(content_encoding, "gzip") == 0 || strcasecmp(content_encoding, "x-gzip") == 0)
+    return HTTP_INFLATE_GZIP;
+  if (strcasecmp(content_encoding, "deflate") == 0)
+    return HTTP_INFLATE_DEFLATE;
+  return HTTP_INFLATE_IDENTITY;
+}
+
+http_inflate_t *http_inflate_begin(http_inflate_encoding_t encoding, http_inflate_sink_fn sink, void *ctx)
+{
+  if (encoding == HTTP_INFLATE_IDENTITY || !sink)
+    return NULL;
+
+  http_inflate_t *z = heap_caps_calloc(1, sizeof(*z), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!z)
+    return NULL;
+  tinfl_init(&z->inflator);
+  z->status = TINFL_STATUS_NEEDS_MORE_INPUT;
+  z->gzip = encoding == HTTP_INFLATE_GZIP;
+  z->stage = z->gzip ? STAGE_GZIP_HEADER : STAGE_DEFLATE_DETECT;
+  z->sink = sink;
+  z->ctx = ctx;
+  return z;
+}
+
+esp_err_t http_inflate_feed(http_inflate_t *z, const void *data, size_t len)
+{
+  const uint8_t *bytes = data;
+  while (len > 0 && z->error == ESP_OK)
+  {
+    z->error = feed_step(z, &bytes, &len);
+  }
+  return z->error;
+}
+
+esp_err_t http_inflate_finish(http_inflate_t *z, size_t *out_len)
+{
+  if (out_len)
+    *out_len = z->out_len;
+  if (z->error != ESP_OK)
+    return z->error;
+  if (z->stage != STAGE_END)
+    z->error = ESP_ERR_INVALID_SIZE;
+  return z->error;
+}
+
+void http_inflate_free(http_inflate_t *z)
+{
+  heap_caps_free(z);
+}
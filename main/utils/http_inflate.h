@@ -0,0 +1,86 @@
+/**
+ * @file http_inflate.h
+ * @brief Streaming gzip/deflate decoder for HTTP response bodies
+ *
+ * Decodes a Content-Encoding: gzip or deflate body chunk by chunk as it
+ * arrives and hands the plain bytes to a sink, so a compressed response
+ * never exists in RAM in full, compressed or not. The only buffer is the
+ * 32 KB back-reference window the inflater needs anyway.
+ *
+ * gzip members are checked against their CRC32 and length trailer, zlib
+ * streams against their Adler-32. "deflate" is accepted both zlib wrapped,
+ * as RFC 9110 says, and raw, as some servers send it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef HTTP_INFLATE_H
+#define HTTP_INFLATE_H
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    HTTP_INFLATE_IDENTITY = 0, ///< Not encoded, or an encoding this decoder does not know
+    HTTP_INFLATE_GZIP,
+    HTTP_INFLATE_DEFLATE,
+  } http_inflate_encoding_t;
+
+  typedef struct http_inflate http_inflate_t;
+
+  /** Receives decoded bytes, an error stops the stream and is returned by the feed */
+  typedef esp_err_t (*http_inflate_sink_fn)(void *ctx, const char *data, size_t len);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Map a Content-Encoding header value to a decoder
+   * @param content_encoding Header value, case is ignored
+   */
+  http_inflate_encoding_t http_inflate_encoding(const char *content_encoding);
+
+  /**
+   * @brief Start decoding one response body
+   * @param encoding HTTP_INFLATE_GZIP or HTTP_INFLATE_DEFLATE
+   * @return Decoder in PSRAM (about 43 KB), NULL on a bad encoding or out of memory
+   */
+  http_inflate_t *http_inflate_begin(http_inflate_encoding_t encoding, http_inflate_sink_fn sink, void *ctx);
+
+  /**
+   * @brief Decode the next piece of the body, any size, any split
+   * @return ESP_OK, ESP_ERR_INVALID_RESPONSE on corrupt data or bytes past the end,
+   *         or the sink's error; errors are sticky
+   */
+  esp_err_t http_inflate_feed(http_inflate_t *z, const void *data, size_t len);
+
+  /**
+   * @brief Check that the body ended where the stream did
+   * @param out_len Decoded bytes, may be NULL
+   * @return ESP_OK, ESP_ERR_INVALID_SIZE if the body was cut short,
+   *         ESP_ERR_INVALID_CRC if the gzip trailer does not match, or the first feed error
+   */
+  esp_err_t http_inflate_finish(http_inflate_t *z, size_t *out_len);
+
+  /**
+   * @brief Free a decoder, NULL is ignored
+   */
+  void http_inflate_free(http_inflate_t *z);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_INFLATE_H
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 IRAM Report
+====================
+
+Prints how much internal RAM the code in IRAM takes and how much is left,
+from the linker map of a build. The top-level CMakeLists.txt runs it after
+every link, so a change that moves code into IRAM (main/linker.lf,
+IRAM_ATTR) shows its cost right away.
+
+On the ESP32-S3 IRAM and DRAM share one SRAM, DRAM starts where IRAM ends,
+so the headroom for more IRAM code is whatever DRAM leaves free. Lists
+the functions of main and LVGL placed in IRAM with their sizes.
+
+Usage:
+    python iram_report.py build/ESP32-8048S050-Fancy-Board.map
+    python iram_report.py build/app.map --min-free 16384
+"""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+SEGMENT_RE = re.compile(r"^(\w+)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)")
+OUTPUT_RE = re.compile(r"^(\.\S+)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)")
+INPUT_RE = re.compile(r"^ (\.\S+)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S+)")
+ADDR_RE = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S+)")
+SYMBOL_RE = re.compile(r"^\s+0x[0-9a-fA-F]+\s+([A-Za-z_]\w*)$")
+
+# Archives whose IRAM functions are listed one by one
+LISTED_ARCHIVES = ("libmain.a", "liblvgl__lvgl.a")
+
+
+def parse_map(path: str):
+    """Return segments {name: (origin, length)}, output sections and IRAM input sections."""
+    segments = {}
+    outputs = []
+    iram_inputs = defaultdict(int)
+    in_memory_config = False
+    current_output = None
+    pending_input = None
+    unnamed = None  # IRAM_ATTR input section (.iram1.N) waiting for its symbol line
+
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for raw in f:
+            line = raw.rstrip("\n")
+            if line.startswith("Memory Configuration"):
+                in_memory_config = True
+                continue
+            if in_memory_config:
+                if line.startswith("Linker script and memory map"):
+                    in_memory_config = False
+                    continue
+                m = SEGMENT_RE.match(line)
+                if m and m.group(1) != "Name":
+                    segments[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+
+            m = OUTPUT_RE.match(line)
+            if m:
+                current_output = m.group(1)
+                outputs.append((current_output, int(m.group(2), 16), int(m.group(3), 16)))
+                pending_input = None
+                continue
+            if line.startswith(".") and " " not in line.strip():
+                # Long output section name, address and size follow on the next line
+                current_output = line.strip()
+                pending_input = None
+                continue
+
+            if not current_output or not current_output.startswith(".iram0.text"):
+                continue
+            m = SYMBOL_RE.match(line)
+            if m:
+                if unnamed:
+                    archive, obj, size = unnamed
+                    iram_inputs[(archive, obj, m.group(1))] += size
+                    unnamed = None
+                continue
+            m = INPUT_RE.match(line)
+            if m:
+                section, size, obj = m.group(1), int(m.group(3), 16), m.group(4)
+            elif pending_input:
+                m = ADDR_RE.match(line)
+                if not m:
+                    pending_input = None
+                    continue
+                section, size, obj = pending_input, int(m.group(2), 16), m.group(3)
+            else:
+                stripped = line.strip()
+                pending_input = stripped if line.startswith(" .") and " " not in stripped else None
+                continue
+            pending_input = None
+            archive = next((a for a in LISTED_ARCHIVES if a + "(" in obj), None)
+            unnamed = None
+            if archive and size:
+                obj = obj.split("(")[-1].rstrip(")")
+                if re.match(r"^\.iram1\.\d+$", section):
+                    unnamed = (archive, obj, size)
+                    continue
+                symbol = re.sub(r"^\.(literal|text|iram1)\.", "", section)
+                iram_inputs[(archive, obj, symbol)] += size
+
+    return segments, outputs, iram_inputs
+
+
+def segment_use(segments, outputs, name: str):
+    """Bytes used and left in a segment, None if the map has no such segment."""
+    if name not in segments:
+        return None
+    origin, length = segments[name]
+    end = origin
+    for _, addr, size in outputs:
+        if origin <= addr < origin + length and size:
+            end = max(end, addr + size)
+    return end - origin, origin + length - end
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Report IRAM use and headroom from a linker map")
+    parser.add_argument("map", help="Linker map of the build (build/<project>.map)")
+    parser.add_argument("--min-free", type=int, default=8192, help="Warn below this many free bytes")
+    parser.add_argument("--top", type=int, default=20, help="IRAM functions of main and LVGL to list")
+    args = parser.parse_args()
+
+    try:
+        segments, outputs, iram_inputs = parse_map(args.map)
+    except OSError as e:
+        print(f"iram_report: {e}", file=sys.stderr)
+        return 0  # Never fail the build over the report
+
+    iram = segment_use(segments, outputs, "iram0_0_seg")
+    dram = segment_use(segments, outputs, "dram0_0_seg")
+    if iram is None or dram is None:
+        print("iram_report: no iram0_0_seg/dram0_0_seg in the map", file=sys.stderr)
+        return 0
+
+    # DRAM begins where IRAM ends, so what DRAM leaves is what IRAM can still grow by
+    headroom = dram[1]
+    print(f"IRAM used {iram[0]} bytes, shared SRAM free {headroom} bytes (DRAM used {dram[0]})")
+
+    if iram_inputs:
+        listed = sorted(iram_inputs.items(), key=lambda item: -item[1])
+        total = sum(size for _, size in listed)
+        print(f"IRAM code of main and LVGL: {total} bytes")
+        for (archive, obj, symbol), size in listed[: args.top]:
+            print(f"  {size:6d}  {archive}:{obj}  {symbol}")
+
+    if headroom < args.min_free:
+        print(f"WARNING: IRAM headroom {headroom} bytes is below {args.min_free}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,181 @@
+/**
+ * @file json_arena.c
+ * @brief Bump arenas in PSRAM for cJSON trees
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "json_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+#define JSON_ARENA_COUNT (JSON_ARENA_SMALL_COUNT + JSON_ARENA_LARGE_COUNT)
+
+/** Every block starts on this boundary, enough for the doubles in cJSON nodes */
+#define JSON_ARENA_ALIGN 8
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+struct json_arena
+{
+  char *base;
+  size_t size;
+  size_t used;                 ///< Only touched by the owner
+  size_t high_water;           ///< Most bytes a scope ever used
+  TaskHandle_t volatile owner; ///< Task the arena serves, NULL while free
+  bool overflowed;             ///< A scope ran out and fell back to the heap
+  bool overflow_logged;
+};
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Smallest first, so json_arena_begin() takes the first free one that fits
+static json_arena_t arenas[JSON_ARENA_COUNT];
+static portMUX_TYPE arenas_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool hooks_installed = false;
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static void *arena_malloc(size_t size)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < JSON_ARENA_COUNT; i++)
+  {
+    json_arena_t *arena = &arenas[i];
+    if (arena->owner != self)
+      continue;
+
+    size_t aligned = (size + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+    if (aligned <= arena->size - arena->used)
+    {
+      void *block = arena->base + arena->used;
+      arena->used += aligned;
+      return block;
+    }
+    arena->overflowed = true;
+    break;
+  }
+  return malloc(size);
+}
+
+static void arena_free(void *block)
+{
+  if (!block)
+    return;
+
+  // Arena memory goes back all at once in json_arena_end()
+  for (int i = 0; i < JSON_ARENA_COUNT; i++)
+  {
+    const char *base = arenas[i].base;
+    if (base && (const char *)block >= base && (const char *)block < base + arenas[i].size)
+      return;
+  }
+  free(block);
+}
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t json_arena_init(void)
+{
+  if (hooks_installed)
+    return ESP_OK;
+
+  int allocated = 0;
+  for (int i = 0; i < JSON_ARENA_COUNT; i++)
+  {
+    json_arena_t *arena = &arenas[i];
+    arena->size = (i < JSON_ARENA_SMALL_COUNT) ? JSON_ARENA_SMALL_SIZE : JSON_ARENA_LARGE_SIZE;
+    arena->base = heap_caps_malloc(arena->size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!arena->base)
+    {
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "Could not allocate %zu byte JSON arena", arena->size);
+      arena->size = 0;
+      continue;
+    }
+    allocated++;
+  }
+  if (allocated == 0)
+    return ESP_ERR_NO_MEM;
+
+  cJSON_Hooks hooks = {.malloc_fn = arena_malloc, .free_fn = arena_free};
+  cJSON_InitHooks(&hooks);
+  hooks_installed = true;
+
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "JSON arenas ready: %d of %d", allocated, JSON_ARENA_COUNT);
+  return ESP_OK;
+}
+
+json_arena_t *json_arena_begin(size_t json_len)
+{
+  if (!hooks_installed)
+    return NULL;
+
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  size_t needed = json_len * JSON_ARENA_TREE_FACTOR;
+  json_arena_t *chosen = NULL;
+
+  portENTER_CRITICAL(&arenas_lock);
+  for (int i = 0; i < JSON_ARENA_COUNT; i++)
+  {
+    if (arenas[i].owner == self)
+    {
+      // Nested scope, the outer arena keeps serving
+      chosen = NULL;
+      break;
+    }
+    if (!chosen && arenas[i].base && arenas[i].owner == NULL && arenas[i].size >= needed)
+    {
+      chosen = &arenas[i];
+    }
+  }
+  if (chosen)
+  {
+    chosen->used = 0;
+    chosen->overflowed = false;
+    chosen->owner = self;
+  }
+  portEXIT_CRITICAL(&arenas_lock);
+
+  return chosen;
+}
+
+void json_arena_end(json_arena_t *arena)
+{
+  if (!arena)
+    return;
+
+  bool log_overflow = arena->overflowed && !arena->overflow_logged;
+  if (arena->used > arena->high_water)
+    arena->high_water = arena->used;
+
+  portENTER_CRITICAL(&arenas_lock);
+  arena->overflow_logged = arena->overflow_logged || log_overflow;
+  arena->used = 0;
+  arena->owner = NULL;
+  portEXIT_CRITICAL(&arenas_lock);
+
+  if (log_overflow)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "%zu byte JSON arena overflowed, rest of the tree went to the heap",
+                        arena->size);
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file json_arena.h
+ * @brief Bump arenas in PSRAM for cJSON trees
+ *
+ * cJSON allocates every node and string separately, so a large document
+ * costs thousands of small allocations, and CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL
+ * puts them all in internal RAM. Between json_arena_begin() and
+ * json_arena_end() the calling task's cJSON allocations are carved out of a
+ * preallocated PSRAM arena instead. cJSON_free() of arena memory does
+ * nothing; the whole arena is reset at once by json_arena_end().
+ *
+ * Nothing allocated inside a scope may outlive it: copy values out before
+ * json_arena_end(), and release printed strings with cJSON_free().
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Arena bytes reserved per byte of JSON text, a cJSON tree is about three times its text */
+#define JSON_ARENA_TREE_FACTOR 4
+
+  /** Arena grades: single states, templates, events and telemetry; full /api/states */
+#define JSON_ARENA_SMALL_SIZE (16 * 1024)
+#define JSON_ARENA_SMALL_COUNT 4
+#define JSON_ARENA_LARGE_SIZE (256 * 1024)
+#define JSON_ARENA_LARGE_COUNT 1
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /** Arena bound to a task, opaque */
+  typedef struct json_arena json_arena_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Preallocate the arenas and install the cJSON hooks
+   * @return ESP_OK on success, ESP_ERR_NO_MEM if no arena could be allocated
+   * @note Call once at startup, before any task uses cJSON
+   */
+  esp_err_t json_arena_init(void);
+
+  /**
+   * @brief Route the calling task's cJSON allocations into a free arena
+   * @param json_len Length of the text about to be parsed
+   * @return Arena, NULL if none fits or all are taken (cJSON then uses the heap)
+   */
+  json_arena_t *json_arena_begin(size_t json_len);
+
+  /**
+   * @brief Release the arena and reset it in one go
+   * @param arena Value returned by json_arena_begin(), NULL is ignored
+   */
+  void json_arena_end(json_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_ARENA_H
@@ -0,0 +1,379 @@
+/**
+ * @file mem_governor.c
+ * @brief Memory pressure levels and feature shedding
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "mem_governor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+static const char *const level_names[MEM_PRESSURE_COUNT] = {"normal", "elevated", "high", "critical"};
+
+#if CONFIG_MEM_GOVERNOR
+typedef struct
+{
+  const char *name;
+  uint32_t caps;
+  size_t elevated_below; ///< Free bytes, halved for each further level; a quarter of it for the largest block
+} region_desc_t;
+
+static const region_desc_t region_descs[HEAP_REGION_COUNT] = {
+    [HEAP_REGION_INTERNAL] = {"internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MEM_GOVERNOR_INTERNAL_KB * 1024},
+    [HEAP_REGION_SPIRAM] = {"spiram", MALLOC_CAP_SPIRAM, MEM_GOVERNOR_SPIRAM_KB * 1024},
+    [HEAP_REGION_DMA] = {"dma", MALLOC_CAP_DMA, MEM_GOVERNOR_DMA_KB * 1024},
+};
+
+typedef struct
+{
+  const char *name;
+  uint32_t regions;
+  mem_governor_shed_fn_t fn;
+  void *ctx;
+  mem_pressure_t applied; ///< Level last passed to fn, written by the sample timer only
+} shedder_t;
+
+typedef struct
+{
+  size_t free;
+  size_t largest;
+  mem_pressure_t level;  ///< Measured, before MEM_PRESSURE_FORCE
+  uint8_t clear_samples; ///< Consecutive samples clear of the current level
+  uint32_t failures;     ///< Failed allocations since the last sample
+} region_state_t;
+
+// Written by the sample timer, allocating tasks and the serial task
+static portMUX_TYPE governor_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t sample_timer = NULL;
+static region_state_t region_states[HEAP_REGION_COUNT];
+static mem_pressure_t forced_level = MEM_PRESSURE_NORMAL;
+static uint32_t failed_allocs = 0;
+
+static shedder_t shedders[MEM_GOVERNOR_MAX_SHEDDERS];
+static int shedder_count = 0;
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_MEM_GOVERNOR
+
+/**
+ * @brief Level of a heap's figures
+ * @param clear Judge with thresholds a quarter higher, for stepping down
+ */
+static mem_pressure_t level_of(heap_region_t region, size_t free, size_t largest, bool clear)
+{
+  size_t limit = region_descs[region].elevated_below;
+  if (clear)
+    limit += limit / 4;
+
+  mem_pressure_t level = MEM_PRESSURE_NORMAL;
+  for (int next = MEM_PRESSURE_ELEVATED; next < MEM_PRESSURE_COUNT; next++, limit /= 2)
+  {
+    if (free >= limit && largest >= limit / 4)
+      break;
+    level = next;
+  }
+  return level;
+}
+
+static mem_pressure_t effective_level(uint32_t mask)
+{
+  mem_pressure_t level = forced_level;
+  for (int region = 0; region < HEAP_REGION_COUNT; region++)
+  {
+    if ((mask & MEM_GOVERNOR_REGION(region)) && region_states[region].level > level)
+      level = region_states[region].level;
+  }
+  return level;
+}
+
+static void sample_region(heap_region_t region)
+{
+  uint32_t caps = region_descs[region].caps;
+  // Boards without PSRAM have nothing to judge
+  if (heap_caps_get_total_size(caps) == 0)
+    return;
+  size_t free = heap_caps_get_free_size(caps);
+  size_t largest = heap_caps_get_largest_free_block(caps);
+
+  portENTER_CRITICAL(&governor_lock);
+  region_state_t *state = &region_states[region];
+  mem_pressure_t before = state->level;
+  mem_pressure_t measured = level_of(region, free, largest, false);
+
+  // A failed allocation is pressure the figures may not show, e.g. a block too large for any heap
+  if (state->failures && measured <= before)
+    measured = before < MEM_PRESSURE_CRITICAL ? before + 1 : MEM_PRESSURE_CRITICAL;
+  state->failures = 0;
+
+  if (measured > state->level)
+  {
+    state->level = measured;
+    state->clear_samples = 0;
+  }
+  else if (state->level > MEM_PRESSURE_NORMAL && level_of(region, free, largest, true) < state->level)
+  {
+    if (++state->clear_samples >= MEM_GOVERNOR_CLEAR_SAMPLES)
+    {
+      state->level--;
+      state->clear_samples = 0;
+    }
+  }
+  else
+  {
+    state->clear_samples = 0;
+  }
+  state->free = free;
+  state->largest = largest;
+  mem_pressure_t after = state->level;
+  portEXIT_CRITICAL(&governor_lock);
+
+  if (after > before)
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Memory pressure %s on the %s heap: %u bytes free, largest block %u",
+                        level_names[after], region_descs[region].name, (unsigned)free, (unsigned)largest);
+  else if (after < before)
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Memory pressure %s on the %s heap: %u bytes free", level_names[after],
+                     region_descs[region].name, (unsigned)free);
+}
+
+static void sample_timer_cb(void *arg)
+{
+  (void)arg;
+  for (int region = 0; region < HEAP_REGION_COUNT; region++)
+  {
+    sample_region(region);
+  }
+
+  portENTER_CRITICAL(&governor_lock);
+  int count = shedder_count;
+  portEXIT_CRITICAL(&governor_lock);
+
+  for (int i = 0; i < count; i++)
+  {
+    shedder_t *shedder = &shedders[i];
+    portENTER_CRITICAL(&governor_lock);
+    mem_pressure_t level = effective_level(shedder->regions);
+    portEXIT_CRITICAL(&governor_lock);
+    if (level == shedder->applied)
+      continue;
+
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Shedding %s: %s -> %s", shedder->name, level_names[shedder->applied],
+                     level_names[level]);
+    shedder->applied = level;
+    shedder->fn(level, shedder->ctx);
+  }
+}
+
+static void reply_status(void)
+{
+  region_state_t copy[HEAP_REGION_COUNT];
+  mem_pressure_t applied[MEM_GOVERNOR_MAX_SHEDDERS];
+  portENTER_CRITICAL(&governor_lock);
+  memcpy(copy, region_states, sizeof(copy));
+  mem_pressure_t overall = effective_level(UINT32_MAX);
+  mem_pressure_t forced = forced_level;
+  uint32_t failed = failed_allocs;
+  int count = shedder_count;
+  for (int i = 0; i < count; i++)
+  {
+    applied[i] = shedders[i].applied;
+  }
+  portEXIT_CRITICAL(&governor_lock);
+
+  char buf[192];
+  int len = snprintf(buf, sizeof(buf),
+                     "MEM_PRESSURE {\"level\":\"%s\",\"forced\":\"%s\",\"failed_allocs\":%lu,\"regions\":[",
+                     level_names[overall], level_names[forced], (unsigned long)failed);
+  serial_data_write(buf, len);
+  for (int region = 0; region < HEAP_REGION_COUNT; region++)
+  {
+    len = snprintf(buf, sizeof(buf),
+                   "%s{\"name\":\"%s\",\"level\":\"%s\",\"free\":%u,\"largest\":%u,\"elevated_below\":%u}",
+                   region ? "," : "", region_descs[region].name, level_names[copy[region].level],
+                   (unsigned)copy[region].free, (unsigned)copy[region].largest,
+                   (unsigned)region_descs[region].elevated_below);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("],\"shedders\":[", 14);
+  for (int i = 0; i < count; i++)
+  {
+    len = snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"level\":\"%s\"}", i ? "," : "", shedders[i].name,
+                   level_names[applied[i]]);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+}
+
+static void handle_force(const char *arg)
+{
+  int level = MEM_PRESSURE_COUNT;
+  for (int i = 0; i < MEM_PRESSURE_COUNT; i++)
+  {
+    if (strcmp(arg, level_names[i]) == 0)
+      level = i;
+  }
+  if (level == MEM_PRESSURE_COUNT)
+  {
+    static const char usage[] =
+        "MEM_PRESSURE {\"error\":\"usage: MEM_PRESSURE_FORCE normal|elevated|high|critical\"}\n";
+    serial_data_write(usage, sizeof(usage) - 1);
+    return;
+  }
+
+  portENTER_CRITICAL(&governor_lock);
+  forced_level = level;
+  portEXIT_CRITICAL(&governor_lock);
+
+  // Shedders follow on the next sample, in the timer task like any other change
+  char buf[96];
+  int len = snprintf(buf, sizeof(buf), "MEM_PRESSURE {\"forced\":\"%s\",\"within_ms\":%d}\n", level_names[level],
+                     MEM_GOVERNOR_PERIOD_MS);
+  serial_data_write(buf, len);
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t mem_governor_start(void)
+{
+#if CONFIG_MEM_GOVERNOR
+  if (sample_timer)
+  {
+    return ESP_OK;
+  }
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = sample_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "mem_governor",
+  };
+  esp_err_t ret = esp_timer_create(&timer_args, &sample_timer);
+  if (ret == ESP_OK)
+  {
+    ret = esp_timer_start_periodic(sample_timer, (uint64_t)MEM_GOVERNOR_PERIOD_MS * 1000);
+  }
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Memory governor timer failed: %s", esp_err_to_name(ret));
+    if (sample_timer)
+    {
+      esp_timer_delete(sample_timer);
+      sample_timer = NULL;
+    }
+    return ret;
+  }
+
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Memory governor started, %d shedder(s)", shedder_count);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t mem_governor_register(const char *name, uint32_t regions, mem_governor_shed_fn_t fn, void *ctx)
+{
+  if (!name || !fn || (regions & ((1u << HEAP_REGION_COUNT) - 1)) == 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_MEM_GOVERNOR
+  esp_err_t ret = ESP_OK;
+  portENTER_CRITICAL(&governor_lock);
+  if (shedder_count < MEM_GOVERNOR_MAX_SHEDDERS)
+  {
+    shedders[shedder_count] = (shedder_t){
+        .name = name,
+        .regions = regions,
+        .fn = fn,
+        .ctx = ctx,
+        .applied = MEM_PRESSURE_NORMAL,
+    };
+    shedder_count++;
+  }
+  else
+  {
+    ret = ESP_ERR_NO_MEM;
+  }
+  portEXIT_CRITICAL(&governor_lock);
+  return ret;
+#else
+  (void)ctx;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+mem_pressure_t mem_governor_get_level(uint32_t regions)
+{
+#if CONFIG_MEM_GOVERNOR
+  portENTER_CRITICAL(&governor_lock);
+  mem_pressure_t level = effective_level(regions);
+  portEXIT_CRITICAL(&governor_lock);
+  return level;
+#else
+  (void)regions;
+  return MEM_PRESSURE_NORMAL;
+#endif
+}
+
+void mem_governor_note_alloc_failure(size_t size, uint32_t caps)
+{
+#if CONFIG_MEM_GOVERNOR
+  (void)size;
+  // Default caps may land in either heap, they are counted where most allocations go
+  heap_region_t region = (caps & MALLOC_CAP_SPIRAM) ? HEAP_REGION_SPIRAM : HEAP_REGION_INTERNAL;
+  portENTER_CRITICAL_SAFE(&governor_lock);
+  failed_allocs++;
+  region_states[region].failures++;
+  if (caps & MALLOC_CAP_DMA)
+    region_states[HEAP_REGION_DMA].failures++;
+  portEXIT_CRITICAL_SAFE(&governor_lock);
+#else
+  (void)size;
+  (void)caps;
+#endif
+}
+
+const char *mem_governor_level_name(mem_pressure_t level)
+{
+  return (level >= 0 && level < MEM_PRESSURE_COUNT) ? level_names[level] : "unknown";
+}
+
+bool mem_governor_handle_command(const char *line)
+{
+  static const char force_command[] = "MEM_PRESSURE_FORCE ";
+  bool is_status = strcmp(line, "GET_MEM_PRESSURE") == 0;
+  bool is_force = strncmp(line, force_command, sizeof(force_command) - 1) == 0;
+  if (!is_status && !is_force)
+  {
+    return false;
+  }
+
+#if CONFIG_MEM_GOVERNOR
+  if (is_status)
+    reply_status();
+  else
+    handle_force(line + sizeof(force_command) - 1);
+#else
+  static const char disabled[] = "MEM_PRESSURE {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
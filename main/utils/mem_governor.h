@@ -0,0 +1,149 @@
+/**
+ * @file mem_governor.h
+ * @brief Memory pressure levels and feature shedding
+ *
+ * Samples free bytes and the largest free block of the internal, PSRAM and
+ * DMA-capable heaps and turns them into a pressure level per heap. A level
+ * rises as soon as a heap falls below its threshold, or by one step when an
+ * allocation from it fails, and falls one step at a time once the heap has
+ * been clear of the threshold by a margin for a few samples, so a heap
+ * hovering around a threshold does not flap.
+ *
+ * Subsystems register a shed callback for the heaps they allocate from and
+ * are told each new level, up and down, so they give back what they can
+ * do without (a history ring, cached pages, snapshot buffers) and take it
+ * again once memory is back:
+ *
+ *   ELEVATED  drop caches that are cheap to rebuild
+ *   HIGH      shrink stores, switch to leaner code paths
+ *   CRITICAL  keep only what the panel needs to work
+ *
+ * GET_MEM_PRESSURE reports the levels, MEM_PRESSURE_FORCE <level> holds a
+ * minimum level to try the shedders out, MEM_PRESSURE_FORCE normal ends it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef MEM_GOVERNOR_H
+#define MEM_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "heap_monitor.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Sample period */
+#ifdef CONFIG_MEM_GOVERNOR_PERIOD_MS
+#define MEM_GOVERNOR_PERIOD_MS CONFIG_MEM_GOVERNOR_PERIOD_MS
+#else
+#define MEM_GOVERNOR_PERIOD_MS 2000
+#endif
+
+  /** Internal heap free below which pressure is elevated, HIGH at half, CRITICAL at a quarter */
+#ifdef CONFIG_MEM_GOVERNOR_INTERNAL_KB
+#define MEM_GOVERNOR_INTERNAL_KB CONFIG_MEM_GOVERNOR_INTERNAL_KB
+#else
+#define MEM_GOVERNOR_INTERNAL_KB 48
+#endif
+
+  /** PSRAM free below which pressure is elevated, HIGH at half, CRITICAL at a quarter */
+#ifdef CONFIG_MEM_GOVERNOR_SPIRAM_KB
+#define MEM_GOVERNOR_SPIRAM_KB CONFIG_MEM_GOVERNOR_SPIRAM_KB
+#else
+#define MEM_GOVERNOR_SPIRAM_KB 1024
+#endif
+
+  /** DMA-capable free below which pressure is elevated */
+#define MEM_GOVERNOR_DMA_KB 32
+
+  /** Samples clear of a threshold by a quarter before the level steps down */
+#define MEM_GOVERNOR_CLEAR_SAMPLES 3
+
+  /** Shed callbacks that can be registered */
+#define MEM_GOVERNOR_MAX_SHEDDERS 8
+
+  /** Region mask bit of a heap */
+#define MEM_GOVERNOR_REGION(region) (1u << (region))
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    MEM_PRESSURE_NORMAL = 0,
+    MEM_PRESSURE_ELEVATED,
+    MEM_PRESSURE_HIGH,
+    MEM_PRESSURE_CRITICAL,
+    MEM_PRESSURE_COUNT
+  } mem_pressure_t;
+
+  /**
+   * @brief Shed callback
+   * @param level Highest level of the heaps the callback was registered for
+   * @param ctx Context given at registration
+   * @note Runs in the esp_timer task: free or flag, leave long work to the owner's task
+   */
+  typedef void (*mem_governor_shed_fn_t)(mem_pressure_t level, void *ctx);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start sampling
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t mem_governor_start(void);
+
+  /**
+   * @brief Register a shed callback
+   * @param name Short name for GET_MEM_PRESSURE, must stay valid
+   * @param regions MEM_GOVERNOR_REGION() bits of the heaps the subsystem allocates from
+   * @param fn Callback, called with the current level after the next sample if it is not NORMAL
+   * @param ctx Passed to fn
+   * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM if MEM_GOVERNOR_MAX_SHEDDERS are registered,
+   *         or ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   * @note May be called before mem_governor_start()
+   */
+  esp_err_t mem_governor_register(const char *name, uint32_t regions, mem_governor_shed_fn_t fn, void *ctx);
+
+  /**
+   * @brief Highest pressure level of the heaps in a mask
+   */
+  mem_pressure_t mem_governor_get_level(uint32_t regions);
+
+  /**
+   * @brief Count a failed allocation against the heaps of its caps
+   * @note Safe from any task and with interrupts disabled; called by the heap monitor
+   */
+  void mem_governor_note_alloc_failure(size_t size, uint32_t caps);
+
+  /**
+   * @brief Name of a level as GET_MEM_PRESSURE reports it
+   */
+  const char *mem_governor_level_name(mem_pressure_t level);
+
+  /**
+   * @brief Handle GET_MEM_PRESSURE and MEM_PRESSURE_FORCE
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a memory governor command
+   */
+  bool mem_governor_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_GOVERNOR_H
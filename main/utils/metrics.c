@@ -0,0 +1,299 @@
+/**
+ * @file metrics.c
+ * @brief Runtime metrics registry with Prometheus text export
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Appends take the lock, exports walk the list without it
+static metric_t *registry_head = NULL;
+static metric_t *registry_tail = NULL;
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t read_uptime(const metric_t *metric);
+static int64_t read_heap_free(const metric_t *metric);
+static int64_t read_heap_min_free(const metric_t *metric);
+static int64_t read_heap_largest_block(const metric_t *metric);
+
+static metric_t uptime_metric = METRIC_READ_INIT(METRIC_TYPE_GAUGE, "uptime_seconds",
+                                                 "Time since boot", NULL, read_uptime, 0);
+static metric_t heap_free_metrics[] = {
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_free_bytes", "Free heap", "region=\"internal\"",
+                     read_heap_free, MALLOC_CAP_INTERNAL),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_free_bytes", "Free heap", "region=\"spiram\"",
+                     read_heap_free, MALLOC_CAP_SPIRAM),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_min_free_bytes", "Lowest free heap since boot",
+                     "region=\"internal\"", read_heap_min_free, MALLOC_CAP_INTERNAL),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_min_free_bytes", "Lowest free heap since boot",
+                     "region=\"spiram\"", read_heap_min_free, MALLOC_CAP_SPIRAM),
+    // Falling while free heap holds steady means fragmentation
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_largest_free_block_bytes", "Largest allocatable block",
+                     "region=\"internal\"", read_heap_largest_block, MALLOC_CAP_INTERNAL),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "heap_largest_free_block_bytes", "Largest allocatable block",
+                     "region=\"spiram\"", read_heap_largest_block, MALLOC_CAP_SPIRAM),
+};
+
+static const char *const type_names[] = {
+    [METRIC_TYPE_COUNTER] = "counter",
+    [METRIC_TYPE_GAUGE] = "gauge",
+    [METRIC_TYPE_HISTOGRAM] = "histogram",
+};
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+static int64_t read_uptime(const metric_t *metric)
+{
+  return esp_timer_get_time() / 1000000;
+}
+
+static int64_t read_heap_free(const metric_t *metric)
+{
+  return heap_caps_get_free_size(metric->arg);
+}
+
+static int64_t read_heap_min_free(const metric_t *metric)
+{
+  return heap_caps_get_minimum_free_size(metric->arg);
+}
+
+static int64_t read_heap_largest_block(const metric_t *metric)
+{
+  return heap_caps_get_largest_free_block(metric->arg);
+}
+
+/**
+ * @brief Write "name<suffix>{labels,extra}" into buf
+ * @return Characters written
+ */
+static int format_series(char *buf, size_t size, const metric_t *metric, const char *suffix, const char *extra)
+{
+  const char *labels = metric->labels;
+  int len;
+  if (labels && extra)
+    len = snprintf(buf, size, "%s%s{%s,%s}", metric->name, suffix, labels, extra);
+  else if (labels || extra)
+    len = snprintf(buf, size, "%s%s{%s}", metric->name, suffix, labels ? labels : extra);
+  else
+    len = snprintf(buf, size, "%s%s", metric->name, suffix);
+  return len < (int)size ? len : (int)size - 1;
+}
+
+static void emit_value(metrics_emit_fn_t emit, void *ctx, const metric_t *metric, const char *suffix,
+                       const char *extra, long long value)
+{
+  char line[192];
+  int len = format_series(line, sizeof(line), metric, suffix, extra);
+  len += snprintf(line + len, sizeof(line) - len, " %lld\n", value);
+  emit(ctx, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+}
+
+static void emit_histogram(metrics_emit_fn_t emit, void *ctx, const metric_histogram_t *histogram)
+{
+  // Cumulative as Prometheus wants it, _count is the last bucket so the two always agree
+  uint64_t cumulative = 0;
+  for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+  {
+    cumulative += __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+    char le[32];
+    if (i < METRICS_HISTOGRAM_BUCKETS - 1)
+      snprintf(le, sizeof(le), "le=\"%lu\"", 1UL << (histogram->unit_shift + i));
+    else
+      snprintf(le, sizeof(le), "le=\"+Inf\"");
+    emit_value(emit, ctx, &histogram->base, "_bucket", le, (long long)cumulative);
+  }
+
+  uint64_t sum;
+  metrics_histogram_totals(histogram, NULL, &sum);
+  emit_value(emit, ctx, &histogram->base, "_sum", NULL, (long long)sum);
+  emit_value(emit, ctx, &histogram->base, "_count", NULL, (long long)cumulative);
+}
+
+/**
+ * @brief Write every registered series in Prometheus text format
+ */
+static void export_all(metrics_emit_fn_t emit, void *ctx)
+{
+  const char *previous_name = NULL;
+  for (metric_t *metric = __atomic_load_n(&registry_head, __ATOMIC_ACQUIRE); metric;
+       metric = __atomic_load_n(&metric->next, __ATOMIC_ACQUIRE))
+  {
+    if (!previous_name || strcmp(previous_name, metric->name) != 0)
+    {
+      char line[192];
+      int len = snprintf(line, sizeof(line), "# HELP %s %s\n", metric->name, metric->help ? metric->help : "");
+      emit(ctx, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+      len = snprintf(line, sizeof(line), "# TYPE %s %s\n", metric->name, type_names[metric->type]);
+      emit(ctx, line, len < (int)sizeof(line) ? len : (int)sizeof(line) - 1);
+      previous_name = metric->name;
+    }
+
+    if (metric->type == METRIC_TYPE_HISTOGRAM)
+    {
+      emit_histogram(emit, ctx, (const metric_histogram_t *)metric);
+    }
+    else
+    {
+      emit_value(emit, ctx, metric, "", NULL, metrics_read(metric));
+    }
+  }
+}
+
+static void emit_serial(void *ctx, const char *line, int len)
+{
+  // Prefixed so host tools can strip it and feed the rest to a Prometheus parser
+  char out[208];
+  static const char prefix[] = "METRICS ";
+  if (len > (int)(sizeof(out) - sizeof(prefix)))
+    len = sizeof(out) - sizeof(prefix);
+  memcpy(out, prefix, sizeof(prefix) - 1);
+  memcpy(out + sizeof(prefix) - 1, line, len);
+  serial_data_write(out, sizeof(prefix) - 1 + len);
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+void metrics_init(void)
+{
+  metrics_register(&uptime_metric);
+  for (size_t i = 0; i < sizeof(heap_free_metrics) / sizeof(heap_free_metrics[0]); i++)
+  {
+    metrics_register(&heap_free_metrics[i]);
+  }
+}
+
+void metrics_register(metric_t *metric)
+{
+  if (!metric || !metric->name)
+  {
+    return;
+  }
+
+  portENTER_CRITICAL(&registry_lock);
+  if (!metric->registered)
+  {
+    metric->registered = true;
+    metric->next = NULL;
+    if (registry_tail)
+      __atomic_store_n(&registry_tail->next, metric, __ATOMIC_RELEASE);
+    else
+      __atomic_store_n(&registry_head, metric, __ATOMIC_RELEASE);
+    registry_tail = metric;
+  }
+  portEXIT_CRITICAL(&registry_lock);
+}
+
+void metrics_histogram_observe(metric_histogram_t *histogram, uint32_t value)
+{
+  // Bucket i holds values up to 2^i units
+  uint32_t units = (uint32_t)(((uint64_t)value + (1UL << histogram->unit_shift) - 1) >> histogram->unit_shift);
+  int bucket = units <= 1 ? 0 : 32 - __builtin_clz(units - 1);
+  if (bucket > METRICS_HISTOGRAM_BUCKETS - 1)
+    bucket = METRICS_HISTOGRAM_BUCKETS - 1;
+  __atomic_fetch_add(&histogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+
+  // 64-bit atomics take a lock on this target, carry into a second word instead
+  uint32_t old = __atomic_fetch_add(&histogram->sum_lo, value, __ATOMIC_RELEASE);
+  if (old + value < old)
+    __atomic_fetch_add(&histogram->sum_hi, 1, __ATOMIC_RELEASE);
+}
+
+metric_t *metrics_find(const char *name, const char *labels)
+{
+  if (!name)
+  {
+    return NULL;
+  }
+
+  for (metric_t *metric = __atomic_load_n(&registry_head, __ATOMIC_ACQUIRE); metric;
+       metric = __atomic_load_n(&metric->next, __ATOMIC_ACQUIRE))
+  {
+    if (strcmp(metric->name, name) != 0)
+      continue;
+    if (!labels && !metric->labels)
+      return metric;
+    if (labels && metric->labels && strcmp(labels, metric->labels) == 0)
+      return metric;
+  }
+  return NULL;
+}
+
+int64_t metrics_read(const metric_t *metric)
+{
+  if (!metric)
+  {
+    return 0;
+  }
+
+  if (metric->type == METRIC_TYPE_HISTOGRAM)
+  {
+    uint64_t count;
+    metrics_histogram_totals((const metric_histogram_t *)metric, &count, NULL);
+    return (int64_t)count;
+  }
+  if (metric->read)
+  {
+    return metric->read(metric);
+  }
+
+  uint32_t raw = __atomic_load_n(&metric->value, __ATOMIC_RELAXED);
+  return metric->type == METRIC_TYPE_GAUGE ? (int64_t)(int32_t)raw : (int64_t)raw;
+}
+
+void metrics_histogram_totals(const metric_histogram_t *histogram, uint64_t *count, uint64_t *sum)
+{
+  if (count)
+  {
+    *count = 0;
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+      *count += __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+  }
+
+  if (sum)
+  {
+    // A carry may land between the two loads, read again until sum_hi is stable
+    uint32_t hi, lo;
+    do
+    {
+      hi = __atomic_load_n(&histogram->sum_hi, __ATOMIC_ACQUIRE);
+      lo = __atomic_load_n(&histogram->sum_lo, __ATOMIC_ACQUIRE);
+    } while (hi != __atomic_load_n(&histogram->sum_hi, __ATOMIC_ACQUIRE));
+    *sum = ((uint64_t)hi << 32) | lo;
+  }
+}
+
+void metrics_export(metrics_emit_fn_t emit, void *ctx)
+{
+  export_all(emit, ctx);
+}
+
+bool metrics_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_METRICS") != 0)
+  {
+    return false;
+  }
+
+  export_all(emit_serial, NULL);
+  emit_serial(NULL, "# EOF\n", 6);
+  return true;
+}
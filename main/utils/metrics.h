@@ -0,0 +1,174 @@
+/**
+ * @file metrics.h
+ * @brief Runtime metrics registry with Prometheus text export
+ *
+ * Modules define their counters, gauges and histograms as static metric_t
+ * records and register them once at init. Updates are single relaxed
+ * atomics, so they are safe from any task and never take a lock. Values a
+ * module already keeps elsewhere can be registered with a read function
+ * instead, which is only called at export time.
+ *
+ * Everything registered is exported in Prometheus text format by GET_METRICS
+ * over serial and, with DIAG_HTTP, by GET /metrics for fleet scraping.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Histogram buckets: edges 1, 2, 4 ... 2^14 times the unit, plus +Inf */
+#define METRICS_HISTOGRAM_BUCKETS 16
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    METRIC_TYPE_COUNTER = 0,
+    METRIC_TYPE_GAUGE,
+    METRIC_TYPE_HISTOGRAM,
+  } metric_type_t;
+
+  typedef struct metric metric_t;
+
+  /** Receives one exposition line, newline included */
+  typedef void (*metrics_emit_fn_t)(void *ctx, const char *line, int len);
+
+  /** Reads a value kept outside the registry, called at export time */
+  typedef int64_t (*metric_read_fn_t)(const metric_t *metric);
+
+  /**
+   * @brief One exported series
+   * @note Series sharing a name must be registered one after another
+   */
+  struct metric
+  {
+    const char *name;      ///< Prometheus name, unit suffix included
+    const char *help;      ///< One line for # HELP
+    const char *labels;    ///< Label pairs without braces, e.g. endpoint="states", or NULL
+    metric_type_t type;    ///< Counter, gauge or histogram
+    metric_read_fn_t read; ///< Counter or gauge read at export instead of value
+    uintptr_t arg;         ///< Free for read
+    uint32_t value;        ///< Counter, or gauge as int32_t
+    metric_t *next;        ///< Registry list, set by metrics_register()
+    bool registered;
+  };
+
+  /**
+   * @brief Distribution over fixed log2 buckets
+   */
+  typedef struct
+  {
+    metric_t base;
+    uint8_t unit_shift;                          ///< First bucket edge is 1 << unit_shift, at most 17
+    uint32_t buckets[METRICS_HISTOGRAM_BUCKETS]; ///< Per bucket, not cumulative
+    uint32_t sum_lo;                             ///< Sum of observations, low word
+    uint32_t sum_hi;                             ///< Carries of sum_lo
+  } metric_histogram_t;
+
+  /** Static initialisers */
+#define METRIC_COUNTER_INIT(name_, help_) {.name = (name_), .help = (help_), .type = METRIC_TYPE_COUNTER}
+#define METRIC_GAUGE_INIT(name_, help_) {.name = (name_), .help = (help_), .type = METRIC_TYPE_GAUGE}
+#define METRIC_READ_INIT(type_, name_, help_, labels_, read_, arg_) \
+  {.name = (name_), .help = (help_), .labels = (labels_), .type = (type_), .read = (read_), .arg = (arg_)}
+#define METRIC_HISTOGRAM_INIT(name_, help_, unit_shift_) \
+  {.base = {.name = (name_), .help = (help_), .type = METRIC_TYPE_HISTOGRAM}, .unit_shift = (unit_shift_)}
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Register the built-in system metrics (uptime, free heap)
+   * @note Call early in app_main(), modules may register before or after
+   */
+  void metrics_init(void);
+
+  /**
+   * @brief Add a series to the registry
+   * @param metric Static record, registering it again does nothing
+   */
+  void metrics_register(metric_t *metric);
+
+  /**
+   * @brief Add a histogram to the registry
+   */
+  static inline void metrics_register_histogram(metric_histogram_t *histogram)
+  {
+    metrics_register(&histogram->base);
+  }
+
+  /**
+   * @brief Count events
+   */
+  static inline void metrics_counter_add(metric_t *metric, uint32_t n)
+  {
+    __atomic_fetch_add(&metric->value, n, __ATOMIC_RELAXED);
+  }
+
+  /**
+   * @brief Set a gauge
+   */
+  static inline void metrics_gauge_set(metric_t *metric, int32_t value)
+  {
+    __atomic_store_n(&metric->value, (uint32_t)value, __ATOMIC_RELAXED);
+  }
+
+  /**
+   * @brief Record one observation, in the histogram's unit
+   * @note Safe from any task, no lock
+   */
+  void metrics_histogram_observe(metric_histogram_t *histogram, uint32_t value);
+
+  /**
+   * @brief Look up a registered series
+   * @param name Metric name
+   * @param labels Label pairs exactly as registered, NULL for a series without labels
+   * @return The series, NULL if none matches
+   */
+  metric_t *metrics_find(const char *name, const char *labels);
+
+  /**
+   * @brief Current value of a counter or gauge, observation count of a histogram
+   */
+  int64_t metrics_read(const metric_t *metric);
+
+  /**
+   * @brief Observation count and sum of a histogram
+   */
+  void metrics_histogram_totals(const metric_histogram_t *histogram, uint64_t *count, uint64_t *sum);
+
+  /**
+   * @brief Format every registered series in Prometheus text format
+   * @param emit Receives each line, on the calling task
+   */
+  void metrics_export(metrics_emit_fn_t emit, void *ctx);
+
+  /**
+   * @brief Handle GET_METRICS
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a metrics command
+   */
+  bool metrics_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
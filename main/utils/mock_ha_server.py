@@ -0,0 +1,430 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Mock Home Assistant Server
+===================================
+
+Stands in for Home Assistant to test the dashboard's HA client at scale and
+under bad network conditions:
+1. Serves /api/states with a configurable number of generated entities
+   (100...5000) plus the dashboard's own entities, /api/states/<id> and
+   the /api/template request the dashboard sends
+2. Accepts service calls and events, switching the mock state so later
+   syncs see the change
+3. Injects latency and jitter, throttles the body, truncates or drops
+   responses and answers with HTTP 500 at configurable rates; with
+   --compress, compresses bodies for clients that accept it, as HA does
+4. Logs every request with its handling time and prints per-endpoint
+   percentiles on exit
+5. Optionally starts HA_LATENCY_TEST on the device and prints its
+   HA_LATENCY reply, the firmware side of the same measurement
+
+Point HA_SERVER_HOST_NAME / HA_SERVER_PORT in smart_config.h at this
+machine. Any token is accepted unless --token is given. There is no
+WebSocket API, so the dashboard falls back to REST polling.
+
+Requirements:
+    pip install pyserial   (only for --device)
+
+Usage:
+    python mock_ha_server.py --entities 5000 --dashboard switch.desk_lamp,light.office
+    python mock_ha_server.py --entities 1000 --latency-ms 200 --jitter-ms 150 --truncate 0.05
+    python mock_ha_server.py --entities 2000 --rate-kbps 256 --drop 0.02 --faults states
+    python mock_ha_server.py --entities 5000 --compress gzip --rate-kbps 256 --truncate 0.05
+    python mock_ha_server.py --entities 500 --device COM3 --test all --syncs 50 --commands 50
+"""
+
+import argparse
+import gzip
+import json
+import random
+import re
+import sys
+import threading
+import time
+import zlib
+from datetime import datetime, timezone
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Dict, List, Optional
+
+DOMAINS = ["sensor", "binary_sensor", "switch", "light", "automation", "input_boolean", "device_tracker", "person"]
+
+# Entity list of the dashboard's template, see STATE_TEMPLATE_HEAD in ha_api.c
+TEMPLATE_ENTITIES = re.compile(r"\{% for e in (\[.*?\]) %\}")
+
+
+def iso_time(timestamp: float) -> str:
+    return datetime.fromtimestamp(timestamp, timezone.utc).isoformat()
+
+
+def percentile(sorted_values: List[float], pct: int) -> float:
+    """Nearest-rank percentile, same definition as the firmware."""
+    rank = max(1, -(-pct * len(sorted_values) // 100))
+    return sorted_values[rank - 1]
+
+
+class MockHomeAssistant:
+    """Entity states and request statistics shared by all handler threads."""
+
+    def __init__(self, count: int, dashboard_ids: List[str], seed: int):
+        self.lock = threading.Lock()
+        self.states: Dict[str, dict] = {}
+        self.timings: Dict[str, List[float]] = {}
+        self.outcomes: Dict[str, Dict[str, int]] = {}
+        rng = random.Random(seed)
+        now = time.time()
+
+        generated = []
+        for i in range(count):
+            domain = DOMAINS[i % len(DOMAINS)]
+            generated.append(self._make_state(f"{domain}.mock_{i:05d}", rng, now))
+
+        # Spread the dashboard's entities through the document, the streaming
+        # parser has to find them anywhere and not just near the start
+        step = max(1, len(generated) // (len(dashboard_ids) + 1))
+        for n, entity_id in enumerate(dashboard_ids):
+            generated.insert(min(len(generated), (n + 1) * step + n), self._make_state(entity_id, rng, now))
+
+        for state in generated:
+            self.states[state["entity_id"]] = state
+
+    @staticmethod
+    def _make_state(entity_id: str, rng: random.Random, now: float) -> dict:
+        domain, name = entity_id.split(".", 1)
+        attributes = {"friendly_name": name.replace("_", " ").title()}
+        if domain == "sensor":
+            state = f"{rng.uniform(0, 100):.2f}"
+            attributes.update({"unit_of_measurement": "°C", "device_class": "temperature", "state_class": "measurement"})
+        elif domain == "light":
+            state = rng.choice(["on", "off"])
+            attributes.update({"supported_color_modes": ["brightness"], "color_mode": "brightness", "brightness": 180})
+        elif domain == "device_tracker" or domain == "person":
+            state = rng.choice(["home", "not_home"])
+            attributes.update({"source_type": "router", "latitude": 52.52, "longitude": 13.40})
+        else:
+            state = rng.choice(["on", "off"])
+        changed = iso_time(now - rng.uniform(0, 86400))
+        return {
+            "entity_id": entity_id,
+            "state": state,
+            "attributes": attributes,
+            "last_changed": changed,
+            "last_reported": changed,
+            "last_updated": changed,
+            "context": {"id": "01J%023X" % rng.getrandbits(64), "parent_id": None, "user_id": None},
+        }
+
+    def set_state(self, entity_id: str, state: str) -> Optional[dict]:
+        with self.lock:
+            entry = self.states.get(entity_id)
+            if entry is None:
+                return None
+            if entry["state"] != state:
+                entry["state"] = state
+                entry["last_changed"] = iso_time(time.time())
+            entry["last_updated"] = iso_time(time.time())
+            return dict(entry)
+
+    def record(self, endpoint: str, outcome: str, elapsed_ms: float) -> None:
+        with self.lock:
+            self.timings.setdefault(endpoint, []).append(elapsed_ms)
+            counts = self.outcomes.setdefault(endpoint, {})
+            counts[outcome] = counts.get(outcome, 0) + 1
+
+    def summary(self) -> str:
+        lines = ["", "Endpoint    Requests   p50 ms   p90 ms   p99 ms   max ms   outcomes"]
+        with self.lock:
+            for endpoint in sorted(self.timings):
+                values = sorted(self.timings[endpoint])
+                outcomes = ", ".join(f"{k}={v}" for k, v in sorted(self.outcomes[endpoint].items()))
+                lines.append(
+                    f"{endpoint:<11} {len(values):>8} {percentile(values, 50):>8.1f} {percentile(values, 90):>8.1f} "
+                    f"{percentile(values, 99):>8.1f} {values[-1]:>8.1f}   {outcomes}"
+                )
+        return "\n".join(lines)
+
+
+def make_handler(mock: MockHomeAssistant, args: argparse.Namespace):
+    fault_endpoints = set(args.faults.split(",")) if args.faults != "all" else None
+
+    class Handler(BaseHTTPRequestHandler):
+        # Keep-alive like HA, the firmware pools its connections
+        protocol_version = "HTTP/1.1"
+        server_version = "MockHomeAssistant/1.0"
+
+        def log_message(self, format, *log_args):
+            pass
+
+        def endpoint(self) -> str:
+            path = self.path.split("?", 1)[0]
+            if path.startswith("/api/services/"):
+                return "services"
+            if path == "/api/template":
+                return "template"
+            if path.startswith("/api/states"):
+                return "states"
+            if path.startswith("/api/events/"):
+                return "events"
+            return "other"
+
+        def read_body(self) -> bytes:
+            length = int(self.headers.get("Content-Length", 0))
+            return self.rfile.read(length) if length else b""
+
+        def authorized(self) -> bool:
+            return not args.token or self.headers.get("Authorization") == f"Bearer {args.token}"
+
+        def faults_apply(self, endpoint: str) -> bool:
+            return fault_endpoints is None or endpoint in fault_endpoints
+
+        def send_body(self, status: int, body: bytes, endpoint: str, start: float) -> None:
+            outcome = str(status)
+            faulty = self.faults_apply(endpoint)
+
+            if faulty and args.latency_ms + args.jitter_ms > 0:
+                time.sleep(max(0.0, args.latency_ms + random.uniform(-args.jitter_ms, args.jitter_ms)) / 1000.0)
+
+            if faulty and random.random() < args.drop:
+                # Connection closed with no response at all
+                self.close_connection = True
+                self.finish_request(endpoint, "dropped", 0, start)
+                return
+
+            if faulty and random.random() < args.error_rate:
+                status, body, outcome = 500, b'{"message":"Mock server error"}', "500"
+
+            # Truncation below then cuts the compressed stream, as a lost connection would
+            encoding = None
+            if args.compress and args.compress in self.headers.get("Accept-Encoding", ""):
+                body = gzip.compress(body, mtime=0) if args.compress == "gzip" else zlib.compress(body)
+                encoding = args.compress
+
+            cut = len(body)
+            if faulty and random.random() < args.truncate:
+                # Full Content-Length announced, part of the body sent, then closed
+                cut = random.randint(0, max(0, len(body) - 1))
+                outcome = "truncated"
+
+            self.send_response(status)
+            self.send_header("Content-Type", "application/json")
+            if encoding:
+                self.send_header("Content-Encoding", encoding)
+            if args.chunked and endpoint == "states" and cut == len(body):
+                self.send_header("Transfer-Encoding", "chunked")
+                self.end_headers()
+                self.write_throttled(body, faulty, chunked=True)
+            else:
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.write_throttled(body[:cut], faulty, chunked=False)
+            if cut < len(body):
+                self.close_connection = True
+            self.finish_request(endpoint, outcome, cut, start)
+
+        def write_throttled(self, body: bytes, faulty: bool, chunked: bool) -> None:
+            chunk = 1460
+            delay = chunk / (args.rate_kbps * 128.0) if faulty and args.rate_kbps > 0 else 0.0
+            for offset in range(0, len(body), chunk):
+                piece = body[offset : offset + chunk]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(piece), piece) if chunked else piece)
+                if delay:
+                    time.sleep(delay)
+            if chunked:
+                self.wfile.write(b"0\r\n\r\n")
+            self.wfile.flush()
+
+        def finish_request(self, endpoint: str, outcome: str, sent: int, start: float) -> None:
+            elapsed_ms = (time.perf_counter() - start) * 1000.0
+            mock.record(endpoint, outcome, elapsed_ms)
+            if not args.quiet:
+                print(f"{elapsed_ms:8.1f} ms  {self.command:<4} {self.path[:60]:<60} {outcome:<9} {sent:>8} B")
+
+        def reply_json(self, status: int, payload, endpoint: str, start: float) -> None:
+            self.send_body(status, json.dumps(payload, ensure_ascii=False).encode("utf-8"), endpoint, start)
+
+        def do_GET(self):
+            start = time.perf_counter()
+            endpoint = self.endpoint()
+            if not self.authorized():
+                self.reply_json(401, {"message": "Unauthorized"}, endpoint, start)
+                return
+
+            path = self.path.split("?", 1)[0]
+            if path in ("/api", "/api/"):
+                self.reply_json(200, {"message": "API running."}, endpoint, start)
+            elif path == "/api/states":
+                with mock.lock:
+                    states = list(mock.states.values())
+                self.reply_json(200, states, endpoint, start)
+            elif path.startswith("/api/states/"):
+                with mock.lock:
+                    state = mock.states.get(path[len("/api/states/") :])
+                if state is None:
+                    self.reply_json(404, {"message": "Entity not found."}, endpoint, start)
+                else:
+                    self.reply_json(200, state, endpoint, start)
+            else:
+                self.reply_json(404, {"message": "Not found"}, endpoint, start)
+
+        def do_POST(self):
+            start = time.perf_counter()
+            endpoint = self.endpoint()
+            body = self.read_body()
+            if not self.authorized():
+                self.reply_json(401, {"message": "Unauthorized"}, endpoint, start)
+                return
+            try:
+                data = json.loads(body) if body else {}
+            except json.JSONDecodeError:
+                self.reply_json(400, {"message": "Invalid JSON"}, endpoint, start)
+                return
+
+            path = self.path.split("?", 1)[0]
+            if endpoint == "template":
+                self.render_template(data, start)
+            elif endpoint == "services":
+                self.call_service(path, data, start)
+            elif endpoint == "events":
+                event_type = path[len("/api/events/") :]
+                self.reply_json(200, {"message": f"Event {event_type} fired."}, endpoint, start)
+            else:
+                self.reply_json(404, {"message": "Not found"}, endpoint, start)
+
+        def render_template(self, data: dict, start: float) -> None:
+            match = TEMPLATE_ENTITIES.search(data.get("template", ""))
+            if not match:
+                # Only the dashboard's state template is understood
+                self.reply_json(400, {"message": "Unsupported template"}, "template", start)
+                return
+            out = []
+            with mock.lock:
+                for entity_id in json.loads(match.group(1)):
+                    state = mock.states.get(entity_id)
+                    if state:
+                        changed = datetime.fromisoformat(state["last_changed"]).timestamp()
+                        out.append({
+                            "entity_id": entity_id,
+                            "state": state["state"],
+                            "friendly_name": state["attributes"].get("friendly_name", entity_id),
+                            "last_changed": int(changed),
+                        })
+            # HA renders the template to text, the JSON is the whole body
+            self.send_body(200, json.dumps(out).encode("utf-8"), "template", start)
+
+        def call_service(self, path: str, data: dict, start: float) -> None:
+            parts = path.split("/")
+            if len(parts) != 5:
+                self.reply_json(400, {"message": "Invalid service"}, "services", start)
+                return
+            domain, service = parts[3], parts[4]
+            entity_ids = data.get("entity_id", [])
+            if isinstance(entity_ids, str):
+                entity_ids = [entity_ids]
+
+            changed = []
+            for entity_id in entity_ids:
+                with mock.lock:
+                    current = mock.states.get(entity_id, {}).get("state")
+                if service == "turn_on":
+                    state = mock.set_state(entity_id, "on")
+                elif service == "turn_off":
+                    state = mock.set_state(entity_id, "off")
+                elif service == "toggle" and current is not None:
+                    state = mock.set_state(entity_id, "off" if current == "on" else "on")
+                else:
+                    state = None
+                if state:
+                    changed.append(state)
+            if domain == "scene" and not args.quiet:
+                print(f"           scene {', '.join(entity_ids)} activated")
+            self.reply_json(200, changed, "services", start)
+
+    return Handler
+
+
+def run_device_test(args: argparse.Namespace) -> None:
+    """Start HA_LATENCY_TEST on the dashboard and print its reply lines."""
+    import serial
+
+    command = f"HA_LATENCY_TEST {args.test} {args.syncs} {args.commands}\n"
+    with serial.Serial(args.device, args.baud, timeout=0.5) as conn:
+        conn.reset_input_buffer()
+        conn.write(command.encode("ascii"))
+        conn.flush()
+        deadline = time.time() + args.test_timeout
+        while time.time() < deadline:
+            line = conn.readline().decode("utf-8", errors="replace").strip()
+            if not line.startswith("HA_LATENCY "):
+                continue
+            reply = json.loads(line[len("HA_LATENCY ") :])
+            print(f"📟 {json.dumps(reply)}")
+            if reply.get("done") or "error" in reply:
+                return
+        print("❌ No complete HA_LATENCY reply before the timeout")
+
+
+def build_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(description="Mock Home Assistant server for latency and scale testing")
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8123)
+    parser.add_argument("--entities", type=int, default=500, help="Generated entities besides the dashboard's (100...5000)")
+    parser.add_argument("--dashboard", default="", help="Comma separated entity IDs the dashboard is configured with")
+    parser.add_argument("--seed", type=int, default=1, help="Seed of the generated states")
+    parser.add_argument("--token", default="", help="Require this bearer token")
+    parser.add_argument("--latency-ms", type=float, default=0.0, help="Delay before each response")
+    parser.add_argument("--jitter-ms", type=float, default=0.0, help="Uniform +/- variation of the delay")
+    parser.add_argument("--rate-kbps", type=float, default=0.0, help="Throttle response bodies, 0 for unlimited")
+    parser.add_argument("--drop", type=float, default=0.0, help="Fraction of requests closed without a response")
+    parser.add_argument("--truncate", type=float, default=0.0, help="Fraction of responses cut short")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="Fraction of responses replaced by HTTP 500")
+    parser.add_argument("--faults", default="all", help="Endpoints faults apply to: all or a list of states,template,services,events")
+    parser.add_argument("--chunked", action="store_true", help="Send /api/states with chunked transfer encoding")
+    parser.add_argument("--compress", choices=("gzip", "deflate"), help="Compress bodies for clients that accept it")
+    parser.add_argument("--quiet", action="store_true", help="No per-request log lines")
+    parser.add_argument("--device", help="Serial port of the dashboard, runs HA_LATENCY_TEST on it")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--test", default="all", help="Fetch path for HA_LATENCY_TEST: all, per_entity, bulk, template")
+    parser.add_argument("--syncs", type=int, default=20)
+    parser.add_argument("--commands", type=int, default=20)
+    parser.add_argument("--test-timeout", type=float, default=600.0)
+    return parser
+
+
+def start_server(args: argparse.Namespace):
+    """Create the mock and its server, the caller runs serve_forever()."""
+    if not 100 <= args.entities <= 5000:
+        print(f"⚠️ {args.entities} entities is outside the tested 100...5000 range")
+    dashboard_ids = [e.strip() for e in args.dashboard.split(",") if e.strip()]
+    mock = MockHomeAssistant(args.entities, dashboard_ids, args.seed)
+    document_size = len(json.dumps(list(mock.states.values()), ensure_ascii=False).encode("utf-8"))
+
+    server = ThreadingHTTPServer((args.bind, args.port), make_handler(mock, args))
+    server.daemon_threads = True
+    print(f"🏠 Mock HA on {args.bind}:{args.port}: {len(mock.states)} entities, /api/states is {document_size / 1024:.0f} KB")
+    print(f"   latency {args.latency_ms:.0f}±{args.jitter_ms:.0f} ms, drop {args.drop:.0%}, truncate {args.truncate:.0%}, "
+          f"errors {args.error_rate:.0%}, faults on {args.faults}")
+    return server, mock
+
+
+def main() -> int:
+    args = build_parser().parse_args()
+    server, mock = start_server(args)
+
+    if args.device:
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        try:
+            run_device_test(args)
+        except KeyboardInterrupt:
+            pass
+    else:
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+    server.shutdown()
+    print(mock.summary())
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
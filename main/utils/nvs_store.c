@@ -0,0 +1,648 @@
+/**
+ * @file nvs_store.c
+ * @brief Write-coalescing NVS persistence with per-key wear limits
+ *
+ * Each key holds its newest value in PSRAM, a CRC of it and the CRC of
+ * what flash holds, so a set() back to the flash contents cancels the
+ * pending write. The writer detaches the values it writes instead of
+ * copying them: a set() during the write allocates a fresh buffer, a
+ * get() still reads the detached one.
+ *
+ * The wear limit is a generic cell rate algorithm per key: every write
+ * moves the key's theoretical next write time one interval on, and a key
+ * may be written up to NVS_STORE_KEY_BURST - 1 intervals ahead of it.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "nvs_store.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+#include "nvs.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// CONSTANTS AND MACROS
+// =======================================================================
+
+#define STORE_US_PER_MS 1000LL
+#define STORE_INTERVAL_US (3600LL * 1000000LL / NVS_STORE_KEY_WRITES_PER_HOUR)
+#define STORE_BURST_US ((NVS_STORE_KEY_BURST - 1) * STORE_INTERVAL_US)
+
+// A flush at shutdown waits this long for a write in progress
+#define STORE_FLUSH_WAIT_MS 2000
+
+// =======================================================================
+// DATA STRUCTURES
+// =======================================================================
+
+typedef struct
+{
+  char ns[NVS_KEY_NAME_MAX_SIZE];
+  char key[NVS_KEY_NAME_MAX_SIZE];
+
+  uint8_t *value;   ///< Newest value, NULL if erased or only flash has it
+  size_t size;      ///< Of value
+  uint32_t crc;     ///< Of value
+  bool erased;      ///< The newest state is no value
+  uint8_t *writing; ///< Value detached by the writer, readable until the write ends
+  size_t writing_size;
+
+  bool flash_known; ///< The flash_ fields describe flash
+  bool flash_present;
+  size_t flash_size;
+  uint32_t flash_crc;
+
+  bool dirty;
+  int64_t due_us;
+  int64_t tat_us; ///< Wear limit, theoretical time of the next write
+
+  uint32_t writes;
+  uint32_t coalesced; ///< Changes folded into a pending write
+  uint32_t unchanged; ///< Changes dropped because flash holds the value
+  uint32_t throttled; ///< Writes pushed back by the wear limit
+  uint32_t failures;
+} store_entry_t;
+
+/**
+ * @brief One key of a batch, detached from its entry
+ */
+typedef struct
+{
+  store_entry_t *entry;
+  const uint8_t *value;
+  size_t size;
+  bool erase;
+} write_job_t;
+
+enum
+{
+  STORE_METRIC_WRITES,
+  STORE_METRIC_COMMITS,
+  STORE_METRIC_COALESCED,
+  STORE_METRIC_THROTTLED,
+};
+
+// =======================================================================
+// STATIC VARIABLES
+// =======================================================================
+
+// state_mutex guards the entries and is never held across flash access,
+// write_mutex serializes the timer, flush and shutdown writers
+static SemaphoreHandle_t state_mutex = NULL;
+static SemaphoreHandle_t write_mutex = NULL;
+static esp_timer_handle_t write_timer = NULL;
+static int64_t timer_due_us = 0;
+
+static store_entry_t entries[NVS_STORE_MAX_KEYS];
+static int entry_count = 0;
+
+// write_due() tracks the entries of a run in a bit mask
+_Static_assert(NVS_STORE_MAX_KEYS <= 32, "NVS_STORE_MAX_KEYS must fit a uint32_t mask");
+
+static metric_t store_metrics[] = {
+    [STORE_METRIC_WRITES] = METRIC_COUNTER_INIT("nvs_store_writes_total", "Keys written or erased in NVS"),
+    [STORE_METRIC_COMMITS] = METRIC_COUNTER_INIT("nvs_store_commits_total", "NVS commits, one per namespace and batch"),
+    [STORE_METRIC_COALESCED] =
+        METRIC_COUNTER_INIT("nvs_store_coalesced_total", "Changes that did not cost a write of their own"),
+    [STORE_METRIC_THROTTLED] =
+        METRIC_COUNTER_INIT("nvs_store_throttled_total", "Writes postponed by the per-key wear limit"),
+};
+
+// =======================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+/**
+ * @note Call with state_mutex held
+ */
+static store_entry_t *find_entry_locked(const char *ns, const char *key, bool add)
+{
+  for (int i = 0; i < entry_count; i++)
+  {
+    if (strcmp(entries[i].key, key) == 0 && strcmp(entries[i].ns, ns) == 0)
+      return &entries[i];
+  }
+  if (!add || entry_count >= NVS_STORE_MAX_KEYS || strlen(ns) >= NVS_KEY_NAME_MAX_SIZE ||
+      strlen(key) >= NVS_KEY_NAME_MAX_SIZE)
+    return NULL;
+
+  store_entry_t *e = &entries[entry_count++];
+  memset(e, 0, sizeof(*e));
+  strcpy(e->ns, ns);
+  strcpy(e->key, key);
+  return e;
+}
+
+/**
+ * @brief Run the timer for due_us unless it already runs for earlier
+ * @note Call with state_mutex held
+ */
+static void arm_timer_locked(int64_t due_us)
+{
+  if (esp_timer_is_active(write_timer))
+  {
+    if (timer_due_us <= due_us)
+      return;
+    esp_timer_stop(write_timer);
+  }
+
+  int64_t now_us = esp_timer_get_time();
+  timer_due_us = due_us;
+  esp_timer_start_once(write_timer, due_us > now_us ? (uint64_t)(due_us - now_us) : 1);
+}
+
+/**
+ * @brief Schedule the write of the entry's newest state
+ * @note Call with state_mutex held
+ */
+static void mark_dirty_locked(store_entry_t *e, int64_t due_us)
+{
+  if (e->dirty)
+  {
+    e->coalesced++;
+    metrics_counter_add(&store_metrics[STORE_METRIC_COALESCED], 1);
+    if (e->due_us < due_us)
+      due_us = e->due_us;
+  }
+
+  int64_t earliest_us = e->tat_us - STORE_BURST_US;
+  if (due_us < earliest_us)
+  {
+    if (!e->dirty || e->due_us < earliest_us)
+    {
+      e->throttled++;
+      metrics_counter_add(&store_metrics[STORE_METRIC_THROTTLED], 1);
+    }
+    due_us = earliest_us;
+  }
+
+  e->dirty = true;
+  e->due_us = due_us;
+  arm_timer_locked(due_us);
+}
+
+/**
+ * @brief Drop a pending write, the newest state is what flash holds
+ * @note Call with state_mutex held
+ */
+static void mark_clean_locked(store_entry_t *e)
+{
+  if (e->dirty)
+  {
+    e->dirty = false;
+    e->coalesced++;
+  }
+  else
+  {
+    e->unchanged++;
+  }
+  metrics_counter_add(&store_metrics[STORE_METRIC_COALESCED], 1);
+}
+
+static esp_err_t read_flash(const char *ns, const char *key, void *value, size_t *size)
+{
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(ns, NVS_READONLY, &handle);
+  if (err != ESP_OK)
+    return err;
+  err = nvs_get_blob(handle, key, value, size);
+  nvs_close(handle);
+  return err;
+}
+
+/**
+ * @brief Write one batch of a namespace and commit it
+ */
+static esp_err_t write_jobs(const char *ns, const write_job_t *jobs, int count)
+{
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(ns, NVS_READWRITE, &handle);
+  if (err != ESP_OK)
+    return err;
+
+  for (int i = 0; i < count && err == ESP_OK; i++)
+  {
+    if (jobs[i].erase)
+    {
+      err = nvs_erase_key(handle, jobs[i].entry->key);
+      if (err == ESP_ERR_NVS_NOT_FOUND)
+        err = ESP_OK;
+    }
+    else
+    {
+      err = nvs_set_blob(handle, jobs[i].entry->key, jobs[i].value, jobs[i].size);
+    }
+  }
+  if (err == ESP_OK)
+  {
+    err = nvs_commit(handle);
+    metrics_counter_add(&store_metrics[STORE_METRIC_COMMITS], 1);
+  }
+  nvs_close(handle);
+  return err;
+}
+
+/**
+ * @brief Detach an entry's newest state for the writer
+ * @note Call with state_mutex held
+ */
+static void detach_locked(store_entry_t *e, write_job_t *job, int64_t now_us)
+{
+  job->entry = e;
+  job->erase = e->erased;
+  job->value = e->value;
+  job->size = e->size;
+
+  e->writing = e->value;
+  e->writing_size = e->size;
+  e->value = NULL;
+  e->dirty = false;
+
+  // Flash holds this once the write ends, set() compares with it from now
+  e->flash_known = true;
+  e->flash_present = !e->erased;
+  e->flash_size = e->size;
+  e->flash_crc = e->crc;
+
+  e->tat_us = (e->tat_us > now_us ? e->tat_us : now_us) + STORE_INTERVAL_US;
+}
+
+/**
+ * @brief Hand the written value back, or schedule a retry
+ * @note Call with state_mutex held
+ */
+static void finish_locked(write_job_t *job, esp_err_t err, int64_t now_us)
+{
+  store_entry_t *e = job->entry;
+  uint8_t *written = e->writing;
+  e->writing = NULL;
+
+  // Unless a set() or erase() came in meanwhile, the written value is the newest
+  if (!e->value && !e->erased)
+  {
+    e->value = written;
+  }
+  else
+  {
+    heap_caps_free(written);
+  }
+
+  if (err == ESP_OK)
+  {
+    e->writes++;
+    metrics_counter_add(&store_metrics[STORE_METRIC_WRITES], 1);
+    return;
+  }
+
+  e->failures++;
+  e->flash_known = false;
+  if (!e->dirty)
+  {
+    e->dirty = true;
+    e->due_us = now_us + NVS_STORE_RETRY_S * 1000000LL;
+  }
+}
+
+/**
+ * @brief Write the due keys, or all dirty ones, a namespace at a time
+ * @note Call with write_mutex held
+ * @return ESP_OK, or the first write error
+ */
+static esp_err_t write_due(bool all)
+{
+  esp_err_t first_err = ESP_OK;
+  uint32_t handled = 0; // Entries already tried in this run, a failed one waits for its retry
+  write_job_t jobs[NVS_STORE_MAX_KEYS];
+
+  while (true)
+  {
+    int64_t now_us = esp_timer_get_time();
+    const char *ns = NULL;
+    int count = 0;
+
+    xSemaphoreTake(state_mutex, portMAX_DELAY);
+    for (int i = 0; i < entry_count; i++)
+    {
+      store_entry_t *e = &entries[i];
+      if (!e->dirty || (handled & (1u << i)) || (!all && e->due_us > now_us))
+        continue;
+      if (ns && strcmp(ns, e->ns) != 0)
+        continue;
+      ns = e->ns;
+      handled |= 1u << i;
+      detach_locked(e, &jobs[count++], now_us);
+    }
+    xSemaphoreGive(state_mutex);
+
+    if (count == 0)
+      break;
+
+    // Flash writes stall for a while, never with state_mutex held
+    esp_err_t err = write_jobs(ns, jobs, count);
+    if (err != ESP_OK)
+    {
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "NVS namespace %s not written: %s", ns, esp_err_to_name(err));
+      if (first_err == ESP_OK)
+        first_err = err;
+    }
+
+    xSemaphoreTake(state_mutex, portMAX_DELAY);
+    for (int i = 0; i < count; i++)
+    {
+      finish_locked(&jobs[i], err, now_us);
+    }
+    xSemaphoreGive(state_mutex);
+  }
+
+  // Keys that are not due yet, or came in during the writes
+  xSemaphoreTake(state_mutex, portMAX_DELAY);
+  for (int i = 0; i < entry_count; i++)
+  {
+    if (entries[i].dirty)
+      arm_timer_locked(entries[i].due_us);
+  }
+  xSemaphoreGive(state_mutex);
+  return first_err;
+}
+
+static void write_timer_cb(void *arg)
+{
+  xSemaphoreTake(write_mutex, portMAX_DELAY);
+  write_due(false);
+  xSemaphoreGive(write_mutex);
+}
+
+static void flush_on_shutdown(void)
+{
+  nvs_store_flush();
+}
+
+static void reply(const char *text)
+{
+  serial_data_write(text, strlen(text));
+}
+
+static void reply_keys(void)
+{
+  char buf[256];
+  nvs_stats_t stats = {0};
+  nvs_get_stats(NULL, &stats);
+  int len = snprintf(buf, sizeof(buf), "NVS {\"entries\":{\"used\":%u,\"free\":%u,\"total\":%u},\"keys\":[",
+                     (unsigned)stats.used_entries, (unsigned)stats.free_entries, (unsigned)stats.total_entries);
+  serial_data_write(buf, len);
+
+  int64_t now_us = esp_timer_get_time();
+  for (int i = 0; i < NVS_STORE_MAX_KEYS; i++)
+  {
+    xSemaphoreTake(state_mutex, portMAX_DELAY);
+    if (i >= entry_count)
+    {
+      xSemaphoreGive(state_mutex);
+      break;
+    }
+    store_entry_t e = entries[i];
+    size_t size = e.value ? e.size : e.writing ? e.writing_size : e.flash_size;
+    xSemaphoreGive(state_mutex);
+
+    int64_t due_ms = e.dirty && e.due_us > now_us ? (e.due_us - now_us) / STORE_US_PER_MS : 0;
+    len = snprintf(buf, sizeof(buf),
+                   "%s{\"ns\":\"%s\",\"key\":\"%s\",\"size\":%u,\"dirty\":%s,\"due_ms\":%lld,\"writes\":%lu,"
+                   "\"coalesced\":%lu,\"unchanged\":%lu,\"throttled\":%lu,\"failures\":%lu}",
+                   i ? "," : "", e.ns, e.key, (unsigned)size, e.dirty ? "true" : "false", (long long)due_ms,
+                   (unsigned long)e.writes, (unsigned long)e.coalesced, (unsigned long)e.unchanged,
+                   (unsigned long)e.throttled, (unsigned long)e.failures);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t nvs_store_init(void)
+{
+  if (state_mutex)
+    return ESP_OK;
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = write_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "nvs_store",
+  };
+  esp_err_t ret = esp_timer_create(&timer_args, &write_timer);
+  if (ret != ESP_OK)
+    return ret;
+
+  write_mutex = xSemaphoreCreateMutex();
+  SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  if (!write_mutex || !mutex)
+  {
+    if (write_mutex)
+      vSemaphoreDelete(write_mutex);
+    if (mutex)
+      vSemaphoreDelete(mutex);
+    write_mutex = NULL;
+    esp_timer_delete(write_timer);
+    write_timer = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  for (size_t i = 0; i < sizeof(store_metrics) / sizeof(store_metrics[0]); i++)
+  {
+    metrics_register(&store_metrics[i]);
+  }
+  state_mutex = mutex;
+
+  // esp_restart() from a command, an OTA update or the watchdog task writes what is pending
+  ret = esp_register_shutdown_handler(flush_on_shutdown);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "NVS store not flushed at restart: %s", esp_err_to_name(ret));
+  }
+  return ESP_OK;
+}
+
+esp_err_t nvs_store_get(const char *ns, const char *key, void *value, size_t *size)
+{
+  if (!ns || !key || !size)
+    return ESP_ERR_INVALID_ARG;
+  if (!state_mutex)
+    return read_flash(ns, key, value, size);
+
+  xSemaphoreTake(state_mutex, portMAX_DELAY);
+  store_entry_t *e = find_entry_locked(ns, key, false);
+  const uint8_t *held = NULL;
+  size_t held_size = 0;
+  if (e && e->erased)
+  {
+    xSemaphoreGive(state_mutex);
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  if (e && (e->value || e->writing))
+  {
+    held = e->value ? e->value : e->writing;
+    held_size = e->value ? e->size : e->writing_size;
+  }
+  if (held)
+  {
+    esp_err_t err = ESP_OK;
+    if (value && *size < held_size)
+      err = ESP_ERR_NVS_INVALID_LENGTH;
+    else if (value)
+      memcpy(value, held, held_size);
+    *size = held_size;
+    xSemaphoreGive(state_mutex);
+    return err;
+  }
+  xSemaphoreGive(state_mutex);
+
+  // Only flash has it; remember what it holds so an equal set() is dropped
+  size_t capacity = *size;
+  esp_err_t err = read_flash(ns, key, value, size);
+  if (err == ESP_OK && value && *size <= capacity)
+  {
+    xSemaphoreTake(state_mutex, portMAX_DELAY);
+    e = find_entry_locked(ns, key, true);
+    if (e && !e->flash_known && !e->dirty)
+    {
+      e->flash_known = true;
+      e->flash_present = true;
+      e->flash_size = *size;
+      e->flash_crc = esp_rom_crc32_le(0, value, *size);
+    }
+    xSemaphoreGive(state_mutex);
+  }
+  return err;
+}
+
+esp_err_t nvs_store_set(const char *ns, const char *key, const void *value, size_t size, uint32_t delay_ms)
+{
+  if (!ns || !key || (!value && size))
+    return ESP_ERR_INVALID_ARG;
+  if (!state_mutex)
+    return ESP_ERR_INVALID_STATE;
+
+  uint32_t crc = esp_rom_crc32_le(0, value, size);
+  xSemaphoreTake(state_mutex, portMAX_DELAY);
+  store_entry_t *e = find_entry_locked(ns, key, true);
+  if (!e)
+  {
+    xSemaphoreGive(state_mutex);
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "NVS store has no room for %s/%s", ns, key);
+    return ESP_ERR_NO_MEM;
+  }
+
+  // The writer may hold the previous buffer, it never shares the current one
+  if (!e->value || e->size != size)
+  {
+    uint8_t *copy = heap_caps_malloc(size ? size : 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!copy)
+    {
+      xSemaphoreGive(state_mutex);
+      return ESP_ERR_NO_MEM;
+    }
+    heap_caps_free(e->value);
+    e->value = copy;
+  }
+  memcpy(e->value, value, size);
+  e->size = size;
+  e->crc = crc;
+  e->erased = false;
+
+  if (e->flash_known && e->flash_present && e->flash_size == size && e->flash_crc == crc)
+  {
+    mark_clean_locked(e);
+  }
+  else
+  {
+    mark_dirty_locked(e, esp_timer_get_time() + (int64_t)delay_ms * STORE_US_PER_MS);
+  }
+  xSemaphoreGive(state_mutex);
+  return ESP_OK;
+}
+
+esp_err_t nvs_store_erase(const char *ns, const char *key, uint32_t delay_ms)
+{
+  if (!ns || !key)
+    return ESP_ERR_INVALID_ARG;
+  if (!state_mutex)
+    return ESP_ERR_INVALID_STATE;
+
+  xSemaphoreTake(state_mutex, portMAX_DELAY);
+  store_entry_t *e = find_entry_locked(ns, key, true);
+  if (!e)
+  {
+    xSemaphoreGive(state_mutex);
+    return ESP_ERR_NO_MEM;
+  }
+
+  heap_caps_free(e->value);
+  e->value = NULL;
+  e->size = 0;
+  e->crc = 0;
+  e->erased = true;
+
+  if (e->flash_known && !e->flash_present)
+  {
+    mark_clean_locked(e);
+  }
+  else
+  {
+    mark_dirty_locked(e, esp_timer_get_time() + (int64_t)delay_ms * STORE_US_PER_MS);
+  }
+  xSemaphoreGive(state_mutex);
+  return ESP_OK;
+}
+
+esp_err_t nvs_store_flush(void)
+{
+  if (!state_mutex)
+    return ESP_ERR_INVALID_STATE;
+  if (xSemaphoreTake(write_mutex, pdMS_TO_TICKS(STORE_FLUSH_WAIT_MS)) != pdTRUE)
+    return ESP_ERR_TIMEOUT;
+
+  esp_err_t err = write_due(true);
+  xSemaphoreGive(write_mutex);
+  return err;
+}
+
+bool nvs_store_handle_command(const char *line)
+{
+  bool is_get = strcmp(line, "GET_NVS") == 0;
+  bool is_flush = strcmp(line, "NVS_FLUSH") == 0;
+  if (!is_get && !is_flush)
+    return false;
+
+  if (!state_mutex)
+  {
+    reply("NVS {\"error\":\"not initialized\"}\n");
+    return true;
+  }
+
+  if (is_get)
+  {
+    reply_keys();
+    return true;
+  }
+
+  esp_err_t err = nvs_store_flush();
+  char buf[64];
+  if (err == ESP_OK)
+    snprintf(buf, sizeof(buf), "NVS {\"flushed\":true}\n");
+  else
+    snprintf(buf, sizeof(buf), "NVS {\"error\":\"%s\"}\n", esp_err_to_name(err));
+  reply(buf);
+  return true;
+}
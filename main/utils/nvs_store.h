@@ -0,0 +1,122 @@
+/**
+ * @file nvs_store.h
+ * @brief Write-coalescing NVS persistence with per-key wear limits
+ *
+ * Callers hand over a value and a delay; the value is kept in RAM and the
+ * key marked dirty. A single esp_timer writes the keys that fall due,
+ * grouped into one nvs_commit() per namespace, so a burst of changes to
+ * the same or neighbouring keys costs one flash write. Values that return
+ * to what flash already holds are not written at all. Producers only copy
+ * under a mutex and never wait for flash.
+ *
+ * Every key also has a write budget (NVS_STORE_KEY_WRITES_PER_HOUR with a
+ * burst of NVS_STORE_KEY_BURST): a key that changes faster than that is
+ * written less often instead of wearing the 20 KB partition. Dirty keys
+ * are written on esp_restart() through a shutdown handler and with
+ * NVS_FLUSH, GET_NVS lists the keys with their write counts.
+ *
+ * Crash logs keep writing straight through, they are rare and must be in
+ * flash before the next crash.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef NVS_STORE_H
+#define NVS_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Writes of one key per hour once its burst is used up */
+#ifdef CONFIG_NVS_STORE_KEY_WRITES_PER_HOUR
+#define NVS_STORE_KEY_WRITES_PER_HOUR CONFIG_NVS_STORE_KEY_WRITES_PER_HOUR
+#else
+#define NVS_STORE_KEY_WRITES_PER_HOUR 30
+#endif
+
+  /** Writes of one key allowed back to back */
+#ifdef CONFIG_NVS_STORE_KEY_BURST
+#define NVS_STORE_KEY_BURST CONFIG_NVS_STORE_KEY_BURST
+#else
+#define NVS_STORE_KEY_BURST 4
+#endif
+
+  /** Keys tracked, a set() for one more fails with ESP_ERR_NO_MEM */
+#define NVS_STORE_MAX_KEYS 24
+
+  /** A failed write is tried again after this */
+#define NVS_STORE_RETRY_S 60
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create the write timer and the shutdown handler
+   * @note Call right after nvs_flash_init(); before it, get() reads flash
+   *       directly and set() fails
+   * @return ESP_OK, or ESP_ERR_NO_MEM
+   */
+  esp_err_t nvs_store_init(void);
+
+  /**
+   * @brief Read a blob, the newest value even if it is not written yet
+   * @param ns NVS namespace
+   * @param key NVS key
+   * @param value Buffer, NULL to query the size
+   * @param size In: buffer size, out: size of the stored value
+   * @return ESP_OK, ESP_ERR_NVS_NOT_FOUND, ESP_ERR_NVS_INVALID_LENGTH if
+   *         the buffer is too small, or an NVS error
+   */
+  esp_err_t nvs_store_get(const char *ns, const char *key, void *value, size_t *size);
+
+  /**
+   * @brief Store a blob within delay_ms, together with other due keys
+   * @param ns NVS namespace
+   * @param key NVS key
+   * @param value Copied before returning
+   * @param size Bytes of value
+   * @param delay_ms Longest the caller wants to wait; an earlier pending
+   *        write of the key is kept, the wear limit may push it later
+   * @return ESP_OK, ESP_ERR_INVALID_STATE before init, ESP_ERR_NO_MEM
+   * @note Write errors are logged and retried, not returned
+   */
+  esp_err_t nvs_store_set(const char *ns, const char *key, const void *value, size_t size, uint32_t delay_ms);
+
+  /**
+   * @brief Erase a key within delay_ms
+   * @return ESP_OK, ESP_ERR_INVALID_STATE before init, ESP_ERR_NO_MEM
+   */
+  esp_err_t nvs_store_erase(const char *ns, const char *key, uint32_t delay_ms);
+
+  /**
+   * @brief Write every dirty key now, ignoring delays and wear limits
+   * @return ESP_OK, or the first write error
+   * @note Blocks for the flash writes
+   */
+  esp_err_t nvs_store_flush(void);
+
+  /**
+   * @brief Handle GET_NVS and NVS_FLUSH
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an NVS store command
+   */
+  bool nvs_store_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVS_STORE_H
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+Dashboard OTA Packager
+======================
+
+Prepares a firmware release for CONFIG_OTA_UPDATE (wifi/ota_update.c):
+copies the new app image, makes a delta patch against every older image
+given with --base and writes the manifest the panels poll:
+
+    {"version": "1.4.0", "image": "<image hash>", "url": "dashboard-1.4.0.bin",
+     "size": 2812345, "sha256": "<file hash>",
+     "deltas": [{"from": "<image hash>", "url": "3fa2c1d0-1.4.0.dpatch",
+                 "size": 184213, "sha256": "<file hash>"}]}
+
+The image hash is what esp_partition_get_sha256() reports for a flashed
+app, the digest esptool appends to the image. A panel running one of the
+base images downloads the matching patch, everything else the full image.
+
+Patches use the format of utils/delta_patch.h. The bsdiff4 package is used
+to find matches when installed (pip install bsdiff4), otherwise a simpler
+built-in block matcher that also handles code moved by a few bytes. Every
+patch is applied again here and compared with the new image before it is
+written.
+
+Usage:
+    python ota_package.py --new build/dashboard.bin --version 1.4.0 \\
+                          --base releases/1.3.0.bin --base releases/1.2.0.bin --out ota
+    # Upload the ota directory, then set CONFIG_OTA_UPDATE_URL to .../ota/manifest.json
+"""
+
+import argparse
+import bz2
+import hashlib
+import json
+import os
+import shutil
+import struct
+import sys
+import zlib
+from typing import List, Optional, Tuple
+
+PATCH_MAGIC = 0x544C4444  # "DDLT"
+PATCH_VERSION = 1
+PATCH_COMPRESSION_ZLIB = 1
+PATCH_HEADER = struct.Struct("<IHHII32s32s")
+RECORD = struct.Struct("<IIi")
+
+ESP_IMAGE_MAGIC = 0xE9
+ESP_IMAGE_HASH_APPENDED = 23  # Offset of hash_appended in esp_image_header_t
+
+BLOCK = 16  # Bytes compared at a time by the built-in matcher
+INDEX_STEP = 8  # Old image positions indexed
+MIN_SIMILAR = BLOCK // 2  # Equal bytes for a block to continue a match
+MAX_PATCH_RATIO = 0.8  # Larger patches are not worth it, the full image is used
+
+# (diff_len, old_start, new_start, extra_len), the bsdiff record with positions
+Record = Tuple[int, int, int, int]
+
+
+# =============================================================================
+# Images
+# =============================================================================
+
+
+def image_hash(image: bytes) -> bytes:
+    """Hash the device reports for this image with esp_partition_get_sha256()"""
+    if len(image) < 32 + 24 or image[0] != ESP_IMAGE_MAGIC:
+        raise ValueError("not an ESP app image")
+    if image[ESP_IMAGE_HASH_APPENDED] == 1:
+        digest = image[-32:]
+        if hashlib.sha256(image[:-32]).digest() != digest:
+            raise ValueError("appended image hash does not match, image damaged")
+        return digest
+    return hashlib.sha256(image).digest()
+
+
+# =============================================================================
+# Matching
+# =============================================================================
+
+
+def similar(new: bytes, j: int, old: bytes, o: int) -> int:
+    """Bytes of new[j:] that continue a match at old[o:], 0 if the block differs too much"""
+    n = min(BLOCK, len(new) - j, len(old) - o)
+    if o < 0 or n <= 0:
+        return 0
+    a, b = new[j : j + n], old[o : o + n]
+    if a == b or sum(x == y for x, y in zip(a, b)) >= min(MIN_SIMILAR, n):
+        return n
+    return 0
+
+
+def builtin_records(old: bytes, new: bytes) -> List[Record]:
+    """Greedy matcher: follow the current alignment while blocks stay similar, else look one up"""
+    index = {}
+    for i in range(0, len(old) - BLOCK + 1, INDEX_STEP):
+        index.setdefault(old[i : i + BLOCK], i)
+
+    records: List[List[int]] = []
+    delta: Optional[int] = None
+    j = 0
+    while j < len(new):
+        n = similar(new, j, old, j + delta) if delta is not None else 0
+        if n:
+            records[-1][0] += n
+            j += n
+            continue
+        o = index.get(new[j : j + BLOCK])
+        if o is not None:
+            delta = o - j
+            records.append([BLOCK, o, j, 0])
+            j += BLOCK
+            continue
+        # No match, the byte is copied as it is
+        delta = None
+        if records and records[-1][2] + records[-1][0] + records[-1][3] == j:
+            records[-1][3] += 1
+        else:
+            records.append([0, 0, j, 1])
+        j += 1
+    return [tuple(r) for r in records]
+
+
+def read_offtin(buf: bytes, pos: int) -> int:
+    value = struct.unpack_from("<Q", buf, pos)[0]
+    return -(value & ~(1 << 63)) if value & (1 << 63) else value
+
+
+def bsdiff_records(old: bytes, new: bytes) -> Optional[List[Record]]:
+    """Records of a bsdiff4 patch, None if bsdiff4 is not installed"""
+    try:
+        import bsdiff4
+    except ImportError:
+        return None
+    patch = bsdiff4.diff(old, new)
+    if patch[:8] != b"BSDIFF40":
+        raise ValueError("unexpected bsdiff4 output")
+    ctrl_len, diff_len = read_offtin(patch, 8), read_offtin(patch, 16)
+    ctrl = bz2.decompress(patch[32 : 32 + ctrl_len])
+
+    records: List[Record] = []
+    old_pos = new_pos = 0
+    for i in range(0, len(ctrl), 24):
+        x, y, z = (read_offtin(ctrl, i + k) for k in (0, 8, 16))
+        records.append((x, old_pos, new_pos, y))
+        old_pos += x + z
+        new_pos += x + y
+    return records
+
+
+# =============================================================================
+# Patch
+# =============================================================================
+
+
+def encode_records(old: bytes, new: bytes, records: List[Record]) -> bytes:
+    """Record stream with the seeks that carry the old position from one record to the next"""
+    out = bytearray()
+    old_pos = 0
+    for i, (diff_len, old_start, new_start, extra_len) in enumerate(records):
+        if diff_len and old_start != old_pos:
+            # Only the previous record can move the old position, an empty one if there is none
+            if not out:
+                out += RECORD.pack(0, 0, old_start)
+            else:
+                struct.pack_into("<i", out, seek_at, old_start - old_pos)
+            old_pos = old_start
+        seek_at = len(out) + 8
+        out += RECORD.pack(diff_len, extra_len, 0)
+        out += bytes((new[new_start + k] - old[old_pos + k]) & 0xFF for k in range(diff_len))
+        extra_start = new_start + diff_len
+        out += new[extra_start : extra_start + extra_len]
+        old_pos += diff_len
+    return bytes(out)
+
+
+def make_patch(old: bytes, new: bytes) -> bytes:
+    records = bsdiff_records(old, new)
+    if records is None:
+        records = builtin_records(old, new)
+    header = PATCH_HEADER.pack(
+        PATCH_MAGIC,
+        PATCH_VERSION,
+        PATCH_COMPRESSION_ZLIB,
+        len(old),
+        len(new),
+        image_hash(old),
+        hashlib.sha256(new).digest(),
+    )
+    return header + zlib.compress(encode_records(old, new, records), 9)
+
+
+def apply_patch(old: bytes, patch: bytes) -> bytes:
+    """Reference implementation of delta_patch.c, used to check every patch"""
+    magic, version, compression, old_size, new_size, _, new_sha = PATCH_HEADER.unpack_from(patch)
+    if magic != PATCH_MAGIC or version != PATCH_VERSION or compression != PATCH_COMPRESSION_ZLIB:
+        raise ValueError("not a delta patch")
+    stream = zlib.decompress(patch[PATCH_HEADER.size :])
+    new = bytearray()
+    pos = old_pos = 0
+    while pos < len(stream):
+        diff_len, extra_len, seek = RECORD.unpack_from(stream, pos)
+        pos += RECORD.size
+        new += bytes((stream[pos + k] + old[old_pos + k]) & 0xFF for k in range(diff_len))
+        pos += diff_len
+        new += stream[pos : pos + extra_len]
+        pos += extra_len
+        old_pos += diff_len + seek
+    if len(new) != new_size or hashlib.sha256(new).digest() != new_sha:
+        raise ValueError("patch does not reproduce the new image")
+    return bytes(new)
+
+
+# =============================================================================
+# Release
+# =============================================================================
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Package a firmware release for OTA updates")
+    parser.add_argument("--new", required=True, help="New app image, e.g. build/dashboard.bin")
+    parser.add_argument("--version", required=True, help="Version shown by GET_OTA")
+    parser.add_argument("--base", action="append", default=[], help="Older image panels may run, repeatable")
+    parser.add_argument("--out", "-o", required=True, help="Output directory")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    new = open(args.new, "rb").read()
+    try:
+        new_hash = image_hash(new)
+    except ValueError as e:
+        sys.exit(f"{args.new}: {e}")
+
+    image_name = f"dashboard-{args.version}.bin"
+    shutil.copyfile(args.new, os.path.join(args.out, image_name))
+    manifest = {
+        "version": args.version,
+        "image": new_hash.hex(),
+        "url": image_name,
+        "size": len(new),
+        "sha256": hashlib.sha256(new).hexdigest(),
+        "deltas": [],
+    }
+    print(f"{image_name}: {len(new)} bytes")
+
+    for base_path in args.base:
+        old = open(base_path, "rb").read()
+        try:
+            old_hash = image_hash(old)
+            if old_hash == new_hash:
+                continue
+            patch = make_patch(old, new)
+            apply_patch(old, patch)
+        except ValueError as e:
+            sys.exit(f"{base_path}: {e}")
+        ratio = len(patch) / len(new)
+        if ratio > MAX_PATCH_RATIO:
+            print(f"{base_path}: patch is {ratio:.0%} of the image, skipped")
+            continue
+        patch_name = f"{old_hash.hex()[:8]}-{args.version}.dpatch"
+        with open(os.path.join(args.out, patch_name), "wb") as f:
+            f.write(patch)
+        manifest["deltas"].append(
+            {"from": old_hash.hex(), "url": patch_name, "size": len(patch), "sha256": hashlib.sha256(patch).hexdigest()}
+        )
+        print(f"{patch_name}: {len(patch)} bytes ({ratio:.1%} of the image) for {base_path}")
+
+    with open(os.path.join(args.out, "manifest.json"), "w") as f:
+        json.dump(manifest, f, indent=2)
+    print(f"{os.path.join(args.out, 'manifest.json')}: {len(manifest['deltas'])} deltas")
+
+
+if __name__ == "__main__":
+    main()
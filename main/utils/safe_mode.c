@@ -0,0 +1,231 @@
+/**
+ * @file safe_mode.c
+ * @brief Crash-loop detection and minimal safe-mode boot
+ *
+ * A boot is early until it has been up for CONFIG_SAFE_MODE_STABLE_S.
+ * A panic or watchdog reset while the previous boot was still early adds
+ * one to the RTC counter. Staying up for the stable window clears it, and
+ * so does a power-on, since RTC memory holds noise then.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "safe_mode.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_app_desc.h"
+#include "esp_attr.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "sdkconfig.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "utils/crash_log_manager.h"
+#include "utils/nvs_store.h"
+
+#define SAFE_MODE_MAGIC 0x53464d31 // "SFM1", bump when safe_mode_rtc_t changes
+
+#define SAFE_MODE_RESTART_DELAY_MS 100 ///< Lets the reply drain before the reset
+
+#define SAFE_MODE_NVS_NAMESPACE "safe_mode"
+#define SAFE_MODE_NVS_KEY_GOOD "good_sha" ///< ELF SHA prefix of the last image that stayed up
+
+#if CONFIG_SAFE_MODE
+#define SAFE_MODE_THRESHOLD CONFIG_SAFE_MODE_CRASH_THRESHOLD
+#else
+#define SAFE_MODE_THRESHOLD 0
+#endif
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  uint32_t magic;
+  uint8_t crashes; ///< Consecutive early crashes
+  bool early;      ///< Boot has not reached the stable window yet
+} safe_mode_rtc_t;
+
+// Left alone by the startup code, so it outlives a panic or watchdog reset
+static RTC_NOINIT_ATTR safe_mode_rtc_t rtc_state;
+
+static safe_mode_status_t status;
+static char running_sha[CRASH_ELF_SHA_LEN + 1];
+static TimerHandle_t stable_timer = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static bool is_crash_reset(esp_reset_reason_t reason)
+{
+  return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+}
+
+/**
+ * @brief Whether the running image reached the stable window on an earlier boot
+ * @param stored Set if NVS holds any known-good image at all
+ */
+static bool running_image_known_good(bool *stored)
+{
+  char good[CRASH_ELF_SHA_LEN];
+  size_t size = sizeof(good);
+  *stored = nvs_store_get(SAFE_MODE_NVS_NAMESPACE, SAFE_MODE_NVS_KEY_GOOD, good, &size) == ESP_OK &&
+            size == sizeof(good);
+  return *stored && memcmp(good, running_sha, sizeof(good)) == 0;
+}
+
+static void stable_timer_callback(TimerHandle_t timer)
+{
+  rtc_state.crashes = 0;
+  rtc_state.early = false;
+  status.stable = true;
+
+  // Only a full boot vouches for the image, safe mode skipped most of it
+  if (!status.active && !status.known_good)
+  {
+    if (nvs_store_set(SAFE_MODE_NVS_NAMESPACE, SAFE_MODE_NVS_KEY_GOOD, running_sha, CRASH_ELF_SHA_LEN, 0) == ESP_OK)
+    {
+      status.known_good = true;
+    }
+  }
+  debug_log_info(DEBUG_TAG_SYSTEM, "Boot stable, crash-loop counter cleared");
+}
+
+#if CONFIG_SAFE_MODE && CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+/**
+ * @brief Go back to the other slot if the loop started with this image
+ * @note Only returns if there is nothing to roll back to
+ */
+static void try_rollback(void)
+{
+  bool stored;
+  if (running_image_known_good(&stored) || !stored || !esp_ota_check_rollback_is_possible())
+  {
+    return;
+  }
+
+  debug_log_error_f(DEBUG_TAG_SYSTEM, "Safe mode: %u crashes since image %s was installed, rolling back",
+                    rtc_state.crashes, running_sha);
+  // The previous image starts with a clean count, it was fine before
+  rtc_state.crashes = 0;
+  esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+  debug_log_error_f(DEBUG_TAG_SYSTEM, "Safe mode: rollback failed: %s", esp_err_to_name(err));
+  rtc_state.crashes = status.crashes;
+}
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+bool safe_mode_init(void)
+{
+  esp_reset_reason_t reason = esp_reset_reason();
+  esp_app_get_elf_sha256(running_sha, sizeof(running_sha));
+
+  status.threshold = SAFE_MODE_THRESHOLD;
+  status.last_reset = (uint8_t)reason;
+  bool stored;
+  status.known_good = running_image_known_good(&stored);
+
+#if CONFIG_SAFE_MODE
+  // RTC memory holds noise after power-on and may be corrupt after a brownout
+  if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT || rtc_state.magic != SAFE_MODE_MAGIC)
+  {
+    memset(&rtc_state, 0, sizeof(rtc_state));
+    rtc_state.magic = SAFE_MODE_MAGIC;
+  }
+  if (is_crash_reset(reason) && rtc_state.early && rtc_state.crashes < UINT8_MAX)
+  {
+    rtc_state.crashes++;
+  }
+  rtc_state.early = true;
+  status.crashes = rtc_state.crashes;
+
+  if (status.crashes >= SAFE_MODE_THRESHOLD)
+  {
+#if CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    try_rollback();
+#endif
+    status.active = true;
+    debug_log_error_f(DEBUG_TAG_SYSTEM, "Safe mode: %u early crashes in a row, starting display and serial only",
+                      status.crashes);
+  }
+  else if (status.crashes > 0)
+  {
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Early crash %u of %u before safe mode", status.crashes,
+                        SAFE_MODE_THRESHOLD);
+  }
+
+  stable_timer = xTimerCreate("safe_mode", pdMS_TO_TICKS(CONFIG_SAFE_MODE_STABLE_S * 1000), pdFALSE, NULL,
+                              stable_timer_callback);
+  if (!stable_timer || xTimerStart(stable_timer, 0) != pdPASS)
+  {
+    debug_log_error(DEBUG_TAG_SYSTEM, "Safe mode stable timer not started, crashes keep counting");
+  }
+#else
+  (void)is_crash_reset;
+  (void)stable_timer;
+  (void)stable_timer_callback;
+#endif
+  return status.active;
+}
+
+bool safe_mode_is_active(void)
+{
+  return status.active;
+}
+
+void safe_mode_get_status(safe_mode_status_t *out)
+{
+  if (out)
+  {
+    *out = status;
+  }
+}
+
+bool safe_mode_handle_command(const char *line)
+{
+  char reply[192];
+  int len;
+
+  if (strcmp(line, "GET_SAFE_MODE") == 0)
+  {
+    len = snprintf(reply, sizeof(reply),
+                   "SAFE_MODE {\"enabled\":%s,\"active\":%s,\"crashes\":%u,\"threshold\":%u,\"stable\":%s,"
+                   "\"reset\":\"%s\",\"image\":\"%s\",\"known_good\":%s}\n",
+                   SAFE_MODE_THRESHOLD > 0 ? "true" : "false", status.active ? "true" : "false", status.crashes,
+                   status.threshold, status.stable ? "true" : "false", crash_log_reason_name(status.last_reset),
+                   running_sha, status.known_good ? "true" : "false");
+    serial_data_write(reply, len);
+    return true;
+  }
+
+  bool leave = strcmp(line, "SAFE_MODE_EXIT") == 0;
+  if (!leave && strcmp(line, "SAFE_MODE_ENTER") != 0)
+  {
+    return false;
+  }
+
+#if CONFIG_SAFE_MODE
+  // A software reset neither counts nor clears, so the next boot sees exactly this
+  rtc_state.magic = SAFE_MODE_MAGIC;
+  rtc_state.crashes = leave ? 0 : SAFE_MODE_THRESHOLD;
+  rtc_state.early = false;
+  len = snprintf(reply, sizeof(reply), "SAFE_MODE {\"ok\":true,\"restarting\":\"%s\"}\n", leave ? "normal" : "safe");
+  serial_data_write(reply, len);
+  vTaskDelay(pdMS_TO_TICKS(SAFE_MODE_RESTART_DELAY_MS));
+  esp_restart();
+#else
+  len = snprintf(reply, sizeof(reply), "SAFE_MODE {\"ok\":false,\"error\":\"disabled\"}\n");
+  serial_data_write(reply, len);
+#endif
+  return true;
+}
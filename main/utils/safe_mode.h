@@ -0,0 +1,84 @@
+/**
+ * @file safe_mode.h
+ * @brief Crash-loop detection and minimal safe-mode boot
+ *
+ * A counter in RTC memory, which survives panic and watchdog resets, counts
+ * crashes that happened before the previous boot stayed up for
+ * CONFIG_SAFE_MODE_STABLE_S. Once CONFIG_SAFE_MODE_CRASH_THRESHOLD of them
+ * come in a row, app_main() skips the entity registry, cached UI state,
+ * WiFi and Home Assistant and brings up only the panel, one status screen
+ * and the serial command channel.
+ *
+ * Every image that stays up for the stable window has its ELF SHA prefix
+ * stored in NVS. A crash loop in an image that never got that far, with a
+ * valid image in the other app slot, is rolled back through otadata
+ * instead of entering safe mode.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef SAFE_MODE_H
+#define SAFE_MODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // TYPE DEFINITIONS
+  // =======================================================================
+
+  /**
+   * @brief Crash-loop state of this boot
+   */
+  typedef struct
+  {
+    bool active;        ///< This boot is the minimal safe-mode boot
+    bool stable;        ///< Up for the stable window, the counter is cleared
+    uint8_t crashes;    ///< Consecutive early crashes before this boot
+    uint8_t threshold;  ///< Crashes that enter safe mode
+    uint8_t last_reset; ///< esp_reset_reason_t of this boot
+    bool known_good;    ///< Running image has been up for the stable window before
+  } safe_mode_status_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Count this boot and decide whether to enter safe mode
+   * @note Call once, after nvs_store_init() and crash_handler_init(). May
+   *       not return: a crash loop in an unconfirmed update is rolled back
+   *       with a reboot into the other slot.
+   * @return true if app_main() should do the minimal safe-mode boot
+   */
+  bool safe_mode_init(void);
+
+  /**
+   * @brief Whether this boot is the safe-mode boot
+   */
+  bool safe_mode_is_active(void);
+
+  /**
+   * @brief Snapshot of the crash-loop state
+   */
+  void safe_mode_get_status(safe_mode_status_t *status);
+
+  /**
+   * @brief Handle GET_SAFE_MODE, SAFE_MODE_EXIT and SAFE_MODE_ENTER
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a safe mode command
+   */
+  bool safe_mode_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAFE_MODE_H
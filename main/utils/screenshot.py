@@ -0,0 +1,325 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Screenshot
+===================
+
+Pulls the frame buffer off the dashboard with SCREENSHOT and saves it as a
+PNG, with the dirty areas of the last frames alongside in JSON:
+1. Sends SCREENSHOT and collects the SCREENSHOT_DATA and SCREENSHOT_DIRTY lines
+2. Decodes the run-length encoding and checks the CRC32 against the device
+3. Writes NAME.png, NAME.json and, with --overlay, NAME_dirty.png
+
+With --mux the request goes over the framed command channel
+(serial_link.py) and the data comes back as raw bulk frames, without the
+base64 overhead.
+
+With --compare PREV it also diffs against an earlier capture. Pixels that
+changed outside the areas invalidated since then are a rendering bug
+(missed invalidation); invalidated pixels that did not change were redrawn
+for nothing (over-invalidation). The history only covers the frames the
+device keeps, older frames are reported as missing.
+
+Requirements:
+    pip install pyserial
+
+Usage:
+    python screenshot.py --port COM3 --output before
+    python screenshot.py --port COM3 --output after --compare before --overlay
+    python screenshot.py --port COM3 --mux --output framed
+    python screenshot.py --decode capture.log --output offline
+"""
+
+import argparse
+import base64
+import json
+import struct
+import sys
+import time
+import zlib
+
+DIRTY_COLOR = (255, 0, 64)
+
+
+# =======================================================================
+# Capture
+# =======================================================================
+
+
+def parse_lines(lines):
+    """Collect header, encoded data, dirty frames and trailer from reply lines."""
+    header, trailer = None, None
+    chunks, dirty = [], []
+    for line in lines:
+        for prefix in ("SCREENSHOT_DATA ", "SCREENSHOT_DIRTY ", "SCREENSHOT "):
+            start = line.find(prefix)
+            if start >= 0:
+                payload = line[start + len(prefix):]
+                break
+        else:
+            continue
+        if prefix == "SCREENSHOT_DATA ":
+            chunks.append(base64.b64decode(payload))
+        elif prefix == "SCREENSHOT_DIRTY ":
+            dirty.append(json.loads(payload))
+        else:
+            message = json.loads(payload)
+            if "error" in message:
+                raise RuntimeError(message["error"])
+            if message.get("done"):
+                trailer = message
+            else:
+                header, chunks, dirty = message, [], []
+    if not header or not trailer:
+        raise TimeoutError("capture incomplete")
+    return header, b"".join(chunks), dirty, trailer
+
+
+def capture(port: str, baud: int, frames: int, timeout: float) -> list:
+    """Run SCREENSHOT and return the reply lines up to the trailer."""
+    import serial
+
+    with serial.Serial(port, baud, timeout=0.1) as conn:
+        conn.reset_input_buffer()
+        conn.write(f"SCREENSHOT {frames}\n".encode())
+        conn.flush()
+        lines = []
+        buffer = b""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            buffer += conn.read(16384)
+            *raw_lines, buffer = buffer.split(b"\n")
+            for raw in raw_lines:
+                line = raw.decode("utf-8", errors="replace").rstrip("\r")
+                if "SCREENSHOT" not in line:
+                    continue
+                lines.append(line)
+                if '"done":true' in line or '"error"' in line:
+                    return lines
+                deadline = time.time() + timeout
+        raise TimeoutError("no reply from SCREENSHOT")
+
+
+def capture_mux(port: str, baud: int, frames: int, timeout: float):
+    """Run SCREENSHOT as a mux request, return the reply lines and the bulk data."""
+    import serial
+    from serial_link import SerialLink
+
+    with serial.Serial(port, baud, timeout=0.1) as conn:
+        conn.reset_input_buffer()
+        response, done = SerialLink(conn).request(f"SCREENSHOT {frames}", timeout)
+    if not done:
+        raise TimeoutError("no reply from SCREENSHOT")
+    return response.text.decode("utf-8", errors="replace").splitlines(), bytes(response.bulk)
+
+
+# =======================================================================
+# Pixels
+# =======================================================================
+
+
+def decode_rle(data: bytes, pixel_size: int, count: int) -> bytes:
+    """Undo the device's per-pixel run-length encoding."""
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        control = data[pos]
+        pos += 1
+        if control & 0x80:
+            out += data[pos:pos + pixel_size] * ((control & 0x7F) + 1)
+            pos += pixel_size
+        else:
+            size = (control + 1) * pixel_size
+            out += data[pos:pos + size]
+            pos += size
+    if len(out) != count * pixel_size:
+        raise ValueError(f"decoded {len(out)} bytes, expected {count * pixel_size}")
+    return bytes(out)
+
+
+def to_rgb(raw: bytes, fmt: str) -> bytearray:
+    """Frame buffer bytes to packed RGB888."""
+    if fmt == "rgb888":
+        rgb = bytearray(len(raw))
+        rgb[0::3], rgb[1::3], rgb[2::3] = raw[2::3], raw[1::3], raw[0::3]
+        return rgb
+    # Little-endian RGB565, channels widened with their top bits repeated
+    rgb = bytearray(len(raw) // 2 * 3)
+    for i, (value,) in enumerate(struct.iter_unpack("<H", raw)):
+        r, g, b = value >> 11, (value >> 5) & 0x3F, value & 0x1F
+        rgb[3 * i:3 * i + 3] = bytes(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+    return rgb
+
+
+def write_png(path: str, width: int, height: int, rgb: bytes):
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body))
+
+    stride = width * 3
+    rows = b"".join(b"\x00" + bytes(rgb[y * stride:(y + 1) * stride]) for y in range(height))
+    with open(path, "wb") as out:
+        out.write(b"\x89PNG\r\n\x1a\n")
+        out.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        out.write(chunk(b"IDAT", zlib.compress(rows, 6)))
+        out.write(chunk(b"IEND", b""))
+
+
+def read_png(path: str):
+    """Read back a PNG written by write_png, unfiltered 8-bit RGB only."""
+    with open(path, "rb") as src:
+        data = src.read()
+    pos, idat = 8, b""
+    width = height = 0
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height = struct.unpack(">II", body[:8])
+        elif kind == b"IDAT":
+            idat += body
+        pos += 12 + length
+    rows = zlib.decompress(idat)
+    stride = width * 3
+    rgb = bytearray()
+    for y in range(height):
+        row = rows[y * (stride + 1):(y + 1) * (stride + 1)]
+        if row[0] != 0:
+            raise ValueError(f"{path}: filtered rows are not supported")
+        rgb += row[1:]
+    return width, height, rgb
+
+
+# =======================================================================
+# Dirty areas
+# =======================================================================
+
+
+def dirty_mask(width: int, height: int, frames: list) -> bytearray:
+    mask = bytearray(width * height)
+    for frame in frames:
+        for x1, y1, x2, y2 in frame["areas"]:
+            x1, x2 = max(x1, 0), min(x2, width - 1)
+            for y in range(max(y1, 0), min(y2, height - 1) + 1):
+                mask[y * width + x1:y * width + x2 + 1] = b"\x01" * (x2 - x1 + 1)
+    return mask
+
+
+def draw_overlay(width: int, rgb: bytearray, frames: list) -> bytearray:
+    out = bytearray(rgb)
+    color = bytes(DIRTY_COLOR)
+    height = len(rgb) // 3 // width
+    for frame in frames:
+        for x1, y1, x2, y2 in frame["areas"]:
+            for x in range(x1, x2 + 1):
+                for y in (y1, y2):
+                    if 0 <= x < width and 0 <= y < height:
+                        out[3 * (y * width + x):3 * (y * width + x) + 3] = color
+            for y in range(y1, y2 + 1):
+                for x in (x1, x2):
+                    if 0 <= x < width and 0 <= y < height:
+                        out[3 * (y * width + x):3 * (y * width + x) + 3] = color
+    return out
+
+
+def compare(prev_base: str, header: dict, rgb: bytes, dirty: list) -> bool:
+    """Report missed and needless invalidation since an earlier capture; False on a missed one."""
+    width, height = header["w"], header["h"]
+    prev_w, prev_h, prev_rgb = read_png(prev_base + ".png")
+    with open(prev_base + ".json", encoding="utf-8") as src:
+        prev = json.load(src)
+    if (prev_w, prev_h) != (width, height):
+        print("⚠️  Captures differ in size, not compared")
+        return True
+    if header.get("rotation"):
+        print("⚠️  Rotated display, dirty areas are in logical coordinates, not compared")
+        return True
+
+    last_seq = max((f["seq"] for f in prev["dirty"]), default=0)
+    frames = [f for f in dirty if f["seq"] > last_seq]
+    if frames and frames[0]["seq"] > last_seq + 1:
+        print(f"⚠️  {frames[0]['seq'] - last_seq - 1} frames since {prev_base} are no longer on the device,"
+              " capture sooner or raise SCREEN_CAPTURE_FRAMES")
+
+    mask = dirty_mask(width, height, frames)
+    dirty_px = changed_px = missed_px = 0
+    for i in range(width * height):
+        changed = rgb[3 * i:3 * i + 3] != prev_rgb[3 * i:3 * i + 3]
+        if mask[i]:
+            dirty_px += 1
+            changed_px += changed
+        elif changed:
+            missed_px += 1
+
+    print(f"Frames since {prev_base}: {len(frames)}, invalidated {dirty_px} px, changed {changed_px} px")
+    if dirty_px:
+        print(f"Redrawn unchanged: {dirty_px - changed_px} px ({100.0 * (dirty_px - changed_px) / dirty_px:.1f}%)")
+    if missed_px:
+        print(f"❌ {missed_px} px changed outside the invalidated areas")
+        return False
+    return True
+
+
+# =======================================================================
+# Main
+# =======================================================================
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Capture the dashboard's frame buffer and dirty areas")
+    parser.add_argument("--port", help="Serial port of the dashboard")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--frames", type=int, default=16, help="Frames of dirty areas to fetch")
+    parser.add_argument("--decode", metavar="LOG", help="Decode SCREENSHOT lines from a saved serial log instead")
+    parser.add_argument("--output", default="screenshot", help="Base name of the PNG and JSON files")
+    parser.add_argument("--overlay", action="store_true", help="Also write the capture with dirty areas outlined")
+    parser.add_argument("--compare", metavar="PREV", help="Base name of an earlier capture to diff against")
+    parser.add_argument("--timeout", type=float, default=10.0, help="Seconds without output before giving up")
+    parser.add_argument("--mux", action="store_true", help="Request over the framed command channel")
+    args = parser.parse_args()
+    if not args.port and not args.decode:
+        parser.error("--port or --decode is required")
+
+    try:
+        if args.decode:
+            with open(args.decode, encoding="utf-8", errors="replace") as src:
+                lines = src.read().splitlines()
+        else:
+            started = time.time()
+            if args.mux:
+                lines, bulk = capture_mux(args.port, args.baud, args.frames, args.timeout)
+            else:
+                lines, bulk = capture(args.port, args.baud, args.frames, args.timeout), b""
+            print(f"Received in {time.time() - started:.1f}s")
+        header, data, dirty, trailer = parse_lines(lines)
+        data = data or bulk
+        pixel_size = 2 if header["format"] == "rgb565" else 3
+        raw = decode_rle(data, pixel_size, header["w"] * header["h"])
+    except (OSError, TimeoutError, RuntimeError, ValueError) as exc:
+        print(f"❌ Capture failed: {exc}")
+        return 1
+    if zlib.crc32(raw) != trailer["crc32"]:
+        print("❌ CRC mismatch, the transfer was corrupted")
+        return 1
+
+    width, height = header["w"], header["h"]
+    rgb = to_rgb(raw, header["format"])
+    write_png(args.output + ".png", width, height, rgb)
+    with open(args.output + ".json", "w", encoding="utf-8") as out:
+        json.dump({"header": header, "trailer": trailer, "dirty": dirty}, out, indent=1)
+    if args.overlay:
+        write_png(args.output + "_dirty.png", width, height, draw_overlay(width, rgb, dirty))
+
+    ratio = len(data) / len(raw)
+    print(f"✅ {width}x{height} {header['format']} written to {args.output}.png, "
+          f"{len(data)} bytes encoded ({ratio:.1%}), {len(dirty)} dirty frames")
+
+    if args.compare:
+        try:
+            return 0 if compare(args.compare, header, rgb, dirty) else 1
+        except (OSError, ValueError) as exc:
+            print(f"❌ Compare failed: {exc}")
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Serial Link Channels
+=============================
+
+Host side of the framed command channel (main/serial/serial_mux.h):
+1. Sends commands as control requests with a request id
+2. Splits the incoming stream into telemetry frames, responses per request,
+   bulk data per request, log frames and left-over plain text
+3. With --logs, moves the device's ESP log output into log frames
+   (UART link only) and prints it until --duration runs out
+4. With --baud-up, steps the UART up through faster rates first, testing
+   each in both directions before committing it (main/serial/serial_baud.h)
+
+Several requests may be in flight, responses are matched by id. Bulk data
+of a request, e.g. the raw encoded SCREENSHOT data, is written to
+--bulk-out.
+
+Requirements:
+    pip install pyserial
+
+Usage:
+    python serial_link.py --port COM3 STATS GET_DISPLAY_METRICS
+    python serial_link.py --port COM3 --bulk-out screen.rle "SCREENSHOT 0"
+    python serial_link.py --port COM3 --logs --duration 30
+    python serial_link.py --port COM3 --baud-up 921600,2000000,3000000 STATS
+"""
+
+import argparse
+import json
+import random
+import struct
+import sys
+import time
+from typing import Dict, List, Optional, Tuple
+
+# Mirrors main/serial/serial_mux.h and telemetry_frame.h
+FRAME_VERSION = 1
+MSG_MUX = 0x10
+CHANNEL_TELEMETRY = 0
+CHANNEL_CONTROL = 1
+CHANNEL_LOG = 2
+CHANNEL_BULK = 3
+FLAG_REQUEST = 0x01
+FLAG_MORE = 0x02
+FLAG_ERROR = 0x04
+REQUEST_MAX = 160 - 6 - 2
+BAUD_TEST_LEN = 128  # SERIAL_BAUD_TEST_LEN
+
+
+def crc16_ccitt(data: bytes) -> int:
+    """CRC16-CCITT, poly 0x1021, init 0xFFFF (telemetry_frame_crc16)."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """Consistent Overhead Byte Stuffing."""
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> Optional[bytes]:
+    """Inverse of cobs_encode, None on malformed input."""
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            return None
+        out += data[pos + 1:pos + code]
+        pos += code
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def baud_pattern(seed: int) -> str:
+    """Link test pattern of a seed, the same xorshift32 as serial_baud_pattern()."""
+    x = seed or 0x9E3779B9
+    out = []
+    for _ in range(BAUD_TEST_LEN):
+        x ^= (x << 13) & 0xFFFFFFFF
+        x ^= x >> 17
+        x ^= (x << 5) & 0xFFFFFFFF
+        c = 0x21 + x % 94
+        out.append(chr(c + 1 if c in (0x22, 0x5C) else c))
+    return "".join(out)
+
+
+def reply_json(response) -> dict:
+    """JSON object of a "NAME {...}" reply, empty if there is none."""
+    text = response.text.decode("utf-8", "replace")
+    start = text.find("{")
+    try:
+        return json.loads(text[start:]) if start >= 0 else {}
+    except ValueError:
+        return {}
+
+
+def encode_request(request_id: int, command: str) -> bytes:
+    """Delimited control request frame."""
+    body = command.encode("utf-8")
+    if len(body) > REQUEST_MAX:
+        raise ValueError(f"command longer than {REQUEST_MAX} bytes")
+    payload = struct.pack("<BBBBH", FRAME_VERSION, MSG_MUX, CHANNEL_CONTROL, FLAG_REQUEST, request_id) + body
+    payload += struct.pack("<H", crc16_ccitt(payload))
+    return b"\x00" + cobs_encode(payload) + b"\x00"
+
+
+class Response:
+    """Everything the device sent for one request."""
+
+    def __init__(self):
+        self.text = bytearray()
+        self.bulk = bytearray()
+        self.error = False
+        self.done = False
+
+
+class SerialLink:
+    def __init__(self, conn):
+        """Wrap an open pyserial connection."""
+        self.conn = conn
+        self.next_id = 1
+        self.responses: Dict[int, Response] = {}
+        self.logs: List[str] = []
+        self.lines: List[str] = []  # Plain text lines, e.g. JSON telemetry or output of other tasks
+        self.text = bytearray()
+        self.telemetry_frames = 0
+        self.crc_errors = 0
+        self.rx = bytearray()
+        self.in_frame = False
+
+    def send(self, command: str) -> int:
+        """Send a command as a control request, return its id."""
+        request_id = self.next_id
+        self.next_id = self.next_id % 0xFFFF + 1
+        self.responses[request_id] = Response()
+        self.conn.write(encode_request(request_id, command))
+        self.conn.flush()
+        return request_id
+
+    def poll(self):
+        """Read what arrived and sort it into responses, logs and text."""
+        data = self.conn.read(self.conn.in_waiting or 1)
+        for byte in data:
+            if byte == 0:
+                if self.in_frame and self.rx:
+                    self._frame(bytes(self.rx))
+                    self.in_frame = False
+                else:
+                    self.in_frame = True
+                    self.text.clear()
+                self.rx.clear()
+            elif self.in_frame:
+                self.rx.append(byte)
+            elif byte == 0x0A:
+                self.lines.append(self.text.decode("utf-8", "replace").rstrip("\r"))
+                self.text.clear()
+            else:
+                self.text.append(byte)
+
+    def _frame(self, encoded: bytes):
+        payload = cobs_decode(encoded)
+        if not payload or len(payload) < 4 or crc16_ccitt(payload[:-2]) != struct.unpack("<H", payload[-2:])[0]:
+            self.crc_errors += 1
+            return
+        payload = payload[:-2]
+        if payload[1] != MSG_MUX:
+            self.telemetry_frames += 1
+            return
+        _, _, channel, flags, request_id = struct.unpack("<BBBBH", payload[:6])
+        body = payload[6:]
+        if channel == CHANNEL_LOG:
+            self.logs.append(body.decode("utf-8", "replace").rstrip("\n"))
+            return
+        response = self.responses.get(request_id)
+        if response is None:
+            return
+        if channel == CHANNEL_BULK:
+            response.bulk += body
+        elif channel == CHANNEL_CONTROL:
+            response.text += body
+            response.error |= bool(flags & FLAG_ERROR)
+            response.done = not flags & FLAG_MORE
+
+    def request(self, command: str, timeout: float = 10.0) -> Tuple[Response, bool]:
+        """Send a command and wait for its response, return it and whether it completed."""
+        request_id = self.send(command)
+        response = self.responses[request_id]
+        deadline = time.time() + timeout
+        while not response.done and time.time() < deadline:
+            self.poll()
+        del self.responses[request_id]
+        return response, response.done
+
+
+def negotiate_baud(link: SerialLink, rates: List[int], timeout: float) -> int:
+    """Step the UART up through rates, stop at the first that fails, return the rate in use."""
+    conn = link.conn
+    for rate in rates:
+        response, done = link.request(f"BAUD_TRY {rate}", timeout)
+        offer = reply_json(response)
+        if not done or offer.get("rate") != rate:
+            print(f"BAUD_TRY {rate} refused: {response.text.decode('utf-8', 'replace').strip()}")
+            break
+        previous = conn.baudrate
+        time.sleep(offer["switch_ms"] * 2 / 1000)
+        conn.baudrate = rate
+        conn.reset_input_buffer()
+
+        seed = random.getrandbits(32)
+        response, done = link.request(f"BAUD_TEST {seed} {baud_pattern(seed)}", timeout)
+        echo_ok = done and reply_json(response).get("echo") == baud_pattern(seed ^ 0xFFFFFFFF)
+        committed = False
+        if echo_ok:
+            response, done = link.request("BAUD_COMMIT", timeout)
+            committed = done and reply_json(response).get("committed") is True
+        if not committed:
+            # The device returns to the previous rate once its confirm window is over
+            time.sleep(offer["confirm_ms"] / 1000)
+            conn.baudrate = previous
+            conn.reset_input_buffer()
+            print(f"{rate} baud failed the link test, staying at {previous}")
+            break
+        print(f"Link now at {rate} baud")
+    return conn.baudrate
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Send commands over the dashboard's framed command channel")
+    parser.add_argument("commands", nargs="*", help="Commands to run, one request each")
+    parser.add_argument("--port", "-p", required=True, help="Serial port of the dashboard")
+    parser.add_argument("--baudrate", "-b", type=int, default=115200, help="Baud rate (default: 115200)")
+    parser.add_argument("--timeout", type=float, default=10.0, help="Seconds to wait for each response")
+    parser.add_argument("--bulk-out", help="Write the bulk data of the responses to this file")
+    parser.add_argument("--logs", action="store_true", help="Move ESP log output into log frames and print it")
+    parser.add_argument("--duration", type=float, default=10.0, help="Seconds to print logs for (default: 10)")
+    parser.add_argument("--baud-up", help="Comma-separated rates to step the UART up through, e.g. 921600,2000000")
+    args = parser.parse_args()
+
+    import serial
+
+    failed = False
+    bulk = bytearray()
+    with serial.Serial(args.port, args.baudrate, timeout=0.05) as conn:
+        conn.reset_input_buffer()
+        link = SerialLink(conn)
+        if args.baud_up:
+            negotiate_baud(link, [int(rate) for rate in args.baud_up.split(",")], args.timeout)
+        for command in args.commands:
+            started = time.time()
+            response, done = link.request(command, args.timeout)
+            status = "error" if response.error else ("ok" if done else "timeout")
+            print(f"> {command}  [{status}, {(time.time() - started) * 1000:.0f} ms, "
+                  f"{len(response.text)} B text, {len(response.bulk)} B bulk]")
+            sys.stdout.write(response.text.decode("utf-8", "replace"))
+            if response.text and not response.text.endswith(b"\n"):
+                print()
+            bulk += response.bulk
+            failed |= status != "ok"
+
+        if args.logs:
+            response, done = link.request("LOG_CHANNEL ON", args.timeout)
+            sys.stdout.write(response.text.decode("utf-8", "replace"))
+            deadline = time.time() + args.duration
+            try:
+                while time.time() < deadline:
+                    link.poll()
+                    for line in link.logs:
+                        print(line)
+                    link.logs.clear()
+                    link.lines.clear()
+            finally:
+                link.request("LOG_CHANNEL OFF", args.timeout)
+
+        if link.crc_errors:
+            print(f"{link.crc_errors} damaged frames")
+
+    if args.bulk_out and bulk:
+        with open(args.bulk_out, "wb") as f:
+            f.write(bulk)
+        print(f"{len(bulk)} bulk bytes written to {args.bulk_out}")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
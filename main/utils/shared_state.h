@@ -0,0 +1,160 @@
+/**
+ * @file shared_state.h
+ * @brief Lock-free primitives for state one task writes and another reads
+ *
+ * Flags, enums and counters that cross cores are read and written through
+ * the shared_* helpers: a store publishes everything written before it, a
+ * load sees everything the store published. Nothing here takes a lock.
+ *
+ * Structs too large for one atomic word (a telemetry sample, parser
+ * statistics) are guarded by a seqlock. The writer bumps the sequence to
+ * odd, writes, and bumps it back to even; a reader copies the struct and
+ * retries if the sequence moved meanwhile. Readers never block the writer
+ * and never take a lock. Writers must be serialized among themselves, by
+ * being a single task or by a lock of their own.
+ *
+ * A reader that preempted the writer on the same core would spin on an odd
+ * sequence forever, so after SEQLOCK_SPINS_BEFORE_YIELD tries it sleeps a
+ * tick and lets the writer finish. Readers must not run in an ISR.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define SEQLOCK_SPINS_BEFORE_YIELD 64
+
+  // =======================================================================
+  // ATOMIC WORDS
+  // =======================================================================
+
+  static inline bool shared_load_bool(const bool *flag)
+  {
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+  }
+
+  static inline void shared_store_bool(bool *flag, bool value)
+  {
+    __atomic_store_n(flag, value, __ATOMIC_RELEASE);
+  }
+
+  static inline uint32_t shared_load_u32(const uint32_t *word)
+  {
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+  }
+
+  static inline void shared_store_u32(uint32_t *word, uint32_t value)
+  {
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief Store a word and return the one it replaced
+   */
+  static inline uint32_t shared_exchange_u32(uint32_t *word, uint32_t value)
+  {
+    return __atomic_exchange_n(word, value, __ATOMIC_ACQ_REL);
+  }
+
+  /**
+   * @brief Add to a counter read by other tasks, returns the new value
+   */
+  static inline uint32_t shared_add_u32(uint32_t *word, uint32_t n)
+  {
+    return __atomic_add_fetch(word, n, __ATOMIC_RELAXED);
+  }
+
+  // =======================================================================
+  // SEQLOCK
+  // =======================================================================
+
+  typedef struct
+  {
+    uint32_t seq; ///< Odd while a write is in progress
+  } seqlock_t;
+
+#define SEQLOCK_INIT {.seq = 0}
+
+  static inline void seqlock_write_begin(seqlock_t *lock)
+  {
+    __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELAXED);
+    // The odd sequence is visible before any of the data written next
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+
+  static inline void seqlock_write_end(seqlock_t *lock)
+  {
+    __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief Wait out a write in progress and return the sequence to check against
+   */
+  static inline uint32_t seqlock_read_begin(const seqlock_t *lock)
+  {
+    uint32_t seq;
+    int spins = 0;
+    while ((seq = __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE)) & 1)
+    {
+      if (++spins >= SEQLOCK_SPINS_BEFORE_YIELD)
+      {
+        vTaskDelay(1);
+        spins = 0;
+      }
+    }
+    return seq;
+  }
+
+  /**
+   * @brief Sequence of the last completed write, a cheap check for new data without copying it
+   */
+  static inline uint32_t seqlock_sequence(const seqlock_t *lock)
+  {
+    return __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE) & ~1u;
+  }
+
+  /**
+   * @brief True if a write overlapped the read, whose copy must be discarded
+   */
+  static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t seq)
+  {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&lock->seq, __ATOMIC_RELAXED) != seq;
+  }
+
+  /**
+   * @brief Copy a seqlock-guarded object into dst, retrying until the copy is consistent
+   */
+#define SEQLOCK_READ(lock, dst, src)                  \
+  do                                                  \
+  {                                                   \
+    uint32_t seqlock_seq_;                            \
+    do                                                \
+    {                                                 \
+      seqlock_seq_ = seqlock_read_begin(lock);        \
+      memcpy((dst), (src), sizeof(*(dst)));           \
+    } while (seqlock_read_retry(lock, seqlock_seq_)); \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHARED_STATE_H
@@ -0,0 +1,518 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Soak Test
+==================
+
+Keeps the dashboard busy for hours and watches for slow regressions:
+1. Streams telemetry, synthetic or replayed from a capture
+2. Plays a touch script through TOUCH_INJECT (taps, long presses and
+   two-finger swipes that go through the real gesture and LVGL paths)
+3. Optionally runs the mock Home Assistant server in-process and starts
+   HA_LATENCY_TEST on the device at intervals
+4. Samples GET_METRICS, GET_TASK_STATS and GET_TOUCH_LATENCY periodically
+   into a JSONL file
+5. At the end flags heap leaks, fragmentation growth, rising latency
+   percentiles, shrinking stack watermarks and reboots, both within the
+   run and against a stored baseline
+
+The first --warmup minutes are excluded from trends, boot-time allocations
+and caches filling up would otherwise look like leaks. Latency percentiles
+from the registry histograms are upper bucket edges (powers of two), so a
+change shows up as a step of one bucket.
+
+Requirements:
+    pip install pyserial
+
+Usage:
+    python soak_test.py --port COM3 --hours 8 --output soak.jsonl
+    python soak_test.py --port COM3 --hours 4 --mock-ha "--entities 2000 --latency-ms 80 --jitter-ms 60 --quiet"
+    python soak_test.py --port COM3 --hours 8 --baseline baseline.json
+    python soak_test.py --analyze soak.jsonl --save-baseline baseline.json
+"""
+
+import argparse
+import json
+import re
+import shlex
+import sys
+import threading
+import time
+from collections import deque
+from typing import Dict, List, Optional, Tuple
+
+# Reply prefixes the soak test waits for, everything else is log output
+REPLY_PREFIXES = ("METRICS ", "TASK_STATS ", "TOUCH_LATENCY ", "HA_LATENCY ", "TOUCH_INJECT ", "TOUCH_SCRIPT ")
+# Lines that mean the device restarted underneath the test
+RESET_MARKERS = ("rst:0x", "Guru Meditation", "abort() was called", "Rebooting...")
+
+# Histograms from the metrics registry tracked for latency regressions
+LATENCY_HISTOGRAMS = ("ha_request_duration_ms", "ha_parse_duration_us")
+# Gauges averaged per window, already means over the device's own window
+LATENCY_GAUGES = ("display_render_us", "display_flush_us", "display_lock_wait_us")
+
+# Default script: taps on both columns, a long press, page swipes both ways
+DEFAULT_TOUCH_SCRIPT = [
+    {"tap": [200, 240]},
+    {"tap": [600, 240]},
+    {"tap": [400, 420], "ms": 700},
+    {"swipe": [600, 240, 200, 240], "ms": 300, "fingers": 2},
+    {"swipe": [200, 240, 600, 240], "ms": 300, "fingers": 2},
+]
+
+PROMETHEUS_LINE = re.compile(r"^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{([^}]*)\})?\s+(-?[0-9.eE+]+)$")
+
+
+# =======================================================================
+# DEVICE LINK
+# =======================================================================
+
+
+class DeviceLink:
+    """Serial port shared by the telemetry, touch and sampling threads."""
+
+    def __init__(self, port: str, baudrate: int):
+        import serial
+
+        self.conn = serial.Serial(port=port, baudrate=baudrate, timeout=0.1, write_timeout=2)
+        self.write_lock = threading.Lock()
+        self.query_lock = threading.Lock()
+        self.lines = deque(maxlen=4096)
+        self.lines_ready = threading.Condition()
+        self.resets = 0
+        self.running = True
+        self.reader = threading.Thread(target=self._read_loop, daemon=True)
+        self.reader.start()
+
+    def close(self):
+        self.running = False
+        self.reader.join(timeout=1.0)
+        self.conn.close()
+
+    def _read_loop(self):
+        buffer = b""
+        while self.running:
+            chunk = self.conn.read(max(1, self.conn.in_waiting))
+            if not chunk:
+                continue
+            buffer += chunk
+            *complete, buffer = buffer.split(b"\n")
+            for raw in complete:
+                line = raw.decode("utf-8", errors="ignore").strip()
+                if any(marker in line for marker in RESET_MARKERS):
+                    self.resets += 1
+                    print(f"🔥 Device reset seen: {line[:80]}")
+                start = min((line.find(p) for p in REPLY_PREFIXES if p in line), default=-1)
+                if start >= 0:
+                    with self.lines_ready:
+                        self.lines.append(line[start:])
+                        self.lines_ready.notify_all()
+
+    def write(self, data: bytes):
+        with self.write_lock:
+            self.conn.write(data)
+
+    def _collect(self, command: str, done, timeout: float) -> List[str]:
+        """Send a command and gather reply lines until done(lines) or the timeout."""
+        with self.query_lock:
+            with self.lines_ready:
+                self.lines.clear()
+            self.write(f"{command}\n".encode("ascii"))
+            collected: List[str] = []
+            deadline = time.time() + timeout
+            with self.lines_ready:
+                while time.time() < deadline:
+                    while self.lines:
+                        collected.append(self.lines.popleft())
+                    if done(collected):
+                        return collected
+                    self.lines_ready.wait(timeout=max(0.0, deadline - time.time()))
+            return collected
+
+    def query_json(self, command: str, prefix: str, timeout: float = 5.0) -> Optional[Dict]:
+        tag = prefix + " {"
+        lines = self._collect(command, lambda got: any(l.startswith(tag) for l in got), timeout)
+        for line in lines:
+            if line.startswith(tag):
+                try:
+                    return json.loads(line[len(prefix) + 1:])
+                except json.JSONDecodeError:
+                    return None
+        return None
+
+    def query_metrics(self, timeout: float = 10.0) -> Optional[Dict[str, float]]:
+        """GET_METRICS as {"name{labels}": value}, None if the export did not complete."""
+        lines = self._collect("GET_METRICS", lambda got: "METRICS # EOF" in got, timeout)
+        if "METRICS # EOF" not in lines:
+            return None
+        values = {}
+        for line in lines:
+            match = PROMETHEUS_LINE.match(line[len("METRICS "):])
+            if match:
+                key = match.group(1) + (match.group(2) or "")
+                values[key] = float(match.group(4))
+        return values
+
+    def run_ha_latency_test(self, syncs: int, commands: int, timeout: float) -> List[Dict]:
+        def finished(got):
+            return any(l.startswith("HA_LATENCY ") and ('"done"' in l or '"error"' in l) for l in got)
+
+        replies = []
+        for line in self._collect(f"HA_LATENCY_TEST all {syncs} {commands}", finished, timeout):
+            if line.startswith("HA_LATENCY "):
+                try:
+                    replies.append(json.loads(line[len("HA_LATENCY "):]))
+                except json.JSONDecodeError:
+                    pass
+        return replies
+
+
+# =======================================================================
+# LOAD GENERATORS
+# =======================================================================
+
+
+def telemetry_loop(link: DeviceLink, rate: float, replay: Optional[str], stop: threading.Event):
+    from telemetry_load_test import TelemetryLoadTest, load_capture
+
+    generator = TelemetryLoadTest("unused")
+    samples = load_capture(replay) if replay else None
+    index = 0
+    period = 1.0 / rate
+    next_send = time.time()
+    while not stop.is_set():
+        if samples:
+            sample = dict(samples[index % len(samples)])
+            sample["ts"] = int(time.time() * 1000)
+            index += 1
+        else:
+            sample = generator.synthetic_sample()
+        link.write((json.dumps(sample, separators=(",", ":")) + "\n").encode("utf-8"))
+        next_send += period
+        stop.wait(max(0.0, next_send - time.time()))
+
+
+def touch_command(step: Dict) -> str:
+    if "tap" in step:
+        x, y = step["tap"]
+        return f"TOUCH_INJECT {x} {y} {step.get('ms', 80)}"
+    x0, y0, x1, y1 = step["swipe"]
+    return f"TOUCH_INJECT {x0} {y0} {x1} {y1} {step.get('ms', 300)} {step.get('fingers', 1)}"
+
+
+def touch_loop(link: DeviceLink, script: List[Dict], interval: float, stop: threading.Event):
+    index = 0
+    while not stop.wait(interval):
+        step = script[index % len(script)]
+        link.write((touch_command(step) + "\n").encode("ascii"))
+        index += 1
+
+
+def start_mock_ha(options: str):
+    from mock_ha_server import build_parser, start_server
+
+    server, mock = start_server(build_parser().parse_args(shlex.split(options)))
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server, mock
+
+
+# =======================================================================
+# SAMPLING
+# =======================================================================
+
+
+def take_sample(link: DeviceLink, start: float) -> Dict:
+    sample = {"t": round(time.time() - start, 1), "resets": link.resets}
+    sample["metrics"] = link.query_metrics()
+    tasks = link.query_json("GET_TASK_STATS", "TASK_STATS")
+    if tasks and "tasks" in tasks:
+        sample["stack_free"] = {task["name"]: task["stack_free"] for task in tasks["tasks"]}
+    touch = link.query_json("GET_TOUCH_LATENCY", "TOUCH_LATENCY")
+    if touch and "error" not in touch:
+        sample["touch_latency"] = touch
+    return sample
+
+
+def run_soak(args) -> List[Dict]:
+    link = DeviceLink(args.port, args.baudrate)
+    stop = threading.Event()
+    threads = []
+    mock_server = None
+    samples: List[Dict] = []
+
+    try:
+        if args.mock_ha is not None:
+            mock_server, _ = start_mock_ha(args.mock_ha)
+        script = DEFAULT_TOUCH_SCRIPT
+        if args.touch_script:
+            with open(args.touch_script, encoding="utf-8") as f:
+                script = json.load(f)
+
+        if args.telemetry_rate > 0:
+            threads.append(threading.Thread(target=telemetry_loop,
+                                            args=(link, args.telemetry_rate, args.replay, stop), daemon=True))
+        if args.touch_interval > 0:
+            threads.append(threading.Thread(target=touch_loop, args=(link, script, args.touch_interval, stop),
+                                            daemon=True))
+        for thread in threads:
+            thread.start()
+
+        start = time.time()
+        end = start + args.hours * 3600
+        next_sample = start
+        next_ha_test = start + args.warmup * 60 if args.ha_test_interval > 0 else float("inf")
+        print(f"🔁 Soak test for {args.hours:g} h, sampling every {args.sample_interval:g} s")
+
+        with open(args.output, "w", encoding="utf-8") as out:
+            while time.time() < end:
+                now = time.time()
+                if now >= next_sample:
+                    sample = take_sample(link, start)
+                    if now >= next_ha_test:
+                        sample["ha_latency"] = link.run_ha_latency_test(args.ha_syncs, args.ha_commands, 600)
+                        next_ha_test = now + args.ha_test_interval * 60
+                    samples.append(sample)
+                    out.write(json.dumps(sample) + "\n")
+                    out.flush()
+                    print_progress(sample)
+                    next_sample += args.sample_interval
+                time.sleep(min(1.0, max(0.0, next_sample - time.time())))
+    except KeyboardInterrupt:
+        print("\n⏹️  Stopped early, analysing what was collected")
+    finally:
+        stop.set()
+        for thread in threads:
+            thread.join(timeout=2.0)
+        if mock_server:
+            mock_server.shutdown()
+        link.close()
+    return samples
+
+
+def print_progress(sample: Dict):
+    metrics = sample.get("metrics") or {}
+    internal = metrics.get('heap_free_bytes{region="internal"}')
+    largest = metrics.get('heap_largest_free_block_bytes{region="internal"}')
+    stacks = sample.get("stack_free") or {}
+    low_stack = min(stacks.items(), key=lambda kv: kv[1]) if stacks else ("-", 0)
+    print(f"  t={sample['t'] / 60:7.1f} min  internal free {internal or 0:8.0f} B  largest {largest or 0:8.0f} B  "
+          f"lowest stack {low_stack[0]}={low_stack[1]} B  resets {sample['resets']}")
+
+
+# =======================================================================
+# ANALYSIS
+# =======================================================================
+
+
+def slope_per_hour(points: List[Tuple[float, float]]) -> float:
+    """Least-squares slope of (seconds, value) in value per hour."""
+    if len(points) < 3:
+        return 0.0
+    n = len(points)
+    mean_t = sum(t for t, _ in points) / n
+    mean_v = sum(v for _, v in points) / n
+    var = sum((t - mean_t) ** 2 for t, _ in points)
+    if var == 0:
+        return 0.0
+    return sum((t - mean_t) * (v - mean_v) for t, v in points) / var * 3600
+
+
+def median(values: List[float]) -> Optional[float]:
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[len(ordered) // 2]
+
+
+def histogram_percentiles(before: Dict[str, float], after: Dict[str, float], name: str) -> Optional[Dict]:
+    """p50/p90/p99 bucket edges of the observations between two samples."""
+    prefix = name + "_bucket{le=\""
+    buckets = []
+    for key, value in after.items():
+        if key.startswith(prefix):
+            edge = key[len(prefix):-2]
+            delta = value - before.get(key, 0.0)
+            buckets.append((float("inf") if edge == "+Inf" else float(edge), delta))
+    buckets.sort()
+    if not buckets or buckets[-1][1] <= 0:
+        return None
+    total = buckets[-1][1]
+    result = {"n": int(total)}
+    for pct in (50, 90, 99):
+        target = total * pct / 100.0
+        result[f"p{pct}"] = next(edge for edge, cumulative in buckets if cumulative >= target)
+    return result
+
+
+def analyze(samples: List[Dict], warmup_min: float) -> Dict:
+    """Summary of a run: heap trends, fragmentation, latency per window, stack minimums."""
+    steady = [s for s in samples if s["t"] >= warmup_min * 60 and s.get("metrics")]
+    summary: Dict = {"samples": len(samples), "steady_samples": len(steady),
+                     "hours": round(samples[-1]["t"] / 3600, 2) if samples else 0,
+                     "resets": samples[-1]["resets"] if samples else 0}
+
+    # Uptime going backwards catches resets whose log line was missed
+    uptimes = [s["metrics"].get("uptime_seconds") for s in samples if s.get("metrics")]
+    summary["resets"] += sum(1 for a, b in zip(uptimes, uptimes[1:]) if a is not None and b is not None and b < a)
+    if len(steady) < 4:
+        summary["error"] = "not enough samples after the warmup"
+        return summary
+
+    heap = {}
+    for region in ("internal", "spiram"):
+        free_key = f'heap_free_bytes{{region="{region}"}}'
+        largest_key = f'heap_largest_free_block_bytes{{region="{region}"}}'
+        free = [(s["t"], s["metrics"][free_key]) for s in steady if free_key in s["metrics"]]
+        ratios = [s["metrics"][largest_key] / s["metrics"][free_key] for s in steady
+                  if s["metrics"].get(free_key) and largest_key in s["metrics"]]
+        quarter = max(1, len(ratios) // 4)
+        heap[region] = {
+            "free_slope_bytes_per_hour": round(slope_per_hour(free), 1),
+            "free_first": free[0][1] if free else None,
+            "free_last": free[-1][1] if free else None,
+            "largest_ratio_first": round(median(ratios[:quarter]), 3) if ratios else None,
+            "largest_ratio_last": round(median(ratios[-quarter:]), 3) if ratios else None,
+        }
+    summary["heap"] = heap
+
+    # Latency of the first and last quarter of the steady part
+    quarter = max(2, len(steady) // 4)
+    windows = {"first": steady[:quarter], "last": steady[-quarter:]}
+    latency: Dict = {}
+    for name in LATENCY_HISTOGRAMS:
+        latency[name] = {label: histogram_percentiles(w[0]["metrics"], w[-1]["metrics"], name)
+                         for label, w in windows.items()}
+    for name in LATENCY_GAUGES:
+        latency[name] = {label: median([s["metrics"][name] for s in w if name in s["metrics"]])
+                         for label, w in windows.items()}
+    touch = [s["touch_latency"] for s in steady if s.get("touch_latency")]
+    if touch and touch[-1].get("photon_us"):
+        latency["touch_photon_p95_us"] = touch[-1]["photon_us"]["p95"]
+    ha_runs = [r for s in steady for r in s.get("ha_latency", []) if "p90_ms" in r]
+    if ha_runs:
+        by_series: Dict[str, List[float]] = {}
+        for run in ha_runs:
+            by_series.setdefault(run.get("path") or "commands", []).append(run["p90_ms"])
+        latency["ha_p90_ms"] = {series: {"first": values[0], "last": values[-1]} for series, values in by_series.items()}
+    summary["latency"] = latency
+
+    stacks: Dict[str, int] = {}
+    for sample in samples:
+        for task, free in (sample.get("stack_free") or {}).items():
+            stacks[task] = min(free, stacks.get(task, free))
+    summary["stack_min_free"] = stacks
+    return summary
+
+
+def find_regressions(summary: Dict, baseline: Optional[Dict], args) -> List[str]:
+    findings = []
+    if summary.get("error"):
+        return [summary["error"]]
+    if summary["resets"]:
+        findings.append(f"device reset {summary['resets']} time(s) during the run")
+
+    for region, heap in summary["heap"].items():
+        slope = heap["free_slope_bytes_per_hour"]
+        if slope < -args.leak_bytes_per_hour:
+            findings.append(f"{region} heap shrinking by {-slope:.0f} B/h (limit {args.leak_bytes_per_hour:.0f})")
+        first, last = heap["largest_ratio_first"], heap["largest_ratio_last"]
+        if first and last and last < first - args.fragmentation_drop:
+            findings.append(f"{region} fragmentation growing: largest/free {first:.2f} -> {last:.2f}")
+        if baseline and region in baseline.get("heap", {}):
+            base_last = baseline["heap"][region].get("free_last")
+            if base_last and heap["free_last"] and heap["free_last"] < base_last * (1 - args.latency_tolerance):
+                findings.append(f"{region} free heap {heap['free_last']:.0f} B, baseline {base_last:.0f} B")
+
+    for name, windows in summary["latency"].items():
+        if name in LATENCY_HISTOGRAMS:
+            first, last = windows.get("first"), windows.get("last")
+            if first and last and last["p90"] > first["p90"]:
+                findings.append(f"{name} p90 rose during the run: {first['p90']:g} -> {last['p90']:g}")
+            base = baseline and baseline.get("latency", {}).get(name, {}).get("last")
+            if base and last and last["p90"] > base["p90"]:
+                findings.append(f"{name} p90 {last['p90']:g}, baseline {base['p90']:g}")
+        elif name in LATENCY_GAUGES:
+            first, last = windows.get("first"), windows.get("last")
+            if first and last and last > first * (1 + args.latency_tolerance):
+                findings.append(f"{name} rose during the run: {first:.0f} -> {last:.0f} us")
+            base = baseline and baseline.get("latency", {}).get(name, {}).get("last")
+            if base and last and last > base * (1 + args.latency_tolerance):
+                findings.append(f"{name} {last:.0f} us, baseline {base:.0f} us")
+        elif name == "touch_photon_p95_us":
+            base = baseline and baseline.get("latency", {}).get(name)
+            if base and windows > base * (1 + args.latency_tolerance):
+                findings.append(f"touch-to-photon p95 {windows} us, baseline {base} us")
+        elif name == "ha_p90_ms":
+            for series, values in windows.items():
+                if values["last"] > values["first"] * (1 + args.latency_tolerance):
+                    findings.append(f"HA {series} p90 rose during the run: {values['first']} -> {values['last']} ms")
+
+    if baseline:
+        for task, free in summary["stack_min_free"].items():
+            base = baseline.get("stack_min_free", {}).get(task)
+            if base is not None and free < base - args.stack_margin:
+                findings.append(f"task {task} stack headroom {free} B, baseline {base} B")
+    return findings
+
+
+def load_samples(path: str) -> List[Dict]:
+    with open(path, encoding="utf-8") as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="ESP32-S3 long-duration soak test")
+    parser.add_argument("--port", "-p", help="Serial port of the dashboard")
+    parser.add_argument("--baudrate", "-b", type=int, default=115200)
+    parser.add_argument("--hours", type=float, default=8.0, help="Run length (default: 8)")
+    parser.add_argument("--warmup", type=float, default=10.0, help="Minutes left out of trends (default: 10)")
+    parser.add_argument("--sample-interval", type=float, default=60.0, help="Seconds between samples (default: 60)")
+    parser.add_argument("--output", "-o", default="soak.jsonl", help="Samples, one JSON object per line")
+    parser.add_argument("--telemetry-rate", type=float, default=2.0, help="Telemetry samples per second, 0 for none")
+    parser.add_argument("--replay", help="JSONL telemetry capture to loop instead of synthetic samples")
+    parser.add_argument("--touch-interval", type=float, default=5.0, help="Seconds between touch strokes, 0 for none")
+    parser.add_argument("--touch-script", help="JSON list of {\"tap\":[x,y]} / {\"swipe\":[x0,y0,x1,y1]} steps")
+    parser.add_argument("--mock-ha", nargs="?", const="--quiet", help="Run mock_ha_server.py in-process with these options")
+    parser.add_argument("--ha-test-interval", type=float, default=0.0, help="Minutes between HA_LATENCY_TEST runs, 0 for none")
+    parser.add_argument("--ha-syncs", type=int, default=10)
+    parser.add_argument("--ha-commands", type=int, default=10)
+    parser.add_argument("--analyze", help="Analyse an existing samples file instead of running")
+    parser.add_argument("--baseline", help="Summary of a known-good run to compare against")
+    parser.add_argument("--save-baseline", help="Write this run's summary as a baseline")
+    parser.add_argument("--leak-bytes-per-hour", type=float, default=2048.0, help="Tolerated heap decline (default: 2048)")
+    parser.add_argument("--fragmentation-drop", type=float, default=0.1, help="Tolerated fall of largest/free (default: 0.1)")
+    parser.add_argument("--latency-tolerance", type=float, default=0.2, help="Tolerated relative rise (default: 0.2)")
+    parser.add_argument("--stack-margin", type=int, default=256, help="Tolerated stack headroom loss in bytes (default: 256)")
+    args = parser.parse_args()
+
+    if args.analyze:
+        samples = load_samples(args.analyze)
+    elif args.port:
+        samples = run_soak(args)
+    else:
+        parser.error("--port or --analyze is required")
+
+    summary = analyze(samples, args.warmup)
+    baseline = None
+    if args.baseline:
+        with open(args.baseline, encoding="utf-8") as f:
+            baseline = json.load(f)
+    findings = find_regressions(summary, baseline, args)
+
+    print()
+    print(json.dumps(summary, indent=2))
+    if args.save_baseline and not summary.get("error"):
+        with open(args.save_baseline, "w", encoding="utf-8") as f:
+            json.dump(summary, f, indent=2)
+        print(f"💾 Baseline written to {args.save_baseline}")
+
+    if findings:
+        print(f"\n❌ {len(findings)} regression(s):")
+        for finding in findings:
+            print(f"   - {finding}")
+        return 1
+    print("\n✅ No regressions found")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
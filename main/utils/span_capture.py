@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Span Capture
+=====================
+
+Records a timing span capture on the device and saves it as a Chrome trace
+JSON file, to open in https://ui.perfetto.dev or chrome://tracing:
+1. Sends SPANS_START (or SPANS_START RING) and waits for the given time
+2. Sends SPANS_EXPORT and collects the "SPANS " lines of the reply
+3. Joins them into one JSON document and checks that it parses
+
+Requirements:
+    pip install pyserial
+
+Usage:
+    python span_capture.py --port COM3 --duration 10 --output trace.json
+    python span_capture.py --port /dev/ttyACM0 --ring --duration 60
+"""
+
+import argparse
+import json
+import sys
+import time
+
+import serial
+
+
+def capture(port: str, baud: int, duration: float, ring: bool, timeout: float) -> str:
+    """Run one capture and return the exported JSON text."""
+    with serial.Serial(port, baud, timeout=0.1) as conn:
+        conn.reset_input_buffer()
+        conn.write(b"SPANS_START RING\n" if ring else b"SPANS_START\n")
+        conn.flush()
+        print(f"Recording for {duration:.0f}s...")
+        time.sleep(duration)
+        conn.reset_input_buffer()
+
+        conn.write(b"SPANS_EXPORT\n")
+        conn.flush()
+        parts = []
+        buffer = b""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            buffer += conn.read(4096)
+            *lines, buffer = buffer.split(b"\n")
+            for raw in lines:
+                line = raw.decode("utf-8", errors="replace").rstrip("\r")
+                start = line.find("SPANS ")
+                if start < 0:
+                    continue
+                payload = line[start + len("SPANS "):]
+                parts.append(payload)
+                if payload == "]}":
+                    return "\n".join(parts)
+                # More lines are coming, keep waiting from the newest one
+                deadline = time.time() + timeout
+        raise TimeoutError("export did not finish")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Capture timing spans into a Chrome trace file")
+    parser.add_argument("--port", required=True, help="Serial port of the dashboard")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--duration", type=float, default=10.0, help="Seconds to record")
+    parser.add_argument("--ring", action="store_true", help="Overwrite the oldest records instead of stopping when full")
+    parser.add_argument("--output", default="trace.json")
+    parser.add_argument("--timeout", type=float, default=5.0, help="Seconds without export output before giving up")
+    args = parser.parse_args()
+
+    try:
+        text = capture(args.port, args.baud, args.duration, args.ring, args.timeout)
+        trace = json.loads(text)
+    except (serial.SerialException, TimeoutError, json.JSONDecodeError) as exc:
+        print(f"❌ Capture failed: {exc}")
+        return 1
+
+    with open(args.output, "w", encoding="utf-8") as out:
+        json.dump(trace, out)
+    events = [e for e in trace["traceEvents"] if e.get("ph") != "M"]
+    print(f"✅ {len(events)} events written to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
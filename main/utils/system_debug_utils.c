@@ -13,11 +13,19 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_app_desc.h"
+#include "esp_attr.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "sdkconfig.h"
+#include "serial/serial_data_handler.h"
+#include "task_plan.h"
 
 #ifdef CONFIG_SYSTEM_DEBUG_ENABLED
 
@@ -38,11 +46,613 @@ static const char *debug_tag_strings[DEBUG_TAG_MAX] = {
     "LVGL_SETUP",
     "SYSTEM"};
 
+// =======================================================================
+// LOG RING
+// =======================================================================
+//
+// Log calls store a 64-byte binary record instead of formatting: the
+// format pointer (in flash), tag, level, timestamp and the arguments packed
+// as raw bytes, strings copied in. A slot is claimed with one atomic add,
+// so writers on either core never wait on each other or the UART. The
+// drain task formats records lazily; LOG_DUMP prints what is still in the
+// ring, including the tail of the boot before a soft reset.
+
+#if CONFIG_SYSTEM_DEBUG_LOG_RING
+
+#define LOG_RING_MAGIC 0x4C524731 // "LRG1", bump when log_ring_t changes
+#define LOG_RING_PAYLOAD 48
+#define LOG_RING_DRAIN_MS 100
+
+typedef struct
+{
+  uint32_t commit;    ///< seq + 1 once the record is complete, 0 while it is being written
+  uint32_t time_ms;   ///< esp_log_timestamp() when logged
+  const char *format; ///< Flash string, NULL when payload holds the formatted text
+  uint8_t tag;
+  uint8_t level;
+  uint8_t payload_len;
+  uint8_t reserved;
+  uint8_t payload[LOG_RING_PAYLOAD];
+} log_ring_record_t;
+
+typedef struct
+{
+  uint32_t magic;
+  uint8_t elf_sha[8];  ///< Format pointers are only valid for the image that wrote them
+  uint32_t boot_seq;   ///< First seq of this boot
+  uint32_t prev_seq;   ///< First seq of the previous boot
+  log_ring_record_t records[CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS];
+} log_ring_t;
+
+typedef enum
+{
+  SPEC_LEN_NONE,
+  SPEC_LEN_HH,
+  SPEC_LEN_H,
+  SPEC_LEN_L,
+  SPEC_LEN_LL,
+  SPEC_LEN_J,
+  SPEC_LEN_Z,
+  SPEC_LEN_T,
+  SPEC_LEN_BIG_L,
+} spec_len_t;
+
+typedef struct
+{
+  const char *start; ///< The '%'
+  const char *end;   ///< One past the conversion character
+  uint8_t stars;     ///< '*' width and precision, each an int argument
+  bool precision_star;
+  spec_len_t length;
+  char conversion;
+} log_spec_t;
+
+// Not cleared on reset, so the tail of a crashed boot is still readable
+static RTC_NOINIT_ATTR log_ring_t log_ring;
+
+static uint32_t log_next_seq = 0;  ///< Next seq to claim, atomic
+static uint32_t log_drain_seq = 0; ///< Next seq the drain task prints
+static uint32_t log_lost = 0;      ///< Records overwritten before they were drained
+static bool log_ring_ready = false;
+
+static const char log_level_letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+
+/**
+ * @brief Parse one conversion specification
+ * @param p Points at the '%'
+ * @return false at the end of the string
+ */
+static bool log_scan_spec(const char *p, log_spec_t *spec)
+{
+  spec->start = p++;
+  spec->stars = 0;
+  spec->precision_star = false;
+  spec->length = SPEC_LEN_NONE;
+
+  while (*p && strchr("-+ #0", *p))
+    p++;
+  if (*p == '*')
+  {
+    spec->stars++;
+    p++;
+  }
+  while (*p >= '0' && *p <= '9')
+    p++;
+  if (*p == '.')
+  {
+    p++;
+    if (*p == '*')
+    {
+      spec->stars++;
+      spec->precision_star = true;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9')
+      p++;
+  }
+
+  switch (*p)
+  {
+  case 'h':
+    spec->length = (p[1] == 'h') ? SPEC_LEN_HH : SPEC_LEN_H;
+    p += (p[1] == 'h') ? 2 : 1;
+    break;
+  case 'l':
+    spec->length = (p[1] == 'l') ? SPEC_LEN_LL : SPEC_LEN_L;
+    p += (p[1] == 'l') ? 2 : 1;
+    break;
+  case 'j':
+    spec->length = SPEC_LEN_J;
+    p++;
+    break;
+  case 'z':
+    spec->length = SPEC_LEN_Z;
+    p++;
+    break;
+  case 't':
+    spec->length = SPEC_LEN_T;
+    p++;
+    break;
+  case 'L':
+    spec->length = SPEC_LEN_BIG_L;
+    p++;
+    break;
+  default:
+    break;
+  }
+
+  if (*p == '\0')
+    return false;
+  spec->conversion = *p;
+  spec->end = p + 1;
+  return true;
+}
+
+static size_t log_int_size(spec_len_t length)
+{
+  switch (length)
+  {
+  case SPEC_LEN_L:
+    return sizeof(long);
+  case SPEC_LEN_LL:
+  case SPEC_LEN_J:
+    return sizeof(long long);
+  case SPEC_LEN_Z:
+    return sizeof(size_t);
+  case SPEC_LEN_T:
+    return sizeof(ptrdiff_t);
+  default:
+    return sizeof(int);
+  }
+}
+
+/**
+ * @brief Pack the arguments of a format into a payload
+ * @return false if a conversion is not supported or the arguments do not fit
+ */
+static bool log_pack_args(const char *format, va_list args, uint8_t *payload, uint8_t *payload_len)
+{
+  size_t used = 0;
+  for (const char *p = strchr(format, '%'); p; p = strchr(p, '%'))
+  {
+    if (p[1] == '%')
+    {
+      p += 2;
+      continue;
+    }
+
+    log_spec_t spec;
+    if (!log_scan_spec(p, &spec))
+      return false;
+    p = spec.end;
+
+    int precision = -1;
+    for (int i = 0; i < spec.stars; i++)
+    {
+      int value = va_arg(args, int);
+      if (used + sizeof(value) > LOG_RING_PAYLOAD)
+        return false;
+      memcpy(payload + used, &value, sizeof(value));
+      used += sizeof(value);
+      if (spec.precision_star && i == spec.stars - 1)
+        precision = value;
+    }
+
+    switch (spec.conversion)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+    {
+      size_t size = log_int_size(spec.length);
+      if (used + size > LOG_RING_PAYLOAD)
+        return false;
+      if (size == sizeof(long long))
+      {
+        long long value = va_arg(args, long long);
+        memcpy(payload + used, &value, size);
+      }
+      else if (size == sizeof(long))
+      {
+        long value = va_arg(args, long);
+        memcpy(payload + used, &value, size);
+      }
+      else
+      {
+        int value = va_arg(args, int);
+        memcpy(payload + used, &value, size);
+      }
+      used += size;
+      break;
+    }
+    case 'p':
+    {
+      void *value = va_arg(args, void *);
+      if (used + sizeof(value) > LOG_RING_PAYLOAD)
+        return false;
+      memcpy(payload + used, &value, sizeof(value));
+      used += sizeof(value);
+      break;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+    {
+      if (spec.length == SPEC_LEN_BIG_L)
+        return false;
+      double value = va_arg(args, double);
+      if (used + sizeof(value) > LOG_RING_PAYLOAD)
+        return false;
+      memcpy(payload + used, &value, sizeof(value));
+      used += sizeof(value);
+      break;
+    }
+    case 's':
+    {
+      // Copied, the caller's buffer is gone by the time the record is printed; long strings are cut
+      const char *value = va_arg(args, const char *);
+      if (!value)
+        value = "(null)";
+      if (used + 2 > LOG_RING_PAYLOAD)
+        return false;
+      size_t room = LOG_RING_PAYLOAD - used - 1;
+      size_t len = strnlen(value, (precision >= 0 && (size_t)precision < room) ? (size_t)precision : room);
+      memcpy(payload + used, value, len);
+      payload[used + len] = '\0';
+      used += len + 1;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+
+  *payload_len = (uint8_t)used;
+  return true;
+}
+
+/**
+ * @brief Format a record's message the way vsnprintf would have
+ */
+static void log_format_record(const log_ring_record_t *record, char *out, size_t size)
+{
+  if (!record->format)
+  {
+    size_t len = strnlen((const char *)record->payload, record->payload_len);
+    len = (len < size - 1) ? len : size - 1;
+    memcpy(out, record->payload, len);
+    out[len] = '\0';
+    return;
+  }
+  if (!esp_ptr_in_drom(record->format))
+  {
+    snprintf(out, size, "<bad record>");
+    return;
+  }
+
+  const char *format = record->format;
+  const uint8_t *arg = record->payload;
+  const uint8_t *arg_end = record->payload + record->payload_len;
+  size_t len = 0;
+  out[0] = '\0';
+
+  while (*format && len < size - 1)
+  {
+    const char *percent = strchr(format, '%');
+    size_t literal = percent ? (size_t)(percent - format) : strlen(format);
+    if (literal > size - 1 - len)
+      literal = size - 1 - len;
+    memcpy(out + len, format, literal);
+    len += literal;
+    out[len] = '\0';
+    if (!percent || len >= size - 1)
+      break;
+
+    if (percent[1] == '%')
+    {
+      out[len++] = '%';
+      out[len] = '\0';
+      format = percent + 2;
+      continue;
+    }
+
+    log_spec_t spec;
+    char spec_text[16];
+    if (!log_scan_spec(percent, &spec) || (size_t)(spec.end - spec.start) >= sizeof(spec_text))
+      break;
+    memcpy(spec_text, spec.start, spec.end - spec.start);
+    spec_text[spec.end - spec.start] = '\0';
+    format = spec.end;
+
+    int star[2] = {0, 0};
+    for (int i = 0; i < spec.stars; i++)
+    {
+      if (arg + sizeof(int) > arg_end)
+        return;
+      memcpy(&star[i], arg, sizeof(int));
+      arg += sizeof(int);
+    }
+
+    char *dst = out + len;
+    size_t room = size - len;
+    int written = 0;
+
+#define LOG_EMIT(value)                                                                        \
+  (spec.stars == 0   ? snprintf(dst, room, spec_text, value)                                   \
+   : spec.stars == 1 ? snprintf(dst, room, spec_text, star[0], value)                          \
+                     : snprintf(dst, room, spec_text, star[0], star[1], value))
+
+    switch (spec.conversion)
+    {
+    case 's':
+    {
+      size_t slen = strnlen((const char *)arg, arg_end - arg);
+      if (arg + slen >= arg_end)
+        return;
+      written = LOG_EMIT((const char *)arg);
+      arg += slen + 1;
+      break;
+    }
+    case 'p':
+    {
+      void *value;
+      if (arg + sizeof(value) > arg_end)
+        return;
+      memcpy(&value, arg, sizeof(value));
+      arg += sizeof(value);
+      written = LOG_EMIT(value);
+      break;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+    {
+      double value;
+      if (arg + sizeof(value) > arg_end)
+        return;
+      memcpy(&value, arg, sizeof(value));
+      arg += sizeof(value);
+      written = LOG_EMIT(value);
+      break;
+    }
+    default:
+    {
+      size_t int_size = log_int_size(spec.length);
+      if (arg + int_size > arg_end)
+        return;
+      if (int_size == sizeof(long long))
+      {
+        long long value;
+        memcpy(&value, arg, int_size);
+        written = LOG_EMIT(value);
+      }
+      else if (int_size == sizeof(long))
+      {
+        long value;
+        memcpy(&value, arg, int_size);
+        written = LOG_EMIT(value);
+      }
+      else
+      {
+        int value;
+        memcpy(&value, arg, int_size);
+        written = LOG_EMIT(value);
+      }
+      arg += int_size;
+      break;
+    }
+    }
+#undef LOG_EMIT
+
+    if (written < 0)
+      break;
+    len += ((size_t)written < room) ? (size_t)written : room - 1;
+  }
+}
+
+/**
+ * @brief Copy a completed record out of the ring
+ * @return false if the record is still being written or was already overwritten
+ */
+static bool log_read_record(uint32_t seq, log_ring_record_t *out)
+{
+  const log_ring_record_t *slot = &log_ring.records[seq % CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS];
+  if (__atomic_load_n(&slot->commit, __ATOMIC_ACQUIRE) != seq + 1)
+    return false;
+  memcpy(out, slot, sizeof(*out));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&slot->commit, __ATOMIC_RELAXED) == seq + 1;
+}
+
+/**
+ * @brief Store a message as a record
+ * @return false if the ring is not running or does not keep this level, args is then untouched
+ */
+static bool log_ring_write(esp_log_level_t level, debug_tag_t tag, const char *format, va_list args)
+{
+  if (!log_ring_ready || level > CONFIG_SYSTEM_DEBUG_LOG_RING_LEVEL)
+    return false;
+
+  log_ring_record_t record;
+  record.time_ms = esp_log_timestamp();
+  record.tag = (uint8_t)tag;
+  record.level = (uint8_t)level;
+  record.reserved = 0;
+
+  va_list packed;
+  va_copy(packed, args);
+  bool ok = esp_ptr_in_drom(format) && log_pack_args(format, packed, record.payload, &record.payload_len);
+  va_end(packed);
+  record.format = ok ? format : NULL;
+  if (!ok)
+  {
+    // Formats built at runtime, or arguments that do not pack, are stored as text
+    vsnprintf((char *)record.payload, LOG_RING_PAYLOAD, format, args);
+    record.payload_len = LOG_RING_PAYLOAD;
+  }
+
+  uint32_t seq = __atomic_fetch_add(&log_next_seq, 1, __ATOMIC_RELAXED);
+  log_ring_record_t *slot = &log_ring.records[seq % CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS];
+  __atomic_store_n(&slot->commit, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy((uint8_t *)slot + sizeof(slot->commit), (const uint8_t *)&record + sizeof(record.commit),
+         sizeof(record) - sizeof(record.commit));
+  __atomic_store_n(&slot->commit, seq + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void log_ring_drain_task(void *arg)
+{
+  char text[256];
+  while (1)
+  {
+    uint32_t head = __atomic_load_n(&log_next_seq, __ATOMIC_ACQUIRE);
+    if (head - log_drain_seq > CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS)
+    {
+      log_lost += head - log_drain_seq - CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS;
+      log_drain_seq = head - CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS;
+    }
+
+    while (log_drain_seq != head)
+    {
+      log_ring_record_t record;
+      if (!log_read_record(log_drain_seq, &record))
+      {
+        // Older than the ring by now, or a writer was preempted half way and is retried next round
+        uint32_t commit = __atomic_load_n(
+            &log_ring.records[log_drain_seq % CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS].commit, __ATOMIC_RELAXED);
+        if (commit == 0 || commit < log_drain_seq + 1)
+          break;
+        log_lost++;
+        log_drain_seq++;
+        continue;
+      }
+      log_drain_seq++;
+
+      if (record.tag >= DEBUG_TAG_MAX || record.level > ESP_LOG_VERBOSE)
+        continue;
+      log_format_record(&record, text, sizeof(text));
+      esp_log_write((esp_log_level_t)record.level, debug_tag_strings[record.tag], "%c (%lu) %s: %s\n",
+                    log_level_letters[record.level], (unsigned long)record.time_ms, debug_tag_strings[record.tag],
+                    text);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(LOG_RING_DRAIN_MS));
+  }
+}
+
+static const char *log_boot_label(uint32_t seq)
+{
+  if (seq >= log_ring.boot_seq)
+    return "this";
+  return (seq >= log_ring.prev_seq) ? "prev" : "old";
+}
+
+/**
+ * @brief Format the records still in the ring from since on
+ * @return Records emitted
+ */
+static uint32_t log_ring_export(uint32_t since, uint32_t head, debug_log_emit_fn_t emit, void *ctx)
+{
+  char text[256];
+  char line[320];
+  uint32_t first = (head > CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS) ? head - CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS : 0;
+  uint32_t emitted = 0;
+  if (since > first && since <= head)
+    first = since;
+
+  for (uint32_t seq = first; seq != head; seq++)
+  {
+    log_ring_record_t record;
+    if (!log_read_record(seq, &record) || record.tag >= DEBUG_TAG_MAX || record.level > ESP_LOG_VERBOSE)
+      continue;
+
+    log_format_record(&record, text, sizeof(text));
+    int len = snprintf(line, sizeof(line), "%s %lu %c %s: %s\n", log_boot_label(seq), (unsigned long)record.time_ms,
+                       log_level_letters[record.level], debug_tag_strings[record.tag], text);
+    if (len >= (int)sizeof(line))
+    {
+      line[sizeof(line) - 2] = '\n';
+      len = sizeof(line) - 1;
+    }
+    emit(ctx, line, len);
+    emitted++;
+  }
+  return emitted;
+}
+
+static void log_emit_serial(void *ctx, const char *line, int len)
+{
+  char out[sizeof("LOG ") + 320];
+  memcpy(out, "LOG ", 4);
+  memcpy(out + 4, line, len);
+  serial_data_write(out, 4 + len);
+}
+
+static void log_ring_dump(void)
+{
+  uint32_t head = __atomic_load_n(&log_next_seq, __ATOMIC_ACQUIRE);
+  uint32_t printed = log_ring_export(0, head, log_emit_serial, NULL);
+
+  char line[96];
+  int len = snprintf(line, sizeof(line), "LOG {\"end\":true,\"records\":%lu,\"lost\":%lu}\n", (unsigned long)printed,
+                     (unsigned long)log_lost);
+  serial_data_write(line, len);
+}
+
+
+#endif // CONFIG_SYSTEM_DEBUG_LOG_RING
+
+// =======================================================================
+// LOGGING
+// =======================================================================
+
+/**
+ * @brief Hand a message to the log ring, or format and log it in place
+ */
+static void log_message_v(esp_log_level_t level, debug_tag_t tag, const char *format, va_list args)
+{
+#if CONFIG_SYSTEM_DEBUG_LOG_RING
+  if (log_ring_write(level, tag, format, args))
+    return;
+#endif
+
+  // Above the compiled-in maximum the line would be formatted only to be dropped
+  if (level > LOG_LOCAL_LEVEL)
+    return;
+
+  char buffer[512];
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  ESP_LOG_LEVEL_LOCAL(level, debug_tag_strings[tag], "%s", buffer);
+}
+
+static void log_message(esp_log_level_t level, debug_tag_t tag, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  log_message_v(level, tag, format, args);
+  va_end(args);
+}
+
 void debug_log_startup(debug_tag_t tag, const char *component_name)
 {
   if (tag < DEBUG_TAG_MAX && component_name)
   {
-    ESP_LOGI(debug_tag_strings[tag], "%s started", component_name);
+    log_message(ESP_LOG_INFO, tag, "%s started", component_name);
   }
 }
 
@@ -50,7 +660,7 @@ void debug_log_error(debug_tag_t tag, const char *error_msg)
 {
   if (tag < DEBUG_TAG_MAX && error_msg)
   {
-    ESP_LOGE(debug_tag_strings[tag], "%s", error_msg);
+    log_message(ESP_LOG_ERROR, tag, "%s", error_msg);
   }
 }
 
@@ -58,7 +668,7 @@ void debug_log_event(debug_tag_t tag, const char *event_msg)
 {
   if (tag < DEBUG_TAG_MAX && event_msg)
   {
-    ESP_LOGI(debug_tag_strings[tag], "%s", event_msg);
+    log_message(ESP_LOG_INFO, tag, "%s", event_msg);
   }
 }
 
@@ -97,16 +707,13 @@ void debug_print_memory_usage(debug_tag_t tag, void *task_handle)
   size_t free_heap = esp_get_free_heap_size();
   size_t min_heap = esp_get_minimum_free_heap_size();
 
-  ESP_LOGI(debug_tag_strings[tag],
-           "Memory: free=%zu bytes, min_free=%zu bytes",
-           free_heap, min_heap);
+  log_message(ESP_LOG_INFO, tag, "Memory: free=%zu bytes, min_free=%zu bytes", free_heap, min_heap);
 
   if (task_handle != NULL)
   {
     UBaseType_t stack_hwm = uxTaskGetStackHighWaterMark((TaskHandle_t)task_handle);
-    ESP_LOGI(debug_tag_strings[tag],
-             "Task stack high-water mark: %u bytes",
-             (unsigned int)(stack_hwm * sizeof(StackType_t)));
+    log_message(ESP_LOG_INFO, tag, "Task stack high-water mark: %u bytes",
+                (unsigned int)(stack_hwm * sizeof(StackType_t)));
   }
 }
 
@@ -114,7 +721,7 @@ void debug_log_info(debug_tag_t tag, const char *info_msg)
 {
   if (tag < DEBUG_TAG_MAX && info_msg)
   {
-    ESP_LOGI(debug_tag_strings[tag], "%s", info_msg);
+    log_message(ESP_LOG_INFO, tag, "%s", info_msg);
   }
 }
 
@@ -122,7 +729,7 @@ void debug_log_warning(debug_tag_t tag, const char *warning_msg)
 {
   if (tag < DEBUG_TAG_MAX && warning_msg)
   {
-    ESP_LOGW(debug_tag_strings[tag], "%s", warning_msg);
+    log_message(ESP_LOG_WARN, tag, "%s", warning_msg);
   }
 }
 
@@ -130,7 +737,7 @@ void debug_log_debug(debug_tag_t tag, const char *debug_msg)
 {
   if (tag < DEBUG_TAG_MAX && debug_msg)
   {
-    ESP_LOGD(debug_tag_strings[tag], "%s", debug_msg);
+    log_message(ESP_LOG_DEBUG, tag, "%s", debug_msg);
   }
 }
 
@@ -141,14 +748,7 @@ void debug_log_info_f(debug_tag_t tag, const char *format, ...)
 
   va_list args;
   va_start(args, format);
-
-  // Format the message into a buffer
-  char buffer[512];
-  vsnprintf(buffer, sizeof(buffer), format, args);
-
-  // Use ESP-IDF logging macro
-  ESP_LOGI(debug_tag_strings[tag], "%s", buffer);
-
+  log_message_v(ESP_LOG_INFO, tag, format, args);
   va_end(args);
 }
 
@@ -159,14 +759,7 @@ void debug_log_error_f(debug_tag_t tag, const char *format, ...)
 
   va_list args;
   va_start(args, format);
-
-  // Format the message into a buffer
-  char buffer[512];
-  vsnprintf(buffer, sizeof(buffer), format, args);
-
-  // Use ESP-IDF logging macro
-  ESP_LOGE(debug_tag_strings[tag], "%s", buffer);
-
+  log_message_v(ESP_LOG_ERROR, tag, format, args);
   va_end(args);
 }
 
@@ -177,14 +770,7 @@ void debug_log_warning_f(debug_tag_t tag, const char *format, ...)
 
   va_list args;
   va_start(args, format);
-
-  // Format the message into a buffer
-  char buffer[512];
-  vsnprintf(buffer, sizeof(buffer), format, args);
-
-  // Use ESP-IDF logging macro
-  ESP_LOGW(debug_tag_strings[tag], "%s", buffer);
-
+  log_message_v(ESP_LOG_WARN, tag, format, args);
   va_end(args);
 }
 
@@ -195,14 +781,7 @@ void debug_log_debug_f(debug_tag_t tag, const char *format, ...)
 
   va_list args;
   va_start(args, format);
-
-  // Format the message into a buffer
-  char buffer[512];
-  vsnprintf(buffer, sizeof(buffer), format, args);
-
-  // Use ESP-IDF logging macro
-  ESP_LOGD(debug_tag_strings[tag], "%s", buffer);
-
+  log_message_v(ESP_LOG_DEBUG, tag, format, args);
   va_end(args);
 }
 
@@ -319,3 +898,278 @@ void debug_log_multiline(esp_log_level_t level, debug_tag_t tag, const char *for
 }
 
 #endif
+
+// =======================================================================
+// TRACE RECORDS
+// =======================================================================
+
+#if CONFIG_SYSTEM_DEBUG_TRACE
+
+#define TRACE_BURST 16 ///< Records a tag may store back to back before the rate applies
+#define TRACE_COST_US (1000000 / CONFIG_SYSTEM_DEBUG_TRACE_RATE)
+
+// Static initializer, hot paths may trace before app_main()
+uint8_t debug_trace_levels[DEBUG_TAG_MAX] = {[0 ... DEBUG_TAG_MAX - 1] = CONFIG_SYSTEM_DEBUG_TRACE_LEVEL};
+
+static portMUX_TYPE trace_lock = portMUX_INITIALIZER_UNLOCKED;
+static debug_trace_record_t trace_ring[CONFIG_SYSTEM_DEBUG_TRACE_DEPTH];
+static uint32_t trace_head = 0; ///< Next slot to write
+static uint32_t trace_count = 0;
+static uint16_t trace_seq = 0;
+static uint32_t trace_overwritten = 0;
+
+// Per-tag token bucket, kept as microseconds of credit
+static int64_t trace_credit_us[DEBUG_TAG_MAX];
+static int64_t trace_last_us[DEBUG_TAG_MAX];
+static uint32_t trace_rate_dropped[DEBUG_TAG_MAX];
+
+void IRAM_ATTR debug_trace_record(debug_tag_t tag, debug_trace_event_t event, uint32_t arg0, uint32_t arg1)
+{
+  if (tag >= DEBUG_TAG_MAX)
+    return;
+
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL_SAFE(&trace_lock);
+
+  int64_t credit = trace_credit_us[tag] + (now_us - trace_last_us[tag]);
+  if (credit > (int64_t)TRACE_BURST * TRACE_COST_US)
+    credit = (int64_t)TRACE_BURST * TRACE_COST_US;
+  trace_last_us[tag] = now_us;
+
+  if (credit < TRACE_COST_US)
+  {
+    trace_credit_us[tag] = credit;
+    trace_rate_dropped[tag]++;
+    portEXIT_CRITICAL_SAFE(&trace_lock);
+    return;
+  }
+  trace_credit_us[tag] = credit - TRACE_COST_US;
+
+  // A full ring drops its oldest record, the latest ones matter most
+  debug_trace_record_t *record = &trace_ring[trace_head];
+  record->time_us = (uint32_t)now_us;
+  record->seq = trace_seq++;
+  record->tag = (uint8_t)tag;
+  record->event = (uint8_t)event;
+  record->arg0 = arg0;
+  record->arg1 = arg1;
+  trace_head = (trace_head + 1) % CONFIG_SYSTEM_DEBUG_TRACE_DEPTH;
+  if (trace_count < CONFIG_SYSTEM_DEBUG_TRACE_DEPTH)
+    trace_count++;
+  else
+    trace_overwritten++;
+
+  portEXIT_CRITICAL_SAFE(&trace_lock);
+}
+
+static int trace_tag_from_name(const char *name, size_t len)
+{
+  for (int i = 0; i < DEBUG_TAG_MAX; i++)
+  {
+    if (strlen(debug_tag_strings[i]) == len && strncmp(debug_tag_strings[i], name, len) == 0)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Drain the ring oldest first, one record per line
+ */
+static void trace_dump(void)
+{
+  char buf[384];
+  uint32_t records = 0;
+
+  while (1)
+  {
+    debug_trace_record_t record;
+    portENTER_CRITICAL(&trace_lock);
+    if (trace_count == 0)
+    {
+      portEXIT_CRITICAL(&trace_lock);
+      break;
+    }
+    uint32_t tail = (trace_head + CONFIG_SYSTEM_DEBUG_TRACE_DEPTH - trace_count) % CONFIG_SYSTEM_DEBUG_TRACE_DEPTH;
+    record = trace_ring[tail];
+    trace_count--;
+    portEXIT_CRITICAL(&trace_lock);
+
+    const char *tag = (record.tag < DEBUG_TAG_MAX) ? debug_tag_strings[record.tag] : "?";
+    int len = snprintf(buf, sizeof(buf),
+                       "TRACE {\"seq\":%u,\"t\":%lu,\"tag\":\"%s\",\"ev\":%u,\"a0\":%lu,\"a1\":%lu}\n",
+                       record.seq, (unsigned long)record.time_us, tag, record.event, (unsigned long)record.arg0,
+                       (unsigned long)record.arg1);
+    serial_data_write(buf, len);
+    records++;
+  }
+
+  uint32_t dropped[DEBUG_TAG_MAX];
+  portENTER_CRITICAL(&trace_lock);
+  uint32_t overwritten = trace_overwritten;
+  memcpy(dropped, trace_rate_dropped, sizeof(dropped));
+  trace_overwritten = 0;
+  memset(trace_rate_dropped, 0, sizeof(trace_rate_dropped));
+  portEXIT_CRITICAL(&trace_lock);
+
+  int len = snprintf(buf, sizeof(buf), "TRACE {\"end\":true,\"records\":%lu,\"overwritten\":%lu,\"rate_dropped\":{",
+                     (unsigned long)records, (unsigned long)overwritten);
+  bool first = true;
+  for (int i = 0; i < DEBUG_TAG_MAX && len < (int)sizeof(buf); i++)
+  {
+    if (dropped[i] == 0)
+      continue;
+    len += snprintf(buf + len, sizeof(buf) - len, "%s\"%s\":%lu", first ? "" : ",", debug_tag_strings[i],
+                    (unsigned long)dropped[i]);
+    first = false;
+  }
+  if (len < (int)sizeof(buf))
+    len += snprintf(buf + len, sizeof(buf) - len, "}}\n");
+  if (len >= (int)sizeof(buf))
+    len = sizeof(buf) - 1;
+  serial_data_write(buf, len);
+}
+
+static void trace_reply_levels(void)
+{
+  char buf[384];
+  int len = snprintf(buf, sizeof(buf), "TRACE {\"levels\":{");
+  for (int i = 0; i < DEBUG_TAG_MAX && len < (int)sizeof(buf); i++)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len, "%s\"%s\":%u", i ? "," : "", debug_tag_strings[i],
+                    debug_trace_levels[i]);
+  }
+  if (len < (int)sizeof(buf))
+    len += snprintf(buf + len, sizeof(buf) - len, "}}\n");
+  if (len >= (int)sizeof(buf))
+    len = sizeof(buf) - 1;
+  serial_data_write(buf, len);
+}
+
+#endif
+
+bool debug_trace_handle_command(const char *line)
+{
+  static const char level_command[] = "TRACE_LEVEL";
+  bool is_dump = strcmp(line, "TRACE_DUMP") == 0;
+  bool is_level = strncmp(line, level_command, sizeof(level_command) - 1) == 0 &&
+                  (line[sizeof(level_command) - 1] == '\0' || line[sizeof(level_command) - 1] == ' ');
+  if (!is_dump && !is_level)
+    return false;
+
+#if CONFIG_SYSTEM_DEBUG_TRACE
+  if (is_dump)
+  {
+    trace_dump();
+    return true;
+  }
+
+  // TRACE_LEVEL [<TAG>] [<level>], no arguments only reports
+  const char *args = line + sizeof(level_command) - 1;
+  while (*args == ' ')
+    args++;
+  if (*args != '\0')
+  {
+    const char *value = strrchr(args, ' ');
+    int tag = -1;
+    if (value)
+    {
+      tag = trace_tag_from_name(args, value - args);
+      value++;
+    }
+    else
+    {
+      value = args;
+    }
+
+    char *end;
+    long level = strtol(value, &end, 10);
+    if (*end != '\0' || level < DEBUG_TRACE_LEVEL_OFF || level > DEBUG_TRACE_LEVEL_SAMPLE ||
+        (value != args && tag < 0))
+    {
+      static const char usage[] = "TRACE {\"error\":\"usage: TRACE_LEVEL [<TAG>] <0-2>\"}\n";
+      serial_data_write(usage, sizeof(usage) - 1);
+      return true;
+    }
+    for (int i = 0; i < DEBUG_TAG_MAX; i++)
+    {
+      if (tag < 0 || tag == i)
+        debug_trace_levels[i] = (uint8_t)level;
+    }
+  }
+  trace_reply_levels();
+#else
+  static const char disabled[] = "TRACE {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
+
+// =======================================================================
+// LOG RING CONTROL
+// =======================================================================
+
+void debug_log_ring_init(void)
+{
+#if CONFIG_SYSTEM_DEBUG_LOG_RING
+  if (log_ring_ready)
+    return;
+
+  uint8_t elf_sha[sizeof(log_ring.elf_sha)];
+  memcpy(elf_sha, esp_app_get_description()->app_elf_sha256, sizeof(elf_sha));
+
+  uint32_t next = 0;
+  if (log_ring.magic == LOG_RING_MAGIC && memcmp(log_ring.elf_sha, elf_sha, sizeof(elf_sha)) == 0)
+  {
+    // Sequence numbers carry on from the previous boot, its records stay readable
+    for (int i = 0; i < CONFIG_SYSTEM_DEBUG_LOG_RING_RECORDS; i++)
+    {
+      if (log_ring.records[i].commit > next)
+        next = log_ring.records[i].commit;
+    }
+    log_ring.prev_seq = log_ring.boot_seq;
+  }
+  else
+  {
+    memset(&log_ring, 0, sizeof(log_ring));
+    log_ring.magic = LOG_RING_MAGIC;
+    memcpy(log_ring.elf_sha, elf_sha, sizeof(elf_sha));
+  }
+  log_ring.boot_seq = next;
+  log_next_seq = next;
+  log_drain_seq = next;
+
+  if (task_plan_create(TASK_PLAN_LOG_DRAIN, log_ring_drain_task, NULL, NULL) != pdPASS)
+  {
+    ESP_LOGE(debug_tag_strings[DEBUG_TAG_SYSTEM], "Log drain task not created, logging directly");
+    return;
+  }
+  log_ring_ready = true;
+#endif
+}
+
+uint32_t debug_log_ring_export(uint32_t since, debug_log_emit_fn_t emit, void *ctx)
+{
+#if CONFIG_SYSTEM_DEBUG_LOG_RING
+  if (!log_ring_ready)
+    return since;
+  uint32_t head = __atomic_load_n(&log_next_seq, __ATOMIC_ACQUIRE);
+  log_ring_export(since, head, emit, ctx);
+  return head;
+#else
+  return since;
+#endif
+}
+
+bool debug_log_ring_handle_command(const char *line)
+{
+  if (strcmp(line, "LOG_DUMP") != 0)
+    return false;
+
+#if CONFIG_SYSTEM_DEBUG_LOG_RING
+  log_ring_dump();
+#else
+  static const char disabled[] = "LOG {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
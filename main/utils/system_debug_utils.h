@@ -20,7 +20,9 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "esp_log.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -155,6 +157,112 @@ extern "C"
    */
   void debug_log_multiline(esp_log_level_t level, debug_tag_t tag, const char *format, ...);
 
+  // =======================================================================
+  // LOG RING
+  // =======================================================================
+  //
+  // With CONFIG_SYSTEM_DEBUG_LOG_RING the debug_log_*() calls above do not
+  // format or touch the UART on the calling task. They store a binary
+  // record (format pointer, tag, level, packed arguments) in a ring in RTC
+  // memory, and a low-priority task formats and prints it later. The ring
+  // survives soft resets, panics and watchdog resets of the same firmware,
+  // so LOG_DUMP also shows the last lines before a crash.
+
+  /**
+   * @brief Open the log ring and start its drain task
+   * @note Call first thing in app_main(), earlier lines are logged directly
+   */
+  void debug_log_ring_init(void);
+
+  /** Receives one formatted log line, newline included */
+  typedef void (*debug_log_emit_fn_t)(void *ctx, const char *line, int len);
+
+  /**
+   * @brief Format the records still in the ring, as LOG_DUMP prints them without the prefix
+   * @param since Value returned by the previous call to continue after it, 0 for all
+   * @param emit Receives each line, on the calling task
+   * @return Position to pass as since to get only newer records
+   */
+  uint32_t debug_log_ring_export(uint32_t since, debug_log_emit_fn_t emit, void *ctx);
+
+  /**
+   * @brief Handle LOG_DUMP
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a log ring command
+   */
+  bool debug_log_ring_handle_command(const char *line);
+
+  // =======================================================================
+  // TRACE RECORDS
+  // =======================================================================
+  //
+  // Hot paths (touch samples, per-event UI handlers) must not format text or
+  // wait on the UART. DEBUG_TRACE() instead stores a fixed-size binary record
+  // in a RAM ring, rate limited per tag, and the serial task formats the ring
+  // on TRACE_DUMP. Compiled out unless CONFIG_SYSTEM_DEBUG_TRACE is set; at
+  // runtime each tag has a level set with TRACE_LEVEL.
+
+  /**
+   * @brief Trace detail, a record is kept if its level is at most the tag's level
+   */
+  typedef enum
+  {
+    DEBUG_TRACE_LEVEL_OFF = 0,
+    DEBUG_TRACE_LEVEL_EVENT,  ///< Once per press, state change or similar
+    DEBUG_TRACE_LEVEL_SAMPLE, ///< Every sample or frame
+  } debug_trace_level_t;
+
+  /**
+   * @brief Trace event IDs, meaning of the arguments in the comments
+   */
+  typedef enum
+  {
+    DEBUG_TRACE_TOUCH_SAMPLE = 1, ///< a0 = x | y << 16, a1 = count | track_id << 8
+    DEBUG_TRACE_TOUCH_RELEASE,    ///< a0 = last x | y << 16
+    DEBUG_TRACE_UI_PRESSED,       ///< a0 = registry index
+    DEBUG_TRACE_UI_RELEASED,      ///< a0 = registry index
+  } debug_trace_event_t;
+
+  /**
+   * @brief One trace record as stored in the ring
+   */
+  typedef struct
+  {
+    uint32_t time_us; ///< Low 32 bits of esp_timer time
+    uint16_t seq;     ///< Increments per stored record, gaps mean the ring wrapped
+    uint8_t tag;      ///< debug_tag_t
+    uint8_t event;    ///< debug_trace_event_t
+    uint32_t arg0;
+    uint32_t arg1;
+  } debug_trace_record_t;
+
+#if CONFIG_SYSTEM_DEBUG_TRACE
+  /** Runtime level per tag, read inline by DEBUG_TRACE() */
+  extern uint8_t debug_trace_levels[DEBUG_TAG_MAX];
+
+  /**
+   * @brief Store one record, subject to the tag's rate limit
+   * @note Callable from tasks and ISRs, never blocks
+   */
+  void debug_trace_record(debug_tag_t tag, debug_trace_event_t event, uint32_t arg0, uint32_t arg1);
+
+#define DEBUG_TRACE(tag, level, event, arg0, arg1)                                  \
+  do                                                                                \
+  {                                                                                 \
+    if ((level) <= debug_trace_levels[(tag)])                                       \
+      debug_trace_record((tag), (event), (uint32_t)(arg0), (uint32_t)(arg1));       \
+  } while (0)
+#else
+#define DEBUG_TRACE(tag, level, event, arg0, arg1) ((void)0)
+#endif
+
+  /**
+   * @brief Handle TRACE_DUMP / TRACE_LEVEL
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a trace command
+   */
+  bool debug_trace_handle_command(const char *line);
+
 #ifdef __cplusplus
 }
 #endif
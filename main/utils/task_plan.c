@@ -0,0 +1,466 @@
+/**
+ * @file task_plan.c
+ * @brief Central core, priority and stack plan of every firmware task
+ *
+ * The check reads every task with uxTaskGetSystemState(), which needs the
+ * trace facility and, for the core of each task, the core id in the task
+ * list; both are on in sdkconfig.defaults.esp32s3. A violation is logged
+ * when a task shows a kind of violation it did not show at the previous
+ * check, so a lasting one is reported once and a recurring one each time
+ * it comes back.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "task_plan.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "task_stack.h"
+
+#define TASK_PLAN_CHECK_SUPPORTED \
+  (CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID)
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+#define RENDER TASK_PLAN_RENDER_CORE
+#define NETWORK TASK_PLAN_NETWORK_CORE
+
+static const task_plan_entry_t plan[TASK_PLAN_COUNT] = {
+    // Draws and flushes the UI, nothing else of ours may delay it
+    [TASK_PLAN_LVGL] = {"LVGL", 16 * 1024, 5, RENDER},
+    // Above LVGL so a touch report is ready when LVGL wakes
+    [TASK_PLAN_TOUCH] = {"GT911", 3072, 6, RENDER},
+    // Splits large state documents with the parser; below LVGL it only gets
+    // what LVGL leaves idle, its parser state is static
+    [TASK_PLAN_ENTITY_PARSER_HELPER] = {"entity_parser2", 4096, 1, RENDER, .psram_stack = true},
+
+    // Same priority as LVGL, it finishes what LVGL rendered
+    [TASK_PLAN_LCD_FLUSH] = {"lcd_flush", 3072, 5, NETWORK},
+    // Stays in DRAM, its commands write NVS
+    [TASK_PLAN_SERIAL] = {"serial_data", 8192, 2, NETWORK},
+    // Runs the same commands as serial_data; below it, a command never delays a sample
+    [TASK_PLAN_SERIAL_MUX] = {"serial_mux", 8192, 1, NETWORK},
+    // Decoder runs inline, same budget and priority as serial_data
+    [TASK_PLAN_TELEMETRY_NET] = {"telemetry_net", 6144, 2, NETWORK},
+    // Below serial_data, which only queues the samples for it
+    [TASK_PLAN_TELEMETRY_RELAY] = {"telemetry_relay", 4096, 1, NETWORK},
+    // Card writes take milliseconds, staging blocks in PSRAM keep them off serial_data
+    [TASK_PLAN_TELEMETRY_SD_LOG] = {"telemetry_sd_log", 4096, 1, NETWORK},
+    [TASK_PLAN_ENTITY_PARSER] = {"entity_parser", 8192, 2, NETWORK, .psram_stack = true},
+    [TASK_PLAN_SYNC_STATES] = {"SyncStatesTask", 16384, 2, NETWORK, .psram_stack = true},
+    // Service calls build JSON with cJSON
+    [TASK_PLAN_HA_WORKER] = {"ha_worker", 8192, 2, NETWORK, .psram_stack = true},
+    // Helpers of a parallel state fetch, same priority as the sync task
+    [TASK_PLAN_HA_FETCH] = {"HaFetch", 6144, 2, NETWORK},
+    [TASK_PLAN_HA_DNS] = {"HaDnsRefresh", 3072, 2, NETWORK},
+    // TLS handshakes with remote HA URLs; below the HA tasks, a probe never delays a request
+    [TASK_PLAN_HA_PROBE] = {"ha_probe", 8192, 1, NETWORK, .psram_stack = true},
+    // Template fetch and service calls build JSON with cJSON
+    [TASK_PLAN_HA_LATENCY] = {"ha_latency", 8192, 2, NETWORK},
+    // Above the HA tasks so beacons keep their interval during a sync
+    [TASK_PLAN_HA_SHARE] = {"ha_share", 4096, 3, NETWORK},
+    // Snapshot download and decode, below the HA tasks so a frame never delays a sync;
+    // the decoder keeps its stack in DRAM, the ROM decoder works on it per block
+    [TASK_PLAN_HA_CAMERA] = {"ha_camera", 8192, 1, NETWORK, .psram_stack = true},
+    [TASK_PLAN_HA_CAMERA_DECODE] = {"cam_decode", 4096, 1, NETWORK},
+    // Refills the I2S ring within its ~65 ms, above the HA and telemetry tasks
+    [TASK_PLAN_ALERT_AUDIO] = {"alert_audio", 3072, 4, NETWORK},
+    // TLS handshake and cJSON; flash writes stall the cache anyway
+    [TASK_PLAN_OTA] = {"ota_update", 8192, 2, NETWORK},
+    [TASK_PLAN_SCREENSHOT] = {"screenshot", 4096, 2, NETWORK},
+    // CSV text and file reads on the stack, below everything that draws or receives
+    [TASK_PLAN_HISTORY_EXPORT] = {"history_export", 6144, 1, NETWORK},
+    [TASK_PLAN_DEFERRED_INIT] = {"deferred_init", 6144, 1, NETWORK},
+    [TASK_PLAN_LOG_DRAIN] = {"log_drain", 4096, 1, NETWORK},
+    [TASK_PLAN_PROFILER] = {"task_prof", 3072, 1, NETWORK},
+    // Below LVGL, so a benchmark never delays a frame it measures
+    [TASK_PLAN_UI_BENCH] = {"ui_bench", 4096, 3, NETWORK},
+    [TASK_PLAN_LVGL_BENCH] = {"lvgl_bench", 3072, 3, NETWORK},
+
+    // Cores set in sdkconfig.defaults.esp32s3, priorities are IDF's own
+    [TASK_PLAN_WIFI] = {"wifi", 0, 0, NETWORK, .external = true},
+    [TASK_PLAN_TCPIP] = {"tiT", 0, 0, NETWORK, .external = true},
+    [TASK_PLAN_MQTT] = {"mqtt_task", 4096, 5, NETWORK, .external = true},
+    // The client has no core option and floats; its handler only parses
+    // and queues, it runs briefly
+    [TASK_PLAN_WEBSOCKET] = {"websocket_task", 6144, 5, tskNO_AFFINITY, .external = true},
+    // Below LVGL, touch, serial and the HA worker
+    [TASK_PLAN_DIAG_HTTP] = {"httpd", 6144, 2, NETWORK, .external = true},
+};
+
+#undef RENDER
+#undef NETWORK
+
+/** IDF tasks allowed on the render core besides the plan */
+static const char *const render_core_system_tasks[] = {"IDLE1", "ipc1"};
+
+enum
+{
+  VIOLATION_CORE = 1 << 0,
+  VIOLATION_PRIORITY = 1 << 1,
+  VIOLATION_STACK = 1 << 2,
+  VIOLATION_UNPLANNED = 1 << 3,
+};
+
+typedef struct
+{
+  TaskHandle_t handle; ///< NULL for a free slot
+  uint8_t violations;  ///< VIOLATION_* found at the last check
+  bool seen;
+} reported_t;
+
+#if TASK_PLAN_CHECK_SUPPORTED
+// Written by the check timer and the serial task
+static SemaphoreHandle_t check_mutex = NULL;
+static TaskStatus_t *status_buf = NULL;
+static UBaseType_t status_count = 0;
+static reported_t *reported = NULL;
+static esp_timer_handle_t check_timer = NULL;
+static int violation_count = 0;
+static bool overflow_warned = false;
+
+static int64_t read_violations(const metric_t *metric)
+{
+  return violation_count;
+}
+
+static metric_t violations_metric = METRIC_READ_INIT(METRIC_TYPE_GAUGE, "task_plan_violations",
+                                                     "Tasks off their planned core, priority or stack", NULL,
+                                                     read_violations, 0);
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if TASK_PLAN_CHECK_SUPPORTED
+
+static const task_plan_entry_t *find_entry(const char *name)
+{
+  for (int i = 0; i < TASK_PLAN_COUNT; i++)
+  {
+    if (strcmp(plan[i].name, name) == 0)
+      return &plan[i];
+  }
+  return NULL;
+}
+
+static bool is_render_core_system_task(const char *name)
+{
+  for (size_t i = 0; i < sizeof(render_core_system_tasks) / sizeof(render_core_system_tasks[0]); i++)
+  {
+    if (strcmp(render_core_system_tasks[i], name) == 0)
+      return true;
+  }
+  return false;
+}
+
+static uint8_t task_violations(const TaskStatus_t *status)
+{
+  const task_plan_entry_t *entry = find_entry(status->pcTaskName);
+  if (!entry)
+  {
+    // Pinned to the render core, or free to run there
+    bool may_render = status->xCoreID == TASK_PLAN_RENDER_CORE || status->xCoreID == tskNO_AFFINITY;
+    return (may_render && !is_render_core_system_task(status->pcTaskName)) ? VIOLATION_UNPLANNED : 0;
+  }
+
+  uint8_t violations = 0;
+  if (status->xCoreID != entry->core)
+    violations |= VIOLATION_CORE;
+  if (entry->priority && status->uxBasePriority != entry->priority)
+    violations |= VIOLATION_PRIORITY;
+  // ESP-IDF reports the high-water mark in bytes
+  if (status->usStackHighWaterMark < TASK_PLAN_STACK_MARGIN)
+    violations |= VIOLATION_STACK;
+  return violations;
+}
+
+static reported_t *find_reported(TaskHandle_t handle)
+{
+  reported_t *free_slot = NULL;
+  for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++)
+  {
+    if (reported[i].handle == handle)
+      return &reported[i];
+    if (!reported[i].handle && !free_slot)
+      free_slot = &reported[i];
+  }
+  if (free_slot)
+  {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->handle = handle;
+  }
+  return free_slot;
+}
+
+static void log_violations(const TaskStatus_t *status, uint8_t violations)
+{
+  const task_plan_entry_t *entry = find_entry(status->pcTaskName);
+  int core = (status->xCoreID == tskNO_AFFINITY) ? -1 : (int)status->xCoreID;
+  if (violations & VIOLATION_UNPLANNED)
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Task %s is not planned and can run on the render core (core %d)",
+                        status->pcTaskName, core);
+  if (violations & VIOLATION_CORE)
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Task %s runs on core %d, planned for %d", status->pcTaskName, core,
+                        (entry->core == tskNO_AFFINITY) ? -1 : (int)entry->core);
+  if (violations & VIOLATION_PRIORITY)
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Task %s runs at priority %u, planned for %u", status->pcTaskName,
+                        (unsigned)status->uxBasePriority, (unsigned)entry->priority);
+  if (violations & VIOLATION_STACK)
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Task %s has only %lu bytes of stack left", status->pcTaskName,
+                        (unsigned long)status->usStackHighWaterMark);
+}
+
+/**
+ * @brief Read all tasks and log new violations, with check_mutex held
+ */
+static int check_locked(void)
+{
+  uint32_t total = 0;
+  status_count = uxTaskGetSystemState(status_buf, TASK_PLAN_MAX_TASKS, &total);
+  if (status_count == 0)
+  {
+    if (!overflow_warned)
+    {
+      overflow_warned = true;
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "More than %d tasks, task plan not checked", TASK_PLAN_MAX_TASKS);
+    }
+    return violation_count;
+  }
+
+  for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++)
+  {
+    reported[i].seen = false;
+  }
+
+  int count = 0;
+  for (UBaseType_t i = 0; i < status_count; i++)
+  {
+    uint8_t violations = task_violations(&status_buf[i]);
+    reported_t *slot = find_reported(status_buf[i].xHandle);
+    if (violations)
+      count++;
+    if (!slot)
+      continue;
+    if (violations & ~slot->violations)
+      log_violations(&status_buf[i], violations & ~slot->violations);
+    slot->violations = violations;
+    slot->seen = true;
+  }
+  for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++)
+  {
+    if (reported[i].handle && !reported[i].seen)
+      reported[i].handle = NULL;
+  }
+
+  violation_count = count;
+  return count;
+}
+
+static void check_timer_cb(void *arg)
+{
+  task_plan_check();
+}
+
+static const TaskStatus_t *find_status(const char *name, int *instances)
+{
+  const TaskStatus_t *found = NULL;
+  *instances = 0;
+  for (UBaseType_t i = 0; i < status_count; i++)
+  {
+    if (strcmp(status_buf[i].pcTaskName, name) == 0)
+    {
+      // Of several instances, the one closest to overflowing
+      if (!found || status_buf[i].usStackHighWaterMark < found->usStackHighWaterMark)
+        found = &status_buf[i];
+      (*instances)++;
+    }
+  }
+  return found;
+}
+
+static int violation_names(uint8_t violations, char *buf, size_t size)
+{
+  static const char *const names[] = {"core", "priority", "stack", "unplanned"};
+  int len = 0;
+  buf[0] = '\0';
+  for (int i = 0; i < 4 && len < (int)size; i++)
+  {
+    if (violations & (1 << i))
+      len += snprintf(buf + len, size - len, "%s\"%s\"", len ? "," : "", names[i]);
+  }
+  return len;
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+const task_plan_entry_t *task_plan_get(task_plan_id_t id)
+{
+  return (id < TASK_PLAN_COUNT) ? &plan[id] : NULL;
+}
+
+BaseType_t task_plan_create(task_plan_id_t id, TaskFunction_t task, void *arg, TaskHandle_t *handle)
+{
+  if (id >= TASK_PLAN_COUNT || plan[id].external)
+  {
+    return pdFAIL;
+  }
+
+  const task_plan_entry_t *entry = &plan[id];
+  if (entry->psram_stack)
+  {
+    return task_stack_create(task, entry->name, entry->stack_size, arg, entry->priority, handle, entry->core);
+  }
+  return xTaskCreatePinnedToCore(task, entry->name, entry->stack_size, arg, entry->priority, handle, entry->core);
+}
+
+esp_err_t task_plan_start_monitor(void)
+{
+#if TASK_PLAN_CHECK_SUPPORTED
+  if (check_mutex)
+  {
+    return ESP_OK;
+  }
+
+  status_buf = heap_caps_calloc(TASK_PLAN_MAX_TASKS, sizeof(TaskStatus_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  reported = heap_caps_calloc(TASK_PLAN_MAX_TASKS, sizeof(reported_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  check_mutex = xSemaphoreCreateMutex();
+  if (!status_buf || !reported || !check_mutex)
+  {
+    heap_caps_free(status_buf);
+    heap_caps_free(reported);
+    if (check_mutex)
+      vSemaphoreDelete(check_mutex);
+    status_buf = NULL;
+    reported = NULL;
+    check_mutex = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  metrics_register(&violations_metric);
+
+  if (TASK_PLAN_CHECK_PERIOD_S > 0)
+  {
+    const esp_timer_create_args_t timer_args = {
+        .callback = check_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "task_plan",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &check_timer);
+    if (ret == ESP_OK)
+    {
+      ret = esp_timer_start_periodic(check_timer, (uint64_t)TASK_PLAN_CHECK_PERIOD_S * 1000000);
+    }
+    if (ret != ESP_OK)
+    {
+      // GET_TASK_PLAN still checks on demand
+      debug_log_error_f(DEBUG_TAG_SYSTEM, "Task plan timer failed: %s", esp_err_to_name(ret));
+    }
+  }
+
+  int violations = task_plan_check();
+  debug_log_info_f(DEBUG_TAG_SYSTEM, "Task plan monitor started, %d violation(s)", violations);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int task_plan_check(void)
+{
+#if TASK_PLAN_CHECK_SUPPORTED
+  if (!check_mutex)
+  {
+    return -1;
+  }
+
+  xSemaphoreTake(check_mutex, portMAX_DELAY);
+  int count = check_locked();
+  xSemaphoreGive(check_mutex);
+  return count;
+#else
+  return -1;
+#endif
+}
+
+bool task_plan_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TASK_PLAN") != 0)
+  {
+    return false;
+  }
+
+#if TASK_PLAN_CHECK_SUPPORTED
+  if (!check_mutex)
+  {
+    static const char stopped[] = "TASK_PLAN {\"error\":\"not started\"}\n";
+    serial_data_write(stopped, sizeof(stopped) - 1);
+    return true;
+  }
+
+  xSemaphoreTake(check_mutex, portMAX_DELAY);
+  int count = check_locked();
+
+  char buf[256];
+  char names[48];
+  int len = snprintf(buf, sizeof(buf), "TASK_PLAN {\"render_core\":%d,\"violations\":%d,\"tasks\":[",
+                     TASK_PLAN_RENDER_CORE, count);
+  serial_data_write(buf, len);
+
+  for (int i = 0; i < TASK_PLAN_COUNT; i++)
+  {
+    const task_plan_entry_t *entry = &plan[i];
+    int instances = 0;
+    const TaskStatus_t *status = find_status(entry->name, &instances);
+    int core = (entry->core == tskNO_AFFINITY) ? -1 : (int)entry->core;
+    len = snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u,\"stack\":%lu,\"running\":%d",
+                   i ? "," : "", entry->name, core, (unsigned)entry->priority, (unsigned long)entry->stack_size,
+                   instances);
+    if (status)
+    {
+      violation_names(task_violations(status), names, sizeof(names));
+      len += snprintf(buf + len, sizeof(buf) - len,
+                      ",\"actual_core\":%d,\"actual_prio\":%u,\"stack_free\":%lu,\"violations\":[%s]",
+                      (status->xCoreID == tskNO_AFFINITY) ? -1 : (int)status->xCoreID,
+                      (unsigned)status->uxBasePriority, (unsigned long)status->usStackHighWaterMark, names);
+    }
+    if (len < (int)sizeof(buf) - 1)
+      buf[len++] = '}';
+    serial_data_write(buf, len);
+  }
+
+  serial_data_write("],\"unplanned\":[", 15);
+  int unplanned = 0;
+  for (UBaseType_t i = 0; i < status_count; i++)
+  {
+    if (!(task_violations(&status_buf[i]) & VIOLATION_UNPLANNED))
+      continue;
+    len = snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u}", unplanned ? "," : "",
+                   status_buf[i].pcTaskName,
+                   (status_buf[i].xCoreID == tskNO_AFFINITY) ? -1 : (int)status_buf[i].xCoreID,
+                   (unsigned)status_buf[i].uxBasePriority);
+    serial_data_write(buf, len);
+    unplanned++;
+  }
+  xSemaphoreGive(check_mutex);
+  serial_data_write("]}\n", 3);
+#else
+  static const char disabled[] = "TASK_PLAN {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
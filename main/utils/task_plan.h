@@ -0,0 +1,160 @@
+/**
+ * @file task_plan.h
+ * @brief Central core, priority and stack plan of every firmware task
+ *
+ * Core 1 is the render core: the LVGL task and the touch reader that feeds
+ * it. Network, parsing, serial and housekeeping all run on core 0 next to
+ * the WiFi and lwIP tasks. The only guest on core 1 is the second parse
+ * worker, at priority 1 it only takes time LVGL leaves idle.
+ *
+ * Tasks are created through task_plan_create() with the entry of their id,
+ * so a placement is changed in the table in task_plan.c and nowhere else.
+ * Tasks that IDF components create themselves (WiFi, lwIP, MQTT,
+ * WebSocket, HTTP server) are listed too; their stacks and priorities are
+ * passed to the component from the table, their cores come from
+ * sdkconfig. Boot steps and the panel init helper are short-lived and keep
+ * their own placement.
+ *
+ * A periodic check compares the running tasks against the plan and logs
+ * each new violation once: a planned task on another core or at another
+ * base priority, a stack within TASK_PLAN_STACK_MARGIN of overflowing, or
+ * a task nobody planned on the render core or free to float onto it.
+ * GET_TASK_PLAN prints the plan next to what is actually running.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef TASK_PLAN_H
+#define TASK_PLAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define TASK_PLAN_RENDER_CORE 1
+#define TASK_PLAN_NETWORK_CORE 0
+
+  /** Stack headroom in bytes below which a task is reported */
+#define TASK_PLAN_STACK_MARGIN 512
+
+  /** Tasks read per check, IDF's own included */
+#define TASK_PLAN_MAX_TASKS 48
+
+  /** Check period, 0 checks on GET_TASK_PLAN only */
+#ifdef CONFIG_TASK_PLAN_CHECK_PERIOD_S
+#define TASK_PLAN_CHECK_PERIOD_S CONFIG_TASK_PLAN_CHECK_PERIOD_S
+#else
+#define TASK_PLAN_CHECK_PERIOD_S 60
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    // Render core
+    TASK_PLAN_LVGL = 0,
+    TASK_PLAN_TOUCH,
+    TASK_PLAN_ENTITY_PARSER_HELPER,
+
+    // Network core, created here
+    TASK_PLAN_LCD_FLUSH,
+    TASK_PLAN_SERIAL,
+    TASK_PLAN_SERIAL_MUX,
+    TASK_PLAN_TELEMETRY_NET,
+    TASK_PLAN_TELEMETRY_RELAY,
+    TASK_PLAN_TELEMETRY_SD_LOG,
+    TASK_PLAN_ENTITY_PARSER,
+    TASK_PLAN_SYNC_STATES,
+    TASK_PLAN_HA_WORKER,
+    TASK_PLAN_HA_FETCH,
+    TASK_PLAN_HA_DNS,
+    TASK_PLAN_HA_PROBE,
+    TASK_PLAN_HA_LATENCY,
+    TASK_PLAN_HA_SHARE,
+    TASK_PLAN_HA_CAMERA,
+    TASK_PLAN_HA_CAMERA_DECODE,
+    TASK_PLAN_ALERT_AUDIO,
+    TASK_PLAN_OTA,
+    TASK_PLAN_SCREENSHOT,
+    TASK_PLAN_HISTORY_EXPORT,
+    TASK_PLAN_DEFERRED_INIT,
+    TASK_PLAN_LOG_DRAIN,
+    TASK_PLAN_PROFILER,
+    TASK_PLAN_UI_BENCH,
+    TASK_PLAN_LVGL_BENCH,
+
+    // Created by IDF components
+    TASK_PLAN_WIFI,
+    TASK_PLAN_TCPIP,
+    TASK_PLAN_MQTT,
+    TASK_PLAN_WEBSOCKET,
+    TASK_PLAN_DIAG_HTTP,
+
+    TASK_PLAN_COUNT
+  } task_plan_id_t;
+
+  typedef struct
+  {
+    const char *name;     ///< Task name, also how the check finds it
+    uint32_t stack_size;  ///< Bytes, 0 if the component sizes it
+    UBaseType_t priority; ///< 0 if the component picks it
+    BaseType_t core;      ///< 0, 1 or tskNO_AFFINITY
+    bool psram_stack;     ///< Created through task_stack_create(), see task_stack.h
+    bool external;        ///< Created by an IDF component, only checked
+  } task_plan_entry_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Planned placement of a task
+   */
+  const task_plan_entry_t *task_plan_get(task_plan_id_t id);
+
+  /**
+   * @brief Create a task with the name, stack, priority and core of its plan entry
+   * @param id Entry of the task, not an external one
+   * @return pdPASS on success
+   * @note A task with psram_stack set must be deleted with task_stack_delete()
+   */
+  BaseType_t task_plan_create(task_plan_id_t id, TaskFunction_t task, void *arg, TaskHandle_t *handle);
+
+  /**
+   * @brief Allocate the check buffers and start the periodic check
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without trace facility and core ids
+   */
+  esp_err_t task_plan_start_monitor(void);
+
+  /**
+   * @brief Compare the running tasks against the plan, log new violations
+   * @return Tasks currently in violation, -1 if the monitor is not started
+   */
+  int task_plan_check(void);
+
+  /**
+   * @brief Handle GET_TASK_PLAN
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a task plan command
+   */
+  bool task_plan_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PLAN_H
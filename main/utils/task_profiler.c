@@ -0,0 +1,296 @@
+/**
+ * @file task_profiler.c
+ * @brief Periodic per-task CPU, stack and blocking profiler
+ *
+ * Run-time counters tick in microseconds of esp_timer time, so a task's
+ * counter delta over the period's wall time is its share of one core.
+ * Tasks are matched across samples by handle; a slot is freed when its
+ * task no longer shows up, i.e. was deleted.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "task_profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "task_plan.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  TaskHandle_t handle; ///< NULL for a free slot
+  bool seen;           ///< Found in the current sample
+  bool stack_warned;
+  uint32_t runtime_last;
+  uint32_t samples;
+  uint32_t blocked_mask; ///< Bit 0 is the newest sample
+  task_profile_t profile;
+} task_slot_t;
+
+#if CONFIG_TASK_PROFILER
+// Written by the profiler task, read by the serial task
+static SemaphoreHandle_t profiler_mutex = NULL;
+static TaskStatus_t *status_buf = NULL;
+static task_slot_t *slots = NULL;
+static uint32_t total_last = 0;
+static uint32_t sample_count = 0;
+static uint16_t core_load[2] = {0, 0};
+static bool overflow_warned = false;
+
+static int64_t read_core_load(const metric_t *metric)
+{
+  return core_load[metric->arg];
+}
+
+static metric_t core_load_metrics[] = {
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "cpu_load_permille", "Core load over the last profiler period",
+                     "core=\"0\"", read_core_load, 0),
+    METRIC_READ_INIT(METRIC_TYPE_GAUGE, "cpu_load_permille", "Core load over the last profiler period",
+                     "core=\"1\"", read_core_load, 1),
+};
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_TASK_PROFILER
+
+static task_slot_t *find_slot(TaskHandle_t handle)
+{
+  task_slot_t *free_slot = NULL;
+  for (int i = 0; i < TASK_PROFILER_MAX_TASKS; i++)
+  {
+    if (slots[i].handle == handle)
+      return &slots[i];
+    if (!slots[i].handle && !free_slot)
+      free_slot = &slots[i];
+  }
+  if (free_slot)
+  {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->handle = handle;
+  }
+  return free_slot;
+}
+
+static void update_slot(task_slot_t *slot, const TaskStatus_t *status, uint32_t elapsed)
+{
+  task_profile_t *profile = &slot->profile;
+  if (slot->samples == 0)
+  {
+    strlcpy(profile->name, status->pcTaskName, sizeof(profile->name));
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+    profile->core = (status->xCoreID == tskNO_AFFINITY) ? -1 : (int8_t)status->xCoreID;
+#else
+    profile->core = -1;
+#endif
+    profile->stack_free_min = UINT32_MAX;
+  }
+  else if (elapsed > 0)
+  {
+    uint64_t permille = (uint64_t)(status->ulRunTimeCounter - slot->runtime_last) * 1000 / elapsed;
+    profile->cpu_permille = (permille > 1000) ? 1000 : (uint16_t)permille;
+    profile->cpu_avg_permille = (slot->samples == 1)
+                                    ? profile->cpu_permille
+                                    : (uint16_t)((profile->cpu_avg_permille * 7 + profile->cpu_permille) / 8);
+    if (profile->cpu_permille > profile->cpu_peak_permille)
+      profile->cpu_peak_permille = profile->cpu_permille;
+  }
+  slot->runtime_last = status->ulRunTimeCounter;
+  slot->samples++;
+  slot->seen = true;
+
+  profile->base_priority = (uint8_t)status->uxBasePriority;
+  slot->blocked_mask = (slot->blocked_mask << 1) | (status->eCurrentState == eBlocked ? 1 : 0);
+  uint32_t window = (slot->samples < TASK_PROFILER_WINDOW) ? slot->samples : TASK_PROFILER_WINDOW;
+  uint32_t mask = (window < 32) ? ((1UL << window) - 1) : UINT32_MAX;
+  profile->blocked_pct = (uint8_t)(__builtin_popcount(slot->blocked_mask & mask) * 100 / window);
+
+  // Raised above its own priority: it holds a mutex a higher priority task waits for
+  if (status->uxCurrentPriority > status->uxBasePriority)
+    profile->inherited_samples++;
+
+  // ESP-IDF reports the high-water mark in bytes
+  if (status->usStackHighWaterMark < profile->stack_free_min)
+    profile->stack_free_min = status->usStackHighWaterMark;
+  if (!slot->stack_warned && profile->stack_free_min < TASK_PROFILER_STACK_WARN_BYTES)
+  {
+    slot->stack_warned = true;
+    debug_log_warning_f(DEBUG_TAG_SYSTEM, "Task %s has only %lu bytes of stack left", profile->name,
+                        (unsigned long)profile->stack_free_min);
+  }
+}
+
+static void take_sample(void)
+{
+  uint32_t total = 0;
+  UBaseType_t count = uxTaskGetSystemState(status_buf, TASK_PROFILER_MAX_TASKS, &total);
+  if (count == 0)
+  {
+    if (!overflow_warned)
+    {
+      overflow_warned = true;
+      debug_log_warning_f(DEBUG_TAG_SYSTEM, "More than %d tasks, profiler paused", TASK_PROFILER_MAX_TASKS);
+    }
+    return;
+  }
+
+  xSemaphoreTake(profiler_mutex, portMAX_DELAY);
+  uint32_t elapsed = total - total_last;
+  total_last = total;
+
+  for (int i = 0; i < TASK_PROFILER_MAX_TASKS; i++)
+  {
+    slots[i].seen = false;
+  }
+  for (UBaseType_t i = 0; i < count; i++)
+  {
+    task_slot_t *slot = find_slot(status_buf[i].xHandle);
+    if (slot)
+      update_slot(slot, &status_buf[i], (sample_count > 0) ? elapsed : 0);
+  }
+  for (int i = 0; i < TASK_PROFILER_MAX_TASKS; i++)
+  {
+    if (slots[i].handle && !slots[i].seen)
+      slots[i].handle = NULL;
+  }
+
+  // Whatever the idle task did not get was load
+  for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++)
+  {
+    TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+    for (int i = 0; i < TASK_PROFILER_MAX_TASKS; i++)
+    {
+      if (slots[i].handle == idle && slots[i].samples > 1)
+        core_load[core] = 1000 - slots[i].profile.cpu_permille;
+    }
+  }
+  sample_count++;
+  xSemaphoreGive(profiler_mutex);
+}
+
+static void profiler_task(void *arg)
+{
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1)
+  {
+    take_sample();
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TASK_PROFILER_PERIOD_MS));
+  }
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t task_profiler_start(void)
+{
+#if CONFIG_TASK_PROFILER
+  if (profiler_mutex)
+  {
+    return ESP_OK;
+  }
+
+  status_buf = heap_caps_calloc(TASK_PROFILER_MAX_TASKS, sizeof(TaskStatus_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  slots = heap_caps_calloc(TASK_PROFILER_MAX_TASKS, sizeof(task_slot_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  profiler_mutex = xSemaphoreCreateMutex();
+  if (!status_buf || !slots || !profiler_mutex ||
+      task_plan_create(TASK_PLAN_PROFILER, profiler_task, NULL, NULL) != pdPASS)
+  {
+    heap_caps_free(status_buf);
+    heap_caps_free(slots);
+    if (profiler_mutex)
+      vSemaphoreDelete(profiler_mutex);
+    status_buf = NULL;
+    slots = NULL;
+    profiler_mutex = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  metrics_register(&core_load_metrics[0]);
+  metrics_register(&core_load_metrics[1]);
+  debug_log_info(DEBUG_TAG_SYSTEM, "Task profiler started");
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int task_profiler_snapshot(task_profile_t *tasks, int max_tasks, uint16_t core_load_permille[2])
+{
+#if CONFIG_TASK_PROFILER
+  if (!profiler_mutex || !tasks)
+  {
+    return 0;
+  }
+
+  int count = 0;
+  xSemaphoreTake(profiler_mutex, portMAX_DELAY);
+  for (int i = 0; i < TASK_PROFILER_MAX_TASKS && count < max_tasks; i++)
+  {
+    if (slots[i].handle && slots[i].samples > 1)
+      tasks[count++] = slots[i].profile;
+  }
+  if (core_load_permille)
+  {
+    core_load_permille[0] = core_load[0];
+    core_load_permille[1] = core_load[1];
+  }
+  xSemaphoreGive(profiler_mutex);
+  return count;
+#else
+  return 0;
+#endif
+}
+
+bool task_profiler_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_TASK_STATS") != 0)
+  {
+    return false;
+  }
+
+#if CONFIG_TASK_PROFILER
+  // Only the serial task asks, a static copy keeps the table off its stack
+  static task_profile_t tasks[TASK_PROFILER_MAX_TASKS];
+  uint16_t cores[2] = {0, 0};
+  int count = task_profiler_snapshot(tasks, TASK_PROFILER_MAX_TASKS, cores);
+
+  char buf[224];
+  int len = snprintf(buf, sizeof(buf), "TASK_STATS {\"period_ms\":%d,\"core_load\":[%u.%u,%u.%u],\"tasks\":[",
+                     TASK_PROFILER_PERIOD_MS, cores[0] / 10, cores[0] % 10, cores[1] / 10, cores[1] % 10);
+  serial_data_write(buf, len);
+
+  for (int i = 0; i < count; i++)
+  {
+    const task_profile_t *task = &tasks[i];
+    len = snprintf(buf, sizeof(buf),
+                   "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u,\"cpu\":%u.%u,\"cpu_avg\":%u.%u,\"cpu_peak\":%u.%u,"
+                   "\"stack_free\":%lu,\"blocked_pct\":%u,\"inherited\":%lu}",
+                   i ? "," : "", task->name, task->core, task->base_priority, task->cpu_permille / 10,
+                   task->cpu_permille % 10, task->cpu_avg_permille / 10, task->cpu_avg_permille % 10,
+                   task->cpu_peak_permille / 10, task->cpu_peak_permille % 10, (unsigned long)task->stack_free_min,
+                   task->blocked_pct, (unsigned long)task->inherited_samples);
+    serial_data_write(buf, len);
+  }
+  serial_data_write("]}\n", 3);
+#else
+  static const char disabled[] = "TASK_STATS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
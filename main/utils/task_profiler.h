@@ -0,0 +1,101 @@
+/**
+ * @file task_profiler.h
+ * @brief Periodic per-task CPU, stack and blocking profiler
+ *
+ * Samples every FreeRTOS task with uxTaskGetSystemState() once per period
+ * and keeps rolling figures per task: CPU use from the run-time counters,
+ * the stack high-water mark, how often it was found blocked, and how often
+ * it was running on a priority inherited through a mutex (a priority
+ * inversion in progress). Core load is derived from the idle tasks. Read
+ * with task_profiler_snapshot() or GET_TASK_STATS, e.g. to right-size the
+ * task stacks.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Tasks tracked at once, more are left out of the figures */
+#define TASK_PROFILER_MAX_TASKS 40
+
+  /** Sample period */
+#ifdef CONFIG_TASK_PROFILER_PERIOD_MS
+#define TASK_PROFILER_PERIOD_MS CONFIG_TASK_PROFILER_PERIOD_MS
+#else
+#define TASK_PROFILER_PERIOD_MS 1000
+#endif
+
+  /** Samples the blocked share is taken over, one bit each */
+#define TASK_PROFILER_WINDOW 32
+
+  /** Stack headroom below which a task is reported once in the log */
+#define TASK_PROFILER_STACK_WARN_BYTES 512
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Rolling figures of one task
+   */
+  typedef struct
+  {
+    char name[configMAX_TASK_NAME_LEN];
+    int8_t core;                 ///< Core the task is pinned to, -1 if either
+    uint8_t base_priority;
+    uint16_t cpu_permille;       ///< Share of one core over the last period
+    uint16_t cpu_avg_permille;   ///< Moving average, about 8 periods
+    uint16_t cpu_peak_permille;  ///< Highest single period since the task was first seen
+    uint32_t stack_free_min;     ///< Stack bytes never used so far
+    uint8_t blocked_pct;         ///< Share of the last TASK_PROFILER_WINDOW samples found blocked
+    uint32_t inherited_samples;  ///< Samples found running above its base priority
+  } task_profile_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start the profiler task
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig,
+   *         ESP_ERR_NO_MEM if the task or its buffers could not be created
+   */
+  esp_err_t task_profiler_start(void);
+
+  /**
+   * @brief Copy the current figures
+   * @param tasks Array for the per-task figures
+   * @param max_tasks Size of the array
+   * @param core_load_permille Load of core 0 and 1 over the last period, may be NULL
+   * @return Number of tasks copied, 0 before the first two samples
+   */
+  int task_profiler_snapshot(task_profile_t *tasks, int max_tasks, uint16_t core_load_permille[2]);
+
+  /**
+   * @brief Handle GET_TASK_STATS
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a task profiler command
+   */
+  bool task_profiler_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PROFILER_H
@@ -0,0 +1,46 @@
+/**
+ * @file task_stack.c
+ * @brief Task creation with the stack in PSRAM for tasks that allow it
+ *
+ * Built on the IDF WithCaps variants, which create a static task over a
+ * heap_caps stack and keep the TCB internal. There is no silent fallback
+ * to DRAM: a task created one way is deleted the same way.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "task_stack.h"
+
+#include "esp_heap_caps.h"
+#include "freertos/idf_additions.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+BaseType_t task_stack_create(TaskFunction_t task, const char *name, uint32_t stack_size, void *arg,
+                             UBaseType_t priority, TaskHandle_t *handle, BaseType_t core_id)
+{
+#if CONFIG_TASK_STACKS_IN_PSRAM
+  BaseType_t result = xTaskCreatePinnedToCoreWithCaps(task, name, stack_size, arg, priority, handle, core_id,
+                                                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (result == pdPASS)
+  {
+    debug_log_debug_f(DEBUG_TAG_SYSTEM, "Task %s: %lu byte stack in PSRAM", name, (unsigned long)stack_size);
+  }
+  return result;
+#else
+  return xTaskCreatePinnedToCore(task, name, stack_size, arg, priority, handle, core_id);
+#endif
+}
+
+void task_stack_delete(TaskHandle_t handle)
+{
+#if CONFIG_TASK_STACKS_IN_PSRAM
+  vTaskDeleteWithCaps(handle);
+#else
+  vTaskDelete(handle);
+#endif
+}
@@ -0,0 +1,51 @@
+/**
+ * @file task_stack.h
+ * @brief Task creation with the stack in PSRAM for tasks that allow it
+ *
+ * A task whose stack lives in PSRAM cannot run while the flash cache is
+ * disabled, so it must never write NVS, erase a partition or touch any
+ * other flash operation itself. Network, HTTP and parse workers qualify;
+ * the LVGL, touch and serial tasks do not (the serial task runs commands
+ * that write NVS, LVGL and touch are hot paths that keep DRAM stacks).
+ * The TCB stays in internal RAM either way.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef TASK_STACK_H
+#define TASK_STACK_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Create a task with its stack in PSRAM
+   * @param core_id Core to pin to, or tskNO_AFFINITY
+   * @return pdPASS on success
+   * @note Falls back to an internal stack when TASK_STACKS_IN_PSRAM is off.
+   *       Delete the task with task_stack_delete(), it must not delete itself.
+   */
+  BaseType_t task_stack_create(TaskFunction_t task, const char *name, uint32_t stack_size, void *arg,
+                               UBaseType_t priority, TaskHandle_t *handle, BaseType_t core_id);
+
+  /**
+   * @brief Delete a task created by task_stack_create() and free its stack
+   */
+  void task_stack_delete(TaskHandle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_STACK_H
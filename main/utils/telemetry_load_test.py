@@ -0,0 +1,574 @@
+#!/usr/bin/env python3
+"""
+ESP32-S3 Telemetry Load Test
+============================
+
+Companion to crash_test_suite.py for the telemetry receive path:
+1. Replays recorded telemetry captures at their original pace or a fixed rate
+2. Generates synthetic JSON lines or binary frames at a configurable rate
+3. Optionally mixes in malformed input (truncated, oversized, garbage, bad CRC)
+4. Reads the device STATS and DISPLAY_METRICS replies to report drops,
+   parse failures, latency and UI update rate
+5. Answers the device's TIME_SYNC requests, so the reported latency is the
+   measured sender-to-display time rather than the variation above the
+   fastest sample
+6. With --adaptive, holds samples back as the device's TELEMETRY_RATE
+   requests ask, like a host agent that honours them
+
+Capture files contain one telemetry JSON object per line, exactly as sent
+to the device. Lines starting with '#' are ignored.
+
+Note that UART0 at 115200 baud carries roughly 11 KB/s, i.e. about 40 JSON
+samples/s or 150 binary frames/s. Rates up to 1 kHz need the USB CDC
+transport (CONFIG_SERIAL_TELEMETRY_USB_CDC).
+
+Requirements:
+    pip install pyserial
+
+Usage:
+    python telemetry_load_test.py --port COM3 --rate 10
+    python telemetry_load_test.py --port COM3 --rate 1000 --format binary --duration 30
+    python telemetry_load_test.py --port COM3 --replay capture.jsonl --fuzz 0.05
+    python telemetry_load_test.py --port COM3 --sweep 10,50,100,500,1000 --format binary
+    python telemetry_load_test.py --port COM3 --rate 1000 --format packed --keyframe-interval 200
+    python telemetry_load_test.py --port COM3 --rate 50 --adaptive --duration 60
+"""
+
+import argparse
+import json
+import math
+import random
+import struct
+import sys
+import time
+from datetime import datetime
+from typing import Dict, List, Optional
+
+import serial
+
+# Mirrors main/serial/telemetry_frame.h
+FRAME_VERSION = 1
+MSG_KEYFRAME = 0x01
+MSG_DELTA = 0x02
+MSG_DELTA_PACKED = 0x03
+FIELD_TIMESTAMP = 1 << 0
+FIELD_CPU_USAGE = 1 << 1
+FIELD_CPU_TEMP = 1 << 2
+FIELD_CPU_FAN = 1 << 3
+FIELD_CPU_NAME = 1 << 4
+FIELD_GPU_USAGE = 1 << 5
+FIELD_GPU_TEMP = 1 << 6
+FIELD_GPU_NAME = 1 << 7
+FIELD_GPU_MEM_USED = 1 << 8
+FIELD_GPU_MEM_TOTAL = 1 << 9
+FIELD_MEM_USAGE = 1 << 10
+FIELD_MEM_USED = 1 << 11
+FIELD_MEM_TOTAL = 1 << 12
+FIELD_MEM_AVAIL = 1 << 13
+FIELD_CPU_CORES = 1 << 14
+FIELD_ALL = (1 << 15) - 1
+LIST_MAX = 32
+
+# Device line buffer is 1024 bytes including the terminator
+DEVICE_LINE_BUFFER = 1024
+
+
+def crc16_ccitt(data: bytes) -> int:
+    """CRC16-CCITT, poly 0x1021, init 0xFFFF (telemetry_frame_crc16)."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """Consistent Overhead Byte Stuffing."""
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def packed_int(value: int, previous: int, width: int) -> bytes:
+    """Difference to the previous value, wrapped to width bytes, as a zigzag LEB128 varint."""
+    bits = 8 * width
+    diff = (value - previous) & ((1 << bits) - 1)
+    if diff >> (bits - 1):
+        diff -= 1 << bits
+    zigzag = (diff << 1) ^ (diff >> 63)
+    zigzag &= (1 << 64) - 1
+    out = bytearray()
+    while zigzag > 0x7F:
+        out.append((zigzag & 0x7F) | 0x80)
+        zigzag >>= 7
+    out.append(zigzag)
+    return bytes(out)
+
+
+def encode_frame(sample: Dict, fields: int, msg_type: int, previous: Optional[Dict] = None) -> bytes:
+    """Build a delimited binary frame from a sample dict in the JSON layout.
+
+    A MSG_DELTA_PACKED frame is encoded against previous, the sample the
+    receiver currently holds.
+    """
+    cpu, gpu, mem = sample["cpu"], sample["gpu"], sample["mem"]
+    packed = msg_type == MSG_DELTA_PACKED
+
+    def string(value: str) -> bytes:
+        raw = value.encode("utf-8")[:255]
+        return bytes([len(raw)]) + raw
+
+    def integer(fmt: str, path) -> bytes:
+        value, old = sample, previous
+        for key in path:
+            value = value[key]
+            old = old[key] if packed else None
+        return packed_int(value, old, struct.calcsize(fmt)) if packed else struct.pack(fmt, value)
+
+    payload = bytearray(struct.pack("<BBH", FRAME_VERSION, msg_type, fields))
+    if fields & FIELD_TIMESTAMP:
+        payload += integer("<Q", ("ts",))
+    if fields & FIELD_CPU_USAGE:
+        payload += integer("<B", ("cpu", "usage"))
+    if fields & FIELD_CPU_TEMP:
+        payload += integer("<B", ("cpu", "temp"))
+    if fields & FIELD_CPU_FAN:
+        payload += integer("<H", ("cpu", "fan"))
+    if fields & FIELD_CPU_NAME:
+        payload += string(cpu["name"])
+    if fields & FIELD_GPU_USAGE:
+        payload += integer("<B", ("gpu", "usage"))
+    if fields & FIELD_GPU_TEMP:
+        payload += integer("<B", ("gpu", "temp"))
+    if fields & FIELD_GPU_NAME:
+        payload += string(gpu["name"])
+    if fields & FIELD_GPU_MEM_USED:
+        payload += integer("<I", ("gpu", "mem_used"))
+    if fields & FIELD_GPU_MEM_TOTAL:
+        payload += integer("<I", ("gpu", "mem_total"))
+    if fields & FIELD_MEM_USAGE:
+        payload += integer("<B", ("mem", "usage"))
+    if fields & FIELD_MEM_USED:
+        payload += struct.pack("<f", mem["used"])
+    if fields & FIELD_MEM_TOTAL:
+        payload += struct.pack("<f", mem["total"])
+    if fields & FIELD_MEM_AVAIL:
+        payload += struct.pack("<f", mem["avail"])
+    if fields & FIELD_CPU_CORES:
+        cores = cpu.get("cores", [])[:LIST_MAX]
+        old_cores = previous["cpu"].get("cores", [])[:LIST_MAX] if packed else None
+        if packed and len(cores) == len(old_cores):
+            # Count flagged with 0x80, a bitmap of the changed values, then those values
+            changed = bytearray((len(cores) + 7) // 8)
+            for i, (new, old) in enumerate(zip(cores, old_cores)):
+                if new != old:
+                    changed[i // 8] |= 1 << (i % 8)
+            payload += bytes([0x80 | len(cores)]) + changed
+            payload += bytes(new for new, old in zip(cores, old_cores) if new != old)
+        else:
+            payload += bytes([len(cores)]) + bytes(cores)
+    payload += struct.pack("<H", crc16_ccitt(bytes(payload)))
+    return b"\x00" + cobs_encode(bytes(payload)) + b"\x00"
+
+
+def changed_fields(before: Optional[Dict], after: Dict) -> int:
+    """Field bitmap of values that differ between two samples."""
+    if before is None:
+        return FIELD_ALL
+    checks = [
+        (FIELD_TIMESTAMP, ("ts",)), (FIELD_CPU_USAGE, ("cpu", "usage")), (FIELD_CPU_TEMP, ("cpu", "temp")),
+        (FIELD_CPU_FAN, ("cpu", "fan")), (FIELD_CPU_NAME, ("cpu", "name")), (FIELD_GPU_USAGE, ("gpu", "usage")),
+        (FIELD_GPU_TEMP, ("gpu", "temp")), (FIELD_GPU_NAME, ("gpu", "name")),
+        (FIELD_GPU_MEM_USED, ("gpu", "mem_used")), (FIELD_GPU_MEM_TOTAL, ("gpu", "mem_total")),
+        (FIELD_MEM_USAGE, ("mem", "usage")), (FIELD_MEM_USED, ("mem", "used")),
+        (FIELD_MEM_TOTAL, ("mem", "total")), (FIELD_MEM_AVAIL, ("mem", "avail")),
+    ]
+    fields = 0
+    if before["cpu"].get("cores", []) != after["cpu"].get("cores", []):
+        fields |= FIELD_CPU_CORES
+    for bit, path in checks:
+        a, b = before, after
+        for key in path:
+            a, b = a[key], b[key]
+        if a != b:
+            fields |= bit
+    return fields
+
+
+class TelemetryLoadTest:
+    def __init__(self, port: str, baudrate: int = 115200, adaptive: bool = False):
+        """Initialize telemetry load test."""
+        self.port = port
+        self.baudrate = baudrate
+        self.serial_conn = None
+        self.rx_buffer = b""
+        self.sequence = 0
+        self.previous_sample = None
+        self.frames_sent = 0
+        self.adaptive = adaptive
+        self.rate_interval = 0.0  # Seconds between samples the device asked for, 0 pauses
+        self.rate_lease_end = 0.0  # The request applies until then
+        self.last_sent = 0.0
+
+    def connect(self) -> bool:
+        """Connect to ESP32-S3 device."""
+        try:
+            self.serial_conn = serial.Serial(
+                port=self.port,
+                baudrate=self.baudrate,
+                timeout=0,
+                write_timeout=2
+            )
+            print(f"✓ Connected to {self.port} at {self.baudrate} baud")
+            self.serial_conn.reset_input_buffer()
+            self.serial_conn.reset_output_buffer()
+            return True
+        except Exception as e:
+            print(f"✗ Failed to connect to {self.port}: {e}")
+            return False
+
+    def disconnect(self):
+        """Disconnect from device."""
+        if self.serial_conn and self.serial_conn.is_open:
+            self.serial_conn.close()
+            print("✓ Disconnected from device")
+
+    # -------------------------------------------------------------------
+    # Device queries
+    # -------------------------------------------------------------------
+
+    def drain_lines(self) -> List[str]:
+        """Return complete lines received so far, answering clock sync requests on the way."""
+        waiting = self.serial_conn.in_waiting
+        if waiting:
+            self.rx_buffer += self.serial_conn.read(waiting)
+        received = time.time()
+        *lines, self.rx_buffer = self.rx_buffer.split(b"\n")
+        lines = [line.decode("utf-8", errors="ignore").strip() for line in lines]
+        for line in lines:
+            self.answer_time_sync(line, received)
+            self.note_rate_request(line, received)
+        return lines
+
+    def answer_time_sync(self, line: str, received: float):
+        """Reply to a TIME_SYNC request, see main/serial/telemetry_clock.h."""
+        start = line.find("TIME_SYNC {")
+        if start < 0:
+            return
+        try:
+            seq = json.loads(line[start + len("TIME_SYNC "):])["seq"]
+        except (json.JSONDecodeError, KeyError):
+            return
+        reply = f"TIME_SYNC_REPLY {seq} {received * 1000:.3f} {time.time() * 1000:.3f}\n"
+        self.serial_conn.write(reply.encode("utf-8"))
+
+    def note_rate_request(self, line: str, received: float):
+        """Take a TELEMETRY_RATE request, see main/serial/telemetry_rate.h."""
+        start = line.find("TELEMETRY_RATE {")
+        if start < 0:
+            return
+        try:
+            request = json.loads(line[start + len("TELEMETRY_RATE "):])
+            self.rate_interval = request["interval_ms"] / 1000.0
+            self.rate_lease_end = received + request["lease_ms"] / 1000.0
+        except (json.JSONDecodeError, KeyError, TypeError):
+            return
+
+    def held_back(self, now: float) -> bool:
+        """True if the device's current rate request has no room for a sample now."""
+        if not self.adaptive or now >= self.rate_lease_end:
+            return False
+        return self.rate_interval == 0 or now - self.last_sent < self.rate_interval
+
+    def query(self, command: str, prefix: str, timeout: float = 3.0) -> Optional[Dict]:
+        """Send a command and wait for its single 'PREFIX {json}' reply line."""
+        self.serial_conn.write(f"{command}\n".encode("utf-8"))
+        self.serial_conn.flush()
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            for line in self.drain_lines():
+                start = line.find(prefix + " {")
+                if start >= 0:
+                    try:
+                        return json.loads(line[start + len(prefix) + 1:])
+                    except json.JSONDecodeError:
+                        print(f"⚠️  Malformed {prefix} reply: {line[:80]}")
+                        return None
+            time.sleep(0.01)
+        print(f"⚠️  No {prefix} reply within {timeout:.0f}s")
+        return None
+
+    def reset_stats(self):
+        """Clear device link counters before a run."""
+        self.serial_conn.write(b"STATS_RESET\n")
+        self.serial_conn.flush()
+        time.sleep(0.2)
+        self.drain_lines()
+
+    def local_stats(self) -> Optional[Dict]:
+        """Link statistics of the local source (id 0)."""
+        stats = self.query("STATS", "STATS")
+        if not stats:
+            return None
+        for source in stats.get("sources", []):
+            if source.get("id") == 0:
+                return source
+        return None
+
+    # -------------------------------------------------------------------
+    # Sample generation
+    # -------------------------------------------------------------------
+
+    def synthetic_sample(self) -> Dict:
+        """Plausible, slowly varying sample."""
+        t = self.sequence / 20.0
+        self.sequence += 1
+        return {
+            "ts": int(time.time() * 1000),
+            "cpu": {"usage": int(40 + 30 * math.sin(t)), "temp": int(55 + 10 * math.sin(t / 3)),
+                    "fan": 1200 + int(300 * math.sin(t / 5)), "name": "Load Test CPU",
+                    "cores": [int(40 + 30 * math.sin(t + core / 3)) for core in range(16)]},
+            "gpu": {"usage": int(50 + 40 * math.sin(t / 2)), "temp": int(60 + 8 * math.sin(t / 4)),
+                    "name": "Load Test GPU", "mem_used": 4096 + int(1024 * math.sin(t / 6)),
+                    "mem_total": 16384},
+            "mem": {"usage": int(45 + 10 * math.sin(t / 7)), "used": round(14.4 + 2 * math.sin(t / 7), 1),
+                    "total": 31.9, "avail": round(17.5 - 2 * math.sin(t / 7), 1)},
+        }
+
+    def encode_sample(self, sample: Dict, fmt: str, keyframe_interval: int) -> bytes:
+        """Encode a sample as a JSON line or a keyframe/delta binary frame."""
+        if fmt == "json":
+            return (json.dumps(sample, separators=(",", ":")) + "\n").encode("utf-8")
+
+        keyframe = self.previous_sample is None or self.frames_sent % keyframe_interval == 0
+        self.frames_sent += 1
+        previous, self.previous_sample = self.previous_sample, sample
+        if keyframe:
+            return encode_frame(sample, FIELD_ALL, MSG_KEYFRAME)
+        fields = changed_fields(previous, sample) | FIELD_TIMESTAMP
+        return encode_frame(sample, fields, MSG_DELTA_PACKED if fmt == "packed" else MSG_DELTA, previous)
+
+    def malformed_input(self, sample: Dict) -> bytes:
+        """One of several kinds of broken input."""
+        line = json.dumps(sample, separators=(",", ":"))
+        kind = random.choice(["truncated", "oversized", "garbage", "bad_crc", "unbalanced"])
+        if kind == "truncated":
+            return (line[:random.randint(5, len(line) - 2)] + "\n").encode("utf-8")
+        if kind == "oversized":
+            return ("{\"pad\":\"" + "x" * (DEVICE_LINE_BUFFER + 64) + "\"}\n").encode("utf-8")
+        if kind == "garbage":
+            return bytes(random.randint(1, 255) for _ in range(random.randint(8, 64))) + b"\n"
+        if kind == "bad_crc":
+            frame = bytearray(encode_frame(sample, FIELD_ALL, MSG_KEYFRAME))
+            index = len(frame) // 2
+            frame[index] ^= 0x5A
+            if frame[index] == 0:
+                frame[index] = 0x01  # A zero would split the frame instead
+            return bytes(frame)
+        return ("{\"cpu\":{\"usage\":" + str(random.randint(0, 100)) + "\n").encode("utf-8")
+
+    # -------------------------------------------------------------------
+    # Runs
+    # -------------------------------------------------------------------
+
+    def run(self, samples, rate: Optional[float], fmt: str, fuzz: float, keyframe_interval: int) -> Dict:
+        """Send samples, then collect device statistics."""
+        self.reset_stats()
+
+        sent = malformed = sent_bytes = held = 0
+        start = time.time()
+        next_send = start
+        previous_ts = None
+
+        for sample in samples:
+            # Replay keeps the recorded spacing unless a fixed rate is given
+            if rate:
+                next_send += 1.0 / rate
+            elif previous_ts is not None:
+                next_send += max(0, sample["ts"] - previous_ts) / 1000.0
+            previous_ts = sample.get("ts")
+
+            delay = next_send - time.time()
+            if delay > 0:
+                time.sleep(delay)
+
+            if self.held_back(time.time()):
+                held += 1
+                self.drain_lines()
+                continue
+
+            if fuzz > 0 and random.random() < fuzz:
+                payload = self.malformed_input(sample)
+                malformed += 1
+            else:
+                if rate:
+                    sample["ts"] = int(time.time() * 1000)
+                payload = self.encode_sample(sample, fmt, keyframe_interval)
+                sent += 1
+
+            self.serial_conn.write(payload)
+            sent_bytes += len(payload)
+            self.last_sent = time.time()
+            self.drain_lines()
+
+        elapsed = time.time() - start
+        # Let the device finish the backlog and the rate window roll over
+        time.sleep(1.5)
+        self.previous_sample = None
+        self.frames_sent = 0
+
+        stats = self.local_stats()
+        display = self.query("GET_DISPLAY_METRICS", "DISPLAY_METRICS")
+        return self.summarize(sent, malformed, sent_bytes, elapsed, stats, display, held)
+
+    def summarize(self, sent, malformed, sent_bytes, elapsed, stats, display, held=0) -> Dict:
+        """Combine host-side and device-side numbers."""
+        result = {
+            "sent": sent,
+            "held_back": held,
+            "malformed_sent": malformed,
+            "bytes_sent": sent_bytes,
+            "elapsed_s": round(elapsed, 3),
+            "offered_rate_hz": round(sent / elapsed, 1) if elapsed > 0 else 0,
+            "device": stats,
+        }
+        if stats:
+            received = stats.get("samples", 0)
+            result["dropped"] = max(0, sent - received)
+            result["drop_pct"] = round(100.0 * result["dropped"] / sent, 2) if sent else 0.0
+            result["achieved_rate_hz"] = round(received / elapsed, 1) if elapsed > 0 else 0
+        if display:
+            # Rendered frames over the device's metrics window, i.e. the UI update rate
+            result["ui_fps"] = display.get("fps")
+            result["display_metrics"] = display
+        return result
+
+    def print_summary(self, label: str, result: Dict):
+        """Print one run."""
+        print(f"\n📊 {label}")
+        print(f"   Sent: {result['sent']} samples ({result['malformed_sent']} malformed), "
+              f"{result['bytes_sent']} bytes in {result['elapsed_s']}s ({result['offered_rate_hz']} Hz)")
+        if result.get("held_back"):
+            print(f"   Held back: {result['held_back']} samples on the device's rate requests")
+        stats = result.get("device")
+        if not stats:
+            print("   ⚠️  No device statistics")
+            return
+        print(f"   Device: {stats['samples']} samples, {result['dropped']} dropped ({result['drop_pct']}%), "
+              f"{result['achieved_rate_hz']} Hz")
+        print(f"   Errors: parse={stats['parse_failures']} overflow={stats['line_overflows']} "
+              f"frame={stats['frame_errors']} crc={stats['crc_errors']} delta_dropped={stats['deltas_dropped']} "
+              f"overruns={stats['rx_overruns']}")
+        latency = stats.get("latency_ms", {})
+        basis = "synced" if latency.get("synced") else "above fastest"
+        print(f"   Latency ({basis}): last={latency.get('last')} avg={latency.get('avg')} "
+              f"max={latency.get('max')} ms")
+        print(f"   Jitter histogram <1/<2/<5/<10/<20/<50/<100/>=100 ms: {stats['jitter_ms']}")
+        if result.get("ui_fps") is not None:
+            print(f"   UI rate: {result['ui_fps']} fps")
+
+    def save_results(self, results: Dict, filename: str = None):
+        """Save results to JSON file."""
+        if not filename:
+            timestamp = datetime.now().strftime('%Y%m%d_%H%M%S')
+            filename = f"telemetry_load_results_{timestamp}.json"
+        try:
+            with open(filename, 'w') as f:
+                json.dump(results, f, indent=2)
+            print(f"💾 Results saved to: {filename}")
+        except Exception as e:
+            print(f"⚠️  Failed to save results: {e}")
+
+
+def load_capture(path: str) -> List[Dict]:
+    """Read a JSONL capture, skipping comments and unparsable lines."""
+    samples = []
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            try:
+                samples.append(json.loads(line))
+            except json.JSONDecodeError:
+                continue
+    return samples
+
+
+def main():
+    """Main function."""
+    parser = argparse.ArgumentParser(description="ESP32-S3 Telemetry Load Test")
+    parser.add_argument("--port", "-p", default="COM3", help="Serial port (default: COM3)")
+    parser.add_argument("--baudrate", "-b", type=int, default=115200, help="Baud rate (default: 115200)")
+    parser.add_argument("--replay", help="JSONL capture to replay instead of synthetic samples")
+    parser.add_argument("--rate", "-r", type=float, help="Samples per second (default: 10, replay keeps recorded pace)")
+    parser.add_argument("--sweep", help="Comma separated rates to run one after another, e.g. 10,100,1000")
+    parser.add_argument("--duration", "-d", type=float, default=10.0, help="Seconds per synthetic run (default: 10)")
+    parser.add_argument("--format", "-f", choices=["json", "binary", "packed"], default="json",
+                        help="Wire format, packed sends varint deltas between keyframes (default: json)")
+    parser.add_argument("--keyframe-interval", type=int, default=50, help="Binary: keyframe every N frames (default: 50)")
+    parser.add_argument("--adaptive", action="store_true", help="Honour the device's TELEMETRY_RATE requests")
+    parser.add_argument("--fuzz", type=float, default=0.0, help="Fraction of malformed inputs, 0..1 (default: 0)")
+    parser.add_argument("--seed", type=int, help="Random seed for reproducible fuzzing")
+    parser.add_argument("--save", "-s", action="store_true", help="Save results to JSON file")
+    parser.add_argument("--output", "-o", help="Output filename for results")
+
+    args = parser.parse_args()
+    if args.seed is not None:
+        random.seed(args.seed)
+
+    print("ESP32-S3 Telemetry Load Test")
+    print("============================")
+    print(f"Port: {args.port}")
+    print(f"Format: {args.format}")
+    print()
+
+    tester = TelemetryLoadTest(args.port, args.baudrate, args.adaptive)
+    if not tester.connect():
+        sys.exit(1)
+
+    results = {}
+    try:
+        if args.replay:
+            samples = load_capture(args.replay)
+            if not samples:
+                print(f"❌ No samples in {args.replay}")
+                sys.exit(1)
+            label = f"replay {args.replay} ({len(samples)} samples)"
+            results[label] = tester.run(samples, args.rate, args.format, args.fuzz, args.keyframe_interval)
+            tester.print_summary(label, results[label])
+        else:
+            rates = [float(r) for r in args.sweep.split(",")] if args.sweep else [args.rate or 10.0]
+            for rate in rates:
+                wire_bytes = {"json": 260, "binary": 75, "packed": 30}[args.format]
+                if rate * wire_bytes > args.baudrate / 10:
+                    print(f"⚠️  {rate:g} Hz exceeds what {args.baudrate} baud can carry, expect drops")
+                count = int(rate * args.duration)
+                samples = (tester.synthetic_sample() for _ in range(count))
+                label = f"synthetic {rate:g} Hz"
+                results[label] = tester.run(samples, rate, args.format, args.fuzz, args.keyframe_interval)
+                tester.print_summary(label, results[label])
+    finally:
+        tester.disconnect()
+
+    if args.save:
+        tester.save_results(results, args.output)
+
+
+if __name__ == "__main__":
+    main()
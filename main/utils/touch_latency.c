@@ -0,0 +1,292 @@
+/**
+ * @file touch_latency.c
+ * @brief Touch-to-photon latency probe
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "touch_latency.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+
+// =======================================================================
+// PRIVATE TYPES
+// =======================================================================
+
+/** Intervals from the touch, in the order they are reported */
+enum
+{
+  LATENCY_INVALIDATE = 0, ///< First invalidation, usually the pressed style
+  LATENCY_DISPATCH,       ///< Switch handler ran
+  LATENCY_PHOTON,         ///< Flush of the frame showing the change finished
+  LATENCY_COUNT
+};
+
+/** Progress of the press being measured */
+typedef enum
+{
+  PROBE_IDLE = 0,
+  PROBE_TOUCHED,    ///< Waiting for the switch handler
+  PROBE_DISPATCHED, ///< Waiting for a refresh to start
+  PROBE_RENDERING,  ///< Waiting for its flush to finish
+} probe_stage_t;
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+#if CONFIG_TOUCH_LATENCY_PROBE
+static const char *const latency_names[LATENCY_COUNT] = {"invalidate_us", "dispatch_us", "photon_us"};
+
+static portMUX_TYPE probe_lock = portMUX_INITIALIZER_UNLOCKED;
+static probe_stage_t probe_stage = PROBE_IDLE;
+static int64_t probe_touch_us = 0;
+static int64_t probe_invalidate_us = 0;
+static int64_t probe_dispatch_us = 0;
+
+// Ring of completed presses, guarded by probe_lock
+static uint32_t samples[LATENCY_COUNT][TOUCH_LATENCY_SAMPLES];
+static uint32_t sample_next = 0;
+static uint32_t sample_count = 0;
+static uint32_t presses_undispatched = 0; ///< Presses that landed outside a switch
+
+// Tap to command, from the touch of the last dispatched press
+static int64_t command_touch_us = 0; ///< 0 while no command is outstanding
+static uint32_t command_samples[TOUCH_LATENCY_SAMPLES];
+static uint32_t command_next = 0;
+static uint32_t command_count = 0;
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_TOUCH_LATENCY_PROBE
+static bool within_window(int64_t now_us)
+{
+  return now_us - probe_touch_us <= (int64_t)TOUCH_LATENCY_MAX_MS * 1000;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of a sorted array
+ */
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t pct)
+{
+  uint32_t rank = (pct * count + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+#if CONFIG_TOUCH_LATENCY_PROBE
+void touch_latency_mark_touch(int64_t touch_us)
+{
+  portENTER_CRITICAL(&probe_lock);
+  if (probe_stage == PROBE_TOUCHED)
+  {
+    presses_undispatched++;
+  }
+  probe_stage = PROBE_TOUCHED;
+  probe_touch_us = touch_us;
+  probe_invalidate_us = 0;
+  probe_dispatch_us = 0;
+  portEXIT_CRITICAL(&probe_lock);
+}
+
+void touch_latency_mark_invalidate(void)
+{
+  if (probe_stage != PROBE_TOUCHED || probe_invalidate_us != 0)
+    return;
+
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&probe_lock);
+  if (probe_stage == PROBE_TOUCHED && probe_invalidate_us == 0 && within_window(now_us))
+  {
+    probe_invalidate_us = now_us;
+  }
+  portEXIT_CRITICAL(&probe_lock);
+}
+
+void touch_latency_mark_dispatch(void)
+{
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&probe_lock);
+  if (probe_stage == PROBE_TOUCHED && within_window(now_us))
+  {
+    probe_dispatch_us = now_us;
+    command_touch_us = probe_touch_us;
+    if (probe_invalidate_us == 0)
+    {
+      probe_invalidate_us = now_us;
+    }
+    probe_stage = PROBE_DISPATCHED;
+  }
+  portEXIT_CRITICAL(&probe_lock);
+}
+
+void touch_latency_mark_refresh_start(void)
+{
+  if (probe_stage != PROBE_DISPATCHED)
+    return;
+
+  portENTER_CRITICAL(&probe_lock);
+  if (probe_stage == PROBE_DISPATCHED)
+  {
+    probe_stage = PROBE_RENDERING;
+  }
+  portEXIT_CRITICAL(&probe_lock);
+}
+
+void IRAM_ATTR touch_latency_mark_flush_done(void)
+{
+  if (probe_stage != PROBE_RENDERING)
+    return;
+
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL_SAFE(&probe_lock);
+  if (probe_stage == PROBE_RENDERING)
+  {
+    samples[LATENCY_INVALIDATE][sample_next] = (uint32_t)(probe_invalidate_us - probe_touch_us);
+    samples[LATENCY_DISPATCH][sample_next] = (uint32_t)(probe_dispatch_us - probe_touch_us);
+    samples[LATENCY_PHOTON][sample_next] = (uint32_t)(now_us - probe_touch_us);
+    sample_next = (sample_next + 1) % TOUCH_LATENCY_SAMPLES;
+    if (sample_count < TOUCH_LATENCY_SAMPLES)
+    {
+      sample_count++;
+    }
+    probe_stage = PROBE_IDLE;
+  }
+  portEXIT_CRITICAL_SAFE(&probe_lock);
+}
+
+void touch_latency_mark_command_done(void)
+{
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&probe_lock);
+  if (command_touch_us != 0 && now_us - command_touch_us <= (int64_t)TOUCH_LATENCY_COMMAND_MAX_MS * 1000)
+  {
+    command_samples[command_next] = (uint32_t)(now_us - command_touch_us);
+    command_next = (command_next + 1) % TOUCH_LATENCY_SAMPLES;
+    if (command_count < TOUCH_LATENCY_SAMPLES)
+    {
+      command_count++;
+    }
+  }
+  command_touch_us = 0;
+  portEXIT_CRITICAL(&probe_lock);
+}
+#endif
+
+bool touch_latency_handle_command(const char *line)
+{
+  if (strcmp(line, "RESET_TOUCH_LATENCY") == 0)
+  {
+#if CONFIG_TOUCH_LATENCY_PROBE
+    portENTER_CRITICAL(&probe_lock);
+    probe_stage = PROBE_IDLE;
+    sample_next = 0;
+    sample_count = 0;
+    presses_undispatched = 0;
+    command_touch_us = 0;
+    command_next = 0;
+    command_count = 0;
+    portEXIT_CRITICAL(&probe_lock);
+#endif
+    static const char ok[] = "TOUCH_LATENCY OK\n";
+    serial_data_write(ok, sizeof(ok) - 1);
+    return true;
+  }
+
+  if (strcmp(line, "GET_TOUCH_LATENCY") != 0)
+    return false;
+
+#if CONFIG_TOUCH_LATENCY_PROBE
+  // Sorted copies, the ring keeps filling while we format
+  uint32_t *sorted = malloc(sizeof(samples) + sizeof(command_samples));
+  if (!sorted)
+  {
+    static const char error[] = "TOUCH_LATENCY {\"error\":\"no memory\"}\n";
+    serial_data_write(error, sizeof(error) - 1);
+    return true;
+  }
+
+  portENTER_CRITICAL(&probe_lock);
+  uint32_t count = sample_count;
+  uint32_t undispatched = presses_undispatched;
+  uint32_t commands = command_count;
+  memcpy(sorted, samples, sizeof(samples));
+  memcpy(sorted + LATENCY_COUNT * TOUCH_LATENCY_SAMPLES, command_samples, sizeof(command_samples));
+  portEXIT_CRITICAL(&probe_lock);
+
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf), "TOUCH_LATENCY {\"n\":%lu,\"undispatched\":%lu,\"budget_p95_us\":%lu",
+                     (unsigned long)count, (unsigned long)undispatched, (unsigned long)TOUCH_LATENCY_BUDGET_MS * 1000);
+  serial_data_write(buf, len);
+
+  bool over_budget = false;
+  for (int i = 0; i < LATENCY_COUNT; i++)
+  {
+    uint32_t *values = sorted + i * TOUCH_LATENCY_SAMPLES;
+    if (count == 0)
+    {
+      len = snprintf(buf, sizeof(buf), ",\"%s\":null", latency_names[i]);
+      serial_data_write(buf, len);
+      continue;
+    }
+
+    qsort(values, count, sizeof(uint32_t), compare_u32);
+    uint32_t p95 = percentile(values, count, 95);
+    if (i == LATENCY_PHOTON)
+    {
+      over_budget = p95 > (uint32_t)TOUCH_LATENCY_BUDGET_MS * 1000;
+    }
+    len = snprintf(buf, sizeof(buf), ",\"%s\":{\"p50\":%lu,\"p90\":%lu,\"p95\":%lu,\"p99\":%lu,\"max\":%lu}",
+                   latency_names[i], (unsigned long)percentile(values, count, 50),
+                   (unsigned long)percentile(values, count, 90), (unsigned long)p95,
+                   (unsigned long)percentile(values, count, 99), (unsigned long)values[count - 1]);
+    serial_data_write(buf, len);
+  }
+
+  // Tap to command, the press's touch until Home Assistant accepted the switch
+  uint32_t *values = sorted + LATENCY_COUNT * TOUCH_LATENCY_SAMPLES;
+  if (commands == 0)
+  {
+    len = snprintf(buf, sizeof(buf), ",\"commands\":0,\"command_us\":null");
+  }
+  else
+  {
+    qsort(values, commands, sizeof(uint32_t), compare_u32);
+    len = snprintf(buf, sizeof(buf),
+                   ",\"commands\":%lu,\"command_us\":{\"p50\":%lu,\"p90\":%lu,\"p95\":%lu,\"p99\":%lu,\"max\":%lu}",
+                   (unsigned long)commands, (unsigned long)percentile(values, commands, 50),
+                   (unsigned long)percentile(values, commands, 90), (unsigned long)percentile(values, commands, 95),
+                   (unsigned long)percentile(values, commands, 99), (unsigned long)values[commands - 1]);
+  }
+  serial_data_write(buf, len);
+  free(sorted);
+
+  len = snprintf(buf, sizeof(buf), ",\"over_budget\":%s}\n", over_budget ? "true" : "false");
+  serial_data_write(buf, len);
+#else
+  static const char disabled[] = "TOUCH_LATENCY {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file touch_latency.h
+ * @brief Touch-to-photon latency probe
+ *
+ * Timestamps one touch at a time through the pipeline: the GT911 INT edge
+ * (or the first read of a press when polling), the first invalidation after
+ * it, the switch handler in the controls panel, and the completion of the
+ * first flush of a frame started after both. The intervals from the touch
+ * are kept for the last TOUCH_LATENCY_SAMPLES presses and reported as
+ * percentiles with GET_TOUCH_LATENCY. Presses that reach the switch handler
+ * are also followed to Home Assistant accepting the command, which takes
+ * far longer than a frame and is kept in a ring of its own.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef TOUCH_LATENCY_H
+#define TOUCH_LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Presses kept for the percentiles */
+#define TOUCH_LATENCY_SAMPLES 128
+
+  /** A stage this long after the touch belongs to something else */
+#define TOUCH_LATENCY_MAX_MS 1000
+
+  /** A command accepted later than this is not counted as tap to command */
+#define TOUCH_LATENCY_COMMAND_MAX_MS 10000
+
+  /** p95 budget of touch to photon, reported as over_budget */
+#ifdef CONFIG_TOUCH_LATENCY_BUDGET_MS
+#define TOUCH_LATENCY_BUDGET_MS CONFIG_TOUCH_LATENCY_BUDGET_MS
+#else
+#define TOUCH_LATENCY_BUDGET_MS 50
+#endif
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+#if CONFIG_TOUCH_LATENCY_PROBE
+  /**
+   * @brief A finger landed, starts a new measurement
+   * @param touch_us esp_timer time of the INT edge or of the read that saw the press
+   */
+  void touch_latency_mark_touch(int64_t touch_us);
+
+  /**
+   * @brief LVGL invalidated an area, the first one after the touch counts
+   */
+  void touch_latency_mark_invalidate(void);
+
+  /**
+   * @brief The UI acted on the touch
+   */
+  void touch_latency_mark_dispatch(void);
+
+  /**
+   * @brief LVGL started a refresh
+   */
+  void touch_latency_mark_refresh_start(void);
+
+  /**
+   * @brief A flush reached the panel, completes the measurement
+   * @note Safe from ISR context
+   */
+  void touch_latency_mark_flush_done(void);
+
+  /**
+   * @brief Home Assistant accepted the command of the last dispatched press
+   */
+  void touch_latency_mark_command_done(void);
+#else
+  static inline void touch_latency_mark_touch(int64_t touch_us) { (void)touch_us; }
+  static inline void touch_latency_mark_invalidate(void) {}
+  static inline void touch_latency_mark_dispatch(void) {}
+  static inline void touch_latency_mark_refresh_start(void) {}
+  static inline void touch_latency_mark_flush_done(void) {}
+  static inline void touch_latency_mark_command_done(void) {}
+#endif
+
+  /**
+   * @brief Handle GET_TOUCH_LATENCY / RESET_TOUCH_LATENCY
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a latency command
+   */
+  bool touch_latency_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOUCH_LATENCY_H
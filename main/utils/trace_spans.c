@@ -0,0 +1,243 @@
+/**
+ * @file trace_spans.c
+ * @brief Cross-task timing spans, exported as Chrome/Perfetto JSON
+ *
+ * A slot is claimed with one atomic add on the record counter, so tasks on
+ * both cores record without a lock. The buffer is only allocated by the
+ * first SPANS_START and is kept afterwards.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "trace_spans.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+typedef struct
+{
+  uint32_t time_us;  ///< Since SPANS_START
+  const char *name;
+  int32_t value;
+  uint32_t task;     ///< Task handle, low two bits hold the phase
+} span_record_t;
+
+#if CONFIG_TRACE_SPANS
+volatile bool trace_spans_recording = false;
+
+static span_record_t *records = NULL;
+static uint32_t record_next = 0; ///< Claims, atomic; above TRACE_SPANS_EVENTS without ring mode means dropped
+static bool ring_mode = false;
+static int64_t start_us = 0;
+
+static const char *const phase_names[] = {"B", "E", "i", "C"};
+#endif
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_TRACE_SPANS
+
+void IRAM_ATTR trace_spans_record(trace_span_phase_t phase, const char *name, int32_t value)
+{
+  uint32_t now = (uint32_t)(esp_timer_get_time() - start_us);
+  uint32_t index = __atomic_fetch_add(&record_next, 1, __ATOMIC_RELAXED);
+  if (index >= TRACE_SPANS_EVENTS)
+  {
+    if (!ring_mode)
+    {
+      trace_spans_recording = false;
+      return;
+    }
+    index %= TRACE_SPANS_EVENTS;
+  }
+
+  span_record_t *record = &records[index];
+  record->time_us = now;
+  record->name = name;
+  record->value = value;
+  record->task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle() | (uint32_t)phase;
+}
+
+static void reply_status(void)
+{
+  uint32_t claimed = __atomic_load_n(&record_next, __ATOMIC_RELAXED);
+  uint32_t kept = (claimed < TRACE_SPANS_EVENTS) ? claimed : TRACE_SPANS_EVENTS;
+  char buf[160];
+  int len = snprintf(buf, sizeof(buf),
+                     "SPANS_STATUS {\"recording\":%s,\"ring\":%s,\"events\":%lu,\"capacity\":%d,\"%s\":%lu}\n",
+                     trace_spans_recording ? "true" : "false", ring_mode ? "true" : "false", (unsigned long)kept,
+                     TRACE_SPANS_EVENTS, ring_mode ? "overwritten" : "dropped",
+                     (unsigned long)(claimed - kept));
+  serial_data_write(buf, len);
+}
+
+static void stop_recording(void)
+{
+  trace_spans_recording = false;
+  // Let a writer that read the flag just before finish its record
+  vTaskDelay(pdMS_TO_TICKS(2));
+}
+
+/**
+ * @brief Name a task handle for the export
+ * @note Only a live task is asked for its name, a deleted task keeps its handle
+ */
+static void task_label(uint32_t handle, const TaskStatus_t *tasks, UBaseType_t task_count, char *out, size_t size)
+{
+  for (UBaseType_t i = 0; i < task_count; i++)
+  {
+    if ((uint32_t)(uintptr_t)tasks[i].xHandle == handle)
+    {
+      snprintf(out, size, "%s", tasks[i].pcTaskName);
+      return;
+    }
+  }
+  snprintf(out, size, "task_%08lx", (unsigned long)handle);
+}
+
+static void export_capture(void)
+{
+  stop_recording();
+
+  uint32_t claimed = __atomic_load_n(&record_next, __ATOMIC_RELAXED);
+  uint32_t count = (claimed < TRACE_SPANS_EVENTS) ? claimed : TRACE_SPANS_EVENTS;
+  uint32_t first = (ring_mode && claimed > TRACE_SPANS_EVENTS) ? claimed % TRACE_SPANS_EVENTS : 0;
+
+  // Task names once up front, as thread_name metadata
+  static uint32_t handles[TRACE_SPANS_MAX_TASKS];
+  int handle_count = 0;
+  for (uint32_t i = 0; i < count && handle_count < TRACE_SPANS_MAX_TASKS; i++)
+  {
+    uint32_t handle = records[i].task & ~3UL;
+    bool known = false;
+    for (int h = 0; h < handle_count && !known; h++)
+      known = handles[h] == handle;
+    if (!known)
+      handles[handle_count++] = handle;
+  }
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+  UBaseType_t task_count = uxTaskGetNumberOfTasks() + 4;
+  TaskStatus_t *tasks = heap_caps_malloc(task_count * sizeof(TaskStatus_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  task_count = tasks ? uxTaskGetSystemState(tasks, task_count, NULL) : 0;
+#else
+  TaskStatus_t *tasks = NULL;
+  UBaseType_t task_count = 0;
+#endif
+
+  char buf[192];
+  static const char header[] = "SPANS {\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  serial_data_write(header, sizeof(header) - 1);
+
+  bool first_event = true;
+  for (int h = 0; h < handle_count; h++)
+  {
+    char label[configMAX_TASK_NAME_LEN + 16];
+    task_label(handles[h], tasks, task_count, label, sizeof(label));
+    int len = snprintf(buf, sizeof(buf),
+                       "SPANS %s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}\n",
+                       first_event ? "" : ",", (unsigned long)handles[h], label);
+    serial_data_write(buf, len);
+    first_event = false;
+  }
+  heap_caps_free(tasks);
+
+  for (uint32_t n = 0; n < count; n++)
+  {
+    const span_record_t *record = &records[(first + n) % TRACE_SPANS_EVENTS];
+    trace_span_phase_t phase = (trace_span_phase_t)(record->task & 3);
+    unsigned long tid = record->task & ~3UL;
+    int len;
+    if (phase == TRACE_SPAN_PH_COUNTER)
+    {
+      len = snprintf(buf, sizeof(buf),
+                     "SPANS %s{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%lu,\"pid\":1,\"tid\":%lu,\"args\":{\"value\":%ld}}\n",
+                     first_event ? "" : ",", record->name, (unsigned long)record->time_us, tid, (long)record->value);
+    }
+    else
+    {
+      len = snprintf(buf, sizeof(buf), "SPANS %s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%lu,\"pid\":1,\"tid\":%lu%s}\n",
+                     first_event ? "" : ",", record->name, phase_names[phase], (unsigned long)record->time_us, tid,
+                     phase == TRACE_SPAN_PH_INSTANT ? ",\"s\":\"t\"" : "");
+    }
+    serial_data_write(buf, len);
+    first_event = false;
+  }
+
+  static const char footer[] = "SPANS ]}\n";
+  serial_data_write(footer, sizeof(footer) - 1);
+}
+
+#endif
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+bool trace_spans_handle_command(const char *line)
+{
+  if (strncmp(line, "SPANS_", 6) != 0)
+  {
+    return false;
+  }
+  const char *command = line + 6;
+  bool is_start = strcmp(command, "START") == 0 || strcmp(command, "START RING") == 0;
+  if (!is_start && strcmp(command, "STOP") != 0 && strcmp(command, "STATUS") != 0 && strcmp(command, "EXPORT") != 0)
+  {
+    return false;
+  }
+
+#if CONFIG_TRACE_SPANS
+  if (is_start)
+  {
+    stop_recording();
+    if (!records)
+    {
+      records = heap_caps_malloc(TRACE_SPANS_EVENTS * sizeof(span_record_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (!records)
+    {
+      static const char no_mem[] = "SPANS_STATUS {\"error\":\"no memory\"}\n";
+      serial_data_write(no_mem, sizeof(no_mem) - 1);
+      return true;
+    }
+    ring_mode = strcmp(command, "START RING") == 0;
+    __atomic_store_n(&record_next, 0, __ATOMIC_RELAXED);
+    start_us = esp_timer_get_time();
+    trace_spans_recording = true;
+    debug_log_info_f(DEBUG_TAG_SYSTEM, "Span capture started, %d records%s", TRACE_SPANS_EVENTS,
+                     ring_mode ? ", ring" : "");
+  }
+  else if (strcmp(command, "STOP") == 0)
+  {
+    stop_recording();
+  }
+  else if (strcmp(command, "EXPORT") == 0)
+  {
+    if (records)
+    {
+      export_capture();
+      return true;
+    }
+  }
+  reply_status();
+#else
+  static const char disabled[] = "SPANS_STATUS {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
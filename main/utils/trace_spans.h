@@ -0,0 +1,101 @@
+/**
+ * @file trace_spans.h
+ * @brief Cross-task timing spans, exported as Chrome/Perfetto JSON
+ *
+ * Begin/end spans, instant events and counters from any task go into a
+ * PSRAM buffer as 16-byte records: a timestamp, a static name, a value and
+ * the calling task. Nothing is recorded until SPANS_START, and while idle
+ * each call site costs one load of trace_spans_recording. SPANS_EXPORT
+ * stops the capture and prints it as Chrome trace JSON, one "SPANS " line
+ * per event; span_capture.py strips the prefix into a file that
+ * ui.perfetto.dev or chrome://tracing open as a per-task timeline.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef TRACE_SPANS_H
+#define TRACE_SPANS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Records in the capture buffer, 16 bytes each in PSRAM */
+#ifdef CONFIG_TRACE_SPANS_EVENTS
+#define TRACE_SPANS_EVENTS CONFIG_TRACE_SPANS_EVENTS
+#else
+#define TRACE_SPANS_EVENTS 16384
+#endif
+
+  /** Distinct tasks named in an export, later ones keep their handle as name */
+#define TRACE_SPANS_MAX_TASKS 32
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Record kind, the Chrome trace "ph" of the exported event
+   */
+  typedef enum
+  {
+    TRACE_SPAN_PH_BEGIN = 0, ///< "B", nests per task
+    TRACE_SPAN_PH_END,       ///< "E", closes the innermost open span of the task
+    TRACE_SPAN_PH_INSTANT,   ///< "i"
+    TRACE_SPAN_PH_COUNTER,   ///< "C", value is the new counter value
+  } trace_span_phase_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+#if CONFIG_TRACE_SPANS
+  /** Read inline by the macros, set between SPANS_START and SPANS_STOP */
+  extern volatile bool trace_spans_recording;
+
+  /**
+   * @brief Store one record
+   * @param name Static string, only the pointer is kept
+   * @note Callable from any task, never blocks; use the macros below
+   */
+  void trace_spans_record(trace_span_phase_t phase, const char *name, int32_t value);
+
+#define TRACE_SPAN_RECORD(phase, name, value)                                       \
+  do                                                                                \
+  {                                                                                 \
+    if (trace_spans_recording)                                                      \
+      trace_spans_record((phase), (name), (int32_t)(value));                        \
+  } while (0)
+#else
+#define TRACE_SPAN_RECORD(phase, name, value) ((void)0)
+#endif
+
+#define TRACE_SPAN_BEGIN(name) TRACE_SPAN_RECORD(TRACE_SPAN_PH_BEGIN, (name), 0)
+#define TRACE_SPAN_END(name) TRACE_SPAN_RECORD(TRACE_SPAN_PH_END, (name), 0)
+#define TRACE_SPAN_INSTANT(name) TRACE_SPAN_RECORD(TRACE_SPAN_PH_INSTANT, (name), 0)
+#define TRACE_SPAN_COUNTER(name, value) TRACE_SPAN_RECORD(TRACE_SPAN_PH_COUNTER, (name), (value))
+
+  /**
+   * @brief Handle SPANS_START [RING], SPANS_STOP, SPANS_STATUS and SPANS_EXPORT
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a span trace command
+   * @note Without RING the capture stops once the buffer is full, with it the
+   *       oldest records are overwritten
+   */
+  bool trace_spans_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_SPANS_H
@@ -0,0 +1,566 @@
+/**
+ * @file ota_update.c
+ * @brief Firmware updates over WiFi into the inactive app slot
+ *
+ * One short-lived task per run: manifest, then a single streaming GET
+ * whose body goes through the SHA-256 check into esp_ota_write(), directly
+ * or through the delta patcher. The slot is erased sector by sector as it
+ * is written (OTA_WITH_SEQUENTIAL_WRITES), so the download starts at once
+ * and RAM use is one 4 KB receive buffer plus the patcher's window.
+ *
+ * A patch that fails to apply is not retried, the full image is fetched
+ * instead in the same run.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "ota_update.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "esp_app_desc.h"
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "mbedtls/sha256.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "utils/delta_patch.h"
+#include "utils/task_plan.h"
+#include "wifi_manager.h"
+
+#if CONFIG_OTA_UPDATE
+
+#define OTA_READ_CHUNK 4096
+#define OTA_REBOOT_DELAY_MS 2000 // Lets the last GET_OTA reply and log lines out
+
+// =======================================================================
+// PRIVATE TYPES AND VARIABLES
+// =======================================================================
+
+/** Download offered by the manifest */
+typedef struct
+{
+  char url[OTA_UPDATE_URL_MAX_LEN];
+  uint32_t size;
+  uint8_t sha256[32];
+} ota_download_t;
+
+typedef struct
+{
+  esp_ota_handle_t handle;
+  const esp_partition_t *running;
+  delta_patch_t *patch; ///< NULL for a full image
+} ota_sink_t;
+
+static portMUX_TYPE ota_lock = portMUX_INITIALIZER_UNLOCKED;
+static ota_update_status_t status;
+static bool running = false;
+static char manifest_url[OTA_UPDATE_URL_MAX_LEN];
+static TimerHandle_t check_timer = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void set_state(ota_update_state_t state)
+{
+  portENTER_CRITICAL(&ota_lock);
+  status.state = state;
+  portEXIT_CRITICAL(&ota_lock);
+}
+
+static void fail(esp_err_t err, const char *message)
+{
+  portENTER_CRITICAL(&ota_lock);
+  status.state = OTA_STATE_FAILED;
+  status.error = err;
+  strlcpy(status.message, message, sizeof(status.message));
+  portEXIT_CRITICAL(&ota_lock);
+  debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "OTA update failed, %s: %s", message, esp_err_to_name(err));
+}
+
+static bool parse_sha256(const char *hex, uint8_t out[32])
+{
+  if (!hex || strlen(hex) != 64)
+    return false;
+  for (int i = 0; i < 32; i++)
+  {
+    unsigned int byte;
+    if (sscanf(hex + i * 2, "%2x", &byte) != 1)
+      return false;
+    out[i] = (uint8_t)byte;
+  }
+  return true;
+}
+
+/**
+ * @brief Manifest URLs may be relative to the manifest
+ */
+static bool resolve_url(const char *base, const char *url, char *out, size_t out_size)
+{
+  if (strstr(url, "://"))
+    return (size_t)snprintf(out, out_size, "%s", url) < out_size;
+  const char *slash = strrchr(base, '/');
+  int dir_len = slash ? (int)(slash - base + 1) : 0;
+  return (size_t)snprintf(out, out_size, "%.*s%s", dir_len, base, url) < out_size;
+}
+
+static bool parse_download(const cJSON *item, const char *base, ota_download_t *out)
+{
+  const cJSON *url = cJSON_GetObjectItem(item, "url");
+  const cJSON *size = cJSON_GetObjectItem(item, "size");
+  const cJSON *sha = cJSON_GetObjectItem(item, "sha256");
+  if (!cJSON_IsString(url) || !cJSON_IsNumber(size) || size->valuedouble < 1 || size->valuedouble > UINT32_MAX)
+    return false;
+  out->size = (uint32_t)size->valuedouble;
+  return resolve_url(base, url->valuestring, out->url, sizeof(out->url)) &&
+         parse_sha256(cJSON_GetStringValue(sha), out->sha256);
+}
+
+static esp_http_client_handle_t open_url(const char *url, int64_t *content_length)
+{
+  esp_http_client_config_t config = {
+      .url = url,
+      .timeout_ms = OTA_UPDATE_HTTP_TIMEOUT_MS,
+      .buffer_size = OTA_READ_CHUNK,
+      .keep_alive_enable = false,
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+      .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
+  };
+  esp_http_client_handle_t client = esp_http_client_init(&config);
+  if (!client)
+    return NULL;
+  if (esp_http_client_open(client, 0) != ESP_OK)
+  {
+    esp_http_client_cleanup(client);
+    return NULL;
+  }
+  *content_length = esp_http_client_fetch_headers(client);
+  int code = esp_http_client_get_status_code(client);
+  if (code != 200)
+  {
+    debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "OTA: HTTP %d for %s", code, url);
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return NULL;
+  }
+  return client;
+}
+
+static void close_url(esp_http_client_handle_t client)
+{
+  esp_http_client_close(client);
+  esp_http_client_cleanup(client);
+}
+
+static cJSON *fetch_manifest(const char *url)
+{
+  int64_t length;
+  esp_http_client_handle_t client = open_url(url, &length);
+  if (!client)
+    return NULL;
+
+  char *buf = malloc(OTA_UPDATE_MANIFEST_MAX_LEN);
+  int total = 0;
+  while (buf && total < OTA_UPDATE_MANIFEST_MAX_LEN)
+  {
+    int n = esp_http_client_read(client, buf + total, OTA_UPDATE_MANIFEST_MAX_LEN - total);
+    if (n <= 0)
+      break;
+    total += n;
+  }
+  bool complete = buf && esp_http_client_is_complete_data_received(client);
+  close_url(client);
+
+  cJSON *manifest = complete ? cJSON_ParseWithLength(buf, total) : NULL;
+  free(buf);
+  return manifest;
+}
+
+static esp_err_t read_running(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+  const ota_sink_t *sink = ctx;
+  return esp_partition_read(sink->running, offset, buf, len);
+}
+
+static esp_err_t write_slot(void *ctx, const void *buf, size_t len)
+{
+  const ota_sink_t *sink = ctx;
+  esp_err_t err = esp_ota_write(sink->handle, buf, len);
+  if (err == ESP_OK)
+  {
+    portENTER_CRITICAL(&ota_lock);
+    status.written += len;
+    portEXIT_CRITICAL(&ota_lock);
+  }
+  return err;
+}
+
+/**
+ * @brief Stream one download through the hash check into the slot
+ */
+static esp_err_t download(const ota_download_t *dl, ota_sink_t *sink)
+{
+  int64_t length;
+  esp_http_client_handle_t client = open_url(dl->url, &length);
+  if (!client)
+    return ESP_ERR_HTTP_CONNECT;
+  if (length >= 0 && length != dl->size)
+  {
+    close_url(client);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  uint8_t *buf = malloc(OTA_READ_CHUNK);
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+
+  esp_err_t err = buf ? ESP_OK : ESP_ERR_NO_MEM;
+  uint32_t received = 0;
+  int next_log_pct = 10;
+  while (err == ESP_OK && received < dl->size)
+  {
+    int n = esp_http_client_read(client, (char *)buf, OTA_READ_CHUNK);
+    if (n <= 0 || received + n > dl->size)
+    {
+      err = n < 0 ? ESP_FAIL : ESP_ERR_INVALID_SIZE; // Connection lost, or more or less than announced
+      break;
+    }
+    mbedtls_sha256_update(&sha, buf, n);
+    err = sink->patch ? delta_patch_feed(sink->patch, buf, n) : write_slot(sink, buf, n);
+    received += n;
+
+    portENTER_CRITICAL(&ota_lock);
+    status.received = received;
+    portEXIT_CRITICAL(&ota_lock);
+    int pct = (int)((uint64_t)received * 100 / dl->size);
+    if (pct >= next_log_pct)
+    {
+      debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "OTA: %d%% of %lu bytes", pct, (unsigned long)dl->size);
+      next_log_pct = pct / 10 * 10 + 10;
+    }
+  }
+  close_url(client);
+  free(buf);
+
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+  if (err == ESP_OK && memcmp(digest, dl->sha256, sizeof(digest)) != 0)
+    err = ESP_ERR_INVALID_CRC;
+  return err;
+}
+
+/**
+ * @brief Write one download into the inactive slot and make it the boot slot
+ */
+static esp_err_t install(const ota_download_t *dl, bool delta, const uint8_t running_hash[32], const char **step)
+{
+  ota_sink_t sink = {.running = esp_ota_get_running_partition()};
+  const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+  if (!target)
+  {
+    *step = "no update slot";
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  portENTER_CRITICAL(&ota_lock);
+  status.state = OTA_STATE_DOWNLOADING;
+  status.delta = delta;
+  status.total = dl->size;
+  status.received = 0;
+  status.written = 0;
+  portEXIT_CRITICAL(&ota_lock);
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "OTA: %s of %lu bytes into %s", delta ? "patch" : "image",
+                   (unsigned long)dl->size, target->label);
+
+  *step = "slot";
+  esp_err_t err = esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &sink.handle);
+  if (err != ESP_OK)
+    return err;
+  if (delta)
+  {
+    sink.patch = delta_patch_begin(running_hash, sink.running->size, read_running, write_slot, &sink);
+    if (!sink.patch)
+    {
+      esp_ota_abort(sink.handle);
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  *step = "download";
+  err = download(dl, &sink);
+  if (err == ESP_OK && sink.patch)
+  {
+    *step = "patch";
+    err = delta_patch_finish(sink.patch, NULL);
+  }
+  delta_patch_free(sink.patch);
+  if (err != ESP_OK)
+  {
+    esp_ota_abort(sink.handle);
+    return err;
+  }
+
+  *step = "image check";
+  err = esp_ota_end(sink.handle);
+  if (err == ESP_OK)
+  {
+    *step = "boot slot";
+    err = esp_ota_set_boot_partition(target);
+  }
+  return err;
+}
+
+static void run_update(const char *url)
+{
+  cJSON *manifest = fetch_manifest(url);
+  if (!manifest)
+  {
+    fail(ESP_ERR_INVALID_RESPONSE, "manifest");
+    return;
+  }
+
+  ota_download_t image;
+  uint8_t offered_hash[32];
+  const char *version = cJSON_GetStringValue(cJSON_GetObjectItem(manifest, "version"));
+  if (!version || !parse_sha256(cJSON_GetStringValue(cJSON_GetObjectItem(manifest, "image")), offered_hash) ||
+      !parse_download(manifest, url, &image))
+  {
+    cJSON_Delete(manifest);
+    fail(ESP_ERR_INVALID_RESPONSE, "manifest fields");
+    return;
+  }
+  portENTER_CRITICAL(&ota_lock);
+  strlcpy(status.version, version, sizeof(status.version));
+  portEXIT_CRITICAL(&ota_lock);
+
+  uint8_t running_hash[32];
+  esp_err_t err = esp_partition_get_sha256(esp_ota_get_running_partition(), running_hash);
+  if (err != ESP_OK)
+  {
+    cJSON_Delete(manifest);
+    fail(err, "running image hash");
+    return;
+  }
+  if (memcmp(running_hash, offered_hash, sizeof(running_hash)) == 0)
+  {
+    cJSON_Delete(manifest);
+    set_state(OTA_STATE_UP_TO_DATE);
+    debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "OTA: %s is running already", version);
+    return;
+  }
+
+  // A patch against exactly the running image, if the release has one
+  ota_download_t patch;
+  bool have_patch = false;
+#if CONFIG_OTA_UPDATE_DELTA
+  const cJSON *delta;
+  cJSON_ArrayForEach(delta, cJSON_GetObjectItem(manifest, "deltas"))
+  {
+    uint8_t from[32];
+    if (parse_sha256(cJSON_GetStringValue(cJSON_GetObjectItem(delta, "from")), from) &&
+        memcmp(from, running_hash, sizeof(from)) == 0 && parse_download(delta, url, &patch))
+    {
+      have_patch = true;
+      break;
+    }
+  }
+#endif
+  cJSON_Delete(manifest);
+
+  const char *step = "";
+  err = ESP_FAIL;
+  if (have_patch)
+  {
+    err = install(&patch, true, running_hash, &step);
+    if (err != ESP_OK)
+    {
+      debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "OTA: patch failed at %s (%s), fetching the full image", step,
+                          esp_err_to_name(err));
+    }
+  }
+  if (err != ESP_OK)
+    err = install(&image, false, running_hash, &step);
+  if (err != ESP_OK)
+  {
+    fail(err, step);
+    return;
+  }
+
+  set_state(OTA_STATE_DONE);
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "OTA: %s installed", version);
+}
+
+static void ota_task(void *arg)
+{
+  (void)arg;
+  int64_t start_us = esp_timer_get_time();
+  run_update(manifest_url);
+
+  portENTER_CRITICAL(&ota_lock);
+  status.elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+  bool done = status.state == OTA_STATE_DONE;
+  running = false;
+  portEXIT_CRITICAL(&ota_lock);
+
+#if CONFIG_OTA_UPDATE_AUTO_REBOOT
+  if (done)
+  {
+    debug_log_info(DEBUG_TAG_WIFI_MANAGER, "OTA: restarting into the new image");
+    vTaskDelay(pdMS_TO_TICKS(OTA_REBOOT_DELAY_MS));
+    esp_restart();
+  }
+#else
+  (void)done;
+#endif
+  vTaskDelete(NULL);
+}
+
+static void check_timer_callback(TimerHandle_t timer)
+{
+  (void)timer;
+  // Runs on the timer task, the run itself gets its own task
+  if (wifi_manager_wait_for_ip(0))
+    ota_update_start(NULL);
+}
+
+static const char *state_name(ota_update_state_t state)
+{
+  static const char *const names[] = {"idle", "checking", "downloading", "up_to_date", "done", "failed"};
+  return state < sizeof(names) / sizeof(names[0]) ? names[state] : "unknown";
+}
+
+#endif // CONFIG_OTA_UPDATE
+
+// =======================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =======================================================================
+
+esp_err_t ota_update_init(void)
+{
+#if CONFIG_OTA_UPDATE
+  // Boot got this far, so the bootloader must not roll this image back
+  esp_ota_img_states_t state;
+  if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK &&
+      state == ESP_OTA_IMG_PENDING_VERIFY)
+  {
+    esp_ota_mark_app_valid_cancel_rollback();
+    debug_log_info(DEBUG_TAG_WIFI_MANAGER, "OTA: new image confirmed");
+  }
+
+#if CONFIG_OTA_UPDATE_CHECK_INTERVAL_MIN > 0
+  check_timer = xTimerCreate("ota_check", pdMS_TO_TICKS(CONFIG_OTA_UPDATE_CHECK_INTERVAL_MIN * 60000), pdTRUE, NULL,
+                             check_timer_callback);
+  if (!check_timer || xTimerStart(check_timer, 0) != pdPASS)
+    return ESP_ERR_NO_MEM;
+#else
+  (void)check_timer;
+  (void)check_timer_callback;
+#endif
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t ota_update_start(const char *url)
+{
+#if CONFIG_OTA_UPDATE
+  if (!url)
+    url = CONFIG_OTA_UPDATE_URL;
+  if (url[0] == '\0' || strlen(url) >= sizeof(manifest_url))
+    return ESP_ERR_INVALID_ARG;
+
+  portENTER_CRITICAL(&ota_lock);
+  bool busy = running;
+  running = true;
+  portEXIT_CRITICAL(&ota_lock);
+  if (busy)
+    return ESP_ERR_INVALID_STATE;
+
+  strlcpy(manifest_url, url, sizeof(manifest_url));
+  portENTER_CRITICAL(&ota_lock);
+  memset(&status, 0, sizeof(status));
+  status.state = OTA_STATE_CHECKING;
+  portEXIT_CRITICAL(&ota_lock);
+
+  if (task_plan_create(TASK_PLAN_OTA, ota_task, NULL, NULL) != pdPASS)
+  {
+    running = false;
+    set_state(OTA_STATE_IDLE);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+#else
+  (void)url;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void ota_update_get_status(ota_update_status_t *out)
+{
+  if (!out)
+    return;
+#if CONFIG_OTA_UPDATE
+  portENTER_CRITICAL(&ota_lock);
+  *out = status;
+  portEXIT_CRITICAL(&ota_lock);
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
+
+bool ota_update_handle_command(const char *line)
+{
+  bool start = strncmp(line, "OTA_UPDATE", 10) == 0 && (line[10] == '\0' || line[10] == ' ');
+  if (!start && strcmp(line, "GET_OTA") != 0)
+    return false;
+
+#if CONFIG_OTA_UPDATE
+  char buf[320];
+  int len;
+  if (start)
+  {
+    const char *url = line[10] == ' ' ? line + 11 : NULL;
+    esp_err_t ret = ota_update_start(url);
+    if (ret == ESP_OK)
+      len = snprintf(buf, sizeof(buf), "OTA {\"started\":true}\n");
+    else
+      len = snprintf(buf, sizeof(buf), "OTA {\"error\":\"%s\"}\n",
+                     ret == ESP_ERR_INVALID_STATE ? "busy" : (ret == ESP_ERR_INVALID_ARG ? "no url" : esp_err_to_name(ret)));
+    serial_data_write(buf, len);
+    return true;
+  }
+
+  ota_update_status_t s;
+  ota_update_get_status(&s);
+  const esp_partition_t *next = esp_ota_get_next_update_partition(NULL);
+  len = snprintf(buf, sizeof(buf),
+                 "OTA {\"state\":\"%s\",\"running\":\"%s\",\"slot\":\"%s\",\"offered\":\"%s\",\"delta\":%s,"
+                 "\"received\":%lu,\"total\":%lu,\"written\":%lu,\"elapsed_ms\":%lu",
+                 state_name(s.state), esp_app_get_description()->version, next ? next->label : "", s.version,
+                 s.delta ? "true" : "false", (unsigned long)s.received, (unsigned long)s.total,
+                 (unsigned long)s.written, (unsigned long)s.elapsed_ms);
+  if (s.state == OTA_STATE_FAILED)
+    len += snprintf(buf + len, sizeof(buf) - len, ",\"error\":\"%s\",\"step\":\"%s\"", esp_err_to_name(s.error),
+                    s.message);
+  len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+  serial_data_write(buf, len);
+#else
+  static const char disabled[] = "OTA {\"error\":\"disabled\"}\n";
+  serial_data_write(disabled, sizeof(disabled) - 1);
+#endif
+  return true;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file ota_update.h
+ * @brief Firmware updates over WiFi into the inactive app slot
+ *
+ * Fetches a release manifest made by utils/ota_package.py, and if it
+ * offers another image than the running one, streams it into the other
+ * of app0/app1. When the manifest has a delta patch against the running
+ * image, only the patch is downloaded and the new image is rebuilt from
+ * the running one on the fly (utils/delta_patch.h), typically a tenth of
+ * the transfer or less. Every download is checked against the SHA-256 in
+ * the manifest as it streams, the rebuilt image against its own, and
+ * esp_ota_end() verifies the image before it is made the boot slot.
+ *
+ * Started with OTA_UPDATE [url] over the serial port or every
+ * CONFIG_OTA_UPDATE_CHECK_INTERVAL_MIN, progress with GET_OTA.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+#define OTA_UPDATE_URL_MAX_LEN 256
+#define OTA_UPDATE_MANIFEST_MAX_LEN 4096
+#define OTA_UPDATE_HTTP_TIMEOUT_MS 15000
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  typedef enum
+  {
+    OTA_STATE_IDLE,
+    OTA_STATE_CHECKING,    ///< Fetching the manifest
+    OTA_STATE_DOWNLOADING, ///< Writing the inactive slot
+    OTA_STATE_UP_TO_DATE,  ///< The manifest offers the running image
+    OTA_STATE_DONE,        ///< New image set as boot slot
+    OTA_STATE_FAILED,
+  } ota_update_state_t;
+
+  typedef struct
+  {
+    ota_update_state_t state;
+    bool delta;          ///< Downloading a patch rather than the image
+    uint32_t received;   ///< Bytes downloaded
+    uint32_t total;      ///< Bytes to download
+    uint32_t written;    ///< Image bytes written to the slot
+    uint32_t elapsed_ms; ///< Of the last or current run
+    char version[32];    ///< Version offered by the manifest
+    esp_err_t error;     ///< Of a failed run
+    char message[48];    ///< Step that failed
+  } ota_update_status_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Confirm the running image and start the periodic check
+   * @note Call once boot has completed; with rollback enabled in the
+   *       bootloader an image that never gets here is replaced by the
+   *       previous one on the next reset
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t ota_update_init(void);
+
+  /**
+   * @brief Check the manifest and update in the background
+   * @param manifest_url NULL for CONFIG_OTA_UPDATE_URL
+   * @return ESP_OK when started, ESP_ERR_INVALID_STATE while a run is in progress,
+   *         ESP_ERR_INVALID_ARG without a URL, ESP_ERR_NOT_SUPPORTED if disabled
+   */
+  esp_err_t ota_update_start(const char *manifest_url);
+
+  /**
+   * @brief Snapshot of the current or last run
+   */
+  void ota_update_get_status(ota_update_status_t *status);
+
+  /**
+   * @brief Handle OTA_UPDATE [url] and GET_OTA
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was an OTA command
+   */
+  bool ota_update_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OTA_UPDATE_H
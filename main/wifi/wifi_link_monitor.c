@@ -0,0 +1,411 @@
+/**
+ * @file wifi_link_monitor.c
+ * @brief WiFi link-quality monitor with RSSI-based roaming
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "wifi_link_monitor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "serial/serial_data_handler.h"
+#include "system_debug_utils.h"
+#include "wifi_manager.h"
+#if CONFIG_ESP_WIFI_11KV_SUPPORT
+#include "esp_wnm.h"
+#endif
+
+// =======================================================================
+// PRIVATE CONSTANTS
+// =======================================================================
+
+#define ROAM_SCAN_MAX_APS 8
+
+// Samples after a connect before the average is trusted
+#define RSSI_SETTLE_SAMPLES 4
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Written by the event task and the esp_timer task
+static wifi_link_metrics_t link_metrics = {0};
+static portMUX_TYPE link_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int32_t rssi_avg_q4 = 0; // Smoothed RSSI, 1/16 dB
+static int32_t avg_history[WIFI_LINK_TREND_SAMPLES];
+static uint8_t beacon_loss_history[WIFI_LINK_TREND_SAMPLES];
+static uint8_t history_next = 0;
+static uint8_t history_count = 0;
+static uint8_t beacon_loss_pending = 0; // Timeouts since the last sample
+
+static esp_timer_handle_t sample_timer = NULL;
+static wifi_link_callback_t link_cb = NULL;
+
+// Roaming, only touched by the esp_timer task and then the event task once the scan is done
+static int64_t last_roam_us = 0;
+static volatile bool scan_pending = false;
+static wifi_ap_record_t scan_records[ROAM_SCAN_MAX_APS];
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+static void reset_history(void)
+{
+  memset(avg_history, 0, sizeof(avg_history));
+  memset(beacon_loss_history, 0, sizeof(beacon_loss_history));
+  history_next = 0;
+  history_count = 0;
+  beacon_loss_pending = 0;
+  link_metrics.beacon_loss_recent = 0;
+  link_metrics.rssi_trend = 0;
+  link_metrics.degraded = false;
+}
+
+/**
+ * @brief Ask the AP to steer us, or look for a stronger AP ourselves
+ * @note Runs in the esp_timer task
+ */
+static void try_roam(void)
+{
+#if CONFIG_WIFI_ROAMING
+  int64_t now_us = esp_timer_get_time();
+  if (scan_pending || (last_roam_us != 0 && now_us - last_roam_us < (int64_t)WIFI_ROAM_COOLDOWN_S * 1000000))
+  {
+    return;
+  }
+  last_roam_us = now_us;
+
+#if CONFIG_ESP_WIFI_11KV_SUPPORT
+  // The AP knows its neighbours and their load better than one scan does
+  if (esp_wnm_is_btm_supported_connection() && esp_wnm_send_bss_transition_mgmt_query(REASON_RSSI, NULL, 0) == 0)
+  {
+    portENTER_CRITICAL(&link_lock);
+    link_metrics.roam_requests++;
+    portEXIT_CRITICAL(&link_lock);
+    debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Link degraded, requested a BSS transition");
+    return;
+  }
+#endif
+
+  wifi_config_t config;
+  if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK)
+  {
+    return;
+  }
+
+  wifi_scan_config_t scan_config = {
+      .ssid = config.sta.ssid,
+      .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+  };
+  scan_pending = true;
+  if (esp_wifi_scan_start(&scan_config, false) != ESP_OK)
+  {
+    scan_pending = false;
+    return;
+  }
+
+  portENTER_CRITICAL(&link_lock);
+  link_metrics.roam_scans++;
+  portEXIT_CRITICAL(&link_lock);
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Link degraded, scanning for %s", (char *)config.sta.ssid);
+#endif
+}
+
+/**
+ * @brief Pick the strongest other AP of the network from the finished scan
+ * @note Runs in the event task
+ */
+static void evaluate_scan(void)
+{
+  uint16_t count = ROAM_SCAN_MAX_APS;
+  // Also frees the driver's copy of the list
+  if (esp_wifi_scan_get_ap_records(&count, scan_records) != ESP_OK)
+  {
+    esp_wifi_clear_ap_list();
+    return;
+  }
+
+  portENTER_CRITICAL(&link_lock);
+  int8_t current_rssi = link_metrics.rssi_avg;
+  uint8_t current_bssid[6];
+  memcpy(current_bssid, link_metrics.bssid, sizeof(current_bssid));
+  bool connected = link_metrics.connected;
+  portEXIT_CRITICAL(&link_lock);
+
+  const wifi_ap_record_t *best = NULL;
+  for (int i = 0; i < count; i++)
+  {
+    if (memcmp(scan_records[i].bssid, current_bssid, sizeof(current_bssid)) == 0)
+    {
+      continue;
+    }
+    if (!best || scan_records[i].rssi > best->rssi)
+    {
+      best = &scan_records[i];
+    }
+  }
+
+  if (!connected || !best || best->rssi < current_rssi + WIFI_ROAM_HYSTERESIS_DB)
+  {
+    debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "No better AP found (%d candidates, current %d dBm)", count,
+                     current_rssi);
+    return;
+  }
+
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Found AP at %d dBm against %d dBm", best->rssi, current_rssi);
+  esp_err_t ret = wifi_manager_roam(best->bssid, best->primary);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "Roam not started: %s", esp_err_to_name(ret));
+  }
+}
+
+static void sample_timer_cb(void *arg)
+{
+  int rssi = 0;
+  bool sampled = esp_wifi_sta_get_rssi(&rssi) == ESP_OK;
+
+  wifi_link_metrics_t snapshot;
+  portENTER_CRITICAL(&link_lock);
+  if (!link_metrics.connected || !sampled)
+  {
+    portEXIT_CRITICAL(&link_lock);
+    return;
+  }
+
+  if (history_count == 0)
+  {
+    rssi_avg_q4 = rssi * 16;
+  }
+  else
+  {
+    rssi_avg_q4 += (rssi * 16 - rssi_avg_q4) / 4;
+  }
+
+  // Once full, the slot about to be overwritten is the oldest
+  int32_t oldest_q4 = (history_count == WIFI_LINK_TREND_SAMPLES) ? avg_history[history_next] : avg_history[0];
+  if (history_count == 0)
+  {
+    oldest_q4 = rssi_avg_q4;
+  }
+  avg_history[history_next] = rssi_avg_q4;
+  beacon_loss_history[history_next] = beacon_loss_pending;
+  beacon_loss_pending = 0;
+  history_next = (history_next + 1) % WIFI_LINK_TREND_SAMPLES;
+  if (history_count < WIFI_LINK_TREND_SAMPLES)
+  {
+    history_count++;
+  }
+
+  uint32_t beacon_loss = 0;
+  for (int i = 0; i < WIFI_LINK_TREND_SAMPLES; i++)
+  {
+    beacon_loss += beacon_loss_history[i];
+  }
+
+  link_metrics.rssi = (int8_t)rssi;
+  link_metrics.rssi_avg = (int8_t)(rssi_avg_q4 / 16);
+  link_metrics.rssi_trend = (int8_t)((rssi_avg_q4 - oldest_q4) / 16);
+  link_metrics.beacon_loss_recent = (beacon_loss > UINT8_MAX) ? UINT8_MAX : (uint8_t)beacon_loss;
+  link_metrics.degraded = (history_count >= RSSI_SETTLE_SAMPLES && link_metrics.rssi_avg < WIFI_ROAM_RSSI_THRESHOLD) ||
+                          beacon_loss >= WIFI_LINK_BEACON_LOSS_LIMIT;
+  snapshot = link_metrics;
+  portEXIT_CRITICAL(&link_lock);
+
+  if (snapshot.degraded)
+  {
+    try_roam();
+  }
+
+  wifi_link_callback_t callback = link_cb;
+  if (callback)
+  {
+    callback(&snapshot);
+  }
+}
+
+static void link_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+  switch (event_id)
+  {
+  case WIFI_EVENT_STA_CONNECTED:
+  {
+    wifi_event_sta_connected_t *connected = (wifi_event_sta_connected_t *)event_data;
+    static const uint8_t no_bssid[6] = {0};
+
+    portENTER_CRITICAL(&link_lock);
+    if (memcmp(link_metrics.bssid, no_bssid, sizeof(no_bssid)) != 0 &&
+        memcmp(link_metrics.bssid, connected->bssid, sizeof(link_metrics.bssid)) != 0)
+    {
+      link_metrics.roams++;
+    }
+    memcpy(link_metrics.bssid, connected->bssid, sizeof(link_metrics.bssid));
+    link_metrics.channel = connected->channel;
+    link_metrics.connected = true;
+    reset_history();
+    portEXIT_CRITICAL(&link_lock);
+
+    // Sample only while associated, a dropped link costs no wakeups
+    esp_timer_stop(sample_timer);
+    esp_timer_start_periodic(sample_timer, (uint64_t)WIFI_LINK_SAMPLE_MS * 1000);
+    break;
+  }
+
+  case WIFI_EVENT_STA_DISCONNECTED:
+  {
+    wifi_link_metrics_t snapshot;
+    portENTER_CRITICAL(&link_lock);
+    link_metrics.connected = false;
+    link_metrics.disconnects++;
+    reset_history();
+    snapshot = link_metrics;
+    portEXIT_CRITICAL(&link_lock);
+    esp_timer_stop(sample_timer);
+
+    wifi_link_callback_t callback = link_cb;
+    if (callback)
+    {
+      callback(&snapshot);
+    }
+    break;
+  }
+
+  case WIFI_EVENT_STA_BEACON_TIMEOUT:
+    portENTER_CRITICAL(&link_lock);
+    link_metrics.beacon_timeouts++;
+    if (beacon_loss_pending < UINT8_MAX)
+    {
+      beacon_loss_pending++;
+    }
+    portEXIT_CRITICAL(&link_lock);
+    debug_log_warning(DEBUG_TAG_WIFI_MANAGER, "Beacon timeout");
+    break;
+
+  case WIFI_EVENT_SCAN_DONE:
+    if (scan_pending)
+    {
+      evaluate_scan();
+      scan_pending = false;
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t wifi_link_monitor_start(void)
+{
+#if CONFIG_WIFI_LINK_MONITOR
+  if (sample_timer)
+  {
+    return ESP_OK;
+  }
+
+  // The timer exists before the handler that starts and stops it
+  const esp_timer_create_args_t timer_args = {
+      .callback = sample_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "wifi_link",
+  };
+  esp_err_t ret = esp_timer_create(&timer_args, &sample_timer);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "Link monitor timer failed: %s", esp_err_to_name(ret));
+    sample_timer = NULL;
+    return ret;
+  }
+
+  ret = esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &link_event_handler, NULL);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "Link monitor event registration failed: %s", esp_err_to_name(ret));
+    esp_timer_delete(sample_timer);
+    sample_timer = NULL;
+    return ret;
+  }
+
+  // Already associated, the connect event was missed
+  wifi_ap_record_t ap;
+  if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
+  {
+    portENTER_CRITICAL(&link_lock);
+    memcpy(link_metrics.bssid, ap.bssid, sizeof(link_metrics.bssid));
+    link_metrics.channel = ap.primary;
+    link_metrics.connected = true;
+    portEXIT_CRITICAL(&link_lock);
+    ret = esp_timer_start_periodic(sample_timer, (uint64_t)WIFI_LINK_SAMPLE_MS * 1000);
+  }
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "Link monitor timer failed: %s", esp_err_to_name(ret));
+    esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &link_event_handler);
+    if (sample_timer)
+    {
+      esp_timer_delete(sample_timer);
+      sample_timer = NULL;
+    }
+    return ret;
+  }
+
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Link monitor started, roaming below %d dBm", WIFI_ROAM_RSSI_THRESHOLD);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t wifi_link_monitor_get_metrics(wifi_link_metrics_t *metrics)
+{
+  if (!metrics)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&link_lock);
+  *metrics = link_metrics;
+  portEXIT_CRITICAL(&link_lock);
+  return ESP_OK;
+}
+
+void wifi_link_monitor_register_callback(wifi_link_callback_t callback)
+{
+  link_cb = callback;
+}
+
+bool wifi_link_monitor_handle_command(const char *line)
+{
+  if (strcmp(line, "GET_WIFI_LINK") != 0)
+  {
+    return false;
+  }
+
+  wifi_link_metrics_t m;
+  wifi_link_monitor_get_metrics(&m);
+
+  char buf[384];
+  int len = snprintf(buf, sizeof(buf),
+                     "WIFI_LINK {\"connected\":%s,\"degraded\":%s,\"rssi\":%d,\"rssi_avg\":%d,\"rssi_trend\":%d,"
+                     "\"bssid\":\"%02x:%02x:%02x:%02x:%02x:%02x\",\"channel\":%u,\"beacon_loss_recent\":%u,"
+                     "\"beacon_timeouts\":%lu,\"disconnects\":%lu,\"roam_requests\":%lu,\"roam_scans\":%lu,"
+                     "\"roams\":%lu,\"threshold\":%d}\n",
+                     m.connected ? "true" : "false", m.degraded ? "true" : "false", m.rssi, m.rssi_avg, m.rssi_trend,
+                     m.bssid[0], m.bssid[1], m.bssid[2], m.bssid[3], m.bssid[4], m.bssid[5], m.channel,
+                     m.beacon_loss_recent, (unsigned long)m.beacon_timeouts, (unsigned long)m.disconnects,
+                     (unsigned long)m.roam_requests, (unsigned long)m.roam_scans, (unsigned long)m.roams,
+                     WIFI_ROAM_RSSI_THRESHOLD);
+  serial_data_write(buf, len);
+  return true;
+}
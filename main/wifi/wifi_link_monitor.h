@@ -0,0 +1,127 @@
+/**
+ * @file wifi_link_monitor.h
+ * @brief WiFi link-quality monitor with RSSI-based roaming
+ *
+ * Samples the RSSI of the associated AP on a periodic esp_timer, smooths it
+ * and follows its trend, and counts beacon timeouts and disconnects. When
+ * the smoothed RSSI stays below the roaming threshold, or beacons keep
+ * getting lost, the link is marked degraded. A degraded link first asks the
+ * AP for a BSS transition (802.11v) when it supports one, otherwise scans
+ * for the same SSID and moves to a clearly stronger AP.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef WIFI_LINK_MONITOR_H
+#define WIFI_LINK_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** RSSI sampling period */
+#define WIFI_LINK_SAMPLE_MS 2000
+
+  /** Samples the trend is measured over, 32 s at the default period */
+#define WIFI_LINK_TREND_SAMPLES 16
+
+  /** Beacon timeouts within one trend window that mark the link degraded */
+#define WIFI_LINK_BEACON_LOSS_LIMIT 2
+
+  /** Smoothed RSSI below which the panel looks for a better AP */
+#ifdef CONFIG_WIFI_ROAM_RSSI_THRESHOLD
+#define WIFI_ROAM_RSSI_THRESHOLD CONFIG_WIFI_ROAM_RSSI_THRESHOLD
+#else
+#define WIFI_ROAM_RSSI_THRESHOLD -70
+#endif
+
+  /** A scanned AP must beat the current one by this much to roam to it */
+#ifdef CONFIG_WIFI_ROAM_HYSTERESIS_DB
+#define WIFI_ROAM_HYSTERESIS_DB CONFIG_WIFI_ROAM_HYSTERESIS_DB
+#else
+#define WIFI_ROAM_HYSTERESIS_DB 8
+#endif
+
+  /** Minimum time between two roaming attempts */
+#ifdef CONFIG_WIFI_ROAM_COOLDOWN_S
+#define WIFI_ROAM_COOLDOWN_S CONFIG_WIFI_ROAM_COOLDOWN_S
+#else
+#define WIFI_ROAM_COOLDOWN_S 120
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Link metrics snapshot
+   */
+  typedef struct
+  {
+    bool connected;
+    bool degraded;              ///< Below the roaming threshold or losing beacons
+    int8_t rssi;                ///< Last sample, dBm
+    int8_t rssi_avg;            ///< Smoothed RSSI, dBm
+    int8_t rssi_trend;          ///< Smoothed RSSI change over the trend window, dB
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint8_t beacon_loss_recent; ///< Beacon timeouts in the current trend window
+    uint32_t beacon_timeouts;   ///< Since boot
+    uint32_t disconnects;       ///< Since boot
+    uint32_t roam_requests;     ///< BSS transition queries sent
+    uint32_t roam_scans;        ///< Targeted rescans started
+    uint32_t roams;             ///< Moves to a different AP, by either path
+  } wifi_link_metrics_t;
+
+  /**
+   * @brief Called after every sample, from the esp_timer task
+   * @param metrics Snapshot, only valid during the call
+   */
+  typedef void (*wifi_link_callback_t)(const wifi_link_metrics_t *metrics);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start sampling the link
+   * @note Call after wifi_manager_init(), the event loop must exist
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t wifi_link_monitor_start(void);
+
+  /**
+   * @brief Copy the current metrics
+   * @param metrics Destination
+   * @return ESP_OK, or ESP_ERR_INVALID_ARG for NULL
+   */
+  esp_err_t wifi_link_monitor_get_metrics(wifi_link_metrics_t *metrics);
+
+  /**
+   * @brief Register the sample callback
+   * @param callback Called after every sample, NULL to stop
+   */
+  void wifi_link_monitor_register_callback(wifi_link_callback_t callback);
+
+  /**
+   * @brief Handle GET_WIFI_LINK
+   * @param line Trimmed command line from the serial port
+   * @return true if the line was a link monitor command
+   */
+  bool wifi_link_monitor_handle_command(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_LINK_MONITOR_H
@@ -4,6 +4,8 @@
 #include "esp_event.h"
 #include "esp_http_client.h"
 #include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
@@ -13,6 +15,9 @@
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
 #include "nvs_flash.h"
+#include "boot_graph.h"
+#include "event_bus.h"
+#include "nvs_store.h"
 #include "system_debug_utils.h"
 #include "wifi_config.h"
 
@@ -23,36 +28,63 @@ typedef struct
   wifi_status_t status;
   int retry_count;
   wifi_info_t connection_info;
-  wifi_status_callback_t status_callback;
   wifi_connected_callback_t connected_callback;
   bool connected_callback_called;
   bool initial_connection_attempted;
-  TaskHandle_t reconnect_task_handle;
+  esp_timer_handle_t retry_timer; // One-shot backoff before the next connect
+  bool auto_reconnect;            // Cleared by wifi_manager_disconnect()
+  esp_netif_t *sta_netif;
+  bool link_up;          // Associated with an AP
+  bool directed_attempt; // Current attempt targets the cached AP
+  bool directed_failed;  // Cached AP did not answer, scan until the next association
+  bool static_ip_active; // Cached lease applied, DHCP client stopped
 } wifi_manager_internal_t;
 
+// Last good AP and DHCP lease, persisted so boot and reconnect skip the scan
+#define WIFI_FAST_NVS_NAMESPACE "wifi_fast"
+#define WIFI_FAST_NVS_KEY "ap"
+#define WIFI_FAST_BLOB_VERSION 1
+#define WIFI_FAST_SAVE_DELAY_MS 10000
+
+typedef struct
+{
+  uint32_t version;
+  uint8_t ssid[33];
+  uint8_t bssid[6];
+  uint8_t channel;
+  bool has_lease;
+  esp_netif_ip_info_t ip_info;
+  esp_ip4_addr_t dns;
+} wifi_fast_cache_t;
+
 static wifi_manager_internal_t s_wifi_manager = {
     .initialized = false,
     .status = WIFI_STATUS_DISCONNECTED,
     .retry_count = 0,
     .connection_info = {{0}},
-    .status_callback = NULL,
     .connected_callback_called = false,
     .initial_connection_attempted = false,
-    .reconnect_task_handle = NULL};
+    .retry_timer = NULL,
+    .auto_reconnect = true};
 
 static EventGroupHandle_t s_wifi_event_group;
+static wifi_fast_cache_t s_fast_cache = {0};
+static bool s_fast_cache_valid = false;
 
 // Function declarations
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 static void ip_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 static void wifi_update_connection_info(void);
 static void wifi_set_status(wifi_status_t new_status);
-static void wifi_reconnect_task(void *pvParameters);
-static esp_err_t wifi_start_reconnect_task(void);
-static void wifi_stop_reconnect_task(void);
+static void wifi_retry_timer_cb(void *arg);
+static void wifi_schedule_reconnect(void);
+static void wifi_cancel_reconnect(void);
 static const char *wifi_status_to_text(wifi_status_t status, const wifi_info_t *info);
 static bool wifi_has_stored_credentials(void);
 static esp_err_t wifi_connect_with_default_credentials(void);
+static void wifi_fast_cache_load(void);
+static void wifi_fast_cache_save(void);
+static esp_err_t wifi_connect_sta(void);
 
 // Helper functions for default credential fallback
 static bool wifi_has_stored_credentials(void)
@@ -109,6 +141,116 @@ static esp_err_t wifi_connect_with_default_credentials(void)
 #endif
 }
 
+// Fast reconnect: directed connect to the cached AP, optional cached static IP
+static void wifi_fast_cache_load(void)
+{
+  wifi_fast_cache_t cache;
+  size_t size = sizeof(cache);
+  esp_err_t ret = nvs_store_get(WIFI_FAST_NVS_NAMESPACE, WIFI_FAST_NVS_KEY, &cache, &size);
+  if (ret != ESP_OK || size != sizeof(cache) || cache.version != WIFI_FAST_BLOB_VERSION)
+  {
+    return;
+  }
+
+  s_fast_cache = cache;
+  s_fast_cache.ssid[sizeof(s_fast_cache.ssid) - 1] = '\0';
+  s_fast_cache_valid = true;
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Cached AP for %s on channel %d", (char *)s_fast_cache.ssid,
+                   s_fast_cache.channel);
+}
+
+// The store drops the write when nothing changed, the same AP and lease are the normal case
+static void wifi_fast_cache_save(void)
+{
+  nvs_store_set(WIFI_FAST_NVS_NAMESPACE, WIFI_FAST_NVS_KEY, &s_fast_cache, sizeof(s_fast_cache),
+                WIFI_FAST_SAVE_DELAY_MS);
+}
+
+#if CONFIG_WIFI_FAST_STATIC_IP
+static void wifi_apply_static_ip(bool use_static)
+{
+  esp_netif_t *netif = s_wifi_manager.sta_netif;
+  if (!netif || use_static == s_wifi_manager.static_ip_active)
+  {
+    return;
+  }
+
+  if (!use_static)
+  {
+    esp_netif_dhcpc_start(netif);
+    s_wifi_manager.static_ip_active = false;
+    return;
+  }
+
+  esp_err_t ret = esp_netif_dhcpc_stop(netif);
+  if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED)
+  {
+    return;
+  }
+  esp_netif_set_ip_info(netif, &s_fast_cache.ip_info);
+  esp_netif_dns_info_t dns = {0};
+  dns.ip.type = ESP_IPADDR_TYPE_V4;
+  dns.ip.u_addr.ip4 = s_fast_cache.dns;
+  esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+  s_wifi_manager.static_ip_active = true;
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Using cached address " IPSTR, IP2STR(&s_fast_cache.ip_info.ip));
+}
+#endif
+
+/**
+ * @brief Connect, straight to the cached AP when it belongs to the configured network
+ */
+static esp_err_t wifi_connect_sta(void)
+{
+  wifi_config_t config;
+  if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK)
+  {
+    // The driver stores its config in flash, so only write it when something changes
+    bool changed = false;
+
+#if CONFIG_WIFI_ROAMING && CONFIG_ESP_WIFI_11KV_SUPPORT
+    // Let the AP steer us with neighbor reports and BSS transition requests
+    if (!config.sta.rm_enabled || !config.sta.btm_enabled)
+    {
+      config.sta.rm_enabled = 1;
+      config.sta.btm_enabled = 1;
+      changed = true;
+    }
+#endif
+
+#if CONFIG_WIFI_FAST_RECONNECT
+    bool directed = s_fast_cache_valid && !s_wifi_manager.directed_failed &&
+                    strncmp((char *)config.sta.ssid, (char *)s_fast_cache.ssid, sizeof(config.sta.ssid)) == 0;
+
+    if ((config.sta.bssid_set != directed) || config.sta.scan_method != WIFI_FAST_SCAN ||
+        (directed && (config.sta.channel != s_fast_cache.channel ||
+                      memcmp(config.sta.bssid, s_fast_cache.bssid, sizeof(config.sta.bssid)) != 0)) ||
+        (!directed && config.sta.channel != 0))
+    {
+      config.sta.bssid_set = directed;
+      config.sta.channel = directed ? s_fast_cache.channel : 0;
+      config.sta.scan_method = WIFI_FAST_SCAN;
+      if (directed)
+      {
+        memcpy(config.sta.bssid, s_fast_cache.bssid, sizeof(config.sta.bssid));
+      }
+      changed = true;
+    }
+    s_wifi_manager.directed_attempt = directed;
+#endif
+
+    if (changed)
+    {
+      esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+
+#if CONFIG_WIFI_FAST_STATIC_IP
+    wifi_apply_static_ip(directed && s_fast_cache.has_lease);
+#endif
+  }
+  return esp_wifi_connect();
+}
+
 // Event handlers
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
 {
@@ -130,68 +272,96 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         if (connect_ret != ESP_OK)
         {
           debug_log_warning(DEBUG_TAG_WIFI_MANAGER, "Failed to connect with default credentials");
-          // Still try esp_wifi_connect() as fallback
-          esp_wifi_connect();
+          // Still try to connect as fallback
+          wifi_connect_sta();
         }
         // If connect_ret == ESP_OK, wifi_manager_connect() will handle the connection
       }
       else
       {
         debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Using stored WiFi credentials for auto-connection");
-        esp_wifi_connect();
+        wifi_connect_sta();
       }
     }
     else
     {
       // Subsequent starts, just connect normally
-      esp_wifi_connect();
+      wifi_connect_sta();
     }
     break;
 
   case WIFI_EVENT_STA_CONNECTED:
+  {
+    wifi_event_sta_connected_t *connected = (wifi_event_sta_connected_t *)event_data;
+    if (s_wifi_manager.directed_attempt)
+    {
+      debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Connected to the cached AP without a scan");
+    }
+    s_wifi_manager.link_up = true;
+    s_wifi_manager.directed_failed = false;
+    boot_graph_mark_milestone("wifi_assoc");
+
+    // Roaming to another AP keeps the lease, a different network drops it
+    if (strncmp((char *)s_fast_cache.ssid, (char *)connected->ssid, connected->ssid_len) != 0 ||
+        s_fast_cache.ssid[connected->ssid_len] != '\0')
+    {
+      memset(&s_fast_cache, 0, sizeof(s_fast_cache));
+      memcpy(s_fast_cache.ssid, connected->ssid, connected->ssid_len);
+    }
+    s_fast_cache.version = WIFI_FAST_BLOB_VERSION;
+    memcpy(s_fast_cache.bssid, connected->bssid, sizeof(s_fast_cache.bssid));
+    s_fast_cache.channel = connected->channel;
+    s_fast_cache_valid = true;
+
     wifi_update_connection_info();
     wifi_set_status(WIFI_STATUS_CONNECTED);
-    wifi_stop_reconnect_task();
+    wifi_cancel_reconnect();
     s_wifi_manager.retry_count = 0;
     xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi connected successfully");
     break;
+  }
 
   case WIFI_EVENT_STA_DISCONNECTED:
   {
     wifi_event_sta_disconnected_t *disconnected = (wifi_event_sta_disconnected_t *)event_data;
     debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "WiFi disconnected (reason: %d)", disconnected->reason);
 
+    // The cached AP did not take us, scan from the next attempt on
+    if (s_wifi_manager.directed_attempt && !s_wifi_manager.link_up)
+    {
+      debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Cached AP unavailable, falling back to a scan");
+      s_wifi_manager.directed_failed = true;
+    }
+    s_wifi_manager.link_up = false;
+
     wifi_set_status(WIFI_STATUS_DISCONNECTED);
-    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_GOT_IP_BIT);
 
-    s_wifi_manager.retry_count++;
-    if (s_wifi_manager.retry_count < WIFI_MAXIMUM_RETRY_COUNT)
+    if (!s_wifi_manager.auto_reconnect)
     {
-      debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Retrying connection (attempt %d/%d)",
-                       s_wifi_manager.retry_count, WIFI_MAXIMUM_RETRY_COUNT);
-      esp_wifi_connect();
+      break;
     }
-    else
+
+    s_wifi_manager.retry_count++;
+    if (s_wifi_manager.retry_count == WIFI_MAXIMUM_RETRY_COUNT)
     {
       // On first boot, if we've exhausted retries and never connected, try default credentials
       if (!s_wifi_manager.initial_connection_attempted)
       {
         s_wifi_manager.initial_connection_attempted = true;
         debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Initial connection failed, attempting with default credentials");
-        esp_err_t connect_ret = wifi_connect_with_default_credentials();
-        if (connect_ret == ESP_OK)
+        if (wifi_connect_with_default_credentials() == ESP_OK)
         {
-          // Reset retry count for new connection attempt
-          s_wifi_manager.retry_count = 0;
-          return; // Don't start background task yet
+          wifi_schedule_reconnect();
+          break;
         }
       }
 
-      debug_log_error(DEBUG_TAG_WIFI_MANAGER, "Maximum retry attempts reached, starting background reconnection");
-      wifi_start_reconnect_task(); // Start background reconnection
+      debug_log_error(DEBUG_TAG_WIFI_MANAGER, "Maximum retry attempts reached, backing off");
       xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
     }
+    wifi_schedule_reconnect();
     break;
   }
 
@@ -215,17 +385,29 @@ static void ip_event_handler(void *arg, esp_event_base_t event_base, int32_t eve
              IPSTR, IP2STR(&event->ip_info.gw));
 
     debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Got IP address: %s", s_wifi_manager.connection_info.ip_address);
+
+    // Remember the lease with the AP it came from
+    s_fast_cache.ip_info = event->ip_info;
+    esp_netif_dns_info_t dns;
+    if (esp_netif_get_dns_info(event->esp_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK &&
+        dns.ip.type == ESP_IPADDR_TYPE_V4)
+    {
+      s_fast_cache.dns = dns.ip.u_addr.ip4;
+    }
+    s_fast_cache.has_lease = true;
+    wifi_fast_cache_save();
     wifi_set_status(WIFI_STATUS_CONNECTED);
-    wifi_stop_reconnect_task();
+    wifi_cancel_reconnect();
     s_wifi_manager.retry_count = 0;
-    xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_GOT_IP_BIT);
+    boot_graph_mark_milestone("wifi_ip");
     break;
   }
 
   case IP_EVENT_STA_LOST_IP:
     debug_log_warning(DEBUG_TAG_WIFI_MANAGER, "Lost IP address");
     wifi_set_status(WIFI_STATUS_DISCONNECTED);
-    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_GOT_IP_BIT);
     break;
 
   default:
@@ -279,22 +461,28 @@ static const char *wifi_status_to_text(wifi_status_t status, const wifi_info_t *
   }
 }
 
+/**
+ * @brief Publish the current status, retained by the bus for late subscribers
+ */
+static void wifi_publish_status(void)
+{
+  wifi_status_t status = s_wifi_manager.status;
+  event_t event = {.topic = EVENT_TOPIC_WIFI_STATUS,
+                   .wifi_status = {.status = status,
+                                   .is_connected = (status == WIFI_STATUS_CONNECTED),
+                                   .text = wifi_status_to_text(status, &s_wifi_manager.connection_info)}};
+  event_bus_publish(&event);
+}
+
 static void wifi_set_status(wifi_status_t new_status)
 {
   if (s_wifi_manager.status != new_status)
   {
     s_wifi_manager.status = new_status;
 
-    const char *status_text = wifi_status_to_text(new_status, &s_wifi_manager.connection_info);
-    bool is_connected = (new_status == WIFI_STATUS_CONNECTED);
-
-    debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "WiFi status changed to: %s", status_text);
-
-    // Notify callbacks
-    if (s_wifi_manager.status_callback)
-    {
-      s_wifi_manager.status_callback(is_connected, status_text, new_status, &s_wifi_manager.connection_info);
-    }
+    debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "WiFi status changed to: %s",
+                     wifi_status_to_text(new_status, &s_wifi_manager.connection_info));
+    wifi_publish_status();
 
     // Notify connected callback, only called once in the entire lifecycle
     if (s_wifi_manager.connected_callback && new_status == WIFI_STATUS_CONNECTED && !s_wifi_manager.connected_callback_called)
@@ -305,64 +493,64 @@ static void wifi_set_status(wifi_status_t new_status)
   }
 }
 
-static void wifi_reconnect_task(void *pvParameters)
+/**
+ * @brief Backoff expired, start the next attempt
+ * @note Runs in the esp_timer task, the outcome arrives as a WiFi event
+ */
+static void wifi_retry_timer_cb(void *arg)
 {
-  debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi reconnect task started");
-
-  while (true)
+  if (!s_wifi_manager.auto_reconnect || s_wifi_manager.status == WIFI_STATUS_CONNECTED)
   {
-    vTaskDelay(pdMS_TO_TICKS(WIFI_RECONNECT_DELAY_MS));
-
-    if (s_wifi_manager.status != WIFI_STATUS_CONNECTED)
-    {
-      debug_log_info(DEBUG_TAG_WIFI_MANAGER, "Attempting WiFi reconnection...");
-      s_wifi_manager.retry_count = 0;
-      esp_wifi_connect();
-    }
-    else
-    {
-      debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi reconnected successfully, stopping reconnect task");
-      break;
-    }
+    return;
   }
 
-  s_wifi_manager.reconnect_task_handle = NULL;
-  vTaskDelete(NULL);
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Attempting WiFi reconnection (attempt %d)", s_wifi_manager.retry_count + 1);
+  esp_err_t ret = wifi_connect_sta();
+  if (ret != ESP_OK)
+  {
+    // No disconnect event follows a rejected call, so back off from here
+    debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "Reconnect not started: %s", esp_err_to_name(ret));
+    s_wifi_manager.retry_count++;
+    wifi_schedule_reconnect();
+  }
 }
 
-static esp_err_t wifi_start_reconnect_task(void)
+/**
+ * @brief Arm the backoff timer for the attempt after retry_count failures
+ *
+ * The first retry comes almost at once, later ones double from
+ * WIFI_RECONNECT_BASE_DELAY_MS up to WIFI_RECONNECT_MAX_DELAY_MS. Up to an
+ * eighth of jitter keeps panels on the same AP from retrying in lockstep.
+ */
+static void wifi_schedule_reconnect(void)
 {
-  if (s_wifi_manager.reconnect_task_handle != NULL)
+  if (!s_wifi_manager.retry_timer)
   {
-    debug_log_warning(DEBUG_TAG_WIFI_MANAGER, "Reconnect task already running");
-    return ESP_OK;
+    return;
   }
 
-  BaseType_t result = xTaskCreate(
-      wifi_reconnect_task,
-      "wifi_reconnect",
-      4096,
-      NULL,
-      5,
-      &s_wifi_manager.reconnect_task_handle);
-
-  if (result != pdPASS)
+  uint32_t delay_ms = WIFI_RECONNECT_FIRST_DELAY_MS;
+  if (s_wifi_manager.retry_count > 1)
   {
-    debug_log_error(DEBUG_TAG_WIFI_MANAGER, "Failed to create WiFi reconnect task");
-    return ESP_FAIL;
+    int shift = s_wifi_manager.retry_count - 2;
+    delay_ms = WIFI_RECONNECT_MAX_DELAY_MS;
+    if (shift < 16 && ((uint32_t)WIFI_RECONNECT_BASE_DELAY_MS << shift) < WIFI_RECONNECT_MAX_DELAY_MS)
+    {
+      delay_ms = (uint32_t)WIFI_RECONNECT_BASE_DELAY_MS << shift;
+    }
   }
+  delay_ms += esp_random() % (delay_ms / 8 + 1);
 
-  debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi reconnect task started");
-  return ESP_OK;
+  esp_timer_stop(s_wifi_manager.retry_timer);
+  esp_timer_start_once(s_wifi_manager.retry_timer, (uint64_t)delay_ms * 1000);
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Next WiFi reconnection in %lu ms", (unsigned long)delay_ms);
 }
 
-static void wifi_stop_reconnect_task(void)
+static void wifi_cancel_reconnect(void)
 {
-  if (s_wifi_manager.reconnect_task_handle != NULL)
+  if (s_wifi_manager.retry_timer)
   {
-    vTaskDelete(s_wifi_manager.reconnect_task_handle);
-    s_wifi_manager.reconnect_task_handle = NULL;
-    debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi reconnect task stopped");
+    esp_timer_stop(s_wifi_manager.retry_timer);
   }
 }
 
@@ -393,7 +581,8 @@ esp_err_t wifi_manager_init(void)
   ESP_ERROR_CHECK(esp_event_loop_create_default());
 
   // Create WiFi station interface
-  esp_netif_create_default_wifi_sta();
+  s_wifi_manager.sta_netif = esp_netif_create_default_wifi_sta();
+  wifi_fast_cache_load();
 
   // Initialize WiFi with default config
   wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -407,6 +596,15 @@ esp_err_t wifi_manager_init(void)
     return ESP_FAIL;
   }
 
+  // Reconnect backoff, no task of its own
+  const esp_timer_create_args_t retry_timer_args = {
+      .callback = wifi_retry_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "wifi_retry",
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&retry_timer_args, &s_wifi_manager.retry_timer));
+  s_wifi_manager.auto_reconnect = true;
+
   // Register event handlers
   ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
   ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &ip_event_handler, NULL));
@@ -420,6 +618,8 @@ esp_err_t wifi_manager_init(void)
 
   s_wifi_manager.initialized = true;
   wifi_set_status(WIFI_STATUS_DISCONNECTED);
+  // Retained even if unchanged, WiFi starts in parallel with the UI and a late subscriber still learns where it stands
+  wifi_publish_status();
 
   debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi manager initialized successfully");
   return ESP_OK;
@@ -441,8 +641,9 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
 
   debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Connecting to WiFi network: %s", ssid);
 
-  // Stop any existing reconnect task
-  wifi_stop_reconnect_task();
+  // A pending backoff would race the attempt below
+  wifi_cancel_reconnect();
+  s_wifi_manager.auto_reconnect = true;
 
   // Configure WiFi credentials
   wifi_config_t wifi_config = {0};
@@ -461,7 +662,7 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
   s_wifi_manager.retry_count = 0;
   wifi_set_status(WIFI_STATUS_CONNECTING);
 
-  esp_err_t result = esp_wifi_connect();
+  esp_err_t result = wifi_connect_sta();
   if (result != ESP_OK)
   {
     debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "Failed to initiate WiFi connection: %s", esp_err_to_name(result));
@@ -472,6 +673,33 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
   return ESP_OK;
 }
 
+esp_err_t wifi_manager_roam(const uint8_t bssid[6], uint8_t channel)
+{
+#if CONFIG_WIFI_FAST_RECONNECT
+  if (!s_wifi_manager.initialized || !bssid)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_wifi_manager.link_up || !s_fast_cache_valid)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Roaming to %02x:%02x:%02x:%02x:%02x:%02x on channel %d", bssid[0],
+                   bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], channel);
+
+  // Same network, so the lease stays; the fast retry after the disconnect targets the new AP
+  memcpy(s_fast_cache.bssid, bssid, sizeof(s_fast_cache.bssid));
+  s_fast_cache.channel = channel;
+  s_wifi_manager.directed_failed = false;
+  return esp_wifi_disconnect();
+#else
+  (void)bssid;
+  (void)channel;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t wifi_manager_disconnect(void)
 {
   if (!s_wifi_manager.initialized)
@@ -479,7 +707,8 @@ esp_err_t wifi_manager_disconnect(void)
     return ESP_ERR_INVALID_STATE;
   }
 
-  wifi_stop_reconnect_task();
+  s_wifi_manager.auto_reconnect = false;
+  wifi_cancel_reconnect();
   esp_err_t result = esp_wifi_disconnect();
   wifi_set_status(WIFI_STATUS_DISCONNECTED);
 
@@ -503,20 +732,27 @@ esp_err_t wifi_manager_get_info(wifi_info_t *info)
   return ESP_OK;
 }
 
-void wifi_manager_register_status_callback(wifi_status_callback_t callback)
+void wifi_manager_register_connected_callback(wifi_connected_callback_t callback)
 {
-  s_wifi_manager.status_callback = callback;
-}
+  s_wifi_manager.connected_callback = callback;
+  s_wifi_manager.connected_callback_called = false; // Reset flag when new callback is registered
 
-void wifi_manager_unregister_callback(void)
-{
-  s_wifi_manager.status_callback = NULL;
+  // Already connected, the event that would have called it is gone
+  if (callback && s_wifi_manager.status == WIFI_STATUS_CONNECTED && !s_wifi_manager.connected_callback_called)
+  {
+    s_wifi_manager.connected_callback_called = true;
+    callback();
+  }
 }
 
-void wifi_manager_register_connected_callback(wifi_connected_callback_t callback)
+bool wifi_manager_wait_for_ip(TickType_t ticks_to_wait)
 {
-  s_wifi_manager.connected_callback = callback;
-  s_wifi_manager.connected_callback_called = false; // Reset flag when new callback is registered
+  if (!s_wifi_event_group)
+  {
+    return false;
+  }
+  EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_GOT_IP_BIT, pdFALSE, pdTRUE, ticks_to_wait);
+  return (bits & WIFI_GOT_IP_BIT) != 0;
 }
 
 void wifi_manager_unregister_connected_callback(void)
@@ -532,7 +768,8 @@ esp_err_t wifi_manager_deinit(void)
     return ESP_OK;
   }
 
-  wifi_stop_reconnect_task();
+  s_wifi_manager.auto_reconnect = false;
+  wifi_cancel_reconnect();
   esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler);
   esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, &ip_event_handler);
   esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_LOST_IP, &ip_event_handler);
@@ -540,6 +777,12 @@ esp_err_t wifi_manager_deinit(void)
   esp_wifi_stop();
   esp_wifi_deinit();
 
+  if (s_wifi_manager.retry_timer)
+  {
+    esp_timer_delete(s_wifi_manager.retry_timer);
+    s_wifi_manager.retry_timer = NULL;
+  }
+
   if (s_wifi_event_group)
   {
     vEventGroupDelete(s_wifi_event_group);
@@ -7,7 +7,7 @@
  *
  * Features:
  * - Automatic WiFi connection with retry logic
- * - Connection status callbacks for UI updates
+ * - Status changes published on the event bus (EVENT_TOPIC_WIFI_STATUS)
  * - WiFi credential configuration via menuconfig
  * - Signal strength monitoring
  * - Network time synchronization support
@@ -37,11 +37,17 @@ extern "C"
 /** WiFi connection timeout in milliseconds */
 #define WIFI_CONNECT_TIMEOUT_MS 30000
 
-/** Maximum number of connection retry attempts */
+/** Failed attempts before WIFI_FAIL_BIT is set, retries continue afterwards */
 #define WIFI_MAXIMUM_RETRY_COUNT 5
 
-/** WiFi reconnection delay in milliseconds */
-#define WIFI_RECONNECT_DELAY_MS 10000
+/** Delay before the first retry, most drops are a single missed beacon or deauth */
+#define WIFI_RECONNECT_FIRST_DELAY_MS 250
+
+/** Delay before the second retry, doubled on every further failure */
+#define WIFI_RECONNECT_BASE_DELAY_MS 1000
+
+/** Longest delay between retries */
+#define WIFI_RECONNECT_MAX_DELAY_MS 60000
 
 /** WiFi scan timeout in milliseconds */
 #define WIFI_SCAN_TIMEOUT_MS 10000
@@ -50,6 +56,7 @@ extern "C"
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT BIT1
 #define WIFI_DISCONNECTED_BIT BIT2
+#define WIFI_GOT_IP_BIT BIT3
 
   // =======================================================================
   // DATA STRUCTURES
@@ -84,15 +91,6 @@ extern "C"
     bool has_internet;          ///< Internet connectivity status
   } wifi_info_t;
 
-  /**
-   * @brief WiFi status callback function type
-   * @param is_connected Boolean indicating if WiFi is connected
-   * @param status_text Human-readable status text
-   * @param status Current WiFi status
-   * @param info WiFi connection information (NULL if disconnected)
-   */
-  typedef void (*wifi_status_callback_t)(bool is_connected, const char *status_text, wifi_status_t status, const wifi_info_t *info);
-
   /**
    * @brief WiFi connected callback function type
    */
@@ -128,6 +126,19 @@ extern "C"
    */
   esp_err_t wifi_manager_disconnect(void);
 
+  /**
+   * @brief Move to another AP of the current network
+   *
+   * Drops the link and lets the fast first reconnect target the given AP
+   * without a scan. If it does not answer, the following retries scan.
+   *
+   * @param bssid AP to move to
+   * @param channel Primary channel of that AP
+   * @return ESP_OK if the move started, ESP_ERR_NOT_SUPPORTED without
+   *         CONFIG_WIFI_FAST_RECONNECT, ESP_ERR_INVALID_STATE when not connected
+   */
+  esp_err_t wifi_manager_roam(const uint8_t bssid[6], uint8_t channel);
+
   /**
    * @brief Get current WiFi connection status
    *
@@ -144,23 +155,21 @@ extern "C"
   esp_err_t wifi_manager_get_info(wifi_info_t *info);
 
   /**
-   * @brief Register callback for WiFi status changes
+   * @brief Register callback for WiFi connected event, only called once
    *
-   * @param callback Function to call when WiFi status changes
-   */
-  void wifi_manager_register_status_callback(wifi_status_callback_t callback);
-
-  /**
-   * @brief Unregister WiFi status change callback
+   * Called right away if WiFi is already connected.
+   *
+   * @param callback Function to call when WiFi is connected
    */
-  void wifi_manager_unregister_callback(void);
+  void wifi_manager_register_connected_callback(wifi_connected_callback_t callback);
 
   /**
-   * @brief Register callback for WiFi connected event, only called once
+   * @brief Wait until the station has an IP address
    *
-   * @param callback Function to call when WiFi is connected
+   * @param ticks_to_wait How long to wait, portMAX_DELAY for ever
+   * @return true if an address is assigned
    */
-  void wifi_manager_register_connected_callback(wifi_connected_callback_t callback);
+  bool wifi_manager_wait_for_ip(TickType_t ticks_to_wait);
 
   /**
    * @brief Unregister WiFi connected event callback
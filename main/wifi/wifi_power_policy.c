@@ -0,0 +1,162 @@
+/**
+ * @file wifi_power_policy.c
+ * @brief Adaptive WiFi power save, driven by UI activity and HA requests
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#include "wifi_power_policy.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "system_debug_utils.h"
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+// Callers are the LVGL task, HTTP callers and the hold timer
+static SemaphoreHandle_t policy_mutex = NULL;
+static esp_timer_handle_t hold_timer = NULL;
+
+static wifi_power_ui_t ui_level = WIFI_POWER_UI_ACTIVE;
+static int requests_in_flight = 0;
+static bool hold_active = false;
+static bool ps_applied = false;
+static wifi_ps_type_t applied_ps = WIFI_PS_NONE;
+
+static const char *const ps_names[] = {"none", "min_modem", "max_modem"};
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+/**
+ * @brief Set the power save the current inputs call for
+ * @note Call with policy_mutex held
+ */
+static void apply_locked(void)
+{
+  wifi_ps_type_t ps = WIFI_PS_NONE;
+  if (ui_level != WIFI_POWER_UI_ACTIVE && requests_in_flight == 0 && !hold_active)
+  {
+    ps = (ui_level == WIFI_POWER_UI_STANDBY) ? WIFI_POWER_STANDBY_PS : WIFI_PS_MIN_MODEM;
+  }
+
+  if (ps_applied && ps == applied_ps)
+  {
+    return;
+  }
+
+  esp_err_t ret = esp_wifi_set_ps(ps);
+  if (ret != ESP_OK)
+  {
+    debug_log_warning_f(DEBUG_TAG_WIFI_MANAGER, "Power save change failed: %s", esp_err_to_name(ret));
+    return;
+  }
+  applied_ps = ps;
+  ps_applied = true;
+  debug_log_debug_f(DEBUG_TAG_WIFI_MANAGER, "WiFi power save: %s", ps_names[ps]);
+}
+
+static void hold_timer_cb(void *arg)
+{
+  xSemaphoreTake(policy_mutex, portMAX_DELAY);
+  hold_active = false;
+  apply_locked();
+  xSemaphoreGive(policy_mutex);
+}
+
+// =======================================================================
+// PUBLIC API FUNCTIONS
+// =======================================================================
+
+esp_err_t wifi_power_policy_init(void)
+{
+#if CONFIG_WIFI_POWER_POLICY
+  if (policy_mutex)
+  {
+    return ESP_OK;
+  }
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = hold_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "wifi_ps_hold",
+  };
+  esp_err_t ret = esp_timer_create(&timer_args, &hold_timer);
+  if (ret != ESP_OK)
+  {
+    return ret;
+  }
+
+  policy_mutex = xSemaphoreCreateMutex();
+  if (!policy_mutex)
+  {
+    esp_timer_delete(hold_timer);
+    hold_timer = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  xSemaphoreTake(policy_mutex, portMAX_DELAY);
+  apply_locked();
+  xSemaphoreGive(policy_mutex);
+
+  debug_log_info(DEBUG_TAG_WIFI_MANAGER, "WiFi power-save policy started");
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void wifi_power_policy_set_ui(wifi_power_ui_t ui)
+{
+  if (!policy_mutex)
+  {
+    return;
+  }
+
+  xSemaphoreTake(policy_mutex, portMAX_DELAY);
+  ui_level = ui;
+  apply_locked();
+  xSemaphoreGive(policy_mutex);
+}
+
+void wifi_power_policy_request_begin(void)
+{
+  if (!policy_mutex)
+  {
+    return;
+  }
+
+  xSemaphoreTake(policy_mutex, portMAX_DELAY);
+  requests_in_flight++;
+  apply_locked();
+  xSemaphoreGive(policy_mutex);
+}
+
+void wifi_power_policy_request_end(void)
+{
+  if (!policy_mutex)
+  {
+    return;
+  }
+
+  xSemaphoreTake(policy_mutex, portMAX_DELAY);
+  if (requests_in_flight > 0)
+  {
+    requests_in_flight--;
+  }
+
+  // The reply, and the state change HA pushes after it, arrive shortly afterwards
+  if (requests_in_flight == 0 && WIFI_POWER_HOLD_MS > 0)
+  {
+    hold_active = true;
+    esp_timer_stop(hold_timer);
+    esp_timer_start_once(hold_timer, (uint64_t)WIFI_POWER_HOLD_MS * 1000);
+  }
+  apply_locked();
+  xSemaphoreGive(policy_mutex);
+}
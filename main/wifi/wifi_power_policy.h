@@ -0,0 +1,91 @@
+/**
+ * @file wifi_power_policy.h
+ * @brief Adaptive WiFi power save, driven by UI activity and HA requests
+ *
+ * In modem sleep the radio only wakes for DTIM beacons, so the first HA
+ * request after a tap waits for the next one. This policy turns power save
+ * off while the UI is active or a Home Assistant request is in flight, and
+ * for WIFI_POWER_HOLD_MS after the last request so the state update that
+ * follows arrives quickly too. An idle UI goes back to minimum modem sleep,
+ * standby to the power-save mode chosen in menuconfig.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-14
+ */
+
+#ifndef WIFI_POWER_POLICY_H
+#define WIFI_POWER_POLICY_H
+
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // CONSTANTS AND CONFIGURATION
+  // =======================================================================
+
+  /** Radio stays awake this long after the last HA request */
+#ifdef CONFIG_WIFI_POWER_HOLD_MS
+#define WIFI_POWER_HOLD_MS CONFIG_WIFI_POWER_HOLD_MS
+#else
+#define WIFI_POWER_HOLD_MS 2000
+#endif
+
+  /** Power save while the display is in standby */
+#if CONFIG_WIFI_POWER_STANDBY_MIN_MODEM
+#define WIFI_POWER_STANDBY_PS WIFI_PS_MIN_MODEM
+#else
+#define WIFI_POWER_STANDBY_PS WIFI_PS_MAX_MODEM
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief How much the user is engaging with the panel
+   */
+  typedef enum
+  {
+    WIFI_POWER_UI_ACTIVE = 0, ///< Touched recently, no power save
+    WIFI_POWER_UI_IDLE,       ///< Minimum modem sleep
+    WIFI_POWER_UI_STANDBY,    ///< WIFI_POWER_STANDBY_PS
+  } wifi_power_ui_t;
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Start the policy and apply the power save for an active UI
+   * @note Call after wifi_manager_init()
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t wifi_power_policy_init(void);
+
+  /**
+   * @brief Report the UI activity level
+   * @param ui New level
+   */
+  void wifi_power_policy_set_ui(wifi_power_ui_t ui);
+
+  /**
+   * @brief A Home Assistant request is about to go out, keeps the radio awake
+   * @note Every call must be paired with wifi_power_policy_request_end()
+   */
+  void wifi_power_policy_request_begin(void);
+
+  /**
+   * @brief The request finished, power save may resume after WIFI_POWER_HOLD_MS
+   */
+  void wifi_power_policy_request_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_POWER_POLICY_H
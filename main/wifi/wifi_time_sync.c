@@ -0,0 +1,87 @@
+/**
+ * @file wifi_time_sync.c
+ * @brief Wall-clock time from SNTP once the station has an address
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#include "wifi_time_sync.h"
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include "system_debug_utils.h"
+#if CONFIG_WIFI_SNTP
+#include "esp_netif_sntp.h"
+#endif
+
+// =======================================================================
+// PRIVATE VARIABLES
+// =======================================================================
+
+static volatile bool time_valid = false;
+static volatile wifi_time_sync_callback_t sync_cb = NULL;
+
+// =======================================================================
+// PRIVATE FUNCTIONS
+// =======================================================================
+
+#if CONFIG_WIFI_SNTP
+static void time_sync_notification(struct timeval *tv)
+{
+  bool first = !time_valid;
+  time_valid = true;
+  if (first)
+  {
+    struct tm local;
+    localtime_r(&tv->tv_sec, &local);
+    debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "Clock set by SNTP: %04d-%02d-%02d %02d:%02d:%02d", local.tm_year + 1900,
+                     local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+  }
+
+  wifi_time_sync_callback_t cb = sync_cb;
+  if (cb)
+  {
+    cb();
+  }
+}
+#endif
+
+// =======================================================================
+// PUBLIC FUNCTIONS
+// =======================================================================
+
+esp_err_t wifi_time_sync_start(void)
+{
+#if CONFIG_WIFI_SNTP
+  setenv("TZ", CONFIG_WIFI_SNTP_TIMEZONE, 1);
+  tzset();
+
+  // Polls on its own once the station gets an address, and again every hour
+  esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(CONFIG_WIFI_SNTP_SERVER);
+  config.sync_cb = time_sync_notification;
+  esp_err_t ret = esp_netif_sntp_init(&config);
+  if (ret != ESP_OK)
+  {
+    debug_log_error_f(DEBUG_TAG_WIFI_MANAGER, "SNTP start failed: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  debug_log_info_f(DEBUG_TAG_WIFI_MANAGER, "SNTP started, server %s, TZ %s", CONFIG_WIFI_SNTP_SERVER,
+                   CONFIG_WIFI_SNTP_TIMEZONE);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool wifi_time_sync_is_valid(void)
+{
+  return time_valid;
+}
+
+void wifi_time_sync_register_callback(wifi_time_sync_callback_t callback)
+{
+  sync_cb = callback;
+}
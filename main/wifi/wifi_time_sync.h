@@ -0,0 +1,61 @@
+/**
+ * @file wifi_time_sync.h
+ * @brief Wall-clock time from SNTP once the station has an address
+ *
+ * The SNTP client is started at boot and begins polling as soon as the
+ * network is up. The system clock is set on every sync, so time() and
+ * localtime_r() give local wall-clock time from then on; before the first
+ * sync the clock still counts from the epoch and is reported invalid.
+ *
+ * @author System Monitor Dashboard
+ * @date 2026-10-15
+ */
+
+#ifndef WIFI_TIME_SYNC_H
+#define WIFI_TIME_SYNC_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  // =======================================================================
+  // DATA STRUCTURES
+  // =======================================================================
+
+  /**
+   * @brief Called after the system clock was set, from the lwIP task
+   */
+  typedef void (*wifi_time_sync_callback_t)(void);
+
+  // =======================================================================
+  // PUBLIC FUNCTION DECLARATIONS
+  // =======================================================================
+
+  /**
+   * @brief Apply the time zone and start the SNTP client
+   * @note Call after wifi_manager_init()
+   * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if disabled in menuconfig
+   */
+  esp_err_t wifi_time_sync_start(void);
+
+  /**
+   * @brief Whether the system clock holds wall-clock time
+   * @return true once a sync has succeeded
+   */
+  bool wifi_time_sync_is_valid(void);
+
+  /**
+   * @brief Register the sync callback
+   * @param callback Called after every sync, NULL to stop
+   */
+  void wifi_time_sync_register_callback(wifi_time_sync_callback_t callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_TIME_SYNC_H